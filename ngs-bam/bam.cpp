@@ -25,36 +25,132 @@
 
 #include <iostream>
 #include <fstream>
+#include <sys/stat.h>
 #include "bam.hpp"
+#include "sam.hpp"
+#include "sidecar.hpp"
+#include "trace.hpp"
+#include "cpu.hpp"
 
-#define MAX_INDEX_SEQ_LEN ((1u << 29) - 1)
-#define MAX_BIN  (37449u)
-#define NUMINTV ((MAX_INDEX_SEQ_LEN + 1) >> 14)
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* how much BGZF blocks of BAM records typically deflate by */
+static double const typicalRatio = 3.0;
+
+/* IndexArray
+ *  a read-only view of one of a RefIndex's arrays, which are either
+ *  its own or in a mapped flattened index
+ */
+template <typename T>
+class IndexArray {
+    T const *first;
+    size_t count;
+public:
+    typedef T const *const_iterator;
+    
+    IndexArray() : first(0), count(0) {}
+    IndexArray(T const *const First, size_t const Count) : first(First), count(Count) {}
+    explicit IndexArray(std::vector<T> const &v) : first(v.empty() ? 0 : &v[0]), count(v.size()) {}
+    
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T const &operator [](size_t const i) const { return first[i]; }
+    T const &back() const { return first[count - 1]; }
+};
 
 class RefIndex {
 public:
+    /* bins are stored sparsely, sorted by bin id; the chunks of bins[i]
+     * are chunks[bins[i].first] up to the first chunk of bins[i + 1]
+     */
+    struct Bin {
+        uint32_t id;
+        uint32_t first;
+        BAMFilePosType loffset;     /* CSI only */
+    };
+    IndexFormat const format;
     BAMFilePosType off_beg, off_end;
     uint64_t n_mapped, n_unmapped;
-    BAMFilePosTypeList interval;
-    std::vector<BAMFilePosTypeList> bins;
+    bool has_counts;                /* the pseudo-bin was present */
+    IndexArray<BAMFilePosType> interval;
+    IndexArray<Bin> bins;
+    IndexArray<BAMFileChunk> chunks;
     
 private:
-    static void CopyWhereLess(BAMFilePosTypeList &dst,
-                              BAMFilePosTypeList const &src,
-                              BAMFilePosType const maxpos)
+    /* what the arrays view unless they are mapped */
+    BAMFilePosTypeList ownInterval;
+    std::vector<Bin> ownBins;
+    BAMFileChunkList ownChunks;
+    
+
+    static bool LessBinId(Bin const &bin, uint32_t const id) {
+        return bin.id < id;
+    }
+    struct LoadedChunk {
+        uint32_t bin;
+        BAMFilePosType loffset;
+        BAMFileChunk chunk;
+    };
+    static bool LessBin(LoadedChunk const &a, LoadedChunk const &b)
     {
-        if (maxpos.hasValue()) {
-            for (unsigned i = 0; i < src.size(); ++i) {
-                BAMFilePosType const pos = src[i];
-                
-                if (pos < maxpos)
-                    dst.push_back(pos);
-            }
+        return a.bin < b.bin;
+    }
+    /* first bin id of a level of the binning scheme */
+    static uint32_t FirstBin(unsigned const level) {
+        return ((1u << (3 * level)) - 1) / 7;
+    }
+    /* CopyWhereEndsAfter
+     *  copy the chunks that end after minpos
+     */
+    static void CopyWhereEndsAfter(BAMFileChunkList &dst,
+                                   BAMFileChunk const *const src,
+                                   BAMFileChunk const *const endp,
+                                   BAMFilePosType const minpos)
+    {
+        for (BAMFileChunk const *cur = src; cur != endp; ++cur) {
+            if (minpos < cur->end)
+                dst.push_back(*cur);
         }
-        else {
-            for (unsigned i = 0; i < src.size(); ++i)
-                dst.push_back(src[i]);
+    }
+    /* CopyBins
+     *  copy the chunks of all bins with ids in [first, last]
+     */
+    void CopyBins(BAMFileChunkList &dst, uint32_t const first, uint32_t const last,
+                  BAMFilePosType const minpos) const
+    {
+        Bin const *i = std::lower_bound(bins.begin(), bins.end(), first, LessBinId);
+        
+        for ( ; i != bins.end() && i->id <= last; ++i) {
+            uint32_t const end = (i + 1) != bins.end() ? (i + 1)->first : (uint32_t)chunks.size();
+            
+            CopyWhereEndsAfter(dst, &chunks[0] + i->first, &chunks[0] + end, minpos);
+        }
+    }
+    /* Merge
+     *  sort the chunks and merge those that overlap or that meet
+     *  in the same BGZF block; reading through is cheaper than seeking
+     */
+    static void Merge(BAMFileChunkList &list)
+    {
+        if (list.empty())
+            return;
+        
+        std::sort(list.begin(), list.end());
+        
+        BAMFileChunkList::iterator out = list.begin();
+        for (BAMFileChunkList::const_iterator i = list.begin() + 1; i != list.end(); ++i) {
+            if (i->beg.fpos() <= out->end.fpos()) {
+                if (out->end < i->end)
+                    out->end = i->end;
+            }
+            else
+                *++out = *i;
         }
+        list.erase(out + 1, list.end());
     }
 public:
     char const *LoadIndexIntervals(char const *data, char const *const endp)
@@ -67,17 +163,13 @@ public:
         if (next > endp)
             throw std::runtime_error("insufficient data to load index intervals");
 
-        BAMFilePosType last(0);
-        
-        interval.resize(n);
+        ownInterval.resize(n);
         for (unsigned i = 0; i < n; ++i) {
-            BAMFilePosType const intvl = LE2Host<BAMFilePosType>(data); data += 8;
-            
-            interval[i] = (intvl == last) ? BAMFilePosType(0) : intvl;
-            last = intvl;
+            ownInterval[i] = LE2Host<BAMFilePosType>(data); data += 8;
         }
-        while (interval.size() > 0 && !interval.back().hasValue())
-            interval.pop_back();
+        while (ownInterval.size() > 0 && !ownInterval.back().hasValue())
+            ownInterval.pop_back();
+        interval = IndexArray<BAMFilePosType>(ownInterval);
         
         return next;
     }
@@ -87,88 +179,361 @@ public:
             throw std::runtime_error("insufficient data to load index bin count");
         int32_t const n_bin = LE2Host<int32_t>(data); data += 4;
         
-        bins.resize(MAX_BIN);
+        uint32_t const max_bin = FirstBin(format.depth + 1);
+        uint32_t const pseudo_bin = max_bin + 1;
+        unsigned const bin_header = format.csi ? 16 : 8;
+        std::vector<LoadedChunk> loaded;
+        
         for (int i = 0; i < n_bin; ++i) {
-            if (data + 8 > endp)
+            if (data + bin_header > endp)
                 throw std::runtime_error("insufficient data to load index bin size");
             
-            uint32_t const bin     = LE2Host<uint32_t>(data + 0);
-             int32_t const n_chunk = LE2Host< int32_t>(data + 4);
+            LoadedChunk entry;
+            
+            entry.bin = LE2Host<uint32_t>(data + 0);
+            if (format.csi)
+                entry.loffset = LE2Host<BAMFilePosType>(data + 4);
+            int32_t const n_chunk = LE2Host< int32_t>(data + bin_header - 4);
 
-            data += 8;
+            data += bin_header;
             if (data + n_chunk * 16 > endp)
                 throw std::runtime_error("insufficient data to load index bin chunks");
             
-            if (bin == MAX_BIN && n_chunk == 2) {
+            if (entry.bin == pseudo_bin && n_chunk == 2) {
                 // special doodad
                 off_beg    = LE2Host<BAMFilePosType>(data); data += 8;
                 off_end    = LE2Host<BAMFilePosType>(data); data += 8;
                 n_mapped   = LE2Host<uint64_t>(data); data += 8;
                 n_unmapped = LE2Host<uint64_t>(data); data += 8;
+                has_counts = true;
             }
-            else if (bin < MAX_BIN) {
-                BAMFilePosTypeList &this_bin = bins[bin];
-                
-                this_bin.resize(n_chunk);
-                
+            else if (entry.bin < max_bin) {
                 for (unsigned k = 0; k < n_chunk; ++k) {
                     BAMFilePosType const beg = LE2Host<BAMFilePosType>(data); data += 8;
                     BAMFilePosType const end = LE2Host<BAMFilePosType>(data); data += 8;
                     
-                    (void)end;
-                    this_bin[k] = beg;
+                    entry.chunk = BAMFileChunk(beg, end);
+                    loaded.push_back(entry);
                 }
             }
             else
                 data += 16 * n_chunk;
         }
+        
+        /* bins are not necessarily stored in order */
+        std::stable_sort(loaded.begin(), loaded.end(), LessBin);
+        
+        ownBins.clear();
+        ownChunks.clear();
+        ownChunks.reserve(loaded.size());
+        for (unsigned i = 0; i < loaded.size(); ++i) {
+            if (i == 0 || loaded[i].bin != loaded[i - 1].bin) {
+                Bin const bin = { loaded[i].bin, (uint32_t)ownChunks.size(), loaded[i].loffset };
+                ownBins.push_back(bin);
+            }
+            ownChunks.push_back(loaded[i].chunk);
+        }
+        bins = IndexArray<Bin>(ownBins);
+        chunks = IndexArray<BAMFileChunk>(ownChunks);
         return data;
     }
-    RefIndex()
+    char const *Load(char const *const data, char const *const endp)
+    {
+        char const *const next = LoadIndexBins(data, endp);
+        
+        /* CSI has no linear index */
+        return format.csi ? next : LoadIndexIntervals(next, endp);
+    }
+    /* Measure
+     *  the size of one reference's index data, without loading it
+     *  also picks up the counts from the pseudo-bin, if there is one
+     */
+    static size_t Measure(char const *const data, char const *const endp, IndexFormat const &format,
+                          uint64_t &n_mapped, uint64_t &n_unmapped, bool &has_counts)
+    {
+        char const *cur = data;
+        unsigned const bin_header = format.csi ? 16 : 8;
+        uint32_t const pseudo_bin = FirstBin(format.depth + 1) + 1;
+        
+        if (cur + 4 > endp)
+            throw std::runtime_error("insufficient data to load index bin count");
+        int32_t const n_bin = LE2Host<int32_t>(cur); cur += 4;
+        
+        for (int i = 0; i < n_bin; ++i) {
+            if (cur + bin_header > endp)
+                throw std::runtime_error("insufficient data to load index bin size");
+            int32_t const n_chunk = LE2Host<int32_t>(cur + bin_header - 4);
+            
+            if (LE2Host<uint32_t>(cur) == pseudo_bin && n_chunk == 2 && cur + bin_header + 32 <= endp) {
+                n_mapped   = LE2Host<uint64_t>(cur + bin_header + 16);
+                n_unmapped = LE2Host<uint64_t>(cur + bin_header + 24);
+                has_counts = true;
+            }
+            cur += bin_header;
+            if (n_chunk < 0 || cur + n_chunk * 16 > endp)
+                throw std::runtime_error("insufficient data to load index bin chunks");
+            cur += 16 * n_chunk;
+        }
+        if (format.csi)
+            return cur - data;
+        
+        if (cur + 4 > endp)
+            throw std::runtime_error("insufficient data to load index interval count");
+        int32_t const n_intv = LE2Host<int32_t>(cur); cur += 4;
+        
+        if (n_intv < 0 || cur + 8 * n_intv > endp)
+            throw std::runtime_error("insufficient data to load index intervals");
+        cur += 8 * n_intv;
+        
+        return cur - data;
+    }
+    RefIndex(IndexFormat const &Format)
+    : format(Format)
+    , n_mapped(0)
+    , n_unmapped(0)
+    , has_counts(false)
+    {}
+    /* a view of one reference of a flattened index, see FlatRefIndex */
+    RefIndex(IndexFormat const &Format, FlatRefIndex const &flat, char const *const base)
+    : format(Format)
+    , off_beg(flat.off_beg)
+    , off_end(flat.off_end)
+    , n_mapped(flat.n_mapped)
+    , n_unmapped(flat.n_unmapped)
+    , has_counts(flat.has_counts != 0)
+    , interval(reinterpret_cast<BAMFilePosType const *>(base + flat.interval), (size_t)flat.n_interval)
+    , bins(reinterpret_cast<Bin const *>(base + flat.bins), (size_t)flat.n_bins)
+    , chunks(reinterpret_cast<BAMFileChunk const *>(base + flat.chunks), (size_t)flat.n_chunks)
     {}
-    BAMFilePosTypeList slice(unsigned const beg, unsigned const end) const
+    /* Footprint
+     *  the bytes it holds, not those of a mapping it views
+     */
+    size_t Footprint() const {
+        return sizeof(*this) + ownInterval.capacity() * sizeof(BAMFilePosType) +
+               ownBins.capacity() * sizeof(Bin) + ownChunks.capacity() * sizeof(BAMFileChunk);
+    }
+    /* MinPos
+     *  no alignment overlapping beg starts before the returned position
+     */
+    BAMFilePosType MinPos(unsigned const beg) const
     {
-        unsigned const first[] = { 1, 9, 73, 585, 4681 };
-        unsigned const cnt = end - 1 - beg;
-        unsigned const maxintvl = (end >> 14) + 1;
-        BAMFilePosType const maxpos = maxintvl < interval.size() ? interval[maxintvl] : off_end;
-        unsigned int_beg[5], int_cnt[5];
-        BAMFilePosTypeList rslt;
-        
-        for (unsigned i = 0; i < 5; ++i) {
-            unsigned const shift = 14 + 3 * (4 - i);
+        if (!format.csi) {
+            unsigned const intvl = beg >> format.min_shift;
             
-            int_beg[i] = (beg >> shift);
+            return intvl < interval.size() ? interval[intvl]
+                 : interval.size() > 0 ? interval.back() : BAMFilePosType(0);
         }
-        for (unsigned i = 0; i < 5; ++i) {
-            unsigned const shift = 14 + 3 * (4 - i);
+        /* use the smallest bin containing beg that has any alignments */
+        for (int level = format.depth; level >= 0; --level) {
+            unsigned const shift = format.min_shift + 3 * (format.depth - level);
+            uint32_t const id = FirstBin(level) + (uint32_t)((uint64_t)beg >> shift);
+            Bin const *const i = std::lower_bound(bins.begin(), bins.end(), id, LessBinId);
             
-            int_cnt[i] = (cnt >> shift) + 1;
+            if (i != bins.end() && i->id == id)
+                return i->loffset;
+        }
+        return BAMFilePosType(0);
+    }
+    /* RecordStarts
+     *  adds the start of every chunk, each one the position of a record,
+     *  to dst and sets extent to the span of all the chunks
+     *  returns false if there are no chunks
+     */
+    bool RecordStarts(BAMFilePosTypeList &dst, BAMFileChunk &extent) const
+    {
+        if (chunks.empty())
+            return false;
+        
+        extent = chunks[0];
+        for (BAMFileChunk const *i = chunks.begin(); i != chunks.end(); ++i) {
+            dst.push_back(i->beg);
+            if (i->beg < extent.beg)
+                extent.beg = i->beg;
+            if (extent.end < i->end)
+                extent.end = i->end;
+        }
+        return true;
+    }
+    /* Extent
+     *  from the pseudo-bin if there is one, else from the chunks
+     */
+    bool Extent(BAMFileChunk &extent) const
+    {
+        if (has_counts && off_end.hasValue()) {
+            extent = BAMFileChunk(off_beg, off_end);
+            return true;
+        }
+        if (chunks.empty())
+            return false;
+        
+        extent = chunks[0];
+        for (BAMFileChunk const *i = chunks.begin(); i != chunks.end(); ++i) {
+            if (i->beg < extent.beg)
+                extent.beg = i->beg;
+            if (extent.end < i->end)
+                extent.end = i->end;
+        }
+        return true;
+    }
+    /* ChunkBytes
+     *  the compressed bytes a chunk spans; one inside a single block is
+     *  taken as its share of the block, deflated at a ratio typical of BAM
+     *  an index built while reading ends the file's last chunk at ~0,
+     *  which is taken as the end of the last block any other chunk was
+     *  seen to end in, "last"
+     */
+    static double ChunkBytes(BAMFileChunk const &chunk, uint64_t const last)
+    {
+        uint64_t const beg = chunk.beg.fpos();
+        uint64_t const end = chunk.end.getValue() == ~(uint64_t)0 ? std::max(beg, last) : chunk.end.fpos();
+        
+        if (beg < end)
+            return (double)(end - beg);
+        return chunk.beg.bpos() < chunk.end.bpos() ? (chunk.end.bpos() - chunk.beg.bpos()) / typicalRatio : 0.0;
+    }
+    /* LastEnd
+     *  the file position of the last block any chunk is known to end in
+     */
+    uint64_t LastEnd() const
+    {
+        uint64_t last = 0;
+        
+        for (size_t k = 0; k < chunks.size(); ++k) {
+            if (chunks[k].end.getValue() != ~(uint64_t)0 && chunks[k].end.fpos() > last)
+                last = chunks[k].end.fpos();
         }
-        CopyWhereLess(rslt, bins[0], maxpos);
-        for (unsigned i = 0; i < 5; ++i) {
-            unsigned const beg = int_beg[i] + first[i];
-            unsigned const N = int_cnt[i];
+        return last;
+    }
+    /* Bytes
+     *  about how many compressed bytes hold the records that overlap
+     *  [beg, end) of a reference of "length": every bin's chunks that
+     *  overlap it, in proportion to how much of the bin's extent on the
+     *  reference, clipped to its length, is in it
+     */
+    double Bytes(unsigned const beg, unsigned const end, unsigned const length) const
+    {
+        uint64_t const last = LastEnd();
+        double bytes = 0;
+        
+        for (int level = 0; level <= format.depth; ++level) {
+            unsigned const shift = format.min_shift + 3 * (format.depth - level);
+            uint32_t const first = FirstBin(level);
+            uint32_t const last_bin = first + (uint32_t)((uint64_t)(end - 1) >> shift);
+            Bin const *i = std::lower_bound(bins.begin(), bins.end(), first + (uint32_t)((uint64_t)beg >> shift), LessBinId);
             
-            for (unsigned j = 0; j < N; ++j) {
-                CopyWhereLess(rslt, bins[beg + j], maxpos);
+            for ( ; i != bins.end() && i->id <= last_bin; ++i) {
+                uint64_t const bin_beg = (uint64_t)(i->id - first) << shift;
+                uint64_t const bin_end = std::min(bin_beg + ((uint64_t)1 << shift), (uint64_t)std::max(length, end));
+                uint64_t const overlap = std::min((uint64_t)end, bin_end) - std::max((uint64_t)beg, bin_beg);
+                uint32_t const chunks_end = (i + 1) != bins.end() ? (i + 1)->first : (uint32_t)chunks.size();
+                double held = 0;
+                
+                for (uint32_t k = i->first; k < chunks_end; ++k)
+                    held += ChunkBytes(chunks[k], last);
+                bytes += held * overlap / (bin_end - bin_beg);
             }
         }
-        std::sort(rslt.begin(), rslt.end());
+        return bytes;
+    }
+    BAMFileChunkList slice(unsigned const beg, unsigned const end) const
+    {
+        BAMFilePosType const minpos = MinPos(beg);
+        BAMFileChunkList rslt;
+        
+        for (int level = 0; level <= format.depth; ++level) {
+            unsigned const shift = format.min_shift + 3 * (format.depth - level);
+            uint32_t const first = FirstBin(level);
+            
+            CopyBins(rslt, first + (uint32_t)((uint64_t)beg >> shift),
+                           first + (uint32_t)((uint64_t)(end - 1) >> shift), minpos);
+        }
+        Merge(rslt);
+        if (!rslt.empty() && rslt.front().beg < minpos)
+            rslt.front().beg = minpos;
         return rslt;
     }
+    /* Explain
+     *  what slice does for [beg, end) and about what reading its result
+     *  costs; the blocks of each range are at least those the index
+     *  knows to start in it, and at least as many as blocks deflated at
+     *  a typical ratio would take for its bytes, each inflating to a
+     *  full block
+     */
+    void Explain(unsigned const beg, unsigned const end, NGS_BAM::SlicePlan &plan) const
+    {
+        BAMFilePosType const minpos = MinPos(beg);
+        BAMFileChunkList selected, kept;
+        
+        for (int level = 0; level <= format.depth; ++level) {
+            unsigned const shift = format.min_shift + 3 * (format.depth - level);
+            uint32_t const first = FirstBin(level);
+            
+            CopyBins(selected, first + (uint32_t)((uint64_t)beg >> shift),
+                               first + (uint32_t)((uint64_t)(end - 1) >> shift), BAMFilePosType(0));
+        }
+        for (BAMFileChunkList::const_iterator i = selected.begin(); i != selected.end(); ++i) {
+            if (minpos < i->end) {
+                NGS_BAM::SliceChunk const chunk = { i->beg.getValue(), i->end.getValue() };
+                plan.chunks.push_back(chunk);
+                kept.push_back(*i);
+            }
+            else
+                ++plan.trimmedChunks;
+        }
+        Merge(kept);
+        plan.trimmed = plan.trimmedChunks != 0;
+        if (!kept.empty() && kept.front().beg < minpos) {
+            kept.front().beg = minpos;
+            plan.trimmed = true;
+        }
+        
+        /* where the index knows blocks to start */
+        std::vector<uint64_t> starts;
+        for (BAMFileChunk const *i = chunks.begin(); i != chunks.end(); ++i) {
+            starts.push_back(i->beg.fpos());
+            if (i->end.getValue() != ~(uint64_t)0)
+                starts.push_back(i->end.fpos());
+        }
+        for (BAMFilePosType const *i = interval.begin(); i != interval.end(); ++i)
+            starts.push_back(i->fpos());
+        std::sort(starts.begin(), starts.end());
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+        
+        uint64_t const last = LastEnd();
+        double const typicalBlock = BAM_BLK_MAX / typicalRatio;
+        
+        for (BAMFileChunkList::const_iterator i = kept.begin(); i != kept.end(); ++i) {
+            NGS_BAM::SliceChunk const range = { i->beg.getValue(), i->end.getValue() };
+            bool const open = i->end.getValue() == ~(uint64_t)0;
+            uint64_t const first = i->beg.fpos();
+            uint64_t const lastBlock = open ? std::max(first, last) : i->end.fpos();
+            bool const intoLast = open || i->end.bpos() != 0 || lastBlock == first;
+            uint64_t const known = (std::lower_bound(starts.begin(), starts.end(), lastBlock) -
+                                    std::lower_bound(starts.begin(), starts.end(), first)) + (intoLast ? 1 : 0);
+            uint64_t const sized = (uint64_t)((lastBlock - first) / typicalBlock + 0.5) + (intoLast ? 1 : 0);
+            uint64_t const blocks = std::max<uint64_t>(1, std::max(known, sized));
+            
+            plan.ranges.push_back(range);
+            plan.compressedBytes += (uint64_t)(ChunkBytes(*i, last) + 0.5);
+            plan.blocks += blocks;
+            plan.inflatedBytes += blocks * BGZF_BLK_DATA;
+        }
+    }
 };
 
-size_t HeaderRefInfo::LoadIndex(char const data[], char const *const endp)
+size_t HeaderRefInfo::LoadIndex(char const data[], char const *const endp, IndexFormat const &format)
 {
-    RefIndex *i = new RefIndex();
+    RefIndex *i = new RefIndex(format);
     try {
-        char const *const next1 = i->LoadIndexBins(data, endp);
-        char const *const next2 = i->LoadIndexIntervals(next1, endp);
+        char const *const next = i->Load(data, endp);
         
         index = i;
+        has_counts = i->has_counts;
+        n_mapped = i->n_mapped;
+        n_unmapped = i->n_unmapped;
+        memory->Add(MemoryLedger::index, i->Footprint());
         
-        return next2 - data;
+        return next - data;
     }
     catch (...) {
         delete i;
@@ -176,514 +541,2958 @@ size_t HeaderRefInfo::LoadIndex(char const data[], char const *const endp)
     }
 }
 
+size_t HeaderRefInfo::DeferIndex(char const data[], char const *const endp, IndexFormat const &format, pthread_mutex_t *const lock)
+{
+    size_t const size = RefIndex::Measure(data, endp, format, n_mapped, n_unmapped, has_counts);
+    
+    index_data = data;
+    index_size = size;
+    index_format = format;
+    index_lock = lock;
+    
+    return size;
+}
+
 void HeaderRefInfo::DropIndex()
 {
     if (index) {
+        memory->Remove(MemoryLedger::index, index->Footprint());
         delete index;
         index = 0;
     }
+    index_data = 0;
+    index_size = 0;
+    has_counts = false;
 }
 
-BAMFilePosTypeList HeaderRefInfo::slice(unsigned const beg, unsigned const end) const {
-    return index ? index->slice(beg, end) : BAMFilePosTypeList();
+void HeaderRefInfo::MapIndex(IndexFormat const &format, FlatRefIndex const &flat, char const *const base)
+{
+    DropIndex();
+    if (!flat.has_index)
+        return;
+    index = new RefIndex(format, flat, base);
+    memory->Add(MemoryLedger::index, index->Footprint());
+    has_counts = flat.has_counts != 0;
+    n_mapped = flat.n_mapped;
+    n_unmapped = flat.n_unmapped;
 }
 
-void BAMFile::DumpSAM(std::ostream &oss, BAMRecord const &rec) const
+RefIndex const *HeaderRefInfo::getIndex() const
 {
-    unsigned const seqlen   = rec.l_seq();
-    std::string const RNAME = rec.isSelfMapped() ? getRefInfo(rec.refID()).getName() : "*";
-    std::string const RNEXT = rec.isMateMapped() ? getRefInfo(rec.next_refID()).getName() : "*";
-    int const POS   		= rec.isSelfMapped() ? (rec.pos() + 1) : 0;
-    int const PNEXT 		= rec.isMateMapped() ? (rec.next_pos() + 1) : 0;
-
-    oss	        << rec.readname()
- 		<< '\t' << rec.flag()
-    	<< '\t' << RNAME
-    	<< '\t' << POS
-        << '\t' << int(rec.mq())
-    	<< '\t';
-    
-    if (rec.isSelfMapped()) {
-        unsigned const N = rec.nc();
-        
-        for (unsigned i = 0; i < N; ++i) {
-            uint32_t const cv = rec.cigar(i);
-            int const op = cv & 0x0F;
-            int len = cv >> 4;
-            char buf[16];
-            char *cur = buf + sizeof(buf);
-            
-            *--cur = '\0';
-            *--cur = "MIDNSHP=X???????"[op];
-            do {
-                int const digit = len % 10;
-                
-                *--cur = digit + '0';
-                len /= 10;
-            } while (len > 0);
-            oss << cur;
-        }
-    }
-    else
-        oss << '*';
-    
-	oss	<< '\t' << RNEXT
-    	<< '\t' << PNEXT
-        << '\t' << rec.tlen()
-    	<< '\t';
-    
-    if (seqlen > 0) {
-        for (int i = 0; i < seqlen; ++i)
-            oss << rec.seq(i);
-        oss << '\t';
-        
-        bool allFF = true;
-        uint8_t const *const q = rec.qual();
-        for (unsigned i = 0; i < seqlen; ++i) {
-            uint8_t const qv = q[i];
-            
-            if (qv != 0xFF) {
-                allFF = false;
-                break;
+    AwaitIndex();
+    if (index_data == 0)
+        return index;
+    
+    pthread_mutex_lock(index_lock);
+    try {
+        if (index == 0) {
+            RefIndex *i = new RefIndex(index_format);
+            try {
+                i->Load(index_data, index_data + index_size);
             }
-        }
-        if (allFF)
-            oss << '*';
-        else {
-            for (unsigned i = 0; i < seqlen; ++i) {
-                uint8_t const qv = q[i];
-                int const offset = ((int)qv) + '!';
-                int const out = offset < '~' ? offset : '~';
-                
-                oss << char(out);
+            catch (...) {
+                delete i;
+                throw;
             }
+            memory->Add(MemoryLedger::index, i->Footprint());
+            index = i;
         }
     }
-    else
-        oss << "*\t*";
-    
-    for (BAMRecord::OptionalField::const_iterator i = rec.begin(); i != rec.end(); ++i) {
-        std::string const tag = std::string(i->getTag(), 2);
-        int const elems = i->getElementCount();
-        char const type = i->getValueType();
-        char const *raw = i->getRawValue();
-        
-        oss << '\t' << tag << ':' << (elems == 1 ? type : 'B') << ':';
-        if (type == 'Z' || type == 'H')
-            oss << raw;
-        else {
-            if (elems > 1)
-                oss << type;
-            for (int j = 0; j < elems; ++j) {
-                if (elems > 1)
-                    oss << ',';
-                switch (type) {
-                    case 'A':
-                        oss << *raw;
-                        ++raw;
-                        break;
-                    case 'C':
-                        oss << unsigned(*((uint8_t const *)raw));
-                        ++raw;
-                        break;
-                    case 'c':
-                        oss << int(*((int8_t const *)raw));
-                        ++raw;
-                        break;
-                    case 'S':
-                        oss << unsigned(LE2Host<uint16_t>(raw));
-                        raw += 2;
-                        break;
-                    case 's':
-                        oss << int(LE2Host<int16_t>(raw));
-                        raw += 2;
-                        break;
-                    case 'F':
-                        oss << float(LE2Host<float>(raw));
-                        raw += 4;
-                        break;
-                    case 'I':
-                        oss << unsigned(LE2Host<uint32_t>(raw));
-                        raw += 4;
-                        break;
-                    case 'i':
-                        oss << int(LE2Host<int32_t>(raw));
-                        raw += 4;
-                        break;
-                }
-            }
-        }
+    catch (...) {
+        pthread_mutex_unlock(index_lock);
+        throw;
     }
+    pthread_mutex_unlock(index_lock);
+    return index;
 }
 
-unsigned BAMFile::FillBuffer(int const n) {
-    size_t const nwant = n * IO_BLK_SIZE;
-    char *const dst = (char *)(iobuffer + 2 * IO_BLK_SIZE - nwant);
-#if USE_STDIO
-    size_t const nread = feof(file) ? 0 : fread(dst, 1, nwant, file);
-#else
-    size_t const nread = file.eof() ? 0 : file.read(dst, nwant).gcount();
-    
-    if (nread == 0 && !file.eof())
-        throw std::runtime_error("read failed");
-#endif
-    return (unsigned)nread;
+BAMFileChunkList HeaderRefInfo::slice(unsigned const beg, unsigned const end) const {
+    TRACE_SPAN("RefIndex::slice");
+    RefIndex const *const i = getIndex();
+    return i ? i->slice(beg, end) : BAMFileChunkList();
 }
 
-void BAMFile::ReadZlib(void) {
-    zs.next_out  = bambuffer;
-    zs.avail_out = sizeof(bambuffer);
-    zs.total_out = 0;
-    bam_cur      = 0;
+BAMFilePosType HeaderRefInfo::minPos(unsigned const beg) const {
+    RefIndex const *const i = getIndex();
+    return i ? i->MinPos(beg) : BAMFilePosType(0);
+}
+
+bool HeaderRefInfo::getRecordStarts(BAMFilePosTypeList &starts, BAMFileChunk &extent) const {
+    RefIndex const *const i = getIndex();
+    return i && i->RecordStarts(starts, extent);
+}
+
+bool HeaderRefInfo::getExtent(BAMFileChunk &extent) const {
+    RefIndex const *const i = getIndex();
+    return i && i->Extent(extent);
+}
+
+bool HeaderRefInfo::explain(unsigned const beg, unsigned const end, NGS_BAM::SlicePlan &plan) const {
+    RefIndex const *const i = getIndex();
+    if (i == 0)
+        return false;
+    if (beg < end)
+        i->Explain(beg, end, plan);
+    return true;
+}
+
+bool HeaderRefInfo::estimate(unsigned const beg, unsigned const end, uint64_t &alignments, uint64_t &bytes) const {
+    RefIndex const *const i = getIndex();
+    if (i == 0 || (!has_counts && !i->chunks.empty()))
+        return false;
     
-    if (zs.avail_in == 0) {
-    FILL_BUFFER:
-#if USE_STDIO
-        cpos = ftell(file);
-#else
-        cpos = file.tellg();
-#endif
-        zs.avail_in = FillBuffer(2);
-        zs.next_in  = iobuffer;
-        if (zs.avail_in == 0) /* EOF */
-            return;
-    }
+    /* no chunks, no records, whether or not it was counted */
+    alignments = bytes = 0;
+    if (beg >= end || n_mapped == 0 || i->chunks.empty())
+        return true;
     
-    bpos = cpos + (zs.next_in - iobuffer);
-    int const zrc = inflate(&zs, Z_FINISH);
+    if (beg == 0 && end >= length) {
+        alignments = n_mapped;
+        bytes = (uint64_t)(i->Bytes(0, length, length) + 0.5);
+        return true;
+    }
+    double const all = i->Bytes(0, length, length);
+    double const some = i->Bytes(beg, end, length);
     
-    if (zrc == Z_STREAM_END) {
-        /* inflateReset clobbers these value but we want them */
-        uLong const total_out = zs.total_out;
-        uLong const total_in  = zs.total_in;
-        
-        int const zrc = inflateReset(&zs);
-        if (zrc != Z_OK)
-            throw std::logic_error("inflateReset didn't return Z_OK");
-        
-        zs.total_out = total_out;
-        zs.total_in  = total_in;
+    bytes = (uint64_t)(some + 0.5);
+    alignments = all > 0 ? std::min(n_mapped, (uint64_t)(n_mapped * (some / all) + 0.5)) : 0;
+    return true;
+}
 
-#if 0
-        std::cerr << std::dec << "total_in: " << total_in << "; avail_in: " << zs.avail_in << "; IO_BLK_SIZE: " << IO_BLK_SIZE << std::endl;
-#endif
-        
-        if (total_in >= IO_BLK_SIZE && total_in + zs.avail_in == 2 * IO_BLK_SIZE)
-        {
-            memcpy(iobuffer, &iobuffer[sizeof(iobuffer)/2], sizeof(iobuffer)/2);
-            cpos += sizeof(iobuffer)/2;
-            zs.next_in  -= sizeof(iobuffer)/2;
-            zs.avail_in += FillBuffer(1);
+/* the 4-bit base codes; SEQ packs two per byte, the first in the high nibble */
+static char const seqCodes[] = "=ACMGRSVTWYHKDBN";
+
+/* both bases of every possible SEQ byte */
+static struct SeqPairs {
+    char pair[256][2];
+
+    SeqPairs() {
+        for (unsigned i = 0; i < 256; ++i) {
+            pair[i][0] = seqCodes[i >> 4];
+            pair[i][1] = seqCodes[i & 15];
         }
-        
-        return;
     }
-    if (zrc != Z_OK && zrc != Z_BUF_ERROR)
-        throw std::runtime_error("decompression failed");
-    
-    if (zs.avail_in == 0)
-        goto FILL_BUFFER;
-    
-    throw std::runtime_error("zs.avail_in != 0");
-}
+} const seqPairs;
 
-size_t BAMFile::ReadN(size_t N, void *Dst) {
-    uint8_t *const dst = reinterpret_cast<uint8_t *>(Dst);
-    size_t n = 0;
-    
-    while (n < N) {
-        size_t const avail_out = N - n;
-        size_t const avail_in = zs.total_out - bam_cur;
-        
-        if (avail_in) {
-            size_t const copy = avail_out < avail_in ? avail_out : avail_in;
-            
-            memcpy(dst + n, bambuffer + bam_cur, copy);
-            bam_cur += copy;
-            if (bam_cur == zs.total_out)
-                bam_cur = zs.total_out = 0;
-            
-            n += copy;
-            if (n == N)
-                break;
+/* the complement of each code */
+static char const seqComplements[] = "=TGKCYSBAWRDMHVN";
+
+/* the complements of both bases of every SEQ byte, the low one first */
+static struct SeqReversePairs {
+    char pair[256][2];
+
+    SeqReversePairs() {
+        for (unsigned i = 0; i < 256; ++i) {
+            pair[i][0] = seqComplements[i & 15];
+            pair[i][1] = seqComplements[i >> 4];
         }
-        ReadZlib();
-        if (zs.total_out == 0)
-            break;
     }
-    return n;
+} const seqReversePairs;
+
+/* the kernels below each have a plain version, with NEON where built
+ * for aarch64, and with CPU_DISPATCH some for x86 vector instructions;
+ * which one runs is picked at load, by seqKernels further down
+ * a vector step takes as many whole vectors as there are and leaves
+ * the rest to the next step, the last one a byte at a time */
+
+static inline void DecodeSeqTail(char *dst, uint8_t const *src, unsigned count)
+{
+    for ( ; count > 0; --count, ++src, dst += 2) {
+        dst[0] = seqPairs.pair[*src][0];
+        dst[1] = seqPairs.pair[*src][1];
+    }
 }
 
-size_t BAMFile::SkipN(size_t N) {
-    size_t n = 0;
-    
-    while (n < N) {
-        size_t const avail_out = N - n;
-        size_t const avail_in = zs.total_out - bam_cur;
+static inline void DecodeSeqReverseTail(char *dst, uint8_t const *end, unsigned count)
+{
+    for ( ; count > 0; --count, dst += 2) {
+        uint8_t const b = *--end;
         
-        if (avail_in) {
-            size_t const copy = avail_out < avail_in ? avail_out : avail_in;
-            
-            bam_cur += copy;
-            n += copy;
-            if (n == N)
-                break;
-        }
-        ReadZlib();
-        if (zs.total_out == 0)
-            break;
+        dst[0] = seqReversePairs.pair[b][0];
+        dst[1] = seqReversePairs.pair[b][1];
     }
-    return n;
 }
 
-void BAMFile::Seek(size_t const new_bpos, unsigned const new_bam_cur) {
-    unsigned const c_offset = new_bpos % IO_BLK_SIZE;
-    size_t const new_cpos = new_bpos - c_offset;
-    
-#if 0
-    std::cerr << "seek to " << std::hex << new_bpos << "|" << new_bam_cur << std::endl;
-#endif
+/* DecodeSeqBytes
+ *  expand "count" SEQ bytes into 2 * count bases
+ *  the vector kernels look up 16 nibbles at a time with a byte shuffle
+ *  and interleave the high and low base of each byte
+ */
+static void DecodeSeqBytesPlain(char *dst, uint8_t const *src, unsigned count)
+{
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t const table = vld1q_u8((uint8_t const *)seqCodes);
+    uint8x16_t const mask = vdupq_n_u8(0x0F);
     
-#if USE_STDIO
-    if (fseek(file, new_cpos, SEEK_SET))
-        throw std::runtime_error("position is invalid");
-    cpos = ftell(file);
-#else
-    file.seekg(new_cpos);
-    cpos = file.tellg();
-#endif
-    zs.avail_in = FillBuffer(2);
-    if (zs.avail_in > c_offset) {
-        zs.avail_in -= c_offset;
-        zs.next_in = iobuffer + c_offset;
-        ReadZlib();
-        if (zs.total_out > new_bam_cur) {
-            bam_cur = new_bam_cur;
-            return;
-        }
+    for ( ; count >= 16; count -= 16, src += 16, dst += 32) {
+        uint8x16_t const v = vld1q_u8(src);
+        uint8x16x2_t bases;
+        
+        bases.val[0] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+        bases.val[1] = vqtbl1q_u8(table, vandq_u8(v, mask));
+        vst2q_u8((uint8_t *)dst, bases);
     }
-    throw std::runtime_error("position is invalid");
+#endif
+    DecodeSeqTail(dst, src, count);
 }
 
-template <typename T>
-bool BAMFile::Read(size_t count, T *dst) {
-    size_t const nwant = count * sizeof(T);
-    size_t const nread = ReadN(nwant, reinterpret_cast<void *>(dst));
+#if CPU_DISPATCH
+CPU_TARGET("ssse3")
+static inline void DecodeSeq16(char *&dst, uint8_t const *&src, unsigned &count)
+{
+    __m128i const table = _mm_loadu_si128((__m128i const *)seqCodes);
+    __m128i const mask = _mm_set1_epi8(0x0F);
     
-    return nwant == nread;
+    for ( ; count >= 16; count -= 16, src += 16, dst += 32) {
+        __m128i const v = _mm_loadu_si128((__m128i const *)src);
+        __m128i const hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i const lo = _mm_shuffle_epi8(table, _mm_and_si128(v, mask));
+        
+        _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi8(hi, lo));
+    }
 }
 
-int32_t BAMFile::ReadI32() {
-    int32_t value;
+CPU_TARGET("avx2")
+static inline void DecodeSeq32(char *&dst, uint8_t const *&src, unsigned &count)
+{
+    __m256i const table = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)seqCodes));
+    __m256i const mask = _mm256_set1_epi8(0x0F);
     
-    if (Read(1, &value))
-        return LE2Host<int32_t>(&value);
-    throw std::runtime_error("insufficient data while reading bam file");
+    for ( ; count >= 32; count -= 32, src += 32, dst += 64) {
+        __m256i const v = _mm256_loadu_si256((__m256i const *)src);
+        __m256i const hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i const lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, mask));
+        /* unpack works within 128 bit lanes, so put the lanes back in order */
+        __m256i const a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i const b = _mm256_unpackhi_epi8(hi, lo);
+        
+        _mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
 }
 
-bool BAMFile::ReadI32(int32_t &rslt) {
-    int32_t value;
+CPU_TARGET("avx512f,avx512bw")
+static inline void DecodeSeq64(char *&dst, uint8_t const *&src, unsigned &count)
+{
+    __m512i const table = _mm512_broadcast_i32x4(_mm_loadu_si128((__m128i const *)seqCodes));
+    __m512i const mask = _mm512_set1_epi8(0x0F);
+    /* the 64 bit halves of each lane of a and b, in the order they go out */
+    __m512i const first = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    __m512i const second = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
     
-    if (Read(1, &value)) {
-        rslt = LE2Host<int32_t>(&value);
-        return true;
+    for ( ; count >= 64; count -= 64, src += 64, dst += 128) {
+        __m512i const v = _mm512_loadu_si512(src);
+        __m512i const hi = _mm512_shuffle_epi8(table, _mm512_and_si512(_mm512_srli_epi16(v, 4), mask));
+        __m512i const lo = _mm512_shuffle_epi8(table, _mm512_and_si512(v, mask));
+        __m512i const a = _mm512_unpacklo_epi8(hi, lo);
+        __m512i const b = _mm512_unpackhi_epi8(hi, lo);
+        
+        _mm512_storeu_si512(dst, _mm512_permutex2var_epi64(a, first, b));
+        _mm512_storeu_si512(dst + 64, _mm512_permutex2var_epi64(a, second, b));
     }
-    return false;
 }
 
-void BAMFile::InflateInit(void) {
-    memset(&zs, 0, sizeof(zs));
-    
-    int const zrc = inflateInit2(&zs, MAX_WBITS + 16);
-    switch (zrc) {
-        case Z_OK:
-            break;
-        case Z_MEM_ERROR:
-            throw std::bad_alloc();
-            break;
-        case Z_VERSION_ERROR:
-            throw std::runtime_error(std::string("zlib version is not compatible; need version " ZLIB_VERSION " but have ") + zlibVersion());
-            break;
-        case Z_STREAM_ERROR:
-        default:
-            throw std::invalid_argument(zs.msg ? zs.msg : "unknown");
-            break;
-    }
+CPU_TARGET("ssse3")
+static void DecodeSeqBytesSSSE3(char *dst, uint8_t const *src, unsigned count)
+{
+    DecodeSeq16(dst, src, count);
+    DecodeSeqTail(dst, src, count);
 }
 
-void BAMFile::CheckHeaderSignature(void) {
-    static char const sig[] = "BAM\1";
-    char actual[4];
+CPU_TARGET("avx2")
+static void DecodeSeqBytesAVX2(char *dst, uint8_t const *src, unsigned count)
+{
+    DecodeSeq32(dst, src, count);
+    DecodeSeq16(dst, src, count);
+    DecodeSeqTail(dst, src, count);
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static void DecodeSeqBytesAVX512(char *dst, uint8_t const *src, unsigned count)
+{
+    DecodeSeq64(dst, src, count);
+    DecodeSeq32(dst, src, count);
+    DecodeSeq16(dst, src, count);
+    DecodeSeqTail(dst, src, count);
+}
+#endif
+
+/* DecodeSeqBytesReverse
+ *  expand the "count" SEQ bytes before "end" into the reverse complement
+ *  of their 2 * count bases
+ *  the vector kernels reverse the bytes with a shuffle, then look up the
+ *  complements of their nibbles as above, the low one first
+ */
+static void DecodeSeqBytesReversePlain(char *dst, uint8_t const *end, unsigned count)
+{
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t const table = vld1q_u8((uint8_t const *)seqComplements);
+    uint8x16_t const mask = vdupq_n_u8(0x0F);
+    
+    for ( ; count >= 16; count -= 16, end -= 16, dst += 32) {
+        uint8x16_t const r = vrev64q_u8(vld1q_u8(end - 16));
+        uint8x16_t const v = vextq_u8(r, r, 8);
+        uint8x16x2_t bases;
+        
+        bases.val[0] = vqtbl1q_u8(table, vandq_u8(v, mask));
+        bases.val[1] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+        vst2q_u8((uint8_t *)dst, bases);
+    }
+#endif
+    DecodeSeqReverseTail(dst, end, count);
+}
+
+#if CPU_DISPATCH
+CPU_TARGET("ssse3")
+static inline void DecodeSeqReverse16(char *&dst, uint8_t const *&end, unsigned &count)
+{
+    __m128i const table = _mm_loadu_si128((__m128i const *)seqComplements);
+    __m128i const mask = _mm_set1_epi8(0x0F);
+    __m128i const reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    
+    for ( ; count >= 16; count -= 16, end -= 16, dst += 32) {
+        __m128i const v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(end - 16)), reverse);
+        __m128i const hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i const lo = _mm_shuffle_epi8(table, _mm_and_si128(v, mask));
+        
+        _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi8(lo, hi));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi8(lo, hi));
+    }
+}
+
+CPU_TARGET("avx2")
+static inline void DecodeSeqReverse32(char *&dst, uint8_t const *&end, unsigned &count)
+{
+    __m256i const table = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)seqComplements));
+    __m256i const mask = _mm256_set1_epi8(0x0F);
+    __m256i const reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    
+    for ( ; count >= 32; count -= 32, end -= 32, dst += 64) {
+        __m256i const r = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(end - 32)), reverse);
+        /* the shuffle reverses within 128 bit lanes, so swap the lanes too */
+        __m256i const v = _mm256_permute2x128_si256(r, r, 0x01);
+        __m256i const hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i const lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, mask));
+        __m256i const a = _mm256_unpacklo_epi8(lo, hi);
+        __m256i const b = _mm256_unpackhi_epi8(lo, hi);
+        
+        _mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static inline void DecodeSeqReverse64(char *&dst, uint8_t const *&end, unsigned &count)
+{
+    __m512i const table = _mm512_broadcast_i32x4(_mm_loadu_si128((__m128i const *)seqComplements));
+    __m512i const mask = _mm512_set1_epi8(0x0F);
+    __m512i const reverse = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    __m512i const first = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    __m512i const second = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+    
+    for ( ; count >= 64; count -= 64, end -= 64, dst += 128) {
+        __m512i const r = _mm512_shuffle_epi8(_mm512_loadu_si512(end - 64), reverse);
+        /* and the four lanes reversed */
+        __m512i const v = _mm512_shuffle_i64x2(r, r, 0x1B);
+        __m512i const hi = _mm512_shuffle_epi8(table, _mm512_and_si512(_mm512_srli_epi16(v, 4), mask));
+        __m512i const lo = _mm512_shuffle_epi8(table, _mm512_and_si512(v, mask));
+        __m512i const a = _mm512_unpacklo_epi8(lo, hi);
+        __m512i const b = _mm512_unpackhi_epi8(lo, hi);
+        
+        _mm512_storeu_si512(dst, _mm512_permutex2var_epi64(a, first, b));
+        _mm512_storeu_si512(dst + 64, _mm512_permutex2var_epi64(a, second, b));
+    }
+}
+
+CPU_TARGET("ssse3")
+static void DecodeSeqBytesReverseSSSE3(char *dst, uint8_t const *end, unsigned count)
+{
+    DecodeSeqReverse16(dst, end, count);
+    DecodeSeqReverseTail(dst, end, count);
+}
+
+CPU_TARGET("avx2")
+static void DecodeSeqBytesReverseAVX2(char *dst, uint8_t const *end, unsigned count)
+{
+    DecodeSeqReverse32(dst, end, count);
+    DecodeSeqReverse16(dst, end, count);
+    DecodeSeqReverseTail(dst, end, count);
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static void DecodeSeqBytesReverseAVX512(char *dst, uint8_t const *end, unsigned count)
+{
+    DecodeSeqReverse64(dst, end, count);
+    DecodeSeqReverse32(dst, end, count);
+    DecodeSeqReverse16(dst, end, count);
+    DecodeSeqReverseTail(dst, end, count);
+}
+#endif
+
+/* EncodeQual
+ *  the body of BAMRecord::encodeQual
+ *  the vector kernels cap and bias 16 or more qualities at a time and
+ *  note whether any of them is not 0xFF
+ */
+static inline bool EncodeQualTail(char *dst, uint8_t const *src, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = false;
+    
+    for ( ; count > 0; --count, ++src, ++dst) {
+        uint8_t const qv = *src;
+        
+        present |= (qv != 0xFF);
+        *dst = (char)((qv < maxQual ? qv : maxQual) + add);
+    }
+    return present;
+}
+
+static bool EncodeQualPlain(char *dst, uint8_t const *src, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = false;
+    
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t const cap = vdupq_n_u8(maxQual);
+    uint8x16_t const bias = vdupq_n_u8(add);
+    
+    for ( ; count >= 16; count -= 16, src += 16, dst += 16) {
+        uint8x16_t const v = vld1q_u8(src);
+        
+        present |= vminvq_u8(v) != 0xFF;
+        vst1q_u8((uint8_t *)dst, vaddq_u8(vminq_u8(v, cap), bias));
+    }
+#endif
+    return EncodeQualTail(dst, src, count, add, maxQual) || present;
+}
+
+#if CPU_DISPATCH
+CPU_TARGET("sse2")
+static inline bool EncodeQual16(char *&dst, uint8_t const *&src, size_t &count, uint8_t const add, uint8_t const maxQual)
+{
+    __m128i const all = _mm_set1_epi8((char)0xFF);
+    __m128i const cap = _mm_set1_epi8((char)maxQual);
+    __m128i const bias = _mm_set1_epi8((char)add);
+    bool present = false;
+    
+    for ( ; count >= 16; count -= 16, src += 16, dst += 16) {
+        __m128i const v = _mm_loadu_si128((__m128i const *)src);
+        
+        present |= _mm_movemask_epi8(_mm_cmpeq_epi8(v, all)) != 0xFFFF;
+        _mm_storeu_si128((__m128i *)dst, _mm_add_epi8(_mm_min_epu8(v, cap), bias));
+    }
+    return present;
+}
+
+CPU_TARGET("avx2")
+static inline bool EncodeQual32(char *&dst, uint8_t const *&src, size_t &count, uint8_t const add, uint8_t const maxQual)
+{
+    __m256i const all = _mm256_set1_epi8((char)0xFF);
+    __m256i const cap = _mm256_set1_epi8((char)maxQual);
+    __m256i const bias = _mm256_set1_epi8((char)add);
+    bool present = false;
+    
+    for ( ; count >= 32; count -= 32, src += 32, dst += 32) {
+        __m256i const v = _mm256_loadu_si256((__m256i const *)src);
+        
+        present |= (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, all)) != 0xFFFFFFFFu;
+        _mm256_storeu_si256((__m256i *)dst, _mm256_add_epi8(_mm256_min_epu8(v, cap), bias));
+    }
+    return present;
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static inline bool EncodeQual64(char *&dst, uint8_t const *&src, size_t &count, uint8_t const add, uint8_t const maxQual)
+{
+    __m512i const all = _mm512_set1_epi8((char)0xFF);
+    __m512i const cap = _mm512_set1_epi8((char)maxQual);
+    __m512i const bias = _mm512_set1_epi8((char)add);
+    bool present = false;
+    
+    for ( ; count >= 64; count -= 64, src += 64, dst += 64) {
+        __m512i const v = _mm512_loadu_si512(src);
+        
+        present |= _mm512_cmpneq_epi8_mask(v, all) != 0;
+        _mm512_storeu_si512(dst, _mm512_add_epi8(_mm512_min_epu8(v, cap), bias));
+    }
+    return present;
+}
+
+CPU_TARGET("sse2")
+static bool EncodeQualSSE2(char *dst, uint8_t const *src, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool const present = EncodeQual16(dst, src, count, add, maxQual);
+    return EncodeQualTail(dst, src, count, add, maxQual) || present;
+}
+
+CPU_TARGET("avx2")
+static bool EncodeQualAVX2(char *dst, uint8_t const *src, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = EncodeQual32(dst, src, count, add, maxQual);
+    present |= EncodeQual16(dst, src, count, add, maxQual);
+    return EncodeQualTail(dst, src, count, add, maxQual) || present;
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static bool EncodeQualAVX512(char *dst, uint8_t const *src, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = EncodeQual64(dst, src, count, add, maxQual);
+    present |= EncodeQual32(dst, src, count, add, maxQual);
+    present |= EncodeQual16(dst, src, count, add, maxQual);
+    return EncodeQualTail(dst, src, count, add, maxQual) || present;
+}
+#endif
+
+/* EncodeQualReverse
+ *  EncodeQual of the "count" qualities before "end", the last one first
+ *  the vector kernels reverse the bytes with a shuffle, as
+ *  DecodeSeqBytesReverse does, then cap and bias them as above
+ */
+static inline bool EncodeQualReverseTail(char *dst, uint8_t const *end, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = false;
+    
+    for ( ; count > 0; --count, ++dst) {
+        uint8_t const qv = *--end;
+        
+        present |= (qv != 0xFF);
+        *dst = (char)((qv < maxQual ? qv : maxQual) + add);
+    }
+    return present;
+}
+
+static bool EncodeQualReversePlain(char *dst, uint8_t const *end, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = false;
+    
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t const cap = vdupq_n_u8(maxQual);
+    uint8x16_t const bias = vdupq_n_u8(add);
+    
+    for ( ; count >= 16; count -= 16, end -= 16, dst += 16) {
+        uint8x16_t const r = vrev64q_u8(vld1q_u8(end - 16));
+        uint8x16_t const v = vextq_u8(r, r, 8);
+        
+        present |= vminvq_u8(v) != 0xFF;
+        vst1q_u8((uint8_t *)dst, vaddq_u8(vminq_u8(v, cap), bias));
+    }
+#endif
+    return EncodeQualReverseTail(dst, end, count, add, maxQual) || present;
+}
+
+#if CPU_DISPATCH
+CPU_TARGET("ssse3")
+static inline bool EncodeQualReverse16(char *&dst, uint8_t const *&end, size_t &count, uint8_t const add, uint8_t const maxQual)
+{
+    __m128i const all = _mm_set1_epi8((char)0xFF);
+    __m128i const cap = _mm_set1_epi8((char)maxQual);
+    __m128i const bias = _mm_set1_epi8((char)add);
+    __m128i const reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    bool present = false;
+    
+    for ( ; count >= 16; count -= 16, end -= 16, dst += 16) {
+        __m128i const v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(end - 16)), reverse);
+        
+        present |= _mm_movemask_epi8(_mm_cmpeq_epi8(v, all)) != 0xFFFF;
+        _mm_storeu_si128((__m128i *)dst, _mm_add_epi8(_mm_min_epu8(v, cap), bias));
+    }
+    return present;
+}
+
+CPU_TARGET("avx2")
+static inline bool EncodeQualReverse32(char *&dst, uint8_t const *&end, size_t &count, uint8_t const add, uint8_t const maxQual)
+{
+    __m256i const all = _mm256_set1_epi8((char)0xFF);
+    __m256i const cap = _mm256_set1_epi8((char)maxQual);
+    __m256i const bias = _mm256_set1_epi8((char)add);
+    __m256i const reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    bool present = false;
+    
+    for ( ; count >= 32; count -= 32, end -= 32, dst += 32) {
+        __m256i const r = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(end - 32)), reverse);
+        __m256i const v = _mm256_permute2x128_si256(r, r, 0x01);
+        
+        present |= (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, all)) != 0xFFFFFFFFu;
+        _mm256_storeu_si256((__m256i *)dst, _mm256_add_epi8(_mm256_min_epu8(v, cap), bias));
+    }
+    return present;
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static inline bool EncodeQualReverse64(char *&dst, uint8_t const *&end, size_t &count, uint8_t const add, uint8_t const maxQual)
+{
+    __m512i const all = _mm512_set1_epi8((char)0xFF);
+    __m512i const cap = _mm512_set1_epi8((char)maxQual);
+    __m512i const bias = _mm512_set1_epi8((char)add);
+    __m512i const reverse = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    bool present = false;
+    
+    for ( ; count >= 64; count -= 64, end -= 64, dst += 64) {
+        __m512i const r = _mm512_shuffle_epi8(_mm512_loadu_si512(end - 64), reverse);
+        __m512i const v = _mm512_shuffle_i64x2(r, r, 0x1B);
+        
+        present |= _mm512_cmpneq_epi8_mask(v, all) != 0;
+        _mm512_storeu_si512(dst, _mm512_add_epi8(_mm512_min_epu8(v, cap), bias));
+    }
+    return present;
+}
+
+CPU_TARGET("ssse3")
+static bool EncodeQualReverseSSSE3(char *dst, uint8_t const *end, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool const present = EncodeQualReverse16(dst, end, count, add, maxQual);
+    return EncodeQualReverseTail(dst, end, count, add, maxQual) || present;
+}
+
+CPU_TARGET("avx2")
+static bool EncodeQualReverseAVX2(char *dst, uint8_t const *end, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = EncodeQualReverse32(dst, end, count, add, maxQual);
+    present |= EncodeQualReverse16(dst, end, count, add, maxQual);
+    return EncodeQualReverseTail(dst, end, count, add, maxQual) || present;
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static bool EncodeQualReverseAVX512(char *dst, uint8_t const *end, size_t count, uint8_t const add, uint8_t const maxQual)
+{
+    bool present = EncodeQualReverse64(dst, end, count, add, maxQual);
+    present |= EncodeQualReverse32(dst, end, count, add, maxQual);
+    present |= EncodeQualReverse16(dst, end, count, add, maxQual);
+    return EncodeQualReverseTail(dst, end, count, add, maxQual) || present;
+}
+#endif
+
+/* HasQual
+ *  whether any of "count" qualities is not 0xFF
+ */
+static bool HasQualPlain(uint8_t const *src, unsigned count)
+{
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for ( ; count >= 16; count -= 16, src += 16) {
+        if (vminvq_u8(vld1q_u8(src)) != 0xFF)
+            return true;
+    }
+#endif
+    for ( ; count > 0; --count, ++src) {
+        if (*src != 0xFF)
+            return true;
+    }
+    return false;
+}
+
+#if CPU_DISPATCH
+CPU_TARGET("sse2")
+static bool HasQualSSE2(uint8_t const *src, unsigned count)
+{
+    __m128i const all = _mm_set1_epi8((char)0xFF);
+    
+    for ( ; count >= 16; count -= 16, src += 16) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const *)src), all)) != 0xFFFF)
+            return true;
+    }
+    return HasQualPlain(src, count);
+}
+
+CPU_TARGET("avx2")
+static bool HasQualAVX2(uint8_t const *src, unsigned count)
+{
+    __m256i const all = _mm256_set1_epi8((char)0xFF);
+    
+    for ( ; count >= 32; count -= 32, src += 32) {
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const *)src), all)) != 0xFFFFFFFFu)
+            return true;
+    }
+    return HasQualSSE2(src, count);
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static bool HasQualAVX512(uint8_t const *src, unsigned count)
+{
+    __m512i const all = _mm512_set1_epi8((char)0xFF);
+    
+    for ( ; count >= 64; count -= 64, src += 64) {
+        if (_mm512_cmpneq_epi8_mask(_mm512_loadu_si512(src), all) != 0)
+            return true;
+    }
+    return HasQualAVX2(src, count);
+}
+#endif
+
+/* the kernels in use, the plain ones until seqKernels has picked */
+static void (*DecodeSeqBytes)(char *, uint8_t const *, unsigned) = DecodeSeqBytesPlain;
+static void (*DecodeSeqBytesReverse)(char *, uint8_t const *, unsigned) = DecodeSeqBytesReversePlain;
+static bool (*EncodeQual)(char *, uint8_t const *, size_t, uint8_t, uint8_t) = EncodeQualPlain;
+static bool (*EncodeQualReverse)(char *, uint8_t const *, size_t, uint8_t, uint8_t) = EncodeQualReversePlain;
+static bool (*HasQual)(uint8_t const *, unsigned) = HasQualPlain;
+
+static struct SeqKernels {
+    SeqKernels() {
+#if CPU_DISPATCH
+        CPU::Level const level = CPU::Best();
+        
+        if (level >= CPU::sse2) {
+            EncodeQual = EncodeQualSSE2;
+            HasQual = HasQualSSE2;
+        }
+        if (level >= CPU::ssse3) {
+            DecodeSeqBytes = DecodeSeqBytesSSSE3;
+            DecodeSeqBytesReverse = DecodeSeqBytesReverseSSSE3;
+            EncodeQualReverse = EncodeQualReverseSSSE3;
+        }
+        if (level >= CPU::avx2) {
+            DecodeSeqBytes = DecodeSeqBytesAVX2;
+            DecodeSeqBytesReverse = DecodeSeqBytesReverseAVX2;
+            EncodeQual = EncodeQualAVX2;
+            EncodeQualReverse = EncodeQualReverseAVX2;
+            HasQual = HasQualAVX2;
+        }
+        if (level >= CPU::avx512) {
+            DecodeSeqBytes = DecodeSeqBytesAVX512;
+            DecodeSeqBytesReverse = DecodeSeqBytesReverseAVX512;
+            EncodeQual = EncodeQualAVX512;
+            EncodeQualReverse = EncodeQualReverseAVX512;
+            HasQual = HasQualAVX512;
+        }
+#endif
+    }
+} const seqKernels;
+
+void BAMRecord::decodeSeq(char dst[], unsigned const offset, unsigned const length) const
+{
+    uint8_t const *const packed = seq();
+    unsigned const end = offset + length;
+    unsigned i = offset;
+    
+    if ((i & 1) != 0 && i < end)
+        *dst++ = seq(i++);
+    
+    unsigned const count = (end - i) >> 1;
+    DecodeSeqBytes(dst, packed + (i >> 1), count);
+    dst += 2 * count;
+    i += 2 * count;
+    
+    if (i < end)
+        *dst = seq(i);
+}
+
+void BAMRecord::decodeSeqReverse(char dst[], unsigned const offset, unsigned const length) const
+{
+    uint8_t const *const packed = seq();
+    unsigned i = offset + length;
+    
+    if ((i & 1) != 0 && i > offset) {
+        --i;
+        *dst++ = seqComplements[packed[i >> 1] >> 4];
+    }
+    
+    unsigned const count = (i - offset) >> 1;
+    DecodeSeqBytesReverse(dst, packed + (i >> 1), count);
+    dst += 2 * count;
+    i -= 2 * count;
+    
+    if (i > offset)
+        *dst = seqComplements[packed[offset >> 1] & 15];
+}
+
+bool BAMRecord::decodeQual(char dst[], unsigned const offset, unsigned const length,
+                           bool const offset33, uint8_t const maxQual) const
+{
+    return encodeQual(dst, qual() + offset, length, offset33, maxQual);
+}
+
+bool BAMRecord::decodeQualReverse(char dst[], unsigned const offset, unsigned const length,
+                                  bool const offset33, uint8_t const maxQual) const
+{
+    return EncodeQualReverse(dst, qual() + offset + length, length, offset33 ? 33 : 0, maxQual);
+}
+
+bool BAMRecord::encodeQual(char dst[], uint8_t const src[], size_t const count,
+                           bool const offset33, uint8_t const maxQual)
+{
+    return EncodeQual(dst, src, count, offset33 ? 33 : 0, maxQual);
+}
+
+bool BAMRecord::hasQual() const
+{
+    return HasQual(qual(), l_seq());
+}
+
+void BAMFile::DumpSAM(std::ostream &oss, BAMRecord const &rec) const
+{
+    std::vector<char> text(SAMFormatter::MaxSize(*this, rec));
+    char const *const endp = SAMFormatter::Format(&text[0], *this, rec);
+    
+    oss.write(&text[0], endp - &text[0]);
+}
+
+static ngs::WorkPool::Priority PoolPriority(NGS_BAM::OpenOptions::Priority const priority)
+{
+    switch (priority) {
+        case NGS_BAM::OpenOptions::low:
+            return ngs::WorkPool::low;
+        case NGS_BAM::OpenOptions::high:
+            return ngs::WorkPool::high;
+        default:
+            return ngs::WorkPool::normal;
+    }
+}
+
+/* OpenReader
+ *  a BGZF reader of the file, or for a SAM file, a SAMReader, with
+ *  a BGZF reader of its own if it is bgzipped
+ */
+BlockReader *BAMFile::OpenReader(void) const
+{
+    BGZFReader *const bgzf = samText.isSAM() && !samText.isBGZF() ? 0 :
+        new BGZFReader(path, options.threads, options.useMmap, options.prefetch, &blockCache,
+                       options.verifyCRC, &ioStats, options.ioBuffer, options.hugePages,
+                       options.streaming, &memory, options.follow, PoolPriority(options.priority),
+                       options.numaLocal, options.adaptiveReadahead, options.gpuInflate);
+    
+    if (!samText.isSAM())
+        return bgzf;
+    return new SAMReader(samText, bgzf, options.threads, PoolPriority(options.priority), &memory);
+}
+
+BAMFileCursor::BAMFileCursor(BAMFile const &File)
+: file(File)
+, reader(File.OpenReader())
+, block(0)
+, bam_cur(0)
+{
+    try {
+        Rewind();
+    }
+    catch (...) {
+        delete reader;
+        throw;
+    }
+}
+
+BAMFileCursor::BAMFileCursor(BAMFile const &File, BAMFilePosType const start)
+: file(File)
+, reader(File.OpenReader())
+, block(0)
+, bam_cur(0)
+{
+    try {
+        Seek(start);
+    }
+    catch (...) {
+        delete reader;
+        throw;
+    }
+}
+
+BAMFileCursor::~BAMFileCursor()
+{
+    delete reader;
+}
+
+/* Settle
+ *  at the end of a block, move on to the next one, so that Tell
+ *  gives the position that an index has for the next record
+ */
+void BAMFileCursor::Settle(void) {
+    if (block && bam_cur == block->size)
+        ReadBlock();
+}
+
+void BAMFileCursor::Rewind() {
+    Seek(file.first_bpos, file.first_bam_cur);
+}
+
+bool BAMFileCursor::isGoodRecord(BAMRecord const &rec) {
+    return file.isGoodRecord(rec);
+}
+
+void BAMFileCursor::DumpSAM(std::ostream &oss, BAMRecord const &rec) const {
+    file.DumpSAM(oss, rec);
+}
+
+void BAMFileCursor::ReadBlock(void) {
+    block = reader->Next();
+    bam_cur = 0;
+}
+
+size_t BAMFileCursor::ReadN(size_t N, void *Dst) {
+    uint8_t *const dst = reinterpret_cast<uint8_t *>(Dst);
+    size_t n = 0;
+    
+    while (n < N) {
+        size_t const avail_out = N - n;
+        size_t const avail_in = block ? block->size - bam_cur : 0;
+        
+        if (avail_in) {
+            size_t const copy = avail_out < avail_in ? avail_out : avail_in;
+            
+            memcpy(dst + n, block->data + bam_cur, copy);
+            bam_cur += copy;
+            
+            n += copy;
+            if (n == N)
+                break;
+        }
+        ReadBlock();
+        if (!block)
+            break;
+    }
+    return n;
+}
+
+size_t BAMFileCursor::SkipN(size_t N) {
+    size_t n = 0;
+    
+    while (n < N) {
+        size_t const avail_out = N - n;
+        size_t const avail_in = block ? block->size - bam_cur : 0;
+        
+        if (avail_in) {
+            size_t const copy = avail_out < avail_in ? avail_out : avail_in;
+            
+            bam_cur += copy;
+            n += copy;
+            if (n == N)
+                break;
+        }
+        ReadBlock();
+        if (!block)
+            break;
+    }
+    return n;
+}
+
+void BAMFileCursor::Seek(size_t const new_bpos, unsigned const new_bam_cur) {
+    TRACE_SPAN("BAMFileCursor::Seek");
+#if 0
+    std::cerr << "seek to " << std::hex << new_bpos << "|" << new_bam_cur << std::endl;
+#endif
+    
+    /* no I/O if it is in the current block */
+    if (!(block && block->fpos == new_bpos && new_bam_cur <= block->size)) {
+        try {
+            reader->Seek(new_bpos);
+            ReadBlock();
+        }
+        catch (std::runtime_error const &) {
+            if (file.isStream())
+                throw;              /* it says the stream has gone past it */
+            throw std::runtime_error("position is invalid");
+        }
+        if (new_bam_cur != 0 && !(block && block->fpos == new_bpos && new_bam_cur <= block->size))
+            throw std::runtime_error("position is invalid");
+    }
+    bam_cur = new_bam_cur;
+    Settle();
+}
+
+template <typename T>
+bool BAMFileCursor::Read(size_t count, T *dst) {
+    size_t const nwant = count * sizeof(T);
+    size_t const nread = ReadN(nwant, reinterpret_cast<void *>(dst));
+    
+    return nwant == nread;
+}
+
+int32_t BAMFileCursor::ReadI32() {
+    int32_t value;
+    
+    if (Read(1, &value))
+        return LE2Host<int32_t>(&value);
+    throw std::runtime_error("insufficient data while reading bam file");
+}
+
+bool BAMFileCursor::ReadI32(int32_t &rslt) {
+    int32_t value;
+    
+    if (Read(1, &value)) {
+        rslt = LE2Host<int32_t>(&value);
+        return true;
+    }
+    return false;
+}
+
+void BAMFile::CheckHeaderSignature(void) {
+    static char const sig[] = "BAM\1";
+    char actual[4];
+    
+    if (!cursor.Read(4, actual) || memcmp(actual, sig, 4) != 0)
+        throw std::runtime_error("Not a BAM file");
+}
+
+void BAMFile::ReadHeader(void) {
+    CheckHeaderSignature();
+    
+    {
+        int32_t const l_text = cursor.ReadI32();
+        if (l_text < 0)
+            throw std::runtime_error("header text length < 0");
+        
+        headerText.resize(l_text);
+        if (l_text > 0 && !cursor.Read(l_text, &headerText[0]))
+            throw std::runtime_error("file is truncated");
+        headerText.resize(strnlen(headerText.data(), l_text));
+    }
+    ParseReadGroups();
+    ParseSortOrder();
+    int32_t const n_ref = cursor.ReadI32();
+    if (n_ref < 0)
+        throw std::runtime_error("header reference count < 0");
+    
+    // the names are read straight into one string, each one after a NUL
+    // so that it is terminated by the next; where each one is, is only
+    // known for sure once the string has stopped growing
+    std::vector<size_t> nameAt(n_ref);
+    std::vector<int32_t> lengths(n_ref);
+    
+    for (int i = 0; i < n_ref; ++i) {
+        int32_t const l_name = cursor.ReadI32();
+        
+        if (l_name < 0)
+            throw std::runtime_error("header reference name length < 0");
+        
+        size_t const at = referenceNames.size() + 1;
+        
+        referenceNames.resize(at + l_name);
+        if (l_name > 0 && !cursor.Read(l_name, &referenceNames[at]))
+            throw std::runtime_error("file is truncated");
+        referenceNames.resize(at + strnlen(referenceNames.data() + at, l_name));
+        nameAt[i] = at;
+        
+        lengths[i] = cursor.ReadI32();
+        if (lengths[i] < 0)
+            throw std::runtime_error("header reference length < 0");
+    }
+    referenceNames += '\0';
+    
+    references.reserve(n_ref);
+    for (int i = 0; i < n_ref; ++i) {
+        size_t const end = i + 1 < n_ref ? nameAt[i + 1] - 1 : referenceNames.size() - 1;
+        
+        references.push_back(HeaderRefInfo(referenceNames.data() + nameAt[i], end - nameAt[i], lengths[i], &memory));
+    }
+    HashReferences();
+}
+
+/* HashName
+ *  FNV-1a
+ */
+static uint32_t HashName(char const name[], size_t const length)
+{
+    uint32_t hash = 2166136261u;
+    
+    for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    return hash;
+}
+
+/* HashReferences
+ *  a table at most half full, probed linearly; of references
+ *  with the same name, the last one is found
+ */
+void BAMFile::HashReferences(void)
+{
+    size_t size = 16;
+    
+    while (size < 2 * references.size())
+        size *= 2;
+    referenceHash.assign(size, 0);
+    
+    for (unsigned i = 0; i < references.size(); ++i) {
+        HeaderRefInfo const &ri = references[i];
+        size_t slot = HashName(ri.getName(), ri.getNameLength()) & (size - 1);
+        
+        while (referenceHash[slot] != 0) {
+            HeaderRefInfo const &other = references[referenceHash[slot] - 1];
+            
+            if (other.getNameLength() == ri.getNameLength() &&
+                memcmp(other.getName(), ri.getName(), ri.getNameLength()) == 0)
+            {
+                break;
+            }
+            slot = (slot + 1) & (size - 1);
+        }
+        referenceHash[slot] = i + 1;
+    }
+}
+
+int BAMFile::FindReference(char const name[], size_t const length) const
+{
+    size_t const mask = referenceHash.size() - 1;
+    size_t slot = HashName(name, length) & mask;
+    
+    for ( ; referenceHash[slot] != 0; slot = (slot + 1) & mask) {
+        unsigned const i = referenceHash[slot] - 1;
+        HeaderRefInfo const &candidate = references[i];
+        
+        if (candidate.getNameLength() == length && memcmp(candidate.getName(), name, length) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+void BAMFile::LoadIndexData(size_t const fsize, char const data[], bool const lazy) {
+    char const *const endp = data + fsize;
+    IndexFormat format;
+    size_t offset;
+    
+    if (memcmp(data, "BAI\1", 4) == 0) {
+        format.min_shift = 14;
+        format.depth = 5;
+        format.csi = false;
+        offset = 4;
+    }
+    else if (memcmp(data, "CSI\1", 4) == 0 && fsize >= 16) {
+        format.min_shift = LE2Host<int32_t>(data + 4);
+        format.depth = LE2Host<int32_t>(data + 8);
+        format.csi = true;
+        
+        int32_t const l_aux = LE2Host<int32_t>(data + 12);
+        if (format.min_shift <= 0 || format.depth < 0 || format.min_shift + 3 * format.depth > 63 ||
+            l_aux < 0 || 16 + (size_t)l_aux + 4 > fsize)
+            return;
+        offset = 16 + l_aux;
+    }
+    else
+        return;
+    
+    if (offset + 4 > fsize)
+        return;
+    
+    int32_t const n_ref = LE2Host<int32_t>(data + offset);
+    if (n_ref != references.size())
+        return;
+    
+    offset += 4;
+    
+    for (int i = 0; i < n_ref; ++i) {
+        size_t size = 0;
+        
+        if (lazy) {
+            try {
+                size = references[i].DeferIndex(data + offset, endp, format, &indexLock);
+            }
+            catch (std::runtime_error const &) {
+                size = 0;
+            }
+        }
+        else
+            size = references[i].LoadIndex(data + offset, endp, format);
+        
+        offset += size;
+        if (size == 0) {
+            std::cerr << "failed to load index #" << (i + 1) << std::endl;
+            for (int j = 0; j < i; ++j)
+                references[j].DropIndex();
+            return;
+        }
+    }
+    /* optional in both formats */
+    if (offset + 8 <= fsize) {
+        n_no_coor = LE2Host<uint64_t>(data + offset);
+        has_no_coor = true;
+    }
+}
+
+/* LoadCompressedIndex
+ *  CSI indexes are BGZF compressed; inflate the whole file into indexCopy
+ */
+bool BAMFile::LoadCompressedIndex(std::string const &idxpath, bool const lazy) {
+    try {
+        BGZFReader *const reader = new BGZFReader(idxpath, 0);
+        
+        try {
+            for (BGZFBlock const *block = reader->Next(); block; block = reader->Next())
+                indexCopy.insert(indexCopy.end(), block->data, block->data + block->size);
+        }
+        catch (...) {
+            delete reader;
+            throw;
+        }
+        delete reader;
+    }
+    catch (std::runtime_error const &) {
+        std::vector<char>().swap(indexCopy);
+        return false;
+    }
+    if (indexCopy.size() >= 8)
+        LoadIndexData(indexCopy.size(), &indexCopy[0], lazy);
+    if (!lazy)
+        std::vector<char>().swap(indexCopy);
+    return true;
+}
+
+bool BAMFile::LoadIndexFile(std::string const &idxpath, bool const useMmap, bool const lazy) {
+    if (ByteSource::IsURL(idxpath)) {
+        try {
+            ByteSource *const source = ByteSource::Open(idxpath);
+            size_t fsize = 0;
+            
+            try {
+                for ( ; ; ) {
+                    indexCopy.resize(fsize + IO_BLK_SIZE);
+                    
+                    size_t const nread = source->Read(fsize, &indexCopy[fsize], IO_BLK_SIZE);
+                    if (nread == 0)
+                        break;
+                    fsize += nread;
+                }
+            }
+            catch (...) {
+                delete source;
+                throw;
+            }
+            delete source;
+            indexCopy.resize(fsize);
+        }
+        catch (std::runtime_error const &) {
+            std::vector<char>().swap(indexCopy);
+            return false;
+        }
+        if (indexCopy.size() >= 8)
+            LoadIndexData(indexCopy.size(), &indexCopy[0], lazy);
+        if (!lazy)
+            std::vector<char>().swap(indexCopy);
+        return true;
+    }
+    if (useMmap && indexMap.Map(idxpath)) {
+        if (indexMap.size() >= 8)
+            LoadIndexData(indexMap.size(), reinterpret_cast<char const *>(indexMap.data()), lazy);
+        if (!lazy)
+            indexMap.Unmap();
+        return true;
+    }
+    
+    std::ifstream ifile;
+    
+    ifile.open(idxpath.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!ifile.is_open())
+        return false;
+    
+    std::filebuf *const buf = ifile.rdbuf();
+    size_t const fsize = buf->pubseekoff(0, ifile.end, ifile.in);
+    
+    if (fsize < 8)
+        return true;
+    
+    buf->pubseekpos(0, ifile.in);
+    
+    indexCopy.resize(fsize);
+    buf->sgetn(&indexCopy[0], fsize);
+    
+    LoadIndexData(fsize, &indexCopy[0], lazy);
+    if (!lazy)
+        std::vector<char>().swap(indexCopy);
+    return true;
+}
+
+/* LoadIndex
+ *  use the .bai if there is one, otherwise the .csi
+ */
+void BAMFile::LoadIndex(std::string const &filepath, bool const useMmap, bool const lazy) {
+    TRACE_SPAN("BAMFile::LoadIndex");
+    if (!LoadIndexFile(filepath + ".bai", useMmap, lazy))
+        LoadCompressedIndex(filepath + ".csi", lazy);
+}
+
+static char const flatIndexSuffix[] = ".ngs-index";
+static char const flatIndexMagic[8] = { 'N', 'G', 'S', 'F', 'L', 'A', 'T', '1' };
+
+/* FlatAlign
+ *  where the flattened index starts after the sidecar's first line
+ */
+static size_t FlatAlign(size_t const offset)
+{
+    return (offset + 63) & ~(size_t)63;
+}
+
+/* MapFlatIndex
+ *  use the index from its sidecar, if that is current and fits the
+ *  header; every array must lie within the mapping
+ */
+bool BAMFile::MapFlatIndex(std::string const &filepath) {
+    Sidecar cached;
+    
+    if (!cached.OpenRead(filepath, flatIndexSuffix))
+        return false;
+    
+    long const line = ftell(cached.get());
+    if (line < 0 || !flatIndex.Map(fileno(cached.get())))
+        return false;
+    
+    size_t const start = FlatAlign((size_t)line);
+    size_t const size = flatIndex.size() > start ? flatIndex.size() - start : 0;
+    char const *const base = reinterpret_cast<char const *>(flatIndex.data()) + start;
+    FlatIndexHeader const *const header = reinterpret_cast<FlatIndexHeader const *>(base);
+    FlatRefIndex const *const flat = reinterpret_cast<FlatRefIndex const *>(header + 1);
+    
+    if (size < sizeof(*header) || memcmp(header->magic, flatIndexMagic, 8) != 0 ||
+        header->n_ref != references.size() ||
+        size < sizeof(*header) + header->n_ref * sizeof(*flat))
+    {
+        flatIndex.Unmap();
+        return false;
+    }
+    for (unsigned i = 0; i < header->n_ref; ++i) {
+        FlatRefIndex const &ref = flat[i];
+        
+        if (ref.interval % 8 != 0 || ref.bins % 8 != 0 || ref.chunks % 8 != 0 ||
+            ref.interval > size || ref.n_interval > (size - ref.interval) / sizeof(BAMFilePosType) ||
+            ref.bins > size || ref.n_bins > (size - ref.bins) / sizeof(RefIndex::Bin) ||
+            ref.chunks > size || ref.n_chunks > (size - ref.chunks) / sizeof(BAMFileChunk))
+        {
+            flatIndex.Unmap();
+            return false;
+        }
+    }
+    
+    IndexFormat format;
+    
+    format.min_shift = header->min_shift;
+    format.depth = header->depth;
+    format.csi = header->csi != 0;
+    for (unsigned i = 0; i < header->n_ref; ++i)
+        references[i].MapIndex(format, flat[i], base);
+    n_no_coor = header->n_no_coor;
+    has_no_coor = header->has_no_coor != 0;
+    std::vector<char>().swap(indexCopy);
+    indexMap.Unmap();
+    return true;
+}
+
+/* SaveFlatIndex
+ *  write the loaded index to its sidecar, loading the references that
+ *  were deferred; nothing is written if no reference has an index
+ */
+void BAMFile::SaveFlatIndex(std::string const &filepath) const {
+    std::vector<RefIndex const *> loaded(references.size(), (RefIndex const *)0);
+    bool any = false;
+    
+    for (unsigned i = 0; i < references.size(); ++i) {
+        if (references[i].hasIndex())
+            loaded[i] = references[i].getIndex();
+        if (loaded[i])
+            any = true;
+    }
+    if (!any)
+        return;
+    
+    FlatIndexHeader header;
+    std::vector<FlatRefIndex> flat(references.size());
+    uint64_t offset = sizeof(header) + flat.size() * sizeof(FlatRefIndex);
+    
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, flatIndexMagic, 8);
+    header.n_ref = (uint32_t)references.size();
+    header.n_no_coor = n_no_coor;
+    header.has_no_coor = has_no_coor ? 1 : 0;
+    memset(&flat[0], 0, flat.size() * sizeof(FlatRefIndex));
+    for (unsigned i = 0; i < references.size(); ++i) {
+        RefIndex const *const ri = loaded[i];
+        FlatRefIndex &ref = flat[i];
+        
+        if (!ri)
+            continue;
+        header.min_shift = ri->format.min_shift;
+        header.depth = ri->format.depth;
+        header.csi = ri->format.csi ? 1 : 0;
+        ref.has_index = 1;
+        ref.has_counts = ri->has_counts ? 1 : 0;
+        ref.off_beg = ri->off_beg.getValue();
+        ref.off_end = ri->off_end.getValue();
+        ref.n_mapped = ri->n_mapped;
+        ref.n_unmapped = ri->n_unmapped;
+        ref.interval = offset; ref.n_interval = ri->interval.size(); offset += ref.n_interval * sizeof(BAMFilePosType);
+        ref.bins = offset; ref.n_bins = ri->bins.size(); offset += ref.n_bins * sizeof(RefIndex::Bin);
+        ref.chunks = offset; ref.n_chunks = ri->chunks.size(); offset += ref.n_chunks * sizeof(BAMFileChunk);
+    }
+    
+    Sidecar update;
+    
+    if (!update.OpenWrite(filepath, flatIndexSuffix))
+        return;
+    
+    FILE *const fp = update.get();
+    long const line = ftell(fp);
+    
+    if (line < 0)
+        return;
+    for (size_t pad = FlatAlign((size_t)line) - (size_t)line; pad > 0; --pad)
+        fputc('\0', fp);
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(&flat[0], sizeof(FlatRefIndex), flat.size(), fp);
+    for (unsigned i = 0; i < references.size(); ++i) {
+        RefIndex const *const ri = loaded[i];
+        
+        if (!ri)
+            continue;
+        fwrite(ri->interval.begin(), sizeof(BAMFilePosType), ri->interval.size(), fp);
+        fwrite(ri->bins.begin(), sizeof(RefIndex::Bin), ri->bins.size(), fp);
+        fwrite(ri->chunks.begin(), sizeof(BAMFileChunk), ri->chunks.size(), fp);
+    }
+    update.Commit();
+}
+
+/* BuildIndex
+ *  index the file with a pass over its records when it has no index
+ *  of its own, and save it if asked to; a file that turns out not to
+ *  be sorted by position is left without one
+ */
+void BAMFile::BuildIndex(std::string const &filepath, bool const lazy) {
+    for (unsigned i = 0; i < references.size(); ++i) {
+        if (references[i].hasIndex())
+            return;
+    }
+    if (references.empty())
+        return;
+    
+    BAMIndexBuilder builder((unsigned)references.size());
+    BAMFileCursor scan(*this);
+    BAMRecordBuffer buffer;
+    
+    for ( ; ; ) {
+        BAMFilePosType const beg = scan.Tell();
+        BAMRecord const *const rec = scan.Read(buffer, 0);
+        
+        if (!rec)
+            break;
+        builder.Add(rec->refID(), *rec, beg.getValue(), scan.Tell().getValue());
+        if (!builder.isSorted()) {
+            zones.clear();
+            return;
+        }
+        if (options.zoneMap)
+            zones.Add(beg.getValue(), *rec);
+    }
+    
+    std::string data;
+    
+    builder.Encode(data, 0);
+    if (options.saveIndex && !ByteSource::IsURL(filepath) && !samText.isSAM()) {
+        try {
+            BAMIndexBuilder::Save(filepath + ".bai", data);
+        }
+        catch (std::runtime_error const &) {
+            /* it is still used from memory */
+        }
+    }
+    indexCopy.assign(data.begin(), data.end());
+    LoadIndexData(indexCopy.size(), &indexCopy[0], lazy);
+    if (!lazy)
+        std::vector<char>().swap(indexCopy);
+}
+
+/* PoolConfigured
+ *  the options, after asking for their poolThreads before the
+ *  file's reader submits to the shared pool and starts it
+ */
+static NGS_BAM::OpenOptions const &PoolConfigured(NGS_BAM::OpenOptions const &options)
+{
+    if (options.poolThreads > 0)
+        ngs::WorkPool::configure(options.poolThreads);
+    return options;
+}
+
+/* DiskTier
+ *  where the blocks of a remote file go besides its block cache, see
+ *  NGS_BAM::OpenOptions::diskCache; nowhere for a local file, or for a
+ *  remote one that the server doesn't tag with an ETag
+ */
+static BGZFDiskTier DiskTier(std::string const &filepath, NGS_BAM::OpenOptions const &options)
+{
+    BGZFDiskTier tier;
+    
+    if (options.diskCache.empty() || !ByteSource::IsURL(filepath))
+        return tier;
+    
+    ByteSource *const probe = ByteSource::Open(filepath);
+    std::string etag;
+    
+    try {
+        etag = probe->Tag();
+    }
+    catch (...) {
+        delete probe;
+        throw;
+    }
+    delete probe;
+    if (etag.empty())
+        return tier;
+    
+    tier.cache = DiskCache::Open(options.diskCache, options.diskCacheSize);
+    tier.tag = filepath + '\n' + etag;
+    tier.inflated = options.diskCacheInflated;
+    return tier;
+}
+
+IndexLoad::IndexLoad()
+: file(0)
+, running(false)
+, done(true)
+{
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&cond, 0);
+}
+
+IndexLoad::~IndexLoad()
+{
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+}
+
+void IndexLoad::Start(BAMFile &File, ngs::WorkPool::Priority const priority)
+{
+    file = &File;
+    done = false;
+    try {
+        ngs::WorkPool::shared().submit(*this, priority);
+    }
+    catch (...) {
+        done = true;
+        throw;
+    }
+}
+
+void IndexLoad::run()
+{
+    pthread_mutex_lock(&mutex);
+    loader = pthread_self();
+    running = true;
+    pthread_mutex_unlock(&mutex);
+    Execute();
+}
+
+void IndexLoad::Execute() const
+{
+    std::string failed;
+    
+    try {
+        file->OpenIndex();
+    }
+    catch (std::exception const &e) {
+        failed = e.what();
+        if (failed.empty())
+            failed = "failed to load index";
+    }
+    catch (...) {
+        failed = "failed to load index";
+    }
+    pthread_mutex_lock(&mutex);
+    error = failed;
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Wait
+ *  for a load that isn't done: the thread running it goes on with it,
+ *  one that finds it still queued takes it back and runs it, and any
+ *  other waits for it
+ */
+void IndexLoad::Wait() const
+{
+    pthread_mutex_lock(&mutex);
+    if (!done && running && pthread_equal(loader, pthread_self())) {
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+    if (!done && !running) {
+        pthread_mutex_unlock(&mutex);
+        if (ngs::WorkPool::shared().cancel(const_cast<IndexLoad &>(*this))) {
+            const_cast<IndexLoad *>(this)->run();
+            return;
+        }
+        pthread_mutex_lock(&mutex);
+    }
+    while (!done)
+        pthread_cond_wait(&cond, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
+
+void IndexLoad::Finish()
+{
+    if (__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+        return;
+    try {
+        if (ngs::WorkPool::shared().cancel(*this)) {
+            done = true;
+            return;
+        }
+    }
+    catch (...) {}
+    pthread_mutex_lock(&mutex);
+    while (!done)
+        pthread_cond_wait(&cond, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
+
+BAMFile::BAMFile(std::string const &filepath, NGS_BAM::OpenOptions const &Options)
+: path(filepath)
+, options(PoolConfigured(Options))
+, stream(ByteSource::IsStream(filepath))
+, samText(filepath)
+, blockCache(Options.blockCache, &memory, DiskTier(filepath, Options))
+, regionCache(Options.regionCache, &memory)
+, collated(false)
+, sortOrder(NGS_BAM::unknownOrder)
+, n_no_coor(0)
+, has_no_coor(false)
+, coverageMapped(false)
+, first_bpos(0)
+, first_bam_cur(0)
+, cursor(*this)                 /* at the start of the file until the header is read */
+{
+    TRACE_SPAN("BAMFile::open");
+    pthread_mutex_init(&indexLock, 0);
+    ReadHeader();
+    memory.Add(MemoryLedger::header, HeaderFootprint());
+    first_bpos = cursor.block ? cursor.block->fpos : 0;
+    first_bam_cur = cursor.bam_cur;
+    if (stream)
+        return;                     /* it has no index and can't be read again to make one */
+    if (!options.asyncIndex) {
+        OpenIndex();
+        return;
+    }
+    for (unsigned i = 0; i < references.size(); ++i)
+        references[i].index_load = &indexLoad;
+    indexLoad.Start(*this, PoolPriority(options.priority));
+}
+
+/* OpenIndex
+ *  map, load or build the index, and the zone map, as the options say
+ */
+void BAMFile::OpenIndex(void)
+{
+    bool const shareable = options.sharedIndex && !ByteSource::IsURL(path);
+    
+    if (!shareable || !MapFlatIndex(path)) {
+        if (!samText.isSAM())       /* an index of bgzipped SAM has its BGZF positions, not the records' */
+            LoadIndex(path, options.useMmap, options.lazyIndex);
+        if (options.buildIndex && options.follow == 0)   /* it would wait for the file to be finished */
+            BuildIndex(path, options.lazyIndex);
+        if (shareable) {
+            SaveFlatIndex(path);
+            MapFlatIndex(path);
+        }
+        memory.Add(MemoryLedger::index, indexCopy.capacity());
+    }
+    if (options.zoneMap && options.follow == 0 && !ByteSource::IsURL(path))
+        MakeZones(path);
+}
+
+/* MakeZones
+ *  load the zone map from its sidecar if it is current, else make it
+ *  with a pass over the records, unless BuildIndex has just made it
+ *  in its own, and save it
+ */
+void BAMFile::MakeZones(std::string const &filepath)
+{
+    if (!zones.empty())
+        zones.Save(filepath);
+    else if (!zones.Load(filepath)) {
+        BAMFileCursor scan(*this);
+        BAMRecordBuffer buffer;
+        
+        for ( ; ; ) {
+            BAMFilePosType const beg = scan.Tell();
+            BAMRecord const *const rec = scan.Read(buffer, 0);
+            
+            if (!rec)
+                break;
+            zones.Add(beg.getValue(), *rec);
+        }
+        zones.Save(filepath);
+    }
+    memory.Add(MemoryLedger::index, zones.footprint());
+}
+
+/* HeaderFootprint
+ *  the bytes the parsed header holds
+ */
+size_t BAMFile::HeaderFootprint(void) const
+{
+    size_t bytes = headerText.capacity() + referenceNames.capacity()
+                 + references.capacity() * sizeof(HeaderRefInfo)
+                 + referenceHash.capacity() * sizeof(unsigned)
+                 + readGroups.capacity() * sizeof(std::string)
+                 + readGroupOrder.capacity() * sizeof(unsigned);
+    
+    for (size_t i = 0; i < readGroups.size(); ++i)
+        bytes += readGroups[i].capacity();
+    return bytes;
+}
+
+BAMFile::~BAMFile()
+{
+    indexLoad.Finish();
+    pthread_mutex_destroy(&indexLock);
+}
+
+/* the files Open has opened
+ * an entry is stale once its file has changed; it is no longer found
+ * and goes when its last user closes it; an entry no one is using is
+ * idle, and only the "keep" most recently closed ones are kept */
+struct SharedFile
+{
+    std::string path;
+    NGS_BAM::OpenOptions options;
+    struct stat stamp;
+    BAMFile *file;
+    unsigned users;
+    uint64_t closed;                /* when it was last closed */
+    bool stale;
+};
+static pthread_mutex_t sharedLock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<SharedFile *> shared;
+static unsigned sharedKeep = 0;
+static uint64_t sharedClock = 0;
+
+/* the options BAMFile uses */
+static bool SameFileOptions(NGS_BAM::OpenOptions const &a, NGS_BAM::OpenOptions const &b)
+{
+    return a.threads == b.threads && a.useMmap == b.useMmap && a.lazyIndex == b.lazyIndex &&
+           a.asyncIndex == b.asyncIndex &&
+           a.prefetch == b.prefetch && a.blockCache == b.blockCache && a.verifyCRC == b.verifyCRC &&
+           a.validation == b.validation && a.buildIndex == b.buildIndex && a.saveIndex == b.saveIndex &&
+           a.sharedIndex == b.sharedIndex && a.ioBuffer == b.ioBuffer && a.hugePages == b.hugePages &&
+           a.streaming == b.streaming && a.follow == b.follow && a.regionCache == b.regionCache &&
+           a.priority == b.priority && a.numaLocal == b.numaLocal &&
+           a.adaptiveReadahead == b.adaptiveReadahead && a.gpuInflate == b.gpuInflate && a.zoneMap == b.zoneMap &&
+           a.diskCache == b.diskCache && a.diskCacheSize == b.diskCacheSize &&
+           a.diskCacheInflated == b.diskCacheInflated;
+}
+
+static bool SameStamp(struct stat const &a, struct stat const &b)
+{
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size &&
+           a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+/* TrimShared
+ *  drop the stale and the idle entries that aren't kept
+ *  called with sharedLock held; returns the files to delete once it's released
+ */
+static void TrimShared(std::vector<BAMFile *> &drop)
+{
+    for ( ; ; ) {
+        unsigned idle = 0;
+        int victim = -1;
+        
+        // of the idle ones, the stale go first, then the least recently closed
+        for (unsigned i = 0; i < shared.size(); ++i) {
+            SharedFile const &entry = *shared[i];
+            
+            if (entry.users != 0)
+                continue;
+            ++idle;
+            if (victim < 0 || (entry.stale && !shared[victim]->stale) ||
+                (entry.stale == shared[victim]->stale && entry.closed < shared[victim]->closed))
+            {
+                victim = i;
+            }
+        }
+        if (victim < 0 || (!shared[victim]->stale && idle <= sharedKeep))
+            return;
+        drop.push_back(shared[victim]->file);
+        delete shared[victim];
+        shared.erase(shared.begin() + victim);
+    }
+}
+
+BAMFile const &BAMFile::Open(std::string const &filepath, NGS_BAM::OpenOptions const &options)
+{
+    struct stat stamp;
     
-    if (!Read(4, actual) || memcmp(actual, sig, 4) != 0)
-        throw std::runtime_error("Not a BAM file");
+    // a file that can't be stamped, e.g. a pipe, is never shared
+    bool const stamped = stat(filepath.c_str(), &stamp) == 0 && S_ISREG(stamp.st_mode);
+    std::vector<BAMFile *> drop;
+    
+    if (stamped) {
+        BAMFile const *found = 0;
+        
+        pthread_mutex_lock(&sharedLock);
+        for (unsigned i = 0; i < shared.size(); ++i) {
+            SharedFile &entry = *shared[i];
+            
+            if (entry.stale || entry.path != filepath || !SameFileOptions(entry.options, options))
+                continue;
+            if (!SameStamp(entry.stamp, stamp)) {
+                entry.stale = true;
+                continue;
+            }
+            ++entry.users;
+            found = entry.file;
+            break;
+        }
+        TrimShared(drop);
+        pthread_mutex_unlock(&sharedLock);
+        
+        for (unsigned i = 0; i < drop.size(); ++i)
+            delete drop[i];
+        if (found)
+            return *found;
+    }
+    
+    // a URL that can't be read only fails at the first read, which the
+    // cursor would report as a bad position, so try it with a small one
+    if (ByteSource::IsURL(filepath)) {
+        ByteSource *const probe = ByteSource::Open(filepath);
+        char byte;
+        
+        try {
+            probe->Read(0, &byte, 1);
+        }
+        catch (...) {
+            delete probe;
+            throw;
+        }
+        delete probe;
+    }
+    
+    // opened without the lock, so that opening one file doesn't hold up the others
+    BAMFile *const file = new BAMFile(filepath, options);
+    SharedFile *const entry = new SharedFile();
+    
+    entry->path = filepath;
+    entry->options = options;
+    entry->stamp = stamp;
+    entry->file = file;
+    entry->users = 1;
+    entry->closed = 0;
+    entry->stale = !stamped;
+    
+    pthread_mutex_lock(&sharedLock);
+    shared.push_back(entry);
+    pthread_mutex_unlock(&sharedLock);
+    return *file;
+}
+
+void BAMFile::Close(BAMFile const &file)
+{
+    std::vector<BAMFile *> drop;
+    
+    pthread_mutex_lock(&sharedLock);
+    for (unsigned i = 0; i < shared.size(); ++i) {
+        if (shared[i]->file == &file) {
+            --shared[i]->users;
+            shared[i]->closed = ++sharedClock;
+            break;
+        }
+    }
+    TrimShared(drop);
+    pthread_mutex_unlock(&sharedLock);
+    
+    for (unsigned i = 0; i < drop.size(); ++i)
+        delete drop[i];
+}
+
+void BAMFile::Keep(unsigned const count)
+{
+    std::vector<BAMFile *> drop;
+    
+    pthread_mutex_lock(&sharedLock);
+    sharedKeep = count;
+    TrimShared(drop);
+    pthread_mutex_unlock(&sharedLock);
+    
+    for (unsigned i = 0; i < drop.size(); ++i)
+        delete drop[i];
+}
+
+BAMRecord const *BAMFileCursor::Read(BAMRecordBuffer &buffer)
+{
+    return Read(buffer, NGS_BAM::OpenOptions::allFields);
+}
+
+BAMRecord const *BAMFileCursor::Read(BAMRecordBuffer &buffer, unsigned const fields)
+{
+    static BAMRecordFilter const none;
+    bool rejected;
+    
+    return Read(buffer, fields, none, rejected);
+}
+
+BAMRecord const *BAMFileCursor::Read(BAMRecordBuffer &buffer, unsigned const fields,
+                                     BAMRecordFilter const &filter, bool &rejected)
+{
+    int32_t datasize;
+    
+    rejected = false;
+    if (!ReadI32(datasize)) // assumes cause is EOF
+        return 0;
+    
+    if (datasize < 0)
+        throw std::runtime_error("file is corrupt: record size < 0");
+
+    uint32_t const size = (uint32_t)datasize;
+    SizedRawData *const data = buffer.Reserve(size);
+    bool const allFields = (fields & NGS_BAM::OpenOptions::allFields) == NGS_BAM::OpenOptions::allFields;
+    
+    if (size < BAMLayout::length_fixed_part || (allFields && !filter.isActive())) {
+        if (!Read(size, data->data))
+            throw std::runtime_error("file is truncated");
+    }
+    else {
+        if (!Read(BAMLayout::length_fixed_part, data->data))
+            throw std::runtime_error("file is truncated");
+        
+        BAMRecord const &rec = *buffer.record();
+        size_t const rest = size - BAMLayout::length_fixed_part;
+        
+        /* a rejected record is skipped without being copied or measured */
+        if (filter.isActive() && filter.Rejects(rec)) {
+            if (SkipN(rest) != rest)
+                throw std::runtime_error("file is truncated");
+            Settle();
+            rejected = true;
+            return &rec;
+        }
+        if (allFields || filter.needsRest()) {
+            if (ReadN(rest, data->data + BAMLayout::length_fixed_part) != rest)
+                throw std::runtime_error("file is truncated");
+        }
+        else {
+            /* the parts that follow the fixed part, in file order;
+             * the CIGAR, with field 0, is always wanted */
+            struct { unsigned field; size_t length; } part[5] = {
+                { NGS_BAM::OpenOptions::readName, rec.l_read_name() },
+                { 0, 4u * rec.nc() },
+                { NGS_BAM::OpenOptions::bases, (rec.l_seq() + 1u) >> 1 },
+                { NGS_BAM::OpenOptions::qualities, (size_t)rec.l_seq() },
+                { NGS_BAM::OpenOptions::tags, 0 }
+            };
+            size_t offset = BAMLayout::length_fixed_part;
+            
+            for (unsigned i = 0; i < 4; ++i)
+                offset += part[i].length;
+            if (offset > size)
+                throw std::runtime_error("file is corrupt: record is too small");
+            part[4].length = size - offset;
+            
+            /* neighboring parts that are both wanted or both not are read, or skipped, together */
+            offset = BAMLayout::length_fixed_part;
+            for (unsigned i = 0; i < 5; ) {
+                bool const wanted = part[i].field == 0 || (fields & part[i].field) != 0;
+                size_t length = 0;
+                
+                do {
+                    length += part[i++].length;
+                } while (i < 5 && wanted == (part[i].field == 0 || (fields & part[i].field) != 0));
+                
+                size_t const got = wanted ? ReadN(length, data->data + offset) : SkipN(length);
+                
+                if (got != length)
+                    throw std::runtime_error("file is truncated");
+                offset += length;
+            }
+        }
+    }
+    
+    NGS_BAM::OpenOptions::Validation const validation = file.options.validation;
+    
+    buffer.Measure(validation != NGS_BAM::OpenOptions::trusted || size < BAMLayout::length_fixed_part);
+    if (validation == NGS_BAM::OpenOptions::strict && !file.isGoodRecord(*buffer.record()))
+        throw std::runtime_error("file is corrupt: bad record");
+    /* one that only a program's tests on all of it reject */
+    if (filter.isActive() && filter.RejectsRest(*buffer.record()))
+        rejected = true;
+    Settle();
+    return buffer.record();
+}
+
+BAMRecord const *BAMFileCursor::ReadFixed(BAMRecordBuffer &buffer)
+{
+    int32_t datasize;
+    
+    if (!ReadI32(datasize)) // assumes cause is EOF
+        return 0;
+    if (datasize < (int32_t)BAMLayout::length_fixed_part)
+        throw std::runtime_error("file is corrupt: record is too small");
+    
+    uint32_t const size = (uint32_t)datasize;
+    SizedRawData *const data = buffer.Reserve(size);
+    size_t const rest = size - BAMLayout::length_fixed_part;
+    
+    if (!Read(BAMLayout::length_fixed_part, data->data) || SkipN(rest) != rest)
+        throw std::runtime_error("file is truncated");
+    Settle();
+    return buffer.record();
+}
+
+/* LooksLikeRecords
+ *  whether the records that start at "at" in an inflated block, up to
+ *  the first one that doesn't end in it, are well formed, which is as
+ *  good a sign as there is that a record starts there, short of having
+ *  read up to it; the first one's name has to be in the block
+ */
+static bool LooksLikeRecords(uint8_t const *const data, unsigned const size, unsigned at, int const refs)
+{
+    unsigned checked = 0;
+    
+    while (size - at >= 4 + BAMLayout::length_fixed_part) {
+        uint8_t const *const rec = data + at + 4;
+        int32_t const block_size = LE2Host<int32_t>(data + at);
+        int32_t const refID = LE2Host<int32_t>(rec + BAMLayout::start_refID);
+        int32_t const next_refID = LE2Host<int32_t>(rec + BAMLayout::start_next_refID);
+        int32_t const l_seq = LE2Host<int32_t>(rec + BAMLayout::start_l_seq);
+        unsigned const nl = rec[BAMLayout::start_nl];
+        unsigned const nc = LE2Host<uint16_t>(rec + BAMLayout::start_nc);
+        
+        if (block_size < (int32_t)BAMLayout::length_fixed_part || l_seq < 0 || nl < 1)
+            return false;
+        if (refID < -1 || refID >= refs || next_refID < -1 || next_refID >= refs)
+            return false;
+        if (LE2Host<int32_t>(rec + BAMLayout::start_pos) < -1 || LE2Host<int32_t>(rec + BAMLayout::start_next_pos) < -1)
+            return false;
+        if (BAMLayout::length_fixed_part + nl + 4 * (uint64_t)nc + ((uint64_t)l_seq + 1) / 2 + (uint64_t)l_seq > (uint64_t)block_size)
+            return false;
+        
+        unsigned const name = at + 4 + BAMLayout::length_fixed_part;
+        
+        if (size - name < nl)
+            break;
+        for (unsigned i = 0; i + 1 < nl; ++i) {
+            if (data[name + i] < '!' || data[name + i] > '~')
+                return false;
+        }
+        if (data[name + nl - 1] != 0)
+            return false;
+        ++checked;
+        
+        if ((uint64_t)(size - at) < 4 + (uint64_t)block_size)
+            return true;
+        at += 4 + (unsigned)block_size;
+    }
+    return checked > 0;
+}
+
+bool BAMFileCursor::FindRecord(uint64_t const limit)
+{
+    int const refs = (int)file.countOfReferences();
+    
+    for ( ; block && block->fpos < limit; ReadBlock()) {
+        for (unsigned at = bam_cur; at < block->size; ++at) {
+            if (LooksLikeRecords(block->data, block->size, at, refs)) {
+                bam_cur = at;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* ReadGroupLess
+ *  orders indices into a list of read group IDs by ID
+ */
+struct ReadGroupLess
+{
+    std::vector<std::string> const &IDs;
+    
+    explicit ReadGroupLess(std::vector<std::string> const &ids) : IDs(ids) {}
+    bool operator ()(unsigned const a, unsigned const b) const {
+        return IDs[a] < IDs[b];
+    }
+};
+
+/* ParseReadGroups
+ *  the ID of every @RG line of the header text, whose fields are
+ *  separated by tabs; a repeated ID is only counted once
+ */
+void BAMFile::ParseReadGroups(void)
+{
+    size_t line = 0;
+    
+    while (line < headerText.size()) {
+        size_t eol = headerText.find('\n', line);
+        if (eol == std::string::npos)
+            eol = headerText.size();
+        
+        if (headerText.compare(line, 4, "@RG\t") == 0) {
+            size_t field = line + 3;
+            
+            while (field < eol) {
+                size_t const beg = field + 1;
+                size_t end = headerText.find('\t', beg);
+                if (end == std::string::npos || end > eol)
+                    end = eol;
+                
+                if (end - beg > 3 && headerText.compare(beg, 3, "ID:") == 0) {
+                    if (FindReadGroup(headerText.data() + beg + 3, end - beg - 3) < 0) {
+                        unsigned const i = (unsigned)readGroups.size();
+                        
+                        readGroups.push_back(headerText.substr(beg + 3, end - beg - 3));
+                        readGroupOrder.insert(std::lower_bound(readGroupOrder.begin(), readGroupOrder.end(), i,
+                                                               ReadGroupLess(readGroups)), i);
+                    }
+                    break;
+                }
+                field = end;
+            }
+        }
+        line = eol + 1;
+    }
+}
+
+/* ParseSortOrder
+ *  the SO and GO fields of the @HD line, which has to be the first line
+ */
+void BAMFile::ParseSortOrder(void)
+{
+    if (headerText.compare(0, 4, "@HD\t") != 0)
+        return;
+    
+    size_t eol = headerText.find('\n');
+    if (eol == std::string::npos)
+        eol = headerText.size();
+    
+    for (size_t field = 3; field < eol; ) {
+        size_t const beg = field + 1;
+        size_t end = headerText.find('\t', beg);
+        if (end == std::string::npos || end > eol)
+            end = eol;
+        
+        std::string const value = headerText.substr(beg, end - beg);
+        if (value == "SO:queryname" || value == "GO:query")
+            collated = true;
+        if (value == "SO:coordinate")
+            sortOrder = NGS_BAM::coordinate;
+        else if (value == "SO:queryname")
+            sortOrder = NGS_BAM::queryname;
+        else if (value == "SO:unsorted")
+            sortOrder = NGS_BAM::unsorted;
+        field = end;
+    }
+}
+
+int BAMFile::FindReadGroup(char const name[], size_t const length) const
+{
+    size_t lo = 0;
+    size_t hi = readGroupOrder.size();
+    
+    while (lo < hi) {
+        size_t const mid = (lo + hi) / 2;
+        std::string const &ID = readGroups[readGroupOrder[mid]];
+        int const diff = ID.compare(0, ID.size(), name, length);
+        
+        if (diff == 0)
+            return (int)readGroupOrder[mid];
+        if (diff < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return -1;
+}
+
+bool BAMFile::isGoodRecord(BAMRecord const &rec) const
+{
+    if (rec.isTooSmall())
+        return false;
+    
+    int const refs = (int)references.size();
+    int const self_refID = rec.refID();
+    if (self_refID < -1 || self_refID >= refs || rec.pos() < -1)
+        return false;
+
+    int const mate_refID = rec.next_refID();
+    if (mate_refID < -1 || mate_refID >= refs || rec.next_pos() < -1)
+        return false;
+    
+    return rec.l_read_name() >= 1;
+}
+
+bool BAMFile::getShard(int const refID, unsigned const shard, unsigned const count, BAMFileChunk &rslt) const
+{
+    unsigned const first = refID < 0 ? 0 : (unsigned)refID;
+    unsigned const last = refID < 0 ? (unsigned)references.size() : (unsigned)refID + 1;
+    BAMFilePosTypeList starts;
+    BAMFileChunk extent;
+    bool indexed = false;
+    
+    for (unsigned i = first; i < last; ++i) {
+        BAMFileChunk ref;
+        
+        if (!references[i].getRecordStarts(starts, ref))
+            continue;
+        if (!indexed || ref.beg < extent.beg)
+            extent.beg = ref.beg;
+        if (!indexed || extent.end < ref.end)
+            extent.end = ref.end;
+        indexed = true;
+    }
+    if (!indexed || count == 0 || shard >= count)
+        return false;
+    
+    /* the whole file also has the records before and after the indexed ones */
+    BAMFilePosType const beg = refID < 0 ? BAMFilePosType(((uint64_t)first_bpos << 16) | first_bam_cur) : extent.beg;
+    BAMFilePosType const end = refID < 0 ? BAMFilePosType(~(uint64_t)0) : extent.end;
+    
+    std::sort(starts.begin(), starts.end());
+    
+    /* the boundaries divide the compressed bytes of the indexed records evenly */
+    uint64_t const lo = beg.fpos();
+    uint64_t const hi = extent.end.fpos() > lo ? extent.end.fpos() : lo;
+    BAMFilePosTypeList::const_iterator const after = std::upper_bound(starts.begin(), starts.end(), beg);
+    BAMFilePosType bound[2];
+    
+    for (unsigned k = 0; k < 2; ++k) {
+        unsigned const n = shard + k;
+        
+        if (n == 0)
+            bound[k] = beg;
+        else if (n == count)
+            bound[k] = end;
+        else {
+            uint64_t const target = lo + (uint64_t)((double)(hi - lo) * n / count);
+            BAMFilePosTypeList::const_iterator i = std::lower_bound(starts.begin(), starts.end(), BAMFilePosType(target << 16));
+            
+            if (i < after)
+                i = after;
+            bound[k] = (i != starts.end() && *i < end) ? *i : end;
+        }
+    }
+    rslt = BAMFileChunk(bound[0], bound[1]);
+    return true;
+}
+
+void BAMFile::CountFlags(BAMFlagStats &stats) const
+{
+    BAMFileCursor scan(*this);
+    BAMRecordBuffer buffer;
+    
+    while (BAMRecord const *const rec = scan.ReadFixed(buffer))
+        stats.Add(*rec);
+}
+
+/* FindBlock
+ *  where the first BGZF block at or after fpos is in a local file, or
+ *  "end" if there is none before it; as blocks are at most BAM_BLK_MAX
+ *  bytes, one starts in that many, and a header is only taken for one
+ *  if another follows where its size says or the file ends there
+ */
+static uint64_t FindBlock(ByteSource &source, uint64_t const fpos, uint64_t const end)
+{
+    std::vector<uint8_t> buffer(2 * BAM_BLK_MAX + 18);
+    size_t have = 0;
+    
+    while (have < buffer.size()) {
+        size_t const nread = source.Read(fpos + have, &buffer[have], buffer.size() - have);
+        if (nread == 0)
+            break;
+        have += nread;
+    }
+    for (size_t i = 0; i + 18 <= have && i < BAM_BLK_MAX; ++i) {
+        uint8_t const *const hdr = &buffer[i];
+        
+        if (hdr[0] != 31 || hdr[1] != 139 || hdr[2] != 8 || (hdr[3] & 4) == 0)
+            continue;
+        if (LE2Host<uint16_t>(hdr + 10) != 6 || hdr[12] != 'B' || hdr[13] != 'C' || LE2Host<uint16_t>(hdr + 14) != 2)
+            continue;
+        
+        size_t const next = i + LE2Host<uint16_t>(hdr + 16) + 1;
+        
+        if (fpos + next == end)
+            return fpos + i;
+        if (next + 4 <= have && buffer[next] == 31 && buffer[next + 1] == 139 && buffer[next + 2] == 8 && (buffer[next + 3] & 4) != 0)
+            return fpos + i;
+    }
+    return end;
+}
+
+/* UnorderedScan
+ *  the threads of BAMFile::ScanUnordered and what they tell each other,
+ *  which is where the first record of each range is once its thread
+ *  has found it: the thread of the range before reads up to there
+ */
+class UnorderedScan
+{
+    enum State { looking, found, none };
+    struct Range {
+        uint64_t from;              /* where its blocks start */
+        BAMFilePosType start;       /* its first record, once found */
+        State state;
+    };
+    struct Start {
+        UnorderedScan *scan;
+        unsigned range;
+    };
+    
+    BAMFile const &file;
+    std::string const path;
+    BAMFilePosType const first;     /* the first record of the file */
+    uint64_t const end;             /* of the file */
+    std::vector<NGS_BAM::ScanConsumer *> const &consumers;
+    std::vector<Range> ranges;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool failed;
+    std::string error;
+    
+    UnorderedScan(UnorderedScan const &);
+    UnorderedScan &operator =(UnorderedScan const &);
+    
+    static void *Body(void *const arg) {
+        Start const *const start = reinterpret_cast<Start const *>(arg);
+        
+        start->scan->Work(start->range);
+        return 0;
+    }
+    
+    void Fail(std::string const &what) {
+        pthread_mutex_lock(&lock);
+        if (!failed) {
+            error = what;
+            __atomic_store_n(&failed, true, __ATOMIC_RELAXED);
+        }
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+    }
+    
+    /* Publish
+     *  where range k starts, if it wasn't already said
+     */
+    void Publish(unsigned const k, State const state, BAMFilePosType const start) {
+        pthread_mutex_lock(&lock);
+        if (ranges[k].state == looking) {
+            ranges[k].state = state;
+            ranges[k].start = start;
+        }
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+    }
+    
+    /* Await
+     *  range k once its thread has looked for its first record
+     *  returns false if the scan has failed meanwhile
+     */
+    bool Await(unsigned const k, Range &rslt) {
+        pthread_mutex_lock(&lock);
+        while (ranges[k].state == looking && !failed)
+            pthread_cond_wait(&changed, &lock);
+        rslt = ranges[k];
+        bool const ok = !failed;
+        pthread_mutex_unlock(&lock);
+        return ok;
+    }
+    
+    void Work(unsigned const k) {
+        try {
+            Read(k);
+        }
+        catch (std::exception const &e) {
+            Fail(e.what());
+        }
+        catch (...) {
+            Fail("unknown error in scan");
+        }
+        Publish(k, none, BAMFilePosType());
+    }
+    
+    /* Read
+     *  the records of range k: from its first one up to the first one
+     *  of the next range that has any, or the end of the file
+     */
+    void Read(unsigned const k) {
+        uint64_t const limit = k + 1 < ranges.size() ? ranges[k + 1].from : end;
+        uint64_t block = first.fpos();
+        
+        if (k > 0) {
+            FileSource source(path);
+            
+            block = FindBlock(source, ranges[k].from, end);
+            if (block >= limit)
+                return;
+        }
+        BAMFileCursor cursor(file, k == 0 ? first : BAMFilePosType(block << 16));
+        
+        if (k > 0 && !cursor.FindRecord(limit))
+            return;
+        Publish(k, found, cursor.Tell());
+        
+        NGS_BAM::ScanConsumer &consumer = *consumers[k];
+        BAMRecordBuffer buffer;
+        BAMFilePosType stop(~(uint64_t)0);
+        bool bounded = false;
+        size_t next = k + 1;
+        
+        while (!__atomic_load_n(&failed, __ATOMIC_RELAXED)) {
+            BAMFilePosType const pos = cursor.Tell();
+            
+            /* no record of a later range starts before its blocks do */
+            while (!bounded && next < ranges.size() && pos.fpos() >= ranges[next].from) {
+                Range range;
+                
+                if (!Await((unsigned)next, range))
+                    return;
+                if (range.state == found) {
+                    stop = range.start;
+                    bounded = true;
+                }
+                else
+                    ++next;
+            }
+            if (bounded && !(pos < stop)) {
+                if (stop < pos)
+                    throw std::runtime_error("file is corrupt: records don't line up with their blocks");
+                break;
+            }
+            
+            BAMRecord const *const rec = cursor.Read(buffer);
+            
+            if (!rec) {
+                if (bounded)
+                    throw std::runtime_error("file is truncated");
+                break;
+            }
+            NGS_BAM::RawRecord const raw = { rec->rawData(), rec->rawSize() };
+            consumer.consume(raw);
+        }
+    }
+    
+public:
+    UnorderedScan(BAMFile const &File, std::string const &Path, BAMFilePosType const First, uint64_t const End,
+                  std::vector<NGS_BAM::ScanConsumer *> const &Consumers, unsigned const count)
+    : file(File)
+    , path(Path)
+    , first(First)
+    , end(End)
+    , consumers(Consumers)
+    , ranges(count)
+    , failed(false)
+    {
+        /* the bytes after the header are shared out evenly */
+        uint64_t const beg = first.fpos();
+        
+        for (unsigned k = 0; k < count; ++k) {
+            ranges[k].from = beg + (uint64_t)((double)(end - beg) * k / count);
+            ranges[k].state = looking;
+        }
+        pthread_mutex_init(&lock, 0);
+        pthread_cond_init(&changed, 0);
+    }
+    ~UnorderedScan() {
+        pthread_cond_destroy(&changed);
+        pthread_mutex_destroy(&lock);
+    }
+    
+    /* Run
+     *  range 0 is read by the calling thread
+     */
+    void Run() {
+        std::vector<pthread_t> threads(ranges.size());
+        std::vector<Start> starts(ranges.size());
+        size_t started = 1;
+        
+        for ( ; started < ranges.size(); ++started) {
+            starts[started].scan = this;
+            starts[started].range = (unsigned)started;
+            if (pthread_create(&threads[started], 0, Body, &starts[started]) != 0) {
+                Fail("can't start a thread");
+                break;
+            }
+        }
+        Work(0);
+        for (size_t i = 1; i < started; ++i)
+            pthread_join(threads[i], 0);
+        
+        if (failed)
+            throw std::runtime_error(error);
+    }
+};
+
+void BAMFile::ScanUnordered(std::vector<NGS_BAM::ScanConsumer *> const &consumers) const
+{
+    if (consumers.empty())
+        return;
+    
+    BAMFilePosType const first(((uint64_t)first_bpos << 16) | first_bam_cur);
+    uint64_t end = ~(uint64_t)0;
+    unsigned count = 1;
+    struct stat st;
+    
+    /* only a local file can be read anywhere at once; no range is
+     * smaller than a block, as it would have no block of its own */
+    if (consumers.size() > 1 && !stream && !isSAM() && !isFollowed() && !ByteSource::IsURL(path) &&
+        stat(path.c_str(), &st) == 0 && (uint64_t)st.st_size > first.fpos())
+    {
+        uint64_t const blocks = ((uint64_t)st.st_size - first.fpos()) / BAM_BLK_MAX + 1;
+        
+        end = (uint64_t)st.st_size;
+        count = blocks < consumers.size() ? (unsigned)blocks : (unsigned)consumers.size();
+    }
+    UnorderedScan scan(*this, path, first, end, consumers, count);
+    
+    scan.Run();
+}
+
+char const *BAMFlagStats::Name(Counter const what)
+{
+    static char const *const names[counters] = {
+        "TOTAL", "PRIMARY", "SECONDARY", "SUPPLEMENTARY", "DUPLICATES", "PRIMARY_DUPLICATES",
+        "MAPPED", "PRIMARY_MAPPED", "PAIRED", "READ1", "READ2", "PROPERLY_PAIRED",
+        "WITH_MATE_MAPPED", "SINGLETONS", "MATE_ON_OTHER_REFERENCE", "MATE_ON_OTHER_REFERENCE_MAPQ5"
+    };
+    return names[what];
+}
+
+CoverageMap const *BAMFile::getCoverageMap() const
+{
+    if (!__atomic_load_n(&coverageMapped, __ATOMIC_ACQUIRE)) {
+        std::vector<uint64_t> lengths(references.size());
+        
+        for (size_t i = 0; i < references.size(); ++i)
+            lengths[i] = references[i].getLength();
+        
+        pthread_mutex_lock(&indexLock);
+        if (!coverageMapped && !stream && coverageMap.Map(path, lengths))
+            __atomic_store_n(&coverageMapped, true, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&indexLock);
+    }
+    return coverageMapped ? &coverageMap : 0;
 }
 
-void BAMFile::ReadHeader(void) {
-    CheckHeaderSignature();
+bool BAMFile::getSampleUnits(BAMFilePosTypeList &units, std::vector<double> &weights) const
+{
+    double total = 0;
     
-    {
-        int32_t const l_text = ReadI32();
-        if (l_text < 0)
-            throw std::runtime_error("header text length < 0");
-        
-        char *const text = new char[l_text];
-        if (!Read(l_text, text))
-            throw std::runtime_error("file is truncated");
-        
-        headerText = text;
-        delete [] text;
+    indexLoad.Await();
+    if (!zones.empty()) {
+        for (size_t i = 0; i < zones.size(); ++i) {
+            units.push_back(BAMFilePosType(zones[i].start));
+            total += zones[i].count;
+            weights.push_back(total);
+        }
+        units.push_back(BAMFilePosType(~(uint64_t)0));
+        return true;
     }
-    int32_t const n_ref = ReadI32();
-    if (n_ref < 0)
-        throw std::runtime_error("header reference count < 0");
     
-    references.reserve(n_ref);
+    BAMFilePosTypeList starts;
+    BAMFilePosType end;
+    bool indexed = false;
     
-    for (int i = 0; i < n_ref; ++i) {
-        int32_t const l_name = ReadI32();
+    for (unsigned i = 0; i < references.size(); ++i) {
+        BAMFileChunk ref;
         
-        if (l_name < 0)
-            throw std::runtime_error("header reference name length < 0");
-        
-        char *const name = new char[l_name];
-        if (!Read(l_name, name))
-            throw std::runtime_error("file is truncated");
-        
-        int32_t const l_ref = ReadI32();
-        if (l_ref < 0)
-            throw std::runtime_error("header reference length < 0");
+        if (!references[i].getRecordStarts(starts, ref))
+            continue;
+        if (!indexed || end < ref.end)
+            end = ref.end;
+        indexed = true;
+    }
+    if (!indexed)
+        return false;
+    
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+    for (size_t i = 0; i < starts.size() && starts[i] < end; ++i) {
+        BAMFilePosType const beg = starts[i];
+        BAMFilePosType const next = i + 1 < starts.size() && starts[i + 1] < end ? starts[i + 1] : end;
+        /* a compressed byte inflates to about three */
+        double const bytes = (double)(next.fpos() - beg.fpos()) + ((double)next.bpos() - beg.bpos()) / 3;
         
-        references.push_back(HeaderRefInfo(name, l_ref));
-        referencesByName[name] = i;
+        units.push_back(beg);
+        total += bytes > 1 ? bytes : 1;
+        weights.push_back(total);
+    }
+    units.push_back(end);
+    return !weights.empty();
+}
+
+bool BAMFile::getUnplaced(BAMFilePosType &start, uint64_t &count) const
+{
+    BAMFilePosType end(((uint64_t)first_bpos << 16) | first_bam_cur);
+    bool indexed = false;
+    
+    indexLoad.Await();              /* for n_no_coor */
+    for (unsigned i = 0; i < references.size(); ++i) {
+        BAMFileChunk ref;
         
-        delete [] name;
+        if (!references[i].hasIndex())
+            continue;
+        indexed = true;
+        if (references[i].getExtent(ref) && end < ref.end)
+            end = ref.end;
     }
+    if (!indexed)
+        return false;
+    
+    start = end;
+    count = has_no_coor ? n_no_coor : UINT64_MAX;
+    return true;
 }
 
-void BAMFile::LoadIndexData(size_t const fsize, char const data[]) {
-    char const *const endp = data + fsize;
+/* MatePositionLess
+ *  orders indices into a list of mate requests by the mate's position
+ */
+struct MatePositionLess
+{
+    BAMMateRequestList const &requests;
     
-    if (memcmp(data, "BAI\1", 4) != 0)
-        return;
+    explicit MatePositionLess(BAMMateRequestList const &Requests) : requests(Requests) {}
+    bool operator ()(unsigned const a, unsigned const b) const {
+        BAMMateRequest const &A = requests[a];
+        BAMMateRequest const &B = requests[b];
+        
+        return A.mateRefID < B.mateRefID || (A.mateRefID == B.mateRefID && A.matePos < B.matePos);
+    }
+};
+
+void BAMFile::FindMates(BAMMateRequestList &requests) const
+{
+    std::vector<unsigned> order;
     
-    int32_t const n_ref = LE2Host<int32_t>(data + 4);
-    if (n_ref != references.size())
+    for (unsigned i = 0; i < requests.size(); ++i) {
+        BAMMateRequest &req = requests[i];
+        
+        req.found = false;
+        if (req.mateRefID >= 0 && (unsigned)req.mateRefID < references.size() && req.matePos >= 0)
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), MatePositionLess(requests));
+    
+    // the cursor starts where the first mate that the index can place is
+    BAMFileChunkList chunks;
+    size_t k = 0;
+    
+    for ( ; k < order.size(); ++k) {
+        BAMMateRequest const &req = requests[order[k]];
+        
+        chunks = references[req.mateRefID].slice(req.matePos, req.matePos + 1);
+        if (!chunks.empty())
+            break;
+    }
+    if (k == order.size())
         return;
     
-    size_t offset = 8;
+    BAMFileCursor cursor(*this, chunks[0].beg);
+    BAMRecordBuffer buffer;
+    BAMRecord const *rec = 0;       /* read, but past the last position looked at */
+    BAMFilePosType recPos;
     
-    for (int i = 0; i < n_ref; ++i) {
-        size_t const size = references[i].LoadIndex(data + offset, endp);
+    while (k < order.size()) {
+        int32_t const refID = requests[order[k]].mateRefID;
+        int32_t const pos = requests[order[k]].matePos;
+        size_t end = k + 1;
         
-        offset += size;
-        if (size == 0) {
-            std::cerr << "failed to load index #" << (i + 1) << std::endl;
-            for (int j = 0; j < i; ++j)
-                references[j].DropIndex();
-            return;
+        while (end < order.size() && requests[order[end]].mateRefID == refID && requests[order[end]].matePos == pos)
+            ++end;
+        
+        chunks = references[refID].slice(pos, pos + 1);
+        if (!chunks.empty()) {
+            // the records before the cursor are all at earlier positions
+            if ((rec ? recPos : cursor.Tell()) < chunks[0].beg) {
+                cursor.Seek(chunks[0].beg);
+                rec = 0;
+            }
+            // records of the reference before the position are only skipped over
+            BAMRecordFilter filter;
+            
+            filter.refID = refID;
+            filter.beg = pos;
+            filter.end = pos + 1;
+            for ( ; ; ) {
+                if (!rec) {
+                    bool rejected;
+                    
+                    recPos = cursor.Tell();
+                    rec = cursor.Read(buffer, NGS_BAM::OpenOptions::readName, filter, rejected);
+                    if (!rec)
+                        break;
+                    if (rejected) {
+                        rec = 0;
+                        continue;
+                    }
+                }
+                int32_t const REFID = rec->refID();
+                
+                if (REFID >= 0 && (REFID < refID || (REFID == refID && rec->pos() < pos))) {
+                    rec = 0;
+                    continue;
+                }
+                if (REFID != refID || rec->pos() != pos)
+                    break;
+                for (size_t i = k; i < end; ++i) {
+                    BAMMateRequest &req = requests[order[i]];
+                    
+                    if (!req.found && req.isMate(*rec)) {
+                        req.mate = recPos;
+                        req.found = true;
+                    }
+                }
+                rec = 0;
+            }
         }
+        k = end;
     }
 }
 
-void BAMFile::LoadIndex(std::string const &filepath) {
-    char *data;
-    size_t fsize;
-    {
-        std::string const idxpath(filepath+".bai");
-        std::ifstream ifile;
-        
-        ifile.open(idxpath.c_str(), std::ifstream::in | std::ifstream::binary);
-        if (!ifile.is_open())
-            return;
-        
-        std::filebuf *const buf = ifile.rdbuf();
-        fsize = buf->pubseekoff(0, ifile.end, ifile.in);
-        
-        if (fsize < 8)
-            return;
-        
-        buf->pubseekpos(0, ifile.in);
-        
-        data = new char[fsize];
-        buf->sgetn(data, fsize);
+struct BAMTemplateReader::Held
+{
+    BAMTemplateSegment seg;
+    uint32_t hash;
+    size_t bytes;                   /* what it counts for against the limit */
+    Held *chain;
+    Held *older;
+    Held *newer;
+};
+
+BAMTemplateReader::BAMTemplateReader(BAMFile const &file, unsigned const Fields, size_t const Limit)
+: cursor(file)
+, memory(file.getMemory())
+, fields(Fields | NGS_BAM::OpenOptions::readName)
+, collated(file.isCollated())
+, sorted(file.getSortOrder() == NGS_BAM::coordinate)
+, limit(Limit)
+, unplaced(false)
+, buckets(collated ? 0 : 1024, (Held *)0)
+, oldest(0)
+, newest(0)
+, spare(0)
+, count(0)
+, heldBytes(0)
+, peakBytes(0)
+, evictions(0)
+, eof(false)
+{
+}
+
+BAMTemplateReader::BAMTemplateReader(BAMFile const &file, unsigned const Fields, size_t const Limit,
+                                     BAMFilePosType const start)
+: cursor(file, start)
+, memory(file.getMemory())
+, fields(Fields | NGS_BAM::OpenOptions::readName)
+, collated(file.isCollated())
+, sorted(file.getSortOrder() == NGS_BAM::coordinate)
+, limit(Limit)
+, unplaced(true)
+, buckets(collated ? 0 : 1024, (Held *)0)
+, oldest(0)
+, newest(0)
+, spare(0)
+, count(0)
+, heldBytes(0)
+, peakBytes(0)
+, evictions(0)
+, eof(false)
+{
+}
+
+BAMTemplateReader::~BAMTemplateReader()
+{
+    memory.Remove(MemoryLedger::mateBuffer, heldBytes);
+    while (oldest) {
+        Held *const next = oldest->newer;
+        delete oldest;
+        oldest = next;
     }
-    LoadIndexData(fsize, data);
-    delete [] data;
+    while (spare) {
+        Held *const next = spare->chain;
+        delete spare;
+        spare = next;
+    }
+}
+
+static uint32_t HashName(BAMRecord const &rec)
+{
+    return HashName(rec.readname(), strnlen(rec.readname(), rec.l_read_name()));
 }
 
-BAMFile::BAMFile(std::string const &filepath)
+/* MateBehind
+ *  the mate of "rec" is placed before it, so in a file sorted by
+ *  coordinate it has been read
+ */
+static bool MateBehind(BAMRecord const &rec)
 {
-    InflateInit();
+    int32_t const refID = rec.refID();
+    int32_t const mateRefID = rec.next_refID();
     
-#if USE_STDIO
-    file = fopen(filepath.c_str(), "rb");
-    if (file == NULL)
-        throw std::runtime_error(std::string("The file '")+filepath+"' could not be opened");
-#else
-    file.open(filepath.c_str(), std::ifstream::in | std::ifstream::binary);
-    if (!file.is_open())
-        throw std::runtime_error(std::string("The file '")+filepath+"' could not be opened");
-#endif
+    if (refID < 0 || mateRefID < 0)
+        return false;
+    return mateRefID < refID || (mateRefID == refID && rec.next_pos() < rec.pos());
+}
 
-    ReadHeader();
-    first_bpos = cpos + (zs.next_in - iobuffer);
-    first_bam_cur = bam_cur;
-    LoadIndex(filepath);
+/* Find
+ *  the held record that is rec's mate: the same name and the other segment
+ */
+BAMTemplateReader::Held *BAMTemplateReader::Find(BAMRecord const &rec, uint32_t const hash) const
+{
+    char const *const name = rec.readname();
+    size_t const length = strnlen(name, rec.l_read_name());
+    Held *held = collated ? newest : buckets[hash & (buckets.size() - 1)];
+    
+    for ( ; held; held = collated ? 0 : held->chain) {
+        BAMRecord const &other = *held->seg.record();
+        
+        if ((collated || held->hash == hash) &&
+            ((other.flag() ^ rec.flag()) & 0x00C0) == 0x00C0 &&
+            strnlen(other.readname(), other.l_read_name()) == length &&
+            memcmp(other.readname(), name, length) == 0)
+        {
+            return held;
+        }
+    }
+    return 0;
 }
 
-BAMFile::~BAMFile()
+void BAMTemplateReader::Rehash(void)
 {
-    inflateEnd(&zs);
+    std::vector<Held *> grown(2 * buckets.size(), (Held *)0);
+    size_t const mask = grown.size() - 1;
+    
+    for (Held *held = oldest; held; held = held->newer) {
+        held->chain = grown[held->hash & mask];
+        grown[held->hash & mask] = held;
+    }
+    buckets.swap(grown);
 }
 
-BAMRecord const *BAMFile::Read()
+/* Hold
+ *  keep the record in "seg", giving "seg" storage in its place
+ */
+void BAMTemplateReader::Hold(BAMTemplateSegment &seg, uint32_t const hash)
 {
-    union aligned_BAMRecord {
-        SizedRawData raw;
-        BAMRecord record;
-        struct {
-            uint8_t align[16];
-        } align;
-    };
-    int32_t datasize;
+    if (!collated && count >= buckets.size())
+        Rehash();
     
-    if (!ReadI32(datasize)) // assumes cause is EOF
-        return 0;
+    Held *held = spare;
     
-    if (datasize < 0)
-        throw std::runtime_error("file is corrupt: record size < 0");
+    if (held)
+        spare = held->chain;
+    else
+        held = new Held();
+    
+    held->seg.buffer.Swap(seg.buffer);
+    held->seg.pos = seg.pos;
+    held->hash = hash;
+    held->bytes = sizeof(Held) + held->seg.buffer.size();
+    held->older = newest;
+    held->newer = 0;
+    if (newest)
+        newest->newer = held;
+    else
+        oldest = held;
+    newest = held;
+    
+    if (!collated) {
+        Held *&bucket = buckets[hash & (buckets.size() - 1)];
+        held->chain = bucket;
+        bucket = held;
+    }
+    ++count;
+    heldBytes += held->bytes;
+    memory.Add(MemoryLedger::mateBuffer, held->bytes);
+    if (peakBytes < heldBytes)
+        peakBytes = heldBytes;
+}
 
-    uint32_t const size = (uint32_t)datasize;
+/* Unhold
+ *  hand a held record back in "seg"
+ */
+void BAMTemplateReader::Unhold(Held *const held, BAMTemplateSegment &seg)
+{
+    if (!collated) {
+        Held **link = &buckets[held->hash & (buckets.size() - 1)];
+        
+        while (*link != held)
+            link = &(*link)->chain;
+        *link = held->chain;
+    }
+    (held->older ? held->older->newer : oldest) = held->newer;
+    (held->newer ? held->newer->older : newest) = held->older;
+    --count;
+    heldBytes -= held->bytes;
+    memory.Remove(MemoryLedger::mateBuffer, held->bytes);
     
-    union aligned_BAMRecord *data = new aligned_BAMRecord[(size + sizeof(uint32_t) + sizeof(aligned_BAMRecord) - 1)/sizeof(aligned_BAMRecord)];
-    data->raw.size = size;
-    if (Read(size, data->raw.data))
-        return &data->record;
+    seg.buffer.Swap(held->seg.buffer);
+    seg.pos = held->seg.pos;
+    held->chain = spare;
+    spare = held;
+}
 
-    delete [] data;
-    throw std::runtime_error("file is truncated");
+unsigned BAMTemplateReader::Next(BAMTemplateSegment seg[2])
+{
+    for ( ; ; ) {
+        bool const full = heldBytes > limit || (!collated && oldest && MemoryLedger::OverBudget());
+        
+        if (oldest && (eof || full || (collated && oldest != newest))) {
+            if (!eof && full)
+                ++evictions;
+            Unhold(oldest, seg[0]);
+            return 1;
+        }
+        if (eof)
+            return 0;
+        
+        seg[0].pos = cursor.Tell();
+        
+        BAMRecord const *const rec = cursor.Read(seg[0].buffer, fields);
+        if (!rec) {
+            eof = true;
+            continue;
+        }
+        
+        int const flag = rec->flag();
+        
+        if ((flag & 0x0900) != 0 || (unplaced && rec->refID() >= 0))
+            continue;
+        // unpaired, or with no telling which segment it is
+        if ((flag & 0x0001) == 0 || (flag & 0x00C0) == 0 || (flag & 0x00C0) == 0x00C0)
+            return 1;
+        
+        uint32_t const hash = collated ? 0 : HashName(*rec);
+        Held *const mate = Find(*rec, hash);
+        
+        if (!mate) {
+            if (sorted && MateBehind(*rec))
+                return 1;
+            Hold(seg[0], hash);
+            continue;
+        }
+        // the first segment comes first
+        if ((flag & 0x0040) != 0) {
+            Unhold(mate, seg[1]);
+        }
+        else {
+            seg[1].buffer.Swap(seg[0].buffer);
+            seg[1].pos = seg[0].pos;
+            Unhold(mate, seg[0]);
+        }
+        return 2;
+    }
 }
 
-bool BAMFile::isGoodRecord(BAMRecord const &rec)
+void BAMTemplateReader::Checkpoint(std::vector<BAMFilePosType> &held, BAMFilePosType &next) const
 {
-    if (rec.isTooSmall())
-        return false;
-    
-    unsigned const refs = (unsigned)references.size();
-    unsigned const flag = rec.flag();
-    int const self_refID = rec.refID();
-    if ((flag & 0x40) != 0 && self_refID > 0 && self_refID >= refs)
-        return false;
+    held.clear();
+    for (Held const *h = oldest; h; h = h->newer)
+        held.push_back(h->seg.pos);
+    next = eof ? BAMFilePosType() : cursor.Tell();
+}
 
-    int const mate_refID = rec.next_refID();
-    if ((flag & 0x80) != 0 && mate_refID > 0 && mate_refID >= refs)
-        return false;
+void BAMTemplateReader::Resume(std::vector<BAMFilePosType> const &held, BAMFilePosType const next)
+{
+    BAMTemplateSegment seg;
     
-    return true;
+    while (oldest)
+        Unhold(oldest, seg);
+    for (size_t i = 0; i < held.size(); ++i) {
+        cursor.Seek(held[i]);
+        seg.pos = held[i];
+        
+        BAMRecord const *const rec = cursor.Read(seg.buffer, fields);
+        if (!rec || (rec->flag() & 0x0001) == 0)
+            throw std::runtime_error("cursor does not match the file");
+        Hold(seg, collated ? 0 : HashName(*rec));
+    }
+    eof = !next.hasValue();
+    if (!eof)
+        cursor.Seek(next);
 }
 
-BAMRecordSource *BAMFile::Slice(const std::string &rname, unsigned start, unsigned last)
+BAMRecordSource *BAMFile::Slice(const std::string &rname, unsigned start, unsigned last) const
 {
     int const refID = getReferenceIndexByName(rname);
     
@@ -697,16 +3506,306 @@ BAMRecordSource *BAMFile::Slice(const std::string &rname, unsigned start, unsign
     if (last == 0)
         last = ri.length;
     
-    if (!ri.index || start >= ri.length)
+    if (!ri.hasIndex() || start >= ri.length)
         return new BAMRecordSource();
 
     if (last > start + ri.length)
         last = start + ri.length;
     
-    BAMFilePosTypeList const &index = ri.slice(start, last);
+    BAMFileChunkList const &index = ri.slice(start, last);
     
     if (index.size() == 0)
         return new BAMRecordSource();
     
     return new BAMFileSlice(*this, refID, start, last, index);
 }
+
+void BAMFile::WillNeed(std::vector<BAMFileChunkList> const &regions) const
+{
+    if (stream || samText.isSAM())
+        return;
+    
+    std::vector<std::pair<uint64_t, uint64_t> > ranges;     /* compressed bytes, from and to */
+    
+    for (size_t i = 0; i < regions.size(); ++i) {
+        for (BAMFileChunkList::const_iterator j = regions[i].begin(); j != regions[i].end(); ++j) {
+            if (j->beg.fpos() <= j->end.fpos())
+                ranges.push_back(std::make_pair(j->beg.fpos(), j->end.fpos() + BAM_BLK_MAX));
+        }
+    }
+    if (ranges.empty())
+        return;
+    std::sort(ranges.begin(), ranges.end());
+    
+    try {
+        BGZFReader reader(path, 0, options.useMmap, 0, &blockCache, options.verifyCRC, &ioStats,
+                          BAM_BLK_MAX, false, false, &memory);
+        uint64_t beg = ranges[0].first;
+        uint64_t end = ranges[0].second;
+        
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            if (ranges[i].first <= end) {
+                if (end < ranges[i].second)
+                    end = ranges[i].second;
+                continue;
+            }
+            reader.Advise(beg, end - beg);
+            beg = ranges[i].first;
+            end = ranges[i].second;
+        }
+        reader.Advise(beg, end - beg);
+        
+        if (options.blockCache == 0)
+            return;
+        for (size_t i = 0; i < regions.size(); ++i) {
+            if (regions[i].empty())
+                continue;
+            reader.Seek(regions[i].front().beg.fpos());
+            reader.Next();
+        }
+    }
+    catch (std::exception const &) {
+        /* only a hint */
+    }
+}
+
+static void AppendLE(std::string &dst, uint64_t value, unsigned const size)
+{
+    for (unsigned i = 0; i < size; ++i, value >>= 8)
+        dst.push_back((char)(value & 0xFF));
+}
+
+static void PutLE32(uint8_t *const dst, uint32_t const value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+uint32_t BAMIndexBuilder::Bin(int32_t const beg, int32_t end)
+{
+    --end;
+    if (beg >> 14 == end >> 14) return ((1 << 15) - 1) / 7 + (beg >> 14);
+    if (beg >> 17 == end >> 17) return ((1 << 12) - 1) / 7 + (beg >> 17);
+    if (beg >> 20 == end >> 20) return ((1 <<  9) - 1) / 7 + (beg >> 20);
+    if (beg >> 23 == end >> 23) return ((1 <<  6) - 1) / 7 + (beg >> 23);
+    if (beg >> 26 == end >> 26) return ((1 <<  3) - 1) / 7 + (beg >> 26);
+    return 0;
+}
+
+BAMIndexBuilder::BAMIndexBuilder(unsigned const referenceCount)
+: refs(referenceCount)
+, n_no_coor(0)
+, lastRefID(0)
+, lastPos(-1)
+, sorted(true)
+{
+}
+
+void BAMIndexBuilder::Add(int32_t const refID, BAMRecord const &rec, uint64_t const beg, uint64_t const end)
+{
+    int32_t const pos = rec.pos() < 0 ? 0 : rec.pos();
+    
+    /* records without a reference come last, in any order */
+    if ((uint32_t)refID < (uint32_t)lastRefID || (refID == lastRefID && refID >= 0 && pos < lastPos))
+        sorted = false;
+    lastRefID = refID;
+    lastPos = pos;
+    
+    if (refID < 0 || (unsigned)refID >= refs.size()) {
+        ++n_no_coor;
+        return;
+    }
+    
+    Ref &ref = refs[refID];
+    bool const unmapped = (rec.flag() & 0x0004) != 0;
+    unsigned const refLen = unmapped ? 0 : rec.refLen();
+    int32_t const last = pos + (refLen > 0 ? refLen : 1);
+    std::vector<Chunk> &chunks = ref.bins[Bin(pos, last)];
+    
+    if (!chunks.empty() && chunks.back().end >> 16 == beg >> 16)
+        chunks.back().end = end;
+    else {
+        Chunk const chunk = { beg, end };
+        chunks.push_back(chunk);
+    }
+    
+    unsigned const window = (unsigned)(last - 1) >> 14;
+    
+    if (ref.linear.size() <= window)
+        ref.linear.resize(window + 1, 0);
+    for (unsigned i = (unsigned)pos >> 14; i <= window; ++i) {
+        if (ref.linear[i] == 0)
+            ref.linear[i] = beg;
+    }
+    
+    if (ref.n_mapped + ref.n_unmapped == 0)
+        ref.extent.beg = beg;
+    ref.extent.end = end;
+    if (unmapped)
+        ++ref.n_unmapped;
+    else
+        ++ref.n_mapped;
+}
+
+/* FileOffset
+ *  an offset of the builder's as a file position
+ */
+static uint64_t FileOffset(BGZFWriter const *const file, uint64_t const offset)
+{
+    return file ? file->FileOffset(offset) : offset;
+}
+
+/* Encode
+ *  a linear index entry left at 0 has no record starting in its window
+ *  and takes the offset of the entry before it; the counts go in the
+ *  pseudo-bin, as samtools writes them
+ */
+void BAMIndexBuilder::Encode(std::string &data, BGZFWriter const *const file) const
+{
+    static uint32_t const pseudo_bin = 37450;
+    
+    data.assign("BAI\1", 4);
+    
+    AppendLE(data, refs.size(), 4);
+    for (unsigned i = 0; i < refs.size(); ++i) {
+        Ref const &ref = refs[i];
+        bool const used = ref.n_mapped + ref.n_unmapped > 0;
+        
+        AppendLE(data, ref.bins.size() + (used ? 1 : 0), 4);
+        for (std::map<uint32_t, std::vector<Chunk> >::const_iterator j = ref.bins.begin(); j != ref.bins.end(); ++j) {
+            AppendLE(data, j->first, 4);
+            AppendLE(data, j->second.size(), 4);
+            for (unsigned k = 0; k < j->second.size(); ++k) {
+                AppendLE(data, FileOffset(file, j->second[k].beg), 8);
+                AppendLE(data, FileOffset(file, j->second[k].end), 8);
+            }
+        }
+        if (used) {
+            AppendLE(data, pseudo_bin, 4);
+            AppendLE(data, 2, 4);
+            AppendLE(data, FileOffset(file, ref.extent.beg), 8);
+            AppendLE(data, FileOffset(file, ref.extent.end), 8);
+            AppendLE(data, ref.n_mapped, 8);
+            AppendLE(data, ref.n_unmapped, 8);
+        }
+        
+        uint64_t offset = 0;
+        
+        AppendLE(data, ref.linear.size(), 4);
+        for (unsigned j = 0; j < ref.linear.size(); ++j) {
+            if (ref.linear[j] != 0)
+                offset = FileOffset(file, ref.linear[j]);
+            AppendLE(data, offset, 8);
+        }
+    }
+    AppendLE(data, n_no_coor, 8);
+}
+
+void BAMIndexBuilder::Write(std::string const &indexpath, BGZFWriter const &file) const
+{
+    std::string data;
+    
+    Encode(data, &file);
+    Save(indexpath, data);
+}
+
+void BAMIndexBuilder::Save(std::string const &indexpath, std::string const &data)
+{
+    FILE *const fp = fopen(indexpath.c_str(), "wb");
+    
+    if (fp == 0)
+        throw std::runtime_error("'" + indexpath + "' could not be created");
+    
+    bool const written = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    
+    if (fclose(fp) != 0 || !written)
+        throw std::runtime_error("failed to write '" + indexpath + "'");
+}
+
+BAMWriter::BAMWriter(std::string const &filepath, std::string const &headerText, References const &references,
+                     unsigned const threads, int const level, bool const buildIndex)
+: path(filepath)
+, file(filepath, threads, level)
+, referenceCount((uint32_t)references.size())
+, index(buildIndex ? new BAMIndexBuilder((unsigned)references.size()) : 0)
+, records(0)
+{
+    std::string header("BAM\1", 4);
+    
+    AppendLE(header, headerText.size(), 4);
+    header.append(headerText);
+    AppendLE(header, references.size(), 4);
+    for (unsigned i = 0; i < references.size(); ++i) {
+        AppendLE(header, references[i].first.size() + 1, 4);
+        header.append(references[i].first);
+        header.push_back('\0');
+        AppendLE(header, references[i].second, 4);
+    }
+    try {
+        file.Write(header.data(), header.size());
+        /* the first record starts a block */
+        file.Flush();
+    }
+    catch (...) {
+        delete index;
+        throw;
+    }
+}
+
+BAMWriter::~BAMWriter()
+{
+    delete index;
+}
+
+void BAMWriter::Write(BAMRecord const &rec, int32_t const *const refMap)
+{
+    int32_t refID = rec.refID();
+    int32_t next_refID = rec.next_refID();
+    
+    if (refMap) {
+        if (refID >= 0)
+            refID = refMap[refID];
+        if (next_refID >= 0)
+            next_refID = refMap[next_refID];
+    }
+    if ((refID >= 0 && (uint32_t)refID >= referenceCount) || (next_refID >= 0 && (uint32_t)next_refID >= referenceCount))
+        throw std::runtime_error("record's reference is not in the header of '" + path + "'");
+    
+    uint32_t const size = rec.rawSize();
+    uint8_t const *const raw = rec.rawData();
+    
+    if (size < BAMLayout::length_fixed_part)
+        throw std::runtime_error("record is too small to write to '" + path + "'");
+    
+    uint64_t const beg = file.Tell();
+    uint8_t fixed[4 + BAMLayout::start_next_pos];
+    
+    PutLE32(fixed, size);
+    if (refMap) {
+        PutLE32(fixed + 4 + BAMLayout::start_refID, (uint32_t)refID);
+        memcpy(fixed + 4 + BAMLayout::start_pos, raw + BAMLayout::start_pos, BAMLayout::start_next_refID - BAMLayout::start_pos);
+        PutLE32(fixed + 4 + BAMLayout::start_next_refID, (uint32_t)next_refID);
+        file.Write(fixed, sizeof(fixed));
+        file.Write(raw + BAMLayout::start_next_pos, size - BAMLayout::start_next_pos);
+    }
+    else {
+        file.Write(fixed, 4);
+        file.Write(raw, size);
+    }
+    ++records;
+    
+    if (index) {
+        index->Add(refID, rec, beg, file.Tell());
+        if (!index->isSorted())
+            throw std::runtime_error("records of '" + path + "' are not in position order, so it can't be indexed");
+    }
+}
+
+void BAMWriter::Close(void)
+{
+    file.Close();
+    if (index)
+        index->Write(path + ".bai", file);
+}
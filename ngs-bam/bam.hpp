@@ -23,7 +23,8 @@
  * ===========================================================================
  */
 
-#define USE_STDIO 1
+#ifndef _hpp_bam_
+#define _hpp_bam_
 
 #include <stdint.h>
 #include <string.h>
@@ -34,16 +35,14 @@
 #include <algorithm>
 #include <iterator>
 
-#include <zlib.h>
+#include <ngs-bam/ngs-bam.hpp>
 
-#if USE_STDIO
-#include <cstdio>
-#else
-#include <fstream>
-#endif
-
-#define BAM_BLK_MAX (64u * 1024u)
-#define IO_BLK_SIZE (1024u * 1024u)
+#include "bgzf.hpp"
+#include "sam.hpp"
+#include "filter.hpp"
+#include "zones.hpp"
+#include "coverage.hpp"
+#include "regions.hpp"
 
 template<typename T>
 static T LE2Host(void const *const src)
@@ -71,6 +70,7 @@ class BAMFilePosType {
 public:
     BAMFilePosType(uint64_t const x = 0) : value(x) {}
     bool hasValue() const { return value != 0; }
+    uint64_t getValue() const { return value; }
     uint64_t fpos() const {
         return value >> 16;
     }
@@ -78,10 +78,10 @@ public:
         return (uint16_t)value;
     }
     friend bool operator <(BAMFilePosType const lhs, BAMFilePosType const rhs) {
-        return rhs.value < rhs.value;
+        return lhs.value < rhs.value;
     }
     friend bool operator ==(BAMFilePosType const lhs, BAMFilePosType const rhs) {
-        return rhs.value == rhs.value;
+        return lhs.value == rhs.value;
     }
 };
 
@@ -94,30 +94,210 @@ BAMFilePosType LE2Host<BAMFilePosType>(void const *const src)
 
 typedef std::vector<BAMFilePosType> BAMFilePosTypeList;
 
+/* BAMFileChunk
+ *  the range of virtual file positions [beg, end)
+ */
+struct BAMFileChunk {
+    BAMFilePosType beg;
+    BAMFilePosType end;
+
+    BAMFileChunk(BAMFilePosType const Beg = 0, BAMFilePosType const End = 0)
+    : beg(Beg), end(End)
+    {}
+    friend bool operator <(BAMFileChunk const &lhs, BAMFileChunk const &rhs) {
+        return lhs.beg < rhs.beg;
+    }
+};
+
+typedef std::vector<BAMFileChunk> BAMFileChunkList;
+
 class BAMFile;
 class RefIndex;
 
+/* IndexFormat
+ *  the binning scheme of a BAI or CSI index
+ *  BAI is always min_shift = 14, depth = 5
+ */
+struct IndexFormat
+{
+    int min_shift;
+    int depth;
+    bool csi;
+};
+
+/* FlatIndexHeader, FlatRefIndex
+ *  a parsed index flattened for mapping, as its sidecar has it: the
+ *  header, a FlatRefIndex per reference, then the arrays of RefIndex,
+ *  the linear index, the bins with any chunks, sparse and by id, and
+ *  their chunks; every offset is from the start of the header, so it
+ *  can be used wherever it is mapped; in host byte order, 8-byte aligned
+ */
+struct FlatIndexHeader
+{
+    char magic[8];
+    uint32_t n_ref;
+    int32_t min_shift;
+    int32_t depth;
+    uint32_t csi;
+    uint64_t n_no_coor;
+    uint32_t has_no_coor;
+    uint32_t reserved;
+};
+
+struct FlatRefIndex
+{
+    uint64_t off_beg, off_end;      /* the pseudo-bin */
+    uint64_t n_mapped, n_unmapped;
+    uint64_t interval, n_interval;
+    uint64_t bins, n_bins;
+    uint64_t chunks, n_chunks;
+    uint32_t has_index;
+    uint32_t has_counts;
+};
+
+/* IndexLoad
+ *  the loading of a file's index while it is used, see
+ *  NGS_BAM::OpenOptions::asyncIndex: it runs on the shared pool, or on
+ *  the first thread to need the index if no pool thread has taken it
+ *  yet; Await returns once it is done, and throws what it failed with
+ *  every time; it is done from the start for a file that loads its
+ *  index when it is opened
+ */
+class IndexLoad : public ngs::WorkItem
+{
+    BAMFile *file;
+    mutable pthread_mutex_t mutex;
+    mutable pthread_cond_t cond;
+    mutable pthread_t loader;
+    mutable bool running;
+    mutable bool done;              /* set last, with release */
+    mutable std::string error;
+
+    void Execute() const;
+    void Wait() const;
+
+    IndexLoad(IndexLoad const &);
+    IndexLoad &operator =(IndexLoad const &);
+public:
+    IndexLoad();
+    ~IndexLoad();
+
+    /* Start
+     *  submit the loading of "file"'s index
+     */
+    void Start(BAMFile &file, ngs::WorkPool::Priority const priority);
+
+    /* Await
+     *  the load, from anything that needs the index; returns at once
+     *  on the thread that is loading it
+     */
+    void Await() const {
+        if (!__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+            Wait();
+        if (!error.empty())
+            throw std::runtime_error(error);
+    }
+
+    /* Finish
+     *  the load, without starting it if no one has, for a file that is
+     *  going away; it doesn't throw
+     */
+    void Finish();
+
+    void run();
+};
+
 class HeaderRefInfo
 {
     friend class BAMFile;
 
-    RefIndex const *index;
-    std::string name;
+    mutable RefIndex const *index;
+    char const *index_data;         /* unparsed index when loading lazily */
+    size_t index_size;
+    IndexFormat index_format;
+    pthread_mutex_t *index_lock;    /* owned by BAMFile */
+    IndexLoad const *index_load;    /* owned by BAMFile, when it is loaded in the background */
+    MemoryLedger *memory;           /* the file's, counts the index */
+    uint64_t n_mapped;              /* counts from the index pseudo-bin */
+    uint64_t n_unmapped;
+    bool has_counts;
+    char const *name;               /* in BAMFile::referenceNames */
+    size_t name_length;
     unsigned length;
 
-    HeaderRefInfo(std::string const &Name, int32_t const Length)
-    : name(Name), length(Length), index(0)
+    HeaderRefInfo(char const Name[], size_t const NameLength, int32_t const Length, MemoryLedger *const Memory)
+    : index(0), index_data(0), index_size(0), index_lock(0), index_load(0), memory(Memory)
+    , n_mapped(0), n_unmapped(0), has_counts(false)
+    , name(Name), name_length(NameLength), length(Length)
     {}
-    size_t LoadIndex(char const data[], char const *const endp);
+    size_t LoadIndex(char const data[], char const *const endp, IndexFormat const &format);
+    size_t DeferIndex(char const data[], char const *const endp, IndexFormat const &format, pthread_mutex_t *const lock);
     void DropIndex();
+    void MapIndex(IndexFormat const &format, FlatRefIndex const &flat, char const *const base);
+    RefIndex const *getIndex() const;
 public:
     ~HeaderRefInfo() {
         DropIndex();
     }
-    BAMFilePosTypeList slice(unsigned const beg, unsigned const end) const;
-    std::string const &getName() const {
+    void AwaitIndex() const {
+        if (index_load)
+            index_load->Await();
+    }
+    bool hasIndex() const {
+        AwaitIndex();
+        return index != 0 || index_data != 0;
+    }
+    /* getIndexCounts
+     *  the number of mapped and unmapped records placed on this reference,
+     *  according to the index; returns false if the index doesn't have them
+     */
+    bool getIndexCounts(uint64_t &mapped, uint64_t &unmapped) const {
+        AwaitIndex();
+        mapped = n_mapped;
+        unmapped = n_unmapped;
+        return has_counts;
+    }
+    BAMFileChunkList slice(unsigned const beg, unsigned const end) const;
+    /* minPos
+     *  no record overlapping beg starts before the returned position,
+     *  by the linear index; 0 if there is no index
+     */
+    BAMFilePosType minPos(unsigned const beg) const;
+    /* getRecordStarts
+     *  adds the positions of records that the index knows of to starts,
+     *  and sets extent to the positions of the reference's records
+     *  returns false if there is no index
+     */
+    bool getRecordStarts(BAMFilePosTypeList &starts, BAMFileChunk &extent) const;
+    /* getExtent
+     *  the positions of the reference's records according to the index
+     *  returns false if there is no index or the reference has no records
+     */
+    bool getExtent(BAMFileChunk &extent) const;
+    /* estimate
+     *  about how many mapped records overlap [beg, end) and how many
+     *  compressed bytes hold them, from the bins' chunks and the counts
+     *  of the pseudo-bin; returns false if the index doesn't have them
+     */
+    bool estimate(unsigned const beg, unsigned const end, uint64_t &alignments, uint64_t &bytes) const;
+    /* explain
+     *  what slice would give for [beg, end) and about what reading it
+     *  would cost, see NGS_BAM::explainSlice; returns false if there
+     *  is no index
+     */
+    bool explain(unsigned const beg, unsigned const end, NGS_BAM::SlicePlan &plan) const;
+    /* getName
+     *  NUL-terminated and valid as long as the file is open
+     */
+    char const *getName() const {
         return name;
     }
+    size_t getNameLength() const {
+        return name_length;
+    }
+    std::string getNameString() const {
+        return std::string(name, name_length);
+    }
     unsigned getLength() const {
         return length;
     }
@@ -187,11 +367,27 @@ struct BAMLayout : public SizedRawData {
     }
 };
 
+/* BAMRecordSpan
+ *  the extent of a record according to its CIGAR
+ *  worked out once as the record is read, see BAMRecordBuffer::span
+ *  index 0 of the clips is the left edge, 1 the right
+ */
+struct BAMRecordSpan {
+    unsigned refLen;                /* reference positions covered by M, D, N, = and X */
+    unsigned softClip[2];
+    unsigned hardClip[2];
+};
+
 class BAMRecord : private BAMLayout {
 public:
     bool isTooSmall() const {
         return (size_t)size < min_size();
     }
+    /* rawSize, rawData
+     *  the record as stored in the file, without its size
+     */
+    uint32_t rawSize() const { return size; }
+    uint8_t const *rawData() const { return data; }
 
     int32_t refID() const { return LE2Host<int32_t>(p_refID()); }
     int32_t pos() const { return LE2Host<int32_t>(p_pos()); }
@@ -208,6 +404,18 @@ public:
         uint8_t const *const p_cigar = p_readname() + l_read_name();
         return LE2Host<uint32_t>(p_cigar + 4u * i);
     }
+    /* cigarOps
+     *  the packed CIGAR operations in place, if they are already in host
+     *  order and aligned; otherwise NULL, and cigar(i) copies each one
+     */
+    uint32_t const *cigarOps() const {
+#if BYTE_ORDER == LITTLE_ENDIAN
+        uint8_t const *const p_cigar = p_readname() + l_read_name();
+        if (((uintptr_t)p_cigar & 3) == 0)
+            return (uint32_t const *)p_cigar;
+#endif
+        return 0;
+    }
     uint8_t const *seq() const { return p_readname() + l_read_name() + 4u * nc(); }
     char seq(unsigned const i) const {
         static char const tr[] = "=ACMGRSVTWYHKDBN";
@@ -216,28 +424,78 @@ public:
         uint8_t const hi = b4na2 >> 4;
         return tr[(i & 1) ? lo : hi];
     }
+    /* decodeSeq
+     *  writes bases [offset, offset + length) to dst as characters
+     */
+    void decodeSeq(char dst[], unsigned offset, unsigned length) const;
+
+    /* decodeSeqReverse
+     *  writes the reverse complement of bases [offset, offset + length)
+     *  to dst, i.e. the bases as sequenced of a record of the reverse strand
+     */
+    void decodeSeqReverse(char dst[], unsigned offset, unsigned length) const;
+
+    /* decodeQual
+     *  writes qualities [offset, offset + length) to dst, capped at maxQual
+     *  and ascii-encoded if offset33
+     *  returns false if they are all missing (0xFF)
+     */
+    bool decodeQual(char dst[], unsigned offset, unsigned length, bool offset33, uint8_t maxQual) const;
+
+    /* decodeQualReverse
+     *  decodeQual, last quality first, i.e. the qualities as sequenced
+     *  of a record of the reverse strand
+     */
+    bool decodeQualReverse(char dst[], unsigned offset, unsigned length, bool offset33, uint8_t maxQual) const;
+
+    /* encodeQual
+     *  decodeQual of "count" phred values at src, from any record
+     */
+    static bool encodeQual(char dst[], uint8_t const src[], size_t count, bool offset33, uint8_t maxQual);
+
+    /* hasQual
+     *  false if the qualities are missing, i.e. all 0xFF
+     */
+    bool hasQual() const;
+
     uint8_t const *qual() const { return seq() + ((l_seq() + 1) >> 1); }
     void const *extra() const { return (void const *)(qual() + l_seq()); }
 
-    unsigned refLen() const {
+    BAMRecordSpan span() const {
         unsigned const n = nc();
-        unsigned rslt = 0;
+        BAMRecordSpan rslt = { 0, { 0, 0 }, { 0, 0 } };
+        int edge = 0;               /* clips after the first aligned op are on the right */
 
         for (unsigned i = 0; i < n; ++i) {
             uint32_t const op = cigar(i);
             int const code = op & 0x0F;
-            int const len = op >> 4;
+            unsigned const len = op >> 4;
             switch (code) {
                 case 0: /* M */
                 case 2: /* D */
                 case 3: /* N */
                 case 7: /* = */
                 case 8: /* X */
-                    rslt += len;
+                    rslt.refLen += len;
+                    /* fall through */
+                case 1: /* I */
+                case 6: /* P */
+                    edge = 1;
+                    rslt.softClip[1] = rslt.hardClip[1] = 0;
+                    break;
+                case 4: /* S */
+                    rslt.softClip[edge] += len;
+                    break;
+                case 5: /* H */
+                    rslt.hardClip[edge] += len;
+                    break;
             }
         }
         return rslt;
     }
+    unsigned refLen() const {
+        return span().refLen;
+    }
     bool isSelfMapped() const {
         return ((flag() & 0x0004) != 0 || refID() < 0 || pos() < 0 || nc() == 0) ? false : true;
     }
@@ -305,6 +563,7 @@ public:
                 case 'S':
                 case 's':
                     return 2;
+                case 'f':
                 case 'F':
                 case 'I':
                 case 'i':
@@ -349,6 +608,9 @@ public:
         char const *getTag() const {
             return tag;
         }
+        bool isArray() const {
+            return val_type == 'B';
+        }
         char getValueType() const {
             if (val_type != 'B')
                 return val_type;
@@ -375,6 +637,21 @@ public:
             else
                 return value.scalar;
         }
+        /* getInt
+         *  the value of a field of type c, C, s, S, i or I into "rslt",
+         *  or false if it is of another
+         */
+        bool getInt(int64_t &rslt) const {
+            switch (val_type) {
+                case 'c': rslt = (int8_t)value.scalar[0]; return true;
+                case 'C': rslt = (uint8_t)value.scalar[0]; return true;
+                case 's': rslt = LE2Host<int16_t>(value.scalar); return true;
+                case 'S': rslt = LE2Host<uint16_t>(value.scalar); return true;
+                case 'i': rslt = LE2Host<int32_t>(value.scalar); return true;
+                case 'I': rslt = LE2Host<uint32_t>(value.scalar); return true;
+            }
+            return false;
+        }
 
         typedef OptionalField const constOptionalField;
         class const_iterator : public std::iterator<std::forward_iterator_tag, constOptionalField>
@@ -412,15 +689,362 @@ public:
     OptionalField::const_iterator end() const {
         return OptionalField::const_iterator(endp(), endp());
     }
+    /* findTag
+     *  the optional field named "tag", or NULL if there is none
+     *  this walks the fields; BAMRecordBuffer::findTag uses an index of them
+     */
+    OptionalField const *findTag(char const tag[2]) const {
+        for (OptionalField::const_iterator i = begin(); i != end(); ++i) {
+            char const *const name = i->getTag();
+            if (name[0] == tag[0] && name[1] == tag[1])
+                return &*i;
+        }
+        return 0;
+    }
+};
+
+/* BAMTagTable
+ *  where each optional field of a record starts, found in one walk over
+ *  them; a lookup is then a search of the names rather than another walk
+ *  its storage is kept from one record to the next
+ */
+class BAMTagTable
+{
+    struct Entry {
+        uint16_t tag;
+        uint32_t offset;            /* from the first field */
+    };
+    std::vector<Entry> entries;
+
+    static uint16_t Key(char const tag[2]) {
+        return (uint8_t)tag[0] | ((uint8_t)tag[1] << 8);
+    }
+public:
+    void Build(BAMRecord const &rec) {
+        char const *const base = (char const *)rec.extra();
+
+        entries.clear();
+        for (BAMRecord::OptionalField::const_iterator i = rec.begin(); i != rec.end(); ++i) {
+            Entry const entry = { Key(i->getTag()), (uint32_t)((char const *)&*i - base) };
+            entries.push_back(entry);
+        }
+    }
+    /* Find
+     *  as BAMRecord::findTag, for the record the table was built from
+     */
+    BAMRecord::OptionalField const *Find(BAMRecord const &rec, char const tag[2]) const {
+        uint16_t const key = Key(tag);
+
+        for (std::vector<Entry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+            if (i->tag == key)
+                return (BAMRecord::OptionalField const *)((char const *)rec.extra() + i->offset);
+        }
+        return 0;
+    }
+    void Swap(BAMTagTable &other) {
+        entries.swap(other.entries);
+    }
+};
+
+/* BAMRecordBuffer
+ *  a growable buffer that records are decoded into
+ *  it is reused by every Read into it, so the record it holds is only
+ *  valid until the next Read; Detach hands the record to the caller
+ */
+class BAMRecordBuffer
+{
+    union Storage {
+        SizedRawData raw;
+        BAMRecord record;
+        struct {
+            uint8_t align[16];
+        } align;
+    };
+    Storage *data;
+    size_t capacity;                /* in units of Storage */
+    BAMRecordSpan recordSpan;
+    mutable BAMTagTable tagTable;
+    mutable bool tagsIndexed;       /* tagTable is of the current record */
+
+    BAMRecordBuffer(BAMRecordBuffer const &);
+    BAMRecordBuffer &operator =(BAMRecordBuffer const &);
+public:
+    BAMRecordBuffer() : data(0), capacity(0), tagsIndexed(false) {
+        recordSpan.refLen = 0;
+        recordSpan.softClip[0] = recordSpan.softClip[1] = 0;
+        recordSpan.hardClip[0] = recordSpan.hardClip[1] = 0;
+    }
+    ~BAMRecordBuffer() {
+        ngs_adapt::Allocator::deleteBlock(data, capacity * sizeof(Storage));
+    }
+
+    /* Reserve
+     *  returns storage for a record of "size" bytes
+     *  the previous contents are lost
+     */
+    SizedRawData *Reserve(uint32_t const size) {
+        size_t const need = (size + sizeof(uint32_t) + sizeof(Storage) - 1) / sizeof(Storage);
+
+        if (need > capacity) {
+            size_t const grow = need < 2 * capacity ? 2 * capacity : need;
+
+            /* from the ngs_adapt::Allocator installed, see EngineBlock */
+            ngs_adapt::Allocator::deleteBlock(data, capacity * sizeof(Storage));
+            data = 0;
+            capacity = 0;
+            data = static_cast<Storage *>(ngs_adapt::Allocator::newBlock(grow * sizeof(Storage)));
+            capacity = grow;
+        }
+        data->raw.size = size;
+        tagsIndexed = false;
+        return &data->raw;
+    }
+    BAMRecord const *record() const {
+        return data ? &data->record : 0;
+    }
+    /* size
+     *  bytes of storage the buffer holds
+     */
+    size_t size() const {
+        return capacity * sizeof(Storage);
+    }
+
+    /* Measure
+     *  work out the span of the record just read into the buffer
+     *  without "check", the record is trusted to be big enough for its CIGAR
+     */
+    void Measure(bool const check = true) {
+        static BAMRecordSpan const empty = { 0, { 0, 0 }, { 0, 0 } };
+
+        recordSpan = check && data->record.isTooSmall() ? empty : data->record.span();
+    }
+    BAMRecordSpan const &span() const {
+        return recordSpan;
+    }
+
+    /* findTag
+     *  as BAMRecord::findTag, for a record read with its tags; the
+     *  fields are indexed the first time one of them is looked for
+     */
+    BAMRecord::OptionalField const *findTag(char const tag[2]) const {
+        if (!tagsIndexed) {
+            tagTable.Build(data->record);
+            tagsIndexed = true;
+        }
+        return tagTable.Find(data->record, tag);
+    }
+
+    /* Detach
+     *  the caller takes ownership of the current record
+     *  and must free it with Release
+     */
+    BAMRecord const *Detach() {
+        BAMRecord const *const rslt = record();
+
+        data = 0;
+        capacity = 0;
+        tagsIndexed = false;
+        return rslt;
+    }
+    static void Release(BAMRecord const *const rec) {
+        delete [] reinterpret_cast<Storage const *>(rec);
+    }
+
+    /* Swap
+     *  exchanges storage, letting a caller keep a record
+     *  and hand back a previously used buffer in its place
+     */
+    void Swap(BAMRecordBuffer &other) {
+        Storage *const data_ = data;
+        size_t const capacity_ = capacity;
+        BAMRecordSpan const span_ = recordSpan;
+        bool const tagsIndexed_ = tagsIndexed;
+
+        data = other.data;
+        capacity = other.capacity;
+        recordSpan = other.recordSpan;
+        tagsIndexed = other.tagsIndexed;
+        other.data = data_;
+        other.capacity = capacity_;
+        other.recordSpan = span_;
+        other.tagsIndexed = tagsIndexed_;
+        tagTable.Swap(other.tagTable);
+    }
+};
+
+/* BAMRecordFilter
+ *  tests the fixed part of a record, so that a record that isn't wanted
+ *  can be skipped over without the rest of it being read
+ *  only records of refID that start before end are tested; the others
+ *  are let through, so that whoever reads a slice still sees the record
+ *  that ends it; with refID < 0 every record is let through
+ */
+struct BAMRecordFilter
+{
+    int32_t refID;
+    int32_t beg;                    /* earliest wanted start */
+    int32_t end;
+    unsigned rejectFlags;           /* any of these FLAG bits rejects a record */
+    int minMapQ;
+    int maxMapQ;
+    RecordProgram const *program;   /* if not NULL, what a record has to pass as well */
+
+    BAMRecordFilter()
+    : refID(-1), beg(0), end(0), rejectFlags(0), minMapQ(0), maxMapQ(255), program(0)
+    {}
+
+    bool isActive() const {
+        return refID >= 0;
+    }
+    bool needsRest() const {
+        return program != 0 && program->needsRest();
+    }
+    /* Rejects
+     *  may be given a record of which only the fixed part is read;
+     *  a program that needs more is left to RejectsRest
+     */
+    bool Rejects(BAMRecord const &rec) const {
+        int32_t const pos = rec.pos();
+        int const mq = rec.mq();
+
+        if (rec.refID() != refID || pos >= end)
+            return false;
+        if (pos < beg || (rec.flag() & rejectFlags) != 0 || mq < minMapQ || mq > maxMapQ)
+            return true;
+        return program != 0 && !program->needsRest() && !program->Accepts(rec);
+    }
+    /* RejectsRest
+     *  whether the program rejects a record that is read whole
+     */
+    bool RejectsRest(BAMRecord const &rec) const {
+        if (!needsRest() || rec.refID() != refID || rec.pos() >= end)
+            return false;
+        return rec.isTooSmall() || !program->Accepts(rec);
+    }
+    /* RejectsAll
+     *  whether every record of a zone would be rejected, so that its
+     *  block needn't be read at all
+     */
+    bool RejectsAll(BAMZone const &zone) const {
+        if (zone.refMin != refID || zone.refMax != refID || zone.posMax >= end)
+            return false;
+        if (zone.posMax < beg || (zone.flagAll & rejectFlags) != 0 || zone.mqMax < minMapQ || zone.mqMin > maxMapQ)
+            return true;
+        if (program == 0)
+            return false;
+
+        RecordProgram::Range ranges[RecordProgram::alen + 1] = {};
+
+        ranges[RecordProgram::flag].known = true;
+        ranges[RecordProgram::flag].lo = zone.flagAll;
+        ranges[RecordProgram::flag].hi = zone.flagAny;
+        ranges[RecordProgram::mapq].known = true;
+        ranges[RecordProgram::mapq].lo = zone.mqMin;
+        ranges[RecordProgram::mapq].hi = zone.mqMax;
+        ranges[RecordProgram::pos].known = true;
+        ranges[RecordProgram::pos].lo = zone.posMin;
+        ranges[RecordProgram::pos].hi = zone.posMax;
+        return program->RejectsAll(ranges);
+    }
+};
+
+/* BAMFlagStats
+ *  what samtools flagstat counts of records, from their fixed part,
+ *  of those that pass QC and of those that fail it; the tests of a
+ *  record are added as bits, so counting one doesn't branch
+ */
+struct BAMFlagStats
+{
+    enum Counter {
+        total, primary, secondary, supplementary, duplicates, primaryDuplicates,
+        mapped, primaryMapped, paired, read1, read2, properlyPaired,
+        bothMapped, singletons, mateOtherReference, mateOtherReferenceMapQ5,
+        counters
+    };
+    uint64_t count[2][counters];    /* [0] passed QC, [1] failed */
+
+    BAMFlagStats() {
+        memset(count, 0, sizeof(count));
+    }
+    static char const *Name(Counter const what);
+
+    void Add(BAMRecord const &rec) {
+        unsigned const flag = rec.flag();
+        uint64_t *const c = count[(flag >> 9) & 1];
+        unsigned const isMapped = ((flag >> 2) & 1) ^ 1;
+        unsigned const isPrimary = (((flag >> 8) & 1) | ((flag >> 11) & 1)) ^ 1;
+        unsigned const isDuplicate = (flag >> 10) & 1;
+        unsigned const isPaired = flag & 1 & isPrimary;
+        unsigned const mateMapped = ((flag >> 3) & 1) ^ 1;
+        unsigned const isBothMapped = isPaired & isMapped & mateMapped;
+        unsigned const otherReference = isBothMapped & (rec.next_refID() != rec.refID());
+
+        c[total] += 1;
+        c[primary] += isPrimary;
+        c[secondary] += (flag >> 8) & 1;
+        c[supplementary] += (flag >> 11) & 1;
+        c[duplicates] += isDuplicate;
+        c[primaryDuplicates] += isDuplicate & isPrimary;
+        c[mapped] += isMapped;
+        c[primaryMapped] += isMapped & isPrimary;
+        c[paired] += isPaired;
+        c[read1] += isPaired & (flag >> 6) & 1;
+        c[read2] += isPaired & (flag >> 7) & 1;
+        c[properlyPaired] += isPaired & isMapped & (flag >> 1) & 1;
+        c[bothMapped] += isBothMapped;
+        c[singletons] += isPaired & isMapped & (mateMapped ^ 1);
+        c[mateOtherReference] += otherReference;
+        c[mateOtherReferenceMapQ5] += otherReference & (rec.mq() >= 5);
+    }
+    void Add(BAMFlagStats const &other) {
+        for (unsigned i = 0; i < 2; ++i) {
+            for (unsigned j = 0; j < counters; ++j)
+                count[i][j] += other.count[i][j];
+        }
+    }
+};
+
+/* BAMMateRequest
+ *  what a record says of its mate, for BAMFile::FindMates to look for
+ *  the mate is the record at (mateRefID, matePos) with the same name,
+ *  the other segment bit, and a mate position that is the record's own
+ */
+struct BAMMateRequest
+{
+    std::string name;
+    int32_t refID;
+    int32_t pos;
+    int32_t mateRefID;
+    int32_t matePos;
+    unsigned flag;
+    BAMFilePosType mate;            /* where the mate starts, if found */
+    bool found;
+
+    /* "rec" must have been read with its name */
+    explicit BAMMateRequest(BAMRecord const &rec)
+    : name(rec.readname(), strnlen(rec.readname(), rec.l_read_name()))
+    , refID(rec.refID()), pos(rec.pos())
+    , mateRefID(rec.next_refID()), matePos(rec.next_pos())
+    , flag(rec.flag()), found(false)
+    {}
+    
+    bool isMate(BAMRecord const &rec) const {
+        return (rec.flag() & 0x0900) == 0 &&
+               (rec.flag() & 0x00C0) == ((flag & 0x00C0) ^ 0x00C0) &&
+               rec.next_refID() == refID && rec.next_pos() == pos &&
+               name.compare(0, name.size(), rec.readname(), strnlen(rec.readname(), rec.l_read_name())) == 0;
+    }
 };
+typedef std::vector<BAMMateRequest> BAMMateRequestList;
 
 class BAMRecordSource
 {
 public:
+    virtual ~BAMRecordSource() {}
     virtual bool isGoodRecord(BAMRecord const &rec) {
         return false;
     }
-    virtual BAMRecord const *Read() {
+    virtual BAMRecord const *Read(BAMRecordBuffer &buffer) {
         return 0;
     }
     virtual void DumpSAM(std::ostream &oss, BAMRecord const &rec) const {
@@ -428,131 +1052,688 @@ public:
     }
 };
 
-class BAMFile : public BAMRecordSource {
-#if USE_STDIO
-    FILE *file;
-#else
-    std::ifstream file;
-#endif
-    std::vector<HeaderRefInfo> references;
-    std::map<std::string, unsigned> referencesByName;
-    std::string headerText;
-
-    size_t first_bpos;
-    size_t bpos;                    /* file position of bambuffer */
-    size_t cpos;                    /* file position of iobuffer  */
-    z_stream zs;
-
-    unsigned first_bam_cur;
-    unsigned bam_cur;               /* current offset in bambuffer */
+/* BAMFileCursor
+ *  a reading position in a BAM file, with a BGZF reader of its own,
+ *  or a SAM file, with a SAMReader of its own
+ *  cursors share the header, index and block cache of their file,
+ *  so any number of them can be used at once, one per thread
+ */
+class BAMFileCursor : public BAMRecordSource {
+    friend class BAMFile;
 
-    Bytef iobuffer[2*IO_BLK_SIZE];
-    Bytef bambuffer[BAM_BLK_MAX];
+    BAMFile const &file;
+    BlockReader *const reader;
+    BGZFBlock const *block;         /* current inflated block */
+    unsigned bam_cur;               /* current offset in block */
 
-    unsigned FillBuffer(int const n);
-    void ReadZlib(void);
+    void ReadBlock(void);
+    void Settle(void);
     size_t ReadN(size_t N, void *Dst);
     size_t SkipN(size_t N);
     template <typename T> bool Read(size_t count, T *dst);
     int32_t ReadI32();
     bool ReadI32(int32_t &rslt);
-    void InflateInit(void);
+
+    BAMFileCursor(BAMFileCursor const &);
+    BAMFileCursor &operator =(BAMFileCursor const &);
+public:
+    /* starts at the first record */
+    explicit BAMFileCursor(BAMFile const &file);
+    /* starts at "start" */
+    BAMFileCursor(BAMFile const &file, BAMFilePosType const start);
+    ~BAMFileCursor();
+
+    void Seek(size_t const new_bpos, unsigned new_bam_cur);
+    void Seek(BAMFilePosType const pos) {
+        Seek(pos.fpos(), pos.bpos());
+    }
+    /* Tell
+     *  the virtual file position of the next record
+     */
+    BAMFilePosType Tell() const {
+        if (block)
+            return BAMFilePosType((block->fpos << 16) | bam_cur);
+        else
+            return BAMFilePosType(~(uint64_t)0);
+    }
+    void Rewind();
+    /* isComplete
+     *  the file's BGZF EOF marker has been read
+     */
+    bool isComplete() const {
+        return reader->isComplete();
+    }
+    /* Prefetch
+     *  ask for a chunk that is about to be read
+     */
+    void Prefetch(BAMFileChunk const &chunk) {
+        uint64_t const beg = chunk.beg.fpos();
+        uint64_t const end = chunk.end.fpos();
+
+        if (beg <= end)
+            reader->Prefetch(beg, end - beg + BAM_BLK_MAX);
+    }
+    /* Plan
+     *  tell a remote file about all the chunks that are going to be read
+     */
+    void Plan(BAMFileChunkList const &chunks) {
+        for (BAMFileChunkList::const_iterator i = chunks.begin(); i != chunks.end(); ++i) {
+            uint64_t const beg = i->beg.fpos();
+            uint64_t const end = i->end.fpos();
+
+            if (beg <= end)
+                reader->Plan(beg, end - beg + BAM_BLK_MAX);
+        }
+    }
+    virtual bool isGoodRecord(BAMRecord const &rec);
+    virtual BAMRecord const *Read(BAMRecordBuffer &buffer);
+    /* Read
+     *  as above, but only the parts of the record in "fields", a mask of
+     *  NGS_BAM::OpenOptions::Field, are copied; the rest is skipped over
+     *  and left undefined; the fixed part and the CIGAR are always copied
+     */
+    BAMRecord const *Read(BAMRecordBuffer &buffer, unsigned const fields);
+    /* Read
+     *  as above, but a record "filter" rejects is skipped over after its
+     *  fixed part; only that part is valid then and "rejected" is set
+     */
+    BAMRecord const *Read(BAMRecordBuffer &buffer, unsigned const fields,
+                          BAMRecordFilter const &filter, bool &rejected);
+    /* ReadFixed
+     *  only the fixed part of a record, skipping over the rest, which
+     *  is left undefined; the record isn't validated
+     */
+    BAMRecord const *ReadFixed(BAMRecordBuffer &buffer);
+    /* FindRecord
+     *  move to the first record that starts in the current block, or in
+     *  one of those after it that start before "limit", going by where
+     *  a run of what looks like records starts, for a cursor that was
+     *  put at the start of a block rather than at a record
+     *  returns false if there is none
+     */
+    bool FindRecord(uint64_t const limit);
+    void DumpSAM(std::ostream &oss, BAMRecord const &rec) const;
+};
+
+/* BAMFile
+ *  the header and index of a BAM file, which don't change once loaded,
+ *  and a cursor for reading it directly; more cursors can be made
+ *  a SAM file, plain or bgzipped, is read as one, see SAMText; it has
+ *  no index but one that buildIndex builds
+ */
+class BAMFile : public BAMRecordSource {
+    friend class BAMFileCursor;
+
+    std::string const path;
+    NGS_BAM::OpenOptions const options;
+    bool const stream;                  /* can only be read forward, see ByteSource::IsStream */
+    SAMText const samText;              /* of a SAM file */
+    mutable MemoryLedger memory;        /* what the file and its readers hold */
+    mutable BGZFBlockCache blockCache;  /* shared by all cursors */
+    mutable RegionCache regionCache;    /* shared by all slices */
+    mutable BGZFStats ioStats;          /* counted by all cursors */
+    mutable FileLatencies latency;      /* counted by all collections */
+    std::vector<HeaderRefInfo> references;
+    std::string referenceNames;     /* all the names, each after a NUL */
+    std::vector<unsigned> referenceHash;    /* open addressing, 1 + index into references or 0 */
+    std::string headerText;
+    std::vector<std::string> readGroups;    /* IDs of the @RG header lines, in order */
+    std::vector<unsigned> readGroupOrder;   /* indices into readGroups, sorted by ID */
+    bool collated;                  /* @HD says mates are next to each other */
+    NGS_BAM::SortOrder sortOrder;   /* what @HD says of the order */
+    MappedFile indexMap;
+    MappedFile flatIndex;           /* the shared index sidecar, if it is used */
+    std::vector<char> indexCopy;    /* index data kept for lazy loading */
+    ZoneMap zones;                  /* see NGS_BAM::OpenOptions::zoneMap */
+    uint64_t n_no_coor;             /* records without a reference, from the index */
+    bool has_no_coor;
+    mutable pthread_mutex_t indexLock;  /* also maps the coverage map */
+    IndexLoad indexLoad;            /* see NGS_BAM::OpenOptions::asyncIndex */
+    mutable CoverageMap coverageMap;    /* see NGS_BAM::buildCoverageMap */
+    mutable bool coverageMapped;
+
+    size_t first_bpos;              /* position of the first record */
+    unsigned first_bam_cur;
+
+    BAMFileCursor cursor;           /* used by Seek, Tell and Read */
+
     void CheckHeaderSignature(void);
     void ReadHeader(void);
-    void LoadIndexData(size_t const fsize, char const data[]);
-    void LoadIndex(std::string const &filepath);
+    void HashReferences(void);
+    int FindReference(char const name[], size_t const length) const;
+    void ParseReadGroups(void);
+    void ParseSortOrder(void);
+    size_t HeaderFootprint(void) const;
+    int FindReadGroup(char const name[], size_t const length) const;
+    void LoadIndexData(size_t const fsize, char const data[], bool const lazy);
+    bool LoadIndexFile(std::string const &idxpath, bool const useMmap, bool const lazy);
+    bool LoadCompressedIndex(std::string const &idxpath, bool const lazy);
+    void LoadIndex(std::string const &filepath, bool const useMmap, bool const lazy);
+    void BuildIndex(std::string const &filepath, bool const lazy);
+    bool MapFlatIndex(std::string const &filepath);
+    void SaveFlatIndex(std::string const &filepath) const;
+    void MakeZones(std::string const &filepath);
+    void OpenIndex(void);
+    friend class IndexLoad;         /* calls OpenIndex */
+    BlockReader *OpenReader(void) const;
 
 public:
-    BAMFile(std::string const &filepath);
+    BAMFile(std::string const &filepath, NGS_BAM::OpenOptions const &options = NGS_BAM::OpenOptions());
     ~BAMFile();
-    void Seek(size_t const new_bpos, unsigned new_bam_cur);
+
+    /* Open
+     *  the file at filepath, shared with whoever else has it open with
+     *  the same options; it is the same file while its device, inode,
+     *  size and modification time stay the same
+     *  each Open is matched by a Close; the last "Keep" files closed
+     *  stay open for the next Open of them
+     */
+    static BAMFile const &Open(std::string const &filepath, NGS_BAM::OpenOptions const &options);
+    static void Close(BAMFile const &file);
+    static void Keep(unsigned const count);
+    /* isStream
+     *  whether the file can only be read forward, once: it has no index,
+     *  and a cursor can't start before what the others have just read
+     */
+    bool isStream() const {
+        return stream;
+    }
+    /* isSAM
+     *  whether the file is SAM text, see SAMText
+     */
+    bool isSAM() const {
+        return samText.isSAM();
+    }
+    NGS_BAM::OpenOptions const &getOptions() const {
+        return options;
+    }
+    /* isFollowed
+     *  whether the file was opened to be read while it is being written,
+     *  see NGS_BAM::OpenOptions::follow
+     */
+    bool isFollowed() const {
+        return options.follow > 0;
+    }
+    /* isAdaptive
+     *  whether its readers size their reads from how it is read,
+     *  see NGS_BAM::OpenOptions::adaptiveReadahead
+     */
+    bool isAdaptive() const {
+        return options.adaptiveReadahead;
+    }
+    /* getZones
+     *  what the records of each block are, see NGS_BAM::OpenOptions::zoneMap;
+     *  empty if the file wasn't opened with it
+     */
+    ZoneMap const &getZones() const {
+        indexLoad.Await();
+        return zones;
+    }
+    void CountSkipped(unsigned const blocks) const {
+        BGZFStats::Add(ioStats.blocksSkipped, blocks);
+    }
+    void Seek(size_t const new_bpos, unsigned new_bam_cur) {
+        cursor.Seek(new_bpos, new_bam_cur);
+    }
+    void Seek(BAMFilePosType const pos) {
+        cursor.Seek(pos);
+    }
+    BAMFilePosType Tell() const {
+        return cursor.Tell();
+    }
     void Rewind() {
-        Seek(first_bpos, first_bam_cur);
+        cursor.Rewind();
+    }
+    void Prefetch(BAMFileChunk const &chunk) {
+        cursor.Prefetch(chunk);
+    }
+    virtual bool isGoodRecord(BAMRecord const &rec) {
+        return static_cast<BAMFile const *>(this)->isGoodRecord(rec);
+    }
+    /* isGoodRecord
+     *  the record is big enough for its parts, and its reference IDs,
+     *  positions and name length are valid; its name isn't looked at,
+     *  since it may not have been read
+     */
+    bool isGoodRecord(BAMRecord const &rec) const;
+    virtual BAMRecord const *Read(BAMRecordBuffer &buffer) {
+        return cursor.Read(buffer);
+    }
+
+    /* getIOStats
+     *  what the cursors of the file have read and inflated so far
+     */
+    BGZFStats const &getIOStats() const {
+        return ioStats;
+    }
+    /* getLatency
+     *  how long opening and slicing the file have taken
+     */
+    FileLatencies &getLatency() const {
+        return latency;
+    }
+    /* getRegionCache
+     *  the windows of records kept for slices, see OpenOptions::regionCache
+     */
+    RegionCache &getRegionCache() const {
+        return regionCache;
+    }
+    /* getMemory
+     *  what the file holds, by what for, including its readers';
+     *  counted in the process' ledger as well
+     */
+    MemoryLedger &getMemory() const {
+        return memory;
     }
-    virtual bool isGoodRecord(BAMRecord const &rec);
-    virtual BAMRecord const *Read();
 
     unsigned countOfReferences() const {
         return (unsigned)references.size();
     }
 
+    int getReferenceIndexByName(char const name[]) const {
+        return FindReference(name, strlen(name));
+    }
     int getReferenceIndexByName(std::string const &name) const {
-        std::map<std::string, unsigned>::const_iterator i = referencesByName.find(name);
-        if (i != referencesByName.end())
-            return i->second;
-        else
-            return -1;
+        return FindReference(name.data(), name.size());
     }
 
     HeaderRefInfo const &getRefInfo(unsigned const i) const {
         return references[i];
     }
 
-    BAMRecordSource *Slice(std::string const &rname, unsigned start, unsigned last);
+    /* getCoverageMap
+     *  the file's coverage map, mapped from its sidecar the first time
+     *  it is asked for and is found current; NULL until then
+     */
+    CoverageMap const *getCoverageMap() const;
+
+    /* getHeaderText
+     *  the SAM header text, as it is in the file
+     */
+    std::string const &getHeaderText() const {
+        return headerText;
+    }
+
+    /* isCollated
+     *  true if the header's @HD line says the records of a template are
+     *  next to each other, with SO:queryname or GO:query
+     */
+    bool isCollated() const {
+        return collated;
+    }
+
+    /* getSortOrder
+     *  what the SO field of the header's @HD line says
+     */
+    NGS_BAM::SortOrder getSortOrder() const {
+        return sortOrder;
+    }
+    /* isUnsorted
+     *  the header says the records aren't in position order
+     */
+    bool isUnsorted() const {
+        return sortOrder == NGS_BAM::unsorted || sortOrder == NGS_BAM::queryname;
+    }
+
+    unsigned countOfReadGroups() const {
+        return (unsigned)readGroups.size();
+    }
+    std::string const &getReadGroupName(unsigned const i) const {
+        return readGroups[i];
+    }
+    int getReadGroupIndexByName(std::string const &name) const {
+        return FindReadGroup(name.data(), name.size());
+    }
+    /* getReadGroupIndex
+     *  the index of the read group named by the RG tag of a record read
+     *  with its tags, or -1 if it has none or one the header doesn't list
+     */
+    int getReadGroupIndex(BAMRecord const &rec) const {
+        return getReadGroupIndex(rec.findTag("RG"));
+    }
+    /* the same, for the RG field "rg", which may be NULL */
+    int getReadGroupIndex(BAMRecord::OptionalField const *const rg) const {
+        if (rg == 0 || rg->getValueType() != 'Z')
+            return -1;
+        return FindReadGroup(rg->getRawValue(), rg->getElementSize());
+    }
+
+    /* getShard
+     *  shard "shard" of "count" of the records of reference refID, or of the
+     *  whole file if refID < 0; the shards are split at record positions from
+     *  the index so that each has about the same number of compressed bytes
+     *  returns false if there is no index
+     */
+    bool getShard(int const refID, unsigned const shard, unsigned const count, BAMFileChunk &rslt) const;
+
+    /* getSampleUnits
+     *  the runs of records that a sample is drawn from: run i is from
+     *  units[i] to units[i + 1], and weights[i] is the weight of runs up
+     *  to and including it; with the zone map a run is a block's records,
+     *  weighed by their count, else it is from one record position of the
+     *  index to the next, weighed by its compressed bytes
+     *  returns false if there is neither
+     */
+    bool getSampleUnits(BAMFilePosTypeList &units, std::vector<double> &weights) const;
+
+    /* getUnplaced
+     *  where the records without a reference start in a file sorted by
+     *  position: after the last record of any reference in the index
+     *  count is how many there are, or UINT64_MAX if the index doesn't say
+     *  returns false if there is no index
+     */
+    bool getUnplaced(BAMFilePosType &start, uint64_t &count) const;
+
+    /* Slice
+     *  the records overlapping a region, read with a cursor of its own
+     */
+    BAMRecordSource *Slice(std::string const &rname, unsigned start, unsigned last) const;
+
+    /* WillNeed
+     *  a hint that the chunks of some regions, each as the index gives
+     *  them, are about to be read: the system is asked for their bytes,
+     *  merged, whatever prefetch is, and with a block cache the first
+     *  block of each region is inflated into it, so that the cursor
+     *  that seeks there next neither reads nor inflates it
+     *  reads with a reader of its own, and a failure is ignored
+     */
+    void WillNeed(std::vector<BAMFileChunkList> const &regions) const;
+
+    /* FindMates
+     *  looks for the mates of all the requests at once; they are looked
+     *  for in position order, so the file is read forward, and a seek
+     *  is only made to skip ahead; needs the index
+     */
+    void FindMates(BAMMateRequestList &requests) const;
+
+    /* CountFlags
+     *  add the flags of every record to "stats", with one pass over the
+     *  file in which only their fixed parts are read
+     */
+    void CountFlags(BAMFlagStats &stats) const;
+
+    /* ScanUnordered
+     *  every record, in no particular order, see NGS_BAM::scanUnordered:
+     *  a local file is cut into as many ranges of bytes as there are
+     *  consumers, and each is read by a thread of its own, from the
+     *  first record it finds in the range up to where the next range's
+     *  thread found its own; anything else is read by the first one
+     */
+    void ScanUnordered(std::vector<NGS_BAM::ScanConsumer *> const &consumers) const;
 
     void DumpSAM(std::ostream &oss, BAMRecord const &rec) const;
 };
 
+/* BAMTemplateSegment
+ *  a record BAMTemplateReader returns, and where it starts
+ */
+struct BAMTemplateSegment
+{
+    BAMRecordBuffer buffer;
+    BAMFilePosType pos;
+    
+    BAMRecord const *record() const {
+        return buffer.record();
+    }
+};
+
+/* BAMTemplateReader
+ *  the primary records of a file grouped by template: a paired record
+ *  is held, by name, until its mate is read and then both come out
+ *  together; an unpaired record comes out at once
+ *
+ *  with collated input only the last record is held, since a mate is
+ *  next to it; otherwise the records held take at most "limit" bytes,
+ *  or less while the process is over its memory budget, and the one
+ *  held longest comes out alone to make room, as do those left at the
+ *  end of the file; with input sorted by coordinate, a record whose
+ *  mate is placed before it and isn't held comes out alone at once,
+ *  since the mate has been read already
+ */
+class BAMTemplateReader
+{
+    struct Held;
+
+    BAMFileCursor cursor;
+    MemoryLedger &memory;           /* the file's, counts what is held */
+    unsigned const fields;
+    bool const collated;
+    bool const sorted;              /* by coordinate */
+    size_t const limit;
+    bool const unplaced;            /* skip records with a reference */
+    std::vector<Held *> buckets;    /* chained by hash of the name */
+    Held *oldest;                   /* the held records in the order read */
+    Held *newest;
+    Held *spare;                    /* released, for reuse */
+    size_t count;
+    size_t heldBytes;
+    size_t peakBytes;
+    uint64_t evictions;             /* records let out early to make room */
+    bool eof;
+
+    Held *Find(BAMRecord const &rec, uint32_t const hash) const;
+    void Hold(BAMTemplateSegment &seg, uint32_t const hash);
+    void Unhold(Held *const held, BAMTemplateSegment &seg);
+    void Rehash(void);
+
+    BAMTemplateReader(BAMTemplateReader const &);
+    BAMTemplateReader &operator =(BAMTemplateReader const &);
+public:
+    /* the records are read with "fields" and their names */
+    BAMTemplateReader(BAMFile const &file, unsigned const fields, size_t const limit);
+    /* only the records without a reference, from "start" on */
+    BAMTemplateReader(BAMFile const &file, unsigned const fields, size_t const limit, BAMFilePosType const start);
+    ~BAMTemplateReader();
+
+    /* Next
+     *  the records of the next template into "seg", in segment order
+     *  returns how many there are, 1 or 2, or 0 at the end of the file
+     */
+    unsigned Next(BAMTemplateSegment seg[2]);
+
+    /* Checkpoint
+     *  where the reader is: the positions of the records it holds,
+     *  oldest first, and that of the next record it would read, which
+     *  is 0 once it has read to the end of the file
+     */
+    void Checkpoint(std::vector<BAMFilePosType> &held, BAMFilePosType &next) const;
+    /* Resume
+     *  takes the reader back to a Checkpoint, reading the records that
+     *  were held again; what it holds now is let go
+     */
+    void Resume(std::vector<BAMFilePosType> const &held, BAMFilePosType const next);
+
+    size_t getHeldBytes() const {
+        return heldBytes;
+    }
+    size_t getPeakBytes() const {
+        return peakBytes;
+    }
+    uint64_t getEvictions() const {
+        return evictions;
+    }
+};
+
 class BAMFileSlice : public BAMRecordSource {
     friend class BAMFile;
 
-    BAMFile *const parent;
-    BAMFilePosTypeList const index;
+    BAMFileCursor cursor;
+    BAMFileChunkList const index;
     unsigned const refID;
     unsigned const start;
     unsigned const end;
-    BAMFilePosTypeList::const_iterator cur;
+    BAMFileChunkList::const_iterator cur;
 
-    void Seek(void)
-    {
-        BAMFilePosType const pos = *cur++;
-        size_t const fpos = pos.fpos();
-        uint16_t const bpos = pos.bpos();
-
-        parent->Seek(fpos, bpos);
-    }
-    BAMFileSlice(BAMFile &p, unsigned const r, unsigned const s, unsigned const e, BAMFilePosTypeList const &i)
-    : parent(&p)
+    BAMFileSlice(BAMFile const &p, unsigned const r, unsigned const s, unsigned const e, BAMFileChunkList const &i)
+    : cursor(p)
+    , index(i)
     , refID(r)
     , start(s)
     , end(e)
-    , index(i)
     {
         cur = index.begin();
-        Seek();
+        cursor.Plan(index);
+        cursor.Seek(cur->beg);
+        PrefetchNext();
+    }
+    void PrefetchNext() {
+        if (cur != index.end() && cur + 1 != index.end())
+            cursor.Prefetch(cur[1]);
+    }
+    /* ReadChunk
+     *  read the next record of the current chunk,
+     *  jumping to the next chunk when this one is used up
+     */
+    BAMRecord const *ReadChunk(BAMRecordBuffer &buffer) {
+        while (cur != index.end() && !(cursor.Tell() < cur->end)) {
+            if (++cur == index.end())
+                break;
+            cursor.Seek(cur->beg);
+            PrefetchNext();
+        }
+        return cur != index.end() ? cursor.Read(buffer) : 0;
     }
 public:
     virtual bool isGoodRecord(BAMRecord const &rec) {
-        return parent->isGoodRecord(rec);
+        return cursor.isGoodRecord(rec);
     }
-    virtual BAMRecord const *Read() {
+    virtual BAMRecord const *Read(BAMRecordBuffer &buffer) {
         for ( ; ; ) {
-            BAMRecord const *const current = parent->Read();
+            BAMRecord const *const current = ReadChunk(buffer);
 
             if (!current)
                 return 0;
 
-            if (!current->isSelfMapped()) {
-                delete current;
+            if (!current->isSelfMapped())
                 continue;
-            }
+
             unsigned const REF = current->refID();
             unsigned const POS = current->pos();
 
-            if (REF != refID || POS >= end) {
-                delete current;
+            if (REF != refID || POS >= end)
                 return 0;
-            }
-            unsigned const LEN = current->refLen();
 
-            if (POS + LEN <= start) {
-                delete current;
+            unsigned const LEN = buffer.span().refLen;
+
+            if (POS + LEN <= start)
                 continue;
-            }
+
             return current;
         }
     }
     void DumpSAM(std::ostream &oss, BAMRecord const &rec) const {
-        parent->DumpSAM(oss, rec);
+        cursor.DumpSAM(oss, rec);
     }
 };
+
+/* BAMIndexBuilder
+ *  the BAI index of a file, built from the records as they are
+ *  written, with offsets those of BGZFWriter::Tell, or as they are
+ *  read, with offsets those of BAMFileCursor::Tell
+ */
+class BAMIndexBuilder
+{
+    struct Chunk {
+        uint64_t beg;
+        uint64_t end;
+    };
+    struct Ref {
+        std::map<uint32_t, std::vector<Chunk> > bins;
+        std::vector<uint64_t> linear;   /* first record of each 16 kbp window */
+        Chunk extent;               /* all the records of the reference */
+        uint64_t n_mapped;
+        uint64_t n_unmapped;
+        
+        Ref() : n_mapped(0), n_unmapped(0) {
+            extent.beg = extent.end = 0;
+        }
+    };
+    std::vector<Ref> refs;
+    uint64_t n_no_coor;
+    int32_t lastRefID;
+    int32_t lastPos;
+    bool sorted;
+
+public:
+    explicit BAMIndexBuilder(unsigned const referenceCount);
+
+    /* Add
+     *  a record of reference refID written at [beg, end) in the output
+     */
+    void Add(int32_t const refID, BAMRecord const &rec, uint64_t const beg, uint64_t const end);
+
+    /* Bin
+     *  the smallest bin of the BAI scheme holding [beg, end)
+     */
+    static uint32_t Bin(int32_t const beg, int32_t end);
+
+    /* isSorted
+     *  the records added so far are in position order
+     */
+    bool isSorted() const {
+        return sorted;
+    }
+
+    /* Encode
+     *  the index as a .bai file has it; with "file", its offsets are
+     *  translated by it, otherwise they are already file positions
+     */
+    void Encode(std::string &data, BGZFWriter const *const file) const;
+
+    /* Write
+     *  the index to indexpath, with its offsets translated by "file"
+     */
+    void Write(std::string const &indexpath, BGZFWriter const &file) const;
+
+    /* Save
+     *  encoded index data to indexpath
+     */
+    static void Save(std::string const &indexpath, std::string const &data);
+};
+
+/* BAMWriter
+ *  writes a BAM file: its header, then the records given to Write,
+ *  through a BGZFWriter with "threads" workers at compression "level"
+ *
+ *  with buildIndex, the records must be written in position order and
+ *  Close writes the index too, as filepath + ".bai"
+ */
+class BAMWriter
+{
+    std::string const path;
+    BGZFWriter file;
+    uint32_t const referenceCount;
+    BAMIndexBuilder *index;
+    uint64_t records;
+
+    BAMWriter(BAMWriter const &);
+    BAMWriter &operator =(BAMWriter const &);
+public:
+    /* References
+     *  the name and length of each reference, in header order
+     */
+    typedef std::vector<std::pair<std::string, uint32_t> > References;
+
+    BAMWriter(std::string const &filepath, std::string const &headerText, References const &references,
+              unsigned const threads = 0, int const level = -1, bool const buildIndex = false);
+    ~BAMWriter();
+
+    /* Write
+     *  the record as it is, except that with refMap its reference IDs
+     *  are replaced by refMap[refID]; it must have been read with all
+     *  its fields
+     */
+    void Write(BAMRecord const &rec, int32_t const *const refMap = 0);
+
+    uint64_t countOfRecords() const {
+        return records;
+    }
+
+    /* Close
+     *  finishes the file and writes the index; throws if the index was
+     *  asked for and the records weren't in position order
+     */
+    void Close(void);
+};
+
+#endif // _hpp_bam_
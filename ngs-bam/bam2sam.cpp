@@ -0,0 +1,508 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "bam.hpp"
+#include "sam.hpp"
+
+#include <pthread.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+/* bam2sam
+ *  a BAM file as SAM, or the records of some regions of it
+ *
+ *  the BGZF blocks are inflated on "-@" threads while one thread reads
+ *  the records into batches; "-t" threads format the batches as SAM,
+ *  each into a buffer of its own, and the buffers are written out in
+ *  the order the records were read, so the output doesn't depend on
+ *  the number of threads
+ *
+ *  a region is read with BAMFile::Slice, which needs an index; the
+ *  records are filtered on FLAG and MAPQ before they are formatted
+ */
+
+struct Options {
+    char const *input;
+    char const *output;
+    std::vector<char const *> regions;
+    unsigned inflaters;
+    unsigned formatters;
+    unsigned batchSize;
+    unsigned requireFlags;
+    unsigned rejectFlags;
+    int minMapQ;
+    bool header;
+    bool buildIndex;
+
+    Options()
+    : input(0), output(0), inflaters(2), formatters(2), batchSize(4096)
+    , requireFlags(0), rejectFlags(0), minMapQ(0), header(true), buildIndex(false)
+    {}
+};
+
+/* Batch
+ *  records, read into buffers that are kept and reused, then their text
+ */
+struct Batch {
+    enum State { empty, filled, formatting, formatted, writing };
+
+    BAMRecordBuffer *buffers;
+    BAMRecord const **records;
+    unsigned count;
+    std::vector<char> text;
+    size_t used;
+    State state;
+
+    Batch() : buffers(0), records(0), count(0), used(0), state(empty) {}
+    ~Batch() {
+        delete [] buffers;
+        delete [] records;
+    }
+    void Allocate(unsigned const size) {
+        buffers = new BAMRecordBuffer[size];
+        records = new BAMRecord const *[size];
+    }
+    void Format(BAMFile const &file) {
+        used = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            BAMRecord const &rec = *records[i];
+            size_t const need = used + SAMFormatter::MaxSize(file, rec) + 1;
+
+            if (need > text.size())
+                text.resize(need < 2 * text.size() ? 2 * text.size() : need);
+
+            char *const endp = SAMFormatter::Format(&text[used], file, rec);
+
+            *endp = '\n';
+            used = endp + 1 - &text[0];
+        }
+    }
+};
+
+/* Converter
+ *  batch n uses slot n % slots; the reader fills the slots in order,
+ *  the formatters take the filled ones in order, and the writer waits
+ *  for each in turn to be formatted
+ */
+class Converter {
+    BAMFile &file;
+    Options const &options;
+    FILE *const out;
+    std::vector<Batch> slots;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint64_t nextFill;              /* the batch the reader fills next */
+    uint64_t nextFormat;            /* the batch a formatter takes next */
+    uint64_t nextWrite;
+    bool filling;                   /* the reader isn't done */
+    bool failed;
+    std::string error;
+    uint64_t written;
+    uint64_t skipped;               /* records that aren't well formed */
+
+    Batch &Slot(uint64_t const n) {
+        return slots[n % slots.size()];
+    }
+    void WaitFor(uint64_t const n, Batch::State const state) {
+        while (!failed && Slot(n).state != state)
+            pthread_cond_wait(&changed, &lock);
+    }
+    void Fail(std::string const &what) {
+        pthread_mutex_lock(&lock);
+        if (!failed) {
+            failed = true;
+            error = what;
+        }
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+    }
+    bool Wanted(BAMRecord const &rec) const {
+        unsigned const flag = rec.flag();
+
+        return (flag & options.requireFlags) == options.requireFlags
+            && (flag & options.rejectFlags) == 0
+            && rec.mq() >= options.minMapQ;
+    }
+
+    /* Fill
+     *  the next batch of records from source
+     *  returns false at the end of the source
+     */
+    bool Fill(BAMRecordSource &source, Batch &batch) {
+        unsigned const size = options.batchSize;
+
+        batch.count = 0;
+        while (batch.count < size) {
+            BAMRecordBuffer &buffer = batch.buffers[batch.count];
+            BAMRecord const *const rec = source.Read(buffer);
+
+            if (!rec)
+                return false;
+            if (!source.isGoodRecord(*rec)) {
+                ++skipped;
+                continue;
+            }
+            if (Wanted(*rec))
+                batch.records[batch.count++] = rec;
+        }
+        return true;
+    }
+    void ReadSource(BAMRecordSource &source) {
+        for (bool more = true; more; ) {
+            pthread_mutex_lock(&lock);
+            WaitFor(nextFill, Batch::empty);
+
+            bool const stop = failed;
+
+            pthread_mutex_unlock(&lock);
+            if (stop)
+                return;
+
+            Batch &batch = Slot(nextFill);
+
+            more = Fill(source, batch);
+            if (batch.count == 0)
+                continue;
+
+            pthread_mutex_lock(&lock);
+            batch.state = Batch::filled;
+            ++nextFill;
+            pthread_cond_broadcast(&changed);
+            pthread_mutex_unlock(&lock);
+        }
+    }
+    void Read() {
+        if (options.regions.empty()) {
+            ReadSource(file);
+            return;
+        }
+        for (size_t i = 0; i < options.regions.size(); ++i) {
+            std::string rname;
+            unsigned start = 0;
+            unsigned last = 0;
+
+            Resolve(options.regions[i], rname, start, last);
+
+            BAMRecordSource *const source = file.Slice(rname, start, last);
+
+            try {
+                ReadSource(*source);
+            }
+            catch (...) {
+                delete source;
+                throw;
+            }
+            delete source;
+        }
+    }
+
+    /* Resolve
+     *  a region into a reference that can be sliced and its bounds
+     */
+    void Resolve(char const *const region, std::string &rname, unsigned &start, unsigned &last) const {
+        rname = region;
+        start = last = 0;
+        /* a reference name may have a colon in it */
+        if (file.getReferenceIndexByName(rname) < 0)
+            ParseRegion(region, rname, start, last);
+
+        int const refID = file.getReferenceIndexByName(rname);
+
+        if (refID < 0)
+            throw std::runtime_error("no reference " + rname);
+        if (!file.getRefInfo(refID).hasIndex())
+            throw std::runtime_error("a region needs an index; try -I");
+    }
+
+    void Format() {
+        pthread_mutex_lock(&lock);
+        for ( ; ; ) {
+            while (!failed && nextFormat == nextFill && filling)
+                pthread_cond_wait(&changed, &lock);
+            if (failed || nextFormat == nextFill)
+                break;
+
+            Batch &batch = Slot(nextFormat++);
+
+            batch.state = Batch::formatting;
+            pthread_mutex_unlock(&lock);
+            try {
+                batch.Format(file);
+            }
+            catch (std::exception const &e) {
+                Fail(e.what());
+                return;
+            }
+            pthread_mutex_lock(&lock);
+            batch.state = Batch::formatted;
+            pthread_cond_broadcast(&changed);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    void Write() {
+        pthread_mutex_lock(&lock);
+        for ( ; ; ) {
+            while (!failed && nextWrite == nextFill && filling)
+                pthread_cond_wait(&changed, &lock);
+            if (failed || nextWrite == nextFill)
+                break;
+            WaitFor(nextWrite, Batch::formatted);
+            if (failed)
+                break;
+
+            Batch &batch = Slot(nextWrite);
+
+            batch.state = Batch::writing;
+            pthread_mutex_unlock(&lock);
+            if (fwrite(&batch.text[0], 1, batch.used, out) != batch.used) {
+                Fail("can't write the output");
+                return;
+            }
+            written += batch.count;
+            pthread_mutex_lock(&lock);
+            batch.state = Batch::empty;
+            ++nextWrite;
+            pthread_cond_broadcast(&changed);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+
+    static void *Formatter(void *const self) {
+        static_cast<Converter *>(self)->Format();
+        return 0;
+    }
+    static void *Writer(void *const self) {
+        static_cast<Converter *>(self)->Write();
+        return 0;
+    }
+
+    Converter(Converter const &);
+    Converter &operator =(Converter const &);
+public:
+    Converter(BAMFile &File, Options const &Options, FILE *const Out)
+    : file(File)
+    , options(Options)
+    , out(Out)
+    , slots(2 * (Options.formatters + 1))
+    , nextFill(0)
+    , nextFormat(0)
+    , nextWrite(0)
+    , filling(true)
+    , failed(false)
+    , written(0)
+    , skipped(0)
+    {
+        pthread_mutex_init(&lock, 0);
+        pthread_cond_init(&changed, 0);
+        for (size_t i = 0; i < slots.size(); ++i)
+            slots[i].Allocate(Options.batchSize);
+    }
+    ~Converter() {
+        pthread_cond_destroy(&changed);
+        pthread_mutex_destroy(&lock);
+    }
+
+    /* ParseRegion
+     *  RNAME, RNAME:START or RNAME:START-END, 1-based and inclusive
+     */
+    static void ParseRegion(char const *const region, std::string &rname, unsigned &start, unsigned &last) {
+        char const *const colon = strrchr(region, ':');
+
+        start = last = 0;
+        if (colon == 0) {
+            rname = region;
+            return;
+        }
+        char *endp = 0;
+
+        rname.assign(region, colon);
+        start = strtoul(colon + 1, &endp, 10);
+        if (*endp == '-')
+            last = strtoul(endp + 1, &endp, 10);
+        if (*endp != '\0' || endp == colon + 1 || (last != 0 && last < start))
+            throw std::runtime_error(std::string("bad region ") + region);
+    }
+
+    /* Run
+     *  the records, after the header if it is wanted
+     *  returns the number written
+     */
+    uint64_t Run() {
+        for (size_t i = 0; i < options.regions.size(); ++i) {
+            std::string rname;
+            unsigned start;
+            unsigned last;
+
+            Resolve(options.regions[i], rname, start, last);
+        }
+        if (options.header)
+            WriteHeader();
+
+        std::vector<pthread_t> threads(options.formatters + 1);
+        size_t started = 0;
+
+        for ( ; started < threads.size(); ++started) {
+            void *(*const body)(void *) = started == 0 ? Writer : Formatter;
+
+            if (pthread_create(&threads[started], 0, body, this) != 0) {
+                Fail("can't start a thread");
+                break;
+            }
+        }
+        if (started == threads.size()) {
+            try {
+                Read();
+            }
+            catch (std::exception const &e) {
+                Fail(e.what());
+            }
+        }
+        pthread_mutex_lock(&lock);
+        filling = false;
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+        for (size_t i = 0; i < started; ++i)
+            pthread_join(threads[i], 0);
+
+        if (failed)
+            throw std::runtime_error(error);
+        if (skipped)
+            std::cerr << "bam2sam: skipped " << skipped << " records that aren't well formed" << std::endl;
+        return written;
+    }
+
+    /* WriteHeader
+     *  the header text, or @SQ lines if the file has no text
+     */
+    void WriteHeader() {
+        std::string const &text = file.getHeaderText();
+
+        if (text.empty()) {
+            for (unsigned i = 0; i < file.countOfReferences(); ++i) {
+                HeaderRefInfo const &ri = file.getRefInfo(i);
+
+                fprintf(out, "@SQ\tSN:%s\tLN:%u\n", ri.getName(), ri.getLength());
+            }
+            return;
+        }
+        size_t const length = strnlen(text.data(), text.size());
+
+        fwrite(text.data(), 1, length, out);
+        if (length > 0 && text[length - 1] != '\n')
+            fputc('\n', out);
+    }
+};
+
+static void usage(char const *const name)
+{
+    std::cerr
+        << "usage: " << name << " [options] <file.bam> [region ...]\n"
+           "  a region is RNAME, RNAME:START or RNAME:START-END\n"
+           "  -o <file>  write to the file instead of stdout\n"
+           "  -@ <n>     inflate n blocks at once, on the shared pool (2)\n"
+           "  -t <n>     format on n threads (2)\n"
+           "  -b <n>     records per batch (4096)\n"
+           "  -f <flags> only records with all of these FLAG bits\n"
+           "  -F <flags> only records with none of these FLAG bits\n"
+           "  -q <mapq>  only records with at least this MAPQ\n"
+           "  -I         index the file, if it has no index, for regions\n"
+           "  --no-header  records only\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        bool const hasValue = i + 1 < argc;
+
+        if (arg == "-o" && hasValue)
+            options.output = argv[++i];
+        else if (arg == "-@" && hasValue)
+            options.inflaters = strtoul(argv[++i], 0, 10);
+        else if (arg == "-t" && hasValue)
+            options.formatters = strtoul(argv[++i], 0, 10);
+        else if (arg == "-b" && hasValue)
+            options.batchSize = strtoul(argv[++i], 0, 10);
+        else if (arg == "-f" && hasValue)
+            options.requireFlags = strtoul(argv[++i], 0, 0);
+        else if (arg == "-F" && hasValue)
+            options.rejectFlags = strtoul(argv[++i], 0, 0);
+        else if (arg == "-q" && hasValue)
+            options.minMapQ = atoi(argv[++i]);
+        else if (arg == "-I")
+            options.buildIndex = true;
+        else if (arg == "--no-header")
+            options.header = false;
+        else if (arg[0] == '-' && arg.size() > 1) {
+            usage(argv[0]);
+            return 2;
+        }
+        else if (options.input == 0)
+            options.input = argv[i];
+        else
+            options.regions.push_back(argv[i]);
+    }
+    if (options.input == 0 || options.formatters == 0 || options.batchSize == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE *const out = options.output ? fopen(options.output, "w") : stdout;
+
+    if (out == 0) {
+        std::cerr << "bam2sam: can't create " << options.output << std::endl;
+        return 1;
+    }
+    try {
+        NGS_BAM::OpenOptions open;
+
+        open.threads = options.inflaters;
+        open.streaming = options.regions.empty();
+        open.buildIndex = options.buildIndex;
+
+        BAMFile file(options.input, open);
+        Converter converter(file, options, out);
+
+        converter.Run();
+    }
+    catch (std::exception const &e) {
+        std::cerr << "bam2sam: " << e.what() << std::endl;
+        if (options.output)
+            fclose(out);
+        return 1;
+    }
+    if (fflush(out) != 0 || ferror(out) || (options.output && fclose(out) != 0)) {
+        std::cerr << "bam2sam: can't write the output" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,644 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include <ngs-bam/ngs-bam.hpp>
+
+#include <ngs/ReadCollection.hpp>
+#include <ngs/ReferenceIterator.hpp>
+#include <ngs/PileupIterator.hpp>
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* bamserve
+ *  answers region queries about the BAM files under a directory over a
+ *  socket, keeping the files open from one request to the next, so that
+ *  their headers, indexes and block caches are read once per file rather
+ *  than once per request
+ *
+ *  all integers are little-endian; a string is a uint16 length and its
+ *  bytes, a path one relative to the directory served
+ *
+ *  a request is a frame of a uint32 size of the rest, a uint32 tag of
+ *  the client's choosing, a uint8 op and its arguments:
+ *    1  references  path
+ *    2  slice       path, reference, int64 start, uint64 length
+ *    3  coverage    path, reference, int64 start, uint64 length
+ *    4  pileup      path, reference, int64 start, uint64 length, int32 minQuality
+ *
+ *  it is answered by frames of a uint32 size of the rest, the request's
+ *  tag, a uint8 status and data: status 0 says more frames follow, 1
+ *  that this one is the last, 2 that the request failed, the data being
+ *  the message; the data of the frames of a request, put together, are
+ *    references: a uint32 count, then the name and uint64 length of each
+ *    slice: the alignments that overlap the window, each as a uint32
+ *        block_size and the record, as in a BAM file, its refID that of
+ *        the references answer
+ *    coverage: a uint32 depth for each position of the window
+ *    pileup: for each position int64 position, then uint32 counts of A,
+ *        C, G, T, N, deletions and insertions on the plus strand, then
+ *        those on the minus strand
+ *
+ *  a client may send requests before the answers to earlier ones come;
+ *  each connection answers its requests in the order they were sent
+ */
+
+enum Op {
+    opReferences = 1,
+    opSlice = 2,
+    opCoverage = 3,
+    opPileup = 4
+};
+
+enum Status {
+    statusMore = 0,
+    statusLast = 1,
+    statusFailed = 2
+};
+
+/* the largest request taken, and the data sent in a frame */
+#define MAX_REQUEST (64u * 1024u)
+#define FRAME_DATA (256u * 1024u)
+
+struct Options {
+    char const *root;
+    char const *listen;
+    char const *socketPath;
+    unsigned keep;
+    unsigned connections;
+    NGS_BAM::OpenOptions open;
+
+    Options()
+    : root(0), listen(0), socketPath(0), keep(64), connections(64)
+    , open(NGS_BAM::defaultOpenOptions())
+    {}
+};
+
+/* Catalog
+ *  the collections being served, by path, the least recently used closed
+ *  once there are more than "keep"; the engine keeps their files' headers
+ *  and indexes for as long as it keeps them open
+ */
+class Catalog {
+    struct Entry {
+        ngs::ReadCollection collection;
+        uint64_t used;
+
+        explicit Entry(ngs::ReadCollection const &c) : collection(c), used(0) {}
+    };
+    typedef std::map<std::string, Entry> Entries;
+
+    std::string root;
+    NGS_BAM::OpenOptions options;
+    size_t keep;
+    pthread_mutex_t lock;
+    Entries entries;
+    uint64_t clock;
+
+    /* Resolve
+     *  a path under the root, or throws; no absolute paths nor ".."
+     */
+    std::string Resolve(std::string const &path) const {
+        if (path.empty() || path[0] == '/')
+            throw std::runtime_error("bad path '" + path + "'");
+        for (size_t at = 0; at <= path.size(); ) {
+            size_t const end = std::min(path.find('/', at), path.size());
+            if (path.compare(at, end - at, "..") == 0)
+                throw std::runtime_error("bad path '" + path + "'");
+            at = end + 1;
+        }
+        return root + "/" + path;
+    }
+public:
+    Catalog(std::string const &Root, NGS_BAM::OpenOptions const &Options, size_t const Keep)
+    : root(Root), options(Options), keep(Keep == 0 ? 1 : Keep), clock(0)
+    {
+        pthread_mutex_init(&lock, 0);
+    }
+    ~Catalog() {
+        pthread_mutex_destroy(&lock);
+    }
+
+    ngs::ReadCollection Get(std::string const &path) {
+        pthread_mutex_lock(&lock);
+        Entries::iterator i = entries.find(path);
+        if (i != entries.end()) {
+            i->second.used = ++clock;
+            ngs::ReadCollection const rslt = i->second.collection;
+            pthread_mutex_unlock(&lock);
+            return rslt;
+        }
+        pthread_mutex_unlock(&lock);
+
+        // opened without the lock, so that a cold open doesn't hold up
+        // the others; if two race, the first one in is kept
+        ngs::ReadCollection const opened = NGS_BAM::openReadCollection(Resolve(path), options);
+
+        pthread_mutex_lock(&lock);
+        i = entries.insert(Entries::value_type(path, Entry(opened))).first;
+        i->second.used = ++clock;
+        ngs::ReadCollection const rslt = i->second.collection;
+        while (entries.size() > keep) {
+            Entries::iterator oldest = entries.begin();
+            for (Entries::iterator j = entries.begin(); j != entries.end(); ++j) {
+                if (j->second.used < oldest->second.used)
+                    oldest = j;
+            }
+            entries.erase(oldest);
+        }
+        pthread_mutex_unlock(&lock);
+        return rslt;
+    }
+};
+
+/* Request
+ *  the arguments of a request frame, read in order
+ */
+class Request {
+    std::vector<char> const &data;
+    size_t at;
+
+    char const *Take(size_t const n) {
+        if (data.size() - at < n)
+            throw std::runtime_error("short request");
+        char const *const rslt = &data[0] + at;
+        at += n;
+        return rslt;
+    }
+    uint64_t Unsigned(unsigned const n) {
+        uint8_t const *const p = (uint8_t const *)Take(n);
+        uint64_t rslt = 0;
+        for (unsigned i = n; i > 0; --i)
+            rslt = (rslt << 8) | p[i - 1];
+        return rslt;
+    }
+public:
+    explicit Request(std::vector<char> const &Data, size_t const start) : data(Data), at(start) {}
+
+    uint8_t U8() { return (uint8_t)Unsigned(1); }
+    int32_t I32() { return (int32_t)(uint32_t)Unsigned(4); }
+    uint32_t U32() { return (uint32_t)Unsigned(4); }
+    int64_t I64() { return (int64_t)Unsigned(8); }
+    uint64_t U64() { return Unsigned(8); }
+    std::string String() {
+        size_t const n = (size_t)Unsigned(2);
+        return std::string(Take(n), n);
+    }
+};
+
+/* Connection
+ *  reads the requests of one client and answers them in turn; an answer
+ *  is put together in "out" and sent a frame at a time
+ */
+class Connection {
+    int fd;
+    Catalog &catalog;
+    std::vector<char> in;
+    std::string out;
+    uint32_t tag;
+
+    bool Receive(char *dst, size_t n) {
+        while (n > 0) {
+            ssize_t const got = recv(fd, dst, n, 0);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                return false;
+            dst += got;
+            n -= (size_t)got;
+        }
+        return true;
+    }
+    void Send(char const *src, size_t n) {
+        while (n > 0) {
+            ssize_t const sent = send(fd, src, n, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent <= 0)
+                throw std::runtime_error("the client went away");
+            src += sent;
+            n -= (size_t)sent;
+        }
+    }
+
+    void Put(uint64_t value, unsigned const n) {
+        for (unsigned i = 0; i < n; ++i, value >>= 8)
+            out.push_back((char)(value & 0xFF));
+    }
+    void PutString(std::string const &value) {
+        Put(value.size(), 2);
+        out.append(value);
+    }
+
+    /* Begin, More, End
+     *  a frame's header is left room for at the front of "out"; More
+     *  sends what there is once it is a frame's worth
+     */
+    void Begin() {
+        out.assign(9, '\0');
+    }
+    void Finish(Status const status) {
+        uint32_t const size = (uint32_t)(out.size() - 4);
+        for (unsigned i = 0; i < 4; ++i) {
+            out[i] = (char)((size >> (8 * i)) & 0xFF);
+            out[4 + i] = (char)((tag >> (8 * i)) & 0xFF);
+        }
+        out[8] = (char)status;
+        Send(out.data(), out.size());
+    }
+    void More() {
+        if (out.size() >= FRAME_DATA) {
+            Finish(statusMore);
+            Begin();
+        }
+    }
+    void End() {
+        Finish(statusLast);
+    }
+    void Fail(std::string const &message) {
+        Begin();
+        out.append(message);
+        Finish(statusFailed);
+    }
+
+    void References(Request &request) {
+        ngs::ReadCollection const collection = catalog.Get(request.String());
+        std::vector<std::pair<std::string, uint64_t> > refs;
+        ngs::ReferenceIterator i = collection.getReferences();
+        while (i.nextReference())
+            refs.push_back(std::make_pair(i.getCommonName(), i.getLength()));
+
+        Begin();
+        Put(refs.size(), 4);
+        for (size_t k = 0; k < refs.size(); ++k) {
+            PutString(refs[k].first);
+            Put(refs[k].second, 8);
+            More();
+        }
+        End();
+    }
+    void Slice(ngs::Reference const &reference, int64_t const start, uint64_t const length) {
+        ngs::AlignmentIterator i = reference.getAlignmentSlice(start, length, ngs::Alignment::all);
+
+        Begin();
+        while (i.nextAlignment()) {
+            NGS_BAM::RawRecord const rec = NGS_BAM::getRawRecord(i);
+            Put(rec.size, 4);
+            out.append((char const *)rec.data, rec.size);
+            More();
+        }
+        End();
+    }
+    void Coverage(ngs::Reference const &reference, int64_t const start, uint64_t const length) {
+        std::vector<uint32_t> const depth = reference.getCoverage(start, length, ngs::Alignment::all,
+            (ngs::Alignment::AlignmentFilter)(ngs::Alignment::passFailed | ngs::Alignment::passDuplicates), 0);
+
+        Begin();
+        for (size_t k = 0; k < depth.size(); ++k) {
+            Put(depth[k], 4);
+            More();
+        }
+        End();
+    }
+    void Pileup(ngs::Reference const &reference, int64_t const start, uint64_t const length, int const minQuality) {
+        static ngs::PileupBaseCounts::BaseKind const kinds[] = {
+            ngs::PileupBaseCounts::baseA, ngs::PileupBaseCounts::baseC, ngs::PileupBaseCounts::baseG,
+            ngs::PileupBaseCounts::baseT, ngs::PileupBaseCounts::baseN, ngs::PileupBaseCounts::deletion,
+            ngs::PileupBaseCounts::insertion
+        };
+        unsigned const nkinds = sizeof(kinds) / sizeof(kinds[0]);
+        ngs::PileupIterator i = reference.getPileupSlice(start, length, ngs::Alignment::all);
+        std::vector<ngs::PileupBaseCounts> counts(1024);
+
+        Begin();
+        for ( ; ; ) {
+            uint32_t const n = i.nextBaseCounts(minQuality, &counts[0], (uint32_t)counts.size());
+            for (uint32_t k = 0; k < n; ++k) {
+                ngs::PileupBaseCounts const &c = counts[k];
+                Put(c.getReferencePosition(), 8);
+                for (unsigned j = 0; j < nkinds; ++j)
+                    Put(c.getCount(kinds[j], ngs::PileupBaseCounts::plusStrand), 4);
+                for (unsigned j = 0; j < nkinds; ++j)
+                    Put(c.getCount(kinds[j], ngs::PileupBaseCounts::minusStrand), 4);
+                More();
+            }
+            if (n < counts.size())
+                break;
+        }
+        End();
+    }
+
+    /* Answer
+     *  the request in "in", whose tag has been read
+     */
+    void Answer() {
+        Request request(in, 4);
+        uint8_t const op = request.U8();
+
+        if (op == opReferences) {
+            References(request);
+            return;
+        }
+        if (op != opSlice && op != opCoverage && op != opPileup)
+            throw std::runtime_error("unknown request");
+
+        ngs::ReadCollection const collection = catalog.Get(request.String());
+        ngs::Reference const reference = collection.getReference(request.String());
+        int64_t const start = request.I64();
+        uint64_t const length = request.U64();
+
+        if (op == opSlice)
+            Slice(reference, start, length);
+        else if (op == opCoverage)
+            Coverage(reference, start, length);
+        else
+            Pileup(reference, start, length, request.I32());
+    }
+public:
+    Connection(int const Fd, Catalog &Catalog) : fd(Fd), catalog(Catalog), tag(0) {}
+    ~Connection() {
+        close(fd);
+    }
+
+    void Run() {
+        for ( ; ; ) {
+            char head[4];
+            if (!Receive(head, 4))
+                return;
+            uint32_t const size = (uint8_t)head[0] | ((uint8_t)head[1] << 8) | ((uint8_t)head[2] << 16) | ((uint32_t)(uint8_t)head[3] << 24);
+            if (size < 5 || size > MAX_REQUEST)
+                return;
+            in.resize(size);
+            if (!Receive(&in[0], size))
+                return;
+            tag = Request(in, 0).U32();
+
+            std::string error;
+            try {
+                Answer();
+            }
+            catch (ngs::ErrorMsg const &e) {
+                error = e.what();
+            }
+            catch (std::exception const &e) {
+                error = e.what();
+            }
+            if (!error.empty()) {
+                // a client that can't be sent to is done with
+                try {
+                    Fail(error);
+                }
+                catch (std::exception const &) {
+                    return;
+                }
+            }
+        }
+    }
+};
+
+/* Server
+ *  takes connections, each on a thread of its own, up to "connections"
+ *  of them at once; the next waits for one to end
+ */
+class Server {
+    Catalog catalog;
+    unsigned connections;
+    unsigned running;
+    pthread_mutex_t lock;
+    pthread_cond_t ended;
+
+    struct Start {
+        Server *server;
+        int fd;
+    };
+    static void *Serve(void *const arg) {
+        Start const start = *(Start *)arg;
+        delete (Start *)arg;
+        {
+            Connection connection(start.fd, start.server->catalog);
+            connection.Run();
+        }
+        start.server->Ended();
+        return 0;
+    }
+    void Ended() {
+        pthread_mutex_lock(&lock);
+        --running;
+        pthread_cond_signal(&ended);
+        pthread_mutex_unlock(&lock);
+    }
+public:
+    Server(Options const &options)
+    : catalog(options.root, options.open, options.keep)
+    , connections(options.connections == 0 ? 1 : options.connections)
+    , running(0)
+    {
+        pthread_mutex_init(&lock, 0);
+        pthread_cond_init(&ended, 0);
+    }
+
+    void Run(int const listener) {
+        for ( ; ; ) {
+            pthread_mutex_lock(&lock);
+            while (running >= connections)
+                pthread_cond_wait(&ended, &lock);
+            pthread_mutex_unlock(&lock);
+
+            int const fd = accept(listener, 0, 0);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE)
+                    continue;
+                throw std::runtime_error(std::string("can't accept connections: ") + strerror(errno));
+            }
+            int const on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+            Start *const start = new Start;
+            start->server = this;
+            start->fd = fd;
+
+            pthread_t thread;
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+            pthread_mutex_lock(&lock);
+            ++running;
+            pthread_mutex_unlock(&lock);
+            if (pthread_create(&thread, &attr, Serve, start) != 0) {
+                delete start;
+                close(fd);
+                Ended();
+            }
+            pthread_attr_destroy(&attr);
+        }
+    }
+};
+
+/* Listen
+ *  on [host:]port, or on a Unix socket at "path"
+ */
+static int ListenTCP(std::string const &address)
+{
+    size_t const colon = address.rfind(':');
+    std::string const host = colon == std::string::npos ? std::string() : address.substr(0, colon);
+    std::string const port = colon == std::string::npos ? address : address.substr(colon + 1);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *found = 0;
+    int const rc = getaddrinfo(host.empty() ? 0 : host.c_str(), port.c_str(), &hints, &found);
+    if (rc != 0)
+        throw std::runtime_error("can't listen on '" + address + "': " + gai_strerror(rc));
+
+    int fd = -1;
+    for (struct addrinfo *ai = found; ai != 0 && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        int const on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 128) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0)
+        throw std::runtime_error("can't listen on '" + address + "': " + strerror(errno));
+    return fd;
+}
+
+static int ListenUnix(std::string const &path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("the socket path '" + path + "' is too long");
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw std::runtime_error(std::string("can't make a socket: ") + strerror(errno));
+    unlink(path.c_str());
+    if (bind(fd, (struct sockaddr const *)&addr, sizeof(addr)) != 0 || listen(fd, 128) != 0) {
+        int const error = errno;
+        close(fd);
+        throw std::runtime_error("can't listen on '" + path + "': " + strerror(error));
+    }
+    return fd;
+}
+
+static void usage(char const *const name)
+{
+    std::cerr
+        << "usage: " << name << " [options] <directory>\n"
+           "  serves the BAM files under the directory\n"
+           "  -l <[host:]port>  listen on TCP\n"
+           "  -u <path>         listen on a Unix socket\n"
+           "  -n <n>            collections kept open (64)\n"
+           "  -c <n>            connections served at once (64)\n"
+           "  -O <settings>     engine tunables, e.g. \"threads=4,blockCache=64\"\n"
+           "  -I                index files that have no index\n";
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string const arg = argv[i];
+            bool const hasValue = i + 1 < argc;
+
+            if (arg == "-l" && hasValue)
+                options.listen = argv[++i];
+            else if (arg == "-u" && hasValue)
+                options.socketPath = argv[++i];
+            else if (arg == "-n" && hasValue)
+                options.keep = strtoul(argv[++i], 0, 10);
+            else if (arg == "-c" && hasValue)
+                options.connections = strtoul(argv[++i], 0, 10);
+            else if (arg == "-O" && hasValue)
+                NGS_BAM::setOpenOptions(options.open, argv[++i]);
+            else if (arg == "-I")
+                options.open.buildIndex = true;
+            else if (arg[0] == '-' && arg.size() > 1) {
+                usage(argv[0]);
+                return 2;
+            }
+            else if (options.root == 0)
+                options.root = argv[i];
+            else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+    }
+    catch (std::exception const &e) {
+        std::cerr << "bamserve: " << e.what() << std::endl;
+        return 2;
+    }
+    if (options.root == 0 || (options.listen == 0) == (options.socketPath == 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    try {
+        // the files of collections let go stay open for a while yet
+        NGS_BAM::keepOpenFiles(options.keep);
+
+        int const listener = options.listen ? ListenTCP(options.listen) : ListenUnix(options.socketPath);
+        Server server(options);
+
+        server.Run(listener);
+    }
+    catch (std::exception const &e) {
+        std::cerr << "bamserve: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,2022 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "bgzf.hpp"
+#include "trace.hpp"
+#include "numa.hpp"
+
+#if HAVE_ISAL
+#include <isa-l/crc.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <stdexcept>
+#include <new>
+
+struct BGZFReader::Slot : public EngineBlock
+{
+    enum { empty, loaded, busy, done };
+
+    int state;
+    bool eof;
+    std::string error;
+    unsigned csize;
+    uint8_t const *src;             /* cdata or the mapped file */
+    BGZFBlock block;
+    uint8_t cdata[BAM_BLK_MAX];
+
+    Slot() : state(empty), eof(false), csize(0), src(0) {}
+};
+
+struct BGZFReader::Worker : public ngs::WorkItem
+{
+    BGZFReader *parent;
+    BGZFInflater inflater;
+    BGZFBatchInflater *batch;       /* owned, NULL but for the worker of a GPU */
+    bool queued;                    /* submitted to the pool and not yet run */
+    bool running;
+
+    explicit Worker(bool const verifyCRC) : parent(0), inflater(verifyCRC), batch(0), queued(false), running(false) {}
+    ~Worker() {
+        delete batch;
+    }
+    void run() {
+        parent->WorkerRun(*this);
+    }
+};
+
+class BGZFLock
+{
+    pthread_mutex_t *const mutex;
+public:
+    BGZFLock(pthread_mutex_t &m) : mutex(&m) {
+        pthread_mutex_lock(mutex);
+    }
+    ~BGZFLock() {
+        pthread_mutex_unlock(mutex);
+    }
+};
+
+/* ShardCount
+ *  a power of two, so that each shard has 4 blocks or more
+ */
+static unsigned ShardCount(unsigned const capacity)
+{
+    unsigned count = 1;
+    
+    if (capacity == 0)
+        return 0;
+    while (count < BLOCK_CACHE_SHARDS && count * 8 <= capacity)
+        count *= 2;
+    return count;
+}
+
+BGZFBlockCache::BGZFBlockCache(unsigned const Capacity, MemoryLedger *const Memory, BGZFDiskTier const &Disk)
+: shards(ShardCount(Capacity))
+, capacity(Capacity > 0 ? (Capacity + ShardCount(Capacity) - 1) / ShardCount(Capacity) : 0)
+, memory(Memory)
+, disk(Disk)
+{
+    for (unsigned i = 0; i < shards.size(); ++i) {
+        Shard *const shard = shards[i] = new Shard();
+        
+        shard->clock = 0;
+        pthread_rwlock_init(&shard->lock, 0);
+        pthread_mutex_init(&shard->mutex, 0);
+        pthread_cond_init(&shard->loaded, 0);
+    }
+}
+
+BGZFBlockCache::~BGZFBlockCache()
+{
+    for (unsigned i = 0; i < shards.size(); ++i) {
+        Shard *const shard = shards[i];
+        
+        for (unsigned j = 0; j < shard->entries.size(); ++j)
+            delete shard->entries[j];
+        if (memory)
+            memory->Remove(MemoryLedger::blockCache, shard->entries.size() * sizeof(Entry));
+        pthread_cond_destroy(&shard->loaded);
+        pthread_mutex_destroy(&shard->mutex);
+        pthread_rwlock_destroy(&shard->lock);
+        delete shard;
+    }
+}
+
+/* Find
+ *  copy a block out of its shard, pinned, so that the lock is only
+ *  held, and shared, while it is looked up
+ */
+bool BGZFBlockCache::Find(Shard &shard, uint64_t const fpos, BGZFBlock &dst, unsigned &csize) const
+{
+    pthread_rwlock_rdlock(&shard.lock);
+    
+    std::map<uint64_t, Entry *>::const_iterator const i = shard.byPos.find(fpos);
+    
+    if (i == shard.byPos.end()) {
+        pthread_rwlock_unlock(&shard.lock);
+        return false;
+    }
+    Entry &entry = *i->second;
+    
+    __atomic_add_fetch(&entry.pins, 1, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&entry.used, __atomic_add_fetch(&shard.clock, 1, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&shard.lock);
+    
+    dst.fpos = fpos;
+    dst.size = entry.block.size;
+    memcpy(dst.data, entry.block.data, entry.block.size);
+    csize = entry.csize;
+    
+    __atomic_sub_fetch(&entry.pins, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool BGZFBlockCache::Get(uint64_t const fpos, BGZFBlock &dst, unsigned &csize, bool const claim)
+{
+    bool claimed = false;
+    
+    if (!shards.empty()) {
+        Shard &shard = ShardOf(fpos);
+        
+        for ( ; ; ) {
+            if (Find(shard, fpos, dst, csize))
+                return true;
+            
+            BGZFLock lock(shard.mutex);
+            
+            if (shard.loading.count(fpos) != 0) {
+                /* another reader is inflating it */
+                do {
+                    pthread_cond_wait(&shard.loaded, &shard.mutex);
+                } while (shard.loading.count(fpos) != 0);
+                continue;
+            }
+            if (!claim)
+                break;
+            
+            /* it may have been put since it was looked for */
+            pthread_rwlock_rdlock(&shard.lock);
+            bool const put = shard.byPos.count(fpos) != 0;
+            pthread_rwlock_unlock(&shard.lock);
+            if (put)
+                continue;
+            
+            shard.loading.insert(fpos);
+            claimed = true;
+            break;
+        }
+    }
+    if (!disk.cache || !disk.inflated || !GetDisk(fpos, dst, csize))
+        return false;
+    if (!shards.empty()) {
+        Shard &shard = ShardOf(fpos);
+        
+        Keep(shard, dst, csize);
+        if (claimed)
+            EndClaim(shard, fpos);
+    }
+    return true;
+}
+
+/* GetDisk
+ *  a block from the disk tier, which has the size of the compressed
+ *  block in front of what it inflates to
+ */
+bool BGZFBlockCache::GetDisk(uint64_t const fpos, BGZFBlock &dst, unsigned &csize)
+{
+    std::vector<uint8_t> piece(4 + BAM_BLK_MAX);
+    size_t size = piece.size();
+    
+    if (!disk.cache->Get(disk.tag, fpos, 'i', &piece[0], size) || size < 4)
+        return false;
+    
+    dst.fpos = fpos;
+    dst.size = (unsigned)(size - 4);
+    memcpy(dst.data, &piece[4], dst.size);
+    csize = piece[0] | (piece[1] << 8) | (piece[2] << 16) | ((unsigned)piece[3] << 24);
+    return true;
+}
+
+/* Oldest
+ *  with the shard locked for writing; entries.size() if all are pinned
+ */
+unsigned BGZFBlockCache::Oldest(Shard const &shard)
+{
+    unsigned oldest = (unsigned)shard.entries.size();
+    
+    for (unsigned j = 0; j < shard.entries.size(); ++j) {
+        Entry const &entry = *shard.entries[j];
+        
+        if (__atomic_load_n(&entry.pins, __ATOMIC_ACQUIRE) != 0)
+            continue;
+        if (oldest == shard.entries.size() || entry.used < shard.entries[oldest]->used)
+            oldest = j;
+    }
+    return oldest;
+}
+
+void BGZFBlockCache::Keep(Shard &shard, BGZFBlock const &block, unsigned const csize)
+{
+    pthread_rwlock_wrlock(&shard.lock);
+    
+    std::map<uint64_t, Entry *>::const_iterator const i = shard.byPos.find(block.fpos);
+    
+    if (i != shard.byPos.end()) {
+        i->second->used = ++shard.clock;
+        pthread_rwlock_unlock(&shard.lock);
+        return;
+    }
+    
+    std::vector<Entry *> &entries = shard.entries;
+    Entry *victim = 0;
+    bool const tight = MemoryLedger::OverBudget(sizeof(Entry));
+    
+    if (entries.size() < capacity && !(tight && !entries.empty())) {
+        entries.push_back(0);
+        victim = entries.back() = new Entry();
+        if (memory)
+            memory->Add(MemoryLedger::blockCache, sizeof(Entry));
+    }
+    else {
+        unsigned oldest = Oldest(shard);
+        
+        if (tight && entries.size() > 1 && oldest < entries.size()) {
+            /* over budget: give the oldest back and reuse the next oldest */
+            shard.byPos.erase(entries[oldest]->block.fpos);
+            delete entries[oldest];
+            entries[oldest] = entries.back();
+            entries.pop_back();
+            if (memory)
+                memory->Remove(MemoryLedger::blockCache, sizeof(Entry));
+            oldest = Oldest(shard);
+        }
+        if (oldest < entries.size()) {
+            victim = entries[oldest];
+            shard.byPos.erase(victim->block.fpos);
+        }
+    }
+    if (victim) {
+        /* every other one pinned, it isn't kept */
+        victim->block.fpos = block.fpos;
+        victim->block.size = block.size;
+        memcpy(victim->block.data, block.data, block.size);
+        victim->csize = csize;
+        victim->used = ++shard.clock;
+        shard.byPos[block.fpos] = victim;
+    }
+    pthread_rwlock_unlock(&shard.lock);
+}
+
+void BGZFBlockCache::EndClaim(Shard &shard, uint64_t const fpos)
+{
+    BGZFLock lock(shard.mutex);
+    
+    if (shard.loading.erase(fpos) != 0)
+        pthread_cond_broadcast(&shard.loaded);
+}
+
+void BGZFBlockCache::Put(BGZFBlock const &block, unsigned const csize)
+{
+    if (disk.cache && disk.inflated) {
+        std::vector<uint8_t> piece(4 + block.size);
+        
+        piece[0] = (uint8_t)csize;
+        piece[1] = (uint8_t)(csize >> 8);
+        piece[2] = (uint8_t)(csize >> 16);
+        piece[3] = (uint8_t)(csize >> 24);
+        memcpy(&piece[4], block.data, block.size);
+        disk.cache->Put(disk.tag, block.fpos, 'i', &piece[0], piece.size());
+    }
+    if (shards.empty())
+        return;
+    
+    Shard &shard = ShardOf(block.fpos);
+    
+    Keep(shard, block, csize);
+    EndClaim(shard, block.fpos);
+}
+
+void BGZFBlockCache::Abandon(uint64_t const fpos)
+{
+    if (!shards.empty())
+        EndClaim(ShardOf(fpos), fpos);
+}
+
+bool MappedFile::Map(int const fd) {
+    struct stat st;
+    
+    Unmap();
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return false;
+    
+    void *const p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+        return false;
+    
+    base = p;
+    length = (size_t)st.st_size;
+    return true;
+}
+
+bool MappedFile::Map(std::string const &filepath) {
+    int const fd = open(filepath.c_str(), O_RDONLY);
+    
+    if (fd < 0)
+        return false;
+    
+    bool const rslt = Map(fd);
+    close(fd);
+    return rslt;
+}
+
+void MappedFile::Unmap(void) {
+    if (base) {
+        munmap(base, length);
+        base = 0;
+        length = 0;
+    }
+}
+
+#if HAVE_LIBDEFLATE
+
+BGZFInflater::BGZFInflater(bool const VerifyCRC)
+: decompressor(libdeflate_alloc_decompressor())
+, verifyCRC(VerifyCRC)
+{
+    if (decompressor == 0)
+        throw std::bad_alloc();
+}
+
+BGZFInflater::~BGZFInflater() {
+    libdeflate_free_decompressor(decompressor);
+}
+
+char const *BGZFInflater::Backend(void) {
+    return "libdeflate";
+}
+
+#elif HAVE_ISAL
+
+BGZFInflater::BGZFInflater(bool const VerifyCRC)
+: state(new inflate_state)
+, verifyCRC(VerifyCRC)
+{
+}
+
+BGZFInflater::~BGZFInflater() {
+    delete state;
+}
+
+char const *BGZFInflater::Backend(void) {
+    return "isa-l";
+}
+
+#else
+
+BGZFInflater::BGZFInflater(bool const VerifyCRC)
+: verifyCRC(VerifyCRC)
+{
+    memset(&zs, 0, sizeof(zs));
+    
+    /* raw deflate; the gzip wrapper is taken apart by Inflate */
+    int const zrc = inflateInit2(&zs, -MAX_WBITS);
+    switch (zrc) {
+        case Z_OK:
+            break;
+        case Z_MEM_ERROR:
+            throw std::bad_alloc();
+            break;
+        case Z_VERSION_ERROR:
+            throw std::runtime_error(std::string("zlib version is not compatible; need version " ZLIB_VERSION " but have ") + zlibVersion());
+            break;
+        case Z_STREAM_ERROR:
+        default:
+            throw std::invalid_argument(zs.msg ? zs.msg : "unknown");
+            break;
+    }
+}
+
+BGZFInflater::~BGZFInflater() {
+    inflateEnd(&zs);
+}
+
+char const *BGZFInflater::Backend(void) {
+    return "zlib";
+}
+
+#endif
+
+static uint32_t LE32(uint8_t const *const p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Unwrap
+ *  BGZF has only the FEXTRA flag set, so the deflate data starts right
+ *  after the extra field and ends 8 bytes before the end of the block
+ *  returns NULL, with the deflate data and the trailer's CRC32 and
+ *  size, or an error message
+ */
+static char const *Unwrap(uint8_t const *const src, unsigned const csize,
+                          uint8_t const *&in, unsigned &inlen, uint32_t &crc, uint32_t &isize)
+{
+    static unsigned const fixed_header = 12;
+    static unsigned const trailer_size = 8;
+    
+    if (csize < fixed_header + trailer_size)
+        return "block is truncated";
+    if (src[3] != 4)
+        return "unsupported gzip header";
+    
+    unsigned const header = fixed_header + (src[10] | (src[11] << 8));
+    
+    if (csize < header + trailer_size)
+        return "block is truncated";
+    
+    in = src + header;
+    inlen = csize - header - trailer_size;
+    crc = LE32(src + csize - trailer_size);
+    isize = LE32(src + csize - 4);
+    
+    if (isize > BAM_BLK_MAX)
+        return "block is too large";
+    return 0;
+}
+
+char const *BGZFInflater::Inflate(uint8_t const *const src, unsigned const csize, BGZFBlock &dst)
+{
+    TRACE_SPAN("BGZFInflater::Inflate");
+    uint8_t const *in;
+    unsigned inlen;
+    uint32_t crc, isize;
+    
+    if (char const *const error = Unwrap(src, csize, in, inlen, crc, isize))
+        return error;
+    
+#if HAVE_LIBDEFLATE
+    if (libdeflate_deflate_decompress(decompressor, in, inlen, dst.data, isize, 0) != LIBDEFLATE_SUCCESS)
+        return "decompression failed";
+    if (verifyCRC && libdeflate_crc32(0, dst.data, isize) != crc)
+        return "CRC mismatch";
+#elif HAVE_ISAL
+    isal_inflate_init(state);
+    state->next_in   = const_cast<uint8_t *>(in);
+    state->avail_in  = inlen;
+    state->next_out  = dst.data;
+    state->avail_out = sizeof(dst.data);
+    state->crc_flag  = ISAL_DEFLATE;
+    
+    if (isal_inflate_stateless(state) != ISAL_DECOMP_OK || state->total_out != isize)
+        return "decompression failed";
+    if (verifyCRC && crc32_gzip_refl(0, dst.data, isize) != crc)
+        return "CRC mismatch";
+#else
+    zs.next_in   = const_cast<Bytef *>(in);
+    zs.avail_in  = inlen;
+    zs.next_out  = dst.data;
+    zs.avail_out = sizeof(dst.data);
+    
+    int const zrc = inflate(&zs, Z_FINISH);
+    unsigned const size = (unsigned)(sizeof(dst.data) - zs.avail_out);
+    
+    if (inflateReset(&zs) != Z_OK)
+        return "inflateReset didn't return Z_OK";
+    if (zrc != Z_STREAM_END || size != isize)
+        return "decompression failed";
+    if (verifyCRC && crc32(0L, dst.data, size) != crc)
+        return "CRC mismatch";
+#endif
+    
+    dst.size = isize;
+    return 0;
+}
+
+#if HAVE_NVCOMP
+
+/* BlockCRC
+ *  the CRC32 of inflated data, with the backend's own
+ */
+static uint32_t BlockCRC(uint8_t const *const data, unsigned const size)
+{
+#if HAVE_LIBDEFLATE
+    return libdeflate_crc32(0, data, size);
+#elif HAVE_ISAL
+    return crc32_gzip_refl(0, data, size);
+#else
+    return crc32(0L, data, size);
+#endif
+}
+
+/* Device
+ *  a CUDA stream and the buffers of a batch, on the device and pinned
+ *  on the host; a block's deflate data and its inflated data each have
+ *  a BAM_BLK_MAX slice of them
+ */
+struct BGZFBatchInflater::Device
+{
+    cudaStream_t stream;
+    uint8_t *hostIn;
+    uint8_t *hostOut;
+    void **hostPtrs;                /* deflate data, then inflated data */
+    size_t *hostSizes;              /* deflate sizes, inflated sizes, actual sizes */
+    nvcompStatus_t *hostStatus;
+    uint8_t *deviceIn;
+    uint8_t *deviceOut;
+    void **devicePtrs;
+    size_t *deviceSizes;
+    nvcompStatus_t *deviceStatus;
+    void *temp;
+    size_t tempBytes;
+
+    Device() : stream(0), hostIn(0), hostOut(0), hostPtrs(0), hostSizes(0), hostStatus(0)
+    , deviceIn(0), deviceOut(0), devicePtrs(0), deviceSizes(0), deviceStatus(0), temp(0), tempBytes(0)
+    {}
+    ~Device() {
+        cudaFreeHost(hostIn);
+        cudaFreeHost(hostOut);
+        cudaFreeHost(hostPtrs);
+        cudaFreeHost(hostSizes);
+        cudaFreeHost(hostStatus);
+        cudaFree(deviceIn);
+        cudaFree(deviceOut);
+        cudaFree(devicePtrs);
+        cudaFree(deviceSizes);
+        cudaFree(deviceStatus);
+        cudaFree(temp);
+        if (stream)
+            cudaStreamDestroy(stream);
+    }
+    bool Allocate() {
+        size_t const data = (size_t)GPU_BATCH * BAM_BLK_MAX;
+        
+        return cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) == cudaSuccess
+            && cudaMallocHost((void **)&hostIn, data) == cudaSuccess
+            && cudaMallocHost((void **)&hostOut, data) == cudaSuccess
+            && cudaMallocHost((void **)&hostPtrs, 2 * GPU_BATCH * sizeof(void *)) == cudaSuccess
+            && cudaMallocHost((void **)&hostSizes, 3 * GPU_BATCH * sizeof(size_t)) == cudaSuccess
+            && cudaMallocHost((void **)&hostStatus, GPU_BATCH * sizeof(nvcompStatus_t)) == cudaSuccess
+            && cudaMalloc((void **)&deviceIn, data) == cudaSuccess
+            && cudaMalloc((void **)&deviceOut, data) == cudaSuccess
+            && cudaMalloc((void **)&devicePtrs, 2 * GPU_BATCH * sizeof(void *)) == cudaSuccess
+            && cudaMalloc((void **)&deviceSizes, 3 * GPU_BATCH * sizeof(size_t)) == cudaSuccess
+            && cudaMalloc((void **)&deviceStatus, GPU_BATCH * sizeof(nvcompStatus_t)) == cudaSuccess
+            && nvcompBatchedDeflateDecompressGetTempSize(GPU_BATCH, BAM_BLK_MAX, &tempBytes) == nvcompSuccess
+            && cudaMalloc(&temp, tempBytes) == cudaSuccess;
+    }
+    /* Run
+     *  inflate the first "count" slices of hostIn into hostOut; false
+     *  if the device failed, not if a block did
+     */
+    bool Run(unsigned const count) {
+        for (unsigned i = 0; i < count; ++i) {
+            hostPtrs[i] = deviceIn + (size_t)i * BAM_BLK_MAX;
+            hostPtrs[GPU_BATCH + i] = deviceOut + (size_t)i * BAM_BLK_MAX;
+        }
+        
+        size_t used = 0;
+        for (unsigned i = 0; i < count; ++i)
+            used = (size_t)i * BAM_BLK_MAX + hostSizes[i];
+        
+        void *const *const inflated = devicePtrs + GPU_BATCH;
+        size_t *const sizes = deviceSizes;
+        
+        return cudaMemcpyAsync(deviceIn, hostIn, used, cudaMemcpyHostToDevice, stream) == cudaSuccess
+            && cudaMemcpyAsync(devicePtrs, hostPtrs, 2 * GPU_BATCH * sizeof(void *), cudaMemcpyHostToDevice, stream) == cudaSuccess
+            && cudaMemcpyAsync(deviceSizes, hostSizes, 2 * GPU_BATCH * sizeof(size_t), cudaMemcpyHostToDevice, stream) == cudaSuccess
+            && nvcompBatchedDeflateDecompressAsync(devicePtrs, sizes, sizes + GPU_BATCH, sizes + 2 * GPU_BATCH,
+                                                   count, temp, tempBytes, inflated, deviceStatus, stream) == nvcompSuccess
+            && cudaMemcpyAsync(hostOut, deviceOut, (size_t)count * BAM_BLK_MAX, cudaMemcpyDeviceToHost, stream) == cudaSuccess
+            && cudaMemcpyAsync(hostSizes + 2 * GPU_BATCH, sizes + 2 * GPU_BATCH, count * sizeof(size_t), cudaMemcpyDeviceToHost, stream) == cudaSuccess
+            && cudaMemcpyAsync(hostStatus, deviceStatus, count * sizeof(nvcompStatus_t), cudaMemcpyDeviceToHost, stream) == cudaSuccess
+            && cudaStreamSynchronize(stream) == cudaSuccess;
+    }
+};
+
+BGZFBatchInflater *BGZFBatchInflater::Open(bool const verifyCRC)
+{
+    int devices = 0;
+    
+    if (cudaGetDeviceCount(&devices) != cudaSuccess || devices == 0)
+        return 0;
+    
+    Device *const device = new Device();
+    
+    if (!device->Allocate()) {
+        delete device;
+        return 0;
+    }
+    return new BGZFBatchInflater(device, verifyCRC);
+}
+
+char const *BGZFBatchInflater::Backend(void) {
+    return "nvcomp";
+}
+
+#else
+
+struct BGZFBatchInflater::Device
+{
+};
+
+BGZFBatchInflater *BGZFBatchInflater::Open(bool const verifyCRC)
+{
+    return 0;
+}
+
+char const *BGZFBatchInflater::Backend(void) {
+    return 0;
+}
+
+#endif
+
+BGZFBatchInflater::BGZFBatchInflater(Device *const Device, bool const VerifyCRC)
+: device(Device)
+, fallback(VerifyCRC)
+, verifyCRC(VerifyCRC)
+{
+}
+
+BGZFBatchInflater::~BGZFBatchInflater()
+{
+    delete device;
+}
+
+void BGZFBatchInflater::Inflate(unsigned const count, uint8_t const *const src[], unsigned const csize[],
+                                BGZFBlock *const dst[], char const *error[])
+{
+    TRACE_SPAN("BGZFBatchInflater::Inflate");
+#if HAVE_NVCOMP
+    unsigned const n = count < GPU_BATCH ? count : GPU_BATCH;
+    uint32_t crc[GPU_BATCH], isize[GPU_BATCH];
+    
+    for (unsigned i = 0; i < n; ++i) {
+        uint8_t const *in = 0;
+        unsigned inlen = 0;
+        
+        error[i] = Unwrap(src[i], csize[i], in, inlen, crc[i], isize[i]);
+        if (error[i])
+            inlen = 0;              /* passed over, and not looked at */
+        else
+            memcpy(device->hostIn + (size_t)i * BAM_BLK_MAX, in, inlen);
+        device->hostSizes[i] = inlen;
+        device->hostSizes[GPU_BATCH + i] = BAM_BLK_MAX;
+    }
+    if (device->Run(n)) {
+        for (unsigned i = 0; i < n; ++i) {
+            uint8_t const *const out = device->hostOut + (size_t)i * BAM_BLK_MAX;
+            
+            if (error[i])
+                continue;
+            if (device->hostStatus[i] != nvcompSuccess || device->hostSizes[2 * GPU_BATCH + i] != isize[i])
+                error[i] = "decompression failed";
+            else if (verifyCRC && BlockCRC(out, isize[i]) != crc[i])
+                error[i] = "CRC mismatch";
+            else {
+                memcpy(dst[i]->data, out, isize[i]);
+                dst[i]->size = isize[i];
+            }
+        }
+        if (n < count)
+            Inflate(count - n, src + n, csize + n, dst + n, error + n);
+        return;
+    }
+#endif
+    /* the device failed, or there is none */
+    for (unsigned i = 0; i < count; ++i)
+        error[i] = fallback.Inflate(src[i], csize[i], *dst[i]);
+}
+
+/* the empty block that ends a BGZF file */
+static uint8_t const eofMarker[] = {
+    31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0,
+    27, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+uint64_t BGZFStats::Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* Inflate
+ *  inflate a block with one of the reader's inflaters, or copy it from
+ *  the cache, counting either in stats; a block inflated is put there
+ *  for the other readers, and those that want it meanwhile wait for it
+ */
+char const *BGZFReader::Inflate(BGZFInflater &inflater, uint8_t const *const src, unsigned const csize, BGZFBlock &dst)
+{
+    unsigned cached;
+    
+    if (!cache)
+        return InflateTimed(inflater, src, csize, dst);
+    if (cache->Get(dst.fpos, dst, cached, true)) {
+        if (stats)
+            BGZFStats::Add(stats->cacheHits, 1);
+        return 0;
+    }
+    
+    /* the block is claimed, so it is put or abandoned whatever happens */
+    char const *error;
+    
+    try {
+        error = InflateTimed(inflater, src, csize, dst);
+    }
+    catch (...) {
+        cache->Abandon(dst.fpos);
+        throw;
+    }
+    if (error || dst.size == 0)
+        cache->Abandon(dst.fpos);
+    else
+        cache->Put(dst, csize);
+    return error;
+}
+
+char const *BGZFReader::InflateTimed(BGZFInflater &inflater, uint8_t const *const src, unsigned const csize, BGZFBlock &dst)
+{
+    if (!stats)
+        return inflater.Inflate(src, csize, dst);
+    
+    uint64_t const start = BGZFStats::Now();
+    char const *const error = inflater.Inflate(src, csize, dst);
+    
+    uint64_t const elapsed = BGZFStats::Now() - start;
+    
+    BGZFStats::Add(stats->inflateNanos, elapsed);
+    stats->inflateLatency.Add(elapsed);
+    if (!error) {
+        BGZFStats::Add(stats->inflatedBytes, dst.size);
+        BGZFStats::Add(stats->blocksInflated, 1);
+    }
+    return error;
+}
+
+/* Fill
+ *  make at least "want" bytes available at io_cur
+ *  returns the number of bytes available
+ */
+size_t BGZFReader::Fill(size_t const want) {
+    if (io_end - io_cur >= want || io_eof)
+        return io_end - io_cur;
+    
+    if (io_cur > 0) {
+        memmove(iobuffer, iobuffer + io_cur, io_end - io_cur);
+        cpos += io_cur;
+        io_end -= io_cur;
+        io_cur = 0;
+    }
+    while (io_end < want) {
+        /* at first and after a seek, read little, as it may be for one
+         * record, then more and more as reading goes on */
+        size_t const room = ioSize - io_end;
+        size_t const ask = want - io_end > readSize ? want - io_end : readSize;
+        uint64_t const start = stats ? BGZFStats::Now() : 0;
+        uint64_t const before = stats ? source->Requests() : 0;
+        size_t const nread = source->Read(cpos + io_end, iobuffer + io_end, ask < room ? ask : room);
+        
+        readSize = 2 * readSize < ioSize ? 2 * readSize : ioSize;
+        
+        if (stats) {
+            BGZFStats::Add(stats->readNanos, BGZFStats::Now() - start);
+            BGZFStats::Add(stats->bytesRead, nread);
+            BGZFStats::Add(stats->requests, source->Requests() - before);
+        }
+        if (nread == 0) {
+            io_eof = true;
+            break;
+        }
+        io_end += nread;
+    }
+    return io_end - io_cur;
+}
+
+/* Await
+ *  wait FOLLOW_POLL_MS for a followed file to grow; the reader thread
+ *  waits on readerCond, so that it stops waiting as soon as Seek or
+ *  StopThreads want it to, and then returns false
+ */
+bool BGZFReader::Await(void) {
+    if (workers.empty()) {
+        usleep(FOLLOW_POLL_MS * 1000u);
+        return true;
+    }
+    
+    BGZFLock lock(mutex);
+    struct timespec deadline;
+    
+    if (shutdown || !reading)
+        return false;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += (long)FOLLOW_POLL_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&readerCond, &mutex, &deadline);
+    return !shutdown && reading;
+}
+
+/* FillFollowing
+ *  Fill, and with follow, read again until "want" bytes are there or
+ *  the file hasn't grown for "follow" seconds
+ */
+size_t BGZFReader::FillFollowing(size_t const want) {
+    size_t have = Fill(want);
+    
+    if (have >= want || follow == 0)
+        return have;
+    
+    uint64_t const patience = (uint64_t)follow * 1000000000u;
+    uint64_t deadline = BGZFStats::Now() + patience;
+    
+    while (have < want && !isComplete() && BGZFStats::Now() < deadline && Await()) {
+        size_t const before = have;
+        
+        io_eof = false;
+        have = Fill(want);
+        if (have > before)
+            deadline = BGZFStats::Now() + patience;
+    }
+    return have;
+}
+
+/* LoadBlock
+ *  make the whole block at io_cur available
+ *  returns the size of the compressed block or 0 at end of file
+ */
+unsigned BGZFReader::LoadBlock(void) {
+    static unsigned const fixed_header = 12;
+    
+    ReadAhead(cpos + io_cur);
+    
+    size_t const avail = FillFollowing(fixed_header);
+    
+    if (avail == 0) {
+        if (streaming && !(map.data() && !workers.empty()))
+            DropBehind(cpos + io_cur, true);
+        return 0;
+    }
+    if (avail < fixed_header)
+        throw std::runtime_error("file is truncated");
+    
+    {
+        uint8_t const *const hdr = io + io_cur;
+        
+        if (hdr[0] != 31 || hdr[1] != 139 || hdr[2] != 8 || (hdr[3] & 4) == 0)
+            throw std::runtime_error("file is not BGZF compressed");
+    }
+    unsigned const xlen = io[io_cur + 10] | (io[io_cur + 11] << 8);
+    
+    if (FillFollowing(fixed_header + xlen) < fixed_header + xlen)
+        throw std::runtime_error("file is truncated");
+    
+    uint8_t const *const extra = io + io_cur + fixed_header;
+    unsigned csize = 0;
+    
+    for (unsigned i = 0; i + 4 <= xlen; ) {
+        unsigned const slen = extra[i + 2] | (extra[i + 3] << 8);
+        
+        if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2 && i + 6 <= xlen) {
+            csize = (extra[i + 4] | (extra[i + 5] << 8)) + 1;
+            break;
+        }
+        i += 4 + slen;
+    }
+    if (csize < fixed_header + xlen + 8)
+        throw std::runtime_error("file is not BGZF compressed");
+    
+    if (FillFollowing(csize) < csize)
+        throw std::runtime_error("file is truncated");
+    if (csize == sizeof(eofMarker) && memcmp(io + io_cur, eofMarker, csize) == 0)
+        __atomic_store_n(&complete, true, __ATOMIC_RELAXED);
+    
+    if (stats)
+        BGZFStats::Add(stats->compressedBytes, csize);
+    return csize;
+}
+
+/* Observe
+ *  a seek to fpos: the run it ends and how far it goes from where
+ *  reading was go into the file's averages
+ */
+void BGZFReader::Observe(uint64_t const fpos) {
+    uint64_t const at = cpos + io_cur;
+    
+    if (stats) {
+        BGZFStats::Average(stats->runAverage, at > runStart ? at - runStart : 0);
+        BGZFStats::Average(stats->seekAverage, fpos > at ? fpos - at : at - fpos);
+    }
+    runStart = fpos;
+}
+
+/* FirstRead
+ *  how much to read after a seek: with adaptive, what a run usually
+ *  reads, else a block
+ */
+size_t BGZFReader::FirstRead(void) const {
+    uint64_t const usual = adaptive && stats ? BGZFStats::Get(stats->runAverage) : 0;
+    size_t const size = usual < BAM_BLK_MAX ? BAM_BLK_MAX : usual < ioSize ? (size_t)usual : ioSize;
+    
+    if (stats)
+        BGZFStats::Set(stats->firstRead, size);
+    return size;
+}
+
+/* Ahead
+ *  how far ahead of fpos to have the system read: with adaptive, as far
+ *  as the run so far or the usual one, whichever is longer, once that
+ *  is more than the buffer holds, up to ADAPTIVE_AHEAD; at least prefetch
+ */
+uint64_t BGZFReader::Ahead(uint64_t const fpos) const {
+    if (!adaptive)
+        return prefetch;
+    
+    uint64_t const run = fpos > runStart ? fpos - runStart : 0;
+    uint64_t const usual = stats ? BGZFStats::Get(stats->runAverage) : 0;
+    uint64_t ahead = run > usual ? run : usual;
+    
+    if (ahead <= ioSize)
+        ahead = 0;
+    else if (ahead > ADAPTIVE_AHEAD)
+        ahead = ADAPTIVE_AHEAD;
+    if (ahead < prefetch)
+        ahead = prefetch;
+    if (stats)
+        BGZFStats::Set(stats->readAhead, ahead);
+    return ahead;
+}
+
+void BGZFReader::SeekFile(uint64_t const fpos) {
+    advised = 0;
+    Observe(fpos);
+    if (map.data()) {
+        if (fpos > map.size())
+            throw std::runtime_error("position is invalid");
+        io_cur = (size_t)fpos;
+        return;
+    }
+    if (fpos >= cpos && fpos - cpos <= io_end) {
+        /* still in the buffer */
+        io_cur = (size_t)(fpos - cpos);
+        return;
+    }
+    if (stats)
+        BGZFStats::Add(stats->seeks, 1);
+    cpos = fpos;
+    io_cur = io_end = 0;
+    io_eof = false;
+    readSize = FirstRead();
+}
+
+void BGZFReader::WillNeed(uint64_t const fpos, uint64_t const length) {
+    /* only hints, failures don't matter */
+    if (map.data()) {
+        if (fpos >= map.size())
+            return;
+        
+        uint64_t const page = (uint64_t)sysconf(_SC_PAGESIZE);
+        uint64_t const beg = fpos - fpos % page;
+        uint64_t const end = length < map.size() - fpos ? fpos + length : map.size();
+        
+        madvise((void *)(map.data() + beg), (size_t)(end - beg), MADV_WILLNEED);
+    }
+    else
+        source->WillNeed(fpos, length);
+}
+
+/* DropBehind
+ *  when streaming, drop the pages before fpos, STREAM_AHEAD bytes at
+ *  a time, or all of them at the end of the file; a mapped file's are
+ *  unmapped from this reader first, as the system keeps mapped pages
+ */
+void BGZFReader::DropBehind(uint64_t const fpos, bool const atEnd) {
+    /* only hints, failures don't matter */
+    uint64_t const page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t const end = atEnd ? fpos : fpos - fpos % page;
+    
+    if (end < dropped)
+        dropped = end - end % page;
+    if (end == dropped || (!atEnd && end - dropped < STREAM_AHEAD))
+        return;
+    if (map.data())
+        madvise((void *)(map.data() + dropped), (size_t)(end - dropped), MADV_DONTNEED);
+    source->DontNeed(dropped, end - dropped);
+    dropped = end;
+}
+
+/* ReadAhead
+ *  keep the next Ahead bytes after fpos requested,
+ *  asking for more each time half of them have been used
+ */
+void BGZFReader::ReadAhead(uint64_t const fpos) {
+    /* workers inflate straight from a mapping, so then NextParallel drops */
+    if (streaming && !(map.data() && !workers.empty()))
+        DropBehind(fpos);
+    
+    uint64_t const ahead = Ahead(fpos);
+    
+    if (ahead == 0 || fpos + ahead / 2 < advised)
+        return;
+    
+    uint64_t const beg = fpos > advised ? fpos : advised;
+    
+    advised = fpos + ahead;
+    WillNeed(beg, advised - beg);
+}
+
+void BGZFReader::Prefetch(uint64_t const fpos, uint64_t const length) {
+    if (prefetch > 0)
+        WillNeed(fpos, length);
+}
+
+void BGZFReader::Plan(uint64_t const fpos, uint64_t const length) {
+    if (source->Descriptor() < 0)
+        source->WillNeed(fpos, length);
+}
+
+void BGZFReader::Advise(uint64_t const fpos, uint64_t const length) {
+    WillNeed(fpos, length);
+}
+
+/* TakeCached
+ *  with nothing read yet at the current position, e.g. after a seek,
+ *  the block there from the cache, without reading it
+ */
+bool BGZFReader::TakeCached(void) {
+    uint64_t const fpos = cpos + io_cur;
+    unsigned csize;
+    
+    if (!cache->Get(fpos, block, csize))
+        return false;
+    if (stats)
+        BGZFStats::Add(stats->cacheHits, 1);
+    cpos = fpos + csize;
+    io_cur = io_end = 0;
+    return true;
+}
+
+BGZFBlock const *BGZFReader::NextSerial(void) {
+    for ( ; ; ) {
+        if (cache && !map.data() && io_cur == io_end && !io_eof && TakeCached())
+            return &block;
+        
+        unsigned const csize = LoadBlock();
+        
+        if (csize == 0)
+            return 0;
+        
+        block.fpos = cpos + io_cur;
+        
+        char const *const error = Inflate(inflater, io + io_cur, csize, block);
+        if (error)
+            throw std::runtime_error(error);
+        io_cur += csize;
+        
+        if (block.size > 0)
+            return &block;
+    }
+}
+
+void BGZFReader::ReaderLoop(void) {
+    BGZFLock lock(mutex);
+    
+    for ( ; ; ) {
+        while (!shutdown && (!reading || fill - head == slots.size()))
+            pthread_cond_wait(&readerCond, &mutex);
+        if (shutdown)
+            break;
+        
+        Slot &slot = *slots[fill % slots.size()];
+        
+        readerBusy = true;
+        pthread_mutex_unlock(&mutex);
+        try {
+            unsigned const csize = LoadBlock();
+            
+            if (csize == 0)
+                slot.eof = true;
+            else {
+                if (map.data())
+                    slot.src = io + io_cur;
+                else {
+                    memcpy(slot.cdata, io + io_cur, csize);
+                    slot.src = slot.cdata;
+                }
+                slot.csize = csize;
+                slot.block.fpos = cpos + io_cur;
+                io_cur += csize;
+            }
+        }
+        catch (std::exception const &e) {
+            slot.error = e.what();
+        }
+        catch (...) {
+            slot.error = "unknown error";
+        }
+        pthread_mutex_lock(&mutex);
+        readerBusy = false;
+        
+        if (!reading) {
+            /* Seek was called while loading; the slot is discarded */
+            pthread_cond_broadcast(&doneCond);
+            continue;
+        }
+        ++fill;
+        if (slot.eof || !slot.error.empty()) {
+            slot.state = Slot::done;
+            reading = false;
+            pthread_cond_broadcast(&doneCond);
+        }
+        else {
+            slot.state = Slot::loaded;
+            Dispatch();
+            /* Next may be waiting to inflate it */
+            pthread_cond_broadcast(&doneCond);
+        }
+    }
+}
+
+/* Dispatch
+ *  submit an idle worker for the loaded slots, if there is one; those
+ *  queued or running take the rest in turn; with the lock held
+ *  none is once StopThreads has begun, as it may have found them all
+ *  idle already and be about to delete them
+ */
+void BGZFReader::Dispatch(void) {
+    if (shutdown)
+        return;
+    for (unsigned i = 0; i < workers.size(); ++i) {
+        Worker &worker = *workers[i];
+        
+        if (worker.queued || worker.running)
+            continue;
+        try {
+            pool->submit(worker, priority);
+            worker.queued = true;
+        }
+        catch (...) {
+            /* Next inflates what the pool doesn't */
+        }
+        return;
+    }
+}
+
+/* InflateSlot
+ *  inflate a loaded slot without the lock, which is held on entry
+ */
+void BGZFReader::InflateSlot(Slot &slot, BGZFInflater &inflater) {
+    slot.state = Slot::busy;
+    ++inflight;
+    pthread_mutex_unlock(&mutex);
+    
+    char const *const error = Inflate(inflater, slot.src, slot.csize, slot.block);
+    
+    pthread_mutex_lock(&mutex);
+    if (error)
+        slot.error = error;
+    slot.state = Slot::done;
+    --inflight;
+    pthread_cond_broadcast(&doneCond);
+}
+
+/* InflateSlots
+ *  inflate busy slots on a GPU, each as Inflate would, from the cache
+ *  or into it
+ */
+void BGZFReader::InflateSlots(BGZFBatchInflater &batch, Slot *const batchSlots[], unsigned const count) {
+    uint8_t const *src[GPU_BATCH];
+    unsigned csize[GPU_BATCH];
+    BGZFBlock *dst[GPU_BATCH];
+    char const *error[GPU_BATCH];
+    Slot *claimed[GPU_BATCH];
+    unsigned n = 0;
+    
+    for (unsigned i = 0; i < count; ++i) {
+        Slot &slot = *batchSlots[i];
+        unsigned cached;
+        
+        if (cache && cache->Get(slot.block.fpos, slot.block, cached, true)) {
+            if (stats)
+                BGZFStats::Add(stats->cacheHits, 1);
+            continue;
+        }
+        src[n] = slot.src;
+        csize[n] = slot.csize;
+        dst[n] = &slot.block;
+        claimed[n++] = &slot;
+    }
+    if (n == 0)
+        return;
+    
+    uint64_t const start = stats ? BGZFStats::Now() : 0;
+    
+    try {
+        batch.Inflate(n, src, csize, dst, error);
+    }
+    catch (...) {
+        for (unsigned i = 0; cache && i < n; ++i)
+            cache->Abandon(claimed[i]->block.fpos);
+        throw;
+    }
+    if (stats) {
+        uint64_t const elapsed = BGZFStats::Now() - start;
+        
+        BGZFStats::Add(stats->inflateNanos, elapsed);
+        for (unsigned i = 0; i < n; ++i) {
+            stats->inflateLatency.Add(elapsed / n);
+            if (!error[i]) {
+                BGZFStats::Add(stats->inflatedBytes, dst[i]->size);
+                BGZFStats::Add(stats->blocksInflated, 1);
+            }
+        }
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        Slot &slot = *claimed[i];
+        
+        if (error[i])
+            slot.error = error[i];
+        if (!cache)
+            continue;
+        if (error[i] || slot.block.size == 0)
+            cache->Abandon(slot.block.fpos);
+        else
+            cache->Put(slot.block, slot.csize);
+    }
+}
+
+/* InflateBatch
+ *  inflate the loaded slots there are, up to GPU_BATCH, on the GPU of
+ *  "self" without the lock, which is held on entry
+ */
+void BGZFReader::InflateBatch(Worker &self) {
+    Slot *taken[GPU_BATCH];
+    unsigned count = 0;
+    
+    while (count < GPU_BATCH && work < fill) {
+        Slot &slot = *slots[work++ % slots.size()];
+        
+        if (slot.state != Slot::loaded)
+            continue;
+        slot.state = Slot::busy;
+        taken[count++] = &slot;
+    }
+    if (count == 0)
+        return;
+    
+    std::string failed;
+    
+    self.running = true;
+    inflight += count;
+    pthread_mutex_unlock(&mutex);
+    try {
+        InflateSlots(*self.batch, taken, count);
+    }
+    catch (std::exception const &e) {
+        failed = e.what();
+    }
+    catch (...) {
+        failed = "unknown error";
+    }
+    pthread_mutex_lock(&mutex);
+    for (unsigned i = 0; i < count; ++i) {
+        if (!failed.empty())
+            taken[i]->error = failed;
+        taken[i]->state = Slot::done;
+    }
+    inflight -= count;
+    self.running = false;
+}
+
+/* WorkerRun
+ *  inflate the next loaded slot on the pool; one at a time, so that a
+ *  file doesn't keep a pool thread from the other work submitted to it;
+ *  the worker of a GPU takes all the loaded slots there are, up to
+ *  GPU_BATCH, as a batch
+ */
+void BGZFReader::WorkerRun(Worker &self) {
+    /* the pool thread stays there, for the next block */
+    if (node >= 0 && NUMA::Current() != node)
+        NUMA::Pin(node);
+    
+    BGZFLock lock(mutex);
+    
+    self.queued = false;
+    while (!shutdown && work < fill) {
+        if (self.batch) {
+            InflateBatch(self);
+            break;
+        }
+        
+        Slot &slot = *slots[work++ % slots.size()];
+        if (slot.state != Slot::loaded)
+            continue;
+        
+        self.running = true;
+        InflateSlot(slot, self.inflater);
+        self.running = false;
+        break;
+    }
+    if (!shutdown && work < fill)
+        Dispatch();
+    /* StopThreads waits for the workers to be idle */
+    pthread_cond_broadcast(&doneCond);
+}
+
+void *BGZFReader::ReaderMain(void *const arg) {
+    BGZFReader *const self = static_cast<BGZFReader *>(arg);
+    
+    if (self->node >= 0)
+        NUMA::Pin(self->node);
+    self->ReaderLoop();
+    return 0;
+}
+
+BGZFBlock const *BGZFReader::NextParallel(void) {
+    BGZFLock lock(mutex);
+    
+    for ( ; ; ) {
+        if (holding) {
+            Slot &prev = *slots[head % slots.size()];
+            
+            prev.state = Slot::empty;
+            prev.csize = 0;
+            ++head;
+            holding = false;
+            pthread_cond_signal(&readerCond);
+        }
+        for ( ; ; ) {
+            Slot &next = *slots[head % slots.size()];
+            
+            if (head != fill && next.state == Slot::done)
+                break;
+            if (head != fill && next.state == Slot::loaded) {
+                /* no worker has taken it yet; rather than wait for the pool */
+                if (work <= head)
+                    work = head + 1;
+                InflateSlot(next, inflater);
+                continue;
+            }
+            pthread_cond_wait(&doneCond, &mutex);
+        }
+        
+        Slot &slot = *slots[head % slots.size()];
+        
+        if (!slot.error.empty())
+            throw std::runtime_error(slot.error);
+        /* the blocks before the one at head have all been inflated */
+        if (streaming && map.data())
+            DropBehind(slot.eof ? map.size() : slot.block.fpos, slot.eof);
+        if (slot.eof)
+            return 0;
+        
+        holding = true;
+        if (slot.block.size > 0)
+            return &slot.block;
+    }
+}
+
+BGZFBlock const *BGZFReader::Next(void) {
+    return workers.empty() ? NextSerial() : NextParallel();
+}
+
+void BGZFReader::Seek(uint64_t const fpos) {
+    if (workers.empty()) {
+        SeekFile(fpos);
+        return;
+    }
+    BGZFLock lock(mutex);
+    
+    reading = false;
+    holding = false;
+    while (readerBusy || inflight > 0)
+        pthread_cond_wait(&doneCond, &mutex);
+    
+    for (unsigned i = 0; i < slots.size(); ++i) {
+        Slot &slot = *slots[i];
+        
+        slot.state = Slot::empty;
+        slot.csize = 0;
+        slot.eof = false;
+        slot.error.clear();
+    }
+    head = fill = work = 0;
+    
+    SeekFile(fpos);
+    reading = true;
+    pthread_cond_signal(&readerCond);
+}
+
+void BGZFReader::StartThreads(unsigned const count) {
+    BGZFBatchInflater *const batch = gpu ? BGZFBatchInflater::Open(verifyCRC) : 0;
+    
+    /* enough slots loaded ahead for the GPU to take whole batches */
+    for (unsigned i = 0; i < 2 * count + 2 + (batch ? GPU_BATCH : 0); ++i) {
+        slots.push_back(new Slot());
+        if (node >= 0)
+            NUMA::Prefer(slots.back(), sizeof(Slot), node);
+        if (memory)
+            memory->Add(MemoryLedger::inflateQueue, sizeof(Slot));
+    }
+    
+    for (unsigned i = 0; i < count; ++i) {
+        Worker *const worker = new Worker(verifyCRC);
+        
+        worker->parent = this;
+        workers.push_back(worker);
+    }
+    workers[0]->batch = batch;
+    
+    try {
+        pool = &ngs::WorkPool::shared();
+    }
+    catch (ngs::ErrorMsg const &e) {
+        throw std::runtime_error(e.what());
+    }
+    
+    if (pthread_create(&reader, 0, ReaderMain, this) != 0)
+        throw std::runtime_error("failed to start reader thread");
+    readerStarted = true;
+}
+
+void BGZFReader::StopThreads(void) {
+    {
+        BGZFLock lock(mutex);
+        
+        shutdown = true;
+        pthread_cond_broadcast(&readerCond);
+        pthread_cond_broadcast(&doneCond);
+        
+        /* a worker that has started is waited for */
+        for (unsigned i = 0; i < workers.size(); ) {
+            Worker &worker = *workers[i];
+            
+            if (worker.queued && pool->cancel(worker))
+                worker.queued = false;
+            if (worker.queued || worker.running)
+                pthread_cond_wait(&doneCond, &mutex);
+            else
+                ++i;
+        }
+    }
+    if (readerStarted)
+        pthread_join(reader, 0);
+    readerStarted = false;
+    
+    for (unsigned i = 0; i < workers.size(); ++i)
+        delete workers[i];
+    workers.clear();
+    
+    for (unsigned i = 0; i < slots.size(); ++i)
+        delete slots[i];
+    if (memory)
+        memory->Remove(MemoryLedger::inflateQueue, slots.size() * sizeof(Slot));
+    slots.clear();
+}
+
+/* AllocIO
+ *  a read buffer of at least "size" bytes, which is updated; page
+ *  aligned, or with "huge" rounded to and aligned on huge pages and
+ *  advised to be backed by them
+ */
+static uint8_t *AllocIO(size_t &size, bool const huge)
+{
+    static size_t const hugePageSize = 2u * 1024u * 1024u;
+    size_t const align = huge ? hugePageSize : (size_t)sysconf(_SC_PAGESIZE);
+    void *p = 0;
+    
+    if (size < BAM_BLK_MAX)
+        size = BAM_BLK_MAX;
+    if (huge)
+        size = (size + align - 1) & ~(align - 1);
+    if (posix_memalign(&p, align, size) != 0)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (huge)
+        madvise(p, size, MADV_HUGEPAGE);
+#endif
+    return static_cast<uint8_t *>(p);
+}
+
+/* OpenSource
+ *  the bytes of a file, through the disk tier of its block cache if
+ *  it has one
+ */
+static ByteSource *OpenSource(std::string const &filepath, MemoryLedger *const memory, BGZFBlockCache const *const cache)
+{
+    ByteSource *const source = ByteSource::Open(filepath, memory);
+    
+    if (!cache || !cache->getDiskTier().cache)
+        return source;
+    
+    BGZFDiskTier const &disk = cache->getDiskTier();
+    
+    return new CachedSource(source, *disk.cache, disk.tag);
+}
+
+BGZFReader::BGZFReader(std::string const &filepath, unsigned const threads, bool const useMmap,
+                       size_t const Prefetch, BGZFBlockCache *const Cache,
+                       bool const VerifyCRC, BGZFStats *const Stats,
+                       size_t const IOSize, bool const hugePages, bool const Streaming,
+                       MemoryLedger *const Memory, unsigned const Follow,
+                       ngs::WorkPool::Priority const Priority, bool const numaLocal,
+                       bool const Adaptive, bool const GPU)
+: source(OpenSource(filepath, Memory, Cache))
+, prefetch(Streaming && Prefetch < STREAM_AHEAD ? STREAM_AHEAD : Prefetch)
+, advised(0)
+, streaming(Streaming)
+, dropped(0)
+, io(0)
+, cpos(0)
+, io_cur(0)
+, io_end(0)
+, io_eof(false)
+, readSize(BAM_BLK_MAX)
+, adaptive(Adaptive)
+, runStart(0)
+, ioSize(MemoryLedger::OverBudget(IOSize) ? BAM_BLK_MAX : IOSize)
+, iobuffer(0)
+, follow(Follow)
+, complete(false)
+, verifyCRC(VerifyCRC)
+, inflater(VerifyCRC)
+, cache(Cache)
+, stats(Stats)
+, memory(Memory)
+, pool(0)
+, priority(Priority)
+, node(numaLocal && NUMA::Nodes() > 1 ? NUMA::Current() : -1)
+, readerStarted(false)
+, head(0)
+, fill(0)
+, work(0)
+, inflight(0)
+, holding(false)
+, reading(true)
+, readerBusy(false)
+, shutdown(false)
+, gpu(GPU)
+{
+    if (useMmap && follow == 0 && source->Descriptor() >= 0 && map.Map(source->Descriptor())) {
+        io = map.data();
+        io_end = map.size();
+        io_eof = true;
+    }
+    else {
+        try {
+            io = iobuffer = AllocIO(ioSize, hugePages);
+        }
+        catch (...) {
+            delete source;
+            throw;
+        }
+        if (memory)
+            memory->Add(MemoryLedger::ioBuffers, ioSize);
+        if (node >= 0)
+            NUMA::Prefer(iobuffer, ioSize, node);
+    }
+    
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&readerCond, 0);
+    pthread_cond_init(&doneCond, 0);
+    
+    if (threads > 0) {
+        try {
+            StartThreads(threads);
+        }
+        catch (...) {
+            StopThreads();
+            pthread_cond_destroy(&doneCond);
+                        pthread_cond_destroy(&readerCond);
+            pthread_mutex_destroy(&mutex);
+            free(iobuffer);
+            if (memory && iobuffer)
+                memory->Remove(MemoryLedger::ioBuffers, ioSize);
+            delete source;
+            throw;
+        }
+    }
+}
+
+BGZFReader::~BGZFReader()
+{
+    StopThreads();
+    pthread_cond_destroy(&doneCond);
+        pthread_cond_destroy(&readerCond);
+    pthread_mutex_destroy(&mutex);
+    free(iobuffer);
+    if (memory && iobuffer)
+        memory->Remove(MemoryLedger::ioBuffers, ioSize);
+    delete source;
+}
+
+struct BGZFWriter::Slot : public EngineBlock
+{
+    enum { filling, queued, busy, done };
+
+    int state;
+    unsigned size;                  /* bytes in data */
+    unsigned csize;                 /* bytes in cdata, 0 if compression failed */
+    uint8_t data[BGZF_BLK_DATA];
+    uint8_t cdata[BAM_BLK_MAX];
+
+    Slot() : state(filling), size(0), csize(0) {}
+};
+
+struct BGZFWriter::Worker : public ngs::WorkItem
+{
+    BGZFWriter *parent;
+    BGZFDeflater deflater;
+    bool queued;                    /* submitted to the pool and not yet run */
+    bool running;
+
+    explicit Worker(int const level) : parent(0), deflater(level), queued(false), running(false) {}
+    void run() {
+        parent->WorkerRun(*this);
+    }
+};
+
+#if HAVE_LIBDEFLATE
+
+BGZFDeflater::BGZFDeflater(int const level)
+: compressor(libdeflate_alloc_compressor(level < 0 ? 6 : level))
+{
+    if (compressor == 0)
+        throw std::bad_alloc();
+}
+
+BGZFDeflater::~BGZFDeflater() {
+    libdeflate_free_compressor(compressor);
+}
+
+#else
+
+BGZFDeflater::BGZFDeflater(int const level)
+{
+    memset(&zs, 0, sizeof(zs));
+    
+    /* raw deflate; Deflate writes the gzip wrapper */
+    int const zrc = deflateInit2(&zs, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED,
+                                 -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    switch (zrc) {
+        case Z_OK:
+            break;
+        case Z_MEM_ERROR:
+            throw std::bad_alloc();
+            break;
+        case Z_VERSION_ERROR:
+            throw std::runtime_error(std::string("zlib version is not compatible; need version " ZLIB_VERSION " but have ") + zlibVersion());
+            break;
+        case Z_STREAM_ERROR:
+        default:
+            throw std::invalid_argument(zs.msg ? zs.msg : "invalid compression level");
+            break;
+    }
+}
+
+BGZFDeflater::~BGZFDeflater() {
+    deflateEnd(&zs);
+}
+
+#endif
+
+static void PutLE16(uint8_t *const p, unsigned const value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void PutLE32(uint8_t *const p, uint32_t const value) {
+    PutLE16(p, value & 0xFFFF);
+    PutLE16(p + 2, value >> 16);
+}
+
+/* Deflate
+ *  a gzip header with only the BC extra field, then the deflate data,
+ *  then the CRC32 and size of the data; BGZF_BLK_DATA bytes stored
+ *  without compression, as one final stored deflate block, still fit
+ */
+unsigned BGZFDeflater::Deflate(uint8_t const *const src, unsigned const size, uint8_t dst[])
+{
+    static uint8_t const header[] = {
+        31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 0, 0
+    };
+    static unsigned const header_size = sizeof(header);
+    static unsigned const trailer_size = 8;
+    static unsigned const room = BAM_BLK_MAX - header_size - trailer_size;
+    
+    if (size > BGZF_BLK_DATA)
+        return 0;
+    
+    uint8_t *const out = dst + header_size;
+    unsigned outlen = 0;
+    
+#if HAVE_LIBDEFLATE
+    outlen = (unsigned)libdeflate_deflate_compress(compressor, src, size, out, room);
+    uint32_t const crc = libdeflate_crc32(0, src, size);
+#else
+    zs.next_in   = const_cast<Bytef *>(src);
+    zs.avail_in  = size;
+    zs.next_out  = out;
+    zs.avail_out = room;
+    
+    int const zrc = deflate(&zs, Z_FINISH);
+    
+    if (zrc == Z_STREAM_END)
+        outlen = (unsigned)(room - zs.avail_out);
+    if (deflateReset(&zs) != Z_OK)
+        return 0;
+    if (zrc != Z_STREAM_END && zrc != Z_OK && zrc != Z_BUF_ERROR)
+        return 0;
+    uint32_t const crc = (uint32_t)crc32(0L, src, size);
+#endif
+    
+    if (outlen == 0) {
+        out[0] = 1;                 /* BFINAL, stored */
+        PutLE16(out + 1, size);
+        PutLE16(out + 3, ~size & 0xFFFF);
+        memcpy(out + 5, src, size);
+        outlen = 5 + size;
+    }
+    
+    unsigned const csize = header_size + outlen + trailer_size;
+    
+    memcpy(dst, header, header_size);
+    PutLE16(dst + 16, csize - 1);
+    PutLE32(dst + header_size + outlen, crc);
+    PutLE32(dst + header_size + outlen + 4, size);
+    return csize;
+}
+
+/* Dispatch
+ *  submit an idle worker for the queued slots, if there is one;
+ *  with the lock held
+ */
+void BGZFWriter::Dispatch(void) {
+    for (unsigned i = 0; i < workers.size(); ++i) {
+        Worker &worker = *workers[i];
+        
+        if (worker.queued || worker.running)
+            continue;
+        try {
+            pool->submit(worker);
+            worker.queued = true;
+        }
+        catch (...) {
+            /* Drain compresses what the pool doesn't */
+        }
+        return;
+    }
+}
+
+/* DeflateSlot
+ *  compress a queued slot without the lock, which is held on entry
+ */
+void BGZFWriter::DeflateSlot(Slot &slot, BGZFDeflater &deflater) {
+    slot.state = Slot::busy;
+    pthread_mutex_unlock(&mutex);
+    slot.csize = deflater.Deflate(slot.data, slot.size, slot.cdata);
+    pthread_mutex_lock(&mutex);
+    slot.state = Slot::done;
+    pthread_cond_broadcast(&doneCond);
+}
+
+void BGZFWriter::WorkerRun(Worker &self) {
+    BGZFLock lock(mutex);
+    
+    self.queued = false;
+    while (!shutdown && work < fill) {
+        Slot &slot = *slots[work++ % slots.size()];
+        if (slot.state != Slot::queued)
+            continue;
+        
+        self.running = true;
+        DeflateSlot(slot, self.deflater);
+        self.running = false;
+        break;
+    }
+    if (!shutdown && work < fill)
+        Dispatch();
+    pthread_cond_broadcast(&doneCond);
+}
+
+void BGZFWriter::Output(Slot const &slot) {
+    if (slot.csize == 0)
+        throw std::runtime_error("failed to compress a block of '" + path + "'");
+    if (fwrite(slot.cdata, 1, slot.csize, fp) != slot.csize)
+        throw std::runtime_error("failed to write '" + path + "'");
+    blockPos.push_back(fpos);
+    fpos += slot.csize;
+}
+
+/* Drain
+ *  write finished blocks in order until at most "keep" are queued
+ */
+void BGZFWriter::Drain(uint64_t const keep) {
+    BGZFLock lock(mutex);
+    
+    while (fill - head > keep) {
+        Slot &slot = *slots[head % slots.size()];
+        
+        while (slot.state != Slot::done) {
+            if (slot.state == Slot::queued) {
+                /* no worker has taken it yet; rather than wait for the pool */
+                if (work <= head)
+                    work = head + 1;
+                DeflateSlot(slot, deflater);
+            }
+            else
+                pthread_cond_wait(&doneCond, &mutex);
+        }
+        
+        pthread_mutex_unlock(&mutex);
+        try {
+            Output(slot);
+        }
+        catch (...) {
+            pthread_mutex_lock(&mutex);
+            throw;
+        }
+        pthread_mutex_lock(&mutex);
+        slot.state = Slot::filling;
+        ++head;
+    }
+}
+
+void BGZFWriter::Submit(void) {
+    Slot &slot = Current();
+    
+    slot.size = used;
+    used = 0;
+    ++blocks;
+    if (workers.empty()) {
+        slot.csize = deflater.Deflate(slot.data, slot.size, slot.cdata);
+        Output(slot);
+        return;
+    }
+    {
+        BGZFLock lock(mutex);
+        
+        slot.state = Slot::queued;
+        ++fill;
+        Dispatch();
+    }
+    /* the next slot must be free to fill */
+    Drain(slots.size() - 1);
+}
+
+void BGZFWriter::Write(void const *const data, size_t size) {
+    uint8_t const *src = static_cast<uint8_t const *>(data);
+    
+    if (fp == 0)
+        throw std::runtime_error("'" + path + "' is closed");
+    while (size > 0) {
+        Slot &slot = Current();
+        size_t const n = size < BGZF_BLK_DATA - used ? size : BGZF_BLK_DATA - used;
+        
+        memcpy(slot.data + used, src, n);
+        used += (unsigned)n;
+        src += n;
+        size -= n;
+        if (used == BGZF_BLK_DATA)
+            Submit();
+    }
+}
+
+void BGZFWriter::Flush(void) {
+    if (used > 0)
+        Submit();
+}
+
+void BGZFWriter::Close(void) {
+    if (fp == 0)
+        return;
+    Flush();
+    if (!workers.empty())
+        Drain(0);
+    
+    blockPos.push_back(fpos);
+    if (fwrite(eofMarker, 1, sizeof(eofMarker), fp) != sizeof(eofMarker))
+        throw std::runtime_error("failed to write '" + path + "'");
+    fpos += sizeof(eofMarker);
+    
+    FILE *const closing = fp;
+    
+    fp = 0;
+    StopThreads();
+    if (fclose(closing) != 0)
+        throw std::runtime_error("failed to write '" + path + "'");
+}
+
+void BGZFWriter::StartThreads(unsigned const count) {
+    for (unsigned i = 0; i < count; ++i) {
+        Worker *const worker = new Worker(level);
+        
+        worker->parent = this;
+        workers.push_back(worker);
+    }
+    
+    try {
+        pool = &ngs::WorkPool::shared();
+    }
+    catch (ngs::ErrorMsg const &e) {
+        throw std::runtime_error(e.what());
+    }
+}
+
+void BGZFWriter::StopThreads(void) {
+    {
+        BGZFLock lock(mutex);
+        
+        shutdown = true;
+        for (unsigned i = 0; i < workers.size(); ) {
+            Worker &worker = *workers[i];
+            
+            if (worker.queued && pool->cancel(worker))
+                worker.queued = false;
+            if (worker.queued || worker.running)
+                pthread_cond_wait(&doneCond, &mutex);
+            else
+                ++i;
+        }
+    }
+    
+    for (unsigned i = 0; i < workers.size(); ++i)
+        delete workers[i];
+    workers.clear();
+}
+
+BGZFWriter::BGZFWriter(std::string const &filepath, unsigned const count, int const Level)
+: path(filepath)
+, fp(fopen(filepath.c_str(), "wb"))
+, fpos(0)
+, blocks(0)
+, used(0)
+, deflater(Level)
+, level(Level)
+, pool(0)
+, head(0)
+, fill(0)
+, work(0)
+, shutdown(false)
+{
+    if (fp == 0)
+        throw std::runtime_error("'" + path + "' could not be created");
+    
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&doneCond, 0);
+    
+    try {
+        for (unsigned i = 0; i < (count > 0 ? 2 * count + 2 : 1); ++i)
+            slots.push_back(new Slot());
+        if (count > 0)
+            StartThreads(count);
+    }
+    catch (...) {
+        StopThreads();
+        for (unsigned i = 0; i < slots.size(); ++i)
+            delete slots[i];
+        pthread_cond_destroy(&doneCond);
+                pthread_mutex_destroy(&mutex);
+        fclose(fp);
+        throw;
+    }
+}
+
+BGZFWriter::~BGZFWriter()
+{
+    StopThreads();
+    for (unsigned i = 0; i < slots.size(); ++i)
+        delete slots[i];
+    pthread_cond_destroy(&doneCond);
+        pthread_mutex_destroy(&mutex);
+    if (fp)
+        fclose(fp);
+}
@@ -0,0 +1,666 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_bgzf_
+#define _hpp_bgzf_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+#if HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#else
+#if HAVE_ISAL
+#include <isa-l/igzip_lib.h>
+#endif
+#include <zlib.h>
+#endif
+#if HAVE_NVCOMP
+#include <cuda_runtime.h>
+#include <nvcomp/deflate.h>
+#endif
+#include <cstdio>
+
+#include <ngs/WorkPool.hpp>
+
+#include "source.hpp"
+#include "memory.hpp"
+#include "latency.hpp"
+#include "diskcache.hpp"
+
+#define BAM_BLK_MAX (64u * 1024u)
+#define IO_BLK_SIZE (1024u * 1024u)
+#define STREAM_AHEAD (8u * IO_BLK_SIZE)    /* read-ahead and drop-behind step when streaming */
+#define BGZF_BLK_DATA 0xff00u       /* the most a written block holds, so that it always fits */
+#define FOLLOW_POLL_MS 100u         /* how often a followed file is read again at its end */
+#define ADAPTIVE_AHEAD (32u * IO_BLK_SIZE)  /* the most adaptive read-ahead asks for */
+#define BLOCK_CACHE_SHARDS 16u      /* the most the block cache is split into, at 4 blocks or more each */
+#define GPU_BATCH 64u               /* the most blocks inflated on a GPU at once */
+
+/* BGZFBlock
+ *  the inflated contents of one BGZF block
+ */
+struct BGZFBlock
+{
+    uint64_t fpos;                  /* file position of the compressed block */
+    unsigned size;                  /* number of valid bytes in data */
+    uint8_t data[BAM_BLK_MAX];
+};
+
+/* BGZFInflater
+ *  inflates whole BGZF blocks with the backend chosen at build time:
+ *  libdeflate with HAVE_LIBDEFLATE, ISA-L with HAVE_ISAL, else zlib
+ *
+ *  a block's deflate data is followed by the CRC32 and size of the
+ *  inflated data; the size is always checked, the CRC with verifyCRC
+ */
+class BGZFInflater
+{
+#if HAVE_LIBDEFLATE
+    struct libdeflate_decompressor *decompressor;
+#elif HAVE_ISAL
+    struct inflate_state *state;
+#else
+    z_stream zs;
+#endif
+    bool const verifyCRC;
+
+    BGZFInflater(BGZFInflater const &);
+    BGZFInflater &operator =(BGZFInflater const &);
+public:
+    explicit BGZFInflater(bool const verifyCRC = true);
+    ~BGZFInflater();
+
+    /* Inflate
+     *  inflates the complete block of csize bytes at src into dst
+     *  returns NULL on success or an error message
+     */
+    char const *Inflate(uint8_t const *src, unsigned const csize, BGZFBlock &dst);
+
+    /* Backend
+     *  the name of the backend, e.g. for diagnostics
+     */
+    static char const *Backend(void);
+};
+
+/* BGZFBatchInflater
+ *  inflates whole BGZF blocks GPU_BATCH at a time on a GPU, with nvCOMP's
+ *  batched deflate when built with HAVE_NVCOMP; Open returns NULL
+ *  without it, or if there is no device to use, and blocks are inflated
+ *  by a BGZFInflater each instead
+ *
+ *  the sizes and CRCs are checked as BGZFInflater checks them, the CRC
+ *  on the CPU; a batch the device fails on is inflated on the CPU
+ */
+class BGZFBatchInflater
+{
+    struct Device;
+    Device *const device;
+    BGZFInflater fallback;
+    bool const verifyCRC;
+
+    BGZFBatchInflater(Device *const device, bool const verifyCRC);
+    BGZFBatchInflater(BGZFBatchInflater const &);
+    BGZFBatchInflater &operator =(BGZFBatchInflater const &);
+public:
+    static BGZFBatchInflater *Open(bool const verifyCRC);
+    ~BGZFBatchInflater();
+
+    /* Inflate
+     *  the "count" blocks of csize[i] bytes at src[i] into *dst[i],
+     *  setting error[i] to NULL on success or an error message
+     */
+    void Inflate(unsigned const count, uint8_t const *const src[], unsigned const csize[],
+                 BGZFBlock *const dst[], char const *error[]);
+
+    /* Backend
+     *  the name of the backend, NULL without one
+     */
+    static char const *Backend(void);
+};
+
+/* MappedFile
+ *  a read-only memory mapping of a whole file
+ */
+class MappedFile
+{
+    void *base;
+    size_t length;
+
+    MappedFile(MappedFile const &);
+    MappedFile &operator =(MappedFile const &);
+public:
+    MappedFile() : base(0), length(0) {}
+    ~MappedFile() {
+        Unmap();
+    }
+
+    /* Map
+     *  returns false if the file can't be mapped, e.g. it is empty or a pipe
+     */
+    bool Map(std::string const &filepath);
+    bool Map(int const fd);
+    void Unmap(void);
+
+    uint8_t const *data() const {
+        return static_cast<uint8_t const *>(base);
+    }
+    size_t size() const {
+        return length;
+    }
+};
+
+/* BGZFDiskTier
+ *  where the blocks of a remote file go besides the block cache, see
+ *  NGS_BAM::OpenOptions::diskCache: its readers' bytes are kept in
+ *  "cache" as they are fetched, and with "inflated", the block cache
+ *  puts its blocks there as well and looks for those it hasn't there
+ */
+struct BGZFDiskTier
+{
+    DiskCache *cache;               /* NULL for none */
+    std::string tag;                /* the version of the file */
+    bool inflated;
+
+    BGZFDiskTier() : cache(0), inflated(false) {}
+};
+
+/* BGZFBlockCache
+ *  the most recently inflated blocks, keyed by file position,
+ *  so that a seek to one of them doesn't read or inflate it again
+ *  shared by the readers of one file, from any thread: the blocks are
+ *  spread over shards by a hash of their position, each with its own
+ *  lock, which lookups share; a block found is pinned while it is copied
+ *  out, and is not reused until it is unpinned
+ *  a reader that misses claims the block, and others that miss on it
+ *  wait for it to be put rather than inflate it again
+ *  the blocks are counted in "memory", if there is one; over the
+ *  memory budget it doesn't grow, and gives a block back with every
+ *  one put until each shard has one left
+ */
+class BGZFBlockCache
+{
+    struct Entry : public EngineBlock {
+        BGZFBlock block;
+        unsigned csize;             /* size of the compressed block */
+        uint64_t used;              /* when last put or found */
+        unsigned pins;              /* copies out in progress */
+    };
+    struct Shard {
+        std::vector<Entry *> entries;
+        std::map<uint64_t, Entry *> byPos;
+        pthread_rwlock_t lock;      /* the entries and byPos */
+        pthread_mutex_t mutex;      /* loading */
+        pthread_cond_t loaded;
+        std::set<uint64_t> loading; /* the blocks claimed */
+        uint64_t clock;
+    };
+    std::vector<Shard *> shards;
+    unsigned const capacity;        /* of each shard */
+    MemoryLedger *const memory;
+    BGZFDiskTier const disk;
+
+    Shard &ShardOf(uint64_t const fpos) const {
+        return *shards[(unsigned)((fpos * 0x9E3779B97F4A7C15ull) >> 32) % shards.size()];
+    }
+    static unsigned Oldest(Shard const &shard);     /* index of the least recently used entry, unpinned */
+    bool Find(Shard &shard, uint64_t const fpos, BGZFBlock &dst, unsigned &csize) const;
+    void Keep(Shard &shard, BGZFBlock const &block, unsigned const csize);
+    void EndClaim(Shard &shard, uint64_t const fpos);
+    bool GetDisk(uint64_t const fpos, BGZFBlock &dst, unsigned &csize);
+
+    BGZFBlockCache(BGZFBlockCache const &);
+    BGZFBlockCache &operator =(BGZFBlockCache const &);
+public:
+    explicit BGZFBlockCache(unsigned const capacity, MemoryLedger *const memory = 0,
+                            BGZFDiskTier const &disk = BGZFDiskTier());
+    ~BGZFBlockCache();
+
+    /* Get
+     *  copy the block at fpos into dst if it is cached, waiting for it
+     *  if it is claimed; with "claim", a miss claims it for the caller,
+     *  who must then Put it or Abandon it
+     */
+    bool Get(uint64_t const fpos, BGZFBlock &dst, unsigned &csize, bool const claim = false);
+
+    /* Put
+     *  remember a block, replacing the least recently used one of its
+     *  shard, and end a claim on it
+     */
+    void Put(BGZFBlock const &block, unsigned const csize);
+
+    /* Abandon
+     *  end a claim without a block, e.g. when it didn't inflate
+     */
+    void Abandon(uint64_t const fpos);
+
+    BGZFDiskTier const &getDiskTier() const {
+        return disk;
+    }
+};
+
+/* BGZFStats
+ *  I/O counters of the readers of one file
+ *  updated by reader and worker threads at once, so they are only
+ *  changed with Add and read with Get
+ */
+struct BGZFStats
+{
+    uint64_t bytesRead;             /* bytes read from the file */
+    uint64_t compressedBytes;       /* size of the blocks loaded */
+    uint64_t inflatedBytes;         /* bytes produced by the inflater */
+    uint64_t blocksInflated;
+    uint64_t blocksSkipped;         /* passed over by slices, see OpenOptions::zoneMap */
+    uint64_t cacheHits;             /* blocks copied from the cache instead */
+    uint64_t seeks;                 /* reads from a new position; a mapped file needs none */
+    uint64_t requests;              /* requests to a remote file */
+    uint64_t readNanos;             /* time spent reading */
+    uint64_t inflateNanos;          /* time spent inflating */
+    LatencyHistogram inflateLatency;    /* of each block inflated */
+
+    /* how the file is read, which adaptive readers size their reads from;
+     * the averages are over the recent seeks, each one an eighth */
+    uint64_t runAverage;            /* bytes read from one seek to the next */
+    uint64_t seekAverage;           /* distance of a seek from where reading was */
+    uint64_t firstRead;             /* bytes last asked for after a seek */
+    uint64_t readAhead;             /* bytes last asked to be read ahead */
+
+    BGZFStats()
+    : bytesRead(0), compressedBytes(0), inflatedBytes(0), blocksInflated(0), blocksSkipped(0)
+    , cacheHits(0), seeks(0), requests(0), readNanos(0), inflateNanos(0)
+    , runAverage(0), seekAverage(0), firstRead(0), readAhead(0)
+    {}
+
+    static void Add(uint64_t &counter, uint64_t const value) {
+        __atomic_fetch_add(&counter, value, __ATOMIC_RELAXED);
+    }
+    static void Set(uint64_t &counter, uint64_t const value) {
+        __atomic_store_n(&counter, value, __ATOMIC_RELAXED);
+    }
+    /* Average
+     *  an eighth of "value" into "average"; racing readers may lose one
+     */
+    static void Average(uint64_t &average, uint64_t const value) {
+        uint64_t const was = Get(average);
+        Set(average, was == 0 ? value : was - was / 8 + value / 8);
+    }
+    static uint64_t Get(uint64_t const &counter) {
+        return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+    }
+    /* Now
+     *  a monotonic clock in nanoseconds, for the time counters
+     */
+    static uint64_t Now(void);
+};
+
+/* BlockReader
+ *  where a BAMFileCursor gets its blocks of records: a BGZFReader for
+ *  a BAM file, a SAMReader for SAM text, see sam.hpp
+ *  a block's fpos is what a virtual file position has in its upper bits
+ */
+class BlockReader
+{
+public:
+    virtual ~BlockReader() {}
+
+    /* Seek
+     *  position the reader at the start of the block at fpos
+     */
+    virtual void Seek(uint64_t const fpos) = 0;
+
+    /* Next
+     *  returns the next non-empty block or NULL at end of file
+     *  the block returned by the previous call is no longer valid
+     */
+    virtual BGZFBlock const *Next(void) = 0;
+
+    /* Prefetch, Plan
+     *  hints of what is going to be read, as BGZFReader has them
+     */
+    virtual void Prefetch(uint64_t const fpos, uint64_t const length) {}
+    virtual void Plan(uint64_t const fpos, uint64_t const length) {}
+
+    /* isComplete
+     *  the whole file has been read
+     */
+    virtual bool isComplete() const = 0;
+};
+
+/* BGZFReader
+ *  splits a BGZF file into its blocks using the BSIZE extra field
+ *  and returns the inflated blocks in file order
+ *
+ *  with threads == 0, blocks are inflated on the calling thread;
+ *  otherwise a reader thread splits the input into blocks, up to
+ *  "threads" workers on the process' ngs::WorkPool inflate them in
+ *  parallel, submitted with "priority", and Next() takes them from an
+ *  ordered queue of finished blocks; a block the pool hasn't got to
+ *  by the time Next wants it is inflated by Next
+ *
+ *  the file is read through a ByteSource, so it may be a URL
+ *
+ *  with useMmap, a local file is mapped and blocks are inflated straight
+ *  from the mapping; files that can't be mapped are read with pread
+ *
+ *  with prefetch, the system is asked to start reading the next
+ *  "prefetch" bytes ahead of the reader, so that I/O on slow file
+ *  systems overlaps with inflating
+ *
+ *  with adaptive, the reader records in stats how long its runs between
+ *  seeks are and how far it seeks, and sizes its reads from that: the
+ *  first read after a seek is as long as a run usually is, up to ioSize,
+ *  and once a run, or the usual one, is longer than ioSize, the system
+ *  is asked to read as far ahead as it is long, up to ADAPTIVE_AHEAD; so
+ *  random access to small regions reads little and long scans a lot;
+ *  prefetch is then the least asked for
+ *
+ *  with streaming, what has been read is dropped from the page cache
+ *  behind the reader, so that a scan of a large file doesn't evict
+ *  the pages of other files; prefetch is then at least STREAM_AHEAD
+ *
+ *  with a cache, every block returned is put in it and a block
+ *  found there is copied instead of inflated again
+ *
+ *  with verifyCRC, the CRC32 of every inflated block is checked
+ *
+ *  with stats, the reader's I/O is counted in them
+ *
+ *  input is read into a buffer of ioSize bytes, at least BAM_BLK_MAX,
+ *  allocated page aligned unless the file is mapped; with hugePages on
+ *  huge pages where the system has them; over the memory budget, it
+ *  is only BAM_BLK_MAX
+ *
+ *  with memory, the buffer and the slots of the pipeline are counted
+ *  in it, and so are the windows of a remote file
+ *
+ *  with follow, a file that is still being written is read again every
+ *  FOLLOW_POLL_MS at its end, or at a block that isn't all there yet,
+ *  until it has grown or "follow" seconds have gone by without it
+ *  growing; it is complete, and no longer waited for, once its BGZF EOF
+ *  marker has been read; a followed file isn't mapped
+ *
+ *  with numaLocal, on a machine with several NUMA nodes, the buffers are
+ *  put on the node of the thread that makes the reader, which is taken to
+ *  be the one that reads its blocks, and the reader thread and the pool
+ *  threads that inflate them are moved to that node's CPUs
+ *
+ *  with gpu and threads, one of the workers inflates the loaded blocks
+ *  in batches on a GPU, see BGZFBatchInflater, while the others go on
+ *  inflating one block at a time; without a GPU, it is like the others
+ */
+class BGZFReader : public BlockReader
+{
+    struct Slot;
+    struct Worker;
+
+    ByteSource *const source;
+    MappedFile map;
+    size_t const prefetch;          /* bytes to request ahead, 0 for none */
+    uint64_t advised;               /* end of the range requested so far */
+    bool const streaming;
+    uint64_t dropped;               /* end of the range dropped behind the reader */
+    uint8_t const *io;              /* iobuffer or the mapped file */
+    uint64_t cpos;                  /* file position of io */
+    size_t io_cur;                  /* current offset in io */
+    size_t io_end;                  /* end of valid data in io */
+    bool io_eof;
+    size_t readSize;                /* the most the next read asks for; small at first and after a seek */
+    bool const adaptive;
+    uint64_t runStart;              /* where reading last started after a seek */
+    size_t ioSize;                  /* of iobuffer */
+    uint8_t *iobuffer;              /* NULL when the file is mapped */
+
+    unsigned const follow;          /* seconds to wait for a file to grow, 0 not to */
+    bool complete;                  /* the EOF marker was read, only changed atomically */
+
+    bool const verifyCRC;
+    BGZFInflater inflater;          /* used when there are no workers */
+    BGZFBlock block;
+    BGZFBlockCache *const cache;
+    BGZFStats *const stats;
+    MemoryLedger *const memory;
+
+    /* decompression pipeline, all guarded by mutex */
+    std::vector<Slot *> slots;
+    std::vector<Worker *> workers;  /* none without threads */
+    ngs::WorkPool *pool;
+    ngs::WorkPool::Priority const priority;
+    int const node;                 /* the NUMA node to keep to, -1 for any */
+    pthread_t reader;
+    bool readerStarted;
+    uint64_t head;                  /* next slot for Next */
+    uint64_t fill;                  /* next slot for the reader */
+    uint64_t work;                  /* next slot for a worker */
+    unsigned inflight;              /* number of slots being inflated */
+    bool holding;                   /* Next has returned slot[head] */
+    bool reading;                   /* reader thread should load blocks */
+    bool readerBusy;                /* reader is loading a slot */
+    bool shutdown;
+    bool const gpu;                 /* a worker inflates batches on a GPU, if there is one */
+    pthread_mutex_t mutex;
+    pthread_cond_t readerCond;
+    pthread_cond_t doneCond;
+
+    size_t Fill(size_t const want);
+    void Observe(uint64_t const fpos);
+    size_t FirstRead(void) const;
+    uint64_t Ahead(uint64_t const fpos) const;
+    size_t FillFollowing(size_t const want);
+    bool Await(void);
+    void ReadAhead(uint64_t const fpos);
+    void WillNeed(uint64_t const fpos, uint64_t const length);
+    void DropBehind(uint64_t const fpos, bool const atEnd = false);
+    unsigned LoadBlock(void);
+    void SeekFile(uint64_t const fpos);
+    void StartThreads(unsigned const count);
+    void StopThreads(void);
+    void ReaderLoop(void);
+    void Dispatch(void);
+    void InflateSlot(Slot &slot, BGZFInflater &inflater);
+    void InflateBatch(Worker &self);
+    void InflateSlots(BGZFBatchInflater &batch, Slot *const batchSlots[], unsigned const count);
+    void WorkerRun(Worker &self);
+    bool TakeCached(void);
+    BGZFBlock const *NextSerial(void);
+    BGZFBlock const *NextParallel(void);
+    char const *Inflate(BGZFInflater &inflater, uint8_t const *src, unsigned const csize, BGZFBlock &dst);
+    char const *InflateTimed(BGZFInflater &inflater, uint8_t const *src, unsigned const csize, BGZFBlock &dst);
+
+    static void *ReaderMain(void *arg);
+
+    BGZFReader(BGZFReader const &);
+    BGZFReader &operator =(BGZFReader const &);
+public:
+    BGZFReader(std::string const &filepath, unsigned const threads, bool const useMmap = false,
+               size_t const prefetch = 0, BGZFBlockCache *const cache = 0,
+               bool const verifyCRC = true, BGZFStats *const stats = 0,
+               size_t const ioSize = 2 * IO_BLK_SIZE, bool const hugePages = false,
+               bool const streaming = false, MemoryLedger *const memory = 0,
+               unsigned const follow = 0,
+               ngs::WorkPool::Priority const priority = ngs::WorkPool::normal,
+               bool const numaLocal = false, bool const adaptive = false,
+               bool const gpu = false);
+    ~BGZFReader();
+
+    /* Seek
+     *  position the reader at the start of the block at fpos
+     */
+    void Seek(uint64_t const fpos);
+
+    /* Next
+     *  returns the next non-empty block or NULL at end of file
+     *  the block returned by the previous call is no longer valid
+     */
+    BGZFBlock const *Next(void);
+
+    /* Prefetch
+     *  ask for [fpos, fpos + length) to be read in the background,
+     *  e.g. the next chunk of a slice; does nothing without prefetch
+     */
+    void Prefetch(uint64_t const fpos, uint64_t const length);
+
+    /* Plan
+     *  tell a remote file that [fpos, fpos + length) is going to be read,
+     *  e.g. every chunk of a slice, so that it can fetch them together;
+     *  does nothing for a local file
+     */
+    void Plan(uint64_t const fpos, uint64_t const length);
+
+    /* Advise
+     *  as Prefetch, with or without prefetch, e.g. for a hint that a
+     *  region is going to be queried
+     */
+    void Advise(uint64_t const fpos, uint64_t const length);
+
+    /* isComplete
+     *  the file's BGZF EOF marker has been read; with threads, it may
+     *  have been read ahead of the blocks that Next has returned
+     */
+    bool isComplete() const {
+        return __atomic_load_n(&complete, __ATOMIC_RELAXED);
+    }
+};
+
+/* BGZFDeflater
+ *  compresses whole BGZF blocks with libdeflate with HAVE_LIBDEFLATE,
+ *  else zlib; data that doesn't compress is stored instead
+ */
+class BGZFDeflater
+{
+#if HAVE_LIBDEFLATE
+    struct libdeflate_compressor *compressor;
+#else
+    z_stream zs;
+#endif
+
+    BGZFDeflater(BGZFDeflater const &);
+    BGZFDeflater &operator =(BGZFDeflater const &);
+public:
+    /* level is 0 to 9, or -1 for the backend's default */
+    explicit BGZFDeflater(int const level);
+    ~BGZFDeflater();
+
+    /* Deflate
+     *  compresses the "size" bytes at src, at most BGZF_BLK_DATA, into
+     *  a complete block at dst, which has room for BAM_BLK_MAX bytes
+     *  returns the size of the block or 0 if compression failed
+     */
+    unsigned Deflate(uint8_t const *src, unsigned const size, uint8_t dst[]);
+};
+
+/* BGZFWriter
+ *  cuts what is written into blocks of at most BGZF_BLK_DATA bytes and
+ *  writes them to a file compressed, ending it with the EOF marker block
+ *
+ *  with threads == 0, blocks are compressed on the calling thread;
+ *  otherwise up to "threads" workers on the process' ngs::WorkPool
+ *  compress them in parallel and the calling thread writes the
+ *  finished ones in order, compressing itself a block the pool
+ *  hasn't got to when it is the next to write
+ *
+ *  Tell returns a virtual offset whose upper bits are the number of the
+ *  block rather than its file position, which isn't known until the
+ *  blocks before it are compressed; FileOffset translates it once the
+ *  block is written
+ */
+class BGZFWriter
+{
+    struct Slot;
+    struct Worker;
+
+    std::string const path;
+    FILE *fp;
+    uint64_t fpos;                  /* bytes written so far */
+    std::vector<uint64_t> blockPos; /* file position of each block written */
+    uint64_t blocks;                /* number of blocks finished */
+    unsigned used;                  /* bytes in the current block */
+    BGZFDeflater deflater;          /* used when there are no workers */
+    int const level;
+
+    /* compression pipeline, all guarded by mutex */
+    std::vector<Slot *> slots;
+    std::vector<Worker *> workers;  /* none without threads */
+    ngs::WorkPool *pool;
+    uint64_t head;                  /* next slot to write */
+    uint64_t fill;                  /* the slot being filled */
+    uint64_t work;                  /* next slot for a worker */
+    bool shutdown;
+    pthread_mutex_t mutex;
+    pthread_cond_t doneCond;
+
+    Slot &Current(void) {
+        return *slots[fill % slots.size()];
+    }
+    void Submit(void);
+    void Drain(uint64_t const keep);
+    void Output(Slot const &slot);
+    void StartThreads(unsigned const count);
+    void StopThreads(void);
+    void Dispatch(void);
+    void DeflateSlot(Slot &slot, BGZFDeflater &deflater);
+    void WorkerRun(Worker &self);
+
+    BGZFWriter(BGZFWriter const &);
+    BGZFWriter &operator =(BGZFWriter const &);
+public:
+    BGZFWriter(std::string const &filepath, unsigned const threads, int const level = -1);
+
+    /* the file is left incomplete if it wasn't closed */
+    ~BGZFWriter();
+
+    void Write(void const *data, size_t size);
+
+    /* Flush
+     *  ends the current block, so that what is written next starts a new one
+     */
+    void Flush(void);
+
+    /* Tell
+     *  the virtual offset of the next byte written, by block number
+     */
+    uint64_t Tell() const {
+        return (blocks << 16) | used;
+    }
+
+    /* FileOffset
+     *  translates an offset from Tell into the file's virtual offset
+     *  the block must have been written; after Close they all have been
+     */
+    uint64_t FileOffset(uint64_t const offset) const {
+        return (blockPos[offset >> 16] << 16) | (offset & 0xFFFF);
+    }
+
+    /* Close
+     *  writes the last block and the EOF marker and closes the file
+     */
+    void Close(void);
+};
+
+#endif // _hpp_bgzf_
@@ -0,0 +1,151 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "columns.hpp"
+
+#include <zlib.h>
+#include <string.h>
+#include <cstdio>
+#include <stdexcept>
+
+static char const columnMagic[8] = { 'N', 'G', 'S', 'C', 'O', 'L', 'S', '1' };
+
+struct ColumnTrailer
+{
+    char magic[8];
+    uint64_t directory;             /* offset of the chunks' */
+    uint64_t chunks;
+};
+
+ColumnWriter::ColumnWriter(std::string const &Path, int const Level)
+: file(0)
+, path(Path)
+, temp(Path + ".tmp")
+, offset(0)
+, level(Level)
+{
+    file = fopen(temp.c_str(), "wb");
+    if (file == 0)
+        throw std::runtime_error("can't create '" + temp + "'");
+}
+
+ColumnWriter::~ColumnWriter()
+{
+    if (file) {
+        fclose(file);
+        remove(temp.c_str());
+    }
+}
+
+void ColumnWriter::Write(void const *const data, size_t const size)
+{
+    ColumnChunk chunk = { offset, size, size };
+    void const *stored = data;
+    uLongf bound = compressBound((uLong)size);
+
+    if (size > 0 && level != 0) {
+        deflated.resize(bound);
+        if (compress2(&deflated[0], &bound, static_cast<Bytef const *>(data), (uLong)size, level) == Z_OK && bound < size) {
+            chunk.stored = bound;
+            stored = &deflated[0];
+        }
+    }
+    if (chunk.stored > 0 && fwrite(stored, 1, (size_t)chunk.stored, file) != chunk.stored)
+        throw std::runtime_error("can't write '" + temp + "'");
+    offset += chunk.stored;
+    chunks.push_back(chunk);
+}
+
+void ColumnWriter::Commit()
+{
+    ColumnTrailer trailer;
+    static char const pad[8] = { 0 };
+
+    memcpy(trailer.magic, columnMagic, 8);
+    trailer.directory = (offset + 7) & ~(uint64_t)7;     /* for the directory to be mapped */
+    trailer.chunks = chunks.size();
+    if (fwrite(pad, 1, (size_t)(trailer.directory - offset), file) != trailer.directory - offset ||
+        (!chunks.empty() && fwrite(&chunks[0], sizeof(ColumnChunk), chunks.size(), file) != chunks.size()) ||
+        fwrite(&trailer, sizeof(trailer), 1, file) != 1)
+    {
+        throw std::runtime_error("can't write '" + temp + "'");
+    }
+
+    int const rc = fclose(file);
+
+    file = 0;
+    if (rc != 0 || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        throw std::runtime_error("can't write '" + path + "'");
+    }
+}
+
+void ColumnFile::Open(std::string const &path)
+{
+    if (!mapped.Map(path))
+        throw std::runtime_error("can't map '" + path + "'");
+
+    size_t const size = mapped.size();
+    ColumnTrailer trailer;
+
+    if (size >= sizeof(trailer))
+        memcpy(&trailer, mapped.data() + size - sizeof(trailer), sizeof(trailer));
+    if (size < sizeof(trailer) || memcmp(trailer.magic, columnMagic, 8) != 0 ||
+        trailer.directory % 8 != 0 || trailer.directory > size - sizeof(trailer) ||
+        trailer.chunks != (size - sizeof(trailer) - trailer.directory) / sizeof(ColumnChunk))
+    {
+        mapped.Unmap();
+        throw std::runtime_error("'" + path + "' is not a column file");
+    }
+    chunks = reinterpret_cast<ColumnChunk const *>(mapped.data() + trailer.directory);
+    count = (size_t)trailer.chunks;
+    for (size_t i = 0; i < count; ++i) {
+        if (chunks[i].stored > chunks[i].size || chunks[i].offset > trailer.directory ||
+            chunks[i].stored > trailer.directory - chunks[i].offset)
+        {
+            mapped.Unmap();
+            chunks = 0;
+            count = 0;
+            throw std::runtime_error("'" + path + "' is damaged");
+        }
+    }
+}
+
+void ColumnFile::Read(size_t const i, void *const dst) const
+{
+    ColumnChunk const &chunk = chunks[i];
+    uint8_t const *const src = mapped.data() + chunk.offset;
+
+    if (chunk.stored == chunk.size) {
+        if (chunk.size > 0)
+            memcpy(dst, src, (size_t)chunk.size);
+        return;
+    }
+
+    uLongf size = (uLongf)chunk.size;
+
+    if (uncompress(static_cast<Bytef *>(dst), &size, src, (uLong)chunk.stored) != Z_OK || size != chunk.size)
+        throw std::runtime_error("a column chunk is damaged");
+}
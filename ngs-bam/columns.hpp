@@ -0,0 +1,139 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_columns_
+#define _hpp_columns_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "bgzf.hpp"
+
+/* ColumnZone
+ *  what the rows of one chunk of a column cache have; a chunk's rows
+ *  are of one reference and in position order, so that the chunks of
+ *  a region are a run of them and can be found without reading any
+ */
+struct ColumnZone
+{
+    int64_t posMin;
+    int64_t posMax;
+    int64_t endMax;                 /* the end of the one that ends last */
+    int32_t reference;
+    uint32_t rows;
+    uint8_t flagAll;                /* the row flags every one has */
+    uint8_t flagAny;                /* and those any one has */
+    uint8_t mqMin;
+    uint8_t mqMax;
+    uint8_t reserved[4];
+};
+
+/* ColumnChunk
+ *  where a chunk of a column file is: "stored" bytes at "offset",
+ *  deflated unless they are as many as the chunk's "size"
+ */
+struct ColumnChunk
+{
+    uint64_t offset;
+    uint64_t stored;
+    uint64_t size;
+};
+
+/* ColumnWriter
+ *  makes a column file a chunk at a time: each is deflated on its own,
+ *  or kept as it is if that doesn't make it smaller, so that any one
+ *  can be read without the others; after the chunks, their directory
+ *  and a trailer that finds it
+ *  it is written beside "path" and renamed to it by Commit
+ */
+class ColumnWriter
+{
+    FILE *file;
+    std::string path;
+    std::string temp;
+    std::vector<ColumnChunk> chunks;
+    std::vector<uint8_t> deflated;
+    uint64_t offset;
+    int level;
+
+    ColumnWriter(ColumnWriter const &);
+    ColumnWriter &operator =(ColumnWriter const &);
+public:
+    /* throws if the file can't be created; "level" as zlib's */
+    ColumnWriter(std::string const &path, int const level);
+    ~ColumnWriter();
+
+    /* Write
+     *  the next chunk, of "size" bytes
+     */
+    void Write(void const *const data, size_t const size);
+
+    /* Commit
+     *  the directory and trailer; throws if they, or any chunk before,
+     *  couldn't be written
+     */
+    void Commit();
+};
+
+/* ColumnFile
+ *  a column file, mapped
+ */
+class ColumnFile
+{
+    MappedFile mapped;
+    ColumnChunk const *chunks;
+    size_t count;
+
+    ColumnFile(ColumnFile const &);
+    ColumnFile &operator =(ColumnFile const &);
+public:
+    ColumnFile() : chunks(0), count(0) {}
+
+    /* Open
+     *  throws if it can't be mapped or isn't a column file
+     */
+    void Open(std::string const &path);
+
+    size_t size() const {
+        return count;
+    }
+    /* Size
+     *  the bytes of chunk "i" once it is read
+     */
+    size_t Size(size_t const i) const {
+        return (size_t)chunks[i].size;
+    }
+    /* Read
+     *  chunk "i" into the Size(i) bytes at "dst"; throws if it is
+     *  damaged
+     */
+    void Read(size_t const i, void *const dst) const;
+};
+
+#endif // _hpp_columns_
@@ -0,0 +1,271 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "coverage.hpp"
+
+#include <string.h>
+#include <cstdio>
+
+static char const coverageSuffix[] = ".ngs-coverage";
+static char const coverageMagic[8] = { 'N', 'G', 'S', 'C', 'O', 'V', 'R', '1' };
+
+struct CoverageMap::Header
+{
+    char magic[8];
+    uint32_t n_ref;
+    uint32_t flags;
+    int32_t map_qual;
+    uint32_t finest_shift;
+    uint32_t level_shift;
+    uint32_t levels;
+};
+
+struct CoverageMap::Reference
+{
+    uint64_t length;
+    uint64_t bins[LEVELS];          /* offsets from the header */
+};
+
+/* Align
+ *  where the header starts after the sidecar's first line
+ */
+static size_t Align(size_t const offset)
+{
+    return (offset + 63) & ~(size_t)63;
+}
+
+static uint64_t CountBins(uint64_t const length, int const level)
+{
+    unsigned const shift = CoverageMap::Shift(level);
+    
+    return (length + ((uint64_t)1 << shift) - 1) >> shift;
+}
+
+bool CoverageMap::Writer::Open(std::string const &bampath, std::vector<uint64_t> const &Lengths,
+                               uint32_t const flags, int32_t const map_qual)
+{
+    if (!update.OpenWrite(bampath, coverageSuffix))
+        return false;
+    
+    FILE *const fp = update.get();
+    long const line = ftell(fp);
+    
+    if (line < 0)
+        return false;
+    
+    Header header;
+    std::vector<Reference> table(Lengths.size());
+    uint64_t offset = sizeof(header) + table.size() * sizeof(Reference);
+    
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, coverageMagic, 8);
+    header.n_ref = (uint32_t)Lengths.size();
+    header.flags = flags;
+    header.map_qual = map_qual;
+    header.finest_shift = FINEST_SHIFT;
+    header.level_shift = LEVEL_SHIFT;
+    header.levels = LEVELS;
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i].length = Lengths[i];
+        for (int level = 0; level < LEVELS; ++level) {
+            table[i].bins[level] = offset;
+            offset += CountBins(Lengths[i], level) * sizeof(CoverageBin);
+        }
+    }
+    for (size_t pad = Align((size_t)line) - (size_t)line; pad > 0; --pad)
+        fputc('\0', fp);
+    if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        (!table.empty() && fwrite(&table[0], sizeof(Reference), table.size(), fp) != table.size()))
+    {
+        return false;
+    }
+    lengths = Lengths;
+    ref = 0;
+    pos = 0;
+    for (int level = 0; level < LEVELS; ++level) {
+        Sum const none = { 0, 0, ~(uint32_t)0, 0 };
+        
+        open[level] = none;
+    }
+    ok = true;
+    Flush();                        /* past any references of no length */
+    return true;
+}
+
+/* Close
+ *  the open bin of "level", into the one above
+ */
+void CoverageMap::Writer::Close(unsigned const level)
+{
+    Sum &s = open[level];
+    CoverageBin const bin = { (float)((double)s.sum / s.count), s.min, s.max };
+    
+    bins[level].push_back(bin);
+    if (level + 1 < LEVELS) {
+        Sum &up = open[level + 1];
+        
+        up.sum += s.sum;
+        up.count += s.count;
+        if (up.min > s.min)
+            up.min = s.min;
+        if (up.max < s.max)
+            up.max = s.max;
+    }
+    Sum const none = { 0, 0, ~(uint32_t)0, 0 };
+    s = none;
+}
+
+/* Flush
+ *  write the bins of each reference that has all its positions
+ */
+void CoverageMap::Writer::Flush()
+{
+    while (ref < lengths.size() && pos == lengths[ref]) {
+        for (int level = 0; level < LEVELS; ++level) {
+            std::vector<CoverageBin> &done = bins[level];
+            
+            if (open[level].count > 0)
+                Close(level);
+            if (ok && !done.empty() && fwrite(&done[0], sizeof(CoverageBin), done.size(), update.get()) != done.size())
+                ok = false;
+            done.clear();
+        }
+        ++ref;
+        pos = 0;
+    }
+}
+
+void CoverageMap::Writer::Add(uint32_t const depth[], size_t const count)
+{
+    uint64_t const width = (uint64_t)1 << FINEST_SHIFT;
+    
+    for (size_t i = 0; i < count; ) {
+        if (ref >= lengths.size()) {
+            ok = false;             /* more than the references have */
+            return;
+        }
+        
+        Sum &s = open[0];
+        uint64_t n = count - i;
+        
+        if (n > width - s.count)
+            n = width - s.count;
+        if (n > lengths[ref] - pos)
+            n = lengths[ref] - pos;
+        for (uint64_t j = 0; j < n; ++j) {
+            uint32_t const d = depth[i + j];
+            
+            s.sum += d;
+            if (s.min > d)
+                s.min = d;
+            if (s.max < d)
+                s.max = d;
+        }
+        s.count += n;
+        pos += n;
+        i += n;
+        if (s.count == width) {
+            Close(0);
+            for (int level = 1; level < LEVELS && open[level].count == ((uint64_t)1 << Shift(level)); ++level)
+                Close(level);
+        }
+        Flush();
+    }
+}
+
+bool CoverageMap::Writer::Commit()
+{
+    if (!ok || ref < lengths.size())
+        return false;
+    return update.Commit();
+}
+
+bool CoverageMap::Map(std::string const &bampath, std::vector<uint64_t> const &lengths)
+{
+    Sidecar cached;
+    
+    if (header || !cached.OpenRead(bampath, coverageSuffix))
+        return false;
+    
+    long const line = ftell(cached.get());
+    if (line < 0 || !mapped.Map(fileno(cached.get())))
+        return false;
+    
+    size_t const start = Align((size_t)line);
+    size_t const size = mapped.size() > start ? mapped.size() - start : 0;
+    char const *const Base = reinterpret_cast<char const *>(mapped.data()) + start;
+    Header const *const Hdr = reinterpret_cast<Header const *>(Base);
+    Reference const *const table = reinterpret_cast<Reference const *>(Hdr + 1);
+    
+    if (size < sizeof(*Hdr) || memcmp(Hdr->magic, coverageMagic, 8) != 0 ||
+        Hdr->finest_shift != FINEST_SHIFT || Hdr->level_shift != LEVEL_SHIFT || Hdr->levels != LEVELS ||
+        Hdr->n_ref != lengths.size() || size < sizeof(*Hdr) + Hdr->n_ref * sizeof(*table))
+    {
+        mapped.Unmap();
+        return false;
+    }
+    for (unsigned i = 0; i < Hdr->n_ref; ++i) {
+        if (table[i].length != lengths[i]) {
+            mapped.Unmap();
+            return false;
+        }
+        for (int level = 0; level < LEVELS; ++level) {
+            uint64_t const at = table[i].bins[level];
+            
+            if (at % 4 != 0 || at > size || CountBins(lengths[i], level) > (size - at) / sizeof(CoverageBin)) {
+                mapped.Unmap();
+                return false;
+            }
+        }
+    }
+    header = Hdr;
+    refs = table;
+    base = Base;
+    return true;
+}
+
+int CoverageMap::Level(uint64_t const resolution)
+{
+    int level = -1;
+    
+    while (level + 1 < LEVELS && ((uint64_t)1 << Shift(level + 1)) <= resolution)
+        ++level;
+    return level;
+}
+
+bool CoverageMap::counted(uint32_t const flags, int32_t const map_qual) const
+{
+    return header != 0 && header->flags == flags && header->map_qual == map_qual;
+}
+
+CoverageBin const *CoverageMap::getBins(unsigned const refID, int const level, size_t &count) const
+{
+    if (header == 0 || refID >= header->n_ref || level < 0 || level >= LEVELS) {
+        count = 0;
+        return 0;
+    }
+    count = (size_t)CountBins(refs[refID].length, level);
+    return reinterpret_cast<CoverageBin const *>(base + refs[refID].bins[level]);
+}
@@ -0,0 +1,142 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_coverage_
+#define _hpp_coverage_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "bgzf.hpp"
+#include "sidecar.hpp"
+
+/* CoverageBin
+ *  the depth over a bin of a reference: the mean of its positions',
+ *  and the least and the most of any one
+ */
+struct CoverageBin
+{
+    float mean;
+    uint32_t min;
+    uint32_t max;
+};
+
+/* CoverageMap
+ *  the depth of every reference in bins of 256 positions, and again in
+ *  bins four times as wide at each level above, up to 1 MiB, with the
+ *  filter of the alignments it was counted from; kept in a sidecar,
+ *  <path>.ngs-coverage, and mapped from it
+ */
+class CoverageMap
+{
+public:
+    enum { FINEST_SHIFT = 8, LEVEL_SHIFT = 2, LEVELS = 7 };
+
+    /* Writer
+     *  makes the sidecar from the depth at every position of each
+     *  reference in turn, given in pieces of any size
+     */
+    class Writer
+    {
+        struct Sum {
+            uint64_t sum;
+            uint64_t count;
+            uint32_t min;
+            uint32_t max;
+        };
+        Sidecar update;
+        std::vector<uint64_t> lengths;
+        unsigned ref;
+        uint64_t pos;
+        Sum open[LEVELS];
+        std::vector<CoverageBin> bins[LEVELS];
+        bool ok;
+
+        void Close(unsigned const level);
+        void Flush();
+    public:
+        Writer() : ref(0), pos(0), ok(false) {}
+
+        /* Open
+         *  returns false if the sidecar can't be written
+         */
+        bool Open(std::string const &bampath, std::vector<uint64_t> const &lengths, uint32_t const flags, int32_t const map_qual);
+
+        /* Add
+         *  the depth at the next "count" positions
+         */
+        void Add(uint32_t const depth[], size_t const count);
+
+        /* Commit
+         *  once every position of every reference was added
+         */
+        bool Commit();
+    };
+
+private:
+    struct Header;
+    struct Reference;
+
+    MappedFile mapped;
+    Header const *header;
+    Reference const *refs;
+    char const *base;
+
+    CoverageMap(CoverageMap const &);
+    CoverageMap &operator =(CoverageMap const &);
+public:
+    CoverageMap() : header(0), refs(0), base(0) {}
+
+    /* Map
+     *  the sidecar of the file at "bampath", if it is current and has
+     *  the references of "lengths"
+     */
+    bool Map(std::string const &bampath, std::vector<uint64_t> const &lengths);
+
+    /* Level
+     *  the coarsest level whose bins are no wider than "resolution",
+     *  or -1 if the finest are wider
+     */
+    static int Level(uint64_t const resolution);
+    static unsigned Shift(int const level) {
+        return FINEST_SHIFT + level * LEVEL_SHIFT;
+    }
+
+    /* counted
+     *  whether it was counted from the alignments of "flags" and
+     *  "map_qual", as NGS_ReferenceAlignFlags choose them
+     */
+    bool counted(uint32_t const flags, int32_t const map_qual) const;
+
+    /* getBins
+     *  those of reference "refID" at "level", and how many there are
+     */
+    CoverageBin const *getBins(unsigned const refID, int const level, size_t &count) const;
+};
+
+#endif // _hpp_coverage_
@@ -0,0 +1,73 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "cpu.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+static char const *const levelNames[] = { "scalar", "sse2", "ssse3", "avx2", "avx512" };
+
+char const *CPU::Name(Level const level)
+{
+    return levelNames[level];
+}
+
+static CPU::Level Detect()
+{
+#if CPU_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return CPU::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return CPU::avx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return CPU::ssse3;
+    if (__builtin_cpu_supports("sse2"))
+        return CPU::sse2;
+#endif
+    return CPU::scalar;
+}
+
+static CPU::Level Find()
+{
+    CPU::Level const found = Detect();
+    char const *const cap = getenv("NGS_BAM_CPU");
+    
+    if (cap) {
+        for (unsigned i = 0; i < sizeof(levelNames) / sizeof(levelNames[0]); ++i) {
+            if (strcmp(cap, levelNames[i]) == 0)
+                return (CPU::Level)i < found ? (CPU::Level)i : found;
+        }
+    }
+    return found;
+}
+
+CPU::Level CPU::Best()
+{
+    static Level const best = Find();
+    return best;
+}
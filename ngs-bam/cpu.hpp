@@ -0,0 +1,71 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_cpu_
+#define _hpp_cpu_
+
+/* CPU
+ *  the vector instructions this machine has, found once at load, so that
+ *  a build for plain x86-64 can still run the SSSE3, AVX2 and AVX-512
+ *  kernels where they are there
+ *  the environment variable NGS_BAM_CPU, one of "scalar", "sse2",
+ *  "ssse3", "avx2" or "avx512", caps what is used, to compare kernels
+ *  on one machine
+ *  with GCC or clang on x86, CPU_DISPATCH is 1 and a kernel built with
+ *  CPU_TARGET may use what it names whatever the build's flags; elsewhere
+ *  the kernels are picked when compiled, as NEON is on aarch64
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CPU_DISPATCH 1
+#define CPU_TARGET(ISA) __attribute__((target(ISA)))
+#include <immintrin.h>
+#else
+#define CPU_DISPATCH 0
+#define CPU_TARGET(ISA)
+#endif
+
+class CPU
+{
+public:
+    enum Level {
+        scalar,
+        sse2,
+        ssse3,
+        avx2,
+        avx512                      /* AVX-512 F and BW */
+    };
+
+    /* Best
+     *  of what this machine has and NGS_BAM_CPU allows
+     */
+    static Level Best();
+
+    /* Name
+     *  as NGS_BAM_CPU has it
+     */
+    static char const *Name(Level const level);
+};
+
+#endif // _hpp_cpu_
@@ -0,0 +1,2582 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "cram.hpp"
+#include "source.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+
+#include <zlib.h>
+#if HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+#if HAVE_BZIP2
+#include <bzlib.h>
+#endif
+#if HAVE_LZMA
+#include <lzma.h>
+#endif
+
+/* the file definition: "CRAM", the version and a 20 byte file ID */
+#define CRAM_DEFINITION_SIZE 26
+
+/* the start of the EOF container, which has no records */
+#define CRAM_EOF_START 4542278
+
+/* the first read of a container, enough for the headers of most */
+#define CRAM_HEADER_PEEK 256
+
+/* block content types */
+enum {
+    FILE_HEADER = 0,
+    COMPRESSION_HEADER = 1,
+    SLICE_HEADER = 2,
+    EXTERNAL_DATA = 4,
+    CORE_DATA = 5
+};
+
+/* compression bit flags of a record */
+enum {
+    CF_QUAL_ARRAY = 1,
+    CF_DETACHED = 2,
+    CF_MATE_DOWNSTREAM = 4,
+    CF_NO_SEQ = 8
+};
+
+class CRAMLock
+{
+    pthread_mutex_t *const mutex;
+public:
+    CRAMLock(pthread_mutex_t &m) : mutex(&m) {
+        pthread_mutex_lock(mutex);
+    }
+    ~CRAMLock() {
+        pthread_mutex_unlock(mutex);
+    }
+};
+
+/* CRAMBytes
+ *  reads the integers of CRAM from memory; a read past the end gives
+ *  0 and sets "overrun", so that a caller may read more and try again
+ */
+class CRAMBytes
+{
+    uint8_t const *cur;
+    uint8_t const *const end;
+public:
+    bool overrun;
+
+    CRAMBytes(uint8_t const *const data, size_t const size) : cur(data), end(data + size), overrun(false) {}
+
+    size_t left() const {
+        return overrun ? 0 : (size_t)(end - cur);
+    }
+    uint8_t const *here() const {
+        return cur;
+    }
+    bool Has(size_t const count) {
+        if ((size_t)(end - cur) >= count)
+            return true;
+        overrun = true;
+        cur = end;
+        return false;
+    }
+    uint8_t Byte() {
+        return Has(1) ? *cur++ : 0;
+    }
+    uint8_t const *Bytes(size_t const count) {
+        if (!Has(count))
+            return 0;
+        uint8_t const *const rslt = cur;
+        cur += count;
+        return rslt;
+    }
+    int32_t Int32() {
+        if (!Has(4))
+            return 0;
+        uint32_t const value = cur[0] | (cur[1] << 8) | (cur[2] << 16) | ((uint32_t)cur[3] << 24);
+        cur += 4;
+        return (int32_t)value;
+    }
+    int32_t ITF8() {
+        if (!Has(1))
+            return 0;
+        uint32_t const b0 = cur[0];
+        unsigned const n = b0 < 0x80 ? 1 : b0 < 0xC0 ? 2 : b0 < 0xE0 ? 3 : b0 < 0xF0 ? 4 : 5;
+        if (!Has(n))
+            return 0;
+        uint8_t const *const p = cur;
+        uint32_t value;
+
+        cur += n;
+        switch (n) {
+            case 1:
+                value = b0;
+                break;
+            case 2:
+                value = ((b0 << 8) | p[1]) & 0x3FFF;
+                break;
+            case 3:
+                value = ((b0 << 16) | (p[1] << 8) | p[2]) & 0x1FFFFF;
+                break;
+            case 4:
+                value = ((b0 << 24) | (p[1] << 16) | (p[2] << 8) | p[3]) & 0x0FFFFFFF;
+                break;
+            default:
+                value = ((b0 & 0x0F) << 28) | (p[1] << 20) | (p[2] << 12) | (p[3] << 4) | (p[4] & 0x0F);
+                break;
+        }
+        return (int32_t)value;
+    }
+    int64_t LTF8() {
+        if (!Has(1))
+            return 0;
+        unsigned const b0 = cur[0];
+        unsigned n = 1;
+
+        while (n < 9 && (b0 & (0x80 >> (n - 1))) != 0)
+            ++n;
+        if (!Has(n))
+            return 0;
+
+        uint64_t value = n < 8 ? (b0 & (0xFF >> n)) : 0;
+
+        for (unsigned i = 1; i < n; ++i)
+            value = (value << 8) | cur[i];
+        cur += n;
+        return (int64_t)value;
+    }
+};
+
+static void Truncated(char const what[])
+{
+    throw std::runtime_error(std::string("CRAM ") + what + " is truncated");
+}
+
+/* BitReader
+ *  the core data block, read from the most significant bit of each byte
+ */
+class BitReader
+{
+    uint8_t const *data;
+    size_t size;
+    size_t byte;
+    unsigned bit;                   /* of the current byte, 7 first */
+public:
+    BitReader() : data(0), size(0), byte(0), bit(7) {}
+
+    void Reset(uint8_t const *const Data, size_t const Size) {
+        data = Data;
+        size = Size;
+        byte = 0;
+        bit = 7;
+    }
+    unsigned Bit() {
+        if (byte >= size)
+            Truncated("core data block");
+
+        unsigned const rslt = (data[byte] >> bit) & 1;
+
+        if (bit == 0) {
+            bit = 7;
+            ++byte;
+        }
+        else
+            --bit;
+        return rslt;
+    }
+    uint32_t Bits(unsigned count) {
+        uint32_t value = 0;
+
+        while (count--)
+            value = (value << 1) | Bit();
+        return value;
+    }
+};
+
+/* External
+ *  an external data block, read from the front
+ */
+struct External
+{
+    std::vector<uint8_t> data;
+    size_t pos;
+
+    External() : pos(0) {}
+
+    uint8_t Byte() {
+        if (pos >= data.size())
+            Truncated("external data block");
+        return data[pos++];
+    }
+    int32_t ITF8() {
+        CRAMBytes in(data.empty() ? 0 : &data[0] + pos, data.size() - pos);
+        int32_t const value = in.ITF8();
+
+        if (in.overrun)
+            Truncated("external data block");
+        pos = data.size() - in.left();
+        return value;
+    }
+    void Append(size_t const count, std::string &dst) {
+        if (data.size() - pos < count)
+            Truncated("external data block");
+        dst.append((char const *)&data[pos], count);
+        pos += count;
+    }
+    void AppendUntil(uint8_t const stop, std::string &dst) {
+        uint8_t const *const beg = data.empty() ? 0 : &data[0] + pos;
+        uint8_t const *const hit = beg ? (uint8_t const *)memchr(beg, stop, data.size() - pos) : 0;
+
+        if (hit == 0)
+            Truncated("external data block");
+        dst.append((char const *)beg, hit - beg);
+        pos += (hit - beg) + 1;
+    }
+};
+
+/* Gunzip
+ *  a gzip stream of a known size, of one member or several
+ */
+static void Gunzip(uint8_t const *const src, size_t const csize, std::vector<uint8_t> &dst, size_t const rawSize)
+{
+    dst.resize(rawSize);
+    if (rawSize == 0)
+        return;
+#if HAVE_LIBDEFLATE
+    struct libdeflate_decompressor *const d = libdeflate_alloc_decompressor();
+    size_t actual = 0;
+
+    if (d == 0)
+        throw std::bad_alloc();
+
+    enum libdeflate_result const rc = libdeflate_gzip_decompress(d, src, csize, &dst[0], rawSize, &actual);
+
+    libdeflate_free_decompressor(d);
+    if (rc == LIBDEFLATE_SUCCESS && actual == rawSize)
+        return;
+#endif
+    z_stream zs;
+
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK)
+        throw std::runtime_error("gzip initialization failed");
+    zs.next_in = const_cast<Bytef *>(src);
+    zs.avail_in = (uInt)csize;
+    zs.next_out = &dst[0];
+    zs.avail_out = (uInt)rawSize;
+    for ( ; ; ) {
+        int const zrc = inflate(&zs, Z_FINISH);
+
+        if (zrc == Z_STREAM_END && zs.avail_out != 0 && zs.avail_in != 0) {
+            inflateReset(&zs);
+            continue;
+        }
+        inflateEnd(&zs);
+        if ((zrc == Z_STREAM_END || zrc == Z_OK || zrc == Z_BUF_ERROR) && zs.avail_out == 0)
+            return;
+        throw std::runtime_error("CRAM block gzip decompression failed");
+    }
+}
+
+/* rANS 4x8
+ *  4 interleaved states, 12 bit frequencies; order 0 or order 1, for
+ *  which the previous symbol is the context of each
+ */
+#define RANS_TF_SHIFT 12
+#define RANS_TOTFREQ (1u << RANS_TF_SHIFT)
+#define RANS_BYTE_L (1u << 23)
+
+struct RansSymbol
+{
+    uint16_t freq;
+    uint16_t start;
+};
+
+struct RansTable
+{
+    RansSymbol sym[256];
+    uint8_t lookup[RANS_TOTFREQ];   /* symbol of each slot */
+};
+
+static void RansRenorm(uint32_t &x, CRAMBytes &in)
+{
+    while (x < RANS_BYTE_L)
+        x = (x << 8) | in.Byte();
+}
+
+/* ReadFrequencies
+ *  a table of the frequencies of symbols, with runs of adjacent symbols
+ */
+static void ReadFrequencies(CRAMBytes &in, RansTable &table)
+{
+    unsigned x = 0;
+    unsigned rle = 0;
+    unsigned j = in.Byte();
+
+    memset(table.sym, 0, sizeof(table.sym));
+    memset(table.lookup, 0, sizeof(table.lookup));
+    do {
+        unsigned F = in.Byte();
+
+        if (F >= 128)
+            F = ((F & 127) << 8) | in.Byte();
+        if (x + F > RANS_TOTFREQ || in.overrun)
+            throw std::runtime_error("CRAM rANS frequency table is invalid");
+        table.sym[j].freq = (uint16_t)F;
+        table.sym[j].start = (uint16_t)x;
+        memset(&table.lookup[x], (int)j, F);
+        x += F;
+
+        if (rle == 0 && in.left() > 0 && j + 1 == *in.here()) {
+            j = in.Byte();
+            rle = in.Byte();
+        }
+        else if (rle != 0) {
+            --rle;
+            ++j;
+        }
+        else
+            j = in.Byte();
+    } while (j != 0 && j < 256 && !in.overrun);
+    if (x == 0)
+        throw std::runtime_error("CRAM rANS frequency table is empty");
+}
+
+static uint8_t RansDecode(RansTable const &table, uint32_t &x)
+{
+    uint32_t const m = x & (RANS_TOTFREQ - 1);
+    uint8_t const c = table.lookup[m];
+
+    x = table.sym[c].freq * (x >> RANS_TF_SHIFT) + m - table.sym[c].start;
+    return c;
+}
+
+static void RansStates(CRAMBytes &in, uint32_t R[4])
+{
+    for (unsigned k = 0; k < 4; ++k)
+        R[k] = (uint32_t)in.Int32();
+}
+
+static void Rans0(CRAMBytes &in, uint8_t *const out, size_t const size)
+{
+    RansTable *const table = new RansTable;
+    uint32_t R[4];
+
+    try {
+        ReadFrequencies(in, *table);
+        RansStates(in, R);
+
+        size_t const end = size & ~(size_t)3;
+
+        for (size_t i = 0; i < end; i += 4) {
+            for (unsigned k = 0; k < 4; ++k) {
+                out[i + k] = RansDecode(*table, R[k]);
+                RansRenorm(R[k], in);
+            }
+        }
+        for (size_t k = 0; k < (size & 3); ++k)
+            out[end + k] = table->lookup[R[k] & (RANS_TOTFREQ - 1)];
+    }
+    catch (...) {
+        delete table;
+        throw;
+    }
+    delete table;
+}
+
+static void Rans1(CRAMBytes &in, uint8_t *const out, size_t const size)
+{
+    std::vector<RansTable> tables(256);
+    unsigned rle = 0;
+    unsigned i = in.Byte();
+
+    do {
+        ReadFrequencies(in, tables[i]);
+        if (rle == 0 && in.left() > 0 && i + 1 == *in.here()) {
+            i = in.Byte();
+            rle = in.Byte();
+        }
+        else if (rle != 0) {
+            --rle;
+            ++i;
+        }
+        else
+            i = in.Byte();
+    } while (i != 0 && i < 256 && !in.overrun);
+
+    uint32_t R[4];
+    size_t const quarter = size >> 2;
+    size_t at[4];
+    unsigned last[4] = { 0, 0, 0, 0 };
+
+    RansStates(in, R);
+    for (unsigned k = 0; k < 4; ++k)
+        at[k] = k * quarter;
+    for (size_t n = 0; n < quarter; ++n) {
+        for (unsigned k = 0; k < 4; ++k) {
+            uint8_t const c = RansDecode(tables[last[k]], R[k]);
+
+            RansRenorm(R[k], in);
+            out[at[k]++] = c;
+            last[k] = c;
+        }
+    }
+    for ( ; at[3] < size; ) {
+        uint8_t const c = RansDecode(tables[last[3]], R[3]);
+
+        RansRenorm(R[3], in);
+        out[at[3]++] = c;
+        last[3] = c;
+    }
+}
+
+static void Unrans(uint8_t const *const src, size_t const csize, std::vector<uint8_t> &dst, size_t const rawSize)
+{
+    CRAMBytes in(src, csize);
+    unsigned const order = in.Byte();
+    uint32_t const insize = (uint32_t)in.Int32();
+    uint32_t const outsize = (uint32_t)in.Int32();
+
+    if (in.overrun || insize + 9 > csize || outsize != rawSize)
+        throw std::runtime_error("CRAM rANS block header is invalid");
+    dst.resize(rawSize);
+    if (rawSize == 0)
+        return;
+    if (order == 0)
+        Rans0(in, &dst[0], rawSize);
+    else
+        Rans1(in, &dst[0], rawSize);
+    if (in.overrun)
+        throw std::runtime_error("CRAM rANS block is truncated");
+}
+
+/* Decompress
+ *  a block's data by its method
+ */
+static void Decompress(unsigned const method, uint8_t const *const src, size_t const csize,
+                       std::vector<uint8_t> &dst, size_t const rawSize)
+{
+    switch (method) {
+        case 0:
+            if (csize != rawSize)
+                throw std::runtime_error("CRAM raw block sizes differ");
+            dst.assign(src, src + csize);
+            return;
+        case 1:
+            Gunzip(src, csize, dst, rawSize);
+            return;
+        case 2:
+#if HAVE_BZIP2
+        {
+            unsigned int size = (unsigned int)rawSize;
+
+            dst.resize(rawSize + 1);
+            if (BZ2_bzBuffToBuffDecompress((char *)&dst[0], &size, (char *)const_cast<uint8_t *>(src),
+                                           (unsigned int)csize, 0, 0) != BZ_OK || size != rawSize)
+                throw std::runtime_error("CRAM block bzip2 decompression failed");
+            dst.resize(size);
+            return;
+        }
+#else
+            throw std::runtime_error("CRAM blocks compressed with bzip2 are not supported by this build");
+#endif
+        case 3:
+#if HAVE_LZMA
+        {
+            uint64_t memlimit = ~(uint64_t)0;
+            size_t in_pos = 0;
+            size_t out_pos = 0;
+
+            dst.resize(rawSize + 1);
+            if (lzma_stream_buffer_decode(&memlimit, 0, 0, src, &in_pos, csize,
+                                          &dst[0], &out_pos, dst.size()) != LZMA_OK || out_pos != rawSize)
+                throw std::runtime_error("CRAM block xz decompression failed");
+            dst.resize(out_pos);
+            return;
+        }
+#else
+            throw std::runtime_error("CRAM blocks compressed with xz are not supported by this build");
+#endif
+        case 4:
+            Unrans(src, csize, dst, rawSize);
+            return;
+        default:
+            throw std::runtime_error("CRAM block compression method is not supported (CRAM 3.1 codecs are not)");
+    }
+}
+
+/* Block
+ *  one block, its data decompressed
+ */
+struct Block
+{
+    unsigned method;
+    unsigned type;
+    int32_t id;
+    std::vector<uint8_t> data;
+};
+
+/* ReadBlock
+ *  the block at the front of "in", which ends with its CRC32
+ */
+static void ReadBlock(CRAMBytes &in, bool const verifyCRC, Block &rslt)
+{
+    uint8_t const *const start = in.here();
+
+    rslt.method = in.Byte();
+    rslt.type = in.Byte();
+    rslt.id = in.ITF8();
+
+    int32_t const csize = in.ITF8();
+    int32_t const rawSize = in.ITF8();
+
+    if (in.overrun || csize < 0 || rawSize < 0)
+        Truncated("block header");
+
+    uint8_t const *const data = in.Bytes(csize);
+
+    if (data == 0)
+        Truncated("block");
+    uint32_t const expect = (uint32_t)in.Int32();
+
+    if (in.overrun)
+        Truncated("block");
+    if (verifyCRC && crc32(0, start, (uInt)(data + csize - start)) != expect)
+        throw std::runtime_error("CRAM block CRC mismatch");
+    Decompress(rslt.method, data, csize, rslt.data, rawSize);
+}
+
+/* Codec
+ *  an encoding of a data series; sub-encodings are indices into the
+ *  compression header's list of them
+ */
+struct Codec
+{
+    enum Kind {
+        NUL = 0,
+        EXTERNAL = 1,
+        HUFFMAN = 3,
+        BYTE_ARRAY_LEN = 4,
+        BYTE_ARRAY_STOP = 5,
+        BETA = 6,
+        SUBEXP = 7,
+        GAMMA = 9
+    };
+    struct Code {
+        uint32_t length;
+        uint32_t code;
+        int32_t symbol;
+    };
+    int kind;
+    int32_t external;               /* block content ID, EXTERNAL and BYTE_ARRAY_STOP */
+    int32_t offset;                 /* BETA, SUBEXP and GAMMA */
+    int32_t bits;                   /* BETA, or k of SUBEXP */
+    uint8_t stop;                   /* BYTE_ARRAY_STOP */
+    int lengths;                    /* sub-encodings of BYTE_ARRAY_LEN */
+    int values;
+    std::vector<Code> codes;        /* HUFFMAN, by length then code */
+
+    Codec() : kind(NUL), external(-1), offset(0), bits(0), stop(0), lengths(-1), values(-1) {}
+};
+
+/* data series */
+enum Series {
+    BF, CF, RI, RL, AP, RG, RN, MF, NS, NP, TS, NF, TL, FN, FC, FP,
+    DL, BB, QQ, BS, IN, RS, PD, HC, SC, MQ, BA, QS,
+    SERIES
+};
+static char const seriesKeys[SERIES][3] = {
+    "BF", "CF", "RI", "RL", "AP", "RG", "RN", "MF", "NS", "NP", "TS", "NF", "TL", "FN", "FC", "FP",
+    "DL", "BB", "QQ", "BS", "IN", "RS", "PD", "HC", "SC", "MQ", "BA", "QS"
+};
+
+/* CompressionHeader
+ *  what a container's slices are decoded with
+ */
+struct CompressionHeader
+{
+    bool readNames;                 /* RN: the names are kept */
+    bool deltaPositions;            /* AP: positions are from the previous record */
+    bool referenceRequired;         /* RR */
+    char substitutions[5][4];       /* SM: the base of each code, by reference base */
+    std::vector<std::vector<int32_t> > tagLines;    /* TD: the tags of each TL */
+    std::vector<Codec> codecs;
+    int series[SERIES];             /* index into codecs, or -1 */
+    std::map<int32_t, int> tags;    /* by (tag << 8) | type */
+
+    CompressionHeader() : readNames(true), deltaPositions(true), referenceRequired(true) {
+        uint8_t const sm[5] = { 0x1B, 0x1B, 0x1B, 0x1B, 0x1B };
+
+        SetSubstitutions(sm);
+        for (unsigned i = 0; i < SERIES; ++i)
+            series[i] = -1;
+    }
+    /* SetSubstitutions
+     *  from the SM of the preservation map: for each reference base of
+     *  ACGTN, the 2 bit codes of the other four, in that order
+     */
+    void SetSubstitutions(uint8_t const sm[5]) {
+        static char const bases[] = "ACGTN";
+
+        for (unsigned r = 0; r < 5; ++r) {
+            char alts[4];
+            unsigned k = 0;
+
+            for (unsigned b = 0; b < 5; ++b) {
+                if (b != r)
+                    alts[k++] = bases[b];
+            }
+            for (unsigned i = 0; i < 4; ++i)
+                substitutions[r][(sm[r] >> (6 - 2 * i)) & 3] = alts[i];
+        }
+    }
+};
+
+static int ReadCodec(CRAMBytes &in, CompressionHeader &hdr);
+
+static int ReadCodecParams(CRAMBytes &in, int const kind, CompressionHeader &hdr)
+{
+    Codec codec;
+
+    codec.kind = kind;
+    switch (kind) {
+        case Codec::NUL:
+            break;
+        case Codec::EXTERNAL:
+            codec.external = in.ITF8();
+            break;
+        case Codec::HUFFMAN: {
+            int32_t const symbols = in.ITF8();
+            std::vector<int32_t> alphabet;
+
+            for (int32_t i = 0; i < symbols && !in.overrun; ++i)
+                alphabet.push_back(in.ITF8());
+
+            int32_t const count = in.ITF8();
+
+            if (count != symbols)
+                throw std::runtime_error("CRAM Huffman encoding is invalid");
+            for (int32_t i = 0; i < count && !in.overrun; ++i) {
+                Codec::Code code;
+
+                code.length = (uint32_t)in.ITF8();
+                code.code = 0;
+                code.symbol = alphabet[i];
+                if (code.length > 31)
+                    throw std::runtime_error("CRAM Huffman code is too long");
+                codec.codes.push_back(code);
+            }
+            /* canonical codes, by length and then by symbol */
+            for (size_t i = 1; i < codec.codes.size(); ++i) {
+                Codec::Code const key = codec.codes[i];
+                size_t j = i;
+
+                for ( ; j > 0; --j) {
+                    Codec::Code const &prev = codec.codes[j - 1];
+
+                    if (prev.length < key.length || (prev.length == key.length && prev.symbol < key.symbol))
+                        break;
+                    codec.codes[j] = prev;
+                }
+                codec.codes[j] = key;
+            }
+
+            uint32_t code = 0;
+            uint32_t length = codec.codes.empty() ? 0 : codec.codes[0].length;
+
+            for (size_t i = 0; i < codec.codes.size(); ++i) {
+                code <<= codec.codes[i].length - length;
+                length = codec.codes[i].length;
+                codec.codes[i].code = code++;
+            }
+            break;
+        }
+        case Codec::BYTE_ARRAY_LEN:
+            codec.lengths = ReadCodec(in, hdr);
+            codec.values = ReadCodec(in, hdr);
+            break;
+        case Codec::BYTE_ARRAY_STOP:
+            codec.stop = in.Byte();
+            codec.external = in.ITF8();
+            break;
+        case Codec::BETA:
+            codec.offset = in.ITF8();
+            codec.bits = in.ITF8();
+            break;
+        case Codec::SUBEXP:
+            codec.offset = in.ITF8();
+            codec.bits = in.ITF8();
+            break;
+        case Codec::GAMMA:
+            codec.offset = in.ITF8();
+            break;
+        default: {
+            char buffer[64];
+
+            snprintf(buffer, sizeof(buffer), "CRAM encoding %d is not supported", kind);
+            throw std::runtime_error(buffer);
+        }
+    }
+    if (in.overrun)
+        Truncated("encoding");
+    hdr.codecs.push_back(codec);
+    return (int)hdr.codecs.size() - 1;
+}
+
+/* ReadCodec
+ *  an encoding: its ID, then its parameters, which are measured
+ */
+static int ReadCodec(CRAMBytes &in, CompressionHeader &hdr)
+{
+    int32_t const kind = in.ITF8();
+    int32_t const size = in.ITF8();
+    uint8_t const *const params = in.Bytes(size < 0 ? 0 : size);
+
+    if (params == 0 || size < 0)
+        Truncated("encoding");
+
+    CRAMBytes sub(params, size);
+
+    return ReadCodecParams(sub, kind, hdr);
+}
+
+static void ReadCompressionHeader(Block const &block, CompressionHeader &hdr)
+{
+    if (block.type != COMPRESSION_HEADER)
+        throw std::runtime_error("CRAM container doesn't start with a compression header");
+
+    CRAMBytes in(block.data.empty() ? 0 : &block.data[0], block.data.size());
+
+    /* the preservation map */
+    in.ITF8();
+    for (int32_t n = in.ITF8(); n > 0 && !in.overrun; --n) {
+        uint8_t const *const key = in.Bytes(2);
+
+        if (key == 0)
+            break;
+        if (key[0] == 'R' && key[1] == 'N')
+            hdr.readNames = in.Byte() != 0;
+        else if (key[0] == 'A' && key[1] == 'P')
+            hdr.deltaPositions = in.Byte() != 0;
+        else if (key[0] == 'R' && key[1] == 'R')
+            hdr.referenceRequired = in.Byte() != 0;
+        else if (key[0] == 'S' && key[1] == 'M') {
+            uint8_t const *const sm = in.Bytes(5);
+
+            if (sm)
+                hdr.SetSubstitutions(sm);
+        }
+        else if (key[0] == 'T' && key[1] == 'D') {
+            int32_t const size = in.ITF8();
+            uint8_t const *const td = in.Bytes(size < 0 ? 0 : size);
+            std::vector<int32_t> line;
+
+            for (int32_t i = 0; td && i < size; ) {
+                if (td[i] == 0) {
+                    hdr.tagLines.push_back(line);
+                    line.clear();
+                    ++i;
+                    continue;
+                }
+                if (i + 3 > size)
+                    break;
+                line.push_back((td[i] << 16) | (td[i + 1] << 8) | td[i + 2]);
+                i += 3;
+            }
+        }
+        else
+            throw std::runtime_error(std::string("CRAM preservation map key ") + (char)key[0] + (char)key[1] + " is not supported");
+    }
+
+    /* the encodings of the data series */
+    in.ITF8();
+    for (int32_t n = in.ITF8(); n > 0 && !in.overrun; --n) {
+        uint8_t const *const key = in.Bytes(2);
+
+        if (key == 0)
+            break;
+
+        int const codec = ReadCodec(in, hdr);
+
+        for (unsigned i = 0; i < SERIES; ++i) {
+            if (seriesKeys[i][0] == key[0] && seriesKeys[i][1] == key[1])
+                hdr.series[i] = codec;
+        }
+    }
+
+    /* the encodings of the tags */
+    in.ITF8();
+    for (int32_t n = in.ITF8(); n > 0 && !in.overrun; --n) {
+        int32_t const key = in.ITF8();
+
+        hdr.tags[key] = ReadCodec(in, hdr);
+    }
+    if (in.overrun)
+        Truncated("compression header");
+}
+
+/* SliceDecoder
+ *  the records of one slice, from its blocks
+ */
+class SliceDecoder
+{
+    struct Record {
+        int32_t refID;
+        int64_t pos;                /* 1-based, 0 for none */
+        int64_t end;                /* of the alignment, inclusive */
+        uint32_t flag;
+        uint32_t cf;
+        int32_t mapq;
+        int32_t readGroup;
+        int32_t mateRef;
+        int64_t matePos;            /* 1-based */
+        int64_t tlen;
+        bool tlenKnown;
+        int32_t mateLine;           /* the next record of the template, or -1 */
+        std::string name;
+        std::vector<uint32_t> cigar;
+        std::string seq;
+        std::string qual;
+        std::string aux;
+    };
+    CRAMFile const &file;
+    CompressionHeader const &hdr;
+    BitReader core;
+    std::map<int32_t, External> externals;
+    std::vector<External *> byCodec;        /* of each EXTERNAL and BYTE_ARRAY_STOP codec */
+    std::vector<Record> records;
+
+    /* the reference bases under the records, from the FASTA or embedded */
+    std::string window;
+    int32_t windowRef;
+    int64_t windowStart;            /* 0-based */
+    bool embedded;
+
+    External &ExternalOf(int const codec) {
+        External *const ext = byCodec[codec];
+
+        if (ext == 0)
+            throw std::runtime_error("CRAM slice lacks an external block it is encoded with");
+        return *ext;
+    }
+    void NoCodec(Series const series) const {
+        throw std::runtime_error(std::string("CRAM data series ") + seriesKeys[series] + " has no encoding");
+    }
+    int32_t Int(int const codec);
+    int32_t Int(Series const series) {
+        if (hdr.series[series] < 0)
+            NoCodec(series);
+        return Int(hdr.series[series]);
+    }
+    /* Byte
+     *  a value of a byte series, which an external block has as a byte
+     */
+    uint8_t Byte(int const codec) {
+        if (hdr.codecs[codec].kind == Codec::EXTERNAL)
+            return ExternalOf(codec).Byte();
+        return (uint8_t)Int(codec);
+    }
+    uint8_t Byte(Series const series) {
+        if (hdr.series[series] < 0)
+            NoCodec(series);
+        return Byte(hdr.series[series]);
+    }
+    void Bytes(int const codec, std::string &dst);
+    void Bytes(Series const series, std::string &dst) {
+        if (hdr.series[series] < 0)
+            NoCodec(series);
+        dst.clear();
+        Bytes(hdr.series[series], dst);
+    }
+    /* BytesN
+     *  "count" values of a byte series, e.g. the qualities of a read
+     */
+    void BytesN(Series const series, size_t const count, char *dst);
+    void Tag(int32_t const key, std::string &aux);
+
+    char const *Reference(int32_t const refID, int64_t const beg, int64_t const end);
+    void Features(Record &rec, int32_t const readLength);
+    void LinkMates();
+    void Pack(Record const &rec, CRAMSlice &into) const;
+public:
+    SliceDecoder(CRAMFile const &File, CompressionHeader const &Hdr) : file(File), hdr(Hdr), windowRef(-1), windowStart(0), embedded(false) {}
+
+    /* Decode
+     *  the slice in "data", into "into"
+     */
+    unsigned Decode(uint8_t const *const data, size_t const size, CRAMSlice &into);
+};
+
+int32_t SliceDecoder::Int(int const index)
+{
+    Codec const &codec = hdr.codecs[index];
+
+    switch (codec.kind) {
+        case Codec::EXTERNAL:
+            return ExternalOf(index).ITF8();
+        case Codec::HUFFMAN: {
+            size_t const n = codec.codes.size();
+
+            if (n == 1 && codec.codes[0].length == 0)
+                return codec.codes[0].symbol;
+
+            uint32_t length = 0;
+            uint32_t code = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                Codec::Code const &c = codec.codes[i];
+
+                while (length < c.length) {
+                    code = (code << 1) | core.Bit();
+                    ++length;
+                }
+                if (c.code == code)
+                    return c.symbol;
+            }
+            throw std::runtime_error("CRAM Huffman code is not in its table");
+        }
+        case Codec::BETA:
+            return (int32_t)core.Bits(codec.bits) - codec.offset;
+        case Codec::GAMMA: {
+            unsigned n = 0;
+
+            while (core.Bit() == 0) {
+                if (++n > 31)
+                    throw std::runtime_error("CRAM gamma code is invalid");
+            }
+            return (int32_t)((1u << n) | core.Bits(n)) - codec.offset;
+        }
+        case Codec::SUBEXP: {
+            unsigned i = 0;
+            uint32_t value;
+
+            while (core.Bit() == 1) {
+                if (++i > 31)
+                    throw std::runtime_error("CRAM subexponential code is invalid");
+            }
+            if (i == 0)
+                value = core.Bits(codec.bits);
+            else {
+                unsigned const b = i + codec.bits - 1;
+
+                value = (1u << b) | core.Bits(b);
+            }
+            return (int32_t)value - codec.offset;
+        }
+        default:
+            throw std::runtime_error("CRAM encoding can't encode integers");
+    }
+}
+
+void SliceDecoder::Bytes(int const index, std::string &dst)
+{
+    Codec const &codec = hdr.codecs[index];
+
+    switch (codec.kind) {
+        case Codec::BYTE_ARRAY_LEN: {
+            int32_t const length = Int(codec.lengths);
+
+            if (length < 0)
+                throw std::runtime_error("CRAM byte array length is negative");
+            if (hdr.codecs[codec.values].kind == Codec::EXTERNAL)
+                ExternalOf(codec.values).Append(length, dst);
+            else {
+                for (int32_t i = 0; i < length; ++i)
+                    dst.push_back((char)Byte(codec.values));
+            }
+            return;
+        }
+        case Codec::BYTE_ARRAY_STOP:
+            ExternalOf(index).AppendUntil(codec.stop, dst);
+            return;
+        default:
+            throw std::runtime_error("CRAM encoding can't encode byte arrays");
+    }
+}
+
+void SliceDecoder::BytesN(Series const series, size_t const count, char *const dst)
+{
+    int const index = hdr.series[series];
+
+    if (index < 0)
+        NoCodec(series);
+    if (hdr.codecs[index].kind == Codec::EXTERNAL) {
+        External &ext = ExternalOf(index);
+
+        if (ext.data.size() - ext.pos < count)
+            Truncated("external data block");
+        memcpy(dst, &ext.data[ext.pos], count);
+        ext.pos += count;
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = (char)Byte(index);
+}
+
+/* Tag
+ *  appends a tag as BAM has it: its name, its type and its value, which
+ *  is what its encoding gives
+ */
+void SliceDecoder::Tag(int32_t const key, std::string &aux)
+{
+    std::map<int32_t, int>::const_iterator const i = hdr.tags.find(key);
+
+    if (i == hdr.tags.end())
+        throw std::runtime_error("CRAM tag has no encoding");
+    aux.push_back((char)(key >> 16));
+    aux.push_back((char)(key >> 8));
+    aux.push_back((char)key);
+
+    Codec const &codec = hdr.codecs[i->second];
+
+    if (codec.kind != Codec::EXTERNAL) {
+        Bytes(i->second, aux);
+        return;
+    }
+
+    /* a value of its own block, measured by its type */
+    External &ext = ExternalOf(i->second);
+    char const type = (char)key;
+
+    switch (type) {
+        case 'A': case 'c': case 'C':
+            ext.Append(1, aux);
+            break;
+        case 's': case 'S':
+            ext.Append(2, aux);
+            break;
+        case 'i': case 'I': case 'f':
+            ext.Append(4, aux);
+            break;
+        case 'Z': case 'H':
+            ext.AppendUntil(0, aux);
+            aux.push_back('\0');
+            break;
+        default:
+            throw std::runtime_error("CRAM tag of an external block has an unknown size");
+    }
+}
+
+/* HasTag
+ *  whether the tags, as BAM has them, have one of this name
+ */
+static bool HasTag(std::string const &aux, char const c1, char const c2)
+{
+    size_t at = 0;
+
+    while (at + 3 <= aux.size()) {
+        if (aux[at] == c1 && aux[at + 1] == c2)
+            return true;
+
+        char const type = aux[at + 2];
+
+        at += 3;
+        switch (type) {
+            case 'A': case 'c': case 'C':
+                at += 1;
+                break;
+            case 's': case 'S':
+                at += 2;
+                break;
+            case 'i': case 'I': case 'f':
+                at += 4;
+                break;
+            case 'Z': case 'H':
+                while (at < aux.size() && aux[at] != '\0')
+                    ++at;
+                ++at;
+                break;
+            case 'B': {
+                if (at + 5 > aux.size())
+                    return false;
+
+                char const sub = aux[at];
+                uint32_t const n = (uint8_t)aux[at + 1] | ((uint8_t)aux[at + 2] << 8)
+                                 | ((uint8_t)aux[at + 3] << 16) | ((uint32_t)(uint8_t)aux[at + 4] << 24);
+                unsigned const width = (sub == 'c' || sub == 'C') ? 1 : (sub == 's' || sub == 'S') ? 2 : 4;
+
+                at += 5 + (size_t)n * width;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+/* Reference
+ *  the bases of [beg, end), 0-based, of reference refID, upper case;
+ *  NULL if they aren't known
+ */
+char const *SliceDecoder::Reference(int32_t const refID, int64_t const beg, int64_t const end)
+{
+    if (beg < 0 || end < beg)
+        return 0;
+    if (embedded) {
+        if (refID != windowRef || beg < windowStart || end > windowStart + (int64_t)window.size())
+            return 0;
+        return window.data() + (beg - windowStart);
+    }
+    if (refID == windowRef && beg >= windowStart && end <= windowStart + (int64_t)window.size())
+        return window.data() + (beg - windowStart);
+
+    int const seq = file.getSequence(refID);
+
+    if (seq < 0)
+        return 0;
+
+    /* fetch a little more, for the records that follow */
+    IndexedFasta const &fasta = file.getFasta();
+    uint64_t const length = fasta.getLength(seq);
+    int64_t const want = end - beg < 65536 ? 65536 : end - beg;
+
+    if ((uint64_t)end > length)
+        return 0;
+    fasta.Copy(seq, beg, want, window);
+    for (size_t i = 0; i < window.size(); ++i) {
+        char const c = window[i];
+
+        if (c >= 'a' && c <= 'z')
+            window[i] = c - 'a' + 'A';
+    }
+    windowRef = refID;
+    windowStart = beg;
+    return window.data();
+}
+
+static void AddCigar(std::vector<uint32_t> &cigar, unsigned const op, uint32_t const length)
+{
+    if (length == 0)
+        return;
+    if (!cigar.empty() && (cigar.back() & 0x0F) == op)
+        cigar.back() += length << 4;
+    else
+        cigar.push_back((length << 4) | op);
+}
+
+static unsigned BaseIndex(char const base)
+{
+    switch (base) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return 4;
+    }
+}
+
+/* Feature
+ *  a read feature: its code, its 1-based position in the read and
+ *  its value, a number or bytes
+ */
+struct Feature
+{
+    char code;
+    int32_t pos;
+    int32_t value;
+    std::string bytes;
+};
+
+/* Features
+ *  the read features of a mapped record, and the bases between them
+ *  from the reference; its bases, qualities and CIGAR are made from them
+ */
+void SliceDecoder::Features(Record &rec, int32_t const readLength)
+{
+    int32_t const count = Int(FN);
+    int32_t position = 0;           /* of the previous feature, 1-based */
+    int64_t refPos = rec.pos - 1;   /* 0-based */
+    int32_t seqPos = 0;             /* bases made so far */
+    std::vector<Feature> features((size_t)(count < 0 ? 0 : count));
+    int64_t refEnd = refPos;
+
+    /* all of them first, since their lengths give the reference span */
+    for (int32_t i = 0; i < count; ++i) {
+        Feature &f = features[i];
+
+        f.code = (char)Byte(FC);
+        position += Int(FP);
+        f.pos = position;
+        f.value = 0;
+        switch (f.code) {
+            case 'B':
+                f.bytes.push_back((char)Byte(BA));
+                f.value = Byte(QS);
+                break;
+            case 'X':
+                f.value = Byte(BS);
+                break;
+            case 'D':
+                f.value = Int(DL);
+                break;
+            case 'I':
+                Bytes(IN, f.bytes);
+                break;
+            case 'i':
+                f.bytes.push_back((char)Byte(BA));
+                break;
+            case 'b':
+                Bytes(BB, f.bytes);
+                break;
+            case 'q':
+                Bytes(QQ, f.bytes);
+                break;
+            case 'Q':
+                f.value = Byte(QS);
+                break;
+            case 'H':
+                f.value = Int(HC);
+                break;
+            case 'S':
+                Bytes(SC, f.bytes);
+                break;
+            case 'P':
+                f.value = Int(PD);
+                break;
+            case 'N':
+                f.value = Int(RS);
+                break;
+            default:
+                throw std::runtime_error(std::string("CRAM read feature ") + f.code + " is not known");
+        }
+    }
+    {
+        /* the reference span: matches and what the features take */
+        int64_t span = 0;
+        int32_t at = 1;
+
+        for (int32_t i = 0; i < count; ++i) {
+            Feature const &f = features[i];
+
+            if (f.pos > at) {
+                span += f.pos - at;
+                at = f.pos;
+            }
+            switch (f.code) {
+                case 'B': case 'X':
+                    ++span;
+                    ++at;
+                    break;
+                case 'b':
+                    span += f.bytes.size();
+                    at += (int32_t)f.bytes.size();
+                    break;
+                case 'I': case 'S':
+                    at += (int32_t)f.bytes.size();
+                    break;
+                case 'i':
+                    ++at;
+                    break;
+                case 'D': case 'N':
+                    span += f.value;
+                    break;
+            }
+        }
+        if (at <= readLength)
+            span += readLength - at + 1;
+        refEnd = refPos + span;
+    }
+
+    char const *const ref = Reference(rec.refID, refPos, refEnd);
+
+    if (ref == 0 && hdr.referenceRequired && (file.getOptions().fields & NGS_BAM::OpenOptions::bases) != 0)
+        throw std::runtime_error("the reference bases of '" + file.getReference(rec.refID).name
+                                 + "' are needed to decode " + file.getPath()
+                                 + "; give them with the referenceFasta option");
+
+    rec.seq.assign((size_t)readLength, 'N');
+    rec.qual.assign((size_t)readLength, (char)0xFF);
+    rec.cigar.clear();
+
+    int64_t const refBase = refPos;
+
+    for (int32_t i = 0; i <= count; ++i) {
+        /* the matches before the feature, or up to the end */
+        int32_t const upTo = i < count ? features[i].pos - 1 : readLength;
+
+        if (upTo > seqPos) {
+            int32_t const n = upTo - seqPos;
+
+            if (upTo > readLength)
+                throw std::runtime_error("CRAM read feature is past the end of its read");
+            if (ref)
+                memcpy(&rec.seq[seqPos], ref + (refPos - refBase), n);
+            AddCigar(rec.cigar, 0, n);
+            seqPos += n;
+            refPos += n;
+        }
+        if (i == count)
+            break;
+
+        Feature const &f = features[i];
+        int32_t const n = (int32_t)f.bytes.size();
+
+        int32_t const bases = f.code == 'X' || f.code == 'B' || f.code == 'i' ? 1
+                            : f.code == 'b' || f.code == 'I' || f.code == 'S' ? n : 0;
+        int32_t const quals = f.code == 'q' ? n : f.code == 'Q' ? 1 : 0;
+
+        if (seqPos + bases > readLength || (quals > 0 && (f.pos < 1 || f.pos - 1 + quals > readLength)))
+            throw std::runtime_error("CRAM read feature is past the end of its read");
+        switch (f.code) {
+            case 'X': {
+                char const base = ref ? ref[refPos - refBase] : 'N';
+
+                rec.seq[seqPos] = hdr.substitutions[BaseIndex(base)][f.value & 3];
+                AddCigar(rec.cigar, 0, 1);
+                ++seqPos;
+                ++refPos;
+                break;
+            }
+            case 'B':
+                rec.seq[seqPos] = f.bytes[0];
+                rec.qual[seqPos] = (char)f.value;
+                AddCigar(rec.cigar, 0, 1);
+                ++seqPos;
+                ++refPos;
+                break;
+            case 'b':
+                memcpy(&rec.seq[seqPos], f.bytes.data(), n);
+                AddCigar(rec.cigar, 0, n);
+                seqPos += n;
+                refPos += n;
+                break;
+            case 'I':
+            case 'S':
+                memcpy(&rec.seq[seqPos], f.bytes.data(), n);
+                AddCigar(rec.cigar, f.code == 'I' ? 1 : 4, n);
+                seqPos += n;
+                break;
+            case 'i':
+                rec.seq[seqPos] = f.bytes[0];
+                AddCigar(rec.cigar, 1, 1);
+                ++seqPos;
+                break;
+            case 'D':
+            case 'N':
+                AddCigar(rec.cigar, f.code == 'D' ? 2 : 3, f.value);
+                refPos += f.value;
+                break;
+            case 'H':
+                AddCigar(rec.cigar, 5, f.value);
+                break;
+            case 'P':
+                AddCigar(rec.cigar, 6, f.value);
+                break;
+            case 'q':
+                memcpy(&rec.qual[f.pos - 1], f.bytes.data(), n);
+                break;
+            case 'Q':
+                rec.qual[f.pos - 1] = (char)f.value;
+                break;
+        }
+    }
+    rec.end = refPos > rec.pos - 1 ? refPos : rec.pos;
+}
+
+/* LinkMates
+ *  the mate fields of the records whose mates are in the slice, and
+ *  the template lengths of those, from the extent of the template;
+ *  the leftmost of them has it positive, or the first read of those
+ *  at the leftmost position
+ */
+void SliceDecoder::LinkMates()
+{
+    int32_t const n = (int32_t)records.size();
+
+    for (int32_t r = 0; r < n; ++r) {
+        Record &cr = records[r];
+
+        if (cr.mateLine < 0)
+            continue;
+        if (cr.mateLine >= n)
+            throw std::runtime_error("CRAM record's mate is past the end of its slice");
+        if (!cr.tlenKnown) {
+            int64_t left = cr.pos;
+            int64_t right = cr.end;
+            int32_t ref = cr.refID;
+            int leftCount = 0;
+            int32_t id = r;
+
+            for ( ; ; ) {
+                Record &m = records[id];
+
+                if (left > m.pos) {
+                    left = m.pos;
+                    leftCount = 1;
+                }
+                else if (left == m.pos)
+                    ++leftCount;
+                if (right < m.end)
+                    right = m.end;
+                if (m.mateLine < 0) {
+                    m.mateLine = r;
+                    break;
+                }
+                if (m.mateLine <= id || m.mateLine >= n)
+                    throw std::runtime_error("CRAM record's mate is invalid");
+                id = m.mateLine;
+                if (records[id].refID != ref)
+                    ref = -1;
+                if (id == r)
+                    break;
+            }
+
+            int64_t const tlen = ref < 0 ? 0 : right - left + 1;
+
+            id = r;
+            do {
+                Record &m = records[id];
+
+                if (tlen == 0 || m.pos != left)
+                    m.tlen = -tlen;
+                else
+                    m.tlen = (leftCount == 1 || (m.flag & 0x40) != 0) ? tlen : -tlen;
+                m.tlenKnown = true;
+                id = m.mateLine;
+            } while (id != r);
+        }
+
+        Record const &mate = records[cr.mateLine];
+
+        cr.mateRef = mate.refID;
+        cr.matePos = mate.pos;
+        cr.flag |= 0x01;
+        if (mate.flag & 0x04) {
+            cr.flag |= 0x08;
+            cr.tlen = 0;
+        }
+        if (cr.flag & 0x04)
+            cr.tlen = 0;
+        if (mate.flag & 0x10)
+            cr.flag |= 0x20;
+    }
+}
+
+/* SeqCodes
+ *  the 4 bit code of BAM of each base
+ */
+static struct SeqCodes
+{
+    uint8_t code[256];
+
+    SeqCodes() {
+        static char const codes[] = "=ACMGRSVTWYHKDBN";
+
+        memset(code, 15, sizeof(code));
+        for (unsigned i = 0; i < 16; ++i) {
+            code[(uint8_t)codes[i]] = i;
+            code[(uint8_t)tolower(codes[i])] = i;
+        }
+    }
+} const seqCodes;
+
+/* Pack
+ *  a record as BAM has it
+ */
+void SliceDecoder::Pack(Record const &rec, CRAMSlice &into) const
+{
+    uint8_t const *const table = seqCodes.code;
+
+    size_t const nameLen = rec.name.size() + 1;
+
+    if (nameLen > 255)
+        throw std::runtime_error("CRAM read name is too long");
+
+    uint32_t const seqLen = (rec.cf & CF_NO_SEQ) != 0 ? 0 : (uint32_t)rec.seq.size();
+    uint32_t const size = BAMLayout::length_fixed_part + (uint32_t)nameLen + 4u * (uint32_t)rec.cigar.size()
+                        + (seqLen + 1) / 2 + seqLen + (uint32_t)rec.aux.size();
+    uint8_t *const dst = into.Add(size, rec.mateLine);
+    int32_t const pos = (int32_t)(rec.pos - 1);
+    int32_t const end = rec.end > rec.pos ? (int32_t)rec.end : pos + 1;
+    uint32_t const bin = BAMIndexBuilder::Bin(pos < 0 ? -1 : pos, pos < 0 ? 0 : end);
+    uint32_t const fixed[8] = {
+        (uint32_t)rec.refID,
+        (uint32_t)pos,
+        (uint32_t)nameLen | ((uint32_t)(rec.mapq & 0xFF) << 8) | (bin << 16),
+        (uint32_t)rec.cigar.size() | (rec.flag << 16),
+        seqLen,
+        (uint32_t)rec.mateRef,
+        (uint32_t)(rec.matePos - 1),
+        (uint32_t)(int32_t)rec.tlen
+    };
+    uint8_t *p = dst;
+
+    for (unsigned i = 0; i < 8; ++i) {
+        p[0] = (uint8_t)fixed[i];
+        p[1] = (uint8_t)(fixed[i] >> 8);
+        p[2] = (uint8_t)(fixed[i] >> 16);
+        p[3] = (uint8_t)(fixed[i] >> 24);
+        p += 4;
+    }
+    memcpy(p, rec.name.c_str(), nameLen);
+    p += nameLen;
+    for (size_t i = 0; i < rec.cigar.size(); ++i) {
+        uint32_t const op = rec.cigar[i];
+
+        p[0] = (uint8_t)op;
+        p[1] = (uint8_t)(op >> 8);
+        p[2] = (uint8_t)(op >> 16);
+        p[3] = (uint8_t)(op >> 24);
+        p += 4;
+    }
+    for (uint32_t i = 0; i < seqLen; i += 2) {
+        uint8_t const hi = table[(uint8_t)rec.seq[i]];
+        uint8_t const lo = i + 1 < seqLen ? table[(uint8_t)rec.seq[i + 1]] : 0;
+
+        *p++ = (uint8_t)((hi << 4) | lo);
+    }
+    if (seqLen)
+        memcpy(p, rec.qual.data(), seqLen);
+    p += seqLen;
+    if (!rec.aux.empty())
+        memcpy(p, rec.aux.data(), rec.aux.size());
+}
+
+unsigned SliceDecoder::Decode(uint8_t const *const data, size_t const size, CRAMSlice &into)
+{
+    bool const verifyCRC = file.getOptions().verifyCRC;
+    CRAMBytes in(data, size);
+    Block block;
+
+    ReadBlock(in, verifyCRC, block);
+    if (block.type != SLICE_HEADER)
+        throw std::runtime_error("CRAM slice doesn't start with its header");
+
+    CRAMBytes sh(block.data.empty() ? 0 : &block.data[0], block.data.size());
+    int32_t const sliceRef = sh.ITF8();
+    int32_t const sliceStart = sh.ITF8();
+    sh.ITF8();                      /* its span */
+    int32_t const count = sh.ITF8();
+    int64_t const counter = sh.LTF8();
+    int32_t const blocks = sh.ITF8();
+
+    for (int32_t n = sh.ITF8(); n > 0 && !sh.overrun; --n)
+        sh.ITF8();
+
+    int32_t const embeddedID = sh.ITF8();
+
+    if (sh.overrun || count < 0 || blocks < 0)
+        Truncated("slice header");
+
+    /* the core block and the external ones */
+    Block core;
+    bool haveCore = false;
+
+    for (int32_t i = 0; i < blocks; ++i) {
+        Block b;
+
+        ReadBlock(in, verifyCRC, b);
+        if (b.type == CORE_DATA) {
+            core.data.swap(b.data);
+            haveCore = true;
+        }
+        else if (b.type == EXTERNAL_DATA)
+            externals[b.id].data.swap(b.data);
+    }
+    if (haveCore)
+        this->core.Reset(core.data.empty() ? 0 : &core.data[0], core.data.size());
+
+    byCodec.assign(hdr.codecs.size(), (External *)0);
+    for (size_t i = 0; i < hdr.codecs.size(); ++i) {
+        Codec const &codec = hdr.codecs[i];
+
+        if (codec.kind == Codec::EXTERNAL || codec.kind == Codec::BYTE_ARRAY_STOP) {
+            std::map<int32_t, External>::iterator const ext = externals.find(codec.external);
+
+            if (ext != externals.end())
+                byCodec[i] = &ext->second;
+        }
+    }
+    if (embeddedID >= 0) {
+        std::map<int32_t, External>::const_iterator const ext = externals.find(embeddedID);
+
+        if (ext == externals.end())
+            throw std::runtime_error("CRAM slice lacks its embedded reference");
+        window.assign(ext->second.data.begin(), ext->second.data.end());
+        for (size_t i = 0; i < window.size(); ++i)
+            window[i] = (char)toupper((unsigned char)window[i]);
+        windowRef = sliceRef;
+        windowStart = sliceStart - 1;
+        embedded = true;
+    }
+
+    records.resize((size_t)count);
+
+    int64_t lastPos = sliceStart;
+
+    for (int32_t r = 0; r < count; ++r) {
+        Record &rec = records[r];
+
+        rec.flag = (uint32_t)Int(BF);
+        rec.cf = (uint32_t)Int(CF);
+        rec.refID = sliceRef == -2 ? Int(RI) : sliceRef;
+
+        int32_t const readLength = Int(RL);
+        int32_t const ap = Int(AP);
+
+        if (readLength < 0)
+            throw std::runtime_error("CRAM read length is negative");
+        if (hdr.deltaPositions) {
+            rec.pos = lastPos + ap;
+            lastPos = rec.pos;
+        }
+        else
+            rec.pos = ap;
+        rec.readGroup = Int(RG);
+        rec.name.clear();
+        if (hdr.readNames)
+            Bytes(RN, rec.name);
+        rec.mateRef = -1;
+        rec.matePos = 0;
+        rec.tlen = 0;
+        rec.tlenKnown = true;
+        rec.mateLine = -1;
+        if (rec.cf & CF_DETACHED) {
+            int32_t const mf = Int(MF);
+
+            if (mf & 1)
+                rec.flag |= 0x20;
+            if (mf & 2)
+                rec.flag |= 0x08;
+            if (!hdr.readNames)
+                Bytes(RN, rec.name);
+            rec.mateRef = Int(NS);
+            rec.matePos = Int(NP);
+            rec.tlen = Int(TS);
+        }
+        else if (rec.cf & CF_MATE_DOWNSTREAM) {
+            rec.mateLine = r + 1 + Int(NF);
+            rec.tlenKnown = false;
+        }
+
+        /* the tags of its line of the dictionary */
+        rec.aux.clear();
+
+        int32_t const line = Int(TL);
+
+        if (line < 0 || (size_t)line >= hdr.tagLines.size()) {
+            if (!hdr.tagLines.empty() || line != 0)
+                throw std::runtime_error("CRAM tag line is not in the dictionary");
+        }
+        else {
+            std::vector<int32_t> const &tags = hdr.tagLines[line];
+
+            for (size_t t = 0; t < tags.size(); ++t)
+                Tag(tags[t], rec.aux);
+        }
+
+        if ((rec.flag & 0x04) == 0) {
+            Features(rec, readLength);
+            rec.mapq = Int(MQ);
+            if (rec.cf & CF_QUAL_ARRAY) {
+                if (readLength)
+                    BytesN(QS, readLength, &rec.qual[0]);
+            }
+        }
+        else {
+            rec.cigar.clear();
+            rec.mapq = 0;
+            rec.end = rec.pos;
+            rec.seq.assign((size_t)readLength, 'N');
+            rec.qual.assign((size_t)readLength, (char)0xFF);
+            if ((rec.cf & CF_NO_SEQ) == 0 && readLength)
+                BytesN(BA, readLength, &rec.seq[0]);
+            if ((rec.cf & CF_QUAL_ARRAY) != 0 && readLength)
+                BytesN(QS, readLength, &rec.qual[0]);
+        }
+
+        /* the read group as a tag, unless it has one */
+        if (rec.readGroup >= 0 && (unsigned)rec.readGroup < file.countOfReadGroups()) {
+            if (!HasTag(rec.aux, 'R', 'G')) {
+                std::string const &id = file.getReadGroupName(rec.readGroup);
+
+                rec.aux.append("RGZ", 3);
+                rec.aux.append(id.c_str(), id.size() + 1);
+            }
+        }
+    }
+    LinkMates();
+
+    /* names the file doesn't keep: of the first record of a template */
+    if (!hdr.readNames) {
+        for (int32_t r = 0; r < count; ++r) {
+            Record &rec = records[r];
+
+            if (!rec.name.empty())
+                continue;
+
+            char buffer[32];
+
+            snprintf(buffer, sizeof(buffer), "%lld", (long long)(counter + r + 1));
+            rec.name = buffer;
+            for (int32_t m = rec.mateLine; m > r && records[m].name.empty(); m = records[m].mateLine)
+                records[m].name = rec.name;
+        }
+    }
+    for (int32_t r = 0; r < count; ++r) {
+        Record const &rec = records[r];
+
+        if (rec.name.empty())
+            records[r].name = "*";
+        Pack(records[r], into);
+    }
+    return (unsigned)count;
+}
+
+/* ReadFully
+ *  "length" bytes at fpos, or those up to the end of the file
+ */
+static size_t ReadFully(ByteSource &src, uint64_t const fpos, uint8_t *const dst, size_t const length)
+{
+    size_t got = 0;
+
+    while (got < length) {
+        size_t const n = src.Read(fpos + got, dst + got, length - got);
+
+        if (n == 0)
+            break;
+        got += n;
+    }
+    return got;
+}
+
+/* ReadContainerHeader
+ *  the header of the container at fpos, and its size; false at the end
+ *  of the file
+ */
+static bool ReadContainerHeader(ByteSource &src, uint64_t const fpos, bool const verifyCRC,
+                                CRAMContainer &into, size_t &headerSize)
+{
+    std::vector<uint8_t> buffer(CRAM_HEADER_PEEK);
+
+    for ( ; ; ) {
+        size_t const got = ReadFully(src, fpos, &buffer[0], buffer.size());
+
+        if (got == 0)
+            return false;
+
+        CRAMBytes in(&buffer[0], got);
+        int32_t const length = in.Int32();
+
+        into.fpos = fpos;
+        into.refID = in.ITF8();
+        into.start = in.ITF8();
+        into.span = in.ITF8();
+        into.records = in.ITF8();
+        into.counter = in.LTF8();
+        in.LTF8();
+        in.ITF8();
+        into.landmarks.clear();
+        for (int32_t n = in.ITF8(); n > 0 && !in.overrun; --n)
+            into.landmarks.push_back(in.ITF8());
+
+        size_t const crcAt = got - in.left();
+        uint32_t const expect = (uint32_t)in.Int32();
+
+        if (!in.overrun && verifyCRC && crc32(0, &buffer[0], (uInt)crcAt) != expect)
+            throw std::runtime_error("CRAM container header CRC mismatch");
+        if (!in.overrun) {
+            if (length < 0)
+                throw std::runtime_error("CRAM container length is negative");
+            into.length = (uint32_t)length;
+            headerSize = got - in.left();
+            into.next = fpos + headerSize + into.length;
+            return true;
+        }
+        if (got < buffer.size())
+            Truncated("container header");
+        buffer.resize(buffer.size() * 2);
+    }
+}
+
+static bool IsEOFContainer(CRAMContainer const &container)
+{
+    return container.refID == -1 && container.start == CRAM_EOF_START && container.records == 0;
+}
+
+bool CRAMFile::ReadContainer(ByteSource &src, uint64_t const fpos, std::vector<uint32_t> const *const slices,
+                             CRAMContainer &into) const
+{
+    size_t headerSize = 0;
+
+    if (!ReadContainerHeader(src, fpos, options.verifyCRC, into, headerSize) || IsEOFContainer(into))
+        return false;
+
+    uint64_t const data = fpos + headerSize;
+    std::vector<int32_t> const &landmarks = into.landmarks;
+    size_t const N = landmarks.size();
+
+    into.header.clear();
+    into.sliceAt.clear();
+    into.slices.clear();
+    if (N == 0 || into.records == 0)
+        return true;
+    for (size_t i = 0; i < N; ++i) {
+        if (landmarks[i] < 0 || (uint32_t)landmarks[i] > into.length || (i > 0 && landmarks[i] < landmarks[i - 1]))
+            throw std::runtime_error("CRAM container has an invalid slice landmark");
+    }
+
+    if (slices == 0) {
+        /* all of it, in one read */
+        std::vector<uint8_t> all(into.length);
+
+        if (into.length > 0 && ReadFully(src, data, &all[0], into.length) != into.length)
+            Truncated("container");
+        into.header.assign(all.begin(), all.begin() + landmarks[0]);
+        into.slices.resize(N);
+        for (size_t i = 0; i < N; ++i) {
+            uint32_t const end = i + 1 < N ? (uint32_t)landmarks[i + 1] : into.length;
+
+            into.sliceAt.push_back(landmarks[i]);
+            into.slices[i].assign(all.begin() + landmarks[i], all.begin() + end);
+        }
+        return true;
+    }
+
+    into.header.resize(landmarks[0]);
+    if (landmarks[0] > 0 && ReadFully(src, data, &into.header[0], landmarks[0]) != (size_t)landmarks[0])
+        Truncated("container");
+    for (size_t k = 0; k < slices->size(); ++k) {
+        uint32_t const at = (*slices)[k];
+        std::vector<int32_t>::const_iterator const i = std::find(landmarks.begin(), landmarks.end(), (int32_t)at);
+
+        if (i == landmarks.end())
+            throw std::runtime_error("CRAM index has a slice that its container doesn't");
+
+        size_t const which = i - landmarks.begin();
+        uint32_t const end = which + 1 < N ? (uint32_t)landmarks[which + 1] : into.length;
+        std::vector<uint8_t> slice(end - at);
+
+        if (!slice.empty() && ReadFully(src, data + at, &slice[0], slice.size()) != slice.size())
+            Truncated("slice");
+        into.sliceAt.push_back(at);
+        into.slices.push_back(std::vector<uint8_t>());
+        into.slices.back().swap(slice);
+    }
+    return true;
+}
+
+void CRAMFile::Decode(CRAMContainer const &container, CRAMSliceList &into) const
+{
+    if (container.slices.empty() || container.header.empty())
+        return;
+
+    CompressionHeader hdr;
+    CRAMBytes in(&container.header[0], container.header.size());
+    Block block;
+    uint64_t records = 0;
+
+    ReadBlock(in, options.verifyCRC, block);
+    ReadCompressionHeader(block, hdr);
+    for (size_t i = 0; i < container.slices.size(); ++i) {
+        std::vector<uint8_t> const &data = container.slices[i];
+        SliceDecoder decoder(*this, hdr);
+
+        into.push_back(CRAMSlice());
+        into.back().container = container.fpos;
+        into.back().slice = container.sliceAt[i];
+        records += decoder.Decode(data.empty() ? 0 : &data[0], data.size(), into.back());
+    }
+    __atomic_fetch_add(&containersDecoded, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&slicesDecoded, container.slices.size(), __ATOMIC_RELAXED);
+    __atomic_fetch_add(&recordsDecoded, records, __ATOMIC_RELAXED);
+}
+
+void CRAMFile::getDecodeCounts(uint64_t &containers, uint64_t &slices, uint64_t &records) const
+{
+    containers = __atomic_load_n(&containersDecoded, __ATOMIC_RELAXED);
+    slices = __atomic_load_n(&slicesDecoded, __ATOMIC_RELAXED);
+    records = __atomic_load_n(&recordsDecoded, __ATOMIC_RELAXED);
+}
+
+bool CRAMFile::isCRAM(std::string const &filepath)
+{
+    if (ByteSource::IsStream(filepath))
+        return false;
+
+    ByteSource *src = 0;
+
+    try {
+        src = ByteSource::Open(filepath);
+    }
+    catch (...) {
+        return false;
+    }
+
+    char magic[4];
+    size_t const got = ReadFully(*src, 0, (uint8_t *)magic, 4);
+
+    delete src;
+    return got == 4 && memcmp(magic, "CRAM", 4) == 0;
+}
+
+/* PoolConfigured
+ *  as for BAM files, the options after asking for their poolThreads
+ */
+static NGS_BAM::OpenOptions const &PoolConfigured(NGS_BAM::OpenOptions const &options)
+{
+    if (options.poolThreads > 0)
+        ngs::WorkPool::configure(options.poolThreads);
+    return options;
+}
+
+CRAMFile::CRAMFile(std::string const &filepath, NGS_BAM::OpenOptions const &Options)
+: path(filepath)
+, options(PoolConfigured(Options))
+, source(0)
+, major(0)
+, minor(0)
+, firstContainer(0)
+, haveIndexFile(false)
+, containersDecoded(0)
+, slicesDecoded(0)
+, recordsDecoded(0)
+{
+    if (ByteSource::IsStream(filepath))
+        throw std::runtime_error("CRAM files can't be read as a stream: " + filepath);
+    source = ByteSource::Open(filepath);
+    try {
+        ReadDefinition();
+        ReadHeader();
+        ParseHeader();
+        OpenFasta();
+        if (!LoadIndex(path + ".crai"))
+            ScanIndex();
+    }
+    catch (...) {
+        delete source;
+        throw;
+    }
+}
+
+CRAMFile::~CRAMFile()
+{
+    delete source;
+}
+
+void CRAMFile::ReadDefinition()
+{
+    uint8_t def[CRAM_DEFINITION_SIZE];
+
+    if (ReadFully(*source, 0, def, sizeof(def)) != sizeof(def) || memcmp(def, "CRAM", 4) != 0)
+        throw std::runtime_error(path + " is not a CRAM file");
+    major = def[4];
+    minor = def[5];
+    if (major != 3)
+        throw std::runtime_error(path + ": only CRAM version 3 is supported");
+}
+
+/* ReadHeader
+ *  the SAM header, of the file's first container
+ */
+void CRAMFile::ReadHeader()
+{
+    CRAMContainer container;
+    size_t headerSize = 0;
+
+    if (!ReadContainerHeader(*source, CRAM_DEFINITION_SIZE, options.verifyCRC, container, headerSize))
+        Truncated("file header");
+
+    std::vector<uint8_t> data(container.length);
+
+    if (!data.empty() && ReadFully(*source, CRAM_DEFINITION_SIZE + headerSize, &data[0], data.size()) != data.size())
+        Truncated("file header");
+    firstContainer = container.next;
+
+    CRAMBytes in(data.empty() ? 0 : &data[0], data.size());
+    Block block;
+
+    ReadBlock(in, options.verifyCRC, block);
+
+    CRAMBytes text(block.data.empty() ? 0 : &block.data[0], block.data.size());
+    int32_t const length = text.Int32();
+    uint8_t const *const chars = text.Bytes(length < 0 ? 0 : length);
+
+    if (chars == 0)
+        Truncated("SAM header");
+    headerText.assign((char const *)chars, length);
+
+    /* some writers pad the text */
+    size_t const nul = headerText.find('\0');
+
+    if (nul != std::string::npos)
+        headerText.resize(nul);
+}
+
+/* Field
+ *  the value of tag "tag" of a header line, without its tag
+ */
+static bool Field(std::string const &line, char const tag[3], std::string &value)
+{
+    size_t at = 0;
+
+    while ((at = line.find('\t', at)) != std::string::npos) {
+        ++at;
+        if (line.compare(at, 3, std::string(tag) + ":") == 0) {
+            size_t const end = line.find('\t', at);
+
+            value = line.substr(at + 3, end == std::string::npos ? std::string::npos : end - at - 3);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CRAMFile::ParseHeader()
+{
+    size_t at = 0;
+
+    while (at < headerText.size()) {
+        size_t end = headerText.find('\n', at);
+
+        if (end == std::string::npos)
+            end = headerText.size();
+
+        std::string line = headerText.substr(at, end - at);
+
+        at = end + 1;
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.resize(line.size() - 1);
+        if (line.compare(0, 3, "@SQ") == 0) {
+            CRAMReference ref;
+            std::string length;
+
+            if (!Field(line, "SN", ref.name))
+                throw std::runtime_error(path + ": @SQ header line lacks SN");
+            ref.length = Field(line, "LN", length) ? strtoull(length.c_str(), 0, 10) : 0;
+            Field(line, "UR", ref.uri);
+            byName[ref.name] = (unsigned)references.size();
+            references.push_back(ref);
+        }
+        else if (line.compare(0, 3, "@RG") == 0) {
+            std::string id;
+
+            if (Field(line, "ID", id))
+                readGroups.push_back(id);
+        }
+    }
+}
+
+int CRAMFile::FindReference(std::string const &name) const
+{
+    std::map<std::string, unsigned>::const_iterator const i = byName.find(name);
+
+    return i == byName.end() ? -1 : (int)i->second;
+}
+
+int CRAMFile::FindReadGroup(std::string const &name) const
+{
+    for (size_t i = 0; i < readGroups.size(); ++i) {
+        if (readGroups[i] == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+/* OpenFasta
+ *  as for BAM files, with the UR of the first @SQ line as the last resort
+ *  a reference is only given bases by a sequence of its name and length
+ */
+void CRAMFile::OpenFasta()
+{
+    if (!options.referenceFasta.empty()) {
+        if (!fasta.Open(options.referenceFasta))
+            throw std::runtime_error("The FASTA file '" + options.referenceFasta + "' or its .fai index could not be opened");
+    }
+    else {
+        std::string const base = path.size() > 5 && path.compare(path.size() - 5, 5, ".cram") == 0
+                               ? path.substr(0, path.size() - 5) : path;
+
+        if (!fasta.Open(base + ".fa") && !fasta.Open(base + ".fasta") && !fasta.Open(base + ".fa.gz")) {
+            std::string uri = references.empty() ? std::string() : references[0].uri;
+
+            if (uri.compare(0, 7, "file://") == 0)
+                uri = uri.substr(7);
+            if (uri.empty() || uri.find("://") != std::string::npos || !fasta.Open(uri))
+                return;
+        }
+    }
+
+    unsigned const N = countOfReferences();
+
+    sequences.resize(N, -1);
+    for (unsigned i = 0; i < N; ++i) {
+        int const seq = fasta.Find(references[i].name);
+
+        if (seq >= 0 && fasta.getLength(seq) == references[i].length)
+            sequences[i] = seq;
+    }
+}
+
+static bool ByPosition(CRAMIndexEntry const &a, CRAMIndexEntry const &b)
+{
+    /* -1, the unplaced, go last */
+    uint32_t const ra = (uint32_t)a.refID;
+    uint32_t const rb = (uint32_t)b.refID;
+
+    if (ra != rb)
+        return ra < rb;
+    if (a.start != b.start)
+        return a.start < b.start;
+    return a < b;
+}
+
+/* LoadIndex
+ *  the .crai: gzipped lines of the reference, start, span, container
+ *  position, slice offset and size
+ */
+bool CRAMFile::LoadIndex(std::string const &craipath)
+{
+    ByteSource *src = 0;
+
+    try {
+        src = ByteSource::Open(craipath);
+    }
+    catch (...) {
+        return false;
+    }
+
+    std::vector<uint8_t> raw;
+
+    try {
+        uint8_t buffer[64 * 1024];
+
+        for (uint64_t fpos = 0; ; ) {
+            size_t const n = src->Read(fpos, buffer, sizeof(buffer));
+
+            if (n == 0)
+                break;
+            raw.insert(raw.end(), buffer, buffer + n);
+            fpos += n;
+        }
+    }
+    catch (...) {
+        delete src;
+        throw;
+    }
+    delete src;
+
+    std::string text;
+
+    if (raw.size() >= 2 && raw[0] == 0x1f && raw[1] == 0x8b) {
+        z_stream zs;
+        char out[64 * 1024];
+
+        memset(&zs, 0, sizeof(zs));
+        if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK)
+            throw std::runtime_error("gzip initialization failed");
+        zs.next_in = &raw[0];
+        zs.avail_in = (uInt)raw.size();
+        for ( ; ; ) {
+            zs.next_out = (Bytef *)out;
+            zs.avail_out = sizeof(out);
+
+            int const zrc = inflate(&zs, Z_NO_FLUSH);
+
+            text.append(out, sizeof(out) - zs.avail_out);
+            if (zrc == Z_STREAM_END) {
+                if (zs.avail_in == 0)
+                    break;
+                inflateReset(&zs);
+                continue;
+            }
+            if (zrc != Z_OK) {
+                inflateEnd(&zs);
+                throw std::runtime_error(craipath + " could not be decompressed");
+            }
+        }
+        inflateEnd(&zs);
+    }
+    else
+        text.assign(raw.begin(), raw.end());
+
+    char const *cp = text.c_str();
+
+    while (*cp) {
+        CRAMIndexEntry entry;
+        long long fields[6];
+        int n = 0;
+        char *endp = 0;
+
+        for ( ; n < 6; ++n) {
+            fields[n] = strtoll(cp, &endp, 10);
+            if (endp == cp)
+                break;
+            cp = endp;
+        }
+        if (n == 0 && *cp == '\n') {
+            ++cp;
+            continue;
+        }
+        if (n != 6)
+            throw std::runtime_error(craipath + " is not a valid CRAM index");
+        while (*cp && *cp != '\n')
+            ++cp;
+        if (*cp)
+            ++cp;
+        entry.refID = (int32_t)fields[0];
+        entry.start = fields[1];
+        entry.span = fields[2];
+        entry.container = (uint64_t)fields[3];
+        entry.slice = (uint32_t)fields[4];
+        entry.size = (uint32_t)fields[5];
+        index.push_back(entry);
+    }
+    std::sort(index.begin(), index.end(), ByPosition);
+    haveIndexFile = true;
+    return true;
+}
+
+/* ScanIndex
+ *  an entry for each slice, with the extent of its container, from the
+ *  headers of the containers; those of several references cover all
+ */
+void CRAMFile::ScanIndex()
+{
+    CRAMContainer container;
+    size_t headerSize = 0;
+
+    for (uint64_t fpos = firstContainer; ; fpos = container.next) {
+        if (!ReadContainerHeader(*source, fpos, options.verifyCRC, container, headerSize)
+            || IsEOFContainer(container))
+            break;
+        for (size_t i = 0; i < container.landmarks.size() && container.records > 0; ++i) {
+            CRAMIndexEntry entry;
+            uint32_t const end = i + 1 < container.landmarks.size() ? container.landmarks[i + 1] : container.length;
+
+            entry.refID = container.refID;
+            entry.start = container.refID == -2 ? 0 : container.start;
+            entry.span = container.refID == -2 ? (int64_t)1 << 62 : container.span;
+            entry.container = fpos;
+            entry.slice = container.landmarks[i];
+            entry.size = end - container.landmarks[i];
+            index.push_back(entry);
+        }
+    }
+    std::sort(index.begin(), index.end(), ByPosition);
+}
+
+void CRAMFile::Slices(int32_t const refID, int64_t const beg, int64_t const end, CRAMIndexEntryList &rslt) const
+{
+    rslt.clear();
+    for (CRAMIndexEntryList::const_iterator i = index.begin(); i != index.end(); ++i) {
+        if (i->refID != refID && i->refID != -2)
+            continue;
+        if (i->start - 1 < end && i->start - 1 + i->span > beg)
+            rslt.push_back(*i);
+    }
+    std::sort(rslt.begin(), rslt.end());
+
+    CRAMIndexEntryList::iterator dups = rslt.begin();
+
+    for (CRAMIndexEntryList::const_iterator i = rslt.begin(); i != rslt.end(); ++i) {
+        if (dups == rslt.begin() || (dups - 1)->container != i->container || (dups - 1)->slice != i->slice)
+            *dups++ = *i;
+    }
+    rslt.erase(dups, rslt.end());
+}
+
+/* CRAMReader::Job
+ *  a container, read, and its slices once decoded
+ */
+struct CRAMReader::Job : public ngs::WorkItem
+{
+    CRAMReader &reader;
+    CRAMContainer container;
+    CRAMSliceList slices;
+    size_t taken;
+    bool queued;
+    bool running;
+    bool done;
+    std::string error;
+
+    Job(CRAMReader &Reader) : reader(Reader), taken(0), queued(false), running(false), done(false) {}
+
+    void run() {
+        {
+            CRAMLock lock(reader.mutex);
+
+            queued = false;
+            running = true;
+        }
+        reader.Run(*this);
+    }
+};
+
+static ngs::WorkPool::Priority PoolPriority(NGS_BAM::OpenOptions::Priority const priority)
+{
+    switch (priority) {
+        case NGS_BAM::OpenOptions::low:
+            return ngs::WorkPool::low;
+        case NGS_BAM::OpenOptions::high:
+            return ngs::WorkPool::high;
+        default:
+            return ngs::WorkPool::normal;
+    }
+}
+
+/* StartPool
+ *  the shared pool, if containers are decoded ahead
+ */
+static ngs::WorkPool *StartPool(unsigned const threads)
+{
+    if (threads == 0)
+        return 0;
+    try {
+        return &ngs::WorkPool::shared();
+    }
+    catch (ngs::ErrorMsg const &e) {
+        throw std::runtime_error(e.what());
+    }
+}
+
+CRAMReader::CRAMReader(CRAMFile const &File, uint64_t const fpos)
+: file(File)
+, source(ByteSource::Open(File.getPath()))
+, planned(false)
+, planned_next(0)
+, next(fpos)
+, ended(false)
+, ahead(File.getOptions().threads > 0 ? File.getOptions().threads : 1)
+, pool(0)
+, priority(PoolPriority(File.getOptions().priority))
+{
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&doneCond, 0);
+    try {
+        pool = StartPool(File.getOptions().threads);
+    }
+    catch (...) {
+        pthread_cond_destroy(&doneCond);
+        pthread_mutex_destroy(&mutex);
+        delete source;
+        throw;
+    }
+}
+
+CRAMReader::CRAMReader(CRAMFile const &File, CRAMIndexEntryList const &entries)
+: file(File)
+, source(ByteSource::Open(File.getPath()))
+, plan(entries)
+, planned(true)
+, planned_next(0)
+, next(0)
+, ended(entries.empty())
+, ahead(File.getOptions().threads > 0 ? File.getOptions().threads : 1)
+, pool(0)
+, priority(PoolPriority(File.getOptions().priority))
+{
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&doneCond, 0);
+    try {
+        pool = StartPool(File.getOptions().threads);
+    }
+    catch (...) {
+        pthread_cond_destroy(&doneCond);
+        pthread_mutex_destroy(&mutex);
+        delete source;
+        throw;
+    }
+}
+
+/* ~CRAMReader
+ *  a job that has started is waited for
+ */
+CRAMReader::~CRAMReader()
+{
+    {
+        CRAMLock lock(mutex);
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            Job &job = *jobs[i];
+
+            if (job.queued && pool->cancel(job))
+                job.queued = false;
+            while (job.queued || job.running)
+                pthread_cond_wait(&doneCond, &mutex);
+        }
+    }
+    for (size_t i = 0; i < jobs.size(); ++i)
+        delete jobs[i];
+    pthread_cond_destroy(&doneCond);
+    pthread_mutex_destroy(&mutex);
+    delete source;
+}
+
+/* ReadNext
+ *  the next container into "job"; planned, only the slices of
+ *  the next entries that are of the same container
+ */
+bool CRAMReader::ReadNext(Job &job)
+{
+    size_t const prefetch = file.getOptions().prefetch;
+
+    if (!planned) {
+        if (!file.ReadContainer(*source, next, 0, job.container))
+            return false;
+        next = job.container.next;
+        if (prefetch > 0)
+            source->WillNeed(next, prefetch);
+        return true;
+    }
+    while (planned_next < plan.size()) {
+        uint64_t const container = plan[planned_next].container;
+        std::vector<uint32_t> slices;
+
+        while (planned_next < plan.size() && plan[planned_next].container == container)
+            slices.push_back(plan[planned_next++].slice);
+        if (prefetch > 0 && planned_next < plan.size())
+            source->WillNeed(plan[planned_next].container, prefetch);
+        if (file.ReadContainer(*source, container, &slices, job.container))
+            return true;
+    }
+    return false;
+}
+
+void CRAMReader::Run(Job &job)
+{
+    std::string error;
+
+    try {
+        file.Decode(job.container, job.slices);
+    }
+    catch (std::exception const &e) {
+        error = e.what();
+        if (error.empty())
+            error = "CRAM container could not be decoded";
+    }
+    catch (...) {
+        error = "CRAM container could not be decoded";
+    }
+
+    CRAMLock lock(mutex);
+
+    job.error = error;
+    job.running = false;
+    job.done = true;
+    std::vector<uint8_t>().swap(job.container.header);
+    std::vector<std::vector<uint8_t> >().swap(job.container.slices);
+    pthread_cond_broadcast(&doneCond);
+}
+
+void CRAMReader::Submit(Job &job)
+{
+    {
+        CRAMLock lock(mutex);
+
+        job.queued = true;
+    }
+    try {
+        pool->submit(job, priority);
+    }
+    catch (ngs::ErrorMsg const &) {
+        /* it is decoded when it is wanted */
+        CRAMLock lock(mutex);
+
+        job.queued = false;
+    }
+}
+
+/* Fill
+ *  reads containers until "ahead" are decoding or decoded
+ */
+void CRAMReader::Fill()
+{
+    while (!ended && jobs.size() < ahead) {
+        Job *const job = new Job(*this);
+
+        try {
+            if (!ReadNext(*job)) {
+                delete job;
+                ended = true;
+                break;
+            }
+            jobs.push_back(job);
+        }
+        catch (std::runtime_error const &e) {
+            delete job;
+            throw std::runtime_error(file.getPath() + ": " + e.what());
+        }
+        catch (...) {
+            delete job;
+            throw;
+        }
+        if (pool)
+            Submit(*job);
+    }
+}
+
+/* Finish
+ *  waits for "job" to be decoded; one that hasn't started is taken back
+ *  and decoded here, so that the reader never waits on the pool's queue
+ */
+void CRAMReader::Finish(Job &job)
+{
+    {
+        CRAMLock lock(mutex);
+
+        if (job.queued && pool->cancel(job))
+            job.queued = false;
+        while (job.queued || job.running)
+            pthread_cond_wait(&doneCond, &mutex);
+        if (job.done)
+            return;
+        job.running = true;
+    }
+    Run(job);
+}
+
+bool CRAMReader::Next(CRAMSlice &into)
+{
+    for ( ; ; ) {
+        Fill();
+        if (jobs.empty())
+            return false;
+
+        Job &job = *jobs.front();
+
+        Finish(job);
+        if (!job.error.empty())
+            throw std::runtime_error(file.getPath() + ": " + job.error);
+        if (job.taken < job.slices.size()) {
+            into.swap(job.slices[job.taken++]);
+            if (job.taken == job.slices.size()) {
+                delete jobs.front();
+                jobs.erase(jobs.begin());
+                Fill();
+            }
+            return true;
+        }
+        delete jobs.front();
+        jobs.erase(jobs.begin());
+    }
+}
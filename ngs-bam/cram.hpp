@@ -0,0 +1,349 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_cram_
+#define _hpp_cram_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <ngs-bam/ngs-bam.hpp>
+#include <ngs/WorkPool.hpp>
+
+#include "bam.hpp"
+#include "fasta.hpp"
+
+class ByteSource;
+
+/* CRAMIndexEntry
+ *  a slice, as a line of the .crai has it: the reference and the
+ *  1-based extent of its records, where its container starts in the
+ *  file, and where the slice starts in the container's data, after
+ *  the container's header, and its size; refID -2 is a slice of
+ *  several references, -1 one of unplaced records
+ */
+struct CRAMIndexEntry
+{
+    int32_t refID;
+    int64_t start;
+    int64_t span;
+    uint64_t container;
+    uint32_t slice;
+    uint32_t size;
+
+    bool operator <(CRAMIndexEntry const &rhs) const {
+        if (container != rhs.container)
+            return container < rhs.container;
+        return slice < rhs.slice;
+    }
+};
+typedef std::vector<CRAMIndexEntry> CRAMIndexEntryList;
+
+/* CRAMReference
+ *  an @SQ line of the header
+ */
+struct CRAMReference
+{
+    std::string name;
+    uint64_t length;
+    std::string uri;                /* its UR, if any */
+};
+
+/* CRAMContainer
+ *  a container as it was read: its header, the blocks of its compression
+ *  header, and those of the slices that are to be decoded, each with where
+ *  it starts in the container's data
+ */
+struct CRAMContainer
+{
+    uint64_t fpos;
+    uint64_t next;                  /* where the next one starts */
+    int32_t refID;
+    int64_t start;
+    int64_t span;
+    int32_t records;
+    int64_t counter;                /* of the first record, in the file */
+    std::vector<int32_t> landmarks; /* where the slices start */
+    uint32_t length;                /* of its data */
+    std::vector<uint8_t> header;    /* the compression header block */
+    std::vector<uint32_t> sliceAt;
+    std::vector<std::vector<uint8_t> > slices;
+};
+
+/* CRAMSlice
+ *  the records of a slice, decoded into the layout of BAM records so
+ *  that everything that reads those reads them
+ *  a record's mate is the index of the next record of its template in
+ *  the slice, or -1 if it isn't there
+ */
+class CRAMSlice
+{
+    std::vector<uint64_t> arena;    /* the records, each 8-byte aligned */
+    std::vector<size_t> offsets;    /* into arena, in units of uint64_t */
+    std::vector<int32_t> mates;
+public:
+    uint64_t container;
+    uint32_t slice;
+
+    CRAMSlice() : container(0), slice(0) {}
+
+    size_t count() const {
+        return offsets.size();
+    }
+    BAMRecord const &record(size_t const i) const {
+        return *reinterpret_cast<BAMRecord const *>(&arena[offsets[i]]);
+    }
+    /* raw
+     *  record "i" with its size, to be copied
+     */
+    SizedRawData const &raw(size_t const i) const {
+        return *reinterpret_cast<SizedRawData const *>(&arena[offsets[i]]);
+    }
+    int32_t mate(size_t const i) const {
+        return mates[i];
+    }
+    /* Add
+     *  room for a record of "size" bytes, after its size
+     */
+    uint8_t *Add(uint32_t const size, int32_t const mate) {
+        size_t const at = arena.size();
+        size_t const units = (sizeof(uint32_t) + size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        arena.resize(at + units);
+        offsets.push_back(at);
+        mates.push_back(mate);
+        *reinterpret_cast<uint32_t *>(&arena[at]) = size;
+        return reinterpret_cast<uint8_t *>(&arena[at]) + sizeof(uint32_t);
+    }
+    size_t bytes() const {
+        return arena.size() * sizeof(uint64_t);
+    }
+    void swap(CRAMSlice &other) {
+        arena.swap(other.arena);
+        offsets.swap(other.offsets);
+        mates.swap(other.mates);
+        std::swap(container, other.container);
+        std::swap(slice, other.slice);
+    }
+};
+typedef std::vector<CRAMSlice> CRAMSliceList;
+
+/* CRAMFile
+ *  the file definition, SAM header and index of a CRAM 3.0 file, and
+ *  the reference bases its records are decoded against
+ *
+ *  the index is <path>.crai or, without one, made at open time from the
+ *  headers of the containers, whose extents then stand for their slices'
+ *  the bases come from the FASTA file of OpenOptions::referenceFasta, a
+ *  FASTA file next to <path> as for BAM files, or the file of the UR of
+ *  the first @SQ line, if it is a local one; a slice with a reference of
+ *  its own embedded is decoded against that
+ *
+ *  blocks compressed with gzip, rANS order 0 and 1, and, if built with
+ *  HAVE_BZIP2 and HAVE_LZMA, bzip2 and xz are read; the codecs of
+ *  CRAM 3.1 are not
+ */
+class CRAMFile
+{
+    std::string const path;
+    NGS_BAM::OpenOptions const options;
+    ByteSource *source;             /* for the header and the index only */
+    unsigned major;
+    unsigned minor;
+    std::string headerText;
+    std::vector<CRAMReference> references;
+    std::map<std::string, unsigned> byName;
+    std::vector<std::string> readGroups;    /* IDs of the @RG header lines, in order */
+    uint64_t firstContainer;        /* after the header's */
+    CRAMIndexEntryList index;       /* by reference, then start */
+    bool haveIndexFile;
+    IndexedFasta fasta;
+    std::vector<int> sequences;     /* per reference, its FASTA sequence or -1 */
+
+    /* counted by every decode; only changed atomically */
+    mutable uint64_t containersDecoded;
+    mutable uint64_t slicesDecoded;
+    mutable uint64_t recordsDecoded;
+
+    void ReadDefinition();
+    void ReadHeader();
+    void ParseHeader();
+    bool LoadIndex(std::string const &craipath);
+    void ScanIndex();
+    void OpenFasta();
+
+    CRAMFile(CRAMFile const &);
+    CRAMFile &operator =(CRAMFile const &);
+public:
+    CRAMFile(std::string const &filepath, NGS_BAM::OpenOptions const &options);
+    ~CRAMFile();
+
+    /* isCRAM
+     *  whether the file at filepath starts as a CRAM file does; false
+     *  for a stream, which can't be read twice
+     */
+    static bool isCRAM(std::string const &filepath);
+
+    std::string const &getPath() const {
+        return path;
+    }
+    NGS_BAM::OpenOptions const &getOptions() const {
+        return options;
+    }
+    unsigned getMajorVersion() const {
+        return major;
+    }
+    unsigned getMinorVersion() const {
+        return minor;
+    }
+    std::string const &getHeaderText() const {
+        return headerText;
+    }
+    unsigned countOfReferences() const {
+        return (unsigned)references.size();
+    }
+    CRAMReference const &getReference(unsigned const i) const {
+        return references[i];
+    }
+    /* FindReference
+     *  by name; -1 if there is none
+     */
+    int FindReference(std::string const &name) const;
+
+    unsigned countOfReadGroups() const {
+        return (unsigned)readGroups.size();
+    }
+    std::string const &getReadGroupName(unsigned const i) const {
+        return readGroups[i];
+    }
+    int FindReadGroup(std::string const &name) const;
+
+    /* hasIndexFile
+     *  whether the index came from a .crai, rather than the containers
+     */
+    bool hasIndexFile() const {
+        return haveIndexFile;
+    }
+    CRAMIndexEntryList const &getIndex() const {
+        return index;
+    }
+    uint64_t getFirstContainer() const {
+        return firstContainer;
+    }
+    /* Slices
+     *  the slices that may hold records of reference refID over the
+     *  0-based [beg, end), in file order
+     */
+    void Slices(int32_t const refID, int64_t const beg, int64_t const end, CRAMIndexEntryList &rslt) const;
+
+    /* getSequence
+     *  the FASTA sequence of reference refID, or -1 if its bases aren't known
+     */
+    int getSequence(int32_t const refID) const {
+        return refID >= 0 && (size_t)refID < sequences.size() ? sequences[refID] : -1;
+    }
+    IndexedFasta const &getFasta() const {
+        return fasta;
+    }
+
+    /* ReadContainer
+     *  the container at fpos, with every slice if "slices" is NULL or
+     *  only those that start where it says; returns false at the end of
+     *  the file, or at the EOF container
+     */
+    bool ReadContainer(ByteSource &src, uint64_t const fpos, std::vector<uint32_t> const *const slices,
+                       CRAMContainer &into) const;
+
+    /* Decode
+     *  the slices of a container that has been read, appended to "into"
+     *  may be called by several threads at once
+     */
+    void Decode(CRAMContainer const &container, CRAMSliceList &into) const;
+
+    /* getDecodeCounts
+     *  what has been decoded so far, by every reader
+     */
+    void getDecodeCounts(uint64_t &containers, uint64_t &slices, uint64_t &records) const;
+};
+
+/* CRAMReader
+ *  the slices of a file, in file order: of the containers from one
+ *  position on, or of a list of index entries
+ *  the caller's thread reads the containers; with OpenOptions::threads,
+ *  up to that many are decoded ahead of it on the shared ngs::WorkPool,
+ *  and one that hasn't started when it is wanted is taken back and
+ *  decoded by the caller
+ */
+class CRAMReader
+{
+    struct Job;
+    friend struct Job;
+
+    CRAMFile const &file;
+    ByteSource *const source;
+    CRAMIndexEntryList plan;        /* what is left to read, if planned */
+    bool const planned;
+    size_t planned_next;
+    uint64_t next;                  /* the next container, if not planned */
+    bool ended;                     /* no more containers to read */
+    std::vector<Job *> jobs;        /* in file order */
+    size_t ahead;                   /* jobs to have read */
+    ngs::WorkPool *pool;
+    ngs::WorkPool::Priority const priority;
+    pthread_mutex_t mutex;
+    pthread_cond_t doneCond;
+
+    bool ReadNext(Job &job);
+    void Fill();
+    void Run(Job &job);
+    void Submit(Job &job);
+    void Finish(Job &job);
+
+    CRAMReader(CRAMReader const &);
+    CRAMReader &operator =(CRAMReader const &);
+public:
+    /* the containers from fpos on */
+    CRAMReader(CRAMFile const &file, uint64_t const fpos);
+    /* the slices of "entries", which must be in file order */
+    CRAMReader(CRAMFile const &file, CRAMIndexEntryList const &entries);
+    ~CRAMReader();
+
+    /* Next
+     *  the next slice, into "into"; false at the end
+     */
+    bool Next(CRAMSlice &into);
+};
+
+/* OpenCRAMCollection
+ *  the NGS read collection of a CRAM file, see ngs-cram.cpp
+ */
+namespace ngs_adapt { class ReadCollectionItf; }
+ngs_adapt::ReadCollectionItf *OpenCRAMCollection(std::string const &path, NGS_BAM::OpenOptions const &options);
+
+#endif // _hpp_cram_
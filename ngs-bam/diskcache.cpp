@@ -0,0 +1,281 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "diskcache.hpp"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <time.h>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+/* a piece found is touched again once it is this many seconds old, so
+ * that reading a hot one doesn't write the directory every time */
+static time_t const touchAge = 60;
+
+/* a piece left half written, by a process that died, once this old */
+static time_t const staleAge = 3600;
+
+static pthread_mutex_t openLock = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string, DiskCache *> opened;
+static uint64_t written = 0;        /* for the names pieces are written under */
+
+static uint64_t HashTag(std::string const &tag)
+{
+    uint64_t hash = 14695981039346656037ull;
+    
+    for (size_t i = 0; i < tag.size(); ++i)
+        hash = (hash ^ (uint8_t)tag[i]) * 1099511628211ull;
+    return hash;
+}
+
+DiskCache::DiskCache(std::string const &Dir, uint64_t const Bound)
+: dir(Dir)
+, bound(Bound)
+, held(0)
+, unseen(0)
+, walking(false)
+{
+    pthread_mutex_init(&mutex, 0);
+}
+
+DiskCache *DiskCache::Open(std::string const &dir, uint64_t const bound)
+{
+    pthread_mutex_lock(&openLock);
+    
+    std::map<std::string, DiskCache *>::const_iterator const i = opened.find(dir);
+    DiskCache *const cache = i != opened.end() ? i->second : new DiskCache(dir, bound);
+    bool const first = i == opened.end();
+    
+    if (first) {
+        mkdir(dir.c_str(), 0777);
+        opened[dir] = cache;
+        cache->walking = true;
+    }
+    pthread_mutex_unlock(&openLock);
+    
+    /* what the directory already has counts against the bound */
+    if (first)
+        cache->Walk(true);
+    return cache;
+}
+
+/* Path
+ *  the subdirectory is chosen by both the version and the position, so
+ *  that the pieces of one file are spread over all of them
+ */
+std::string DiskCache::Path(std::string const &tag, uint64_t const fpos, char const kind) const
+{
+    uint64_t const hash = HashTag(tag);
+    unsigned const sub = (unsigned)((hash ^ ((fpos >> 16) * 0x9E3779B97F4A7C15ull)) >> 56);
+    char name[64];
+    
+    snprintf(name, sizeof(name), "/%02x/%016llx-%llx.%c", sub, (unsigned long long)hash, (unsigned long long)fpos, kind);
+    return dir + name;
+}
+
+bool DiskCache::Get(std::string const &tag, uint64_t const fpos, char const kind, void *const dst, size_t &size)
+{
+    std::string const path = Path(tag, fpos, kind);
+    int const fd = open(path.c_str(), O_RDONLY);
+    
+    if (fd < 0)
+        return false;
+    
+    struct stat st;
+    size_t got = 0;
+    bool const fits = fstat(fd, &st) == 0 && (uint64_t)st.st_size <= size;
+    
+    if (fits) {
+        while (got < (size_t)st.st_size) {
+            ssize_t const nread = read(fd, static_cast<char *>(dst) + got, (size_t)st.st_size - got);
+            
+            if (nread < 0 && errno == EINTR)
+                continue;
+            if (nread <= 0)
+                break;
+            got += (size_t)nread;
+        }
+    }
+    close(fd);
+    if (!fits || got != (size_t)st.st_size)
+        return false;
+    
+    if (time(0) - st.st_mtime >= touchAge)
+        utimensat(AT_FDCWD, path.c_str(), 0, 0);
+    size = got;
+    return true;
+}
+
+void DiskCache::Put(std::string const &tag, uint64_t const fpos, char const kind, void const *const src, size_t const size)
+{
+    std::string const path = Path(tag, fpos, kind);
+    struct stat st;
+    
+    if (stat(path.c_str(), &st) == 0)
+        return;
+    
+    char suffix[48];
+    
+    snprintf(suffix, sizeof(suffix), ".tmp%ld.%llu", (long)getpid(),
+             (unsigned long long)__atomic_fetch_add(&written, 1, __ATOMIC_RELAXED));
+    
+    std::string const temp = path + suffix;
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    
+    if (fd < 0 && errno == ENOENT) {
+        /* the subdirectory, or all of it, isn't there yet, or was removed */
+        mkdir(dir.c_str(), 0777);
+        mkdir(path.substr(0, dir.size() + 3).c_str(), 0777);
+        fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    }
+    if (fd < 0)
+        return;
+    
+    size_t put = 0;
+    
+    while (put < size) {
+        ssize_t const nwrit = write(fd, static_cast<char const *>(src) + put, size - put);
+        
+        if (nwrit < 0 && errno == EINTR)
+            continue;
+        if (nwrit <= 0)
+            break;
+        put += (size_t)nwrit;
+    }
+    if (close(fd) != 0 || put != size || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return;
+    }
+    
+    pthread_mutex_lock(&mutex);
+    held += size;
+    unseen += size;
+    
+    bool const walk = !walking && (held > bound || unseen > bound / 16);
+    
+    if (walk)
+        walking = true;
+    pthread_mutex_unlock(&mutex);
+    
+    if (walk)
+        Walk(true);
+}
+
+/* Piece
+ *  a file of the directory, as Walk finds it
+ */
+struct DiskCachePiece {
+    struct timespec touched;
+    uint64_t size;
+    std::string path;
+    
+    friend bool operator <(DiskCachePiece const &lhs, DiskCachePiece const &rhs) {
+        if (lhs.touched.tv_sec != rhs.touched.tv_sec)
+            return lhs.touched.tv_sec < rhs.touched.tv_sec;
+        return lhs.touched.tv_nsec < rhs.touched.tv_nsec;
+    }
+};
+
+/* Walk
+ *  count what the directory holds, which other processes may have
+ *  added to, and with "evict" remove the least recently touched pieces
+ *  while it holds more than the bound; done by one process at a time,
+ *  a process that finds another at it leaves it to that one
+ */
+void DiskCache::Walk(bool const evict)
+{
+    std::string const lockPath = dir + "/.lock";
+    int const lock = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+    bool const locked = lock >= 0 && flock(lock, LOCK_EX | LOCK_NB) == 0;
+    uint64_t total = 0;
+    
+    if (locked) {
+        std::vector<DiskCachePiece> pieces;
+        time_t const now = time(0);
+        
+        for (unsigned sub = 0; sub < 256; ++sub) {
+            char name[8];
+            
+            snprintf(name, sizeof(name), "/%02x", sub);
+            
+            std::string const subdir = dir + name;
+            DIR *const d = opendir(subdir.c_str());
+            
+            if (!d)
+                continue;
+            while (struct dirent const *const entry = readdir(d)) {
+                if (entry->d_name[0] == '.')
+                    continue;
+                
+                DiskCachePiece piece;
+                struct stat st;
+                
+                piece.path = subdir + "/" + entry->d_name;
+                if (stat(piece.path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+                    continue;
+                if (strstr(entry->d_name, ".tmp") != 0) {
+                    if (now - st.st_mtime > staleAge)
+                        unlink(piece.path.c_str());
+                    continue;
+                }
+                piece.touched = st.st_mtim;
+                piece.size = (uint64_t)st.st_size;
+                total += piece.size;
+                if (evict)
+                    pieces.push_back(piece);
+            }
+            closedir(d);
+        }
+        if (evict && total > bound) {
+            uint64_t const target = bound - bound / 8;
+            
+            std::sort(pieces.begin(), pieces.end());
+            for (size_t i = 0; i < pieces.size() && total > target; ++i) {
+                if (unlink(pieces[i].path.c_str()) == 0)
+                    total -= pieces[i].size;
+            }
+        }
+        flock(lock, LOCK_UN);
+    }
+    if (lock >= 0)
+        close(lock);
+    
+    pthread_mutex_lock(&mutex);
+    if (locked)
+        held = total;
+    unseen = 0;
+    walking = false;
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,88 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_diskcache_
+#define _hpp_diskcache_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include <string>
+
+/* DiskCache
+ *  pieces of remote files kept in a directory, e.g. on a local SSD, so
+ *  that what has been fetched once isn't fetched again, by this process
+ *  or by any other that uses the same directory
+ *
+ *  a piece is a file of its own, named for the version of the file it
+ *  is from, its position and its kind, in one of 256 subdirectories;
+ *  it is written under a name of its own and renamed, so that no one
+ *  reads one that is half written, and touched when it is found
+ *  once more than "bound" bytes have been put, counting those that
+ *  the directory had when it was last walked, the process that gets
+ *  the directory's lock walks it again and removes the least recently
+ *  touched pieces until an eighth of the bound is free
+ *
+ *  it is only a cache: a directory that can't be read or written just
+ *  doesn't keep anything
+ */
+class DiskCache
+{
+    std::string const dir;
+    uint64_t const bound;
+    uint64_t held;                  /* bytes in the directory, as far as is known */
+    uint64_t unseen;                /* bytes put since it was last walked */
+    bool walking;
+    pthread_mutex_t mutex;
+
+    DiskCache(std::string const &dir, uint64_t const bound);
+    DiskCache(DiskCache const &);
+    DiskCache &operator =(DiskCache const &);
+
+    std::string Path(std::string const &tag, uint64_t const fpos, char const kind) const;
+    void Walk(bool const evict);
+public:
+    /* Open
+     *  the cache in "dir", of at most "bound" bytes; the same one for
+     *  every file of the process that uses that directory, the first
+     *  bound it is opened with being its bound; kept until exit
+     */
+    static DiskCache *Open(std::string const &dir, uint64_t const bound);
+
+    /* Get
+     *  copy the piece of kind "kind" at fpos of the file whose version
+     *  is "tag" into dst, if it is kept and has at most "size" bytes
+     *  returns false if it isn't, else true with "size" set to its size
+     */
+    bool Get(std::string const &tag, uint64_t const fpos, char const kind, void *const dst, size_t &size);
+
+    /* Put
+     *  keep a piece, unless it is already kept
+     */
+    void Put(std::string const &tag, uint64_t const fpos, char const kind, void const *const src, size_t const size);
+};
+
+#endif // _hpp_diskcache_
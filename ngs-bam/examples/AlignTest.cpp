@@ -31,7 +31,6 @@
 #include <ngs/AlignmentIterator.hpp>
 #include <ngs/Alignment.hpp>
 
-#include <math.h>
 #include <iostream>
 
 using namespace ngs;
@@ -41,14 +40,8 @@ class AlignTest
 {
 public:
     static AlignmentIterator getIterator(ReadCollection &collection, int splitNum, int splitNo) {
-        if (splitNum > 1) {
-            long const MAX_ROW = collection.getAlignmentCount();
-            long const chunk = ceil((double)MAX_ROW / splitNum);
-            long const first = chunk * (splitNo - 1);
-            long const count = (first + chunk <= MAX_ROW) ? chunk : (MAX_ROW - first);
-
-            return collection.getAlignmentRange(first + 1, count, Alignment::primaryAlignment);
-        }
+        if (splitNum > 1)
+            return collection.getAlignmentShard(splitNo - 1, splitNum, Alignment::primaryAlignment);
         return collection.getAlignments(Alignment::primaryAlignment);
     }
     static void run(ReadCollection &collection, int splitNum, int splitNo)
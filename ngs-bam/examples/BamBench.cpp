@@ -0,0 +1,328 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs-bam/ngs-bam.hpp>
+#include <ngs/ErrorMsg.hpp>
+#include <ngs/ReadCollection.hpp>
+#include <ngs/AlignmentIterator.hpp>
+#include <ngs/Alignment.hpp>
+#include <ngs/ReferenceIterator.hpp>
+#include <ngs/Reference.hpp>
+#include <ngs/Statistics.hpp>
+
+#include <zlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+using namespace ngs;
+using namespace std;
+
+/* BamBench
+ *  times a BAM file through ngs-bam, one JSON object per line:
+ *
+ *    io        reading the file with stdio
+ *    inflate   inflating its BGZF blocks with zlib, from memory
+ *    scan      all alignments, positions only; records/s and MB/s
+ *    bgzf      the reader's own I/O counters after the scan
+ *    field     a scan that also gets one field; the difference from
+ *              scan is the cost of the field per record
+ *    no-tags   a scan opened without decoding tags
+ *    regions   random slices; queries/s and latency percentiles
+ *
+ *  io is only a measure of the disk if the file is not in the
+ *  page cache; the later scans usually find it there
+ */
+class BamBench
+{
+    static volatile uint64_t sink;
+
+    static double now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+    static void report(char const *name, char const *extra) {
+        cout << "{\"bench\":\"" << name << "\"" << extra << "}" << endl;
+    }
+
+    /* io: the whole file into memory */
+    static vector<uint8_t> readFile(string const &path, double &elapsed) {
+        vector<uint8_t> data;
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp == 0)
+            throw ErrorMsg("can't open " + path);
+
+        double const start = now();
+        uint8_t buffer[1024 * 1024];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+            data.insert(data.end(), buffer, buffer + n);
+        elapsed = now() - start;
+        fclose(fp);
+        return data;
+    }
+
+    /* inflate: every BGZF block, found by its BSIZE field */
+    static uint64_t inflateAll(vector<uint8_t> const &data, uint64_t &blocks) {
+        static uint8_t out[64 * 1024];
+        uint64_t total = 0;
+        size_t pos = 0;
+
+        blocks = 0;
+        while (pos + 18 <= data.size()) {
+            uint8_t const *const hdr = &data[pos];
+            if (hdr[0] != 31 || hdr[1] != 139 || (hdr[3] & 4) == 0)
+                throw ErrorMsg("not a BGZF file");
+
+            unsigned const xlen = hdr[10] | (hdr[11] << 8);
+            unsigned bsize = 0;
+            for (unsigned i = 0; i + 4 <= xlen; ) {
+                uint8_t const *const sub = hdr + 12 + i;
+                unsigned const slen = sub[2] | (sub[3] << 8);
+                if (sub[0] == 'B' && sub[1] == 'C' && slen == 2)
+                    bsize = (sub[4] | (sub[5] << 8)) + 1;
+                i += 4 + slen;
+            }
+            if (bsize == 0 || pos + bsize > data.size())
+                throw ErrorMsg("bad BGZF block");
+
+            z_stream zs;
+            memset(&zs, 0, sizeof(zs));
+            if (inflateInit2(&zs, -15) != Z_OK)
+                throw ErrorMsg("inflateInit2 failed");
+            zs.next_in = const_cast<uint8_t *>(hdr + 12 + xlen);
+            zs.avail_in = bsize - 12 - xlen - 8;
+            zs.next_out = out;
+            zs.avail_out = sizeof(out);
+            int const rc = inflate(&zs, Z_FINISH);
+            inflateEnd(&zs);
+            if (rc != Z_STREAM_END)
+                throw ErrorMsg("inflate failed");
+
+            total += zs.total_out;
+            ++blocks;
+            pos += bsize;
+        }
+        return total;
+    }
+
+    enum Field { none, bases, qualities, rawQualities, shortCigar, longCigar, readId };
+
+    static uint64_t scan(ReadCollection &collection, Field const field) {
+        uint64_t count = 0;
+        AlignmentIterator it = collection.getAlignments(Alignment::all);
+
+        while (it.nextAlignment()) {
+            ++count;
+            sink += it.getAlignmentPosition();
+            switch (field) {
+            case none:
+                break;
+            case bases:
+                sink += it.getFragmentBasesView().size();
+                break;
+            case qualities:
+                sink += it.getFragmentQualitiesView().size();
+                break;
+            case rawQualities:
+                sink += NGS_BAM::getRawQualities(it).size;
+                break;
+            case shortCigar:
+                sink += it.getShortCigar(false).size();
+                break;
+            case longCigar:
+                sink += it.getLongCigar(false).size();
+                break;
+            case readId:
+                sink += it.getReadId().size();
+                break;
+            }
+        }
+        return count;
+    }
+
+    struct Ref {
+        string name;
+        uint64_t length;
+    };
+
+    static vector<Ref> references(ReadCollection &collection) {
+        vector<Ref> refs;
+        ReferenceIterator it = collection.getReferences();
+        while (it.nextReference()) {
+            Ref ref;
+            ref.name = it.getCommonName();
+            ref.length = it.getLength();
+            if (ref.length > 0)
+                refs.push_back(ref);
+        }
+        return refs;
+    }
+
+public:
+    static void run(string const &path, unsigned const queries, uint64_t const width)
+    {
+        char extra[256];
+
+        // io and inflate
+        double ioTime;
+        vector<uint8_t> const data = readFile(path, ioTime);
+        double const mb = data.size() / (1024.0 * 1024.0);
+        snprintf(extra, sizeof(extra), ",\"bytes\":%lu,\"seconds\":%.6f,\"MB_per_s\":%.1f",
+                 (unsigned long)data.size(), ioTime, mb / ioTime);
+        report("io", extra);
+
+        uint64_t blocks;
+        double start = now();
+        uint64_t const inflated = inflateAll(data, blocks);
+        double const inflateTime = now() - start;
+        snprintf(extra, sizeof(extra), ",\"blocks\":%lu,\"inflated_bytes\":%lu,\"seconds\":%.6f,\"MB_per_s\":%.1f,\"io_fraction\":%.3f",
+                 (unsigned long)blocks, (unsigned long)inflated, inflateTime, mb / inflateTime,
+                 ioTime / (ioTime + inflateTime));
+        report("inflate", extra);
+
+        // scans
+        ReadCollection collection = NGS_BAM::openReadCollection(path);
+
+        start = now();
+        uint64_t const records = scan(collection, none);
+        double const scanTime = now() - start;
+        snprintf(extra, sizeof(extra), ",\"records\":%lu,\"seconds\":%.6f,\"records_per_s\":%.0f,\"MB_per_s\":%.1f,\"inflate_fraction\":%.3f",
+                 (unsigned long)records, scanTime, records / scanTime, mb / scanTime, inflateTime / scanTime);
+        report("scan", extra);
+
+        {
+            Statistics const stats = collection.getStatistics();
+            string line;
+            for (String path = stats.nextPath(""); !path.empty(); path = stats.nextPath(path))
+                line += ",\"" + path + "\":" + stats.getAsString(path);
+            report("bgzf", line.c_str());
+        }
+
+        static struct { Field field; char const *name; } const fields[] = {
+            { bases, "field.bases" },
+            { qualities, "field.qualities" },
+            { rawQualities, "field.rawQualities" },
+            { shortCigar, "field.shortCigar" },
+            { longCigar, "field.longCigar" },
+            { readId, "field.readId" }
+        };
+        for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+            start = now();
+            uint64_t const n = scan(collection, fields[i].field);
+            double const elapsed = now() - start;
+            snprintf(extra, sizeof(extra), ",\"records\":%lu,\"ns_per_record\":%.1f,\"ns_over_scan\":%.1f",
+                     (unsigned long)n, elapsed * 1e9 / n, (elapsed - scanTime) * 1e9 / n);
+            report(fields[i].name, extra);
+        }
+
+        // tags have no getter, so their cost is what leaving them out saves
+        {
+            NGS_BAM::OpenOptions options;
+            options.fields = NGS_BAM::OpenOptions::allFields & ~NGS_BAM::OpenOptions::tags;
+            ReadCollection noTags = NGS_BAM::openReadCollection(path, options);
+
+            start = now();
+            uint64_t const n = scan(noTags, none);
+            double const elapsed = now() - start;
+            snprintf(extra, sizeof(extra), ",\"records\":%lu,\"ns_per_record\":%.1f,\"ns_saved\":%.1f",
+                     (unsigned long)n, elapsed * 1e9 / n, (scanTime - elapsed) * 1e9 / n);
+            report("no-tags", extra);
+        }
+
+        // random regions
+        vector<Ref> const refs = references(collection);
+        if (refs.empty() || queries == 0)
+            return;
+
+        vector<double> latency;
+        uint64_t found = 0;
+        srand(1);
+        start = now();
+        for (unsigned i = 0; i < queries; ++i) {
+            Ref const &ref = refs[rand() % refs.size()];
+            uint64_t const first = ref.length > width ? (uint64_t)rand() % (ref.length - width) : 0;
+
+            double const t0 = now();
+            Reference reference = collection.getReference(ref.name);
+            AlignmentIterator it = reference.getAlignmentSlice(first, width);
+            while (it.nextAlignment()) {
+                sink += it.getAlignmentPosition();
+                ++found;
+            }
+            latency.push_back(now() - t0);
+        }
+        double const regionTime = now() - start;
+
+        sort(latency.begin(), latency.end());
+        size_t const n = latency.size();
+        snprintf(extra, sizeof(extra),
+                 ",\"queries\":%u,\"width\":%lu,\"records\":%lu,\"queries_per_s\":%.1f"
+                 ",\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f",
+                 queries, (unsigned long)width, (unsigned long)found, n / regionTime,
+                 latency[n / 2] * 1e6, latency[n * 9 / 10] * 1e6,
+                 latency[n * 99 / 100] * 1e6, latency[n - 1] * 1e6);
+        report("regions", extra);
+    }
+};
+
+volatile uint64_t BamBench::sink;
+
+int main ( int argc, char const *argv[] )
+{
+    if ( argc < 2 || argc > 4 )
+    {
+        cerr << "Usage: BamBench file.bam [queries [width]]\n";
+    }
+    else try
+    {
+        unsigned const queries = argc > 2 ? atoi ( argv[2] ) : 1000;
+        uint64_t const width = argc > 3 ? atol ( argv[3] ) : 10000;
+
+        BamBench::run ( argv[1], queries, width );
+        return 0;
+    }
+    catch ( ErrorMsg & x )
+    {
+        cerr <<  x.toString () << '\n';
+    }
+    catch ( exception & x )
+    {
+        cerr <<  x.what () << '\n';
+    }
+    catch ( ... )
+    {
+        cerr <<  "unknown exception\n";
+    }
+
+    return 10;
+}
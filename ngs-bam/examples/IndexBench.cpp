@@ -0,0 +1,384 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs-bam/ngs-bam.hpp>
+#include <ngs/ErrorMsg.hpp>
+#include <ngs/ReadCollection.hpp>
+#include <ngs/AlignmentIterator.hpp>
+#include <ngs/Alignment.hpp>
+#include <ngs/ReferenceIterator.hpp>
+#include <ngs/Reference.hpp>
+
+#include <zlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace ngs;
+using namespace std;
+
+/* IndexBench
+ *  times opening a BAM file and its index through ngs-bam, one JSON
+ *  object per line, for each way of holding the index:
+ *
+ *    eager.parsed   every reference's index parsed at open time
+ *    lazy.parsed    each parsed on first use ( lazyIndex )
+ *    eager.shared   the parsed index mapped from its sidecar ( sharedIndex ),
+ *                   written by an open before the one timed
+ *    lazy.shared    both
+ *
+ *  with the seconds to open the collection, the peak resident set
+ *  before and after it, and the latency of a first slice of the
+ *  middle reference, which is where a lazy index pays for its own
+ *  each is measured in a process of its own, so that neither the
+ *  peak resident set nor the files ngs-bam keeps open carry over
+ *
+ *  "-generate" first writes a BAM file of many references, or of deep
+ *  bins, with a .bai that ngs-bam builds for it
+ */
+class IndexBench
+{
+    static volatile uint64_t sink;
+
+    static double now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+    static void report(char const *name, char const *extra) {
+        cout << "{\"bench\":\"" << name << "\"" << extra << "}" << endl;
+    }
+    /* the peak resident set of this process, in KiB */
+    static long peakRSS() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    /* BGZFOut
+     *  a BGZF file written block by block with zlib
+     */
+    class BGZFOut {
+        FILE *fp;
+        string pending;
+
+        void flush() {
+            static uint8_t out[64 * 1024 + 1024];
+            z_stream zs;
+            memset(&zs, 0, sizeof(zs));
+            if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                throw ErrorMsg("deflateInit2 failed");
+            zs.next_in = (Bytef *)pending.data();
+            zs.avail_in = (uInt)pending.size();
+            zs.next_out = out + 18;
+            zs.avail_out = sizeof(out) - 18 - 8;
+            int const rc = deflate(&zs, Z_FINISH);
+            deflateEnd(&zs);
+            if (rc != Z_STREAM_END)
+                throw ErrorMsg("deflate failed");
+
+            size_t const bsize = 18 + zs.total_out + 8;
+            static uint8_t const header[] = {
+                31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0
+            };
+            memcpy(out, header, sizeof(header));
+            out[16] = (bsize - 1) & 0xFF;
+            out[17] = (bsize - 1) >> 8;
+
+            uint32_t const crc = crc32(crc32(0, 0, 0), (Bytef const *)pending.data(), (uInt)pending.size());
+            uint32_t const isize = (uint32_t)pending.size();
+            uint8_t *const tail = out + 18 + zs.total_out;
+            for (unsigned i = 0; i < 4; ++i) {
+                tail[i] = (crc >> (8 * i)) & 0xFF;
+                tail[4 + i] = (isize >> (8 * i)) & 0xFF;
+            }
+            if (fwrite(out, 1, bsize, fp) != bsize)
+                throw ErrorMsg("write failed");
+            pending.clear();
+        }
+    public:
+        explicit BGZFOut(string const &path) : fp(fopen(path.c_str(), "wb")) {
+            if (fp == 0)
+                throw ErrorMsg("can't create " + path);
+        }
+        ~BGZFOut() {
+            if (fp != 0)
+                fclose(fp);
+        }
+        void write(string const &data) {
+            for (size_t i = 0; i < data.size(); ) {
+                size_t const n = min(data.size() - i, (size_t)0xFF00 - pending.size());
+                pending.append(data, i, n);
+                i += n;
+                if (pending.size() == 0xFF00)
+                    flush();
+            }
+        }
+        /* ends the file with the empty block that marks its end */
+        void close() {
+            if (!pending.empty())
+                flush();
+            flush();
+            fclose(fp);
+            fp = 0;
+        }
+    };
+
+    static void put32(string &s, uint32_t const v) {
+        for (unsigned i = 0; i < 4; ++i)
+            s += (char)((v >> (8 * i)) & 0xFF);
+    }
+    static void put16(string &s, uint16_t const v) {
+        s += (char)(v & 0xFF);
+        s += (char)(v >> 8);
+    }
+    /* the smallest bin of the BAI scheme holding [beg, end) */
+    static uint16_t reg2bin(uint32_t const beg, uint32_t end) {
+        --end;
+        if (beg >> 14 == end >> 14) return ((1 << 15) - 1) / 7 + (beg >> 14);
+        if (beg >> 17 == end >> 17) return ((1 << 12) - 1) / 7 + (beg >> 17);
+        if (beg >> 20 == end >> 20) return ((1 << 9) - 1) / 7 + (beg >> 20);
+        if (beg >> 23 == end >> 23) return ((1 << 6) - 1) / 7 + (beg >> 23);
+        if (beg >> 26 == end >> 26) return ((1 << 3) - 1) / 7 + (beg >> 26);
+        return 0;
+    }
+    /* a record of refID at pos, "length" bases all matching */
+    static void putRecord(string &s, int32_t const refID, uint32_t const pos, uint32_t const length, uint64_t const id) {
+        char name[32];
+        int const l_name = snprintf(name, sizeof(name), "r%lu", (unsigned long)id) + 1;
+
+        put32(s, 32 + l_name + 4);
+        put32(s, refID);
+        put32(s, pos);
+        s += (char)l_name;
+        s += (char)60;                      // mapping quality
+        put16(s, reg2bin(pos, pos + length));
+        put16(s, 1);                        // CIGAR operations
+        put16(s, 0);                        // flags
+        put32(s, 0);                        // no sequence
+        put32(s, (uint32_t)-1);             // no mate
+        put32(s, (uint32_t)-1);
+        put32(s, 0);
+        s.append(name, l_name);
+        put32(s, length << 4);              // <length>M
+    }
+
+public:
+    /* generate
+     *  "references" of "refLength" bases, with "records" evenly spaced
+     *  on each, of lengths that put them in bins of every level
+     *  e.g. 500000 references with 2 records apiece for the many-contig
+     *  case, 1 reference of 500 Mbp with 100000 for the deep-bin one
+     */
+    static void generate(string const &path, unsigned const references, uint32_t const refLength, unsigned const records)
+    {
+        BGZFOut out(path);
+        string header("BAM\1");
+        string const text("@HD\tVN:1.6\tSO:coordinate\n");
+        put32(header, (uint32_t)text.size());
+        header += text;
+        put32(header, references);
+        for (unsigned i = 0; i < references; ++i) {
+            char name[32];
+            int const l_name = snprintf(name, sizeof(name), "ref%u", i) + 1;
+            put32(header, l_name);
+            header.append(name, l_name);
+            put32(header, refLength);
+        }
+        out.write(header);
+
+        static uint32_t const lengths[] = { 100, 20000, 150000, 1200000 };
+        uint64_t const step = records ? refLength / records : refLength;
+        uint64_t id = 0;
+        string batch;
+        for (unsigned ref = 0; ref < references; ++ref) {
+            for (unsigned i = 0; i < records; ++i) {
+                uint32_t const pos = (uint32_t)(i * step);
+                uint32_t const length = (uint32_t)min<uint64_t>(lengths[i % 4], refLength - pos);
+                putRecord(batch, ref, pos, length ? length : 1, ++id);
+            }
+            if (batch.size() >= 1024 * 1024) {
+                out.write(batch);
+                batch.clear();
+            }
+        }
+        out.write(batch);
+        out.close();
+
+        // have ngs-bam index it
+        NGS_BAM::OpenOptions options;
+        options.buildIndex = true;
+        options.saveIndex = true;
+        inChild(path, options, 0);
+
+        char extra[160];
+        snprintf(extra, sizeof(extra), ",\"references\":%u,\"ref_length\":%u,\"records\":%lu",
+                 references, refLength, (unsigned long)id);
+        report("generate", extra);
+    }
+
+    /* measure
+     *  one open of the file, with the middle reference's first slice
+     */
+    static void measure(string const &path, NGS_BAM::OpenOptions const &options, char const *const name)
+    {
+        long const before = peakRSS();
+        double start = now();
+        ReadCollection collection = NGS_BAM::openReadCollection(path, options);
+        double const openTime = now() - start;
+        long const afterOpen = peakRSS();
+
+        // the middle reference, found before the slice is timed
+        vector<string> names;
+        {
+            ReferenceIterator it = collection.getReferences();
+            while (it.nextReference())
+                names.push_back(it.getCommonName());
+        }
+
+        double sliceTime = 0;
+        uint64_t found = 0;
+        if (!names.empty()) {
+            start = now();
+            Reference reference = collection.getReference(names[names.size() / 2]);
+            AlignmentIterator it = reference.getAlignmentSlice(0, 100000);
+            while (it.nextAlignment()) {
+                sink += it.getAlignmentPosition();
+                ++found;
+            }
+            sliceTime = now() - start;
+        }
+
+        char extra[320];
+        snprintf(extra, sizeof(extra),
+                 ",\"references\":%lu,\"open_ms\":%.3f,\"peak_rss_kb_before\":%ld"
+                 ",\"peak_rss_kb_open\":%ld,\"open_rss_kb\":%ld"
+                 ",\"first_slice_ms\":%.3f,\"first_slice_records\":%lu,\"peak_rss_kb\":%ld",
+                 (unsigned long)names.size(), openTime * 1e3, before,
+                 afterOpen, afterOpen - before,
+                 sliceTime * 1e3, (unsigned long)found, peakRSS());
+        report(name, extra);
+    }
+
+    /* inChild
+     *  measure ( or, without a name, just open ) in a process of its own
+     */
+    static void inChild(string const &path, NGS_BAM::OpenOptions const &options, char const *const name)
+    {
+        cout.flush();
+        pid_t const pid = fork();
+        if (pid < 0)
+            throw ErrorMsg("fork failed");
+        if (pid == 0) {
+            int rc = 0;
+            try {
+                if (name != 0)
+                    measure(path, options, name);
+                else
+                    NGS_BAM::openReadCollection(path, options);
+            }
+            catch (ErrorMsg &x) {
+                cerr << x.toString() << '\n';
+                rc = 10;
+            }
+            catch (exception &x) {
+                cerr << x.what() << '\n';
+                rc = 10;
+            }
+            cout.flush();
+            _exit(rc);
+        }
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            throw ErrorMsg(string("measuring ") + (name ? name : "an open") + " failed");
+    }
+
+    static void run(string const &path)
+    {
+        static struct { bool lazy; bool shared; char const *name; } const variants[] = {
+            { false, false, "eager.parsed" },
+            { true,  false, "lazy.parsed" },
+            { false, true,  "eager.shared" },
+            { true,  true,  "lazy.shared" }
+        };
+        for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); ++i) {
+            NGS_BAM::OpenOptions options;
+            options.lazyIndex = variants[i].lazy;
+            options.sharedIndex = variants[i].shared;
+            if (options.sharedIndex)
+                inChild(path, options, 0);  // writes the sidecar if it isn't current
+            inChild(path, options, variants[i].name);
+        }
+    }
+};
+
+volatile uint64_t IndexBench::sink;
+
+int main ( int argc, char const *argv[] )
+{
+    bool const generate = argc > 1 && strcmp ( argv[1], "-generate" ) == 0;
+
+    if ( generate ? argc != 6 : argc != 2 )
+    {
+        cerr << "Usage: IndexBench file.bam\n"
+                "       IndexBench -generate file.bam references ref-length records-per-reference\n";
+    }
+    else try
+    {
+        if ( generate )
+        {
+            IndexBench::generate ( argv[2], atoi ( argv[3] ), atol ( argv[4] ), atoi ( argv[5] ) );
+            IndexBench::run ( argv[2] );
+        }
+        else
+        {
+            IndexBench::run ( argv[1] );
+        }
+        return 0;
+    }
+    catch ( ErrorMsg & x )
+    {
+        cerr <<  x.toString () << '\n';
+    }
+    catch ( exception & x )
+    {
+        cerr <<  x.what () << '\n';
+    }
+    catch ( ... )
+    {
+        cerr <<  "unknown exception\n";
+    }
+
+    return 10;
+}
@@ -0,0 +1,531 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "fasta.hpp"
+#include "cpu.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+IndexedFasta::IndexedFasta()
+: inflatedSize(0)
+, clock(0)
+{
+    pthread_mutex_init(&cacheLock, 0);
+}
+
+IndexedFasta::~IndexedFasta()
+{
+    for (size_t i = 0; i < cache.size(); ++i)
+        delete cache[i];
+    pthread_mutex_destroy(&cacheLock);
+}
+
+static uint64_t LE64(uint8_t const *const p)
+{
+    uint64_t value = 0;
+    
+    for (unsigned i = 8; i > 0; --i)
+        value = (value << 8) | p[i - 1];
+    return value;
+}
+
+/* BlockSize
+ *  of the BGZF block at "src", from its BSIZE field, or 0 if it isn't
+ *  one or doesn't fit in "avail" bytes
+ */
+static unsigned BlockSize(uint8_t const *const src, uint64_t const avail)
+{
+    static unsigned const fixed_header = 12;
+    static unsigned const trailer_size = 8;
+    
+    if (avail < fixed_header + trailer_size || src[0] != 31 || src[1] != 139 || src[2] != 8 || (src[3] & 4) == 0)
+        return 0;
+    
+    unsigned const xlen = src[10] | (src[11] << 8);
+    uint8_t const *const extra = src + fixed_header;
+    
+    if (avail < fixed_header + xlen)
+        return 0;
+    for (unsigned i = 0; i + 4 <= xlen; ) {
+        unsigned const slen = extra[i + 2] | (extra[i + 3] << 8);
+        
+        if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2 && i + 6 <= xlen) {
+            unsigned const csize = (extra[i + 4] | (extra[i + 5] << 8)) + 1;
+            
+            return csize >= fixed_header + xlen + trailer_size && csize <= avail ? csize : 0;
+        }
+        i += 4 + slen;
+    }
+    return 0;
+}
+
+/* BlockInflatedSize
+ *  from the ISIZE field at the end of a block of "csize" bytes
+ */
+static uint32_t BlockInflatedSize(uint8_t const *const src, unsigned const csize)
+{
+    uint8_t const *const p = src + csize - 4;
+    
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* LoadGzi
+ *  the index is the number of blocks after the first, then for each
+ *  one its offset in the file and inflated, all 64-bit little endian
+ *  returns false if there is none; throws if it is malformed
+ */
+bool IndexedFasta::LoadGzi(std::string const &gzipath)
+{
+    MappedFile gzi;
+    
+    if (!gzi.Map(gzipath))
+        return false;
+    
+    uint8_t const *const data = gzi.data();
+    uint64_t const count = gzi.size() >= 8 ? LE64(data) : 0;
+    
+    if (gzi.size() < 8 || (gzi.size() - 8) / 16 < count)
+        throw std::runtime_error("BGZF index '" + gzipath + "' is malformed");
+    
+    Block const first = { 0, 0 };
+    
+    blocks.assign(1, first);
+    for (uint64_t i = 0; i < count; ++i) {
+        Block const block = { LE64(data + 8 + 16 * i), LE64(data + 16 + 16 * i) };
+        
+        if (block.coffset <= blocks.back().coffset || block.uoffset < blocks.back().uoffset || block.coffset >= map.size())
+            throw std::runtime_error("BGZF index '" + gzipath + "' doesn't fit the FASTA file");
+        blocks.push_back(block);
+    }
+    
+    Block const &last = blocks.back();
+    unsigned const csize = BlockSize(map.data() + last.coffset, map.size() - last.coffset);
+    
+    if (csize == 0)
+        throw std::runtime_error("BGZF index '" + gzipath + "' doesn't fit the FASTA file");
+    inflatedSize = last.uoffset + BlockInflatedSize(map.data() + last.coffset, csize);
+    return true;
+}
+
+/* ScanBlocks
+ *  for a compressed file without a .gzi, from the sizes in the headers
+ *  and trailers of its blocks, so that none is inflated
+ */
+void IndexedFasta::ScanBlocks()
+{
+    uint64_t coffset = 0;
+    uint64_t uoffset = 0;
+    
+    blocks.clear();
+    while (coffset < map.size()) {
+        unsigned const csize = BlockSize(map.data() + coffset, map.size() - coffset);
+        
+        if (csize == 0)
+            throw std::runtime_error("FASTA file '" + path + "' is compressed, but not with bgzip");
+        
+        Block const block = { coffset, uoffset };
+        
+        blocks.push_back(block);
+        coffset += csize;
+        uoffset += BlockInflatedSize(map.data() + block.coffset, csize);
+    }
+    inflatedSize = uoffset;
+}
+
+/* Open
+ *  each line of the index is NAME LENGTH OFFSET LINEBASES LINEWIDTH,
+ *  separated by tabs; the offsets of a compressed file are inflated
+ */
+bool IndexedFasta::Open(std::string const &fastapath)
+{
+    FILE *const fai = fopen((fastapath + ".fai").c_str(), "r");
+    
+    if (!fai)
+        return false;
+    if (!map.Map(fastapath)) {
+        fclose(fai);
+        return false;
+    }
+    path = fastapath;
+    blocks.clear();
+    try {
+        if (map.size() >= 2 && map.data()[0] == 31 && map.data()[1] == 139 && !LoadGzi(fastapath + ".gzi"))
+            ScanBlocks();
+    }
+    catch (...) {
+        fclose(fai);
+        map.Unmap();
+        throw;
+    }
+    
+    uint64_t const size = blocks.empty() ? map.size() : inflatedSize;
+    std::string line;
+    int ch;
+    
+    do {
+        ch = fgetc(fai);
+        if (ch != '\n' && ch != EOF) {
+            line += (char)ch;
+            continue;
+        }
+        if (line.empty())
+            continue;
+        
+        size_t const tab = line.find('\t');
+        unsigned long long length, offset, lineBases, lineBytes;
+        
+        if (tab == line.npos ||
+            sscanf(line.c_str() + tab, "%llu %llu %llu %llu", &length, &offset, &lineBases, &lineBytes) != 4 ||
+            lineBases == 0 || lineBytes < lineBases)
+        {
+            fclose(fai);
+            throw std::runtime_error("FASTA index '" + fastapath + ".fai' is malformed");
+        }
+        
+        Sequence seq;
+        
+        seq.length = length;
+        seq.offset = offset;
+        seq.lineBases = lineBases;
+        seq.lineBytes = lineBytes;
+        if (seq.offset > size || (seq.length > 0 && Where(seq, seq.length - 1) >= size)) {
+            fclose(fai);
+            throw std::runtime_error("FASTA index '" + fastapath + ".fai' doesn't fit the FASTA file");
+        }
+        byName[line.substr(0, tab)] = (unsigned)sequences.size();
+        sequences.push_back(seq);
+        line.clear();
+    } while (ch != EOF);
+    
+    fclose(fai);
+    return true;
+}
+
+int IndexedFasta::Find(std::string const &name) const
+{
+    std::map<std::string, unsigned>::const_iterator const i = byName.find(name);
+    
+    return i == byName.end() ? -1 : (int)i->second;
+}
+
+/* BlockOf
+ *  the index of the block that has the inflated "offset"
+ */
+size_t IndexedFasta::BlockOf(uint64_t const offset) const
+{
+    size_t lo = 0;
+    size_t hi = blocks.size();
+    
+    while (lo + 1 < hi) {
+        size_t const mid = (lo + hi) / 2;
+        
+        if (blocks[mid].uoffset <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Load
+ *  the inflated block, from the cache or into the least recently used
+ *  entry of it; the cache's lock is held
+ */
+BGZFBlock const &IndexedFasta::Load(Block const &block) const
+{
+    Inflated *victim = 0;
+    
+    for (size_t i = 0; i < cache.size(); ++i) {
+        Inflated *const entry = cache[i];
+        
+        if (entry->block.fpos == block.coffset) {
+            entry->used = ++clock;
+            return entry->block;
+        }
+        if (!victim || entry->used < victim->used)
+            victim = entry;
+    }
+    if (cache.size() < CACHE_BLOCKS) {
+        cache.push_back(0);
+        cache.back() = victim = new Inflated();
+    }
+    victim->block.fpos = ~(uint64_t)0;
+    victim->used = 0;
+    
+    unsigned const csize = BlockSize(map.data() + block.coffset, map.size() - block.coffset);
+    char const *const error = csize != 0 ? inflater.Inflate(map.data() + block.coffset, csize, victim->block)
+                                         : "block is malformed";
+    
+    if (error)
+        throw std::runtime_error("FASTA file '" + path + "': " + error);
+    victim->block.fpos = block.coffset;
+    victim->used = ++clock;
+    return victim->block;
+}
+
+/* CopyInflated
+ *  copies "count" bytes of a compressed file from the inflated "offset"
+ */
+void IndexedFasta::CopyInflated(uint64_t offset, size_t count, char *dst) const
+{
+    pthread_mutex_lock(&cacheLock);
+    try {
+        for (size_t b = BlockOf(offset); count > 0; ++b) {
+            if (b >= blocks.size())
+                throw std::runtime_error("FASTA file '" + path + "' is truncated");
+            
+            BGZFBlock const &block = Load(blocks[b]);
+            uint64_t const at = offset - blocks[b].uoffset;
+            
+            if (at >= block.size)
+                continue;           /* an empty block */
+            
+            size_t const n = count < block.size - at ? count : (size_t)(block.size - at);
+            
+            memcpy(dst, block.data + at, n);
+            dst += n;
+            offset += n;
+            count -= n;
+        }
+    }
+    catch (...) {
+        pthread_mutex_unlock(&cacheLock);
+        throw;
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+size_t IndexedFasta::LineSize(unsigned const i, uint64_t const pos, uint64_t const count) const
+{
+    Sequence const &seq = sequences[i];
+    uint64_t const toLineEnd = seq.lineBases - pos % seq.lineBases;
+    uint64_t const toEnd = pos < seq.length ? seq.length - pos : 0;
+    uint64_t n = count;
+    
+    if (n > toLineEnd)
+        n = toLineEnd;
+    if (n > toEnd)
+        n = toEnd;
+    return (size_t)n;
+}
+
+char const *IndexedFasta::Chunk(unsigned const i, uint64_t const pos, uint64_t const count, size_t &size) const
+{
+    if (!blocks.empty())
+        throw std::runtime_error("FASTA file '" + path + "' is compressed");
+    size = LineSize(i, pos, count);
+    return (char const *)map.data() + (size ? Where(sequences[i], pos) : 0);
+}
+
+void IndexedFasta::Copy(unsigned const i, uint64_t const pos, uint64_t const count, std::string &rslt) const
+{
+    uint64_t const length = sequences[i].length;
+    uint64_t const end = pos < length && count < length - pos ? pos + count : length;
+    
+    rslt.clear();
+    if (pos < end) {
+        rslt.resize((size_t)(end - pos));
+        Read(i, pos, &rslt[0], end - pos);
+    }
+}
+
+uint64_t IndexedFasta::Read(unsigned const i, uint64_t const pos, char *const buffer, uint64_t const count) const
+{
+    uint64_t copied = 0;
+    
+    while (copied < count) {
+        size_t const size = LineSize(i, pos + copied, count - copied);
+        
+        if (size == 0)
+            break;
+        
+        uint64_t const at = Where(sequences[i], pos + copied);
+        
+        if (blocks.empty())
+            memcpy(buffer + copied, map.data() + at, size);
+        else
+            CopyInflated(at, size, buffer + copied);
+        copied += size;
+    }
+    return copied;
+}
+
+/* the 2-bit code of every byte, A C G T in either case, or 4 for any other */
+static struct BaseCodes {
+    uint8_t code[256];
+    
+    BaseCodes() {
+        memset(code, 4, sizeof(code));
+        code['A'] = code['a'] = 0;
+        code['C'] = code['c'] = 1;
+        code['G'] = code['g'] = 2;
+        code['T'] = code['t'] = 3;
+    }
+} const baseCodes;
+
+/* Pack32
+ *  the codes and mask bits of 32 bases
+ */
+static void Pack32Plain(uint8_t const *const ascii, uint64_t &word, uint32_t &mask)
+{
+    /* the shifts are constant once the loop is unrolled */
+    for (unsigned k = 0; k < 32; ++k) {
+        unsigned const code = baseCodes.code[ascii[k]];
+        
+        word |= (uint64_t)(code & 3) << (2 * k);
+        mask |= (uint32_t)(code >> 2) << k;
+    }
+}
+
+#if CPU_DISPATCH
+/* Spread
+ *  moves bit k of the low 32 to bit 2k
+ */
+static inline uint64_t Spread(uint64_t x)
+{
+    x = (x | x << 16) & 0x0000FFFF0000FFFFull;
+    x = (x | x << 8) & 0x00FF00FF00FF00FFull;
+    x = (x | x << 4) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | x << 2) & 0x3333333333333333ull;
+    x = (x | x << 1) & 0x5555555555555555ull;
+    return x;
+}
+
+CPU_TARGET("avx2")
+static void Pack32AVX2(uint8_t const *const ascii, uint64_t &word, uint32_t &mask)
+{
+    /* A C G T and a c g t are 0 1 2 3 in bits 1 and 2 of the byte
+     * xor bits 2 and 3; the two bits of each code are gathered
+     * apart, then interleaved */
+    __m256i const v = _mm256_loadu_si256((__m256i const *)ascii);
+    __m256i const upper = _mm256_and_si256(v, _mm256_set1_epi8((char)0xDF));
+    __m256i const known = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(upper, _mm256_set1_epi8('A')), _mm256_cmpeq_epi8(upper, _mm256_set1_epi8('C'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(upper, _mm256_set1_epi8('G')), _mm256_cmpeq_epi8(upper, _mm256_set1_epi8('T'))));
+    __m256i const code = _mm256_and_si256(_mm256_and_si256(
+        _mm256_xor_si256(_mm256_srli_epi16(v, 1), _mm256_srli_epi16(v, 2)), _mm256_set1_epi8(3)), known);
+    uint64_t const lo = (uint32_t)_mm256_movemask_epi8(_mm256_slli_epi16(code, 7));
+    uint64_t const hi = (uint32_t)_mm256_movemask_epi8(_mm256_slli_epi16(code, 6));
+    
+    word = Spread(lo) | Spread(hi) << 1;
+    mask = ~(uint32_t)_mm256_movemask_epi8(known);
+}
+#endif
+
+/* the one in use, picked at load by pack32Kernel */
+static void (*Pack32)(uint8_t const *, uint64_t &, uint32_t &) = Pack32Plain;
+
+static struct Pack32Kernel {
+    Pack32Kernel() {
+#if CPU_DISPATCH
+        if (CPU::Best() >= CPU::avx2)
+            Pack32 = Pack32AVX2;
+#endif
+    }
+} const pack32Kernel;
+
+/* PackWord
+ *  packs "count", up to 32, of "ascii" into the bytes of "bases" and
+ *  "nmask" that they fill; a base other than A C G T packs as 0 with
+ *  its mask bit set, without a branch on it
+ */
+static void PackWord(uint8_t const *const ascii, unsigned const count, uint8_t *const bases, uint8_t *const nmask)
+{
+    uint64_t word = 0;
+    uint32_t mask = 0;
+    
+    if (count == 32)
+        Pack32(ascii, word, mask);
+    else {
+        for (unsigned k = 0; k < count; ++k) {
+            unsigned const code = baseCodes.code[ascii[k]];
+            
+            word |= (uint64_t)(code & 3) << (2 * k);
+            mask |= (uint32_t)(code >> 2) << k;
+        }
+    }
+    for (unsigned b = 0; b < (count + 3) / 4; ++b)
+        bases[b] = (uint8_t)(word >> (8 * b));
+    if (nmask) {
+        for (unsigned b = 0; b < (count + 7) / 8; ++b)
+            nmask[b] = (uint8_t)(mask >> (8 * b));
+    }
+}
+
+/* ReadPacked
+ *  copies the bases out of their lines a batch at a time, then packs
+ *  them 32 to a word
+ */
+uint64_t IndexedFasta::ReadPacked(unsigned const i, uint64_t const pos, uint64_t const count, uint8_t *const bases, uint8_t *const nmask) const
+{
+    uint8_t ascii[16 * 1024];
+    uint64_t packed = 0;
+    
+    while (packed < count) {
+        uint64_t const want = count - packed < sizeof(ascii) ? count - packed : sizeof(ascii);
+        uint64_t const got = Read(i, pos + packed, (char *)ascii, want);
+        
+        for (uint64_t k = 0; k < got; k += 32) {
+            uint64_t const at = packed + k;
+            
+            PackWord(ascii + k, got - k < 32 ? (unsigned)(got - k) : 32, bases + at / 4, nmask ? nmask + at / 8 : 0);
+        }
+        packed += got;
+        if (got < want)
+            break;
+    }
+    return packed;
+}
+
+void IndexedFasta::WillNeed(unsigned const i, uint64_t const pos, uint64_t const count) const
+{
+    /* only a hint, failures don't matter */
+    Sequence const &seq = sequences[i];
+    
+    if (pos >= seq.length || count == 0)
+        return;
+    
+    uint64_t const last = count < seq.length - pos ? pos + count - 1 : seq.length - 1;
+    uint64_t const page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t beg = Where(seq, pos);
+    uint64_t end = Where(seq, last) + 1;
+    
+    if (!blocks.empty()) {
+        /* the blocks that have them */
+        size_t const after = BlockOf(end - 1) + 1;
+        
+        beg = blocks[BlockOf(beg)].coffset;
+        end = after < blocks.size() ? blocks[after].coffset : map.size();
+    }
+    beg -= beg % page;
+    
+    madvise((void *)(map.data() + beg), (size_t)(end - beg), MADV_WILLNEED);
+}
@@ -0,0 +1,162 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_fasta_
+#define _hpp_fasta_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "bgzf.hpp"
+
+/* IndexedFasta
+ *  a FASTA file, mapped into memory, and its .fai index
+ *  a base is found by arithmetic on the line lengths in the index,
+ *  so the file is never scanned; the bases are in the case the file
+ *  has them in
+ *  a file compressed with bgzip is read a BGZF block at a time; where
+ *  each block starts, in the file and inflated, is read from its .gzi
+ *  or, without one, from the blocks' headers; the last CACHE_BLOCKS
+ *  inflated are kept, and lookups share them under a lock
+ */
+class IndexedFasta
+{
+    struct Sequence {
+        uint64_t length;
+        uint64_t offset;            /* of the first base */
+        uint64_t lineBases;
+        uint64_t lineBytes;         /* lineBases and the line end */
+    };
+    struct Block {
+        uint64_t coffset;           /* in the file */
+        uint64_t uoffset;           /* of its first byte, inflated */
+    };
+    struct Inflated {
+        BGZFBlock block;
+        uint64_t used;              /* when last looked at */
+    };
+    enum { CACHE_BLOCKS = 64 };
+
+    std::string path;
+    MappedFile map;
+    std::vector<Sequence> sequences;
+    std::map<std::string, unsigned> byName;
+    std::vector<Block> blocks;      /* of a compressed file, by offset; empty for any other */
+    uint64_t inflatedSize;          /* of that file */
+    mutable std::vector<Inflated *> cache;
+    mutable uint64_t clock;
+    mutable BGZFInflater inflater;
+    mutable pthread_mutex_t cacheLock;
+
+    IndexedFasta(IndexedFasta const &);
+    IndexedFasta &operator =(IndexedFasta const &);
+
+    uint64_t Where(Sequence const &seq, uint64_t const pos) const {
+        return seq.offset + pos / seq.lineBases * seq.lineBytes + pos % seq.lineBases;
+    }
+    bool LoadGzi(std::string const &gzipath);
+    void ScanBlocks();
+    size_t BlockOf(uint64_t const offset) const;
+    BGZFBlock const &Load(Block const &block) const;
+    void CopyInflated(uint64_t offset, size_t count, char *dst) const;
+public:
+    IndexedFasta();
+    ~IndexedFasta();
+
+    /* Open
+     *  map <fastapath> and load <fastapath>.fai
+     *  returns false if either can't be opened; throws if the
+     *  index is malformed or points outside of the file
+     */
+    bool Open(std::string const &fastapath);
+    bool isOpen() const {
+        return map.data() != 0;
+    }
+    /* isCompressed
+     *  with bgzip; then Chunk can't lend the bases
+     */
+    bool isCompressed() const {
+        return !blocks.empty();
+    }
+
+    /* Find
+     *  the sequence named "name", or -1
+     */
+    int Find(std::string const &name) const;
+    uint64_t getLength(unsigned const i) const {
+        return sequences[i].length;
+    }
+
+    /* LineSize
+     *  of up to "count" bases from "pos" to the end of their line
+     */
+    size_t LineSize(unsigned const i, uint64_t const pos, uint64_t const count) const;
+
+    /* Chunk
+     *  up to "count" bases from "pos" to the end of their line,
+     *  straight from a file that isn't compressed; sets "size" to the
+     *  number of bases
+     */
+    char const *Chunk(unsigned const i, uint64_t const pos, uint64_t const count, size_t &size) const;
+
+    /* Copy
+     *  sets "rslt" to "count" bases from "pos", or those up to the end
+     */
+    void Copy(unsigned const i, uint64_t const pos, uint64_t const count, std::string &rslt) const;
+
+    /* Read
+     *  copies up to "count" bases from "pos" into "buffer", a line at a
+     *  time; returns the number copied, fewer only at the end
+     */
+    uint64_t Read(unsigned const i, uint64_t const pos, char *const buffer, uint64_t const count) const;
+
+    /* ReadPacked
+     *  packs up to "count" bases from "pos" into "bases" and "nmask",
+     *  as Reference::getReferenceBasesPacked does; returns the number
+     *  packed, fewer only at the end
+     */
+    uint64_t ReadPacked(unsigned const i, uint64_t const pos, uint64_t const count, uint8_t *const bases, uint8_t *const nmask) const;
+
+    /* WillNeed
+     *  hints that the bases of [pos, pos + count) are to be read soon
+     */
+    void WillNeed(unsigned const i, uint64_t const pos, uint64_t const count) const;
+
+    char Base(unsigned const i, uint64_t const pos) const {
+        uint64_t const at = Where(sequences[i], pos);
+        char base;
+
+        if (blocks.empty())
+            return (char)map.data()[at];
+        CopyInflated(at, 1, &base);
+        return base;
+    }
+};
+
+#endif // _hpp_fasta_
@@ -0,0 +1,631 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "filter.hpp"
+#include "bam.hpp"
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+/* RecordParser
+ *  compiles an expression by recursive descent:
+ *    expr    := conj { "||" conj }
+ *    conj    := unary { "&&" unary }
+ *    unary   := "!" unary | "(" expr ")" | test
+ *    test    := operand [ cmp operand | "in" "{" const { "," const } "}" ]
+ *    operand := ( field | tag | const ) [ "&" integer ]
+ *  keeping count of how deep the stack gets
+ */
+class RecordParser
+{
+    typedef RecordProgram P;
+
+    P &program;
+    std::string const &expr;
+    size_t at;                      /* the next token */
+    unsigned depth;
+
+    void Fail(std::string const &what) const {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%u", (unsigned)at);
+        throw std::runtime_error("filter expression '" + expr + "': " + what + " at " + buf);
+    }
+    void Skip() {
+        while (at < expr.size() && (expr[at] == ' ' || expr[at] == '\t' || expr[at] == '\n' || expr[at] == '\r'))
+            ++at;
+    }
+    bool Accept(char const token[]) {
+        size_t const n = strlen(token);
+        
+        Skip();
+        if (expr.compare(at, n, token) != 0)
+            return false;
+        // "<" isn't the start of "<=", "!" of "!=" nor "&" of "&&"
+        if (n == 1 && at + 1 < expr.size() &&
+            ((expr[at + 1] == '=' && strchr("<>!", token[0])) || (token[0] == '&' && expr[at + 1] == '&')))
+            return false;
+        at += n;
+        return true;
+    }
+    void Expect(char const token[]) {
+        if (!Accept(token))
+            Fail(std::string("expected '") + token + "'");
+    }
+    static bool isIdent(char const ch, bool const first) {
+        return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_' || (!first && ch >= '0' && ch <= '9');
+    }
+    std::string Word() {
+        Skip();
+        size_t const start = at;
+        
+        if (at < expr.size() && isIdent(expr[at], true)) {
+            while (at < expr.size() && isIdent(expr[at], false))
+                ++at;
+        }
+        return expr.substr(start, at - start);
+    }
+    bool AcceptWord(char const word[]) {
+        size_t const start = at;
+        
+        if (Word() == word)
+            return true;
+        at = start;
+        return false;
+    }
+    bool AcceptCmp(P::Cmp &cmp) {
+        static struct { char const *token; P::Cmp cmp; } const cmps[] = {
+            { "==", P::eq }, { "!=", P::ne }, { "<=", P::le }, { ">=", P::ge }, { "<", P::lt }, { ">", P::gt }
+        };
+        for (unsigned i = 0; i < sizeof(cmps) / sizeof(cmps[0]); ++i) {
+            if (Accept(cmps[i].token)) {
+                cmp = cmps[i].cmp;
+                return true;
+            }
+        }
+        return false;
+    }
+    P::Instruction &Emit(P::Op const op, int const pushes) {
+        P::Instruction ins;
+        
+        memset(&ins, 0, sizeof(ins));
+        ins.op = op;
+        program.code.push_back(ins);
+        depth += pushes;
+        if (pushes > 0 && depth > P::MAX_DEPTH)
+            Fail("too deeply nested");
+        return program.code.back();
+    }
+    // a number or a string, if there is one
+    bool Constant(P::Constant &value) {
+        Skip();
+        memset(&value, 0, sizeof(value));
+        if (at < expr.size() && expr[at] == '"') {
+            size_t const end = expr.find('"', at + 1);
+            
+            if (end == std::string::npos)
+                Fail("unterminated string");
+            value.kind = P::Value::string;
+            value.offset = program.text.size();
+            value.length = end - at - 1;
+            program.text.append(expr, at + 1, value.length);
+            at = end + 1;
+            return true;
+        }
+        
+        char const *const start = expr.c_str() + at;
+        char const *const digits = *start == '-' ? start + 1 : start;
+        
+        if (!((*digits >= '0' && *digits <= '9') || (*digits == '.' && digits[1] >= '0' && digits[1] <= '9')))
+            return false;
+        
+        char *end;
+        
+        if (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+            value.kind = P::Value::integer;
+            value.i = strtoll(start, &end, 16);
+        }
+        else {
+            value.d = strtod(start, &end);
+            if (memchr(start, '.', end - start) || memchr(start, 'e', end - start) || memchr(start, 'E', end - start))
+                value.kind = P::Value::real;
+            else {
+                value.kind = P::Value::integer;
+                value.i = strtoll(start, &end, 10);
+            }
+        }
+        at += end - start;
+        if (at < expr.size() && isIdent(expr[at], false))
+            Fail("bad number");
+        return true;
+    }
+    void Operand() {
+        static struct { char const *name; P::Field field; } const fields[] = {
+            { "flag", P::flag }, { "mapq", P::mapq }, { "pos", P::pos }, { "mpos", P::mpos },
+            { "tlen", P::tlen }, { "rlen", P::rlen }, { "alen", P::alen }
+        };
+        P::Constant value;
+        
+        if (Constant(value)) {
+            Emit(P::pushConst, 1).first = (unsigned)program.constants.size();
+            program.constants.push_back(value);
+        }
+        else {
+            size_t const start = at;
+            std::string const word = Word();
+            unsigned i = 0;
+            
+            while (i < sizeof(fields) / sizeof(fields[0]) && word != fields[i].name)
+                ++i;
+            if (i < sizeof(fields) / sizeof(fields[0])) {
+                Emit(P::pushField, 1).field = fields[i].field;
+                program.rest |= fields[i].field == P::alen;
+            }
+            else if (word.size() == 2 && word[0] != '_' && word[1] != '_') {
+                P::Instruction &ins = Emit(P::pushTag, 1);
+                
+                ins.tag[0] = word[0];
+                ins.tag[1] = word[1];
+                program.rest = true;
+            }
+            else {
+                at = start;
+                Fail(word.empty() ? "expected a value" : "unknown field '" + word + "'");
+            }
+        }
+        if (Accept("&")) {
+            if (!Constant(value) || value.kind != P::Value::integer)
+                Fail("expected an integer");
+            Emit(P::mask, 0).bits = value.i;
+        }
+    }
+    void Test() {
+        P::Cmp cmp;
+        
+        Operand();
+        if (AcceptCmp(cmp)) {
+            Operand();
+            Emit(P::compare, -1).cmp = cmp;
+        }
+        else if (AcceptWord("in")) {
+            unsigned const first = (unsigned)program.constants.size();
+            P::Constant value;
+            
+            Expect("{");
+            do {
+                if (!Constant(value))
+                    Fail("expected a number or a string");
+                program.constants.push_back(value);
+            } while (Accept(","));
+            Expect("}");
+            
+            P::Instruction &ins = Emit(P::in, 0);
+            
+            ins.first = first;
+            ins.count = (unsigned)program.constants.size() - first;
+        }
+        else
+            Emit(P::test, 0);
+    }
+    void Unary() {
+        if (Accept("!")) {
+            Unary();
+            Emit(P::negate, 0);
+        }
+        else if (Accept("(")) {
+            Expr();
+            Expect(")");
+        }
+        else
+            Test();
+    }
+    void Conj() {
+        Unary();
+        while (Accept("&&")) {
+            Unary();
+            Emit(P::both, -1);
+        }
+    }
+    void Expr() {
+        Conj();
+        while (Accept("||")) {
+            Conj();
+            Emit(P::either, -1);
+        }
+    }
+public:
+    RecordParser(P &Program, std::string const &Expr)
+    : program(Program)
+    , expr(Expr)
+    , at(0)
+    , depth(0)
+    {}
+    
+    void Parse() {
+        Skip();
+        if (at == expr.size())
+            return;
+        Expr();
+        Skip();
+        if (at != expr.size())
+            Fail("unexpected '" + expr.substr(at, 1) + "'");
+    }
+};
+
+RecordProgram::RecordProgram(std::string const &expression)
+: rest(false)
+{
+    RecordParser(*this, expression).Parse();
+}
+
+RecordProgram::Value RecordProgram::getConstant(unsigned const i) const
+{
+    Constant const &c = constants[i];
+    Value const v = { c.kind, c.i, c.d, text.data() + c.offset, c.length };
+    
+    return v;
+}
+
+static RecordProgram::Value Truth(bool const yes)
+{
+    RecordProgram::Value const v = { RecordProgram::Value::integer, yes ? 1 : 0, 0, 0, 0 };
+    
+    return v;
+}
+
+static bool IsTrue(RecordProgram::Value const &v)
+{
+    switch (v.kind) {
+    case RecordProgram::Value::integer:
+        return v.i != 0;
+    case RecordProgram::Value::real:
+        return v.d != 0;
+    case RecordProgram::Value::string:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// numbers compare with numbers and strings with strings; a test of anything else is false
+static bool Order(RecordProgram::Value const &a, RecordProgram::Value const &b, int &order)
+{
+    typedef RecordProgram::Value V;
+    
+    if (a.kind == V::string && b.kind == V::string) {
+        int const diff = memcmp(a.s, b.s, a.n < b.n ? a.n : b.n);
+        
+        order = diff != 0 ? diff : a.n < b.n ? -1 : a.n > b.n ? 1 : 0;
+        return true;
+    }
+    if ((a.kind != V::integer && a.kind != V::real) || (b.kind != V::integer && b.kind != V::real))
+        return false;
+    if (a.kind == V::integer && b.kind == V::integer)
+        order = a.i < b.i ? -1 : a.i > b.i ? 1 : 0;
+    else {
+        double const x = a.kind == V::integer ? (double)a.i : a.d;
+        double const y = b.kind == V::integer ? (double)b.i : b.d;
+        
+        order = x < y ? -1 : x > y ? 1 : 0;
+    }
+    return true;
+}
+
+template <class Get>
+bool RecordProgram::Run(Get const &get) const
+{
+    Value stack[MAX_DEPTH];
+    unsigned top = 0;
+    
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        Instruction const &ins = code[pc];
+        
+        switch (ins.op) {
+        case pushField:
+            stack[top++] = get.Field(ins.field);
+            break;
+        case pushTag:
+            stack[top++] = get.Tag(ins.tag);
+            break;
+        case pushConst:
+            stack[top++] = getConstant(ins.first);
+            break;
+        case mask:
+            if (stack[top - 1].kind == Value::integer)
+                stack[top - 1].i &= ins.bits;
+            else
+                stack[top - 1].kind = Value::none;
+            break;
+        case compare: {
+            int order;
+            bool yes = false;
+            
+            --top;
+            if (Order(stack[top - 1], stack[top], order)) {
+                switch (ins.cmp) {
+                case eq: yes = order == 0; break;
+                case ne: yes = order != 0; break;
+                case lt: yes = order < 0; break;
+                case le: yes = order <= 0; break;
+                case gt: yes = order > 0; break;
+                case ge: yes = order >= 0; break;
+                }
+            }
+            stack[top - 1] = Truth(yes);
+            break;
+        }
+        case in: {
+            int order;
+            bool yes = false;
+            
+            for (unsigned i = 0; i < ins.count && !yes; ++i)
+                yes = Order(stack[top - 1], getConstant(ins.first + i), order) && order == 0;
+            stack[top - 1] = Truth(yes);
+            break;
+        }
+        case test:
+            stack[top - 1] = Truth(IsTrue(stack[top - 1]));
+            break;
+        case negate:
+            stack[top - 1] = Truth(!IsTrue(stack[top - 1]));
+            break;
+        case both:
+            --top;
+            stack[top - 1] = Truth(IsTrue(stack[top - 1]) && IsTrue(stack[top]));
+            break;
+        case either:
+            --top;
+            stack[top - 1] = Truth(IsTrue(stack[top - 1]) || IsTrue(stack[top]));
+            break;
+        }
+    }
+    return code.empty() || IsTrue(stack[0]);
+}
+
+/* RawRecord
+ *  the fields and tags of a record, from its bytes
+ */
+struct RawRecord
+{
+    typedef RecordProgram::Value Value;
+    
+    BAMRecord const &rec;
+    
+    explicit RawRecord(BAMRecord const &Rec) : rec(Rec) {}
+    
+    static Value Integer(int64_t const i) {
+        Value const v = { Value::integer, i, 0, 0, 0 };
+        return v;
+    }
+    Value Field(RecordProgram::Field const what) const {
+        switch (what) {
+        case RecordProgram::flag: return Integer(rec.flag());
+        case RecordProgram::mapq: return Integer(rec.mq());
+        case RecordProgram::pos:  return Integer(rec.pos());
+        case RecordProgram::mpos: return Integer(rec.next_pos());
+        case RecordProgram::tlen: return Integer(rec.tlen());
+        case RecordProgram::rlen: return Integer(rec.l_seq());
+        case RecordProgram::alen: return Integer(rec.refLen());
+        }
+        return Value();
+    }
+    Value Tag(char const tag[2]) const {
+        BAMRecord::OptionalField const *const field = rec.findTag(tag);
+        Value v = { Value::none, 0, 0, 0, 0 };
+        
+        if (field == 0 || field->isArray())
+            return v;
+        
+        char const *const raw = field->getRawValue();
+        
+        switch (field->getValueType()) {
+        case 'c': return Integer(*(int8_t const *)raw);
+        case 'C': return Integer(*(uint8_t const *)raw);
+        case 's': return Integer(LE2Host<int16_t>(raw));
+        case 'S': return Integer(LE2Host<uint16_t>(raw));
+        case 'i': return Integer(LE2Host<int32_t>(raw));
+        case 'I': return Integer(LE2Host<uint32_t>(raw));
+        case 'f':
+            v.kind = Value::real;
+            v.d = LE2Host<float>(raw);
+            break;
+        case 'A':
+            v.kind = Value::string;
+            v.s = raw;
+            v.n = 1;
+            break;
+        case 'Z':
+        case 'H':
+            v.kind = Value::string;
+            v.s = raw;
+            v.n = field->getElementSize();
+            break;
+        }
+        return v;
+    }
+};
+
+/* FromSource
+ *  the same of a RecordProgram::Source
+ */
+struct FromSource
+{
+    RecordProgram::Source const &src;
+    
+    explicit FromSource(RecordProgram::Source const &Src) : src(Src) {}
+    
+    RecordProgram::Value Field(RecordProgram::Field const what) const {
+        return src.getField(what);
+    }
+    RecordProgram::Value Tag(char const tag[2]) const {
+        return src.getTag(tag);
+    }
+};
+
+bool RecordProgram::Accepts(BAMRecord const &rec) const
+{
+    return Run(RawRecord(rec));
+}
+
+bool RecordProgram::Accepts(Source const &src) const
+{
+    return Run(FromSource(src));
+}
+
+/* Span
+ *  what RejectsAll knows of a value: if known, that it is in [lo, hi],
+ *  and if bits as well, that it has all of lo's bits and none not in hi;
+ *  a truth is [0, 0], [1, 1], or [0, 1] if it could be either
+ */
+struct Span
+{
+    bool known;
+    bool bits;
+    double lo;
+    double hi;
+    int64_t all;
+    int64_t any;
+    
+    static Span Unknown() {
+        Span const s = { false, false, 0, 0, 0, 0 };
+        return s;
+    }
+    static Span Between(double const lo, double const hi) {
+        Span const s = { true, false, lo, hi, 0, 0 };
+        return s;
+    }
+    static Span Bits(int64_t const all, int64_t const any) {
+        Span const s = { true, true, (double)all, (double)any, all, any };
+        return s;
+    }
+    static Span Truth(bool const canBeFalse, bool const canBeTrue) {
+        return Between(canBeFalse ? 0 : 1, canBeTrue ? 1 : 0);
+    }
+    bool canBeTrue() const {
+        return !known || lo != 0 || hi != 0;
+    }
+    bool canBeFalse() const {
+        return !known || (lo <= 0 && hi >= 0);
+    }
+};
+
+static Span Compare(int const cmp, Span const &a, Span const &b)
+{
+    if (!a.known || !b.known)
+        return Span::Truth(true, true);
+    
+    bool const same = a.lo == a.hi && b.lo == b.hi && a.lo == b.lo;
+    bool const apart = a.hi < b.lo || a.lo > b.hi;
+    
+    switch (cmp) {
+    case 0: return Span::Truth(!same, !apart);                              // eq
+    case 1: return Span::Truth(!apart, !same);                              // ne
+    case 2: return Span::Truth(!(a.hi < b.lo), a.lo < b.hi);                // lt
+    case 3: return Span::Truth(!(a.hi <= b.lo), a.lo <= b.hi);              // le
+    case 4: return Span::Truth(!(a.lo > b.hi), a.hi > b.lo);                // gt
+    default: return Span::Truth(!(a.lo >= b.hi), a.hi >= b.lo);             // ge
+    }
+}
+
+bool RecordProgram::RejectsAll(Range const ranges[]) const
+{
+    if (code.empty())
+        return false;
+    
+    Span stack[MAX_DEPTH];
+    unsigned top = 0;
+    
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        Instruction const &ins = code[pc];
+        
+        switch (ins.op) {
+        case pushField: {
+            Range const &r = ranges[ins.field];
+            
+            stack[top++] = !r.known ? Span::Unknown()
+                         : ins.field == flag ? Span::Bits(r.lo, r.hi)
+                         : Span::Between((double)r.lo, (double)r.hi);
+            break;
+        }
+        case pushTag:
+            stack[top++] = Span::Unknown();
+            break;
+        case pushConst: {
+            Value const v = getConstant(ins.first);
+            
+            stack[top++] = v.kind == Value::integer ? Span::Between((double)v.i, (double)v.i)
+                         : v.kind == Value::real ? Span::Between(v.d, v.d)
+                         : Span::Unknown();
+            break;
+        }
+        case mask: {
+            Span &s = stack[top - 1];
+            
+            s = s.bits ? Span::Bits(s.all & ins.bits, s.any & ins.bits) : Span::Unknown();
+            break;
+        }
+        case compare:
+            --top;
+            stack[top - 1] = Compare(ins.cmp, stack[top - 1], stack[top]);
+            break;
+        case in: {
+            bool canBeTrue = false;
+            bool canBeFalse = true;
+            
+            for (unsigned i = 0; i < ins.count; ++i) {
+                Value const v = getConstant(ins.first + i);
+                Span const c = v.kind == Value::integer ? Span::Between((double)v.i, (double)v.i)
+                             : v.kind == Value::real ? Span::Between(v.d, v.d)
+                             : Span::Unknown();
+                Span const eq = Compare(0, stack[top - 1], c);
+                
+                canBeTrue = canBeTrue || eq.canBeTrue();
+                canBeFalse = canBeFalse && eq.canBeFalse();
+            }
+            stack[top - 1] = Span::Truth(canBeFalse, canBeTrue);
+            break;
+        }
+        case test:
+            stack[top - 1] = Span::Truth(stack[top - 1].canBeFalse(), stack[top - 1].canBeTrue());
+            break;
+        case negate:
+            stack[top - 1] = Span::Truth(stack[top - 1].canBeTrue(), stack[top - 1].canBeFalse());
+            break;
+        case both:
+            --top;
+            stack[top - 1] = Span::Truth(stack[top - 1].canBeFalse() || stack[top].canBeFalse(),
+                                         stack[top - 1].canBeTrue() && stack[top].canBeTrue());
+            break;
+        case either:
+            --top;
+            stack[top - 1] = Span::Truth(stack[top - 1].canBeFalse() && stack[top].canBeFalse(),
+                                         stack[top - 1].canBeTrue() || stack[top].canBeTrue());
+            break;
+        }
+    }
+    return !stack[0].canBeTrue();
+}
@@ -0,0 +1,137 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_filter_
+#define _hpp_filter_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+class BAMRecord;
+
+/* RecordProgram
+ *  a filter expression, see NGS_BAM::RecordFilter, compiled once to the
+ *  code of a small stack machine, which is run on each record as it is
+ *  read, on its raw bytes; an empty program accepts every record
+ */
+class RecordProgram
+{
+public:
+    enum Field { flag, mapq, pos, mpos, tlen, rlen, alen };
+
+    struct Value {
+        enum Kind { none, integer, real, string } kind;
+        int64_t i;
+        double d;
+        char const *s;
+        size_t n;
+    };
+
+    /* Source
+     *  the fields and tags of what isn't a raw record, e.g. an
+     *  alignment of another engine; none if it can't tell
+     */
+    class Source {
+    public:
+        virtual ~Source() {}
+        virtual Value getField(Field const what) const = 0;
+        virtual Value getTag(char const tag[2]) const = 0;
+    };
+
+    RecordProgram() : rest(false) {}
+
+    /* throws std::runtime_error if "expression" isn't one */
+    explicit RecordProgram(std::string const &expression);
+
+    bool isEmpty() const {
+        return code.empty();
+    }
+
+    /* needsRest
+     *  whether it tests more than the fixed part of a record, which is
+     *  all that is read of the records it rejects otherwise
+     */
+    bool needsRest() const {
+        return rest;
+    }
+
+    bool Accepts(BAMRecord const &rec) const;
+    bool Accepts(Source const &src) const;
+
+    /* Range
+     *  what is known of a field over a run of records, that it is in
+     *  [lo, hi]; of flag, lo is the bits every record has and hi the
+     *  bits any record has
+     */
+    struct Range {
+        bool known;
+        int64_t lo;
+        int64_t hi;
+    };
+
+    /* RejectsAll
+     *  whether it would reject every record whose fields are in
+     *  "ranges", one for each Field; what tags are isn't known
+     */
+    bool RejectsAll(Range const ranges[]) const;
+
+    enum { MAX_DEPTH = 32 };        /* of the stack */
+private:
+    enum Op { pushField, pushTag, pushConst, mask, compare, in, test, negate, both, either };
+    enum Cmp { eq, ne, lt, le, gt, ge };
+
+    struct Constant {
+        Value::Kind kind;
+        int64_t i;
+        double d;
+        size_t offset;              /* of a string, into text */
+        size_t length;
+    };
+    struct Instruction {
+        Op op;
+        Cmp cmp;
+        Field field;
+        char tag[2];
+        int64_t bits;               /* of mask */
+        unsigned first;             /* of constants, pushConst and in */
+        unsigned count;
+    };
+    friend class RecordParser;
+
+    std::string text;               /* the string constants */
+    std::vector<Constant> constants;
+    std::vector<Instruction> code;
+    bool rest;
+
+    Value getConstant(unsigned const i) const;
+
+    template <class Get>
+    bool Run(Get const &get) const;
+};
+
+#endif // _hpp_filter_
@@ -0,0 +1,713 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "htsget.hpp"
+#include "source.hpp"
+#include "memory.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <stdexcept>
+#include <cstdio>
+
+#if HAVE_LIBCURL
+#include <curl/curl.h>
+#endif
+
+/* JSONText
+ *  just enough of a JSON reader for a ticket: its strings, and the
+ *  rest passed over
+ */
+class JSONText
+{
+    std::string const &text;
+    size_t at;
+
+    static void Bad() {
+        throw std::runtime_error("not an htsget ticket");
+    }
+    void Space() {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\n' || text[at] == '\r'))
+            ++at;
+    }
+    unsigned Hex4() {
+        unsigned value = 0;
+
+        if (at + 4 > text.size())
+            Bad();
+        for (unsigned i = 0; i < 4; ++i) {
+            int const ch = text[at++];
+
+            value <<= 4;
+            if (ch >= '0' && ch <= '9')
+                value |= ch - '0';
+            else if (ch >= 'a' && ch <= 'f')
+                value |= ch - 'a' + 10;
+            else if (ch >= 'A' && ch <= 'F')
+                value |= ch - 'A' + 10;
+            else
+                Bad();
+        }
+        return value;
+    }
+    static void AppendUTF8(std::string &dst, unsigned const cp) {
+        if (cp < 0x80)
+            dst.push_back((char)cp);
+        else if (cp < 0x800) {
+            dst.push_back((char)(0xC0 | (cp >> 6)));
+            dst.push_back((char)(0x80 | (cp & 0x3F)));
+        }
+        else if (cp < 0x10000) {
+            dst.push_back((char)(0xE0 | (cp >> 12)));
+            dst.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            dst.push_back((char)(0x80 | (cp & 0x3F)));
+        }
+        else {
+            dst.push_back((char)(0xF0 | (cp >> 18)));
+            dst.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+            dst.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            dst.push_back((char)(0x80 | (cp & 0x3F)));
+        }
+    }
+public:
+    explicit JSONText(std::string const &Text)
+    : text(Text)
+    , at(0)
+    {}
+
+    bool Accept(char const ch) {
+        Space();
+        if (at < text.size() && text[at] == ch) {
+            ++at;
+            return true;
+        }
+        return false;
+    }
+    void Expect(char const ch) {
+        if (!Accept(ch))
+            Bad();
+    }
+    /* More
+     *  whether there is another member or element before "close";
+     *  "first" is set before the first call for an object or array
+     */
+    bool More(char const close, bool &first) {
+        if (Accept(close))
+            return false;
+        if (!first)
+            Expect(',');
+        first = false;
+        return true;
+    }
+    bool AtEnd() {
+        Space();
+        return at == text.size();
+    }
+    std::string String() {
+        std::string rslt;
+
+        Expect('"');
+        for ( ; ; ) {
+            if (at >= text.size())
+                Bad();
+
+            char const ch = text[at++];
+
+            if (ch == '"')
+                return rslt;
+            if ((unsigned char)ch < 0x20)
+                Bad();
+            if (ch != '\\') {
+                rslt.push_back(ch);
+                continue;
+            }
+            if (at >= text.size())
+                Bad();
+            switch (text[at++]) {
+            case '"':  rslt.push_back('"');  break;
+            case '\\': rslt.push_back('\\'); break;
+            case '/':  rslt.push_back('/');  break;
+            case 'b':  rslt.push_back('\b'); break;
+            case 'f':  rslt.push_back('\f'); break;
+            case 'n':  rslt.push_back('\n'); break;
+            case 'r':  rslt.push_back('\r'); break;
+            case 't':  rslt.push_back('\t'); break;
+            case 'u': {
+                unsigned cp = Hex4();
+
+                if (cp >= 0xD800 && cp < 0xDC00 && text.compare(at, 2, "\\u") == 0) {
+                    at += 2;
+
+                    unsigned const low = Hex4();
+
+                    if (low < 0xDC00 || low >= 0xE000)
+                        Bad();
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                AppendUTF8(rslt, cp);
+                break;
+            }
+            default:
+                Bad();
+            }
+        }
+    }
+    /* Key
+     *  a member's name, and the ':' after it
+     */
+    std::string Key() {
+        std::string const key = String();
+
+        Expect(':');
+        return key;
+    }
+    void Skip(unsigned const depth = 0) {
+        if (depth > 64)
+            Bad();
+        Space();
+        if (at >= text.size())
+            Bad();
+
+        bool first = true;
+
+        switch (text[at]) {
+        case '"':
+            String();
+            return;
+        case '{':
+            ++at;
+            while (More('}', first)) {
+                Key();
+                Skip(depth + 1);
+            }
+            return;
+        case '[':
+            ++at;
+            while (More(']', first))
+                Skip(depth + 1);
+            return;
+        default: {
+            /* a number, true, false or null */
+            size_t const start = at;
+
+            while (at < text.size() && strchr(",}] \t\n\r", text[at]) == 0)
+                ++at;
+            if (at == start)
+                Bad();
+        }
+        }
+    }
+};
+
+static void ParseURLs(JSONText &in, std::vector<HtsgetBlock> &blocks)
+{
+    bool first = true;
+
+    in.Expect('[');
+    while (in.More(']', first)) {
+        HtsgetBlock block;
+        bool member = true;
+
+        in.Expect('{');
+        while (in.More('}', member)) {
+            std::string const key = in.Key();
+
+            if (key == "url")
+                block.url = in.String();
+            else if (key == "headers") {
+                bool header = true;
+
+                in.Expect('{');
+                while (in.More('}', header)) {
+                    std::string const name = in.Key();
+
+                    block.headers.push_back(name + ": " + in.String());
+                }
+            }
+            else
+                in.Skip();
+        }
+        if (block.url.compare(0, 5, "data:") != 0 && block.url.compare(0, 7, "http://") != 0
+            && block.url.compare(0, 8, "https://") != 0)
+        {
+            throw std::runtime_error("the htsget ticket has a URL that can't be fetched");
+        }
+        blocks.push_back(block);
+    }
+}
+
+void ParseHtsgetTicket(std::string const &json, std::string &format, std::vector<HtsgetBlock> &blocks)
+{
+    JSONText in(json);
+    std::string error;
+    std::string message;
+    bool found = false;
+    bool first = true;
+
+    format.clear();
+    blocks.clear();
+    in.Expect('{');
+    while (in.More('}', first)) {
+        if (in.Key() != "htsget") {
+            in.Skip();
+            continue;
+        }
+
+        bool member = true;
+
+        found = true;
+        in.Expect('{');
+        while (in.More('}', member)) {
+            std::string const key = in.Key();
+
+            if (key == "format")
+                format = in.String();
+            else if (key == "urls")
+                ParseURLs(in, blocks);
+            else if (key == "error")
+                error = in.String();
+            else if (key == "message")
+                message = in.String();
+            else
+                in.Skip();
+        }
+    }
+    if (!in.AtEnd() || !found)
+        throw std::runtime_error("not an htsget ticket");
+    if (!error.empty())
+        throw std::runtime_error(message.empty() ? error : error + ": " + message);
+}
+
+std::string HtsgetTicketURL(std::string const &path)
+{
+    std::string url;
+
+    if (path.compare(0, 9, "htsget://") == 0)
+        url = "https://" + path.substr(9);
+    else if (path.compare(0, 14, "htsget+http://") == 0)
+        url = "http://" + path.substr(14);
+    else if (path.compare(0, 15, "htsget+https://") == 0)
+        url = "https://" + path.substr(15);
+    else
+        throw std::runtime_error(std::string("The file '")+path+"' is not an htsget path");
+
+    size_t const query = url.find('?');
+
+    if (query == std::string::npos)
+        return url + "?format=BAM";
+    if (url.find("?format=") == std::string::npos && url.find("&format=") == std::string::npos)
+        url += "&format=BAM";
+    return url;
+}
+
+std::string HtsgetRegionPath(std::string const &path, std::string const &name, uint64_t const beg, uint64_t const end)
+{
+    static char const hex[] = "0123456789ABCDEF";
+    size_t const query = path.find('?');
+    std::string rslt(path, 0, query);
+    char sep = '?';
+
+    /* the rest of the query, without the region */
+    if (query != std::string::npos) {
+        size_t at = query + 1;
+
+        while (at <= path.size()) {
+            size_t const amp = path.find('&', at);
+            size_t const stop = amp == std::string::npos ? path.size() : amp;
+            std::string const param(path, at, stop - at);
+            std::string const key(param, 0, param.find('='));
+
+            if (!param.empty() && key != "referenceName" && key != "start" && key != "end") {
+                rslt += sep;
+                rslt += param;
+                sep = '&';
+            }
+            at = stop + 1;
+        }
+    }
+    rslt += sep;
+    rslt += "referenceName=";
+    for (size_t i = 0; i < name.size(); ++i) {
+        unsigned char const ch = name[i];
+
+        if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || strchr("-._~", ch) != 0)
+            rslt += (char)ch;
+        else {
+            rslt += '%';
+            rslt += hex[ch >> 4];
+            rslt += hex[ch & 0xF];
+        }
+    }
+
+    char range[64];
+
+    snprintf(range, sizeof(range), "&start=%llu&end=%llu", (unsigned long long)beg, (unsigned long long)end);
+    return rslt + range;
+}
+
+static int HexValue(int const ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+static int Base64Value(int const ch)
+{
+    if (ch >= 'A' && ch <= 'Z')
+        return ch - 'A';
+    if (ch >= 'a' && ch <= 'z')
+        return ch - 'a' + 26;
+    if (ch >= '0' && ch <= '9')
+        return ch - '0' + 52;
+    if (ch == '+' || ch == '-')
+        return 62;
+    if (ch == '/' || ch == '_')
+        return 63;
+    return -1;
+}
+
+bool DecodeDataURI(std::string const &uri, std::vector<uint8_t> &rslt)
+{
+    static char const b64[] = ";base64";
+    size_t const comma = uri.find(',');
+
+    rslt.clear();
+    if (uri.compare(0, 5, "data:") != 0 || comma == std::string::npos)
+        return false;
+
+    size_t const n = sizeof(b64) - 1;
+    bool const base64 = comma >= 5 + n && uri.compare(comma - n, n, b64) == 0;
+
+    if (base64) {
+        unsigned bits = 0;
+        unsigned count = 0;
+
+        rslt.reserve((uri.size() - comma) / 4 * 3);
+        for (size_t i = comma + 1; i < uri.size(); ++i) {
+            int const value = Base64Value((unsigned char)uri[i]);
+
+            if (value < 0) {
+                if (uri[i] == '=' || uri[i] == ' ' || uri[i] == '\n' || uri[i] == '\r')
+                    continue;
+                return false;
+            }
+            bits = (bits << 6) | value;
+            if ((count += 6) >= 8) {
+                count -= 8;
+                rslt.push_back((uint8_t)(bits >> count));
+            }
+        }
+        return true;
+    }
+    for (size_t i = comma + 1; i < uri.size(); ++i) {
+        if (uri[i] != '%')
+            rslt.push_back((uint8_t)uri[i]);
+        else {
+            int const hi = i + 2 < uri.size() ? HexValue((unsigned char)uri[i + 1]) : -1;
+            int const lo = hi < 0 ? -1 : HexValue((unsigned char)uri[i + 2]);
+
+            if (lo < 0)
+                return false;
+            rslt.push_back((uint8_t)((hi << 4) | lo));
+            i += 2;
+        }
+    }
+    return true;
+}
+
+#if HAVE_LIBCURL
+
+/* a ticket is small; anything much bigger isn't one */
+static size_t const maxTicket = 16u * 1024u * 1024u;
+
+struct HtsgetFeed::Transfer
+{
+    HtsgetFeed *feed;
+    size_t block;
+    CURL *curl;                     /* NULL unless it is being fetched */
+    curl_slist *headers;
+    std::vector<uint8_t> data;
+    size_t taken;                   /* of data, by Read */
+    bool done;
+    bool paused;                    /* holds FEED_AHEAD bytes */
+};
+
+static size_t WriteTicket(char *const ptr, size_t const size, size_t const nmemb, void *const arg)
+{
+    std::string &body = *static_cast<std::string *>(arg);
+    size_t const n = size * nmemb;
+
+    if (body.size() + n > maxTicket)
+        return 0;
+    body.append(ptr, n);
+    return n;
+}
+
+size_t HtsgetFeed::Write(char *const ptr, size_t const size, size_t const nmemb, void *const arg)
+{
+    Transfer &t = *static_cast<Transfer *>(arg);
+    size_t const n = size * nmemb;
+    size_t const before = t.data.capacity();
+
+    if (t.block != t.feed->front && t.data.size() - t.taken >= FEED_AHEAD) {
+        t.paused = true;
+        return CURL_WRITEFUNC_PAUSE;
+    }
+    t.data.insert(t.data.end(), ptr, ptr + n);
+    if (t.feed->memory && t.data.capacity() > before)
+        t.feed->memory->Add(MemoryLedger::remoteWindows, t.data.capacity() - before);
+    return n;
+}
+
+HtsgetFeed::HtsgetFeed(std::string const &Path, MemoryLedger *const Memory)
+: path(Path)
+, memory(Memory)
+, multi(0)
+, front(0)
+{
+    InitCurl();
+    FetchTicket();
+    multi = curl_multi_init();
+    if (multi == 0)
+        throw std::runtime_error(std::string("The file '")+path+"' could not be opened");
+}
+
+HtsgetFeed::~HtsgetFeed()
+{
+    for (size_t i = 0; i < transfers.size(); ++i)
+        Finish(*transfers[i]);
+    for (size_t i = 0; i < transfers.size(); ++i)
+        delete transfers[i];
+    if (multi)
+        curl_multi_cleanup(static_cast<CURLM *>(multi));
+}
+
+/* FetchTicket
+ *  the blocks of the ticket; an error the server explains is thrown
+ *  with its explanation
+ */
+void HtsgetFeed::FetchTicket(void)
+{
+    std::string const url = HtsgetTicketURL(path);
+    CURL *const handle = curl_easy_init();
+    curl_slist *headers = 0;
+    std::string body;
+    long code = 0;
+
+    if (handle == 0)
+        throw std::runtime_error(std::string("The file '")+path+"' could not be opened");
+
+    char const *const token = getenv("NGS_BAM_HTSGET_TOKEN");
+
+    headers = curl_slist_append(headers, "Accept: application/vnd.ga4gh.htsget.v1.3.0+json, application/json");
+    if (token && token[0])
+        headers = curl_slist_append(headers, (std::string("Authorization: Bearer ") + token).c_str());
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteTicket);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &body);
+
+    CURLcode const rc = curl_easy_perform(handle);
+
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+    curl_easy_cleanup(handle);
+    curl_slist_free_all(headers);
+
+    if (rc != CURLE_OK)
+        throw std::runtime_error(std::string("The file '")+path+"' could not be opened: "+curl_easy_strerror(rc));
+
+    std::string format;
+    char status[32];
+
+    snprintf(status, sizeof(status), "HTTP status %ld", code);
+    try {
+        ParseHtsgetTicket(body, format, blocks);
+    }
+    catch (std::exception const &e) {
+        /* an error the server doesn't explain is told by its status */
+        bool const unexplained = code != 200 && strcmp(e.what(), "not an htsget ticket") == 0;
+
+        throw std::runtime_error(std::string("The file '")+path+"' could not be opened: "+(unexplained ? status : e.what()));
+    }
+    if (code != 200)
+        throw std::runtime_error(std::string("The file '")+path+"' could not be opened: "+status);
+    if (!format.empty() && format != "BAM")
+        throw std::runtime_error(std::string("The file '")+path+"' could not be opened: its ticket is for "+format+", not BAM");
+}
+
+/* Start
+ *  the blocks from the front, up to FEED_TRANSFERS being fetched; a
+ *  data: block is done at once
+ */
+void HtsgetFeed::Start(void)
+{
+    unsigned active = 0;
+
+    for (size_t i = front; i < transfers.size(); ++i) {
+        if (transfers[i]->curl)
+            ++active;
+    }
+    while (transfers.size() < blocks.size() && active < FEED_TRANSFERS) {
+        HtsgetBlock const &block = blocks[transfers.size()];
+        Transfer *const t = new Transfer();
+
+        t->feed = this;
+        t->block = transfers.size();
+        t->curl = 0;
+        t->headers = 0;
+        t->taken = 0;
+        t->done = false;
+        t->paused = false;
+        transfers.push_back(t);
+
+        if (block.url.compare(0, 5, "data:") == 0) {
+            if (!DecodeDataURI(block.url, t->data))
+                throw std::runtime_error(std::string("The file '")+path+"' could not be read: its ticket has a bad data: URL");
+            if (memory)
+                memory->Add(MemoryLedger::remoteWindows, t->data.capacity());
+            t->done = true;
+            continue;
+        }
+        for (size_t j = 0; j < block.headers.size(); ++j)
+            t->headers = curl_slist_append(t->headers, block.headers[j].c_str());
+
+        CURL *const handle = curl_easy_init();
+
+        if (handle == 0)
+            throw std::runtime_error(std::string("The file '")+path+"' could not be read");
+        curl_easy_setopt(handle, CURLOPT_URL, block.url.c_str());
+        curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);  /* an error page isn't data */
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, t->headers);
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, Write);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, t);
+        curl_easy_setopt(handle, CURLOPT_PRIVATE, t);
+        curl_multi_add_handle(static_cast<CURLM *>(multi), handle);
+        t->curl = handle;
+        ++active;
+    }
+}
+
+/* Finish
+ *  what the block was fetched with, and what it held, let go
+ */
+void HtsgetFeed::Finish(Transfer &t)
+{
+    if (t.curl) {
+        curl_multi_remove_handle(static_cast<CURLM *>(multi), t.curl);
+        curl_easy_cleanup(t.curl);
+        t.curl = 0;
+    }
+    if (t.headers) {
+        curl_slist_free_all(t.headers);
+        t.headers = 0;
+    }
+    if (memory)
+        memory->Remove(MemoryLedger::remoteWindows, t.data.capacity());
+    std::vector<uint8_t>().swap(t.data);
+    t.taken = 0;
+}
+
+/* Perform
+ *  waits for any of the transfers to move on, and moves them on
+ */
+void HtsgetFeed::Perform(void)
+{
+    CURLM *const m = static_cast<CURLM *>(multi);
+    int running = 0;
+    int left = 0;
+    CURLMsg *msg;
+
+    curl_multi_wait(m, 0, 0, 1000, 0);
+    if (curl_multi_perform(m, &running) != CURLM_OK)
+        throw std::runtime_error(std::string("The file '")+path+"' could not be read");
+    while ((msg = curl_multi_info_read(m, &left)) != 0) {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        Transfer *t = 0;
+        long code = 0;
+        CURLcode const rc = msg->data.result;
+
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&t);
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &code);
+        curl_multi_remove_handle(m, t->curl);
+        curl_easy_cleanup(t->curl);
+        t->curl = 0;
+        t->done = true;
+        if (rc != CURLE_OK || (code != 200 && code != 206)) {
+            char reason[80];
+
+            if (rc == CURLE_OK || rc == CURLE_HTTP_RETURNED_ERROR)
+                snprintf(reason, sizeof(reason), "block %u of its ticket: HTTP status %ld", (unsigned)(t->block + 1), code);
+            else
+                snprintf(reason, sizeof(reason), "block %u of its ticket: %s", (unsigned)(t->block + 1), curl_easy_strerror(rc));
+            throw std::runtime_error(std::string("The file '")+path+"' could not be read: "+reason);
+        }
+    }
+}
+
+size_t HtsgetFeed::Read(void *const dst, size_t const length)
+{
+    while (front < blocks.size()) {
+        Start();
+
+        Transfer &t = *transfers[front];
+
+        if (t.taken < t.data.size()) {
+            size_t const avail = t.data.size() - t.taken;
+            size_t const n = length < avail ? length : avail;
+
+            memcpy(dst, &t.data[t.taken], n);
+            t.taken += n;
+            if (t.taken == t.data.size()) {
+                t.data.clear();
+                t.taken = 0;
+            }
+            return n;
+        }
+        if (t.done) {
+            Finish(t);
+            if (++front < transfers.size() && transfers[front]->paused) {
+                transfers[front]->paused = false;
+                curl_easy_pause(transfers[front]->curl, CURLPAUSE_CONT);
+            }
+            continue;
+        }
+        Perform();
+    }
+    return 0;
+}
+
+#endif
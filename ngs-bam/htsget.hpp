@@ -0,0 +1,129 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_htsget_
+#define _hpp_htsget_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+class MemoryLedger;
+
+/* htsget
+ *  a file on an htsget server is asked for with a ticket, a JSON
+ *  object that lists the URLs whose bodies, one after the other, are
+ *  a BAM file of what was asked for, and often of a little around it
+ *
+ *  its path is htsget://host/prefix/reads/<id>, whose ticket is at
+ *  https://host/prefix/reads/<id>, or htsget+http://... for a server
+ *  without TLS; the query is kept, so a path may name a region, e.g.
+ *  htsget://host/reads/NA12878?referenceName=chr1&start=0&end=1000000
+ *  the ticket request has the bearer token of NGS_BAM_HTSGET_TOKEN, if
+ *  it is set; the URLs are fetched with the headers the ticket gives
+ */
+
+/* HtsgetBlock
+ *  one of the URLs of a ticket
+ */
+struct HtsgetBlock
+{
+    std::string url;                    /* http(s):// or data: */
+    std::vector<std::string> headers;   /* "Name: value", to be sent with it */
+};
+
+/* ParseHtsgetTicket
+ *  the format and blocks of a ticket; throws the server's error and
+ *  message if it is an error, and if it isn't a ticket
+ */
+void ParseHtsgetTicket(std::string const &json, std::string &format, std::vector<HtsgetBlock> &blocks);
+
+/* HtsgetTicketURL
+ *  where the ticket of "path" is asked for, with format=BAM unless it
+ *  has a format
+ */
+std::string HtsgetTicketURL(std::string const &path);
+
+/* HtsgetRegionPath
+ *  the path of what of "path" overlaps [beg, end) of reference "name",
+ *  0-based; the region "path" may have is replaced
+ */
+std::string HtsgetRegionPath(std::string const &path, std::string const &name, uint64_t const beg, uint64_t const end);
+
+/* DecodeDataURI
+ *  the bytes of a data: URI, base64 or percent-encoded
+ *  returns false if it isn't one
+ */
+bool DecodeDataURI(std::string const &uri, std::vector<uint8_t> &rslt);
+
+#if HAVE_LIBCURL
+
+/* HtsgetFeed
+ *  the bytes of a path's ticket, read forward, as a stream is
+ *
+ *  the ticket is fetched when it is made; the blocks are fetched in
+ *  order, up to FEED_TRANSFERS at once, so that those after the one
+ *  being read are coming in while it is; one that isn't being read
+ *  holds up to FEED_AHEAD bytes and then waits to be
+ */
+class HtsgetFeed
+{
+    struct Transfer;
+
+    enum { FEED_TRANSFERS = 4 };
+    enum { FEED_AHEAD = 8 * 1024 * 1024 };
+
+    std::string const path;
+    MemoryLedger *const memory;     /* counts what the blocks hold, may be NULL */
+    std::vector<HtsgetBlock> blocks;
+    std::vector<Transfer *> transfers;  /* per block, from the first started */
+    void *multi;                    /* CURLM * */
+    size_t front;                   /* the block being read */
+
+    HtsgetFeed(HtsgetFeed const &);
+    HtsgetFeed &operator =(HtsgetFeed const &);
+
+    static size_t Write(char *const ptr, size_t const size, size_t const nmemb, void *const arg);
+    void FetchTicket(void);
+    void Start(void);
+    void Perform(void);
+    void Finish(Transfer &t);
+public:
+    HtsgetFeed(std::string const &path, MemoryLedger *const memory = 0);
+    ~HtsgetFeed();
+
+    /* Read
+     *  the next bytes, up to "length" of them; 0 at the end
+     */
+    size_t Read(void *const dst, size_t const length);
+
+    size_t countOfBlocks() const {
+        return blocks.size();
+    }
+};
+#endif
+
+#endif // _hpp_htsget_
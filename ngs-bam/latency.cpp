@@ -0,0 +1,147 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "latency.hpp"
+
+#include <new>
+
+LatencyHistogram::LatencyHistogram()
+: max(0)
+{
+    for (unsigned i = 0; i < stripes; ++i)
+        counts[i] = 0;
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+    for (unsigned i = 0; i < stripes; ++i)
+        delete [] counts[i];
+}
+
+unsigned LatencyHistogram::Bucket(uint64_t const nanos)
+{
+    if (nanos < (1u << subBits))
+        return (unsigned)nanos;
+    
+    unsigned const e = 63 - __builtin_clzll(nanos);
+    if (e > maxExponent)
+        return buckets - 1;
+    return ((e - subBits + 1) << subBits) + (unsigned)((nanos >> (e - subBits)) & ((1u << subBits) - 1));
+}
+
+uint64_t LatencyHistogram::Highest(unsigned const bucket)
+{
+    if (bucket < (1u << subBits))
+        return bucket;
+    
+    unsigned const e = (bucket >> subBits) + subBits - 1;
+    uint64_t const low = (uint64_t)((1u << subBits) + (bucket & ((1u << subBits) - 1))) << (e - subBits);
+    return low + ((uint64_t)1 << (e - subBits)) - 1;
+}
+
+/* Stripe
+ *  the calling thread's, made if no thread has counted into it yet;
+ *  threads take the stripes in turn as they first count
+ */
+uint64_t *LatencyHistogram::Stripe()
+{
+    static unsigned nextThread = 0;
+    static __thread unsigned thread = 0;
+    
+    if (thread == 0)
+        thread = __atomic_add_fetch(&nextThread, 1, __ATOMIC_RELAXED);
+    
+    uint64_t **const slot = &counts[thread % stripes];
+    uint64_t *stripe = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    
+    if (stripe == 0) {
+        uint64_t *const made = new (std::nothrow) uint64_t[buckets]();
+        if (made == 0)
+            return 0;
+        if (__atomic_compare_exchange_n(slot, &stripe, made, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            stripe = made;
+        else
+            delete [] made;     /* another thread made it first */
+    }
+    return stripe;
+}
+
+void LatencyHistogram::Add(uint64_t const nanos)
+{
+    uint64_t *const stripe = Stripe();
+    
+    if (stripe == 0)
+        return;
+    __atomic_fetch_add(&stripe[Bucket(nanos)], 1, __ATOMIC_RELAXED);
+    
+    uint64_t seen = __atomic_load_n(&max, __ATOMIC_RELAXED);
+    while (seen < nanos && !__atomic_compare_exchange_n(&max, &seen, nanos, true,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const
+{
+    uint64_t total[buckets] = { 0 };
+    Summary rslt = Summary();
+    
+    for (unsigned i = 0; i < stripes; ++i) {
+        uint64_t const *const stripe = __atomic_load_n(&counts[i], __ATOMIC_ACQUIRE);
+        if (stripe == 0)
+            continue;
+        for (unsigned k = 0; k < buckets; ++k) {
+            uint64_t const n = __atomic_load_n(&stripe[k], __ATOMIC_RELAXED);
+            total[k] += n;
+            rslt.count += n;
+        }
+    }
+    rslt.max = __atomic_load_n(&max, __ATOMIC_RELAXED);
+    if (rslt.count == 0)
+        return rslt;
+    
+    /* the ranks of the quantiles, rounded up */
+    uint64_t const rank50 = (rslt.count + 1) / 2;
+    uint64_t const rank99 = (rslt.count * 99 + 99) / 100;
+    uint64_t const rank999 = (rslt.count * 999 + 999) / 1000;
+    uint64_t seen = 0;
+    
+    for (unsigned k = 0; k < buckets; ++k) {
+        if (total[k] == 0)
+            continue;
+        
+        uint64_t const before = seen;
+        uint64_t const highest = Highest(k) < rslt.max ? Highest(k) : rslt.max;
+        
+        seen += total[k];
+        if (before < rank50 && rank50 <= seen)
+            rslt.p50 = highest;
+        if (before < rank99 && rank99 <= seen)
+            rslt.p99 = highest;
+        if (before < rank999 && rank999 <= seen)
+            rslt.p999 = highest;
+    }
+    return rslt;
+}
@@ -0,0 +1,82 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_latency_
+#define _hpp_latency_
+
+#include <stdint.h>
+
+/* LatencyHistogram
+ *  durations in nanoseconds, counted in buckets of a sixteenth of a
+ *  power of two as HDR histograms have them, so that the quantiles are
+ *  within about 6% of the true ones; durations from 2^41 on are all
+ *  counted in the last bucket
+ *  counted by many threads at once without a lock: each thread counts
+ *  into one of a few stripes, made when first counted into, and they
+ *  are summed when read
+ */
+class LatencyHistogram
+{
+public:
+    enum {
+        subBits = 4,
+        maxExponent = 40,
+        buckets = (maxExponent - subBits + 2) << subBits,
+        stripes = 4
+    };
+    struct Summary {
+        uint64_t count;
+        uint64_t p50, p99, p999;    /* the highest durations counted with them */
+        uint64_t max;
+    };
+private:
+    uint64_t *counts[stripes];
+    uint64_t max;
+
+    static unsigned Bucket(uint64_t const nanos);
+    static uint64_t Highest(unsigned const bucket);
+    uint64_t *Stripe();
+
+    LatencyHistogram(LatencyHistogram const &);
+    LatencyHistogram &operator =(LatencyHistogram const &);
+public:
+    LatencyHistogram();
+    ~LatencyHistogram();
+
+    void Add(uint64_t const nanos);
+    Summary Summarize() const;
+};
+
+/* FileLatencies
+ *  of opening and slicing a file, counted by every collection sharing it
+ */
+struct FileLatencies
+{
+    LatencyHistogram open;          /* openReadCollection */
+    LatencyHistogram sliceOpen;     /* a slice, until it is returned */
+    LatencyHistogram firstRecord;   /* a slice, until its first alignment */
+};
+
+#endif // _hpp_latency_
@@ -0,0 +1,91 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "memory.hpp"
+
+uint64_t MemoryLedger::budget = 0;
+
+MemoryLedger::MemoryLedger(MemoryLedger *const Parent)
+: parent(Parent)
+{
+    for (unsigned i = 0; i < categories; ++i)
+        bytes[i] = 0;
+}
+
+MemoryLedger::MemoryLedger()
+: parent(&Process())
+{
+    for (unsigned i = 0; i < categories; ++i)
+        bytes[i] = 0;
+}
+
+MemoryLedger::~MemoryLedger()
+{
+    if (parent) {
+        for (unsigned i = 0; i < categories; ++i)
+            parent->Remove((Category)i, (size_t)Get((Category)i));
+    }
+}
+
+uint64_t MemoryLedger::Total() const
+{
+    uint64_t total = 0;
+
+    for (unsigned i = 0; i < categories; ++i)
+        total += Get((Category)i);
+    return total;
+}
+
+char const *MemoryLedger::Name(Category const what)
+{
+    static char const *const names[categories] = {
+        "IO_BUFFERS",
+        "INFLATE_QUEUE",
+        "BLOCK_CACHE",
+        "REMOTE_WINDOWS",
+        "INDEX",
+        "HEADER",
+        "MATE_BUFFER",
+        "REGION_CACHE"
+    };
+    return names[what];
+}
+
+MemoryLedger &MemoryLedger::Process()
+{
+    static MemoryLedger process(0);
+    return process;
+}
+
+void MemoryLedger::SetBudget(uint64_t const bytes)
+{
+    __atomic_store_n(&budget, bytes, __ATOMIC_RELAXED);
+}
+
+uint64_t MemoryLedger::Budget()
+{
+    return __atomic_load_n(&budget, __ATOMIC_RELAXED);
+}
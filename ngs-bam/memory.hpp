@@ -0,0 +1,130 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_memory_
+#define _hpp_memory_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <ngs/adapter/Refcount.hpp>
+
+/* MemoryLedger
+ *  the bytes held for one file, by what they are held for; every change
+ *  is also made to the ledger of the whole process, Process()
+ *  updated by reader and worker threads at once, so the counters are
+ *  only changed with Add and Remove and read with Get
+ *  what is still counted when a ledger goes is taken off the process'
+ *
+ *  the process may have a budget; the buffers that can make do with
+ *  less ask OverBudget before they grow: over it the block and region
+ *  caches give back what they hold, read iterators let out the records they hold for
+ *  their mates early, remote files fetch small windows and new readers
+ *  read through the smallest buffer
+ *  mapped files aren't counted, since their pages are the system's
+ */
+class MemoryLedger
+{
+public:
+    enum Category {
+        ioBuffers,                  /* the read buffers of BGZF readers */
+        inflateQueue,               /* blocks being read and inflated by worker threads */
+        blockCache,                 /* inflated blocks kept for seeks */
+        remoteWindows,              /* what remote files have fetched */
+        index,                      /* the parsed index and what it is parsed from */
+        header,                     /* header text, references and read groups */
+        mateBuffer,                 /* records read iterators hold for their mates */
+        regionCache,                /* windows of records kept for slices */
+        categories
+    };
+private:
+    MemoryLedger *const parent;
+    uint64_t bytes[categories];
+
+    static uint64_t budget;
+
+    explicit MemoryLedger(MemoryLedger *const parent);
+    MemoryLedger(MemoryLedger const &);
+    MemoryLedger &operator =(MemoryLedger const &);
+public:
+    MemoryLedger();
+    ~MemoryLedger();
+
+    void Add(Category const what, size_t const count) {
+        __atomic_fetch_add(&bytes[what], (uint64_t)count, __ATOMIC_RELAXED);
+        if (parent)
+            parent->Add(what, count);
+    }
+    void Remove(Category const what, size_t const count) {
+        __atomic_fetch_sub(&bytes[what], (uint64_t)count, __ATOMIC_RELAXED);
+        if (parent)
+            parent->Remove(what, count);
+    }
+    uint64_t Get(Category const what) const {
+        return __atomic_load_n(&bytes[what], __ATOMIC_RELAXED);
+    }
+    uint64_t Total() const;
+
+    /* Name
+     *  of a category as statistics have it, e.g. "BLOCK_CACHE"
+     */
+    static char const *Name(Category const what);
+
+    /* Process
+     *  the sum of every file's ledger
+     */
+    static MemoryLedger &Process();
+
+    /* SetBudget
+     *  the most the process is to hold, 0 for no limit, the default
+     */
+    static void SetBudget(uint64_t const bytes);
+    static uint64_t Budget();
+
+    /* OverBudget
+     *  whether holding "more" bytes would take the process over its budget
+     */
+    static bool OverBudget(size_t const more = 0) {
+        uint64_t const limit = __atomic_load_n(&budget, __ATOMIC_RELAXED);
+        return limit != 0 && Process().Total() + more > limit;
+    }
+};
+
+/* EngineBlock
+ *  a base for what is allocated in bulk, e.g. the blocks of the caches
+ *  and inflate queues, so that it comes from the ngs_adapt::Allocator
+ *  installed, as the engine's NGS objects do
+ */
+struct EngineBlock
+{
+    static void *operator new(size_t const bytes) {
+        return ngs_adapt::Allocator::newBlock(bytes);
+    }
+    static void operator delete(void *const block, size_t const bytes) {
+        ngs_adapt::Allocator::deleteBlock(block, bytes);
+    }
+};
+
+#endif // _hpp_memory_
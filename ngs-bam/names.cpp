@@ -0,0 +1,230 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "names.hpp"
+#include "sidecar.hpp"
+#include "bam.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+static char const namesSuffix[] = ".ngs-names";
+static char const namesMagic[8] = { 'N', 'G', 'S', 'N', 'A', 'M', 'E', '1' };
+
+/* the Bloom filter: bits per name and the bits tested for a fingerprint,
+ * which miss about 1% of the names that aren't in the file */
+static unsigned const bloomBitsPerName = 10;
+static unsigned const bloomProbes = 7;
+
+/* NamesHeader
+ *  what the sidecar has after its first line, at a multiple of 64;
+ *  the entries follow it, then the Bloom filter's words
+ */
+struct NamesHeader {
+    char magic[8];
+    uint64_t n_entries;
+    uint64_t n_bloom;
+    uint32_t probes;
+    uint32_t reserved;
+};
+
+static size_t NamesAlign(size_t const offset)
+{
+    return (offset + 63) & ~(size_t)63;
+}
+
+static bool LessEntry(NameIndex::Entry const &lhs, NameIndex::Entry const &rhs)
+{
+    return lhs.fingerprint < rhs.fingerprint || (lhs.fingerprint == rhs.fingerprint && lhs.pos < rhs.pos);
+}
+
+static bool LessFingerprint(NameIndex::Entry const &lhs, uint64_t const fingerprint)
+{
+    return lhs.fingerprint < fingerprint;
+}
+
+/* Fingerprint
+ *  FNV-1a, with its bits mixed as MurmurHash3 finishes, since the Bloom
+ *  filter uses them all
+ */
+uint64_t NameIndex::Fingerprint(char const name[], size_t const length)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    
+    for (size_t i = 0; i < length; ++i) {
+        h ^= (uint8_t)name[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/* MayHave
+ *  the probes are the fingerprint plus multiples of an odd step made
+ *  from its other half
+ */
+bool NameIndex::MayHave(uint64_t const fingerprint) const
+{
+    if (n_bloom == 0)
+        return n_entries > 0;
+    
+    uint64_t const mask = (uint64_t)n_bloom * 64 - 1;
+    uint64_t const step = ((fingerprint >> 32) | (fingerprint << 32)) | 1;
+    uint64_t bit = fingerprint;
+    
+    for (unsigned i = 0; i < bloomProbes; ++i, bit += step) {
+        uint64_t const at = bit & mask;
+        
+        if ((bloom[at >> 6] & ((uint64_t)1 << (at & 63))) == 0)
+            return false;
+    }
+    return true;
+}
+
+bool NameIndex::Map(std::string const &bampath)
+{
+    Sidecar cached;
+    
+    if (!cached.OpenRead(bampath, namesSuffix))
+        return false;
+    
+    long const line = ftell(cached.get());
+    if (line < 0 || !map.Map(fileno(cached.get())))
+        return false;
+    
+    size_t const start = NamesAlign((size_t)line);
+    size_t const size = map.size() > start ? map.size() - start : 0;
+    char const *const base = reinterpret_cast<char const *>(map.data()) + start;
+    NamesHeader const *const header = reinterpret_cast<NamesHeader const *>(base);
+    
+    if (size < sizeof(*header) || memcmp(header->magic, namesMagic, 8) != 0 ||
+        header->probes != bloomProbes || (header->n_bloom & (header->n_bloom - 1)) != 0 ||
+        header->n_entries > (size - sizeof(*header)) / sizeof(Entry) ||
+        header->n_bloom > (size - sizeof(*header) - header->n_entries * sizeof(Entry)) / sizeof(uint64_t))
+    {
+        map.Unmap();
+        return false;
+    }
+    entries = reinterpret_cast<Entry const *>(header + 1);
+    n_entries = (size_t)header->n_entries;
+    bloom = reinterpret_cast<uint64_t const *>(entries + n_entries);
+    n_bloom = (size_t)header->n_bloom;
+    std::vector<Entry>().swap(ownEntries);
+    std::vector<uint64_t>().swap(ownBloom);
+    return true;
+}
+
+void NameIndex::Build(BAMFile const &file)
+{
+    BAMFileCursor scan(file);
+    BAMRecordBuffer buffer;
+    std::vector<Entry> built;
+    
+    for ( ; ; ) {
+        BAMFilePosType const pos = scan.Tell();
+        BAMRecord const *const rec = scan.Read(buffer, NGS_BAM::OpenOptions::readName);
+        
+        if (!rec)
+            break;
+        
+        int const flag = rec->flag();
+        
+        if ((flag & 0x0900) != 0 || ((flag & 0x0001) != 0 && (flag & 0x00C0) == 0x0080))
+            continue;
+        
+        Entry const entry = { Fingerprint(rec->readname(), strnlen(rec->readname(), rec->l_read_name())), pos.getValue() };
+        built.push_back(entry);
+    }
+    std::sort(built.begin(), built.end(), LessEntry);
+    
+    size_t words = 1;
+    while (words * 64 < built.size() * bloomBitsPerName)
+        words *= 2;
+    
+    std::vector<uint64_t> filter(words, 0);
+    uint64_t const mask = (uint64_t)words * 64 - 1;
+    
+    for (std::vector<Entry>::const_iterator i = built.begin(); i != built.end(); ++i) {
+        uint64_t const step = ((i->fingerprint >> 32) | (i->fingerprint << 32)) | 1;
+        uint64_t bit = i->fingerprint;
+        
+        for (unsigned k = 0; k < bloomProbes; ++k, bit += step)
+            filter[(bit & mask) >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+    
+    map.Unmap();
+    ownEntries.swap(built);
+    ownBloom.swap(filter);
+    entries = ownEntries.empty() ? 0 : &ownEntries[0];
+    n_entries = ownEntries.size();
+    bloom = &ownBloom[0];
+    n_bloom = ownBloom.size();
+}
+
+void NameIndex::Save(std::string const &bampath) const
+{
+    Sidecar update;
+    
+    if (!update.OpenWrite(bampath, namesSuffix))
+        return;
+    
+    FILE *const fp = update.get();
+    long const line = ftell(fp);
+    NamesHeader header;
+    
+    if (line < 0)
+        return;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, namesMagic, 8);
+    header.n_entries = n_entries;
+    header.n_bloom = n_bloom;
+    header.probes = bloomProbes;
+    for (size_t pad = NamesAlign((size_t)line) - (size_t)line; pad > 0; --pad)
+        fputc('\0', fp);
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(entries, sizeof(Entry), n_entries, fp);
+    fwrite(bloom, sizeof(uint64_t), n_bloom, fp);
+    update.Commit();
+}
+
+void NameIndex::Find(char const name[], size_t const length, std::vector<uint64_t> &rslt) const
+{
+    uint64_t const fingerprint = Fingerprint(name, length);
+    
+    rslt.clear();
+    if (!MayHave(fingerprint))
+        return;
+    for (Entry const *i = std::lower_bound(entries, entries + n_entries, fingerprint, LessFingerprint);
+         i != entries + n_entries && i->fingerprint == fingerprint; ++i)
+    {
+        rslt.push_back(i->pos);
+    }
+}
@@ -0,0 +1,105 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_names_
+#define _hpp_names_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "bgzf.hpp"
+
+class BAMFile;
+
+/* NameIndex
+ *  the read names of a BAM file, for looking reads up by name; each name
+ *  is kept as a 64-bit fingerprint with the position of the record that
+ *  starts its read, sorted by fingerprint, so that the names that share
+ *  one are next to each other and what a lookup finds has to be checked
+ *  against the record
+ *  a Bloom filter over the fingerprints rules out most names that aren't
+ *  in the file without a search
+ *  kept in a sidecar, <path>.ngs-names, which is mapped read-only
+ */
+class NameIndex
+{
+public:
+    struct Entry {
+        uint64_t fingerprint;
+        uint64_t pos;               /* virtual file position of the record */
+    };
+private:
+    MappedFile map;                 /* the sidecar, if it is used */
+    std::vector<Entry> ownEntries;  /* what is used unless it is mapped */
+    std::vector<uint64_t> ownBloom;
+    Entry const *entries;
+    size_t n_entries;
+    uint64_t const *bloom;
+    size_t n_bloom;                 /* words, a power of 2 */
+
+    NameIndex(NameIndex const &);
+    NameIndex &operator =(NameIndex const &);
+
+    bool MayHave(uint64_t const fingerprint) const;
+public:
+    NameIndex() : entries(0), n_entries(0), bloom(0), n_bloom(0) {}
+
+    /* Fingerprint
+     *  of a name of "length" characters
+     */
+    static uint64_t Fingerprint(char const name[], size_t const length);
+
+    /* Map
+     *  use the sidecar of the file at "bampath", if it is current
+     */
+    bool Map(std::string const &bampath);
+
+    /* Build
+     *  with a pass over the records of "file"; a read is found by the
+     *  primary record of its first segment, the one reads start at
+     */
+    void Build(BAMFile const &file);
+
+    /* Save
+     *  write what Build made to the sidecar; nothing is written if it
+     *  can't be, e.g. the directory is read-only
+     */
+    void Save(std::string const &bampath) const;
+
+    /* Find
+     *  the positions of the records whose names may be "name", in
+     *  file order; empty when it surely isn't in the file
+     */
+    void Find(char const name[], size_t const length, std::vector<uint64_t> &rslt) const;
+
+    size_t size() const {
+        return n_entries;
+    }
+};
+
+#endif // _hpp_names_
@@ -25,28 +25,276 @@
 
 #include <ngs-bam/ngs-bam.hpp>
 #include "bam.hpp"
+#include "sidecar.hpp"
+#include "names.hpp"
+#include "fasta.hpp"
+#include "trace.hpp"
+#include "cpu.hpp"
+#include "slot.hpp"
+#include "cram.hpp"
+#include "htsget.hpp"
 
 #include <ngs/ReadCollection.hpp>
+#include <ngs/ReferenceIterator.hpp>
+#include <ngs/ReadGroupIterator.hpp>
+#include <ngs/Alignment.hpp>
+#include <ngs/WorkPool.hpp>
 #include <ngs/adapter/ReadCollectionItf.hpp>
 #include <ngs/adapter/AlignmentItf.hpp>
 #include <ngs/adapter/ReferenceItf.hpp>
+#include <ngs/adapter/PileupItf.hpp>
 #include <ngs/adapter/StringItf.hpp>
+#include <ngs/adapter/StatisticsItf.hpp>
+#include <ngs/adapter/ReadGroupItf.hpp>
+#include <ngs/adapter/ReadItf.hpp>
+
+#include <cctype>
+#include <cstdlib>
+#include <deque>
+
+/* alignment IDs
+ *  the virtual file position of the record, in decimal, so that
+ *  getAlignment can seek straight to it; read and fragment IDs
+ *  are made the same way
+ */
+static void FormatAlignmentId(BAMFilePosType const pos, std::string &rslt)
+{
+    char buffer[24];
+    
+    rslt.assign(buffer, snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)pos.getValue()));
+}
+
+static bool ParseAlignmentId(char const id[], BAMFilePosType &pos)
+{
+    uint64_t value = 0;
+    
+    if (id == 0 || id[0] == '\0')
+        return false;
+    for (char const *cp = id; *cp; ++cp) {
+        if (*cp < '0' || *cp > '9' || value > (UINT64_MAX - (*cp - '0')) / 10)
+            return false;
+        value = value * 10 + (*cp - '0');
+    }
+    pos = BAMFilePosType(value);
+    return true;
+}
+
+/* cursors
+ *  a tag for the kind of iterator, then its numbers in decimal, each
+ *  after a ':'; file positions are virtual ones, with 0 for the end
+ */
+static void AppendCursorField(std::string &rslt, uint64_t const value)
+{
+    char buffer[24];
+    
+    rslt.push_back(':');
+    rslt.append(buffer, snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)value));
+}
+
+static std::vector<uint64_t> ParseCursor(char const tag[], char const cursor[], size_t const minFields)
+{
+    std::vector<uint64_t> fields;
+    size_t const taglen = strlen(tag);
+    
+    if (cursor == 0 || strncmp(cursor, tag, taglen) != 0)
+        throw std::runtime_error("not a cursor of this kind of iterator");
+    for (char const *cp = cursor + taglen; *cp; ) {
+        uint64_t value = 0;
+        
+        if (*cp++ != ':' || *cp < '0' || *cp > '9')
+            throw std::runtime_error("invalid cursor");
+        for ( ; *cp >= '0' && *cp <= '9'; ++cp) {
+            if (value > (UINT64_MAX - (*cp - '0')) / 10)
+                throw std::runtime_error("invalid cursor");
+            value = value * 10 + (*cp - '0');
+        }
+        fields.push_back(value);
+    }
+    if (fields.size() < minFields)
+        throw std::runtime_error("invalid cursor");
+    return fields;
+}
+
+/* ReadCategory
+ *  the category, as ngs::Read::ReadCategory, of a read whose
+ *  fragments are or aren't aligned
+ */
+static uint32_t ReadCategory(bool const aligned, bool const mateAligned)
+{
+    if (aligned && mateAligned)
+        return ngs::Read::fullyAligned;
+    if (aligned || mateAligned)
+        return ngs::Read::partiallyAligned;
+    return ngs::Read::unaligned;
+}
+
+/* by the flags of one of its records, which say if the mate is aligned */
+static uint32_t ReadCategory(int const flag)
+{
+    bool const aligned = (flag & 0x0004) == 0;
+    
+    return ReadCategory(aligned, (flag & 0x0001) == 0 ? aligned : (flag & 0x0008) == 0);
+}
+
+/* ReadCountIndex
+ *  where the count of a category is kept
+ */
+static unsigned ReadCountIndex(uint32_t const category)
+{
+    return category == ngs::Read::fullyAligned ? 0 : category == ngs::Read::partiallyAligned ? 1 : 2;
+}
+
+/* Statistic
+ *  one named uint64 value; lists of them are kept sorted by path
+ */
+struct Statistic
+{
+    std::string path;
+    uint64_t value;
+
+    Statistic(std::string const &Path, uint64_t const Value) : path(Path), value(Value) {}
+
+    bool operator <(Statistic const &rhs) const {
+        return path < rhs.path;
+    }
+};
+typedef std::vector<Statistic> StatisticList;
 
 class ReadCollection : public ngs_adapt::ReadCollectionItf
 {
+    friend class MergedCollection;  /* reads the records of its files' iterators */
+    friend class EngineAccess;      /* for the functions of NGS_BAM */
+
     class Alignment;
     class AlignmentNone;
+    class AlignmentRange;
     class AlignmentSlice;
+    class AlignmentCachedSlice;
+    class TicketHold;
+    class AlignmentTicket;
+    class RegionHint;
+    class AlignmentShard;
+    class AlignmentSample;
+    class AlignmentIntervals;
+    class AlignmentMates;
+    class AlignmentOne;
+    class Read;
+    class Pileup;
     class Reference;
+    class ReadGroup;
+    class StatisticTable;
 
-    BAMFile file;
+    BAMFile const &file;            /* shared, see BAMFile::Open            */
     std::string const path;         /* path used to open the BAM file       */
+    unsigned const fields;          /* parts of records that are decoded    */
+    bool const buildStats;          /* make the aggregates if not cached    */
+    size_t const mateBuffer;        /* what a read iterator may hold        */
+    IndexedFasta fasta;             /* the reference bases, if there are any */
+    std::vector<int> sequences;     /* per reference, its FASTA sequence or -1 */
+
+    /* results of a full scan, cached in sidecars:
+     * the alignment counts, the position of every
+     * ROW_CHECKPOINT_INTERVAL'th mapped record and
+     * the read counts, fully aligned, partially aligned
+     * and unaligned */
+    mutable pthread_mutex_t scanLock;
+    mutable bool haveScan;
+    mutable uint64_t primaryCount;
+    mutable uint64_t secondaryCount;
+    mutable BAMFilePosTypeList checkpoints;
+    mutable uint64_t readCounts[3];
+    
+    /* what read iterators held while pairing records, most at once
+     * and records let out without their mates; only changed atomically */
+    mutable uint64_t mateBufferPeak;
+    mutable uint64_t mateBufferEvictions;
+
+    /* per read group and per reference aggregates of another full scan,
+     * also cached in a sidecar and also guarded by scanLock */
+    mutable bool haveStats;
+    mutable StatisticList stats;
+
+    /* read names, indexed the first time one is looked up if the
+     * collection was opened with nameIndex; also guarded by scanLock */
+    bool const nameIndex;
+    mutable bool haveNames;
+    mutable NameIndex names;
+
+    bool LoadScan() const;
+    void SaveScan() const;
+    void Scan() const;
+    void getScanCounts(uint64_t &primary, uint64_t &secondary) const;
+
+    bool LoadStats() const;
+    void SaveStats() const;
+    void BuildStats() const;
+    
+    void OpenFasta(std::string const &fastapath);
+
+    /* Hold, LetGo
+     *  a reference to the collection for one of its iterators, counted on
+     *  the Reference "via" that it came from when there is one; each
+     *  thread has References of its own, so iterators made on many of
+     *  them don't all count on the collection's one refcount
+     */
+    static ReadCollection *Hold(ReadCollection const *collection, Reference const *via);
+    static void LetGo(ReadCollection *collection, Reference *via);
 public:
-    ReadCollection(std::string const &filepath)
-    : path(filepath)
-    , file(filepath)
-    {};
+    ReadCollection(std::string const &filepath, NGS_BAM::OpenOptions const &Options)
+    : file(BAMFile::Open(filepath, Options))
+    , path(filepath)
+    , fields(Options.fields)
+    , buildStats(Options.buildStats)
+    , mateBuffer(Options.mateBuffer)
+    , haveScan(false)
+    , primaryCount(0)
+    , secondaryCount(0)
+    , mateBufferPeak(0)
+    , mateBufferEvictions(0)
+    , haveStats(false)
+    , nameIndex(Options.nameIndex)
+    , haveNames(false)
+    {
+        readCounts[0] = readCounts[1] = readCounts[2] = 0;
+        try {
+            OpenFasta(Options.referenceFasta);
+        }
+        catch (...) {
+            BAMFile::Close(file);
+            throw;
+        }
+        pthread_mutex_init(&scanLock, 0);
+    }
+    ~ReadCollection() {
+        pthread_mutex_destroy(&scanLock);
+        BAMFile::Close(file);
+    }
     
+    /* getCheckpoint
+     *  the position of the checkpointed row at or before "row" (1-based)
+     *  returns false if the collection has fewer rows
+     */
+    bool getCheckpoint(uint64_t const row, BAMFilePosType &pos, uint64_t &checkpointRow) const;
+
+    /* getStats
+     *  the aggregates whose paths start with "prefix", with it removed
+     *  they come from the sidecar, or from a scan if the collection was
+     *  opened with buildStats; empty if there are none
+     */
+    void getStats(std::string const &prefix, StatisticList &rslt) const;
+
+    /* FindReadName
+     *  the position of the record that starts the read named "name"
+     *  returns false if there is none, or if the collection wasn't
+     *  opened with nameIndex
+     */
+    bool FindReadName(char const name[], BAMFilePosType &pos) const;
+
+    /* CountMateBuffer
+     *  what a read iterator held, for the statistics
+     */
+    void CountMateBuffer(uint64_t const peak, uint64_t const evictions) const;
+
     ngs_adapt::StringItf *getName() const;
     ngs_adapt::ReadGroupItf *getReadGroups() const;
     bool hasReadGroup(char const spec[]) const;
@@ -63,6 +311,10 @@ public:
                                                uint64_t const count,
                                                bool const want_primary,
                                                bool const want_secondary ) const;
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard,
+                                               uint32_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary ) const;
     uint64_t getReadCount(bool const want_full,
                           bool const want_partial,
                           bool const want_unaligned) const;
@@ -75,16 +327,71 @@ public:
                                      bool const want_full,
                                      bool const want_partial,
                                      bool const want_unaligned) const;
+    uint32_t getFeatures() const {
+        return NGS_ReadCollectionFeature_read_groups
+             | NGS_ReadCollectionFeature_references
+             | NGS_ReadCollectionFeature_alignments
+             | NGS_ReadCollectionFeature_alignment_count
+             | NGS_ReadCollectionFeature_alignment_range
+             | NGS_ReadCollectionFeature_alignment_shard
+             | NGS_ReadCollectionFeature_read_by_id
+             | NGS_ReadCollectionFeature_reads;
+    }
+    ngs_adapt::StatisticsItf *getStatistics() const;
+    bool getReferenceTable(NGS_ReferenceTable_v1 &table) const;
     
-    void Seek(BAMFilePosType const new_pos) {
-    	file.Seek(new_pos.fpos(), new_pos.bpos());
+    /* Need
+     *  throws unless the collection was opened to decode "field",
+     *  one of NGS_BAM::OpenOptions::Field
+     */
+    void Need(unsigned const field) const {
+        if ((fields & field) == 0)
+            throw std::runtime_error("not available");
+    }
+    unsigned getFields() const {
+        return fields;
     }
-    BAMRecord const *ReadBAMRecord() {
-        return file.Read();
+    /* NeedPositions
+     *  throws if reference refID has no index and the header says the
+     *  records aren't in position order, when its "what" would otherwise
+     *  come back empty rather than be what the file has
+     */
+    void NeedPositions(int const refID, char const what[]) const {
+        if (file.isUnsorted() && !file.getRefInfo(refID).hasIndex())
+            throw std::runtime_error(std::string("the ") + what + " of '" + path + "' can't be read: it isn't sorted by position");
     }
+    
+    /* getReadGroup
+     *  the read group of a record read with its tags, into "slot"
+     */
+    ngs_adapt::StringItf *getReadGroup(BAMRecord const &rec, StringSlot &slot) const;
+    /* the same, from its RG field, which may be NULL */
+    ngs_adapt::StringItf *getReadGroup(BAMRecord::OptionalField const *rg, StringSlot &slot) const;
+    
     HeaderRefInfo const &getRefInfo(unsigned const i) const {
         return file.getRefInfo(i);
     }
+    BAMFile const &getFile() const {
+        return file;
+    }
+    /* isAdapted
+     *  the C object of a collection is an ngs_adapt one, so Self works on it
+     */
+    static bool isAdapted(NGS_ReadCollection_v1 const *const obj) {
+        return obj != 0 && obj->vt == &ivt.dad;
+    }
+    /* getSequence
+     *  the FASTA sequence of reference refID, or -1 if its bases aren't known
+     */
+    int getSequence(unsigned const refID) const {
+        return refID < sequences.size() ? sequences[refID] : -1;
+    }
+    IndexedFasta const &getFasta() const {
+        return fasta;
+    }
+    bool getShard(int const refID, unsigned const shard, unsigned const count, BAMFileChunk &rslt) const {
+        return file.getShard(refID, shard, count, rslt);
+    }
 };
 
 // base class for the Alignment types
@@ -94,9 +401,14 @@ public:
 // for example, if want_primary and want_secondary are both false
 class ReadCollection::AlignmentNone : public ngs_adapt::AlignmentItf
 {
+    friend class MergedCollection;  /* holds and releases them */
+
     virtual ngs_adapt::StringItf *getCigar(bool const clipped, char const OPCODE[]) const {
         throw std::runtime_error("no rows");
     }
+protected:
+    mutable std::string cursorBuffer;
+    mutable StringSlot cursorString;
 public:
     ngs_adapt::StringItf *getFragmentId() const {
         throw std::runtime_error("not available");
@@ -107,12 +419,21 @@ public:
     ngs_adapt::StringItf *getFragmentQualities(uint64_t offset, uint64_t length) const {
         throw std::runtime_error("no rows");
     }
+    uint32_t getFragmentIndex() const {
+        throw std::runtime_error("no rows");
+    }
     ngs_adapt::StringItf *getAlignmentId() const {
         throw std::runtime_error("not available");
     }
     ngs_adapt::StringItf *getReferenceSpec() const {
         throw std::runtime_error("no rows");
     }
+    int32_t getReferenceIndex() const {
+        throw std::runtime_error("no rows");
+    }
+    int32_t getMateReferenceIndex() const {
+        throw std::runtime_error("no rows");
+    }
     int32_t getMappingQuality() const {
         throw std::runtime_error("no rows");
     }
@@ -126,13 +447,13 @@ public:
         throw std::runtime_error("no rows");
     }
     ngs_adapt::StringItf *getClippedFragmentBases() const {
-        throw std::runtime_error("not available");
+        throw std::runtime_error("no rows");
     }
     ngs_adapt::StringItf *getClippedFragmentQualities() const {
-        throw std::runtime_error("not available");
+        throw std::runtime_error("no rows");
     }
     ngs_adapt::StringItf *getAlignedFragmentBases() const {
-        throw std::runtime_error("not available");
+        throw std::runtime_error("no rows");
     }
     ngs_adapt::StringItf *getAlignedFragmentQualities() const {
         throw std::runtime_error("not available");
@@ -185,27 +506,167 @@ public:
     bool nextAlignment() {
         return false;
     }
+    /* getCursor, resumeFrom
+     *  "A1", the file position to go on reading from and a number of
+     *  the kind of iterator's own; with none, there is nothing more
+     *  wherever it is resumed
+     */
+    ngs_adapt::StringItf *getCursor() const {
+        cursorBuffer = "A1:0:0";
+        return cursorString.Set(cursorBuffer);
+    }
+    void resumeFrom(char const cursor[]) {
+        ParseCursor("A1", cursor, 2);
+    }
     bool nextFragment() {
         throw std::runtime_error("not available");
     }
+    uint32_t getSupportedMessages() const {
+        return 0;
+    }
+    bool getTag(char const tag[], NGS_AlignmentTag_v1 &value) const {
+        throw std::runtime_error("no rows");
+    }
+    bool getCigarOps(NGS_AlignmentCigar_v1 &cigar) const {
+        throw std::runtime_error("no rows");
+    }
+    bool getMismatches(NGS_AlignmentMismatches_v1 &mismatches) const {
+        throw std::runtime_error("no rows");
+    }
+    bool getReadFragment(NGS_AlignmentReadFragment_v1 &fragment) const {
+        throw std::runtime_error("no rows");
+    }
+    void getCore(NGS_AlignmentCore_v1 &core) const {
+        throw std::runtime_error("no rows");
+    }
+    /* getClippedBases, getClippedQualities
+     *  the fragment without its soft clips into "dst", in its aligned
+     *  orientation or, with readOrientation, as it was sequenced
+     *  getClippedQualities returns false if the record has none
+     */
+    virtual void getClippedBases(bool readOrientation, std::string &dst) const {
+        throw std::runtime_error("no rows");
+    }
+    virtual bool getClippedQualities(bool readOrientation, std::string &dst) const {
+        throw std::runtime_error("no rows");
+    }
+    /* getRecord
+     *  the current record, or NULL if there is none
+     */
+    virtual BAMRecord const *getRecord() const {
+        return 0;
+    }
+    /* getCollection
+     *  the collection the records are read from, or NULL if there is none
+     */
+    virtual ReadCollection const *getCollection() const {
+        return 0;
+    }
+    /* isAdapted
+     *  the C object of an alignment is an ngs_adapt one, so Self works on it
+     */
+    static bool isAdapted(NGS_Alignment_v1 const *const obj) {
+        return obj != 0 && obj->vt == &ivt.dad;
+    }
 };
 
 class ReadCollection::Alignment : public ReadCollection::AlignmentNone
 {
+    friend class ReadCollection::AlignmentMates;    /* reads and resumes a slice */
+
     mutable std::string seqBuffer;
     mutable std::string qualBuffer;
     mutable std::string cigarBuffer;
+    mutable std::vector<uint32_t> cigarOpsBuffer;   /* when the record's can't be lent */
+    mutable std::string idBuffer;
+    mutable std::string mateIdBuffer;
+    mutable std::string refBasesBuffer;
+    mutable std::string seqView;        /* lent, so apart from the slots' */
+    mutable std::string qualView;
+    mutable std::string clippedSeqBuffer;
+    mutable std::string clippedQualBuffer;
+    mutable std::string alignedSeqBuffer;
+    mutable std::string mismatchSeqBuffer;      /* for getMismatches */
+    mutable std::string mismatchRefBuffer;
+    mutable std::vector<uint32_t> mismatchOffsets;
+    mutable StringSlot alignmentIdString;
+    mutable StringSlot mateAlignmentIdString;
+    mutable StringSlot refBasesString;
+    mutable StringSlot readIdString;
+    mutable StringSlot referenceSpecString;
+    mutable StringSlot readGroupString;
+    mutable StringSlot basesString;
+    mutable StringSlot qualitiesString;
+    mutable StringSlot cigarString;
+    mutable StringSlot mateReferenceSpecString;
+    mutable StringSlot clippedBasesString;
+    mutable StringSlot clippedQualitiesString;
+    mutable StringSlot alignedBasesString;
 protected:
+    Reference *const via;           /* what holds parent, see Hold */
     ReadCollection *parent;
+    BAMFileCursor cursor;           /* this iterator's own place in the file */
+    BAMRecordBuffer buffer;         /* reused by every nextAlignment */
     BAMRecord const *current;
+    BAMFilePosType currentPos;      /* where current starts, its ID */
+    BAMRecordFilter filter;         /* tested before a record is read in full */
+    RecordProgram program;          /* the filter's, if it has one */
+    bool rejected;                  /* filter rejected current */
     bool want_primary;
     bool want_secondary;
+    bool ended;                     /* resumed at the end */
+    unsigned fields;                /* decoded, see DecodeOnly */
+    BAMIndexBuilder *followed;      /* what a followed file's iterator has read */
+    uint64_t followedRecords;
+    uint64_t waitingSince;          /* when a slice was asked for, until its first alignment */
 
     ngs_adapt::StringItf *getCigar(bool const clipped, char const OPCODE[]) const;
+    bool FindMate(BAMFilePosType &mate) const;
     
+    virtual BAMRecord const *ReadRecord() {
+        if (ended)
+            return 0;
+        currentPos = cursor.Tell();
+        
+        BAMRecord const *const rec = cursor.Read(buffer, fields, filter, rejected);
+        
+        if (followed && rec && !rejected) {
+            followed->Add(rec->refID(), *rec, currentPos.getValue(), cursor.Tell().getValue());
+            ++followedRecords;
+        }
+        return rec;
+    }
+    /* Checkpoint, Resume
+     *  the fields of a cursor: where reading goes on, 0 at the end, and
+     *  the kind of iterator's own number; Resume is given a fresh iterator
+     */
+    virtual void Checkpoint(BAMFilePosType &next, uint64_t &extra) const {
+        BAMFilePosType const here = cursor.Tell();
+        
+        next = ended || here == BAMFilePosType(~(uint64_t)0) ? BAMFilePosType() : here;
+        extra = 0;
+    }
+    virtual void Resume(BAMFilePosType const next, uint64_t const extra) {
+        if (next.hasValue())
+            cursor.Seek(next);
+        else
+            ended = true;
+    }
+    /* GotFirst
+     *  counts how long a slice took to give its first alignment
+     */
+    void GotFirst() {
+        if (waitingSince != 0) {
+            parent->file.getLatency().firstRecord.Add(BGZFStats::Now() - waitingSince);
+            waitingSince = 0;
+        }
+    }
     bool shouldSkip() const {
         int const flag = current->flag();
 
+        if (rejected)
+            return true;
+
         if ((flag & 0x0004) != 0)
             return true;
         
@@ -219,56 +680,351 @@ protected:
     }
 
 public:
-    Alignment(ReadCollection const *Parent, bool WantPrimary, bool WantSecondary) {
-        parent = static_cast<ReadCollection *>(Parent->Duplicate());
+    Alignment(ReadCollection const *Parent, bool WantPrimary, bool WantSecondary, Reference const *Via = 0)
+    : via(const_cast<Reference *>(Via))
+    , parent(Hold(Parent, Via))
+    , cursor(Parent->file)
+    {
+        want_primary = WantPrimary;
+        want_secondary = WantSecondary;
+        fields = Parent->getFields();
+        current = 0;
+        rejected = false;
+        ended = false;
+        followed = 0;
+        followedRecords = 0;
+        waitingSince = 0;
+        if (Parent->file.isFollowed())
+            followed = new BAMIndexBuilder(Parent->file.countOfReferences());
+    }
+    /* starts at "start" instead of the first record */
+    Alignment(ReadCollection const *Parent, bool WantPrimary, bool WantSecondary, BAMFilePosType const start)
+    : via(0)
+    , parent(Hold(Parent, 0))
+    , cursor(Parent->file, start)
+    {
         want_primary = WantPrimary;
         want_secondary = WantSecondary;
+        fields = Parent->getFields();
         current = 0;
+        rejected = false;
+        ended = false;
+        followed = 0;
+        followedRecords = 0;
+        waitingSince = 0;
     }
     virtual ~Alignment() {
-        if (current)
-            delete current;
-        parent->Release();
+        delete followed;
+        LetGo(parent, via);
     }
-    
+
+    /* TakeRecord
+     *  hands the current record over to "into" and
+     *  continues reading with the storage "into" had
+     */
+    BAMRecord const *TakeRecord(BAMRecordBuffer &into) {
+        into.Swap(buffer);
+        current = 0;
+        return into.record();
+    }
+    BAMFilePosType getCurrentPos() const {
+        return currentPos;
+    }
+    /* DecodeOnly
+     *  reads the records with their CIGARs and "Fields" only,
+     *  for a caller in the engine that uses nothing else
+     */
+    void DecodeOnly(unsigned const Fields) {
+        fields = Fields & parent->getFields();
+    }
+    /* KeepProgram
+     *  a copy of the filter's program, so that the one it was made
+     *  with may go before the iterator does
+     */
+    void KeepProgram() {
+        if (filter.program != 0) {
+            program = *filter.program;
+            filter.program = &program;
+        }
+    }
+    /* WaitForFirst
+     *  a slice asked for at "since" counts the time to its first alignment
+     */
+    void WaitForFirst(uint64_t const since) {
+        waitingSince = since;
+    }
+    BAMRecord const *getRecord() const {
+        return current;
+    }
+    /* getFollowed
+     *  the index of what has been read, for an iterator of all of a
+     *  followed file; NULL for any other
+     */
+    BAMIndexBuilder const *getFollowed(uint64_t &records, BAMFilePosType &next, bool &complete) const {
+        records = followedRecords;
+        next = cursor.Tell();
+        complete = cursor.isComplete();
+        return followed;
+    }
+    ReadCollection const *getCollection() const {
+        return parent;
+    }
+
     ngs_adapt::StringItf *getFragmentBases(uint64_t offset, uint64_t length) const;
     ngs_adapt::StringItf *getFragmentQualities(uint64_t offset, uint64_t length) const;
+    ngs_adapt::StringItf *getFragmentBasesView(uint64_t offset, uint64_t length, NGS_StringView_v1 &view) const;
+    ngs_adapt::StringItf *getFragmentQualitiesView(uint64_t offset, uint64_t length, NGS_StringView_v1 &view) const;
+    bool getFragmentBasesPacked(uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 &packed) const;
+    /* getClippedFragmentBases, getClippedFragmentQualities, getAlignedFragmentBases
+     *  in the aligned orientation, as SEQ and QUAL are; the clips are
+     *  those of the CIGAR measured when the record was read
+     */
+    ngs_adapt::StringItf *getClippedFragmentBases() const;
+    ngs_adapt::StringItf *getClippedFragmentQualities() const;
+    ngs_adapt::StringItf *getAlignedFragmentBases() const;
+    void getClippedBases(bool readOrientation, std::string &dst) const;
+    bool getClippedQualities(bool readOrientation, std::string &dst) const;
+    ngs_adapt::StringItf *getAlignmentId() const;
     ngs_adapt::StringItf *getReferenceSpec() const;
+    ngs_adapt::StringItf *getReferenceBases() const;
+    ngs_adapt::StringItf *getReferenceSpecView(NGS_StringView_v1 &view) const;
     int32_t getMappingQuality() const;
     ngs_adapt::StringItf *getReadGroup() const;
     ngs_adapt::StringItf *getReadId() const;
+    ngs_adapt::StringItf *getReadIdView(NGS_StringView_v1 &view) const;
+    uint32_t getFragmentIndex() const;
     bool isPrimary() const;
     int64_t getAlignmentPosition() const;
     uint64_t getAlignmentLength() const;
     bool getIsReversedOrientation() const;
+    int32_t getSoftClip(uint32_t edge) const;
     uint64_t getTemplateLength() const;
     bool hasMate() const;
+    ngs_adapt::StringItf *getMateAlignmentId() const;
+    ngs_adapt::AlignmentItf *getMateAlignment() const;
     ngs_adapt::StringItf *getMateReferenceSpec() const;
     bool getMateIsReversedOrientation() const;
+    /* the header's order, which getReferences keeps */
+    int32_t getReferenceIndex() const {
+        return current->refID();
+    }
+    int32_t getMateReferenceIndex() const {
+        return current->next_refID();
+    }
     bool nextAlignment();
+    bool nextAlignmentBatch(NGS_AlignmentBatch_v1 &batch);
+    ngs_adapt::StringItf *getCursor() const;
+    void resumeFrom(char const cursor[]);
+    uint32_t getSupportedMessages() const;
+    /* getTag
+     *  looked up in an index of the record's fields, made on the first lookup
+     */
+    bool getTag(char const tag[], NGS_AlignmentTag_v1 &value) const;
+    /* getCigarOps
+     *  lent from the record, or copied from it if it can't be
+     */
+    bool getCigarOps(NGS_AlignmentCigar_v1 &cigar) const;
+    /* getMismatches
+     *  from the NM field when the mask isn't wanted, from MD when it is,
+     *  and otherwise by comparing the bases to those of the FASTA file
+     *  returns false if there are neither fields nor reference bases
+     */
+    bool getMismatches(NGS_AlignmentMismatches_v1 &mismatches) const;
+    /* getReadFragment
+     *  SEQ and QUAL decoded into the caller's buffers as sequenced, by
+     *  the kernels of decodeSeqReverse and decodeQualReverse for a record
+     *  of the reverse strand
+     */
+    bool getReadFragment(NGS_AlignmentReadFragment_v1 &fragment) const;
+    /* getCore
+     *  all from the record's fixed fields and its measured CIGAR
+     */
+    void getCore(NGS_AlignmentCore_v1 &core) const;
+};
+
+/* ResumeChunk
+ *  the chunk where reading from "next" goes on, or the end of "chunks"
+ */
+static BAMFileChunkList::const_iterator ResumeChunk(BAMFileChunkList const &chunks, BAMFilePosType const next)
+{
+    BAMFileChunkList::const_iterator cur = chunks.begin();
+    
+    if (!next.hasValue())
+        return chunks.end();
+    while (cur != chunks.end() && !(next < cur->end))
+        ++cur;
+    return cur;
+}
+
+/* ClipWindow
+ *  [Start, Start + length) clipped to a reference; false if it starts past the end
+ */
+static bool ClipWindow(HeaderRefInfo const &ri, int64_t const Start, uint64_t const length, unsigned &start, unsigned &end)
+{
+    unsigned const len = ri.getLength();
+    if (Start >= len)
+        return false;
+    
+    start = Start < 0 ? 0 : Start;
+    uint64_t const End = (Start < 0 ? 0 : Start) + length;
+    end = End > len ? len : End;
+    return true;
+}
+
+/* WindowFilter
+ *  "filter" for the window [beg, end) of reference refID, active only
+ *  if it rejects anything there
+ */
+static BAMRecordFilter WindowFilter(BAMRecordFilter filter, bool const startWithin,
+                                    unsigned const refID, unsigned const beg, unsigned const end)
+{
+    filter.beg = startWithin ? beg : 0;
+    if (filter.rejectFlags != 0 || filter.minMapQ > 0 || filter.maxMapQ < 255 || filter.beg > 0 || filter.program != 0) {
+        filter.refID = refID;
+        filter.end = end;
+    }
+    else
+        filter.refID = -1;
+    return filter;
+}
+
+// rows are the mapped records, numbered from 1 in file order
+class ReadCollection::AlignmentRange : public ReadCollection::Alignment
+{
+    uint64_t row;                   /* row of the next mapped record */
+    uint64_t const last;            /* first row after the range */
+
+    BAMRecord const *ReadRecord() {
+        if (row >= last)
+            return 0;
+        
+        BAMRecord const *const rec = Alignment::ReadRecord();
+        if (rec && (rec->flag() & 0x0004) == 0)
+            ++row;
+        return rec;
+    }
+    void Checkpoint(BAMFilePosType &next, uint64_t &extra) const {
+        Alignment::Checkpoint(next, extra);
+        extra = row;
+    }
+    void Resume(BAMFilePosType const next, uint64_t const extra) {
+        Alignment::Resume(next, 0);
+        row = extra;
+    }
+public:
+    AlignmentRange(ReadCollection const *Parent,
+                   bool const WantPrimary,
+                   bool const WantSecondary,
+                   BAMFilePosType const start,
+                   uint64_t const startRow,
+                   uint64_t const First,
+                   uint64_t const Count)
+    : Alignment(Parent, WantPrimary, WantSecondary)
+    , row(startRow)
+    , last(First + Count)
+    {
+        cursor.Seek(start);
+        
+        // skip from the checkpoint to the first row
+        while (row < First) {
+            BAMRecord const *const rec = Alignment::ReadRecord();
+            
+            if (!rec)
+                break;
+            if ((rec->flag() & 0x0004) == 0)
+                ++row;
+        }
+    }
 };
 
 class ReadCollection::AlignmentSlice : public ReadCollection::Alignment
 {
+    friend class ReadCollection::Pileup;    /* owns one */
+    friend class ReadCollection::Reference; /* counts coverage with one */
+
     unsigned refID;
     unsigned beg;
     unsigned end;
-    BAMFilePosTypeList const slice;
-    BAMFilePosTypeList::const_iterator cur;
+    bool startWithin;               /* the filter's window is this one */
+    BAMFileChunkList slice;
+    BAMFileChunkList::const_iterator cur;
+    uint64_t zoneChecked;           /* the block SkipZones last looked at */
+
+    // have the chunk after the current one read in the background
+    void PrefetchNext() {
+        if (cur != slice.end() && cur + 1 != slice.end())
+            cursor.Prefetch(cur[1]);
+    }
+    // pass over the blocks, from the one the next record starts, that the
+    // filter would reject every record of; see OpenOptions::zoneMap
+    bool SkipZones() {
+        ZoneMap const &zones = parent->file.getZones();
+        uint64_t const here = cursor.Tell().getValue();
+        
+        if (zones.empty() || (here >> 16) == zoneChecked)
+            return false;
+        zoneChecked = here >> 16;
+        
+        BAMZone const *zone = zones.Find(here);
+        BAMZone const *next;
+        unsigned skipped = 0;
+        
+        while (zone && filter.RejectsAll(*zone) && (next = zones.Next(zone)) != 0) {
+            zone = next;
+            ++skipped;
+            if (!(BAMFilePosType(zone->start) < cur->end))
+                break;
+        }
+        if (skipped == 0)
+            return false;
+        parent->file.CountSkipped(skipped);
+        cursor.Seek(BAMFilePosType(zone->start));
+        zoneChecked = zone->start >> 16;
+        return true;
+    }
+    // jump to the next chunk when the current one is used up
+    BAMRecord const *ReadRecord() {
+        do {
+            while (cur != slice.end() && !(cursor.Tell() < cur->end)) {
+                if (++cur == slice.end())
+                    break;
+                cursor.Seek(cur->beg);
+                PrefetchNext();
+            }
+        } while (cur != slice.end() && filter.isActive() && SkipZones());
+        return cur != slice.end() ? Alignment::ReadRecord() : 0;
+    }
+    void Resume(BAMFilePosType const next, uint64_t const extra) {
+        cur = ResumeChunk(slice, next);
+        if (cur == slice.end())
+            return;
+        cursor.Seek(cur->beg < next ? next : cur->beg);
+        PrefetchNext();
+    }
 public:
     AlignmentSlice(ReadCollection const *Parent,
                    bool const WantPrimary,
                    bool const WantSecondary,
-                   BAMFilePosTypeList const &Slice,
+                   BAMFileChunkList const &Slice,
+                   unsigned const RefID,
                    unsigned const Beg,
-                   unsigned const End)
-    : Alignment(Parent, WantPrimary, WantSecondary)
-    , slice(Slice)
+                   unsigned const End,
+                   BAMRecordFilter const &Filter = BAMRecordFilter(),
+                   bool const StartWithin = false,
+                   Reference const *const Via = 0)
+    : Alignment(Parent, WantPrimary, WantSecondary, Via)
+    , refID(RefID)
     , beg(Beg)
     , end(End)
-    , cur(Slice.begin())
+    , startWithin(StartWithin)
+    , slice(Slice)
+    , cur(slice.begin())
+    , zoneChecked(~(uint64_t)0)
     {
-        parent->Seek(*cur++);
+        filter = Filter;
+        cursor.Plan(slice);
+        cursor.Seek(cur->beg);
+        PrefetchNext();
     }
     
     bool nextAlignment() {
@@ -282,379 +1038,6502 @@ public:
                 if (REFID != refID || POS >= end)
                     return false;
                 
-                unsigned const REFLEN = current->refLen();
-                if (POS + REFLEN > beg)
+                unsigned const REFLEN = buffer.span().refLen;
+                if (POS + REFLEN > beg) {
+                    GotFirst();
                     return true;
+                }
             }
         }
     }
+
+    /* reposition
+     *  to another window of the reference, with the same filters; the
+     *  cursor keeps its buffers, and a window that starts in the block
+     *  it has is read from there without a seek
+     */
+    void reposition(int64_t const Start, uint64_t const length) {
+        HeaderRefInfo const &ri = parent->getRefInfo(refID);
+        
+        if (!ClipWindow(ri, Start, length, beg, end))
+            beg = end = 0;
+        filter = WindowFilter(filter, startWithin, refID, beg, end);
+        if (beg < end)
+            slice = ri.slice(beg, end);
+        else
+            slice.clear();
+        current = 0;
+        rejected = false;
+        ended = false;
+        cur = slice.begin();
+        if (cur == slice.end())
+            return;
+        cursor.Plan(slice);
+        cursor.Seek(cur->beg);
+        PrefetchNext();
+    }
+
+    /* skipTo
+     *  when the linear index has the first record that can reach refPos
+     *  more than SEEK_AHEAD bytes ahead, the cursor seeks to it; reading
+     *  through a few blocks costs less than the read-ahead a seek drops
+     *  the records passed over are read only as far as their CIGARs and
+     *  the one stopped at is read again in full
+     */
+    bool skipTo(int64_t const refPos) {
+        if (refPos > 0)
+            SeekAhead(refPos < (int64_t)end ? (unsigned)refPos : end);
+
+        unsigned const wanted = fields;
+        bool found;
+
+        fields = 0;
+        try {
+            do {
+                found = nextAlignment();
+            } while (found && current->pos() + buffer.span().refLen <= refPos);
+        }
+        catch (...) {
+            fields = wanted;
+            throw;
+        }
+        fields = wanted;
+        if (!found)
+            return false;
+        cursor.Seek(currentPos);
+        current = ReadRecord();
+        return current != 0;
+    }
+private:
+    enum { SEEK_AHEAD = 2 * BAM_BLK_MAX };
+
+    void SeekAhead(unsigned const refPos) {
+        BAMFilePosType const here = cursor.Tell();
+        BAMFilePosType const minPos = parent->getRefInfo(refID).minPos(refPos);
+
+        if (!(here < minPos) || minPos.fpos() < here.fpos() + SEEK_AHEAD)
+            return;
+        // the chunk with minPos in it, or the first after it
+        while (cur != slice.end() && !(minPos < cur->end))
+            ++cur;
+        if (cur == slice.end())
+            return;
+        cursor.Seek(cur->beg < minPos ? minPos : cur->beg);
+        PrefetchNext();
+    }
 };
 
-class ReadCollection::Reference : public ngs_adapt::ReferenceItf
+// the collection of a ticket, let go of only after the slice's cursor
+// is gone, as the cursor uses the collection's file to the end
+class ReadCollection::TicketHold
 {
-    ReadCollection *parent;
-    unsigned cur;
-    unsigned max;
-    int state;
-    
+protected:
+    ReadCollection *const ticket;
 public:
-    Reference(ReadCollection const *const Parent,
-              unsigned const current,
-              unsigned const references,
-              int const initState)
-    : parent(static_cast<ReadCollection *>(Parent->Duplicate()))
-    , cur(current)
-    , max(references)
-    , state(initState)
+    explicit TicketHold(ReadCollection const *const Ticket)
+    : ticket(static_cast<ReadCollection *>(Ticket->Duplicate()))
     {}
-    
-    ~Reference() {
-        parent->Release();
-    }
-    
-    ngs_adapt::StringItf *getCommonName() const {
-        if (state == 2)
-            throw std::runtime_error("no current row");
-        
-        HeaderRefInfo const &ri = parent->getRefInfo(cur);
-        std::string const &RNAME = ri.getName();
-        
-        return new ngs_adapt::StringItf(RNAME.data(), RNAME.size());
-    }
-    ngs_adapt::StringItf *getCanonicalName() const {
-        throw std::runtime_error("not available");
-    }
-    // TODO: rename to isCircular
-    bool getIsCircular() const {
-        throw std::runtime_error("not available");
+    ~TicketHold() {
+        ticket->Release();
     }
-    uint64_t getLength() const {
-        if (state == 2)
-            throw std::runtime_error("no current row");
-        
-        HeaderRefInfo const &ri = parent->getRefInfo(cur);
-        
-        return ri.getLength();
+};
+
+// a slice of a file on an htsget server, read from the start of the
+// collection of its own ticket, which has the records of the slice and
+// ones around it, in file order; those before the slice are passed over
+class ReadCollection::AlignmentTicket : private TicketHold, public ReadCollection::Alignment
+{
+    unsigned const refID;
+    unsigned const beg;
+    unsigned const end;
+public:
+    AlignmentTicket(ReadCollection const *Ticket,
+                    bool const WantPrimary,
+                    bool const WantSecondary,
+                    unsigned const RefID,
+                    unsigned const Beg,
+                    unsigned const End,
+                    BAMRecordFilter const &Filter = BAMRecordFilter())
+    : TicketHold(Ticket)
+    , Alignment(Ticket, WantPrimary, WantSecondary)
+    , refID(RefID)
+    , beg(Beg)
+    , end(End)
+    {
+        filter = Filter;
+    }
+
+    bool nextAlignment() {
+        for ( ; ; ) {
+            if (!Alignment::nextAlignment())
+                return false;
+            if (current->isSelfMapped()) {
+                unsigned const POS   = current->pos();
+                unsigned const REFID = current->refID();
+                
+                if (REFID > refID || (REFID == refID && POS >= end))
+                    return false;
+                if (REFID < refID)
+                    continue;
+                
+                unsigned const REFLEN = buffer.span().refLen;
+                if (POS + REFLEN > beg) {
+                    GotFirst();
+                    return true;
+                }
+            }
+        }
+    }
+};
+
+// a slice of up to CACHED_WINDOWS windows, read through the file's
+// RegionCache; the windows it doesn't have are read a run at a time and
+// put there; a record of several windows is given only the first time
+// it is found, since the windows are read in file order and so are the
+// records of each one
+class ReadCollection::AlignmentCachedSlice : public ReadCollection::Alignment
+{
+    unsigned const refID;
+    unsigned beg;
+    unsigned end;
+    bool const startWithin;         /* the filter's window is this one */
+    unsigned lastWindow;
+    unsigned window;                /* the one being read */
+    RegionWindow records;           /* of window */
+    size_t next;                    /* into records */
+    std::map<unsigned, RegionWindow> ahead;  /* the rest of the last run read */
+    uint64_t from;                  /* where the first record not yet given starts */
+
+    RegionCache &Cache() const {
+        return parent->file.getRegionCache();
+    }
+    void Load(unsigned const w) {
+        window = w;
+        next = 0;
+
+        std::map<unsigned, RegionWindow>::iterator const i = ahead.find(w);
+
+        if (i != ahead.end()) {
+            records.records.swap(i->second.records);
+            records.data.swap(i->second.data);
+            ahead.erase(i);
+        }
+        else if (!Cache().Get(refID, w, records))
+            Fill(w);
+    }
+    // reads w and the windows after it up to one that is cached
+    void Fill(unsigned const w) {
+        unsigned last = w;
+
+        ahead.clear();
+        while (last < lastWindow && last - w + 1 < CACHED_WINDOWS && !Cache().Get(refID, last + 1, ahead[last + 1]))
+            ahead.erase(++last);
+
+        HeaderRefInfo const &ri = parent->getRefInfo(refID);
+        unsigned const a = w << RegionCache::WINDOW_SHIFT;
+        unsigned const b = std::min<uint64_t>((uint64_t)(last + 1) << RegionCache::WINDOW_SHIFT, ri.getLength());
+        BAMFileChunkList const chunks = ri.slice(a, b);
+        std::vector<RegionWindow> run(last - w + 1);
+        bool done = false;
+
+        cursor.Plan(chunks);
+        for (BAMFileChunkList::const_iterator i = chunks.begin(); i != chunks.end() && !done; ++i) {
+            cursor.Seek(i->beg);
+            if (i + 1 != chunks.end())
+                cursor.Prefetch(i[1]);
+            while (cursor.Tell() < i->end) {
+                uint64_t const at = cursor.Tell().getValue();
+                BAMRecord const *const rec = cursor.Read(buffer);
+
+                if (!rec)
+                    break;
+                if (!rec->isSelfMapped())
+                    continue;
+                if ((unsigned)rec->refID() != refID || (unsigned)rec->pos() >= b) {
+                    done = true;
+                    break;
+                }
+
+                unsigned const pos = rec->pos();
+                unsigned const refLen = buffer.span().refLen;
+                unsigned const reach = pos + (refLen > 0 ? refLen : 1);
+
+                if (reach <= a)
+                    continue;
+
+                unsigned const first = std::max(pos >> RegionCache::WINDOW_SHIFT, w);
+                unsigned const to = std::min((reach - 1) >> RegionCache::WINDOW_SHIFT, last);
+
+                for (unsigned k = first; k <= to; ++k)
+                    run[k - w].Add(at, cursor.Tell().getValue(), rec->rawData(), rec->rawSize());
+            }
+        }
+        for (unsigned k = w; k <= last; ++k)
+            Cache().Put(refID, k, run[k - w]);
+        records.records.swap(run[0].records);
+        records.data.swap(run[0].data);
+        for (unsigned k = w + 1; k <= last; ++k) {
+            RegionWindow &dst = ahead[k];
+
+            dst.records.swap(run[k - w].records);
+            dst.data.swap(run[k - w].data);
+        }
+    }
+    BAMRecord const *ReadRecord() {
+        for ( ; ; ) {
+            if (ended)
+                return 0;
+            if (next == records.records.size()) {
+                if (window == lastWindow)
+                    ended = true;
+                else
+                    Load(window + 1);
+                continue;
+            }
+
+            RegionWindow::Record const &r = records.records[next++];
+
+            if (r.beg < from)
+                continue;
+            currentPos = BAMFilePosType(r.beg);
+            from = r.end;
+            memcpy(buffer.Reserve(r.size)->data, &records.data[r.offset], r.size);
+            buffer.Measure(false);
+
+            BAMRecord const *const rec = buffer.record();
+
+            rejected = filter.isActive() && (filter.Rejects(*rec) || filter.RejectsRest(*rec));
+            return rec;
+        }
+    }
+    void Checkpoint(BAMFilePosType &Next, uint64_t &extra) const {
+        Next = ended ? BAMFilePosType() : BAMFilePosType(from);
+        extra = 0;
+    }
+    // the windows are read again from the first, the records before "Next" passed over
+    void Resume(BAMFilePosType const Next, uint64_t const extra) {
+        if (Next.hasValue())
+            from = Next.getValue();
+        else
+            ended = true;
+    }
+public:
+    enum { CACHED_WINDOWS = 64 };
+
+    AlignmentCachedSlice(ReadCollection const *Parent,
+                         bool const WantPrimary,
+                         bool const WantSecondary,
+                         BAMFileChunkList const &Slice,
+                         unsigned const RefID,
+                         unsigned const Beg,
+                         unsigned const End,
+                         BAMRecordFilter const &Filter = BAMRecordFilter(),
+                         bool const StartWithin = false,
+                         Reference const *const Via = 0)
+    : Alignment(Parent, WantPrimary, WantSecondary, Via)
+    , refID(RefID)
+    , beg(Beg)
+    , end(End)
+    , startWithin(StartWithin)
+    , lastWindow((End - 1) >> RegionCache::WINDOW_SHIFT)
+    , window(0)
+    , next(0)
+    , from(Slice.front().beg.getValue())
+    {
+        filter = Filter;
+        Load(Beg >> RegionCache::WINDOW_SHIFT);
+    }
+
+    bool nextAlignment() {
+        for ( ; ; ) {
+            if (!Alignment::nextAlignment())
+                return false;
+
+            unsigned const POS = current->pos();
+
+            if (POS >= end)
+                return false;
+            if (POS + buffer.span().refLen > beg) {
+                GotFirst();
+                return true;
+            }
+        }
+    }
+    /* reposition
+     *  to another window of the reference, with the same filters; the
+     *  window being read and those read ahead with it are kept, so one
+     *  that starts in them is given without going to the cache
+     */
+    void reposition(int64_t const Start, uint64_t const length) {
+        HeaderRefInfo const &ri = parent->getRefInfo(refID);
+        BAMFileChunkList const &slice = ClipWindow(ri, Start, length, beg, end) && beg < end
+                                      ? ri.slice(beg, end) : BAMFileChunkList();
+        
+        current = 0;
+        rejected = false;
+        ended = slice.empty();
+        if (ended)
+            return;
+        filter = WindowFilter(filter, startWithin, refID, beg, end);
+        lastWindow = (end - 1) >> RegionCache::WINDOW_SHIFT;
+        from = slice.front().beg.getValue();
+        
+        unsigned const w = beg >> RegionCache::WINDOW_SHIFT;
+        
+        if (w != window)
+            Load(w);
+        else
+            next = 0;
+    }
+    // straight to the window of refPos, which has every record not yet given that reaches it
+    bool skipTo(int64_t const refPos) {
+        if (refPos > 0 && !ended) {
+            unsigned const w = refPos < (int64_t)end ? (unsigned)(refPos >> RegionCache::WINDOW_SHIFT) : lastWindow;
+
+            if (w > window)
+                Load(w);
+        }
+
+        bool found;
+
+        do {
+            found = nextAlignment();
+        } while (found && current->pos() + buffer.span().refLen <= refPos);
+        return found;
+    }
+};
+
+// the records from one record position up to another, as planned by getShard,
+// of one reference or, with a refID < 0, of every reference
+class ReadCollection::AlignmentShard : public ReadCollection::Alignment
+{
+    int const refID;
+    BAMFilePosType const end;
+
+    BAMRecord const *ReadRecord() {
+        return cursor.Tell() < end ? Alignment::ReadRecord() : 0;
+    }
+public:
+    AlignmentShard(ReadCollection const *Parent,
+                   bool const WantPrimary,
+                   bool const WantSecondary,
+                   BAMFileChunk const &Bounds,
+                   int const RefID,
+                   Reference const *const Via = 0)
+    : Alignment(Parent, WantPrimary, WantSecondary, Via)
+    , refID(RefID)
+    , end(Bounds.end)
+    {
+        cursor.Seek(Bounds.beg);
+    }
+    
+    bool nextAlignment() {
+        while (Alignment::nextAlignment()) {
+            if (refID < 0 || current->refID() == refID)
+                return true;
+        }
+        return false;
+    }
+};
+
+/* AlignmentSample
+ *  up to "limit" alignments drawn at random, see NGS_BAM::sampleAlignments:
+ *  runs of records, see BAMFile::getSampleUnits, are drawn by weight
+ *  without replacement and each is read whole, in the order drawn
+ */
+class ReadCollection::AlignmentSample : public ReadCollection::Alignment
+{
+    BAMFilePosTypeList const units;
+    std::vector<double> weights;    /* added up; drawn runs weigh 0 once Reweigh has run */
+    std::vector<bool> drawn;
+    size_t left;                    /* runs not drawn yet */
+    unsigned misses;                /* draws in a row of runs already drawn */
+    uint64_t const limit;
+    uint64_t returned;
+    uint64_t random;                /* state of the generator */
+    BAMFilePosType end;             /* of the run being read */
+
+    // a number in [0, 1), by splitmix64
+    double Random() {
+        uint64_t z = (random += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return (double)(z >> 11) * (1.0 / 9007199254740992.0);
+    }
+    // drop the weight of the runs already drawn, when draws keep finding them
+    void Reweigh() {
+        double total = 0;
+        double last = 0;
+        
+        for (size_t i = 0; i < weights.size(); ++i) {
+            double const weight = weights[i] - last;
+            
+            last = weights[i];
+            if (!drawn[i])
+                total += weight;
+            weights[i] = total;
+        }
+        misses = 0;
+    }
+    bool Draw() {
+        while (left > 0) {
+            size_t const i = std::upper_bound(weights.begin(), weights.end(), Random() * weights.back()) - weights.begin();
+            
+            if (i >= drawn.size() || drawn[i]) {
+                if (++misses == 32)
+                    Reweigh();
+                continue;
+            }
+            drawn[i] = true;
+            --left;
+            misses = 0;
+            cursor.Seek(units[i]);
+            end = units[i + 1];
+            return true;
+        }
+        return false;
+    }
+    BAMRecord const *ReadRecord() {
+        for ( ; ; ) {
+            if (cursor.Tell() < end) {
+                if (BAMRecord const *const rec = Alignment::ReadRecord())
+                    return rec;
+            }
+            if (!Draw())
+                return 0;
+        }
+    }
+    void Checkpoint(BAMFilePosType &next, uint64_t &extra) const {
+        throw std::runtime_error("not available");
+    }
+public:
+    AlignmentSample(ReadCollection const *Parent,
+                    bool const WantPrimary,
+                    bool const WantSecondary,
+                    BAMFilePosTypeList const &Units,
+                    std::vector<double> const &Weights,
+                    uint64_t const Limit,
+                    uint64_t const Seed)
+    : Alignment(Parent, WantPrimary, WantSecondary)
+    , units(Units)
+    , weights(Weights)
+    , drawn(Weights.size())
+    , left(Weights.size())
+    , misses(0)
+    , limit(Limit)
+    , returned(0)
+    , random(Seed)
+    {
+    }
+    
+    bool nextAlignment() {
+        if (returned >= limit || !Alignment::nextAlignment())
+            return false;
+        ++returned;
+        return true;
+    }
+};
+
+/* AlignmentIntervals
+ *  the alignments of many intervals in one pass over the merged chunks
+ *  of them all; a chunk that starts in the block where the one before it
+ *  ends is joined to it, so that the block is read once, and each record
+ *  is routed to the intervals it overlaps, being returned once for each
+ */
+class ReadCollection::AlignmentIntervals : public ReadCollection::Alignment
+{
+public:
+    struct Target {
+        unsigned refID;
+        unsigned beg;
+        unsigned end;
+        size_t index;               /* in the caller's list */
+
+        Target(unsigned const RefID, unsigned const Beg, unsigned const End = 0, size_t const Index = 0)
+        : refID(RefID), beg(Beg), end(End), index(Index)
+        {}
+        friend bool operator <(Target const &lhs, Target const &rhs) {
+            return lhs.refID < rhs.refID || (lhs.refID == rhs.refID && lhs.beg < rhs.beg);
+        }
+    };
+    typedef std::vector<Target> TargetList;
+private:
+    TargetList const targets;       /* by reference and start */
+    std::vector<unsigned> reach;    /* furthest end of targets[..i] on i's reference */
+    BAMFileChunkList const slice;
+    BAMFileChunkList::const_iterator cur;
+    std::vector<size_t> hits;       /* the intervals the current record overlaps */
+    size_t hit;                     /* the one it is returned for */
+
+    void PrefetchNext() {
+        if (cur != slice.end() && cur + 1 != slice.end())
+            cursor.Prefetch(cur[1]);
+    }
+    BAMRecord const *ReadRecord() {
+        while (cur != slice.end() && !(cursor.Tell() < cur->end)) {
+            if (++cur == slice.end())
+                break;
+            cursor.Seek(cur->beg);
+            PrefetchNext();
+        }
+        return cur != slice.end() ? Alignment::ReadRecord() : 0;
+    }
+    // the targets that start before the record's end, walked back while any
+    // of those on its reference may still end after its start
+    void Route() {
+        unsigned const REFID = current->refID();
+        unsigned const POS = current->pos();
+        unsigned const END = POS + buffer.span().refLen;
+        size_t i = std::lower_bound(targets.begin(), targets.end(), Target(REFID, END)) - targets.begin();
+
+        hits.clear();
+        for ( ; i > 0 && targets[i - 1].refID == REFID && reach[i - 1] > POS; --i) {
+            if (targets[i - 1].end > POS)
+                hits.push_back(targets[i - 1].index);
+        }
+        std::sort(hits.begin(), hits.end());
+        hit = 0;
+    }
+    // a record with intervals still to come is read again
+    void Checkpoint(BAMFilePosType &next, uint64_t &extra) const {
+        if (current && hit + 1 < hits.size()) {
+            next = currentPos;
+            extra = hit + 1;
+        }
+        else
+            Alignment::Checkpoint(next, extra);
+    }
+    void Resume(BAMFilePosType const next, uint64_t const extra) {
+        cur = ResumeChunk(slice, next);
+        if (cur == slice.end())
+            return;
+        cursor.Seek(cur->beg < next ? next : cur->beg);
+        PrefetchNext();
+        if (extra == 0)
+            return;
+        current = ReadRecord();
+        if (current)
+            Route();
+        if (!current || !current->isSelfMapped() || extra > hits.size())
+            throw std::runtime_error("cursor does not match the file");
+        hit = extra - 1;
+    }
+public:
+    AlignmentIntervals(ReadCollection const *Parent,
+                       bool const WantPrimary,
+                       bool const WantSecondary,
+                       BAMFileChunkList const &Slice,
+                       TargetList const &Targets)
+    : Alignment(Parent, WantPrimary, WantSecondary)
+    , targets(Targets)
+    , reach(Targets.size())
+    , slice(Slice)
+    , hit(0)
+    {
+        for (size_t i = 0; i < targets.size(); ++i) {
+            bool const more = i > 0 && targets[i - 1].refID == targets[i].refID;
+            reach[i] = more && reach[i - 1] > targets[i].end ? reach[i - 1] : targets[i].end;
+        }
+        cur = slice.begin();
+        cursor.Plan(slice);
+        cursor.Seek(cur->beg);
+        PrefetchNext();
+    }
+
+    /* Merge
+     *  the chunks in file order, with overlapping ones and those that
+     *  start in the block where the one before ends made one
+     */
+    static void Merge(BAMFileChunkList &chunks) {
+        std::sort(chunks.begin(), chunks.end());
+
+        size_t n = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (n > 0 && chunks[i].beg.fpos() <= chunks[n - 1].end.fpos()) {
+                if (chunks[n - 1].end < chunks[i].end)
+                    chunks[n - 1].end = chunks[i].end;
+            }
+            else
+                chunks[n++] = chunks[i];
+        }
+        chunks.resize(n);
+    }
+
+    bool nextAlignment() {
+        if (current && ++hit < hits.size())
+            return true;
+        while (Alignment::nextAlignment()) {
+            if (current->isSelfMapped()) {
+                Route();
+                if (!hits.empty())
+                    return true;
+            }
+        }
+        return false;
+    }
+    size_t getIntervalIndex() const {
+        if (!current)
+            throw std::runtime_error("no current row");
+        return hits[hit];
+    }
+};
+
+// a slice with the mates of its alignments that are outside the window;
+// the slice is read a batch at a time, the mates the batch asks for are
+// looked for at once in position order and then read in file order,
+// through the file's block cache, and each is given right after its
+// alignment; a mate is given if it passes the slice's filters and the
+// slice wouldn't give it itself
+class ReadCollection::AlignmentMates : public ReadCollection::Alignment
+{
+    struct Held {
+        BAMRecordBuffer *buffer;
+        BAMFilePosType pos;         /* its ID */
+        BAMFilePosType from;        /* of the slice's alignment, its own or its mate's */
+        bool isMate;
+    };
+    ReadCollection::Alignment *const slice;
+    unsigned const refID;
+    unsigned const beg;
+    unsigned const end;
+    BAMRecordFilter const wanted;   /* the slice's */
+    std::vector<BAMRecordBuffer *> buffers;
+    size_t used;                    /* of buffers, by this batch */
+    std::vector<Held> held;         /* this batch, in the order given */
+    size_t next;                    /* of held */
+    bool skipFirst;                 /* resumed at a mate */
+
+    enum { MATE_BATCH = 4096 };
+
+    BAMRecordBuffer &Buffer() {
+        if (used == buffers.size())
+            buffers.push_back(new BAMRecordBuffer());
+        return *buffers[used++];
+    }
+    // a primary alignment with a mapped mate that doesn't start in the window
+    bool AsksForMate(BAMRecord const &rec) const {
+        if (!want_primary || (rec.flag() & 0x0909) != 0x0001 || rec.next_refID() < 0 || rec.next_pos() < 0)
+            return false;
+        return rec.next_refID() != (int32_t)refID || rec.next_pos() < (int32_t)beg || rec.next_pos() >= (int32_t)end;
+    }
+    bool GivesMate(BAMRecord const &rec, unsigned const refLen) const {
+        int const mq = rec.mq();
+        
+        if ((rec.flag() & wanted.rejectFlags) != 0 || mq < wanted.minMapQ || mq > wanted.maxMapQ)
+            return false;
+        // the slice gives the ones that reach into the window from before it
+        return !(rec.refID() == (int32_t)refID && rec.pos() >= wanted.beg && rec.pos() < (int32_t)end &&
+                 (unsigned)rec.pos() + refLen > beg);
+    }
+    // false at the end of the slice
+    bool Refill() {
+        BAMMateRequestList requests;
+        std::vector<size_t> asking;     /* the held alignment of each request */
+        
+        held.clear();
+        next = 0;
+        used = 0;
+        while (held.size() < MATE_BATCH && slice->nextAlignment()) {
+            BAMRecordBuffer &into = Buffer();
+            BAMRecord const *const rec = slice->TakeRecord(into);
+            Held const h = { &into, slice->getCurrentPos(), slice->getCurrentPos(), false };
+            
+            if (AsksForMate(*rec)) {
+                asking.push_back(held.size());
+                requests.push_back(BAMMateRequest(*rec));
+            }
+            held.push_back(h);
+        }
+        if (held.empty())
+            return false;
+        if (skipFirst) {
+            next = 1;
+            skipFirst = false;
+        }
+        if (requests.empty())
+            return true;
+        
+        parent->file.FindMates(requests);
+        
+        std::vector<std::pair<BAMFilePosType, size_t> > order;
+        
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (requests[i].found)
+                order.push_back(std::make_pair(requests[i].mate, i));
+        }
+        std::sort(order.begin(), order.end());
+        
+        std::vector<BAMRecordBuffer *> mates(requests.size(), (BAMRecordBuffer *)0);
+        
+        for (size_t k = 0; k < order.size(); ++k) {
+            BAMRecordBuffer &into = Buffer();
+            
+            cursor.Seek(order[k].first);
+            
+            BAMRecord const *const rec = cursor.Read(into, fields);
+            
+            if (rec && GivesMate(*rec, into.span().refLen))
+                mates[order[k].second] = &into;
+            else
+                --used;
+        }
+        
+        // the mates go in after their alignments
+        std::vector<Held> batch;
+        size_t r = 0;
+        
+        batch.reserve(held.size() + order.size());
+        for (size_t i = 0; i < held.size(); ++i) {
+            batch.push_back(held[i]);
+            if (r < asking.size() && asking[r] == i) {
+                if (mates[r]) {
+                    Held const h = { mates[r], requests[r].mate, held[i].pos, true };
+                    batch.push_back(h);
+                }
+                ++r;
+            }
+        }
+        held.swap(batch);
+        return true;
+    }
+    // at a mate, its alignment is read again and passed over
+    void Checkpoint(BAMFilePosType &Next, uint64_t &extra) const {
+        if (next < held.size()) {
+            Next = held[next].from;
+            extra = held[next].isMate ? 1 : 0;
+        }
+        else
+            slice->Checkpoint(Next, extra);
+    }
+    void Resume(BAMFilePosType const Next, uint64_t const extra) {
+        held.clear();
+        next = 0;
+        slice->current = 0;
+        slice->Resume(Next, 0);
+        skipFirst = extra != 0;
+    }
+    AlignmentMates(ReadCollection const *Parent,
+                   ReadCollection::Alignment *const Slice,
+                   unsigned const RefID,
+                   unsigned const Beg,
+                   unsigned const End,
+                   BAMRecordFilter const &Wanted)
+    : Alignment(Parent, Slice->want_primary, Slice->want_secondary, Slice->via)
+    , slice(Slice)
+    , refID(RefID)
+    , beg(Beg)
+    , end(End)
+    , wanted(Wanted)
+    , used(0)
+    , next(0)
+    , skipFirst(false)
+    {
+    }
+public:
+    // takes "Slice" over
+    static ReadCollection::Alignment *Make(ReadCollection const *Parent,
+                                           ReadCollection::Alignment *const Slice,
+                                           unsigned const RefID,
+                                           unsigned const Beg,
+                                           unsigned const End,
+                                           BAMRecordFilter const &Wanted)
+    {
+        try {
+            return new AlignmentMates(Parent, Slice, RefID, Beg, End, Wanted);
+        }
+        catch (...) {
+            Slice->Release();
+            throw;
+        }
+    }
+    ~AlignmentMates() {
+        for (size_t i = 0; i < buffers.size(); ++i)
+            delete buffers[i];
+        slice->Release();
+    }
+    
+    bool nextAlignment() {
+        while (next == held.size()) {
+            if (!Refill())
+                return false;
+        }
+        Held const &h = held[next++];
+        
+        buffer.Swap(*h.buffer);
+        current = buffer.record();
+        currentPos = h.pos;
+        rejected = false;
+        GotFirst();
+        return true;
+    }
+};
+
+/* AlignmentOne
+ *  the record at an alignment ID, read with a single seek; refID < 0
+ *  takes it on any reference
+ */
+class ReadCollection::AlignmentOne : public ReadCollection::Alignment
+{
+    static std::runtime_error NotFound(char const id[]) {
+        return std::runtime_error(std::string("no alignment with ID '") + id + "'");
+    }
+    AlignmentOne(ReadCollection const *Parent, BAMFilePosType const pos, char const id[], int const refID)
+    : Alignment(Parent, true, true, pos)
+    {
+        current = Alignment::ReadRecord();
+        if (!current || !cursor.isGoodRecord(*current) || (current->flag() & 0x0004) != 0 ||
+            current->refID() < 0 || current->refID() >= (int)parent->file.countOfReferences() ||
+            (refID >= 0 && current->refID() != refID))
+        {
+            throw NotFound(id);
+        }
+    }
+public:
+    static AlignmentOne *Make(ReadCollection const *Parent, char const id[], int const refID) {
+        BAMFilePosType pos;
+        
+        if (!ParseAlignmentId(id, pos))
+            throw NotFound(id);
+        // a position that isn't a record start shows up as a bad block or record
+        try {
+            return new AlignmentOne(Parent, pos, id, refID);
+        }
+        catch (std::runtime_error const &) {
+            throw NotFound(id);
+        }
+    }
+    bool nextAlignment() {
+        throw std::runtime_error("no more rows available");
+    }
+    bool nextAlignmentBatch(NGS_AlignmentBatch_v1 &batch) {
+        throw std::runtime_error("no more rows available");
+    }
+};
+
+/* Read
+ *  reads are templates: the primary records of one are its fragments,
+ *  in segment order, and an iterator groups them with a BAMTemplateReader;
+ *  reads are numbered from 1 in the order it returns them
+ *  a read's ID is the alignment ID of its record that comes first in
+ *  the file, a fragment's that of its own record
+ *  bases and qualities are given as sequenced, so those of a record
+ *  aligned to the reverse strand are reversed, and the bases complemented
+ */
+class ReadCollection::Read : public ngs_adapt::ReadItf
+{
+    mutable std::string idBuffer;
+    mutable std::string fragmentIdBuffer;
+    mutable std::string seqBuffer;
+    mutable std::string qualBuffer;
+    mutable StringSlot readIdString;
+    mutable StringSlot fragmentIdString;
+    mutable StringSlot readNameString;
+    mutable StringSlot readGroupString;
+    mutable StringSlot basesString;
+    mutable StringSlot qualitiesString;
+    mutable std::string cursorBuffer;
+    mutable StringSlot cursorString;
+    
+    ReadCollection *parent;
+    BAMTemplateReader *reader;      /* 0 for a single read */
+    BAMTemplateSegment seg[2];
+    unsigned segments;              /* of the current read, 0 without one */
+    unsigned fragment;              /* 1 + the current one, 0 before the first */
+    uint64_t row;                   /* of the current read */
+    uint64_t first;                 /* the rows wanted */
+    uint64_t last;
+    uint32_t categories;            /* wanted, a mask of ngs::Read::ReadCategory */
+    
+    static std::runtime_error NotFound(char const id[]) {
+        return std::runtime_error(std::string("no read with ID '") + id + "'");
+    }
+    BAMRecord const &Current() const {
+        if (segments == 0)
+            throw std::runtime_error("no current row");
+        return *seg[0].record();
+    }
+    BAMTemplateSegment const &Fragment() const {
+        if (fragment == 0 || fragment > segments)
+            throw std::runtime_error("no current fragment");
+        return seg[fragment - 1];
+    }
+    uint32_t Category() const {
+        int const flag = seg[0].record()->flag();
+        
+        if (segments == 1)
+            return ReadCategory(flag);
+        return ReadCategory((flag & 0x0004) == 0, (seg[1].record()->flag() & 0x0004) == 0);
+    }
+    
+    static void AppendBases(BAMRecord const &rec, std::string &dst);
+    static bool AppendQualities(BAMRecord const &rec, std::string &dst);
+    
+    ngs_adapt::StringItf *Slice(std::string const &value, uint64_t const offset, uint64_t const length,
+                                StringSlot &slot) const
+    {
+        uint64_t const beg = offset < value.size() ? offset : value.size();
+        uint64_t const end = length < value.size() - beg ? beg + length : value.size();
+        
+        return slot.Set(value.data() + beg, end - beg);
+    }
+    
+    Read(ReadCollection const *Parent, BAMFilePosType const pos, char const id[]);
+public:
+    /* the reads in rows [First, First + Count) */
+    Read(ReadCollection const *Parent, uint64_t const First, uint64_t const Count, uint32_t const Categories)
+    : parent(static_cast<ReadCollection *>(Parent->Duplicate()))
+    , reader(new BAMTemplateReader(Parent->file, Parent->getFields(), Parent->mateBuffer))
+    , segments(0)
+    , fragment(0)
+    , row(0)
+    , first(First)
+    , last(Count < UINT64_MAX - First ? First + Count : UINT64_MAX)
+    , categories(Categories)
+    {
+    }
+    /* the reads of the "count" records without a reference, from "start" on */
+    Read(ReadCollection const *Parent, BAMFilePosType const start, uint64_t const count)
+    : parent(static_cast<ReadCollection *>(Parent->Duplicate()))
+    , reader(count > 0 ? new BAMTemplateReader(Parent->file, Parent->getFields(), Parent->mateBuffer, start) : 0)
+    , segments(0)
+    , fragment(0)
+    , row(0)
+    , first(1)
+    , last(UINT64_MAX)
+    , categories(~(uint32_t)0)    /* they are all unaligned */
+    {
+    }
+    ~Read() {
+        if (reader) {
+            parent->CountMateBuffer(reader->getPeakBytes(), reader->getEvictions());
+            delete reader;
+        }
+        parent->Release();
+    }
+    
+    /* Make
+     *  the read with the record at "id", which may be any of its records,
+     *  or, with a name index, the read named "id"
+     */
+    static Read *Make(ReadCollection const *Parent, char const id[]) {
+        BAMFilePosType pos;
+        
+        if (ParseAlignmentId(id, pos)) {
+            // a position that isn't a record start shows up as a bad block or record
+            try {
+                return new Read(Parent, pos, id);
+            }
+            catch (std::runtime_error const &) {
+            }
+        }
+        if (!Parent->FindReadName(id, pos))
+            throw NotFound(id);
+        return new Read(Parent, pos, id);
+    }
+    
+    ngs_adapt::StringItf *getReadId() const;
+    /* getReadRowId
+     *  the number of getReadId, the virtual offset of the read's first record
+     */
+    uint64_t getReadRowId() const {
+        Current();
+        return (segments > 1 && seg[1].pos < seg[0].pos ? seg[1].pos : seg[0].pos).getValue();
+    }
+    uint32_t getNumFragments() const {
+        Current();
+        return segments;
+    }
+    uint32_t getReadCategory() const {
+        Current();
+        return Category();
+    }
+    ngs_adapt::StringItf *getReadGroup() const {
+        return parent->getReadGroup(Current(), readGroupString);
+    }
+    ngs_adapt::StringItf *getReadName() const;
+    ngs_adapt::StringItf *getReadBases(uint64_t offset, uint64_t length) const;
+    ngs_adapt::StringItf *getReadQualities(uint64_t offset, uint64_t length) const;
+    bool nextRead();
+    /* getCursor, resumeFrom
+     *  "R1", the row of the current read and the reader's Checkpoint:
+     *  where it reads next and the records it holds, which with
+     *  collated input are none, and otherwise those waiting for mates
+     */
+    ngs_adapt::StringItf *getCursor() const;
+    void resumeFrom(char const cursor[]);
+    
+    ngs_adapt::StringItf *getFragmentId() const {
+        FormatAlignmentId(Fragment().pos, fragmentIdBuffer);
+        return fragmentIdString.Set(fragmentIdBuffer);
+    }
+    ngs_adapt::StringItf *getFragmentBases(uint64_t offset, uint64_t length) const;
+    ngs_adapt::StringItf *getFragmentQualities(uint64_t offset, uint64_t length) const;
+    bool getFragmentBasesPacked(uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 &packed) const;
+    bool nextFragment() {
+        if (fragment < segments) {
+            ++fragment;
+            return true;
+        }
+        fragment = segments + 1;
+        return false;
+    }
+    uint32_t getFragmentIndex() const {
+        Fragment();
+        return fragment - 1;
+    }
+    bool isPaired() const {
+        return (Fragment().record()->flag() & 0x0001) != 0;
+    }
+    bool isAligned() const {
+        return (Fragment().record()->flag() & 0x0004) == 0;
+    }
+};
+
+/* AlignFilter
+ *  the record filter for NGS_ReferenceAlignFlags and a mapping quality
+ *  over [beg, end) of refID; it passes everything when nothing is asked
+ *  for, so that records are read in one piece; there is no wraparound
+ *  in BAM, so no_wraparound changes nothing
+ */
+static BAMRecordFilter AlignFilter(uint32_t const flags, int32_t const mapQual,
+                                   unsigned const refID, unsigned const beg, unsigned const end,
+                                   RecordProgram const *const program = 0)
+{
+    BAMRecordFilter filter;
+    
+    filter.program = program;
+    if ((flags & NGS_ReferenceAlignFlags_pass_bad) == 0)
+        filter.rejectFlags |= 0x0200;
+    if ((flags & NGS_ReferenceAlignFlags_pass_dups) == 0)
+        filter.rejectFlags |= 0x0400;
+    if ((flags & NGS_ReferenceAlignFlags_min_map_qual) != 0)
+        filter.minMapQ = mapQual;
+    if ((flags & NGS_ReferenceAlignFlags_max_map_qual) != 0)
+        filter.maxMapQ = mapQual;
+    return WindowFilter(filter, (flags & NGS_ReferenceAlignFlags_start_within_window) != 0, refID, beg, end);
+}
+
+// steps through a slice one reference position at a time
+// the alignments covering the current position are kept ordered by end,
+// so the finished ones are always at the front; each one keeps its place
+// in its CIGAR and is advanced as the position moves
+// the records are held in buffers that are recycled once an alignment
+// is finished, and the events are the active alignments themselves
+// with a maximum depth, the alignments starting at a position are sampled
+// down to the room left by the active ones before they become active
+class ReadCollection::Pileup : public ngs_adapt::PileupItf
+{
+    struct Active {
+        BAMRecordBuffer *buffer;
+        BAMRecord const *rec;
+        BAMFilePosType pos;         /* where rec starts, its alignment ID */
+        unsigned first;             /* first reference position */
+        unsigned end;               /* first reference position past the end */
+        unsigned op;                /* current CIGAR operation */
+        unsigned left;              /* reference positions left in op, including this one */
+        unsigned seqPos;            /* sequence position at this reference position */
+        unsigned insPos;            /* insertion just before this reference position */
+        unsigned insLen;
+        int code;                   /* CIGAR code of op */
+
+        friend bool operator <(Active const &a, Active const &b) {
+            return a.end < b.end;
+        }
+    };
+
+    Reference *const via;           /* what holds parent, see Hold */
+    ReadCollection *parent;
+    AlignmentSlice *source;         /* NULL if nothing overlaps the window, or once read */
+    std::vector<AlignmentSlice *> following; /* read from after source, see extendTo */
+    unsigned const refID;
+    unsigned const beg;
+    unsigned end;
+    unsigned column;
+    uint32_t const flags;
+    int32_t const mapQual;
+    unsigned const maxDepth;        /* 0 if not sampled */
+    uint64_t random;                /* state of the sampling's generator */
+    bool const skipEmpty;
+    bool started;
+    bool held;                      /* column is the old end, still to be visited */
+    bool havePending;
+    Active pending;                 /* the next alignment to start */
+    std::vector<Active> active;
+    std::vector<Active> entering;   /* the sample being taken */
+    std::vector<BAMRecordBuffer *> spare;
+    int event;                      /* index into active, -1 before the first event */
+    mutable std::string insBuffer;
+    mutable std::string idBuffer;
+    mutable StringSlot insString;
+    mutable StringSlot alignmentIdString;
+    mutable StringSlot referenceSpecString;
+
+    static bool consumesSequence(int const code) {
+        return code == 0 || code == 7 || code == 8;
+    }
+
+    // find the next operation at or after op that consumes reference,
+    // gathering any insertion on the way
+    static void Enter(Active &a) {
+        unsigned const n = a.rec->nc();
+
+        a.insLen = 0;
+        for ( ; a.op < n; ++a.op) {
+            uint32_t const op = a.rec->cigar(a.op);
+            int const code = op & 0x0F;
+            unsigned const len = op >> 4;
+
+            switch (code) {
+                case 1: /* I */
+                    if (a.insLen == 0)
+                        a.insPos = a.seqPos;
+                    a.insLen += len;
+                    a.seqPos += len;
+                    break;
+                case 4: /* S */
+                    a.seqPos += len;
+                    break;
+                case 0: /* M */
+                case 2: /* D */
+                case 3: /* N */
+                case 7: /* = */
+                case 8: /* X */
+                    if (len > 0) {
+                        a.left = len;
+                        a.code = code;
+                        return;
+                    }
+                    break;
+            }
+        }
+        a.left = 0;
+    }
+    static void Advance(Active &a, unsigned n) {
+        while (n > 0 && a.left > 0) {
+            unsigned const k = n < a.left ? n : a.left;
+
+            if (consumesSequence(a.code))
+                a.seqPos += k;
+            a.left -= k;
+            a.insLen = 0;
+            n -= k;
+            if (a.left == 0) {
+                ++a.op;
+                Enter(a);
+            }
+        }
+    }
+
+    // on to the next alignment of the source, or of those that follow it;
+    // a source is let go of once it is used up
+    bool Next() {
+        for ( ; ; ) {
+            if (source) {
+                if (source->nextAlignment())
+                    return true;
+                source->Release();
+                source = 0;
+            }
+            if (following.empty())
+                return false;
+            source = following.front();
+            following.erase(following.begin());
+        }
+    }
+    // read ahead to the next alignment; the source has filtered them
+    void Fetch() {
+        havePending = false;
+        if (Next()) {
+            if (spare.empty())
+                spare.push_back(new BAMRecordBuffer());
+
+            BAMRecordBuffer *const buffer = spare.back();
+            BAMRecord const *const rec = source->TakeRecord(*buffer);
+
+            spare.pop_back();
+            pending.buffer = buffer;
+            pending.rec = rec;
+            pending.pos = source->getCurrentPos();
+            pending.first = rec->pos();
+            pending.end = pending.first + buffer->span().refLen;
+            pending.op = 0;
+            pending.seqPos = 0;
+            Enter(pending);
+            havePending = true;
+        }
+    }
+    void Start() {
+        Active a = pending;
+
+        Advance(a, column - a.first);
+        if (a.end > column)
+            active.insert(std::upper_bound(active.begin(), active.end(), a), a);
+        else
+            spare.push_back(a.buffer);
+        Fetch();
+    }
+    // a number in [0, n), by splitmix64
+    unsigned Random(unsigned const n) {
+        uint64_t z = (random += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return (unsigned)(((z >> 32) * n) >> 32);
+    }
+    // start as many of the alignments starting here as there is room for,
+    // each as likely as the others to be taken: the k'th to reach the
+    // column replaces one of those taken so far with the chance room / k
+    void Sample() {
+        unsigned const room = maxDepth > active.size() ? maxDepth - (unsigned)active.size() : 0;
+        unsigned seen = 0;
+
+        entering.clear();
+        while (havePending && pending.first <= column) {
+            Active a = pending;
+
+            Advance(a, column - a.first);
+            if (a.end <= column)
+                spare.push_back(a.buffer);
+            else if (++seen <= room)
+                entering.push_back(a);
+            else {
+                unsigned const j = Random(seen);
+                if (j < room) {
+                    spare.push_back(entering[j].buffer);
+                    entering[j] = a;
+                }
+                else
+                    spare.push_back(a.buffer);
+            }
+            Fetch();
+        }
+        for (unsigned i = 0; i < entering.size(); ++i)
+            active.insert(std::upper_bound(active.begin(), active.end(), entering[i]), entering[i]);
+    }
+
+    uint32_t EventType(Active const &a) const {
+        uint32_t type;
+
+        switch (a.code) {
+            case 2: /* D */
+            case 3: /* N */
+                type = ngs::PileupEvent::deletion;
+                break;
+            case 8: /* X */
+                type = ngs::PileupEvent::mismatch;
+                break;
+            default:
+                type = ngs::PileupEvent::match;
+                break;
+        }
+        if (a.insLen > 0)
+            type |= ngs::PileupEvent::insertion;
+        if (column == a.first)
+            type |= ngs::PileupEvent::alignment_start;
+        if (column + 1 == a.end)
+            type |= ngs::PileupEvent::alignment_stop;
+        if ((a.rec->flag() & 0x0010) != 0)
+            type |= ngs::PileupEvent::alignment_minus_strand;
+        return type;
+    }
+    static char Base(Active const &a) {
+        return consumesSequence(a.code) ? a.rec->seq(a.seqPos) : '-';
+    }
+    static char Quality(Active const &a) {
+        if (!consumesSequence(a.code))
+            return '!';
+
+        int const qv = a.rec->qual()[a.seqPos];
+        return (char)((qv > 63 ? 63 : qv) + 33);
+    }
+    // copies an insertion into the arena if there is room, measuring it anyway
+    static void ColumnInsertion(NGS_PileupColumn_v1 &col, uint32_t const i, Active const &a, bool const quals) {
+        NGS_PileupColumnString_v1 *const dst = quals ? col.ins_quals : col.ins_bases;
+        
+        if (i < col.capacity) {
+            dst[i].offset = col.arena_used;
+            dst[i].size = a.insLen;
+        }
+        if (a.insLen > 0 && i < col.capacity && col.arena_used <= col.arena_size && a.insLen <= col.arena_size - col.arena_used) {
+            char *const out = col.arena + col.arena_used;
+            if (quals)
+                a.rec->decodeQual(out, a.insPos, a.insLen, true, 63);
+            else
+                a.rec->decodeSeq(out, a.insPos, a.insLen);
+        }
+        col.arena_used += a.insLen;
+    }
+    // counts the active alignments from their packed bases, as
+    // get_base_counts has them: by Base and Quality, or as deletions
+    void CountBases(int32_t const minQual, NGS_PileupBaseCounts_v1 &counts) const {
+        static uint8_t const kind[16] = {
+            NGS_PileupBaseCount_N, NGS_PileupBaseCount_A, NGS_PileupBaseCount_C, NGS_PileupBaseCount_N,
+            NGS_PileupBaseCount_G, NGS_PileupBaseCount_N, NGS_PileupBaseCount_N, NGS_PileupBaseCount_N,
+            NGS_PileupBaseCount_T, NGS_PileupBaseCount_N, NGS_PileupBaseCount_N, NGS_PileupBaseCount_N,
+            NGS_PileupBaseCount_N, NGS_PileupBaseCount_N, NGS_PileupBaseCount_N, NGS_PileupBaseCount_N
+        };
+
+        counts.position = column;
+        memset(counts.plus, 0, sizeof(counts.plus));
+        memset(counts.minus, 0, sizeof(counts.minus));
+        for (unsigned i = 0; i < active.size(); ++i) {
+            Active const &a = active[i];
+            uint32_t *const n = (a.rec->flag() & 0x0010) != 0 ? counts.minus : counts.plus;
+
+            if (a.insLen > 0)
+                ++n[NGS_PileupBaseCount_insertion];
+            if (!consumesSequence(a.code)) {
+                ++n[NGS_PileupBaseCount_deletion];
+                continue;
+            }
+            if (minQual > 0) {
+                int const qv = a.rec->qual()[a.seqPos];
+                if ((qv > 63 ? 63 : qv) < minQual)
+                    continue;
+            }
+            uint8_t const b4na2 = a.rec->seq()[a.seqPos >> 1];
+            ++n[kind[(a.seqPos & 1) ? (b4na2 & 15) : (b4na2 >> 4)]];
+        }
+    }
+    Active const &current() const {
+        if (event < 0 || (unsigned)event >= active.size())
+            throw std::runtime_error("no current event");
+        return active[event];
+    }
+
+public:
+    Pileup(ReadCollection const *const Parent,
+           BAMFileChunkList const &Slice,
+           unsigned const RefID,
+           unsigned const Beg,
+           unsigned const End,
+           uint32_t const Flags,
+           int32_t const MapQual,
+           unsigned const MaxDepth,
+           uint64_t const Seed,
+           bool const SkipEmpty,
+           Reference const *const Via)
+    : PileupItf()
+    , via(const_cast<Reference *>(Via))
+    , parent(Hold(Parent, Via))
+    , source(0)
+    , refID(RefID)
+    , beg(Beg)
+    , end(End)
+    , column(Beg)
+    , flags(Flags)
+    , mapQual(MapQual)
+    , maxDepth(MaxDepth)
+    , random(Seed)
+    , skipEmpty(SkipEmpty)
+    , started(false)
+    , held(false)
+    , havePending(false)
+    , event(-1)
+    {
+        if (Slice.size() > 0 && (Flags & (NGS_ReferenceAlignFlags_wants_primary | NGS_ReferenceAlignFlags_wants_secondary)) != 0) {
+            source = new AlignmentSlice(parent,
+                                        (Flags & NGS_ReferenceAlignFlags_wants_primary) != 0,
+                                        (Flags & NGS_ReferenceAlignFlags_wants_secondary) != 0,
+                                        Slice, RefID, Beg, End,
+                                        AlignFilter(Flags, MapQual, RefID, Beg, End),
+                                        false, Via);
+        }
+    }
+    ~Pileup() {
+        for (unsigned i = 0; i < active.size(); ++i)
+            delete active[i].buffer;
+        for (unsigned i = 0; i < spare.size(); ++i)
+            delete spare[i];
+        if (havePending)
+            delete pending.buffer;
+        if (source)
+            source->Release();
+        for (unsigned i = 0; i < following.size(); ++i)
+            following[i]->Release();
+        LetGo(parent, via);
+    }
+
+    int32_t getMappingQuality() const {
+        return current().rec->mq();
+    }
+    int32_t getReferenceIndex() const {
+        current();
+        return refID;
+    }
+    int32_t getMateReferenceIndex() const {
+        return current().rec->next_refID();
+    }
+    ngs_adapt::StringItf *getAlignmentId() const {
+        FormatAlignmentId(current().pos, idBuffer);
+        return alignmentIdString.Set(idBuffer);
+    }
+    int64_t getAlignmentPosition() const {
+        return current().seqPos;
+    }
+    int64_t getFirstAlignmentPosition() const {
+        return current().first;
+    }
+    int64_t getLastAlignmentPosition() const {
+        return current().end - 1;
+    }
+    uint32_t getEventType() const {
+        return EventType(current());
+    }
+    char getAlignmentBase() const {
+        Active const &a = current();
+
+        parent->Need(NGS_BAM::OpenOptions::bases);
+        return Base(a);
+    }
+    char getAlignmentQuality() const {
+        Active const &a = current();
+
+        parent->Need(NGS_BAM::OpenOptions::qualities);
+        return Quality(a);
+    }
+    ngs_adapt::StringItf *getInsertionBases() const {
+        Active const &a = current();
+
+        parent->Need(NGS_BAM::OpenOptions::bases);
+        insBuffer.resize(a.insLen);
+        if (a.insLen > 0)
+            a.rec->decodeSeq(&insBuffer[0], a.insPos, a.insLen);
+        return insString.Set(insBuffer);
+    }
+    ngs_adapt::StringItf *getInsertionQualities() const {
+        Active const &a = current();
+
+        parent->Need(NGS_BAM::OpenOptions::qualities);
+        insBuffer.resize(a.insLen);
+        if (a.insLen > 0)
+            a.rec->decodeQual(&insBuffer[0], a.insPos, a.insLen, true, 63);
+        return insString.Set(insBuffer);
+    }
+    uint32_t getEventRepeatCount() const {
+        return current().left;
+    }
+    uint32_t getEventIndelType() const {
+        Active const &a = current();
+
+        if (a.code != 3)
+            return ngs::PileupEvent::normal_indel;
+        parent->Need(NGS_BAM::OpenOptions::tags);
+
+        // the aligner's XS:A tag gives the direction of transcription
+        BAMRecord::OptionalField const *const xs = a.buffer->findTag("XS");
+        if (xs != 0 && xs->getValueType() == 'A') {
+            char const strand = xs->getRawValue()[0];
+            if (strand == '+')
+                return ngs::PileupEvent::intron_plus;
+            if (strand == '-')
+                return ngs::PileupEvent::intron_minus;
+        }
+        return ngs::PileupEvent::intron_unknown;
+    }
+    bool nextPileupEvent() {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+        if (event + 1 < (int)active.size()) {
+            ++event;
+            return true;
+        }
+        event = (int)active.size();
+        return false;
+    }
+    void resetPileupEvent() {
+        event = -1;
+    }
+    // the events are the active alignments, so they are all at hand
+    bool getColumn(NGS_PileupColumn_v1 &col) {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+
+        uint32_t const fields = col.fields;
+        if ((fields & (NGS_PileupColumnFields_base | NGS_PileupColumnFields_ins_bases)) != 0)
+            parent->Need(NGS_BAM::OpenOptions::bases);
+        if ((fields & (NGS_PileupColumnFields_qual | NGS_PileupColumnFields_ins_quals)) != 0)
+            parent->Need(NGS_BAM::OpenOptions::qualities);
+
+        uint32_t const n = (uint32_t)active.size();
+        uint32_t const m = n < col.capacity ? n : col.capacity;
+
+        col.count = n;
+        col.arena_used = 0;
+        for (uint32_t i = 0; i < m; ++i) {
+            Active const &a = active[i];
+
+            if ((fields & NGS_PileupColumnFields_event_type) != 0)
+                col.event_type[i] = EventType(a);
+            if ((fields & NGS_PileupColumnFields_base) != 0)
+                col.base[i] = Base(a);
+            if ((fields & NGS_PileupColumnFields_qual) != 0)
+                col.qual[i] = Quality(a);
+            if ((fields & NGS_PileupColumnFields_map_qual) != 0)
+                col.map_qual[i] = a.rec->mq();
+        }
+        if ((fields & (NGS_PileupColumnFields_ins_bases | NGS_PileupColumnFields_ins_quals)) != 0) {
+            for (uint32_t i = 0; i < n; ++i) {
+                if ((fields & NGS_PileupColumnFields_ins_bases) != 0)
+                    ColumnInsertion(col, i, active[i], false);
+                if ((fields & NGS_PileupColumnFields_ins_quals) != 0)
+                    ColumnInsertion(col, i, active[i], true);
+            }
+        }
+        event = -1;
+        return n <= col.capacity && col.arena_used <= col.arena_size;
+    }
+    // the positions after the first are moved to as nextPileup does
+    uint32_t getBaseCounts(int32_t const min_qual, uint32_t const count, NGS_PileupBaseCounts_v1 *const counts) {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+
+        parent->Need(NGS_BAM::OpenOptions::bases);
+        if (min_qual > 0)
+            parent->Need(NGS_BAM::OpenOptions::qualities);
+
+        uint32_t i = 0;
+        for ( ; i < count; ++i) {
+            if (i != 0 && !nextPileup())
+                break;
+            CountBases(min_qual, counts[i]);
+        }
+        event = -1;
+        return i;
+    }
+
+    ngs_adapt::StringItf *getReferenceSpec() const {
+        HeaderRefInfo const &ri = parent->getRefInfo(refID);
+        return referenceSpecString.Set(ri.getName(), ri.getNameLength());
+    }
+    int64_t getReferencePosition() const {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+        return column;
+    }
+    char getReferenceBase() const {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+        
+        // a BAM file doesn't carry the reference sequence, a FASTA file may
+        int const seq = parent->getSequence(refID);
+        if (seq < 0)
+            throw std::runtime_error("not available");
+        return parent->getFasta().Base(seq, column);
+    }
+    uint32_t getPileupDepth() const {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+        return (uint32_t)active.size();
+    }
+    bool nextPileup() {
+        if (!started) {
+            started = true;
+            Fetch();
+        }
+        else if (held)
+            held = false;
+        else if (column < end) {
+            ++column;
+            for (unsigned i = 0; i < active.size(); ++i)
+                Advance(active[i], 1);
+        }
+        event = -1;
+        if (column >= end)
+            return false;
+
+        for ( ; ; ) {
+            unsigned done = 0;
+            while (done < active.size() && active[done].end <= column) {
+                spare.push_back(active[done].buffer);
+                ++done;
+            }
+            active.erase(active.begin(), active.begin() + done);
+
+            if (maxDepth == 0) {
+                while (havePending && pending.first <= column)
+                    Start();
+            }
+            else
+                Sample();
+            if (!skipEmpty || !active.empty())
+                return true;
+
+            // nothing covers it, so go on to where the next alignment starts
+            column = havePending && pending.first < end ? pending.first : end;
+            if (column >= end)
+                return false;
+        }
+    }
+    /* extendTo
+     *  the alignments that cross the old end are already in hand, those
+     *  starting after it are read by a slice of their own, taken up when
+     *  the ones before it are used up
+     */
+    void extendTo(int64_t const newEnd) {
+        unsigned const len = parent->getRefInfo(refID).getLength();
+        
+        if (newEnd < (int64_t)end)
+            throw std::runtime_error("a pileup window can't be made smaller");
+        
+        unsigned const End = newEnd < (int64_t)len ? (unsigned)newEnd : len;
+        if (End <= end)
+            return;
+        if ((flags & (NGS_ReferenceAlignFlags_wants_primary | NGS_ReferenceAlignFlags_wants_secondary)) != 0) {
+            parent->NeedPositions(refID, "pileups");
+            
+            BAMFileChunkList const &slice = parent->getRefInfo(refID).slice(end, End);
+            if (slice.size() > 0) {
+                AlignmentSlice *const more =
+                    new AlignmentSlice(parent,
+                                       (flags & NGS_ReferenceAlignFlags_wants_primary) != 0,
+                                       (flags & NGS_ReferenceAlignFlags_wants_secondary) != 0,
+                                       slice, refID, end, End,
+                                       AlignFilter(flags | NGS_ReferenceAlignFlags_start_within_window, mapQual, refID, end, End),
+                                       false, via);
+                try {
+                    following.push_back(more);
+                }
+                catch (...) {
+                    more->Release();
+                    throw;
+                }
+            }
+        }
+        if (started && column >= end)
+            held = true;
+        if (started && !havePending)
+            Fetch();
+        end = End;
+    }
+};
+
+/* SumCoverage
+ *  turns the differences of Reference::AddCoverage into depths, in place;
+ *  they wrap around below zero, which the running sum undoes
+ */
+static void SumCoveragePlain(uint32_t *const depth, uint64_t const length)
+{
+    uint32_t sum = 0;
+    
+    for (uint64_t i = 0; i < length; ++i)
+        depth[i] = sum += depth[i];
+}
+
+#if CPU_DISPATCH
+/* the vector kernels sum within a vector by adding it to itself shifted
+ * by 1, 2, 4 columns, then carry the last column into the next */
+CPU_TARGET("sse2")
+static void SumCoverageSSE2(uint32_t *const depth, uint64_t const length)
+{
+    __m128i carry = _mm_setzero_si128();
+    uint64_t i = 0;
+    
+    for ( ; i + 4 <= length; i += 4) {
+        __m128i v = _mm_loadu_si128((__m128i const *)(depth + i));
+        
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, carry);
+        _mm_storeu_si128((__m128i *)(depth + i), v);
+        carry = _mm_shuffle_epi32(v, 0xFF);
+    }
+    uint32_t sum = (uint32_t)_mm_cvtsi128_si32(carry);
+    
+    for ( ; i < length; ++i)
+        depth[i] = sum += depth[i];
+}
+
+CPU_TARGET("avx2")
+static void SumCoverageAVX2(uint32_t *const depth, uint64_t const length)
+{
+    __m256i const last = _mm256_set1_epi32(7);
+    __m256i carry = _mm256_setzero_si256();
+    uint64_t i = 0;
+    
+    for ( ; i + 8 <= length; i += 8) {
+        __m256i v = _mm256_loadu_si256((__m256i const *)(depth + i));
+        
+        /* the shifts are within 128 bit lanes; the low lane's sum is
+         * then added to the high one */
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+        v = _mm256_add_epi32(v, _mm256_permute2x128_si256(_mm256_shuffle_epi32(v, 0xFF), v, 0x08));
+        v = _mm256_add_epi32(v, carry);
+        _mm256_storeu_si256((__m256i *)(depth + i), v);
+        carry = _mm256_permutevar8x32_epi32(v, last);
+    }
+    uint32_t sum = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(carry));
+    
+    for ( ; i < length; ++i)
+        depth[i] = sum += depth[i];
+}
+#endif
+
+/* the one in use, picked at load by sumCoverageKernel */
+static void (*SumCoverage)(uint32_t *, uint64_t) = SumCoveragePlain;
+
+static struct SumCoverageKernel {
+    SumCoverageKernel() {
+#if CPU_DISPATCH
+        CPU::Level const level = CPU::Best();
+        
+        if (level >= CPU::sse2)
+            SumCoverage = SumCoverageSSE2;
+        if (level >= CPU::avx2)
+            SumCoverage = SumCoverageAVX2;
+#endif
+    }
+} const sumCoverageKernel;
+
+/* the bases copyReferenceBases hints ahead of a reader that reads in order */
+#define FASTA_AHEAD (4u * 1024u * 1024u)
+
+class ReadCollection::Reference : public ngs_adapt::ReferenceItf
+{
+    friend class MergedCollection;  /* holds and releases them */
+    friend class ReadCollection;    /* its iterators hold them, see Hold */
+
+    mutable std::string basesBuffer;
+    mutable StringSlot basesString;
+    mutable unsigned aheadRef;      /* the reference copyReferenceBases read last, */
+    mutable uint64_t aheadNext;     /* the offset it expects next */
+    mutable uint64_t aheadTo;       /* and the end of what it has hinted */
+    ReadCollection *parent;
+    unsigned cur;
+    unsigned max;
+    int state;
+    
+public:
+    Reference(ReadCollection const *const Parent,
+              unsigned const current,
+              unsigned const references,
+              int const initState)
+    : aheadRef(~0u)
+    , aheadNext(0)
+    , aheadTo(0)
+    , parent(static_cast<ReadCollection *>(Parent->Duplicate()))
+    , cur(current)
+    , max(references)
+    , state(initState)
+    {}
+    
+    ~Reference() {
+        parent->Release();
+    }
+    
+    ngs_adapt::StringItf *getCommonName() const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        HeaderRefInfo const &ri = parent->getRefInfo(cur);
+        return new ngs_adapt::StringItf(ri.getName(), ri.getNameLength());
+    }
+    ngs_adapt::StringItf *getCanonicalName() const {
+        throw std::runtime_error("not available");
+    }
+    // TODO: rename to isCircular
+    bool getIsCircular() const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getLength() const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        HeaderRefInfo const &ri = parent->getRefInfo(cur);
+        
+        return ri.getLength();
+    }
+    // slices, shards and pileups all come from the index, bases from the FASTA
+    uint32_t getFeatures() const {
+        if (state == 2)
+            return 0;
+        
+        uint32_t const features = NGS_ReferenceFeature_alignment_by_id
+                                | (parent->getSequence(cur) >= 0 ? NGS_ReferenceFeature_bases : 0);
+        HeaderRefInfo const &ri = parent->getRefInfo(cur);
+        if (!ri.hasIndex())
+            return features;
+        
+        uint64_t mapped, unmapped;
+        return features
+             | NGS_ReferenceFeature_alignments
+             | NGS_ReferenceFeature_alignment_shard
+             | NGS_ReferenceFeature_pileups
+             | (ri.getIndexCounts(mapped, unmapped) || parent->file.getZones().hasCounts()
+                ? NGS_ReferenceFeature_alignment_count : 0);
+    }
+    // the sequence of the current reference, after checking "offset"
+    int Bases(uint64_t const offset) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        int const seq = parent->getSequence(cur);
+        if (seq < 0)
+            throw std::runtime_error("not available");
+        if (offset >= parent->getFasta().getLength(seq))
+            throw std::runtime_error("offset is out of range");
+        return seq;
+    }
+    ngs_adapt::StringItf *getReferenceBases(uint64_t const offset, uint64_t const length) const {
+        int const seq = Bases(offset);
+        
+        parent->getFasta().Copy(seq, offset, length, basesBuffer);
+        return basesString.Set(basesBuffer);
+    }
+    // the rest of a line of the FASTA file, without a copy unless it is compressed
+    ngs_adapt::StringItf *getReferenceChunk(uint64_t const offset, uint64_t const length) const {
+        int const seq = Bases(offset);
+        IndexedFasta const &fasta = parent->getFasta();
+        
+        if (fasta.isCompressed()) {
+            fasta.Copy(seq, offset, fasta.LineSize(seq, offset, length), basesBuffer);
+            return basesString.Set(basesBuffer);
+        }
+        
+        size_t size;
+        char const *const bases = fasta.Chunk(seq, offset, length, size);
+        
+        return new ngs_adapt::StringItf(bases, size);
+    }
+    /* the bases straight from the file, line by line; while they are
+     * asked for in order, the pages of the next FASTA_AHEAD are hinted */
+    uint64_t copyReferenceBases(uint64_t const offset, char *const buffer, uint64_t const size) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        int const seq = parent->getSequence(cur);
+        if (seq < 0)
+            throw std::runtime_error("not available");
+        
+        IndexedFasta const &fasta = parent->getFasta();
+        if (offset >= fasta.getLength(seq))
+            return 0;
+        
+        uint64_t const copied = fasta.Read(seq, offset, buffer, size);
+        uint64_t const end = offset + copied;
+        
+        if (aheadRef != cur || offset != aheadNext) {
+            aheadRef = cur;
+            aheadTo = end;
+        }
+        if (aheadTo < end + FASTA_AHEAD / 2) {
+            fasta.WillNeed(seq, aheadTo, end + FASTA_AHEAD - aheadTo);
+            aheadTo = end + FASTA_AHEAD;
+        }
+        aheadNext = end;
+        return copied;
+    }
+    bool getReferenceBasesPacked(uint64_t const offset, uint64_t const length, uint8_t *const bases, uint8_t *const n_mask, uint64_t &count) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        int const seq = parent->getSequence(cur);
+        if (seq < 0)
+            throw std::runtime_error("not available");
+        
+        IndexedFasta const &fasta = parent->getFasta();
+        count = offset < fasta.getLength(seq) ? fasta.ReadPacked(seq, offset, length, bases, n_mask) : 0;
+        return true;
+    }
+    uint64_t getAlignmentCount ( bool wants_primary, bool wants_secondary ) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        uint64_t mapped, unmapped;
+        ZoneMap const &zones = parent->file.getZones();
+        
+        if (!wants_primary && !wants_secondary)
+            return 0;
+        if (wants_primary && wants_secondary && parent->getRefInfo(cur).getIndexCounts(mapped, unmapped))
+            return mapped;
+        if (zones.hasCounts()) {
+            return (wants_primary ? zones.getCount(cur, ZoneMap::primary) : 0)
+                 + (wants_secondary ? zones.getCount(cur, ZoneMap::secondary) + zones.getCount(cur, ZoneMap::supplementary) : 0);
+        }
+        throw std::runtime_error("not available");
+    }
+    bool estimateSlice(int64_t const Start, uint64_t const length, uint64_t &alignments, uint64_t &bytes) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        unsigned start, end;
+        if (!getWindow(Start, length, start, end)) {
+            alignments = bytes = 0;
+            return true;
+        }
+        if (!parent->getRefInfo(cur).estimate(start, end, alignments, bytes))
+            return false;
+        
+        // the records that start in the windows it overlaps, if they are counted
+        ZoneMap const &zones = parent->file.getZones();
+        
+        if (zones.hasCounts()) {
+            alignments = zones.getCount(cur, ZoneMap::primary, start, end)
+                       + zones.getCount(cur, ZoneMap::secondary, start, end)
+                       + zones.getCount(cur, ZoneMap::supplementary, start, end);
+        }
+        return true;
+    }
+    /* explainSlice
+     *  see NGS_BAM::explainSlice
+     */
+    NGS_BAM::SlicePlan explainSlice(int64_t const Start, uint64_t const length) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        HeaderRefInfo const &ri = parent->getRefInfo(cur);
+        NGS_BAM::SlicePlan plan;
+        unsigned start, end;
+        
+        if (!ri.hasIndex())
+            throw std::runtime_error("the slices of '" + parent->path + "' can't be explained without its index");
+        if (getWindow(Start, length, start, end))
+            ri.explain(start, end, plan);
+        return plan;
+    }
+    /* summarizeCoverage
+     *  the bins of the file's coverage map over a window, see
+     *  NGS_BAM::summarizeCoverage; returns false if the map can't
+     *  answer: there is none, it was counted from other alignments, or
+     *  its finest bins are wider than "resolution"
+     */
+    bool summarizeCoverage(int64_t const Start, uint64_t const length, uint64_t const resolution,
+                           uint32_t const flags, int32_t const map_qual, std::vector<NGS_BAM::CoverageBin> &bins) const
+    {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        CoverageMap const *const map = parent->getFile().getCoverageMap();
+        int const level = CoverageMap::Level(resolution);
+        
+        if (!map || level < 0 || !map->counted(flags, map_qual))
+            return false;
+        
+        unsigned start, end;
+        if (!getWindow(Start, length, start, end) || start >= end)
+            return true;
+        
+        unsigned const shift = CoverageMap::Shift(level);
+        uint64_t const refLength = getLength();
+        size_t count;
+        CoverageBin const *const bin = map->getBins(cur, level, count);
+        
+        for (size_t i = start >> shift; i < count && ((uint64_t)i << shift) < end; ++i) {
+            uint64_t const beg = (uint64_t)i << shift;
+            uint64_t const lim = std::min(beg + ((uint64_t)1 << shift), refLength);
+            NGS_BAM::CoverageBin const b = { (int64_t)beg, lim - beg, bin[i].mean, bin[i].min, bin[i].max };
+            
+            bins.push_back(b);
+        }
+        return true;
+    }
+    /* isAdapted
+     *  the C object of a reference is one of these, so Self works on it
+     */
+    static bool isAdapted(NGS_Reference_v1 const *const obj) {
+        return obj != 0 && obj->vt == &ivt.dad;
+    }
+    ngs_adapt::AlignmentItf *getAlignment(char const id[]) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        return AlignmentOne::Make(parent, id, cur);
+    }
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary, bool const want_secondary) const {
+        return getAlignmentSlice(0, getLength(), want_primary, want_secondary);
+    }
+    /* getTicketSlice
+     *  a slice of a file on an htsget server, from a ticket for it alone
+     */
+    ngs_adapt::AlignmentItf *getTicketSlice(unsigned const start, unsigned const end, uint32_t const flags, int32_t const map_qual,
+                                            uint64_t const asked) const {
+        std::string const name = parent->getRefInfo(cur).getNameString();
+        ReadCollection *const ticket = new ReadCollection(HtsgetRegionPath(parent->path, name, start, end),
+                                                          parent->file.getOptions());
+        ReadCollection::Alignment *it = 0;
+        
+        try {
+            int const refID = ticket->file.getReferenceIndexByName(name);
+            
+            if (refID >= 0) {
+                it = new ReadCollection::AlignmentTicket(ticket, (flags & NGS_ReferenceAlignFlags_wants_primary) != 0,
+                                                         (flags & NGS_ReferenceAlignFlags_wants_secondary) != 0,
+                                                         refID, start, end, AlignFilter(flags, map_qual, refID, start, end));
+            }
+        }
+        catch (...) {
+            ticket->Release();
+            throw;
+        }
+        ticket->Release();
+        if (it == 0)
+            return new ReadCollection::AlignmentNone();
+        it->WaitForFirst(asked);
+        parent->file.getLatency().sliceOpen.Add(BGZFStats::Now() - asked);
+        return it;
+    }
+    // clip a window to the reference; returns false if nothing is left
+    bool getWindow(int64_t const Start, uint64_t const length, unsigned &start, unsigned &end) const {
+        return ClipWindow(parent->getRefInfo(cur), Start, length, start, end);
+    }
+    ngs_adapt::AlignmentItf *getAlignmentSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        uint32_t const flags = (want_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                             | (want_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                             | NGS_ReferenceAlignFlags_pass_bad
+                             | NGS_ReferenceAlignFlags_pass_dups;
+        
+        return getFilteredAlignmentSlice(start, length, flags, 0);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignments(uint32_t const flags, int32_t const map_qual) const {
+        return getFilteredAlignmentSlice(0, getLength(), flags, map_qual);
+    }
+    // the filters are tested on each record's fixed part, see AlignFilter
+    ngs_adapt::AlignmentItf *getFilteredAlignmentSlice(int64_t const Start, uint64_t const length, uint32_t const flags, int32_t const map_qual) const {
+        return getSlice(Start, length, flags, map_qual, 0);
+    }
+    /* getSlice
+     *  of getFilteredAlignmentSlice, with the records also tested by
+     *  "program", of which the iterator keeps a copy
+     */
+    ngs_adapt::AlignmentItf *getSlice(int64_t const Start, uint64_t const length, uint32_t const flags, int32_t const map_qual,
+                                      RecordProgram const *const program) const {
+        bool const want_primary = (flags & NGS_ReferenceAlignFlags_wants_primary) != 0;
+        bool const want_secondary = (flags & NGS_ReferenceAlignFlags_wants_secondary) != 0;
+        
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        unsigned start, end;
+        if (!getWindow(Start, length, start, end) || (!want_primary && !want_secondary))
+            return new ReadCollection::AlignmentNone();
+        
+        bool const withMates = (flags & NGS_ReferenceAlignFlags_with_mates) != 0;
+        
+        if (withMates)
+            parent->Need(NGS_BAM::OpenOptions::readName);
+        
+        uint64_t const asked = BGZFStats::Now();
+        
+        if (ByteSource::IsHtsget(parent->path)) {
+            if (withMates)
+                throw std::runtime_error("mates outside a slice aren't looked for on an htsget server");
+            if (program)
+                throw std::runtime_error("filter expressions aren't tested on records from an htsget server");
+            return getTicketSlice(start, end, flags, map_qual, asked);
+        }
+        
+        parent->NeedPositions(cur, "slices");
+        
+        BAMFileChunkList const &slice = parent->getRefInfo(cur).slice(start, end);
+        
+        if (slice.size() == 0)
+            return new ReadCollection::AlignmentNone();
+
+        ReadCollection::Alignment *it;
+        
+        if (parent->file.getRegionCache().isActive() &&
+            ((end - 1) >> RegionCache::WINDOW_SHIFT) - (start >> RegionCache::WINDOW_SHIFT) < ReadCollection::AlignmentCachedSlice::CACHED_WINDOWS)
+        {
+            it = new ReadCollection::AlignmentCachedSlice(parent, want_primary, want_secondary,
+                                                          slice, cur, start, end,
+                                                          AlignFilter(flags, map_qual, cur, start, end, program),
+                                                          (flags & NGS_ReferenceAlignFlags_start_within_window) != 0, this);
+        }
+        else {
+            it = new ReadCollection::AlignmentSlice(parent, want_primary, want_secondary,
+                                                    slice, cur, start, end,
+                                                    AlignFilter(flags, map_qual, cur, start, end, program),
+                                                    (flags & NGS_ReferenceAlignFlags_start_within_window) != 0, this);
+        }
+        it->KeepProgram();
+        if (withMates)
+            it = ReadCollection::AlignmentMates::Make(parent, it, cur, start, end, AlignFilter(flags, map_qual, cur, start, end));
+        it->WaitForFirst(asked);
+        parent->file.getLatency().sliceOpen.Add(BGZFStats::Now() - asked);
+        return it;
+    }
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard, uint32_t const count, bool const want_primary, bool const want_secondary) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        if (shard >= count)
+            throw std::runtime_error("shard is out of range");
+        
+        BAMFileChunk bounds;
+        
+        if ((!want_primary && !want_secondary) || !parent->getShard(cur, shard, count, bounds) || !(bounds.beg < bounds.end))
+            return new ReadCollection::AlignmentNone();
+        
+        return new ReadCollection::AlignmentShard(parent, want_primary, want_secondary, bounds, cur, this);
+    }
+    ngs_adapt::PileupItf *getPileups(bool const want_primary, bool const want_secondary) const {
+        return getPileupSlice(0, getLength(), want_primary, want_secondary);
+    }
+    ngs_adapt::PileupItf *getFilteredPileups(uint32_t flags, int32_t map_qual) const {
+        return getFilteredPileupSlice(0, getLength(), flags, map_qual);
+    }
+    ngs_adapt::PileupItf *getPileupSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        uint32_t const flags = (want_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                             | (want_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                             | NGS_ReferenceAlignFlags_pass_bad
+                             | NGS_ReferenceAlignFlags_pass_dups;
+        
+        return getFilteredPileupSlice(start, length, flags, 0);
+    }
+    /* AddCoverage
+     *  adds the M, D, = and X runs of the alignments of a filtered slice
+     *  to "diff", as differences from one position of the window to the
+     *  next: +1 where a run starts and -1 where it ends, so that the
+     *  running sum of "diff" is the depth; only the CIGARs are read
+     */
+    void AddCoverage(int64_t const Start, uint64_t const length, uint32_t const flags, int32_t const map_qual, uint32_t *const diff) const {
+        bool const want_primary = (flags & NGS_ReferenceAlignFlags_wants_primary) != 0;
+        bool const want_secondary = (flags & NGS_ReferenceAlignFlags_wants_secondary) != 0;
+        
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        unsigned start, end;
+        if (!getWindow(Start, length, start, end) || (!want_primary && !want_secondary))
+            return;
+        
+        parent->NeedPositions(cur, "slices");
+        
+        BAMFileChunkList const &slice = parent->getRefInfo(cur).slice(start, end);
+        if (slice.size() == 0)
+            return;
+        
+        ReadCollection::AlignmentSlice *const it =
+            new ReadCollection::AlignmentSlice(parent, want_primary, want_secondary,
+                                               slice, cur, start, end,
+                                               AlignFilter(flags, map_qual, cur, start, end),
+                                               false, this);
+        try {
+            it->DecodeOnly(0);
+            while (it->nextAlignment()) {
+                BAMRecord const &rec = *it->getRecord();
+                unsigned const n = rec.nc();
+                unsigned pos = rec.pos();
+                
+                for (unsigned i = 0; i < n; ++i) {
+                    uint32_t const op = rec.cigar(i);
+                    unsigned const len = op >> 4;
+                    
+                    switch (op & 0x0F) {
+                        case 0: /* M */
+                        case 2: /* D */
+                        case 7: /* = */
+                        case 8: /* X */
+                            if (pos < end && pos + len > start) {
+                                unsigned const a = pos > start ? pos : start;
+                                unsigned const b = pos + len < end ? pos + len : end;
+                                
+                                ++diff[a - Start];
+                                if ((uint64_t)(b - Start) < length)
+                                    --diff[b - Start];
+                            }
+                            pos += len;
+                            break;
+                        case 3: /* N */
+                            pos += len;
+                            break;
+                    }
+                }
+            }
+        }
+        catch (...) {
+            it->Release();
+            throw;
+        }
+        it->Release();
+    }
+    bool getCoverage(int64_t const start, uint64_t const length, uint32_t const flags, int32_t const map_qual, uint32_t *const depth) const {
+        memset(depth, 0, length * sizeof(depth[0]));
+        AddCoverage(start, length, flags, map_qual, depth);
+        SumCoverage(depth, length);
+        return true;
+    }
+    ngs_adapt::PileupItf *getFilteredPileupSlice(int64_t const start, uint64_t const length, uint32_t flags, int32_t map_qual) const {
+        return getSampledPileupSlice(start, length, flags, map_qual, 0, 0, false);
+    }
+    ngs_adapt::PileupItf *getSampledPileupSlice(int64_t const Start, uint64_t const length, uint32_t flags, int32_t map_qual,
+                                                uint32_t const max_depth, uint64_t const seed, bool const skip_empty) const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        unsigned start, end;
+        if (!getWindow(Start, length, start, end))
+            start = end = parent->getRefInfo(cur).getLength();
+        else
+            parent->NeedPositions(cur, "pileups");
+        
+        BAMFileChunkList const &slice = start < end ? parent->getRefInfo(cur).slice(start, end) : BAMFileChunkList();
+        
+        return new ReadCollection::Pileup(parent, slice, cur, start, end, flags, map_qual, max_depth, seed, skip_empty, this);
+    }
+    bool nextReference() {
+        switch (state) {
+            case 0:
+                if (cur < max) {
+                    state = 1;
+                    return true;
+                }
+                else {
+                    state = 2;
+                    return false;
+                }
+            case 1:
+                ++cur;
+                if (cur < max)
+                    return true;
+                state = 2;
+            case 2:
+                return false;
+            default:
+                throw std::runtime_error("no more rows available");
+        }
+    }
+};
+
+// a Reference holds the collection for as long as it lives
+ReadCollection *ReadCollection::Hold(ReadCollection const *const collection, Reference const *const via)
+{
+    if (via == 0)
+        return static_cast<ReadCollection *>(collection->Duplicate());
+    via->Duplicate();
+    return const_cast<ReadCollection *>(collection);
+}
+
+void ReadCollection::LetGo(ReadCollection *const collection, Reference *const via)
+{
+    if (via == 0)
+        collection->Release();
+    else
+        via->Release();
+}
+
+/* StatisticTable
+ *  a list of uint64 statistics, sorted by path
+ */
+class ReadCollection::StatisticTable : public ngs_adapt::StatisticsItf
+{
+    StatisticList values;
+    std::vector<std::string> text;  /* values in decimal, for getAsString */
+    std::vector<NGS_StatisticsEntry_v1> entries;    /* lent by getEntries */
+
+    unsigned Find(char const path[]) const {
+        StatisticList::const_iterator const i = std::lower_bound(values.begin(), values.end(),
+                                                                 Statistic(path, 0));
+        return (i != values.end() && i->path == path) ? unsigned(i - values.begin()) : unsigned(values.size());
+    }
+    unsigned Index(char const path[]) const {
+        unsigned const i = Find(path);
+        if (i == values.size())
+            throw std::runtime_error(std::string("no such statistic: ") + path);
+        return i;
+    }
+    uint64_t Value(char const path[]) const {
+        return values[Index(path)].value;
+    }
+public:
+    /* takes the contents of "list", which must be sorted */
+    explicit StatisticTable(StatisticList &list) {
+        values.swap(list);
+        text.reserve(values.size());
+        for (unsigned i = 0; i < values.size(); ++i) {
+            char buffer[24];
+            snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)values[i].value);
+            text.push_back(buffer);
+        }
+        entries.resize(values.size());
+        for (unsigned i = 0; i < values.size(); ++i) {
+            NGS_StatisticsEntry_v1 &e = entries[i];
+            e.path = values[i].path.c_str();
+            e.path_size = values[i].path.size();
+            e.text = "";
+            e.text_size = 0;
+            e.type = ngs::Statistics::uint64;
+            e.value.u64 = values[i].value;
+        }
+    }
+    uint32_t getValueType(char const path[]) const {
+        return Find(path) == values.size() ? ngs::Statistics::none : ngs::Statistics::uint64;
+    }
+    ngs_adapt::StringItf *getAsString(char const path[]) const {
+        std::string const &value = text[Index(path)];
+        return new ngs_adapt::StringItf(value.data(), value.size());
+    }
+    int64_t getAsI64(char const path[]) const {
+        uint64_t const value = Value(path);
+        if (value > (uint64_t)INT64_MAX)
+            throw std::runtime_error("value is too large for int64");
+        return (int64_t)value;
+    }
+    uint64_t getAsU64(char const path[]) const {
+        return Value(path);
+    }
+    double getAsDouble(char const path[]) const {
+        return (double)Value(path);
+    }
+    ngs_adapt::StringItf *nextPath(char const path[]) const {
+        StatisticList::const_iterator const i = (path == 0 || path[0] == '\0')
+                                              ? values.begin()
+                                              : std::upper_bound(values.begin(), values.end(), Statistic(path, 0));
+        if (i == values.end())
+            return new ngs_adapt::StringItf(0, 0);
+        return new ngs_adapt::StringItf(i->path.data(), i->path.size());
+    }
+    bool getEntries(NGS_StatisticsEntry_v1 const *&list, uint64_t &count) const {
+        list = entries.empty() ? 0 : &entries[0];
+        count = entries.size();
+        return true;
+    }
+};
+
+// the read groups of the @RG header lines, in header order
+class ReadCollection::ReadGroup : public ngs_adapt::ReadGroupItf
+{
+    ReadCollection *parent;
+    unsigned cur;
+    unsigned const max;
+    int state;                      /* 0 before the first, 1 on one, 2 past the last, 3 just one */
+public:
+    ReadGroup(ReadCollection const *const Parent,
+              unsigned const current,
+              unsigned const readGroups,
+              int const initState)
+    : parent(static_cast<ReadCollection *>(Parent->Duplicate()))
+    , cur(current)
+    , max(readGroups)
+    , state(initState)
+    {}
+    
+    ~ReadGroup() {
+        parent->Release();
+    }
+    
+    ngs_adapt::StringItf *getName() const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+        
+        std::string const &ID = parent->file.getReadGroupName(cur);
+        
+        return new ngs_adapt::StringItf(ID.data(), ID.size());
+    }
+    /* getStatistics
+     *  the read group's aggregates; the primary records are its reads:
+     *  READ_COUNT, BASE_COUNT, ALIGNED_READ_COUNT, DUPLICATE_COUNT,
+     *  MIN_READ_LENGTH, MAX_READ_LENGTH and READ_LENGTH/<length>
+     */
+    ngs_adapt::StatisticsItf *getStatistics() const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+
+        StatisticList list;
+
+        parent->getStats("RG/" + parent->file.getReadGroupName(cur) + "/", list);
+        if (list.empty())
+            throw std::runtime_error("not available");
+        return new StatisticTable(list);
+    }
+    bool nextReadGroup() {
+        switch (state) {
+            case 0:
+                if (cur < max) {
+                    state = 1;
+                    return true;
+                }
+                state = 2;
+                return false;
+            case 1:
+                if (++cur < max)
+                    return true;
+                state = 2;
+            case 2:
+                return false;
+            default:
+                throw std::runtime_error("no more rows available");
+        }
+    }
+};
+
+/* OpenFasta
+ *  the reference bases come from "fastapath" or, if it is empty, from
+ *  <name>.fa, <name>.fasta or <name>.fa.gz next to <name>.bam, if there is one
+ *  a reference is only given bases by a sequence of its name and length
+ */
+void ReadCollection::OpenFasta(std::string const &fastapath)
+{
+    if (!fastapath.empty()) {
+        if (!fasta.Open(fastapath))
+            throw std::runtime_error("The FASTA file '" + fastapath + "' or its .fai index could not be opened");
+    }
+    else {
+        std::string const base = path.size() > 4 && path.compare(path.size() - 4, 4, ".bam") == 0
+                               ? path.substr(0, path.size() - 4) : path;
+        
+        if (!fasta.Open(base + ".fa") && !fasta.Open(base + ".fasta") && !fasta.Open(base + ".fa.gz"))
+            return;
+    }
+    
+    unsigned const N = file.countOfReferences();
+    
+    sequences.resize(N, -1);
+    for (unsigned i = 0; i < N; ++i) {
+        HeaderRefInfo const &ri = file.getRefInfo(i);
+        int const seq = fasta.Find(ri.getNameString());
+        
+        if (seq >= 0 && fasta.getLength(seq) == ri.getLength())
+            sequences[i] = seq;
+    }
+}
+
+/* AddLatency
+ *  the count, quantiles and most of a histogram, under "prefix"
+ */
+static void AddLatency(StatisticList &list, std::string const &prefix, LatencyHistogram const &histogram)
+{
+    LatencyHistogram::Summary const summary = histogram.Summarize();
+    
+    list.push_back(Statistic(prefix + "COUNT", summary.count));
+    list.push_back(Statistic(prefix + "P50", summary.p50));
+    list.push_back(Statistic(prefix + "P99", summary.p99));
+    list.push_back(Statistic(prefix + "P999", summary.p999));
+    list.push_back(Statistic(prefix + "MAX", summary.max));
+}
+
+/* getStatistics
+ *  the BGZF counters of the file as they are now, counted by every
+ *  collection sharing it; times are in
+ *  nanoseconds and include the time of every thread, so with threads
+ *  they may add up to more than has passed; then the windows slices
+ *  found in the region cache and those they read, under REGIONS/
+ *  followed by the aggregates, if there are any, under RG/<ID>/ and
+ *  REFERENCE/<name>/, by what the read iterators finished so far
+ *  held while pairing records, under READS/, the mapped records
+ *  of each reference by category, with OpenOptions::zoneMap, under
+ *  COUNTS/<name>/: PRIMARY, SECONDARY, SUPPLEMENTARY, DUPLICATE and
+ *  QC_FAIL, by what the file
+ *  holds now, as getMemoryUse has it, under MEMORY/, and how long
+ *  opening collections of the file, slicing it until the slice was
+ *  returned and until its first alignment, and inflating each block
+ *  have taken, in nanoseconds, under LATENCY/OPEN/, SLICE_OPEN/,
+ *  FIRST_RECORD/ and INFLATE/: COUNT, P50, P99, P999 and MAX
+ *  BGZF/ADAPTIVE/ has how reads are sized, see OpenOptions::
+ *  adaptiveReadahead: ENABLED, the average bytes read between seeks
+ *  and distance of a seek, and the bytes last read after a seek
+ *  and asked to be read ahead
+ */
+ngs_adapt::StatisticsItf *ReadCollection::getStatistics() const
+{
+    BGZFStats const &io = file.getIOStats();
+    StatisticList list;
+
+    getStats("", list);
+    list.push_back(Statistic("BGZF/BYTES_READ", BGZFStats::Get(io.bytesRead)));
+    list.push_back(Statistic("BGZF/COMPRESSED_BYTES", BGZFStats::Get(io.compressedBytes)));
+    list.push_back(Statistic("BGZF/INFLATED_BYTES", BGZFStats::Get(io.inflatedBytes)));
+    list.push_back(Statistic("BGZF/BLOCKS_INFLATED", BGZFStats::Get(io.blocksInflated)));
+    list.push_back(Statistic("BGZF/BLOCKS_SKIPPED", BGZFStats::Get(io.blocksSkipped)));
+    list.push_back(Statistic("BGZF/CACHE_HITS", BGZFStats::Get(io.cacheHits)));
+    list.push_back(Statistic("BGZF/SEEKS", BGZFStats::Get(io.seeks)));
+    list.push_back(Statistic("BGZF/REQUESTS", BGZFStats::Get(io.requests)));
+    list.push_back(Statistic("BGZF/READ_NANOS", BGZFStats::Get(io.readNanos)));
+    list.push_back(Statistic("BGZF/INFLATE_NANOS", BGZFStats::Get(io.inflateNanos)));
+    list.push_back(Statistic("BGZF/ADAPTIVE/ENABLED", file.isAdaptive() ? 1 : 0));
+    list.push_back(Statistic("BGZF/ADAPTIVE/RUN_AVERAGE", BGZFStats::Get(io.runAverage)));
+    list.push_back(Statistic("BGZF/ADAPTIVE/SEEK_AVERAGE", BGZFStats::Get(io.seekAverage)));
+    list.push_back(Statistic("BGZF/ADAPTIVE/FIRST_READ", BGZFStats::Get(io.firstRead)));
+    list.push_back(Statistic("BGZF/ADAPTIVE/READ_AHEAD", BGZFStats::Get(io.readAhead)));
+    list.push_back(Statistic("REGIONS/CACHE_HITS", file.getRegionCache().getHits()));
+    list.push_back(Statistic("REGIONS/CACHE_MISSES", file.getRegionCache().getMisses()));
+    list.push_back(Statistic("READS/MATE_BUFFER_LIMIT", mateBuffer));
+    list.push_back(Statistic("READS/MATE_BUFFER_PEAK", BGZFStats::Get(mateBufferPeak)));
+    list.push_back(Statistic("READS/MATE_BUFFER_EVICTIONS", BGZFStats::Get(mateBufferEvictions)));
+    
+    ZoneMap const &zones = file.getZones();
+    
+    for (unsigned i = 0; zones.hasCounts() && i < file.countOfReferences(); ++i) {
+        static char const *const names[] = { "PRIMARY", "SECONDARY", "SUPPLEMENTARY", "DUPLICATE", "QC_FAIL" };
+        std::string const prefix = "COUNTS/" + file.getRefInfo(i).getNameString() + "/";
+        
+        for (unsigned c = 0; c < ZoneMap::categories; ++c)
+            list.push_back(Statistic(prefix + names[c], zones.getCount(i, (ZoneMap::Category)c)));
+    }
+    
+    MemoryLedger const &memory = file.getMemory();
+    
+    for (unsigned i = 0; i < MemoryLedger::categories; ++i) {
+        MemoryLedger::Category const what = (MemoryLedger::Category)i;
+        list.push_back(Statistic(std::string("MEMORY/") + MemoryLedger::Name(what), memory.Get(what)));
+    }
+    list.push_back(Statistic("MEMORY/TOTAL", memory.Total()));
+    
+    FileLatencies &latency = file.getLatency();
+    
+    AddLatency(list, "LATENCY/OPEN/", latency.open);
+    AddLatency(list, "LATENCY/SLICE_OPEN/", latency.sliceOpen);
+    AddLatency(list, "LATENCY/FIRST_RECORD/", latency.firstRecord);
+    AddLatency(list, "LATENCY/INFLATE/", io.inflateLatency);
+    std::sort(list.begin(), list.end());
+
+    return new StatisticTable(list);
+}
+
+/* getReferenceTable
+ *  the names and lengths from the header, without a Reference per contig;
+ *  the header has no canonical names and doesn't say what is circular
+ */
+bool ReadCollection::getReferenceTable(NGS_ReferenceTable_v1 &table) const
+{
+    unsigned const N = file.countOfReferences();
+    bool const names = (table.fields & NGS_ReferenceTableFields_common_name) != 0;
+    uint64_t bytes = 0;
+    
+    for (unsigned i = 0; names && i < N; ++i)
+        bytes += file.getRefInfo(i).getNameLength();
+    if (bytes > UINT32_MAX)
+        throw std::runtime_error("reference names are too long for a reference table");
+    
+    table.count = N;
+    table.arena_used = (uint32_t)bytes;
+    table.filled = table.fields & (NGS_ReferenceTableFields_common_name | NGS_ReferenceTableFields_length);
+    if (N > table.capacity || bytes > table.arena_size)
+        return false;
+    
+    uint32_t offset = 0;
+    for (unsigned i = 0; i < N; ++i) {
+        HeaderRefInfo const &ri = file.getRefInfo(i);
+        
+        if (names) {
+            uint32_t const size = (uint32_t)ri.getNameLength();
+            
+            table.common_name[i].offset = offset;
+            table.common_name[i].size = size;
+            memcpy(table.arena + offset, ri.getName(), size);
+            offset += size;
+        }
+        if ((table.fields & NGS_ReferenceTableFields_length) != 0)
+            table.length[i] = ri.getLength();
+    }
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::getReadGroup(BAMRecord const &rec, StringSlot &slot) const
+{
+    Need(NGS_BAM::OpenOptions::tags);
+    return getReadGroup(rec.findTag("RG"), slot);
+}
+
+ngs_adapt::StringItf *ReadCollection::getReadGroup(BAMRecord::OptionalField const *const rg, StringSlot &slot) const
+{
+    if (rg == 0 || rg->getValueType() != 'Z')
+        return NULL;
+    
+    int const i = file.getReadGroupIndex(rg);
+    if (i >= 0)
+        return slot.Set(file.getReadGroupName(i));
+    
+    // a read group the header doesn't list, as the record has it
+    return slot.Set(rg->getRawValue(), rg->getElementSize());
+}
+
+void ReadCollection::CountMateBuffer(uint64_t const peak, uint64_t const evictions) const
+{
+    uint64_t seen = __atomic_load_n(&mateBufferPeak, __ATOMIC_RELAXED);
+    
+    while (seen < peak && !__atomic_compare_exchange_n(&mateBufferPeak, &seen, peak, true,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    BGZFStats::Add(mateBufferEvictions, evictions);
+}
+
+ngs_adapt::StringItf *ReadCollection::getName() const
+{
+    size_t const sep = path.rfind('/');
+    
+    if (sep == path.npos)
+        return new ngs_adapt::StringItf(path.data(), path.size());
+    else {
+        char const *name = path.data() + sep + 1;
+        unsigned const len = path.size() - sep - 1;
+        return new ngs_adapt::StringItf(name, len);
+    }
+}
+
+ngs_adapt::ReadGroupItf *ReadCollection::getReadGroups() const
+{
+    return new ReadGroup(this, 0, file.countOfReadGroups(), 0);
+}
+
+bool ReadCollection::hasReadGroup(char const spec[]) const
+{
+    return file.getReadGroupIndexByName(spec) >= 0;
+}
+
+ngs_adapt::ReadGroupItf *ReadCollection::getReadGroup(char const spec[]) const
+{
+    int const i = file.getReadGroupIndexByName(spec);
+    
+    if (i < 0)
+        throw std::runtime_error(std::string("no read group named '") + spec + "'");
+    return new ReadGroup(this, i, 0, 3);
+}
+
+ngs_adapt::ReferenceItf *ReadCollection::getReferences() const
+{
+    return new Reference(this, 0, file.countOfReferences(), 0);
+}
+
+bool ReadCollection::hasReference(char const spec[]) const
+{
+    int const i = file.getReferenceIndexByName(spec);
+    return i >= 0;
+}
+
+ngs_adapt::ReferenceItf *ReadCollection::getReference(char const spec[]) const
+{
+    int const i = file.getReferenceIndexByName(spec);
+    
+    if (i < 0)
+        throw std::runtime_error(std::string("reference not found: ") + spec);
+    return new Reference(this, i, 0, 3);
+}
+
+ngs_adapt::AlignmentItf *ReadCollection::getAlignment(char const spec[]) const
+{
+    return AlignmentOne::Make(this, spec, -1);
+}
+
+ngs_adapt::AlignmentItf *ReadCollection::getAlignments(bool const want_primary,
+                                                       bool const want_secondary) const
+{
+    if (!want_secondary && !want_primary)
+        return new AlignmentNone();
+    return new Alignment(this, want_primary, want_secondary);
+}
+
+#define ROW_CHECKPOINT_INTERVAL (64u * 1024u)
+
+static char const scanSuffix[] = ".ngs-rows";
+
+/* LoadScan
+ *  load the results of a previous scan from the sidecar
+ *  layout after the sidecar header: a line with the interval,
+ *  the primary and secondary counts and the number of checkpoints,
+ *  then one line per checkpoint position, then a line with the
+ *  read counts
+ */
+bool ReadCollection::LoadScan() const
+{
+    Sidecar cached;
+    unsigned long long interval = 0, p = 0, s = 0, n = 0;
+    
+    if (!cached.OpenRead(path, scanSuffix) ||
+        fscanf(cached.get(), "%llu %llu %llu %llu", &interval, &p, &s, &n) != 4 ||
+        interval != ROW_CHECKPOINT_INTERVAL)
+    {
+        return false;
+    }
+    
+    BAMFilePosTypeList loaded;
+    loaded.reserve(n);
+    for (unsigned long long i = 0; i < n; ++i) {
+        unsigned long long pos;
+        
+        if (fscanf(cached.get(), "%llu", &pos) != 1)
+            return false;
+        loaded.push_back(BAMFilePosType(pos));
+    }
+    
+    unsigned long long reads[3];
+    
+    if (fscanf(cached.get(), "%llu %llu %llu", &reads[0], &reads[1], &reads[2]) != 3)
+        return false;
+    for (unsigned i = 0; i < 3; ++i)
+        readCounts[i] = reads[i];
+    primaryCount = p;
+    secondaryCount = s;
+    checkpoints.swap(loaded);
+    return true;
+}
+
+void ReadCollection::SaveScan() const
+{
+    Sidecar update;
+    
+    if (!update.OpenWrite(path, scanSuffix))
+        return;
+    
+    FILE *const fp = update.get();
+    
+    fprintf(fp, "%llu %llu %llu %llu\n",
+            (unsigned long long)ROW_CHECKPOINT_INTERVAL,
+            (unsigned long long)primaryCount,
+            (unsigned long long)secondaryCount,
+            (unsigned long long)checkpoints.size());
+    for (unsigned i = 0; i < checkpoints.size(); ++i)
+        fprintf(fp, "%llu\n", (unsigned long long)checkpoints[i].getValue());
+    fprintf(fp, "%llu %llu %llu\n", (unsigned long long)readCounts[0],
+            (unsigned long long)readCounts[1], (unsigned long long)readCounts[2]);
+    
+    update.Commit();
+}
+
+/* Scan
+ *  count primary and secondary alignments and reads and record the row
+ *  checkpoints with a full scan, done once and remembered in a sidecar next to the BAM file
+ *  called with scanLock held
+ */
+void ReadCollection::Scan() const
+{
+    if (haveScan)
+        return;
+    
+    if (!LoadScan()) {
+        if (file.isStream())
+            throw std::runtime_error("'" + path + "' is a stream, which can't be counted without reading it all");
+        
+        BAMFileCursor scan(file);
+        BAMRecordBuffer buffer;
+        uint64_t rows = 0;
+        
+        primaryCount = secondaryCount = 0;
+        readCounts[0] = readCounts[1] = readCounts[2] = 0;
+        checkpoints.clear();
+        for ( ; ; ) {
+            BAMFilePosType const pos = scan.Tell();
+            BAMRecord const *const rec = scan.Read(buffer, 0);
+            
+            if (!rec)
+                break;
+            
+            int const flag = rec->flag();
+            
+            // a read for each template, counted at its first segment
+            if ((flag & 0x0900) == 0 && ((flag & 0x0001) == 0 || (flag & 0x00C0) != 0x0080))
+                ++readCounts[ReadCountIndex(ReadCategory(flag))];
+            if ((flag & 0x0004) != 0)
+                continue;
+            if (rows++ % ROW_CHECKPOINT_INTERVAL == 0)
+                checkpoints.push_back(pos);
+            if ((flag & 0x0900) == 0)
+                ++primaryCount;
+            else
+                ++secondaryCount;
+        }
+        SaveScan();
+    }
+    haveScan = true;
+}
+
+void ReadCollection::getScanCounts(uint64_t &primary, uint64_t &secondary) const
+{
+    pthread_mutex_lock(&scanLock);
+    try {
+        Scan();
+        primary = primaryCount;
+        secondary = secondaryCount;
+    }
+    catch (...) {
+        pthread_mutex_unlock(&scanLock);
+        throw;
+    }
+    pthread_mutex_unlock(&scanLock);
+}
+
+bool ReadCollection::getCheckpoint(uint64_t const row, BAMFilePosType &pos, uint64_t &checkpointRow) const
+{
+    bool rslt = false;
+    
+    pthread_mutex_lock(&scanLock);
+    try {
+        Scan();
+        if (row >= 1 && row <= primaryCount + secondaryCount) {
+            uint64_t const i = (row - 1) / ROW_CHECKPOINT_INTERVAL;
+            
+            pos = checkpoints[i];
+            checkpointRow = i * ROW_CHECKPOINT_INTERVAL + 1;
+            rslt = true;
+        }
+    }
+    catch (...) {
+        pthread_mutex_unlock(&scanLock);
+        throw;
+    }
+    pthread_mutex_unlock(&scanLock);
+    return rslt;
+}
+
+/* FindReadName
+ *  the index is mapped from its sidecar, or built and saved there; what
+ *  it finds is checked against the records' names
+ */
+bool ReadCollection::FindReadName(char const name[], BAMFilePosType &pos) const
+{
+    if (!nameIndex || name == 0 || name[0] == '\0')
+        return false;
+    
+    std::vector<uint64_t> found;
+    
+    pthread_mutex_lock(&scanLock);
+    try {
+        if (!haveNames) {
+            if (!names.Map(path)) {
+                if (file.isStream())
+                    throw std::runtime_error("'" + path + "' is a stream, whose names can't be indexed without reading it all");
+                names.Build(file);
+                names.Save(path);
+            }
+            haveNames = true;
+        }
+        names.Find(name, strlen(name), found);
+    }
+    catch (...) {
+        pthread_mutex_unlock(&scanLock);
+        throw;
+    }
+    pthread_mutex_unlock(&scanLock);
+    
+    size_t const length = strlen(name);
+    BAMRecordBuffer buffer;
+    
+    for (std::vector<uint64_t>::const_iterator i = found.begin(); i != found.end(); ++i) {
+        BAMFileCursor cursor(file, BAMFilePosType(*i));
+        BAMRecord const *const rec = cursor.Read(buffer, NGS_BAM::OpenOptions::readName);
+        
+        if (rec && strnlen(rec->readname(), rec->l_read_name()) == length &&
+            memcmp(rec->readname(), name, length) == 0)
+        {
+            pos = BAMFilePosType(*i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static char const statsSuffix[] = ".ngs-stats";
+
+/* LoadStats
+ *  load the aggregates of a previous scan from the sidecar
+ *  layout after the sidecar header: a line with the number of
+ *  statistics, then one line per statistic with its value and path,
+ *  in path order
+ */
+bool ReadCollection::LoadStats() const
+{
+    Sidecar cached;
+    unsigned long long n = 0;
+    
+    if (!cached.OpenRead(path, statsSuffix) ||
+        fscanf(cached.get(), "%llu", &n) != 1 || fgetc(cached.get()) != '\n')
+    {
+        return false;
+    }
+    
+    FILE *const fp = cached.get();
+    StatisticList loaded;
+    
+    loaded.reserve(n);
+    for (unsigned long long i = 0; i < n; ++i) {
+        unsigned long long value;
+        
+        if (fscanf(fp, "%llu", &value) != 1 || fgetc(fp) != ' ')
+            return false;
+        
+        std::string name;
+        int ch;
+        
+        while ((ch = fgetc(fp)) != '\n') {
+            if (ch == EOF)
+                return false;
+            name += (char)ch;
+        }
+        loaded.push_back(Statistic(name, value));
+    }
+    stats.swap(loaded);
+    return true;
+}
+
+void ReadCollection::SaveStats() const
+{
+    Sidecar update;
+    
+    if (!update.OpenWrite(path, statsSuffix))
+        return;
+    
+    FILE *const fp = update.get();
+    
+    fprintf(fp, "%llu\n", (unsigned long long)stats.size());
+    for (unsigned i = 0; i < stats.size(); ++i)
+        fprintf(fp, "%llu %s\n", (unsigned long long)stats[i].value, stats[i].path.c_str());
+    
+    update.Commit();
+}
+
+/* GroupCounts
+ *  what BuildStats adds up for a read group
+ */
+struct GroupCounts
+{
+    uint64_t reads;
+    uint64_t bases;
+    uint64_t aligned;
+    uint64_t duplicates;
+    std::map<unsigned, uint64_t> lengths;
+    
+    GroupCounts() : reads(0), bases(0), aligned(0), duplicates(0) {}
+};
+
+/* RefCounts
+ *  what BuildStats adds up for a reference
+ */
+struct RefCounts
+{
+    uint64_t alignments;
+    uint64_t bases;
+    
+    RefCounts() : alignments(0), bases(0) {}
+};
+
+static void AddStatistic(StatisticList &list, std::string const &prefix, char const name[], uint64_t const value)
+{
+    list.push_back(Statistic(prefix + name, value));
+}
+
+/* BuildStats
+ *  add up every record by its read group and by its reference
+ *  records with no RG tag, or one the header doesn't list, are
+ *  only counted for their reference
+ *  called with scanLock held
+ */
+void ReadCollection::BuildStats() const
+{
+    std::vector<GroupCounts> groups(file.countOfReadGroups());
+    std::vector<RefCounts> refs(file.countOfReferences());
+    BAMFileCursor scan(file);
+    BAMRecordBuffer buffer;
+    
+    for ( ; ; ) {
+        BAMRecord const *const rec = scan.Read(buffer, NGS_BAM::OpenOptions::tags);
+        
+        if (!rec)
+            break;
+        
+        int const flag = rec->flag();
+        unsigned const length = rec->l_seq();
+        
+        if ((flag & 0x0004) == 0 && rec->refID() >= 0 && (unsigned)rec->refID() < refs.size()) {
+            RefCounts &ref = refs[rec->refID()];
+            
+            ++ref.alignments;
+            ref.bases += length;
+        }
+        if ((flag & 0x0900) != 0)
+            continue;
+        
+        int const rg = file.getReadGroupIndex(*rec);
+        
+        if (rg < 0)
+            continue;
+        
+        GroupCounts &group = groups[rg];
+        
+        ++group.reads;
+        group.bases += length;
+        if ((flag & 0x0004) == 0)
+            ++group.aligned;
+        if ((flag & 0x0400) != 0)
+            ++group.duplicates;
+        ++group.lengths[length];
+    }
+    
+    StatisticList list;
+    
+    for (unsigned i = 0; i < groups.size(); ++i) {
+        GroupCounts const &group = groups[i];
+        std::string const prefix = "RG/" + file.getReadGroupName(i) + "/";
+        
+        AddStatistic(list, prefix, "READ_COUNT", group.reads);
+        AddStatistic(list, prefix, "BASE_COUNT", group.bases);
+        AddStatistic(list, prefix, "ALIGNED_READ_COUNT", group.aligned);
+        AddStatistic(list, prefix, "DUPLICATE_COUNT", group.duplicates);
+        AddStatistic(list, prefix, "MIN_READ_LENGTH", group.lengths.empty() ? 0 : group.lengths.begin()->first);
+        AddStatistic(list, prefix, "MAX_READ_LENGTH", group.lengths.empty() ? 0 : group.lengths.rbegin()->first);
+        for (std::map<unsigned, uint64_t>::const_iterator j = group.lengths.begin(); j != group.lengths.end(); ++j) {
+            char name[32];
+            
+            snprintf(name, sizeof(name), "READ_LENGTH/%u", j->first);
+            AddStatistic(list, prefix, name, j->second);
+        }
+    }
+    for (unsigned i = 0; i < refs.size(); ++i) {
+        std::string const prefix = "REFERENCE/" + file.getRefInfo(i).getNameString() + "/";
+        
+        AddStatistic(list, prefix, "ALIGNMENT_COUNT", refs[i].alignments);
+        AddStatistic(list, prefix, "BASE_COUNT", refs[i].bases);
+    }
+    std::sort(list.begin(), list.end());
+    stats.swap(list);
+}
+
+void ReadCollection::getStats(std::string const &prefix, StatisticList &rslt) const
+{
+    pthread_mutex_lock(&scanLock);
+    try {
+        if (!haveStats) {
+            if (!LoadStats() && buildStats && !file.isStream()) {
+                BuildStats();
+                SaveStats();
+            }
+            haveStats = true;
+        }
+        StatisticList::const_iterator i = std::lower_bound(stats.begin(), stats.end(), Statistic(prefix, 0));
+        
+        for ( ; i != stats.end() && i->path.compare(0, prefix.size(), prefix) == 0; ++i)
+            rslt.push_back(Statistic(i->path.substr(prefix.size()), i->value));
+    }
+    catch (...) {
+        pthread_mutex_unlock(&scanLock);
+        throw;
+    }
+    pthread_mutex_unlock(&scanLock);
+}
+
+uint64_t ReadCollection::getAlignmentCount(bool const want_primary,
+                                           bool const want_secondary) const
+{
+    if (!want_primary && !want_secondary)
+        return 0;
+    
+    ZoneMap const &zones = file.getZones();
+    
+    if (zones.hasCounts()) {
+        unsigned const N = file.countOfReferences();
+        uint64_t total = 0;
+        
+        for (unsigned i = 0; i < N; ++i) {
+            if (want_primary)
+                total += zones.getCount(i, ZoneMap::primary);
+            if (want_secondary)
+                total += zones.getCount(i, ZoneMap::secondary) + zones.getCount(i, ZoneMap::supplementary);
+        }
+        return total;
+    }
+    if (want_primary && want_secondary) {
+        // the index pseudo-bins count every mapped record
+        unsigned const N = file.countOfReferences();
+        uint64_t total = 0;
+        unsigned i;
+        
+        for (i = 0; i < N; ++i) {
+            uint64_t mapped, unmapped;
+            
+            if (!file.getRefInfo(i).getIndexCounts(mapped, unmapped))
+                break;
+            total += mapped;
+        }
+        if (i == N)
+            return total;
+    }
+    
+    uint64_t primary, secondary;
+    getScanCounts(primary, secondary);
+    
+    return (want_primary ? primary : 0) + (want_secondary ? secondary : 0);
+}
+
+ngs_adapt::AlignmentItf *ReadCollection::getAlignmentRange(uint64_t const first,
+                                                           uint64_t const count,
+                                                           bool const want_primary,
+                                                           bool const want_secondary ) const
+{
+    BAMFilePosType pos;
+    uint64_t checkpointRow;
+    uint64_t const First = first < 1 ? 1 : first;
+    
+    if ((!want_primary && !want_secondary) || count == 0 || !getCheckpoint(First, pos, checkpointRow))
+        return new AlignmentNone();
+    
+    return new AlignmentRange(this, want_primary, want_secondary, pos, checkpointRow, First, count);
+}
+
+ngs_adapt::AlignmentItf *ReadCollection::getAlignmentShard(uint32_t const shard,
+                                                           uint32_t const count,
+                                                           bool const want_primary,
+                                                           bool const want_secondary ) const
+{
+    if (shard >= count)
+        throw std::runtime_error("shard is out of range");
+    if (!want_primary && !want_secondary)
+        return new AlignmentNone();
+    
+    BAMFileChunk bounds;
+    
+    if (getShard(-1, shard, count, bounds)) {
+        if (!(bounds.beg < bounds.end))
+            return new AlignmentNone();
+        return new AlignmentShard(this, want_primary, want_secondary, bounds, -1);
+    }
+    
+    // without an index, split the rows evenly
+    uint64_t const total = getAlignmentCount(true, true);
+    uint64_t const beg = total / count * shard + total % count * shard / count;
+    uint64_t const end = total / count * (shard + 1) + total % count * (shard + 1) / count;
+    
+    return getAlignmentRange(beg + 1, end - beg, want_primary, want_secondary);
+}
+
+/* getReadCount
+ *  templates are counted by their first segments, so a last segment
+ *  whose mate isn't in the file, which reads return on its own, isn't
+ *  counted, nor are the reads a full mate buffer splits off
+ */
+uint64_t ReadCollection::getReadCount(bool const want_full,
+                                      bool const want_partial,
+                                      bool const want_unaligned) const
+{
+    uint64_t counts[3];
+    
+    pthread_mutex_lock(&scanLock);
+    try {
+        Scan();
+        for (unsigned i = 0; i < 3; ++i)
+            counts[i] = readCounts[i];
+    }
+    catch (...) {
+        pthread_mutex_unlock(&scanLock);
+        throw;
+    }
+    pthread_mutex_unlock(&scanLock);
+    
+    return (want_full ? counts[0] : 0) + (want_partial ? counts[1] : 0) + (want_unaligned ? counts[2] : 0);
+}
+
+static uint32_t ReadCategories(bool const want_full, bool const want_partial, bool const want_unaligned)
+{
+    return (want_full ? ngs::Read::fullyAligned : 0)
+         | (want_partial ? ngs::Read::partiallyAligned : 0)
+         | (want_unaligned ? ngs::Read::unaligned : 0);
+}
+
+ngs_adapt::ReadItf *ReadCollection::getRead(char const spec[]) const
+{
+    return Read::Make(this, spec);
+}
+
+ngs_adapt::ReadItf *ReadCollection::getReads(bool const want_full,
+                                             bool const want_partial,
+                                             bool const want_unaligned) const
+{
+    return new Read(this, 1, UINT64_MAX, ReadCategories(want_full, want_partial, want_unaligned));
+}
+
+/* getReadRange
+ *  reads are only numbered as they are paired, so the rows before
+ *  "first" are read and paired too
+ */
+ngs_adapt::ReadItf *ReadCollection::getReadRange(uint64_t const first,
+                                                 uint64_t const count,
+                                                 bool const want_full,
+                                                 bool const want_partial,
+                                                 bool const want_unaligned) const
+{
+    return new Read(this, first, count, ReadCategories(want_full, want_partial, want_unaligned));
+}
+
+/* the record at "pos" and its mate, which is looked for
+ * first in the next primary record and then through the index */
+ReadCollection::Read::Read(ReadCollection const *Parent, BAMFilePosType const pos, char const id[])
+: parent(static_cast<ReadCollection *>(Parent->Duplicate()))
+, reader(0)
+, segments(0)
+, fragment(0)
+, row(1)
+, first(1)
+, last(1)
+, categories(0)
+{
+    try {
+        BAMFileCursor cursor(parent->file, pos);
+        unsigned const fields = parent->getFields() | NGS_BAM::OpenOptions::readName;
+        BAMRecord const *const rec = cursor.Read(seg[0].buffer, fields);
+        
+        if (!rec || !cursor.isGoodRecord(*rec) || (rec->flag() & 0x0900) != 0)
+            throw NotFound(id);
+        seg[0].pos = pos;
+        segments = 1;
+        
+        int const flag = rec->flag();
+        
+        if ((flag & 0x0001) != 0 && (flag & 0x00C0) != 0 && (flag & 0x00C0) != 0x00C0) {
+            BAMMateRequestList request(1, BAMMateRequest(*rec));
+            
+            for ( ; ; ) {
+                seg[1].pos = cursor.Tell();
+                
+                BAMRecord const *const next = cursor.Read(seg[1].buffer, fields);
+                
+                if (!next || (next->flag() & 0x0900) == 0) {
+                    request[0].found = next && request[0].isMate(*next);
+                    break;
+                }
+            }
+            if (!request[0].found) {
+                parent->file.FindMates(request);
+                if (request[0].found) {
+                    seg[1].pos = request[0].mate;
+                    cursor.Seek(seg[1].pos);
+                    cursor.Read(seg[1].buffer, fields);
+                }
+            }
+            if (request[0].found) {
+                segments = 2;
+                if ((flag & 0x0080) != 0) {
+                    seg[0].buffer.Swap(seg[1].buffer);
+                    std::swap(seg[0].pos, seg[1].pos);
+                }
+            }
+        }
+    }
+    catch (...) {
+        parent->Release();
+        throw;
+    }
+}
+
+bool ReadCollection::Read::nextRead()
+{
+    fragment = 0;
+    if (!reader) {
+        // a single read is current until it is moved off
+        segments = 0;
+        return false;
+    }
+    while (row + 1 < last) {
+        segments = reader->Next(seg);
+        if (segments == 0)
+            break;
+        ++row;
+        if (row >= first && (Category() & categories) != 0)
+            return true;
+    }
+    segments = 0;
+    return false;
+}
+
+ngs_adapt::StringItf *ReadCollection::Read::getCursor() const
+{
+    if (!reader)
+        throw std::runtime_error("a single read has no cursor");
+    
+    std::vector<BAMFilePosType> held;
+    BAMFilePosType next;
+    
+    reader->Checkpoint(held, next);
+    cursorBuffer = "R1";
+    AppendCursorField(cursorBuffer, row);
+    AppendCursorField(cursorBuffer, next.getValue());
+    // each held record after the one before it, as they are in file order
+    for (size_t i = 0; i < held.size(); ++i)
+        AppendCursorField(cursorBuffer, held[i].getValue() - (i > 0 ? held[i - 1].getValue() : 0));
+    return cursorString.Set(cursorBuffer);
+}
+
+void ReadCollection::Read::resumeFrom(char const cursor[])
+{
+    if (!reader)
+        throw std::runtime_error("a single read has no cursor");
+    
+    std::vector<uint64_t> const values = ParseCursor("R1", cursor, 2);
+    std::vector<BAMFilePosType> held;
+    uint64_t pos = 0;
+    
+    for (size_t i = 2; i < values.size(); ++i) {
+        pos += values[i];
+        held.push_back(BAMFilePosType(pos));
+    }
+    reader->Resume(held, BAMFilePosType(values[1]));
+    row = values[0];
+    segments = 0;
+    fragment = 0;
+}
+
+ngs_adapt::StringItf *ReadCollection::Read::getReadId() const
+{
+    FormatAlignmentId(getReadRowId(), idBuffer);
+    return readIdString.Set(idBuffer);
+}
+
+ngs_adapt::StringItf *ReadCollection::Read::getReadName() const
+{
+    BAMRecord const &rec = Current();
+    char const *const QNAME = rec.readname();
+    
+    return readNameString.Set(QNAME, strnlen(QNAME, rec.l_read_name()));
+}
+
+/* AppendBases
+ *  the bases of a record as sequenced
+ */
+void ReadCollection::Read::AppendBases(BAMRecord const &rec, std::string &dst)
+{
+    size_t const at = dst.size();
+    unsigned const n = rec.l_seq();
+    
+    dst.resize(at + n);
+    if (n == 0)
+        return;
+    if ((rec.flag() & 0x0010) != 0)
+        rec.decodeSeqReverse(&dst[at], 0, n);
+    else
+        rec.decodeSeq(&dst[at], 0, n);
+}
+
+/* AppendQualities
+ *  the qualities of a record as sequenced, phred+33
+ *  returns false if the record has none
+ */
+bool ReadCollection::Read::AppendQualities(BAMRecord const &rec, std::string &dst)
+{
+    size_t const at = dst.size();
+    unsigned const n = rec.l_seq();
+    
+    dst.resize(at + n);
+    bool const notFF = n != 0 && ((rec.flag() & 0x0010) != 0 ? rec.decodeQualReverse(&dst[at], 0, n, true, 63)
+                                                              : rec.decodeQual(&dst[at], 0, n, true, 63));
+    if (!notFF) {
+        dst.resize(at);
+        return n == 0;
+    }
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::Read::getReadBases(uint64_t const offset, uint64_t const length) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    Current();
+    seqBuffer.clear();
+    for (unsigned i = 0; i < segments; ++i)
+        AppendBases(*seg[i].record(), seqBuffer);
+    return Slice(seqBuffer, offset, length, basesString);
+}
+
+// empty if any fragment has no qualities
+ngs_adapt::StringItf *ReadCollection::Read::getReadQualities(uint64_t const offset, uint64_t const length) const
+{
+    parent->Need(NGS_BAM::OpenOptions::qualities);
+    Current();
+    qualBuffer.clear();
+    for (unsigned i = 0; i < segments; ++i) {
+        if (!AppendQualities(*seg[i].record(), qualBuffer)) {
+            qualBuffer.clear();
+            break;
+        }
+    }
+    return Slice(qualBuffer, offset, length, qualitiesString);
+}
+
+ngs_adapt::StringItf *ReadCollection::Read::getFragmentBases(uint64_t const offset, uint64_t const length) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    seqBuffer.clear();
+    AppendBases(*Fragment().record(), seqBuffer);
+    return Slice(seqBuffer, offset, length, basesString);
+}
+
+ngs_adapt::StringItf *ReadCollection::Read::getFragmentQualities(uint64_t const offset, uint64_t const length) const
+{
+    parent->Need(NGS_BAM::OpenOptions::qualities);
+    qualBuffer.clear();
+    AppendQualities(*Fragment().record(), qualBuffer);
+    return Slice(qualBuffer, offset, length, qualitiesString);
+}
+
+/* getFragmentBasesPacked
+ *  SEQ itself, unless the record is reversed; its bases as sequenced
+ *  are then left to the caller to pack
+ */
+bool ReadCollection::Read::getFragmentBasesPacked(uint64_t const Offset, uint64_t const Length, NGS_FragmentPackedBases_v1 &packed) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    
+    BAMRecord const &rec = *Fragment().record();
+    if ((rec.flag() & 0x0010) != 0)
+        return false;
+    
+    unsigned const seqLen = rec.l_seq();
+    unsigned const offset = Offset < seqLen ? Offset : seqLen;
+    
+    packed.bases = rec.seq() + (offset >> 1);
+    packed.count = Length < seqLen - offset ? Length : seqLen - offset;
+    packed.phase = offset & 1;
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getFragmentBases(uint64_t const Offset, uint64_t const Length) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    
+    uint64_t const End = Offset + Length;
+    unsigned const seqLen = current->l_seq();
+    unsigned const offset = Offset < seqLen ? Offset : seqLen;
+    unsigned const seqEnd = End < seqLen ? End : seqLen;
+    
+    seqBuffer.resize(seqEnd - offset);
+    if (offset < seqEnd)
+        current->decodeSeq(&seqBuffer[0], offset, seqEnd - offset);
+    
+    return basesString.Set(seqBuffer);
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getFragmentQualities(uint64_t const Offset, uint64_t const Length) const
+{
+    parent->Need(NGS_BAM::OpenOptions::qualities);
+    
+    uint64_t const End = Offset + Length;
+    unsigned const seqLen = current->l_seq();
+    unsigned const offset = Offset < seqLen ? Offset : seqLen;
+    unsigned const seqEnd = End < seqLen ? End : seqLen;
+    
+    qualBuffer.resize(seqEnd - offset);
+    bool const notFF = offset < seqEnd && current->decodeQual(&qualBuffer[0], offset, seqEnd - offset, true, 63);
+    return qualitiesString.Set(qualBuffer.data(), notFF ? qualBuffer.size() : 0);
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getFragmentBasesView(uint64_t const Offset, uint64_t const Length, NGS_StringView_v1 &view) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    
+    uint64_t const End = Offset + Length;
+    unsigned const seqLen = current->l_seq();
+    unsigned const offset = Offset < seqLen ? Offset : seqLen;
+    unsigned const seqEnd = End < seqLen ? End : seqLen;
+    
+    seqView.resize(seqEnd - offset);
+    if (offset < seqEnd)
+        current->decodeSeq(&seqView[0], offset, seqEnd - offset);
+    
+    view.data = seqView.data();
+    view.size = seqView.size();
+    return NULL;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getFragmentQualitiesView(uint64_t const Offset, uint64_t const Length, NGS_StringView_v1 &view) const
+{
+    parent->Need(NGS_BAM::OpenOptions::qualities);
+    
+    uint64_t const End = Offset + Length;
+    unsigned const seqLen = current->l_seq();
+    unsigned const offset = Offset < seqLen ? Offset : seqLen;
+    unsigned const seqEnd = End < seqLen ? End : seqLen;
+    
+    qualView.resize(seqEnd - offset);
+    bool const notFF = offset < seqEnd && current->decodeQual(&qualView[0], offset, seqEnd - offset, true, 63);
+    view.data = qualView.data();
+    view.size = notFF ? qualView.size() : 0;
+    return NULL;
+}
+
+/* getFragmentBasesPacked
+ *  SEQ itself, which packs the bases as the interface does
+ */
+bool ReadCollection::Alignment::getFragmentBasesPacked(uint64_t const Offset, uint64_t const Length, NGS_FragmentPackedBases_v1 &packed) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    
+    unsigned const seqLen = current->l_seq();
+    unsigned const offset = Offset < seqLen ? Offset : seqLen;
+    
+    packed.bases = current->seq() + (offset >> 1);
+    packed.count = Length < seqLen - offset ? Length : seqLen - offset;
+    packed.phase = offset & 1;
+    return true;
+}
+
+void ReadCollection::Alignment::getClippedBases(bool const readOrientation, std::string &dst) const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    
+    BAMRecordSpan const &span = buffer.span();
+    unsigned const seqLen = current->l_seq();
+    unsigned const left = span.softClip[0] < seqLen ? span.softClip[0] : seqLen;
+    unsigned const right = span.softClip[1] < seqLen - left ? span.softClip[1] : seqLen - left;
+    unsigned const n = seqLen - left - right;
+    
+    dst.resize(n);
+    if (n == 0)
+        return;
+    if (readOrientation && (current->flag() & 0x0010) != 0)
+        current->decodeSeqReverse(&dst[0], left, n);
+    else
+        current->decodeSeq(&dst[0], left, n);
+}
+
+bool ReadCollection::Alignment::getClippedQualities(bool const readOrientation, std::string &dst) const
+{
+    parent->Need(NGS_BAM::OpenOptions::qualities);
+    
+    BAMRecordSpan const &span = buffer.span();
+    unsigned const seqLen = current->l_seq();
+    unsigned const left = span.softClip[0] < seqLen ? span.softClip[0] : seqLen;
+    unsigned const right = span.softClip[1] < seqLen - left ? span.softClip[1] : seqLen - left;
+    unsigned const n = seqLen - left - right;
+    
+    dst.resize(n);
+    bool const notFF = n != 0 && (readOrientation && (current->flag() & 0x0010) != 0
+                                  ? current->decodeQualReverse(&dst[0], left, n, true, 63)
+                                  : current->decodeQual(&dst[0], left, n, true, 63));
+    if (!notFF) {
+        dst.clear();
+        return n == 0;
+    }
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getClippedFragmentBases() const
+{
+    getClippedBases(false, clippedSeqBuffer);
+    return clippedBasesString.Set(clippedSeqBuffer);
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getClippedFragmentQualities() const
+{
+    getClippedQualities(false, clippedQualBuffer);
+    return clippedQualitiesString.Set(clippedQualBuffer);
+}
+
+// all of SEQ, soft clips included
+ngs_adapt::StringItf *ReadCollection::Alignment::getAlignedFragmentBases() const
+{
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    
+    unsigned const seqLen = current->l_seq();
+    
+    alignedSeqBuffer.resize(seqLen);
+    if (seqLen != 0)
+        current->decodeSeq(&alignedSeqBuffer[0], 0, seqLen);
+    return alignedBasesString.Set(alignedSeqBuffer);
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getReferenceSpecView(NGS_StringView_v1 &view) const
+{
+    HeaderRefInfo const &ri = parent->getRefInfo(current->refID());
+    view.data = ri.getName();
+    view.size = ri.getNameLength();
+    return NULL;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getReadIdView(NGS_StringView_v1 &view) const
+{
+    parent->Need(NGS_BAM::OpenOptions::readName);
+    view.data = current->readname();
+    view.size = strnlen(view.data, current->l_read_name());
+    return NULL;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getReferenceSpec() const
+{
+    int const refID = current->refID();
+    HeaderRefInfo const &ri = parent->getRefInfo(refID);
+    return referenceSpecString.Set(ri.getName(), ri.getNameLength());
+}
+
+int32_t ReadCollection::Alignment::getMappingQuality() const
+{
+    return current->mq();
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getReadGroup() const
+{
+    parent->Need(NGS_BAM::OpenOptions::tags);
+    return parent->getReadGroup(buffer.findTag("RG"), readGroupString);
+}
+
+bool ReadCollection::Alignment::getTag(char const tag[], NGS_AlignmentTag_v1 &value) const
+{
+    parent->Need(NGS_BAM::OpenOptions::tags);
+    
+    BAMRecord::OptionalField const *const field = buffer.findTag(tag);
+    if (field == 0)
+        return false;
+    
+    char const type = field->getValueType();
+    
+    value.data = field->getRawValue();
+    value.type = type;
+    value.is_array = field->isArray();
+    if (value.is_array)
+        value.count = field->getElementCount();
+    else if (type == 'Z' || type == 'H')
+        value.count = field->getElementSize();     /* its length */
+    else
+        value.count = 1;
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getAlignmentId() const
+{
+    FormatAlignmentId(currentPos, idBuffer);
+    return alignmentIdString.Set(idBuffer);
+}
+
+/* CompareBases
+ *  counts the bases of "read" unlike those of "ref", ignoring case, a
+ *  read's '=' being like any, and sets "mask", unless it is NULL, to 1
+ *  for each of them and 0 for the others
+ */
+static uint32_t CompareBasesPlain(char const *const read, char const *const ref, uint8_t *const mask, size_t const n)
+{
+    uint32_t count = 0;
+    
+    for (size_t i = 0; i < n; ++i) {
+        unsigned const a = (uint8_t)read[i] & 0xDF;
+        unsigned const differ = a != ((uint8_t)ref[i] & 0xDF) && a != ('=' & 0xDF);
+        
+        count += differ;
+        if (mask)
+            mask[i] = (uint8_t)differ;
+    }
+    return count;
+}
+
+#if CPU_DISPATCH
+CPU_TARGET("sse2")
+static uint32_t CompareBasesSSE2(char const *const read, char const *const ref, uint8_t *const mask, size_t const n)
+{
+    __m128i const upper = _mm_set1_epi8((char)0xDF);
+    __m128i const equals = _mm_set1_epi8('=' & 0xDF);
+    __m128i const one = _mm_set1_epi8(1);
+    uint32_t count = 0;
+    size_t i = 0;
+    
+    for ( ; i + 16 <= n; i += 16) {
+        __m128i const a = _mm_and_si128(_mm_loadu_si128((__m128i const *)(read + i)), upper);
+        __m128i const b = _mm_and_si128(_mm_loadu_si128((__m128i const *)(ref + i)), upper);
+        __m128i const same = _mm_or_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(a, equals));
+        
+        count += __builtin_popcount(~_mm_movemask_epi8(same) & 0xFFFF);
+        if (mask)
+            _mm_storeu_si128((__m128i *)(mask + i), _mm_andnot_si128(same, one));
+    }
+    return count + CompareBasesPlain(read + i, ref + i, mask ? mask + i : 0, n - i);
+}
+
+CPU_TARGET("avx2")
+static uint32_t CompareBasesAVX2(char const *const read, char const *const ref, uint8_t *const mask, size_t const n)
+{
+    __m256i const upper = _mm256_set1_epi8((char)0xDF);
+    __m256i const equals = _mm256_set1_epi8('=' & 0xDF);
+    __m256i const one = _mm256_set1_epi8(1);
+    uint32_t count = 0;
+    size_t i = 0;
+    
+    for ( ; i + 32 <= n; i += 32) {
+        __m256i const a = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)(read + i)), upper);
+        __m256i const b = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)(ref + i)), upper);
+        __m256i const same = _mm256_or_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(a, equals));
+        
+        count += __builtin_popcount(~(unsigned)_mm256_movemask_epi8(same));
+        if (mask)
+            _mm256_storeu_si256((__m256i *)(mask + i), _mm256_andnot_si256(same, one));
+    }
+    return count + CompareBasesPlain(read + i, ref + i, mask ? mask + i : 0, n - i);
+}
+#endif
+
+/* the one in use, picked at load by compareBasesKernel */
+static uint32_t (*CompareBases)(char const *, char const *, uint8_t *, size_t) = CompareBasesPlain;
+
+static struct CompareBasesKernel {
+    CompareBasesKernel() {
+#if CPU_DISPATCH
+        CPU::Level const level = CPU::Best();
+        
+        if (level >= CPU::sse2)
+            CompareBases = CompareBasesSSE2;
+        if (level >= CPU::avx2)
+            CompareBases = CompareBasesAVX2;
+#endif
+    }
+} const compareBasesKernel;
+
+/* MismatchesFromMD
+ *  the aligned bases that an MD field, e.g. "10A5^AC6", gives as unlike
+ *  the reference, as offsets among those of the M, = and X operations
+ *  into "offsets"; returns false if it doesn't cover "aligned" of them
+ */
+static bool MismatchesFromMD(char const *const md, size_t const size, uint32_t const aligned, std::vector<uint32_t> &offsets)
+{
+    uint64_t at = 0;
+    size_t i = 0;
+    
+    offsets.clear();
+    while (i < size) {
+        char const ch = md[i];
+        if (ch >= '0' && ch <= '9') {
+            uint64_t run = 0;
+            for ( ; i < size && md[i] >= '0' && md[i] <= '9'; ++i)
+                run = run * 10 + (md[i] - '0');
+            at += run;
+        }
+        else if (ch == '^') {
+            for (++i; i < size && isalpha((unsigned char)md[i]); ++i)
+                ;
+        }
+        else if (isalpha((unsigned char)ch) && at < aligned) {
+            offsets.push_back((uint32_t)at++);
+            ++i;
+        }
+        else
+            return false;
+        if (at > aligned)
+            return false;
+    }
+    return at == aligned;
+}
+
+bool ReadCollection::Alignment::getMismatches(NGS_AlignmentMismatches_v1 &mismatches) const
+{
+    unsigned const nc = current->nc();
+    uint32_t bases = 0;
+    uint32_t aligned = 0;
+    uint32_t indels = 0;
+    uint32_t lead = 0;
+    
+    for (unsigned i = 0; i < nc; ++i) {
+        uint32_t const op = current->cigar(i);
+        uint32_t const len = op >> 4;
+        switch (op & 15) {
+        case 0: case 7: case 8:     /* M = X */
+            aligned += len;
+            bases += len;
+            break;
+        case 1:                     /* I */
+            indels += len;
+            bases += len;
+            break;
+        case 2:                     /* D */
+            indels += len;
+            break;
+        case 4:                     /* S */
+            if (bases == 0)
+                lead += len;
+            break;
+        }
+    }
+    mismatches.bases = bases;
+    mismatches.count = 0;
+    
+    bool const fill = mismatches.mask != 0 && bases <= mismatches.mask_size;
+    uint8_t *const mask = fill ? mismatches.mask : 0;
+    if (fill && bases != 0)
+        memset(mask, 0, bases);
+    
+    // the aligner's fields, as NM = X + I + D
+    if ((parent->getFields() & NGS_BAM::OpenOptions::tags) != 0) {
+        BAMRecord::OptionalField const *const nm = fill ? 0 : buffer.findTag("NM");
+        int64_t value;
+        if (nm != 0 && nm->getInt(value) && value >= indels) {
+            mismatches.count = (uint32_t)(value - indels);
+            return true;
+        }
+        BAMRecord::OptionalField const *const md = buffer.findTag("MD");
+        if (md != 0 && md->getValueType() == 'Z'
+            && MismatchesFromMD(md->getRawValue(), md->getElementSize(), aligned, mismatchOffsets))
+        {
+            mismatches.count = (uint32_t)mismatchOffsets.size();
+            if (!fill)
+                return true;
+            
+            // each offset among the aligned bases to one among the clipped
+            std::vector<uint32_t>::const_iterator next = mismatchOffsets.begin();
+            uint32_t at = 0;
+            uint32_t q = 0;
+            for (unsigned i = 0; i < nc && next != mismatchOffsets.end(); ++i) {
+                uint32_t const op = current->cigar(i);
+                uint32_t const len = op >> 4;
+                switch (op & 15) {
+                case 0: case 7: case 8:
+                    for ( ; next != mismatchOffsets.end() && *next < at + len; ++next)
+                        mask[q + *next - at] = 1;
+                    at += len;
+                    q += len;
+                    break;
+                case 1:
+                    q += len;
+                    break;
+                }
+            }
+            return true;
+        }
+    }
+    
+    // or the bases themselves
+    int const seq = parent->getSequence(current->refID());
+    if (seq < 0)
+        return false;
+    parent->Need(NGS_BAM::OpenOptions::bases);
+    if (current->l_seq() < lead + bases)
+        return false;
+    
+    mismatchSeqBuffer.resize(bases);
+    if (bases != 0)
+        current->decodeSeq(&mismatchSeqBuffer[0], lead, bases);
+    parent->getFasta().Copy(seq, current->pos(), getAlignmentLength(), mismatchRefBuffer);
+    
+    char const *const read = mismatchSeqBuffer.data();
+    char const *const ref = mismatchRefBuffer.data();
+    size_t const refSize = mismatchRefBuffer.size();
+    uint32_t count = 0;
+    uint32_t q = 0;
+    size_t r = 0;
+    for (unsigned i = 0; i < nc; ++i) {
+        uint32_t const op = current->cigar(i);
+        uint32_t const len = op >> 4;
+        switch (op & 15) {
+        case 0: {                   /* M, as far as the reference goes */
+            size_t const n = r < refSize ? (len < refSize - r ? len : refSize - r) : 0;
+            count += CompareBases(read + q, ref + r, mask ? mask + q : 0, n);
+            q += len;
+            r += len;
+            break;
+        }
+        case 8:                     /* X */
+            count += len;
+            if (mask)
+                memset(mask + q, 1, len);
+            q += len;
+            r += len;
+            break;
+        case 7:                     /* = */
+            q += len;
+            r += len;
+            break;
+        case 1:
+            q += len;
+            break;
+        case 2: case 3:             /* D N */
+            r += len;
+            break;
+        }
+    }
+    mismatches.count = count;
+    return true;
+}
+
+// the reference under the aligned part of the record
+ngs_adapt::StringItf *ReadCollection::Alignment::getReferenceBases() const
+{
+    int const seq = parent->getSequence(current->refID());
+    
+    if (seq < 0)
+        throw std::runtime_error("not available");
+    
+    parent->getFasta().Copy(seq, current->pos(), getAlignmentLength(), refBasesBuffer);
+    return refBasesString.Set(refBasesBuffer);
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getReadId() const
+{
+    parent->Need(NGS_BAM::OpenOptions::readName);
+    char const *const QNAME = current->readname();
+    size_t const len = strnlen(QNAME, current->l_read_name());
+    return readIdString.Set(QNAME, len);
+}
+
+bool ReadCollection::Alignment::isPrimary() const
+{
+    return (current->flag() & 0x0900) == 0;
+}
+
+/* getFragmentIndex
+ *  1 for the last segment of a template, as the reads number them, else 0
+ */
+uint32_t ReadCollection::Alignment::getFragmentIndex() const
+{
+    return (current->flag() & 0x00C0) == 0x0080 ? 1 : 0;
+}
+
+int64_t ReadCollection::Alignment::getAlignmentPosition() const
+{
+    return current->pos();
+}
+
+uint64_t ReadCollection::Alignment::getAlignmentLength() const {
+    return buffer.span().refLen;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getCigar(bool const clipped, char const OPCODE[]) const
+{
+    current->cigarString(cigarBuffer, clipped, OPCODE);
+    return cigarString.Set(cigarBuffer);
+}
+
+bool ReadCollection::Alignment::getCigarOps(NGS_AlignmentCigar_v1 &cigar) const
+{
+    unsigned const n = current->nc();
+    uint32_t const *ops = current->cigarOps();
+    
+    if (ops == 0 && n != 0) {
+        cigarOpsBuffer.resize(n);
+        for (unsigned i = 0; i < n; ++i)
+            cigarOpsBuffer[i] = current->cigar(i);
+        ops = &cigarOpsBuffer[0];
+    }
+    cigar.ops = ops;
+    cigar.count = n;
+    return true;
+}
+
+bool ReadCollection::Alignment::getReadFragment(NGS_AlignmentReadFragment_v1 &fragment) const
+{
+    int const FLAG = current->flag();
+    unsigned const seqLen = current->l_seq();
+    BAMRecordSpan const &span = buffer.span();
+    
+    /* a secondary or supplementary record may hard clip what the primary has */
+    fragment.skipped = (FLAG & 0x0900) != 0 && (span.hardClip[0] != 0 || span.hardClip[1] != 0);
+    fragment.length = fragment.skipped ? 0 : seqLen;
+    fragment.has_quals = false;
+    if (fragment.length == 0 || fragment.length > fragment.size)
+        return true;
+    
+    bool const reverse = (FLAG & 0x0010) != 0;
+    if (fragment.bases != 0) {
+        parent->Need(NGS_BAM::OpenOptions::bases);
+        if (reverse)
+            current->decodeSeqReverse(fragment.bases, 0, seqLen);
+        else
+            current->decodeSeq(fragment.bases, 0, seqLen);
+    }
+    if (fragment.quals != 0) {
+        parent->Need(NGS_BAM::OpenOptions::qualities);
+        fragment.has_quals = reverse ? current->decodeQualReverse(fragment.quals, 0, seqLen, true, 63)
+                                     : current->decodeQual(fragment.quals, 0, seqLen, true, 63);
+    }
+    return true;
+}
+
+void ReadCollection::Alignment::getCore(NGS_AlignmentCore_v1 &core) const
+{
+    int const FLAG = current->flag();
+
+    core.position = current->pos();
+    core.length = buffer.span().refLen;
+    core.template_len = current->tlen();
+    core.map_qual = current->mq();
+    core.flags = ((FLAG & 0x0900) == 0 ? NGS_AlignmentBatchFlags_primary : 0)
+               | ((FLAG & 0x0010) != 0 ? NGS_AlignmentBatchFlags_reversed : 0)
+               | (hasMate() ? NGS_AlignmentBatchFlags_has_mate : 0);
+}
+
+int32_t ReadCollection::Alignment::getSoftClip(uint32_t const edge) const
+{
+    if (edge > 1)
+        throw std::runtime_error("invalid clip edge");
+    return buffer.span().softClip[edge];
+}
+
+bool ReadCollection::Alignment::getIsReversedOrientation() const
+{
+    return (current->flag() & 0x0010) != 0;
+}
+
+// TODO: return type should be int64_t
+uint64_t ReadCollection::Alignment::getTemplateLength() const
+{
+    return current->tlen();
+}
+
+bool ReadCollection::Alignment::hasMate() const
+{
+    int const FLAG = current->flag();
+
+    return (FLAG & 0x0001) != 0 && (FLAG & 0x00C0) != 0 && (FLAG & 0x00C0) != 0x00C0;
+}
+
+/* FindMate
+ *  the position of the mate, looked for around the mate position
+ *  with the index, since the record only has that and its name;
+ *  false if the file hasn't the mate's record, e.g. a filtered subset
+ */
+bool ReadCollection::Alignment::FindMate(BAMFilePosType &mate) const
+{
+    parent->Need(NGS_BAM::OpenOptions::readName);
+    if (!hasMate())
+        throw std::runtime_error("no mate");
+    
+    BAMMateRequestList request(1, BAMMateRequest(*current));
+    
+    parent->file.FindMates(request);
+    if (!request[0].found)
+        return false;
+    mate = request[0].mate;
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getMateAlignmentId() const
+{
+    BAMFilePosType mate;
+    
+    if (!FindMate(mate))
+        return 0;
+    FormatAlignmentId(mate, mateIdBuffer);
+    return mateAlignmentIdString.Set(mateIdBuffer);
+}
+
+ngs_adapt::AlignmentItf *ReadCollection::Alignment::getMateAlignment() const
+{
+    BAMFilePosType mate;
+    std::string id;
+    
+    if (!FindMate(mate))
+        throw std::runtime_error("the mate was not found");
+    FormatAlignmentId(mate, id);
+    return AlignmentOne::Make(parent, id.c_str(), -1);
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getMateReferenceSpec() const
+{
+    int const refID = current->next_refID();
+    
+    if (refID < 0)
+        return mateReferenceSpecString.Set("", 0);
+
+    HeaderRefInfo const &ri = parent->getRefInfo(refID);
+    return mateReferenceSpecString.Set(ri.getName(), ri.getNameLength());
+}
+
+// TODO: rename to isMateReversedOrientation
+bool ReadCollection::Alignment::getMateIsReversedOrientation() const
+{
+    return (current->flag() & 0x0020) != 0;
+}
+
+uint32_t ReadCollection::Alignment::getSupportedMessages() const
+{
+    unsigned const fields = parent->getFields();
+    uint32_t rslt = NGS_AlignmentMessage_id
+                  | NGS_AlignmentMessage_ref_spec
+                  | NGS_AlignmentMessage_map_qual
+                  | NGS_AlignmentMessage_is_primary
+                  | NGS_AlignmentMessage_align_pos
+                  | NGS_AlignmentMessage_align_length
+                  | NGS_AlignmentMessage_is_reversed
+                  | NGS_AlignmentMessage_soft_clip
+                  | NGS_AlignmentMessage_template_len
+                  | NGS_AlignmentMessage_cigar
+                  | NGS_AlignmentMessage_has_mate
+                  | NGS_AlignmentMessage_mate_ref_spec
+                  | NGS_AlignmentMessage_mate_is_reversed;
+
+    if (fields & NGS_BAM::OpenOptions::readName)
+        rslt |= NGS_AlignmentMessage_read_id | NGS_AlignmentMessage_mate_id | NGS_AlignmentMessage_mate_alignment;
+    if (fields & NGS_BAM::OpenOptions::bases)
+        rslt |= NGS_AlignmentMessage_fragment_bases | NGS_AlignmentMessage_clipped_frag_bases
+              | NGS_AlignmentMessage_aligned_frag_bases;
+    if (fields & NGS_BAM::OpenOptions::qualities)
+        rslt |= NGS_AlignmentMessage_fragment_quals | NGS_AlignmentMessage_clipped_frag_quals;
+    if (fields & NGS_BAM::OpenOptions::tags)
+        rslt |= NGS_AlignmentMessage_read_group | NGS_AlignmentMessage_tags;
+    if (parent->getFasta().isOpen())
+        rslt |= NGS_AlignmentMessage_ref_bases;
+
+    return rslt;
+}
+
+bool ReadCollection::Alignment::nextAlignment()
+{
+    do {
+        current = ReadRecord();
+        if (!current)
+            return false;
+    } while (shouldSkip());
+    return true;
+}
+
+ngs_adapt::StringItf *ReadCollection::Alignment::getCursor() const
+{
+    BAMFilePosType next;
+    uint64_t extra;
+    
+    Checkpoint(next, extra);
+    cursorBuffer = "A1";
+    AppendCursorField(cursorBuffer, next.getValue());
+    AppendCursorField(cursorBuffer, extra);
+    return cursorString.Set(cursorBuffer);
+}
+
+void ReadCollection::Alignment::resumeFrom(char const cursor[])
+{
+    std::vector<uint64_t> const values = ParseCursor("A1", cursor, 2);
+    
+    current = 0;
+    Resume(BAMFilePosType(values[0]), values[1]);
+}
+
+static void BatchString(NGS_AlignmentBatch_v1 &batch, NGS_AlignmentBatchString_v1 *const column, char const *const data, unsigned const size)
+{
+    NGS_AlignmentBatchString_v1 &str = column[batch.count];
+    str.offset = batch.arena_used;
+    str.size = size;
+    if (data)
+        memcpy(batch.arena + batch.arena_used, data, size);
+    batch.arena_used += size;
+}
+
+// the columns come straight from the records, rather than through the messages
+bool ReadCollection::Alignment::nextAlignmentBatch(NGS_AlignmentBatch_v1 &batch)
+{
+    unsigned const fields = batch.fields;
+    
+    if ((fields & NGS_AlignmentBatchFields_read_id) != 0)
+        parent->Need(NGS_BAM::OpenOptions::readName);
+    if ((fields & NGS_AlignmentBatchFields_bases) != 0)
+        parent->Need(NGS_BAM::OpenOptions::bases);
+    if ((fields & NGS_AlignmentBatchFields_qualities) != 0)
+        parent->Need(NGS_BAM::OpenOptions::qualities);
+    
+    batch.count = 0;
+    batch.arena_used = 0;
+    if ((fields & NGS_AlignmentBatchFields_cigar) != 0)
+        batch.cigar_arena_used = 0;
+    while (batch.count < batch.capacity && batch.state != NGS_AlignmentBatchState_end) {
+        if (batch.state == NGS_AlignmentBatchState_next) {
+            if (!nextAlignment()) {
+                batch.state = NGS_AlignmentBatchState_end;
+                break;
+            }
+            batch.state = NGS_AlignmentBatchState_held;
+        }
+        HeaderRefInfo const *const refName = (fields & NGS_AlignmentBatchFields_ref_spec) != 0
+                                           ? &parent->getRefInfo(current->refID()) : 0;
+        unsigned const readIdLen = (fields & NGS_AlignmentBatchFields_read_id) != 0
+                                 ? strnlen(current->readname(), current->l_read_name()) : 0;
+        unsigned const seqLen = current->l_seq();
+        uint64_t const need = (refName ? refName->getNameLength() : 0) + readIdLen
+                            + ((fields & NGS_AlignmentBatchFields_bases) != 0 ? seqLen : 0)
+                            + ((fields & NGS_AlignmentBatchFields_qualities) != 0 ? seqLen : 0);
+        
+        // leave the record for the next batch if it doesn't fit in this one
+        if (need > batch.arena_size - batch.arena_used) {
+            if (batch.count == 0)
+                throw std::runtime_error("alignment batch arena is too small for the next alignment");
+            break;
+        }
+        unsigned const nc = (fields & NGS_AlignmentBatchFields_cigar) != 0 ? current->nc() : 0;
+        if (nc > batch.cigar_arena_size - batch.cigar_arena_used) {
+            if (batch.count == 0)
+                throw std::runtime_error("alignment batch CIGAR arena is too small for the next alignment");
+            break;
+        }
+        
+        unsigned const i = batch.count;
+        int const flag = current->flag();
+        
+        if ((fields & NGS_AlignmentBatchFields_ref_index) != 0)
+            batch.ref_index[i] = current->refID();
+        if ((fields & NGS_AlignmentBatchFields_cigar) != 0) {
+            uint32_t *const dst = batch.cigar_arena + batch.cigar_arena_used;
+            uint32_t const *const ops = current->cigarOps();
+            
+            if (ops)
+                memcpy(dst, ops, nc * sizeof(ops[0]));
+            else {
+                for (unsigned j = 0; j < nc; ++j)
+                    dst[j] = current->cigar(j);
+            }
+            batch.cigar[i].offset = batch.cigar_arena_used;
+            batch.cigar[i].size = nc;
+            batch.cigar_arena_used += nc;
+        }
+        
+        if ((fields & NGS_AlignmentBatchFields_position) != 0) {
+            batch.position[i] = current->pos();
+            batch.length[i] = buffer.span().refLen;
+        }
+        if ((fields & NGS_AlignmentBatchFields_map_qual) != 0)
+            batch.map_qual[i] = current->mq();
+        if ((fields & NGS_AlignmentBatchFields_flags) != 0) {
+            batch.flags[i] = ((flag & 0x0900) == 0 ? NGS_AlignmentBatchFlags_primary : 0)
+                           | ((flag & 0x0010) != 0 ? NGS_AlignmentBatchFlags_reversed : 0)
+                           | (hasMate() ? NGS_AlignmentBatchFlags_has_mate : 0);
+        }
+        if (refName)
+            BatchString(batch, batch.ref_spec, refName->getName(), refName->getNameLength());
+        if ((fields & NGS_AlignmentBatchFields_read_id) != 0)
+            BatchString(batch, batch.read_id, current->readname(), readIdLen);
+        if ((fields & NGS_AlignmentBatchFields_bases) != 0) {
+            char *const dst = batch.arena + batch.arena_used;
+            if (seqLen)
+                current->decodeSeq(dst, 0, seqLen);
+            BatchString(batch, batch.bases, 0, seqLen);
+        }
+        if ((fields & NGS_AlignmentBatchFields_qualities) != 0) {
+            char *const dst = batch.arena + batch.arena_used;
+            bool const notFF = seqLen && current->decodeQual(dst, 0, seqLen, true, 63);
+            BatchString(batch, batch.qualities, 0, notFF ? seqLen : 0);
+        }
+        ++batch.count;
+        batch.state = NGS_AlignmentBatchState_next;
+    }
+    return batch.count != 0;
+}
+
+/* MergedCollection
+ *  coordinate-sorted BAM files with the same references, as one collection
+ *  alignments come from an iterator of each file, merged by position;
+ *  an alignment ID is the index of its file, a '.' and its ID in the file
+ */
+class MergedCollection : public ngs_adapt::ReadCollectionItf
+{
+    friend class EngineAccess;      /* for the functions of NGS_BAM */
+
+    class Alignment;
+    class Reference;
+
+    /* every AlignmentItf of a ReadCollection is an AlignmentNone,
+     * and every ReferenceItf a Reference */
+    typedef ReadCollection::AlignmentNone PartAlignment;
+    typedef ReadCollection::Reference PartReference;
+    typedef std::vector<PartAlignment *> PartAlignments;
+    typedef std::vector<PartReference *> PartReferences;
+
+    std::vector<ReadCollection *> parts;
+    std::string name;
+
+    void PartsMatch() const;
+    static void ReleaseParts(PartAlignments const &its);
+    static void ReleaseParts(PartReferences const &refs);
+public:
+    MergedCollection(std::vector<std::string> const &paths, NGS_BAM::OpenOptions const &options);
+    ~MergedCollection();
+
+    /* ParseId
+     *  split a merged alignment ID into its file and the ID in that file
+     */
+    bool ParseId(char const id[], unsigned &part, char const *&rest) const;
+
+    ngs_adapt::StringItf *getName() const {
+        return new ngs_adapt::StringItf(name.data(), name.size());
+    }
+    /* getFile
+     *  the first file; they all have the same references
+     */
+    BAMFile const &getFile() const {
+        return parts[0]->file;
+    }
+    ngs_adapt::ReadGroupItf *getReadGroups() const {
+        throw std::runtime_error("not available");
+    }
+    bool hasReadGroup(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadGroupItf *getReadGroup(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReferenceItf *getReferences() const;
+    bool hasReference(char const spec[]) const {
+        return parts[0]->hasReference(spec);
+    }
+    ngs_adapt::ReferenceItf *getReference(char const spec[]) const;
+    ngs_adapt::AlignmentItf *getAlignment(char const spec[]) const;
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary,
+                                           bool const want_secondary) const;
+    uint64_t getAlignmentCount(bool const want_primary,
+                               bool const want_secondary) const;
+    ngs_adapt::AlignmentItf *getAlignmentRange(uint64_t const first,
+                                               uint64_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary ) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard,
+                                               uint32_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary ) const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getReadCount(bool const want_full,
+                          bool const want_partial,
+                          bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getRead(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getReads(bool const want_full,
+                                 bool const want_partial,
+                                 bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getReadRange(uint64_t const first,
+                                     uint64_t const count,
+                                     bool const want_full,
+                                     bool const want_partial,
+                                     bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    uint32_t getFeatures() const {
+        return NGS_ReadCollectionFeature_references
+             | NGS_ReadCollectionFeature_alignments
+             | NGS_ReadCollectionFeature_alignment_count;
+    }
+    bool getReferenceTable(NGS_ReferenceTable_v1 &table) const {
+        return parts[0]->getReferenceTable(table);
+    }
+};
+
+/* MergedCollection::Alignment
+ *  takes an iterator of each file and gives their alignments in position
+ *  order, those of earlier files first at the same position; a heap holds
+ *  the files whose iterators have a record, ordered by that record
+ *  with one of them already at its record, it is that alignment alone
+ */
+class MergedCollection::Alignment : public ngs_adapt::AlignmentItf
+{
+    typedef PartAlignment Part;
+
+    MergedCollection *parent;
+    PartAlignments its;                 /* per file, NULL for none */
+    std::vector<unsigned> heap;         /* files with a record, not counting cur */
+    int cur;                            /* file of the current alignment, -1 for none */
+    bool const single;
+    mutable std::string idBuffer;
+    mutable std::string mateIdBuffer;
+    mutable StringSlot alignmentIdString;
+    mutable StringSlot mateAlignmentIdString;
+
+    // the heap's order, so that front() is the file with the first record
+    struct Later {
+        PartAlignments const &its;
+        explicit Later(PartAlignments const &Its) : its(Its) {}
+        bool operator ()(unsigned const a, unsigned const b) const {
+            BAMRecord const &A = *its[a]->getRecord();
+            BAMRecord const &B = *its[b]->getRecord();
+            unsigned const arefID = (unsigned)A.refID();    /* unplaced (-1) last */
+            unsigned const brefID = (unsigned)B.refID();
+
+            if (arefID != brefID)
+                return arefID > brefID;
+            if (A.pos() != B.pos())
+                return A.pos() > B.pos();
+            return a > b;
+        }
+    };
+    void Advance(unsigned const i) {
+        if (its[i]->nextAlignment()) {
+            heap.push_back(i);
+            std::push_heap(heap.begin(), heap.end(), Later(its));
+        }
+    }
+    Part &Current() const {
+        if (cur < 0)
+            throw std::runtime_error("no current row");
+        return *its[cur];
+    }
+    // an ID of file cur, made a merged one
+    ngs_adapt::StringItf *MergedId(ngs_adapt::StringItf *const id, std::string &buffer, StringSlot &slot) const {
+        char prefix[16];
+        
+        if (id == 0)
+            return 0;
+        buffer.assign(prefix, snprintf(prefix, sizeof(prefix), "%d.", cur));
+        buffer.append(id->data(), id->size());
+        id->Release();
+        return slot.Set(buffer);
+    }
+public:
+    Alignment(MergedCollection const *const Parent, PartAlignments const &Its, int const positioned = -1)
+    : parent(static_cast<MergedCollection *>(Parent->Duplicate()))
+    , its(Its)
+    , cur(positioned)
+    , single(positioned >= 0)
+    {
+        heap.reserve(its.size());
+    }
+    ~Alignment() {
+        MergedCollection::ReleaseParts(its);
+        parent->Release();
+    }
+
+    bool nextAlignment() {
+        if (single)
+            return Current().nextAlignment();
+        if (cur >= 0)
+            Advance(cur);
+        else if (heap.empty()) {
+            // the first call: every file to its first record
+            for (unsigned i = 0; i < its.size(); ++i) {
+                if (its[i])
+                    Advance(i);
+            }
+        }
+        cur = -1;
+        if (heap.empty()) {
+            MergedCollection::ReleaseParts(its);
+            its.assign(its.size(), 0);
+            return false;
+        }
+        std::pop_heap(heap.begin(), heap.end(), Later(its));
+        cur = heap.back();
+        heap.pop_back();
+        return true;
+    }
+
+    ngs_adapt::StringItf *getAlignmentId() const {
+        ReadCollection::Alignment const &a = static_cast<ReadCollection::Alignment const &>(Current());
+        char buffer[48];
+        
+        idBuffer.assign(buffer, snprintf(buffer, sizeof(buffer), "%d.%llu", cur,
+                                         (unsigned long long)a.getCurrentPos().getValue()));
+        return alignmentIdString.Set(idBuffer);
+    }
+    ngs_adapt::StringItf *getMateAlignmentId() const {
+        return MergedId(Current().getMateAlignmentId(), mateIdBuffer, mateAlignmentIdString);
+    }
+    ngs_adapt::AlignmentItf *getMateAlignment() const {
+        PartAlignments mate(its.size(), 0);
+        
+        mate[cur] = static_cast<Part *>(Current().getMateAlignment());
+        return new Alignment(parent, mate, cur);
+    }
+    ngs_adapt::StringItf *getFragmentId() const {
+        return Current().getFragmentId();
+    }
+    ngs_adapt::StringItf *getFragmentBases(uint64_t const offset, uint64_t const length) const {
+        return Current().getFragmentBases(offset, length);
+    }
+    ngs_adapt::StringItf *getFragmentQualities(uint64_t const offset, uint64_t const length) const {
+        return Current().getFragmentQualities(offset, length);
+    }
+    ngs_adapt::StringItf *getFragmentBasesView(uint64_t const offset, uint64_t const length, NGS_StringView_v1 &view) const {
+        return Current().getFragmentBasesView(offset, length, view);
+    }
+    ngs_adapt::StringItf *getFragmentQualitiesView(uint64_t const offset, uint64_t const length, NGS_StringView_v1 &view) const {
+        return Current().getFragmentQualitiesView(offset, length, view);
+    }
+    bool getFragmentBasesPacked(uint64_t const offset, uint64_t const length, NGS_FragmentPackedBases_v1 &packed) const {
+        return Current().getFragmentBasesPacked(offset, length, packed);
+    }
+    uint32_t getFragmentIndex() const {
+        return Current().getFragmentIndex();
+    }
+    ngs_adapt::StringItf *getReferenceSpec() const {
+        return Current().getReferenceSpec();
+    }
+    ngs_adapt::StringItf *getReferenceSpecView(NGS_StringView_v1 &view) const {
+        return Current().getReferenceSpecView(view);
+    }
+    int32_t getMappingQuality() const {
+        return Current().getMappingQuality();
+    }
+    int32_t getReferenceIndex() const {
+        return Current().getReferenceIndex();
+    }
+    int32_t getMateReferenceIndex() const {
+        return Current().getMateReferenceIndex();
+    }
+    ngs_adapt::StringItf *getReferenceBases() const {
+        return Current().getReferenceBases();
+    }
+    ngs_adapt::StringItf *getReadGroup() const {
+        return Current().getReadGroup();
+    }
+    bool getTag(char const tag[], NGS_AlignmentTag_v1 &value) const {
+        return Current().getTag(tag, value);
+    }
+    bool getCigarOps(NGS_AlignmentCigar_v1 &cigar) const {
+        return Current().getCigarOps(cigar);
+    }
+    bool getMismatches(NGS_AlignmentMismatches_v1 &mismatches) const {
+        return Current().getMismatches(mismatches);
+    }
+    bool getReadFragment(NGS_AlignmentReadFragment_v1 &fragment) const {
+        return Current().getReadFragment(fragment);
+    }
+    void getCore(NGS_AlignmentCore_v1 &core) const {
+        Current().getCore(core);
+    }
+    ngs_adapt::StringItf *getReadId() const {
+        return Current().getReadId();
+    }
+    ngs_adapt::StringItf *getReadIdView(NGS_StringView_v1 &view) const {
+        return Current().getReadIdView(view);
+    }
+    ngs_adapt::StringItf *getClippedFragmentBases() const {
+        return Current().getClippedFragmentBases();
+    }
+    ngs_adapt::StringItf *getClippedFragmentQualities() const {
+        return Current().getClippedFragmentQualities();
+    }
+    ngs_adapt::StringItf *getAlignedFragmentBases() const {
+        return Current().getAlignedFragmentBases();
+    }
+    bool isPrimary() const {
+        return Current().isPrimary();
+    }
+    int64_t getAlignmentPosition() const {
+        return Current().getAlignmentPosition();
+    }
+    uint64_t getReferencePositionProjectionRange(int64_t const ref_pos) const {
+        return Current().getReferencePositionProjectionRange(ref_pos);
+    }
+    uint64_t getAlignmentLength() const {
+        return Current().getAlignmentLength();
+    }
+    bool getIsReversedOrientation() const {
+        return Current().getIsReversedOrientation();
+    }
+    int32_t getSoftClip(uint32_t const edge) const {
+        return Current().getSoftClip(edge);
+    }
+    uint64_t getTemplateLength() const {
+        return Current().getTemplateLength();
+    }
+    ngs_adapt::StringItf *getShortCigar(bool const clipped) const {
+        return Current().getShortCigar(clipped);
+    }
+    ngs_adapt::StringItf *getLongCigar(bool const clipped) const {
+        return Current().getLongCigar(clipped);
+    }
+    char getRNAOrientation() const {
+        return Current().getRNAOrientation();
+    }
+    bool hasMate() const {
+        return Current().hasMate();
+    }
+    ngs_adapt::StringItf *getMateReferenceSpec() const {
+        return Current().getMateReferenceSpec();
+    }
+    bool getMateIsReversedOrientation() const {
+        return Current().getMateIsReversedOrientation();
+    }
+    /* getPart
+     *  the iterator of the file with the current alignment, or NULL
+     */
+    Part const *getPart() const {
+        return cur >= 0 ? its[cur] : 0;
+    }
+    // the files were all opened alike, so any of them answers for the rest
+    uint32_t getSupportedMessages() const {
+        for (unsigned i = 0; i < its.size(); ++i) {
+            if (its[i])
+                return its[i]->getSupportedMessages();
+        }
+        return 0;
+    }
+};
+
+/* MergedCollection::Reference
+ *  the same reference in every file; all but its alignments come from the first
+ */
+class MergedCollection::Reference : public ngs_adapt::ReferenceItf
+{
+    MergedCollection *parent;
+    PartReferences refs;
+public:
+    Reference(MergedCollection const *const Parent, PartReferences const &Refs)
+    : parent(static_cast<MergedCollection *>(Parent->Duplicate()))
+    , refs(Refs)
+    {}
+    ~Reference() {
+        MergedCollection::ReleaseParts(refs);
+        parent->Release();
+    }
+
+    ngs_adapt::StringItf *getCommonName() const {
+        return refs[0]->getCommonName();
+    }
+    ngs_adapt::StringItf *getCanonicalName() const {
+        return refs[0]->getCanonicalName();
+    }
+    bool getIsCircular() const {
+        return refs[0]->getIsCircular();
+    }
+    uint64_t getLength() const {
+        return refs[0]->getLength();
     }
     ngs_adapt::StringItf *getReferenceBases(uint64_t const offset, uint64_t const length) const {
+        return refs[0]->getReferenceBases(offset, length);
+    }
+    ngs_adapt::StringItf *getReferenceChunk(uint64_t const offset, uint64_t const length) const {
+        return refs[0]->getReferenceChunk(offset, length);
+    }
+    uint64_t copyReferenceBases(uint64_t const offset, char *const buffer, uint64_t const size) const {
+        return refs[0]->copyReferenceBases(offset, buffer, size);
+    }
+    bool getReferenceBasesPacked(uint64_t const offset, uint64_t const length, uint8_t *const bases, uint8_t *const n_mask, uint64_t &count) const {
+        return refs[0]->getReferenceBasesPacked(offset, length, bases, n_mask, count);
+    }
+    // what every file has, but no shards or pileups
+    uint32_t getFeatures() const {
+        uint32_t features = ~(uint32_t)0;
+        
+        for (unsigned i = 0; i < refs.size(); ++i)
+            features &= refs[i]->getFeatures();
+        return features & ~(NGS_ReferenceFeature_alignment_shard | NGS_ReferenceFeature_pileups);
+    }
+    uint64_t getAlignmentCount(bool const wants_primary, bool const wants_secondary) const {
+        uint64_t count = 0;
+        
+        for (unsigned i = 0; i < refs.size(); ++i)
+            count += refs[i]->getAlignmentCount(wants_primary, wants_secondary);
+        return count;
+    }
+    // the sum of the files', if every file can estimate it
+    bool estimateSlice(int64_t const start, uint64_t const length, uint64_t &alignments, uint64_t &bytes) const {
+        alignments = bytes = 0;
+        
+        for (unsigned i = 0; i < refs.size(); ++i) {
+            uint64_t count, size;
+            
+            if (!refs[i]->estimateSlice(start, length, count, size))
+                return false;
+            alignments += count;
+            bytes += size;
+        }
+        return true;
+    }
+    ngs_adapt::AlignmentItf *getAlignment(char const id[]) const {
+        unsigned part;
+        char const *rest;
+        
+        PartAlignments one(refs.size(), 0);
+        
+        // the file's own error would give the ID without the file
+        try {
+            if (!parent->ParseId(id, part, rest))
+                throw std::runtime_error("no alignment");
+            one[part] = static_cast<PartAlignment *>(refs[part]->getAlignment(rest));
+        }
+        catch (std::runtime_error const &) {
+            throw std::runtime_error(std::string("no alignment with ID '") + id + "'");
+        }
+        return new Alignment(parent, one, part);
+    }
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary, bool const want_secondary) const {
+        return getAlignmentSlice(0, getLength(), want_primary, want_secondary);
+    }
+    ngs_adapt::AlignmentItf *getAlignmentSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        uint32_t const flags = (want_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                             | (want_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                             | NGS_ReferenceAlignFlags_pass_bad
+                             | NGS_ReferenceAlignFlags_pass_dups;
+        
+        return getFilteredAlignmentSlice(start, length, flags, 0);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignments(uint32_t const flags, int32_t const map_qual) const {
+        return getFilteredAlignmentSlice(0, getLength(), flags, map_qual);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignmentSlice(int64_t const start, uint64_t const length, uint32_t const flags, int32_t const map_qual) const {
+        return getSlice(start, length, flags, map_qual, 0);
+    }
+    // see ReadCollection::Reference::getSlice
+    ngs_adapt::AlignmentItf *getSlice(int64_t const start, uint64_t const length, uint32_t const flags, int32_t const map_qual,
+                                      RecordProgram const *const program) const {
+        PartAlignments its(refs.size(), 0);
+        
+        try {
+            for (unsigned i = 0; i < refs.size(); ++i)
+                its[i] = static_cast<PartAlignment *>(refs[i]->getSlice(start, length, flags, map_qual, program));
+        }
+        catch (...) {
+            MergedCollection::ReleaseParts(its);
+            throw;
+        }
+        return new Alignment(parent, its);
+    }
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard, uint32_t const count, bool const want_primary, bool const want_secondary) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getPileups(bool const want_primary, bool const want_secondary) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getFilteredPileups(uint32_t flags, int32_t map_qual) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getPileupSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getFilteredPileupSlice(int64_t const start, uint64_t const length, uint32_t flags, int32_t map_qual) const {
         throw std::runtime_error("not available");
     }
-    ngs_adapt::StringItf *getReferenceChunk(uint64_t const offset, uint64_t const length) const {
-        throw std::runtime_error("not available");
+    // the files' runs are added together before they are summed
+    bool getCoverage(int64_t const start, uint64_t const length, uint32_t const flags, int32_t const map_qual, uint32_t *const depth) const {
+        memset(depth, 0, length * sizeof(depth[0]));
+        for (unsigned i = 0; i < refs.size(); ++i)
+            refs[i]->AddCoverage(start, length, flags, map_qual, depth);
+        SumCoverage(depth, length);
+        return true;
+    }
+    // the files have the same references, so they all end together
+    bool nextReference() {
+        bool more = false;
+        
+        for (unsigned i = 0; i < refs.size(); ++i)
+            more = refs[i]->nextReference();
+        return more;
+    }
+};
+
+MergedCollection::MergedCollection(std::vector<std::string> const &paths, NGS_BAM::OpenOptions const &Options)
+{
+    NGS_BAM::OpenOptions options(Options);
+    
+    if (paths.empty())
+        throw std::runtime_error("no files to merge");
+    if (options.threads == 0)
+        options.threads = 1;
+    
+    try {
+        for (unsigned i = 0; i < paths.size(); ++i) {
+            parts.push_back(new ReadCollection(paths[i], options));
+            
+            ngs_adapt::StringItf *const partName = parts.back()->getName();
+            
+            if (i > 0)
+                name += '+';
+            name.append(partName->data(), partName->size());
+            partName->Release();
+        }
+        PartsMatch();
+    }
+    catch (...) {
+        for (unsigned i = 0; i < parts.size(); ++i)
+            parts[i]->Release();
+        throw;
+    }
+}
+
+MergedCollection::~MergedCollection()
+{
+    for (unsigned i = 0; i < parts.size(); ++i)
+        parts[i]->Release();
+}
+
+/* PartsMatch
+ *  throws unless every file has the references of the first, in the same order
+ */
+void MergedCollection::PartsMatch() const
+{
+    BAMFile const &first = parts[0]->file;
+    
+    for (unsigned i = 1; i < parts.size(); ++i) {
+        BAMFile const &file = parts[i]->file;
+        bool same = file.countOfReferences() == first.countOfReferences();
+        
+        for (unsigned j = 0; same && j < first.countOfReferences(); ++j) {
+            HeaderRefInfo const &a = first.getRefInfo(j);
+            HeaderRefInfo const &b = file.getRefInfo(j);
+            
+            same = a.getLength() == b.getLength() && a.getNameLength() == b.getNameLength() &&
+                   memcmp(a.getName(), b.getName(), a.getNameLength()) == 0;
+        }
+        if (!same)
+            throw std::runtime_error("the references of '" + parts[i]->path + "' are not those of '" + parts[0]->path + "'");
+    }
+    for (unsigned i = 0; i < parts.size(); ++i) {
+        if (parts[i]->file.isUnsorted())
+            throw std::runtime_error("'" + parts[i]->path + "' can't be merged: it isn't sorted by position");
+    }
+}
+
+void MergedCollection::ReleaseParts(PartAlignments const &its)
+{
+    for (unsigned i = 0; i < its.size(); ++i) {
+        if (its[i])
+            its[i]->Release();
+    }
+}
+
+void MergedCollection::ReleaseParts(PartReferences const &refs)
+{
+    for (unsigned i = 0; i < refs.size(); ++i)
+        refs[i]->Release();
+}
+
+bool MergedCollection::ParseId(char const id[], unsigned &part, char const *&rest) const
+{
+    unsigned value = 0;
+    char const *cp = id;
+    
+    if (id == 0)
+        return false;
+    for ( ; *cp >= '0' && *cp <= '9'; ++cp) {
+        value = value * 10 + (*cp - '0');
+        if (value >= parts.size())
+            return false;
+    }
+    if (cp == id || *cp != '.')
+        return false;
+    part = value;
+    rest = cp + 1;
+    return true;
+}
+
+ngs_adapt::ReferenceItf *MergedCollection::getReferences() const
+{
+    PartReferences refs;
+    
+    refs.reserve(parts.size());
+    for (unsigned i = 0; i < parts.size(); ++i)
+        refs.push_back(static_cast<PartReference *>(parts[i]->getReferences()));
+    return new Reference(this, refs);
+}
+
+ngs_adapt::ReferenceItf *MergedCollection::getReference(char const spec[]) const
+{
+    PartReferences refs;
+    
+    for (unsigned i = 0; i < parts.size(); ++i) {
+        if (!parts[i]->hasReference(spec))
+            throw std::runtime_error(std::string("reference not found: ") + spec);
+    }
+    refs.reserve(parts.size());
+    for (unsigned i = 0; i < parts.size(); ++i)
+        refs.push_back(static_cast<PartReference *>(parts[i]->getReference(spec)));
+    return new Reference(this, refs);
+}
+
+ngs_adapt::AlignmentItf *MergedCollection::getAlignment(char const spec[]) const
+{
+    unsigned part;
+    char const *rest;
+    
+    PartAlignments one(parts.size(), 0);
+    
+    // the file's own error would give the ID without the file
+    try {
+        if (!ParseId(spec, part, rest))
+            throw std::runtime_error("no alignment");
+        one[part] = static_cast<PartAlignment *>(parts[part]->getAlignment(rest));
+    }
+    catch (std::runtime_error const &) {
+        throw std::runtime_error(std::string("no alignment with ID '") + (spec ? spec : "") + "'");
+    }
+    return new Alignment(this, one, part);
+}
+
+ngs_adapt::AlignmentItf *MergedCollection::getAlignments(bool const want_primary,
+                                                         bool const want_secondary) const
+{
+    PartAlignments its(parts.size(), 0);
+    
+    try {
+        for (unsigned i = 0; i < parts.size(); ++i)
+            its[i] = static_cast<PartAlignment *>(parts[i]->getAlignments(want_primary, want_secondary));
+    }
+    catch (...) {
+        ReleaseParts(its);
+        throw;
+    }
+    return new Alignment(this, its);
+}
+
+uint64_t MergedCollection::getAlignmentCount(bool const want_primary,
+                                             bool const want_secondary) const
+{
+    uint64_t count = 0;
+    
+    for (unsigned i = 0; i < parts.size(); ++i)
+        count += parts[i]->getAlignmentCount(want_primary, want_secondary);
+    return count;
+}
+
+ngs::ReadCollection NGS_BAM::openReadCollection(std::string const &path)
+{
+    return openReadCollection(path, defaultOpenOptions());
+}
+
+static bool ParseFlag(std::string const &name, std::string const &value)
+{
+    if (value == "true" || value == "yes" || value == "on" || value == "1")
+        return true;
+    if (value == "false" || value == "no" || value == "off" || value == "0")
+        return false;
+    throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+}
+
+/* ParseSize
+ *  a count, or bytes with a k, M or G suffix
+ */
+static uint64_t ParseSize(std::string const &name, std::string const &value)
+{
+    char const *const text = value.c_str();
+    char *endp = 0;
+    uint64_t const count = strtoull(text, &endp, 10);
+    unsigned shift = 0;
+    
+    if (endp == text || value[0] == '-')
+        throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+    switch (*endp) {
+    case 'k': case 'K': shift = 10; ++endp; break;
+    case 'm': case 'M': shift = 20; ++endp; break;
+    case 'g': case 'G': shift = 30; ++endp; break;
+    }
+    if (*endp != '\0' || (count << shift) >> shift != count)
+        throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+    return count << shift;
+}
+
+static unsigned ParseCount(std::string const &name, std::string const &value)
+{
+    uint64_t const count = ParseSize(name, value);
+    
+    if (count > 0xFFFFFFFFu)
+        throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+    return (unsigned)count;
+}
+
+static unsigned ParseFields(std::string const &name, std::string const &value)
+{
+    typedef NGS_BAM::OpenOptions O;
+    unsigned fields = 0;
+    
+    if (value == "all")
+        return O::allFields;
+    for (std::string::size_type at = 0; at <= value.size(); ) {
+        std::string::size_type const plus = std::min(value.find('+', at), value.size());
+        std::string const field = value.substr(at, plus - at);
+        
+        if (field == "readName")
+            fields |= O::readName;
+        else if (field == "bases")
+            fields |= O::bases;
+        else if (field == "qualities")
+            fields |= O::qualities;
+        else if (field == "tags")
+            fields |= O::tags;
+        else if (!field.empty() || plus < value.size())
+            throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+        at = plus + 1;
+    }
+    return fields;
+}
+
+void NGS_BAM::setOpenOption(OpenOptions &options, std::string const &name, std::string const &value)
+{
+    if (name == "threads")
+        options.threads = ParseCount(name, value);
+    else if (name == "useMmap")
+        options.useMmap = ParseFlag(name, value);
+    else if (name == "lazyIndex")
+        options.lazyIndex = ParseFlag(name, value);
+    else if (name == "asyncIndex")
+        options.asyncIndex = ParseFlag(name, value);
+    else if (name == "prefetch")
+        options.prefetch = (size_t)ParseSize(name, value);
+    else if (name == "streaming")
+        options.streaming = ParseFlag(name, value);
+    else if (name == "blockCache")
+        options.blockCache = ParseCount(name, value);
+    else if (name == "regionCache")
+        options.regionCache = (size_t)ParseSize(name, value);
+    else if (name == "ioBuffer")
+        options.ioBuffer = (size_t)ParseSize(name, value);
+    else if (name == "hugePages")
+        options.hugePages = ParseFlag(name, value);
+    else if (name == "fields")
+        options.fields = ParseFields(name, value);
+    else if (name == "verifyCRC")
+        options.verifyCRC = ParseFlag(name, value);
+    else if (name == "buildStats")
+        options.buildStats = ParseFlag(name, value);
+    else if (name == "referenceFasta")
+        options.referenceFasta = value;
+    else if (name == "mateBuffer")
+        options.mateBuffer = (size_t)ParseSize(name, value);
+    else if (name == "validation") {
+        if (value == "trusted")
+            options.validation = OpenOptions::trusted;
+        else if (value == "checked")
+            options.validation = OpenOptions::checked;
+        else if (value == "strict")
+            options.validation = OpenOptions::strict;
+        else
+            throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+    }
+    else if (name == "buildIndex")
+        options.buildIndex = ParseFlag(name, value);
+    else if (name == "saveIndex")
+        options.saveIndex = ParseFlag(name, value);
+    else if (name == "sharedIndex")
+        options.sharedIndex = ParseFlag(name, value);
+    else if (name == "nameIndex")
+        options.nameIndex = ParseFlag(name, value);
+    else if (name == "follow")
+        options.follow = ParseCount(name, value);
+    else if (name == "priority") {
+        if (value == "low")
+            options.priority = OpenOptions::low;
+        else if (value == "normal")
+            options.priority = OpenOptions::normal;
+        else if (value == "high")
+            options.priority = OpenOptions::high;
+        else
+            throw std::runtime_error("bad value '" + value + "' for open option '" + name + "'");
+    }
+    else if (name == "poolThreads")
+        options.poolThreads = ParseCount(name, value);
+    else if (name == "numaLocal")
+        options.numaLocal = ParseFlag(name, value);
+    else if (name == "adaptiveReadahead")
+        options.adaptiveReadahead = ParseFlag(name, value);
+    else if (name == "gpuInflate")
+        options.gpuInflate = ParseFlag(name, value);
+    else if (name == "zoneMap")
+        options.zoneMap = ParseFlag(name, value);
+    else if (name == "diskCache")
+        options.diskCache = value;
+    else if (name == "diskCacheSize")
+        options.diskCacheSize = ParseSize(name, value);
+    else if (name == "diskCacheInflated")
+        options.diskCacheInflated = ParseFlag(name, value);
+    else
+        throw std::runtime_error("unknown open option '" + name + "'");
+}
+
+void NGS_BAM::setOpenOptions(OpenOptions &options, std::string const &settings)
+{
+    static char const separators[] = ", \t\n";
+    std::string::size_type at = settings.find_first_not_of(separators);
+    
+    while (at != std::string::npos) {
+        std::string::size_type const end = std::min(settings.find_first_of(separators, at), settings.size());
+        std::string const setting = settings.substr(at, end - at);
+        std::string::size_type const equals = setting.find('=');
+        
+        if (equals == std::string::npos)
+            throw std::runtime_error("open option '" + setting + "' has no value");
+        setOpenOption(options, setting.substr(0, equals), setting.substr(equals + 1));
+        at = settings.find_first_not_of(separators, end);
+    }
+}
+
+NGS_BAM::OpenOptions NGS_BAM::defaultOpenOptions()
+{
+    OpenOptions options;
+    char const *const env = getenv("NGS_BAM_OPTIONS");
+    
+    if (env)
+        setOpenOptions(options, env);
+    return options;
+}
+
+ngs::ReadCollection NGS_BAM::openReadCollection(std::string const &path,
+                                                std::map<std::string, std::string> const &settings)
+{
+    OpenOptions options = defaultOpenOptions();
+    
+    for (std::map<std::string, std::string>::const_iterator i = settings.begin(); i != settings.end(); ++i)
+        setOpenOption(options, i->first, i->second);
+    return openReadCollection(path, options);
+}
+
+/* isCRAMPath
+ *  a local file is looked at; a URL is taken at its word, as it can't
+ *  be read twice
+ */
+static bool isCRAMPath(std::string const &path)
+{
+    static char const ext[] = ".cram";
+    size_t const n = sizeof(ext) - 1;
+
+    if (ByteSource::IsHtsget(path))
+        return false;               /* its tickets are asked for as BAM */
+    if (path.find("://") == path.npos)
+        return CRAMFile::isCRAM(path);
+    return path.size() > n && path.compare(path.size() - n, n, ext) == 0;
+}
+
+ngs::ReadCollection NGS_BAM::openReadCollection(std::string const &path, OpenOptions const &options)
+{
+    if (isCRAMPath(path)) {
+        ngs_adapt::ReadCollectionItf *const self = OpenCRAMCollection(path, options);
+        NGS_ReadCollection_v1 *const c_obj = self->Cast();
+        ngs::ReadCollectionItf *const ngs_itf = ngs::ReadCollectionItf::Cast(c_obj);
+
+        return ngs::ReadCollection(ngs_itf);
     }
-    uint64_t getAlignmentCount ( bool wants_primary, bool wants_secondary ) const {
+
+    uint64_t const asked = BGZFStats::Now();
+    ReadCollection *const self = new ReadCollection(path, options);
+    NGS_ReadCollection_v1 *const c_obj = self->Cast();
+    
+    self->getFile().getLatency().open.Add(BGZFStats::Now() - asked);
+    ngs::ReadCollectionItf *const ngs_itf = ngs::ReadCollectionItf::Cast(c_obj);
+    
+    return ngs::ReadCollection(ngs_itf);
+}
+
+ngs::ReadCollection NGS_BAM::openMergedReadCollection(std::vector<std::string> const &paths, OpenOptions const &options)
+{
+    ngs_adapt::ReadCollectionItf *const self = new MergedCollection(paths, options);
+    NGS_ReadCollection_v1 *const c_obj = self->Cast();
+    ngs::ReadCollectionItf *const ngs_itf = ngs::ReadCollectionItf::Cast(c_obj);
+    
+    return ngs::ReadCollection(ngs_itf);
+}
+
+void NGS_BAM::keepOpenFiles(unsigned int const count)
+{
+    BAMFile::Keep(count);
+}
+
+class NGS_BAM::MateFinder::Impl
+{
+public:
+    BAMFile file;
+    BAMFilePosTypeList queued;
+    
+    Impl(std::string const &path, OpenOptions const &options) : file(path, options) {}
+};
+
+/* PositionLess
+ *  orders indices into a list of positions by position
+ */
+struct PositionLess
+{
+    BAMFilePosTypeList const &positions;
+    
+    explicit PositionLess(BAMFilePosTypeList const &Positions) : positions(Positions) {}
+    bool operator ()(unsigned const a, unsigned const b) const {
+        return positions[a] < positions[b];
+    }
+};
+
+NGS_BAM::MateFinder::MateFinder(std::string const &path, OpenOptions const &options)
+: impl(new Impl(path, options))
+{
+}
+
+NGS_BAM::MateFinder::~MateFinder()
+{
+    delete impl;
+}
+
+void NGS_BAM::MateFinder::add(std::string const &alignmentId)
+{
+    BAMFilePosType pos;
+    
+    if (!ParseAlignmentId(alignmentId.c_str(), pos))
+        throw std::runtime_error("no alignment with ID '" + alignmentId + "'");
+    impl->queued.push_back(pos);
+}
+
+std::vector<std::string> NGS_BAM::MateFinder::resolve()
+{
+    BAMFilePosTypeList queued;
+    std::vector<std::string> rslt;
+    
+    queued.swap(impl->queued);
+    rslt.resize(queued.size());
+    if (queued.empty())
+        return rslt;
+    
+    // read the alignments in file order
+    std::vector<unsigned> order(queued.size());
+    
+    for (unsigned i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), PositionLess(queued));
+    
+    BAMFileCursor cursor(impl->file, queued[order[0]]);
+    BAMRecordBuffer buffer;
+    BAMMateRequestList requests;
+    std::vector<unsigned> asked;    /* the request for each alignment, if any */
+    
+    requests.reserve(queued.size());
+    asked.resize(queued.size(), (unsigned)-1);
+    for (unsigned i = 0; i < order.size(); ++i) {
+        unsigned const j = order[i];
+        BAMRecord const *rec;
+        
+        try {
+            cursor.Seek(queued[j]);
+            rec = cursor.Read(buffer, OpenOptions::readName);
+        }
+        catch (std::runtime_error const &) {
+            rec = 0;
+        }
+        if (!rec || !cursor.isGoodRecord(*rec)) {
+            std::string id;
+            
+            FormatAlignmentId(queued[j], id);
+            throw std::runtime_error("no alignment with ID '" + id + "'");
+        }
+        
+        int const FLAG = rec->flag();
+        
+        if ((FLAG & 0x0001) != 0 && (FLAG & 0x00C0) != 0 && (FLAG & 0x00C0) != 0x00C0) {
+            asked[j] = (unsigned)requests.size();
+            requests.push_back(BAMMateRequest(*rec));
+        }
+    }
+    
+    // then their mates in position order
+    impl->file.FindMates(requests);
+    for (unsigned i = 0; i < queued.size(); ++i) {
+        if (asked[i] != (unsigned)-1 && requests[asked[i]].found)
+            FormatAlignmentId(requests[asked[i]].mate, rslt[i]);
+    }
+    return rslt;
+}
+
+/* AlignmentAccess, CollectionAccess, ReferenceAccess
+ *  the C object behind an NGS object, from its protected "self"
+ */
+struct AlignmentAccess : public ngs::Alignment
+{
+    static NGS_Alignment_v1 const *CObject(ngs::Alignment const &alignment) {
+        return reinterpret_cast<NGS_Alignment_v1 const *>(alignment.*(&AlignmentAccess::self));
+    }
+};
+
+struct CollectionAccess : public ngs::ReadCollection
+{
+    static NGS_ReadCollection_v1 const *CObject(ngs::ReadCollection const &collection) {
+        return reinterpret_cast<NGS_ReadCollection_v1 const *>(collection.*(&CollectionAccess::self));
+    }
+};
+
+struct ReferenceAccess : public ngs::Reference
+{
+    static NGS_Reference_v1 const *CObject(ngs::Reference const &reference) {
+        return reinterpret_cast<NGS_Reference_v1 const *>(reference.*(&ReferenceAccess::self));
+    }
+};
+
+/* RegionHint
+ *  BAMFile::WillNeed of some regions, run on the shared pool; holds
+ *  on to the collection, and so to its file, until it has run
+ */
+class ReadCollection::RegionHint : public ngs::WorkItem
+{
+    ReadCollection *const held;
+    std::vector<BAMFileChunkList> regions;
+    
+    RegionHint(ReadCollection const *const collection, std::vector<BAMFileChunkList> &Regions)
+    : held(static_cast<ReadCollection *>(collection->Duplicate()))
+    {
+        regions.swap(Regions);
+    }
+    ~RegionHint() {
+        held->Release();
+    }
+public:
+    void run() {
+        held->getFile().WillNeed(regions);
+        delete this;
+    }
+    
+    /* Submit
+     *  "regions" is taken; without the pool the hint is dropped
+     */
+    static void Submit(ReadCollection const *const collection, std::vector<BAMFileChunkList> &regions) {
+        RegionHint *const hint = new RegionHint(collection, regions);
+        
+        try {
+            ngs::WorkPool::shared().submit(*hint, ngs::WorkPool::low);
+        }
+        catch (ngs::ErrorMsg const &) {
+            delete hint;
+        }
+    }
+};
+
+/* EngineAccess
+ *  what the functions of NGS_BAM reach through NGS objects of ours:
+ *  the collection, file and record behind them
+ */
+class EngineAccess
+{
+public:
+    static ngs_adapt::ReadCollectionItf const *Self(ngs::ReadCollection const &collection) {
+        NGS_ReadCollection_v1 const *const obj = CollectionAccess::CObject(collection);
+        
+        return ReadCollection::isAdapted(obj) ? ngs_adapt::ReadCollectionItf::Self(obj) : 0;
+    }
+    
+    /* File
+     *  the BAM file of a collection, or NULL if it isn't one of ours
+     */
+    static BAMFile const *File(ngs::ReadCollection const &collection) {
+        ngs_adapt::ReadCollectionItf const *const itf = Self(collection);
+        
+        if (ReadCollection const *const single = dynamic_cast<ReadCollection const *>(itf))
+            return &single->getFile();
+        if (MergedCollection const *const merged = dynamic_cast<MergedCollection const *>(itf))
+            return &merged->getFile();
+        return 0;
+    }
+    
+    /* Files
+     *  every BAM file of a collection, none if it isn't one of ours
+     */
+    static std::vector<BAMFile const *> Files(ngs::ReadCollection const &collection) {
+        ngs_adapt::ReadCollectionItf const *const itf = Self(collection);
+        std::vector<BAMFile const *> files;
+        
+        if (ReadCollection const *const single = dynamic_cast<ReadCollection const *>(itf))
+            files.push_back(&single->file);
+        else if (MergedCollection const *const merged = dynamic_cast<MergedCollection const *>(itf)) {
+            for (size_t i = 0; i < merged->parts.size(); ++i)
+                files.push_back(&merged->parts[i]->file);
+        }
+        return files;
+    }
+    
+    /* UnplacedReads
+     *  a read iterator over the records without a reference
+     */
+    static ngs_adapt::ReadItf *UnplacedReads(ngs::ReadCollection const &collection) {
+        ReadCollection const *const single = dynamic_cast<ReadCollection const *>(Self(collection));
+        
+        if (!single)
+            throw std::runtime_error("not available");
+        
+        BAMFilePosType start;
+        uint64_t count;
+        
+        if (!single->file.getUnplaced(start, count))
+            throw std::runtime_error("the unplaced reads of '" + single->path + "' can't be found without its index");
+        return new ReadCollection::Read(single, start, count);
+    }
+    
+    /* AlignmentSlices
+     *  an iterator over the merged chunks of every interval
+     */
+    static ngs_adapt::AlignmentItf *AlignmentSlices(ngs::ReadCollection const &collection,
+                                                    std::vector<NGS_BAM::Interval> const &intervals,
+                                                    bool const want_primary, bool const want_secondary)
+    {
+        ReadCollection const *const single = dynamic_cast<ReadCollection const *>(Self(collection));
+        
+        if (!single)
+            throw std::runtime_error("not available");
+        
+        ReadCollection::AlignmentIntervals::TargetList targets;
+        BAMFileChunkList chunks;
+        
+        for (size_t i = 0; i < intervals.size(); ++i) {
+            NGS_BAM::Interval const &interval = intervals[i];
+            int const refID = single->file.getReferenceIndexByName(interval.reference);
+            
+            if (refID < 0)
+                throw std::runtime_error("no reference '" + interval.reference + "' in '" + single->path + "'");
+            
+            HeaderRefInfo const &ref = single->getRefInfo(refID);
+            
+            if (!ref.hasIndex())
+                throw std::runtime_error("the intervals of '" + single->path + "' can't be found without its index");
+            
+            uint64_t const end = interval.end < ref.getLength() ? interval.end : ref.getLength();
+            if (!(interval.start < end))
+                continue;
+            
+            BAMFileChunkList const &slice = ref.slice((unsigned)interval.start, (unsigned)end);
+            
+            chunks.insert(chunks.end(), slice.begin(), slice.end());
+            targets.push_back(ReadCollection::AlignmentIntervals::Target(refID, (unsigned)interval.start, (unsigned)end, i));
+        }
+        ReadCollection::AlignmentIntervals::Merge(chunks);
+        if (chunks.empty() || (!want_primary && !want_secondary))
+            return new ReadCollection::AlignmentNone();
+        
+        std::sort(targets.begin(), targets.end());
+        return new ReadCollection::AlignmentIntervals(single, want_primary, want_secondary, chunks, targets);
+    }
+    
+    /* WillNeed
+     *  the chunks of the intervals in each file of a collection, hinted
+     *  to it on the pool; those it can't find are passed over
+     */
+    static void WillNeed(ngs::ReadCollection const &collection, std::vector<NGS_BAM::Interval> const &intervals) {
+        ngs_adapt::ReadCollectionItf const *const itf = Self(collection);
+        std::vector<ReadCollection const *> singles;
+        
+        if (ReadCollection const *const single = dynamic_cast<ReadCollection const *>(itf))
+            singles.push_back(single);
+        else if (MergedCollection const *const merged = dynamic_cast<MergedCollection const *>(itf))
+            singles.assign(merged->parts.begin(), merged->parts.end());
+        
+        for (size_t k = 0; k < singles.size(); ++k) {
+            ReadCollection const *const single = singles[k];
+            std::vector<BAMFileChunkList> regions;
+            
+            for (size_t i = 0; i < intervals.size(); ++i) {
+                NGS_BAM::Interval const &interval = intervals[i];
+                int const refID = single->file.getReferenceIndexByName(interval.reference);
+                
+                if (refID < 0)
+                    continue;
+                
+                HeaderRefInfo const &ref = single->getRefInfo(refID);
+                uint64_t const end = interval.end < ref.getLength() ? interval.end : ref.getLength();
+                
+                if (!ref.hasIndex() || !(interval.start < end))
+                    continue;
+                
+                BAMFileChunkList const &slice = ref.slice((unsigned)interval.start, (unsigned)end);
+                
+                if (!slice.empty())
+                    regions.push_back(slice);
+            }
+            if (!regions.empty())
+                ReadCollection::RegionHint::Submit(single, regions);
+        }
+    }
+    
+    /* Slice
+     *  an iterator over a slice of a reference of ours, of alignments of "flags"
+     */
+    static ngs_adapt::AlignmentItf *Slice(ngs::Reference const &reference, int64_t const start, uint64_t const length,
+                                          uint32_t const flags)
+    {
+        NGS_Reference_v1 const *const obj = ReferenceAccess::CObject(reference);
+        ngs_adapt::ReferenceItf const *const itf = ReadCollection::Reference::isAdapted(obj) ? ngs_adapt::ReferenceItf::Self(obj) : 0;
+        
+        if (ReadCollection::Reference const *const single = dynamic_cast<ReadCollection::Reference const *>(itf))
+            return single->getSlice(start, length, flags, 0, 0);
+        if (MergedCollection::Reference const *const merged = dynamic_cast<MergedCollection::Reference const *>(itf))
+            return merged->getSlice(start, length, flags, 0, 0);
         throw std::runtime_error("not available");
     }
-    ngs_adapt::AlignmentItf *getAlignment(char const id[]) const {
+    
+    /* FlagStats
+     *  the flags of every file's records counted, as statistics
+     */
+    static ngs_adapt::StatisticsItf *FlagStats(ngs::ReadCollection const &collection) {
+        std::vector<BAMFile const *> const files = Files(collection);
+        
+        if (files.empty())
+            throw std::runtime_error("not available");
+        
+        BAMFlagStats stats;
+        
+        for (size_t i = 0; i < files.size(); ++i) {
+            BAMFlagStats counted;
+            
+            files[i]->CountFlags(counted);
+            stats.Add(counted);
+        }
+        
+        StatisticList list;
+        
+        for (unsigned i = 0; i < 2; ++i) {
+            std::string const prefix = i == 0 ? "FLAGSTAT/PASSED/" : "FLAGSTAT/FAILED/";
+            
+            for (unsigned j = 0; j < BAMFlagStats::counters; ++j)
+                list.push_back(Statistic(prefix + BAMFlagStats::Name((BAMFlagStats::Counter)j), stats.count[i][j]));
+        }
+        std::sort(list.begin(), list.end());
+        return new ReadCollection::StatisticTable(list);
+    }
+    
+    /* AlignmentSample
+     *  an iterator drawing runs of a single file's records at random
+     */
+    static ngs_adapt::AlignmentItf *AlignmentSample(ngs::ReadCollection const &collection, uint64_t const count, uint64_t const seed,
+                                                    bool const want_primary, bool const want_secondary)
+    {
+        ReadCollection const *const single = dynamic_cast<ReadCollection const *>(Self(collection));
+        
+        if (!single)
+            throw std::runtime_error("not available");
+        
+        BAMFilePosTypeList units;
+        std::vector<double> weights;
+        
+        if (!single->file.getSampleUnits(units, weights))
+            throw std::runtime_error("a sample of '" + single->path + "' can't be drawn without its index or zone map");
+        if (count == 0 || (!want_primary && !want_secondary))
+            return new ReadCollection::AlignmentNone();
+        return new ReadCollection::AlignmentSample(single, want_primary, want_secondary, units, weights, count, seed);
+    }
+    
+    /* SlicePlan
+     *  what a slice of a reference of a single file would read
+     */
+    static NGS_BAM::SlicePlan SlicePlan(ngs::Reference const &reference, int64_t const start, uint64_t const length) {
+        NGS_Reference_v1 const *const obj = ReferenceAccess::CObject(reference);
+        ReadCollection::Reference const *const ref = ReadCollection::Reference::isAdapted(obj)
+            ? dynamic_cast<ReadCollection::Reference const *>(ngs_adapt::ReferenceItf::Self(obj)) : 0;
+        
+        if (!ref)
+            throw std::runtime_error("not available");
+        return ref->explainSlice(start, length);
+    }
+    
+    /* CoverageMapFile
+     *  the path and header of a collection of a single BAM file
+     */
+    static BAMFile const &CoverageMapFile(ngs::ReadCollection const &collection, std::string &path) {
+        ReadCollection const *const single = dynamic_cast<ReadCollection const *>(Self(collection));
+        
+        if (!single)
+            throw std::runtime_error("not available");
+        path = single->path;
+        return single->file;
+    }
+    
+    /* Coverage
+     *  the bins of the coverage map of a reference of a single file, if
+     *  it can answer
+     */
+    static bool Coverage(ngs::Reference const &reference, int64_t const start, uint64_t const length, uint64_t const resolution,
+                         uint32_t const flags, int32_t const map_qual, std::vector<NGS_BAM::CoverageBin> &bins)
+    {
+        NGS_Reference_v1 const *const obj = ReferenceAccess::CObject(reference);
+        ReadCollection::Reference const *const ref = ReadCollection::Reference::isAdapted(obj)
+            ? dynamic_cast<ReadCollection::Reference const *>(ngs_adapt::ReferenceItf::Self(obj)) : 0;
+        
+        return ref != 0 && ref->summarizeCoverage(start, length, resolution, flags, map_qual, bins);
+    }
+    
+    /* ProgramSlice
+     *  a slice of a reference of ours whose records are tested by "program"
+     */
+    static ngs_adapt::AlignmentItf *ProgramSlice(ngs::Reference const &reference, int64_t const start, uint64_t const length,
+                                                 uint32_t const flags, RecordProgram const &program)
+    {
+        NGS_Reference_v1 const *const obj = ReferenceAccess::CObject(reference);
+        ngs_adapt::ReferenceItf const *const itf = ReadCollection::Reference::isAdapted(obj) ? ngs_adapt::ReferenceItf::Self(obj) : 0;
+        
+        if (ReadCollection::Reference const *const single = dynamic_cast<ReadCollection::Reference const *>(itf))
+            return single->getSlice(start, length, flags, 0, &program);
+        if (MergedCollection::Reference const *const merged = dynamic_cast<MergedCollection::Reference const *>(itf))
+            return merged->getSlice(start, length, flags, 0, &program);
         throw std::runtime_error("not available");
     }
-    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary, bool const want_secondary) const {
-        return getAlignmentSlice(0, getLength(), want_primary, want_secondary);
+    
+    /* IntervalIndex
+     *  which interval the current alignment of getAlignmentSlices is for
+     */
+    static size_t IntervalIndex(ngs::Alignment const &alignment) {
+        NGS_Alignment_v1 const *const obj = AlignmentAccess::CObject(alignment);
+        ReadCollection::AlignmentIntervals const *const it = ReadCollection::AlignmentNone::isAdapted(obj)
+            ? dynamic_cast<ReadCollection::AlignmentIntervals const *>(ngs_adapt::AlignmentItf::Self(obj)) : 0;
+        
+        if (!it)
+            throw std::runtime_error("not available");
+        return it->getIntervalIndex();
+    }
+    
+    /* Followed
+     *  the index that an iterator of getAlignments of a followed file
+     *  keeps of what it has read, and how far that is
+     */
+    static BAMIndexBuilder const &Followed(ngs::Alignment const &alignment, NGS_BAM::FollowedProgress &progress) {
+        NGS_Alignment_v1 const *const obj = AlignmentAccess::CObject(alignment);
+        ReadCollection::Alignment const *const it = ReadCollection::AlignmentNone::isAdapted(obj)
+            ? dynamic_cast<ReadCollection::Alignment const *>(ngs_adapt::AlignmentItf::Self(obj)) : 0;
+        BAMFilePosType next;
+        BAMIndexBuilder const *const index = it ? it->getFollowed(progress.records, next, progress.complete) : 0;
+        
+        if (!index)
+            throw std::runtime_error("not available");
+        progress.position = next == BAMFilePosType(~(uint64_t)0) ? 0 : next.getValue();
+        return *index;
+    }
+    
+    /* Part
+     *  an alignment of ours, or the one of a single file that a merged
+     *  one is at; NULL for any other
+     */
+    static ReadCollection::AlignmentNone const *Part(ngs::Alignment const &alignment) {
+        NGS_Alignment_v1 const *const obj = AlignmentAccess::CObject(alignment);
+        
+        if (!ReadCollection::AlignmentNone::isAdapted(obj))
+            return 0;
+        
+        ngs_adapt::AlignmentItf const *const itf = ngs_adapt::AlignmentItf::Self(obj);
+        ReadCollection::AlignmentNone const *part = dynamic_cast<ReadCollection::AlignmentNone const *>(itf);
+        
+        if (!part) {
+            if (MergedCollection::Alignment const *const merged = dynamic_cast<MergedCollection::Alignment const *>(itf))
+                part = merged->getPart();
+        }
+        return part;
+    }
+    
+    /* ClippedBases, ClippedQualities
+     *  for getClippedFragmentBases and getClippedFragmentQualities
+     */
+    static void ClippedBases(ngs::Alignment const &alignment, bool const readOrientation, std::string &dst) {
+        ReadCollection::AlignmentNone const *const part = Part(alignment);
+        
+        if (!part)
+            throw std::runtime_error("not available");
+        part->getClippedBases(readOrientation, dst);
+    }
+    static void ClippedQualities(ngs::Alignment const &alignment, bool const readOrientation, std::string &dst) {
+        ReadCollection::AlignmentNone const *const part = Part(alignment);
+        
+        if (!part)
+            throw std::runtime_error("not available");
+        part->getClippedQualities(readOrientation, dst);
+    }
+    
+    /* RawQualities
+     *  for getRawQualities
+     */
+    static NGS_BAM::RawQualities RawQualities(ngs::Alignment const &alignment) {
+        ReadCollection::AlignmentNone const *const part = Part(alignment);
+        ReadCollection const *const collection = part ? part->getCollection() : 0;
+        
+        if (!collection)
+            throw std::runtime_error("not available");
+        collection->Need(NGS_BAM::OpenOptions::qualities);
+        
+        BAMRecord const *const rec = part->getRecord();
+        
+        if (!rec)
+            throw std::runtime_error("no current row");
+        
+        NGS_BAM::RawQualities const rslt = { rec->qual(), rec->hasQual() ? (size_t)rec->l_seq() : 0 };
+        return rslt;
+    }
+    
+    /* Record
+     *  the current record of an alignment of ours and its file, and
+     *  whether it was read with all its fields; NULL for any other
+     */
+    static BAMRecord const *Record(ngs::Alignment const &alignment, BAMFile const *&file, bool &complete) {
+        ReadCollection::AlignmentNone const *const part = Part(alignment);
+        
+        if (!part)
+            return 0;
+        
+        ReadCollection const *const collection = part->getCollection();
+        BAMRecord const *const rec = part->getRecord();
+        unsigned const all = NGS_BAM::OpenOptions::allFields;
+        
+        if (!collection || !rec)
+            return 0;
+        file = &collection->getFile();
+        complete = (collection->getFields() & all) == all;
+        return rec;
+    }
+};
+
+static void AppendLE32(std::string &dst, uint32_t const value)
+{
+    dst.push_back((char)(value & 0xFF));
+    dst.push_back((char)((value >> 8) & 0xFF));
+    dst.push_back((char)((value >> 16) & 0xFF));
+    dst.push_back((char)(value >> 24));
+}
+
+class NGS_BAM::Writer::Impl
+{
+    std::map<std::string, int32_t> refIDs;  /* the output's references by name */
+    BAMFile const *mapped;          /* the file refMap is for, if any */
+    std::vector<int32_t> refMap;    /* its reference IDs in the output */
+    bool identity;                  /* refMap changes nothing */
+    std::string raw;                /* an alignment made from NGS */
+    BAMRecordBuffer buffer;
+    
+    static void Header(ngs::ReadCollection const &like, std::string &text, BAMWriter::References &refs);
+    int32_t RefID(std::string const &name) const;
+    int32_t const *Map(BAMFile const &file);
+    void Encode(ngs::Alignment const &alignment, BAMRecord const *const rec, BAMFile const *const file);
+public:
+    BAMWriter *writer;
+    
+    Impl(std::string const &path, ngs::ReadCollection const &like, WriteOptions const &options);
+    ~Impl() {
+        delete writer;
+    }
+    void Write(ngs::Alignment const &alignment);
+};
+
+/* Header
+ *  that of "like"'s BAM file if it has one, else made from its references
+ *  and read groups
+ */
+void NGS_BAM::Writer::Impl::Header(ngs::ReadCollection const &like, std::string &text, BAMWriter::References &refs)
+{
+    if (BAMFile const *const file = EngineAccess::File(like)) {
+        text = file->getHeaderText();
+        for (unsigned i = 0; i < file->countOfReferences(); ++i) {
+            HeaderRefInfo const &ri = file->getRefInfo(i);
+            refs.push_back(std::make_pair(ri.getNameString(), (uint32_t)ri.getLength()));
+        }
+        return;
+    }
+    
+    text = "@HD\tVN:1.6\tSO:unknown\n";
+    
+    ngs::ReferenceIterator it = like.getReferences();
+    
+    while (it.nextReference()) {
+        std::string const name = it.getCommonName();
+        uint64_t const length = it.getLength();
+        char buf[32];
+        
+        text += "@SQ\tSN:" + name + "\tLN:";
+        text.append(buf, snprintf(buf, sizeof(buf), "%lu\n", (unsigned long)length));
+        refs.push_back(std::make_pair(name, (uint32_t)length));
+    }
+    try {
+        ngs::ReadGroupIterator groups = like.getReadGroups();
+        
+        while (groups.nextReadGroup()) {
+            std::string const name = groups.getName();
+            
+            if (!name.empty())
+                text += "@RG\tID:" + name + "\n";
+        }
+    }
+    catch (ngs::ErrorMsg const &) {
+        /* a collection without read groups */
+    }
+}
+
+NGS_BAM::Writer::Impl::Impl(std::string const &path, ngs::ReadCollection const &like, WriteOptions const &options)
+: mapped(0)
+, identity(false)
+, writer(0)
+{
+    std::string text;
+    BAMWriter::References refs;
+    
+    Header(like, text, refs);
+    for (unsigned i = 0; i < refs.size(); ++i)
+        refIDs.insert(std::make_pair(refs[i].first, (int32_t)i));
+    writer = new BAMWriter(path, text, refs, options.threads, options.level, options.buildIndex);
+}
+
+int32_t NGS_BAM::Writer::Impl::RefID(std::string const &name) const
+{
+    std::map<std::string, int32_t>::const_iterator const i = refIDs.find(name);
+    
+    if (i == refIDs.end())
+        throw std::runtime_error("reference '" + name + "' is not in the header");
+    return i->second;
+}
+
+/* Map
+ *  the reference IDs of "file" in the output, NULL if they are the same;
+ *  references the output doesn't have get an ID the writer rejects
+ */
+int32_t const *NGS_BAM::Writer::Impl::Map(BAMFile const &file)
+{
+    if (mapped != &file) {
+        unsigned const n = file.countOfReferences();
+        
+        refMap.resize(n);
+        identity = n <= refIDs.size();
+        for (unsigned i = 0; i < n; ++i) {
+            std::map<std::string, int32_t>::const_iterator const j = refIDs.find(file.getRefInfo(i).getNameString());
+            
+            refMap[i] = j != refIDs.end() ? j->second : INT32_MAX;
+            if (refMap[i] != (int32_t)i)
+                identity = false;
+        }
+        mapped = &file;
+    }
+    return identity ? 0 : &refMap[0];
+}
+
+/* Encode
+ *  a BAM record from what ngs::Alignment gives: flags for the strand,
+ *  secondary alignments and the mate, whose position is looked up;
+ *  a mate without a reference is taken to be unmapped
+ *  the qualities are phred+33, as NGS returns them
+ *  a record of ours that wasn't read in full, "rec" of "file", still has
+ *  its fixed part, so the flags and the mate come from there instead
+ */
+void NGS_BAM::Writer::Impl::Encode(ngs::Alignment const &alignment, BAMRecord const *const rec, BAMFile const *const file)
+{
+    static char const opcodes[] = "MIDNSHP=X";
+    static char const seqcodes[] = "=ACMGRSVTWYHKDBN";
+    
+    std::string const name = alignment.getReadId().toString();
+    std::string const cigar = alignment.getLongCigar(false).toString();
+    std::string const bases = alignment.getFragmentBases().toString();
+    std::string const quals = alignment.getFragmentQualities().toString();
+    int32_t const refID = RefID(alignment.getReferenceSpec());
+    int32_t const pos = (int32_t)alignment.getAlignmentPosition();
+    int const mapq = alignment.getMappingQuality();
+    bool const reversed = alignment.getIsReversedOrientation();
+    unsigned flag = reversed ? 0x0010 : 0;
+    int32_t next_refID = -1;
+    int32_t next_pos = -1;
+    int32_t tlen = 0;
+    
+    if (name.size() > 254)
+        throw std::runtime_error("read name '" + name + "' is too long for BAM");
+    if (rec) {
+        int32_t const *const map = Map(*file);
+        
+        flag = rec->flag();
+        next_refID = rec->next_refID();
+        if (map && next_refID >= 0)
+            next_refID = map[next_refID];
+        next_pos = rec->next_pos();
+        tlen = rec->tlen();
+    }
+    else if (alignment.getAlignmentCategory() == ngs::Alignment::secondaryAlignment)
+        flag |= 0x0100;
+    if (!rec && alignment.hasMate()) {
+        flag |= 0x0001;
+        if (alignment.getMateIsReversedOrientation())
+            flag |= 0x0020;
+        std::string const mateSpec = alignment.getMateReferenceSpec();
+        
+        if (mateSpec.empty())
+            flag |= 0x0008;
+        else try {
+            next_refID = RefID(mateSpec);
+            next_pos = (int32_t)alignment.getMateAlignment().getAlignmentPosition();
+            
+            /* some engines give the length without its sign */
+            tlen = (int32_t)alignment.getTemplateLength();
+            if (tlen > 0 && (next_pos < pos || (next_pos == pos && reversed)))
+                tlen = -tlen;
+        }
+        catch (ngs::ErrorMsg const &) {
+            /* the mate isn't there after all */
+            flag |= 0x0008;
+            next_refID = next_pos = -1;
+            tlen = 0;
+        }
     }
-    ngs_adapt::AlignmentItf *getAlignmentSlice(int64_t const Start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
-        if (state == 2)
-            throw std::runtime_error("no current row");
+    
+    std::vector<uint32_t> ops;
+    unsigned refLen = 0;
+    
+    for (size_t i = 0; i < cigar.size(); ) {
+        uint32_t len = 0;
         
-        HeaderRefInfo const &ri = parent->getRefInfo(cur);
-        unsigned const len = ri.getLength();
-        if (Start >= len)
-            return new ReadCollection::AlignmentNone();
+        while (i < cigar.size() && cigar[i] >= '0' && cigar[i] <= '9')
+            len = len * 10 + (cigar[i++] - '0');
         
-        unsigned const start = Start < 0 ? 0 : Start;
-        uint64_t const End = (Start < 0 ? 0 : Start) + length;
-        unsigned const end = End > len ? len : End;
-        BAMFilePosTypeList const &slice = ri.slice(start, end);
+        char const *const op = i < cigar.size() ? strchr(opcodes, cigar[i++]) : 0;
         
-        if (slice.size() == 0)
-            return new ReadCollection::AlignmentNone();
-
-        return new ReadCollection::AlignmentSlice(parent, want_primary, want_secondary,
-                                                  slice, start, end);
-    }
-    ngs_adapt::PileupItf *getPileups(bool const want_primary, bool const want_secondary) const {
-        throw std::runtime_error("not available");
-    }
-    ngs_adapt::PileupItf *getFilteredPileups(uint32_t flags, int32_t map_qual) const {
-        throw std::runtime_error("not available");
-    }
-    ngs_adapt::PileupItf *getPileupSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
-        throw std::runtime_error("not available");
+        if (op == 0 || *op == '\0')
+            throw std::runtime_error("CIGAR '" + cigar + "' is not valid");
+        
+        uint32_t const code = (uint32_t)(op - opcodes);
+        
+        if (code == 0 || code == 2 || code == 3 || code == 7 || code == 8)
+            refLen += len;
+        ops.push_back((len << 4) | code);
     }
-    ngs_adapt::PileupItf *getFilteredPileupSlice(int64_t const start, uint64_t const length, uint32_t flags, int32_t map_qual) const {
-        throw std::runtime_error("not available");
+    
+    int32_t const end = pos + (refLen > 0 ? refLen : 1);
+    uint32_t const bin = BAMIndexBuilder::Bin(pos, end);
+    
+    raw.clear();
+    AppendLE32(raw, (uint32_t)refID);
+    AppendLE32(raw, (uint32_t)pos);
+    AppendLE32(raw, (bin << 16) | ((mapq < 0 ? 0 : mapq > 255 ? 255 : mapq) << 8) | (uint32_t)(name.size() + 1));
+    AppendLE32(raw, (flag << 16) | (uint32_t)ops.size());
+    AppendLE32(raw, (uint32_t)bases.size());
+    AppendLE32(raw, (uint32_t)next_refID);
+    AppendLE32(raw, (uint32_t)next_pos);
+    AppendLE32(raw, (uint32_t)tlen);
+    raw.append(name.c_str(), name.size() + 1);
+    for (unsigned i = 0; i < ops.size(); ++i)
+        AppendLE32(raw, ops[i]);
+    for (size_t i = 0; i < bases.size(); i += 2) {
+        char const *const hi = strchr(seqcodes, toupper(bases[i]));
+        char const *const lo = i + 1 < bases.size() ? strchr(seqcodes, toupper(bases[i + 1])) : seqcodes;
+        unsigned const h = hi && *hi ? (unsigned)(hi - seqcodes) : 15;
+        unsigned const l = lo && *lo ? (unsigned)(lo - seqcodes) : 15;
+        
+        raw.push_back((char)((h << 4) | l));
     }
-    bool nextReference() {
-        switch (state) {
-            case 0:
-                if (cur < max) {
-                    state = 1;
-                    return true;
-                }
-                else {
-                    state = 2;
-                    return false;
-                }
-            case 1:
-                ++cur;
-                if (cur < max)
-                    return true;
-                state = 2;
-            case 2:
-                return false;
-            default:
-                throw std::runtime_error("no more rows available");
-        }
+    for (size_t i = 0; i < bases.size(); ++i)
+        raw.push_back(quals.size() == bases.size() ? (char)(quals[i] - 33) : (char)0xFF);
+    
+    std::string group;
+    
+    if (alignment.tryGetReadGroup(group) && !group.empty()) {
+        raw.append("RGZ", 3);
+        raw.append(group.c_str(), group.size() + 1);
     }
-};
+    
+    SizedRawData *const dst = buffer.Reserve((uint32_t)raw.size());
+    
+    memcpy(dst->data, raw.data(), raw.size());
+}
 
-ngs_adapt::StringItf *ReadCollection::getName() const
+void NGS_BAM::Writer::Impl::Write(ngs::Alignment const &alignment)
 {
-    unsigned const sep = path.rfind('/');
+    BAMFile const *file = 0;
+    bool complete = false;
+    BAMRecord const *const rec = EngineAccess::Record(alignment, file, complete);
     
-    if (sep == path.npos)
-        return new ngs_adapt::StringItf(path.data(), path.size());
-    else {
-        char const *name = path.data() + sep + 1;
-        unsigned const len = path.size() - sep - 1;
-        return new ngs_adapt::StringItf(name, len);
+    if (rec && complete) {
+        writer->Write(*rec, Map(*file));
+        return;
     }
+    Encode(alignment, rec, file);
+    writer->Write(*buffer.record());
 }
 
-ngs_adapt::ReadGroupItf *ReadCollection::getReadGroups() const
+NGS_BAM::Writer::Writer(std::string const &path, ngs::ReadCollection const &like, WriteOptions const &options)
+: impl(new Impl(path, like, options))
 {
-    throw std::logic_error("unimplemented");
 }
 
-bool ReadCollection::hasReadGroup(char const spec[]) const
+NGS_BAM::Writer::~Writer()
 {
-    return false;
+    delete impl;
 }
 
-ngs_adapt::ReadGroupItf *ReadCollection::getReadGroup(char const spec[]) const
+void NGS_BAM::Writer::write(ngs::Alignment const &alignment)
 {
-    throw std::logic_error("unimplemented");
+    impl->Write(alignment);
 }
 
-ngs_adapt::ReferenceItf *ReadCollection::getReferences() const
+void NGS_BAM::Writer::close()
 {
-    return new Reference(this, 0, file.countOfReferences(), 0);
+    impl->writer->Close();
 }
 
-bool ReadCollection::hasReference(char const spec[]) const
+static void AddMemoryUse(NGS_BAM::MemoryUse &use, MemoryLedger const &ledger)
 {
-    int const i = file.getReferenceIndexByName(spec);
-    return i >= 0;
+    use.ioBuffers += ledger.Get(MemoryLedger::ioBuffers);
+    use.inflateQueue += ledger.Get(MemoryLedger::inflateQueue);
+    use.blockCache += ledger.Get(MemoryLedger::blockCache);
+    use.remoteWindows += ledger.Get(MemoryLedger::remoteWindows);
+    use.index += ledger.Get(MemoryLedger::index);
+    use.header += ledger.Get(MemoryLedger::header);
+    use.mateBuffer += ledger.Get(MemoryLedger::mateBuffer);
+    use.regionCache += ledger.Get(MemoryLedger::regionCache);
+    use.total += ledger.Total();
 }
 
-ngs_adapt::ReferenceItf *ReadCollection::getReference(char const spec[]) const
+NGS_BAM::MemoryUse NGS_BAM::getMemoryUse()
 {
-    int const i = file.getReferenceIndexByName(spec);
+    MemoryUse use = MemoryUse();
     
-    if (i < 0)
-        return NULL;
-    else
-        return new Reference(this, i, 0, 3);
+    AddMemoryUse(use, MemoryLedger::Process());
+    return use;
 }
 
-ngs_adapt::AlignmentItf *ReadCollection::getAlignment(char const spec[]) const
+NGS_BAM::MemoryUse NGS_BAM::getMemoryUse(ngs::ReadCollection const &collection)
 {
-    throw std::logic_error("unimplemented");
+    std::vector<BAMFile const *> const files = EngineAccess::Files(collection);
+    MemoryUse use = MemoryUse();
+    
+    if (files.empty())
+        throw std::runtime_error("not available");
+    for (size_t i = 0; i < files.size(); ++i)
+        AddMemoryUse(use, files[i]->getMemory());
+    return use;
 }
 
-ngs_adapt::AlignmentItf *ReadCollection::getAlignments(bool const want_primary,
-                                                       bool const want_secondary) const
+void NGS_BAM::setMemoryBudget(uint64_t const bytes)
 {
-    if (!want_secondary && !want_primary)
-        return new AlignmentNone();
-    const_cast<BAMFile *>(&file)->Rewind();
-    return new Alignment(this, want_primary, want_secondary);
+    MemoryLedger::SetBudget(bytes);
 }
 
-uint64_t ReadCollection::getAlignmentCount(bool const want_primary,
-                                           bool const want_secondary) const
+uint64_t NGS_BAM::getMemoryBudget()
 {
-    throw std::logic_error("unimplemented");
+    return MemoryLedger::Budget();
 }
 
-ngs_adapt::AlignmentItf *ReadCollection::getAlignmentRange(uint64_t const first,
-                                                           uint64_t const count,
-                                                           bool const want_primary,
-                                                           bool const want_secondary ) const
+bool NGS_BAM::traceCompiled()
 {
-    throw std::logic_error("unimplemented");
+    return Trace::Compiled();
 }
 
-uint64_t ReadCollection::getReadCount(bool const want_full,
-                                      bool const want_partial,
-                                      bool const want_unaligned) const
+void NGS_BAM::enableTrace(bool const on)
 {
-    throw std::logic_error("unimplemented");
+    Trace::Enable(on);
 }
 
-ngs_adapt::ReadItf *ReadCollection::getRead(char const spec[]) const
+void NGS_BAM::writeTrace(std::string const &path)
 {
-    throw std::logic_error("unimplemented");
+    FILE *const out = fopen(path.c_str(), "a");
+    
+    if (out == 0)
+        throw std::runtime_error("can't open trace file '" + path + "'");
+    Trace::Export(out, ftell(out) == 0);
+    fclose(out);
 }
 
-ngs_adapt::ReadItf *ReadCollection::getReads(bool const want_full,
-                                             bool const want_partial,
-                                             bool const want_unaligned) const
+ngs::ReadIterator NGS_BAM::getUnplacedReads(ngs::ReadCollection const &collection)
 {
-    throw std::logic_error("unimplemented");
+    ngs_adapt::ReadItf *const self = EngineAccess::UnplacedReads(collection);
+    NGS_Read_v1 *const c_obj = self->Cast();
+    ngs::ReadItf *const ngs_itf = ngs::ReadItf::Cast(c_obj);
+    
+    return ngs::ReadIterator((ngs::ReadRef)ngs_itf);
 }
 
-ngs_adapt::ReadItf *ReadCollection::getReadRange(uint64_t const first,
-                                                 uint64_t const count,
-                                                 bool const want_full,
-                                                 bool const want_partial,
-                                                 bool const want_unaligned) const
+NGS_BAM::SortOrder NGS_BAM::getSortOrder(ngs::ReadCollection const &collection)
 {
-    throw std::logic_error("unimplemented");
+    BAMFile const *const file = EngineAccess::File(collection);
+    
+    if (!file)
+        throw std::runtime_error("not available");
+    return file->getSortOrder();
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getFragmentBases(uint64_t const Offset, uint64_t const Length) const
+std::vector<NGS_BAM::Interval> NGS_BAM::readBED(std::string const &path)
 {
-    uint64_t const End = Offset + Length;
-    unsigned const seqLen = current->l_seq();
-    unsigned const offset = Offset < seqLen ? Offset : seqLen;
-    unsigned const seqEnd = End < seqLen ? End : seqLen;
+    FILE *const fp = fopen(path.c_str(), "r");
+    
+    if (!fp)
+        throw std::runtime_error("can't open BED file '" + path + "'");
+    
+    std::vector<Interval> rslt;
+    std::string line;
+    unsigned lineNo = 0;
+    int ch;
     
-    seqBuffer.resize(0);
-    seqBuffer.reserve(seqLen);
+    do {
+        ch = fgetc(fp);
+        if (ch != '\n' && ch != EOF) {
+            line += (char)ch;
+            continue;
+        }
+        ++lineNo;
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.resize(line.size() - 1);
+        if (line.empty() || line[0] == '#' || line.compare(0, 5, "track") == 0 || line.compare(0, 7, "browser") == 0) {
+            line.clear();
+            continue;
+        }
+        
+        size_t const tab = line.find_first_of(" \t");
+        unsigned long long start, end;
+        
+        if (tab == 0 || tab == line.npos ||
+            sscanf(line.c_str() + tab, "%llu %llu", &start, &end) != 2 || end < start)
+        {
+            fclose(fp);
+            
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%u", lineNo);
+            throw std::runtime_error("line " + std::string(buf) + " of BED file '" + path + "' is malformed");
+        }
+        rslt.push_back(Interval(line.substr(0, tab), start, end));
+        line.clear();
+    } while (ch != EOF);
     
-    for (unsigned i = offset; i < seqEnd; ++i)
-        seqBuffer.append(1, current->seq(i));
+    fclose(fp);
+    return rslt;
+}
+
+ngs::Statistics NGS_BAM::computeFlagStats(ngs::ReadCollection const &collection)
+{
+    ngs_adapt::StatisticsItf *const self = EngineAccess::FlagStats(collection);
+    NGS_Statistics_v1 *const c_obj = self->Cast();
+    ngs::StatisticsItf *const ngs_itf = ngs::StatisticsItf::Cast(c_obj);
     
-    return new ngs_adapt::StringItf(seqBuffer.data(), seqBuffer.size());
+    return ngs::Statistics((ngs::StatisticsRef)ngs_itf);
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getFragmentQualities(uint64_t const Offset, uint64_t const Length) const
+NGS_BAM::Histograms::Histograms(HistogramSpec const &spec)
+: tlenBin(spec.tlenBin > 0 ? spec.tlenBin : 1)
+, alignments(0)
+, templateLength(spec.tlenBins > 0 ? spec.tlenBins : 1)
+, mappingQuality(256)
+, alignedLength(spec.lengthBins > 0 ? spec.lengthBins : 1)
+, softClipLength(spec.lengthBins > 0 ? spec.lengthBins : 1)
 {
-    uint64_t const End = Offset + Length;
-    unsigned const seqLen = current->l_seq();
-    unsigned const offset = Offset < seqLen ? Offset : seqLen;
-    unsigned const seqEnd = End < seqLen ? End : seqLen;
-    bool notFF = false;
-    uint8_t const *qual = current->qual();
+}
+
+void NGS_BAM::Histograms::merge(Histograms const &other)
+{
+    if (other.tlenBin != tlenBin || other.templateLength.size() != templateLength.size() ||
+        other.alignedLength.size() != alignedLength.size())
+    {
+        throw std::runtime_error("histograms of different bins can't be merged");
+    }
+    alignments += other.alignments;
+    for (size_t i = 0; i < templateLength.size(); ++i)
+        templateLength[i] += other.templateLength[i];
+    for (size_t i = 0; i < mappingQuality.size(); ++i)
+        mappingQuality[i] += other.mappingQuality[i];
+    for (size_t i = 0; i < alignedLength.size(); ++i) {
+        alignedLength[i] += other.alignedLength[i];
+        softClipLength[i] += other.softClipLength[i];
+    }
+}
+
+// the bin of "value", the last having all those past it
+static size_t Bin(uint64_t const value, size_t const bins)
+{
+    return value < bins ? (size_t)value : bins - 1;
+}
+
+NGS_BAM::Histograms NGS_BAM::computeHistograms(ngs::Reference const &reference, int64_t const start, uint64_t const length,
+                                               HistogramSpec const &spec)
+{
+    uint32_t const flags = ((spec.categories & ngs::Alignment::primaryAlignment) != 0 ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                         | ((spec.categories & ngs::Alignment::secondaryAlignment) != 0 ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                         | NGS_ReferenceAlignFlags_pass_bad | NGS_ReferenceAlignFlags_pass_dups;
+    ngs_adapt::AlignmentItf *const self = EngineAccess::Slice(reference, start, length, flags);
+    NGS_Alignment_v1 *const c_obj = self->Cast();
+    ngs::AlignmentItf *const ngs_itf = ngs::AlignmentItf::Cast(c_obj);
+    ngs::AlignmentIterator alignments((ngs::AlignmentRef)ngs_itf);
     
-    qualBuffer.resize(0);
-    qualBuffer.reserve(seqLen);
+    return computeHistograms(alignments, spec);
+}
+
+NGS_BAM::Histograms NGS_BAM::computeHistograms(ngs::AlignmentIterator &alignments, HistogramSpec const &spec)
+{
+    Histograms rslt(spec);
     
-    for (unsigned i = offset; i < seqEnd; ++i) {
-        int const qv = qual[i];
+    while (alignments.nextAlignment()) {
+        BAMFile const *file;
+        bool complete;
+        BAMRecord const *const rec = EngineAccess::Record(alignments, file, complete);
+        
+        if (!rec)
+            throw std::runtime_error("not available");
         
-        notFF |= (qv != 0xFF);
-        qualBuffer.append(1, (char)((qv > 63 ? 63 : qv) + 33));
+        unsigned const flag = rec->flag();
+        unsigned const nc = rec->nc();
+        unsigned soft = 0;
+        
+        for (unsigned i = 0; i < nc; ++i) {
+            uint32_t const op = rec->cigar(i);
+            
+            if ((op & 0xF) == 4)
+                soft += op >> 4;
+        }
+        ++rslt.alignments;
+        ++rslt.mappingQuality[rec->mq()];
+        ++rslt.alignedLength[Bin(rec->refLen(), rslt.alignedLength.size())];
+        ++rslt.softClipLength[Bin(soft, rslt.softClipLength.size())];
+        if ((flag & 0x0909) == 0x0001 && rec->next_refID() == rec->refID() && rec->tlen() > 0)
+            ++rslt.templateLength[Bin((uint64_t)rec->tlen() / rslt.tlenBin, rslt.templateLength.size())];
     }
-    return new ngs_adapt::StringItf(qualBuffer.data(), notFF ? qualBuffer.size() : 0);
+    return rslt;
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getReferenceSpec() const
+ngs::AlignmentIterator NGS_BAM::sampleAlignments(ngs::ReadCollection const &collection, uint64_t const count, uint64_t const seed,
+                                                 ngs::Alignment::AlignmentCategory const categories)
 {
-    int const refID = current->refID();
-    HeaderRefInfo const &ri = parent->getRefInfo(refID);
-    std::string const &RNAME = ri.getName();
-    return new ngs_adapt::StringItf(RNAME.data(), RNAME.size());
+    bool const want_primary = (categories & ngs::Alignment::primaryAlignment) != 0;
+    bool const want_secondary = (categories & ngs::Alignment::secondaryAlignment) != 0;
+    ngs_adapt::AlignmentItf *const self = EngineAccess::AlignmentSample(collection, count, seed, want_primary, want_secondary);
+    NGS_Alignment_v1 *const c_obj = self->Cast();
+    ngs::AlignmentItf *const ngs_itf = ngs::AlignmentItf::Cast(c_obj);
+    
+    return ngs::AlignmentIterator((ngs::AlignmentRef)ngs_itf);
 }
 
-int32_t ReadCollection::Alignment::getMappingQuality() const
+ngs::AlignmentIterator NGS_BAM::getAlignmentSlices(ngs::ReadCollection const &collection,
+                                                   std::vector<Interval> const &intervals,
+                                                   ngs::Alignment::AlignmentCategory const categories)
 {
-    return current->mq();
+    bool const want_primary = (categories & ngs::Alignment::primaryAlignment) != 0;
+    bool const want_secondary = (categories & ngs::Alignment::secondaryAlignment) != 0;
+    ngs_adapt::AlignmentItf *const self = EngineAccess::AlignmentSlices(collection, intervals, want_primary, want_secondary);
+    NGS_Alignment_v1 *const c_obj = self->Cast();
+    ngs::AlignmentItf *const ngs_itf = ngs::AlignmentItf::Cast(c_obj);
+    
+    return ngs::AlignmentIterator((ngs::AlignmentRef)ngs_itf);
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getReadGroup() const
+size_t NGS_BAM::getIntervalIndex(ngs::Alignment const &alignment)
+{
+    return EngineAccess::IntervalIndex(alignment);
+}
+
+void NGS_BAM::willNeed(ngs::ReadCollection const &collection, std::vector<Interval> const &intervals)
+{
+    EngineAccess::WillNeed(collection, intervals);
+}
+
+NGS_BAM::SlicePlan NGS_BAM::explainSlice(ngs::Reference const &reference, int64_t const start, uint64_t const length)
+{
+    return EngineAccess::SlicePlan(reference, start, length);
+}
+
+/* CoverageFlags
+ *  the NGS_ReferenceAlignFlags that ngs::Reference::getCoverage would
+ *  give the engine for "spec", and the mapping quality it would matter
+ *  with, 0 if it doesn't
+ */
+static uint32_t CoverageFlags(NGS_BAM::CoverageSpec const &spec, int32_t &map_qual)
+{
+    uint32_t const categories = spec.categories != 0 ? (uint32_t)spec.categories : (uint32_t)ngs::Alignment::primaryAlignment;
+    uint32_t const filters = (uint32_t)spec.filters & (ngs::Alignment::passFailed | ngs::Alignment::passDuplicates |
+                                                       ngs::Alignment::minMapQuality | ngs::Alignment::maxMapQuality);
+    
+    map_qual = (filters & (ngs::Alignment::minMapQuality | ngs::Alignment::maxMapQuality)) != 0 ? spec.mappingQuality : 0;
+    return categories | (filters << 2);
+}
+
+/* the positions of coverage counted at once */
+static uint64_t const COVERAGE_WINDOW = (uint64_t)1 << 20;
+
+bool NGS_BAM::buildCoverageMap(ngs::ReadCollection const &collection, CoverageSpec const &spec)
 {
-    for (BAMRecord::OptionalField::const_iterator i = current->begin(); i != current->end(); ++i) {
-        char const *tag = i->getTag();
-        if (tag[0] == 'R' && tag[1] == 'G' && i->getValueType() == 'Z') {
-            return new ngs_adapt::StringItf(i->getRawValue(), i->getElementSize());
+    TRACE_SPAN("NGS_BAM::buildCoverageMap");
+    std::string path;
+    BAMFile const &file = EngineAccess::CoverageMapFile(collection, path);
+    unsigned const n = file.countOfReferences();
+    std::vector<uint64_t> lengths(n);
+    int32_t map_qual;
+    uint32_t const flags = CoverageFlags(spec, map_qual);
+    CoverageMap::Writer writer;
+    
+    for (unsigned i = 0; i < n; ++i)
+        lengths[i] = file.getRefInfo(i).getLength();
+    if (!writer.Open(path, lengths, flags, map_qual))
+        return false;
+    for (unsigned i = 0; i < n; ++i) {
+        ngs::Reference const reference = collection.getReference(file.getRefInfo(i).getNameString());
+        
+        for (uint64_t pos = 0; pos < lengths[i]; pos += COVERAGE_WINDOW) {
+            std::vector<uint32_t> const depth = reference.getCoverage((int64_t)pos, COVERAGE_WINDOW, spec.categories,
+                                                                      spec.filters, spec.mappingQuality);
+            
+            if (!depth.empty())
+                writer.Add(&depth[0], depth.size());
         }
     }
-    return NULL;
+    return writer.Commit();
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getReadId() const
+std::vector<NGS_BAM::CoverageBin> NGS_BAM::summarizeCoverage(ngs::Reference const &reference, int64_t const start, uint64_t const length,
+                                                             uint64_t const resolution, CoverageSpec const &spec)
 {
-    char const *const QNAME = current->readname();
-    size_t const len = strnlen(QNAME, current->l_read_name());
-    return new ngs_adapt::StringItf(QNAME, len);
+    std::vector<CoverageBin> bins;
+    int32_t map_qual;
+    uint32_t const flags = CoverageFlags(spec, map_qual);
+    
+    if (resolution == 0)
+        throw std::runtime_error("a coverage summary needs bins at least a position wide");
+    if (start < 0)
+        throw std::runtime_error("the window starts before the reference");
+    if (EngineAccess::Coverage(reference, start, length, resolution, flags, map_qual, bins))
+        return bins;
+    
+    uint64_t end = reference.getLength();
+    
+    if ((uint64_t)start >= end)
+        return bins;
+    if (length < end - start)
+        end = start + length;
+    
+    uint64_t sum = 0;
+    CoverageBin open = { start, 0, 0, ~(uint32_t)0, 0 };
+    
+    for (uint64_t pos = start; pos < end; ) {
+        uint64_t const window = std::min(COVERAGE_WINDOW, end - pos);
+        std::vector<uint32_t> const depth = reference.getCoverage((int64_t)pos, window, spec.categories,
+                                                                  spec.filters, spec.mappingQuality);
+        
+        if (depth.size() != window)
+            throw std::runtime_error("the coverage of the window is short");
+        for (size_t i = 0; i < depth.size(); ++i) {
+            uint32_t const d = depth[i];
+            
+            sum += d;
+            open.min = std::min(open.min, d);
+            open.max = std::max(open.max, d);
+            if (++open.length == resolution || pos + i + 1 == end) {
+                open.mean = (double)sum / open.length;
+                bins.push_back(open);
+                open.start += open.length;
+                open.length = 0;
+                open.min = ~(uint32_t)0;
+                open.max = 0;
+                sum = 0;
+            }
+        }
+        pos += window;
+    }
+    return bins;
 }
 
-bool ReadCollection::Alignment::isPrimary() const
+class NGS_BAM::RecordFilter::Impl
 {
-    return (current->flag() & 0x0900) == 0;
-}
+public:
+    RecordProgram program;
+    
+    explicit Impl(std::string const &expression) : program(expression) {}
+};
 
-int64_t ReadCollection::Alignment::getAlignmentPosition() const
+/* AlignmentSource
+ *  the fields and tags of an alignment of any engine, as far as its
+ *  messages tell
+ */
+class AlignmentSource : public RecordProgram::Source
+{
+    typedef RecordProgram::Value Value;
+    
+    ngs::Alignment const &alignment;
+    mutable std::deque<std::string> strings;    /* that the values point into */
+    
+    static Value Integer(int64_t const i) {
+        Value const v = { Value::integer, i, 0, 0, 0 };
+        return v;
+    }
+public:
+    explicit AlignmentSource(ngs::Alignment const &Alignment) : alignment(Alignment) {}
+    
+    Value getField(RecordProgram::Field const what) const {
+        switch (what) {
+        case RecordProgram::flag: {
+            int flag = 0;
+            
+            if (alignment.hasMate()) {
+                flag |= 0x0001;
+                if (alignment.getMateIsReversedOrientation())
+                    flag |= 0x0020;
+            }
+            if (alignment.getIsReversedOrientation())
+                flag |= 0x0010;
+            if (alignment.getAlignmentCategory() == ngs::Alignment::secondaryAlignment)
+                flag |= 0x0100;
+            return Integer(flag);
+        }
+        case RecordProgram::mapq: return Integer(alignment.getMappingQuality());
+        case RecordProgram::pos:  return Integer(alignment.getAlignmentPosition());
+        case RecordProgram::tlen: return Integer(alignment.getTemplateLength());
+        case RecordProgram::rlen: return Integer(alignment.getFragmentBases().size());
+        case RecordProgram::alen: return Integer(alignment.getAlignmentLength());
+        default:
+            return Value();
+        }
+    }
+    Value getTag(char const tag[2]) const {
+        ngs::String const name(tag, 2);
+        Value v = { Value::none, 0, 0, 0, 0 };
+        
+        if (!alignment.hasTag(name))
+            return v;
+        try {
+            return Integer(alignment.getTagInt(name));
+        }
+        catch (ngs::ErrorMsg const &) {}
+        try {
+            v.d = alignment.getTagFloat(name);
+            v.kind = Value::real;
+            return v;
+        }
+        catch (ngs::ErrorMsg const &) {}
+        try {
+            strings.push_back(alignment.getTagString(name));
+            v.kind = Value::string;
+            v.s = strings.back().data();
+            v.n = strings.back().size();
+        }
+        catch (ngs::ErrorMsg const &) {}
+        return v;
+    }
+};
+
+NGS_BAM::RecordFilter::RecordFilter(std::string const &expression)
+: impl(new Impl(expression))
 {
-    return current->pos();
 }
 
-uint64_t ReadCollection::Alignment::getAlignmentLength() const {
-    return current->refLen();
+NGS_BAM::RecordFilter::RecordFilter(RecordFilter const &filter)
+: impl(new Impl(*filter.impl))
+{
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getCigar(bool const clipped, char const OPCODE[]) const
+NGS_BAM::RecordFilter &NGS_BAM::RecordFilter::operator =(RecordFilter const &filter)
 {
-    current->cigarString(cigarBuffer, clipped, OPCODE);
-    return new ngs_adapt::StringItf(cigarBuffer.data(), cigarBuffer.size());
+    impl->program = filter.impl->program;
+    return *this;
 }
 
-bool ReadCollection::Alignment::getIsReversedOrientation() const
+NGS_BAM::RecordFilter::~RecordFilter()
 {
-    return (current->flag() & 0x0010) != 0;
+    delete impl;
 }
 
-// TODO: return type should be int64_t
-uint64_t ReadCollection::Alignment::getTemplateLength() const
+bool NGS_BAM::RecordFilter::accepts(ngs::Alignment const &alignment) const
 {
-    return current->tlen();
+    return impl->program.Accepts(AlignmentSource(alignment));
 }
 
-bool ReadCollection::Alignment::hasMate() const
+ngs::AlignmentIterator NGS_BAM::getAlignmentSlice(ngs::Reference const &reference,
+                                                  int64_t const start, uint64_t const length,
+                                                  RecordFilter const &filter,
+                                                  ngs::Alignment::AlignmentCategory const categories)
 {
-    int const FLAG = current->flag();
+    uint32_t const flags = ((categories & ngs::Alignment::primaryAlignment) != 0 ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                         | ((categories & ngs::Alignment::secondaryAlignment) != 0 ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                         | NGS_ReferenceAlignFlags_pass_bad
+                         | NGS_ReferenceAlignFlags_pass_dups;
+    ngs_adapt::AlignmentItf *const self = EngineAccess::ProgramSlice(reference, start, length, flags, filter.impl->program);
+    NGS_Alignment_v1 *const c_obj = self->Cast();
+    ngs::AlignmentItf *const ngs_itf = ngs::AlignmentItf::Cast(c_obj);
+    
+    return ngs::AlignmentIterator((ngs::AlignmentRef)ngs_itf);
+}
 
-    return (FLAG & 0x0001) != 0 && (FLAG & 0x00C0) != 0 && (FLAG & 0x00C0) != 0x00C0;
+NGS_BAM::FollowedProgress NGS_BAM::getFollowedProgress(ngs::AlignmentIterator const &alignments)
+{
+    FollowedProgress progress;
+    
+    EngineAccess::Followed(alignments, progress);
+    return progress;
 }
 
-ngs_adapt::StringItf *ReadCollection::Alignment::getMateReferenceSpec() const
+void NGS_BAM::saveFollowedIndex(ngs::AlignmentIterator const &alignments, std::string const &indexPath)
 {
-    int const refID = current->next_refID();
+    FollowedProgress progress;
+    BAMIndexBuilder const &index = EngineAccess::Followed(alignments, progress);
+    std::string data;
     
-    if (refID < 0)
-        return new ngs_adapt::StringItf("", 0);
+    if (!index.isSorted())
+        throw std::runtime_error("the alignments read so far aren't in position order");
+    index.Encode(data, 0);
+    BAMIndexBuilder::Save(indexPath, data);
+}
 
-    HeaderRefInfo const &ri = parent->getRefInfo(refID);
-    std::string const &RNEXT = ri.getName();
-    return new ngs_adapt::StringItf(RNEXT.data(), RNEXT.size());
+void NGS_BAM::getClippedFragmentBases(ngs::Alignment const &alignment, bool const readOrientation, std::string &dst)
+{
+    EngineAccess::ClippedBases(alignment, readOrientation, dst);
 }
 
-// TODO: rename to isMateReversedOrientation
-bool ReadCollection::Alignment::getMateIsReversedOrientation() const
+void NGS_BAM::getClippedFragmentQualities(ngs::Alignment const &alignment, bool const readOrientation, std::string &dst)
 {
-    return (current->flag() & 0x0020) != 0;
+    EngineAccess::ClippedQualities(alignment, readOrientation, dst);
 }
 
-bool ReadCollection::Alignment::nextAlignment()
+NGS_BAM::RawQualities NGS_BAM::getRawQualities(ngs::Alignment const &alignment)
 {
-    do {
-        if (current) {
-            delete current;
-            current = 0;
-        }
-        current = parent->ReadBAMRecord();
-        if (!current)
-            return false;
-    } while (shouldSkip());
-    return true;
+    return EngineAccess::RawQualities(alignment);
 }
 
-ngs::ReadCollection NGS_BAM::openReadCollection(std::string const &path)
+NGS_BAM::RawRecord NGS_BAM::getRawRecord(ngs::Alignment const &alignment)
 {
-    ngs_adapt::ReadCollectionItf *const self = new ReadCollection(path);
-    NGS_ReadCollection_v1 *const c_obj = self->Cast();
-    ngs::ReadCollectionItf *const ngs_itf = ngs::ReadCollectionItf::Cast(c_obj);
+    BAMFile const *file = 0;
+    bool complete = false;
+    BAMRecord const *const rec = EngineAccess::Record(alignment, file, complete);
     
-    return ngs::ReadCollection(ngs_itf);
+    if (!rec)
+        throw std::runtime_error("not available");
+    if (!complete)
+        throw std::runtime_error("the record was read without all of its fields");
+    
+    NGS_BAM::RawRecord const rslt = { rec->rawData(), rec->rawSize() };
+    return rslt;
+}
+
+void NGS_BAM::scanUnordered(ngs::ReadCollection const &collection, std::vector<ScanConsumer *> const &consumers)
+{
+    std::vector<BAMFile const *> const files = EngineAccess::Files(collection);
+    
+    if (files.empty())
+        throw std::runtime_error("not available");
+    
+    for (size_t i = 0; i < files.size(); ++i)
+        files[i]->ScanUnordered(consumers);
+}
+
+bool NGS_BAM::encodeQualities(char *const dst, uint8_t const *const raw, size_t const count, uint8_t const maxQual)
+{
+    return BAMRecord::encodeQual(dst, raw, count, true, maxQual);
 }
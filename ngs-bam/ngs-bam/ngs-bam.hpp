@@ -30,16 +30,1101 @@
 #include <ngs/ReadCollection.hpp>
 #endif
 
+#ifndef _hpp_ngs_alignment_
+#include <ngs/Alignment.hpp>
+#endif
+
+#ifndef _hpp_ngs_alignment_iterator_
+#include <ngs/AlignmentIterator.hpp>
+#endif
+
+#ifndef _hpp_ngs_read_iterator_
+#include <ngs/ReadIterator.hpp>
+#endif
+
+#ifndef _hpp_ngs_statistics_
+#include <ngs/Statistics.hpp>
+#endif
+
+#include <map>
 #include <string>
+#include <vector>
 
 namespace NGS_BAM
 {
 
     /* openReadCollection
      *  create an object representing a named collection of reads
-     *  "path" is a file-system path to a BAM file
+     *  "path" is a file-system path to a BAM file or, if the library
+     *  was built with HAVE_LIBCURL, an http://, https:// or s3:// URL
+     *  of one on a server that honors range requests; its index is
+     *  <path>.bai or <path>.csi, and it has no sidecars
+     *  "-" is stdin; it, a pipe or /dev/fd/<n> is read as a stream,
+     *  forward and once: the alignments or reads can be iterated as
+     *  they come, with the header's references and read groups, but
+     *  there is no index, so no slices, and what needs a pass over the
+     *  whole file first, e.g. counts and row ranges, throws
+     *  a CRAM 3.0 file, or a URL ending in ".cram", is read as one:
+     *  its index is <path>.crai, its records are decoded against the
+     *  FASTA file of OpenOptions::referenceFasta or one found as for
+     *  BAM files, and it has read groups, references and alignments,
+     *  but no reads, row ranges, shards or pileups; it can't be read
+     *  as a stream
+     *  a SAM file, plain or bgzipped, is read as one when its text is
+     *  SAM, or for a URL, when it ends in ".sam", ".sam.gz" or
+     *  ".sam.bgz": its lines are parsed into BAM records on the pool's
+     *  threads, so it is a BAM file in all but speed; it has no index
+     *  unless OpenOptions::buildIndex makes one, which isn't saved, and
+     *  it can't be read as a stream
+     *  with HAVE_LIBCURL, htsget://host/prefix/reads/<id> is a BAM file
+     *  on an htsget server, read from https://, or from http:// as
+     *  htsget+http://; it is a stream of what its ticket lists, and a
+     *  slice of a reference asks for a ticket of that region alone, so
+     *  only its part of the file is fetched; the ticket request has the
+     *  bearer token of NGS_BAM_HTSGET_TOKEN, if it is set
      */
     ngs :: ReadCollection openReadCollection ( const std :: string & path );
+
+    /* OpenOptions
+     *  engine tunables for openReadCollection
+     */
+    struct OpenOptions
+    {
+        /* the most BGZF blocks of the file decompressed at once, on the
+         * process' shared ngs::WorkPool, with a thread of the file's own
+         * reading ahead of them; 0 decompresses on the calling thread */
+        unsigned int threads;
+
+        /* map the BAM and index files into memory
+         * instead of reading them through stdio */
+        bool useMmap;
+
+        /* only locate each reference's index at open time
+         * and load it on first use */
+        bool lazyIndex;
+
+        /* open without waiting for the index: it is loaded, or built,
+         * on the process' shared ngs::WorkPool while the header is used
+         * and records are read in order, and the first slice, count or
+         * anything else that needs it waits for it, or loads it there
+         * if no pool thread has started on it; an index that fails to
+         * load makes those throw instead of the open */
+        bool asyncIndex;
+
+        /* bytes of compressed data to have the system read ahead
+         * of the current position, and of the next chunk of a slice
+         * 0 leaves read-ahead to the system */
+        size_t prefetch;
+
+        /* for scans of files larger than memory on shared nodes: what
+         * each reader has read is dropped from the page cache behind it,
+         * so that a scan doesn't evict other processes' pages, and at
+         * least 8 MiB is read ahead of it */
+        bool streaming;
+
+        /* number of inflated BGZF blocks kept so that blocks
+         * read again, e.g. by overlapping or neighboring slices,
+         * are not inflated again; 0 for none. they are shared by
+         * the iterators of all threads, and a block that several
+         * want at once is inflated by one while the others wait */
+        unsigned int blockCache;
+
+        /* bytes of decoded records that slices of up to 1 Mbp keep, by
+         * 16 kbp window of a reference and shared by the collections of
+         * the file, so that a slice over windows read before, e.g. by
+         * overlapping queries of a service, reads only the windows it
+         * doesn't find; the least recently used are given back first
+         * 0, the default, keeps none */
+        size_t regionCache;
+
+        /* bytes of compressed data that each reader of the file, one
+         * per iterator, buffers; at least 64 KiB, e.g. small for services
+         * that keep many files open and large for streaming scans on
+         * parallel file systems; no buffer is used for a mapped file */
+        size_t ioBuffer;
+
+        /* allocate those buffers on huge pages where the system has
+         * them, rounding their size up to a huge page */
+        bool hugePages;
+
+        /* the parts of each record that alignments decode, a mask of
+         * Field; position, flags, mapping quality, mate and CIGAR are
+         * always decoded, and asking for a part left out throws */
+        enum Field
+        {
+            readName = 1,
+            bases = 2,
+            qualities = 4,
+            tags = 8,
+            allFields = 15
+        };
+        unsigned int fields;
+
+        /* check the CRC32 of every BGZF block as it is inflated, or
+         * of every CRAM block and container header as it is read;
+         * the inflated size of a block is always checked */
+        bool verifyCRC;
+
+        /* when the per read group and per reference statistics
+         * have not been saved next to the BAM file, make them with
+         * a full scan the first time they are asked for and save
+         * them there; otherwise only saved ones are used */
+        bool buildStats;
+
+        /* a FASTA file, with its .fai index, that has the reference
+         * sequences; it may be compressed with bgzip, and is then read
+         * by block, using its .gzi index if it has one; if empty,
+         * <name>.fa, <name>.fasta or <name>.fa.gz next to <name>.bam is
+         * used if it is there */
+        std :: string referenceFasta;
+
+        /* bytes that reads of a file that isn't collated, e.g. one
+         * sorted by position, may hold while waiting for the mates of
+         * paired records; when they are used up, the record held
+         * longest becomes a read of its own */
+        size_t mateBuffer;
+
+        /* how much each record is checked as it is read:
+         * trusted  only that it has a fixed part, for files known to be
+         *          well formed, e.g. just written by our own tools; the
+         *          rest of a malformed record may then be misread
+         * checked  also that its CIGAR, bases and qualities fit in it,
+         *          so that none of it is read past its end
+         * strict   also that its reference IDs, positions and name length
+         *          are valid, throwing at the first record that isn't */
+        enum Validation
+        {
+            trusted,
+            checked,
+            strict
+        };
+        Validation validation;
+
+        /* when the file has neither a .bai nor a .csi index, index it
+         * with a pass over its records at open time, inflated on
+         * "threads", and keep the index in memory; with saveIndex it
+         * is also written to <path>.bai; a file that isn't sorted by
+         * position is left without one */
+        bool buildIndex;
+        bool saveIndex;
+
+        /* keep the parsed index in a sidecar, <path>.ngs-index, that is
+         * mapped read-only, so that processes opening the same file share
+         * one copy of it and all but the first open it without parsing;
+         * the first to open the file without a current one writes it */
+        bool sharedIndex;
+
+        /* let getRead find a read by its name as well as by its ID; the
+         * names are indexed with a pass over the file the first time one
+         * is looked up and the index is kept in a sidecar, <path>.ngs-names,
+         * that later opens map while it is current; most names that aren't
+         * in the file are ruled out without a search */
+        bool nameIndex;
+
+        /* for a file that is still being written, e.g. by an aligner:
+         * the seconds to wait at its end, or at a block that isn't all
+         * written yet, for it to grow, reading it again every 100 ms; it
+         * ends for good once its BGZF EOF marker has been read, or when
+         * it hasn't grown for this long; 0, the default, doesn't wait
+         * a followed file isn't mapped and isn't indexed with buildIndex,
+         * see getFollowedProgress and saveFollowedIndex */
+        unsigned int follow;
+
+        /* the priority of the file's decompression on the shared pool,
+         * against that of other collections and iterators */
+        enum Priority
+        {
+            low,
+            normal,
+            high
+        };
+        Priority priority;
+
+        /* the threads of the shared pool, which every collection in the
+         * process decompresses on; only taken from a collection opened
+         * before the pool has started; 0, the default, for the pool's
+         * own, see ngs::WorkPool::defaultThreads */
+        unsigned int poolThreads;
+
+        /* on a machine with several NUMA nodes, keep the file's
+         * decompression on the node of the thread that opens it, which
+         * should be the one that reads it: its buffers are put there, and
+         * the threads that read and inflate its blocks are moved to that
+         * node's CPUs, pool threads included */
+        bool numaLocal;
+
+        /* size reads from how the file has been read: after a seek, read
+         * as much as reading from one seek to the next usually does, up
+         * to ioBuffer, and once a run of reading, or the usual one, is
+         * longer than ioBuffer, have the system read as far ahead as it
+         * is long, up to 32 MiB, with prefetch as the least; so slices
+         * of small regions read little and long scans a lot
+         * the policy it comes to is in getStatistics, under BGZF/ADAPTIVE/
+         * false, the default being true, reads after a seek from one block
+         * and reads ahead only with prefetch */
+        bool adaptiveReadahead;
+
+        /* with threads, have one of the workers inflate BGZF blocks in
+         * batches of up to 64 on a GPU, while the others go on one block
+         * at a time, for full scans on nodes where inflating on the CPUs
+         * holds them back; needs ngs-bam built with "make HAVE_NVCOMP=1",
+         * and is ignored without it or without a CUDA device */
+        bool gpuInflate;
+
+        /* keep what the records of each BGZF block are: their references,
+         * the range of their positions and mapping qualities, the FLAG
+         * bits all and any of them have, and how many there are, so that
+         * a filtered slice passes over the blocks all of whose records it
+         * would reject without inflating them; made with the index when
+         * buildIndex makes one, else with a pass over the file, and kept
+         * next to it in <path>.ngs-zones for the next open, which needs
+         * only to read it; the count of blocks passed over is in
+         * getStatistics, under BGZF/BLOCKS_SKIPPED
+         * the sidecar also counts the mapped records of each reference,
+         * and of each 16 KiB window of it, that are primary, secondary,
+         * supplementary, duplicates and QC failures, so getAlignmentCount
+         * of the collection and of its references answers for either
+         * category without a scan, estimateSlice counts the alignments
+         * of the windows a slice overlaps, and getStatistics has the
+         * counts under COUNTS/<name>/
+         * not for streams, followed files or URLs; false by default */
+        bool zoneMap;
+
+        /* for a file opened by URL, a directory, e.g. on a local SSD,
+         * that keeps its bytes as they are fetched, in pieces of 64 KiB
+         * named for the object's ETag and their position, so that what
+         * later reads of them want, by this process or by any other that
+         * uses the same directory, e.g. jobs over the same targets of
+         * many samples, isn't fetched again; a server that gives no
+         * ETag, or a weak one, leaves the file out; empty, the default,
+         * for none
+         * diskCacheSize bounds what the directory holds, the pieces read
+         * least recently going first once it is over, and with
+         * diskCacheInflated the inflated blocks are kept there as well,
+         * from the block cache, so that they aren't inflated again */
+        std :: string diskCache;
+        uint64_t diskCacheSize;
+        bool diskCacheInflated;
+
+        OpenOptions ()
+        : threads ( 0 )
+        , useMmap ( false )
+        , lazyIndex ( false )
+        , asyncIndex ( false )
+        , prefetch ( 0 )
+        , streaming ( false )
+        , blockCache ( 16 )
+        , regionCache ( 0 )
+        , ioBuffer ( 2 * 1024 * 1024 )
+        , hugePages ( false )
+        , fields ( allFields )
+        , verifyCRC ( true )
+        , buildStats ( false )
+        , mateBuffer ( 256 * 1024 * 1024 )
+        , validation ( checked )
+        , buildIndex ( false )
+        , saveIndex ( false )
+        , sharedIndex ( false )
+        , nameIndex ( false )
+        , follow ( 0 )
+        , priority ( normal )
+        , poolThreads ( 0 )
+        , numaLocal ( false )
+        , adaptiveReadahead ( true )
+        , gpuInflate ( false )
+        , zoneMap ( false )
+        , diskCacheSize ( ( uint64_t ) 16 << 30 )
+        , diskCacheInflated ( false )
+        {
+        }
+    };
+
+    /* openReadCollection
+     *  as above, with engine tunables
+     */
+    ngs :: ReadCollection openReadCollection ( const std :: string & path, const OpenOptions & options );
+
+    /* setOpenOption
+     *  sets the tunable of "options" of the same name as its member from
+     *  text, e.g. from a configuration file: a count, or a size in bytes
+     *  that may end in k, M or G for KiB, MiB or GiB; true, false, yes,
+     *  no, on, off, 1 or 0 for a flag; trusted, checked or strict for
+     *  validation; low, normal or high for priority, and all or the names
+     *  of fields joined by '+' for fields
+     *  throws for a name or value it doesn't know
+     */
+    void setOpenOption ( OpenOptions & options, const std :: string & name, const std :: string & value );
+
+    /* setOpenOptions
+     *  as above, for each <name>=<value> of "settings", separated by
+     *  commas or white space, e.g. "threads=4,blockCache=64,ioBuffer=256k"
+     */
+    void setOpenOptions ( OpenOptions & options, const std :: string & settings );
+
+    /* defaultOpenOptions
+     *  OpenOptions () with the settings of the environment variable
+     *  NGS_BAM_OPTIONS, in the form above, if it is set; what
+     *  openReadCollection uses when it isn't given options, so that a
+     *  deployment may tune a program without rebuilding it
+     */
+    OpenOptions defaultOpenOptions ();
+
+    /* openReadCollection
+     *  as above, with the tunables named in "options" set over
+     *  defaultOpenOptions (), by setOpenOption
+     */
+    ngs :: ReadCollection openReadCollection ( const std :: string & path,
+        const std :: map < std :: string, std :: string > & options );
+
+    /* openMergedReadCollection
+     *  coordinate-sorted BAM files, e.g. the per-lane files of a sample,
+     *  as one collection without writing a merged copy; they must have
+     *  the same references, in the same order
+     *  alignments come in position order, merged from slices of each file
+     *  as they are read; each file is inflated on the shared pool, by at
+     *  least one worker, so that the files are read in parallel
+     *  an alignment's ID is the index of its file in "paths", a '.' and
+     *  its ID in that file
+     *  read groups, reads, alignment ranges and shards and pileups are
+     *  not available
+     */
+    ngs :: ReadCollection openMergedReadCollection ( const std :: vector < std :: string > & paths,
+        const OpenOptions & options = OpenOptions () );
+
+    /* getUnplacedReads
+     *  the reads of a collection of a BAM file sorted by position whose
+     *  records have no reference, which such a file keeps after all the
+     *  others; reading starts after the last record the index has for
+     *  any reference, so the rest of the file isn't read
+     *  reads are numbered from 1 among these; needs the index, and
+     *  isn't available for a merged collection
+     */
+    ngs :: ReadIterator getUnplacedReads ( const ngs :: ReadCollection & collection );
+
+    /* SortOrder
+     *  the order the SO field of a file's @HD header line gives its
+     *  records; unknownOrder if there is none, or it is "unknown"
+     *  a file whose header says unsorted or queryname isn't taken to be
+     *  in position order: without an index its slices and pileups throw
+     *  rather than come back empty, and it can't be merged
+     *  in one sorted by coordinate, a read iterator lets out a record
+     *  whose mate's position has been passed as soon as it is read
+     */
+    enum SortOrder
+    {
+        unknownOrder,
+        unsorted,
+        queryname,
+        coordinate
+    };
+
+    /* getSortOrder
+     *  of the file of a collection of a BAM file, or of the first of a
+     *  merged one
+     */
+    SortOrder getSortOrder ( const ngs :: ReadCollection & collection );
+
+    /* FollowedProgress
+     *  how far an iterator of getAlignments of a followed collection
+     *  has read: the records, and the virtual file position of the
+     *  next one, 0 at the end; "complete" once the file's EOF marker has been read,
+     *  i.e. when the iterator ends, the file was finished rather than
+     *  given up on
+     */
+    struct FollowedProgress
+    {
+        uint64_t records;
+        uint64_t position;
+        bool complete;
+    };
+
+    /* getFollowedProgress
+     *  for an iterator of getAlignments of a collection opened with follow
+     */
+    FollowedProgress getFollowedProgress ( const ngs :: AlignmentIterator & alignments );
+
+    /* saveFollowedIndex
+     *  the records such an iterator has read so far, as a BAI index at
+     *  "indexPath", so that the part of a file sorted by position that
+     *  has been written can be sliced, e.g. by another process; throws
+     *  if they weren't in position order
+     */
+    void saveFollowedIndex ( const ngs :: AlignmentIterator & alignments, const std :: string & indexPath );
+
+    /* Interval
+     *  the positions [start, end) of a reference, 0-based as in BED
+     */
+    struct Interval
+    {
+        std :: string reference;
+        uint64_t start;
+        uint64_t end;
+
+        Interval ( const std :: string & Reference, uint64_t Start, uint64_t End )
+        : reference ( Reference )
+        , start ( Start )
+        , end ( End )
+        {
+        }
+    };
+
+    /* readBED
+     *  the intervals of a BED file, in the order of its lines; the
+     *  columns after the first three, and track, browser and '#' lines,
+     *  are ignored
+     */
+    std :: vector < Interval > readBED ( const std :: string & path );
+
+    /* getAlignmentSlices
+     *  the alignments of a collection of a BAM file that overlap any of
+     *  "intervals", e.g. the targets of a panel, in one iterator: the
+     *  index's chunks of them all are merged and read in file order,
+     *  so that a block that neighboring intervals share is read once
+     *  an alignment is returned once for each interval it overlaps,
+     *  and getIntervalIndex tells which; an interval is truncated to
+     *  the end of its reference, and one of a reference the file
+     *  doesn't have throws
+     *  needs the index, and isn't available for a merged collection
+     */
+    ngs :: AlignmentIterator getAlignmentSlices ( const ngs :: ReadCollection & collection,
+        const std :: vector < Interval > & intervals,
+        ngs :: Alignment :: AlignmentCategory categories = ngs :: Alignment :: all );
+
+    /* getIntervalIndex
+     *  the index in "intervals" of the interval that the current alignment
+     *  of an iterator from getAlignmentSlices is returned for
+     */
+    size_t getIntervalIndex ( const ngs :: Alignment & alignment );
+
+    /* materialize
+     *  the alignments of a collection of any engine that overlap any of
+     *  "regions", read once and kept in memory, as a collection whose
+     *  iterators then run over that copy, for algorithms that make several
+     *  passes over the same alignments
+     *  each field is a column: positions, lengths and flags in arrays, the
+     *  bases packed two to a byte, qualities and CIGARs in arenas of their
+     *  own, and read names and read groups as indices of strings kept once
+     *  an empty "regions" takes every reference whole; those that overlap
+     *  are merged, and an alignment that several of them share is kept once
+     *  "categories", "filters" and "mappingQuality" choose the alignments
+     *  as for getFilteredAlignmentSlice: by default failed and duplicate
+     *  ones are left out, as those flags aren't kept
+     *  the collection has the references of "collection", each with the
+     *  alignments kept of it in position order, whole, sliced, filtered by
+     *  category, mapping quality and start, sharded or piled up; an
+     *  alignment's ID is its row, from 1, and getAlignmentRange counts
+     *  rows from 1; mates are found among the rows by read name
+     *  reads, read groups, reference bases and tags are not available
+     */
+    ngs :: ReadCollection materialize ( const ngs :: ReadCollection & collection,
+        const std :: vector < Interval > & regions,
+        ngs :: Alignment :: AlignmentCategory categories = ngs :: Alignment :: all,
+        ngs :: Alignment :: AlignmentFilter filters = ( ngs :: Alignment :: AlignmentFilter ) 0,
+        int32_t mappingQuality = 0 );
+
+    /* ColumnOptions
+     *  what exportColumns writes of each alignment
+     */
+    struct ColumnOptions
+    {
+        /* the columns besides positions, lengths, template lengths,
+         * flags and mapping qualities, which are always there and
+         * always read; a mask of Column */
+        enum Column
+        {
+            bases = 1,
+            qualities = 2,
+            readName = 4,
+            readGroup = 8,
+            cigar = 16,
+            mate = 32,              // the mate's reference
+            tags = 64,
+            allColumns = 127
+        };
+        unsigned int columns;
+
+        /* the two-character names of the tags kept in the tags column */
+        std :: vector < std :: string > tagNames;
+
+        /* the alignments written, as for materialize */
+        std :: vector < Interval > regions;
+        ngs :: Alignment :: AlignmentCategory categories;
+        ngs :: Alignment :: AlignmentFilter filters;
+        int32_t mappingQuality;
+
+        /* the rows of a chunk, the unit that is deflated, read and
+         * skipped; a chunk has the alignments of one reference */
+        uint32_t chunkRows;
+
+        /* deflate level, 0 to 9, or -1 for the default; chunks that
+         * deflate doesn't shrink are kept as they are */
+        int level;
+
+        ColumnOptions ()
+        : columns ( allColumns )
+        , categories ( ngs :: Alignment :: all )
+        , filters ( ( ngs :: Alignment :: AlignmentFilter ) 0 )
+        , mappingQuality ( 0 )
+        , chunkRows ( 64 * 1024 )
+        , level ( -1 )
+        {
+        }
+    };
+
+    /* exportColumns
+     *  write the alignments of a collection of any engine to a column
+     *  cache in "directory", made if it doesn't exist, for analyses that
+     *  scan the same alignments many times: each field is a file of its
+     *  own, in chunks of the rows of one reference in position order,
+     *  each deflated on its own, with a zone map of each chunk's
+     *  references, positions, flags and mapping qualities
+     *  a column the source doesn't give, e.g. tags from an engine that
+     *  lends none, isn't written; the alignments of one reference at a
+     *  time are held in memory while they are written, and the cache
+     *  isn't there until the last of them is
+     */
+    void exportColumns ( const ngs :: ReadCollection & collection, const std :: string & directory,
+        const ColumnOptions & options = ColumnOptions () );
+
+    /* openColumns
+     *  a collection of the column cache in "directory", as materialize
+     *  would make it of the same alignments, whose iterators run over
+     *  the columns of "columns" alone: only those files are mapped and
+     *  inflated, and asking for a field of another throws
+     *  with "regions", only the chunks whose zones overlap them are
+     *  read, so that alignments outside them but in the same chunks
+     *  may be there too; alignment IDs are the rows of what is read
+     *  the tags kept are found with Alignment :: getTag and the others,
+     *  like those of a column that wasn't read, aren't there
+     */
+    ngs :: ReadCollection openColumns ( const std :: string & directory,
+        unsigned int columns = ColumnOptions :: allColumns,
+        const std :: vector < Interval > & regions = std :: vector < Interval > () );
+
+    /* willNeed
+     *  a hint that the alignments of "intervals" are about to be asked
+     *  for, e.g. the next windows a worker is given: their chunks are
+     *  looked up in the index, and on the shared pool the system is
+     *  asked to read them ahead and, with OpenOptions::blockCache, the
+     *  first block of each interval is inflated into the cache, so that
+     *  a slice of it needn't wait for its first bytes; a slice read
+     *  with threads still reads that block, but doesn't inflate it
+     *  returns at once; intervals a file has no index for, or of
+     *  references it doesn't have, are passed over, and a collection
+     *  that isn't of BAM files is left alone
+     */
+    void willNeed ( const ngs :: ReadCollection & collection, const std :: vector < Interval > & intervals );
+
+    /* sampleAlignments
+     *  about "count" alignments of a collection of a BAM file drawn at
+     *  random from "seed", for estimates such as of insert sizes, error
+     *  rates or duplication that don't need every alignment, without
+     *  reading the whole file
+     *  runs of neighboring records are drawn and each read whole, in
+     *  the order drawn, until "count" alignments are returned or every
+     *  run has been: with OpenOptions::zoneMap a run is the records of
+     *  a BGZF block and is drawn by their count, so that each record is
+     *  as likely as the others to be in the sample; else a run goes
+     *  from one record position the index has to the next, a 16 KiB
+     *  window of the reference or less, and is drawn by its compressed
+     *  bytes, so that records that compress badly, e.g. long ones or
+     *  those with many tags, are a little more likely
+     *  a sample isn't of independent alignments but of clusters, the
+     *  runs: in estimating how much a statistic varies, treat each run,
+     *  i.e. the alignments from the same block or window, as one unit,
+     *  or take fewer alignments from more runs by asking for more and
+     *  thinning them; a last run may be cut short by "count"
+     *  needs the zone map or the index, can't be resumed from a cursor,
+     *  and isn't available for a merged collection
+     */
+    ngs :: AlignmentIterator sampleAlignments ( const ngs :: ReadCollection & collection,
+        uint64_t count, uint64_t seed,
+        ngs :: Alignment :: AlignmentCategory categories = ngs :: Alignment :: all );
+
+    /* computeFlagStats
+     *  what samtools flagstat counts of the records of a collection of
+     *  one or more BAM files, with one pass over each in which only the
+     *  fixed part of each record is read: under FLAGSTAT/PASSED/ for
+     *  those that pass QC and FLAGSTAT/FAILED/ for those that don't,
+     *  TOTAL, PRIMARY, SECONDARY, SUPPLEMENTARY, DUPLICATES,
+     *  PRIMARY_DUPLICATES, MAPPED, PRIMARY_MAPPED, and of the primary
+     *  records of pairs, PAIRED, READ1, READ2, PROPERLY_PAIRED (and
+     *  mapped), WITH_MATE_MAPPED (both mapped), SINGLETONS (the mate
+     *  isn't), MATE_ON_OTHER_REFERENCE and MATE_ON_OTHER_REFERENCE_MAPQ5
+     *  (of those with both mapped, with a mapping quality of 5 or more)
+     *  the records are inflated with the file's threads, see
+     *  OpenOptions::threads
+     */
+    ngs :: Statistics computeFlagStats ( const ngs :: ReadCollection & collection );
+
+    /* HistogramSpec
+     *  the bins of computeHistograms: the template lengths are counted
+     *  in tlenBins bins tlenBin wide, the aligned and soft-clipped
+     *  lengths in lengthBins bins a base wide; the last bin of each also
+     *  has what is longer
+     */
+    struct HistogramSpec
+    {
+        uint32_t tlenBin;
+        uint32_t tlenBins;
+        uint32_t lengthBins;
+        ngs :: Alignment :: AlignmentCategory categories;
+
+        HistogramSpec ()
+        : tlenBin ( 10 )
+        , tlenBins ( 100 )
+        , lengthBins ( 512 )
+        , categories ( ngs :: Alignment :: all )
+        {
+        }
+    };
+
+    /* Histograms
+     *  what computeHistograms counts, a bin for each element:
+     *  templateLength has the TLEN of each pair of primary alignments
+     *  with both on the same reference, counted once, at the one with
+     *  the positive TLEN; mappingQuality, 256 bins, that of every
+     *  alignment; alignedLength the bases of the reference each covers,
+     *  and softClipLength the bases each has soft clipped, at both ends
+     *  merge adds another, of the same spec, e.g. of another thread's
+     *  part of a reference, to this one
+     */
+    struct Histograms
+    {
+        uint32_t tlenBin;
+        uint64_t alignments;
+        std :: vector < uint64_t > templateLength;
+        std :: vector < uint64_t > mappingQuality;
+        std :: vector < uint64_t > alignedLength;
+        std :: vector < uint64_t > softClipLength;
+
+        explicit Histograms ( const HistogramSpec & spec = HistogramSpec () );
+        void merge ( const Histograms & other );
+    };
+
+    /* computeHistograms
+     *  the histograms of the alignments of a slice of a reference, as
+     *  reference.getAlignmentSlice ( start, length, spec.categories )
+     *  has them, counted from the records without their messages, or of
+     *  the alignments an iterator of a BAM file has left, e.g. from
+     *  sampleAlignments, which it uses up
+     *  the slice isn't available for a reference of another engine, nor
+     *  are alignments of another engine counted
+     */
+    Histograms computeHistograms ( const ngs :: Reference & reference,
+        int64_t start, uint64_t length, const HistogramSpec & spec = HistogramSpec () );
+    Histograms computeHistograms ( ngs :: AlignmentIterator & alignments,
+        const HistogramSpec & spec = HistogramSpec () );
+
+    /* CoverageSpec
+     *  the alignments depth is counted from, as ngs::Reference::getCoverage
+     *  chooses them
+     */
+    struct CoverageSpec
+    {
+        ngs :: Alignment :: AlignmentCategory categories;
+        ngs :: Alignment :: AlignmentFilter filters;
+        int32_t mappingQuality;
+
+        CoverageSpec ()
+        : categories ( ngs :: Alignment :: all )
+        , filters ( ( ngs :: Alignment :: AlignmentFilter ) 0 )
+        , mappingQuality ( 0 )
+        {
+        }
+    };
+
+    /* CoverageBin
+     *  the depth over [ start, start + length ) of a reference: the mean
+     *  of its positions', and the least and the most of any one
+     */
+    struct CoverageBin
+    {
+        int64_t start;
+        uint64_t length;
+        double mean;
+        uint32_t min;
+        uint32_t max;
+    };
+
+    /* buildCoverageMap
+     *  count the depth of every reference of a BAM file with "spec", a
+     *  window at a time, and keep it in a sidecar, <path>.ngs-coverage,
+     *  in bins of 256 positions and again in bins of 1 Ki, 4 Ki, and so
+     *  on up to 1 Mi, for summarizeCoverage; that is about a sixteenth of a
+     *  byte for each position of the references, and a pass over the file's
+     *  alignments, which needs its index. the map is current until the
+     *  file changes
+     *  returns false if the sidecar can't be written; not available for
+     *  a merged collection
+     */
+    bool buildCoverageMap ( const ngs :: ReadCollection & collection,
+        const CoverageSpec & spec = CoverageSpec () );
+
+    /* summarizeCoverage
+     *  the depth over a window of a reference in bins about "resolution"
+     *  positions wide: read from the coverage map of its file, if it has
+     *  a current one counted with "spec", in the widest of its bins no
+     *  wider than "resolution", those that overlap the window; else, or
+     *  for a resolution finer than 256, counted with getCoverage in bins
+     *  of exactly "resolution" from "start", the last cut at the end of
+     *  the window, which is cut at the end of the reference
+     */
+    std :: vector < CoverageBin > summarizeCoverage ( const ngs :: Reference & reference,
+        int64_t start, uint64_t length, uint64_t resolution, const CoverageSpec & spec = CoverageSpec () );
+
+    /* SliceChunk
+     *  virtual file offsets [ begin, end ), each the file offset of a
+     *  BGZF block shifted left by 16 and the offset in its inflated data
+     */
+    struct SliceChunk
+    {
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /* SlicePlan
+     *  what a slice of a reference reads, as the index has it
+     */
+    struct SlicePlan
+    {
+        std :: vector < SliceChunk > chunks;    // of the bins that overlap the slice, in bin order
+        std :: vector < SliceChunk > ranges;    // the chunks sorted and merged, which are read in turn
+        uint64_t trimmedChunks;                 // chunks dropped as ending before the first record of the slice
+        bool trimmed;                           // chunks were dropped or the first range was started later
+        uint64_t compressedBytes;               // about how many bytes of the file the ranges take
+        uint64_t blocks;                        // about how many BGZF blocks they are in
+        uint64_t inflatedBytes;                 // about how many bytes inflating them gives
+
+        SlicePlan ()
+        : trimmedChunks ( 0 )
+        , trimmed ( false )
+        , compressedBytes ( 0 )
+        , blocks ( 0 )
+        , inflatedBytes ( 0 )
+        {
+        }
+    };
+
+    /* explainSlice
+     *  what reference.getAlignmentSlice ( start, length ) would read,
+     *  without reading it: the chunks the index selects for the slice,
+     *  what the linear index (or CSI's bin offsets) trimmed of them, and
+     *  the ranges they merge into, with about how many blocks and bytes
+     *  those take; for sizing windows and finding badly indexed files
+     *  needs the index, and isn't available for a merged collection
+     */
+    SlicePlan explainSlice ( const ngs :: Reference & reference, int64_t start, uint64_t length );
+
+    /* RecordFilter
+     *  an expression that alignments are filtered with, compiled once;
+     *  a slice of getAlignmentSlice tests it on each record as it is
+     *  read, on the record's own bytes, so that the records it rejects
+     *  are never made into alignments
+     *  the expression is tests joined with "&&", "||", "!" and
+     *  parentheses; a test compares a value with another by ==, !=, <,
+     *  <=, > or >=, looks for it in a set, as RG in { "a", "b" } does, or
+     *  is a value alone, which is true if it is there and not 0
+     *  a value is a number, a string in double quotes, a tag such as NM
+     *  or RG, or one of the fields flag, mapq, pos, mpos, tlen, rlen, the
+     *  length of the sequence, and alen, the length of the reference the
+     *  alignment covers; "& bits" after one tests some of its bits, as
+     *  flag & 0x400 == 0 does. a test of a tag that a record doesn't
+     *  have is false
+     *  the records rejected by what isn't a tag or alen are passed over
+     *  having read no more than their fixed part
+     *  e.g. "mapq >= 20 && flag & 0x900 == 0 && NM <= 4 && alen >= 50"
+     *  an empty expression accepts everything; one that isn't throws
+     */
+    class RecordFilter
+    {
+    public:
+
+        explicit RecordFilter ( const std :: string & expression = "" );
+        RecordFilter ( const RecordFilter & filter );
+        RecordFilter & operator = ( const RecordFilter & filter );
+        ~ RecordFilter ();
+
+        /* accepts
+         *  tests an alignment through its messages, for those of an
+         *  engine that getAlignmentSlice can't give the filter to; of the
+         *  bits of flag only 0x1, 0x10, 0x20 and 0x100 are known there,
+         *  and mpos isn't
+         */
+        bool accepts ( const ngs :: Alignment & alignment ) const;
+
+    private:
+
+        friend ngs :: AlignmentIterator getAlignmentSlice ( const ngs :: Reference & reference,
+            int64_t start, uint64_t length, const RecordFilter & filter,
+            ngs :: Alignment :: AlignmentCategory categories );
+
+        class Impl;
+        Impl * impl;
+    };
+
+    /* getAlignmentSlice
+     *  what reference.getAlignmentSlice ( start, length, categories )
+     *  gives, of the alignments that "filter" accepts
+     *  isn't available for a file on an htsget server or a reference of
+     *  another engine, whose alignments can be tested with accepts
+     */
+    ngs :: AlignmentIterator getAlignmentSlice ( const ngs :: Reference & reference,
+        int64_t start, uint64_t length, const RecordFilter & filter,
+        ngs :: Alignment :: AlignmentCategory categories = ngs :: Alignment :: all );
+
+    /* getClippedFragmentBases, getClippedFragmentQualities
+     *  what the alignment's messages of the same name give, into "dst"
+     *  so that it can be reused from one alignment to the next, or with
+     *  "readOrientation" reverse complemented (qualities reversed) back
+     *  to the orientation the fragment was sequenced in, if it aligned to
+     *  the reverse strand; qualities are empty if the record has none
+     *  only available for alignments of this engine
+     */
+    void getClippedFragmentBases ( const ngs :: Alignment & alignment, bool readOrientation, std :: string & dst );
+    void getClippedFragmentQualities ( const ngs :: Alignment & alignment, bool readOrientation, std :: string & dst );
+
+    /* RawQualities
+     *  the phred values of a record as it stores them, without an ASCII
+     *  offset or a cap, lent by the alignment: valid until its next message
+     */
+    struct RawQualities
+    {
+        const uint8_t * data;
+        size_t size;
+    };
+
+    /* getRawQualities
+     *  the qualities of the current record of an alignment of this engine;
+     *  "size" is 0 if it has none, i.e. they are all 0xFF
+     */
+    RawQualities getRawQualities ( const ngs :: Alignment & alignment );
+
+    /* RawRecord
+     *  a record as a BAM file stores it, after its block_size, lent by
+     *  the alignment: valid until its next message
+     */
+    struct RawRecord
+    {
+        const uint8_t * data;
+        size_t size;
+    };
+
+    /* getRawRecord
+     *  the current record of an alignment of this engine, e.g. to pass
+     *  it on without decoding it; throws if the collection was opened
+     *  without all of the fields, as the record then isn't all there
+     */
+    RawRecord getRawRecord ( const ngs :: Alignment & alignment );
+
+    /* ScanConsumer
+     *  what takes the records of scanUnordered, one for each thread
+     */
+    class ScanConsumer
+    {
+    public:
+
+        /* consume
+         *  a record, lent until consume returns; only ever called from
+         *  the one thread this consumer was given to
+         */
+        virtual void consume ( const RawRecord & record ) = 0;
+
+        virtual ~ ScanConsumer ()
+        {
+        }
+    };
+
+    /* scanUnordered
+     *  every record of a collection of one or more BAM files, in no
+     *  particular order, for what doesn't depend on it, e.g. k-mer
+     *  counts, flag stats or histograms: each local file is cut into a
+     *  range of BGZF blocks for each consumer, and each range is
+     *  inflated and parsed by a thread of its own that gives its records
+     *  to its consumer, so that the scan isn't held to the pace of one
+     *  parsing thread; the first consumer's is the calling thread
+     *  a range starts at the first record found in its blocks, and the
+     *  thread of the range before reads up to there, records that cross
+     *  into it included; streams, remote files and files being followed
+     *  are read by the first consumer alone
+     *  throws the first error thrown by a consumer or the engine, once
+     *  all threads have stopped
+     */
+    void scanUnordered ( const ngs :: ReadCollection & collection, const std :: vector < ScanConsumer * > & consumers );
+
+    /* encodeQualities
+     *  "count" phred values at "raw" as text into "dst", capped at
+     *  "maxQual" and with an ASCII offset of 33, as getFragmentQualities
+     *  gives them; returns false if they are all 0xFF
+     */
+    bool encodeQualities ( char * dst, const uint8_t * raw, size_t count, uint8_t maxQual = 63 );
+
+    /* keepOpenFiles
+     *  collections of the same file, opened with the same engine tunables
+     *  while it doesn't change, share its header and index; set how many
+     *  files the process keeps open after their last collection is
+     *  released, so that opening one again only costs a stat
+     *  0, the default, keeps none
+     */
+    void keepOpenFiles ( unsigned int count );
+
+    /* MemoryUse
+     *  the bytes the engine holds, by what they are held for; files
+     *  that are mapped aren't counted, their pages being the system's
+     */
+    struct MemoryUse
+    {
+        uint64_t ioBuffers;         // read buffers
+        uint64_t inflateQueue;      // blocks being read and inflated by worker threads
+        uint64_t blockCache;        // inflated blocks kept for seeks
+        uint64_t remoteWindows;     // what remote files have fetched
+        uint64_t index;             // parsed indexes and what they are parsed from
+        uint64_t header;            // header text, references and read groups
+        uint64_t mateBuffer;        // records read iterators hold for their mates
+        uint64_t regionCache;       // windows of records kept for slices
+        uint64_t total;             // all of the above
+    };
+
+    /* getMemoryUse
+     *  what the process holds for all the files it has open, kept open
+     *  ones included; or for the files of a collection of this engine,
+     *  which is shared with the other collections that have them open
+     *  also among the collection's statistics, under MEMORY/
+     */
+    MemoryUse getMemoryUse ();
+    MemoryUse getMemoryUse ( const ngs :: ReadCollection & collection );
+
+    /* setMemoryBudget
+     *  what the process should hold at most, 0 for no limit, the default
+     *  it isn't a hard limit: while over it, the block cache gives back
+     *  blocks, read iterators let out records before their mates come,
+     *  remote files fetch small windows and new iterators read through
+     *  small buffers, but the header, index and the buffers in use stay
+     */
+    void setMemoryBudget ( uint64_t bytes );
+    uint64_t getMemoryBudget ();
+
+    /* traceCompiled
+     *  whether the engine was built with "make NGS_BAM_TRACE=1", to record
+     *  timed spans of opening, seeking, slicing and inflating
+     */
+    bool traceCompiled ();
+
+    /* enableTrace
+     *  record spans or stop; setting the environment variable NGS_TRACE
+     *  to a file name does the same and appends the spans to it at exit
+     */
+    void enableTrace ( bool on );
+
+    /* writeTrace
+     *  append the spans kept so far, the latest 65536 of each thread, to
+     *  the file at "path" as Chrome trace events, for chrome://tracing or
+     *  Perfetto; the SDK's dispatch layer, built with NGS_TRACE, writes its
+     *  own to the same file
+     */
+    void writeTrace ( const std :: string & path );
+
+    /* MateFinder
+     *  finds the mates of many alignments of a BAM file together:
+     *  the alignments are read in file order, then their mates are
+     *  looked for in position order, so that the file is read in two
+     *  forward sweeps rather than with seeks back and forth
+     *  the file is opened again, and its index is needed
+     *  a slice filtered with Alignment :: withMates does the same a batch
+     *  at a time, giving each mate outside the window after its alignment;
+     *  the collection must have been opened with readName
+     */
+    class MateFinder
+    {
+    public:
+
+        MateFinder ( const std :: string & path, const OpenOptions & options = OpenOptions () );
+        ~ MateFinder ();
+
+        /* add
+         *  queue the alignment with "alignmentId", as given by
+         *  an alignment of a collection of the same file
+         */
+        void add ( const std :: string & alignmentId );
+
+        /* resolve
+         *  the alignment IDs of the mates of the queued alignments,
+         *  in the order they were added, with "" for those whose mate
+         *  wasn't found; empties the queue
+         */
+        std :: vector < std :: string > resolve ();
+
+    private:
+
+        class Impl;
+        Impl * impl;
+
+        MateFinder ( const MateFinder & );
+        MateFinder & operator = ( const MateFinder & );
+    };
+
+    /* WriteOptions
+     *  tunables for Writer
+     */
+    struct WriteOptions
+    {
+        /* the most BGZF blocks compressed at once, on the process'
+         * shared ngs::WorkPool, and written in order; 0 compresses
+         * them as they are filled */
+        unsigned int threads;
+
+        /* deflate level, 0 to 9, or -1 for the default */
+        int level;
+
+        /* write <path>.bai too; alignments must then be written
+         * in position order */
+        bool buildIndex;
+
+        WriteOptions ()
+        : threads ( 0 )
+        , level ( -1 )
+        , buildIndex ( false )
+        {
+        }
+    };
+
+    /* Writer
+     *  writes alignments to a new BAM file with the references of "like":
+     *  the header of its BAM file if it is one of ours, else @SQ lines
+     *  made from its references
+     *  an alignment of a BAM file opened with all its fields, e.g. one
+     *  from a slice, is copied as it was read; any other is made from
+     *  what NGS gives of it, without its tags but the read group, and
+     *  from another engine without the segment flags of paired reads
+     */
+    class Writer
+    {
+    public:
+
+        Writer ( const std :: string & path, const ngs :: ReadCollection & like,
+            const WriteOptions & options = WriteOptions () );
+
+        /* a writer that wasn't closed leaves the file incomplete */
+        ~ Writer ();
+
+        /* write
+         *  append the current alignment of "alignment"
+         */
+        void write ( const ngs :: Alignment & alignment );
+
+        /* close
+         *  finish the file and its index
+         */
+        void close ();
+
+    private:
+
+        class Impl;
+        Impl * impl;
+
+        Writer ( const Writer & );
+        Writer & operator = ( const Writer & );
+    };
 }
 
 #endif // _hpp_ngs_bam_
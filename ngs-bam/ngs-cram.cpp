@@ -0,0 +1,1201 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include <ngs-bam/ngs-bam.hpp>
+#include "cram.hpp"
+#include "slot.hpp"
+
+#include <ngs/adapter/ReadCollectionItf.hpp>
+#include <ngs/adapter/AlignmentItf.hpp>
+#include <ngs/adapter/ReferenceItf.hpp>
+#include <ngs/adapter/PileupItf.hpp>
+#include <ngs/adapter/StringItf.hpp>
+#include <ngs/adapter/ReadGroupItf.hpp>
+#include <ngs/adapter/ReadItf.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+/* alignment IDs
+ *  the file position of the record's container, the offset of its slice
+ *  in the container and its index in the slice, separated by '.', so
+ *  that getAlignment reads only that slice
+ */
+static void FormatAlignmentId(uint64_t const container, uint32_t const slice, size_t const record, std::string &rslt)
+{
+    char buffer[64];
+
+    rslt.assign(buffer, snprintf(buffer, sizeof(buffer), "%llu.%u.%llu", (unsigned long long)container,
+                                 (unsigned)slice, (unsigned long long)record));
+}
+
+static bool ParseAlignmentId(char const id[], uint64_t &container, uint32_t &slice, size_t &record)
+{
+    unsigned long long values[3];
+    char const *cp = id;
+
+    if (id == 0)
+        return false;
+    for (unsigned i = 0; i < 3; ++i) {
+        char *endp = 0;
+
+        if (*cp < '0' || *cp > '9')
+            return false;
+        values[i] = strtoull(cp, &endp, 10);
+        cp = endp;
+        if (*cp != (i < 2 ? '.' : '\0'))
+            return false;
+        ++cp;
+    }
+    container = values[0];
+    slice = (uint32_t)values[1];
+    record = (size_t)values[2];
+    return true;
+}
+
+/* CRAMCollection
+ *  a CRAM file as a read collection: its read groups, references and
+ *  alignments, those of a reference sliced with the index
+ *  reads, alignment ranges and shards, and pileups are not available
+ */
+class CRAMCollection : public ngs_adapt::ReadCollectionItf
+{
+    class Alignment;
+    class Reference;
+    class ReadGroup;
+
+    CRAMFile file;
+
+    /* of getAlignmentCount, counted with a pass over the file once */
+    mutable pthread_mutex_t countLock;
+    mutable bool counted;
+    mutable uint64_t primaryCount;
+    mutable uint64_t secondaryCount;
+
+    void Count() const;
+public:
+    CRAMCollection(std::string const &path, NGS_BAM::OpenOptions const &options)
+    : file(path, options)
+    , counted(false)
+    , primaryCount(0)
+    , secondaryCount(0)
+    {
+        pthread_mutex_init(&countLock, 0);
+    }
+    ~CRAMCollection() {
+        pthread_mutex_destroy(&countLock);
+    }
+
+    CRAMFile const &getFile() const {
+        return file;
+    }
+    /* Need
+     *  throws unless the collection was opened to decode "field"
+     */
+    void Need(unsigned const field) const {
+        if ((file.getOptions().fields & field) == 0)
+            throw std::runtime_error("not available");
+    }
+
+    ngs_adapt::StringItf *getName() const {
+        std::string const &path = file.getPath();
+        size_t const sep = path.rfind('/');
+        size_t const at = sep == path.npos ? 0 : sep + 1;
+
+        return new ngs_adapt::StringItf(path.data() + at, path.size() - at);
+    }
+    ngs_adapt::ReadGroupItf *getReadGroups() const;
+    bool hasReadGroup(char const spec[]) const {
+        return file.FindReadGroup(spec) >= 0;
+    }
+    ngs_adapt::ReadGroupItf *getReadGroup(char const spec[]) const;
+    ngs_adapt::ReferenceItf *getReferences() const;
+    bool hasReference(char const spec[]) const {
+        return file.FindReference(spec) >= 0;
+    }
+    ngs_adapt::ReferenceItf *getReference(char const spec[]) const;
+    Alignment *OneAlignment(char const spec[]) const;
+    ngs_adapt::AlignmentItf *getAlignment(char const spec[]) const;
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary,
+                                           bool const want_secondary) const;
+    uint64_t getAlignmentCount(bool const want_primary,
+                               bool const want_secondary) const;
+    ngs_adapt::AlignmentItf *getAlignmentRange(uint64_t const first,
+                                               uint64_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary ) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard,
+                                               uint32_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary ) const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getReadCount(bool const want_full,
+                          bool const want_partial,
+                          bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getRead(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getReads(bool const want_full,
+                                 bool const want_partial,
+                                 bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getReadRange(uint64_t const first,
+                                     uint64_t const count,
+                                     bool const want_full,
+                                     bool const want_partial,
+                                     bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    uint32_t getFeatures() const {
+        return NGS_ReadCollectionFeature_read_groups
+             | NGS_ReadCollectionFeature_references
+             | NGS_ReadCollectionFeature_alignments
+             | NGS_ReadCollectionFeature_alignment_count;
+    }
+};
+
+/* CRAMCollection::Alignment
+ *  the records of the slices a CRAMReader decodes, each copied into a
+ *  buffer to be measured and have its tags looked up as a BAM record's
+ *  a slice of a reference skips the records of the slices it reads that
+ *  are outside of it, and those its filter rejects
+ */
+class CRAMCollection::Alignment : public ngs_adapt::AlignmentItf
+{
+    friend class CRAMCollection;    /* holds and releases them */
+    friend class Reference;
+public:
+    struct Window {
+        int32_t refID;              /* -1 for the whole file */
+        int64_t beg;
+        int64_t end;
+        BAMRecordFilter filter;
+
+        Window() : refID(-1), beg(0), end(0) {}
+    };
+private:
+    mutable std::string seqBuffer;
+    mutable std::string qualBuffer;
+    mutable std::string cigarBuffer;
+    mutable std::string idBuffer;
+    mutable std::string mateIdBuffer;
+    mutable std::string refBasesBuffer;
+    mutable std::string clippedSeqBuffer;
+    mutable std::string clippedQualBuffer;
+    mutable std::string alignedSeqBuffer;
+    mutable std::string cursorBuffer;
+    mutable StringSlot alignmentIdString;
+    mutable StringSlot mateAlignmentIdString;
+    mutable StringSlot refBasesString;
+    mutable StringSlot readIdString;
+    mutable StringSlot referenceSpecString;
+    mutable StringSlot readGroupString;
+    mutable StringSlot basesString;
+    mutable StringSlot qualitiesString;
+    mutable StringSlot cigarString;
+    mutable StringSlot mateReferenceSpecString;
+    mutable StringSlot clippedBasesString;
+    mutable StringSlot clippedQualitiesString;
+    mutable StringSlot alignedBasesString;
+    mutable StringSlot cursorString;
+
+    CRAMCollection *parent;
+    CRAMFile const &file;
+    CRAMIndexEntryList const plan;  /* the slices, if planned */
+    bool const planned;
+    CRAMReader *reader;             /* NULL once there are no more */
+    CRAMSlice slice;
+    size_t next;                    /* in slice */
+    size_t index;                   /* of current in slice */
+    BAMRecordBuffer buffer;
+    BAMRecord const *current;
+    Window const window;
+    bool const want_primary;
+    bool const want_secondary;
+    bool const single;
+
+    BAMRecord const &Current() const {
+        if (current == 0)
+            throw std::runtime_error("no current row");
+        return *current;
+    }
+    std::string const &RefName(int32_t const refID) const {
+        if (refID < 0 || (unsigned)refID >= file.countOfReferences())
+            throw std::runtime_error("not available");
+        return file.getReference(refID).name;
+    }
+    /* Take
+     *  record "i" of the slice as the current one
+     */
+    void Take(size_t const i) {
+        SizedRawData const &rec = slice.raw(i);
+
+        memcpy(buffer.Reserve(rec.size)->data, rec.data, rec.size);
+        buffer.Measure();
+        current = buffer.record();
+        index = i;
+    }
+    bool shouldSkip() const {
+        int const flag = current->flag();
+
+        if ((flag & 0x0004) != 0)
+            return true;
+        if ((flag & 0x0900) == 0 && !want_primary)
+            return true;
+        if ((flag & 0x0900) != 0 && !want_secondary)
+            return true;
+        if (window.refID < 0)
+            return false;
+        if (current->refID() != window.refID)
+            return true;
+
+        int64_t const pos = current->pos();
+        int64_t const len = buffer.span().refLen > 0 ? buffer.span().refLen : 1;
+
+        if (pos >= window.end || pos + len <= window.beg)
+            return true;
+        return window.filter.isActive() && window.filter.Rejects(*current);
+    }
+    bool FindMate(uint64_t &container, uint32_t &slice, size_t &record) const;
+    bool getClippedQualities(std::string &dst) const;
+    ngs_adapt::StringItf *getCigar(bool const clipped, char const OPCODE[]) const {
+        Current().cigarString(cigarBuffer, clipped, OPCODE);
+        return cigarString.Set(cigarBuffer);
+    }
+public:
+    /* every slice of the file */
+    Alignment(CRAMCollection const *const Parent, bool const WantPrimary, bool const WantSecondary)
+    : parent(static_cast<CRAMCollection *>(Parent->Duplicate()))
+    , file(Parent->file)
+    , planned(false)
+    , reader(0)
+    , next(0)
+    , index(0)
+    , current(0)
+    , want_primary(WantPrimary)
+    , want_secondary(WantSecondary)
+    , single(false)
+    {
+        try {
+            if (want_primary || want_secondary)
+                reader = new CRAMReader(file, file.getFirstContainer());
+        }
+        catch (...) {
+            parent->Release();
+            throw;
+        }
+    }
+    /* the slices of "entries", in file order, with "Window" applied;
+     * with Single, the record "at" of the first, and it alone */
+    Alignment(CRAMCollection const *const Parent, CRAMIndexEntryList const &entries, Window const &Window,
+              bool const WantPrimary, bool const WantSecondary, bool const Single = false, size_t const at = 0)
+    : parent(static_cast<CRAMCollection *>(Parent->Duplicate()))
+    , file(Parent->file)
+    , plan(entries)
+    , planned(true)
+    , reader(0)
+    , next(0)
+    , index(0)
+    , current(0)
+    , window(Window)
+    , want_primary(WantPrimary)
+    , want_secondary(WantSecondary)
+    , single(Single)
+    {
+        try {
+            if ((want_primary || want_secondary) && !entries.empty())
+                reader = new CRAMReader(file, entries);
+            if (single) {
+                if (reader == 0 || !reader->Next(slice) || slice.container != entries[0].container
+                    || slice.slice != entries[0].slice || at >= slice.count()
+                    || (slice.record(at).flag() & 0x0004) != 0)
+                    throw std::runtime_error("no alignment");
+                Take(at);
+                delete reader;
+                reader = 0;
+            }
+        }
+        catch (...) {
+            delete reader;
+            parent->Release();
+            throw;
+        }
+    }
+    ~Alignment() {
+        delete reader;
+        parent->Release();
+    }
+
+    ngs_adapt::StringItf *getFragmentId() const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::StringItf *getFragmentBases(uint64_t const Offset, uint64_t const Length) const {
+        parent->Need(NGS_BAM::OpenOptions::bases);
+
+        BAMRecord const &rec = Current();
+        uint64_t const End = Offset + Length;
+        unsigned const seqLen = rec.l_seq();
+        unsigned const offset = Offset < seqLen ? Offset : seqLen;
+        unsigned const seqEnd = End < seqLen ? End : seqLen;
+
+        seqBuffer.resize(seqEnd - offset);
+        if (offset < seqEnd)
+            rec.decodeSeq(&seqBuffer[0], offset, seqEnd - offset);
+        return basesString.Set(seqBuffer);
+    }
+    ngs_adapt::StringItf *getFragmentQualities(uint64_t const Offset, uint64_t const Length) const {
+        parent->Need(NGS_BAM::OpenOptions::qualities);
+
+        BAMRecord const &rec = Current();
+        uint64_t const End = Offset + Length;
+        unsigned const seqLen = rec.l_seq();
+        unsigned const offset = Offset < seqLen ? Offset : seqLen;
+        unsigned const seqEnd = End < seqLen ? End : seqLen;
+
+        qualBuffer.resize(seqEnd - offset);
+
+        bool const notFF = offset < seqEnd && rec.decodeQual(&qualBuffer[0], offset, seqEnd - offset, true, 63);
+
+        return qualitiesString.Set(qualBuffer.data(), notFF ? qualBuffer.size() : 0);
+    }
+    bool getFragmentBasesPacked(uint64_t const Offset, uint64_t const Length, NGS_FragmentPackedBases_v1 &packed) const {
+        parent->Need(NGS_BAM::OpenOptions::bases);
+
+        BAMRecord const &rec = Current();
+        unsigned const seqLen = rec.l_seq();
+        unsigned const offset = Offset < seqLen ? Offset : seqLen;
+
+        packed.bases = rec.seq() + (offset >> 1);
+        packed.count = Length < seqLen - offset ? Length : seqLen - offset;
+        packed.phase = offset & 1;
+        return true;
+    }
+    ngs_adapt::StringItf *getClippedFragmentBases() const {
+        parent->Need(NGS_BAM::OpenOptions::bases);
+
+        BAMRecord const &rec = Current();
+        BAMRecordSpan const &span = buffer.span();
+        unsigned const seqLen = rec.l_seq();
+        unsigned const left = span.softClip[0] < seqLen ? span.softClip[0] : seqLen;
+        unsigned const right = span.softClip[1] < seqLen - left ? span.softClip[1] : seqLen - left;
+        unsigned const n = seqLen - left - right;
+
+        clippedSeqBuffer.resize(n);
+        if (n != 0)
+            rec.decodeSeq(&clippedSeqBuffer[0], left, n);
+        return clippedBasesString.Set(clippedSeqBuffer);
+    }
+    ngs_adapt::StringItf *getClippedFragmentQualities() const {
+        getClippedQualities(clippedQualBuffer);
+        return clippedQualitiesString.Set(clippedQualBuffer);
+    }
+    // all of SEQ, soft clips included
+    ngs_adapt::StringItf *getAlignedFragmentBases() const {
+        parent->Need(NGS_BAM::OpenOptions::bases);
+
+        BAMRecord const &rec = Current();
+        unsigned const seqLen = rec.l_seq();
+
+        alignedSeqBuffer.resize(seqLen);
+        if (seqLen != 0)
+            rec.decodeSeq(&alignedSeqBuffer[0], 0, seqLen);
+        return alignedBasesString.Set(alignedSeqBuffer);
+    }
+    ngs_adapt::StringItf *getAlignmentId() const {
+        Current();
+        FormatAlignmentId(slice.container, slice.slice, index, idBuffer);
+        return alignmentIdString.Set(idBuffer);
+    }
+    ngs_adapt::StringItf *getReferenceSpec() const {
+        return referenceSpecString.Set(RefName(Current().refID()));
+    }
+    int32_t getMappingQuality() const {
+        return Current().mq();
+    }
+    int32_t getReferenceIndex() const {
+        return Current().refID();
+    }
+    int32_t getMateReferenceIndex() const {
+        return Current().next_refID();
+    }
+    // the reference under the aligned part of the record
+    ngs_adapt::StringItf *getReferenceBases() const {
+        int const seq = file.getSequence(Current().refID());
+
+        if (seq < 0)
+            throw std::runtime_error("not available");
+        file.getFasta().Copy(seq, current->pos(), buffer.span().refLen, refBasesBuffer);
+        return refBasesString.Set(refBasesBuffer);
+    }
+    // the RG tag, which the read group of a CRAM record is made into
+    ngs_adapt::StringItf *getReadGroup() const {
+        parent->Need(NGS_BAM::OpenOptions::tags);
+        Current();
+
+        BAMRecord::OptionalField const *const rg = buffer.findTag("RG");
+
+        if (rg == 0 || rg->getValueType() != 'Z')
+            return readGroupString.Set("", 0);
+        return readGroupString.Set(rg->getRawValue(), rg->getElementSize());
+    }
+    ngs_adapt::StringItf *getReadId() const {
+        parent->Need(NGS_BAM::OpenOptions::readName);
+
+        BAMRecord const &rec = Current();
+        char const *const QNAME = rec.readname();
+
+        return readIdString.Set(QNAME, strnlen(QNAME, rec.l_read_name()));
+    }
+    uint32_t getFragmentIndex() const {
+        return (Current().flag() & 0x00C0) == 0x0080 ? 1 : 0;
+    }
+    bool isPrimary() const {
+        return (Current().flag() & 0x0900) == 0;
+    }
+    int64_t getAlignmentPosition() const {
+        return Current().pos();
+    }
+    uint64_t getReferencePositionProjectionRange(int64_t const ref_pos) const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getAlignmentLength() const {
+        Current();
+        return buffer.span().refLen;
+    }
+    bool getIsReversedOrientation() const {
+        return (Current().flag() & 0x0010) != 0;
+    }
+    int32_t getSoftClip(uint32_t const edge) const {
+        Current();
+        if (edge > 1)
+            throw std::runtime_error("invalid clip edge");
+        return buffer.span().softClip[edge];
+    }
+    uint64_t getTemplateLength() const {
+        return Current().tlen();
+    }
+    ngs_adapt::StringItf *getShortCigar(bool const clipped) const {
+        return getCigar(clipped, "MIDNSHPMM???????");
+    }
+    ngs_adapt::StringItf *getLongCigar(bool const clipped) const {
+        return getCigar(clipped, "MIDNSHP=X???????");
+    }
+    char getRNAOrientation() const {
+        throw std::runtime_error("not available");
+    }
+    bool hasMate() const {
+        int const FLAG = Current().flag();
+
+        return (FLAG & 0x0001) != 0 && (FLAG & 0x00C0) != 0 && (FLAG & 0x00C0) != 0x00C0;
+    }
+    ngs_adapt::StringItf *getMateAlignmentId() const {
+        uint64_t mateContainer;
+        uint32_t mateSlice;
+        size_t mateRecord;
+
+        if (!FindMate(mateContainer, mateSlice, mateRecord))
+            return 0;
+        FormatAlignmentId(mateContainer, mateSlice, mateRecord, mateIdBuffer);
+        return mateAlignmentIdString.Set(mateIdBuffer);
+    }
+    ngs_adapt::AlignmentItf *getMateAlignment() const {
+        uint64_t mateContainer;
+        uint32_t mateSlice;
+        size_t mateRecord;
+        std::string id;
+
+        if (!FindMate(mateContainer, mateSlice, mateRecord))
+            throw std::runtime_error("the mate was not found");
+        FormatAlignmentId(mateContainer, mateSlice, mateRecord, id);
+        return parent->getAlignment(id.c_str());
+    }
+    ngs_adapt::StringItf *getMateReferenceSpec() const {
+        int const refID = Current().next_refID();
+
+        if (refID < 0)
+            return mateReferenceSpecString.Set("", 0);
+        return mateReferenceSpecString.Set(RefName(refID));
+    }
+    bool getMateIsReversedOrientation() const {
+        return (Current().flag() & 0x0020) != 0;
+    }
+    bool getTag(char const tag[], NGS_AlignmentTag_v1 &value) const {
+        parent->Need(NGS_BAM::OpenOptions::tags);
+        Current();
+
+        BAMRecord::OptionalField const *const field = buffer.findTag(tag);
+
+        if (field == 0)
+            return false;
+
+        char const type = field->getValueType();
+
+        value.data = field->getRawValue();
+        value.type = type;
+        value.is_array = field->isArray();
+        if (value.is_array)
+            value.count = field->getElementCount();
+        else if (type == 'Z' || type == 'H')
+            value.count = field->getElementSize();
+        else
+            value.count = 1;
+        return true;
+    }
+    // the records are kept aligned, so their CIGARs are always lent
+    bool getCigarOps(NGS_AlignmentCigar_v1 &cigar) const {
+        BAMRecord const &rec = Current();
+
+        cigar.ops = rec.cigarOps();
+        cigar.count = rec.nc();
+        return cigar.ops != 0 || cigar.count == 0;
+    }
+    void getCore(NGS_AlignmentCore_v1 &core) const {
+        int const FLAG = Current().flag();
+
+        core.position = current->pos();
+        core.length = buffer.span().refLen;
+        core.template_len = current->tlen();
+        core.map_qual = current->mq();
+        core.flags = ((FLAG & 0x0900) == 0 ? NGS_AlignmentBatchFlags_primary : 0)
+                   | ((FLAG & 0x0010) != 0 ? NGS_AlignmentBatchFlags_reversed : 0)
+                   | (hasMate() ? NGS_AlignmentBatchFlags_has_mate : 0);
+    }
+    uint32_t getSupportedMessages() const {
+        unsigned const fields = file.getOptions().fields;
+        uint32_t rslt = NGS_AlignmentMessage_id
+                      | NGS_AlignmentMessage_ref_spec
+                      | NGS_AlignmentMessage_map_qual
+                      | NGS_AlignmentMessage_is_primary
+                      | NGS_AlignmentMessage_align_pos
+                      | NGS_AlignmentMessage_align_length
+                      | NGS_AlignmentMessage_is_reversed
+                      | NGS_AlignmentMessage_soft_clip
+                      | NGS_AlignmentMessage_template_len
+                      | NGS_AlignmentMessage_cigar
+                      | NGS_AlignmentMessage_has_mate
+                      | NGS_AlignmentMessage_mate_ref_spec
+                      | NGS_AlignmentMessage_mate_is_reversed;
+
+        if (fields & NGS_BAM::OpenOptions::readName)
+            rslt |= NGS_AlignmentMessage_read_id | NGS_AlignmentMessage_mate_id | NGS_AlignmentMessage_mate_alignment;
+        if (fields & NGS_BAM::OpenOptions::bases)
+            rslt |= NGS_AlignmentMessage_fragment_bases | NGS_AlignmentMessage_clipped_frag_bases
+                  | NGS_AlignmentMessage_aligned_frag_bases;
+        if (fields & NGS_BAM::OpenOptions::qualities)
+            rslt |= NGS_AlignmentMessage_fragment_quals | NGS_AlignmentMessage_clipped_frag_quals;
+        if (fields & NGS_BAM::OpenOptions::tags)
+            rslt |= NGS_AlignmentMessage_read_group | NGS_AlignmentMessage_tags;
+        if (file.getFasta().isOpen())
+            rslt |= NGS_AlignmentMessage_ref_bases;
+        return rslt;
+    }
+    bool nextAlignment() {
+        if (single)
+            throw std::runtime_error("no more rows available");
+        current = 0;
+        for ( ; ; ) {
+            if (next >= slice.count()) {
+                if (reader == 0 || !reader->Next(slice)) {
+                    delete reader;
+                    reader = 0;
+                    return false;
+                }
+                next = 0;
+                continue;
+            }
+            Take(next++);
+            if (!shouldSkip())
+                return true;
+            current = 0;
+        }
+    }
+    bool nextFragment() {
+        throw std::runtime_error("not available");
+    }
+    /* getCursor, resumeFrom
+     *  "A1", the container and slice of the current record and the index
+     *  of the next one in the slice; 1:0:0 before the first slice, and
+     *  0:0:0 at the end
+     */
+    ngs_adapt::StringItf *getCursor() const {
+        char text[80];
+        size_t n;
+
+        if (reader == 0 && next >= slice.count())
+            n = snprintf(text, sizeof(text), "A1:0:0:0");
+        else if (slice.container == 0)
+            n = snprintf(text, sizeof(text), "A1:1:0:0");
+        else
+            n = snprintf(text, sizeof(text), "A1:%llu:%u:%llu", (unsigned long long)slice.container,
+                         (unsigned)slice.slice, (unsigned long long)next);
+        cursorBuffer.assign(text, n);
+        return cursorString.Set(cursorBuffer);
+    }
+    void resumeFrom(char const cursor[]);
+};
+
+/* FindMate
+ *  where the mate is: of a mate in the same slice, its index; any other
+ *  is looked for in the slices at the mate position, by name and segment;
+ *  false if the file hasn't the mate's record
+ */
+bool CRAMCollection::Alignment::FindMate(uint64_t &mateContainer, uint32_t &mateSlice, size_t &mateRecord) const
+{
+    if (!hasMate())
+        throw std::runtime_error("no mate");
+
+    int32_t const attached = slice.mate(index);
+
+    if (attached >= 0 && (size_t)attached != index && (size_t)attached < slice.count()) {
+        mateContainer = slice.container;
+        mateSlice = slice.slice;
+        mateRecord = attached;
+        return true;
+    }
+    parent->Need(NGS_BAM::OpenOptions::readName);
+
+    BAMRecord const &rec = *current;
+    int32_t const mateRef = rec.next_refID();
+    int32_t const matePos = rec.next_pos();
+
+    if (mateRef < 0 || matePos < 0)
+        return false;
+
+    CRAMIndexEntryList entries;
+
+    file.Slices(mateRef, matePos, matePos + 1, entries);
+
+    char const *const name = rec.readname();
+    size_t const nameLen = strnlen(name, rec.l_read_name());
+    int const segment = rec.flag() & 0x00C0;
+    CRAMReader reader(file, entries);
+    CRAMSlice other;
+
+    while (reader.Next(other)) {
+        for (size_t i = 0; i < other.count(); ++i) {
+            BAMRecord const &mate = other.record(i);
+
+            if (mate.refID() != mateRef || mate.pos() != matePos || mate.next_pos() != rec.pos()
+                || (mate.flag() & 0x00C0) == segment || (mate.flag() & 0x0900) != 0)
+                continue;
+            if (strnlen(mate.readname(), mate.l_read_name()) != nameLen || memcmp(mate.readname(), name, nameLen) != 0)
+                continue;
+            mateContainer = other.container;
+            mateSlice = other.slice;
+            mateRecord = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CRAMCollection::Alignment::getClippedQualities(std::string &dst) const
+{
+    parent->Need(NGS_BAM::OpenOptions::qualities);
+
+    BAMRecord const &rec = Current();
+    BAMRecordSpan const &span = buffer.span();
+    unsigned const seqLen = rec.l_seq();
+    unsigned const left = span.softClip[0] < seqLen ? span.softClip[0] : seqLen;
+    unsigned const right = span.softClip[1] < seqLen - left ? span.softClip[1] : seqLen - left;
+    unsigned const n = seqLen - left - right;
+
+    dst.resize(n);
+    if (n == 0 || !rec.decodeQual(&dst[0], left, n, true, 63)) {
+        dst.clear();
+        return n == 0;
+    }
+    return true;
+}
+
+/* resumeFrom
+ *  the slices are read again from the cursor's, which is skipped to
+ *  its record
+ */
+void CRAMCollection::Alignment::resumeFrom(char const cursor[])
+{
+    unsigned long long values[3];
+    char const *cp = cursor;
+
+    if (single)
+        throw std::runtime_error("no more rows available");
+    if (cp == 0 || strncmp(cp, "A1", 2) != 0)
+        throw std::runtime_error("invalid cursor");
+    cp += 2;
+    for (unsigned i = 0; i < 3; ++i) {
+        char *endp = 0;
+
+        if (*cp++ != ':' || *cp < '0' || *cp > '9')
+            throw std::runtime_error("invalid cursor");
+        values[i] = strtoull(cp, &endp, 10);
+        cp = endp;
+    }
+    if (*cp != '\0')
+        throw std::runtime_error("invalid cursor");
+
+    uint64_t const container = values[0];
+    uint32_t const at = (uint32_t)values[1];
+
+    delete reader;
+    reader = 0;
+    slice = CRAMSlice();
+    next = 0;
+    current = 0;
+    if (container == 0 || (!want_primary && !want_secondary))
+        return;
+    if (container == 1 && at == 0 && values[2] == 0) {
+        /* before the first slice */
+        if (planned)
+            reader = plan.empty() ? 0 : new CRAMReader(file, plan);
+        else
+            reader = new CRAMReader(file, file.getFirstContainer());
+        return;
+    }
+    if (planned) {
+        CRAMIndexEntryList rest;
+
+        for (CRAMIndexEntryList::const_iterator i = plan.begin(); i != plan.end(); ++i) {
+            if (i->container > container || (i->container == container && i->slice >= at))
+                rest.push_back(*i);
+        }
+        if (rest.empty())
+            return;
+        reader = new CRAMReader(file, rest);
+    }
+    else
+        reader = new CRAMReader(file, container);
+    while (reader->Next(slice)) {
+        if (slice.container == container && slice.slice == at) {
+            if (values[2] > slice.count())
+                break;
+            next = (size_t)values[2];
+            return;
+        }
+        if (slice.container > container)
+            break;
+    }
+    throw std::runtime_error("invalid cursor");
+}
+
+/* CRAMCollection::Reference
+ *  the @SQ lines of the header, in order; bases come from the FASTA
+ *  file the records are decoded against, slices from the index
+ */
+class CRAMCollection::Reference : public ngs_adapt::ReferenceItf
+{
+    mutable std::string basesBuffer;
+    mutable StringSlot basesString;
+    CRAMCollection *parent;
+    unsigned cur;
+    unsigned max;
+    int state;                      /* 0 before the first, 1 on one, 2 past the last, 3 just one */
+
+    CRAMFile const &File() const {
+        return parent->file;
+    }
+    void Row() const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+    }
+    // the sequence of the current reference, after checking "offset"
+    int Bases(uint64_t const offset) const {
+        Row();
+
+        int const seq = File().getSequence(cur);
+
+        if (seq < 0)
+            throw std::runtime_error("not available");
+        if (offset >= File().getFasta().getLength(seq))
+            throw std::runtime_error("offset is out of range");
+        return seq;
+    }
+    /* Slice
+     *  the slices the index has over the window, with the filter of BAM
+     *  slices applied to their records
+     */
+    Alignment *Slice(int64_t const Start, uint64_t const length, uint32_t const flags, int32_t const map_qual) const {
+        Row();
+
+        int64_t const start = Start < 0 ? 0 : Start;
+        int64_t const end = start + (int64_t)length;
+        Alignment::Window window;
+        CRAMIndexEntryList entries;
+
+        window.refID = cur;
+        window.beg = start;
+        window.end = end;
+        if ((flags & NGS_ReferenceAlignFlags_pass_bad) == 0)
+            window.filter.rejectFlags |= 0x0200;
+        if ((flags & NGS_ReferenceAlignFlags_pass_dups) == 0)
+            window.filter.rejectFlags |= 0x0400;
+        if ((flags & NGS_ReferenceAlignFlags_min_map_qual) != 0)
+            window.filter.minMapQ = map_qual;
+        if ((flags & NGS_ReferenceAlignFlags_max_map_qual) != 0)
+            window.filter.maxMapQ = map_qual;
+        if ((flags & NGS_ReferenceAlignFlags_start_within_window) != 0)
+            window.filter.beg = (int32_t)start;
+        if (window.filter.rejectFlags != 0 || window.filter.minMapQ > 0 || window.filter.maxMapQ < 255 || window.filter.beg > 0) {
+            window.filter.refID = cur;
+            window.filter.end = (int32_t)(end < INT32_MAX ? end : INT32_MAX);
+        }
+        if (start < end)
+            File().Slices(cur, start, end, entries);
+        return new Alignment(parent, entries, window,
+                             (flags & NGS_ReferenceAlignFlags_wants_primary) != 0,
+                             (flags & NGS_ReferenceAlignFlags_wants_secondary) != 0);
+    }
+public:
+    Reference(CRAMCollection const *const Parent, unsigned const current, unsigned const references, int const initState)
+    : parent(static_cast<CRAMCollection *>(Parent->Duplicate()))
+    , cur(current)
+    , max(references)
+    , state(initState)
+    {}
+    ~Reference() {
+        parent->Release();
+    }
+
+    ngs_adapt::StringItf *getCommonName() const {
+        Row();
+
+        std::string const &name = File().getReference(cur).name;
+
+        return new ngs_adapt::StringItf(name.data(), name.size());
+    }
+    ngs_adapt::StringItf *getCanonicalName() const {
+        throw std::runtime_error("not available");
+    }
+    bool getIsCircular() const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getLength() const {
+        Row();
+        return File().getReference(cur).length;
+    }
+    uint32_t getFeatures() const {
+        if (state == 2)
+            return 0;
+        return NGS_ReferenceFeature_alignment_by_id
+             | NGS_ReferenceFeature_alignments
+             | NGS_ReferenceFeature_alignment_count
+             | (File().getSequence(cur) >= 0 ? NGS_ReferenceFeature_bases : 0);
+    }
+    ngs_adapt::StringItf *getReferenceBases(uint64_t const offset, uint64_t const length) const {
+        int const seq = Bases(offset);
+
+        File().getFasta().Copy(seq, offset, length, basesBuffer);
+        return basesString.Set(basesBuffer);
+    }
+    ngs_adapt::StringItf *getReferenceChunk(uint64_t const offset, uint64_t const length) const {
+        return getReferenceBases(offset, length);
+    }
+    uint64_t copyReferenceBases(uint64_t const offset, char *const buffer, uint64_t const size) const {
+        Row();
+
+        int const seq = File().getSequence(cur);
+
+        if (seq < 0)
+            throw std::runtime_error("not available");
+
+        IndexedFasta const &fasta = File().getFasta();
+
+        return offset < fasta.getLength(seq) ? fasta.Read(seq, offset, buffer, size) : 0;
+    }
+    bool getReferenceBasesPacked(uint64_t const offset, uint64_t const length, uint8_t *const bases, uint8_t *const n_mask, uint64_t &count) const {
+        Row();
+
+        int const seq = File().getSequence(cur);
+
+        if (seq < 0)
+            throw std::runtime_error("not available");
+
+        IndexedFasta const &fasta = File().getFasta();
+
+        count = offset < fasta.getLength(seq) ? fasta.ReadPacked(seq, offset, length, bases, n_mask) : 0;
+        return true;
+    }
+    // counted by decoding the slices of the reference
+    uint64_t getAlignmentCount(bool const wants_primary, bool const wants_secondary) const {
+        Row();
+
+        Alignment *const it = Slice(0, getLength(), (wants_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                                                  | (wants_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                                                  | NGS_ReferenceAlignFlags_pass_bad
+                                                  | NGS_ReferenceAlignFlags_pass_dups, 0);
+        uint64_t count = 0;
+
+        try {
+            while (it->nextAlignment())
+                ++count;
+        }
+        catch (...) {
+            it->Release();
+            throw;
+        }
+        it->Release();
+        return count;
+    }
+    ngs_adapt::AlignmentItf *getAlignment(char const id[]) const {
+        Row();
+
+        Alignment *const one = parent->OneAlignment(id);
+
+        try {
+            if (one->Current().refID() != (int32_t)cur)
+                throw std::runtime_error(std::string("no alignment with ID '") + id + "'");
+        }
+        catch (...) {
+            one->Release();
+            throw;
+        }
+        return one;
+    }
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary, bool const want_secondary) const {
+        return getAlignmentSlice(0, getLength(), want_primary, want_secondary);
+    }
+    ngs_adapt::AlignmentItf *getAlignmentSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        uint32_t const flags = (want_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                             | (want_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0)
+                             | NGS_ReferenceAlignFlags_pass_bad
+                             | NGS_ReferenceAlignFlags_pass_dups;
+
+        return getFilteredAlignmentSlice(start, length, flags, 0);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignments(uint32_t const flags, int32_t const map_qual) const {
+        return getFilteredAlignmentSlice(0, getLength(), flags, map_qual);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignmentSlice(int64_t const start, uint64_t const length, uint32_t const flags, int32_t const map_qual) const {
+        return Slice(start, length, flags, map_qual);
+    }
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard, uint32_t const count, bool const want_primary, bool const want_secondary) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getPileups(bool const want_primary, bool const want_secondary) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getFilteredPileups(uint32_t flags, int32_t map_qual) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getPileupSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::PileupItf *getFilteredPileupSlice(int64_t const start, uint64_t const length, uint32_t flags, int32_t map_qual) const {
+        throw std::runtime_error("not available");
+    }
+    bool nextReference() {
+        switch (state) {
+            case 0:
+                if (cur < max) {
+                    state = 1;
+                    return true;
+                }
+                state = 2;
+                return false;
+            case 1:
+                if (++cur < max)
+                    return true;
+                state = 2;
+            case 2:
+                return false;
+            default:
+                throw std::runtime_error("no more rows available");
+        }
+    }
+};
+
+// the read groups of the @RG header lines, in header order
+class CRAMCollection::ReadGroup : public ngs_adapt::ReadGroupItf
+{
+    CRAMCollection *parent;
+    unsigned cur;
+    unsigned const max;
+    int state;                      /* 0 before the first, 1 on one, 2 past the last, 3 just one */
+public:
+    ReadGroup(CRAMCollection const *const Parent, unsigned const current, unsigned const readGroups, int const initState)
+    : parent(static_cast<CRAMCollection *>(Parent->Duplicate()))
+    , cur(current)
+    , max(readGroups)
+    , state(initState)
+    {}
+    ~ReadGroup() {
+        parent->Release();
+    }
+
+    ngs_adapt::StringItf *getName() const {
+        if (state == 2)
+            throw std::runtime_error("no current row");
+
+        std::string const &ID = parent->file.getReadGroupName(cur);
+
+        return new ngs_adapt::StringItf(ID.data(), ID.size());
+    }
+    ngs_adapt::StatisticsItf *getStatistics() const {
+        throw std::runtime_error("not available");
+    }
+    bool nextReadGroup() {
+        switch (state) {
+            case 0:
+                if (cur < max) {
+                    state = 1;
+                    return true;
+                }
+                state = 2;
+                return false;
+            case 1:
+                if (++cur < max)
+                    return true;
+                state = 2;
+            case 2:
+                return false;
+            default:
+                throw std::runtime_error("no more rows available");
+        }
+    }
+};
+
+ngs_adapt::ReadGroupItf *CRAMCollection::getReadGroups() const
+{
+    return new ReadGroup(this, 0, file.countOfReadGroups(), 0);
+}
+
+ngs_adapt::ReadGroupItf *CRAMCollection::getReadGroup(char const spec[]) const
+{
+    int const i = file.FindReadGroup(spec);
+
+    if (i < 0)
+        throw std::runtime_error(std::string("no read group named '") + spec + "'");
+    return new ReadGroup(this, i, 0, 3);
+}
+
+ngs_adapt::ReferenceItf *CRAMCollection::getReferences() const
+{
+    return new Reference(this, 0, file.countOfReferences(), 0);
+}
+
+ngs_adapt::ReferenceItf *CRAMCollection::getReference(char const spec[]) const
+{
+    int const i = file.FindReference(spec);
+
+    if (i < 0)
+        return NULL;
+    return new Reference(this, i, 0, 3);
+}
+
+CRAMCollection::Alignment *CRAMCollection::OneAlignment(char const spec[]) const
+{
+    uint64_t container;
+    uint32_t slice;
+    size_t record;
+
+    try {
+        if (!ParseAlignmentId(spec, container, slice, record))
+            throw std::runtime_error("no alignment");
+
+        CRAMIndexEntryList one(1);
+
+        one[0].refID = -1;
+        one[0].start = 0;
+        one[0].span = 0;
+        one[0].container = container;
+        one[0].slice = slice;
+        one[0].size = 0;
+
+        return new Alignment(this, one, Alignment::Window(), true, true, true, record);
+    }
+    catch (std::runtime_error const &) {
+        throw std::runtime_error(std::string("no alignment with ID '") + (spec ? spec : "") + "'");
+    }
+}
+
+ngs_adapt::AlignmentItf *CRAMCollection::getAlignment(char const spec[]) const
+{
+    return OneAlignment(spec);
+}
+
+ngs_adapt::AlignmentItf *CRAMCollection::getAlignments(bool const want_primary,
+                                                       bool const want_secondary) const
+{
+    return new Alignment(this, want_primary, want_secondary);
+}
+
+/* Count
+ *  the mapped records, primary and not, with a pass over the file
+ */
+void CRAMCollection::Count() const
+{
+    CRAMReader reader(file, file.getFirstContainer());
+    CRAMSlice slice;
+    uint64_t primary = 0;
+    uint64_t secondary = 0;
+
+    while (reader.Next(slice)) {
+        for (size_t i = 0; i < slice.count(); ++i) {
+            int const flag = slice.record(i).flag();
+
+            if ((flag & 0x0004) != 0)
+                continue;
+            if ((flag & 0x0900) == 0)
+                ++primary;
+            else
+                ++secondary;
+        }
+    }
+    primaryCount = primary;
+    secondaryCount = secondary;
+    counted = true;
+}
+
+uint64_t CRAMCollection::getAlignmentCount(bool const want_primary,
+                                           bool const want_secondary) const
+{
+    if (!want_primary && !want_secondary)
+        return 0;
+
+    pthread_mutex_lock(&countLock);
+    try {
+        if (!counted)
+            Count();
+    }
+    catch (...) {
+        pthread_mutex_unlock(&countLock);
+        throw;
+    }
+    pthread_mutex_unlock(&countLock);
+    return (want_primary ? primaryCount : 0) + (want_secondary ? secondaryCount : 0);
+}
+
+ngs_adapt::ReadCollectionItf *OpenCRAMCollection(std::string const &path, NGS_BAM::OpenOptions const &options)
+{
+    return new CRAMCollection(path, options);
+}
@@ -0,0 +1,2359 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include <ngs-bam/ngs-bam.hpp>
+#include "slot.hpp"
+#include "columns.hpp"
+
+#include <ngs/ReadCollection.hpp>
+#include <ngs/ReferenceIterator.hpp>
+#include <ngs/Alignment.hpp>
+#include <ngs/PileupEvent.hpp>
+#include <ngs/adapter/ReadCollectionItf.hpp>
+#include <ngs/adapter/AlignmentItf.hpp>
+#include <ngs/adapter/ReferenceItf.hpp>
+#include <ngs/adapter/PileupItf.hpp>
+#include <ngs/adapter/StringItf.hpp>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+#include <set>
+
+/* MemoryStore
+ *  what materialize reads or openColumns loads, a column per field, the
+ *  rows of each reference together and in position order; row "i" is
+ *  the alignment with ID i + 1
+ *  it is filled once and then only read, by any number of iterators
+ */
+struct MemoryStore
+{
+    enum RowFlags {
+        primary = 0x01,             /* as NGS_AlignmentBatchFlags_* */
+        reversed = 0x02,
+        hasMate = 0x04,
+        mateReversed = 0x08,
+        hasQualities = 0x10
+    };
+    /* which of the fields that not every engine gives were read, or
+     * were loaded from a column cache, as NGS_BAM::ColumnOptions::Column */
+    enum Fields {
+        withBases = 0x01,
+        withQualities = 0x02,
+        withReadNames = 0x04,
+        withReadGroups = 0x08,
+        withCigar = 0x10,
+        withMates = 0x20,
+        withTags = 0x40
+    };
+    /* a tag's entry in the arena of tags, before its "count" values */
+    struct Tag {
+        char tag[2];
+        char type;                  /* as NGS_AlignmentTag_v1 */
+        uint8_t isArray;
+        uint32_t count;
+    };
+    struct Reference {
+        std::string commonName;
+        std::string canonicalName;
+        uint64_t length;
+        bool circular;
+        uint32_t features;          /* NGS_ReferenceFeature_* of the names */
+        size_t first;               /* its rows */
+        size_t end;
+        uint64_t maxSpan;           /* of its alignments, for slices */
+        uint64_t primaryCount;
+    };
+
+    std::string name;
+    std::vector<Reference> references;
+    std::map<std::string, int32_t> referenceIndex;
+    unsigned fields;
+
+    /* the rows */
+    std::vector<int64_t> position;
+    std::vector<uint64_t> span;
+    std::vector<uint64_t> templateLength;
+    std::vector<uint8_t> mapQual;
+    std::vector<uint8_t> flags;
+    std::vector<int32_t> reference;
+    std::vector<int32_t> mateReference;
+    std::vector<uint32_t> readName;     /* into strings */
+    std::vector<uint32_t> readGroup;
+    std::vector<uint64_t> baseAt;       /* into bases and qualities */
+    std::vector<uint32_t> baseCount;
+    std::vector<uint64_t> cigarAt;
+    std::vector<uint32_t> cigarCount;
+    std::vector<uint64_t> tagAt;
+    std::vector<uint32_t> tagBytes;
+
+    /* the arenas */
+    std::vector<uint8_t> bases;         /* 4-bit codes, as BAM packs them */
+    std::string qualities;              /* a character per base */
+    std::vector<uint32_t> cigar;        /* as BAM packs them */
+    std::vector<uint8_t> tags;          /* a Tag and its values for each tag kept */
+    std::vector<std::string> strings;   /* each read name and group once; 0 is "" */
+    std::vector<size_t> byName;         /* rows by read name, for mates */
+
+    MemoryStore() : fields(0) {
+        strings.push_back(std::string());
+    }
+
+    size_t rows() const {
+        return position.size();
+    }
+    uint8_t baseCode(uint64_t const i) const {
+        uint8_t const b4na2 = bases[i >> 1];
+        return (i & 1) != 0 ? (b4na2 & 15) : (b4na2 >> 4);
+    }
+    char base(uint64_t const i) const {
+        return "=ACMGRSVTWYHKDBN"[baseCode(i)];
+    }
+    /* Need
+     *  throws unless every one of "field" was read
+     */
+    void Need(unsigned const field) const {
+        if ((fields & field) != field)
+            throw std::runtime_error("not available");
+    }
+    /* TagSize
+     *  the bytes of each value of a tag of "type", 0 for a type not known
+     */
+    static unsigned TagSize(char const type) {
+        switch (type) {
+            case 'A': case 'c': case 'C': case 'Z': case 'H':
+                return 1;
+            case 's': case 'S':
+                return 2;
+            case 'i': case 'I': case 'f':
+                return 4;
+            default:
+                return 0;
+        }
+    }
+};
+
+/* MemoryFilter
+ *  what a slice's flags and mapping quality ask of a row; failed and
+ *  duplicate alignments were left out, or not, by materialize
+ */
+struct MemoryFilter
+{
+    int64_t beg;
+    int64_t end;
+    int32_t minMapQ;
+    int32_t maxMapQ;
+    bool wantPrimary;
+    bool wantSecondary;
+    bool windowed;
+    bool startWithin;
+
+    MemoryFilter(bool const WantPrimary, bool const WantSecondary)
+    : beg(0)
+    , end(0)
+    , minMapQ(0)
+    , maxMapQ(255)
+    , wantPrimary(WantPrimary)
+    , wantSecondary(WantSecondary)
+    , windowed(false)
+    , startWithin(false)
+    {}
+    MemoryFilter(int64_t const Beg, int64_t const End, uint32_t const flags, int32_t const mapQual)
+    : beg(Beg)
+    , end(End)
+    , minMapQ((flags & NGS_ReferenceAlignFlags_min_map_qual) != 0 ? mapQual : 0)
+    , maxMapQ((flags & NGS_ReferenceAlignFlags_max_map_qual) != 0 ? mapQual : 255)
+    , wantPrimary((flags & NGS_ReferenceAlignFlags_wants_primary) != 0)
+    , wantSecondary((flags & NGS_ReferenceAlignFlags_wants_secondary) != 0)
+    , windowed(true)
+    , startWithin((flags & NGS_ReferenceAlignFlags_start_within_window) != 0)
+    {}
+
+    bool Accepts(MemoryStore const &store, size_t const row) const {
+        bool const primary = (store.flags[row] & MemoryStore::primary) != 0;
+
+        if (primary ? !wantPrimary : !wantSecondary)
+            return false;
+        if (store.mapQual[row] < minMapQ || store.mapQual[row] > maxMapQ)
+            return false;
+        if (!windowed)
+            return true;
+
+        int64_t const pos = store.position[row];
+        int64_t const len = store.span[row] > 0 ? (int64_t)store.span[row] : 1;
+
+        if (pos >= end || pos + len <= beg)
+            return false;
+        return !startWithin || pos >= beg;
+    }
+};
+
+/* MemoryCollection
+ *  a MemoryStore as a read collection: its references, their alignments
+ *  and pileups, and alignments by ID, row range and shard
+ *  reads and read groups are not available
+ */
+class MemoryCollection : public ngs_adapt::ReadCollectionItf
+{
+    class Alignment;
+    class Reference;
+    class Pileup;
+
+    MemoryStore store;
+
+    /* Rows
+     *  the first row of "ref" that may overlap a window from "beg"
+     */
+    size_t Rows(MemoryStore::Reference const &ref, int64_t const beg) const;
+public:
+    MemoryCollection(ngs::ReadCollection const &source, std::vector<NGS_BAM::Interval> const &regions,
+                     ngs::Alignment::AlignmentCategory const categories, ngs::Alignment::AlignmentFilter const filters,
+                     int32_t const mappingQuality);
+    MemoryCollection(std::string const &directory, unsigned const columns, std::vector<NGS_BAM::Interval> const &regions);
+
+    Alignment *OneAlignment(char const spec[]) const;
+
+    ngs_adapt::StringItf *getName() const {
+        return new ngs_adapt::StringItf(store.name.data(), store.name.size());
+    }
+    ngs_adapt::ReadGroupItf *getReadGroups() const {
+        throw std::runtime_error("not available");
+    }
+    bool hasReadGroup(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadGroupItf *getReadGroup(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReferenceItf *getReferences() const;
+    bool hasReference(char const spec[]) const {
+        return spec != 0 && store.referenceIndex.find(spec) != store.referenceIndex.end();
+    }
+    ngs_adapt::ReferenceItf *getReference(char const spec[]) const;
+    ngs_adapt::AlignmentItf *getAlignment(char const spec[]) const;
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary,
+                                           bool const want_secondary) const;
+    uint64_t getAlignmentCount(bool const want_primary,
+                               bool const want_secondary) const;
+    ngs_adapt::AlignmentItf *getAlignmentRange(uint64_t const first,
+                                               uint64_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary) const;
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard,
+                                               uint32_t const count,
+                                               bool const want_primary,
+                                               bool const want_secondary) const;
+    uint64_t getReadCount(bool const want_full,
+                          bool const want_partial,
+                          bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getRead(char const spec[]) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getReads(bool const want_full,
+                                 bool const want_partial,
+                                 bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::ReadItf *getReadRange(uint64_t const first,
+                                     uint64_t const count,
+                                     bool const want_full,
+                                     bool const want_partial,
+                                     bool const want_unaligned) const {
+        throw std::runtime_error("not available");
+    }
+    uint32_t getFeatures() const {
+        return NGS_ReadCollectionFeature_references
+             | NGS_ReadCollectionFeature_alignment_by_id
+             | NGS_ReadCollectionFeature_alignments
+             | NGS_ReadCollectionFeature_alignment_count
+             | NGS_ReadCollectionFeature_alignment_range
+             | NGS_ReadCollectionFeature_alignment_shard;
+    }
+};
+
+size_t MemoryCollection::Rows(MemoryStore::Reference const &ref, int64_t const beg) const
+{
+    int64_t const from = beg - (int64_t)ref.maxSpan;
+
+    return std::lower_bound(store.position.begin() + ref.first, store.position.begin() + ref.end, from)
+         - store.position.begin();
+}
+
+/* Soft clips
+ *  the bases the S operations at either end of a CIGAR leave out,
+ *  inside any H operations
+ */
+static void SoftClips(uint32_t const ops[], uint32_t const count, uint32_t clip[2])
+{
+    clip[0] = clip[1] = 0;
+
+    uint32_t i = 0;
+    uint32_t j = count;
+
+    while (i < j && (ops[i] & 15) == 5)
+        ++i;
+    while (i < j && (ops[i] & 15) == 4)
+        clip[0] += ops[i++] >> 4;
+    while (j > i && (ops[j - 1] & 15) == 5)
+        --j;
+    while (j > i && (ops[j - 1] & 15) == 4)
+        clip[1] += ops[--j] >> 4;
+}
+
+/* FormatCigar
+ *  the text of a CIGAR with "OPCODE" for its codes, neighboring operations
+ *  of the same letter as one; "clipped" leaves out the clips at the ends
+ */
+static void FormatCigar(uint32_t const ops[], uint32_t const count, bool const clipped, char const OPCODE[], std::string &rslt)
+{
+    uint32_t i = 0;
+    uint32_t j = count;
+
+    rslt.clear();
+    if (clipped) {
+        while (i < j && ((ops[i] & 15) == 4 || (ops[i] & 15) == 5))
+            ++i;
+        while (j > i && ((ops[j - 1] & 15) == 4 || (ops[j - 1] & 15) == 5))
+            --j;
+    }
+    while (i < j) {
+        char const code = OPCODE[ops[i] & 15];
+        unsigned long len = 0;
+
+        for ( ; i < j && OPCODE[ops[i] & 15] == code; ++i)
+            len += ops[i] >> 4;
+
+        char buffer[32];
+
+        rslt.append(buffer, snprintf(buffer, sizeof(buffer), "%lu%c", len, code));
+    }
+}
+
+static void FormatAlignmentId(size_t const row, std::string &rslt)
+{
+    char buffer[32];
+
+    rslt.assign(buffer, snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)row + 1));
+}
+
+/* MemoryCollection::Alignment
+ *  the rows [next, end) that "filter" accepts; a window stops at the
+ *  first row that starts after it
+ *  with one already at its row, it is that alignment alone
+ */
+class MemoryCollection::Alignment : public ngs_adapt::AlignmentItf
+{
+    friend class MemoryCollection;
+    friend class Reference;
+
+    mutable std::string textBuffer;
+    mutable std::string idBuffer;
+    mutable StringSlot alignmentIdString;
+    mutable StringSlot mateAlignmentIdString;
+    mutable StringSlot referenceSpecString;
+    mutable StringSlot readIdString;
+    mutable StringSlot readGroupString;
+    mutable StringSlot basesString;
+    mutable StringSlot qualitiesString;
+    mutable StringSlot cigarString;
+    mutable StringSlot mateReferenceSpecString;
+
+    MemoryCollection *parent;
+    MemoryStore const &store;
+    size_t next;
+    size_t const end;
+    size_t row;                     /* current, or end */
+    MemoryFilter const filter;
+    bool const single;
+
+    size_t Current() const {
+        if (row >= end)
+            throw std::runtime_error("no current row");
+        return row;
+    }
+    // the bases [offset, offset + length) of the current row, of at most "count"
+    void Bases(uint64_t offset, uint64_t length, std::string &dst) const {
+        size_t const i = Current();
+        uint64_t const count = store.baseCount[i];
+
+        store.Need(MemoryStore::withBases);
+        if (offset > count)
+            offset = count;
+        if (length > count - offset)
+            length = count - offset;
+        dst.resize(length);
+        for (uint64_t k = 0; k < length; ++k)
+            dst[k] = store.base(store.baseAt[i] + offset + k);
+    }
+    // the qualities likewise; empty if the row has none
+    ngs_adapt::StringItf *Qualities(uint64_t offset, uint64_t length) const {
+        size_t const i = Current();
+        uint64_t const count = store.baseCount[i];
+
+        store.Need(MemoryStore::withQualities);
+        if ((store.flags[i] & MemoryStore::hasQualities) == 0)
+            return qualitiesString.Set("", 0);
+        if (offset > count)
+            offset = count;
+        if (length > count - offset)
+            length = count - offset;
+        return qualitiesString.Set(store.qualities.data() + store.baseAt[i] + offset, length);
+    }
+    void Clips(uint32_t clip[2]) const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withCigar);
+        SoftClips(&store.cigar[0] + store.cigarAt[i], store.cigarCount[i], clip);
+    }
+    ngs_adapt::StringItf *getCigar(bool const clipped, char const OPCODE[]) const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withCigar);
+        FormatCigar(&store.cigar[0] + store.cigarAt[i], store.cigarCount[i], clipped, OPCODE, textBuffer);
+        return cigarString.Set(textBuffer);
+    }
+    size_t FindMate() const;
+public:
+    Alignment(MemoryCollection const *const Parent, size_t const First, size_t const End,
+              MemoryFilter const &Filter, bool const Single = false)
+    : parent(static_cast<MemoryCollection *>(Parent->Duplicate()))
+    , store(Parent->store)
+    , next(First)
+    , end(End)
+    , row(Single ? First : End)
+    , filter(Filter)
+    , single(Single)
+    {}
+    ~Alignment() {
+        parent->Release();
+    }
+
+    ngs_adapt::StringItf *getFragmentId() const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::StringItf *getFragmentBases(uint64_t const offset, uint64_t const length) const {
+        Bases(offset, length, textBuffer);
+        return basesString.Set(textBuffer);
+    }
+    ngs_adapt::StringItf *getFragmentQualities(uint64_t const offset, uint64_t const length) const {
+        return Qualities(offset, length);
+    }
+    // lent from the arena, where a row may start in the middle of a byte
+    bool getFragmentBasesPacked(uint64_t const Offset, uint64_t const Length, NGS_FragmentPackedBases_v1 &packed) const {
+        size_t const i = Current();
+        uint64_t const count = store.baseCount[i];
+        uint64_t const offset = Offset < count ? Offset : count;
+        uint64_t const at = store.baseAt[i] + offset;
+
+        store.Need(MemoryStore::withBases);
+        packed.bases = store.bases.empty() ? 0 : &store.bases[0] + (at >> 1);
+        packed.count = Length < count - offset ? Length : count - offset;
+        packed.phase = (uint32_t)(at & 1);
+        return true;
+    }
+    ngs_adapt::StringItf *getClippedFragmentBases() const {
+        uint32_t clip[2];
+
+        Clips(clip);
+
+        uint64_t const count = store.baseCount[row];
+        uint64_t const left = clip[0] < count ? clip[0] : count;
+        uint64_t const right = clip[1] < count - left ? clip[1] : count - left;
+
+        Bases(left, count - left - right, textBuffer);
+        return basesString.Set(textBuffer);
+    }
+    ngs_adapt::StringItf *getClippedFragmentQualities() const {
+        uint32_t clip[2];
+
+        Clips(clip);
+
+        uint64_t const count = store.baseCount[row];
+        uint64_t const left = clip[0] < count ? clip[0] : count;
+        uint64_t const right = clip[1] < count - left ? clip[1] : count - left;
+
+        return Qualities(left, count - left - right);
+    }
+    // all of the bases, soft clips included
+    ngs_adapt::StringItf *getAlignedFragmentBases() const {
+        return getFragmentBases(0, store.baseCount[Current()]);
+    }
+    ngs_adapt::StringItf *getAlignmentId() const {
+        FormatAlignmentId(Current(), idBuffer);
+        return alignmentIdString.Set(idBuffer);
+    }
+    ngs_adapt::StringItf *getReferenceSpec() const {
+        return referenceSpecString.Set(store.references[store.reference[Current()]].commonName);
+    }
+    int32_t getMappingQuality() const {
+        return store.mapQual[Current()];
+    }
+    int32_t getReferenceIndex() const {
+        return store.reference[Current()];
+    }
+    int32_t getMateReferenceIndex() const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withMates);
+        return store.mateReference[i];
+    }
+    ngs_adapt::StringItf *getReferenceBases() const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::StringItf *getReadGroup() const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withReadGroups);
+
+        std::string const &group = store.strings[store.readGroup[i]];
+
+        if (group.empty())
+            return 0;
+        return readGroupString.Set(group);
+    }
+    ngs_adapt::StringItf *getReadId() const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withReadNames);
+        return readIdString.Set(store.strings[store.readName[i]]);
+    }
+    bool isPrimary() const {
+        return (store.flags[Current()] & MemoryStore::primary) != 0;
+    }
+    int64_t getAlignmentPosition() const {
+        return store.position[Current()];
+    }
+    uint64_t getReferencePositionProjectionRange(int64_t const ref_pos) const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getAlignmentLength() const {
+        return store.span[Current()];
+    }
+    bool getIsReversedOrientation() const {
+        return (store.flags[Current()] & MemoryStore::reversed) != 0;
+    }
+    int32_t getSoftClip(uint32_t const edge) const {
+        uint32_t clip[2];
+
+        Clips(clip);
+        if (edge > 1)
+            throw std::runtime_error("invalid clip edge");
+        return clip[edge];
+    }
+    uint64_t getTemplateLength() const {
+        return store.templateLength[Current()];
+    }
+    ngs_adapt::StringItf *getShortCigar(bool const clipped) const {
+        return getCigar(clipped, "MIDNSHPMM???????");
+    }
+    ngs_adapt::StringItf *getLongCigar(bool const clipped) const {
+        return getCigar(clipped, "MIDNSHP=X???????");
+    }
+    char getRNAOrientation() const {
+        throw std::runtime_error("not available");
+    }
+    bool hasMate() const {
+        return (store.flags[Current()] & MemoryStore::hasMate) != 0;
+    }
+    ngs_adapt::StringItf *getMateAlignmentId() const {
+        size_t const mate = FindMate();
+
+        if (mate == store.rows())
+            return 0;
+        FormatAlignmentId(mate, idBuffer);
+        return mateAlignmentIdString.Set(idBuffer);
+    }
+    ngs_adapt::AlignmentItf *getMateAlignment() const {
+        size_t const mate = FindMate();
+
+        if (mate == store.rows())
+            throw std::runtime_error("the mate was not found");
+        return new Alignment(parent, mate, store.rows(), MemoryFilter(true, true), true);
+    }
+    ngs_adapt::StringItf *getMateReferenceSpec() const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withMates);
+
+        int32_t const mateRef = store.mateReference[i];
+
+        if (mateRef < 0)
+            return mateReferenceSpecString.Set("", 0);
+        return mateReferenceSpecString.Set(store.references[mateRef].commonName);
+    }
+    bool getMateIsReversedOrientation() const {
+        return (store.flags[Current()] & MemoryStore::mateReversed) != 0;
+    }
+    // the CIGARs are kept packed, so they are always lent
+    bool getCigarOps(NGS_AlignmentCigar_v1 &cigar) const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withCigar);
+        cigar.ops = store.cigar.empty() ? 0 : &store.cigar[0] + store.cigarAt[i];
+        cigar.count = store.cigarCount[i];
+        return true;
+    }
+    // lent from the arena of tags; only those kept are found
+    bool getTag(char const tag[], NGS_AlignmentTag_v1 &value) const {
+        size_t const i = Current();
+
+        store.Need(MemoryStore::withTags);
+
+        uint8_t const *p = store.tags.empty() ? 0 : &store.tags[0] + store.tagAt[i];
+        uint8_t const *const end = p + store.tagBytes[i];
+
+        while (p < end) {
+            MemoryStore::Tag entry;
+
+            memcpy(&entry, p, sizeof(entry));
+            p += sizeof(entry);
+            if (entry.tag[0] == tag[0] && entry.tag[1] == tag[1]) {
+                value.data = p;
+                value.count = entry.count;
+                value.type = entry.type;
+                value.is_array = entry.isArray != 0;
+                return true;
+            }
+            p += (size_t)entry.count * MemoryStore::TagSize(entry.type);
+        }
+        return false;
+    }
+    void getCore(NGS_AlignmentCore_v1 &core) const {
+        size_t const i = Current();
+
+        core.position = store.position[i];
+        core.length = store.span[i];
+        core.template_len = store.templateLength[i];
+        core.map_qual = store.mapQual[i];
+        core.flags = store.flags[i] & (NGS_AlignmentBatchFlags_primary
+                                     | NGS_AlignmentBatchFlags_reversed
+                                     | NGS_AlignmentBatchFlags_has_mate);
+    }
+    uint32_t getSupportedMessages() const {
+        uint32_t rslt = NGS_AlignmentMessage_id
+                      | NGS_AlignmentMessage_ref_spec
+                      | NGS_AlignmentMessage_map_qual
+                      | NGS_AlignmentMessage_is_primary
+                      | NGS_AlignmentMessage_align_pos
+                      | NGS_AlignmentMessage_align_length
+                      | NGS_AlignmentMessage_is_reversed
+                      | NGS_AlignmentMessage_template_len
+                      | NGS_AlignmentMessage_has_mate
+                      | NGS_AlignmentMessage_mate_is_reversed;
+
+        if (store.fields & MemoryStore::withCigar)
+            rslt |= NGS_AlignmentMessage_soft_clip | NGS_AlignmentMessage_cigar;
+        if (store.fields & MemoryStore::withMates)
+            rslt |= NGS_AlignmentMessage_mate_ref_spec;
+        if (store.fields & MemoryStore::withReadNames)
+            rslt |= NGS_AlignmentMessage_read_id;
+        if ((store.fields & (MemoryStore::withReadNames | MemoryStore::withMates))
+                         == (MemoryStore::withReadNames | MemoryStore::withMates))
+            rslt |= NGS_AlignmentMessage_mate_id | NGS_AlignmentMessage_mate_alignment;
+        if (store.fields & MemoryStore::withTags)
+            rslt |= NGS_AlignmentMessage_tags;
+        if (store.fields & MemoryStore::withBases)
+            rslt |= NGS_AlignmentMessage_fragment_bases | NGS_AlignmentMessage_clipped_frag_bases
+                  | NGS_AlignmentMessage_aligned_frag_bases;
+        if (store.fields & MemoryStore::withQualities)
+            rslt |= NGS_AlignmentMessage_fragment_quals | NGS_AlignmentMessage_clipped_frag_quals;
+        if (store.fields & MemoryStore::withReadGroups)
+            rslt |= NGS_AlignmentMessage_read_group;
+        return rslt;
+    }
+    bool nextAlignment() {
+        if (single)
+            throw std::runtime_error("no more rows available");
+        row = end;
+        while (next < end) {
+            size_t const i = next++;
+
+            if (filter.windowed && store.position[i] >= filter.end) {
+                next = end;
+                break;
+            }
+            if (filter.Accepts(store, i)) {
+                row = i;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/* FindMate
+ *  the other row with the same read name whose reference is the mate's
+ *  and whose mate's reference is this one's, a primary one first;
+ *  store.rows() if the copy hasn't the mate's row
+ */
+size_t MemoryCollection::Alignment::FindMate() const
+{
+    size_t const i = Current();
+
+    if ((store.flags[i] & MemoryStore::hasMate) == 0)
+        throw std::runtime_error("no mate");
+    store.Need(MemoryStore::withReadNames | MemoryStore::withMates);
+
+    uint32_t const name = store.readName[i];
+    size_t lo = 0;
+    size_t hi = store.byName.size();
+
+    while (lo < hi) {
+        size_t const mid = lo + (hi - lo) / 2;
+
+        if (store.readName[store.byName[mid]] < name)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    size_t found = store.rows();
+
+    for ( ; lo < store.byName.size() && store.readName[store.byName[lo]] == name; ++lo) {
+        size_t const j = store.byName[lo];
+
+        if (j == i || (store.flags[j] & MemoryStore::hasMate) == 0)
+            continue;
+        if (store.reference[j] != store.mateReference[i] || store.mateReference[j] != store.reference[i])
+            continue;
+        if ((store.flags[j] & MemoryStore::primary) != 0)
+            return j;
+        if (found == store.rows())
+            found = j;
+    }
+    return found;
+}
+
+/* MemoryCollection::Pileup
+ *  the rows of a window that the filter accepts, entered as the columns
+ *  reach them and walked along their CIGARs
+ */
+class MemoryCollection::Pileup : public ngs_adapt::PileupItf
+{
+    struct Active {
+        size_t row;
+        int64_t first;              /* first reference position */
+        int64_t end;                /* first reference position past the end */
+        uint32_t op;                /* current CIGAR operation */
+        uint32_t left;              /* reference positions left in op, including this one */
+        uint32_t seqPos;            /* sequence position at this reference position */
+        uint32_t insPos;            /* insertion just before this reference position */
+        uint32_t insLen;
+        int code;                   /* CIGAR code of op */
+
+        friend bool operator <(Active const &a, Active const &b) {
+            return a.end < b.end;
+        }
+    };
+
+    MemoryCollection *parent;
+    MemoryStore const &store;
+    int32_t const refIndex;
+    size_t next;                    /* the next row to enter */
+    size_t const last;
+    int64_t const end;
+    int64_t column;
+    MemoryFilter const filter;
+    bool started;
+    std::vector<Active> active;
+    int event;                      /* index into active, -1 before the first event */
+    mutable std::string textBuffer;
+    mutable StringSlot textString;
+    mutable StringSlot alignmentIdString;
+    mutable StringSlot referenceSpecString;
+
+    static bool consumesSequence(int const code) {
+        return code == 0 || code == 7 || code == 8;
+    }
+    uint32_t const *Ops(Active const &a) const {
+        return &store.cigar[0] + store.cigarAt[a.row];
+    }
+    // find the next operation at or after op that consumes reference,
+    // gathering any insertion on the way
+    void Enter(Active &a) const {
+        uint32_t const n = store.cigarCount[a.row];
+        uint32_t const *const ops = n > 0 ? Ops(a) : 0;
+
+        a.insLen = 0;
+        for ( ; a.op < n; ++a.op) {
+            int const code = ops[a.op] & 0x0F;
+            uint32_t const len = ops[a.op] >> 4;
+
+            switch (code) {
+                case 1: /* I */
+                    if (a.insLen == 0)
+                        a.insPos = a.seqPos;
+                    a.insLen += len;
+                    a.seqPos += len;
+                    break;
+                case 4: /* S */
+                    a.seqPos += len;
+                    break;
+                case 0: /* M */
+                case 2: /* D */
+                case 3: /* N */
+                case 7: /* = */
+                case 8: /* X */
+                    if (len > 0) {
+                        a.left = len;
+                        a.code = code;
+                        return;
+                    }
+                    break;
+            }
+        }
+        a.left = 0;
+    }
+    void Advance(Active &a, int64_t n) const {
+        while (n > 0 && a.left > 0) {
+            uint32_t const k = n < a.left ? (uint32_t)n : a.left;
+
+            if (consumesSequence(a.code))
+                a.seqPos += k;
+            a.left -= k;
+            a.insLen = 0;
+            n -= k;
+            if (a.left == 0) {
+                ++a.op;
+                Enter(a);
+            }
+        }
+    }
+    void Start(size_t const row) {
+        Active a;
+
+        a.row = row;
+        a.first = store.position[row];
+        a.end = a.first + (int64_t)store.span[row];
+        a.op = 0;
+        a.seqPos = 0;
+        a.insPos = 0;
+        Enter(a);
+        Advance(a, column - a.first);
+        if (a.end > column)
+            active.insert(std::upper_bound(active.begin(), active.end(), a), a);
+    }
+    Active const &Current() const {
+        if (event < 0 || (unsigned)event >= active.size())
+            throw std::runtime_error("no current event");
+        return active[event];
+    }
+    void Row() const {
+        if (!started || column >= end)
+            throw std::runtime_error("no current row");
+    }
+    char Base(Active const &a) const {
+        return consumesSequence(a.code) ? store.base(store.baseAt[a.row] + a.seqPos) : '-';
+    }
+    char Quality(Active const &a) const {
+        if (!consumesSequence(a.code) || (store.flags[a.row] & MemoryStore::hasQualities) == 0)
+            return '!';
+        return store.qualities[store.baseAt[a.row] + a.seqPos];
+    }
+public:
+    Pileup(MemoryCollection const *const Parent, int32_t const RefIndex, size_t const First, size_t const Last,
+           MemoryFilter const &Filter)
+    : parent(static_cast<MemoryCollection *>(Parent->Duplicate()))
+    , store(Parent->store)
+    , refIndex(RefIndex)
+    , next(First)
+    , last(Last)
+    , end(Filter.end)
+    , column(Filter.beg)
+    , filter(Filter)
+    , started(false)
+    , event(-1)
+    {}
+    ~Pileup() {
+        parent->Release();
+    }
+
+    int32_t getMappingQuality() const {
+        return store.mapQual[Current().row];
+    }
+    int32_t getReferenceIndex() const {
+        Current();
+        return refIndex;
+    }
+    int32_t getMateReferenceIndex() const {
+        Active const &a = Current();
+
+        store.Need(MemoryStore::withMates);
+        return store.mateReference[a.row];
+    }
+    ngs_adapt::StringItf *getAlignmentId() const {
+        FormatAlignmentId(Current().row, textBuffer);
+        return alignmentIdString.Set(textBuffer);
+    }
+    int64_t getAlignmentPosition() const {
+        return Current().seqPos;
+    }
+    int64_t getFirstAlignmentPosition() const {
+        return Current().first;
+    }
+    int64_t getLastAlignmentPosition() const {
+        return Current().end - 1;
+    }
+    uint32_t getEventType() const {
+        Active const &a = Current();
+        uint32_t type;
+
+        switch (a.code) {
+            case 2: /* D */
+            case 3: /* N */
+                type = ngs::PileupEvent::deletion;
+                break;
+            case 8: /* X */
+                type = ngs::PileupEvent::mismatch;
+                break;
+            default:
+                type = ngs::PileupEvent::match;
+                break;
+        }
+        if (a.insLen > 0)
+            type |= ngs::PileupEvent::insertion;
+        if (column == a.first)
+            type |= ngs::PileupEvent::alignment_start;
+        if (column + 1 == a.end)
+            type |= ngs::PileupEvent::alignment_stop;
+        if ((store.flags[a.row] & MemoryStore::reversed) != 0)
+            type |= ngs::PileupEvent::alignment_minus_strand;
+        return type;
+    }
+    char getAlignmentBase() const {
+        Active const &a = Current();
+
+        store.Need(MemoryStore::withBases);
+        return Base(a);
+    }
+    char getAlignmentQuality() const {
+        Active const &a = Current();
+
+        store.Need(MemoryStore::withQualities);
+        return Quality(a);
+    }
+    ngs_adapt::StringItf *getInsertionBases() const {
+        Active const &a = Current();
+
+        store.Need(MemoryStore::withBases);
+        textBuffer.resize(a.insLen);
+        for (uint32_t k = 0; k < a.insLen; ++k)
+            textBuffer[k] = store.base(store.baseAt[a.row] + a.insPos + k);
+        return textString.Set(textBuffer);
+    }
+    ngs_adapt::StringItf *getInsertionQualities() const {
+        Active const &a = Current();
+
+        store.Need(MemoryStore::withQualities);
+        if ((store.flags[a.row] & MemoryStore::hasQualities) == 0)
+            return textString.Set("", 0);
+        return textString.Set(store.qualities.data() + store.baseAt[a.row] + a.insPos, a.insLen);
+    }
+    uint32_t getEventRepeatCount() const {
+        return Current().left;
+    }
+    // the tags that tell the direction of transcription aren't kept
+    uint32_t getEventIndelType() const {
+        return Current().code == 3 ? ngs::PileupEvent::intron_unknown : ngs::PileupEvent::normal_indel;
+    }
+    bool nextPileupEvent() {
+        Row();
+        if (event + 1 < (int)active.size()) {
+            ++event;
+            return true;
+        }
+        event = (int)active.size();
+        return false;
+    }
+    void resetPileupEvent() {
+        event = -1;
+    }
+
+    ngs_adapt::StringItf *getReferenceSpec() const {
+        return referenceSpecString.Set(store.references[refIndex].commonName);
+    }
+    int64_t getReferencePosition() const {
+        Row();
+        return column;
+    }
+    char getReferenceBase() const {
+        throw std::runtime_error("not available");
+    }
+    uint32_t getPileupDepth() const {
+        Row();
+        return (uint32_t)active.size();
+    }
+    bool nextPileup() {
+        if (!started)
+            started = true;
+        else if (column < end) {
+            ++column;
+            for (unsigned i = 0; i < active.size(); ++i)
+                Advance(active[i], 1);
+        }
+        event = -1;
+        if (column >= end)
+            return false;
+
+        unsigned done = 0;
+        while (done < active.size() && active[done].end <= column)
+            ++done;
+        active.erase(active.begin(), active.begin() + done);
+        for ( ; next < last && store.position[next] <= column; ++next) {
+            if (filter.Accepts(store, next))
+                Start(next);
+        }
+        return true;
+    }
+};
+
+/* MemoryCollection::Reference
+ *  the references of the source collection, in its order, each with
+ *  the rows kept of it
+ */
+class MemoryCollection::Reference : public ngs_adapt::ReferenceItf
+{
+    MemoryCollection *parent;
+    MemoryStore const &store;
+    unsigned cur;
+    unsigned max;
+    int state;                      /* 0 before the first, 1 on one, 2 past the last, 3 just one */
+
+    MemoryStore::Reference const &Ref() const {
+        if (state == 0 || state == 2)
+            throw std::runtime_error("no current row");
+        return store.references[cur];
+    }
+    // the window, truncated to the reference
+    MemoryFilter Window(int64_t const Start, uint64_t const length, uint32_t const flags, int32_t const map_qual) const {
+        MemoryStore::Reference const &ref = Ref();
+        int64_t const start = Start < 0 ? 0 : Start;
+        uint64_t const room = (uint64_t)start < ref.length ? ref.length - start : 0;
+
+        return MemoryFilter(start, start + (int64_t)(length < room ? length : room), flags, map_qual);
+    }
+public:
+    Reference(MemoryCollection const *const Parent, unsigned const current, unsigned const references, int const initState)
+    : parent(static_cast<MemoryCollection *>(Parent->Duplicate()))
+    , store(Parent->store)
+    , cur(current)
+    , max(references)
+    , state(initState)
+    {}
+    ~Reference() {
+        parent->Release();
+    }
+
+    ngs_adapt::StringItf *getCommonName() const {
+        std::string const &name = Ref().commonName;
+
+        return new ngs_adapt::StringItf(name.data(), name.size());
+    }
+    ngs_adapt::StringItf *getCanonicalName() const {
+        MemoryStore::Reference const &ref = Ref();
+
+        if ((ref.features & NGS_ReferenceFeature_canonical_name) == 0)
+            throw std::runtime_error("not available");
+        return new ngs_adapt::StringItf(ref.canonicalName.data(), ref.canonicalName.size());
+    }
+    bool getIsCircular() const {
+        MemoryStore::Reference const &ref = Ref();
+
+        if ((ref.features & NGS_ReferenceFeature_circularity) == 0)
+            throw std::runtime_error("not available");
+        return ref.circular;
+    }
+    uint64_t getLength() const {
+        return Ref().length;
+    }
+    uint32_t getFeatures() const {
+        if (state == 0 || state == 2)
+            return 0;
+        return Ref().features
+             | NGS_ReferenceFeature_alignment_by_id
+             | NGS_ReferenceFeature_alignments
+             | NGS_ReferenceFeature_alignment_count
+             | NGS_ReferenceFeature_alignment_shard
+             | ((store.fields & MemoryStore::withCigar) != 0 ? NGS_ReferenceFeature_pileups : 0);
+    }
+    ngs_adapt::StringItf *getReferenceBases(uint64_t const offset, uint64_t const length) const {
+        throw std::runtime_error("not available");
+    }
+    ngs_adapt::StringItf *getReferenceChunk(uint64_t const offset, uint64_t const length) const {
+        throw std::runtime_error("not available");
+    }
+    uint64_t getAlignmentCount(bool const wants_primary, bool const wants_secondary) const {
+        MemoryStore::Reference const &ref = Ref();
+
+        return (wants_primary ? ref.primaryCount : 0)
+             + (wants_secondary ? ref.end - ref.first - ref.primaryCount : 0);
+    }
+    ngs_adapt::AlignmentItf *getAlignment(char const id[]) const {
+        Ref();
+
+        Alignment *const one = parent->OneAlignment(id);
+
+        if (store.reference[one->row] != (int32_t)cur) {
+            one->Release();
+            throw std::runtime_error(std::string("no alignment with ID '") + id + "'");
+        }
+        return one;
+    }
+    ngs_adapt::AlignmentItf *getAlignments(bool const want_primary, bool const want_secondary) const {
+        MemoryStore::Reference const &ref = Ref();
+
+        return new Alignment(parent, ref.first, ref.end, MemoryFilter(want_primary, want_secondary));
+    }
+    ngs_adapt::AlignmentItf *getAlignmentSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        uint32_t const flags = (want_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                             | (want_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0);
+
+        return getFilteredAlignmentSlice(start, length, flags, 0);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignments(uint32_t const flags, int32_t const map_qual) const {
+        return getFilteredAlignmentSlice(0, getLength(), flags, map_qual);
+    }
+    ngs_adapt::AlignmentItf *getFilteredAlignmentSlice(int64_t const start, uint64_t const length, uint32_t const flags, int32_t const map_qual) const {
+        MemoryFilter const window = Window(start, length, flags, map_qual);
+        MemoryStore::Reference const &ref = store.references[cur];
+
+        return new Alignment(parent, parent->Rows(ref, window.beg), ref.end, window);
+    }
+    ngs_adapt::AlignmentItf *getAlignmentShard(uint32_t const shard, uint32_t const count, bool const want_primary, bool const want_secondary) const {
+        MemoryStore::Reference const &ref = Ref();
+
+        if (count == 0 || shard >= count)
+            throw std::runtime_error("invalid shard");
+
+        uint64_t const n = ref.end - ref.first;
+
+        return new Alignment(parent, ref.first + (size_t)(n * shard / count), ref.first + (size_t)(n * (shard + 1) / count),
+                             MemoryFilter(want_primary, want_secondary));
+    }
+    ngs_adapt::PileupItf *getPileups(bool const want_primary, bool const want_secondary) const {
+        return getPileupSlice(0, getLength(), want_primary, want_secondary);
+    }
+    ngs_adapt::PileupItf *getFilteredPileups(uint32_t flags, int32_t map_qual) const {
+        return getFilteredPileupSlice(0, getLength(), flags, map_qual);
+    }
+    ngs_adapt::PileupItf *getPileupSlice(int64_t const start, uint64_t const length, bool const want_primary, bool const want_secondary) const {
+        uint32_t const flags = (want_primary ? NGS_ReferenceAlignFlags_wants_primary : 0)
+                             | (want_secondary ? NGS_ReferenceAlignFlags_wants_secondary : 0);
+
+        return getFilteredPileupSlice(start, length, flags, 0);
+    }
+    ngs_adapt::PileupItf *getFilteredPileupSlice(int64_t const start, uint64_t const length, uint32_t flags, int32_t map_qual) const {
+        MemoryFilter const window = Window(start, length, flags, map_qual);
+        MemoryStore::Reference const &ref = store.references[cur];
+
+        store.Need(MemoryStore::withCigar);
+        return new Pileup(parent, cur, parent->Rows(ref, window.beg), ref.end, window);
+    }
+    bool nextReference() {
+        switch (state) {
+            case 0:
+                if (cur < max) {
+                    state = 1;
+                    return true;
+                }
+                state = 2;
+                return false;
+            case 1:
+                if (++cur < max)
+                    return true;
+                state = 2;
+            case 2:
+                return false;
+            default:
+                throw std::runtime_error("no more rows available");
+        }
+    }
+};
+
+ngs_adapt::ReferenceItf *MemoryCollection::getReferences() const
+{
+    return new Reference(this, 0, (unsigned)store.references.size(), 0);
+}
+
+ngs_adapt::ReferenceItf *MemoryCollection::getReference(char const spec[]) const
+{
+    std::map<std::string, int32_t>::const_iterator const i = store.referenceIndex.find(spec ? spec : "");
+
+    if (i == store.referenceIndex.end())
+        return NULL;
+    return new Reference(this, i->second, 0, 3);
+}
+
+MemoryCollection::Alignment *MemoryCollection::OneAlignment(char const spec[]) const
+{
+    char *endp = 0;
+    unsigned long long const id = spec != 0 && *spec >= '1' && *spec <= '9' ? strtoull(spec, &endp, 10) : 0;
+
+    if (id == 0 || *endp != '\0' || id > store.rows())
+        throw std::runtime_error(std::string("no alignment with ID '") + (spec ? spec : "") + "'");
+    return new Alignment(this, (size_t)(id - 1), store.rows(), MemoryFilter(true, true), true);
+}
+
+ngs_adapt::AlignmentItf *MemoryCollection::getAlignment(char const spec[]) const
+{
+    return OneAlignment(spec);
+}
+
+ngs_adapt::AlignmentItf *MemoryCollection::getAlignments(bool const want_primary,
+                                                         bool const want_secondary) const
+{
+    return new Alignment(this, 0, store.rows(), MemoryFilter(want_primary, want_secondary));
+}
+
+uint64_t MemoryCollection::getAlignmentCount(bool const want_primary,
+                                             bool const want_secondary) const
+{
+    uint64_t primary = 0;
+
+    for (size_t i = 0; i < store.references.size(); ++i)
+        primary += store.references[i].primaryCount;
+    return (want_primary ? primary : 0) + (want_secondary ? store.rows() - primary : 0);
+}
+
+// rows [first, first + count), counted from 1
+ngs_adapt::AlignmentItf *MemoryCollection::getAlignmentRange(uint64_t const first,
+                                                             uint64_t const count,
+                                                             bool const want_primary,
+                                                             bool const want_secondary) const
+{
+    uint64_t const rows = store.rows();
+    uint64_t const beg = first == 0 ? 0 : first - 1 < rows ? first - 1 : rows;
+    uint64_t const end = count < rows - beg ? beg + count : rows;
+
+    return new Alignment(this, (size_t)beg, (size_t)end, MemoryFilter(want_primary, want_secondary));
+}
+
+ngs_adapt::AlignmentItf *MemoryCollection::getAlignmentShard(uint32_t const shard,
+                                                             uint32_t const count,
+                                                             bool const want_primary,
+                                                             bool const want_secondary) const
+{
+    if (count == 0 || shard >= count)
+        throw std::runtime_error("invalid shard");
+
+    uint64_t const n = store.rows();
+
+    return new Alignment(this, (size_t)(n * shard / count), (size_t)(n * (shard + 1) / count),
+                         MemoryFilter(want_primary, want_secondary));
+}
+
+/* Intern
+ *  the index of "value" in the store's strings, added if it is new
+ */
+static uint32_t Intern(MemoryStore &store, std::map<std::string, uint32_t> &index, std::string const &value)
+{
+    if (value.empty())
+        return 0;
+
+    std::map<std::string, uint32_t>::const_iterator const i = index.find(value);
+
+    if (i != index.end())
+        return i->second;
+
+    uint32_t const rslt = (uint32_t)store.strings.size();
+
+    store.strings.push_back(value);
+    index.insert(std::make_pair(value, rslt));
+    return rslt;
+}
+
+// rows [first, first + order.size()) of a column, into "order"
+template <typename T>
+static void Permute(std::vector<T> &column, size_t const first, std::vector<size_t> const &order)
+{
+    std::vector<T> moved(order.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+        moved[i] = column[first + order[i]];
+    std::copy(moved.begin(), moved.end(), column.begin() + first);
+}
+
+struct RowPositionLess
+{
+    std::vector<int64_t> const &position;
+    size_t const first;
+
+    RowPositionLess(std::vector<int64_t> const &Position, size_t const First) : position(Position), first(First) {}
+
+    bool operator ()(size_t const a, size_t const b) const {
+        return position[first + a] < position[first + b];
+    }
+};
+
+struct RowNameLess
+{
+    std::vector<uint32_t> const &name;
+
+    explicit RowNameLess(std::vector<uint32_t> const &Name) : name(Name) {}
+
+    bool operator ()(size_t const a, size_t const b) const {
+        return name[a] < name[b] || (name[a] == name[b] && a < b);
+    }
+};
+
+/* Sort
+ *  the rows of a reference into position order, if a slice of the
+ *  source didn't give them in it; the arenas stay as they are
+ */
+static void Sort(MemoryStore &store, MemoryStore::Reference const &ref)
+{
+    size_t const n = ref.end - ref.first;
+    std::vector<int64_t>::const_iterator const beg = store.position.begin() + ref.first;
+
+    for (size_t i = 1; ; ++i) {
+        if (i >= n)
+            return;
+        if (beg[i] < beg[i - 1])
+            break;
+    }
+
+    std::vector<size_t> order(n);
+
+    for (size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), RowPositionLess(store.position, ref.first));
+
+    Permute(store.position, ref.first, order);
+    Permute(store.span, ref.first, order);
+    Permute(store.templateLength, ref.first, order);
+    Permute(store.mapQual, ref.first, order);
+    Permute(store.flags, ref.first, order);
+    Permute(store.reference, ref.first, order);
+    Permute(store.mateReference, ref.first, order);
+    Permute(store.readName, ref.first, order);
+    Permute(store.readGroup, ref.first, order);
+    Permute(store.baseAt, ref.first, order);
+    Permute(store.baseCount, ref.first, order);
+    Permute(store.cigarAt, ref.first, order);
+    Permute(store.cigarCount, ref.first, order);
+    Permute(store.tagAt, ref.first, order);
+    Permute(store.tagBytes, ref.first, order);
+}
+
+/* TagAccess
+ *  the optional fields of an alignment as its engine lends them
+ */
+struct TagAccess : public ngs::Alignment
+{
+    static bool Find(ngs::Alignment const &alignment, char const tag[], NGS_AlignmentTag_v1 &value) {
+        ngs::AlignmentItf const *const itf = reinterpret_cast<ngs::AlignmentItf const *>(alignment.*(&TagAccess::self));
+
+        return itf->getTag(tag, value);
+    }
+};
+
+/* Reader
+ *  the fields of the alignments of a source's slices into a store
+ */
+class Reader
+{
+    MemoryStore &store;
+    std::map<std::string, uint32_t> strings;
+    std::vector<uint8_t> packBuffer;
+    std::vector<uint32_t> cigarBuffer;
+    std::vector<std::string> const &tags;   /* to keep of each alignment */
+    uint64_t nextBase;              /* in the arena of bases */
+    bool mateIndex;                 /* the source gives mates' reference indices */
+    bool tagsLent;                  /* the source gives optional fields */
+
+    void AppendBases(ngs::Fragment::PackedBases const &packed) {
+        for (uint64_t i = 0; i < packed.count; ++i, ++nextBase) {
+            uint8_t const code = packed.code(i);
+
+            if ((nextBase & 1) == 0)
+                store.bases.push_back((uint8_t)(code << 4));
+            else
+                store.bases.back() |= code;
+        }
+    }
+    void AppendTags(ngs::Alignment const &alignment) {
+        for (size_t k = 0; k < tags.size() && tagsLent; ++k) {
+            NGS_AlignmentTag_v1 value;
+
+            try {
+                if (!TagAccess::Find(alignment, tags[k].c_str(), value))
+                    continue;
+            }
+            catch (ngs::ErrorMsg const &) {
+                tagsLent = false;
+                break;
+            }
+
+            unsigned const size = MemoryStore::TagSize(value.type);
+
+            if (size == 0)
+                continue;
+
+            MemoryStore::Tag const entry = { { tags[k][0], tags[k][1] }, value.type, (uint8_t)(value.is_array ? 1 : 0), value.count };
+            uint8_t const *const data = static_cast<uint8_t const *>(value.data);
+
+            store.tags.insert(store.tags.end(), (uint8_t const *)&entry, (uint8_t const *)(&entry + 1));
+            if (value.count > 0)
+                store.tags.insert(store.tags.end(), data, data + (size_t)value.count * size);
+        }
+    }
+public:
+    Reader(MemoryStore &Store, std::vector<std::string> const &Tags)
+    : store(Store)
+    , tags(Tags)
+    , nextBase(0)
+    , mateIndex(true)
+    , tagsLent(!Tags.empty())
+    {}
+
+    /* Slice
+     *  the alignments of the slice [start, end) of a reference with index
+     *  "refIndex"; those that started before it and are in "spanning" were
+     *  read with a slice before, and those that go past its end are added
+     */
+    void Slice(ngs::Reference const &ref, int32_t const refIndex, uint64_t const start, uint64_t const end,
+               ngs::Alignment::AlignmentCategory const categories, ngs::Alignment::AlignmentFilter const filters,
+               int32_t const mappingQuality, std::set<std::string> &spanning)
+    {
+        ngs::AlignmentIterator it = ref.getFilteredAlignmentSlice(start, end - start, categories, filters, mappingQuality);
+        bool asked = false;
+        bool wantBases = false;
+        bool wantQualities = false;
+        bool wantReadId = false;
+        bool wantReadGroup = false;
+
+        while (it.nextAlignment()) {
+            if (!asked) {
+                wantBases = it.supports(ngs::Alignment::fragmentBasesMessage);
+                wantQualities = it.supports(ngs::Alignment::fragmentQualitiesMessage);
+                wantReadId = it.supports(ngs::Alignment::readIdMessage);
+                wantReadGroup = it.supports(ngs::Alignment::readGroupMessage);
+                asked = true;
+            }
+
+            ngs::Alignment::Core const core = it.getCore();
+            bool const before = core.alignmentPosition < (int64_t)start;
+            bool const after = core.alignmentPosition + (int64_t)core.alignmentLength > (int64_t)end;
+
+            if (before || after) {
+                std::string const id = it.getAlignmentId().toString();
+
+                if (before && spanning.find(id) != spanning.end())
+                    continue;
+                if (after)
+                    spanning.insert(id);
+            }
+
+            uint8_t flags = (core.primary ? MemoryStore::primary : 0)
+                          | (core.reversedOrientation ? MemoryStore::reversed : 0)
+                          | (core.mate ? MemoryStore::hasMate : 0);
+            int32_t mateRef = -1;
+
+            if (core.mate) {
+                if (it.getMateIsReversedOrientation())
+                    flags |= MemoryStore::mateReversed;
+                if (mateIndex) {
+                    try {
+                        mateRef = it.getMateReferenceIndex();
+                    }
+                    catch (ngs::ErrorMsg const &) {
+                        mateIndex = false;
+                    }
+                }
+                if (!mateIndex) {
+                    std::map<std::string, int32_t>::const_iterator const i = store.referenceIndex.find(it.getMateReferenceSpec());
+
+                    mateRef = i == store.referenceIndex.end() ? -1 : i->second;
+                }
+            }
+
+            uint32_t name = 0;
+            uint32_t group = 0;
+
+            if (wantReadId) {
+                ngs::StringView const view = it.getReadIdView();
+
+                name = Intern(store, strings, std::string(view.data(), view.size()));
+            }
+            if (wantReadGroup) {
+                ngs::String value;
+
+                if (it.tryGetReadGroup(value))
+                    group = Intern(store, strings, value);
+            }
+
+            uint64_t const baseAt = nextBase;
+            uint64_t count = 0;
+
+            if (wantBases) {
+                ngs::Fragment::PackedBases const packed = it.getFragmentBasesPacked(packBuffer);
+
+                AppendBases(packed);
+                count = packed.count;
+            }
+            if (wantQualities) {
+                ngs::StringView const quals = it.getFragmentQualitiesView();
+
+                store.qualities.resize(baseAt, '!');
+                if (quals.size() == count && count != 0) {
+                    store.qualities.append(quals.data(), quals.size());
+                    flags |= MemoryStore::hasQualities;
+                }
+            }
+
+            ngs::Alignment::CigarOps const ops = it.getCigarOps(cigarBuffer);
+            uint64_t const tagAt = store.tags.size();
+
+            AppendTags(it);
+
+            store.position.push_back(core.alignmentPosition);
+            store.span.push_back(core.alignmentLength);
+            store.templateLength.push_back(core.templateLength);
+            store.mapQual.push_back((uint8_t)(core.mappingQuality < 0 ? 0 : core.mappingQuality > 255 ? 255 : core.mappingQuality));
+            store.flags.push_back(flags);
+            store.reference.push_back(refIndex);
+            store.mateReference.push_back(mateRef);
+            store.readName.push_back(name);
+            store.readGroup.push_back(group);
+            store.baseAt.push_back(baseAt);
+            store.baseCount.push_back((uint32_t)count);
+            store.cigarAt.push_back(store.cigar.size());
+            store.cigarCount.push_back(ops.count);
+            store.cigar.insert(store.cigar.end(), ops.ops, ops.ops + ops.count);
+            store.tagAt.push_back(tagAt);
+            store.tagBytes.push_back((uint32_t)(store.tags.size() - tagAt));
+        }
+        if (asked) {
+            store.fields |= (wantBases ? MemoryStore::withBases : 0)
+                          | (wantQualities ? MemoryStore::withQualities : 0)
+                          | (wantReadId ? MemoryStore::withReadNames : 0)
+                          | (wantReadGroup ? MemoryStore::withReadGroups : 0)
+                          | (tagsLent ? MemoryStore::withTags : 0);
+        }
+    }
+};
+
+typedef std::vector<std::pair<uint64_t, uint64_t> > Spans;
+
+/* References
+ *  those of "source", in its order
+ */
+static void References(MemoryStore &store, ngs::ReadCollection const &source)
+{
+    store.name = source.getName();
+
+    ngs::ReferenceIterator refs = source.getReferences();
+
+    while (refs.nextReference()) {
+        MemoryStore::Reference ref;
+
+        ref.commonName = refs.getCommonName();
+        ref.length = refs.getLength();
+        ref.circular = false;
+        ref.features = 0;
+        ref.first = ref.end = 0;
+        ref.maxSpan = 0;
+        ref.primaryCount = 0;
+        try {
+            ref.canonicalName = refs.getCanonicalName();
+            ref.features |= NGS_ReferenceFeature_canonical_name;
+        }
+        catch (ngs::ErrorMsg const &) {
+        }
+        try {
+            ref.circular = refs.getIsCircular();
+            ref.features |= NGS_ReferenceFeature_circularity;
+        }
+        catch (ngs::ErrorMsg const &) {
+        }
+        store.referenceIndex.insert(std::make_pair(ref.commonName, (int32_t)store.references.size()));
+        store.references.push_back(ref);
+    }
+}
+
+/* Wanted
+ *  the spans of each reference that "regions" ask for, sorted; all of
+ *  each if there are none
+ */
+static std::vector<Spans> Wanted(MemoryStore const &store, std::vector<NGS_BAM::Interval> const &regions)
+{
+    std::vector<Spans> wanted(store.references.size());
+
+    if (regions.empty()) {
+        for (size_t i = 0; i < store.references.size(); ++i)
+            wanted[i].push_back(std::make_pair(uint64_t(0), store.references[i].length));
+    }
+    for (size_t i = 0; i < regions.size(); ++i) {
+        std::map<std::string, int32_t>::const_iterator const r = store.referenceIndex.find(regions[i].reference);
+
+        if (r == store.referenceIndex.end())
+            throw std::runtime_error("no reference named '" + regions[i].reference + "'");
+
+        uint64_t const length = store.references[r->second].length;
+        uint64_t const end = regions[i].end < length ? regions[i].end : length;
+
+        if (regions[i].start < end)
+            wanted[r->second].push_back(std::make_pair(regions[i].start, end));
+    }
+    for (size_t i = 0; i < wanted.size(); ++i)
+        std::sort(wanted[i].begin(), wanted[i].end());
+    return wanted;
+}
+
+/* Measure
+ *  the longest span and the primary alignments of the rows of "ref"
+ */
+static void Measure(MemoryStore const &store, MemoryStore::Reference &ref)
+{
+    ref.maxSpan = 0;
+    ref.primaryCount = 0;
+    for (size_t row = ref.first; row < ref.end; ++row) {
+        if (store.span[row] > ref.maxSpan)
+            ref.maxSpan = store.span[row];
+        if ((store.flags[row] & MemoryStore::primary) != 0)
+            ++ref.primaryCount;
+    }
+}
+
+/* ReadReference
+ *  the rows of reference "i" of "source" that "spans" ask for, merged
+ *  where they overlap or touch, in position order
+ */
+static void ReadReference(MemoryStore &store, Reader &reader, ngs::ReadCollection const &source, size_t const i,
+                          Spans const &spans, ngs::Alignment::AlignmentCategory const categories,
+                          ngs::Alignment::AlignmentFilter const filters, int32_t const mappingQuality)
+{
+    MemoryStore::Reference &ref = store.references[i];
+
+    ref.first = store.rows();
+    if (!spans.empty()) {
+        ngs::Reference const source_ref = source.getReference(ref.commonName);
+        std::set<std::string> spanning;
+
+        for (size_t j = 0; j < spans.size(); ) {
+            uint64_t const start = spans[j].first;
+            uint64_t end = spans[j].second;
+
+            for (++j; j < spans.size() && spans[j].first <= end; ++j) {
+                if (spans[j].second > end)
+                    end = spans[j].second;
+            }
+            reader.Slice(source_ref, (int32_t)i, start, end, categories, filters, mappingQuality, spanning);
+        }
+    }
+    ref.end = store.rows();
+    Sort(store, ref);
+    Measure(store, ref);
+}
+
+/* IndexNames
+ *  the rows by read name, for mates
+ */
+static void IndexNames(MemoryStore &store)
+{
+    if ((store.fields & MemoryStore::withReadNames) != 0) {
+        store.byName.resize(store.rows());
+        for (size_t i = 0; i < store.byName.size(); ++i)
+            store.byName[i] = i;
+        std::sort(store.byName.begin(), store.byName.end(), RowNameLess(store.readName));
+    }
+}
+
+/* Materialize
+ *  the references of "source", then the slices of each that "regions"
+ *  ask for
+ */
+static void Materialize(MemoryStore &store, ngs::ReadCollection const &source, std::vector<NGS_BAM::Interval> const &regions,
+                        ngs::Alignment::AlignmentCategory const categories, ngs::Alignment::AlignmentFilter const filters,
+                        int32_t const mappingQuality)
+{
+    References(store, source);
+
+    std::vector<Spans> const wanted = Wanted(store, regions);
+    std::vector<std::string> const noTags;
+    Reader reader(store, noTags);
+
+    store.fields = MemoryStore::withCigar | MemoryStore::withMates;
+    for (size_t i = 0; i < store.references.size(); ++i)
+        ReadReference(store, reader, source, i, wanted[i], categories, filters, mappingQuality);
+    IndexNames(store);
+}
+
+MemoryCollection::MemoryCollection(ngs::ReadCollection const &source, std::vector<NGS_BAM::Interval> const &regions,
+                                   ngs::Alignment::AlignmentCategory const categories,
+                                   ngs::Alignment::AlignmentFilter const filters,
+                                   int32_t const mappingQuality)
+{
+    Materialize(store, source, regions, categories, filters, mappingQuality);
+}
+
+ngs::ReadCollection NGS_BAM::materialize(ngs::ReadCollection const &collection, std::vector<Interval> const &regions,
+                                         ngs::Alignment::AlignmentCategory const categories,
+                                         ngs::Alignment::AlignmentFilter const filters,
+                                         int32_t const mappingQuality)
+{
+    ngs_adapt::ReadCollectionItf *const self = new MemoryCollection(collection, regions, categories, filters, mappingQuality);
+    NGS_ReadCollection_v1 *const c_obj = self->Cast();
+    ngs::ReadCollectionItf *const ngs_itf = ngs::ReadCollectionItf::Cast(c_obj);
+
+    return ngs::ReadCollection(ngs_itf);
+}
+
+/*--------------------------------------------------------------------------
+ * column caches
+ *  a directory with a file for each column of the rows, or for the arena
+ *  of one, see ColumnWriter, each in the same chunks; "zones" has a
+ *  ColumnZone for each chunk, and "columns", written last, the fields
+ *  written and the references
+ */
+static unsigned const columnsVersion = 1;
+
+enum ColumnFileId {
+    colPosition, colSpan, colTemplateLength, colFlags, colMapQual,
+    colMateReference, colCigarCount, colCigar, colBaseCount, colBases, colQualities,
+    colReadName, colReadGroup, colTagBytes, colTags,
+    columnFiles
+};
+
+/* the name of each file and the fields it is kept for, any of them; 0 for always */
+static struct {
+    char const *name;
+    unsigned fields;
+} const columnFile[columnFiles] = {
+    { "position", 0 },
+    { "span", 0 },
+    { "templateLength", 0 },
+    { "flags", 0 },
+    { "mapQual", 0 },
+    { "mateReference", MemoryStore::withMates },
+    { "cigarCount", MemoryStore::withCigar },
+    { "cigar", MemoryStore::withCigar },
+    { "baseCount", MemoryStore::withBases | MemoryStore::withQualities },
+    { "bases", MemoryStore::withBases },
+    { "qualities", MemoryStore::withQualities },
+    { "readName", MemoryStore::withReadNames },
+    { "readGroup", MemoryStore::withReadGroups },
+    { "tagBytes", MemoryStore::withTags },
+    { "tags", MemoryStore::withTags }
+};
+
+static bool ColumnKept(unsigned const id, unsigned const fields)
+{
+    return columnFile[id].fields == 0 || (columnFile[id].fields & fields) != 0;
+}
+
+template <typename T>
+static void AppendBytes(std::vector<uint8_t> &dst, T const *const src, size_t const count)
+{
+    uint8_t const *const bytes = reinterpret_cast<uint8_t const *>(src);
+
+    dst.insert(dst.end(), bytes, bytes + count * sizeof(T));
+}
+
+/* Gather
+ *  the chunk of file "id" of rows [first, end) into "dst"; the bases
+ *  of a chunk are packed from its first
+ */
+static void Gather(MemoryStore const &store, unsigned const id, size_t const first, size_t const end, std::vector<uint8_t> &dst)
+{
+    size_t const n = end - first;
+
+    dst.clear();
+    switch (id) {
+        case colPosition:
+            AppendBytes(dst, &store.position[first], n);
+            break;
+        case colSpan:
+            AppendBytes(dst, &store.span[first], n);
+            break;
+        case colTemplateLength:
+            AppendBytes(dst, &store.templateLength[first], n);
+            break;
+        case colFlags:
+            AppendBytes(dst, &store.flags[first], n);
+            break;
+        case colMapQual:
+            AppendBytes(dst, &store.mapQual[first], n);
+            break;
+        case colMateReference:
+            AppendBytes(dst, &store.mateReference[first], n);
+            break;
+        case colCigarCount:
+            AppendBytes(dst, &store.cigarCount[first], n);
+            break;
+        case colCigar:
+            for (size_t row = first; row < end; ++row) {
+                if (store.cigarCount[row] > 0)
+                    AppendBytes(dst, &store.cigar[store.cigarAt[row]], store.cigarCount[row]);
+            }
+            break;
+        case colBaseCount:
+            AppendBytes(dst, &store.baseCount[first], n);
+            break;
+        case colBases: {
+            uint64_t next = 0;
+
+            for (size_t row = first; row < end; ++row) {
+                for (uint64_t k = 0; k < store.baseCount[row]; ++k, ++next) {
+                    uint8_t const code = store.baseCode(store.baseAt[row] + k);
+
+                    if ((next & 1) == 0)
+                        dst.push_back((uint8_t)(code << 4));
+                    else
+                        dst.back() |= code;
+                }
+            }
+            break;
+        }
+        case colQualities:
+            for (size_t row = first; row < end; ++row) {
+                if ((store.flags[row] & MemoryStore::hasQualities) != 0)
+                    AppendBytes(dst, store.qualities.data() + store.baseAt[row], store.baseCount[row]);
+                else
+                    dst.resize(dst.size() + store.baseCount[row], '!');
+            }
+            break;
+        case colReadName:
+        case colReadGroup:
+            for (size_t row = first; row < end; ++row) {
+                std::string const &value = store.strings[id == colReadName ? store.readName[row] : store.readGroup[row]];
+
+                AppendBytes(dst, value.c_str(), value.size() + 1);
+            }
+            break;
+        case colTagBytes:
+            AppendBytes(dst, &store.tagBytes[first], n);
+            break;
+        case colTags:
+            for (size_t row = first; row < end; ++row) {
+                if (store.tagBytes[row] > 0)
+                    AppendBytes(dst, &store.tags[store.tagAt[row]], store.tagBytes[row]);
+            }
+            break;
+    }
+}
+
+/* Zone
+ *  of rows [first, end) of reference "ref"
+ */
+static ColumnZone Zone(MemoryStore const &store, int32_t const ref, size_t const first, size_t const end)
+{
+    ColumnZone zone;
+
+    memset(&zone, 0, sizeof(zone));
+    zone.posMin = store.position[first];
+    zone.posMax = store.position[first];
+    zone.endMax = store.position[first];
+    zone.reference = ref;
+    zone.rows = (uint32_t)(end - first);
+    zone.flagAll = store.flags[first];
+    zone.flagAny = store.flags[first];
+    zone.mqMin = store.mapQual[first];
+    zone.mqMax = store.mapQual[first];
+    for (size_t row = first; row < end; ++row) {
+        int64_t const pos = store.position[row];
+        int64_t const rowEnd = pos + (store.span[row] > 0 ? (int64_t)store.span[row] : 1);
+
+        zone.posMin = std::min(zone.posMin, pos);
+        zone.posMax = std::max(zone.posMax, pos);
+        zone.endMax = std::max(zone.endMax, rowEnd);
+        zone.flagAll &= store.flags[row];
+        zone.flagAny |= store.flags[row];
+        zone.mqMin = std::min(zone.mqMin, store.mapQual[row]);
+        zone.mqMax = std::max(zone.mqMax, store.mapQual[row]);
+    }
+    return zone;
+}
+
+/* ClearRows
+ *  all but the references, for the rows of the next one
+ */
+static void ClearRows(MemoryStore &store)
+{
+    MemoryStore empty;
+
+    store.position.swap(empty.position);
+    store.span.swap(empty.span);
+    store.templateLength.swap(empty.templateLength);
+    store.mapQual.swap(empty.mapQual);
+    store.flags.swap(empty.flags);
+    store.reference.swap(empty.reference);
+    store.mateReference.swap(empty.mateReference);
+    store.readName.swap(empty.readName);
+    store.readGroup.swap(empty.readGroup);
+    store.baseAt.swap(empty.baseAt);
+    store.baseCount.swap(empty.baseCount);
+    store.cigarAt.swap(empty.cigarAt);
+    store.cigarCount.swap(empty.cigarCount);
+    store.tagAt.swap(empty.tagAt);
+    store.tagBytes.swap(empty.tagBytes);
+    store.bases.swap(empty.bases);
+    store.qualities.swap(empty.qualities);
+    store.cigar.swap(empty.cigar);
+    store.tags.swap(empty.tags);
+    store.strings.swap(empty.strings);
+    store.byName.swap(empty.byName);
+}
+
+/* WriteManifest
+ *  "columns", by way of a file beside it
+ */
+static void WriteManifest(std::string const &base, MemoryStore const &store, unsigned const fields)
+{
+    std::string const path = base + "columns";
+    std::string const temp = path + ".tmp";
+    FILE *const fp = fopen(temp.c_str(), "w");
+
+    if (fp == 0)
+        throw std::runtime_error("can't create '" + temp + "'");
+
+    bool ok = fprintf(fp, "columns %u %u %llu\n%s\n", columnsVersion, fields,
+                      (unsigned long long)store.references.size(), store.name.c_str()) > 0;
+
+    for (size_t i = 0; i < store.references.size() && ok; ++i) {
+        MemoryStore::Reference const &ref = store.references[i];
+
+        ok = fprintf(fp, "%llu %u %d %s\t%s\n", (unsigned long long)ref.length, ref.features, ref.circular ? 1 : 0,
+                     ref.commonName.c_str(), ref.canonicalName.c_str()) > 0;
+    }
+    if (fclose(fp) != 0 || !ok || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        throw std::runtime_error("can't write '" + path + "'");
+    }
+}
+
+static void WriteZones(std::string const &base, std::vector<ColumnZone> const &zones)
+{
+    std::string const path = base + "zones";
+    std::string const temp = path + ".tmp";
+    FILE *const fp = fopen(temp.c_str(), "wb");
+
+    if (fp == 0)
+        throw std::runtime_error("can't create '" + temp + "'");
+
+    bool const ok = fprintf(fp, "zones %u %llu\n", columnsVersion, (unsigned long long)zones.size()) > 0
+                 && (zones.empty() || fwrite(&zones[0], sizeof(ColumnZone), zones.size(), fp) == zones.size());
+
+    if (fclose(fp) != 0 || !ok || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        throw std::runtime_error("can't write '" + path + "'");
+    }
+}
+
+void NGS_BAM::exportColumns(ngs::ReadCollection const &collection, std::string const &directory, ColumnOptions const &options)
+{
+    for (size_t i = 0; i < options.tagNames.size(); ++i) {
+        if (options.tagNames[i].size() != 2)
+            throw std::runtime_error("a tag is two characters: '" + options.tagNames[i] + "'");
+    }
+    if (options.chunkRows == 0)
+        throw std::runtime_error("invalid chunk size");
+    if (options.level < -1 || options.level > 9)
+        throw std::runtime_error("invalid deflate level");
+    if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST)
+        throw std::runtime_error("can't make directory '" + directory + "'");
+
+    std::string const base = directory + "/";
+    unsigned const asked = options.columns & ColumnOptions::allColumns;
+
+    remove((base + "columns").c_str());     /* no cache until it is made again */
+
+    MemoryStore store;
+
+    References(store, collection);
+
+    std::vector<Spans> const wanted = Wanted(store, options.regions);
+    std::vector<std::string> const noTags;
+    std::vector<std::string> const &tags = (asked & ColumnOptions::tags) != 0 ? options.tagNames : noTags;
+    std::vector<ColumnZone> zones;
+    std::vector<uint8_t> buffer;
+    ColumnWriter *writers[columnFiles] = { 0 };
+
+    store.fields = MemoryStore::withCigar | MemoryStore::withMates;
+    try {
+        for (unsigned id = 0; id < columnFiles; ++id) {
+            if (ColumnKept(id, asked))
+                writers[id] = new ColumnWriter(base + columnFile[id].name, options.level);
+        }
+        for (size_t i = 0; i < store.references.size(); ++i) {
+            Reader reader(store, tags);
+
+            ClearRows(store);
+            ReadReference(store, reader, collection, i, wanted[i], options.categories, options.filters, options.mappingQuality);
+
+            MemoryStore::Reference const &ref = store.references[i];
+
+            for (size_t first = ref.first; first < ref.end; first += options.chunkRows) {
+                size_t const end = ref.end - first > options.chunkRows ? first + options.chunkRows : ref.end;
+
+                zones.push_back(Zone(store, (int32_t)i, first, end));
+                for (unsigned id = 0; id < columnFiles; ++id) {
+                    if (writers[id] == 0)
+                        continue;
+                    Gather(store, id, first, end, buffer);
+                    writers[id]->Write(buffer.empty() ? 0 : &buffer[0], buffer.size());
+                }
+            }
+        }
+
+        /* those the source didn't give are dropped */
+        unsigned const fields = asked & store.fields;
+
+        for (unsigned id = 0; id < columnFiles; ++id) {
+            if (ColumnKept(id, fields))
+                writers[id]->Commit();
+            else
+                remove((base + columnFile[id].name).c_str());
+            delete writers[id];
+            writers[id] = 0;
+        }
+        for (size_t i = 0; i < store.references.size(); ++i)
+            store.references[i].first = store.references[i].end = 0;
+        WriteZones(base, zones);
+        WriteManifest(base, store, fields);
+    }
+    catch (...) {
+        for (unsigned id = 0; id < columnFiles; ++id)
+            delete writers[id];
+        throw;
+    }
+}
+
+/* ReadLine
+ *  the next line of "fp" without its end; false at the end of the file
+ */
+static bool ReadLine(FILE *const fp, std::string &line)
+{
+    int ch;
+
+    line.clear();
+    while ((ch = getc(fp)) != EOF && ch != '\n')
+        line += (char)ch;
+    return ch != EOF || !line.empty();
+}
+
+/* ReadManifest
+ *  the references and name of the cache, and the fields written
+ */
+static unsigned ReadManifest(std::string const &base, MemoryStore &store)
+{
+    std::string const path = base + "columns";
+    FILE *const fp = fopen(path.c_str(), "r");
+
+    if (fp == 0)
+        throw std::runtime_error("no column cache at '" + path + "'");
+
+    std::string line;
+    unsigned version = 0;
+    unsigned fields = 0;
+    unsigned long long count = 0;
+    bool ok = ReadLine(fp, line) && sscanf(line.c_str(), "columns %u %u %llu", &version, &fields, &count) == 3
+           && version == columnsVersion && ReadLine(fp, store.name);
+
+    for (unsigned long long i = 0; i < count && ok; ++i) {
+        MemoryStore::Reference ref;
+        unsigned long long length;
+        int circular;
+        int at = 0;
+
+        ok = ReadLine(fp, line) && sscanf(line.c_str(), "%llu %u %d %n", &length, &ref.features, &circular, &at) == 3 && at > 0;
+        if (!ok)
+            break;
+
+        std::string::size_type const tab = line.find('\t', at);
+
+        ok = tab != std::string::npos;
+        ref.commonName = line.substr(at, tab - at);
+        ref.canonicalName = ok ? line.substr(tab + 1) : std::string();
+        ref.length = length;
+        ref.circular = circular != 0;
+        ref.first = ref.end = 0;
+        ref.maxSpan = 0;
+        ref.primaryCount = 0;
+        store.referenceIndex.insert(std::make_pair(ref.commonName, (int32_t)store.references.size()));
+        store.references.push_back(ref);
+    }
+    fclose(fp);
+    if (!ok)
+        throw std::runtime_error("'" + path + "' is damaged");
+    return fields;
+}
+
+static void ReadZones(std::string const &base, std::vector<ColumnZone> &zones)
+{
+    std::string const path = base + "zones";
+    FILE *const fp = fopen(path.c_str(), "rb");
+
+    if (fp == 0)
+        throw std::runtime_error("can't open '" + path + "'");
+
+    std::string line;
+    unsigned version = 0;
+    unsigned long long count = 0;
+    bool ok = ReadLine(fp, line) && sscanf(line.c_str(), "zones %u %llu", &version, &count) == 2 && version == columnsVersion;
+
+    if (ok) {
+        zones.resize((size_t)count);
+        ok = count == 0 || fread(&zones[0], sizeof(ColumnZone), zones.size(), fp) == zones.size();
+    }
+    fclose(fp);
+    if (!ok)
+        throw std::runtime_error("'" + path + "' is damaged");
+}
+
+/* Overlaps
+ *  whether a chunk has a row that may overlap any of "spans"
+ */
+static bool Overlaps(ColumnZone const &zone, Spans const &spans)
+{
+    for (size_t i = 0; i < spans.size(); ++i) {
+        if (zone.posMin < (int64_t)spans[i].second && zone.endMax > (int64_t)spans[i].first)
+            return true;
+    }
+    return false;
+}
+
+template <typename T>
+static void ReadFixed(ColumnFile const &file, size_t const chunk, size_t const rows, std::vector<T> &column)
+{
+    size_t const first = column.size();
+
+    if (file.Size(chunk) != rows * sizeof(T))
+        throw std::runtime_error("a column chunk is damaged");
+    column.resize(first + rows);
+    if (rows > 0)
+        file.Read(chunk, &column[first]);
+}
+
+// the offsets in an arena of rows [first, end) from "at", and where they end
+static uint64_t Offsets(std::vector<uint64_t> &offset, std::vector<uint32_t> const &count, size_t const first, uint64_t at)
+{
+    for (size_t row = first; row < count.size(); ++row) {
+        offset.push_back(at);
+        at += count[row];
+    }
+    return at;
+}
+
+/* Loader
+ *  the chunks of a cache into a store, each column of those it has
+ */
+class Loader
+{
+    MemoryStore &store;
+    ColumnFile files[columnFiles];
+    std::map<std::string, uint32_t> strings;
+    std::vector<uint8_t> buffer;
+
+    void ReadArena(unsigned const id, size_t const chunk, uint64_t const size) {
+        if (files[id].Size(chunk) != size)
+            throw std::runtime_error("a column chunk is damaged");
+        buffer.resize((size_t)size);
+        if (size > 0)
+            files[id].Read(chunk, &buffer[0]);
+    }
+    void ReadStrings(unsigned const id, size_t const chunk, size_t const rows, std::vector<uint32_t> &column) {
+        buffer.resize(files[id].Size(chunk));
+        if (!buffer.empty())
+            files[id].Read(chunk, &buffer[0]);
+
+        char const *p = reinterpret_cast<char const *>(buffer.empty() ? 0 : &buffer[0]);
+        char const *const end = p + buffer.size();
+
+        for (size_t i = 0; i < rows; ++i) {
+            char const *const nul = static_cast<char const *>(memchr(p, '\0', end - p));
+
+            if (nul == 0)
+                throw std::runtime_error("a column chunk is damaged");
+            column.push_back(Intern(store, strings, std::string(p, nul)));
+            p = nul + 1;
+        }
+    }
+    // nibbles from phase 0 onto the arena of bases, which may end mid-byte
+    void AppendBases(uint64_t const at, uint64_t const count) {
+        if ((at & 1) == 0) {
+            store.bases.insert(store.bases.end(), buffer.begin(), buffer.end());
+            return;
+        }
+        for (uint64_t k = 0; k < count; ++k) {
+            uint8_t const b4na2 = buffer[k >> 1];
+            uint8_t const code = (k & 1) != 0 ? (b4na2 & 15) : (b4na2 >> 4);
+
+            if (((at + k) & 1) == 0)
+                store.bases.push_back((uint8_t)(code << 4));
+            else
+                store.bases.back() |= code;
+        }
+    }
+public:
+    Loader(MemoryStore &Store, std::string const &base, size_t const chunks) : store(Store) {
+        for (unsigned id = 0; id < columnFiles; ++id) {
+            if (ColumnKept(id, store.fields)) {
+                files[id].Open(base + columnFile[id].name);
+                if (files[id].size() != chunks)
+                    throw std::runtime_error("'" + base + columnFile[id].name + "' is damaged");
+            }
+        }
+    }
+
+    void Chunk(size_t const chunk, ColumnZone const &zone) {
+        size_t const first = store.rows();
+        size_t const rows = zone.rows;
+        size_t const end = first + rows;
+        uint64_t const nextBase = first > 0 ? store.baseAt[first - 1] + store.baseCount[first - 1] : 0;
+        unsigned const fields = store.fields;
+
+        ReadFixed(files[colPosition], chunk, rows, store.position);
+        ReadFixed(files[colSpan], chunk, rows, store.span);
+        ReadFixed(files[colTemplateLength], chunk, rows, store.templateLength);
+        ReadFixed(files[colFlags], chunk, rows, store.flags);
+        ReadFixed(files[colMapQual], chunk, rows, store.mapQual);
+        store.reference.resize(end, zone.reference);
+
+        if ((fields & MemoryStore::withMates) != 0)
+            ReadFixed(files[colMateReference], chunk, rows, store.mateReference);
+        else
+            store.mateReference.resize(end, -1);
+
+        if ((fields & MemoryStore::withCigar) != 0) {
+            ReadFixed(files[colCigarCount], chunk, rows, store.cigarCount);
+
+            uint64_t const at = store.cigar.size();
+            uint64_t const ops = Offsets(store.cigarAt, store.cigarCount, first, at) - at;
+
+            ReadArena(colCigar, chunk, ops * sizeof(uint32_t));
+            store.cigar.resize((size_t)(at + ops));
+            if (ops > 0)
+                memcpy(&store.cigar[(size_t)at], &buffer[0], buffer.size());
+        }
+        else {
+            store.cigarCount.resize(end, 0);
+            store.cigarAt.resize(end, store.cigar.size());
+        }
+
+        if ((fields & (MemoryStore::withBases | MemoryStore::withQualities)) != 0) {
+            ReadFixed(files[colBaseCount], chunk, rows, store.baseCount);
+
+            uint64_t const count = Offsets(store.baseAt, store.baseCount, first, nextBase) - nextBase;
+
+            if ((fields & MemoryStore::withBases) != 0) {
+                ReadArena(colBases, chunk, (count + 1) / 2);
+                AppendBases(nextBase, count);
+            }
+            if ((fields & MemoryStore::withQualities) != 0) {
+                ReadArena(colQualities, chunk, count);
+                store.qualities.resize((size_t)nextBase, '!');
+                store.qualities.append(reinterpret_cast<char const *>(buffer.empty() ? 0 : &buffer[0]), buffer.size());
+            }
+        }
+        else {
+            store.baseCount.resize(end, 0);
+            store.baseAt.resize(end, nextBase);
+        }
+
+        if ((fields & MemoryStore::withReadNames) != 0)
+            ReadStrings(colReadName, chunk, rows, store.readName);
+        else
+            store.readName.resize(end, 0);
+        if ((fields & MemoryStore::withReadGroups) != 0)
+            ReadStrings(colReadGroup, chunk, rows, store.readGroup);
+        else
+            store.readGroup.resize(end, 0);
+
+        if ((fields & MemoryStore::withTags) != 0) {
+            ReadFixed(files[colTagBytes], chunk, rows, store.tagBytes);
+
+            uint64_t const at = store.tags.size();
+            uint64_t const bytes = Offsets(store.tagAt, store.tagBytes, first, at) - at;
+
+            ReadArena(colTags, chunk, bytes);
+            store.tags.insert(store.tags.end(), buffer.begin(), buffer.end());
+        }
+        else {
+            store.tagBytes.resize(end, 0);
+            store.tagAt.resize(end, store.tags.size());
+        }
+    }
+};
+
+/* LoadColumns
+ *  the columns of "columns" of the chunks of the cache that "regions"
+ *  ask for, or all of them
+ */
+static void LoadColumns(MemoryStore &store, std::string const &directory, unsigned const columns,
+                        std::vector<NGS_BAM::Interval> const &regions)
+{
+    std::string const base = directory + "/";
+
+    store.fields = ReadManifest(base, store) & columns;
+
+    std::vector<ColumnZone> zones;
+
+    ReadZones(base, zones);
+
+    std::vector<Spans> const wanted = Wanted(store, regions);
+    Loader loader(store, base, zones.size());
+    size_t chunk = 0;
+
+    for (size_t i = 0; i < store.references.size(); ++i) {
+        MemoryStore::Reference &ref = store.references[i];
+
+        ref.first = store.rows();
+        for ( ; chunk < zones.size() && zones[chunk].reference == (int32_t)i; ++chunk) {
+            if (Overlaps(zones[chunk], wanted[i]))
+                loader.Chunk(chunk, zones[chunk]);
+        }
+        ref.end = store.rows();
+        Measure(store, ref);
+    }
+    if (chunk != zones.size())
+        throw std::runtime_error("'" + base + "zones' is damaged");
+    IndexNames(store);
+}
+
+MemoryCollection::MemoryCollection(std::string const &directory, unsigned const columns,
+                                   std::vector<NGS_BAM::Interval> const &regions)
+{
+    LoadColumns(store, directory, columns, regions);
+}
+
+ngs::ReadCollection NGS_BAM::openColumns(std::string const &directory, unsigned const columns,
+                                         std::vector<Interval> const &regions)
+{
+    ngs_adapt::ReadCollectionItf *const self = new MemoryCollection(directory, columns, regions);
+    NGS_ReadCollection_v1 *const c_obj = self->Cast();
+    ngs::ReadCollectionItf *const ngs_itf = ngs::ReadCollectionItf::Cast(c_obj);
+
+    return ngs::ReadCollection(ngs_itf);
+}
@@ -0,0 +1,183 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "numa.hpp"
+
+#if defined(__linux__)
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <vector>
+
+#define NUMA_MAX_NODES 64u          /* the most nodes looked for, and that Prefer's mask has */
+#define NUMA_MPOL_PREFERRED 1       /* the <numaif.h> values, which libnuma has */
+#define NUMA_MPOL_MF_MOVE 2
+
+struct NodeMap
+{
+    std::vector<cpu_set_t> cpus;    /* of each node, none for a node without CPUs */
+    unsigned count;                 /* of nodes with CPUs */
+
+    NodeMap();
+};
+
+/* ReadCPUList
+ *  a list like "0-3,8-11" into "cpus"; false if it names none
+ */
+static bool ReadCPUList(char const *const path, cpu_set_t &cpus)
+{
+    FILE *const fp = fopen(path, "r");
+    bool any = false;
+    
+    CPU_ZERO(&cpus);
+    if (fp == 0)
+        return false;
+    for ( ; ; ) {
+        unsigned first, last;
+        
+        if (fscanf(fp, "%u", &first) != 1)
+            break;
+        last = first;
+        
+        int ch = fgetc(fp);
+        if (ch == '-') {
+            if (fscanf(fp, "%u", &last) != 1)
+                break;
+            ch = fgetc(fp);
+        }
+        for (unsigned cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &cpus);
+            any = true;
+        }
+        if (ch != ',')
+            break;
+    }
+    fclose(fp);
+    return any;
+}
+
+NodeMap::NodeMap()
+: count(0)
+{
+    char path[64];
+    cpu_set_t none;
+    
+    CPU_ZERO(&none);
+    /* nodes may be numbered with gaps, so all are looked for */
+    for (unsigned i = 0; i < NUMA_MAX_NODES; ++i) {
+        cpu_set_t found;
+        
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", i);
+        if (!ReadCPUList(path, found))
+            continue;
+        cpus.resize(i + 1, none);
+        cpus[i] = found;
+        ++count;
+    }
+}
+
+static NodeMap const &Map()
+{
+    static NodeMap const map;
+    return map;
+}
+
+unsigned NUMA::Nodes()
+{
+    unsigned const count = Map().count;
+    return count > 0 ? count : 1;
+}
+
+int NUMA::Current()
+{
+    NodeMap const &map = Map();
+    int const cpu = sched_getcpu();
+    
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return -1;
+    for (unsigned i = 0; i < map.cpus.size(); ++i) {
+        if (CPU_ISSET(cpu, &map.cpus[i]))
+            return (int)i;
+    }
+    return -1;
+}
+
+bool NUMA::Pin(int const node)
+{
+    NodeMap const &map = Map();
+    
+    if (node < 0 || (unsigned)node >= map.cpus.size() || CPU_COUNT(&map.cpus[node]) == 0)
+        return false;
+    return sched_setaffinity(0, sizeof(cpu_set_t), &map.cpus[node]) == 0;
+}
+
+void NUMA::Prefer(void const *const p, size_t const size, int const node)
+{
+#ifdef SYS_mbind
+    static unsigned const maskBits = 8 * sizeof(unsigned long);
+    unsigned long mask[NUMA_MAX_NODES / maskBits];
+    uintptr_t const page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t const start = (uintptr_t)p & ~(page - 1);
+    uintptr_t const end = ((uintptr_t)p + size + page - 1) & ~(page - 1);
+    
+    if (node < 0 || (unsigned)node >= NUMA_MAX_NODES || size == 0)
+        return;
+    memset(mask, 0, sizeof(mask));
+    mask[node / maskBits] = 1ul << (node % maskBits);
+    /* as libnuma does, one more than the bits of the mask; what fails is
+     * left where it is, e.g. without the permission to move pages */
+    syscall(SYS_mbind, start, end - start, NUMA_MPOL_PREFERRED, mask,
+            (unsigned long)NUMA_MAX_NODES + 1, NUMA_MPOL_MF_MOVE);
+#endif
+}
+
+#else
+
+unsigned NUMA::Nodes()
+{
+    return 1;
+}
+
+int NUMA::Current()
+{
+    return -1;
+}
+
+bool NUMA::Pin(int const)
+{
+    return false;
+}
+
+void NUMA::Prefer(void const *const, size_t const, int const)
+{
+}
+
+#endif
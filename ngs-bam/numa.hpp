@@ -0,0 +1,64 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_numa_
+#define _hpp_numa_
+
+#include <stddef.h>
+
+/* NUMA
+ *  the machine's NUMA nodes and their CPUs, read once from
+ *  /sys/devices/system/node, so as not to need libnuma
+ *  a node is a number from 0; -1 is none or not known, and the calls
+ *  given it do nothing, as they all do elsewhere than on Linux
+ */
+class NUMA
+{
+public:
+    /* Nodes
+     *  the number of nodes with CPUs, at least 1
+     */
+    static unsigned Nodes();
+
+    /* Current
+     *  the node of the CPU the calling thread is on
+     */
+    static int Current();
+
+    /* Pin
+     *  keep the calling thread on the CPUs of "node"
+     *  returns false if it couldn't be
+     */
+    static bool Pin(int const node);
+
+    /* Prefer
+     *  have the pages of [p, p + size) on "node", those already there
+     *  moved to it and the rest put there when they are first touched;
+     *  the pages at either end are shared with whatever is next to it
+     */
+    static void Prefer(void const *const p, size_t const size, int const node);
+};
+
+#endif // _hpp_numa_
@@ -0,0 +1,137 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include <string.h>
+
+#include "regions.hpp"
+
+void RegionWindow::Add(uint64_t const beg, uint64_t const end, uint8_t const *const raw, uint32_t const size)
+{
+    Record const rec = { beg, end, data.size(), size };
+
+    records.push_back(rec);
+    data.insert(data.end(), raw, raw + size);
+}
+
+RegionCache::RegionCache(size_t const Limit, MemoryLedger *const Memory)
+: limit(Limit)
+, held(0)
+, clock(0)
+, hits(0)
+, misses(0)
+, memory(Memory)
+{
+    pthread_mutex_init(&mutex, 0);
+}
+
+RegionCache::~RegionCache()
+{
+    for (std::map<uint64_t, Entry *>::const_iterator i = byKey.begin(); i != byKey.end(); ++i)
+        delete i->second;
+    if (memory)
+        memory->Remove(MemoryLedger::regionCache, held);
+    pthread_mutex_destroy(&mutex);
+}
+
+bool RegionCache::Get(unsigned const refID, unsigned const window, RegionWindow &dst)
+{
+    if (limit == 0)
+        return false;
+    
+    pthread_mutex_lock(&mutex);
+    
+    std::map<uint64_t, Entry *>::const_iterator const i = byKey.find(Key(refID, window));
+    bool const found = i != byKey.end();
+    
+    if (found) {
+        Entry &entry = *i->second;
+        
+        entry.used = ++clock;
+        dst.records = entry.window.records;
+        dst.data = entry.window.data;
+    }
+    pthread_mutex_unlock(&mutex);
+    __atomic_fetch_add(found ? &hits : &misses, (uint64_t)1, __ATOMIC_RELAXED);
+    return found;
+}
+
+void RegionCache::Drop(std::map<uint64_t, Entry *>::iterator const i)
+{
+    size_t const bytes = i->second->bytes;
+    
+    delete i->second;
+    byKey.erase(i);
+    held -= bytes;
+    if (memory)
+        memory->Remove(MemoryLedger::regionCache, bytes);
+}
+
+void RegionCache::DropOldest()
+{
+    std::map<uint64_t, Entry *>::iterator oldest = byKey.begin();
+    
+    for (std::map<uint64_t, Entry *>::iterator i = byKey.begin(); i != byKey.end(); ++i) {
+        if (i->second->used < oldest->second->used)
+            oldest = i;
+    }
+    Drop(oldest);
+}
+
+void RegionCache::Put(unsigned const refID, unsigned const window, RegionWindow const &src)
+{
+    size_t const bytes = sizeof(Entry) + src.records.size() * sizeof(RegionWindow::Record) + src.data.size();
+    
+    if (bytes > limit)
+        return;
+    
+    pthread_mutex_lock(&mutex);
+    try {
+        uint64_t const key = Key(refID, window);
+        std::map<uint64_t, Entry *>::iterator const i = byKey.find(key);
+        
+        if (i != byKey.end())
+            Drop(i);            /* read again by another iterator; it has the same records */
+        while (!byKey.empty() && (held + bytes > limit || MemoryLedger::OverBudget(bytes)))
+            DropOldest();
+        if (!MemoryLedger::OverBudget(bytes)) {
+            Entry *const entry = new Entry();
+            
+            entry->window.records.assign(src.records.begin(), src.records.end());
+            entry->window.data.assign(src.data.begin(), src.data.end());
+            entry->bytes = bytes;
+            entry->used = ++clock;
+            byKey[key] = entry;
+            held += bytes;
+            if (memory)
+                memory->Add(MemoryLedger::regionCache, bytes);
+        }
+    }
+    catch (...) {
+        pthread_mutex_unlock(&mutex);
+        throw;
+    }
+    pthread_mutex_unlock(&mutex);
+}
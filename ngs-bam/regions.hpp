@@ -0,0 +1,126 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_regions_
+#define _hpp_regions_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include <vector>
+#include <map>
+
+#include "memory.hpp"
+
+/* RegionWindow
+ *  the mapped records of one reference that reach into one window of it,
+ *  in file order, each as the file has it after its size
+ */
+struct RegionWindow
+{
+    struct Record {
+        uint64_t beg;               /* virtual file position of the record, its ID */
+        uint64_t end;               /* and of the one after it */
+        size_t offset;              /* into data */
+        uint32_t size;
+    };
+    std::vector<Record> records;
+    std::vector<uint8_t> data;
+
+    void Add(uint64_t const beg, uint64_t const end, uint8_t const *const raw, uint32_t const size);
+    void Clear() {
+        records.clear();
+        data.clear();
+    }
+};
+
+/* RegionCache
+ *  the most recently read windows of the references, keyed by reference
+ *  and window, so that a slice over windows that another iterator of the
+ *  file has read doesn't read or inflate them again; a window is WINDOW
+ *  bases, as of the linear index, and a record that reaches into several
+ *  windows is in each of them
+ *  may be shared by the readers of one file; holds at most "limit"
+ *  bytes, counted in "memory", if there is one; over the memory budget
+ *  it gives back its least recently used windows until the new one fits
+ *  or it has none left and then doesn't keep it
+ */
+class RegionCache
+{
+    struct Entry {
+        RegionWindow window;
+        size_t bytes;               /* its footprint when put */
+        uint64_t used;              /* when last put or found */
+    };
+    std::map<uint64_t, Entry *> byKey;
+    size_t const limit;
+    size_t held;
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+    MemoryLedger *const memory;
+    pthread_mutex_t mutex;
+
+    static uint64_t Key(unsigned const refID, unsigned const window) {
+        return ((uint64_t)refID << 32) | window;
+    }
+    void Drop(std::map<uint64_t, Entry *>::iterator const i);
+    void DropOldest();
+
+    RegionCache(RegionCache const &);
+    RegionCache &operator =(RegionCache const &);
+public:
+    enum { WINDOW_SHIFT = 14, WINDOW = 1 << WINDOW_SHIFT };
+
+    explicit RegionCache(size_t const limit, MemoryLedger *const memory = 0);
+    ~RegionCache();
+
+    bool isActive() const {
+        return limit != 0;
+    }
+
+    /* Get
+     *  copy the window into dst if it is cached
+     */
+    bool Get(unsigned const refID, unsigned const window, RegionWindow &dst);
+
+    /* Put
+     *  remember a window, giving back the least recently used ones to make room
+     */
+    void Put(unsigned const refID, unsigned const window, RegionWindow const &src);
+
+    /* getHits, getMisses
+     *  of Get, so far
+     */
+    uint64_t getHits() const {
+        return __atomic_load_n(&hits, __ATOMIC_RELAXED);
+    }
+    uint64_t getMisses() const {
+        return __atomic_load_n(&misses, __ATOMIC_RELAXED);
+    }
+};
+
+#endif // _hpp_regions_
@@ -0,0 +1,1490 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "sam.hpp"
+#include "bam.hpp"
+#include "cpu.hpp"
+#include "source.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+SAMFormatter::SAMFormatter(BAMFile const &File)
+: file(File)
+, out(0)
+, batch(0)
+, used(0)
+{
+}
+
+SAMFormatter::SAMFormatter(BAMFile const &File, std::ostream &Out, size_t const Batch)
+: file(File)
+, out(&Out)
+, batch(Batch)
+, used(0)
+{
+    buffer.resize(Batch);
+}
+
+SAMFormatter::~SAMFormatter()
+{
+    if (out)
+        Flush();
+}
+
+void SAMFormatter::Flush()
+{
+    if (out && used) {
+        out->write(&buffer[0], used);
+        used = 0;
+    }
+}
+
+void SAMFormatter::Write(BAMRecord const &rec)
+{
+    size_t const need = MaxSize(file, rec) + 1;
+
+    if (out && used + need > batch)
+        Flush();
+    if (used + need > buffer.size())
+        buffer.resize(used + need > 2 * buffer.size() ? used + need : 2 * buffer.size());
+
+    char *const endp = Format(&buffer[used], file, rec);
+    *endp = '\n';
+    used = (endp + 1) - &buffer[0];
+}
+
+static char *PutString(char *dst, char const *const src, size_t const len)
+{
+    memcpy(dst, src, len);
+    return dst + len;
+}
+
+static char *PutUnsigned(char *dst, uint32_t value)
+{
+    char digits[10];
+    unsigned n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0)
+        *dst++ = digits[--n];
+    return dst;
+}
+
+static char *PutSigned(char *dst, int32_t const value)
+{
+    if (value >= 0)
+        return PutUnsigned(dst, (uint32_t)value);
+    *dst++ = '-';
+    return PutUnsigned(dst, 0u - (uint32_t)value);
+}
+
+/* widest text of one value of a tag of BAM type "type"; floats use %g */
+static size_t MaxValueSize(int const type)
+{
+    switch (type) {
+        case 'A':
+            return 2;
+        case 'C':
+        case 'c':
+            return 5;
+        case 'S':
+        case 's':
+            return 7;
+        case 'I':
+        case 'i':
+            return 12;
+        case 'f':
+        case 'F':
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+size_t SAMFormatter::MaxSize(BAMFile const &file, BAMRecord const &rec)
+{
+    /* FLAG, POS, MAPQ, PNEXT, TLEN and the tabs */
+    size_t rslt = 64 + rec.l_read_name() + 11 * rec.nc() + 2 * (size_t)rec.l_seq();
+
+    if (rec.isSelfMapped())
+        rslt += file.getRefInfo(rec.refID()).getNameLength();
+    if (rec.isMateMapped())
+        rslt += file.getRefInfo(rec.next_refID()).getNameLength();
+    for (BAMRecord::OptionalField::const_iterator i = rec.begin(); i != rec.end(); ++i) {
+        int const elems = i->getElementCount();
+        char const type = i->getValueType();
+
+        /* "\tXX:B:c" */
+        rslt += 7;
+        if (type == 'Z' || type == 'H')
+            rslt += i->getElementSize();
+        else if (elems > 0)
+            rslt += elems * MaxValueSize(type);
+    }
+    return rslt;
+}
+
+char *SAMFormatter::Format(char *dst, BAMFile const &file, BAMRecord const &rec)
+{
+    unsigned const seqlen = rec.l_seq();
+    bool const selfMapped = rec.isSelfMapped();
+    bool const mateMapped = rec.isMateMapped();
+
+    dst = PutString(dst, rec.readname(), strnlen(rec.readname(), rec.l_read_name()));
+    *dst++ = '\t';
+    dst = PutUnsigned(dst, rec.flag());
+    *dst++ = '\t';
+    if (selfMapped) {
+        HeaderRefInfo const &RNAME = file.getRefInfo(rec.refID());
+        dst = PutString(dst, RNAME.getName(), RNAME.getNameLength());
+    }
+    else
+        *dst++ = '*';
+    *dst++ = '\t';
+    dst = PutUnsigned(dst, selfMapped ? rec.pos() + 1 : 0);
+    *dst++ = '\t';
+    dst = PutUnsigned(dst, rec.mq());
+    *dst++ = '\t';
+    if (selfMapped) {
+        unsigned const N = rec.nc();
+
+        for (unsigned i = 0; i < N; ++i) {
+            uint32_t const cv = rec.cigar(i);
+
+            dst = PutUnsigned(dst, cv >> 4);
+            *dst++ = "MIDNSHP=X???????"[cv & 0x0F];
+        }
+    }
+    else
+        *dst++ = '*';
+    *dst++ = '\t';
+    if (mateMapped) {
+        HeaderRefInfo const &RNEXT = file.getRefInfo(rec.next_refID());
+        dst = PutString(dst, RNEXT.getName(), RNEXT.getNameLength());
+    }
+    else
+        *dst++ = '*';
+    *dst++ = '\t';
+    dst = PutUnsigned(dst, mateMapped ? rec.next_pos() + 1 : 0);
+    *dst++ = '\t';
+    dst = PutSigned(dst, rec.tlen());
+    *dst++ = '\t';
+
+    if (seqlen > 0) {
+        rec.decodeSeq(dst, 0, seqlen);
+        dst += seqlen;
+        *dst++ = '\t';
+        if (rec.decodeQual(dst, 0, seqlen, true, '~' - '!'))
+            dst += seqlen;
+        else
+            *dst++ = '*';
+    }
+    else {
+        *dst++ = '*';
+        *dst++ = '\t';
+        *dst++ = '*';
+    }
+
+    for (BAMRecord::OptionalField::const_iterator i = rec.begin(); i != rec.end(); ++i) {
+        char const *const tag = i->getTag();
+        bool const isArray = i->isArray();
+        int const elems = i->getElementCount();
+        char const type = i->getValueType();
+        char const *raw = i->getRawValue();
+
+        *dst++ = '\t';
+        *dst++ = tag[0];
+        *dst++ = tag[1];
+        *dst++ = ':';
+        if (isArray) {
+            *dst++ = 'B';
+            *dst++ = ':';
+            *dst++ = type == 'F' ? 'f' : type;
+        }
+        else {
+            switch (type) {
+                case 'A':
+                case 'Z':
+                case 'H':
+                    *dst++ = type;
+                    break;
+                case 'f':
+                case 'F':
+                    *dst++ = 'f';
+                    break;
+                default:
+                    /* SAM has a single integer type */
+                    *dst++ = 'i';
+                    break;
+            }
+            *dst++ = ':';
+        }
+        if (type == 'Z' || type == 'H') {
+            dst = PutString(dst, raw, i->getElementSize());
+            continue;
+        }
+        for (int j = 0; j < elems; ++j) {
+            if (isArray)
+                *dst++ = ',';
+            switch (type) {
+                case 'A':
+                    *dst++ = *raw;
+                    ++raw;
+                    break;
+                case 'C':
+                    dst = PutUnsigned(dst, *((uint8_t const *)raw));
+                    ++raw;
+                    break;
+                case 'c':
+                    dst = PutSigned(dst, *((int8_t const *)raw));
+                    ++raw;
+                    break;
+                case 'S':
+                    dst = PutUnsigned(dst, LE2Host<uint16_t>(raw));
+                    raw += 2;
+                    break;
+                case 's':
+                    dst = PutSigned(dst, LE2Host<int16_t>(raw));
+                    raw += 2;
+                    break;
+                case 'f':
+                case 'F':
+                    dst += sprintf(dst, "%g", LE2Host<float>(raw));
+                    raw += 4;
+                    break;
+                case 'I':
+                    dst = PutUnsigned(dst, LE2Host<uint32_t>(raw));
+                    raw += 4;
+                    break;
+                case 'i':
+                    dst = PutSigned(dst, LE2Host<int32_t>(raw));
+                    raw += 4;
+                    break;
+            }
+        }
+    }
+    return dst;
+}
+
+class SAMLock
+{
+    pthread_mutex_t *const mutex;
+public:
+    SAMLock(pthread_mutex_t &m) : mutex(&m) {
+        pthread_mutex_lock(mutex);
+    }
+    ~SAMLock() {
+        pthread_mutex_unlock(mutex);
+    }
+};
+
+static void AppendLE(std::string &dst, uint64_t value, unsigned const size)
+{
+    for (unsigned i = 0; i < size; ++i, value >>= 8)
+        dst.push_back((char)(value & 0xFF));
+}
+
+static void PutLE(uint8_t *const dst, uint64_t value, unsigned const size)
+{
+    for (unsigned i = 0; i < size; ++i, value >>= 8)
+        dst[i] = (uint8_t)(value & 0xFF);
+}
+
+static bool EndsWith(std::string const &str, char const suffix[])
+{
+    size_t const n = strlen(suffix);
+
+    return str.size() > n && str.compare(str.size() - n, n, suffix) == 0;
+}
+
+/* SAMTextSource
+ *  reads a plain file where it is asked to; a bgzipped one is read on
+ *  from the block it is in, if it is ahead of the last one known to
+ *  SAMText, else from the one before it that is known, or the start
+ */
+class SAMTextSource
+{
+    SAMText const &text;
+    ByteSource *const source;       /* a plain file */
+    BGZFReader *const bgzf;         /* a bgzipped one */
+    BGZFBlock const *block;         /* the last one inflated */
+    uint64_t blockAt;               /* where its text starts */
+
+    bool Position(uint64_t const pos);
+    void Advance(void);
+
+    SAMTextSource(SAMTextSource const &);
+    SAMTextSource &operator =(SAMTextSource const &);
+public:
+    /* takes one of "source" and "bgzf" */
+    SAMTextSource(SAMText const &Text, ByteSource *const Source, BGZFReader *const BGZF)
+    : text(Text)
+    , source(Source)
+    , bgzf(BGZF)
+    , block(0)
+    , blockAt(0)
+    {}
+    ~SAMTextSource() {
+        delete source;
+        delete bgzf;
+    }
+
+    /* Read
+     *  the "length" bytes of text at pos, fewer at the end of it
+     */
+    size_t Read(uint64_t const pos, char *const dst, size_t const length);
+};
+
+void SAMTextSource::Advance(void)
+{
+    if (block)
+        blockAt += block->size;
+    block = bgzf->Next();
+    if (block)
+        text.Learn(blockAt, block->fpos);
+}
+
+/* Position
+ *  at the block with the text at pos; false past the end
+ */
+bool SAMTextSource::Position(uint64_t const pos)
+{
+    uint64_t start = 0;
+    uint64_t fpos = 0;
+    bool const known = text.Locate(pos, start, fpos);
+
+    if (!(block && blockAt <= pos && (!known || start <= blockAt))) {
+        bgzf->Seek(known ? fpos : 0);
+        block = 0;
+        blockAt = known ? start : 0;
+        Advance();
+    }
+    while (block && pos - blockAt >= block->size)
+        Advance();
+    return block != 0;
+}
+
+size_t SAMTextSource::Read(uint64_t const pos, char *const dst, size_t const length)
+{
+    size_t n = 0;
+
+    if (source) {
+        while (n < length) {
+            size_t const nread = source->Read(pos + n, dst + n, length - n);
+            if (nread == 0)
+                break;
+            n += nread;
+        }
+        return n;
+    }
+    while (n < length && Position(pos + n)) {
+        size_t const at = (size_t)(pos + n - blockAt);
+        size_t const copy = std::min(length - n, (size_t)block->size - at);
+
+        memcpy(dst + n, block->data + at, copy);
+        n += copy;
+    }
+    return n;
+}
+
+SAMText::SAMText(std::string const &filepath)
+: path(filepath)
+, sam(false)
+, bgzipped(false)
+, headerEnd(0)
+{
+    pthread_mutex_init(&mutex, 0);
+    try {
+        Probe();
+        if (sam)
+            ReadHeader();
+    }
+    catch (...) {
+        pthread_mutex_destroy(&mutex);
+        throw;
+    }
+}
+
+SAMText::~SAMText()
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+/* isRecordStart
+ *  what a SAM file starts with: a header line or a QNAME
+ */
+static bool isRecordStart(int const ch)
+{
+    return ch == '@' || ('!' <= ch && ch <= '~');
+}
+
+/* Probe
+ *  BGZF that inflates to "BAM\1" is BAM, and any other BGZF is taken to
+ *  be bgzipped SAM; a file that isn't gzipped is SAM if it starts as
+ *  SAM does, and left to fail as BAM otherwise
+ */
+void SAMText::Probe(void)
+{
+    if (ByteSource::IsStream(path))
+        return;
+    if (ByteSource::IsURL(path) && !EndsWith(path, ".sam") && !EndsWith(path, ".sam.gz") && !EndsWith(path, ".sam.bgz"))
+        return;
+
+    ByteSource *const probe = ByteSource::Open(path);
+    uint8_t magic[4];
+    size_t have = 0;
+
+    try {
+        while (have < sizeof(magic)) {
+            size_t const nread = probe->Read(have, magic + have, sizeof(magic) - have);
+            if (nread == 0)
+                break;
+            have += nread;
+        }
+    }
+    catch (...) {
+        delete probe;
+        throw;
+    }
+    delete probe;
+    if (have == sizeof(magic) && magic[0] == 31 && magic[1] == 139 && magic[2] == 8 && (magic[3] & 4) != 0) {
+        BGZFReader reader(path, 0);
+        BGZFBlock const *const first = reader.Next();
+
+        if (first && !(first->size >= 4 && memcmp(first->data, "BAM\1", 4) == 0))
+            sam = bgzipped = isRecordStart(first->data[0]);
+        return;
+    }
+    sam = have > 0 && isRecordStart(magic[0]);
+}
+
+/* ReadHeader
+ *  the lines that start with '@', then the references of their @SQ lines
+ */
+void SAMText::ReadHeader(void)
+{
+    SAMTextSource source(*this, bgzipped ? 0 : ByteSource::Open(path), bgzipped ? new BGZFReader(path, 0) : 0);
+    std::vector<char> buffer(SAM_CELL);
+    std::string text;
+    bool atLine = true;
+    bool inHeader = true;
+
+    while (inHeader) {
+        size_t const nread = source.Read(headerEnd, &buffer[0], buffer.size());
+        size_t i = 0;
+
+        if (nread == 0)
+            break;
+        while (i < nread) {
+            if (atLine && buffer[i] != '@') {
+                inHeader = false;
+                break;
+            }
+            char const *const nl = (char const *)memchr(&buffer[i], '\n', nread - i);
+            size_t const end = nl ? (size_t)(nl - &buffer[0]) + 1 : nread;
+
+            text.append(&buffer[i], end - i);
+            atLine = nl != 0;
+            i = end;
+        }
+        headerEnd += i;
+    }
+
+    std::vector<std::pair<std::string, int32_t> > refs;
+
+    ParseReferences(text, refs);
+    header.assign("BAM\1", 4);
+    AppendLE(header, text.size(), 4);
+    header += text;
+    AppendLE(header, refs.size(), 4);
+    for (size_t i = 0; i < refs.size(); ++i) {
+        AppendLE(header, refs[i].first.size() + 1, 4);
+        header += refs[i].first;
+        header += '\0';
+        AppendLE(header, (uint32_t)refs[i].second, 4);
+    }
+
+    /* of references with the same name, the last one is found, as BAMFile finds it */
+    std::vector<std::pair<std::string, int32_t> > byName;
+
+    for (size_t i = 0; i < refs.size(); ++i)
+        byName.push_back(std::make_pair(refs[i].first, (int32_t)i));
+    std::sort(byName.begin(), byName.end());
+    for (size_t i = 0; i < byName.size(); ++i) {
+        if (i + 1 < byName.size() && byName[i + 1].first == byName[i].first)
+            continue;
+        names.push_back(byName[i].first);
+        ids.push_back(byName[i].second);
+    }
+}
+
+/* ParseReferences
+ *  the SN and LN of each @SQ line
+ */
+void SAMText::ParseReferences(std::string const &text, std::vector<std::pair<std::string, int32_t> > &refs)
+{
+    for (size_t at = 0; at < text.size(); ) {
+        size_t const nl = text.find('\n', at);
+        size_t const end = nl == text.npos ? text.size() : nl;
+
+        if (text.compare(at, 4, "@SQ\t") == 0) {
+            std::string name;
+            int64_t length = -1;
+
+            for (size_t field = at + 4; field < end; ) {
+                size_t const tab = text.find('\t', field);
+                size_t const fend = tab < end ? tab : end;
+
+                if (text.compare(field, 3, "SN:") == 0)
+                    name.assign(text, field + 3, fend - field - 3);
+                else if (text.compare(field, 3, "LN:") == 0) {
+                    char *endp = 0;
+
+                    length = strtoll(text.c_str() + field + 3, &endp, 10);
+                    if (endp != text.c_str() + fend || length < 0 || length > INT32_MAX)
+                        length = -1;
+                }
+                field = fend + 1;
+            }
+            if (name.empty() || length < 0)
+                throw std::runtime_error("SAM header has an invalid @SQ line");
+            refs.push_back(std::make_pair(name, (int32_t)length));
+        }
+        at = end + 1;
+    }
+}
+
+int32_t SAMText::FindReference(char const name[], size_t const length) const
+{
+    size_t lo = 0;
+    size_t hi = names.size();
+
+    while (lo < hi) {
+        size_t const mid = lo + (hi - lo) / 2;
+        int const diff = names[mid].compare(0, names[mid].npos, name, length);
+
+        if (diff == 0)
+            return ids[mid];
+        if (diff < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return -1;
+}
+
+void SAMText::Learn(uint64_t const text, uint64_t const fpos) const
+{
+    SAMLock lock(mutex);
+
+    if (blocks.empty() || blocks.back().first < text)
+        blocks.push_back(std::make_pair(text, fpos));
+}
+
+bool SAMText::Locate(uint64_t const text, uint64_t &start, uint64_t &fpos) const
+{
+    SAMLock lock(mutex);
+    std::vector<std::pair<uint64_t, uint64_t> >::const_iterator const i =
+        std::upper_bound(blocks.begin(), blocks.end(), std::make_pair(text, ~(uint64_t)0));
+
+    if (i == blocks.begin())
+        return false;
+    start = (i - 1)->first;
+    fpos = (i - 1)->second;
+    return true;
+}
+
+/* the kernel below has a plain version and with CPU_DISPATCH some for
+ * x86 vector instructions, picked at load by breakKernels further down;
+ * a vector step takes as many whole vectors as there are and leaves the
+ * rest to the next step, the last one a byte at a time */
+
+/* IndexBreaks
+ *  the offset of each tab and newline of "length" bytes of text, in
+ *  order, into "out", which has room for "length" of them
+ *  returns how many there are
+ *  the vector kernels compare 16 or more bytes at a time to both and
+ *  take the offsets from the bits of the mask of the matches
+ */
+static inline size_t IndexBreaksTail(char const *text, size_t at, size_t const length, uint32_t *out, size_t n)
+{
+    for ( ; at < length; ++at) {
+        if (text[at] == '\t' || text[at] == '\n')
+            out[n++] = (uint32_t)at;
+    }
+    return n;
+}
+
+static size_t IndexBreaksPlain(char const *text, size_t const length, uint32_t *out)
+{
+    return IndexBreaksTail(text, 0, length, out, 0);
+}
+
+#if CPU_DISPATCH
+CPU_TARGET("sse2")
+static inline void IndexBreaks16(char const *text, size_t &at, size_t const length, uint32_t *out, size_t &n)
+{
+    __m128i const tab = _mm_set1_epi8('\t');
+    __m128i const newline = _mm_set1_epi8('\n');
+
+    for ( ; at + 16 <= length; at += 16) {
+        __m128i const v = _mm_loadu_si128((__m128i const *)(text + at));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, newline)));
+
+        for ( ; mask != 0; mask &= mask - 1)
+            out[n++] = (uint32_t)(at + __builtin_ctz(mask));
+    }
+}
+
+CPU_TARGET("avx2")
+static inline void IndexBreaks32(char const *text, size_t &at, size_t const length, uint32_t *out, size_t &n)
+{
+    __m256i const tab = _mm256_set1_epi8('\t');
+    __m256i const newline = _mm256_set1_epi8('\n');
+
+    for ( ; at + 32 <= length; at += 32) {
+        __m256i const v = _mm256_loadu_si256((__m256i const *)(text + at));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, tab),
+                                                                       _mm256_cmpeq_epi8(v, newline)));
+
+        for ( ; mask != 0; mask &= mask - 1)
+            out[n++] = (uint32_t)(at + __builtin_ctz(mask));
+    }
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static inline void IndexBreaks64(char const *text, size_t &at, size_t const length, uint32_t *out, size_t &n)
+{
+    __m512i const tab = _mm512_set1_epi8('\t');
+    __m512i const newline = _mm512_set1_epi8('\n');
+
+    for ( ; at + 64 <= length; at += 64) {
+        __m512i const v = _mm512_loadu_si512(text + at);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(v, tab) | _mm512_cmpeq_epi8_mask(v, newline);
+
+        for ( ; mask != 0; mask &= mask - 1)
+            out[n++] = (uint32_t)(at + __builtin_ctzll(mask));
+    }
+}
+
+CPU_TARGET("sse2")
+static size_t IndexBreaksSSE2(char const *text, size_t const length, uint32_t *out)
+{
+    size_t at = 0;
+    size_t n = 0;
+
+    IndexBreaks16(text, at, length, out, n);
+    return IndexBreaksTail(text, at, length, out, n);
+}
+
+CPU_TARGET("avx2")
+static size_t IndexBreaksAVX2(char const *text, size_t const length, uint32_t *out)
+{
+    size_t at = 0;
+    size_t n = 0;
+
+    IndexBreaks32(text, at, length, out, n);
+    IndexBreaks16(text, at, length, out, n);
+    return IndexBreaksTail(text, at, length, out, n);
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static size_t IndexBreaksAVX512(char const *text, size_t const length, uint32_t *out)
+{
+    size_t at = 0;
+    size_t n = 0;
+
+    IndexBreaks64(text, at, length, out, n);
+    IndexBreaks32(text, at, length, out, n);
+    IndexBreaks16(text, at, length, out, n);
+    return IndexBreaksTail(text, at, length, out, n);
+}
+#endif
+
+/* the kernel in use, the plain one until breakKernels has picked */
+static size_t (*IndexBreaks)(char const *, size_t, uint32_t *) = IndexBreaksPlain;
+
+static struct BreakKernels {
+    BreakKernels() {
+#if CPU_DISPATCH
+        CPU::Level const level = CPU::Best();
+
+        if (level >= CPU::sse2)
+            IndexBreaks = IndexBreaksSSE2;
+        if (level >= CPU::avx2)
+            IndexBreaks = IndexBreaksAVX2;
+        if (level >= CPU::avx512)
+            IndexBreaks = IndexBreaksAVX512;
+#endif
+    }
+} const breakKernels;
+
+/* the 4 bit codes of SEQ, "=ACMGRSVTWYHKDBN"; anything else is N */
+static struct BaseCodes {
+    uint8_t code[256];
+
+    BaseCodes() {
+        static char const bases[] = "=ACMGRSVTWYHKDBN";
+
+        memset(code, 15, sizeof(code));
+        for (unsigned i = 0; i < 16; ++i) {
+            code[(uint8_t)bases[i]] = (uint8_t)i;
+            code[(uint8_t)tolower(bases[i])] = (uint8_t)i;
+        }
+    }
+} const baseCodes;
+
+static void Fail(uint64_t const tpos, char const what[])
+{
+    char buffer[64];
+
+    snprintf(buffer, sizeof(buffer), "SAM line at byte %llu: ", (unsigned long long)tpos);
+    throw std::runtime_error(std::string(buffer) + what);
+}
+
+/* ParseInt
+ *  the whole of [cp, end) as a decimal integer in [lo, hi]
+ */
+static bool ParseInt(char const *cp, char const *const end, int64_t const lo, int64_t const hi, int64_t &value)
+{
+    bool const negative = cp < end && *cp == '-';
+    int64_t rslt = 0;
+
+    if (cp < end && (*cp == '-' || *cp == '+'))
+        ++cp;
+    if (cp == end || end - cp > 18)
+        return false;
+    for ( ; cp < end; ++cp) {
+        unsigned const digit = (unsigned)(*cp - '0');
+
+        if (digit > 9)
+            return false;
+        rslt = rslt * 10 + digit;
+    }
+    value = negative ? -rslt : rslt;
+    return lo <= value && value <= hi;
+}
+
+static bool ParseFloat(char const *const cp, char const *const end, float &value)
+{
+    char buffer[64];
+    char *endp = 0;
+    size_t const n = (size_t)(end - cp);
+
+    if (n == 0 || n >= sizeof(buffer))
+        return false;
+    memcpy(buffer, cp, n);
+    buffer[n] = '\0';
+    value = strtof(buffer, &endp);
+    return endp == buffer + n;
+}
+
+static void AppendFloat(std::vector<uint8_t> &bam, float const value)
+{
+    uint32_t bits;
+    size_t const at = bam.size();
+
+    memcpy(&bits, &value, 4);
+    bam.resize(at + 4);
+    PutLE(&bam[at], bits, 4);
+}
+
+/* EncodeInteger
+ *  an 'i' field as the smallest BAM type that holds it
+ */
+static void EncodeInteger(std::vector<uint8_t> &bam, int64_t const value)
+{
+    char type;
+    unsigned size;
+
+    if (value < 0) {
+        type = value >= INT8_MIN ? 'c' : value >= INT16_MIN ? 's' : 'i';
+        size = value >= INT8_MIN ? 1 : value >= INT16_MIN ? 2 : 4;
+    }
+    else {
+        type = value <= UINT8_MAX ? 'C' : value <= UINT16_MAX ? 'S' : 'I';
+        size = value <= UINT8_MAX ? 1 : value <= UINT16_MAX ? 2 : 4;
+    }
+
+    size_t const at = bam.size();
+
+    bam.resize(at + 1 + size);
+    bam[at] = (uint8_t)type;
+    PutLE(&bam[at + 1], (uint64_t)value, size);
+}
+
+/* EncodeArray
+ *  the value of a 'B' field, its type and then the comma separated values
+ */
+static void EncodeArray(std::vector<uint8_t> &bam, char const *const value, char const *const end, uint64_t const tpos)
+{
+    char const type = value < end ? *value : 0;
+    int64_t lo = 0;
+    int64_t hi = 0;
+    unsigned size = 4;
+
+    switch (type) {
+        case 'c': lo = INT8_MIN; hi = INT8_MAX; size = 1; break;
+        case 'C': lo = 0; hi = UINT8_MAX; size = 1; break;
+        case 's': lo = INT16_MIN; hi = INT16_MAX; size = 2; break;
+        case 'S': lo = 0; hi = UINT16_MAX; size = 2; break;
+        case 'i': lo = INT32_MIN; hi = INT32_MAX; break;
+        case 'I': lo = 0; hi = UINT32_MAX; break;
+        case 'f': break;
+        default:
+            Fail(tpos, "invalid array type");
+    }
+
+    uint32_t const count = (uint32_t)std::count(value + 1, end, ',');
+    size_t at = bam.size();
+
+    if (count == 0 && value + 1 != end)
+        Fail(tpos, "invalid array");
+    bam.resize(at + 6 + (size_t)count * size);
+    bam[at] = 'B';
+    bam[at + 1] = (uint8_t)type;
+    PutLE(&bam[at + 2], count, 4);
+    at += 6;
+    for (char const *cp = value + 1; cp < end; at += size) {
+        char const *const from = cp + 1;
+        char const *const comma = (char const *)memchr(from, ',', end - from);
+        char const *const to = comma ? comma : end;
+
+        if (type == 'f') {
+            float element;
+            uint32_t bits;
+
+            if (!ParseFloat(from, to, element))
+                Fail(tpos, "invalid array element");
+            memcpy(&bits, &element, 4);
+            PutLE(&bam[at], bits, 4);
+        }
+        else {
+            int64_t element;
+
+            if (!ParseInt(from, to, lo, hi, element))
+                Fail(tpos, "invalid array element");
+            PutLE(&bam[at], (uint64_t)element, size);
+        }
+        cp = to;
+    }
+}
+
+/* EncodeField
+ *  an optional field, TAG:TYPE:VALUE
+ */
+static void EncodeField(std::vector<uint8_t> &bam, char const *const field, char const *const end, uint64_t const tpos)
+{
+    if (end - field < 5 || field[2] != ':' || field[4] != ':')
+        Fail(tpos, "invalid optional field");
+
+    char const type = field[3];
+    char const *const value = field + 5;
+
+    bam.push_back((uint8_t)field[0]);
+    bam.push_back((uint8_t)field[1]);
+    switch (type) {
+        case 'A':
+            if (end - value != 1)
+                Fail(tpos, "invalid character field");
+            bam.push_back('A');
+            bam.push_back((uint8_t)*value);
+            break;
+        case 'i': {
+            int64_t integer;
+
+            if (!ParseInt(value, end, INT32_MIN, UINT32_MAX, integer))
+                Fail(tpos, "invalid integer field");
+            EncodeInteger(bam, integer);
+            break;
+        }
+        case 'f': {
+            float number;
+
+            if (!ParseFloat(value, end, number))
+                Fail(tpos, "invalid float field");
+            bam.push_back('f');
+            AppendFloat(bam, number);
+            break;
+        }
+        case 'Z':
+        case 'H':
+            bam.push_back((uint8_t)type);
+            bam.insert(bam.end(), value, end);
+            bam.push_back(0);
+            break;
+        case 'B':
+            EncodeArray(bam, value, end, tpos);
+            break;
+        default:
+            Fail(tpos, "invalid optional field type");
+    }
+}
+
+/* SAMLine
+ *  a line of SAM text, as the tabs in it cut it, and the reference of
+ *  the last one looked up, which is mostly that of the next line too
+ */
+struct SAMLine
+{
+    SAMText const &file;
+    uint64_t tpos;                  /* where it starts in the text */
+    char const *line;
+    std::vector<char const *> ends; /* of each field */
+    char const *lastName;
+    size_t lastLength;
+    int32_t lastID;
+
+    explicit SAMLine(SAMText const &File) : file(File), tpos(0), line(0), lastName(0), lastLength(0), lastID(-1) {}
+
+    char const *begin(size_t const i) const {
+        return i == 0 ? line : ends[i - 1] + 1;
+    }
+    char const *end(size_t const i) const {
+        return ends[i];
+    }
+    bool isStar(size_t const i) const {
+        return end(i) - begin(i) == 1 && *begin(i) == '*';
+    }
+    int64_t Integer(size_t const i, int64_t const lo, int64_t const hi, char const what[]) const {
+        int64_t value;
+
+        if (!ParseInt(begin(i), end(i), lo, hi, value))
+            Fail(tpos, what);
+        return value;
+    }
+    int32_t Reference(size_t const i) {
+        char const *const name = begin(i);
+        size_t const length = (size_t)(end(i) - name);
+
+        if (isStar(i))
+            return -1;
+        if (!(lastName && length == lastLength && memcmp(name, lastName, length) == 0)) {
+            lastID = file.FindReference(name, length);
+            if (lastID < 0)
+                Fail(tpos, "reference is not in the header");
+            lastName = name;
+            lastLength = length;
+        }
+        return lastID;
+    }
+
+    void Encode(std::vector<uint8_t> &bam);
+};
+
+/* Encode
+ *  the line as a BAM record, with its block_size, after what is in bam
+ */
+void SAMLine::Encode(std::vector<uint8_t> &bam)
+{
+    enum { QNAME, FLAG, RNAME, POS, MAPQ, CIGAR, RNEXT, PNEXT, TLEN, SEQ, QUAL, FIELDS };
+
+    if (ends.size() < FIELDS)
+        Fail(tpos, *line == '@' ? "header line after the records" : "fewer than 11 fields");
+
+    size_t const l_read_name = (size_t)(end(QNAME) - begin(QNAME)) + 1;
+    uint16_t const flag = (uint16_t)Integer(FLAG, 0, UINT16_MAX, "invalid FLAG");
+    int32_t const refID = Reference(RNAME);
+    int32_t const pos = (int32_t)Integer(POS, 0, INT32_MAX, "invalid POS") - 1;
+    uint8_t const mapq = (uint8_t)Integer(MAPQ, 0, UINT8_MAX, "invalid MAPQ");
+    char const *const rnext = begin(RNEXT);
+    int32_t const next_refID = (end(RNEXT) - rnext == 1 && *rnext == '=') ? refID : Reference(RNEXT);
+    int32_t const next_pos = (int32_t)Integer(PNEXT, 0, INT32_MAX, "invalid PNEXT") - 1;
+    int32_t const tlen = (int32_t)Integer(TLEN, INT32_MIN, INT32_MAX, "invalid TLEN");
+    size_t const l_seq = isStar(SEQ) ? 0 : (size_t)(end(SEQ) - begin(SEQ));
+    size_t n_cigar = 0;
+
+    if (l_read_name < 2 || l_read_name > 255)
+        Fail(tpos, "invalid QNAME");
+    if (!isStar(CIGAR)) {
+        for (char const *cp = begin(CIGAR); cp < end(CIGAR); ++cp)
+            n_cigar += (unsigned)(*cp - '0') > 9;
+    }
+    if (n_cigar > UINT16_MAX)
+        Fail(tpos, "too many CIGAR operations");
+    if (!isStar(QUAL) && (size_t)(end(QUAL) - begin(QUAL)) != l_seq)
+        Fail(tpos, "QUAL and SEQ differ in length");
+
+    size_t const at = bam.size();
+
+    bam.resize(at + 36 + l_read_name + 4 * n_cigar + (l_seq + 1) / 2 + l_seq);
+
+    uint8_t *const rec = &bam[at];
+    uint8_t *cigar = rec + 36 + l_read_name;
+    int64_t rlen = 0;
+
+    memcpy(rec + 36, begin(QNAME), l_read_name - 1);
+    rec[36 + l_read_name - 1] = 0;
+    if (n_cigar > 0) {
+        static char const ops[] = "MIDNSHP=X";
+        uint32_t length = 0;
+        bool digits = false;
+
+        for (char const *cp = begin(CIGAR); cp < end(CIGAR); ++cp) {
+            unsigned const digit = (unsigned)(*cp - '0');
+            char const *const op = digit > 9 ? (char const *)memchr(ops, *cp, 9) : 0;
+
+            if (digit <= 9) {
+                if (length > (UINT32_MAX >> 4) / 10)
+                    Fail(tpos, "invalid CIGAR");
+                length = length * 10 + digit;
+                digits = true;
+                continue;
+            }
+            if (!op || !digits)
+                Fail(tpos, "invalid CIGAR");
+
+            unsigned const code = (unsigned)(op - ops);
+
+            PutLE(cigar, (length << 4) | code, 4);
+            cigar += 4;
+            if (code == 0 || code == 2 || code == 3 || code == 7 || code == 8)
+                rlen += length;
+            length = 0;
+            digits = false;
+        }
+        if (digits)
+            Fail(tpos, "invalid CIGAR");
+    }
+
+    uint8_t *const seq = cigar;
+    uint8_t *const qual = seq + (l_seq + 1) / 2;
+
+    if (l_seq > 0) {
+        uint8_t const *const bases = (uint8_t const *)begin(SEQ);
+
+        for (size_t i = 0; i + 1 < l_seq; i += 2)
+            seq[i / 2] = (uint8_t)((baseCodes.code[bases[i]] << 4) | baseCodes.code[bases[i + 1]]);
+        if (l_seq & 1)
+            seq[l_seq / 2] = (uint8_t)(baseCodes.code[bases[l_seq - 1]] << 4);
+        if (isStar(QUAL))
+            memset(qual, 0xFF, l_seq);
+        else {
+            char const *const quals = begin(QUAL);
+
+            for (size_t i = 0; i < l_seq; ++i)
+                qual[i] = (uint8_t)(quals[i] - 33);
+        }
+    }
+
+    int32_t const bin_end = pos + (int32_t)((flag & 4) == 0 && rlen > 0 ? rlen : 1);
+
+    PutLE(rec + 4, (uint32_t)refID, 4);
+    PutLE(rec + 8, (uint32_t)pos, 4);
+    rec[12] = (uint8_t)l_read_name;
+    rec[13] = mapq;
+    PutLE(rec + 14, BAMIndexBuilder::Bin(pos, bin_end), 2);
+    PutLE(rec + 16, n_cigar, 2);
+    PutLE(rec + 18, flag, 2);
+    PutLE(rec + 20, l_seq, 4);
+    PutLE(rec + 24, (uint32_t)next_refID, 4);
+    PutLE(rec + 28, (uint32_t)next_pos, 4);
+    PutLE(rec + 32, (uint32_t)tlen, 4);
+
+    for (size_t i = FIELDS; i < ends.size(); ++i)
+        EncodeField(bam, begin(i), end(i), tpos);
+    PutLE(&bam[at], bam.size() - at - 4, 4);
+}
+
+/* Parse
+ *  the lines of "text", which starts at "start" in the file's text and
+ *  ends with a NUL, into records, and where the blocks of them start
+ *  a block takes records while they fit, and only from one SAM_CELL;
+ *  a record that doesn't fit in one goes on into as many as it needs
+ */
+static void Parse(SAMText const &file, uint64_t const start, std::vector<char> const &text,
+                  std::vector<uint8_t> &bam, std::vector<std::pair<size_t, uint64_t> > &cuts)
+{
+    size_t const length = text.size() - 1;
+    char const *const base = &text[0];
+    std::vector<uint32_t> breaks(length + 1);
+    size_t const count = IndexBreaks(base, length, &breaks[0]);
+    uint64_t const bias = file.headerBlocks();
+    SAMLine line(file);
+    uint64_t cell = 0;
+    size_t blockStart = 0;
+    bool closed = true;
+
+    breaks[count] = (uint32_t)length;       /* the last line may have no newline */
+    bam.reserve(length);
+    for (size_t at = 0, b = 0; at < length; ) {
+        size_t end;
+
+        line.tpos = start + at;
+        line.line = base + at;
+        line.ends.clear();
+        do {
+            end = breaks[b++];
+            line.ends.push_back(base + end);
+        } while (end < length && base[end] != '\n');
+        if (line.ends.back() > line.line && line.ends.back()[-1] == '\r')
+            --line.ends.back();
+        at = end + 1;
+        if (line.ends.size() == 1 && line.ends[0] == line.line)
+            continue;               /* an empty line */
+
+        size_t const recStart = bam.size();
+
+        line.Encode(bam);
+
+        size_t const size = bam.size() - recStart;
+        uint64_t const c = line.tpos / SAM_CELL;
+
+        if (closed || c != cell || recStart - blockStart + size > BGZF_BLK_DATA) {
+            cuts.push_back(std::make_pair(recStart, bias + line.tpos));
+            blockStart = recStart;
+            cell = c;
+            closed = false;
+        }
+        if (size > BGZF_BLK_DATA) {
+            for (size_t k = 1; k * BGZF_BLK_DATA < size; ++k)
+                cuts.push_back(std::make_pair(recStart + k * BGZF_BLK_DATA, bias + line.tpos + k));
+            closed = true;
+        }
+    }
+}
+
+/* SAMReader::Job
+ *  whole lines of text, read, and the records parsed from them
+ */
+struct SAMReader::Job : public ngs::WorkItem
+{
+    SAMReader &reader;
+    uint64_t start;                 /* where the text starts in the file's */
+    std::vector<char> text;         /* then a NUL */
+    std::vector<uint8_t> bam;
+    std::vector<std::pair<size_t, uint64_t> > cuts;    /* where each block starts in bam, and its fpos */
+    bool queued;
+    bool running;
+    bool done;
+    std::string error;
+
+    Job(SAMReader &Reader) : reader(Reader), start(0), queued(false), running(false), done(false) {}
+
+    void run() {
+        {
+            SAMLock lock(reader.mutex);
+
+            queued = false;
+            running = true;
+        }
+        reader.Run(*this);
+    }
+};
+
+/* StartPool
+ *  the shared pool, if jobs are parsed ahead
+ */
+static ngs::WorkPool *StartPool(unsigned const threads)
+{
+    if (threads == 0)
+        return 0;
+    try {
+        return &ngs::WorkPool::shared();
+    }
+    catch (ngs::ErrorMsg const &e) {
+        throw std::runtime_error(e.what());
+    }
+}
+
+static SAMTextSource *OpenText(SAMText const &text, BGZFReader *const bgzf, MemoryLedger *const memory)
+{
+    if (bgzf) {
+        try {
+            return new SAMTextSource(text, 0, bgzf);
+        }
+        catch (...) {
+            delete bgzf;
+            throw;
+        }
+    }
+
+    ByteSource *const source = ByteSource::Open(text.getPath(), memory);
+
+    try {
+        return new SAMTextSource(text, source, 0);
+    }
+    catch (...) {
+        delete source;
+        throw;
+    }
+}
+
+SAMReader::SAMReader(SAMText const &Text, BGZFReader *const bgzf, unsigned const threads,
+                     ngs::WorkPool::Priority const Priority, MemoryLedger *const memory)
+: text(Text)
+, source(OpenText(Text, bgzf, memory))
+, headerNext(0)
+, next(Text.getHeaderEnd())
+, ended(false)
+, complete(false)
+, taken(0)
+, ahead(threads > 0 ? threads : 1)
+, pool(0)
+, priority(Priority)
+{
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&doneCond, 0);
+    try {
+        pool = StartPool(threads);
+    }
+    catch (...) {
+        pthread_cond_destroy(&doneCond);
+        pthread_mutex_destroy(&mutex);
+        delete source;
+        throw;
+    }
+}
+
+SAMReader::~SAMReader()
+{
+    Drop();
+    pthread_cond_destroy(&doneCond);
+    pthread_mutex_destroy(&mutex);
+    delete source;
+}
+
+/* Drop
+ *  the jobs read, a job that has started being waited for
+ */
+void SAMReader::Drop()
+{
+    {
+        SAMLock lock(mutex);
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            Job &job = *jobs[i];
+
+            if (job.queued && pool->cancel(job))
+                job.queued = false;
+            while (job.queued || job.running)
+                pthread_cond_wait(&doneCond, &mutex);
+        }
+    }
+    for (size_t i = 0; i < jobs.size(); ++i)
+        delete jobs[i];
+    jobs.clear();
+    taken = 0;
+}
+
+/* ReadNext
+ *  the text from "next" up to the SAM_JOB boundary after it, and on to
+ *  the end of the line it cuts
+ */
+bool SAMReader::ReadNext(Job &job)
+{
+    size_t const want = (size_t)((next / SAM_JOB + 1) * SAM_JOB - next);
+
+    job.start = next;
+    job.text.resize(want);
+
+    size_t const nread = source->Read(next, &job.text[0], want);
+
+    job.text.resize(nread);
+    if (nread < want)
+        ended = true;
+    while (!ended && job.text.back() != '\n') {
+        size_t const at = job.text.size();
+
+        job.text.resize(at + SAM_CELL);
+
+        size_t const more = source->Read(next + at, &job.text[at], SAM_CELL);
+        char const *const nl = (char const *)memchr(&job.text[at], '\n', more);
+
+        job.text.resize(nl ? (size_t)(nl - &job.text[0]) + 1 : at + more);
+        if (!nl && more < SAM_CELL)
+            ended = true;
+    }
+    if (job.text.empty())
+        return false;
+    next += job.text.size();
+    job.text.push_back('\0');
+    return true;
+}
+
+void SAMReader::Run(Job &job)
+{
+    std::string error;
+
+    try {
+        Parse(text, job.start, job.text, job.bam, job.cuts);
+    }
+    catch (std::exception const &e) {
+        error = e.what();
+        if (error.empty())
+            error = "SAM text could not be parsed";
+    }
+    catch (...) {
+        error = "SAM text could not be parsed";
+    }
+
+    SAMLock lock(mutex);
+
+    job.error = error;
+    job.running = false;
+    job.done = true;
+    std::vector<char>().swap(job.text);
+    pthread_cond_broadcast(&doneCond);
+}
+
+void SAMReader::Submit(Job &job)
+{
+    {
+        SAMLock lock(mutex);
+
+        job.queued = true;
+    }
+    try {
+        pool->submit(job, priority);
+    }
+    catch (ngs::ErrorMsg const &) {
+        /* it is parsed when it is wanted */
+        SAMLock lock(mutex);
+
+        job.queued = false;
+    }
+}
+
+/* Fill
+ *  reads text until "ahead" jobs are parsing or parsed
+ */
+void SAMReader::Fill()
+{
+    while (!ended && jobs.size() < ahead) {
+        Job *const job = new Job(*this);
+
+        try {
+            if (!ReadNext(*job)) {
+                delete job;
+                break;
+            }
+            jobs.push_back(job);
+        }
+        catch (std::runtime_error const &e) {
+            delete job;
+            throw std::runtime_error(text.getPath() + ": " + e.what());
+        }
+        catch (...) {
+            delete job;
+            throw;
+        }
+        if (pool)
+            Submit(*job);
+    }
+}
+
+/* Finish
+ *  waits for "job" to be parsed; one that hasn't started is taken back
+ *  and parsed here, so that the reader never waits on the pool's queue
+ */
+void SAMReader::Finish(Job &job)
+{
+    {
+        SAMLock lock(mutex);
+
+        if (job.queued && pool->cancel(job))
+            job.queued = false;
+        while (job.queued || job.running)
+            pthread_cond_wait(&doneCond, &mutex);
+        if (job.done)
+            return;
+        job.running = true;
+    }
+    Run(job);
+}
+
+/* Seek
+ *  to a block of the header, or to the line of a block of records,
+ *  which is one that starts after a newline
+ */
+void SAMReader::Seek(uint64_t const fpos)
+{
+    uint64_t const bias = text.headerBlocks();
+    uint64_t const headerEnd = text.getHeaderEnd();
+
+    Drop();
+    ended = false;
+    complete = false;
+    if (fpos < bias) {
+        headerNext = fpos;
+        next = headerEnd;
+        return;
+    }
+
+    uint64_t const pos = fpos - bias;
+    char before = '\n';
+
+    if (pos < headerEnd || (pos > headerEnd && (source->Read(pos - 1, &before, 1) != 1 || before != '\n')))
+        throw std::runtime_error("position is invalid");
+    headerNext = bias;
+    next = pos;
+}
+
+BGZFBlock const *SAMReader::Next(void)
+{
+    if (headerNext < text.headerBlocks()) {
+        std::string const &header = text.getHeader();
+        size_t const at = (size_t)headerNext * BGZF_BLK_DATA;
+        size_t const size = std::min(header.size() - at, (size_t)BGZF_BLK_DATA);
+
+        memcpy(block.data, header.data() + at, size);
+        block.size = (unsigned)size;
+        block.fpos = headerNext++;
+        return &block;
+    }
+    for ( ; ; ) {
+        Fill();
+        if (jobs.empty()) {
+            complete = true;
+            return 0;
+        }
+
+        Job &job = *jobs.front();
+
+        Finish(job);
+        if (!job.error.empty())
+            throw std::runtime_error(text.getPath() + ": " + job.error);
+        if (taken < job.cuts.size()) {
+            size_t const beg = job.cuts[taken].first;
+            size_t const end = taken + 1 < job.cuts.size() ? job.cuts[taken + 1].first : job.bam.size();
+
+            memcpy(block.data, &job.bam[beg], end - beg);
+            block.size = (unsigned)(end - beg);
+            block.fpos = job.cuts[taken++].second;
+            return &block;
+        }
+        delete jobs.front();
+        jobs.erase(jobs.begin());
+        taken = 0;
+    }
+}
@@ -0,0 +1,226 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_sam_
+#define _hpp_sam_
+
+#include <stdint.h>
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <ngs/WorkPool.hpp>
+
+#include "bgzf.hpp"
+
+class BAMFile;
+class BAMRecord;
+class ByteSource;
+class MemoryLedger;
+
+/* SAMFormatter
+ *  formats records as SAM text into a byte buffer
+ *  records are collected in the buffer and written to an ostream
+ *  in batches, or the buffer is handed to the caller
+ */
+class SAMFormatter
+{
+    BAMFile const &file;
+    std::ostream *const out;        /* NULL if the caller takes the text */
+    size_t const batch;
+    std::vector<char> buffer;
+    size_t used;
+
+    SAMFormatter(SAMFormatter const &);
+    SAMFormatter &operator =(SAMFormatter const &);
+public:
+    explicit SAMFormatter(BAMFile const &File);
+    SAMFormatter(BAMFile const &File, std::ostream &Out, size_t Batch = 1024u * 1024u);
+    ~SAMFormatter();
+
+    /* Write
+     *  add a record as a line of SAM
+     */
+    void Write(BAMRecord const &rec);
+    void Flush();
+
+    /* the text collected so far, for a formatter without an ostream */
+    char const *data() const {
+        return used ? &buffer[0] : 0;
+    }
+    size_t size() const {
+        return used;
+    }
+    void Clear() {
+        used = 0;
+    }
+
+    /* MaxSize
+     *  an upper bound on the length of the SAM text of a record
+     */
+    static size_t MaxSize(BAMFile const &file, BAMRecord const &rec);
+
+    /* Format
+     *  write the SAM text of a record, without a newline, to dst,
+     *  which must have room for MaxSize bytes
+     *  returns the end of the text
+     */
+    static char *Format(char *dst, BAMFile const &file, BAMRecord const &rec);
+};
+
+#define SAM_CELL (64u * 1024u)      /* text whose records are kept out of the blocks of others */
+#define SAM_JOB (16u * SAM_CELL)    /* text that one job parses */
+
+/* SAMText
+ *  what is known of a SAM file, plain or bgzipped, by all its readers:
+ *  its header, made into a BAM one, and for a bgzipped file where the
+ *  text of each of its BGZF blocks starts, learnt as they are read
+ *
+ *  a SAMReader gives a BAMFileCursor blocks of BAM records, so the file
+ *  is read as if it were a BAM file whose virtual positions are made of
+ *  the text's: the header's blocks are at 0 to headerBlocks - 1, and a
+ *  block of records is at headerBlocks plus where the line of its first
+ *  one starts; a record too large for a block goes on in blocks at the
+ *  next positions, which are in its line, and the next record starts a
+ *  new block. as blocks don't take records from more than one SAM_CELL
+ *  of the text, a reader that seeks to one makes the same blocks from
+ *  there that one reading from the start does
+ */
+class SAMText
+{
+    std::string const path;
+    bool sam;
+    bool bgzipped;
+    std::string header;             /* as a BAM file has it, from its magic on */
+    uint64_t headerEnd;             /* where the first record's line starts */
+    std::vector<std::string> names; /* of the references, sorted */
+    std::vector<int32_t> ids;       /* of names, in the header */
+    mutable pthread_mutex_t mutex;
+    mutable std::vector<std::pair<uint64_t, uint64_t> > blocks;   /* text and file position of each BGZF block */
+
+    void Probe(void);
+    void ReadHeader(void);
+    static void ParseReferences(std::string const &text, std::vector<std::pair<std::string, int32_t> > &refs);
+
+    SAMText(SAMText const &);
+    SAMText &operator =(SAMText const &);
+public:
+    /* a stream, or a URL that doesn't end in .sam, .sam.gz or .sam.bgz,
+     * is taken to be a BAM file; a local file is looked at */
+    explicit SAMText(std::string const &filepath);
+    ~SAMText();
+
+    bool isSAM() const {
+        return sam;
+    }
+    bool isBGZF() const {
+        return bgzipped;
+    }
+    std::string const &getPath() const {
+        return path;
+    }
+    std::string const &getHeader() const {
+        return header;
+    }
+    uint64_t getHeaderEnd() const {
+        return headerEnd;
+    }
+    uint64_t headerBlocks() const {
+        return (header.size() + BGZF_BLK_DATA - 1) / BGZF_BLK_DATA;
+    }
+
+    /* FindReference
+     *  the ID of the named reference, -1 if there is none
+     */
+    int32_t FindReference(char const name[], size_t const length) const;
+
+    /* Learn, Locate
+     *  a BGZF block that was read, and the last one known that starts
+     *  at or before "text"; false if none is
+     */
+    void Learn(uint64_t const text, uint64_t const fpos) const;
+    bool Locate(uint64_t const text, uint64_t &start, uint64_t &fpos) const;
+};
+
+/* SAMTextSource
+ *  the text of a SAM file by where it is in the text, see sam.cpp
+ */
+class SAMTextSource;
+
+/* SAMReader
+ *  the records of a SAM file as blocks of BAM ones, see SAMText
+ *
+ *  the text is read in jobs of up to SAM_JOB bytes, cut where a line
+ *  ends, on the thread that calls Next; with threads, up to that many
+ *  of them are parsed ahead on the process' ngs::WorkPool, and a bgzipped
+ *  file's blocks are inflated by the workers of its own BGZFReader
+ */
+class SAMReader : public BlockReader
+{
+    struct Job;
+    friend struct Job;
+
+    SAMText const &text;
+    SAMTextSource *const source;
+    uint64_t headerNext;            /* the header's next block to give */
+    uint64_t next;                  /* where the next job's text starts */
+    bool ended;                     /* no more text to read */
+    bool complete;
+    std::vector<Job *> jobs;        /* in file order */
+    size_t taken;                   /* blocks given of the first job */
+    size_t const ahead;             /* jobs to have read */
+    ngs::WorkPool *pool;
+    ngs::WorkPool::Priority const priority;
+    pthread_mutex_t mutex;
+    pthread_cond_t doneCond;
+    BGZFBlock block;
+
+    bool ReadNext(Job &job);
+    void Fill();
+    void Run(Job &job);
+    void Submit(Job &job);
+    void Finish(Job &job);
+    void Drop();
+
+    SAMReader(SAMReader const &);
+    SAMReader &operator =(SAMReader const &);
+public:
+    /* "bgzf" is the reader of a bgzipped file, which the SAMReader
+     * takes; a plain one is opened here, counted in "memory" */
+    SAMReader(SAMText const &text, BGZFReader *const bgzf, unsigned const threads,
+              ngs::WorkPool::Priority const priority = ngs::WorkPool::normal, MemoryLedger *const memory = 0);
+    ~SAMReader();
+
+    void Seek(uint64_t const fpos);
+    BGZFBlock const *Next(void);
+    bool isComplete() const {
+        return complete;
+    }
+};
+
+#endif // _hpp_sam_
@@ -0,0 +1,136 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "sidecar.hpp"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static char const sidecar_magic[] = "NGS-BAM-SIDECAR";
+static unsigned long long sidecars_written;
+
+bool Sidecar::Stamp(std::string const &bampath, uint64_t &size, uint64_t &mtime)
+{
+    struct stat st;
+    
+    if (stat(bampath.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    size = (uint64_t)st.st_size;
+    mtime = (uint64_t)st.st_mtime;
+    return true;
+}
+
+Sidecar::~Sidecar()
+{
+    if (file) {
+        fclose(file);
+        if (!temp.empty())
+            remove(temp.c_str());
+    }
+}
+
+bool Sidecar::OpenRead(std::string const &bampath, char const suffix[])
+{
+    uint64_t size, mtime;
+    
+    if (file || !Stamp(bampath, size, mtime))
+        return false;
+    
+    path = bampath + suffix;
+    file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    
+    char magic[32];
+    unsigned long long fsize = 0, fmtime = 0;
+    
+    if (fscanf(file, "%31s %llu %llu", magic, &fsize, &fmtime) == 3 && fgetc(file) == '\n' &&
+        std::string(magic) == sidecar_magic && fsize == size && fmtime == mtime)
+    {
+        return true;
+    }
+    fclose(file);
+    file = 0;
+    return false;
+}
+
+bool Sidecar::OpenWrite(std::string const &bampath, char const suffix[])
+{
+    uint64_t size, mtime;
+    
+    if (file || !Stamp(bampath, size, mtime))
+        return false;
+    
+    path = bampath + suffix;
+    
+    /* a name of this process' own, so that others writing the same
+     * sidecar at once don't write into its file */
+    char tempSuffix[48];
+    
+    snprintf(tempSuffix, sizeof(tempSuffix), ".tmp%ld.%llu", (long)getpid(),
+             __atomic_fetch_add(&sidecars_written, 1, __ATOMIC_RELAXED));
+    temp = path + tempSuffix;
+    
+    int const fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    
+    if (fd < 0) {
+        temp.clear();
+        return false;
+    }
+    file = fdopen(fd, "wb");
+    if (!file) {
+        close(fd);
+        remove(temp.c_str());
+        temp.clear();
+        return false;
+    }
+    
+    if (fprintf(file, "%s %llu %llu\n", sidecar_magic, (unsigned long long)size, (unsigned long long)mtime) > 0)
+        return true;
+    
+    fclose(file);
+    remove(temp.c_str());
+    file = 0;
+    return false;
+}
+
+bool Sidecar::Commit()
+{
+    if (!file || temp.empty())
+        return false;
+    
+    bool const ok = fflush(file) == 0 && !ferror(file);
+    
+    fclose(file);
+    file = 0;
+    if (ok && rename(temp.c_str(), path.c_str()) == 0) {
+        temp.clear();
+        return true;
+    }
+    remove(temp.c_str());
+    temp.clear();
+    return false;
+}
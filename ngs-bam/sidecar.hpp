@@ -0,0 +1,71 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_sidecar_
+#define _hpp_sidecar_
+
+#include <stdint.h>
+
+#include <string>
+#include <cstdio>
+
+/* Sidecar
+ *  small files kept next to a BAM file that cache what a full scan found
+ *  the first line records the size and modification time of the BAM file;
+ *  a sidecar that doesn't match the BAM file is ignored
+ */
+class Sidecar
+{
+    FILE *file;
+    std::string path;
+    std::string temp;               /* written here, then renamed to path */
+
+    Sidecar(Sidecar const &);
+    Sidecar &operator =(Sidecar const &);
+
+    static bool Stamp(std::string const &bampath, uint64_t &size, uint64_t &mtime);
+public:
+    Sidecar() : file(0) {}
+    ~Sidecar();
+
+    /* OpenRead
+     *  open <bampath><suffix> if it is current
+     *  returns false if it doesn't exist or is stale
+     */
+    bool OpenRead(std::string const &bampath, char const suffix[]);
+
+    /* OpenWrite
+     *  start writing a new sidecar; nothing is visible until Commit
+     *  returns false if the sidecar can't be written, e.g. read-only directory
+     */
+    bool OpenWrite(std::string const &bampath, char const suffix[]);
+    bool Commit();
+
+    FILE *get() const {
+        return file;
+    }
+};
+
+#endif // _hpp_sidecar_
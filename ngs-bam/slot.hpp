@@ -0,0 +1,96 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_slot_
+#define _hpp_slot_
+
+#include <ngs/adapter/StringItf.hpp>
+
+#include <string>
+
+/* StringSlot
+ *  one reusable string per iterator field
+ *  the string is handed out again for the next value once every reference
+ *  to the last value has been released; while one is still held, a fresh
+ *  string takes its place, so a value never changes under its holder
+ *  like the iterators it belongs to, a slot is not thread-safe
+ */
+class StringSlot
+{
+    class String : public ngs_adapt::StringItf
+    {
+        mutable unsigned holders;   /* references handed out */
+    public:
+        String() : ngs_adapt::StringItf(0, 0), holders(0) {}
+
+        void *Duplicate() const {
+            void *const rslt = ngs_adapt::StringItf::Duplicate();
+            ++holders;
+            return rslt;
+        }
+        void Release() {
+            --holders;
+            ngs_adapt::StringItf::Release();
+        }
+        // release the slot's own reference
+        void Drop() {
+            ngs_adapt::StringItf::Release();
+        }
+        bool isHeld() const {
+            return holders != 0;
+        }
+        ngs_adapt::StringItf *Share(char const *const data, size_t const size) {
+            str = data;
+            sz = size;
+            Duplicate();
+            return this;
+        }
+    };
+    String *string;
+
+    StringSlot(StringSlot const &);
+    StringSlot &operator =(StringSlot const &);
+public:
+    StringSlot() : string(0) {}
+    ~StringSlot() {
+        if (string)
+            string->Drop();
+    }
+
+    ngs_adapt::StringItf *Set(char const *const data, size_t const size) {
+        if (string && string->isHeld()) {
+            string->Drop();
+            string = 0;
+        }
+        if (!string)
+            string = new String();
+        return string->Share(data, size);
+    }
+    ngs_adapt::StringItf *Set(std::string const &value) {
+        return Set(value.data(), value.size());
+    }
+};
+
+#endif // _hpp_slot_
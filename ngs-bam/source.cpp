@@ -0,0 +1,645 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "source.hpp"
+#include "htsget.hpp"
+#include "memory.hpp"
+#include "diskcache.hpp"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
+#include <stdexcept>
+#include <cstdio>
+
+#if HAVE_LIBCURL
+#include <curl/curl.h>
+#endif
+
+bool ByteSource::IsURL(std::string const &path)
+{
+    return path.compare(0, 7, "http://") == 0 || path.compare(0, 8, "https://") == 0 ||
+           path.compare(0, 5, "s3://") == 0;
+}
+
+bool ByteSource::IsHtsget(std::string const &path)
+{
+    return path.compare(0, 9, "htsget://") == 0 || path.compare(0, 14, "htsget+http://") == 0 ||
+           path.compare(0, 15, "htsget+https://") == 0;
+}
+
+bool ByteSource::IsStream(std::string const &path)
+{
+    struct stat st;
+    
+    if (path == "-" || IsHtsget(path))
+        return true;
+    return !IsURL(path) && stat(path.c_str(), &st) == 0 && !S_ISREG(st.st_mode) && !S_ISBLK(st.st_mode);
+}
+
+ByteSource *ByteSource::Open(std::string const &path, MemoryLedger *const memory)
+{
+    if (IsStream(path))
+        return new StreamSource(path, memory);
+    if (!IsURL(path))
+        return new FileSource(path);
+#if HAVE_LIBCURL
+    if (path.compare(0, 5, "s3://") == 0) {
+        size_t const slash = path.find('/', 5);
+        
+        if (slash == std::string::npos || slash == 5)
+            throw std::runtime_error(std::string("The file '")+path+"' could not be opened");
+        return new HTTPSource("https://" + path.substr(5, slash - 5) + ".s3.amazonaws.com" + path.substr(slash), memory);
+    }
+    return new HTTPSource(path, memory);
+#else
+    throw std::runtime_error(std::string("The file '")+path+"' could not be opened: built without HTTP support");
+#endif
+}
+
+FileSource::FileSource(std::string const &filepath)
+{
+    fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("The file '")+filepath+"' could not be opened");
+}
+
+FileSource::~FileSource()
+{
+    close(fd);
+}
+
+size_t FileSource::Read(uint64_t const fpos, void *const dst, size_t const length)
+{
+    for ( ; ; ) {
+        ssize_t const nread = pread(fd, dst, length, (off_t)fpos);
+        
+        if (nread >= 0)
+            return (size_t)nread;
+        if (errno != EINTR)
+            throw std::runtime_error("read failed");
+    }
+}
+
+void FileSource::WillNeed(uint64_t const fpos, uint64_t const length)
+{
+    /* only a hint, failure doesn't matter */
+#ifdef POSIX_FADV_WILLNEED
+    posix_fadvise(fd, (off_t)fpos, (off_t)length, POSIX_FADV_WILLNEED);
+#endif
+}
+
+void FileSource::DontNeed(uint64_t const fpos, uint64_t const length)
+{
+    /* only a hint, failure doesn't matter */
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(fd, (off_t)fpos, (off_t)length, POSIX_FADV_DONTNEED);
+#endif
+}
+
+/* what a stream keeps behind the furthest read, and the most it reads at once */
+static size_t const STREAM_KEEP = 32u * 1024u * 1024u;
+static size_t const STREAM_READ = 1024u * 1024u;
+
+struct StreamSource::Stream
+{
+    std::string path;
+    MemoryLedger *memory;
+    int fd;                         /* stdin's isn't closed, -1 with a feed */
+#if HAVE_LIBCURL
+    HtsgetFeed *feed;               /* of an htsget path */
+#endif
+    unsigned users;
+    pthread_mutex_t mutex;          /* guards the rest */
+    uint64_t base;                  /* file position of data */
+    std::vector<uint8_t> data;
+    bool eof;
+};
+
+/* the open streams, by path and ledger */
+static pthread_mutex_t streamsLock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<StreamSource::Stream *> streams;
+
+StreamSource::StreamSource(std::string const &path, MemoryLedger *const memory)
+: stream(Attach(path, memory))
+{
+}
+
+/* Find
+ *  the open stream of "path", with another user, or NULL; called with
+ *  streamsLock held
+ */
+StreamSource::Stream *StreamSource::Find(std::string const &path, MemoryLedger *const memory)
+{
+    for (unsigned i = 0; i < streams.size(); ++i) {
+        if (streams[i]->path == path && streams[i]->memory == memory) {
+            ++streams[i]->users;
+            return streams[i];
+        }
+    }
+    return 0;
+}
+
+StreamSource::Stream *StreamSource::Attach(std::string const &path, MemoryLedger *const memory)
+{
+    pthread_mutex_lock(&streamsLock);
+    
+    Stream *const found = Find(path, memory);
+    
+    if (found) {
+        pthread_mutex_unlock(&streamsLock);
+        return found;
+    }
+    if (!IsHtsget(path)) {
+        int const fd = path == "-" ? 0 : open(path.c_str(), O_RDONLY);
+        
+        if (fd < 0) {
+            pthread_mutex_unlock(&streamsLock);
+            throw std::runtime_error(std::string("The file '")+path+"' could not be opened");
+        }
+        return Attached(path, memory, fd, 0);
+    }
+    pthread_mutex_unlock(&streamsLock);
+#if HAVE_LIBCURL
+    /* the ticket is fetched without the lock; whoever attached the
+     * path meanwhile is joined instead */
+    HtsgetFeed *const feed = new HtsgetFeed(path, memory);
+    
+    pthread_mutex_lock(&streamsLock);
+    
+    Stream *const raced = Find(path, memory);
+    
+    if (raced) {
+        pthread_mutex_unlock(&streamsLock);
+        delete feed;
+        return raced;
+    }
+    return Attached(path, memory, -1, feed);
+#else
+    throw std::runtime_error(std::string("The file '")+path+"' could not be opened: built without HTTP support");
+#endif
+}
+
+/* Attached
+ *  a new stream of "path", called with streamsLock held, which it lets go
+ */
+StreamSource::Stream *StreamSource::Attached(std::string const &path, MemoryLedger *const memory, int const fd, HtsgetFeed *const feed)
+{
+    Stream *const added = new Stream();
+    
+    added->path = path;
+    added->memory = memory;
+    added->fd = fd;
+#if HAVE_LIBCURL
+    added->feed = feed;
+#endif
+    added->users = 1;
+    added->base = 0;
+    added->eof = false;
+    pthread_mutex_init(&added->mutex, 0);
+    streams.push_back(added);
+    pthread_mutex_unlock(&streamsLock);
+    return added;
+}
+
+StreamSource::~StreamSource()
+{
+    pthread_mutex_lock(&streamsLock);
+    if (--stream->users > 0) {
+        pthread_mutex_unlock(&streamsLock);
+        return;
+    }
+    for (unsigned i = 0; i < streams.size(); ++i) {
+        if (streams[i] == stream) {
+            streams.erase(streams.begin() + i);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&streamsLock);
+    
+    if (stream->fd > 0)
+        close(stream->fd);
+#if HAVE_LIBCURL
+    delete stream->feed;
+#endif
+    if (stream->memory)
+        stream->memory->Remove(MemoryLedger::ioBuffers, stream->data.capacity());
+    pthread_mutex_destroy(&stream->mutex);
+    delete stream;
+}
+
+/* Read
+ *  reads on to the end of what is asked for, then lets go of all but
+ *  the last STREAM_KEEP bytes once it holds twice as many; the buffer
+ *  never shrinks, so only its growth is counted
+ */
+size_t StreamSource::Read(uint64_t const fpos, void *const dst, size_t const length)
+{
+    Stream &s = *stream;
+    size_t copied = 0;
+    
+    pthread_mutex_lock(&s.mutex);
+    
+    size_t const before = s.data.capacity();
+    
+    try {
+        if (fpos < s.base)
+            throw std::runtime_error("'" + s.path + "' is a stream and what is before the last bytes read can't be read again");
+        while (!s.eof && fpos + length > s.base + s.data.size()) {
+            size_t const have = s.data.size();
+            size_t const want = (size_t)(fpos + length - (s.base + have));
+            
+            s.data.resize(have + (want > STREAM_READ ? want : STREAM_READ));
+            
+#if HAVE_LIBCURL
+            ssize_t const nread = s.feed ? (ssize_t)s.feed->Read(&s.data[have], s.data.size() - have)
+                                         : read(s.fd, &s.data[have], s.data.size() - have);
+#else
+            ssize_t const nread = read(s.fd, &s.data[have], s.data.size() - have);
+#endif
+            
+            s.data.resize(have + (nread > 0 ? (size_t)nread : 0));
+            if (nread == 0)
+                s.eof = true;
+            else if (nread < 0 && errno != EINTR)
+                throw std::runtime_error("read failed");
+        }
+    }
+    catch (...) {
+        pthread_mutex_unlock(&s.mutex);
+        throw;
+    }
+    if (fpos < s.base + s.data.size()) {
+        size_t const at = (size_t)(fpos - s.base);
+        
+        copied = s.data.size() - at < length ? s.data.size() - at : length;
+        memcpy(dst, &s.data[at], copied);
+    }
+    if (s.data.size() > 2 * STREAM_KEEP) {
+        size_t const drop = s.data.size() - STREAM_KEEP;
+        
+        s.data.erase(s.data.begin(), s.data.begin() + drop);
+        s.base += drop;
+    }
+    if (s.memory && s.data.capacity() > before)
+        s.memory->Add(MemoryLedger::ioBuffers, s.data.capacity() - before);
+    pthread_mutex_unlock(&s.mutex);
+    return copied;
+}
+
+CachedSource::CachedSource(ByteSource *const Source, DiskCache &Cache, std::string const &Tag)
+: source(Source)
+, cache(Cache)
+, tag(Tag)
+, pieceAt(~(uint64_t)0)
+{
+}
+
+CachedSource::~CachedSource()
+{
+    delete source;
+}
+
+/* Load
+ *  the piece at fpos, from the cache, else fetched and put there; one
+ *  that is short is the last of the file
+ *  returns false at end of file
+ */
+bool CachedSource::Load(uint64_t const fpos)
+{
+    if (pieceAt == fpos)
+        return !piece.empty();
+    
+    size_t size = PIECE;
+    
+    pieceAt = ~(uint64_t)0;
+    piece.resize(PIECE);
+    if (cache.Get(tag, fpos, 'c', &piece[0], size))
+        piece.resize(size);
+    else {
+        size_t got = 0;
+        
+        while (got < PIECE) {
+            size_t const nread = source->Read(fpos + got, &piece[got], PIECE - got);
+            if (nread == 0)
+                break;
+            got += nread;
+        }
+        piece.resize(got);
+        if (got > 0)
+            cache.Put(tag, fpos, 'c', &piece[0], got);
+    }
+    pieceAt = fpos;
+    return !piece.empty();
+}
+
+size_t CachedSource::Read(uint64_t const fpos, void *const dst, size_t const length)
+{
+    size_t copied = 0;
+    
+    /* from as many pieces as it takes, up to the end of the file */
+    while (copied < length) {
+        uint64_t const pos = fpos + copied;
+        uint64_t const at = pos - pos % PIECE;
+        
+        if (!Load(at) || pos - at >= piece.size())
+            break;
+        
+        size_t const offset = (size_t)(pos - at);
+        size_t const avail = piece.size() - offset;
+        size_t const n = length - copied < avail ? length - copied : avail;
+        
+        memcpy(static_cast<uint8_t *>(dst) + copied, &piece[offset], n);
+        copied += n;
+    }
+    return copied;
+}
+
+#if HAVE_LIBCURL
+
+/* a miss fetches at least minFetch bytes, and planned ranges are
+ * joined to a fetch if they start within maxGap bytes of its end,
+ * up to maxFetch bytes in all */
+static uint64_t const minFetch = 64u * 1024u;
+static uint64_t const maxGap = 256u * 1024u;
+static uint64_t const maxFetch = 64u * 1024u * 1024u;
+static size_t const maxPlanned = 4096;
+
+static pthread_once_t curlOnce = PTHREAD_ONCE_INIT;
+
+static void CurlInit(void)
+{
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+void InitCurl(void)
+{
+    pthread_once(&curlOnce, CurlInit);
+}
+
+/* the body of a response, cut off at what was asked for */
+struct HTTPSink {
+    std::vector<uint8_t> *data;
+    size_t limit;
+};
+
+static size_t WriteBody(char *const ptr, size_t const size, size_t const nmemb, void *const arg)
+{
+    HTTPSink &sink = *static_cast<HTTPSink *>(arg);
+    size_t const n = size * nmemb;
+    size_t const room = sink.limit - sink.data->size();
+    size_t const take = n < room ? n : room;
+    
+    sink.data->insert(sink.data->end(), ptr, ptr + take);
+    return take == n ? n : 0;       /* 0 stops a server that sends more, e.g. ignoring the range */
+}
+
+HTTPSource::HTTPSource(std::string const &URL, MemoryLedger *const Memory)
+: url(URL)
+, memory(Memory)
+, curl(0)
+, streak(minFetch)
+, requests(0)
+{
+    InitCurl();
+    
+    CURL *const handle = curl_easy_init();
+    if (handle == 0)
+        throw std::runtime_error(std::string("The file '")+url+"' could not be opened");
+    
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteBody);
+    curl = handle;
+    
+    for (unsigned i = 0; i < sizeof(windows) / sizeof(windows[0]); ++i)
+        windows[i].fpos = 0;
+    pthread_mutex_init(&mutex, 0);
+}
+
+HTTPSource::~HTTPSource()
+{
+    if (memory) {
+        for (unsigned i = 0; i < sizeof(windows) / sizeof(windows[0]); ++i)
+            memory->Remove(MemoryLedger::remoteWindows, windows[i].data.capacity());
+    }
+    pthread_mutex_destroy(&mutex);
+    curl_easy_cleanup(static_cast<CURL *>(curl));
+}
+
+uint64_t HTTPSource::Requests() const
+{
+    return __atomic_load_n(&requests, __ATOMIC_RELAXED);
+}
+
+/* Fetch
+ *  one request for [beg, end), less at end of file
+ */
+void HTTPSource::Fetch(uint64_t const beg, uint64_t const end, Window &into)
+{
+    CURL *const handle = static_cast<CURL *>(curl);
+    char range[64];
+    HTTPSink sink;
+    long code = 0;
+    size_t const before = into.data.capacity();
+    
+    into.fpos = beg;
+    if (MemoryLedger::OverBudget())
+        std::vector<uint8_t>().swap(into.data);
+    else
+        into.data.clear();
+    into.data.reserve((size_t)(end - beg));
+    if (memory) {
+        memory->Remove(MemoryLedger::remoteWindows, before);
+        memory->Add(MemoryLedger::remoteWindows, into.data.capacity());
+    }
+    sink.data = &into.data;
+    sink.limit = (size_t)(end - beg);
+    
+    snprintf(range, sizeof(range), "%llu-%llu", (unsigned long long)beg, (unsigned long long)(end - 1));
+    curl_easy_setopt(handle, CURLOPT_RANGE, range);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &sink);
+    
+    CURLcode const rc = curl_easy_perform(handle);
+    
+    __atomic_fetch_add(&requests, 1, __ATOMIC_RELAXED);
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+    
+    if (code == 416) {
+        /* the range starts at or after the end of the file */
+        into.data.clear();
+        return;
+    }
+    if (rc != CURLE_OK && !(rc == CURLE_WRITE_ERROR && into.data.size() == sink.limit)) {
+        into.data.clear();
+        throw std::runtime_error(std::string("The file '")+url+"' could not be read: "+curl_easy_strerror(rc));
+    }
+    if (code == 200 && beg > 0) {
+        /* the whole file came back, but the start of it isn't wanted */
+        into.data.clear();
+        throw std::runtime_error(std::string("The file '")+url+"' could not be read: the server doesn't support range requests");
+    }
+    if (code != 200 && code != 206) {
+        char msg[32];
+        
+        into.data.clear();
+        snprintf(msg, sizeof(msg), "HTTP status %ld", code);
+        throw std::runtime_error(std::string("The file '")+url+"' could not be read: "+msg);
+    }
+}
+
+/* PlanFetch
+ *  extend a fetch of [beg, end) over the planned ranges close after it
+ *  returns the new end; the ranges it covers are no longer planned
+ */
+uint64_t HTTPSource::PlanFetch(uint64_t const beg, uint64_t end)
+{
+    pthread_mutex_lock(&mutex);
+    
+    std::map<uint64_t, uint64_t>::iterator i = planned.upper_bound(beg);
+    
+    if (i != planned.begin()) {
+        std::map<uint64_t, uint64_t>::iterator prev = i;
+        if ((--prev)->second > beg)
+            i = prev;               /* beg is inside it */
+    }
+    uint64_t const limit = end > beg + maxFetch ? end : beg + maxFetch;
+    
+    while (i != planned.end() && i->first <= end + maxGap && end < limit) {
+        if (i->second > end)
+            end = i->second < limit ? i->second : limit;
+        if (i->second > end)
+            break;                  /* the rest of it is for another fetch */
+        planned.erase(i++);
+    }
+    pthread_mutex_unlock(&mutex);
+    return end;
+}
+
+size_t HTTPSource::Read(uint64_t const fpos, void *const dst, size_t const length)
+{
+    unsigned const count = sizeof(windows) / sizeof(windows[0]);
+    unsigned found = count;
+    
+    for (unsigned i = 0; i < count; ++i) {
+        if (fpos >= windows[i].fpos && fpos - windows[i].fpos < windows[i].data.size()) {
+            found = i;
+            break;
+        }
+    }
+    if (found == count) {
+        bool const sequential = !windows[0].data.empty() &&
+                                fpos == windows[0].fpos + windows[0].data.size();
+        
+        streak = !sequential || MemoryLedger::OverBudget(2 * streak) ? minFetch
+               : 2 * streak < maxFetch ? 2 * streak : maxFetch;
+        
+        uint64_t const end = PlanFetch(fpos, fpos + (length > streak ? length : streak));
+        
+        /* the oldest window becomes the newest */
+        found = count - 1;
+        Fetch(fpos, end, windows[found]);
+        if (windows[found].data.empty())
+            return 0;
+    }
+    for ( ; found > 0; --found)
+        windows[found].swap(windows[found - 1]);
+    
+    Window const &window = windows[0];
+    size_t const offset = (size_t)(fpos - window.fpos);
+    size_t const avail = window.data.size() - offset;
+    size_t const n = length < avail ? length : avail;
+    
+    memcpy(dst, &window.data[offset], n);
+    return n;
+}
+
+void HTTPSource::WillNeed(uint64_t const fpos, uint64_t const length)
+{
+    if (length == 0)
+        return;
+    pthread_mutex_lock(&mutex);
+    
+    uint64_t &end = planned[fpos];
+    
+    if (end < fpos + length)
+        end = fpos + length;
+    while (planned.size() > maxPlanned)
+        planned.erase(planned.begin());
+    pthread_mutex_unlock(&mutex);
+}
+
+/* FindETag
+ *  the ETag header of a response; a redirect's doesn't count
+ */
+static size_t FindETag(char *const ptr, size_t const size, size_t const nmemb, void *const arg)
+{
+    std::string &etag = *static_cast<std::string *>(arg);
+    size_t const n = size * nmemb;
+    std::string const line(ptr, n);
+    
+    if (line.compare(0, 5, "HTTP/") == 0)
+        etag.clear();
+    else if (n > 5 && strncasecmp(ptr, "ETag:", 5) == 0) {
+        std::string::size_type const beg = line.find_first_not_of(" \t", 5);
+        std::string::size_type const end = line.find_last_not_of(" \t\r\n");
+        
+        if (beg != std::string::npos && end != std::string::npos && end >= beg)
+            etag = line.substr(beg, end - beg + 1);
+    }
+    return n;
+}
+
+std::string HTTPSource::Tag()
+{
+    CURL *const handle = static_cast<CURL *>(curl);
+    std::string etag;
+    long code = 0;
+    
+    curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, FindETag);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, &etag);
+    
+    CURLcode const rc = curl_easy_perform(handle);
+    
+    __atomic_fetch_add(&requests, 1, __ATOMIC_RELAXED);
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, (void *)0);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, (void *)0);
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    
+    /* a weak one doesn't promise the same bytes */
+    if (rc != CURLE_OK || code != 200 || etag.compare(0, 2, "W/") == 0)
+        return std::string();
+    return etag;
+}
+
+#endif
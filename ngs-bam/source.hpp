@@ -0,0 +1,254 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef _hpp_source_
+#define _hpp_source_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+class MemoryLedger;
+class DiskCache;
+class HtsgetFeed;
+
+/* ByteSource
+ *  random access to the bytes of a file, local or remote
+ *  Read is only called by one thread at a time; WillNeed may be
+ *  called by another thread while it runs
+ */
+class ByteSource
+{
+    ByteSource(ByteSource const &);
+    ByteSource &operator =(ByteSource const &);
+protected:
+    ByteSource() {}
+public:
+    virtual ~ByteSource() {}
+
+    /* Read
+     *  copy up to "length" bytes at fpos into dst
+     *  returns the number of bytes copied, 0 at end of file
+     */
+    virtual size_t Read(uint64_t const fpos, void *const dst, size_t const length) = 0;
+
+    /* WillNeed
+     *  a hint that [fpos, fpos + length) is going to be read
+     */
+    virtual void WillNeed(uint64_t const fpos, uint64_t const length) = 0;
+
+    /* DontNeed
+     *  a hint that [fpos, fpos + length) is not going to be read again,
+     *  so that a local file's pages can be dropped from the page cache
+     */
+    virtual void DontNeed(uint64_t const fpos, uint64_t const length) {}
+
+    /* Descriptor
+     *  the file descriptor of a local file, e.g. for mapping it; -1 if remote
+     */
+    virtual int Descriptor() const {
+        return -1;
+    }
+
+    /* Requests
+     *  the number of requests made to a remote source
+     */
+    virtual uint64_t Requests() const {
+        return 0;
+    }
+
+    /* Tag
+     *  what tells this version of the file from any other, e.g. the ETag
+     *  of a remote one; empty if nothing does
+     */
+    virtual std::string Tag() {
+        return std::string();
+    }
+
+    /* IsURL
+     *  whether the path is an http://, https:// or s3:// URL
+     *  rather than a local file
+     */
+    static bool IsURL(std::string const &path);
+
+    /* IsHtsget
+     *  whether the path is an htsget:// or htsget+http(s):// one, of a
+     *  file on an htsget server, see htsget.hpp
+     */
+    static bool IsHtsget(std::string const &path);
+
+    /* IsStream
+     *  whether the path is "-", for stdin, a local file that can only
+     *  be read forward, e.g. a pipe or /dev/fd/<n>, or an htsget path
+     */
+    static bool IsStream(std::string const &path);
+
+    /* Open
+     *  a local file, a stream or a URL; s3://bucket/key is read over
+     *  HTTPS from the bucket's public endpoint
+     *  without HAVE_LIBCURL, URLs can't be opened
+     *  what a remote file fetches and what a stream keeps are counted
+     *  in "memory", if there is one
+     */
+    static ByteSource *Open(std::string const &path, MemoryLedger *const memory = 0);
+};
+
+/* FileSource
+ *  a local file, read with pread
+ */
+class FileSource : public ByteSource
+{
+    int fd;
+public:
+    explicit FileSource(std::string const &filepath);
+    ~FileSource();
+
+    size_t Read(uint64_t const fpos, void *const dst, size_t const length);
+    void WillNeed(uint64_t const fpos, uint64_t const length);
+    void DontNeed(uint64_t const fpos, uint64_t const length);
+    int Descriptor() const {
+        return fd;
+    }
+};
+
+/* StreamSource
+ *  a file that can only be read forward, read with read, or the
+ *  blocks of an htsget ticket, read with an HtsgetFeed
+ *
+ *  the sources of one path that count in the same ledger, i.e. the
+ *  readers of one BAM file, share a Stream, which keeps the last
+ *  STREAM_KEEP bytes it read, so that a reader may start a little
+ *  behind the one furthest ahead, as the first iterator does at the
+ *  first record, which was read with the header; a read that starts
+ *  before what is kept throws
+ */
+class StreamSource : public ByteSource
+{
+public:
+    struct Stream;
+private:
+    Stream *const stream;
+
+    static Stream *Attach(std::string const &path, MemoryLedger *const memory);
+    static Stream *Find(std::string const &path, MemoryLedger *const memory);
+    static Stream *Attached(std::string const &path, MemoryLedger *const memory, int const fd, HtsgetFeed *const feed);
+public:
+    StreamSource(std::string const &path, MemoryLedger *const memory = 0);
+    ~StreamSource();
+
+    size_t Read(uint64_t const fpos, void *const dst, size_t const length);
+    void WillNeed(uint64_t const fpos, uint64_t const length) {}
+};
+
+/* CachedSource
+ *  a remote file whose bytes are kept in a DiskCache as they are
+ *  fetched, in pieces of PIECE bytes at multiples of it, so that reads
+ *  of them later, by this process or another, are made from there
+ *  the last piece is kept for the reads that follow it
+ */
+class CachedSource : public ByteSource
+{
+    ByteSource *const source;       /* owned */
+    DiskCache &cache;
+    std::string const tag;          /* the version of the file */
+    std::vector<uint8_t> piece;
+    uint64_t pieceAt;               /* where "piece" is from, or ~0 */
+
+    bool Load(uint64_t const fpos);
+public:
+    enum { PIECE = 64 * 1024 };
+
+    /* takes "source" over */
+    CachedSource(ByteSource *const source, DiskCache &cache, std::string const &tag);
+    ~CachedSource();
+
+    size_t Read(uint64_t const fpos, void *const dst, size_t const length);
+    void WillNeed(uint64_t const fpos, uint64_t const length) {
+        source->WillNeed(fpos, length);
+    }
+    uint64_t Requests() const {
+        return source->Requests();
+    }
+};
+
+#if HAVE_LIBCURL
+/* InitCurl
+ *  libcurl's global setup, done once for all who use it
+ */
+void InitCurl(void);
+
+/* HTTPSource
+ *  a file on an HTTP(S) server that honors range requests
+ *
+ *  each request fetches a window of the file that is kept for the
+ *  reads that follow; a miss starts a new window where it is and
+ *  makes it reach over every range that WillNeed has asked for that
+ *  lies close enough after it, so that the chunks an index plans for
+ *  a query come in a few large requests instead of one per seek
+ *  a read right after the last window doubles the size of the next,
+ *  so that scans use ever fewer requests, unless the process is over
+ *  its memory budget
+ */
+class HTTPSource : public ByteSource
+{
+    struct Window {
+        uint64_t fpos;
+        std::vector<uint8_t> data;
+
+        void swap(Window &other) {
+            uint64_t const tmp = fpos;
+            fpos = other.fpos;
+            other.fpos = tmp;
+            data.swap(other.data);
+        }
+    };
+    std::string const url;
+    MemoryLedger *const memory;     /* counts the windows, may be NULL */
+    void *curl;                     /* CURL *, used by Read only */
+    Window windows[4];              /* most recently fetched first */
+    size_t streak;                  /* size of the next sequential fetch */
+    uint64_t requests;
+    std::map<uint64_t, uint64_t> planned;   /* start to end of the ranges asked for */
+    pthread_mutex_t mutex;          /* guards planned */
+
+    uint64_t PlanFetch(uint64_t const beg, uint64_t end);
+    void Fetch(uint64_t const beg, uint64_t const end, Window &into);
+public:
+    explicit HTTPSource(std::string const &url, MemoryLedger *const memory = 0);
+    ~HTTPSource();
+
+    size_t Read(uint64_t const fpos, void *const dst, size_t const length);
+    void WillNeed(uint64_t const fpos, uint64_t const length);
+    uint64_t Requests() const;
+    /* the ETag of a HEAD request, unless it is weak */
+    std::string Tag();
+};
+#endif
+
+#endif // _hpp_source_
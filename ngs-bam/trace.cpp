@@ -0,0 +1,203 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "trace.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <new>
+
+bool Trace::on = false;
+
+uint64_t Trace::Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#if NGS_BAM_TRACE
+
+namespace {
+    struct Event {
+        char const *name;
+        uint64_t start;
+        uint64_t duration;
+    };
+    
+    /* Ring
+     *  of a thread that has recorded, kept after it exits so that
+     *  its spans are still written
+     */
+    struct Ring {
+        Event events[Trace::ringSize];
+        uint64_t count;             /* recorded, of which the last ringSize are kept */
+        unsigned thread;
+        Ring *next;
+    };
+    
+    Ring *rings = 0;
+    unsigned numRings = 0;
+    pthread_mutex_t ringsLock = PTHREAD_MUTEX_INITIALIZER;
+    __thread Ring *threadRing = 0;
+    
+    /* ThreadID
+     *  the system's, where there is one, so that these spans are on the
+     *  same tracks as the dispatch layer's
+     */
+    unsigned ThreadID(unsigned const nth)
+    {
+#if defined(__linux__)
+        return (unsigned)syscall(SYS_gettid);
+#else
+        return nth;
+#endif
+    }
+}
+
+bool Trace::Compiled()
+{
+    return true;
+}
+
+void Trace::Enable(bool const On)
+{
+    __atomic_store_n(&on, On, __ATOMIC_RELAXED);
+}
+
+void Trace::Record(char const *const name, uint64_t const start, uint64_t const end)
+{
+    Ring *r = threadRing;
+    
+    if (r == 0) {
+        r = new (std::nothrow) Ring;
+        if (r == 0)
+            return;
+        r->count = 0;
+        pthread_mutex_lock(&ringsLock);
+        r->thread = ThreadID(++numRings);
+        r->next = rings;
+        rings = r;
+        pthread_mutex_unlock(&ringsLock);
+        threadRing = r;
+    }
+    Event &e = r->events[r->count % ringSize];
+    e.name = name;
+    e.start = start;
+    e.duration = end - start;
+    __atomic_store_n(&r->count, r->count + 1, __ATOMIC_RELEASE);
+}
+
+void Trace::Clear()
+{
+    pthread_mutex_lock(&ringsLock);
+    for (Ring *r = rings; r; r = r->next)
+        __atomic_store_n(&r->count, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&ringsLock);
+}
+
+void Trace::Export(FILE *const out, bool const open)
+{
+    int const pid = (int)getpid();
+    
+    if (open)
+        fprintf(out, "[\n");
+    pthread_mutex_lock(&ringsLock);
+    for (Ring const *r = rings; r; r = r->next) {
+        uint64_t const count = __atomic_load_n(&r->count, __ATOMIC_ACQUIRE);
+        uint64_t const kept = count < ringSize ? count : ringSize;
+        
+        for (uint64_t i = count - kept; i < count; ++i) {
+            Event const &e = r->events[i % ringSize];
+            fprintf(out, "{\"name\":\"%s\",\"cat\":\"ngs-bam\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u},\n"
+                    , e.name, e.start / 1000.0, e.duration / 1000.0, pid, r->thread);
+        }
+    }
+    pthread_mutex_unlock(&ringsLock);
+    fflush(out);
+}
+
+/* NGS_TRACE in the environment turns tracing on, and names the file
+ * the spans are appended to at exit, or stderr for "1" */
+static void ExportAtExit()
+{
+    char const *const dest = getenv("NGS_TRACE");
+    
+    if (dest == 0 || strcmp(dest, "1") == 0) {
+        Trace::Export(stderr);
+        return;
+    }
+    FILE *const out = fopen(dest, "a");
+    if (out) {
+        Trace::Export(out, ftell(out) == 0);
+        fclose(out);
+    }
+}
+
+static struct TraceFromEnv {
+    TraceFromEnv() {
+        char const *const env = getenv("NGS_TRACE");
+        if (env && env[0]) {
+            Trace::Enable(true);
+            atexit(ExportAtExit);
+        }
+    }
+} traceFromEnv;
+
+#else
+
+bool Trace::Compiled()
+{
+    return false;
+}
+
+void Trace::Enable(bool)
+{
+}
+
+void Trace::Record(char const *, uint64_t, uint64_t)
+{
+}
+
+void Trace::Clear()
+{
+}
+
+void Trace::Export(FILE *const out, bool const open)
+{
+    if (open)
+        fprintf(out, "[\n");
+    fflush(out);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_trace_
+#define _hpp_trace_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Trace
+ *  timed spans of opening, seeking, slicing and inflating, compiled in
+ *  with "make NGS_BAM_TRACE=1" and recorded only while on: while the
+ *  environment variable NGS_TRACE names a file, which the spans are
+ *  appended to at exit, or after Enable
+ *  each thread records into a ring of its own that keeps its latest
+ *  ringSize spans, without a lock; they are written as Chrome trace
+ *  events, for chrome://tracing or Perfetto, the way the SDK's dispatch
+ *  layer writes its own, so that both may go to the same file
+ *  without the flag TRACE_SPAN is nothing; with it, a span costs a
+ *  single branch while tracing is off
+ */
+class Trace
+{
+    static bool on;
+public:
+    static unsigned const ringSize = 65536;
+
+    static bool Compiled();
+    static void Enable(bool const on);
+    static bool Enabled() {
+        return __atomic_load_n(&on, __ATOMIC_RELAXED);
+    }
+
+    /* Export
+     *  the spans kept so far, one event to the line, each followed by
+     *  a comma, after the opening "[" if "open"; the closing "]" may be
+     *  left off in this format
+     */
+    static void Export(FILE *const out, bool const open = true);
+
+    /* Clear
+     *  empties the rings of all threads
+     */
+    static void Clear();
+
+    static uint64_t Now();
+    static void Record(char const *const name, uint64_t const start, uint64_t const end);
+
+    class Span {
+        char const *const name;
+        uint64_t const start;
+    public:
+        explicit Span(char const *const Name)
+        : name(Name)
+        , start(Enabled() ? Now() : 0)
+        {}
+        ~Span() {
+            if (start != 0)
+                Record(name, start, Now());
+        }
+    };
+};
+
+#if NGS_BAM_TRACE
+#define TRACE_SPAN(NAME) Trace::Span const trace_span(NAME)
+#else
+#define TRACE_SPAN(NAME) ((void)0)
+#endif
+
+#endif // _hpp_trace_
@@ -0,0 +1,198 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+
+#include "zones.hpp"
+#include "sidecar.hpp"
+#include "bam.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+static char const zonesSuffix[] = ".ngs-zones";
+static unsigned const zonesVersion = 2;
+
+void ZoneMap::Count(BAMRecord const &rec)
+{
+    int32_t const refID = rec.refID();
+    int32_t const pos = rec.pos();
+    uint16_t const flag = rec.flag();
+    
+    if ((flag & 0x0004) != 0 || refID < 0 || pos < 0)
+        return;
+    if ((unsigned)refID >= totals.size()) {
+        Totals const none = { { 0 } };
+        
+        totals.resize(refID + 1, none);
+        windows.resize(refID + 1);
+    }
+    
+    std::vector<Window> &ref = windows[refID];
+    unsigned const w = (unsigned)pos >> WINDOW_SHIFT;
+    
+    if (w >= ref.size()) {
+        Window const none = { { 0 } };
+        
+        ref.resize(w + 1, none);
+    }
+    
+    Category const kind = (flag & 0x0100) != 0 ? secondary : (flag & 0x0800) != 0 ? supplementary : primary;
+    
+    ++ref[w].count[kind];
+    ++totals[refID].count[kind];
+    if ((flag & 0x0400) != 0) {
+        ++ref[w].count[duplicate];
+        ++totals[refID].count[duplicate];
+    }
+    if ((flag & 0x0200) != 0) {
+        ++ref[w].count[qcFail];
+        ++totals[refID].count[qcFail];
+    }
+}
+
+void ZoneMap::Add(uint64_t const beg, BAMRecord const &rec)
+{
+    int32_t const refID = rec.refID();
+    int32_t const pos = rec.pos();
+    uint16_t const flag = rec.flag();
+    uint8_t const mq = rec.mq();
+    
+    Count(rec);
+    if (zones.empty() || (zones.back().start >> 16) != (beg >> 16)) {
+        BAMZone const zone = { beg, 1, refID, refID, pos, pos, flag, flag, mq, mq, { 0, 0 } };
+        
+        zones.push_back(zone);
+        return;
+    }
+    
+    BAMZone &zone = zones.back();
+    
+    ++zone.count;
+    zone.refMin = std::min(zone.refMin, refID);
+    zone.refMax = std::max(zone.refMax, refID);
+    zone.posMin = std::min(zone.posMin, pos);
+    zone.posMax = std::max(zone.posMax, pos);
+    zone.flagAll &= flag;
+    zone.flagAny |= flag;
+    zone.mqMin = std::min(zone.mqMin, mq);
+    zone.mqMax = std::max(zone.mqMax, mq);
+}
+
+static bool StartsBefore(BAMZone const &zone, uint64_t const pos)
+{
+    return zone.start < pos;
+}
+
+BAMZone const *ZoneMap::Find(uint64_t const pos) const
+{
+    std::vector<BAMZone>::const_iterator const i = std::lower_bound(zones.begin(), zones.end(), pos, StartsBefore);
+    
+    return i != zones.end() && i->start == pos ? &*i : 0;
+}
+
+uint64_t ZoneMap::getCount(unsigned const refID, Category const what, unsigned const beg, unsigned const end) const
+{
+    if (refID >= windows.size() || beg >= end)
+        return 0;
+    
+    std::vector<Window> const &ref = windows[refID];
+    size_t const last = std::min(ref.size(), (size_t)((end - 1) >> WINDOW_SHIFT) + 1);
+    uint64_t count = 0;
+    
+    for (size_t w = beg >> WINDOW_SHIFT; w < last; ++w)
+        count += ref[w].count[what];
+    return count;
+}
+
+size_t ZoneMap::footprint() const
+{
+    size_t bytes = zones.capacity() * sizeof(BAMZone) + totals.capacity() * sizeof(Totals);
+    
+    for (size_t i = 0; i < windows.size(); ++i)
+        bytes += windows[i].capacity() * sizeof(Window);
+    return bytes;
+}
+
+bool ZoneMap::Load(std::string const &bampath)
+{
+    Sidecar cached;
+    char line[64];
+    unsigned version;
+    unsigned long long count, refs;
+    
+    if (!cached.OpenRead(bampath, zonesSuffix) ||
+        !fgets(line, sizeof(line), cached.get()) ||
+        sscanf(line, "zones %u %llu %llu", &version, &count, &refs) != 3 || version != zonesVersion)
+    {
+        return false;
+    }
+    
+    FILE *const fp = cached.get();
+    std::vector<BAMZone> loaded(count);
+    std::vector<std::vector<Window> > counted(refs);
+    Totals const none = { { 0 } };
+    std::vector<Totals> summed(refs, none);
+    
+    if (count > 0 && fread(&loaded[0], sizeof(BAMZone), count, fp) != count)
+        return false;
+    for (size_t i = 0; i < refs; ++i) {
+        uint64_t n;
+        
+        if (fread(&n, sizeof(n), 1, fp) != 1 || n > ((uint64_t)1 << (32 - WINDOW_SHIFT)))
+            return false;
+        counted[i].resize(n);
+        if (n > 0 && fread(&counted[i][0], sizeof(Window), n, fp) != n)
+            return false;
+        for (size_t w = 0; w < n; ++w) {
+            for (unsigned c = 0; c < categories; ++c)
+                summed[i].count[c] += counted[i][w].count[c];
+        }
+    }
+    zones.swap(loaded);
+    windows.swap(counted);
+    totals.swap(summed);
+    return true;
+}
+
+void ZoneMap::Save(std::string const &bampath) const
+{
+    Sidecar update;
+    
+    if (!update.OpenWrite(bampath, zonesSuffix))
+        return;
+    
+    FILE *const fp = update.get();
+    
+    fprintf(fp, "zones %u %llu %llu\n", zonesVersion, (unsigned long long)zones.size(), (unsigned long long)windows.size());
+    if (!zones.empty() && fwrite(&zones[0], sizeof(BAMZone), zones.size(), fp) != zones.size())
+        return;
+    for (size_t i = 0; i < windows.size(); ++i) {
+        uint64_t const n = windows[i].size();
+        
+        if (fwrite(&n, sizeof(n), 1, fp) != 1 || (n > 0 && fwrite(&windows[i][0], sizeof(Window), n, fp) != n))
+            return;
+    }
+    update.Commit();
+}
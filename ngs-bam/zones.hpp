@@ -0,0 +1,145 @@
+/* ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#ifndef _hpp_zones_
+#define _hpp_zones_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+class BAMRecord;
+
+/* BAMZone
+ *  what the records that start in one BGZF block have, the whole range
+ *  of each field; records that start nowhere else are in the block after
+ */
+struct BAMZone
+{
+    uint64_t start;                 /* virtual file position of the first */
+    uint32_t count;
+    int32_t refMin;
+    int32_t refMax;
+    int32_t posMin;
+    int32_t posMax;
+    uint16_t flagAll;               /* the FLAG bits every one has */
+    uint16_t flagAny;               /* and those any one has */
+    uint8_t mqMin;
+    uint8_t mqMax;
+    uint8_t reserved[2];
+};
+
+/* ZoneMap
+ *  a BAMZone for each block that a record starts in, in file order, so
+ *  that a slice can pass over the blocks a filter would reject all the
+ *  records of without inflating them, and the mapped records of each
+ *  reference and of each 16 KiB window of it by category
+ *  kept in a sidecar, <path>.ngs-zones
+ */
+class ZoneMap
+{
+public:
+    /* secondary and supplementary don't overlap, a record with both bits
+     * being secondary, so NGS's secondary alignments are the two of them;
+     * duplicates and QC failures are counted whatever else they are */
+    enum Category { primary, secondary, supplementary, duplicate, qcFail, categories };
+    enum { WINDOW_SHIFT = 14 };
+
+private:
+    struct Window {
+        uint32_t count[categories];
+    };
+    struct Totals {
+        uint64_t count[categories];
+    };
+    std::vector<BAMZone> zones;
+    std::vector<std::vector<Window> > windows;  /* of each reference */
+    std::vector<Totals> totals;
+
+    void Count(BAMRecord const &rec);
+public:
+    /* Add
+     *  the record at "beg", in file order
+     */
+    void Add(uint64_t const beg, BAMRecord const &rec);
+
+    /* Find
+     *  the zone whose first record starts at "pos", or NULL
+     */
+    BAMZone const *Find(uint64_t const pos) const;
+
+    /* Next
+     *  the zone after "zone", or NULL at the last
+     */
+    BAMZone const *Next(BAMZone const *const zone) const {
+        return zone + 1 != &zones[0] + zones.size() ? zone + 1 : 0;
+    }
+
+    /* Load
+     *  the sidecar of the file at "bampath", if it is current
+     */
+    bool Load(std::string const &bampath);
+
+    /* Save
+     *  to the sidecar; nothing is written if it can't be
+     */
+    void Save(std::string const &bampath) const;
+
+    /* hasCounts
+     *  whether getCount can answer; it can once there are any zones
+     */
+    bool hasCounts() const {
+        return !zones.empty();
+    }
+    /* getCount
+     *  the mapped records of reference "refID" in category "what",
+     *  of all of it, or of those that start in the windows [beg, end)
+     *  overlaps
+     */
+    uint64_t getCount(unsigned const refID, Category const what) const {
+        return refID < totals.size() ? totals[refID].count[what] : 0;
+    }
+    uint64_t getCount(unsigned const refID, Category const what, unsigned const beg, unsigned const end) const;
+
+    void clear() {
+        std::vector<BAMZone>().swap(zones);
+        std::vector<std::vector<Window> >().swap(windows);
+        std::vector<Totals>().swap(totals);
+    }
+    bool empty() const {
+        return zones.empty();
+    }
+    size_t size() const {
+        return zones.size();
+    }
+    BAMZone const &operator [](size_t const i) const {
+        return zones[i];
+    }
+    size_t footprint() const;
+};
+
+#endif // _hpp_zones_
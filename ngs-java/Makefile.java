@@ -145,6 +145,7 @@ ngs-java: $(LIBDIR) $(CLSDIR) $(LIBDIR)/ngs-java.jar $(LIBDIR)/ngs-src.jar $(LIB
 # java API
 NGS_SRC =                  \
 	ErrorMsg               \
+	Releasable             \
 	Statistics             \
 	Fragment               \
 	FragmentIterator       \
@@ -154,10 +155,13 @@ NGS_SRC =                  \
 	ReadGroupIterator      \
 	Alignment              \
 	AlignmentIterator      \
+	AlignmentBatch         \
+	AlignmentRecord        \
 	PileupEvent            \
 	PileupEventIterator    \
 	Pileup                 \
 	PileupIterator         \
+	PileupColumns          \
 	Reference              \
 	ReferenceIterator      \
 	ReadCollection         \
@@ -181,6 +185,7 @@ ITF_SRC =                  \
 	ReadGroupIteratorItf   \
 	AlignmentItf           \
 	AlignmentIteratorItf   \
+	AlignmentSpliterator   \
 	PileupEventItf         \
 	PileupEventIteratorItf \
 	PileupItf              \
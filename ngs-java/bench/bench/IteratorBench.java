@@ -0,0 +1,384 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+package bench;
+
+import ngs.ErrorMsg;
+import ngs.ReadCollection;
+import ngs.Reference;
+import ngs.ReferenceIterator;
+import ngs.Alignment;
+import ngs.AlignmentIterator;
+import ngs.AlignmentBatch;
+import ngs.Read;
+import ngs.ReadIterator;
+import ngs.PileupIterator;
+import ngs.PileupColumns;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.AuxCounters;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.infra.Blackhole;
+
+/**
+ * JMH benchmarks of the hot paths of ngs-java: alignments, reads and
+ * pileups taken a call per getter, into byte arrays and ByteBuffers,
+ * and in batches; see the Makefile for how to build and run them.
+ *
+ * Each invocation reads the first "count" records of "spec". Besides
+ * the invocations per second, each reports two counters: the records
+ * read and the calls made into the engine while iterating, each of
+ * which is one JNI transition in ngs.itf. Run with "-prof gc" for the bytes allocated
+ * per invocation; gc.alloc.rate.norm divided by "count" is per record.
+ */
+@BenchmarkMode ( Mode.Throughput )
+@OutputTimeUnit ( TimeUnit.SECONDS )
+public class IteratorBench
+{
+
+    /**
+     * The open collection, shared by the threads of a run
+     */
+    @State ( Scope.Benchmark )
+    public static class Run
+    {
+        /** an accession or path the engine opens */
+        @Param ( "ERR225922" )
+        public String spec;
+
+        /** the records read per invocation */
+        @Param ( "100000" )
+        public long count;
+
+        /** the length of the pileup slice, from the start of the first reference */
+        @Param ( "10000" )
+        public long pileupLength;
+
+        ReadCollection run;
+        Reference reference;
+
+        @Setup ( Level.Trial )
+        public void open ()
+            throws ErrorMsg
+        {
+            run = gov.nih.nlm.ncbi.ngs.NGS.openReadCollection ( spec );
+
+            ReferenceIterator it = run.getReferences ();
+            if ( it.nextReference () )
+                reference = it;
+            else
+                it.close ();
+        }
+
+        PileupIterator pileupSlice ()
+            throws ErrorMsg
+        {
+            if ( reference == null )
+                throw new IllegalStateException ( spec + " has no references to pile up" );
+            return reference.getPileupSlice ( 0, pileupLength );
+        }
+
+        @TearDown ( Level.Trial )
+        public void close ()
+        {
+            if ( reference != null )
+                reference.close ();
+            run.close ();
+        }
+    }
+
+    /**
+     * Counts reported alongside the score of each benchmark,
+     * as rates over the same time
+     */
+    @State ( Scope.Thread )
+    @AuxCounters ( AuxCounters.Type.OPERATIONS )
+    public static class Counters
+    {
+        public long records;
+        public long jniCalls;
+
+        @Setup ( Level.Iteration )
+        public void clear ()
+        {
+            records = 0;
+            jniCalls = 0;
+        }
+    }
+
+    /**
+     * Buffers reused from one record to the next
+     */
+    @State ( Scope.Thread )
+    public static class Buffers
+    {
+        byte [] array = new byte [ 64 * 1024 ];
+        ByteBuffer direct = ByteBuffer.allocateDirect ( 64 * 1024 );
+        AlignmentBatch batch = new AlignmentBatch ( AlignmentBatch.alignmentPosition
+                                                  | AlignmentBatch.fragmentBases
+                                                  | AlignmentBatch.fragmentQualities,
+                                                  1024, 1024 * 1024 );
+        PileupColumns columns = new PileupColumns ( PileupColumns.eventType
+                                                  | PileupColumns.alignmentBase
+                                                  | PileupColumns.alignmentQuality,
+                                                  1024, 64 * 1024 );
+    }
+
+    /*----------------------------------------------------------------------
+     * ALIGNMENTS
+     */
+
+    @Benchmark
+    public void alignmentNext ( Run r, Counters c )
+        throws ErrorMsg
+    {
+        try ( AlignmentIterator it = r.run.getAlignmentRange ( 1, r.count, Alignment.all ) )
+        {
+            long n = 0;
+            while ( it.nextAlignment () )
+                ++ n;
+
+            c.records += n;
+            c.jniCalls += n + 1;
+        }
+    }
+
+    /** position, bases and qualities as a String apiece */
+    @Benchmark
+    public void alignmentGetters ( Run r, Counters c, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( AlignmentIterator it = r.run.getAlignmentRange ( 1, r.count, Alignment.all ) )
+        {
+            long n = 0;
+            while ( it.nextAlignment () )
+            {
+                bh.consume ( it.getAlignmentPosition () );
+                bh.consume ( it.getFragmentBases () );
+                bh.consume ( it.getFragmentQualities () );
+                ++ n;
+            }
+
+            c.records += n;
+            c.jniCalls += 4 * n + 1;
+        }
+    }
+
+    /** bases and qualities copied into a reused byte array */
+    @Benchmark
+    public void alignmentArray ( Run r, Counters c, Buffers b, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( AlignmentIterator it = r.run.getAlignmentRange ( 1, r.count, Alignment.all ) )
+        {
+            long n = 0, calls = 0;
+            while ( it.nextAlignment () )
+            {
+                bh.consume ( it.getAlignmentPosition () );
+                calls += 2;
+
+                int size = it.getFragmentBases ( b.array, 0 );
+                if ( size > b.array.length )
+                {
+                    b.array = new byte [ size * 2 ];
+                    size = it.getFragmentBases ( b.array, 0 );
+                    ++ calls;
+                }
+                bh.consume ( size );
+                bh.consume ( it.getFragmentQualities ( b.array, 0 ) );
+                calls += 2;
+                ++ n;
+            }
+
+            c.records += n;
+            c.jniCalls += calls + 1;
+        }
+    }
+
+    /** bases and qualities copied into a reused direct ByteBuffer */
+    @Benchmark
+    public void alignmentByteBuffer ( Run r, Counters c, Buffers b, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( AlignmentIterator it = r.run.getAlignmentRange ( 1, r.count, Alignment.all ) )
+        {
+            long n = 0;
+            while ( it.nextAlignment () )
+            {
+                bh.consume ( it.getAlignmentPosition () );
+                b.direct.clear ();
+                bh.consume ( it.getFragmentBases ( b.direct ) );
+                b.direct.clear ();
+                bh.consume ( it.getFragmentQualities ( b.direct ) );
+                ++ n;
+            }
+
+            c.records += n;
+            c.jniCalls += 4 * n + 1;
+        }
+    }
+
+    /** the same columns as alignmentGetters, a batch per call */
+    @Benchmark
+    public void alignmentBatch ( Run r, Counters c, Buffers b, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( AlignmentIterator it = r.run.getAlignmentRange ( 1, r.count, Alignment.all ) )
+        {
+            AlignmentBatch batch = b.batch;
+            long n = 0, calls = 1;
+            while ( it.nextAlignmentBatch ( batch ) )
+            {
+                for ( int i = 0; i < batch.size (); ++ i )
+                {
+                    bh.consume ( batch.getAlignmentPosition ( i ) );
+                    bh.consume ( batch.getFragmentBasesSize ( i ) );
+                    bh.consume ( batch.getFragmentQualitiesSize ( i ) );
+                }
+                n += batch.size ();
+                ++ calls;
+            }
+
+            c.records += n;
+            c.jniCalls += calls;
+        }
+    }
+
+    /*----------------------------------------------------------------------
+     * READS
+     */
+
+    /** bases and qualities as a String apiece */
+    @Benchmark
+    public void readGetters ( Run r, Counters c, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( ReadIterator it = r.run.getReadRange ( 1, r.count, Read.all ) )
+        {
+            long n = 0;
+            while ( it.nextRead () )
+            {
+                bh.consume ( it.getReadBases () );
+                bh.consume ( it.getReadQualities () );
+                ++ n;
+            }
+
+            c.records += n;
+            c.jniCalls += 3 * n + 1;
+        }
+    }
+
+    /** bases and qualities copied into a reused direct ByteBuffer */
+    @Benchmark
+    public void readByteBuffer ( Run r, Counters c, Buffers b, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( ReadIterator it = r.run.getReadRange ( 1, r.count, Read.all ) )
+        {
+            long n = 0;
+            while ( it.nextRead () )
+            {
+                b.direct.clear ();
+                bh.consume ( it.getReadBases ( b.direct ) );
+                b.direct.clear ();
+                bh.consume ( it.getReadQualities ( b.direct ) );
+                ++ n;
+            }
+
+            c.records += n;
+            c.jniCalls += 3 * n + 1;
+        }
+    }
+
+    /*----------------------------------------------------------------------
+     * PILEUPS
+     *  the records are the events
+     */
+
+    /** each event's type, base and quality, a call apiece */
+    @Benchmark
+    public void pileupEvents ( Run r, Counters c, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( PileupIterator it = r.pileupSlice () )
+        {
+            long n = 0, calls = 1;
+            while ( it.nextPileup () )
+            {
+                ++ calls;
+                while ( it.nextPileupEvent () )
+                {
+                    bh.consume ( it.getEventType () );
+                    bh.consume ( it.getAlignmentBase () );
+                    bh.consume ( it.getAlignmentQuality () );
+                    ++ n;
+                }
+                calls += 1;
+            }
+
+            c.records += n;
+            c.jniCalls += calls + 4 * n;
+        }
+    }
+
+    /** the same, a run of positions per call */
+    @Benchmark
+    public void pileupColumns ( Run r, Counters c, Buffers b, Blackhole bh )
+        throws ErrorMsg
+    {
+        try ( PileupIterator it = r.pileupSlice () )
+        {
+            PileupColumns columns = b.columns;
+            long n = 0, calls = 1;
+            while ( it.nextPileupColumns ( columns ) )
+            {
+                int events = columns.getEventCount ();
+                for ( int e = 0; e < events; ++ e )
+                {
+                    bh.consume ( columns.getEventType ( e ) );
+                    bh.consume ( columns.getAlignmentBase ( e ) );
+                    bh.consume ( columns.getAlignmentQuality ( e ) );
+                }
+                n += events;
+                ++ calls;
+            }
+
+            c.records += n;
+            c.jniCalls += calls;
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+package examples;
+
+import ngs.ErrorMsg;
+import ngs.ReadCollection;
+import ngs.AlignmentIterator;
+import ngs.AlignmentBatch;
+import ngs.Alignment;
+
+import java.io.BufferedReader;
+import java.io.FileReader;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+/**
+ * The Java leg of a benchmark run alike in C++, Java and Python;
+ * see also ngs-sdk/examples/BindingBench.cpp and
+ * ngs-python/examples/BindingBench.py
+ *
+ * Each scenario reads the first "count" alignments of a run, and
+ * prints one JSON object per line. Given the output of the C++ leg
+ * for the same run, the cost of each scenario is split into the
+ * engine's ( the C++ cost ) and the rest, spent in JNI marshalling.
+ */
+public class BindingBench
+{
+    static long sink;
+
+    static Map < String, Double > baseline = new HashMap < String, Double > ();
+
+    static void loadBaseline ( String path )
+        throws Exception
+    {
+        Pattern p = Pattern.compile ( "\"bench\":\"([^\"]+)\".*\"ns_per_record\":([-0-9.eE+]+)" );
+        BufferedReader in = new BufferedReader ( new FileReader ( path ) );
+        try
+        {
+            String line;
+            while ( ( line = in.readLine () ) != null )
+            {
+                Matcher m = p.matcher ( line );
+                if ( m.find () )
+                {
+                    String bench = m.group ( 1 );
+                    Double ns = Double.valueOf ( m.group ( 2 ) );
+                    baseline.put ( bench, ns );
+                    // variants such as "bases+qualities.view" stand for their kind
+                    String kind = bench.replaceFirst ( "\\..*", "" );
+                    if ( ! baseline.containsKey ( kind ) )
+                        baseline.put ( kind, ns );
+                }
+            }
+        }
+        finally
+        {
+            in.close ();
+        }
+    }
+
+    static void report ( String bench, long records, long nanos )
+    {
+        double ns = records == 0 ? 0.0 : ( double ) nanos / records;
+        String line = "{\"lang\":\"java\",\"bench\":\"" + bench + "\""
+            + ",\"records\":" + records
+            + ",\"ns_per_record\":" + ns;
+
+        Double engine = baseline.get ( bench );
+        if ( engine == null )
+            engine = baseline.get ( bench.replaceFirst ( "\\..*", "" ) );
+        if ( engine != null )
+            line += ",\"engine_ns\":" + engine + ",\"marshal_ns\":" + ( ns - engine );
+
+        System.out.println ( line + "}" );
+    }
+
+    static final int POSITION = 1, BASES = 2, QUALITIES = 4;
+
+    static void scan ( ReadCollection run, long count, String bench, int fields )
+        throws ErrorMsg
+    {
+        long start = System.nanoTime ();
+        AlignmentIterator it = run.getAlignmentRange ( 1, count, Alignment.all );
+
+        long i;
+        for ( i = 0; it.nextAlignment (); ++ i )
+        {
+            if ( ( fields & POSITION ) != 0 )
+                sink += it.getAlignmentPosition ();
+            if ( ( fields & BASES ) != 0 )
+                sink += it.getFragmentBases ().length ();
+            if ( ( fields & QUALITIES ) != 0 )
+                sink += it.getFragmentQualities ().length ();
+        }
+
+        report ( bench, i, System.nanoTime () - start );
+    }
+
+    static void scanArrays ( ReadCollection run, long count )
+        throws ErrorMsg
+    {
+        long start = System.nanoTime ();
+        AlignmentIterator it = run.getAlignmentRange ( 1, count, Alignment.all );
+        byte [] buffer = new byte [ 4096 ];
+
+        long i;
+        for ( i = 0; it.nextAlignment (); ++ i )
+        {
+            int n = it.getFragmentBases ( buffer, 0 );
+            if ( n > buffer.length )
+            {
+                buffer = new byte [ n * 2 ];
+                n = it.getFragmentBases ( buffer, 0 );
+            }
+            sink += n;
+            sink += it.getFragmentQualities ( buffer, 0 );
+        }
+
+        report ( "bases+qualities.array", i, System.nanoTime () - start );
+    }
+
+    static void scanBatches ( ReadCollection run, long count )
+        throws ErrorMsg
+    {
+        AlignmentBatch batch = new AlignmentBatch ( AlignmentBatch.alignmentPosition
+                                                  | AlignmentBatch.fragmentBases
+                                                  | AlignmentBatch.fragmentQualities,
+                                                  1024, 1024 * 1024 );
+        long start = System.nanoTime ();
+        AlignmentIterator it = run.getAlignmentRange ( 1, count, Alignment.all );
+
+        long n = 0;
+        while ( it.nextAlignmentBatch ( batch ) )
+        {
+            for ( int i = 0; i < batch.size (); ++ i )
+            {
+                sink += batch.getAlignmentPosition ( i );
+                sink += batch.getFragmentBasesSize ( i );
+                sink += batch.getFragmentQualitiesSize ( i );
+            }
+            n += batch.size ();
+        }
+
+        report ( "batch", n, System.nanoTime () - start );
+    }
+
+    static void run ( String acc, long count )
+        throws ErrorMsg, Exception
+    {
+        ReadCollection run = gov.nih.nlm.ncbi.ngs.NGS.openReadCollection ( acc );
+
+        // the first passes warm caches and the JIT, so the rest compare alike
+        scan ( run, count, "warmup", POSITION | BASES | QUALITIES );
+        scan ( run, count, "warmup", POSITION | BASES | QUALITIES );
+
+        scan ( run, count, "next", 0 );
+        scan ( run, count, "position", POSITION );
+        scan ( run, count, "bases", BASES );
+        scan ( run, count, "qualities", QUALITIES );
+        scan ( run, count, "position+bases+qualities", POSITION | BASES | QUALITIES );
+        scanArrays ( run, count );
+        scanBatches ( run, count );
+    }
+
+    public static void main ( String [] args )
+    {
+        if ( args.length < 2 || args.length > 3 )
+        {
+            System.out.print ( "Usage: BindingBench accession count [c++-output]\n" );
+        }
+        else try
+        {
+            if ( args.length > 2 )
+                loadBaseline ( args[2] );
+            run ( args[0], Long.parseLong ( args[1] ) );
+        }
+        catch ( ErrorMsg x )
+        {
+            System.err.println ( x.toString () );
+            x.printStackTrace ();
+        }
+        catch ( Exception x )
+        {
+            System.err.println ( x.toString () );
+            x.printStackTrace ();
+        }
+    }
+}
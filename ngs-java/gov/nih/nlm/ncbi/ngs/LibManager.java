@@ -74,6 +74,15 @@ class LibManager implements FileCreator
      */
     private boolean AUTO_DOWNLOAD = true;
 
+    /**
+     * Fast offline start, set by vdb.System.offline:
+     * no network, no child JVM per candidate library and no cache update;
+     * the library is loaded from OFFLINE_LIBRARY_PATH (vdb.System.libraryPath)
+     * or java.library.path and its version checked against the one required
+     */
+    private boolean OFFLINE = false;
+    private String OFFLINE_LIBRARY_PATH = null;
+
     /**
      * How often search for a latest installed library
      */
@@ -166,6 +175,16 @@ class LibManager implements FileCreator
             return;
         }
 
+        String offline = System.getProperty("vdb.System.offline");
+        if (offline != null && offline.equals("1")) {
+            Logger.info ( "Offline library load: DLL search and download were disabled" );
+            OFFLINE = true;
+            AUTO_DOWNLOAD = false;
+            SEARCH_FOR_LIBRARY = false;
+            OFFLINE_LIBRARY_PATH = System.getProperty("vdb.System.libraryPath");
+            return;
+        }
+
         String noLibraryDownload = System.getProperty("vdb.System.noLibraryDownload");
         if (noLibraryDownload != null && noLibraryDownload.equals("1")) {
             Logger.warning ( "DLL download was disabled" );
@@ -325,11 +344,12 @@ or pathname not found and its directory is not writable */
      */
     void loadLibrary( String libname ) {
         Version requiredVersion = getRequiredVersion(libname);
-        boolean updateCache = Arrays.asList(locations).contains(Location.CACHE);
+        boolean updateCache = !OFFLINE && Arrays.asList(locations).contains(Location.CACHE);
 
         Logger.fine("Searching for " + libname + " library...");
         try {
-            LibSearchResult searchResult = searchLibrary(libname, requiredVersion);
+            LibSearchResult searchResult = OFFLINE ? findOfflineLibrary(libname)
+                : searchLibrary(libname, requiredVersion);
 
             if (searchResult.path == null) {
                 throw new LibraryNotFoundError(libname, "No installed library was found",
@@ -602,6 +622,30 @@ or pathname not found and its directory is not writable */
         return version;
     }
 
+    /** Finds the library to load without checking its version beforehand:
+        that is done once it is loaded, in this process */
+    private LibSearchResult findOfflineLibrary(String libname) {
+        LibSearchResult searchResult = new LibSearchResult();
+        searchResult.location = Location.LIBPATH;
+
+        if (OFFLINE_LIBRARY_PATH == null) {
+            searchResult.path = libname;
+            return searchResult;
+        }
+
+        for (String name : mapLibraryName(libname)) {
+            String path = OFFLINE_LIBRARY_PATH + LibPathIterator.fileSeparator() + name;
+            if (fileExists(path)) {
+                searchResult.path = path;
+                return searchResult;
+            }
+        }
+
+        Logger.warning(libname + " was not found in " + OFFLINE_LIBRARY_PATH);
+        searchResult.failCause = new DownloadDisabledCause();
+        return searchResult;
+    }
+
     private LibSearchResult searchLibrary(String libname, Version requiredVersion) {
         LibSearchResult searchResult = new LibSearchResult();
 
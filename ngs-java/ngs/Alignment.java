@@ -132,6 +132,7 @@ public interface Alignment
     static int maxMapQuality = 8;      // pass alignments with mappingQuality <= param
     static int noWraparound = 16;      // do not include leading wrapped around alignments to circular references
     static int startWithinSlice = 32;  // change slice intersection criteria so that start pos is within slice
+    static int withMates = 64;         // also give the mates outside the slice, each right after its alignment
 
     /* AlignmentCategory
      */
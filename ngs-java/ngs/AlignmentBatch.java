@@ -0,0 +1,275 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+package ngs;
+
+import java.nio.charset.Charset;
+
+
+/**
+ * The columns of a number of Alignments at a time,
+ * filled in by AlignmentIterator.nextAlignmentBatch
+ * in a single call into the engine.
+ * A batch is meant for use with a single iterator.
+ */
+public final class AlignmentBatch
+{
+
+    /**
+     * Columns to fill in
+     */
+    public static final int alignmentPosition   = 0x01;  // and length
+    public static final int mappingQuality      = 0x02;
+    public static final int alignmentFlags      = 0x04;  // category, orientation, mate
+    public static final int referenceSpec       = 0x08;
+    public static final int readId              = 0x10;
+    public static final int fragmentBases       = 0x20;
+    public static final int fragmentQualities   = 0x40;
+    public static final int allFields           = 0x7F;
+
+    /**
+     * @param fields a mask of the columns to fill in
+     * @param capacity the most Alignments a batch holds
+     * @param arenaSize the bytes available to the strings of one batch;
+     *  a batch stops short of "capacity" when its strings would not fit
+     * @throws IllegalArgumentException if capacity or arenaSize is not positive
+     */
+    public AlignmentBatch ( int fields, int capacity, int arenaSize )
+    {
+        if ( capacity <= 0 )
+            throw new IllegalArgumentException ( "alignment batch capacity is " + capacity );
+        if ( arenaSize <= 0 )
+            throw new IllegalArgumentException ( "alignment batch arena size is " + arenaSize );
+
+        this . fields = fields;
+        this . capacity = capacity;
+
+        if ( ( fields & alignmentPosition ) != 0 )
+        {
+            this . position = new long [ capacity ];
+            this . length = new long [ capacity ];
+        }
+        if ( ( fields & mappingQuality ) != 0 )
+            this . mapQual = new int [ capacity ];
+        if ( ( fields & alignmentFlags ) != 0 )
+            this . flags = new int [ capacity ];
+
+        // string columns hold ( offset, size ) pairs into the arena
+        if ( ( fields & referenceSpec ) != 0 )
+            this . refSpec = new int [ capacity * 2 ];
+        if ( ( fields & readId ) != 0 )
+            this . readIds = new int [ capacity * 2 ];
+        if ( ( fields & fragmentBases ) != 0 )
+            this . bases = new int [ capacity * 2 ];
+        if ( ( fields & fragmentQualities ) != 0 )
+            this . qualities = new int [ capacity * 2 ];
+
+        this . arena = new byte [ arenaSize ];
+    }
+
+    /**
+     * A batch of all columns, up to 1024 Alignments and 1MB of strings
+     */
+    public AlignmentBatch ()
+    {
+        this ( allFields, 1024, 1024 * 1024 );
+    }
+
+    /**
+     * @return the number of Alignments in the batch
+     */
+    public int size ()
+    {
+        return count;
+    }
+
+    /**
+     * @return the mask of columns the batch was created with
+     */
+    public int getFields ()
+    {
+        return fields;
+    }
+
+    /**
+     * @return the most Alignments the batch holds
+     */
+    public int getCapacity ()
+    {
+        return capacity;
+    }
+
+    /*----------------------------------------------------------------------
+     * per-Alignment columns
+     *  "i" is zero-based and less than size ()
+     *  throw ErrorMsg if the column was not asked for
+     */
+
+    public long getAlignmentPosition ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return position [ check ( i, position ) ];
+    }
+
+    public long getAlignmentLength ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return length [ check ( i, length ) ];
+    }
+
+    public int getMappingQuality ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return mapQual [ check ( i, mapQual ) ];
+    }
+
+    /**
+     * @return either Alignment.primaryAlignment or Alignment.secondaryAlignment
+     */
+    public int getAlignmentCategory ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return ( flags [ check ( i, flags ) ] & flagPrimary ) != 0
+            ? Alignment . primaryAlignment : Alignment . secondaryAlignment;
+    }
+
+    public boolean getIsReversedOrientation ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return ( flags [ check ( i, flags ) ] & flagReversed ) != 0;
+    }
+
+    public boolean hasMate ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return ( flags [ check ( i, flags ) ] & flagHasMate ) != 0;
+    }
+
+    public String getReferenceSpec ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return getString ( i, refSpec );
+    }
+
+    public String getReadId ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return getString ( i, readIds );
+    }
+
+    public String getFragmentBases ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return getString ( i, bases );
+    }
+
+    public String getFragmentQualities ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return getString ( i, qualities );
+    }
+
+    /*----------------------------------------------------------------------
+     * packed strings
+     *  the bases and qualities of Alignment "i" are the bytes
+     *  [ offset, offset + size ) of getArena (), avoiding a String
+     *  the arena is reused by the next batch
+     */
+
+    public byte [] getArena ()
+    {
+        return arena;
+    }
+
+    public int getFragmentBasesOffset ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return bases [ check ( i, bases ) * 2 ];
+    }
+
+    public int getFragmentBasesSize ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return bases [ check ( i, bases ) * 2 + 1 ];
+    }
+
+    public int getFragmentQualitiesOffset ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return qualities [ check ( i, qualities ) * 2 ];
+    }
+
+    public int getFragmentQualitiesSize ( int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return qualities [ check ( i, qualities ) * 2 + 1 ];
+    }
+
+
+    // implementation
+
+    private int check ( int i, Object column )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( column == null )
+            throw new ErrorMsg ( "column was not requested for the alignment batch" );
+        if ( i < 0 || i >= count )
+            throw new IndexOutOfBoundsException ( "alignment batch index " + i + " is out of range" );
+        return i;
+    }
+
+    private String getString ( int i, int [] column )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        int idx = check ( i, column ) * 2;
+        return new String ( arena, column [ idx ], column [ idx + 1 ], ascii );
+    }
+
+    // NGS_AlignmentBatchFlags
+    private static final int flagPrimary  = 0x01;
+    private static final int flagReversed = 0x02;
+    private static final int flagHasMate  = 0x04;
+
+    private static final Charset ascii = Charset . forName ( "US-ASCII" );
+
+    /* set when created, read by the native fill */
+    private final int fields;
+    private final int capacity;
+    private long [] position;
+    private long [] length;
+    private int [] mapQual;
+    private int [] flags;
+    private int [] refSpec;
+    private int [] readIds;
+    private int [] bases;
+    private int [] qualities;
+    private byte [] arena;
+
+    /* set by the native fill; state carries an Alignment that
+       did not fit in the arena over to the next batch */
+    private int count;
+    private int state;
+}
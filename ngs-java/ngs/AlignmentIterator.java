@@ -42,4 +42,26 @@ public interface AlignmentIterator
      */
     boolean nextAlignment ()
         throws ErrorMsg;
+
+    /**
+     *  Fill "batch" with the columns of the next Alignments,
+     *  in a single call into the engine.
+     *  The iterator is left past the Alignments placed in the batch,
+     *  so it is best not to mix this with nextAlignment.
+     *  @param batch receives up to batch.getCapacity() Alignments
+     *  @return false if no more Alignments are available.
+     *  @throws ErrorMsg if more Alignments should be available, but could not be accessed.
+     */
+    boolean nextAlignmentBatch ( AlignmentBatch batch )
+        throws ErrorMsg;
+
+    /**
+     *  Fill "batch" with no more than "max" of the next Alignments
+     *  @param max the most Alignments to take, limited by the batch capacity
+     *  @param batch receives the Alignments
+     *  @return false if no more Alignments are available.
+     *  @throws ErrorMsg if more Alignments should be available, but could not be accessed.
+     */
+    boolean nextAlignmentBatch ( int max, AlignmentBatch batch )
+        throws ErrorMsg;
 }
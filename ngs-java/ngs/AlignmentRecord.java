@@ -0,0 +1,131 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+package ngs;
+
+
+/**
+ * The columns of one Alignment, copied out of an AlignmentBatch.
+ * Unlike an AlignmentIterator, a record doesn't change when
+ * the iteration moves on, so it may be kept or handed to
+ * another thread; ReadCollection.alignmentStream and
+ * Reference.alignmentStream are streams of them.
+ */
+public final class AlignmentRecord
+{
+
+    /**
+     * @param batch a batch filled in with all of its columns
+     * @param i a zero-based index less than batch.size ()
+     * @throws ErrorMsg if the batch lacks a column
+     * @throws IndexOutOfBoundsException if "i" is out of range
+     */
+    public AlignmentRecord ( AlignmentBatch batch, int i )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        this . referenceSpec = batch . getReferenceSpec ( i );
+        this . readId = batch . getReadId ( i );
+        this . position = batch . getAlignmentPosition ( i );
+        this . length = batch . getAlignmentLength ( i );
+        this . mappingQuality = batch . getMappingQuality ( i );
+        this . category = batch . getAlignmentCategory ( i );
+        this . reversed = batch . getIsReversedOrientation ( i );
+        this . mate = batch . hasMate ( i );
+        this . bases = batch . getFragmentBases ( i );
+        this . qualities = batch . getFragmentQualities ( i );
+    }
+
+    public String getReferenceSpec ()
+    {
+        return referenceSpec;
+    }
+
+    public String getReadId ()
+    {
+        return readId;
+    }
+
+    /**
+     * @return the zero-based position on the Reference
+     */
+    public long getAlignmentPosition ()
+    {
+        return position;
+    }
+
+    /**
+     * @return the projected length on the Reference
+     */
+    public long getAlignmentLength ()
+    {
+        return length;
+    }
+
+    public int getMappingQuality ()
+    {
+        return mappingQuality;
+    }
+
+    /**
+     * @return either Alignment.primaryAlignment or Alignment.secondaryAlignment
+     */
+    public int getAlignmentCategory ()
+    {
+        return category;
+    }
+
+    public boolean getIsReversedOrientation ()
+    {
+        return reversed;
+    }
+
+    public boolean hasMate ()
+    {
+        return mate;
+    }
+
+    public String getFragmentBases ()
+    {
+        return bases;
+    }
+
+    public String getFragmentQualities ()
+    {
+        return qualities;
+    }
+
+
+    private final String referenceSpec;
+    private final String readId;
+    private final long position;
+    private final long length;
+    private final int mappingQuality;
+    private final int category;
+    private final boolean reversed;
+    private final boolean mate;
+    private final String bases;
+    private final String qualities;
+}
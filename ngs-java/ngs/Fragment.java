@@ -26,11 +26,14 @@
 
 package ngs;
 
+import java.nio.ByteBuffer;
+
 
 /**
  * Represents an NGS biological fragment
  */
 public interface Fragment
+    extends Releasable
 {
 
     /**
@@ -74,6 +77,28 @@ public interface Fragment
     String getFragmentBases ( long offset, long length )
         throws ErrorMsg, IndexOutOfBoundsException;
 
+    /**
+     * getFragmentBases into a buffer, without making a String
+     * @param dst a direct or array-backed buffer, filled from its position
+     * @return the number of bases; when more than dst.remaining(),
+     *  nothing is copied and the position is left alone
+     * @throws ErrorMsg upon an error accessing data
+     */
+    int getFragmentBases ( ByteBuffer dst )
+        throws ErrorMsg;
+
+    /**
+     * getFragmentBases into an array, without making a String
+     * @param dst the array to fill
+     * @param dstOffset is where in "dst" to start
+     * @return the number of bases; when more than fit after
+     *  dstOffset, nothing is copied
+     * @throws ErrorMsg upon an error accessing data
+     * @throws IndexOutOfBoundsException upon invalid dstOffset
+     */
+    int getFragmentBases ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException;
+
 
     /** 
      * getFragmentQualities using ASCII offset of 33
@@ -104,6 +129,28 @@ public interface Fragment
     String getFragmentQualities ( long offset, long length )
         throws ErrorMsg, IndexOutOfBoundsException;
 
+    /**
+     * getFragmentQualities into a buffer, without making a String
+     * @param dst a direct or array-backed buffer, filled from its position
+     * @return the number of qualities; when more than dst.remaining(),
+     *  nothing is copied and the position is left alone
+     * @throws ErrorMsg upon an error accessing data
+     */
+    int getFragmentQualities ( ByteBuffer dst )
+        throws ErrorMsg;
+
+    /**
+     * getFragmentQualities into an array, without making a String
+     * @param dst the array to fill
+     * @param dstOffset is where in "dst" to start
+     * @return the number of qualities; when more than fit after
+     *  dstOffset, nothing is copied
+     * @throws ErrorMsg upon an error accessing data
+     * @throws IndexOutOfBoundsException upon invalid dstOffset
+     */
+    int getFragmentQualities ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException;
+
     /**
      * isPaired
      * @return true if fragment has a mate
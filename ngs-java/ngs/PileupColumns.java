@@ -0,0 +1,247 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+package ngs;
+
+
+/**
+ * The events of a run of Pileup positions, a column apiece,
+ * filled in by PileupIterator.nextPileupColumns
+ * in a single call into the engine.
+ * The events of all the positions are held one after another;
+ * those of position "c" are [ getFirstEvent ( c ), getFirstEvent ( c ) + getPileupDepth ( c ) ).
+ * A set of columns is meant for use with a single iterator.
+ */
+public final class PileupColumns
+{
+
+    /**
+     * Event columns to fill in; the position, its reference base and depth always are
+     */
+    public static final int eventType           = 0x01;  // with the strand
+    public static final int alignmentBase       = 0x02;
+    public static final int alignmentQuality    = 0x04;
+    public static final int mappingQuality      = 0x08;
+    public static final int allFields           = 0x0F;
+
+    /**
+     * @param fields a mask of the event columns to fill in
+     * @param maxPositions the most Pileup positions filled in at a time
+     * @param capacity the room for events across those positions;
+     *  a run stops short of "maxPositions" when the events of the next would not fit,
+     *  and the room grows to hold a single position that is deeper
+     * @throws IllegalArgumentException if maxPositions or capacity is not positive
+     */
+    public PileupColumns ( int fields, int maxPositions, int capacity )
+    {
+        if ( maxPositions <= 0 )
+            throw new IllegalArgumentException ( "pileup columns maximum is " + maxPositions );
+        if ( capacity <= 0 )
+            throw new IllegalArgumentException ( "pileup columns capacity is " + capacity );
+
+        this . fields = fields;
+        this . maxPositions = maxPositions;
+        this . position = new long [ maxPositions ];
+        this . refBase = new byte [ maxPositions ];
+        this . start = new int [ maxPositions + 1 ];
+        allocate ( capacity );
+    }
+
+    /**
+     * All event columns, up to 1024 positions and 64K events
+     */
+    public PileupColumns ()
+    {
+        this ( allFields, 1024, 64 * 1024 );
+    }
+
+    /**
+     * @return the number of Pileup positions filled in
+     */
+    public int size ()
+    {
+        return count;
+    }
+
+    /**
+     * @return the number of events across all of them
+     */
+    public int getEventCount ()
+    {
+        return start [ count ];
+    }
+
+    /**
+     * @return the mask of event columns the set was created with
+     */
+    public int getFields ()
+    {
+        return fields;
+    }
+
+    /**
+     * @return the most positions filled in at a time
+     */
+    public int getMaxPositions ()
+    {
+        return maxPositions;
+    }
+
+    /**
+     * @return the room for events, which grows to the deepest position met
+     */
+    public int getCapacity ()
+    {
+        return capacity;
+    }
+
+    /*----------------------------------------------------------------------
+     * per-position
+     *  "c" is zero-based and less than size ()
+     */
+
+    public long getReferencePosition ( int c )
+        throws IndexOutOfBoundsException
+    {
+        return position [ column ( c ) ];
+    }
+
+    public char getReferenceBase ( int c )
+        throws IndexOutOfBoundsException
+    {
+        return ( char ) refBase [ column ( c ) ];
+    }
+
+    public int getPileupDepth ( int c )
+        throws IndexOutOfBoundsException
+    {
+        c = column ( c );
+        return start [ c + 1 ] - start [ c ];
+    }
+
+    /**
+     * @return the index of the first event of position "c"
+     */
+    public int getFirstEvent ( int c )
+        throws IndexOutOfBoundsException
+    {
+        return start [ column ( c ) ];
+    }
+
+    /*----------------------------------------------------------------------
+     * per-event
+     *  "e" is zero-based and less than getEventCount ()
+     *  throw ErrorMsg if the column was not asked for
+     */
+
+    /**
+     * @return a PileupEvent.PileupEventType, with the strand,
+     *  start and stop bits of PileupEvent.getEventType
+     */
+    public int getEventType ( int e )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return type [ event ( e, type ) ];
+    }
+
+    public boolean getIsMinusStrand ( int e )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return ( type [ event ( e, type ) ] & PileupEvent . alignment_minus_strand ) != 0;
+    }
+
+    public char getAlignmentBase ( int e )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return ( char ) base [ event ( e, base ) ];
+    }
+
+    public char getAlignmentQuality ( int e )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return ( char ) qual [ event ( e, qual ) ];
+    }
+
+    public int getMappingQuality ( int e )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        return mapQual [ event ( e, mapQual ) ];
+    }
+
+
+    // implementation
+
+    private void allocate ( int capacity )
+    {
+        this . capacity = capacity;
+        if ( ( fields & eventType ) != 0 )
+            this . type = new int [ capacity ];
+        if ( ( fields & alignmentBase ) != 0 )
+            this . base = new byte [ capacity ];
+        if ( ( fields & alignmentQuality ) != 0 )
+            this . qual = new byte [ capacity ];
+        if ( ( fields & mappingQuality ) != 0 )
+            this . mapQual = new int [ capacity ];
+    }
+
+    private int column ( int c )
+        throws IndexOutOfBoundsException
+    {
+        if ( c < 0 || c >= count )
+            throw new IndexOutOfBoundsException ( "pileup column index " + c + " is out of range" );
+        return c;
+    }
+
+    private int event ( int e, Object column )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( column == null )
+            throw new ErrorMsg ( "column was not requested for the pileup columns" );
+        if ( e < 0 || e >= start [ count ] )
+            throw new IndexOutOfBoundsException ( "pileup event index " + e + " is out of range" );
+        return e;
+    }
+
+    /* set when created, read by the native fill */
+    private final int fields;
+    private final int maxPositions;
+    private long [] position;
+    private byte [] refBase;
+    private int [] start;
+
+    /* replaced by the native fill when a position is deeper than "capacity" */
+    private int capacity;
+    private int [] type;
+    private byte [] base;
+    private byte [] qual;
+    private int [] mapQual;
+
+    /* set by the native fill; state is set while the iterator is on
+       a position that did not fit and is carried over to the next fill */
+    private int count;
+    private int state;
+}
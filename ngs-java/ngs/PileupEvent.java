@@ -32,6 +32,7 @@ package ngs;
  *  and stacked Alignments on the other axis
  */
 public interface PileupEvent
+    extends Releasable
 {
 
     /*----------------------------------------------------------------------
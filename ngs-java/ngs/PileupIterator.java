@@ -41,4 +41,26 @@ public interface PileupIterator
      */
     boolean nextPileup ()
         throws ErrorMsg;
+
+    /**
+     *  Fill "columns" with the events of the next Pileup positions,
+     *  in a single call into the engine.
+     *  The iterator is left on the last position placed in "columns",
+     *  or on the one that did not fit, so it is best not to mix this with nextPileup.
+     *  @param columns receives up to columns.getMaxPositions() positions
+     *  @return false if no more Pileups are available.
+     *  @throws ErrorMsg if more Pileups should be available, but could not be accessed.
+     */
+    boolean nextPileupColumns ( PileupColumns columns )
+        throws ErrorMsg;
+
+    /**
+     *  Fill "columns" with no more than "max" of the next Pileup positions
+     *  @param max the most positions to take, limited by columns.getMaxPositions()
+     *  @param columns receives the positions
+     *  @return false if no more Pileups are available.
+     *  @throws ErrorMsg if more Pileups should be available, but could not be accessed.
+     */
+    boolean nextPileupColumns ( int max, PileupColumns columns )
+        throws ErrorMsg;
 }
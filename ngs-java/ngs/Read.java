@@ -26,6 +26,7 @@
 
 package ngs;
 
+import java.nio.ByteBuffer;
 
 /*==========================================================================
  * Read
@@ -134,6 +135,28 @@ public interface Read
     String getReadBases ( long offset, long length )
         throws ErrorMsg, IndexOutOfBoundsException;
 
+    /**
+     * getReadBases into a buffer, without making a String
+     * @param dst a direct or array-backed buffer, filled from its position
+     * @return the number of bases; when more than dst.remaining(),
+     *  nothing is copied and the position is left alone
+     * @throws ErrorMsg upon an error accessing data
+     */
+    int getReadBases ( ByteBuffer dst )
+        throws ErrorMsg;
+
+    /**
+     * getReadBases into an array, without making a String
+     * @param dst the array to fill
+     * @param dstOffset is where in "dst" to start
+     * @return the number of bases; when more than fit after
+     *  dstOffset, nothing is copied
+     * @throws ErrorMsg upon an error accessing data
+     * @throws IndexOutOfBoundsException upon invalid dstOffset
+     */
+    int getReadBases ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException;
+
 
     /**
      * getReadQualities
@@ -163,4 +186,26 @@ public interface Read
      */
     String getReadQualities ( long offset, long length )
         throws ErrorMsg, IndexOutOfBoundsException;
+
+    /**
+     * getReadQualities into a buffer, without making a String
+     * @param dst a direct or array-backed buffer, filled from its position
+     * @return the number of qualities; when more than dst.remaining(),
+     *  nothing is copied and the position is left alone
+     * @throws ErrorMsg upon an error accessing data
+     */
+    int getReadQualities ( ByteBuffer dst )
+        throws ErrorMsg;
+
+    /**
+     * getReadQualities into an array, without making a String
+     * @param dst the array to fill
+     * @param dstOffset is where in "dst" to start
+     * @return the number of qualities; when more than fit after
+     *  dstOffset, nothing is copied
+     * @throws ErrorMsg upon an error accessing data
+     * @throws IndexOutOfBoundsException upon invalid dstOffset
+     */
+    int getReadQualities ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException;
 }
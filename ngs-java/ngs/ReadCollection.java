@@ -26,6 +26,8 @@
 
 package ngs;
 
+import java.util.stream.Stream;
+
 
 /**
  *<p>
@@ -45,6 +47,7 @@ package ngs;
  *</p>
  */
 public interface ReadCollection
+    extends Releasable
 {
 
     /**
@@ -202,6 +205,33 @@ public interface ReadCollection
   AlignmentIterator getAlignmentRange ( long first, long count, int categories )
         throws ErrorMsg;
 
+    /**
+     * getAlignmentShard
+     * Shards don't overlap and together cover every Alignment;
+     * engines size them by the amount of data to be read where they can.
+     * Requires alignmentShardFeature.
+     * @param shard is 0-based and less than "count"
+     * @param count the number of shards the set is split into
+     * @param categories provides a means of filtering by AlignmentCategory
+     * @return an iterator across one shard, for reading the set in parallel
+     * @throws ErrorMsg upon an error accessing data
+     */
+    AlignmentIterator getAlignmentShard ( int shard, int count, int categories )
+        throws ErrorMsg;
+
+    /**
+     * alignmentStream
+     * A parallel stream splits along engine shards where the engine
+     * has them, and reads each through AlignmentBatches;
+     * an error reading data is thrown as a RuntimeException
+     * whose cause is the ErrorMsg.
+     * @param categories provides a means of filtering by AlignmentCategory
+     * @return a Stream of the columns of the Alignments
+     * @throws ErrorMsg upon an error accessing data
+     */
+    Stream < AlignmentRecord > alignmentStream ( int categories )
+        throws ErrorMsg;
+
 
     /*----------------------------------------------------------------------
      * READS
@@ -265,4 +295,46 @@ public interface ReadCollection
      */
     ReadIterator getReadRange ( long first, long count, int categories )
         throws ErrorMsg;
+
+
+    /*----------------------------------------------------------------------
+     * FEATURES
+     */
+
+    /* Feature
+     *  groups of messages an engine may answer
+     */
+    static int readGroupsFeature     = 0x001;  // getReadGroups, getReadGroup
+    static int referencesFeature     = 0x002;  // getReferences, getReference
+    static int alignmentByIdFeature  = 0x004;
+    static int alignmentsFeature     = 0x008;
+    static int alignmentCountFeature = 0x010;
+    static int alignmentRangeFeature = 0x020;
+    static int alignmentShardFeature = 0x040;
+    static int readByIdFeature       = 0x080;
+    static int readsFeature          = 0x100;  // getReads, getReadCount, getReadRange
+
+    /**
+     * supports
+     * @param feature one of the Feature values above
+     * @return true if the engine answers the messages of "feature",
+     *  false if they would only throw
+     * @throws ErrorMsg upon an error accessing data
+     */
+    boolean supports ( int feature )
+        throws ErrorMsg;
+
+
+    /*----------------------------------------------------------------------
+     * STATISTICS
+     */
+
+    /**
+     * getStatistics
+     * @return counters the engine keeps about the collection,
+     *  e.g. how much of the underlying file has been read
+     * @throws ErrorMsg if the engine keeps none
+     */
+    Statistics getStatistics ()
+        throws ErrorMsg;
 }
@@ -31,6 +31,7 @@ package ngs;
  * Represents an NGS-capable object with a group of Reads
  */
 public interface ReadGroup
+    extends Releasable
 {
 
     /**
@@ -26,11 +26,14 @@
 
 package ngs;
 
+import java.util.stream.Stream;
+
 
 /**
  * Represents a reference sequence
  */
 public interface Reference
+    extends Releasable
 {
 
     /** 
@@ -196,6 +199,31 @@ public interface Reference
     AlignmentIterator getFilteredAlignmentSlice ( long start, long length, int categories, int filters, int mappingQuality )
         throws ErrorMsg;
 
+    /**
+     * alignmentStream
+     * A parallel stream splits the slice into shorter slices,
+     * each Alignment going to the one it starts in, and reads
+     * each through AlignmentBatches; an error reading data
+     * is thrown as a RuntimeException whose cause is the ErrorMsg.
+     * @param start is a signed 0-based offset from the start of the Reference
+     * @param length is the length of the slice.
+     * @return a Stream of the columns of the Alignments in the slice
+     * @throws ErrorMsg upon an error accessing data
+     */
+    Stream < AlignmentRecord > alignmentStream ( long start, long length )
+        throws ErrorMsg;
+
+    /**
+     * alignmentStream
+     * @param start is a signed 0-based offset from the start of the Reference
+     * @param length is the length of the slice.
+     * @param categories provides a means of filtering by AlignmentCategory
+     * @return a Stream of the columns of the Alignments in the slice
+     * @throws ErrorMsg upon an error accessing data
+     */
+    Stream < AlignmentRecord > alignmentStream ( long start, long length, int categories )
+        throws ErrorMsg;
+
 
     /*----------------------------------------------------------------------
      * PILEUP
@@ -260,4 +288,32 @@ public interface Reference
     PileupIterator getFilteredPileupSlice ( long start, long length,
             int categories, int filters, int mappingQuality )
         throws ErrorMsg;
+
+
+    /*----------------------------------------------------------------------
+     * FEATURES
+     */
+
+    /* Feature
+     *  groups of messages an engine may answer
+     */
+    static int canonicalNameFeature  = 0x01;
+    static int circularityFeature    = 0x02;   // getIsCircular
+    static int basesFeature          = 0x04;   // getReferenceBases, getReferenceChunk
+    static int alignmentByIdFeature  = 0x08;
+    static int alignmentsFeature     = 0x10;   // whole, sliced and filtered
+    static int alignmentCountFeature = 0x20;
+    static int alignmentShardFeature = 0x40;
+    static int pileupsFeature        = 0x80;   // whole, sliced and filtered
+
+    /**
+     * supports
+     * @param feature one of the Feature values above
+     * @return true if the engine answers the messages of "feature" for
+     *  this Reference, false if they would only throw; an iterator may
+     *  answer differently from one Reference to the next
+     * @throws ErrorMsg upon an error accessing data
+     */
+    boolean supports ( int feature )
+        throws ErrorMsg;
 }
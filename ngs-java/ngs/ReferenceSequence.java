@@ -31,6 +31,7 @@ package ngs;
  * Represents a reference sequence standalone object
  */
 public interface ReferenceSequence
+    extends Releasable
 {
     /** 
      * getCanonicalName
@@ -0,0 +1,53 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+package ngs;
+
+
+/**
+ * An object backed by one of the engine's, which is released when it
+ * is closed, or else some time after it has been collected.
+ * A java.io.Closeable, so from Java 7 on it can be the resource of a
+ * try-with-resources statement:
+ *<pre>
+ *  try ( ReadCollection run = gov.nih.nlm.ncbi.ngs.NGS.openReadCollection ( spec ) )
+ *  {
+ *      ...
+ *  }
+ *</pre>
+ * Closing matters where many objects are made in a short time, since
+ * what the engine holds for them isn't seen by the garbage collector.
+ */
+public interface Releasable
+    extends java.io.Closeable
+{
+
+    /**
+     * Release the object now. It may not be used afterward;
+     * closing it again does nothing.
+     */
+    void close ();
+}
@@ -31,6 +31,7 @@ package ngs;
  * Statistical data container
  */
 public interface Statistics
+    extends Releasable
 {
 
     /**
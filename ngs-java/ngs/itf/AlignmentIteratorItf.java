@@ -30,6 +30,7 @@ import ngs.ErrorMsg;
 import ngs.Fragment;
 import ngs.Alignment;
 import ngs.AlignmentIterator;
+import ngs.AlignmentBatch;
 
 
 /*==========================================================================
@@ -60,6 +61,25 @@ class AlignmentIteratorItf
         return this . NextAlignment ( self );
     }
 
+    /* nextAlignmentBatch
+     *  fill "batch" with the columns of up to "max" of the next
+     *  Alignments in one native call, rather than a call per getter
+     */
+    public boolean nextAlignmentBatch ( AlignmentBatch batch )
+        throws ErrorMsg
+    {
+        return this . NextAlignmentBatch ( self, batch . getCapacity (), batch );
+    }
+
+    public boolean nextAlignmentBatch ( int max, AlignmentBatch batch )
+        throws ErrorMsg
+    {
+        if ( max <= 0 )
+            throw new ErrorMsg ( "alignment batch maximum is " + max );
+
+        return this . NextAlignmentBatch ( self, Math . min ( max, batch . getCapacity () ), batch );
+    }
+
 
     /***************************************
      * AlignmentIteratorItf Implementation *
@@ -79,7 +99,7 @@ class AlignmentIteratorItf
         try
         {
             AlignmentIteratorItf ref = ( AlignmentIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -90,4 +110,6 @@ class AlignmentIteratorItf
     // native interface
     private native boolean NextAlignment ( long self )
         throws ErrorMsg;
+    private native boolean NextAlignmentBatch ( long self, int max, AlignmentBatch batch )
+        throws ErrorMsg;
 }
@@ -0,0 +1,274 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+package ngs.itf;
+
+import ngs.ErrorMsg;
+import ngs.AlignmentBatch;
+import ngs.AlignmentIterator;
+import ngs.AlignmentRecord;
+import ngs.ReadCollection;
+import ngs.Reference;
+
+import java.util.Spliterator;
+import java.util.function.Consumer;
+import java.util.stream.Stream;
+import java.util.stream.StreamSupport;
+
+
+/*==========================================================================
+ * AlignmentSpliterator
+ *  walks a run of "parts" of a set of Alignments, one iterator
+ *  at a time, fetching each a batch at a time
+ *  splitting hands the parts not yet opened to a new spliterator,
+ *  so the parts themselves are planned once, when the stream is made
+ */
+abstract class AlignmentSpliterator
+    implements Spliterator < AlignmentRecord >
+{
+
+    /* stream
+     *  of the Alignments of "rc", split into engine shards if it has them
+     */
+    static Stream < AlignmentRecord > stream ( ReadCollection rc, int categories )
+        throws ErrorMsg
+    {
+        int parts = rc . supports ( ReadCollection . alignmentShardFeature ) ? partsWanted () : 1;
+        return StreamSupport . stream ( new Shards ( rc, categories, 0, parts, parts ), false );
+    }
+
+    /* stream
+     *  of the Alignments of a slice of "ref", split into shorter slices
+     */
+    static Stream < AlignmentRecord > stream ( Reference ref, long start, long length, int categories )
+        throws ErrorMsg
+    {
+        long partLength = Math . max ( ( length + partsWanted () - 1 ) / partsWanted (), minSliceLength );
+        int parts = length <= 0 ? 1 : ( int ) ( ( length + partLength - 1 ) / partLength );
+        return StreamSupport . stream ( new Slices ( ref, categories, start, length, partLength, 0, parts ), false );
+    }
+
+
+    /******************************
+     * Spliterator Implementation *
+     ******************************/
+
+    public boolean tryAdvance ( Consumer < ? super AlignmentRecord > action )
+    {
+        try
+        {
+            while ( true )
+            {
+                while ( row < rows )
+                {
+                    int i = row ++;
+                    if ( part == 0 || keeps ( part, batch, i ) )
+                    {
+                        action . accept ( new AlignmentRecord ( batch, i ) );
+                        return true;
+                    }
+                }
+
+                if ( it != null && it . nextAlignmentBatch ( batch ) )
+                {
+                    row = 0;
+                    rows = batch . size ();
+                    continue;
+                }
+
+                if ( it != null )
+                {
+                    it . close ();
+                    it = null;
+                }
+
+                if ( next >= end )
+                    return false;
+
+                part = next ++;
+                it = open ( part );
+                if ( batch == null )
+                    batch = new AlignmentBatch ();
+                row = rows = 0;
+            }
+        }
+        catch ( ErrorMsg x )
+        {
+            throw new RuntimeException ( x . getMessage (), x );
+        }
+    }
+
+    /* trySplit
+     *  gives away the later half of the parts not yet opened;
+     *  the part being read stays with this spliterator
+     */
+    public Spliterator < AlignmentRecord > trySplit ()
+    {
+        int left = end - next;
+        if ( left < ( it == null ? 2 : 1 ) )
+            return null;
+
+        int mid = next + left / 2;
+        Spliterator < AlignmentRecord > split = split ( mid, end );
+        end = mid;
+        return split;
+    }
+
+    public long estimateSize ()
+    {
+        return Long . MAX_VALUE;
+    }
+
+    public int characteristics ()
+    {
+        return ORDERED | NONNULL | IMMUTABLE;
+    }
+
+
+    /***************************************
+     * AlignmentSpliterator Implementation *
+     ***************************************/
+
+    AlignmentSpliterator ( int first, int end )
+    {
+        this . next = first;
+        this . end = end;
+    }
+
+    /* open
+     *  an iterator across "part"
+     */
+    abstract AlignmentIterator open ( int part )
+        throws ErrorMsg;
+
+    /* keeps
+     *  whether row "i" of "batch", read from "part", belongs to it;
+     *  the first part keeps every row
+     */
+    boolean keeps ( int part, AlignmentBatch batch, int i )
+        throws ErrorMsg
+    {
+        return true;
+    }
+
+    /* split
+     *  a spliterator across parts [ first, end )
+     */
+    abstract AlignmentSpliterator split ( int first, int end );
+
+    /* partsWanted
+     *  enough parts for the pool to keep busy when they differ in size
+     */
+    static int partsWanted ()
+    {
+        return Runtime . getRuntime () . availableProcessors () * 4;
+    }
+
+    static final long minSliceLength = 64 * 1024;
+
+    private AlignmentIterator it;
+    private AlignmentBatch batch;
+    private int row, rows;
+    private int part;
+    private int next;
+    private int end;
+
+
+    /* Shards
+     *  a ReadCollection's shards, or all of its alignments as one part
+     */
+    static final class Shards
+        extends AlignmentSpliterator
+    {
+        Shards ( ReadCollection rc, int categories, int first, int end, int count )
+        {
+            super ( first, end );
+            this . rc = rc;
+            this . categories = categories;
+            this . count = count;
+        }
+
+        AlignmentIterator open ( int part )
+            throws ErrorMsg
+        {
+            if ( count == 1 )
+                return rc . getAlignments ( categories );
+            return rc . getAlignmentShard ( part, count, categories );
+        }
+
+        AlignmentSpliterator split ( int first, int end )
+        {
+            return new Shards ( rc, categories, first, end, count );
+        }
+
+        private final ReadCollection rc;
+        private final int categories;
+        private final int count;
+    }
+
+    /* Slices
+     *  a slice of a Reference as slices of "partLength"
+     *  a slice iterator also returns the Alignments that start
+     *  before it and overlap it; all but the first part drop them
+     */
+    static final class Slices
+        extends AlignmentSpliterator
+    {
+        Slices ( Reference ref, int categories, long start, long length, long partLength, int first, int end )
+        {
+            super ( first, end );
+            this . ref = ref;
+            this . categories = categories;
+            this . start = start;
+            this . length = length;
+            this . partLength = partLength;
+        }
+
+        AlignmentIterator open ( int part )
+            throws ErrorMsg
+        {
+            long offset = part * partLength;
+            return ref . getAlignmentSlice ( start + offset, Math . min ( partLength, length - offset ), categories );
+        }
+
+        boolean keeps ( int part, AlignmentBatch batch, int i )
+            throws ErrorMsg
+        {
+            return batch . getAlignmentPosition ( i ) >= start + part * partLength;
+        }
+
+        AlignmentSpliterator split ( int first, int end )
+        {
+            return new Slices ( ref, categories, start, length, partLength, first, end );
+        }
+
+        private final Reference ref;
+        private final int categories;
+        private final long start;
+        private final long length;
+        private final long partLength;
+    }
+}
@@ -75,7 +75,7 @@ class FragmentIteratorItf
         try
         {
             FragmentIteratorItf ref = ( FragmentIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -26,6 +26,9 @@
 
 package ngs.itf;
 
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
+
 import ngs.ErrorMsg;
 import ngs.Fragment;
 import ngs.FragmentIterator;
@@ -121,6 +124,68 @@ class FragmentItf
         return this . GetFragmentQualities ( self, offset, length );
     }
 
+    /* getFragmentBases
+     *  into a buffer or array, returning the size and
+     *  copying nothing when there isn't room for it
+     */
+    public int getFragmentBases ( ByteBuffer dst )
+        throws ErrorMsg
+    {
+        if ( dst . isReadOnly () )
+            throw new ReadOnlyBufferException ();
+
+        int pos = dst . position ();
+        int room = dst . remaining ();
+        int size = dst . isDirect ()
+            ? this . GetFragmentBasesBuffer ( self, 0, -1, dst, pos, room )
+            : this . GetFragmentBasesArray ( self, 0, -1, dst . array (), dst . arrayOffset () + pos, room );
+
+        if ( size <= room )
+            dst . position ( pos + size );
+
+        return size;
+    }
+
+    public int getFragmentBases ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( dstOffset < 0 || dstOffset > dst . length )
+            throw new IndexOutOfBoundsException ( "offset " + dstOffset + " is outside of the array" );
+
+        return this . GetFragmentBasesArray ( self, 0, -1, dst, dstOffset, dst . length - dstOffset );
+    }
+
+    /* getFragmentQualities
+     *  into a buffer or array, returning the size and
+     *  copying nothing when there isn't room for it
+     */
+    public int getFragmentQualities ( ByteBuffer dst )
+        throws ErrorMsg
+    {
+        if ( dst . isReadOnly () )
+            throw new ReadOnlyBufferException ();
+
+        int pos = dst . position ();
+        int room = dst . remaining ();
+        int size = dst . isDirect ()
+            ? this . GetFragmentQualitiesBuffer ( self, 0, -1, dst, pos, room )
+            : this . GetFragmentQualitiesArray ( self, 0, -1, dst . array (), dst . arrayOffset () + pos, room );
+
+        if ( size <= room )
+            dst . position ( pos + size );
+
+        return size;
+    }
+
+    public int getFragmentQualities ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( dstOffset < 0 || dstOffset > dst . length )
+            throw new IndexOutOfBoundsException ( "offset " + dstOffset + " is outside of the array" );
+
+        return this . GetFragmentQualitiesArray ( self, 0, -1, dst, dstOffset, dst . length - dstOffset );
+    }
+
     public boolean isPaired()
         throws ErrorMsg
     {
@@ -152,7 +217,7 @@ class FragmentItf
         try
         {
             FragmentItf ref = ( FragmentItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -167,6 +232,14 @@ class FragmentItf
         throws ErrorMsg;
     private native String GetFragmentQualities ( long self, long offset, long length )
         throws ErrorMsg;
+    private native int GetFragmentBasesBuffer ( long self, long offset, long length, ByteBuffer dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetFragmentBasesArray ( long self, long offset, long length, byte [] dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetFragmentQualitiesBuffer ( long self, long offset, long length, ByteBuffer dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetFragmentQualitiesArray ( long self, long offset, long length, byte [] dst, int pos, int room )
+        throws ErrorMsg;
     private native boolean IsPaired ( long self )
         throws ErrorMsg;
     private native boolean IsAligned ( long self )
@@ -88,7 +88,7 @@ class PileupEventIteratorItf
         try
         {
             PileupEventIteratorItf ref = ( PileupEventIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -193,7 +193,7 @@ class PileupEventItf
         try
         {
             PileupEventItf ref = ( PileupEventItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -29,6 +29,7 @@ package ngs.itf;
 import ngs.ErrorMsg;
 import ngs.Pileup;
 import ngs.PileupIterator;
+import ngs.PileupColumns;
 
 
 /*==========================================================================
@@ -58,6 +59,25 @@ class PileupIteratorItf
         return this . NextPileup ( self );
     }
 
+    /* nextPileupColumns
+     *  fill "columns" with the events of up to "max" of the next
+     *  positions in one native call, rather than a call per event
+     */
+    public boolean nextPileupColumns ( PileupColumns columns )
+        throws ErrorMsg
+    {
+        return this . NextPileupColumns ( self, columns . getMaxPositions (), columns );
+    }
+
+    public boolean nextPileupColumns ( int max, PileupColumns columns )
+        throws ErrorMsg
+    {
+        if ( max <= 0 )
+            throw new ErrorMsg ( "pileup columns maximum is " + max );
+
+        return this . NextPileupColumns ( self, Math . min ( max, columns . getMaxPositions () ), columns );
+    }
+
 
     /************************************
      * PileupIteratorItf Implementation *
@@ -77,7 +97,7 @@ class PileupIteratorItf
         try
         {
             PileupIteratorItf ref = ( PileupIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -88,4 +108,6 @@ class PileupIteratorItf
     // native interface
     private native boolean NextPileup ( long self )
         throws ErrorMsg;
+    private native boolean NextPileupColumns ( long self, int max, PileupColumns columns )
+        throws ErrorMsg;
 }
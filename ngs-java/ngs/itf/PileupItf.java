@@ -269,7 +269,7 @@ class PileupItf
         try
         {
             PileupItf ref = ( PileupItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
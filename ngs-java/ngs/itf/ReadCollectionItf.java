@@ -36,6 +36,10 @@ import ngs.Reference;
 import ngs.ReferenceIterator;
 import ngs.Alignment;
 import ngs.AlignmentIterator;
+import ngs.AlignmentRecord;
+import ngs.Statistics;
+
+import java.util.stream.Stream;
 
 
 /*==========================================================================
@@ -254,6 +258,35 @@ public class ReadCollectionItf
         }
     }
 
+    /* getAlignmentShard
+     *  returns an iterator across one of "count" shards of the set
+     *  "shard" is 0-based and less than "count"
+     *  "categories" provides a means of filtering by AlignmentCategory
+     */
+    public AlignmentIterator getAlignmentShard ( int shard, int count, int categories )
+        throws ErrorMsg
+    {
+        long ref = this . GetAlignmentShard ( self, shard, count, categories );
+        try
+        {
+            return new AlignmentIteratorItf ( ref );
+        }
+        catch ( Exception x )
+        {
+            this . release ( ref );
+            throw new ErrorMsg ( x . toString () );
+        }
+    }
+
+    /* alignmentStream
+     *  returns a Stream of AlignmentRecords that splits along shards
+     */
+    public Stream < AlignmentRecord > alignmentStream ( int categories )
+        throws ErrorMsg
+    {
+        return AlignmentSpliterator . stream ( this, categories );
+    }
+
 
 
 
@@ -343,6 +376,33 @@ public class ReadCollectionItf
     }
 
 
+    /* supports
+     */
+    public boolean supports ( int feature )
+        throws ErrorMsg
+    {
+        return ( this . GetFeatures ( self ) & feature ) == feature;
+    }
+
+
+    /* getStatistics
+     */
+    public Statistics getStatistics ()
+        throws ErrorMsg
+    {
+        long ref = this . GetStatistics ( self );
+        try
+        {
+            return new StatisticsItf ( ref );
+        }
+        catch ( Exception x )
+        {
+            this . release ( ref );
+            throw new ErrorMsg ( x . toString () );
+        }
+    }
+
+
     /************************************
      * ReadCollectionItf Implementation *
      ************************************/
@@ -360,7 +420,7 @@ public class ReadCollectionItf
         try
         {
             ReadCollectionItf ref = ( ReadCollectionItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -389,6 +449,8 @@ public class ReadCollectionItf
         throws ErrorMsg;
     private native long GetAlignmentRange ( long self, long first, long count, int categories )
         throws ErrorMsg;
+    private native long GetAlignmentShard ( long self, int shard, int count, int categories )
+        throws ErrorMsg;
     private native long GetRead ( long self, String readId )
         throws ErrorMsg;
     private native long GetReads ( long self, int categories )
@@ -397,4 +459,8 @@ public class ReadCollectionItf
         throws ErrorMsg;
     private native long GetReadRange ( long self, long first, long count, int categories )
         throws ErrorMsg;
+    private native int GetFeatures ( long self )
+        throws ErrorMsg;
+    private native long GetStatistics ( long self )
+        throws ErrorMsg;
 }
@@ -75,7 +75,7 @@ class ReadGroupIteratorItf
         try
         {
             ReadGroupIteratorItf ref = ( ReadGroupIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
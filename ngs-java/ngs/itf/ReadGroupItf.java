@@ -140,7 +140,7 @@ class ReadGroupItf
         try
         {
             ReadGroupItf ref = ( ReadGroupItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -77,7 +77,7 @@ class ReadIteratorItf
         try
         {
             ReadIteratorItf ref = ( ReadIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
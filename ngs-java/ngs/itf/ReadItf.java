@@ -26,6 +26,9 @@
 
 package ngs.itf;
 
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
+
 import ngs.ErrorMsg;
 import ngs.Read;
 import ngs.Fragment;
@@ -118,6 +121,68 @@ class ReadItf
         return this . GetFragmentQualities ( self, offset, length );
     }
 
+    /* getFragmentBases
+     *  into a buffer or array, returning the size and
+     *  copying nothing when there isn't room for it
+     */
+    public int getFragmentBases ( ByteBuffer dst )
+        throws ErrorMsg
+    {
+        if ( dst . isReadOnly () )
+            throw new ReadOnlyBufferException ();
+
+        int pos = dst . position ();
+        int room = dst . remaining ();
+        int size = dst . isDirect ()
+            ? this . GetFragmentBasesBuffer ( self, 0, -1, dst, pos, room )
+            : this . GetFragmentBasesArray ( self, 0, -1, dst . array (), dst . arrayOffset () + pos, room );
+
+        if ( size <= room )
+            dst . position ( pos + size );
+
+        return size;
+    }
+
+    public int getFragmentBases ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( dstOffset < 0 || dstOffset > dst . length )
+            throw new IndexOutOfBoundsException ( "offset " + dstOffset + " is outside of the array" );
+
+        return this . GetFragmentBasesArray ( self, 0, -1, dst, dstOffset, dst . length - dstOffset );
+    }
+
+    /* getFragmentQualities
+     *  into a buffer or array, returning the size and
+     *  copying nothing when there isn't room for it
+     */
+    public int getFragmentQualities ( ByteBuffer dst )
+        throws ErrorMsg
+    {
+        if ( dst . isReadOnly () )
+            throw new ReadOnlyBufferException ();
+
+        int pos = dst . position ();
+        int room = dst . remaining ();
+        int size = dst . isDirect ()
+            ? this . GetFragmentQualitiesBuffer ( self, 0, -1, dst, pos, room )
+            : this . GetFragmentQualitiesArray ( self, 0, -1, dst . array (), dst . arrayOffset () + pos, room );
+
+        if ( size <= room )
+            dst . position ( pos + size );
+
+        return size;
+    }
+
+    public int getFragmentQualities ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( dstOffset < 0 || dstOffset > dst . length )
+            throw new IndexOutOfBoundsException ( "offset " + dstOffset + " is outside of the array" );
+
+        return this . GetFragmentQualitiesArray ( self, 0, -1, dst, dstOffset, dst . length - dstOffset );
+    }
+
     public boolean isPaired ()
         throws ErrorMsg
     {
@@ -267,6 +332,68 @@ class ReadItf
         return this . GetReadQualities ( self, offset, length );
     }
 
+    /* getReadBases
+     *  into a buffer or array, returning the size and
+     *  copying nothing when there isn't room for it
+     */
+    public int getReadBases ( ByteBuffer dst )
+        throws ErrorMsg
+    {
+        if ( dst . isReadOnly () )
+            throw new ReadOnlyBufferException ();
+
+        int pos = dst . position ();
+        int room = dst . remaining ();
+        int size = dst . isDirect ()
+            ? this . GetReadBasesBuffer ( self, 0, -1, dst, pos, room )
+            : this . GetReadBasesArray ( self, 0, -1, dst . array (), dst . arrayOffset () + pos, room );
+
+        if ( size <= room )
+            dst . position ( pos + size );
+
+        return size;
+    }
+
+    public int getReadBases ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( dstOffset < 0 || dstOffset > dst . length )
+            throw new IndexOutOfBoundsException ( "offset " + dstOffset + " is outside of the array" );
+
+        return this . GetReadBasesArray ( self, 0, -1, dst, dstOffset, dst . length - dstOffset );
+    }
+
+    /* getReadQualities
+     *  into a buffer or array, returning the size and
+     *  copying nothing when there isn't room for it
+     */
+    public int getReadQualities ( ByteBuffer dst )
+        throws ErrorMsg
+    {
+        if ( dst . isReadOnly () )
+            throw new ReadOnlyBufferException ();
+
+        int pos = dst . position ();
+        int room = dst . remaining ();
+        int size = dst . isDirect ()
+            ? this . GetReadQualitiesBuffer ( self, 0, -1, dst, pos, room )
+            : this . GetReadQualitiesArray ( self, 0, -1, dst . array (), dst . arrayOffset () + pos, room );
+
+        if ( size <= room )
+            dst . position ( pos + size );
+
+        return size;
+    }
+
+    public int getReadQualities ( byte [] dst, int dstOffset )
+        throws ErrorMsg, IndexOutOfBoundsException
+    {
+        if ( dstOffset < 0 || dstOffset > dst . length )
+            throw new IndexOutOfBoundsException ( "offset " + dstOffset + " is outside of the array" );
+
+        return this . GetReadQualitiesArray ( self, 0, -1, dst, dstOffset, dst . length - dstOffset );
+    }
+
 
     /***************************
      * ReadItf Implementation *
@@ -286,7 +413,7 @@ class ReadItf
         try
         {
             ReadItf ref = ( ReadItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -301,6 +428,14 @@ class ReadItf
         throws ErrorMsg;
     private native String GetFragmentQualities ( long self, long offset, long length )
         throws ErrorMsg;
+    private native int GetFragmentBasesBuffer ( long self, long offset, long length, ByteBuffer dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetFragmentBasesArray ( long self, long offset, long length, byte [] dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetFragmentQualitiesBuffer ( long self, long offset, long length, ByteBuffer dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetFragmentQualitiesArray ( long self, long offset, long length, byte [] dst, int pos, int room )
+        throws ErrorMsg;
     private native boolean IsPaired ( long self )
         throws ErrorMsg;
     private native boolean IsAligned ( long self )
@@ -323,4 +458,12 @@ class ReadItf
         throws ErrorMsg;
     private native String GetReadQualities ( long self, long offset, long length )
         throws ErrorMsg;
+    private native int GetReadBasesBuffer ( long self, long offset, long length, ByteBuffer dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetReadBasesArray ( long self, long offset, long length, byte [] dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetReadQualitiesBuffer ( long self, long offset, long length, ByteBuffer dst, int pos, int room )
+        throws ErrorMsg;
+    private native int GetReadQualitiesArray ( long self, long offset, long length, byte [] dst, int pos, int room )
+        throws ErrorMsg;
 }
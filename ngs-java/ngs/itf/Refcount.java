@@ -28,9 +28,17 @@ package ngs.itf;
 
 import ngs.ErrorMsg;
 
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+
 /*==========================================================================
  * Refcount
  *  manages reference in C heap
+ *
+ *  the reference is released by close (), or after the object has been
+ *  collected without being closed, by whichever Refcount is made or
+ *  closed next; no finalizer is involved, so a collected object goes in
+ *  one pass and nothing waits on the finalizer thread
  */
 class Refcount
 {
@@ -38,7 +46,23 @@ class Refcount
     // constructors
     Refcount ( long ref )
     {
-        this . self = ref;
+        this . adopt ( ref );
+    }
+
+    /* close
+     *  release the reference now rather than once collected
+     *  the object may not be used afterward; closing it again does nothing
+     */
+    public synchronized void close ()
+    {
+        if ( handle != null )
+        {
+            handle . clear ();
+            handle . release ();
+            handle = null;
+        }
+        self = 0;
+        drain ();
     }
 
     // implementation details
@@ -48,19 +72,20 @@ class Refcount
         return this . Duplicate ( self );
     }
 
-    synchronized void invalidate ()
+    /* adopt
+     *  take over a reference, which becomes the object's to release
+     */
+    void adopt ( long ref )
     {
-        this . Release ( self );
-        self = 0;
+        drain ();
+        this . self = ref;
+        if ( ref != 0 )
+            this . handle = new Handle ( this, ref );
     }
 
-    protected void finalize ()
+    void invalidate ()
     {
-        if ( self != 0 )
-        {
-            this . Release ( self );
-            self = 0;
-        }
+        this . close ();
     }
 
     protected static void release ( long ref )
@@ -68,11 +93,79 @@ class Refcount
         ReleaseRef ( ref );
     }
 
+    /* Handle
+     *  the reference of a Refcount, queued once the object is collected
+     *  handles are kept on a list until released, so that they aren't
+     *  collected along with their objects
+     */
+    private static final class Handle
+        extends PhantomReference < Refcount >
+    {
+        Handle ( Refcount obj, long ref )
+        {
+            super ( obj, queue );
+            this . ref = ref;
+            synchronized ( queue )
+            {
+                next = live;
+                if ( live != null )
+                    live . prev = this;
+                live = this;
+            }
+        }
+
+        void release ()
+        {
+            long r;
+            synchronized ( queue )
+            {
+                r = ref;
+                if ( r == 0 )
+                    return;
+                ref = 0;
+                if ( prev != null )
+                    prev . next = next;
+                else
+                    live = next;
+                if ( next != null )
+                    next . prev = prev;
+                prev = next = null;
+            }
+            ReleaseRef ( r );
+        }
+
+        private long ref;
+        private Handle prev;
+        private Handle next;
+    }
+
+    /* drain
+     *  release the references of the objects collected without being closed
+     *  an error releasing one has no one to go to, so it is dropped
+     */
+    private static void drain ()
+    {
+        Handle h;
+        while ( ( h = ( Handle ) queue . poll () ) != null )
+        {
+            try
+            {
+                h . release ();
+            }
+            catch ( Throwable x )
+            {
+            }
+        }
+    }
+
     // native interface
     private native long Duplicate ( long self )
         throws ErrorMsg;
-    private native void Release ( long self );
     private native static void ReleaseRef ( long ref );
 
+    private static final ReferenceQueue < Refcount > queue = new ReferenceQueue < Refcount > ();
+    private static Handle live;         // guarded by queue
+
+    private Handle handle;
     protected long self;
 }
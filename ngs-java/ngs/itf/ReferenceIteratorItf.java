@@ -75,7 +75,7 @@ class ReferenceIteratorItf
         try
         {
             ReferenceIteratorItf ref = ( ReferenceIteratorItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
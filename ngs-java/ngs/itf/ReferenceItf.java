@@ -30,8 +30,11 @@ import ngs.ErrorMsg;
 import ngs.Reference;
 import ngs.Alignment;
 import ngs.AlignmentIterator;
+import ngs.AlignmentRecord;
 import ngs.PileupIterator;
 
+import java.util.stream.Stream;
+
 
 /*==========================================================================
  * ReferenceItf
@@ -232,6 +235,22 @@ class ReferenceItf
         }
     }
 
+    /* alignmentStream
+     *  returns a Stream of AlignmentRecords across a slice of the Reference
+     *  that splits into shorter slices
+     */
+    public Stream < AlignmentRecord > alignmentStream ( long offset, long length )
+        throws ErrorMsg
+    {
+        return AlignmentSpliterator . stream ( this, offset, length, Alignment . all );
+    }
+
+    public Stream < AlignmentRecord > alignmentStream ( long offset, long length, int categories )
+        throws ErrorMsg
+    {
+        return AlignmentSpliterator . stream ( this, offset, length, categories );
+    }
+
 
     /*----------------------------------------------------------------------
      * PILEUP
@@ -312,6 +331,14 @@ class ReferenceItf
         }
     }
 
+    /* supports
+     */
+    public boolean supports ( int feature )
+        throws ErrorMsg
+    {
+        return ( this . GetFeatures ( self ) & feature ) == feature;
+    }
+
     /*******************************
      * ReferenceItf Implementation *
      *******************************/
@@ -329,7 +356,7 @@ class ReferenceItf
         try
         {
             ReferenceItf ref = ( ReferenceItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -368,4 +395,6 @@ class ReferenceItf
         throws ErrorMsg;
     private native long GetFilteredPileupSlice ( long self, long offset, long count, int categories, int filters, int mappingQuality )
         throws ErrorMsg;
+    private native int GetFeatures ( long self )
+        throws ErrorMsg;
 }
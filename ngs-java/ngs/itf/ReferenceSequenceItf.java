@@ -130,7 +130,7 @@ public class ReferenceSequenceItf
         try
         {
             ReferenceSequenceItf ref = ( ReferenceSequenceItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
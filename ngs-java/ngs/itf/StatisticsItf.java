@@ -90,7 +90,7 @@ class StatisticsItf
         try
         {
             StatisticsItf ref = ( StatisticsItf ) obj;
-            this . self = ref . duplicate ();
+            this . adopt ( ref . duplicate () );
         }
         catch ( Exception x )
         {
@@ -0,0 +1,146 @@
+#===========================================================================
+#
+#                           PUBLIC DOMAIN NOTICE
+#              National Center for Biotechnology Information
+#
+# This software/database is a "United States Government Work" under the
+# terms of the United States Copyright Act.  It was written as part of
+# the author's official duties as a United States Government employee and
+# thus cannot be copyrighted.  This software/database is freely available
+# to the public for use. The National Library of Medicine and the U.S.
+# Government have not placed any restriction on its use or reproduction.
+#
+# Although all reasonable efforts have been taken to ensure the accuracy
+# and reliability of the software and data, the NLM and the U.S.
+# Government do not and cannot warrant the performance or results that
+# may be obtained by using this software or data. The NLM and the U.S.
+# Government disclaim all warranties, express or implied, including
+# warranties of performance, merchantability or fitness for any particular
+# purpose.
+#
+# Please cite the author in any work or product based on this material.
+#
+#===========================================================================
+#
+# The Python leg of a benchmark run alike in C++, Java and Python;
+# see also ngs-sdk/examples/BindingBench.cpp and
+# ngs-java/examples/examples/BindingBench.java
+#
+# Each scenario reads the first "count" alignments of a run, and
+# prints one JSON object per line. Given the output of the C++ leg
+# for the same run, the cost of each scenario is split into the
+# engine's ( the C++ cost ) and the rest, spent in ctypes marshalling.
+#
+import json
+import sys
+import time
+import traceback
+
+from ngs import NGS
+from ngs.ErrorMsg import ErrorMsg
+from ngs.Alignment import Alignment
+from ngs.Batch import AlignmentBatch
+
+POSITION, BASES, QUALITIES = 1, 2, 4
+
+baseline = {}
+
+
+def load_baseline(path):
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            rec = json.loads(line)
+            baseline[rec["bench"]] = rec["ns_per_record"]
+            # variants such as "bases+qualities.view" stand for their kind
+            baseline.setdefault(rec["bench"].split(".")[0], rec["ns_per_record"])
+
+
+def report(bench, records, seconds):
+    ns = seconds * 1e9 / records if records else 0.0
+    rec = {"lang": "python", "bench": bench, "records": records, "ns_per_record": round(ns, 1)}
+    engine = baseline.get(bench, baseline.get(bench.split(".")[0]))
+    if engine is not None:
+        rec["engine_ns"] = engine
+        rec["marshal_ns"] = round(ns - engine, 1)
+    print(json.dumps(rec, separators=(",", ":")))
+
+
+def scan(run, count, bench, fields):
+    start = time.time()
+    with run.getAlignmentRange(1, count, Alignment.all) as it:
+        i = 0
+        while it.nextAlignment():
+            if fields & POSITION:
+                it.getAlignmentPosition()
+            if fields & BASES:
+                it.getFragmentBases()
+            if fields & QUALITIES:
+                it.getFragmentQualities()
+            i += 1
+    report(bench, i, time.time() - start)
+
+
+def scan_bytes(run, count):
+    start = time.time()
+    with run.getAlignmentRange(1, count, Alignment.all) as it:
+        i = 0
+        while it.nextAlignment():
+            it.getFragmentBasesBytes()
+            it.getFragmentQualitiesBytes()
+            i += 1
+    report("bases+qualities.bytes", i, time.time() - start)
+
+
+def scan_batches(run, count):
+    batch = AlignmentBatch(AlignmentBatch.alignmentPosition |
+                           AlignmentBatch.fragmentBases |
+                           AlignmentBatch.fragmentQualities)
+    start = time.time()
+    with run.getAlignmentRange(1, count, Alignment.all) as it:
+        n = 0
+        while True:
+            it.nextBatch(batch.getCapacity(), batch)
+            size = batch.size()
+            if size == 0:
+                break
+            positions = batch.getAlignmentPositions()
+            for i in range(size):
+                positions[i]
+                batch.getFragmentBases(i)
+                batch.getFragmentQualities(i)
+            n += size
+    report("batch", n, time.time() - start)
+
+
+def run(acc, count):
+    with NGS.openReadCollection(acc) as run:
+        # the first pass warms caches, so the rest compare alike
+        scan(run, count, "warmup", POSITION | BASES | QUALITIES)
+
+        scan(run, count, "next", 0)
+        scan(run, count, "position", POSITION)
+        scan(run, count, "bases", BASES)
+        scan(run, count, "qualities", QUALITIES)
+        scan(run, count, "position+bases+qualities", POSITION | BASES | QUALITIES)
+        scan_bytes(run, count)
+        scan_batches(run, count)
+
+
+if len(sys.argv) < 3 or len(sys.argv) > 4:
+    print ("Usage: BindingBench accession count [c++-output]\n")
+    exit(1)
+else:
+    try:
+        if len(sys.argv) > 3:
+            load_baseline(sys.argv[3])
+        run(sys.argv[1], int(sys.argv[2]))
+    except ErrorMsg as x:
+        print (x)
+        traceback.print_exc()
+        exit(1)
+    except BaseException as x:
+        traceback.print_exc()
+        exit(1)
@@ -0,0 +1,102 @@
+#===========================================================================
+#
+#                           PUBLIC DOMAIN NOTICE
+#              National Center for Biotechnology Information
+#
+# This software/database is a "United States Government Work" under the
+# terms of the United States Copyright Act.  It was written as part of
+# the author's official duties as a United States Government employee and
+# thus cannot be copyrighted.  This software/database is freely available
+# to the public for use. The National Library of Medicine and the U.S.
+# Government have not placed any restriction on its use or reproduction.
+#
+# Although all reasonable efforts have been taken to ensure the accuracy
+# and reliability of the software and data, the NLM and the U.S.
+# Government do not and cannot warrant the performance or results that
+# may be obtained by using this software or data. The NLM and the U.S.
+# Government disclaim all warranties, express or implied, including
+# warranties of performance, merchantability or fitness for any particular
+# purpose.
+#
+# Please cite the author in any work or product based on this material.
+#
+#===========================================================================
+#
+# Checks that the getters answering other NGS objects work alike through
+# the _native extension and through ctypes: the objects they return keep
+# a plain int as their reference, which the extension must take as well
+#
+import sys
+import traceback
+
+from ngs import NGS
+from ngs.ErrorMsg import ErrorMsg
+from ngs.Alignment import Alignment
+
+
+def statistics(stats):
+    with stats:
+        # the path goes to C as is
+        return stats.nextPath(b"")
+
+
+def collect(run, count):
+    out = []
+    with run.getReferences() as it:
+        while it.nextReference():
+            out.append(("reference", it.getCommonName(), it.getLength()))
+    with run.getReadGroups() as it:
+        while it.nextReadGroup():
+            out.append(("read group", it.getName(), statistics(it.getStatistics())))
+    try:
+        out.append(("statistics", statistics(run.getStatistics())))
+    except ErrorMsg:
+        out.append(("statistics", None)) # an engine that keeps none
+    with run.getAlignmentRange(1, count, Alignment.all) as it:
+        while it.nextAlignment():
+            if it.hasMate():
+                with it.getMateAlignment() as mate:
+                    out.append(("mate", it.getAlignmentId(), mate.getAlignmentId()))
+                break
+    return out
+
+
+def run(acc, count):
+    with NGS.openReadCollection(acc) as run:
+        native = NGS.lib_manager.native
+        if native is None:
+            print ("The _native extension is not built")
+            exit(1)
+
+        natively = collect(run, count)
+        NGS.lib_manager.native = None
+        try:
+            by_ctypes = collect(run, count)
+        finally:
+            NGS.lib_manager.native = native
+
+        for kind in ("reference", "read group"):
+            print ("{} {}s".format(len([x for x in natively if x[0] == kind]), kind))
+        for x in natively:
+            if x[0] == "statistics":
+                print ("statistics {}".format("kept" if x[1] is not None else "not kept"))
+            if x[0] == "mate":
+                print ("the mate of {} is {}".format(x[1], x[2]))
+        if natively != by_ctypes:
+            print ("_native differs from ctypes:\n{}\n{}".format(natively, by_ctypes))
+            exit(1)
+
+
+if len(sys.argv) != 3:
+    print ("Usage: NativeTest accession count\n")
+    exit(1)
+else:
+    try:
+        run(sys.argv[1], int(sys.argv[2]))
+    except ErrorMsg as x:
+        print (x)
+        traceback.print_exc()
+        exit(1)
+    except BaseException as x:
+        traceback.print_exc()
+        exit(1)
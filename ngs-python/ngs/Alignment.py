@@ -43,6 +43,7 @@ class Alignment(Fragment):
     maxMapQuality       = 8
     noWraparound        = 16
     startWithinSlice    = 32
+    withMates           = 64
 
     # AlignmentCategory constants
     primaryAlignment    = 1
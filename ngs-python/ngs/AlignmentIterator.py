@@ -29,6 +29,7 @@ from ctypes import c_int
 from . import NGS
 from .String import getNGSValue
 from .Alignment import Alignment
+from .Batch import AlignmentBatch
 
 class AlignmentIterator(Alignment):
     def nextAlignment(self):
@@ -37,6 +38,43 @@ class AlignmentIterator(Alignment):
         :returns: false if no more Alignments are available.
         :throws: ErrorMsg if more Alignments should be available, but could not be accessed.
         """
-        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_AlignmentIteratorNext, c_int))
+        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_AlignmentIteratorNext, c_int, release_gil=True))
 
+    def nextBatch(self, n=1024, batch=None):
+        """Fill a batch with the columns of up to n of the next Alignments,
+        in a single call into the engine
+        The iterator is left past the Alignments placed in the batch,
+        so it is best not to mix this with nextAlignment.
+        :param n: the most Alignments to take, limited by the batch capacity
+        :param batch: the AlignmentBatch to fill; by default one kept by the iterator
+        :returns: the batch, which is empty when no more Alignments are available.
+        Its columns are views that the next call overwrites.
+        :throws: ErrorMsg if more Alignments should be available, but could not be accessed.
+        """
+        if batch is None:
+            batch = getattr(self, "_batch", None)
+            if batch is None or batch.getCapacity() < n:
+                held = batch.c.state if batch is not None else 0
+                batch = self._batch = AlignmentBatch(capacity=n)
+                batch.c.state = held
+        batch._fill(NGS.lib_manager.PY_NGS_AlignmentIteratorNextBatch, self.ref, n)
+        return batch
+
+    def records(self, fields=AlignmentBatch.recordFieldNames, batch_size=1024):
+        """Iterate over the rest of the Alignments as namedtuples of 'fields',
+        taking them from the engine batch_size at a time
+        String fields are str for ids and bytes for bases and qualities.
+        :param fields: names from AlignmentBatch.recordFields; only their columns are fetched
+        :param batch_size: the most Alignments to take per call into the engine
+        :throws: ValueError if a field name is unknown
+        :throws: ErrorMsg if more Alignments should be available, but could not be accessed.
+        """
+        record_type, mask = AlignmentBatch.recordPlan(fields)
+        batch = AlignmentBatch(mask, capacity=batch_size)
+        while self.nextBatch(batch_size, batch).size():
+            for record in batch.records(record_type):
+                yield record
 
+    def __iter__(self):
+        """the rest of the Alignments, as records() of all fields"""
+        return self.records()
@@ -0,0 +1,345 @@
+# ===========================================================================
+# 
+#                            PUBLIC DOMAIN NOTICE
+#               National Center for Biotechnology Information
+# 
+#  This software/database is a "United States Government Work" under the
+#  terms of the United States Copyright Act.  It was written as part of
+#  the author's official duties as a United States Government employee and
+#  thus cannot be copyrighted.  This software/database is freely available
+#  to the public for use. The National Library of Medicine and the U.S.
+#  Government have not placed any restriction on its use or reproduction.
+# 
+#  Although all reasonable efforts have been taken to ensure the accuracy
+#  and reliability of the software and data, the NLM and the U.S.
+#  Government do not and cannot warrant the performance or results that
+#  may be obtained by using this software or data. The NLM and the U.S.
+#  Government disclaim all warranties, express or implied, including
+#  warranties of performance, merchantability or fitness for any particular
+#  purpose.
+# 
+#  Please cite the author in any work or product based on this material.
+# 
+# ===========================================================================
+# 
+# 
+
+
+from collections import namedtuple
+from ctypes import Structure, POINTER, byref, cast, c_char, c_int, c_int32, c_int64, c_uint32, c_uint64
+
+from .String import NGS_RawString
+from .Alignment import Alignment
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+class NGS_BatchString(Structure):
+    """( offset, size ) of one string in the arena of a batch"""
+    _fields_ = [("offset", c_uint32), ("size", c_uint32)]
+
+
+class NGS_AlignmentBatch(Structure):
+    """mirrors NGS_AlignmentBatch_v1 from ngs-sdk/ngs/itf/AlignmentItf.h"""
+    _fields_ = [
+        ("fields",     c_uint32),
+        ("capacity",   c_uint32),
+        ("position",   POINTER(c_int64)),
+        ("length",     POINTER(c_uint64)),
+        ("map_qual",   POINTER(c_int32)),
+        ("flags",      POINTER(c_uint32)),
+        ("ref_spec",   POINTER(NGS_BatchString)),
+        ("read_id",    POINTER(NGS_BatchString)),
+        ("bases",      POINTER(NGS_BatchString)),
+        ("qualities",  POINTER(NGS_BatchString)),
+        ("arena",      POINTER(c_char)),
+        ("arena_size", c_uint32),
+        ("count",      c_uint32),
+        ("arena_used", c_uint32),
+        ("state",      c_uint32),
+    ]
+
+
+class NGS_ReadBatch(Structure):
+    """mirrors PY_NGS_ReadBatch from ngs-sdk/language/python/py_ReadIteratorItf.h"""
+    _fields_ = [
+        ("fields",        c_uint32),
+        ("capacity",      c_uint32),
+        ("category",      POINTER(c_uint32)),
+        ("num_fragments", POINTER(c_uint32)),
+        ("read_id",       POINTER(NGS_BatchString)),
+        ("read_group",    POINTER(NGS_BatchString)),
+        ("bases",         POINTER(NGS_BatchString)),
+        ("qualities",     POINTER(NGS_BatchString)),
+        ("arena",         POINTER(c_char)),
+        ("arena_size",    c_uint32),
+        ("count",         c_uint32),
+        ("arena_used",    c_uint32),
+        ("state",         c_uint32),
+    ]
+
+
+class Batch:
+    """The columns of a number of records at a time, filled in by the engine
+    straight into buffers owned by this object, in a single call per batch
+
+    Numeric columns are returned as NumPy arrays when NumPy is available
+    and as memoryviews otherwise; both are views of the batch buffers, and
+    are overwritten by the next batch. A string column is a pair of
+    ( offset, size ) columns into the bytes of getArena().
+
+    A batch is meant for use with a single iterator.
+    """
+
+    def __init__(self, struct_type, fields, capacity, arena_size):
+        if capacity <= 0:
+            raise ValueError("batch capacity is {}".format(capacity))
+        if arena_size <= 0:
+            raise ValueError("batch arena size is {}".format(arena_size))
+        self._columns = {}
+        self.c = struct_type()
+        self.c.fields = fields
+        self.c.capacity = capacity
+        self._capacity = capacity
+        self.c.arena_size = arena_size
+        self._arena = (c_char * arena_size)()
+        self.c.arena = cast(self._arena, POINTER(c_char))
+
+    def _column(self, name, wanted, elem_type, code, per_record=1, ptr_type=None):
+        """allocate column 'name' of the C batch when 'wanted'; 'code' is its memoryview format"""
+        if wanted:
+            buf = (elem_type * (self._capacity * per_record))()
+            self._columns[name] = (buf, code, per_record)
+            setattr(self.c, name, cast(buf, POINTER(ptr_type or elem_type)))
+
+    def _fill(self, py_func, ref, n):
+        if n <= 0:
+            raise ValueError("batch maximum is {}".format(n))
+        self.c.capacity = min(n, self._capacity)
+        ret = c_int()
+        ngs_str_err = NGS_RawString()
+        try:
+            py_func(ref, byref(self.c), byref(ret), byref(ngs_str_err.ref))
+        finally:
+            ngs_str_err.close()
+        return bool(ret.value)
+
+    def getCapacity(self):
+        """:returns: the most records the batch holds"""
+        return self._capacity
+
+    def size(self):
+        """:returns: the number of records in the batch"""
+        return self.c.count
+
+    def __len__(self):
+        return self.c.count
+
+    def getArena(self):
+        """:returns: a memoryview of the strings of the batch, packed end to end"""
+        return memoryview(self._arena).cast('B')[:self.c.arena_used]
+
+    def getView(self, name):
+        """:returns: the named column of the records in the batch, as a NumPy array
+        or a memoryview; string columns have two uint32 ( offset, size ) per record
+        :throws: ValueError if the column was not requested
+        """
+        buf, code, per_record = self._checked(name)
+        n = self.c.count * per_record
+        if numpy is not None:
+            return numpy.ctypeslib.as_array(buf)[:n]
+        return memoryview(buf).cast('B').cast(code)[:n]
+
+    def getString(self, name, i):
+        """:returns: the bytes of string column 'name' of record 'i'
+        :throws: ValueError if the column was not requested
+        :throws: IndexError if 'i' is out of range
+        """
+        buf = self._checked(name)[0]
+        if i < 0 or i >= self.c.count:
+            raise IndexError("batch index {} is out of range".format(i))
+        offset, size = buf[2 * i], buf[2 * i + 1]
+        return self._arena[offset:offset + size]
+
+    def _checked(self, name):
+        try:
+            return self._columns[name]
+        except KeyError:
+            raise ValueError("column '{}' was not requested for the batch".format(name))
+
+    # ----------------------------------------------------------------------
+    # records
+    #  each record of a batch as a namedtuple of some of its fields,
+    #  made column by column so there is little work per record
+
+    # name -> ( column bit, reader ), set by subclasses; a reader returns
+    # a field of every record in the batch as a list
+    recordFields = {}
+    _recordTypes = {}
+
+    def _numbers(self, name):
+        return self.getView(name).tolist()
+
+    def _bytes(self, name):
+        buf = self._checked(name)[0]
+        arena = bytes(self.getArena())
+        return [arena[buf[i]:buf[i] + buf[i + 1]] for i in range(0, 2 * self.c.count, 2)]
+
+    def _text(self, name):
+        return [b.decode() for b in self._bytes(name)]
+
+    def _bits(self, name, bit):
+        return [bool(f & bit) for f in self.getView(name).tolist()]
+
+    @classmethod
+    def recordPlan(cls, fields):
+        """:returns: ( a namedtuple type with 'fields', the batch columns they need );
+        see recordFields for the names
+        :throws: ValueError if a name is not one of recordFields
+        """
+        fields = tuple(fields)
+        key = (cls, fields)
+        record_type = cls._recordTypes.get(key)
+        if record_type is None:
+            unknown = [f for f in fields if f not in cls.recordFields]
+            if unknown:
+                raise ValueError("unknown record fields {}; known are {}".format(unknown, sorted(cls.recordFields)))
+            record_type = cls._recordTypes[key] = namedtuple(cls.recordName, fields)
+        mask = 0
+        for f in fields:
+            mask |= cls.recordFields[f][0]
+        return record_type, mask
+
+    def records(self, record_type):
+        """:returns: a list of a 'record_type' from recordPlan per record in the batch"""
+        columns = [self.recordFields[f][1](self) for f in record_type._fields]
+        return list(map(record_type._make, zip(*columns)))
+
+
+class AlignmentBatch(Batch):
+    """Columns of Alignments, filled in by AlignmentIterator.nextBatch"""
+
+    # columns to fill in, as in NGS_AlignmentBatchFields
+    alignmentPosition   = 0x01 # and length
+    mappingQuality      = 0x02
+    alignmentFlags      = 0x04 # category, orientation, mate
+    referenceSpec       = 0x08
+    readId              = 0x10
+    fragmentBases       = 0x20
+    fragmentQualities   = 0x40
+    allFields           = 0x7F
+
+    # bits of the "flags" column
+    primaryFlag         = 0x01
+    reversedFlag        = 0x02
+    hasMateFlag         = 0x04
+
+    recordName = "AlignmentRecord"
+    recordFields = {
+        "pos":       (alignmentPosition, lambda b: b._numbers("position")),
+        "length":    (alignmentPosition, lambda b: b._numbers("length")),
+        "mapq":      (mappingQuality,    lambda b: b._numbers("map_qual")),
+        "category":  (alignmentFlags,    lambda b: [Alignment.primaryAlignment if f & AlignmentBatch.primaryFlag
+                                                   else Alignment.secondaryAlignment for f in b._numbers("flags")]),
+        "reversed":  (alignmentFlags,    lambda b: b._bits("flags", AlignmentBatch.reversedFlag)),
+        "has_mate":  (alignmentFlags,    lambda b: b._bits("flags", AlignmentBatch.hasMateFlag)),
+        "ref_spec":  (referenceSpec,     lambda b: b._text("ref_spec")),
+        "read_id":   (readId,            lambda b: b._text("read_id")),
+        "bases":     (fragmentBases,     lambda b: b._bytes("bases")),
+        "qualities": (fragmentQualities, lambda b: b._bytes("qualities")),
+    }
+    recordFieldNames = ("ref_spec", "read_id", "pos", "length", "mapq",
+                        "category", "reversed", "has_mate", "bases", "qualities")
+
+    def __init__(self, fields=allFields, capacity=1024, arena_size=1024*1024):
+        Batch.__init__(self, NGS_AlignmentBatch, fields, capacity, arena_size)
+        self._column("position",  fields & self.alignmentPosition, c_int64,  'q')
+        self._column("length",    fields & self.alignmentPosition, c_uint64, 'Q')
+        self._column("map_qual",  fields & self.mappingQuality,    c_int32,  'i')
+        self._column("flags",     fields & self.alignmentFlags,    c_uint32, 'I')
+        self._column("ref_spec",  fields & self.referenceSpec,     c_uint32, 'I', 2, NGS_BatchString)
+        self._column("read_id",   fields & self.readId,            c_uint32, 'I', 2, NGS_BatchString)
+        self._column("bases",     fields & self.fragmentBases,     c_uint32, 'I', 2, NGS_BatchString)
+        self._column("qualities", fields & self.fragmentQualities, c_uint32, 'I', 2, NGS_BatchString)
+
+    def getAlignmentPositions(self):
+        return self.getView("position")
+
+    def getAlignmentLengths(self):
+        return self.getView("length")
+
+    def getMappingQualities(self):
+        return self.getView("map_qual")
+
+    def getFlags(self):
+        return self.getView("flags")
+
+    def getReferenceSpec(self, i):
+        return self.getString("ref_spec", i).decode()
+
+    def getReadId(self, i):
+        return self.getString("read_id", i).decode()
+
+    def getFragmentBases(self, i):
+        """:returns: bytes"""
+        return self.getString("bases", i)
+
+    def getFragmentQualities(self, i):
+        """:returns: bytes"""
+        return self.getString("qualities", i)
+
+
+class ReadBatch(Batch):
+    """Columns of Reads, filled in by ReadIterator.nextBatch"""
+
+    # columns to fill in, as in PY_NGS_ReadBatchFields
+    readId              = 0x01
+    readCategory        = 0x02
+    numFragments        = 0x04
+    readGroup           = 0x08
+    readBases           = 0x10
+    readQualities       = 0x20
+    allFields           = 0x3F
+
+    recordName = "ReadRecord"
+    recordFields = {
+        "read_id":       (readId,        lambda b: b._text("read_id")),
+        "category":      (readCategory,  lambda b: b._numbers("category")),
+        "num_fragments": (numFragments,  lambda b: b._numbers("num_fragments")),
+        "read_group":    (readGroup,     lambda b: b._text("read_group")),
+        "bases":         (readBases,     lambda b: b._bytes("bases")),
+        "qualities":     (readQualities, lambda b: b._bytes("qualities")),
+    }
+    recordFieldNames = ("read_id", "category", "num_fragments", "read_group", "bases", "qualities")
+
+    def __init__(self, fields=allFields, capacity=1024, arena_size=1024*1024):
+        Batch.__init__(self, NGS_ReadBatch, fields, capacity, arena_size)
+        self._column("category",      fields & self.readCategory,  c_uint32, 'I')
+        self._column("num_fragments", fields & self.numFragments,  c_uint32, 'I')
+        self._column("read_id",       fields & self.readId,        c_uint32, 'I', 2, NGS_BatchString)
+        self._column("read_group",    fields & self.readGroup,     c_uint32, 'I', 2, NGS_BatchString)
+        self._column("bases",         fields & self.readBases,     c_uint32, 'I', 2, NGS_BatchString)
+        self._column("qualities",     fields & self.readQualities, c_uint32, 'I', 2, NGS_BatchString)
+
+    def getReadCategories(self):
+        return self.getView("category")
+
+    def getNumFragments(self):
+        return self.getView("num_fragments")
+
+    def getReadId(self, i):
+        return self.getString("read_id", i).decode()
+
+    def getReadGroup(self, i):
+        return self.getString("read_group", i).decode()
+
+    def getReadBases(self, i):
+        """:returns: bytes"""
+        return self.getString("bases", i)
+
+    def getReadQualities(self, i):
+        """:returns: bytes"""
+        return self.getString("qualities", i)
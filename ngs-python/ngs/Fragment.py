@@ -28,7 +28,7 @@ from ctypes import byref, c_int
 from . import NGS
 
 from .Refcount import Refcount
-from .String import NGS_String, NGS_RawString, getNGSString, getNGSValue
+from .String import NGS_String, NGS_RawString, getNGSString, getNGSValue, getNGSStringRange, getNGSBytes
 
 
 # Represents an NGS biological fragment
@@ -43,16 +43,7 @@ class Fragment(Refcount):
         :param: length must be >= 0
         :returns: sequence bases
         """
-        ngs_str_err = NGS_RawString()
-        try:
-            ngs_str_seq = NGS_String()
-            try:
-                res = NGS.lib_manager.PY_NGS_FragmentGetFragmentBases(self.ref, offset, length, byref(ngs_str_seq.ref), byref(ngs_str_err.ref))
-                return ngs_str_seq.getPyString()
-            finally:
-                ngs_str_seq.close()
-        finally:
-            ngs_str_err.close()
+        return getNGSStringRange(self, NGS.lib_manager.PY_NGS_FragmentGetFragmentBases, offset, length)
 
     def getFragmentQualities(self, offset=0, length=-1):
         """getFragmentQualities using ASCII offset of 33
@@ -60,16 +51,23 @@ class Fragment(Refcount):
         :param: length must be >= 0
         :returns: phred quality values
         """
-        ngs_str_err = NGS_RawString()
-        try:
-            ngs_str_seq = NGS_String()
-            try:
-                res = NGS.lib_manager.PY_NGS_FragmentGetFragmentQualities(self.ref, offset, length, byref(ngs_str_seq.ref), byref(ngs_str_err.ref))
-                return ngs_str_seq.getPyString()
-            finally:
-                ngs_str_seq.close()
-        finally:
-            ngs_str_err.close()
+        return getNGSStringRange(self, NGS.lib_manager.PY_NGS_FragmentGetFragmentQualities, offset, length)
+
+    def getFragmentBasesBytes(self, offset=0, length=-1):
+        """getFragmentBases as bytes, saving the decode to str
+        :param: offset is zero-based and non-negative
+        :param: length must be >= 0
+        :returns: sequence bases
+        """
+        return getNGSBytes(self, NGS.lib_manager.PY_NGS_FragmentGetFragmentBases, offset, length)
+
+    def getFragmentQualitiesBytes(self, offset=0, length=-1):
+        """getFragmentQualities as bytes, saving the decode to str
+        :param: offset is zero-based and non-negative
+        :param: length must be >= 0
+        :returns: phred quality values using ASCII offset of 33
+        """
+        return getNGSBytes(self, NGS.lib_manager.PY_NGS_FragmentGetFragmentQualities, offset, length)
 
     def isPaired(self):
         return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_FragmentIsPaired, c_int))
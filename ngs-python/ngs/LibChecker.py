@@ -25,46 +25,19 @@
 # 
 
 def check_versions():
-    from ctypes import POINTER, c_char_p, c_void_p, c_size_t, c_char
-
-    from . LibManager import LibManager, load_library, should_download_library, version_tuple
-    from . LibManager import get_library_version_tuple_remote, load_updated_library
+    """the mask of the installed libraries that are out of date, 1 for ncbi-vdb
+    and 2 for ngs-sdk, as LibManager.check_library_versions has it
+    """
+    from . LibManager import load_library, should_download_library
     from . import NGS
 
     if not should_download_library():
         return 0
     
-    libname_engine = "ncbi-vdb"
-    libname_sdk = "ngs-sdk"
-    
-    NGS.lib_manager.c_lib_engine = load_library(libname_engine, do_download=False, silent=True)
-    NGS.lib_manager.c_lib_sdk = load_library(libname_sdk, do_download=False, silent=True)
+    lib_manager = NGS.lib_manager
+    if lib_manager.c_lib_engine is None:
+        lib_manager.c_lib_engine = load_library("ncbi-vdb", do_download=False, silent=True)
+    if lib_manager.c_lib_sdk is None:
+        lib_manager.c_lib_sdk = load_library("ngs-sdk", do_download=False, silent=True)
     
-    ret = 0
-
-    if NGS.lib_manager.c_lib_engine is None:
-        ret = ret | 1
-    else:
-        try:
-            NGS.lib_manager._bind(NGS.lib_manager.c_lib_engine, "PY_NGS_Engine_GetVersion", [POINTER(c_char_p), POINTER(c_char), c_size_t], None)
-        except AttributeError:
-            NGS.lib_manager.setattr("PY_NGS_Engine_GetVersion", None)
-
-        if version_tuple( NGS.getVersion_impl() ) < get_library_version_tuple_remote(libname_engine):
-            ret = ret | 1
-        
-    if NGS.lib_manager.c_lib_sdk is None:
-        ret = ret | 2
-    else:
-        try:
-            NGS.lib_manager.bind_sdk("PY_NGS_PackageGetPackageVersion", [POINTER(c_void_p), POINTER(c_void_p)])
-            # Functions needed to make a call to NGS version functions
-            NGS.lib_manager._bind(NGS.lib_manager.c_lib_sdk, "PY_NGS_RawStringRelease", [c_void_p, POINTER(c_void_p)], None)
-        except AttributeError:
-            NGS.lib_manager.setattr("PY_NGS_PackageGetPackageVersion", None)
-
-        if version_tuple( NGS.getPackageVersion_impl() ) < get_library_version_tuple_remote(libname_sdk):
-            ret = ret | 2
-
-    return ret
-
+    return lib_manager.check_library_versions()
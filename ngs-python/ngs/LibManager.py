@@ -24,8 +24,8 @@
 # 
 # 
 
-from ctypes import cdll, c_char, c_int, c_char_p, c_int32, c_int64, c_double, POINTER, c_size_t, c_void_p, c_uint64, c_uint32
-import os, sys, platform, tempfile, subprocess
+from ctypes import cdll, cast, c_char, c_int, c_char_p, c_int32, c_int64, c_double, POINTER, c_size_t, c_void_p, c_uint64, c_uint32
+import os, sys, platform, tempfile, time, json
 
 if sys.version_info[0] > 2:
     from urllib.parse import urlencode
@@ -53,7 +53,9 @@ def load_saved_library(lib_name):
     and load it if found
     """
     lib = None
-        
+    
+    # libraries must be loaded as CDLL, never PyDLL: CDLL calls drop the GIL,
+    # which lets threads overlap opening collections and fetching data
     for dir in LibManager.get_directories_to_find_dll():
         try:
             lib = cdll.LoadLibrary(os.path.join(dir, lib_filename(lib_name) ))
@@ -82,12 +84,15 @@ def load_updated_library(lib_name):
             continue
 
         lib_path = os.path.join(dir, lib_filename(lib_name))
+        # written apart and loaded from there, then moved into place, so that
+        # the copy this process may have loaded already is never overwritten
+        new_path = lib_path + ".download-" + str(os.getpid())
         
         try:
-            f = open(lib_path, "wb")
-            file_created = (True, lib_path)
+            f = open(new_path, "wb")
+            file_created = (True, new_path)
         except:
-            file_created = (False, lib_path)
+            file_created = (False, new_path)
             continue
 
         params = urlencode({
@@ -107,7 +112,12 @@ def load_updated_library(lib_name):
         except:
             file_saved = (False, lib_path)
             continue
-        return cdll.LoadLibrary(lib_path)
+        library = cdll.LoadLibrary(new_path)
+        try:
+            replace_file(new_path, lib_path)
+        except OSError:
+            pass # e.g. the old one is loaded on Windows; it is replaced next time
+        return library
     
     if not directory_created[0]:
         raise ErrorMsg("Failed to create directory '" + directory_created[1] + "' for " + lib_filename(lib_name))
@@ -116,6 +126,14 @@ def load_updated_library(lib_name):
     elif not file_saved[0]:
         raise ErrorMsg("Failed to save file " + file_saved[1])
 
+def replace_file(src, dst):
+    if hasattr(os, "replace"):
+        os.replace(src, dst)
+    else:
+        if platform.system() == "Windows" and os.path.exists(dst):
+            os.remove(dst)
+        os.rename(src, dst)
+
 def version_tuple(version_str):
     assert isinstance(version_str, str) or isinstance(version_str, unicode)
     import re
@@ -131,7 +149,7 @@ def version_tuple(version_str):
     
     return tuple ( arr_typed )
         
-def get_library_version_tuple_remote(lib_name):
+def get_library_version_remote(lib_name):
     params = urlencode({
         'cmd':     'vers',
         'libname': lib_name,
@@ -146,12 +164,80 @@ def get_library_version_tuple_remote(lib_name):
     if isinstance(version_str, bytes):
         version_str = version_str.decode(encoding='utf8')
     
-    return version_tuple (version_str)
+    return version_str
+
+def get_library_version_tuple_remote(lib_name):
+    return version_tuple (get_library_version_remote(lib_name))
+
+# where the latest versions asked of NCBI are remembered
+VERSION_CACHE_FILE = os.path.join(os.path.expanduser('~'), ".ncbi", "ngs-py-versions.json")
+
+def version_cache_seconds():
+    """NGS_PY_VERSION_CHECK_SECONDS: how long the latest versions are remembered,
+    a day by default; 0 asks every time
+    """
+    try:
+        return float(os.environ.get("NGS_PY_VERSION_CHECK_SECONDS", "86400"))
+    except ValueError:
+        return 86400.0
+
+def get_library_version_tuple_latest(lib_name):
+    """as get_library_version_tuple_remote, but remembered in VERSION_CACHE_FILE
+    for version_cache_seconds(), so that short-lived processes don't each ask
+    """
+    key = lib_name + "/" + LibManager.get_post_os_name_param() + "/" + str(process_bits())
+    now = time.time()
+    try:
+        with open(VERSION_CACHE_FILE) as f:
+            cache = json.load(f)
+    except (IOError, OSError, ValueError):
+        cache = {}
+    if not isinstance(cache, dict):
+        cache = {}
+
+    entry = cache.get(key)
+    if isinstance(entry, dict) and 0 <= now - entry.get("checked", 0) < version_cache_seconds():
+        return version_tuple(entry["version"])
+
+    version_str = get_library_version_remote(lib_name)
+    cache[key] = { "version": version_str, "checked": now }
+    try:
+        if not os.path.isdir(os.path.dirname(VERSION_CACHE_FILE)):
+            os.makedirs(os.path.dirname(VERSION_CACHE_FILE))
+        new_path = VERSION_CACHE_FILE + "." + str(os.getpid())
+        with open(new_path, "w") as f:
+            json.dump(cache, f)
+        replace_file(new_path, VERSION_CACHE_FILE)
+    except (IOError, OSError):
+        pass # only a cache
+    return version_tuple(version_str)
 
 def should_download_library():
+    if is_offline():
+        return False
     do_download = os.environ.get("NGS_PY_DOWNLOAD_LIBRARY", "1")
     return do_download.lower() in ("1", "yes", "true", "on")
 
+def is_offline():
+    """NGS_PY_OFFLINE asks for a fast start: no network and no check for newer
+    libraries; the libraries are loaded from NGS_PY_LIBRARY_PATH (or
+    the usual directories) and checked against LIBRARY_MANIFEST once loaded
+    """
+    offline = os.environ.get("NGS_PY_OFFLINE", "0")
+    return offline.lower() in ("1", "yes", "true", "on")
+
+# the oldest library versions these bindings work with
+LIBRARY_MANIFEST = {
+    "ncbi-vdb": "2.8.0",
+    "ngs-sdk":  "1.3.0",
+}
+
+def check_manifest_version(lib_name, version_str):
+    required = LIBRARY_MANIFEST[lib_name]
+    if version_tuple(version_str) < version_tuple(required):
+        raise ErrorMsg("Library " + lib_filename(lib_name) + " version " + version_str +
+            " is older than the required " + required)
+
     
 def load_library(lib_name, do_download, silent):
     if do_download:
@@ -168,23 +254,216 @@ def load_library(lib_name, do_download, silent):
     else:
         return library
     
+# the prototypes of the functions of the libraries, bound on first use by
+# LibManager.__getattr__; those of ngs-sdk but the common ones report errors
+# that check_res_embedded raises
+
+ENGINE_PROTOTYPES = (
+    ("PY_NGS_Engine_ReadCollectionMake",    [c_char_p, POINTER(c_void_p), POINTER(c_char), c_size_t]),
+    ("PY_NGS_Engine_ReferenceSequenceMake", [c_char_p, POINTER(c_void_p), POINTER(c_char), c_size_t]),
+
+    ("PY_NGS_Engine_SetAppVersionString",   [c_char_p, POINTER(c_char), c_size_t]),
+    ("PY_NGS_Engine_GetVersion",            [POINTER(c_char_p), POINTER(c_char), c_size_t]),
+    ("PY_NGS_Engine_IsValid",               [c_char_p, POINTER(c_int), POINTER(c_char), c_size_t]),
+)
+
+SDK_COMMON_PROTOTYPES = (
+    ("PY_NGS_StringGetData",    [c_void_p, POINTER(c_char_p)]),
+    ("PY_NGS_StringGetSize",    [c_void_p, POINTER(c_size_t)]),
+    ("PY_NGS_RawStringRelease", [c_void_p, POINTER(c_void_p)]),
+    ("PY_NGS_RefcountRelease",  [c_void_p, POINTER(c_void_p)]),
+)
+
+SDK_PROTOTYPES = (
+    # ReadCollection
+
+    ("PY_NGS_ReadCollectionGetName",           [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReadGroups",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionHasReadGroup",      [c_void_p, c_char_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReadGroup",      [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReferences",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionHasReference",      [c_void_p, c_char_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReference",      [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetAlignment",      [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetAlignments",     [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetAlignmentCount", [c_void_p, c_uint32, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetAlignmentRange", [c_void_p, c_uint64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetAlignmentShard", [c_void_p, c_uint32, c_uint32, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetRead",           [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReads",          [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReadCount",      [c_void_p, c_uint32, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetReadRange",      [c_void_p, c_uint64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetFeatures",       [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_ReadCollectionGetStatistics",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+
+    # Alignment
+
+    ("PY_NGS_AlignmentGetAlignmentId",               [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetReferenceSpec",             [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetMappingQuality",            [c_void_p, POINTER(c_int32), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetReferenceBases",            [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetReadGroup",                 [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetReadId",                    [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetClippedFragmentBases",      [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetClippedFragmentQualities",  [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetAlignedFragmentBases",      [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetAlignmentCategory",         [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetAlignmentPosition",         [c_void_p, POINTER(c_int64), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetAlignmentLength",           [c_void_p, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetIsReversedOrientation",     [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetSoftClip",                  [c_void_p, c_uint32, POINTER(c_int32), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetTemplateLength",            [c_void_p, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetShortCigar",                [c_void_p, c_int, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetLongCigar",                 [c_void_p, c_int, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetRNAOrientation",            [c_void_p, POINTER(c_char), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentHasMate",                      [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetMateAlignmentId",           [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetMateAlignment",             [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetMateReferenceSpec",         [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentGetMateIsReversedOrientation", [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    ("PY_NGS_AlignmentIteratorNext",                 [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_AlignmentIteratorNextBatch",            [c_void_p, c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # Fragment
+
+    ("PY_NGS_FragmentGetFragmentId",        [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_FragmentGetFragmentBases",     [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_FragmentGetFragmentQualities", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_FragmentIsPaired",             [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_FragmentIsAligned",            [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    ("PY_NGS_FragmentIteratorNext",         [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # Package
+
+    ("PY_NGS_PackageGetPackageVersion", [POINTER(c_void_p), POINTER(c_void_p)]),
+
+    # PileupEvent
+
+    ("PY_NGS_PileupEventGetMappingQuality",         [c_void_p, POINTER(c_int32), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetAlignmentId",            [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetAlignmentPosition",      [c_void_p, POINTER(c_int64), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetFirstAlignmentPosition", [c_void_p, POINTER(c_int64), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetLastAlignmentPosition",  [c_void_p, POINTER(c_int64), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetEventType",              [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetAlignmentBase",          [c_void_p, POINTER(c_char), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetAlignmentQuality",       [c_void_p, POINTER(c_char), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetInsertionBases",         [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetInsertionQualities",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetEventRepeatCount",       [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventGetEventIndelType",         [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+
+    ("PY_NGS_PileupEventIteratorNext",              [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_PileupEventIteratorReset",             [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # Pileup
+
+    ("PY_NGS_PileupGetReferenceSpec",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_PileupGetReferencePosition", [c_void_p, POINTER(c_int64), POINTER(c_void_p)]),
+    ("PY_NGS_PileupGetReferenceBase",     [c_void_p, POINTER(c_char), POINTER(c_void_p)]),
+    ("PY_NGS_PileupGetPileupDepth",       [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_PileupGetBaseCounts",        [c_void_p, c_int32, c_int64, c_uint64, c_int, POINTER(c_uint32), POINTER(c_uint64), POINTER(c_void_p)]),
+
+    ("PY_NGS_PileupIteratorNext",         [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # ReadGroup
+
+    ("PY_NGS_ReadGroupGetName",       [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGroupGetStatistics", [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+
+    ("PY_NGS_ReadGroupIteratorNext",  [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # Read
+
+    ("PY_NGS_ReadGetReadId",        [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGetNumFragments",  [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_ReadFragmentIsAligned", [c_void_p, c_uint32, POINTER(c_int32), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGetReadCategory",  [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGetReadGroup",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGetReadName",      [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGetReadBases",     [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReadGetReadQualities", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+
+    ("PY_NGS_ReadIteratorNext",     [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_ReadIteratorNextBatch", [c_void_p, c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # Reference
+
+    ("PY_NGS_ReferenceGetCommonName",             [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetCanonicalName",          [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetIsCircular",             [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetLength",                 [c_void_p, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetReferenceBases",         [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetReferenceChunk",         [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetAlignment",              [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetAlignments",             [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetAlignmentSlice",         [c_void_p, c_int64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetFilteredAlignmentSlice", [c_void_p, c_int64, c_uint64, c_uint32, c_uint32, c_int32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetPileups",                [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetFilteredPileups",        [c_void_p, c_uint32, c_uint32, c_int32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetPileupSlice",            [c_void_p, c_int64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetFilteredPileupSlice",    [c_void_p, c_int64, c_uint64, c_uint32, c_uint32, c_int32, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetFeatures",               [c_void_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceGetCoverage",               [c_void_p, c_int64, c_uint64, c_uint32, c_uint32, c_int32, POINTER(c_uint32), POINTER(c_void_p)]),
+
+    ("PY_NGS_ReferenceIteratorNext",              [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+
+    # ReferenceSequence
+
+    ("PY_NGS_ReferenceSequenceGetCanonicalName",  [c_void_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceSequenceGetIsCircular",     [c_void_p, POINTER(c_int), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceSequenceGetLength",         [c_void_p, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceSequenceGetReferenceBases", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_ReferenceSequenceGetReferenceChunk", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)]),
+
+    # Statistics
+
+    ("PY_NGS_StatisticsGetValueType", [c_void_p, c_char_p, POINTER(c_uint32), POINTER(c_void_p)]),
+    ("PY_NGS_StatisticsGetAsString",  [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+    ("PY_NGS_StatisticsGetAsI64",     [c_void_p, c_char_p, POINTER(c_int64), POINTER(c_void_p)]),
+    ("PY_NGS_StatisticsGetAsU64",     [c_void_p, c_char_p, POINTER(c_uint64), POINTER(c_void_p)]),
+    ("PY_NGS_StatisticsGetAsDouble",  [c_void_p, c_char_p, POINTER(c_double), POINTER(c_void_p)]),
+    ("PY_NGS_StatisticsGetNextPath",  [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)]),
+)
+
 class LibManager:
     c_lib_engine = None
     c_lib_sdk = None
+    native = None # the optional _native extension, once the libraries are bound
     
     URL_NCBI_SRATOOLKIT = 'https://trace.ncbi.nlm.nih.gov/Traces/sratoolkit/sratoolkit.cgi'
     
     def _bind(self, c_lib, c_func_name_str, param_types_list, errorcheck):
-        setattr(self, c_func_name_str, getattr(c_lib, c_func_name_str))
-        func = getattr(self, c_func_name_str)
+        func = getattr(c_lib, c_func_name_str)
         func.argtypes = param_types_list
         func.restype = c_int
+        func.address = cast(func, c_void_p).value # for the _native extension
         if errorcheck:
             func.errcheck = errorcheck
+        setattr(self, c_func_name_str, func) # last, for threads binding it at once
+        return func
         
     def bind_sdk(self, c_func_name_str, param_types_list):
         return self._bind(self.c_lib_sdk, c_func_name_str, param_types_list, check_res_embedded)
     
+    def __getattr__(self, name):
+        """bind a function of the libraries the first time it is used"""
+        prototype = _prototypes.get(name)
+        if prototype is None:
+            raise AttributeError(name)
+        lib_attr, param_types_list, errorcheck = prototype
+        c_lib = getattr(self, lib_attr)
+        if c_lib is None:
+            raise AttributeError(name + ": the library isn't loaded")
+        return self._bind(c_lib, name, param_types_list, errorcheck)
+    
+    def _unbind(self, lib_attr):
+        """forget the functions bound from a library that is replaced"""
+        for name, prototype in _prototypes.items():
+            if prototype[0] == lib_attr:
+                self.__dict__.pop(name, None)
+    
     @staticmethod
     def get_directories_to_find_dll():
         env_path = os.environ.get("NGS_PY_LIBRARY_PATH", None)
@@ -216,188 +495,81 @@ class LibManager:
         else:
             return ""
     
-    def initialize_ngs_bindings(self):
-        if self.c_lib_engine and self.c_lib_sdk: # already initialized
-            return
-
-        # check versions - must be run in a separate script to free library before overwriting it
-        # check_vers_res = os.system('python -c "from ngs import NGS; exit(NGS.checkLibVersions())"')
-        # if platform.system() != "Windows":
-            # check_vers_res = check_vers_res >> 8 # python is a cross-platform language
-        
-        # os.system is not that reliable and cross-platform as subprocess. So using subprocess
-        check_vers_res = subprocess.call([sys.executable, "-c", "from ngs import NGS; exit(NGS.checkLibVersions())"])
-        
-        do_update_engine = check_vers_res & 1
-        do_update_sdk    = check_vers_res & 2
-        
-        libname_engine = "ncbi-vdb"
-        libname_sdk = "ngs-sdk"
-        
-        self.c_lib_engine = load_library(libname_engine, do_update_engine, silent=False)
-        self.c_lib_sdk = load_library(libname_sdk, do_update_sdk, silent=False)
-        
-        ##############  ngs-engine imports below  ####################
-        
-        self._bind(self.c_lib_engine, "PY_NGS_Engine_ReadCollectionMake",    [c_char_p, POINTER(c_void_p), POINTER(c_char), c_size_t], None)
-        self._bind(self.c_lib_engine, "PY_NGS_Engine_ReferenceSequenceMake", [c_char_p, POINTER(c_void_p), POINTER(c_char), c_size_t], None)
-
-        self._bind(self.c_lib_engine, "PY_NGS_Engine_SetAppVersionString",   [c_char_p, POINTER(c_char), c_size_t], None)
-        self._bind(self.c_lib_engine, "PY_NGS_Engine_GetVersion",            [POINTER(c_char_p), POINTER(c_char), c_size_t], None)
-        self._bind(self.c_lib_engine, "PY_NGS_Engine_IsValid",               [c_char_p, POINTER(c_int), POINTER(c_char), c_size_t], None)
-
-        # self._bind(self.c_lib_engine, "PY_NGS_Engine_RefcountRelease",       [c_void_p, POINTER(c_char), c_size_t], None)
-        # self._bind(self.c_lib_engine, "PY_NGS_Engine_StringData", [c_void_p, POINTER(c_char_p)], None)
-        # self._bind(self.c_lib_engine, "PY_NGS_Engine_StringSize", [c_void_p, POINTER(c_size_t)], None)
+    def check_library_versions(self):
+        """compare the loaded libraries with the latest ones available from NCBI,
+        in this process; see get_library_version_tuple_latest
+        :returns: a mask of the libraries to download: 1 for ncbi-vdb, 2 for ngs-sdk
+        """
+        from . import NGS
         
-        ##############  ngs-sdk imports below  ####################
+        ret = 0
+        if self.c_lib_engine is None or version_tuple(NGS.getVersion_impl()) < get_library_version_tuple_latest("ncbi-vdb"):
+            ret = ret | 1
+        if self.c_lib_sdk is None or version_tuple(NGS.getPackageVersion_impl()) < get_library_version_tuple_latest("ngs-sdk"):
+            ret = ret | 2
+        return ret
 
-        # Common
-        
-        self._bind(self.c_lib_sdk, "PY_NGS_StringGetData",    [c_void_p, POINTER(c_char_p)], None)
-        self._bind(self.c_lib_sdk, "PY_NGS_StringGetSize",    [c_void_p, POINTER(c_size_t)], None)
-        self._bind(self.c_lib_sdk, "PY_NGS_RawStringRelease", [c_void_p, POINTER(c_void_p)], None)
-        self._bind(self.c_lib_sdk, "PY_NGS_RefcountRelease",  [c_void_p, POINTER(c_void_p)], None)
-        
-        # ReadCollection
-
-        self.bind_sdk("PY_NGS_ReadCollectionGetName",           [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReadGroups",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionHasReadGroup",      [c_void_p, c_char_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReadGroup",      [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReferences",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionHasReference",      [c_void_p, c_char_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReference",      [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetAlignment",      [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetAlignments",     [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetAlignmentCount", [c_void_p, c_uint32, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetAlignmentRange", [c_void_p, c_uint64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetRead",           [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReads",          [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReadCount",      [c_void_p, c_uint32, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadCollectionGetReadRange",      [c_void_p, c_uint64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-
-        # Alignment
-        
-        self.bind_sdk("PY_NGS_AlignmentGetAlignmentId",               [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetReferenceSpec",             [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetMappingQuality",            [c_void_p, POINTER(c_int32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetReferenceBases",            [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetReadGroup",                 [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetReadId",                    [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetClippedFragmentBases",      [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetClippedFragmentQualities",  [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetAlignedFragmentBases",      [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetAlignmentCategory",         [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetAlignmentPosition",         [c_void_p, POINTER(c_int64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetAlignmentLength",           [c_void_p, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetIsReversedOrientation",     [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetSoftClip",                  [c_void_p, c_uint32, POINTER(c_int32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetTemplateLength",            [c_void_p, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetShortCigar",                [c_void_p, c_int, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetLongCigar",                 [c_void_p, c_int, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetRNAOrientation",            [c_void_p, POINTER(c_char), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentHasMate",                      [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetMateAlignmentId",           [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetMateAlignment",             [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetMateReferenceSpec",         [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_AlignmentGetMateIsReversedOrientation", [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        
-        self.bind_sdk("PY_NGS_AlignmentIteratorNext",                 [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        
-        # Fragment
-        
-        self.bind_sdk("PY_NGS_FragmentGetFragmentId",        [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_FragmentGetFragmentBases",     [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_FragmentGetFragmentQualities", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_FragmentIsPaired",             [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_FragmentIsAligned",            [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-
-        self.bind_sdk("PY_NGS_FragmentIteratorNext",         [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        
-        # Package
+    def update_libraries(self):
+        """the explicit form of the remote check done when starting online:
+        download the libraries that are out of date, before they are first used
+        """
+        if self.c_lib_engine or self.c_lib_sdk:
+            raise ErrorMsg("Libraries are already loaded and can't be updated in this process")
+        return self._load_latest_libraries()
 
-        self.bind_sdk("PY_NGS_PackageGetPackageVersion", [POINTER(c_void_p), POINTER(c_void_p)])
-
-        # PileupEvent
-        
-        self.bind_sdk("PY_NGS_PileupEventGetMappingQuality",         [c_void_p, POINTER(c_int32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetAlignmentId",            [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetAlignmentPosition",      [c_void_p, POINTER(c_int64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetFirstAlignmentPosition", [c_void_p, POINTER(c_int64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetLastAlignmentPosition",  [c_void_p, POINTER(c_int64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetEventType",              [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetAlignmentBase",          [c_void_p, POINTER(c_char), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetAlignmentQuality",       [c_void_p, POINTER(c_char), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetInsertionBases",         [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetInsertionQualities",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetEventRepeatCount",       [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventGetEventIndelType",         [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
-
-        self.bind_sdk("PY_NGS_PileupEventIteratorNext",              [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupEventIteratorReset",             [c_void_p, POINTER(c_int), POINTER(c_void_p)])
+    def _load_latest_libraries(self):
+        """load the installed libraries, and in their place those that are out of date,
+        once downloaded; a library that isn't installed is downloaded
+        :returns: the mask of check_library_versions
+        """
+        self.c_lib_engine = load_library("ncbi-vdb", do_download=False, silent=True)
+        self.c_lib_sdk = load_library("ngs-sdk", do_download=False, silent=True)
         
-        # Pileup
+        check_vers_res = self.check_library_versions()
+        if check_vers_res & 1:
+            self._unbind("c_lib_engine")
+            self.c_lib_engine = load_library("ncbi-vdb", do_download=True, silent=False)
+        if check_vers_res & 2:
+            self._unbind("c_lib_sdk")
+            self.c_lib_sdk = load_library("ngs-sdk", do_download=True, silent=False)
+        return check_vers_res
 
-        self.bind_sdk("PY_NGS_PileupGetReferenceSpec",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupGetReferencePosition", [c_void_p, POINTER(c_int64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupGetReferenceBase",     [c_void_p, POINTER(c_char), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_PileupGetPileupDepth",       [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
+    def initialize_ngs_bindings(self):
+        if self.c_lib_engine and self.c_lib_sdk: # already initialized
+            return
 
-        self.bind_sdk("PY_NGS_PileupIteratorNext",         [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        
-        # ReadGroup
+        # online, the libraries are checked against the latest ones in this process;
+        # the functions are bound as they are first used, see __getattr__
+        if should_download_library():
+            self._load_latest_libraries()
+        else:
+            self.c_lib_engine = load_library("ncbi-vdb", do_download=False, silent=False)
+            self.c_lib_sdk = load_library("ngs-sdk", do_download=False, silent=False)
         
-        self.bind_sdk("PY_NGS_ReadGroupGetName",       [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGroupGetStatistics", [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
+        # C-level dispatch of the getters, when the optional extension is built
         
-        self.bind_sdk("PY_NGS_ReadGroupIteratorNext",  [c_void_p, POINTER(c_int), POINTER(c_void_p)])
+        try:
+            from . import _native
+            _native.init(ErrorMsg,
+                self.PY_NGS_StringGetData.address,
+                self.PY_NGS_StringGetSize.address,
+                self.PY_NGS_RefcountRelease.address,
+                self.PY_NGS_RawStringRelease.address)
+            self.native = _native
+        except ImportError:
+            self.native = None
 
-        # Read
+        # offline, the versions are only checked against the manifest
         
-        self.bind_sdk("PY_NGS_ReadGetReadId",        [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGetNumFragments",  [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadFragmentIsAligned",[c_void_p, c_uint32, POINTER(c_int32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGetReadCategory",  [c_void_p, POINTER(c_uint32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGetReadGroup",     [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGetReadName",      [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGetReadBases",     [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReadGetReadQualities", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-
-        self.bind_sdk("PY_NGS_ReadIteratorNext",     [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        
-        # Reference
-        
-        self.bind_sdk("PY_NGS_ReferenceGetCommonName",             [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetCanonicalName",          [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetIsCircular",             [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetLength",                 [c_void_p, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetReferenceBases",         [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetReferenceChunk",         [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetAlignment",              [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetAlignments",             [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetAlignmentSlice",         [c_void_p, c_int64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetFilteredAlignmentSlice", [c_void_p, c_int64, c_uint64, c_uint32, c_uint32, c_int32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetPileups",                [c_void_p, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetFilteredPileups",        [c_void_p, c_uint32, c_uint32, c_int32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetPileupSlice",            [c_void_p, c_int64, c_uint64, c_uint32, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceGetFilteredPileupSlice",    [c_void_p, c_int64, c_uint64, c_uint32, c_uint32, c_int32, POINTER(c_void_p), POINTER(c_void_p)])
-
-        self.bind_sdk("PY_NGS_ReferenceIteratorNext",              [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        
-        # ReferenceSequence
-        
-        self.bind_sdk("PY_NGS_ReferenceSequenceGetCanonicalName",  [c_void_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceSequenceGetIsCircular",     [c_void_p, POINTER(c_int), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceSequenceGetLength",         [c_void_p, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceSequenceGetReferenceBases", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_ReferenceSequenceGetReferenceChunk", [c_void_p, c_uint64, c_uint64, POINTER(c_void_p), POINTER(c_void_p)])
+        if is_offline():
+            from . import NGS
+            check_manifest_version("ncbi-vdb", NGS.getVersion_impl())
+            check_manifest_version("ngs-sdk", NGS.getPackageVersion_impl())
 
-        # Statistics
-        
-        self.bind_sdk("PY_NGS_StatisticsGetValueType", [c_void_p, c_char_p, POINTER(c_uint32), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_StatisticsGetAsString",  [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_StatisticsGetAsI64",     [c_void_p, c_char_p, POINTER(c_int64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_StatisticsGetAsU64",     [c_void_p, c_char_p, POINTER(c_uint64), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_StatisticsGetAsDouble",  [c_void_p, c_char_p, POINTER(c_double), POINTER(c_void_p)])
-        self.bind_sdk("PY_NGS_StatisticsGetNextPath",  [c_void_p, c_char_p, POINTER(c_void_p), POINTER(c_void_p)])
+_prototypes = {}
+for _name, _param_types_list in ENGINE_PROTOTYPES:
+    _prototypes[_name] = ("c_lib_engine", _param_types_list, None)
+for _name, _param_types_list in SDK_COMMON_PROTOTYPES:
+    _prototypes[_name] = ("c_lib_sdk", _param_types_list, None)
+for _name, _param_types_list in SDK_PROTOTYPES:
+    _prototypes[_name] = ("c_lib_sdk", _param_types_list, check_res_embedded)
@@ -0,0 +1,65 @@
+# ===========================================================================
+# 
+#                            PUBLIC DOMAIN NOTICE
+#               National Center for Biotechnology Information
+# 
+#  This software/database is a "United States Government Work" under the
+#  terms of the United States Copyright Act.  It was written as part of
+#  the author's official duties as a United States Government employee and
+#  thus cannot be copyrighted.  This software/database is freely available
+#  to the public for use. The National Library of Medicine and the U.S.
+#  Government have not placed any restriction on its use or reproduction.
+# 
+#  Although all reasonable efforts have been taken to ensure the accuracy
+#  and reliability of the software and data, the NLM and the U.S.
+#  Government do not and cannot warrant the performance or results that
+#  may be obtained by using this software or data. The NLM and the U.S.
+#  Government disclaim all warranties, express or implied, including
+#  warranties of performance, merchantability or fitness for any particular
+#  purpose.
+# 
+#  Please cite the author in any work or product based on this material.
+# 
+# ===========================================================================
+# 
+
+from ctypes import c_uint32
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+# The columns of the per-position base counts of Reference.getBaseCounts,
+# as in ngs::PileupBaseCounts
+
+class PileupBaseCounts:
+
+    baseA       = 0
+    baseC       = 1
+    baseG       = 2
+    baseT       = 3
+    baseN       = 4
+    deletion    = 5     # a skip included
+    insertion   = 6     # an insertion before the position
+
+    kinds       = 7
+
+    # the strands, on the second axis of counts taken byStrand
+    plus        = 0
+    minus       = 1
+
+
+def uint32Array(*shape):
+    """:returns: a zeroed ctypes uint32 buffer for an array of "shape",
+    with a view of it as a NumPy array when NumPy is available and as a
+    memoryview otherwise
+    """
+    size = 1
+    for dim in shape:
+        size *= dim
+    buf = (c_uint32 * size)()
+    if numpy is not None:
+        return buf, numpy.ctypeslib.as_array(buf).reshape(shape)
+    view = memoryview(buf).cast('B')
+    return buf, view.cast('I', shape) if size != 0 else view.cast('I')
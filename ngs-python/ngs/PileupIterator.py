@@ -38,4 +38,4 @@ class PileupIterator(Pileup):
         :returns: false if no more Pileups are available.
         :throws: ErrorMsg if more Pileups should be available, but could not be accessed.
         """
-        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_PileupIteratorNext, c_int))
\ No newline at end of file
+        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_PileupIteratorNext, c_int, release_gil=True))
\ No newline at end of file
@@ -27,7 +27,7 @@
 from ctypes import byref, c_uint32, c_int32
 from . import NGS
 
-from .String import NGS_String, NGS_RawString, getNGSString, getNGSValue
+from .String import NGS_String, NGS_RawString, getNGSString, getNGSValue, getNGSStringRange, getNGSBytes
 from .FragmentIterator import FragmentIterator
 
     # Read
@@ -84,16 +84,7 @@ class Read(FragmentIterator):
         :param: length must be >= 0
         :returns: sequence bases
         """
-        ngs_str_err = NGS_RawString()
-        try:
-            ngs_str_seq = NGS_String()
-            try:
-                res = NGS.lib_manager.PY_NGS_ReadGetReadBases(self.ref, offset, length, byref(ngs_str_seq.ref), byref(ngs_str_err.ref))
-                return ngs_str_seq.getPyString()
-            finally:
-                ngs_str_seq.close()
-        finally:
-            ngs_str_err.close()
+        return getNGSStringRange(self, NGS.lib_manager.PY_NGS_ReadGetReadBases, offset, length)
         
     def getReadQualities(self, offset=0, length=-1):
         """
@@ -101,13 +92,20 @@ class Read(FragmentIterator):
         :param: length must be >= 0
         :returns: phred quality values using ASCII offset of 33
         """
-        ngs_str_err = NGS_RawString()
-        try:
-            ngs_str_seq = NGS_String()
-            try:
-                res = NGS.lib_manager.PY_NGS_ReadGetReadQualities(self.ref, offset, length, byref(ngs_str_seq.ref), byref(ngs_str_err.ref))
-                return ngs_str_seq.getPyString()
-            finally:
-                ngs_str_seq.close()
-        finally:
-            ngs_str_err.close()
+        return getNGSStringRange(self, NGS.lib_manager.PY_NGS_ReadGetReadQualities, offset, length)
+
+    def getReadBasesBytes(self, offset=0, length=-1):
+        """getReadBases as bytes, saving the decode to str
+        :param: offset is zero-based and non-negative
+        :param: length must be >= 0
+        :returns: sequence bases
+        """
+        return getNGSBytes(self, NGS.lib_manager.PY_NGS_ReadGetReadBases, offset, length)
+
+    def getReadQualitiesBytes(self, offset=0, length=-1):
+        """getReadQualities as bytes, saving the decode to str
+        :param: offset is zero-based and non-negative
+        :param: length must be >= 0
+        :returns: phred quality values using ASCII offset of 33
+        """
+        return getNGSBytes(self, NGS.lib_manager.PY_NGS_ReadGetReadQualities, offset, length)
@@ -25,7 +25,7 @@
 # 
 
 
-from ctypes import c_void_p, c_uint64, byref, create_string_buffer, c_char_p, c_int
+from ctypes import c_void_p, c_uint64, c_uint32, byref, create_string_buffer, c_char_p, c_int
 from . import NGS
     
 from .Refcount import Refcount
@@ -39,6 +39,8 @@ from .Reference import Reference
 from .ReferenceIterator import ReferenceIterator
 from .Alignment import Alignment
 from .AlignmentIterator import AlignmentIterator
+from .Statistics import Statistics
+from .Batch import AlignmentBatch, ReadBatch
 
 class ReadCollection(Refcount):
     """Represents an NGS-capable object with a collection of
@@ -52,7 +54,26 @@ class ReadCollection(Refcount):
     not specifically assigned, Reads will be placed into the
     *default* ReadGroup.
     """
+
+    # Feature constants
+    readGroupsFeature       = 0x001 # getReadGroups, getReadGroup
+    referencesFeature       = 0x002 # getReferences, getReference
+    alignmentByIdFeature    = 0x004
+    alignmentsFeature       = 0x008
+    alignmentCountFeature   = 0x010
+    alignmentRangeFeature   = 0x020
+    alignmentShardFeature   = 0x040
+    readByIdFeature         = 0x080
+    readsFeature            = 0x100 # getReads, getReadCount, getReadRange
+
+    _spec = None # as given to openReadCollection
     
+    def getSpec(self):
+        """
+        :returns: the spec the collection was opened with, or None
+        """
+        return self._spec
+
     def getName(self):
         """Access the simple name of the ReadCollection.
         This name is generally extracted from the "spec"
@@ -215,6 +236,49 @@ class ReadCollection(Refcount):
 
         return ret
 
+    def getAlignmentShard(self, shard, count, categories=Alignment.all):
+        '''"shard" is 0-based and less than "count"; the shards don't overlap and
+        together cover every Alignment; the engine sizes them by the amount of
+        data to be read where it can. Requires alignmentShardFeature.
+        "categories" provides a means of filtering by AlignmentCategory
+        :returns: an iterator across one of "count" shards of the set
+        '''
+        ret = AlignmentIterator()
+        ngs_str_err = NGS_RawString()
+        try:
+            res = NGS.lib_manager.PY_NGS_ReadCollectionGetAlignmentShard(self.ref, shard, count, categories, byref(ret.ref), byref(ngs_str_err.ref))
+        finally:
+            ngs_str_err.close()
+
+        return ret
+
+    def planShards(self, shards=None, categories=Alignment.all, reference=None, start=0, length=None,
+                   filters=0, mappingQuality=0):
+        """
+        :returns: a list of picklable ShardSpecs covering the Alignments,
+            for workers to read with ReadCollection.openShard; see Shard.planShards
+        """
+        from .Shard import planShards
+        return planShards(self, shards, categories, reference, start, length, filters, mappingQuality)
+
+    @staticmethod
+    def openShard(spec):
+        """
+        :returns: an AlignmentIterator across the ShardSpec 'spec' from a
+            collection opened once per process; see Shard.openShard
+        """
+        from .Shard import openShard
+        return openShard(spec)
+
+    def alignments(self, categories=Alignment.all, fields=AlignmentBatch.recordFieldNames, batch_size=1024):
+        """Iterate over all Alignments from specified categories as namedtuples
+        of 'fields' taken from the engine batch_size at a time
+        :param: fields see AlignmentIterator.records
+        """
+        with self.getAlignments(categories) as it:
+            for record in it.records(fields, batch_size):
+                yield record
+
     #----------------------------------------------------------------------
     # READ
 
@@ -248,6 +312,15 @@ class ReadCollection(Refcount):
 
         return ret
 
+    def reads(self, categories=Read.all, fields=ReadBatch.recordFieldNames, batch_size=1024):
+        """Iterate over all Reads from specified categories as namedtuples
+        of 'fields' taken from the engine batch_size at a time
+        :param: fields see ReadIterator.records
+        """
+        with self.getReads(categories) as it:
+            for record in it.records(fields, batch_size):
+                yield record
+
     def getReadCount(self, categories=Read.all):
         """of all combined categories
         :returns: the number of reads in the collection
@@ -271,6 +344,25 @@ class ReadCollection(Refcount):
 
         return ret
 
+    def supports(self, feature):
+        """
+        :param: feature is one of the Feature constants
+        :returns: True if the engine answers the messages of "feature",
+            False if they would only raise ErrorMsg
+        """
+        features = getNGSValue(self, NGS.lib_manager.PY_NGS_ReadCollectionGetFeatures, c_uint32)
+        return (features & feature) == feature
+
+    def getStatistics(self):
+        """
+        :returns: counters the engine keeps about the collection, e.g. how
+            much of the underlying file has been read
+        :throws: ErrorMsg if the engine keeps none
+        """
+        ret = Statistics()
+        ret.ref = getNGSValue(self, NGS.lib_manager.PY_NGS_ReadCollectionGetStatistics, c_void_p)
+        return ret
+
 
 def openReadCollection(spec):
     """Create an object representing a named collection of reads
@@ -289,5 +381,6 @@ def openReadCollection(spec):
     res = NGS.lib_manager.PY_NGS_Engine_ReadCollectionMake(spec.encode("UTF-8"), byref(ret.ref), str_err, len(str_err))
     if res != PY_RES_OK:
         raise ErrorMsg(str_err.value)
+    ret._spec = spec
         
     return ret
@@ -29,6 +29,7 @@ from ctypes import c_int
 from . import NGS
 from .String import getNGSValue
 from .Read import Read
+from .Batch import ReadBatch
 
 # ReadIterator
 # iterates across a list of Reads
@@ -40,4 +41,43 @@ class ReadIterator(Read):
         :returns: false if no more Reads are available.
         :throws: ErrorMsg if more Reads should be available, but could not be accessed.
         """
-        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReadIteratorNext, c_int))
\ No newline at end of file
+        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReadIteratorNext, c_int, release_gil=True))
+
+    def nextBatch(self, n=1024, batch=None):
+        """Fill a batch with the columns of up to n of the next Reads,
+        in a single call into the engine
+        The iterator is left past the Reads placed in the batch,
+        so it is best not to mix this with nextRead.
+        :param n: the most Reads to take, limited by the batch capacity
+        :param batch: the ReadBatch to fill; by default one kept by the iterator
+        :returns: the batch, which is empty when no more Reads are available.
+        Its columns are views that the next call overwrites.
+        :throws: ErrorMsg if more Reads should be available, but could not be accessed.
+        """
+        if batch is None:
+            batch = getattr(self, "_batch", None)
+            if batch is None or batch.getCapacity() < n:
+                held = batch.c.state if batch is not None else 0
+                batch = self._batch = ReadBatch(capacity=n)
+                batch.c.state = held
+        batch._fill(NGS.lib_manager.PY_NGS_ReadIteratorNextBatch, self.ref, n)
+        return batch
+
+    def records(self, fields=ReadBatch.recordFieldNames, batch_size=1024):
+        """Iterate over the rest of the Reads as namedtuples of 'fields',
+        taking them from the engine batch_size at a time
+        String fields are str for ids and bytes for bases and qualities.
+        :param fields: names from ReadBatch.recordFields; only their columns are fetched
+        :param batch_size: the most Reads to take per call into the engine
+        :throws: ValueError if a field name is unknown
+        :throws: ErrorMsg if more Reads should be available, but could not be accessed.
+        """
+        record_type, mask = ReadBatch.recordPlan(fields)
+        batch = ReadBatch(mask, capacity=batch_size)
+        while self.nextBatch(batch_size, batch).size():
+            for record in batch.records(record_type):
+                yield record
+
+    def __iter__(self):
+        """the rest of the Reads, as records() of all fields"""
+        return self.records()
\ No newline at end of file
@@ -24,18 +24,31 @@
 # 
 # 
 
-from ctypes import byref, c_int, c_uint64
+from ctypes import byref, c_int, c_uint64, c_uint32
 from . import NGS
 from .Refcount import Refcount
+from .ErrorMsg import ErrorMsg
 from .String import NGS_RawString, NGS_String, getNGSString, getNGSValue
 
 from .Alignment import Alignment
 from .AlignmentIterator import AlignmentIterator
+from .Batch import AlignmentBatch
 from .PileupIterator import PileupIterator
+from .PileupBaseCounts import PileupBaseCounts, uint32Array
 
 # Represents a reference sequence
 
 class Reference(Refcount):
+
+    # Feature constants
+    canonicalNameFeature    = 0x01
+    circularityFeature      = 0x02 # getIsCircular
+    basesFeature            = 0x04 # getReferenceBases, getReferenceChunk
+    alignmentByIdFeature    = 0x08
+    alignmentsFeature       = 0x10 # whole, sliced and filtered
+    alignmentCountFeature   = 0x20
+    alignmentShardFeature   = 0x40
+    pileupsFeature          = 0x80 # whole, sliced and filtered
             
     def getCommonName(self):
         """
@@ -156,6 +169,24 @@ class Reference(Refcount):
 
         return ret
 
+    def alignments(self, start=None, length=None, categories=Alignment.all,
+                   fields=AlignmentBatch.recordFieldNames, batch_size=1024):
+        """Iterate over the Alignments of the Reference, or of a slice of it,
+        as namedtuples of 'fields' taken from the engine batch_size at a time
+        e.g. for aln in ref.alignments(start, length, fields=("pos", "mapq", "bases")):
+        :param: start, length select a slice as in getAlignmentSlice; None for all
+        :param: categories provides a means of filtering by AlignmentCategory
+        :param: fields see AlignmentIterator.records
+        :param: batch_size the most Alignments to take per call into the engine
+        """
+        if start is None and length is None:
+            it = self.getAlignments(categories)
+        else:
+            it = self.getAlignmentSlice(start or 0, self.getLength() if length is None else length, categories)
+        with it:
+            for record in it.records(fields, batch_size):
+                yield record
+
     # ----------------------------------------------------------------------
     # PILEUP
     
@@ -218,8 +249,79 @@ class Reference(Refcount):
             ngs_str_err.close()
         
         return ret
-    
-    
-    
-    
-    
+
+    def getBaseCounts(self, start, length, minQuality=0, categories=Alignment.all,
+                      filters=0, mappingQuality=0, byStrand=False):
+        """Counts the bases of each position of a window of the reference
+        in a single call into the engine, instead of walking its Pileups
+        and their events
+        :param: start is the 0-based starting position, not before the reference
+        :param: length is the length of the window, truncated to the end of the reference
+        :param: minQuality leaves out bases with a quality below it
+        :param: categories, filters, mappingQuality choose the alignments
+            as for getFilteredPileupSlice
+        :param: byStrand keeps the counts of the two strands apart
+        :returns: a uint32 array of [ length, PileupBaseCounts.kinds ] counts,
+            or [ length, 2, PileupBaseCounts.kinds ] byStrand, plus strand first;
+            a NumPy array when NumPy is available, a memoryview otherwise
+        :throws: ErrorMsg if the window starts before the reference
+        """
+        length = self._coverageWindow(start, length)
+        if byStrand:
+            buf, counts = uint32Array(length, 2, PileupBaseCounts.kinds)
+        else:
+            buf, counts = uint32Array(length, PileupBaseCounts.kinds)
+        if length == 0:
+            return counts
+        with self.getFilteredPileupSlice(start, length, categories, filters, mappingQuality) as it:
+            n = c_uint64()
+            ngs_str_err = NGS_RawString()
+            try:
+                res = NGS.lib_manager.PY_NGS_PileupGetBaseCounts(it.ref, minQuality, start, length, int(byStrand), buf, byref(n), byref(ngs_str_err.ref))
+            finally:
+                ngs_str_err.close()
+        return counts
+
+    # ----------------------------------------------------------------------
+    # COVERAGE
+
+    def getCoverage(self, start, length, categories=Alignment.all, filters=0, mappingQuality=0):
+        """The depth at each position of a window of the reference, as
+        getPileupDepth would give it, in a single call into the engine
+        :param: start is the 0-based starting position, not before the reference
+        :param: length is the length of the window, truncated to the end of the reference
+        :param: categories, filters, mappingQuality choose the alignments
+            as for getFilteredAlignmentSlice
+        :returns: a uint32 array of the depths; a NumPy array when NumPy
+            is available, a memoryview otherwise
+        :throws: ErrorMsg if the window starts before the reference
+        """
+        length = self._coverageWindow(start, length)
+        buf, depth = uint32Array(length)
+        if length == 0:
+            return depth
+        ngs_str_err = NGS_RawString()
+        try:
+            res = NGS.lib_manager.PY_NGS_ReferenceGetCoverage(self.ref, start, length, categories, filters, mappingQuality, buf, byref(ngs_str_err.ref))
+        finally:
+            ngs_str_err.close()
+        return depth
+
+    def _coverageWindow(self, start, length):
+        """:returns: the length of the window from start, truncated to the end of the reference"""
+        if start < 0:
+            raise ErrorMsg("the window starts before the reference")
+        end = self.getLength()
+        if start >= end:
+            return 0
+        return min(length, end - start)
+
+    def supports(self, feature):
+        """
+        :param: feature is one of the Feature constants
+        :returns: True if the engine answers the messages of "feature" for
+            this Reference, False if they would only raise ErrorMsg; an
+            iterator may answer differently from one Reference to the next
+        """
+        features = getNGSValue(self, NGS.lib_manager.PY_NGS_ReferenceGetFeatures, c_uint32)
+        return (features & feature) == feature
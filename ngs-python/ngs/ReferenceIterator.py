@@ -39,4 +39,4 @@ class ReferenceIterator(Reference):
         :returns: false if no more References are available.
         :throws: ErrorMsg if there is an error
         """
-        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReferenceIteratorNext, c_int))
\ No newline at end of file
+        return bool(getNGSValue(self, NGS.lib_manager.PY_NGS_ReferenceIteratorNext, c_int, release_gil=True))
\ No newline at end of file
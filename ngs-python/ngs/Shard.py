@@ -0,0 +1,167 @@
+# ===========================================================================
+# 
+#                            PUBLIC DOMAIN NOTICE
+#               National Center for Biotechnology Information
+# 
+#  This software/database is a "United States Government Work" under the
+#  terms of the United States Copyright Act.  It was written as part of
+#  the author's official duties as a United States Government employee and
+#  thus cannot be copyrighted.  This software/database is freely available
+#  to the public for use. The National Library of Medicine and the U.S.
+#  Government have not placed any restriction on its use or reproduction.
+# 
+#  Although all reasonable efforts have been taken to ensure the accuracy
+#  and reliability of the software and data, the NLM and the U.S.
+#  Government do not and cannot warrant the performance or results that
+#  may be obtained by using this software or data. The NLM and the U.S.
+#  Government disclaim all warranties, express or implied, including
+#  warranties of performance, merchantability or fitness for any particular
+#  purpose.
+# 
+#  Please cite the author in any work or product based on this material.
+# 
+# ===========================================================================
+# 
+# 
+
+
+"""Shards of the Alignments of a ReadCollection as plain, picklable values,
+for process-parallel work: a parent plans them with planShards() and
+hands them to multiprocessing or Dask workers, which read each with
+openShard() or shardRecords()
+
+A worker opens each collection once and keeps it for the shards after;
+the cache belongs to the process that filled it, so a forked worker
+opens its own rather than sharing its parent's engine objects.
+"""
+
+import os
+from collections import namedtuple
+
+from .Alignment import Alignment
+from .Batch import AlignmentBatch
+
+
+class ShardSpec(namedtuple("ShardSpec", "collection categories reference start length filters mappingQuality leading shard shards first count")):
+    """One shard, in whichever of three forms the planner chose
+
+    collection      the spec the ReadCollection was opened with
+    categories      of AlignmentCategory
+    reference       with start, length, filters and mappingQuality:
+                    a slice of a Reference, as getFilteredAlignmentSlice;
+                    the slice iterator also returns Alignments that start before
+                    "start", which belong to the slice before unless "leading"
+    shard, shards   one of the engine's shards, as getAlignmentShard
+    first, count    a range of Alignment rows, as getAlignmentRange
+    """
+    __slots__ = ()
+
+    def owns(self, position):
+        """:returns: whether an Alignment at "position" belongs to this shard
+        rather than to the slice before it
+        """
+        return self.reference is None or self.leading or position >= self.start
+
+ShardSpec.__new__.__defaults__ = (Alignment.all, None, 0, 0, 0, 0, True, None, None, None, None)
+
+
+_cache = {}
+_cachePid = None
+
+def _collection(spec):
+    """the ReadCollection for 'spec', opened once per process"""
+    global _cachePid
+    if _cachePid != os.getpid():
+        _cache.clear() # the cache of the parent of a forked process is not ours to use
+        _cachePid = os.getpid()
+    rc = _cache.get(spec)
+    if rc is None:
+        from .ReadCollection import openReadCollection
+        rc = _cache[spec] = openReadCollection(spec)
+    return rc
+
+
+def planShards(rc, shards=None, categories=Alignment.all, reference=None, start=0, length=None,
+               filters=0, mappingQuality=0):
+    """Split the Alignments of 'rc', or of a slice of one of its References,
+    into ShardSpecs for separate processes
+
+    A slice is split by position. Otherwise the engine's own shards are used
+    where the engine has them, and ranges of rows where it can count them.
+    :param: rc an open ReadCollection or the spec to open one with
+    :param: shards how many to plan; by default four per processor
+    :param: reference, start, length a slice to split, as getAlignmentSlice;
+        a length of None runs to the end of the Reference
+    :param: filters, mappingQuality as getFilteredAlignmentSlice, for slices
+    :returns: a list of ShardSpec, which together cover every Alignment once
+    """
+    if isinstance(rc, str):
+        rc = _collection(rc)
+    spec = rc.getSpec()
+    if spec is None:
+        raise ValueError("the ReadCollection was not opened with openReadCollection, so has no spec to plan with")
+    if shards is None:
+        shards = (os.cpu_count() or 1) * 4
+    shards = max(1, shards)
+
+    if reference is not None:
+        if length is None:
+            with rc.getReference(reference) as ref:
+                length = ref.getLength() - start
+        step = max(1, -(-length // shards))
+        return [ShardSpec(spec, categories, reference=reference, start=s, length=min(step, start + length - s),
+                          filters=filters, mappingQuality=mappingQuality, leading=(s == start))
+                for s in range(start, start + length, step)] or \
+               [ShardSpec(spec, categories, reference=reference, start=start, length=0,
+                          filters=filters, mappingQuality=mappingQuality)]
+
+    from .ReadCollection import ReadCollection
+    if rc.supports(ReadCollection.alignmentShardFeature):
+        return [ShardSpec(spec, categories, shard=i, shards=shards) for i in range(shards)]
+
+    if rc.supports(ReadCollection.alignmentCountFeature | ReadCollection.alignmentRangeFeature):
+        total = rc.getAlignmentCount(categories)
+        step = max(1, -(-total // shards))
+        return [ShardSpec(spec, categories, first=f, count=min(step, total - f)) for f in range(0, total, step)]
+
+    return [ShardSpec(spec, categories, shard=0, shards=1)]
+
+
+def openShard(spec):
+    """:returns: an AlignmentIterator across the shard 'spec', in a collection
+    this process has opened once; slice shards may begin with Alignments
+    that spec.owns() says belong to the shard before
+    """
+    rc = _collection(spec.collection)
+    if spec.reference is not None:
+        with rc.getReference(spec.reference) as ref:
+            if spec.filters:
+                return ref.getFilteredAlignmentSlice(spec.start, spec.length, spec.categories,
+                                                     spec.filters, spec.mappingQuality)
+            return ref.getAlignmentSlice(spec.start, spec.length, spec.categories)
+    if spec.first is not None:
+        return rc.getAlignmentRange(spec.first, spec.count, spec.categories)
+    if spec.shards == 1:
+        return rc.getAlignments(spec.categories)
+    return rc.getAlignmentShard(spec.shard, spec.shards, spec.categories)
+
+
+def shardRecords(spec, fields=AlignmentBatch.recordFieldNames, batch_size=1024):
+    """Iterate over the Alignments that belong to the shard 'spec' as records,
+    as AlignmentIterator.records does, leaving out those of the shard before
+    """
+    fields = tuple(fields)
+    if spec.reference is None or spec.leading:
+        with openShard(spec) as it:
+            for record in it.records(fields, batch_size):
+                yield record
+        return
+
+    # the position is needed to tell whose an Alignment is
+    wanted = fields if "pos" in fields else fields + ("pos",)
+    record_type = AlignmentBatch.recordPlan(fields)[0]
+    pos = wanted.index("pos")
+    with openShard(spec) as it:
+        for record in it.records(wanted, batch_size):
+            if spec.owns(record[pos]):
+                yield record if wanted is fields else record_type._make(record[:len(fields)])
@@ -76,6 +76,14 @@ class NGS_String:
             ret = ret.decode(encoding='UTF-8')        
         return ret
 
+    def getPyBytes(self):
+        """returns python bytes object with a single copy of the StringItf data, without decoding"""
+        size = self.getSize()
+        if size == 0:
+            return b''
+        NGS.lib_manager.PY_NGS_StringGetData(self.ref, byref(self.data))
+        return string_at(cast(self.data, c_void_p).value, size)
+
 
 class NGS_RawString:
     """object to work with raw string (char*) objects imported from ngs-sdk
@@ -126,6 +134,14 @@ class NGS_RawString:
         return ret
 
 
+def _native_ref(ref):
+    """the address of an NGS-object's reference for the _native extension: a c_void_p,
+    or the int ( or None ) that getNGSValue ( ..., c_void_p ) returns, as the getters
+    of iterators and statistics keep it
+    """
+    return ref.value if isinstance(ref, c_void_p) else ref
+
+
 def getNGSString(self, py_func):
     """Getter that returns a string-attribute for a given NGS-object (Read, Fragment, Alignment etc.)
     
@@ -136,6 +152,9 @@ def getNGSString(self, py_func):
     
     :remarks: NGS_String object is automatically released after this function returns
     """
+    native = NGS.lib_manager.native
+    if native is not None:
+        return native.get_string(py_func.address, _native_ref(self.ref))
     ngs_str_err = NGS_RawString()
     try:
         ngs_str_seq = NGS_String()
@@ -148,16 +167,72 @@ def getNGSString(self, py_func):
     finally:
         ngs_str_err.close()
 
+
+def getNGSStringRange(self, py_func, offset, length):
+    """Getter that returns bases or qualities of a given NGS-object as str
+    
+    :param self: python class representing NGS-object (like Read or Fragment)
+    :param py_func: PY-function taking offset and length, returning NGS_String
+    :returns: python str object
+    :throws: ErrorMsg
+    
+    :remarks: NGS_String object is automatically released after this function returns
+    """
+    native = NGS.lib_manager.native
+    if native is not None:
+        return native.get_string_range(py_func.address, _native_ref(self.ref), offset, length)
+    ngs_str_err = NGS_RawString()
+    try:
+        ngs_str_seq = NGS_String()
+        try:
+            res = py_func(self.ref, offset, length, byref(ngs_str_seq.ref), byref(ngs_str_err.ref))
+            return ngs_str_seq.getPyString()
+        finally:
+            ngs_str_seq.close()
+    finally:
+        ngs_str_err.close()
+
+
+def getNGSBytes(self, py_func, offset, length):
+    """Getter that returns bases or qualities of a given NGS-object as bytes
+    
+    :param self: python class representing NGS-object (like Read or Fragment)
+    :param py_func: PY-function taking offset and length, returning NGS_String
+    :returns: python bytes object, not decoded
+    :throws: ErrorMsg
+    
+    :remarks: NGS_String object is automatically released after this function returns
+    """
+    native = NGS.lib_manager.native
+    if native is not None:
+        return native.get_string_range(py_func.address, _native_ref(self.ref), offset, length, 1)
+    ngs_str_err = NGS_RawString()
+    try:
+        ngs_str_seq = NGS_String()
+        try:
+            res = py_func(self.ref, offset, length, byref(ngs_str_seq.ref), byref(ngs_str_err.ref))
+            return ngs_str_seq.getPyBytes()
+        finally:
+            ngs_str_seq.close()
+    finally:
+        ngs_str_err.close()
+
         
-def getNGSValue(self, py_func, value_type):
+def getNGSValue(self, py_func, value_type, release_gil=False):
     """Getter that returns a typed attribute for a given NGS-object (Read, Fragment, Alignment etc.)
     
     :param self: python class representing NGS-object (like Read or Fragment)
     :param py_func: PY-function returning a typed object for a given NGS-object
     :param value_type: c_type of the object to query from 'self'
+    :param release_gil: the call may block, as iterator advances that fetch data do;
+                        calls through ctypes always drop the GIL, the _native extension
+                        only when asked to, since it costs more than a plain getter
     :returns: python str object
     :throws: ErrorMsg
     """
+    native = NGS.lib_manager.native
+    if native is not None:
+        return native.get_value(py_func.address, _native_ref(self.ref), value_type._type_, release_gil)
     ret = value_type()
     ngs_str_err = NGS_RawString()
     try:
@@ -48,7 +48,7 @@ class NGS:
             
     @staticmethod
     def getVersion_impl():
-        if NGS.lib_manager.PY_NGS_Engine_GetVersion is None:
+        if getattr(NGS.lib_manager, "PY_NGS_Engine_GetVersion", None) is None: # an old engine
             return "0"
 
         from .String import NGS_RawString
@@ -113,6 +113,15 @@ class NGS:
         from .ReferenceSequence import openReferenceSequence  # entry point - adding name to ngs package global namespace
         return openReferenceSequence(spec)
         
+    @staticmethod
+    def updateLibraries():
+        """Download ncbi-vdb and ngs-sdk libraries newer than the installed ones
+        This is the remote check made when starting with NGS_PY_OFFLINE unset;
+        call it before any other NGS function, e.g. from a separate setup step.
+        :returns: a mask of the libraries updated: 1 for ncbi-vdb, 2 for ngs-sdk
+        """
+        return NGS.lib_manager.update_libraries()
+
     @staticmethod
     def checkLibVersions():
         from . LibChecker import check_versions
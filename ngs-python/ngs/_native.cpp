@@ -0,0 +1,268 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* _native.cpp
+ *  optional CPython extension for the ngs package
+ *
+ *  the PY_NGS_* entry points are still found and loaded by LibManager;
+ *  their addresses are handed to this module, which calls them directly
+ *  and builds the python result, instead of marshalling every call
+ *  through ctypes. when the module isn't built, ngs falls back to ctypes.
+ */
+
+#include <Python.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PY_RES_OK 0
+
+typedef int ( * GetDataFn ) ( void * pRef, char const ** pRet );
+typedef int ( * GetSizeFn ) ( void * pRef, size_t * pRet );
+typedef int ( * ReleaseFn ) ( void * pRef, void ** ppNGSStrError );
+
+typedef int ( * StringFn ) ( void * pRef, void ** ppNGSStringBuf, void ** ppNGSStrError );
+typedef int ( * StringRangeFn ) ( void * pRef, uint64_t offset, uint64_t length, void ** ppNGSStringBuf, void ** ppNGSStrError );
+typedef int ( * ValueFn ) ( void * pRef, void * pRet, void ** ppNGSStrError );
+
+static GetDataFn string_get_data;
+static GetSizeFn string_get_size;
+static ReleaseFn refcount_release;
+static ReleaseFn raw_string_release;
+static PyObject * error_msg_type;
+
+static
+void * FuncAddr ( PyObject * addr )
+{
+    void * ret = PyLong_AsVoidPtr ( addr );
+    if ( ret == NULL && ! PyErr_Occurred () )
+        PyErr_SetString ( PyExc_ValueError, "NULL function address" );
+    return ret;
+}
+
+static
+int RefAddr ( PyObject * ref, void ** pRet )
+{
+    if ( ref == Py_None )
+    {
+        * pRet = NULL;
+        return 0;
+    }
+    * pRet = PyLong_AsVoidPtr ( ref );
+    return * pRet == NULL && PyErr_Occurred () ? -1 : 0;
+}
+
+/* raise ErrorMsg from the error string of a failed call, releasing it */
+static
+PyObject * RaiseError ( void * err )
+{
+    if ( err == NULL )
+        PyErr_SetString ( error_msg_type, "INTERNAL ERROR" );
+    else
+    {
+        PyErr_SetString ( error_msg_type, ( char const * ) err );
+        void * ignored = NULL;
+        ( * raw_string_release ) ( err, & ignored );
+    }
+    return NULL;
+}
+
+/* turn a StringItf into str or bytes, releasing it */
+static
+PyObject * TakeString ( void * str, int as_bytes )
+{
+    char const * data = NULL;
+    size_t size = 0;
+    PyObject * ret;
+
+    if ( str != NULL )
+    {
+        ( * string_get_data ) ( str, & data );
+        ( * string_get_size ) ( str, & size );
+    }
+
+    if ( as_bytes )
+        ret = PyBytes_FromStringAndSize ( data, size );
+    else
+        ret = PyUnicode_DecodeUTF8 ( data, size, NULL );
+
+    if ( str != NULL )
+    {
+        void * ignored = NULL;
+        ( * refcount_release ) ( str, & ignored );
+    }
+
+    return ret;
+}
+
+/* init ( ErrorMsg, StringGetData, StringGetSize, RefcountRelease, RawStringRelease ) */
+static
+PyObject * native_init ( PyObject * self, PyObject * args )
+{
+    PyObject * err_type, * get_data, * get_size, * release, * raw_release;
+    if ( ! PyArg_ParseTuple ( args, "OOOOO", & err_type, & get_data, & get_size, & release, & raw_release ) )
+        return NULL;
+
+    string_get_data = ( GetDataFn ) FuncAddr ( get_data );
+    string_get_size = ( GetSizeFn ) FuncAddr ( get_size );
+    refcount_release = ( ReleaseFn ) FuncAddr ( release );
+    raw_string_release = ( ReleaseFn ) FuncAddr ( raw_release );
+    if ( PyErr_Occurred () )
+        return NULL;
+
+    Py_XDECREF ( error_msg_type );
+    Py_INCREF ( err_type );
+    error_msg_type = err_type;
+
+    Py_RETURN_NONE;
+}
+
+/* get_string ( func, ref ) -> str */
+static
+PyObject * native_get_string ( PyObject * self, PyObject * args )
+{
+    PyObject * func, * ref;
+    void * pRef;
+    if ( ! PyArg_ParseTuple ( args, "OO", & func, & ref ) )
+        return NULL;
+
+    StringFn fn = ( StringFn ) FuncAddr ( func );
+    if ( fn == NULL || RefAddr ( ref, & pRef ) != 0 )
+        return NULL;
+
+    void * str = NULL, * err = NULL;
+    if ( ( * fn ) ( pRef, & str, & err ) != PY_RES_OK )
+        return RaiseError ( err );
+
+    return TakeString ( str, 0 );
+}
+
+/* get_string_range ( func, ref, offset, length, as_bytes ) -> str or bytes */
+static
+PyObject * native_get_string_range ( PyObject * self, PyObject * args )
+{
+    PyObject * func, * ref;
+    unsigned long long offset, length;
+    int as_bytes = 0;
+    void * pRef;
+    if ( ! PyArg_ParseTuple ( args, "OOKK|i", & func, & ref, & offset, & length, & as_bytes ) )
+        return NULL;
+
+    StringRangeFn fn = ( StringRangeFn ) FuncAddr ( func );
+    if ( fn == NULL || RefAddr ( ref, & pRef ) != 0 )
+        return NULL;
+
+    void * str = NULL, * err = NULL;
+    if ( ( * fn ) ( pRef, offset, length, & str, & err ) != PY_RES_OK )
+        return RaiseError ( err );
+
+    return TakeString ( str, as_bytes );
+}
+
+/* get_value ( func, ref, code [, release_gil ] ) -> int, bytes or None
+ *  "code" is the ctypes _type_ of the value returned through the pointer;
+ *  for 'P', a reference, None stands for NULL as with c_void_p.value
+ *  "release_gil" is for calls that may block, like iterator advances,
+ *  so other threads can run meanwhile as they do with ctypes calls */
+static
+PyObject * native_get_value ( PyObject * self, PyObject * args )
+{
+    PyObject * func, * ref;
+    int code;
+    int release_gil = 0;
+    void * pRef;
+    if ( ! PyArg_ParseTuple ( args, "OOC|p", & func, & ref, & code, & release_gil ) )
+        return NULL;
+
+    ValueFn fn = ( ValueFn ) FuncAddr ( func );
+    if ( fn == NULL || RefAddr ( ref, & pRef ) != 0 )
+        return NULL;
+
+    union
+    {
+        char c;
+        int i;
+        unsigned int I;
+        long l;
+        unsigned long L;
+        long long q;
+        unsigned long long Q;
+        void * p;
+    } val;
+    val . Q = 0;
+
+    void * err = NULL;
+    int res;
+    if ( release_gil )
+    {
+        Py_BEGIN_ALLOW_THREADS
+        res = ( * fn ) ( pRef, & val, & err );
+        Py_END_ALLOW_THREADS
+    }
+    else
+    {
+        res = ( * fn ) ( pRef, & val, & err );
+    }
+    if ( res != PY_RES_OK )
+        return RaiseError ( err );
+
+    switch ( code )
+    {
+    case 'c': return PyBytes_FromStringAndSize ( & val . c, 1 );
+    case 'i': return PyLong_FromLong ( val . i );
+    case 'I': return PyLong_FromUnsignedLong ( val . I );
+    case 'l': return PyLong_FromLong ( val . l );
+    case 'L': return PyLong_FromUnsignedLong ( val . L );
+    case 'q': return PyLong_FromLongLong ( val . q );
+    case 'Q': return PyLong_FromUnsignedLongLong ( val . Q );
+    case 'P':
+        if ( val . p == NULL )
+            Py_RETURN_NONE;
+        return PyLong_FromVoidPtr ( val . p );
+    }
+
+    PyErr_Format ( PyExc_ValueError, "unsupported value type '%c'", code );
+    return NULL;
+}
+
+static PyMethodDef native_methods [] =
+{
+    { "init", native_init, METH_VARARGS, "bind the string and refcount entry points" },
+    { "get_string", native_get_string, METH_VARARGS, "call a PY_NGS_* string getter" },
+    { "get_string_range", native_get_string_range, METH_VARARGS, "call a PY_NGS_* string getter taking offset and length" },
+    { "get_value", native_get_value, METH_VARARGS, "call a PY_NGS_* getter of a scalar" },
+    { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef native_module =
+{
+    PyModuleDef_HEAD_INIT, "_native", NULL, -1, native_methods, NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit__native ( void )
+{
+    return PyModule_Create ( & native_module );
+}
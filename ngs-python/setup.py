@@ -1,4 +1,4 @@
-from distutils.core import setup
+from distutils.core import setup, Extension
 import sys
 #import version
 
@@ -17,6 +17,8 @@ setup(name='ngs',
       author='sra-tools',
       author_email='sra-tools@ncbi.nlm.nih.gov',
       packages=['ngs'],
+      # C-level dispatch of the getters; ngs falls back to ctypes without it
+      ext_modules=[Extension('ngs._native', ['ngs/_native.cpp'], optional=True)],
       include_package_data=True,
       scripts=[],
       #test_suite="tests",
@@ -28,8 +28,13 @@
 #include <ngs/adapter/StringItf.hpp>
 #include <ngs/adapter/ErrorMsg.hpp>
 
+#include <ngs/itf/StringItf.h>
+
 #include "ErrBlock.hpp"
 
+#include <string.h>
+#include <vector>
+
 namespace ngs_adapt
 {
 
@@ -47,6 +52,274 @@ namespace ngs_adapt
         throw ErrorMsg ( "INTERNAL ERROR: nextFragment message on Alignment" );
     }
 
+    // the strings of the record being added, released when done with
+    struct BatchStrings
+    {
+        BatchStrings ()
+        {
+            for ( int i = 0; i < 4; ++ i )
+                str [ i ] = 0;
+        }
+
+        ~ BatchStrings ()
+        {
+            for ( int i = 0; i < 4; ++ i )
+            {
+                if ( str [ i ] != 0 )
+                    str [ i ] -> Release ();
+            }
+        }
+
+        uint32_t size () const
+        {
+            size_t total = 0;
+            for ( int i = 0; i < 4; ++ i )
+            {
+                if ( str [ i ] != 0 )
+                    total += str [ i ] -> size ();
+            }
+            return total < ~ ( uint32_t ) 0 ? ( uint32_t ) total : ~ ( uint32_t ) 0;
+        }
+
+        void Copy ( NGS_AlignmentBatch_v1 & batch, int i, NGS_AlignmentBatchString_v1 * dst ) const
+        {
+            if ( dst != 0 )
+            {
+                NGS_AlignmentBatchString_v1 & out = dst [ batch . count ];
+
+                out . offset = batch . arena_used;
+                out . size = str [ i ] ? ( uint32_t ) str [ i ] -> size () : 0;
+                if ( out . size != 0 )
+                    memcpy ( batch . arena + batch . arena_used, str [ i ] -> data (), out . size );
+                batch . arena_used += out . size;
+            }
+        }
+
+        StringItf * str [ 4 ];
+    };
+
+    // the packed operations of a long CIGAR, as BAM has them
+    static
+    void ParseCigar ( const char * cigar, size_t size, std :: vector < uint32_t > & ops )
+    {
+        static const char codes [] = "MIDNSHP=X";
+        uint32_t length = 0;
+        bool digits = false;
+        ops . clear ();
+        for ( size_t i = 0; i < size; ++ i )
+        {
+            if ( cigar [ i ] >= '0' && cigar [ i ] <= '9' )
+            {
+                length = length * 10 + ( cigar [ i ] - '0' );
+                digits = true;
+                continue;
+            }
+            const char * code = cigar [ i ] != 0 ? strchr ( codes, cigar [ i ] ) : 0;
+            if ( code == 0 || ! digits )
+                throw ErrorMsg ( "malformed CIGAR: '" + std :: string ( cigar, size ) + "'" );
+            ops . push_back ( ( length << 4 ) | ( uint32_t ) ( code - codes ) );
+            length = 0;
+            digits = false;
+        }
+        if ( digits )
+            throw ErrorMsg ( "malformed CIGAR: '" + std :: string ( cigar, size ) + "'" );
+    }
+
+    bool AlignmentItf :: nextAlignmentBatch ( NGS_AlignmentBatch_v1 & batch )
+    {
+        uint32_t const fields = batch . fields;
+        std :: vector < uint32_t > ops;
+
+        batch . count = 0;
+        batch . arena_used = 0;
+        if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0 )
+            batch . cigar_arena_used = 0;
+
+        while ( batch . count < batch . capacity && batch . state != NGS_AlignmentBatchState_end )
+        {
+            if ( batch . state == NGS_AlignmentBatchState_next )
+            {
+                if ( ! nextAlignment () )
+                {
+                    batch . state = NGS_AlignmentBatchState_end;
+                    break;
+                }
+                batch . state = NGS_AlignmentBatchState_held;
+            }
+
+            BatchStrings strings;
+            if ( ( fields & NGS_AlignmentBatchFields_ref_spec ) != 0 )
+                strings . str [ 0 ] = getReferenceSpec ();
+            if ( ( fields & NGS_AlignmentBatchFields_read_id ) != 0 )
+                strings . str [ 1 ] = getReadId ();
+            if ( ( fields & NGS_AlignmentBatchFields_bases ) != 0 )
+                strings . str [ 2 ] = getFragmentBases ( 0, -1 );
+            if ( ( fields & NGS_AlignmentBatchFields_qualities ) != 0 )
+                strings . str [ 3 ] = getFragmentQualities ( 0, -1 );
+
+            if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0 )
+            {
+                NGS_AlignmentCigar_v1 lent;
+                if ( getCigarOps ( lent ) )
+                    ops . assign ( lent . ops, lent . ops + lent . count );
+                else
+                {
+                    BatchStrings cigar;
+                    cigar . str [ 0 ] = getLongCigar ( false );
+                    ParseCigar ( cigar . str [ 0 ] -> data (), cigar . str [ 0 ] -> size (), ops );
+                }
+            }
+
+            // leave the record for the next batch if it doesn't fit in this one
+            if ( strings . size () > batch . arena_size - batch . arena_used )
+            {
+                if ( batch . count == 0 )
+                    throw ErrorMsg ( "alignment batch arena is too small for the next alignment" );
+                break;
+            }
+            if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0
+                 && ops . size () > batch . cigar_arena_size - batch . cigar_arena_used )
+            {
+                if ( batch . count == 0 )
+                    throw ErrorMsg ( "alignment batch CIGAR arena is too small for the next alignment" );
+                break;
+            }
+
+            uint32_t const i = batch . count;
+            if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0 )
+            {
+                NGS_AlignmentBatchString_v1 & out = batch . cigar [ i ];
+                out . offset = batch . cigar_arena_used;
+                out . size = ( uint32_t ) ops . size ();
+                if ( out . size != 0 )
+                    memcpy ( batch . cigar_arena + out . offset, & ops [ 0 ], out . size * sizeof ops [ 0 ] );
+                batch . cigar_arena_used += out . size;
+            }
+            if ( ( fields & NGS_AlignmentBatchFields_ref_index ) != 0 )
+                batch . ref_index [ i ] = getReferenceIndex ();
+            if ( ( fields & NGS_AlignmentBatchFields_position ) != 0 )
+            {
+                batch . position [ i ] = getAlignmentPosition ();
+                batch . length [ i ] = getAlignmentLength ();
+            }
+            if ( ( fields & NGS_AlignmentBatchFields_map_qual ) != 0 )
+                batch . map_qual [ i ] = getMappingQuality ();
+            if ( ( fields & NGS_AlignmentBatchFields_flags ) != 0 )
+            {
+                batch . flags [ i ]
+                    = ( isPrimary () ? NGS_AlignmentBatchFlags_primary : 0 )
+                    | ( getIsReversedOrientation () ? NGS_AlignmentBatchFlags_reversed : 0 )
+                    | ( hasMate () ? NGS_AlignmentBatchFlags_has_mate : 0 );
+            }
+            strings . Copy ( batch, 0, ( fields & NGS_AlignmentBatchFields_ref_spec ) ? batch . ref_spec : 0 );
+            strings . Copy ( batch, 1, ( fields & NGS_AlignmentBatchFields_read_id ) ? batch . read_id : 0 );
+            strings . Copy ( batch, 2, ( fields & NGS_AlignmentBatchFields_bases ) ? batch . bases : 0 );
+            strings . Copy ( batch, 3, ( fields & NGS_AlignmentBatchFields_qualities ) ? batch . qualities : 0 );
+
+            ++ batch . count;
+            batch . state = NGS_AlignmentBatchState_next;
+        }
+
+        return batch . count != 0;
+    }
+
+    StringItf * AlignmentItf :: getReferenceSpecView ( NGS_StringView_v1 & view ) const
+    {
+        StringItf * str = getReferenceSpec ();
+        view . data = str -> data ();
+        view . size = str -> size ();
+        return str;
+    }
+
+    StringItf * AlignmentItf :: getReadIdView ( NGS_StringView_v1 & view ) const
+    {
+        StringItf * str = getReadId ();
+        view . data = str -> data ();
+        view . size = str -> size ();
+        return str;
+    }
+
+    uint32_t AlignmentItf :: getSupportedMessages () const
+    {
+        return NGS_AlignmentMessage_all;
+    }
+
+    bool AlignmentItf :: getTag ( const char * tag, NGS_AlignmentTag_v1 & value ) const
+    {
+        return false;
+    }
+
+    bool AlignmentItf :: getCigarOps ( NGS_AlignmentCigar_v1 & cigar ) const
+    {
+        return false;
+    }
+
+    void AlignmentItf :: getCore ( NGS_AlignmentCore_v1 & core ) const
+    {
+        core . position = getAlignmentPosition ();
+        core . length = getAlignmentLength ();
+        core . template_len = getTemplateLength ();
+        core . map_qual = getMappingQuality ();
+        core . flags
+            = ( isPrimary () ? NGS_AlignmentBatchFlags_primary : 0 )
+            | ( getIsReversedOrientation () ? NGS_AlignmentBatchFlags_reversed : 0 )
+            | ( hasMate () ? NGS_AlignmentBatchFlags_has_mate : 0 );
+    }
+
+    bool AlignmentItf :: skipTo ( int64_t refPos )
+    {
+        while ( nextAlignment () )
+        {
+            if ( getAlignmentPosition () + ( int64_t ) getAlignmentLength () > refPos )
+                return true;
+        }
+        return false;
+    }
+
+    StringItf * AlignmentItf :: getCursor () const
+    {
+        throw ErrorMsg ( "this Alignment iterator cannot be resumed" );
+    }
+
+    void AlignmentItf :: resumeFrom ( const char * cursor )
+    {
+        throw ErrorMsg ( "this Alignment iterator cannot be resumed" );
+    }
+
+    int32_t AlignmentItf :: getReferenceIndex () const
+    {
+        throw ErrorMsg ( "this Alignment has no reference index" );
+    }
+
+    int32_t AlignmentItf :: getMateReferenceIndex () const
+    {
+        throw ErrorMsg ( "this Alignment has no reference index" );
+    }
+
+    void AlignmentItf :: reposition ( int64_t start, uint64_t length )
+    {
+        throw ErrorMsg ( "this Alignment iterator cannot be repositioned" );
+    }
+
+    uint32_t AlignmentItf :: getBatchFields () const
+    {
+        return NGS_AlignmentBatchFields_position | NGS_AlignmentBatchFields_map_qual
+            | NGS_AlignmentBatchFields_flags | NGS_AlignmentBatchFields_ref_spec
+            | NGS_AlignmentBatchFields_read_id | NGS_AlignmentBatchFields_bases
+            | NGS_AlignmentBatchFields_qualities | NGS_AlignmentBatchFields_ref_index
+            | NGS_AlignmentBatchFields_cigar;
+    }
+
+    bool AlignmentItf :: getMismatches ( NGS_AlignmentMismatches_v1 & mismatches ) const
+    {
+        return false;
+    }
+
+    bool AlignmentItf :: getReadFragment ( NGS_AlignmentReadFragment_v1 & fragment ) const
+    {
+        return false;
+    }
+
     NGS_String_v1 * CC AlignmentItf :: get_id ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err )
     {
         const AlignmentItf * self = Self ( iself );
@@ -116,7 +389,7 @@ namespace ngs_adapt
         try
         {
             StringItf * val = self -> getReadGroup ();
-            return val -> Cast ();
+            return val != 0 ? val -> Cast () : 0;
         }
         catch ( ... )
         {
@@ -363,7 +636,7 @@ namespace ngs_adapt
         try
         {
             StringItf * val = self -> getMateAlignmentId ();
-            return val -> Cast ();
+            return val != 0 ? val -> Cast () : 0;
         }
         catch ( ... )
         {
@@ -435,12 +708,249 @@ namespace ngs_adapt
         return false;
     }
 
+    bool CC AlignmentItf :: next_batch ( NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_AlignmentBatch_v1 * batch )
+    {
+        AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> nextAlignmentBatch ( * batch );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    NGS_String_v1 * CC AlignmentItf :: get_ref_spec_view ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_StringView_v1 * view )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            StringItf * val = self -> getReferenceSpecView ( * view );
+            return val != 0 ? val -> Cast () : 0;
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    NGS_String_v1 * CC AlignmentItf :: get_read_id_view ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_StringView_v1 * view )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            StringItf * val = self -> getReadIdView ( * view );
+            return val != 0 ? val -> Cast () : 0;
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    uint32_t CC AlignmentItf :: get_supported ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getSupportedMessages ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    bool CC AlignmentItf :: get_tag ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, const char * tag, NGS_AlignmentTag_v1 * value )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getTag ( tag, * value );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    bool CC AlignmentItf :: get_cigar_ops ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_AlignmentCigar_v1 * cigar )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getCigarOps ( * cigar );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    void CC AlignmentItf :: get_core ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_AlignmentCore_v1 * core )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            self -> getCore ( * core );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+    }
+
+    bool CC AlignmentItf :: skip_to ( NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, int64_t ref_pos )
+    {
+        AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> skipTo ( ref_pos );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    NGS_String_v1 * CC AlignmentItf :: get_cursor ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            StringItf * val = self -> getCursor ();
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    void CC AlignmentItf :: resume_from ( NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, const char * cursor )
+    {
+        AlignmentItf * self = Self ( iself );
+        try
+        {
+            self -> resumeFrom ( cursor );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+    }
+
+    int32_t CC AlignmentItf :: get_ref_index ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getReferenceIndex ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return -1;
+    }
+
+    int32_t CC AlignmentItf :: get_mate_ref_index ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getMateReferenceIndex ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return -1;
+    }
+
+    void CC AlignmentItf :: reposition ( NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length )
+    {
+        AlignmentItf * self = Self ( iself );
+        try
+        {
+            self -> reposition ( start, length );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+    }
+
+    uint32_t CC AlignmentItf :: get_batch_fields ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getBatchFields ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    bool CC AlignmentItf :: get_mismatches ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_AlignmentMismatches_v1 * mismatches )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getMismatches ( * mismatches );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    bool CC AlignmentItf :: get_read_fragment ( const NGS_Alignment_v1 * iself, NGS_ErrBlock_v1 * err, NGS_AlignmentReadFragment_v1 * fragment )
+    {
+        const AlignmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getReadFragment ( * fragment );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
     NGS_Alignment_v1_vt AlignmentItf :: ivt =
     {
         {
-            "ngs_adapt::AlignmentItf",
+            NGS_ADAPT_CLASS ( "AlignmentItf" ),
             "NGS_Alignment_v1",
-            1,
+            15,
             & FragmentItf :: ivt . dad
         },
 
@@ -473,7 +983,49 @@ namespace ngs_adapt
         get_rna_orientation,
 
         // v1.2
-        get_ref_pos_projection_range
+        get_ref_pos_projection_range,
+
+        // v1.3
+        next_batch,
+
+        // v1.4
+        get_ref_spec_view,
+        get_read_id_view,
+
+        // v1.5
+        get_supported,
+
+        // v1.6
+        get_tag,
+
+        // v1.7
+        get_cigar_ops,
+
+        // v1.8
+        get_core,
+
+        // v1.9
+        skip_to,
+
+        // v1.10
+        get_cursor,
+        resume_from,
+
+        // v1.11
+        get_ref_index,
+        get_mate_ref_index,
+
+        // v1.12
+        reposition,
+
+        // v1.13
+        get_batch_fields,
+
+        // v1.14
+        get_mismatches,
+
+        // v1.15
+        get_read_fragment
     };
 
 } // namespace ngs_adapt
@@ -37,14 +37,27 @@ namespace ngs_adapt
      *  sets state within "self" such that an exception is thrown
      *  upon return from dispatch
      */
+    /* SetMsg
+     *  copy just the message, not the 4K of padding strncpy would add
+     */
+    static
+    void ErrBlockSetMsg ( NGS_ErrBlock_v1 * self, const char * what )
+    {
+        size_t len = strlen ( what );
+        if ( len >= sizeof self -> msg )
+            len = sizeof self -> msg - 1;
+
+        memcpy ( self -> msg, what, len );
+        self -> msg [ len ] = 0;
+    }
+
     void ErrBlockThrow ( NGS_ErrBlock_v1 * self, uint32_t type, const ErrorMsg & x )
     {
         const char * what = x . what ();
         if ( what == 0 )
             what = "BAD ERROR MESSAGE";
 
-        strncpy ( self -> msg, what, sizeof self -> msg );
-        self -> msg [ sizeof self -> msg - 1 ] = 0;
+        ErrBlockSetMsg ( self, what );
 
         self -> xtype = type <= xt_runtime ? type : xt_runtime;
     }
@@ -55,8 +68,7 @@ namespace ngs_adapt
         if ( what == 0 )
             what = "BAD ERROR MESSAGE";
 
-        strncpy ( self -> msg, what, sizeof self -> msg );
-        self -> msg [ sizeof self -> msg - 1 ] = 0;
+        ErrBlockSetMsg ( self, what );
 
         self -> xtype = type <= xt_runtime ? type : xt_runtime;
     }
@@ -70,7 +82,7 @@ namespace ngs_adapt
      */
     void ErrBlockThrowUnknown ( NGS_ErrBlock_v1 * self )
     {
-        strncpy ( self -> msg, "unknown error", sizeof self -> msg );
+        ErrBlockSetMsg ( self, "unknown error" );
         self -> xtype = xt_runtime;
     }
 
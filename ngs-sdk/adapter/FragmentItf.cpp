@@ -28,6 +28,8 @@
 #include <ngs/adapter/StringItf.hpp>
 #include <ngs/adapter/ErrorMsg.hpp>
 
+#include <ngs/itf/StringItf.h>
+
 #include "ErrBlock.hpp"
 
 namespace ngs_adapt
@@ -42,6 +44,42 @@ namespace ngs_adapt
     {
     }
 
+    bool FragmentItf :: isPaired () const
+    {
+        throw ErrorMsg ( "isPaired is not implemented by this engine" );
+    }
+
+    bool FragmentItf :: isAligned () const
+    {
+        throw ErrorMsg ( "isAligned is not implemented by this engine" );
+    }
+
+    StringItf * FragmentItf :: getFragmentBasesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+    {
+        StringItf * str = getFragmentBases ( offset, length );
+        view . data = str -> data ();
+        view . size = str -> size ();
+        return str;
+    }
+
+    StringItf * FragmentItf :: getFragmentQualitiesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+    {
+        StringItf * str = getFragmentQualities ( offset, length );
+        view . data = str -> data ();
+        view . size = str -> size ();
+        return str;
+    }
+
+    bool FragmentItf :: getFragmentBasesPacked ( uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 & packed ) const
+    {
+        return false;
+    }
+
+    uint32_t FragmentItf :: getFragmentIndex () const
+    {
+        throw ErrorMsg ( "getFragmentIndex is not implemented by this engine" );
+    }
+
     NGS_String_v1 * CC FragmentItf :: get_id ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err )
     {
         const FragmentItf * self = Self ( iself );
@@ -107,19 +145,129 @@ namespace ngs_adapt
         return false;
     }
 
+    bool CC FragmentItf :: is_paired ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const FragmentItf * self = Self ( iself );
+        try
+        {
+            return self -> isPaired ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    bool CC FragmentItf :: is_aligned ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const FragmentItf * self = Self ( iself );
+        try
+        {
+            return self -> isAligned ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    NGS_String_v1 * CC FragmentItf :: get_bases_view ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, NGS_StringView_v1 * view )
+    {
+        const FragmentItf * self = Self ( iself );
+        try
+        {
+            StringItf * val = self -> getFragmentBasesView ( offset, length, * view );
+            return val != 0 ? val -> Cast () : 0;
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    NGS_String_v1 * CC FragmentItf :: get_quals_view ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, NGS_StringView_v1 * view )
+    {
+        const FragmentItf * self = Self ( iself );
+        try
+        {
+            StringItf * val = self -> getFragmentQualitiesView ( offset, length, * view );
+            return val != 0 ? val -> Cast () : 0;
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    bool CC FragmentItf :: get_packed_bases ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 * packed )
+    {
+        const FragmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getFragmentBasesPacked ( offset, length, * packed );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    uint32_t CC FragmentItf :: get_frag_index ( const NGS_Fragment_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const FragmentItf * self = Self ( iself );
+        try
+        {
+            return self -> getFragmentIndex ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
     NGS_Fragment_v1_vt FragmentItf :: ivt =
     {
         {
-            "ngs_adapt::FragmentItf",
+            NGS_ADAPT_CLASS ( "FragmentItf" ),
             "NGS_Fragment_v1",
-            0,
+            4,
             & OpaqueRefcount :: ivt . dad
         },
 
+        // v1.0
         get_id,
         get_bases,
         get_quals,
-        next
+        next,
+
+        // v1.1
+        is_paired,
+        is_aligned,
+
+        // v1.2
+        get_bases_view,
+        get_quals_view,
+
+        // v1.3
+        get_packed_bases,
+
+        // v1.4
+        get_frag_index
     };
 
 } // namespace ngs_adapt
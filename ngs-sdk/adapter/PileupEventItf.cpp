@@ -43,6 +43,16 @@ namespace ngs_adapt
     {
     }
 
+    int32_t PileupEventItf :: getReferenceIndex () const
+    {
+        throw ErrorMsg ( "this PileupEvent has no reference index" );
+    }
+
+    int32_t PileupEventItf :: getMateReferenceIndex () const
+    {
+        throw ErrorMsg ( "this PileupEvent has no reference index" );
+    }
+
     int32_t CC PileupEventItf :: get_map_qual ( const NGS_PileupEvent_v1 * iself, NGS_ErrBlock_v1 * err )
     {
         const PileupEventItf * self = Self ( iself );
@@ -254,15 +264,46 @@ namespace ngs_adapt
         }
     }
 
+    int32_t PileupEventItf :: get_ref_index ( const NGS_PileupEvent_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const PileupEventItf * self = Self ( iself );
+        try
+        {
+            return self -> getReferenceIndex ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return -1;
+    }
+
+    int32_t PileupEventItf :: get_mate_ref_index ( const NGS_PileupEvent_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const PileupEventItf * self = Self ( iself );
+        try
+        {
+            return self -> getMateReferenceIndex ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return -1;
+    }
+
     NGS_PileupEvent_v1_vt PileupEventItf :: ivt =
     {
         {
-            "ngs_adapt::PileupEventItf",
+            NGS_ADAPT_CLASS ( "PileupEventItf" ),
             "NGS_PileupEvent_v1",
-            0,
+            1,
             & OpaqueRefcount :: ivt . dad
         },
 
+        // v1.0
         get_map_qual,
         get_align_id,
         get_align_pos,
@@ -276,7 +317,11 @@ namespace ngs_adapt
         get_rpt_count,
         get_indel_type,
         next,
-        reset
+        reset,
+
+        // v1.1
+        get_ref_index,
+        get_mate_ref_index
     };
 
 } // namespace ngs_adapt
@@ -31,6 +31,8 @@
 
 #include "ErrBlock.hpp"
 
+#include <string.h>
+
 namespace ngs_adapt
 {
 
@@ -43,6 +45,122 @@ namespace ngs_adapt
     {
     }
 
+    // copies an insertion into the arena if there is room, measuring it anyway
+    static
+    void ColumnString ( NGS_PileupColumn_v1 & column, uint32_t i, NGS_PileupColumnString_v1 * dst, StringItf * str )
+    {
+        uint32_t const size = str != 0 ? ( uint32_t ) str -> size () : 0;
+        if ( i < column . capacity )
+        {
+            dst [ i ] . offset = column . arena_used;
+            dst [ i ] . size = size;
+            if ( size != 0 && column . arena_used <= column . arena_size && size <= column . arena_size - column . arena_used )
+                memcpy ( column . arena + column . arena_used, str -> data (), size );
+        }
+        column . arena_used += size;
+        if ( str != 0 )
+            str -> Release ();
+    }
+
+    bool PileupItf :: getColumn ( NGS_PileupColumn_v1 & column )
+    {
+        uint32_t const fields = column . fields;
+        uint32_t const insertions = NGS_PileupColumnFields_ins_bases | NGS_PileupColumnFields_ins_quals;
+
+        column . count = 0;
+        column . arena_used = 0;
+
+        resetPileupEvent ();
+        while ( nextPileupEvent () )
+        {
+            uint32_t const i = column . count ++;
+            bool const fits = i < column . capacity;
+
+            // past the room there is, only the insertions are still measured
+            if ( ! fits && ( fields & insertions ) == 0 )
+                continue;
+
+            if ( fits )
+            {
+                if ( ( fields & NGS_PileupColumnFields_event_type ) != 0 )
+                    column . event_type [ i ] = getEventType ();
+                if ( ( fields & NGS_PileupColumnFields_base ) != 0 )
+                    column . base [ i ] = getAlignmentBase ();
+                if ( ( fields & NGS_PileupColumnFields_qual ) != 0 )
+                    column . qual [ i ] = getAlignmentQuality ();
+                if ( ( fields & NGS_PileupColumnFields_map_qual ) != 0 )
+                    column . map_qual [ i ] = getMappingQuality ();
+            }
+
+            if ( ( fields & NGS_PileupColumnFields_ins_bases ) != 0 )
+                ColumnString ( column, i, column . ins_bases, getInsertionBases () );
+            if ( ( fields & NGS_PileupColumnFields_ins_quals ) != 0 )
+                ColumnString ( column, i, column . ins_quals, getInsertionQualities () );
+        }
+        resetPileupEvent ();
+
+        return column . count <= column . capacity && column . arena_used <= column . arena_size;
+    }
+
+    // the bits of ngs :: PileupEvent :: PileupEventType that are counted
+    static const uint32_t EVENT_KIND = 0x07;
+    static const uint32_t EVENT_DELETION = 0x02;
+    static const uint32_t EVENT_INSERTION = 0x08;
+    static const uint32_t EVENT_MINUS_STRAND = 0x20;
+
+    static
+    uint32_t BaseCountKind ( char base )
+    {
+        switch ( base )
+        {
+        case 'A': case 'a':
+            return NGS_PileupBaseCount_A;
+        case 'C': case 'c':
+            return NGS_PileupBaseCount_C;
+        case 'G': case 'g':
+            return NGS_PileupBaseCount_G;
+        case 'T': case 't':
+            return NGS_PileupBaseCount_T;
+        }
+        return NGS_PileupBaseCount_N;
+    }
+
+    uint32_t PileupItf :: getBaseCounts ( int32_t min_qual, uint32_t count, NGS_PileupBaseCounts_v1 * counts )
+    {
+        uint32_t i = 0;
+        for ( ; i < count; ++ i )
+        {
+            if ( i != 0 && ! nextPileup () )
+                break;
+
+            NGS_PileupBaseCounts_v1 & c = counts [ i ];
+            c . position = getReferencePosition ();
+            memset ( c . plus, 0, sizeof c . plus );
+            memset ( c . minus, 0, sizeof c . minus );
+
+            resetPileupEvent ();
+            while ( nextPileupEvent () )
+            {
+                uint32_t const type = getEventType ();
+                uint32_t * const n = ( type & EVENT_MINUS_STRAND ) != 0 ? c . minus : c . plus;
+
+                if ( ( type & EVENT_INSERTION ) != 0 )
+                    ++ n [ NGS_PileupBaseCount_insertion ];
+                if ( ( type & EVENT_KIND ) == EVENT_DELETION )
+                    ++ n [ NGS_PileupBaseCount_deletion ];
+                else if ( getAlignmentQuality () - 33 >= min_qual )
+                    ++ n [ BaseCountKind ( getAlignmentBase () ) ];
+            }
+            resetPileupEvent ();
+        }
+        return i;
+    }
+
+    void PileupItf :: extendTo ( int64_t newEnd )
+    {
+        throw ErrorMsg ( "this Pileup iterator cannot be extended" );
+    }
+
     NGS_String_v1 * CC PileupItf :: get_ref_spec ( const NGS_Pileup_v1 * iself, NGS_ErrBlock_v1 * err )
     {
         const PileupItf * self = Self ( iself );
@@ -119,20 +237,73 @@ namespace ngs_adapt
         return false;
     }
 
+    bool CC PileupItf :: get_column ( NGS_Pileup_v1 * iself, NGS_ErrBlock_v1 * err, NGS_PileupColumn_v1 * column )
+    {
+        PileupItf * self = Self ( iself );
+        try
+        {
+            return self -> getColumn ( * column );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    uint32_t CC PileupItf :: get_base_counts ( NGS_Pileup_v1 * iself, NGS_ErrBlock_v1 * err, int32_t min_qual, uint32_t count, NGS_PileupBaseCounts_v1 * counts )
+    {
+        PileupItf * self = Self ( iself );
+        try
+        {
+            return self -> getBaseCounts ( min_qual, count, counts );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    void CC PileupItf :: extend_to ( NGS_Pileup_v1 * iself, NGS_ErrBlock_v1 * err, int64_t new_end )
+    {
+        PileupItf * self = Self ( iself );
+        try
+        {
+            self -> extendTo ( new_end );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+    }
+
     NGS_Pileup_v1_vt PileupItf :: ivt =
     {
         {
-            "ngs_adapt::PileupItf",
+            NGS_ADAPT_CLASS ( "PileupItf" ),
             "NGS_Pileup_v1",
-            0,
+            3,
             & PileupEventItf :: ivt . dad
         },
 
+        // v1.0
         get_ref_spec,
         get_ref_pos,
         get_ref_base,
         get_pileup_depth,
-        next
+        next,
+
+        // v1.1
+        get_column,
+
+        // v1.2
+        get_base_counts,
+
+        // v1.3
+        extend_to
     };
 
 } // namespace ngs_adapt
@@ -30,10 +30,13 @@
 #include <ngs/adapter/ReferenceItf.hpp>
 #include <ngs/adapter/AlignmentItf.hpp>
 #include <ngs/adapter/ReadItf.hpp>
+#include <ngs/adapter/StatisticsItf.hpp>
 #include <ngs/adapter/ErrorMsg.hpp>
 
 #include "ErrBlock.hpp"
 
+#include <string.h>
+
 namespace ngs_adapt
 {
 
@@ -46,6 +49,119 @@ namespace ngs_adapt
     {
     }
 
+    uint32_t ReadCollectionItf :: getFeatures () const
+    {
+        return NGS_ReadCollectionFeature_all;
+    }
+
+    StatisticsItf * ReadCollectionItf :: getStatistics () const
+    {
+        throw ErrorMsg ( "getStatistics is not implemented by this engine" );
+    }
+
+    // holds a name from the engine until it is copied into a reference table
+    struct TableName
+    {
+        TableName ( StringItf * _str )
+            : str ( _str )
+        {
+        }
+
+        ~ TableName ()
+        {
+            if ( str != 0 )
+                str -> Release ();
+        }
+
+        // copies the name into the arena if it fits, counting it either way
+        void Copy ( NGS_ReferenceTable_v1 & table, NGS_ReferenceTableString_v1 * column, uint32_t i ) const
+        {
+            size_t const size = str -> size ();
+            if ( size > ~ ( uint32_t ) 0 - table . arena_used )
+                throw ErrorMsg ( "reference names are too long for a reference table" );
+
+            if ( i < table . capacity && table . arena_used <= table . arena_size
+                 && size <= table . arena_size - table . arena_used )
+            {
+                column [ i ] . offset = table . arena_used;
+                column [ i ] . size = ( uint32_t ) size;
+                memcpy ( table . arena + table . arena_used, str -> data (), size );
+            }
+            table . arena_used += ( uint32_t ) size;
+        }
+
+        StringItf * str;
+
+    private:
+
+        TableName ( const TableName & );
+        TableName & operator = ( const TableName & );
+    };
+
+    static
+    void FillReferenceRow ( const ReferenceItf * ref, NGS_ReferenceTable_v1 & table, uint32_t i )
+    {
+        if ( ( table . filled & NGS_ReferenceTableFields_common_name ) != 0 )
+            TableName ( ref -> getCommonName () ) . Copy ( table, table . common_name, i );
+
+        // engines throw for what they don't know, often the canonical name and circularity
+        if ( ( table . filled & NGS_ReferenceTableFields_canonical_name ) != 0 )
+        {
+            StringItf * name = 0;
+            try
+            {
+                name = ref -> getCanonicalName ();
+            }
+            catch ( ... )
+            {
+                table . filled &= ~ NGS_ReferenceTableFields_canonical_name;
+            }
+            if ( name != 0 )
+                TableName ( name ) . Copy ( table, table . canonical_name, i );
+        }
+
+        if ( i >= table . capacity )
+            return;
+
+        if ( ( table . filled & NGS_ReferenceTableFields_length ) != 0 )
+            table . length [ i ] = ref -> getLength ();
+        if ( ( table . filled & NGS_ReferenceTableFields_circular ) != 0 )
+        {
+            try
+            {
+                table . circular [ i ] = ref -> getIsCircular () ? 1 : 0;
+            }
+            catch ( ... )
+            {
+                table . filled &= ~ NGS_ReferenceTableFields_circular;
+            }
+        }
+    }
+
+    bool ReadCollectionItf :: getReferenceTable ( NGS_ReferenceTable_v1 & table ) const
+    {
+        table . count = 0;
+        table . arena_used = 0;
+        table . filled = table . fields
+            & ( NGS_ReferenceTableFields_common_name | NGS_ReferenceTableFields_canonical_name
+              | NGS_ReferenceTableFields_length | NGS_ReferenceTableFields_circular );
+
+        ReferenceItf * ref = getReferences ();
+        try
+        {
+            while ( ref -> nextReference () )
+                FillReferenceRow ( ref, table, table . count ++ );
+        }
+        catch ( ... )
+        {
+            ref -> Release ();
+            throw;
+        }
+        ref -> Release ();
+
+        return table . count <= table . capacity && table . arena_used <= table . arena_size;
+    }
+
 
     NGS_String_v1 * CC ReadCollectionItf :: get_name ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err )
     {
@@ -79,6 +195,20 @@ namespace ngs_adapt
         return 0;
     }
 
+    bool CC ReadCollectionItf :: has_read_group ( const NGS_ReadCollection_v1 * iself, const char * spec )
+    {
+        const ReadCollectionItf * self = Self ( iself );
+        try
+        {
+            return self -> hasReadGroup ( spec );
+        }
+        catch ( ... )
+        {
+        }
+
+        return false;
+    }
+
     NGS_ReadGroup_v1 * CC ReadCollectionItf :: get_read_group ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err,
             const char * spec )
     {
@@ -112,6 +242,20 @@ namespace ngs_adapt
         return 0;
     }
 
+    bool CC ReadCollectionItf :: has_reference ( const NGS_ReadCollection_v1 * iself, const char * spec )
+    {
+        const ReadCollectionItf * self = Self ( iself );
+        try
+        {
+            return self -> hasReference ( spec );
+        }
+        catch ( ... )
+        {
+        }
+
+        return false;
+    }
+
     NGS_Reference_v1 * CC ReadCollectionItf :: get_reference ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err,
             const char * spec )
     {
@@ -196,6 +340,23 @@ namespace ngs_adapt
         return 0;
     }
 
+    NGS_Alignment_v1 * CC ReadCollectionItf :: get_align_shard ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err,
+            uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary )
+    {
+        const ReadCollectionItf * self = Self ( iself );
+        try
+        {
+            AlignmentItf * val = self -> getAlignmentShard ( shard, count, wants_primary, wants_secondary );
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
     NGS_Read_v1 * CC ReadCollectionItf :: get_read ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err,
             const char * readId )
     {
@@ -263,15 +424,63 @@ namespace ngs_adapt
         return 0;
     }
 
+    uint32_t CC ReadCollectionItf :: get_features ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const ReadCollectionItf * self = Self ( iself );
+        try
+        {
+            return self -> getFeatures ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    NGS_Statistics_v1 * CC ReadCollectionItf :: get_statistics ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const ReadCollectionItf * self = Self ( iself );
+        try
+        {
+            StatisticsItf * val = self -> getStatistics ();
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    bool CC ReadCollectionItf :: get_reference_table ( const NGS_ReadCollection_v1 * iself, NGS_ErrBlock_v1 * err,
+            NGS_ReferenceTable_v1 * table )
+    {
+        const ReadCollectionItf * self = Self ( iself );
+        try
+        {
+            return self -> getReferenceTable ( * table );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
     NGS_ReadCollection_v1_vt ReadCollectionItf :: ivt =
     {
         {
-            "ngs_adapt::ReadCollectionItf",
+            NGS_ADAPT_CLASS ( "ReadCollectionItf" ),
             "NGS_ReadCollection_v1",
-            0,
+            5,
             & OpaqueRefcount :: ivt . dad
         },
 
+        // 1.0
         get_name,
         get_read_groups,
         get_read_group,
@@ -284,7 +493,23 @@ namespace ngs_adapt
         get_read,
         get_reads,
         get_read_count,
-        get_read_range
+        get_read_range,
+
+        // 1.1
+        has_read_group,
+        has_reference,
+
+        // 1.2
+        get_align_shard,
+
+        // 1.3
+        get_features,
+
+        // 1.4
+        get_statistics,
+
+        // 1.5
+        get_reference_table
     };
 
 } // namespace ngs_adapt
@@ -93,7 +93,7 @@ namespace ngs_adapt
     NGS_ReadGroup_v1_vt ReadGroupItf :: ivt =
     {
         {
-            "ngs_adapt::ReadGroupItf",
+            NGS_ADAPT_CLASS ( "ReadGroupItf" ),
             "NGS_ReadGroup_v1",
             0,
             & OpaqueRefcount :: ivt . dad
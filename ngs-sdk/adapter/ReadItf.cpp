@@ -42,6 +42,47 @@ namespace ngs_adapt
     {
     }
 
+    bool ReadItf :: fragmentIsAligned ( uint32_t fragIdx ) const
+    {
+        throw ErrorMsg ( "fragmentIsAligned is not implemented by this engine" );
+    }
+
+    StringItf * ReadItf :: getCursor () const
+    {
+        throw ErrorMsg ( "this Read iterator cannot be resumed" );
+    }
+
+    void ReadItf :: resumeFrom ( const char * cursor )
+    {
+        throw ErrorMsg ( "this Read iterator cannot be resumed" );
+    }
+
+    uint64_t ReadItf :: getReadRowId () const
+    {
+        StringItf * id = getReadId ();
+        const char * data = id -> data ();
+        size_t end = id -> size ();
+
+        // the digits the ID ends with, as in "SRR000001.R.12" or "12"
+        size_t start = end;
+        while ( start > 0 && data [ start - 1 ] >= '0' && data [ start - 1 ] <= '9' )
+            -- start;
+
+        uint64_t row = 0;
+        bool numeric = start < end;
+        for ( size_t i = start; numeric && i < end; ++ i )
+        {
+            unsigned digit = ( unsigned ) ( data [ i ] - '0' );
+            numeric = row <= ( ( uint64_t ) -1 - digit ) / 10;
+            row = row * 10 + digit;
+        }
+        id -> Release ();
+
+        if ( ! numeric )
+            throw ErrorMsg ( "this engine's read IDs do not end in a row number" );
+        return row;
+    }
+
     NGS_String_v1 * CC ReadItf :: get_id ( const NGS_Read_v1 * iself, NGS_ErrBlock_v1 * err )
     {
         const ReadItf * self = Self ( iself );
@@ -94,7 +135,7 @@ namespace ngs_adapt
         try
         {
             StringItf * val = self -> getReadGroup ();
-            return val -> Cast ();
+            return val != 0 ? val -> Cast () : 0;
         }
         catch ( ... )
         {
@@ -167,12 +208,71 @@ namespace ngs_adapt
         return false;
     }
 
+    bool CC ReadItf :: frag_is_aligned ( const NGS_Read_v1 * iself, NGS_ErrBlock_v1 * err, uint32_t fragIdx )
+    {
+        const ReadItf * self = Self ( iself );
+        try
+        {
+            return self -> fragmentIsAligned ( fragIdx );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    NGS_String_v1 * CC ReadItf :: get_cursor ( const NGS_Read_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const ReadItf * self = Self ( iself );
+        try
+        {
+            StringItf * val = self -> getCursor ();
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    void CC ReadItf :: resume_from ( NGS_Read_v1 * iself, NGS_ErrBlock_v1 * err, const char * cursor )
+    {
+        ReadItf * self = Self ( iself );
+        try
+        {
+            self -> resumeFrom ( cursor );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+    }
+
+    uint64_t CC ReadItf :: get_row_id ( const NGS_Read_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const ReadItf * self = Self ( iself );
+        try
+        {
+            return self -> getReadRowId ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
     NGS_Read_v1_vt ReadItf :: ivt =
     {
         {
-            "ngs_adapt::ReadItf",
+            NGS_ADAPT_CLASS ( "ReadItf" ),
             "NGS_Read_v1",
-            0,
+            3,
             & FragmentItf :: ivt . dad
         },
 
@@ -183,7 +283,17 @@ namespace ngs_adapt
         get_name,
         get_bases,
         get_quals,
-        next
+        next,
+
+        // v1.1
+        frag_is_aligned,
+
+        // v1.2
+        get_cursor,
+        resume_from,
+
+        // v1.3
+        get_row_id
     };
 
 } // namespace ngs_adapt
@@ -34,8 +34,108 @@
 
 #include "atomic32.h"
 
+/*--------------------------------------------------------------------------
+ * NGS_ADAPT_ATOMIC_BUILTINS
+ *  count references with the compiler's __atomic builtins, ordered only
+ *  as a count needs: relaxed to add a reference, release to drop one and
+ *  acquire before collecting the object, rather than a full barrier each.
+ *  on wherever the builtins exist; define it as 0 to use atomic32.h
+ */
+#ifndef NGS_ADAPT_ATOMIC_BUILTINS
+ #if defined __clang__ || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 7 )
+  #define NGS_ADAPT_ATOMIC_BUILTINS 1
+ #else
+  #define NGS_ADAPT_ATOMIC_BUILTINS 0
+ #endif
+#endif
+
 namespace ngs_adapt
 {
+    /*----------------------------------------------------------------------
+     * small object pool
+     *  blocks of up to POOL_GRAIN * POOL_CLASSES bytes are recycled through
+     *  lists kept per thread; a block released on another thread than the
+     *  one it came from joins the releasing thread's list.
+     *  a list keeps at most POOL_DEPTH blocks, which stay allocated when
+     *  the thread exits. building with NGS_ADAPT_NO_POOL leaves it all
+     *  to the heap.
+     */
+#ifndef NGS_ADAPT_NO_POOL
+
+#if defined _MSC_VER
+#define POOL_TLS __declspec ( thread )
+#else
+#define POOL_TLS __thread
+#endif
+
+    static const size_t POOL_GRAIN = 16;
+    static const size_t POOL_CLASSES = 16;
+    static const unsigned int POOL_DEPTH = 64;
+
+    struct PoolBlock
+    {
+        PoolBlock * next;
+    };
+
+    struct PoolList
+    {
+        PoolBlock * head;
+        unsigned int count;
+    };
+
+    static POOL_TLS PoolList pool [ POOL_CLASSES ];
+
+#endif
+
+    /*----------------------------------------------------------------------
+     * Allocator
+     *  read on every allocation, so only loaded, without a lock
+     */
+    static Allocator * allocator;
+
+    Allocator :: ~ Allocator ()
+    {
+    }
+
+    Allocator * Allocator :: install ( Allocator * replacement )
+    {
+#if NGS_ADAPT_ATOMIC_BUILTINS
+        return __atomic_exchange_n ( & allocator, replacement, __ATOMIC_ACQ_REL );
+#else
+        Allocator * previous = allocator;
+        allocator = replacement;
+        return previous;
+#endif
+    }
+
+    Allocator * Allocator :: installed ()
+    {
+#if NGS_ADAPT_ATOMIC_BUILTINS
+        return __atomic_load_n ( & allocator, __ATOMIC_ACQUIRE );
+#else
+        return allocator;
+#endif
+    }
+
+    void * Allocator :: newBlock ( size_t bytes )
+    {
+        Allocator * current = installed ();
+        if ( current != 0 )
+            return current -> allocate ( bytes );
+        return :: operator new ( bytes );
+    }
+
+    void Allocator :: deleteBlock ( void * block, size_t bytes )
+    {
+        if ( block == 0 )
+            return;
+        Allocator * current = installed ();
+        if ( current != 0 )
+            current -> deallocate ( block, bytes );
+        else
+            :: operator delete ( block );
+    }
+
     /*----------------------------------------------------------------------
      * OpaqueRefcount
      */
@@ -43,13 +143,75 @@ namespace ngs_adapt
     OpaqueRefcount :: ~OpaqueRefcount ()
     {
 	}
+
+    void * OpaqueRefcount :: operator new ( size_t bytes )
+    {
+        Allocator * current = Allocator :: installed ();
+        if ( current != 0 )
+            return current -> allocate ( bytes );
+
+#ifndef NGS_ADAPT_NO_POOL
+        size_t cls = ( bytes - 1 ) / POOL_GRAIN;
+        if ( cls < POOL_CLASSES )
+        {
+            PoolList & list = pool [ cls ];
+            if ( list . head != 0 )
+            {
+                PoolBlock * block = list . head;
+                list . head = block -> next;
+                -- list . count;
+                return block;
+            }
+
+            // the whole class size, so that the block fits any of its class
+            return :: operator new ( ( cls + 1 ) * POOL_GRAIN );
+        }
+#endif
+        return :: operator new ( bytes );
+    }
+
+    void OpaqueRefcount :: operator delete ( void * obj, size_t bytes )
+    {
+        Allocator * current = Allocator :: installed ();
+        if ( current != 0 )
+        {
+            if ( obj != 0 )
+                current -> deallocate ( obj, bytes );
+            return;
+        }
+
+#ifndef NGS_ADAPT_NO_POOL
+        size_t cls = ( bytes - 1 ) / POOL_GRAIN;
+        if ( obj != 0 && cls < POOL_CLASSES )
+        {
+            PoolList & list = pool [ cls ];
+            if ( list . count < POOL_DEPTH )
+            {
+                PoolBlock * block = static_cast < PoolBlock* > ( obj );
+                block -> next = list . head;
+                list . head = block;
+                ++ list . count;
+                return;
+            }
+        }
+#endif
+        :: operator delete ( obj );
+    }
   
     void OpaqueRefcount :: Release ()
     {
+#if NGS_ADAPT_ATOMIC_BUILTINS
+        int result = __atomic_fetch_sub ( & refcount . counter, 1, __ATOMIC_RELEASE );
+#else
         int result = atomic32_read_and_add ( & refcount, -1 );
+#endif
         switch ( result )
         {
         case 1:
+#if NGS_ADAPT_ATOMIC_BUILTINS
+            // see what other holders did before they let go
+            __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+#endif
             // the object should be collected
             delete this;
             break;
@@ -67,9 +229,18 @@ namespace ngs_adapt
 
     void * OpaqueRefcount :: Duplicate () const
     {
+#if NGS_ADAPT_ATOMIC_BUILTINS
+        int prior = __atomic_fetch_add ( & refcount . counter, 1, __ATOMIC_RELAXED );
+        if ( prior <= 0 )
+        {
+            __atomic_fetch_sub ( & refcount . counter, 1, __ATOMIC_RELAXED );
+            throw ErrorMsg ( "attempt to duplicate a zombie object" );
+        }
+#else
         int prior = atomic32_read_and_add_gt ( & refcount, 1, 0 );
         if ( prior <= 0 )
             throw ErrorMsg ( "attempt to duplicate a zombie object" );
+#endif
 
         if ( prior == INT_MAX )
         {
@@ -80,6 +251,11 @@ namespace ngs_adapt
         return ( void* ) this;
     }
 
+    const NGS_VTable * OpaqueRefcount :: QueryExtension ( const char * name ) const
+    {
+        return 0;
+    }
+
     OpaqueRefcount :: OpaqueRefcount ( const OpaqueRefcount & obj )
     {
         cobj = obj . cobj;
@@ -121,15 +297,34 @@ namespace ngs_adapt
 		return 0;
     }
 
+    const NGS_VTable * CC OpaqueRefcount :: query_ext ( const NGS_Refcount_v1 * iself, NGS_ErrBlock_v1 * err, const char * name )
+    {
+        const OpaqueRefcount * self = static_cast < const OpaqueRefcount* > ( offset_cobj ( ( const void* ) iself ) );
+        try
+        {
+            return self -> QueryExtension ( name );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+        return 0;
+    }
+
     NGS_Refcount_v1_vt OpaqueRefcount :: ivt =
     {
         {
-            "ngs_adapt::OpaqueRefcount",
-            "NGS_Refcount_v1"
+            NGS_ADAPT_CLASS ( "OpaqueRefcount" ),
+            "NGS_Refcount_v1",
+            1
         },
 
+        // v1.0
         release,
-        duplicate
+        duplicate,
+
+        // v1.1
+        query_ext
     };
 
 } // namespace ngs_adapt
@@ -33,6 +33,8 @@
 
 #include "ErrBlock.hpp"
 
+#include <string.h>
+
 namespace ngs_adapt
 {
 
@@ -45,6 +47,60 @@ namespace ngs_adapt
     {
     }
 
+    uint32_t ReferenceItf :: getFeatures () const
+    {
+        return NGS_ReferenceFeature_all;
+    }
+
+    bool ReferenceItf :: getCoverage ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t * depth ) const
+    {
+        return false;
+    }
+
+    PileupItf * ReferenceItf :: getSampledPileupSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual,
+        uint32_t max_depth, uint64_t seed, bool skip_empty ) const
+    {
+        if ( max_depth != 0 || skip_empty )
+            throw ErrorMsg ( "pileup sampling is not available" );
+        return getFilteredPileupSlice ( start, length, flags, map_qual );
+    }
+
+    uint64_t ReferenceItf :: copyReferenceBases ( uint64_t offset, char * buffer, uint64_t size ) const
+    {
+        uint64_t length = getLength ();
+        if ( offset >= length )
+            return 0;
+        if ( size > length - offset )
+            size = length - offset;
+
+        uint64_t copied = 0;
+        while ( copied < size )
+        {
+            StringItf * chunk = getReferenceChunk ( offset + copied, size - copied );
+            size_t chunk_size = chunk -> size ();
+            if ( chunk_size > size - copied )
+                chunk_size = ( size_t ) ( size - copied );
+            memmove ( buffer + copied, chunk -> data (), chunk_size );
+            chunk -> Release ();
+
+            if ( chunk_size == 0 )
+                break;
+            copied += chunk_size;
+        }
+
+        return copied;
+    }
+
+    bool ReferenceItf :: getReferenceBasesPacked ( uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * n_mask, uint64_t & count ) const
+    {
+        return false;
+    }
+
+    bool ReferenceItf :: estimateSlice ( int64_t start, uint64_t length, uint64_t & alignments, uint64_t & bytes ) const
+    {
+        return false;
+    }
+
     NGS_String_v1 * CC ReferenceItf :: get_cmn_name ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err )
     {
         const ReferenceItf * self = Self ( iself );
@@ -141,6 +197,22 @@ namespace ngs_adapt
         return 0;
     }
 
+    uint64_t CC ReferenceItf :: get_alignment_count ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        bool wants_primary, bool wants_secondary )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            return self -> getAlignmentCount ( wants_primary, wants_secondary );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
     NGS_Alignment_v1 * CC ReferenceItf :: get_alignment ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
             const char * alignmentId )
     {
@@ -192,6 +264,57 @@ namespace ngs_adapt
         return 0;
     }
 
+    NGS_Alignment_v1 * CC ReferenceItf :: get_filtered_alignments ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        uint32_t flags, int32_t map_qual )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            AlignmentItf * val = self -> getFilteredAlignments ( flags, map_qual );
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    NGS_Alignment_v1 * CC ReferenceItf :: get_filtered_align_slice ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        int64_t start, uint64_t length, uint32_t flags, int32_t map_qual )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            AlignmentItf * val = self -> getFilteredAlignmentSlice ( start, length, flags, map_qual );
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    NGS_Alignment_v1 * CC ReferenceItf :: get_align_shard ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            AlignmentItf * val = self -> getAlignmentShard ( shard, count, wants_primary, wants_secondary );
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
     NGS_Pileup_v1 * CC ReferenceItf :: get_pileups ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
                                      bool wants_primary, bool wants_secondary )
     {
@@ -275,12 +398,108 @@ namespace ngs_adapt
         return false;
     }
 
+    uint32_t CC ReferenceItf :: get_features ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            return self -> getFeatures ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    bool CC ReferenceItf :: get_coverage ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t * depth )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            return self -> getCoverage ( start, length, flags, map_qual, depth );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    NGS_Pileup_v1 * CC ReferenceItf :: get_sampled_pileup_slice ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t max_depth, uint64_t seed, bool skip_empty )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            PileupItf * val = self -> getSampledPileupSlice ( start, length, flags, map_qual, max_depth, seed, skip_empty );
+            return val -> Cast ();
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    uint64_t CC ReferenceItf :: copy_ref_bases ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        uint64_t offset, char * buffer, uint64_t size )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            return self -> copyReferenceBases ( offset, buffer, size );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return 0;
+    }
+
+    bool CC ReferenceItf :: get_packed_ref_bases ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * n_mask, uint64_t * count )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            return self -> getReferenceBasesPacked ( offset, length, bases, n_mask, * count );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
+    bool CC ReferenceItf :: estimate_slice ( const NGS_Reference_v1 * iself, NGS_ErrBlock_v1 * err,
+        int64_t start, uint64_t length, uint64_t * alignments, uint64_t * bytes )
+    {
+        const ReferenceItf * self = Self ( iself );
+        try
+        {
+            return self -> estimateSlice ( start, length, * alignments, * bytes );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
     NGS_Reference_v1_vt ReferenceItf :: ivt =
     {
         {
-            "ngs_adapt::ReferenceItf",
+            NGS_ADAPT_CLASS ( "ReferenceItf" ),
             "NGS_Reference_v1",
-            1,
+            10,
             & OpaqueRefcount :: ivt . dad
         },
 
@@ -300,7 +519,35 @@ namespace ngs_adapt
 
         // 1.1
         get_filtered_pileups,
-        get_filtered_pileup_slice
+        get_filtered_pileup_slice,
+
+        // 1.2
+        get_alignment_count,
+
+        // 1.3
+        get_filtered_alignments,
+        get_filtered_align_slice,
+
+        // 1.4
+        get_align_shard,
+
+        // 1.5
+        get_features,
+
+        // 1.6
+        get_coverage,
+
+        // 1.7
+        get_sampled_pileup_slice,
+
+        // 1.8
+        copy_ref_bases,
+
+        // 1.9
+        get_packed_ref_bases,
+
+        // 1.10
+        estimate_slice
     };
 
 } // namespace ngs_adapt
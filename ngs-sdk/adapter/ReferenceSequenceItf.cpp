@@ -125,7 +125,7 @@ namespace ngs_adapt
     NGS_ReferenceSequence_v1_vt ReferenceSequenceItf :: ivt =
     {
         {
-            "ngs_adapt::ReferenceSequenceItf",
+            NGS_ADAPT_CLASS ( "ReferenceSequenceItf" ),
             "NGS_ReferenceSequence_v1",
             1,
             & OpaqueRefcount :: ivt . dad
@@ -42,6 +42,11 @@ namespace ngs_adapt
     {
     }
 
+    bool StatisticsItf :: getEntries ( const NGS_StatisticsEntry_v1 * & entries, uint64_t & count ) const
+    {
+        return false;
+    }
+
     uint32_t CC StatisticsItf :: get_type ( const NGS_Statistics_v1 * iself, NGS_ErrBlock_v1 * err, const char * path )
     {
         const StatisticsItf * self = Self ( iself );
@@ -134,21 +139,40 @@ namespace ngs_adapt
         return 0;
     }
 
+    bool CC StatisticsItf :: get_entries ( const NGS_Statistics_v1 * iself, NGS_ErrBlock_v1 * err, const NGS_StatisticsEntry_v1 ** entries, uint64_t * count )
+    {
+        const StatisticsItf * self = Self ( iself );
+        try
+        {
+            return self -> getEntries ( * entries, * count );
+        }
+        catch ( ... )
+        {
+            ErrBlockHandleException ( err );
+        }
+
+        return false;
+    }
+
     NGS_Statistics_v1_vt StatisticsItf :: ivt =
     {
         {
-            "ngs_adapt::StatisticsItf",
+            NGS_ADAPT_CLASS ( "StatisticsItf" ),
             "NGS_Statistics_v1",
-            0,
+            1,
             & OpaqueRefcount :: ivt . dad
         },
 
+        // v1.0
         get_type,
         as_string,
         as_I64,
         as_U64,
         as_F64,
-        next_path
+        next_path,
+
+        // v1.1
+        get_entries
     };
 
 } // namespace ngs_adapt
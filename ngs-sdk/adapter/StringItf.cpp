@@ -131,7 +131,7 @@ namespace ngs_adapt
     NGS_String_v1_vt StringItf :: ivt =
     {
         {
-            "ngs_adapt::StringItf",
+            NGS_ADAPT_CLASS ( "StringItf" ),
             "NGS_String_v1",
             0,
             & OpaqueRefcount :: ivt . dad
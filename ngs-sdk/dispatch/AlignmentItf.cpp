@@ -25,14 +25,27 @@
 */
 
 #include <ngs/itf/AlignmentItf.hpp>
+#include <ngs/itf/FragmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
+#include <ngs/itf/DirectBind.hpp>
 
 #include <ngs/itf/AlignmentItf.h>
 
+#include <ngs/itf/StringItf.h>
+
 #include <ngs/Alignment.hpp>
 
+#include <string.h>
+#include <vector>
+
+#if NGS_DIRECT_BIND
+#include <ngs/adapter/AlignmentItf.hpp>
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -55,23 +68,60 @@ namespace ngs
         return out;
     }
 
+#if NGS_DIRECT_BIND
+    /*----------------------------------------------------------------------
+     * the adapter object behind a C one, or NULL to go through the vtable
+     */
+    static DirectTok NGS_Alignment_v1_direct;
+
+    static inline
+    const ngs_adapt :: AlignmentItf * Direct ( const NGS_Alignment_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_Alignment_v1_tok, NGS_Alignment_v1_direct ) )
+            return ngs_adapt :: AlignmentItf :: Self ( self );
+        return 0;
+    }
+
+    static inline
+    ngs_adapt :: AlignmentItf * Direct ( NGS_Alignment_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_Alignment_v1_tok, NGS_Alignment_v1_direct ) )
+            return ngs_adapt :: AlignmentItf :: Self ( self );
+        return 0;
+    }
+
+    static inline
+    AlignmentItf * DirectAlignment ( ngs_adapt :: AlignmentItf * obj )
+    {
+        return obj != 0 ? AlignmentItf :: Cast ( obj -> Cast () ) : 0;
+    }
+#endif
+
 
     /*----------------------------------------------------------------------
      * AlignmentItf
      */
 
     StringItf * AlignmentItf :: getAlignmentId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getAlignmentId () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_id );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_id );
         NGS_String_v1 * ret  = ( * vt -> get_id ) ( self, & err );
 
         // check for errors
@@ -81,17 +131,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getReferenceSpec () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReferenceSpec () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_spec != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_ref_spec );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_ref_spec );
         NGS_String_v1 * ret  = ( * vt -> get_ref_spec ) ( self, & err );
 
         // check for errors
@@ -101,17 +159,25 @@ namespace ngs
     }
 
     int32_t AlignmentItf :: getMappingQuality () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getMappingQuality () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_map_qual != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_map_qual );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_map_qual );
         int32_t ret  = ( * vt -> get_map_qual ) ( self, & err );
 
         // check for errors
@@ -121,17 +187,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getReferenceBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReferenceBases () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_ref_bases );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_ref_bases );
         NGS_String_v1 * ret  = ( * vt -> get_ref_bases ) ( self, & err );
 
         // check for errors
@@ -141,17 +215,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getReadGroup () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadGroup () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read_group != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_read_group );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_read_group );
         NGS_String_v1 * ret  = ( * vt -> get_read_group ) ( self, & err );
 
         // check for errors
@@ -161,17 +243,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getReadId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadId () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_read_id );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_read_id );
         NGS_String_v1 * ret  = ( * vt -> get_read_id ) ( self, & err );
 
         // check for errors
@@ -181,17 +271,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getClippedFragmentBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getClippedFragmentBases () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_clipped_frag_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_clipped_frag_bases );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_clipped_frag_bases );
         NGS_String_v1 * ret  = ( * vt -> get_clipped_frag_bases ) ( self, & err );
 
         // check for errors
@@ -201,17 +299,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getClippedFragmentQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getClippedFragmentQualities () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_clipped_frag_quals != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_clipped_frag_quals );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_clipped_frag_quals );
         NGS_String_v1 * ret  = ( * vt -> get_clipped_frag_quals ) ( self, & err );
 
         // check for errors
@@ -221,17 +327,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getAlignedFragmentBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getAlignedFragmentBases () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_aligned_frag_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_aligned_frag_bases );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_aligned_frag_bases );
         NGS_String_v1 * ret  = ( * vt -> get_aligned_frag_bases ) ( self, & err );
 
         // check for errors
@@ -241,17 +355,25 @@ namespace ngs
     }
 
     uint32_t AlignmentItf :: getAlignmentCategory () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> isPrimary () ? Alignment :: primaryAlignment : Alignment :: secondaryAlignment )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> is_primary != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, is_primary );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, is_primary );
         bool ret  = ( * vt -> is_primary ) ( self, & err );
 
         // check for errors
@@ -261,17 +383,25 @@ namespace ngs
     }
 
     int64_t AlignmentItf :: getAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getAlignmentPosition () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_pos != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_align_pos );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_align_pos );
         int64_t ret  = ( * vt -> get_align_pos ) ( self, & err );
 
         // check for errors
@@ -281,11 +411,17 @@ namespace ngs
     }
 
     uint64_t AlignmentItf :: getReferencePositionProjectionRange (int64_t ref_pos) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getReferencePositionProjectionRange ( ref_pos ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
@@ -296,6 +432,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_pos_projection_range != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_ref_pos_projection_range );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_ref_pos_projection_range );
+        NGS_RECORD_ARG ( ref_pos );
         uint64_t ret  = ( * vt -> get_ref_pos_projection_range ) ( self, & err, ref_pos );
 
         // check for errors
@@ -305,17 +444,25 @@ namespace ngs
     }
 
     uint64_t AlignmentItf :: getAlignmentLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getAlignmentLength () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_length != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_align_length );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_align_length );
         uint64_t ret  = ( * vt -> get_align_length ) ( self, & err );
 
         // check for errors
@@ -325,17 +472,25 @@ namespace ngs
     }
 
     bool AlignmentItf :: getIsReversedOrientation () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getIsReversedOrientation () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_is_reversed != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_is_reversed );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_is_reversed );
         bool ret  = ( * vt -> get_is_reversed ) ( self, & err );
 
         // check for errors
@@ -345,17 +500,26 @@ namespace ngs
     }
 
     int32_t AlignmentItf :: getSoftClip ( uint32_t edge ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getSoftClip ( edge ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_soft_clip != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_soft_clip );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_soft_clip );
+        NGS_RECORD_ARG ( edge );
         int32_t ret  = ( * vt -> get_soft_clip ) ( self, & err, edge );
 
         // check for errors
@@ -365,17 +529,25 @@ namespace ngs
     }
 
     uint64_t AlignmentItf :: getTemplateLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getTemplateLength () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_template_len != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_template_len );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_template_len );
         uint64_t ret  = ( * vt -> get_template_len ) ( self, & err );
 
         // check for errors
@@ -385,17 +557,26 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getShortCigar ( bool clipped ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getShortCigar ( clipped ) ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_short_cigar != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_short_cigar );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_short_cigar );
+        NGS_RECORD_ARG ( clipped );
         NGS_String_v1 * ret  = ( * vt -> get_short_cigar ) ( self, & err, clipped );
 
         // check for errors
@@ -405,17 +586,26 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getLongCigar ( bool clipped ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getLongCigar ( clipped ) ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_long_cigar != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_long_cigar );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_long_cigar );
+        NGS_RECORD_ARG ( clipped );
         NGS_String_v1 * ret  = ( * vt -> get_long_cigar ) ( self, & err, clipped );
 
         // check for errors
@@ -425,11 +615,17 @@ namespace ngs
     }
 
     char AlignmentItf :: getRNAOrientation () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getRNAOrientation () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
@@ -440,6 +636,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_rna_orientation != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_rna_orientation );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_rna_orientation );
         char orientation  = ( * vt -> get_rna_orientation ) ( self, & err );
 
         // check for errors
@@ -449,19 +647,27 @@ namespace ngs
     }
 
     bool AlignmentItf :: hasMate () const
-        throw ()
+        NGS_NOTHROW
     {
         try
         {
             // the object is really from C
             const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+            // or from the adapter classes, to be called directly
+            if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+                NGS_DIRECT_CALL ( return direct -> hasMate () )
+#endif
+
             // cast vtable to our level
             const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
             // call through C vtable
             ErrBlock err;
             assert ( vt -> has_mate != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, has_mate );
+            NGS_RECORD_CALL ( NGS_Alignment_v1_vt, has_mate );
             bool ret  = ( * vt -> has_mate ) ( self, & err );
 
             // check for errors
@@ -482,17 +688,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getMateAlignmentId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getMateAlignmentId () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_mate_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_mate_id );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_mate_id );
         NGS_String_v1 * ret  = ( * vt -> get_mate_id ) ( self, & err );
 
         // check for errors
@@ -502,18 +716,27 @@ namespace ngs
     }
 
     AlignmentItf * AlignmentItf :: getMateAlignment () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectAlignment ( direct -> getMateAlignment () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_mate_alignment != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_mate_alignment );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_mate_alignment );
         NGS_Alignment_v1 * ret  = ( * vt -> get_mate_alignment ) ( self, & err );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -522,17 +745,25 @@ namespace ngs
     }
 
     StringItf * AlignmentItf :: getMateReferenceSpec () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getMateReferenceSpec () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_mate_ref_spec != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_mate_ref_spec );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_mate_ref_spec );
         NGS_String_v1 * ret  = ( * vt -> get_mate_ref_spec ) ( self, & err );
 
         // check for errors
@@ -542,17 +773,25 @@ namespace ngs
     }
 
     bool AlignmentItf :: getMateIsReversedOrientation () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getMateIsReversedOrientation () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_mate_is_reversed != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_mate_is_reversed );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_mate_is_reversed );
         bool ret  = ( * vt -> get_mate_is_reversed ) ( self, & err );
 
         // check for errors
@@ -562,17 +801,25 @@ namespace ngs
     }
 
     bool AlignmentItf :: nextAlignment ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_Alignment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> nextAlignment () )
+#endif
+
         // cast vtable to our level
         const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -581,5 +828,745 @@ namespace ngs
         return ret;
     }
 
-}
+    /*----------------------------------------------------------------------
+     * view of a string an older engine hands out
+     */
+    static
+    StringItf * View ( StringItf * str, NGS_StringView_v1 & view )
+    {
+        view . data = str -> data ();
+        view . size = str -> size ();
+        return str;
+    }
+
+    /*----------------------------------------------------------------------
+     * batches for engines from before v1.3
+     *  filled in one message at a time
+     */
+
+    // the strings of the record being added, released when done with
+    struct BatchStrings
+    {
+        BatchStrings ()
+        {
+            for ( int i = 0; i < 4; ++ i )
+                str [ i ] = 0;
+        }
+
+        ~ BatchStrings ()
+        {
+            for ( int i = 0; i < 4; ++ i )
+            {
+                if ( str [ i ] != 0 )
+                    str [ i ] -> Release ();
+            }
+        }
+
+        uint32_t size () const
+        {
+            size_t total = 0;
+            for ( int i = 0; i < 4; ++ i )
+            {
+                if ( str [ i ] != 0 )
+                    total += str [ i ] -> size ();
+            }
+            return total < ~ ( uint32_t ) 0 ? ( uint32_t ) total : ~ ( uint32_t ) 0;
+        }
+
+        void Copy ( NGS_AlignmentBatch_v1 & batch, int i, NGS_AlignmentBatchString_v1 * dst ) const
+        {
+            if ( dst != 0 )
+            {
+                NGS_AlignmentBatchString_v1 & out = dst [ batch . count ];
+
+                out . offset = batch . arena_used;
+                out . size = str [ i ] ? ( uint32_t ) str [ i ] -> size () : 0;
+                if ( out . size != 0 )
+                    memcpy ( batch . arena + batch . arena_used, str [ i ] -> data (), out . size );
+                batch . arena_used += out . size;
+            }
+        }
+
+        StringItf * str [ 4 ];
+    };
+
+    // the packed operations of a long CIGAR, as BAM has them
+    static
+    void ParseCigar ( const char * cigar, size_t size, std :: vector < uint32_t > & ops )
+    {
+        static const char codes [] = "MIDNSHP=X";
+        uint32_t length = 0;
+        bool digits = false;
+        ops . clear ();
+        for ( size_t i = 0; i < size; ++ i )
+        {
+            if ( cigar [ i ] >= '0' && cigar [ i ] <= '9' )
+            {
+                length = length * 10 + ( cigar [ i ] - '0' );
+                digits = true;
+                continue;
+            }
+            const char * code = cigar [ i ] != 0 ? strchr ( codes, cigar [ i ] ) : 0;
+            if ( code == 0 || ! digits )
+                throw ErrorMsg ( "malformed CIGAR: '" + std :: string ( cigar, size ) + "'" );
+            ops . push_back ( ( length << 4 ) | ( uint32_t ) ( code - codes ) );
+            length = 0;
+            digits = false;
+        }
+        if ( digits )
+            throw ErrorMsg ( "malformed CIGAR: '" + std :: string ( cigar, size ) + "'" );
+    }
+
+    // the CIGAR operations of the record, copied out of what the engine lends
+    static
+    void GetCigar ( const AlignmentItf * it, std :: vector < uint32_t > & ops )
+    {
+        NGS_AlignmentCigar_v1 lent;
+        if ( it -> getCigarOps ( lent ) )
+        {
+            ops . assign ( lent . ops, lent . ops + lent . count );
+            return;
+        }
+
+        StringItf * str = it -> getLongCigar ( false );
+        try
+        {
+            ParseCigar ( str -> data (), str -> size (), ops );
+        }
+        catch ( ... )
+        {
+            str -> Release ();
+            throw;
+        }
+        str -> Release ();
+    }
+
+    static
+    bool FillBatch ( AlignmentItf * it, NGS_AlignmentBatch_v1 & batch )
+    {
+        uint32_t const fields = batch . fields;
+        std :: vector < uint32_t > ops;
+
+        batch . count = 0;
+        batch . arena_used = 0;
+        if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0 )
+            batch . cigar_arena_used = 0;
+
+        while ( batch . count < batch . capacity && batch . state != NGS_AlignmentBatchState_end )
+        {
+            if ( batch . state == NGS_AlignmentBatchState_next )
+            {
+                if ( ! it -> nextAlignment () )
+                {
+                    batch . state = NGS_AlignmentBatchState_end;
+                    break;
+                }
+                batch . state = NGS_AlignmentBatchState_held;
+            }
+
+            BatchStrings strings;
+            const FragmentItf * frag = reinterpret_cast < const FragmentItf * > ( it );
+
+            if ( ( fields & NGS_AlignmentBatchFields_ref_spec ) != 0 )
+                strings . str [ 0 ] = it -> getReferenceSpec ();
+            if ( ( fields & NGS_AlignmentBatchFields_read_id ) != 0 )
+                strings . str [ 1 ] = it -> getReadId ();
+            if ( ( fields & NGS_AlignmentBatchFields_bases ) != 0 )
+                strings . str [ 2 ] = frag -> getFragmentBases ();
+            if ( ( fields & NGS_AlignmentBatchFields_qualities ) != 0 )
+                strings . str [ 3 ] = frag -> getFragmentQualities ();
+
+            if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0 )
+                GetCigar ( it, ops );
+
+            // leave the record for the next batch if it doesn't fit in this one
+            if ( strings . size () > batch . arena_size - batch . arena_used )
+            {
+                if ( batch . count == 0 )
+                    throw ErrorMsg ( "alignment batch arena is too small for the next alignment" );
+                break;
+            }
+            if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0
+                 && ops . size () > batch . cigar_arena_size - batch . cigar_arena_used )
+            {
+                if ( batch . count == 0 )
+                    throw ErrorMsg ( "alignment batch CIGAR arena is too small for the next alignment" );
+                break;
+            }
+
+            uint32_t const i = batch . count;
+            if ( ( fields & NGS_AlignmentBatchFields_cigar ) != 0 )
+            {
+                NGS_AlignmentBatchString_v1 & out = batch . cigar [ i ];
+                out . offset = batch . cigar_arena_used;
+                out . size = ( uint32_t ) ops . size ();
+                if ( out . size != 0 )
+                    memcpy ( batch . cigar_arena + out . offset, & ops [ 0 ], out . size * sizeof ops [ 0 ] );
+                batch . cigar_arena_used += out . size;
+            }
+            if ( ( fields & NGS_AlignmentBatchFields_ref_index ) != 0 )
+                batch . ref_index [ i ] = it -> getReferenceIndex ();
+            if ( ( fields & NGS_AlignmentBatchFields_position ) != 0 )
+            {
+                batch . position [ i ] = it -> getAlignmentPosition ();
+                batch . length [ i ] = it -> getAlignmentLength ();
+            }
+            if ( ( fields & NGS_AlignmentBatchFields_map_qual ) != 0 )
+                batch . map_qual [ i ] = it -> getMappingQuality ();
+            if ( ( fields & NGS_AlignmentBatchFields_flags ) != 0 )
+            {
+                batch . flags [ i ]
+                    = ( it -> getAlignmentCategory () == Alignment :: primaryAlignment ? NGS_AlignmentBatchFlags_primary : 0 )
+                    | ( it -> getIsReversedOrientation () ? NGS_AlignmentBatchFlags_reversed : 0 )
+                    | ( it -> hasMate () ? NGS_AlignmentBatchFlags_has_mate : 0 );
+            }
+            strings . Copy ( batch, 0, ( fields & NGS_AlignmentBatchFields_ref_spec ) ? batch . ref_spec : 0 );
+            strings . Copy ( batch, 1, ( fields & NGS_AlignmentBatchFields_read_id ) ? batch . read_id : 0 );
+            strings . Copy ( batch, 2, ( fields & NGS_AlignmentBatchFields_bases ) ? batch . bases : 0 );
+            strings . Copy ( batch, 3, ( fields & NGS_AlignmentBatchFields_qualities ) ? batch . qualities : 0 );
+
+            ++ batch . count;
+            batch . state = NGS_AlignmentBatchState_next;
+        }
+
+        return batch . count != 0;
+    }
+
+    bool AlignmentItf :: nextAlignmentBatch ( NGS_AlignmentBatch_v1 & batch )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Alignment_v1 * self = Test ();
+
+        // later columns the engine doesn't fill in are asked for one record at a time
+        if ( ( batch . fields & ~ 0x7F ) != 0 && ( batch . fields & ~ getBatchFields () ) != 0 )
+            return FillBatch ( this, batch );
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> nextAlignmentBatch ( batch ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.3
+        if ( vt -> dad . minor_version < 3 )
+            return FillBatch ( this, batch );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> next_batch != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, next_batch );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, next_batch );
+        NGS_RECORD_ARG ( batch . fields );
+        NGS_RECORD_ARG ( batch . capacity );
+        NGS_RECORD_ARG ( batch . arena_size );
+        NGS_RECORD_ARG ( batch . cigar_arena_size );
+        bool ret  = ( * vt -> next_batch ) ( self, & err, & batch );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    StringItf * AlignmentItf :: getReferenceSpecView ( NGS_StringView_v1 & view ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReferenceSpecView ( view ) ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.4, view the string handed out
+        if ( vt -> dad . minor_version < 4 )
+            return View ( getReferenceSpec (), view );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_ref_spec_view != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_ref_spec_view );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_ref_spec_view );
+        NGS_String_v1 * ret  = ( * vt -> get_ref_spec_view ) ( self, & err, & view );
+
+        // check for errors
+        err . Check ();
+
+        return StringItf :: Cast ( ret );
+    }
+
+    StringItf * AlignmentItf :: getReadIdView ( NGS_StringView_v1 & view ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadIdView ( view ) ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.4, view the string handed out
+        if ( vt -> dad . minor_version < 4 )
+            return View ( getReadId (), view );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_read_id_view != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_read_id_view );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_read_id_view );
+        NGS_String_v1 * ret  = ( * vt -> get_read_id_view ) ( self, & err, & view );
+
+        // check for errors
+        err . Check ();
+
+        return StringItf :: Cast ( ret );
+    }
+
+    uint32_t AlignmentItf :: getSupportedMessages () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getSupportedMessages () )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.5, nothing was said, so all is claimed
+        if ( vt -> dad . minor_version < 5 )
+            return NGS_AlignmentMessage_all;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_supported != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_supported );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_supported );
+        uint32_t ret  = ( * vt -> get_supported ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    bool AlignmentItf :: getTag ( const char * tag, NGS_AlignmentTag_v1 & value ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getTag ( tag, value ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.6, there were no tags to be had
+        if ( vt -> dad . minor_version < 6 )
+            return false;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_tag != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_tag );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_tag );
+        NGS_RECORD_ARG ( tag );
+        bool ret  = ( * vt -> get_tag ) ( self, & err, tag, & value );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    bool AlignmentItf :: getCigarOps ( NGS_AlignmentCigar_v1 & cigar ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getCigarOps ( cigar ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.7, the CIGAR was only to be had as text
+        if ( vt -> dad . minor_version < 7 )
+            return false;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_cigar_ops != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_cigar_ops );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_cigar_ops );
+        bool ret  = ( * vt -> get_cigar_ops ) ( self, & err, & cigar );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    void AlignmentItf :: getCore ( NGS_AlignmentCore_v1 & core ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getCore ( core ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.8, each field was asked for by itself
+        if ( vt -> dad . minor_version < 8 )
+        {
+            core . position = getAlignmentPosition ();
+            core . length = getAlignmentLength ();
+            core . template_len = getTemplateLength ();
+            core . map_qual = getMappingQuality ();
+            core . flags
+                = ( getAlignmentCategory () == Alignment :: primaryAlignment ? NGS_AlignmentBatchFlags_primary : 0 )
+                | ( getIsReversedOrientation () ? NGS_AlignmentBatchFlags_reversed : 0 )
+                | ( hasMate () ? NGS_AlignmentBatchFlags_has_mate : 0 );
+            return;
+        }
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_core != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_core );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_core );
+        ( * vt -> get_core ) ( self, & err, & core );
+
+        // check for errors
+        err . Check ();
+    }
+
+    bool AlignmentItf :: skipTo ( int64_t refPos )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> skipTo ( refPos ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.9, the Alignments are passed over one at a time
+        if ( vt -> dad . minor_version < 9 )
+        {
+            while ( nextAlignment () )
+            {
+                if ( getAlignmentPosition () + ( int64_t ) getAlignmentLength () > refPos )
+                    return true;
+            }
+            return false;
+        }
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> skip_to != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, skip_to );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, skip_to );
+        NGS_RECORD_ARG ( refPos );
+        bool ret  = ( * vt -> skip_to ) ( self, & err, refPos );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    StringItf * AlignmentItf :: getCursor () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getCursor () ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.10
+        if ( vt -> dad . minor_version < 10 )
+            throw ErrorMsg ( "the Alignment interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_cursor != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_cursor );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_cursor );
+        NGS_String_v1 * ret  = ( * vt -> get_cursor ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return StringItf :: Cast ( ret );
+    }
+
+    void AlignmentItf :: resumeFrom ( const char * cursor )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> resumeFrom ( cursor ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.10
+        if ( vt -> dad . minor_version < 10 )
+            throw ErrorMsg ( "the Alignment interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> resume_from != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, resume_from );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, resume_from );
+        NGS_RECORD_ARG ( cursor );
+        ( * vt -> resume_from ) ( self, & err, cursor );
+
+        // check for errors
+        err . Check ();
+    }
+
+    int32_t AlignmentItf :: getReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getReferenceIndex () )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
 
+        // test for v1.11
+        if ( vt -> dad . minor_version < 11 )
+            throw ErrorMsg ( "the Alignment interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_ref_index != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_ref_index );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_ref_index );
+        int32_t ret  = ( * vt -> get_ref_index ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    int32_t AlignmentItf :: getMateReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getMateReferenceIndex () )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.11
+        if ( vt -> dad . minor_version < 11 )
+            throw ErrorMsg ( "the Alignment interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_mate_ref_index != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_mate_ref_index );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_mate_ref_index );
+        int32_t ret  = ( * vt -> get_mate_ref_index ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    void AlignmentItf :: reposition ( int64_t start, uint64_t length )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> reposition ( start, length ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.12
+        if ( vt -> dad . minor_version < 12 )
+            throw ErrorMsg ( "the Alignment interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> reposition != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, reposition );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, reposition );
+        NGS_RECORD_ARG ( start );
+        NGS_RECORD_ARG ( length );
+        ( * vt -> reposition ) ( self, & err, start, length );
+
+        // check for errors
+        err . Check ();
+    }
+
+    uint32_t AlignmentItf :: getBatchFields () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getBatchFields () )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.13, next_batch filled in the columns there were then
+        if ( vt -> dad . minor_version < 13 )
+            return vt -> dad . minor_version < 3 ? 0 : 0x7F;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_batch_fields != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_batch_fields );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_batch_fields );
+        uint32_t ret  = ( * vt -> get_batch_fields ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    bool AlignmentItf :: getMismatches ( NGS_AlignmentMismatches_v1 & mismatches ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getMismatches ( mismatches ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.14, the bases were only compared by the caller
+        if ( vt -> dad . minor_version < 14 )
+            return false;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_mismatches != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_mismatches );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_mismatches );
+        NGS_RECORD_ARG ( mismatches . mask_size );
+        bool ret  = ( * vt -> get_mismatches ) ( self, & err, & mismatches );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    bool AlignmentItf :: getReadFragment ( NGS_AlignmentReadFragment_v1 & fragment ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Alignment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: AlignmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getReadFragment ( fragment ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Alignment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.15, the fragment was only turned around by the caller
+        if ( vt -> dad . minor_version < 15 )
+            return false;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_read_fragment != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Alignment_v1_vt, get_read_fragment );
+        NGS_RECORD_CALL ( NGS_Alignment_v1_vt, get_read_fragment );
+        NGS_RECORD_ARG ( fragment . size );
+        bool ret  = ( * vt -> get_read_fragment ) ( self, & err, & fragment );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+}
@@ -0,0 +1,298 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/itf/CallStats.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <new>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * CallStats
+     *  per-thread call counts and cycles for each vtable method
+     */
+
+    bool CallStats :: on;
+
+    uint64_t CallStats :: Clock ()
+        NGS_NOTHROW
+    {
+#if defined _WIN32
+        // Now () always has a TSC there
+        return 0;
+#else
+        struct timespec ts;
+        clock_gettime ( CLOCK_MONOTONIC, & ts );
+        return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+#endif
+    }
+
+#if NGS_CALL_STATS
+
+#if defined _MSC_VER
+#error "NGS_CALL_STATS needs gcc or clang"
+#endif
+
+    /* every method counted gets a slot the first time it is called;
+       every thread that calls one gets a table of slots, kept after it
+       exits so that the totals include it */
+    static const unsigned int MAX_SLOTS = 512;
+
+    struct CallTable
+    {
+        uint64_t calls [ MAX_SLOTS ];
+        uint64_t cycles [ MAX_SLOTS ];
+        CallTable * next;
+    };
+
+    static const char * slot_names [ MAX_SLOTS ];
+    static unsigned int num_slots;
+    static CallTable * tables;
+    static __thread CallTable * thread_table;
+
+    /* guards the slot names and the list of tables;
+       counting itself takes no lock */
+    static volatile int lock_word;
+
+    static
+    void Lock ()
+    {
+        while ( __sync_lock_test_and_set ( & lock_word, 1 ) )
+        {
+            while ( lock_word != 0 )
+                ;
+        }
+    }
+
+    static
+    void Unlock ()
+    {
+        __sync_lock_release ( & lock_word );
+    }
+
+    bool CallStats :: Compiled ()
+        NGS_NOTHROW
+    {
+        return true;
+    }
+
+    void CallStats :: Enable ( bool _on )
+        NGS_NOTHROW
+    {
+        on = _on;
+    }
+
+    unsigned int CallStats :: Register ( const char * method )
+        NGS_NOTHROW
+    {
+        Lock ();
+        unsigned int slot = num_slots;
+        if ( slot < MAX_SLOTS )
+        {
+            slot_names [ slot ] = method;
+            ++ num_slots;
+        }
+        Unlock ();
+
+        // beyond MAX_SLOTS, methods are not counted
+        return slot;
+    }
+
+    void CallStats :: Add ( unsigned int slot, uint64_t cycles )
+        NGS_NOTHROW
+    {
+        if ( slot >= MAX_SLOTS )
+            return;
+
+        CallTable * t = thread_table;
+        if ( t == 0 )
+        {
+            t = new ( std :: nothrow ) CallTable;
+            if ( t == 0 )
+                return;
+            memset ( t, 0, sizeof * t );
+
+            Lock ();
+            t -> next = tables;
+            tables = t;
+            Unlock ();
+
+            thread_table = t;
+        }
+
+        ++ t -> calls [ slot ];
+        t -> cycles [ slot ] += cycles;
+    }
+
+    void CallStats :: Totals ( std :: vector < Entry > & out, bool this_thread_only )
+    {
+        out . clear ();
+
+        Lock ();
+        unsigned int n = num_slots;
+        std :: vector < Entry > sums ( n );
+        for ( unsigned int i = 0; i < n; ++ i )
+        {
+            sums [ i ] . method = slot_names [ i ];
+            sums [ i ] . calls = 0;
+            sums [ i ] . cycles = 0;
+        }
+        for ( const CallTable * t = this_thread_only ? thread_table : tables; t != 0; t = t -> next )
+        {
+            for ( unsigned int i = 0; i < n; ++ i )
+            {
+                sums [ i ] . calls += t -> calls [ i ];
+                sums [ i ] . cycles += t -> cycles [ i ];
+            }
+            if ( this_thread_only )
+                break;
+        }
+        Unlock ();
+
+        for ( unsigned int i = 0; i < n; ++ i )
+        {
+            if ( sums [ i ] . calls != 0 )
+                out . push_back ( sums [ i ] );
+        }
+    }
+
+    void CallStats :: Reset ()
+        NGS_NOTHROW
+    {
+        Lock ();
+        for ( CallTable * t = tables; t != 0; t = t -> next )
+        {
+            memset ( t -> calls, 0, sizeof t -> calls );
+            memset ( t -> cycles, 0, sizeof t -> cycles );
+        }
+        Unlock ();
+    }
+
+    static
+    bool MoreCycles ( const CallStats :: Entry & a, const CallStats :: Entry & b )
+    {
+        return a . cycles > b . cycles;
+    }
+
+    void CallStats :: Dump ( FILE * out )
+    {
+        std :: vector < Entry > totals;
+        Totals ( totals );
+        std :: sort ( totals . begin (), totals . end (), MoreCycles );
+
+        fprintf ( out, "# method\tcalls\tcycles\tcycles_per_call\n" );
+        for ( size_t i = 0; i < totals . size (); ++ i )
+        {
+            const Entry & e = totals [ i ];
+            fprintf ( out, "%s\t%llu\t%llu\t%.1f\n"
+                      , e . method
+                      , ( unsigned long long ) e . calls
+                      , ( unsigned long long ) e . cycles
+                      , ( double ) e . cycles / e . calls
+                );
+        }
+        fflush ( out );
+    }
+
+    /* NGS_CALL_STATS in the environment switches counting on,
+       and says where the totals go at exit */
+    static
+    void DumpAtExit ()
+    {
+        const char * dest = getenv ( "NGS_CALL_STATS" );
+        if ( dest == 0 || strcmp ( dest, "1" ) == 0 )
+        {
+            CallStats :: Dump ( stderr );
+            return;
+        }
+
+        FILE * out = fopen ( dest, "a" );
+        if ( out != 0 )
+        {
+            CallStats :: Dump ( out );
+            fclose ( out );
+        }
+    }
+
+    static struct CallStatsFromEnv
+    {
+        CallStatsFromEnv ()
+        {
+            const char * env = getenv ( "NGS_CALL_STATS" );
+            if ( env != 0 && env [ 0 ] != 0 )
+            {
+                CallStats :: Enable ( true );
+                atexit ( DumpAtExit );
+            }
+        }
+    } call_stats_from_env;
+
+#else
+
+    bool CallStats :: Compiled ()
+        NGS_NOTHROW
+    {
+        return false;
+    }
+
+    void CallStats :: Enable ( bool )
+        NGS_NOTHROW
+    {
+    }
+
+    unsigned int CallStats :: Register ( const char * )
+        NGS_NOTHROW
+    {
+        return 0;
+    }
+
+    void CallStats :: Add ( unsigned int, uint64_t )
+        NGS_NOTHROW
+    {
+    }
+
+    void CallStats :: Totals ( std :: vector < Entry > & out, bool )
+    {
+        out . clear ();
+    }
+
+    void CallStats :: Reset ()
+        NGS_NOTHROW
+    {
+    }
+
+    void CallStats :: Dump ( FILE * )
+    {
+    }
+
+#endif
+
+} // namespace ngs
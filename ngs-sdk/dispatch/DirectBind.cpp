@@ -0,0 +1,107 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/itf/DirectBind.hpp>
+
+#include <string.h>
+
+#include <exception>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * DirectBind
+     */
+
+    bool DirectBound ()
+        NGS_NOTHROW
+    {
+        return NGS_DIRECT_BIND != 0;
+    }
+
+#if NGS_DIRECT_BIND
+
+    /* Tagged
+     *  true for the class name of an adapter class, with our NGS_ADAPT_ABI
+     */
+    static
+    bool DirectTagged ( const char * class_name )
+    {
+        static const char prefix [] = "ngs_adapt::";
+        static const char tag [] = NGS_ADAPT_ABI;
+
+        if ( class_name == 0 || strncmp ( class_name, prefix, sizeof prefix - 1 ) != 0 )
+            return false;
+
+        size_t len = strlen ( class_name );
+        if ( len < sizeof prefix - 1 + sizeof tag - 1 )
+            return false;
+
+        return strcmp ( class_name + len - ( sizeof tag - 1 ), tag ) == 0;
+    }
+
+    bool DirectResolve ( const NGS_VTable * vt, const ItfTok & itf, const DirectTok & tok )
+        NGS_NOTHROW
+    {
+        bool direct = false;
+        try
+        {
+            // the adapter class is of "itf" if its vtable is
+            direct = vt != 0 && DirectTagged ( vt -> class_name ) && Cast ( vt, itf ) != 0;
+        }
+        catch ( ... )
+        {
+        }
+
+        if ( direct )
+            tok . direct = vt;
+        else
+            tok . indirect = vt;
+
+        return direct;
+    }
+
+    void DirectThrow ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        try
+        {
+            throw;
+        }
+        catch ( :: std :: exception & x )
+        {
+            const char * what = x . what ();
+            throw ErrorMsg ( what != 0 ? what : "BAD ERROR MESSAGE" );
+        }
+        catch ( ... )
+        {
+            throw ErrorMsg ( "unknown error" );
+        }
+    }
+
+#endif
+
+} // namespace ngs
@@ -27,10 +27,19 @@
 #include <ngs/itf/FragmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
+#include <ngs/itf/DirectBind.hpp>
 
 #include <ngs/itf/FragmentItf.h>
 
+#include <ngs/itf/StringItf.h>
+
+#if NGS_DIRECT_BIND
+#include <ngs/adapter/FragmentItf.hpp>
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -53,22 +62,64 @@ namespace ngs
         return out;
     }
 
+#if NGS_DIRECT_BIND
+    /*----------------------------------------------------------------------
+     * the adapter object behind a C one, or NULL to go through the vtable
+     */
+    static DirectTok NGS_Fragment_v1_direct;
+
+    static inline
+    const ngs_adapt :: FragmentItf * Direct ( const NGS_Fragment_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_Fragment_v1_tok, NGS_Fragment_v1_direct ) )
+            return ngs_adapt :: FragmentItf :: Self ( self );
+        return 0;
+    }
+
+    static inline
+    ngs_adapt :: FragmentItf * Direct ( NGS_Fragment_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_Fragment_v1_tok, NGS_Fragment_v1_direct ) )
+            return ngs_adapt :: FragmentItf :: Self ( self );
+        return 0;
+    }
+#endif
+
+    /*----------------------------------------------------------------------
+     * view of a string an older engine hands out
+     */
+    static
+    StringItf * View ( StringItf * str, NGS_StringView_v1 & view )
+    {
+        view . data = str -> data ();
+        view . size = str -> size ();
+        return str;
+    }
+
     /*----------------------------------------------------------------------
      * FragmentItf
      */
 
     StringItf * FragmentItf :: getFragmentId () const
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Fragment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getFragmentId () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_id );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_id );
         NGS_String_v1 * ret  = ( * vt -> get_id ) ( self, & err );
 
         // check for errors
@@ -78,29 +129,39 @@ namespace ngs
     }
 
     StringItf * FragmentItf :: getFragmentBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getFragmentBases ( 0, -1 );
     }
 
     StringItf * FragmentItf :: getFragmentBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getFragmentBases ( offset, -1 );
     }
 
     StringItf * FragmentItf :: getFragmentBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Fragment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getFragmentBases ( offset, length ) ) )
+#endif
+
         // cast vtable to our level
         const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_bases );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_bases );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_bases ) ( self, & err, offset, length );
 
         // check for errors
@@ -110,29 +171,39 @@ namespace ngs
     }
 
     StringItf * FragmentItf :: getFragmentQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getFragmentQualities ( 0, -1 );
     }
 
     StringItf * FragmentItf :: getFragmentQualities ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getFragmentQualities ( offset, -1 );
     }
 
     StringItf * FragmentItf :: getFragmentQualities ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Fragment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getFragmentQualities ( offset, length ) ) )
+#endif
+
         // cast vtable to our level
         const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_quals != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_quals );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_quals );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_quals ) ( self, & err, offset, length );
 
         // check for errors
@@ -142,17 +213,25 @@ namespace ngs
     }
 
     bool FragmentItf :: nextFragment ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_Fragment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> nextFragment () )
+#endif
+
         // cast vtable to our level
         const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -162,11 +241,17 @@ namespace ngs
     }
 
     bool FragmentItf :: isPaired () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Fragment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> isPaired () )
+#endif
+
         // cast vtable to our level
         const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
 
@@ -177,6 +262,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> is_paired != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, is_paired );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, is_paired );
         bool ret = ( * vt -> is_paired ) ( self, & err );
 
         // check for errors
@@ -186,11 +273,17 @@ namespace ngs
     }
 
     bool FragmentItf :: isAligned () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Fragment_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> isAligned () )
+#endif
+
         // cast vtable to our level
         const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
 
@@ -201,6 +294,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> is_aligned != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, is_aligned );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, is_aligned );
         bool ret = ( * vt -> is_aligned ) ( self, & err );
 
         // check for errors
@@ -209,4 +304,138 @@ namespace ngs
         return ret;
     }
 
+    StringItf * FragmentItf :: getFragmentBasesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Fragment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getFragmentBasesView ( offset, length, view ) ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.2, view the string handed out
+        if ( vt -> dad . minor_version < 2 )
+            return View ( getFragmentBases ( offset, length ), view );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_bases_view != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_bases_view );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_bases_view );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
+        NGS_String_v1 * ret  = ( * vt -> get_bases_view ) ( self, & err, offset, length, & view );
+
+        // check for errors
+        err . Check ();
+
+        return StringItf :: Cast ( ret );
+    }
+
+    StringItf * FragmentItf :: getFragmentQualitiesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Fragment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getFragmentQualitiesView ( offset, length, view ) ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.2, view the string handed out
+        if ( vt -> dad . minor_version < 2 )
+            return View ( getFragmentQualities ( offset, length ), view );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_quals_view != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_quals_view );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_quals_view );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
+        NGS_String_v1 * ret  = ( * vt -> get_quals_view ) ( self, & err, offset, length, & view );
+
+        // check for errors
+        err . Check ();
+
+        return StringItf :: Cast ( ret );
+    }
+
+    bool FragmentItf :: getFragmentBasesPacked ( uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 & packed ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Fragment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getFragmentBasesPacked ( offset, length, packed ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.3, the bases were only to be had as text
+        if ( vt -> dad . minor_version < 3 )
+            return false;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_packed_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_packed_bases );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_packed_bases );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
+        bool ret = ( * vt -> get_packed_bases ) ( self, & err, offset, length, & packed );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    uint32_t FragmentItf :: getFragmentIndex () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Fragment_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: FragmentItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getFragmentIndex () )
+#endif
+
+        // cast vtable to our level
+        const NGS_Fragment_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.4
+        if ( vt -> dad . minor_version < 4 )
+            throw ErrorMsg ( "the Fragment interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_frag_index != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Fragment_v1_vt, get_frag_index );
+        NGS_RECORD_CALL ( NGS_Fragment_v1_vt, get_frag_index );
+        uint32_t ret = ( * vt -> get_frag_index ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
 } // namespace ngs
@@ -28,6 +28,8 @@
 #include <ngs/itf/AlignmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/PileupEventItf.h>
@@ -60,7 +62,7 @@ namespace ngs
      */
 
     int32_t PileupEventItf :: getMappingQuality () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -71,6 +73,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_map_qual != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_map_qual );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_map_qual );
         int32_t ret  = ( * vt -> get_map_qual ) ( self, & err );
 
         // check for errors
@@ -80,7 +84,7 @@ namespace ngs
     }
 
     StringItf * PileupEventItf :: getAlignmentId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -91,6 +95,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_align_id );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_align_id );
         NGS_String_v1 * ret  = ( * vt -> get_align_id ) ( self, & err );
 
         // check for errors
@@ -100,7 +106,7 @@ namespace ngs
     }
 
     int64_t PileupEventItf :: getAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -111,6 +117,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_pos != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_align_pos );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_align_pos );
         int64_t ret  = ( * vt -> get_align_pos ) ( self, & err );
 
         // check for errors
@@ -120,7 +128,7 @@ namespace ngs
     }
 
     int64_t PileupEventItf :: getFirstAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -131,6 +139,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_first_align_pos != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_first_align_pos );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_first_align_pos );
         int64_t ret  = ( * vt -> get_first_align_pos ) ( self, & err );
 
         // check for errors
@@ -140,7 +150,7 @@ namespace ngs
     }
 
     int64_t PileupEventItf :: getLastAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -151,6 +161,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_last_align_pos != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_last_align_pos );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_last_align_pos );
         int64_t ret  = ( * vt -> get_last_align_pos ) ( self, & err );
 
         // check for errors
@@ -160,7 +172,7 @@ namespace ngs
     }
 
     uint32_t PileupEventItf :: getEventType () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -171,6 +183,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_event_type != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_event_type );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_event_type );
         uint32_t ret  = ( * vt -> get_event_type ) ( self, & err );
 
         // check for errors
@@ -180,7 +194,7 @@ namespace ngs
     }
 
     char PileupEventItf :: getAlignmentBase () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -191,6 +205,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_base != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_align_base );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_align_base );
         char ret  = ( * vt -> get_align_base ) ( self, & err );
 
         // check for errors
@@ -200,7 +216,7 @@ namespace ngs
     }
 
     char PileupEventItf :: getAlignmentQuality () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -211,6 +227,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_qual != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_align_qual );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_align_qual );
         char ret  = ( * vt -> get_align_qual ) ( self, & err );
 
         // check for errors
@@ -220,7 +238,7 @@ namespace ngs
     }
 
     StringItf * PileupEventItf :: getInsertionBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -231,6 +249,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ins_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_ins_bases );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_ins_bases );
         NGS_String_v1 * ret  = ( * vt -> get_ins_bases ) ( self, & err );
 
         // check for errors
@@ -240,7 +260,7 @@ namespace ngs
     }
 
     StringItf * PileupEventItf :: getInsertionQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -251,6 +271,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ins_quals != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_ins_quals );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_ins_quals );
         NGS_String_v1 * ret  = ( * vt -> get_ins_quals ) ( self, & err );
 
         // check for errors
@@ -260,7 +282,7 @@ namespace ngs
     }
 
     uint32_t PileupEventItf :: getEventRepeatCount () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -271,6 +293,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_rpt_count != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_rpt_count );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_rpt_count );
         uint32_t ret  = ( * vt -> get_rpt_count ) ( self, & err );
 
         // check for errors
@@ -280,7 +304,7 @@ namespace ngs
     }
 
     uint32_t PileupEventItf :: getEventIndelType () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_PileupEvent_v1 * self = Test ();
@@ -291,6 +315,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_indel_type != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_indel_type );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_indel_type );
         uint32_t ret  = ( * vt -> get_indel_type ) ( self, & err );
 
         // check for errors
@@ -300,7 +326,7 @@ namespace ngs
     }
 
     bool PileupEventItf :: nextPileupEvent ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_PileupEvent_v1 * self = Test ();
@@ -311,6 +337,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -320,7 +348,7 @@ namespace ngs
     }
 
     void PileupEventItf :: resetPileupEvent ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_PileupEvent_v1 * self = Test ();
@@ -331,10 +359,64 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> reset != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, reset );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, reset );
         ( * vt -> reset ) ( self, & err );
 
         // check for errors
         err . Check ();
     }
+
+    int32_t PileupEventItf :: getReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_PileupEvent_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_PileupEvent_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.1
+        if ( vt -> dad . minor_version < 1 )
+            throw ErrorMsg ( "the PileupEvent interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_ref_index != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_ref_index );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_ref_index );
+        int32_t ret  = ( * vt -> get_ref_index ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    int32_t PileupEventItf :: getMateReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_PileupEvent_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_PileupEvent_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.1
+        if ( vt -> dad . minor_version < 1 )
+            throw ErrorMsg ( "the PileupEvent interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_mate_ref_index != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_PileupEvent_v1_vt, get_mate_ref_index );
+        NGS_RECORD_CALL ( NGS_PileupEvent_v1_vt, get_mate_ref_index );
+        int32_t ret  = ( * vt -> get_mate_ref_index ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
 }
 
@@ -28,9 +28,16 @@
 #include <ngs/itf/PileupEventItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/PileupItf.h>
+#include <ngs/itf/PileupEventItf.h>
+
+#include <ngs/PileupEvent.hpp>
+
+#include <string.h>
 
 namespace ngs
 {
@@ -55,12 +62,123 @@ namespace ngs
     }
 
 
+    /*----------------------------------------------------------------------
+     * columns for engines from before v1.1
+     *  filled in one message per event and field
+     */
+
+    // copies an insertion into the arena if there is room, measuring it anyway
+    static
+    void ColumnString ( NGS_PileupColumn_v1 & column, uint32_t i, NGS_PileupColumnString_v1 * dst, StringItf * str )
+    {
+        uint32_t const size = str != 0 ? ( uint32_t ) str -> size () : 0;
+        if ( i < column . capacity )
+        {
+            dst [ i ] . offset = column . arena_used;
+            dst [ i ] . size = size;
+            if ( size != 0 && column . arena_used <= column . arena_size && size <= column . arena_size - column . arena_used )
+                memcpy ( column . arena + column . arena_used, str -> data (), size );
+        }
+        column . arena_used += size;
+        if ( str != 0 )
+            str -> Release ();
+    }
+
+    static
+    bool FillColumn ( PileupEventItf * event, NGS_PileupColumn_v1 & column )
+    {
+        uint32_t const fields = column . fields;
+        uint32_t const insertions = NGS_PileupColumnFields_ins_bases | NGS_PileupColumnFields_ins_quals;
+
+        column . count = 0;
+        column . arena_used = 0;
+
+        event -> resetPileupEvent ();
+        while ( event -> nextPileupEvent () )
+        {
+            uint32_t const i = column . count ++;
+            bool const fits = i < column . capacity;
+
+            // past the room there is, only the insertions are still measured
+            if ( ! fits && ( fields & insertions ) == 0 )
+                continue;
+
+            uint32_t const type = ( fields & ( NGS_PileupColumnFields_event_type | insertions ) ) != 0
+                ? event -> getEventType () : 0;
+            if ( fits )
+            {
+                if ( ( fields & NGS_PileupColumnFields_event_type ) != 0 )
+                    column . event_type [ i ] = type;
+                if ( ( fields & NGS_PileupColumnFields_base ) != 0 )
+                    column . base [ i ] = event -> getAlignmentBase ();
+                if ( ( fields & NGS_PileupColumnFields_qual ) != 0 )
+                    column . qual [ i ] = event -> getAlignmentQuality ();
+                if ( ( fields & NGS_PileupColumnFields_map_qual ) != 0 )
+                    column . map_qual [ i ] = event -> getMappingQuality ();
+            }
+
+            // only an insertion has bases to ask for
+            bool const inserted = ( type & PileupEvent :: insertion ) != 0;
+            if ( ( fields & NGS_PileupColumnFields_ins_bases ) != 0 )
+                ColumnString ( column, i, column . ins_bases, inserted ? event -> getInsertionBases () : 0 );
+            if ( ( fields & NGS_PileupColumnFields_ins_quals ) != 0 )
+                ColumnString ( column, i, column . ins_quals, inserted ? event -> getInsertionQualities () : 0 );
+        }
+        event -> resetPileupEvent ();
+
+        return column . count <= column . capacity && column . arena_used <= column . arena_size;
+    }
+
+    /*----------------------------------------------------------------------
+     * base counts for engines from before v1.2
+     *  counted from one message per event and field
+     */
+
+    static
+    uint32_t BaseCountKind ( char base )
+    {
+        switch ( base )
+        {
+        case 'A': case 'a':
+            return NGS_PileupBaseCount_A;
+        case 'C': case 'c':
+            return NGS_PileupBaseCount_C;
+        case 'G': case 'g':
+            return NGS_PileupBaseCount_G;
+        case 'T': case 't':
+            return NGS_PileupBaseCount_T;
+        }
+        return NGS_PileupBaseCount_N;
+    }
+
+    static
+    void CountBases ( PileupEventItf * event, int32_t minQuality, NGS_PileupBaseCounts_v1 & counts )
+    {
+        memset ( counts . plus, 0, sizeof counts . plus );
+        memset ( counts . minus, 0, sizeof counts . minus );
+
+        event -> resetPileupEvent ();
+        while ( event -> nextPileupEvent () )
+        {
+            uint32_t const type = event -> getEventType ();
+            uint32_t * const count = ( type & PileupEvent :: alignment_minus_strand ) != 0 ? counts . minus : counts . plus;
+
+            if ( ( type & PileupEvent :: insertion ) != 0 )
+                ++ count [ NGS_PileupBaseCount_insertion ];
+            if ( ( type & 7 ) == PileupEvent :: deletion )
+                ++ count [ NGS_PileupBaseCount_deletion ];
+            else if ( event -> getAlignmentQuality () - 33 >= minQuality )
+                ++ count [ BaseCountKind ( event -> getAlignmentBase () ) ];
+        }
+        event -> resetPileupEvent ();
+    }
+
     /*----------------------------------------------------------------------
      * PileupItf
      */
 
     StringItf * PileupItf :: getReferenceSpec () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Pileup_v1 * self = Test ();
@@ -71,6 +189,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_spec != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, get_ref_spec );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, get_ref_spec );
         NGS_String_v1 * ret  = ( * vt -> get_ref_spec ) ( self, & err );
 
         // check for errors
@@ -80,7 +200,7 @@ namespace ngs
     }
 
     int64_t PileupItf :: getReferencePosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Pileup_v1 * self = Test ();
@@ -91,6 +211,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_pos != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, get_ref_pos );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, get_ref_pos );
         int64_t ret  = ( * vt -> get_ref_pos ) ( self, & err );
 
         // check for errors
@@ -100,7 +222,7 @@ namespace ngs
     }
 
     char PileupItf :: getReferenceBase () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Pileup_v1 * self = Test ();
@@ -111,6 +233,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_base != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, get_ref_base );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, get_ref_base );
         char ret  = ( * vt -> get_ref_base ) ( self, & err );
 
         // check for errors
@@ -120,7 +244,7 @@ namespace ngs
     }
 
     uint32_t PileupItf :: getPileupDepth () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Pileup_v1 * self = Test ();
@@ -131,6 +255,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_pileup_depth != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, get_pileup_depth );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, get_pileup_depth );
         uint32_t ret  = ( * vt -> get_pileup_depth ) ( self, & err );
 
         // check for errors
@@ -140,7 +266,7 @@ namespace ngs
     }
 
     bool PileupItf :: nextPileup ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_Pileup_v1 * self = Test ();
@@ -151,6 +277,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -158,5 +286,96 @@ namespace ngs
 
         return ret;
     }
-}
 
+    bool PileupItf :: getColumn ( NGS_PileupColumn_v1 & column )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Pileup_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Pileup_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.1
+        if ( vt -> dad . minor_version < 1 )
+            return FillColumn ( reinterpret_cast < PileupEventItf * > ( this ), column );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_column != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, get_column );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, get_column );
+        NGS_RECORD_ARG ( column . fields );
+        NGS_RECORD_ARG ( column . capacity );
+        NGS_RECORD_ARG ( column . arena_size );
+        bool ret  = ( * vt -> get_column ) ( self, & err, & column );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    uint32_t PileupItf :: getBaseCounts ( int32_t minQuality, uint32_t count, NGS_PileupBaseCounts_v1 * counts )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Pileup_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Pileup_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.2
+        if ( vt -> dad . minor_version < 2 )
+        {
+            uint32_t i = 0;
+            for ( ; i < count; ++ i )
+            {
+                if ( i != 0 && ! nextPileup () )
+                    break;
+                counts [ i ] . position = getReferencePosition ();
+                CountBases ( reinterpret_cast < PileupEventItf * > ( this ), minQuality, counts [ i ] );
+            }
+            return i;
+        }
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_base_counts != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, get_base_counts );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, get_base_counts );
+        NGS_RECORD_ARG ( minQuality );
+        NGS_RECORD_ARG ( count );
+        uint32_t ret  = ( * vt -> get_base_counts ) ( self, & err, minQuality, count, counts );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    void PileupItf :: extendTo ( int64_t newEnd )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Pileup_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Pileup_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.3
+        if ( vt -> dad . minor_version < 3 )
+            throw ErrorMsg ( "the Pileup interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> extend_to != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Pileup_v1_vt, extend_to );
+        NGS_RECORD_CALL ( NGS_Pileup_v1_vt, extend_to );
+        NGS_RECORD_ARG ( newEnd );
+        ( * vt -> extend_to ) ( self, & err, newEnd );
+
+        // check for errors
+        err . Check ();
+    }
+}
@@ -34,6 +34,8 @@
 #include <ngs/itf/StatisticsItf.hpp>
 
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/ReadCollectionItf.h>
@@ -41,6 +43,8 @@
 #include <ngs/Alignment.hpp>
 #include <ngs/Read.hpp>
 
+#include <string.h>
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -62,12 +66,121 @@ namespace ngs
         return out;
     }
 
+    /*----------------------------------------------------------------------
+     * reference table
+     *  before v1.5, it is filled in by walking the references
+     */
+
+    // holds a name handed out by the engine until it is copied
+    struct TableName
+    {
+        TableName ( StringItf * _str )
+            : str ( _str )
+        {
+        }
+
+        ~ TableName ()
+        {
+            if ( str != 0 )
+                str -> Release ();
+        }
+
+        // copies the name into the arena if it fits, counting it either way
+        void Copy ( NGS_ReferenceTable_v1 & table, NGS_ReferenceTableString_v1 * column, uint32_t i ) const
+        {
+            size_t const size = str -> size ();
+            if ( size > ~ ( uint32_t ) 0 - table . arena_used )
+                throw ErrorMsg ( "reference names are too long for a reference table" );
+
+            if ( i < table . capacity && table . arena_used <= table . arena_size
+                 && size <= table . arena_size - table . arena_used )
+            {
+                column [ i ] . offset = table . arena_used;
+                column [ i ] . size = ( uint32_t ) size;
+                memcpy ( table . arena + table . arena_used, str -> data (), size );
+            }
+            table . arena_used += ( uint32_t ) size;
+        }
+
+        StringItf * str;
+
+    private:
+
+        TableName ( const TableName & );
+        TableName & operator = ( const TableName & );
+    };
+
+    static
+    void FillReferenceRow ( const ReferenceItf * ref, NGS_ReferenceTable_v1 & table, uint32_t i )
+    {
+        if ( ( table . filled & NGS_ReferenceTableFields_common_name ) != 0 )
+            TableName ( ref -> getCommonName () ) . Copy ( table, table . common_name, i );
+
+        // canonical names and circularity are not known to every engine
+        if ( ( table . filled & NGS_ReferenceTableFields_canonical_name ) != 0 )
+        {
+            StringItf * name = 0;
+            try
+            {
+                name = ref -> getCanonicalName ();
+            }
+            catch ( ErrorMsg & )
+            {
+                table . filled &= ~ NGS_ReferenceTableFields_canonical_name;
+            }
+            if ( name != 0 )
+                TableName ( name ) . Copy ( table, table . canonical_name, i );
+        }
+
+        if ( i >= table . capacity )
+            return;
+
+        if ( ( table . filled & NGS_ReferenceTableFields_length ) != 0 )
+            table . length [ i ] = ref -> getLength ();
+        if ( ( table . filled & NGS_ReferenceTableFields_circular ) != 0 )
+        {
+            try
+            {
+                table . circular [ i ] = ref -> getIsCircular () ? 1 : 0;
+            }
+            catch ( ErrorMsg & )
+            {
+                table . filled &= ~ NGS_ReferenceTableFields_circular;
+            }
+        }
+    }
+
+    static
+    bool FillReferenceTable ( const ReadCollectionItf * rc, NGS_ReferenceTable_v1 & table )
+    {
+        table . count = 0;
+        table . arena_used = 0;
+        table . filled = table . fields
+            & ( NGS_ReferenceTableFields_common_name | NGS_ReferenceTableFields_canonical_name
+              | NGS_ReferenceTableFields_length | NGS_ReferenceTableFields_circular );
+
+        ReferenceItf * ref = rc -> getReferences ();
+        try
+        {
+            while ( ref -> nextReference () )
+                FillReferenceRow ( ref, table, table . count ++ );
+        }
+        catch ( ... )
+        {
+            ref -> Release ();
+            throw;
+        }
+        ref -> Release ();
+
+        return table . count <= table . capacity && table . arena_used <= table . arena_size;
+    }
+
     /*----------------------------------------------------------------------
      * ReadCollectionItf
      */
 
     StringItf * ReadCollectionItf :: getName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -78,6 +191,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_name != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_name );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_name );
         NGS_String_v1 * ret  = ( * vt -> get_name ) ( self, & err );
 
         // check for errors
@@ -87,7 +202,7 @@ namespace ngs
     }
 
     ReadGroupItf * ReadCollectionItf :: getReadGroups () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -98,7 +213,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read_groups != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_read_groups );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_read_groups );
         NGS_ReadGroup_v1 * ret  = ( * vt -> get_read_groups ) ( self, & err );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -107,7 +225,7 @@ namespace ngs
     }
 
     bool ReadCollectionItf :: hasReadGroup ( const char * spec ) const
-        throw ()
+        NGS_NOTHROW
     {
         try
         {
@@ -130,6 +248,9 @@ namespace ngs
 
             // call through C vtable
             assert ( vt -> has_read_group != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, has_read_group );
+            NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, has_read_group );
+            NGS_RECORD_ARG ( spec );
             return ( * vt -> has_read_group ) ( self, spec );
         }
         catch ( ... )
@@ -140,7 +261,7 @@ namespace ngs
     }
 
     ReadGroupItf * ReadCollectionItf :: getReadGroup ( const char * spec ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -151,7 +272,11 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read_group != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_read_group );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_read_group );
+        NGS_RECORD_ARG ( spec );
         NGS_ReadGroup_v1 * ret  = ( * vt -> get_read_group ) ( self, & err, spec );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -160,7 +285,7 @@ namespace ngs
     }
 
     ReferenceItf * ReadCollectionItf :: getReferences () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -171,7 +296,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_references != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_references );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_references );
         NGS_Reference_v1 * ret  = ( * vt -> get_references ) ( self, & err );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -180,7 +308,7 @@ namespace ngs
     }
 
     bool ReadCollectionItf :: hasReference ( const char * spec ) const
-        throw ()
+        NGS_NOTHROW
     {
         try
         {
@@ -203,6 +331,9 @@ namespace ngs
 
             // call through C vtable
             assert ( vt -> has_reference != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, has_reference );
+            NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, has_reference );
+            NGS_RECORD_ARG ( spec );
             return ( * vt -> has_reference ) ( self, spec );
         }
         catch ( ... )
@@ -213,7 +344,7 @@ namespace ngs
     }
 
     ReferenceItf * ReadCollectionItf :: getReference ( const char * spec ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -224,7 +355,11 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_reference != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_reference );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_reference );
+        NGS_RECORD_ARG ( spec );
         NGS_Reference_v1 * ret  = ( * vt -> get_reference ) ( self, & err, spec );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -233,7 +368,7 @@ namespace ngs
     }
 
     AlignmentItf * ReadCollectionItf :: getAlignment ( const char * alignmentId ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -244,7 +379,11 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_alignment != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_alignment );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_alignment );
+        NGS_RECORD_ARG ( alignmentId );
         NGS_Alignment_v1 * ret  = ( * vt -> get_alignment ) ( self, & err, alignmentId );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -253,7 +392,7 @@ namespace ngs
     }
 
     AlignmentItf * ReadCollectionItf :: getAlignments ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -264,10 +403,14 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_alignments != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_alignments );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_alignments );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary = ( categories & Alignment :: primaryAlignment );
         bool wants_secondary
             = ( categories & Alignment :: secondaryAlignment ) != 0;
         NGS_Alignment_v1 * ret  = ( * vt -> get_alignments ) ( self, & err, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -276,7 +419,7 @@ namespace ngs
     }
 
     uint64_t ReadCollectionItf :: getAlignmentCount ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -287,6 +430,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_count != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_align_count );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_align_count );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary = ( categories & Alignment :: primaryAlignment );
         bool wants_secondary
             = ( categories & Alignment :: secondaryAlignment ) != 0;
@@ -299,7 +445,7 @@ namespace ngs
     }
 
     AlignmentItf * ReadCollectionItf :: getAlignmentRange ( uint64_t first, uint64_t count, uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -310,10 +456,57 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_range != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_align_range );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_align_range );
+        NGS_RECORD_ARG ( first );
+        NGS_RECORD_ARG ( count );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary = ( categories & Alignment :: primaryAlignment );
         bool wants_secondary
             = ( categories & Alignment :: secondaryAlignment ) != 0;
         NGS_Alignment_v1 * ret  = ( * vt -> get_align_range ) ( self, & err, first, count, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
+
+        // check for errors
+        err . Check ();
+
+        return AlignmentItf :: Cast ( ret );
+    }
+
+    AlignmentItf * ReadCollectionItf :: getAlignmentShard ( uint32_t shard, uint32_t count, uint32_t categories ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_ReadCollection_v1 * self = Test ();
+
+        if ( shard >= count )
+            throw ErrorMsg ( "shard is out of range" );
+
+        // cast vtable to our level
+        const NGS_ReadCollection_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.2
+        if ( vt -> dad . minor_version < 2 )
+        {
+            // split the rows evenly
+            uint64_t total = getAlignmentCount ( Alignment :: all );
+            uint64_t first = total / count * shard + total % count * shard / count;
+            uint64_t last = total / count * ( shard + 1 ) + total % count * ( shard + 1 ) / count;
+            return getAlignmentRange ( first + 1, last - first, categories );
+        }
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_align_shard != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_align_shard );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_align_shard );
+        NGS_RECORD_ARG ( shard );
+        NGS_RECORD_ARG ( count );
+        NGS_RECORD_ARG ( categories );
+        bool wants_primary = ( categories & Alignment :: primaryAlignment ) != 0;
+        bool wants_secondary = ( categories & Alignment :: secondaryAlignment ) != 0;
+        NGS_Alignment_v1 * ret  = ( * vt -> get_align_shard ) ( self, & err, shard, count, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -322,7 +515,7 @@ namespace ngs
     }
 
     ReadItf * ReadCollectionItf :: getRead ( const char * readId ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -333,7 +526,11 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_read );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_read );
+        NGS_RECORD_ARG ( readId );
         NGS_Read_v1 * ret  = ( * vt -> get_read ) ( self, & err, readId );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -342,7 +539,7 @@ namespace ngs
     }
 
     ReadItf * ReadCollectionItf :: getReads ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -353,10 +550,14 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_reads != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_reads );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_reads );
+        NGS_RECORD_ARG ( categories );
         bool wants_full         = ( categories & Read :: fullyAligned ) != 0;
         bool wants_partial      = ( categories & Read :: partiallyAligned ) != 0;
         bool wants_unaligned    = ( categories & Read :: unaligned ) != 0;
         NGS_Read_v1 * ret  = ( * vt -> get_reads ) ( self, & err, wants_full, wants_partial, wants_unaligned );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -365,7 +566,7 @@ namespace ngs
     }
 
     uint64_t ReadCollectionItf :: getReadCount ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -376,6 +577,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read_count != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_read_count );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_read_count );
+        NGS_RECORD_ARG ( categories );
         bool wants_full         = ( categories & Read :: fullyAligned ) != 0;
         bool wants_partial      = ( categories & Read :: partiallyAligned ) != 0;
         bool wants_unaligned    = ( categories & Read :: unaligned ) != 0;
@@ -388,7 +592,7 @@ namespace ngs
     }
     
     ReadItf * ReadCollectionItf :: getReadRange ( uint64_t first, uint64_t count ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -399,7 +603,12 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_reads != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_read_range );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_read_range );
+        NGS_RECORD_ARG ( first );
+        NGS_RECORD_ARG ( count );
         NGS_Read_v1 * ret  = ( * vt -> get_read_range ) ( self, & err, first, count, true, true, true );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -408,7 +617,7 @@ namespace ngs
     }
 
     ReadItf * ReadCollectionItf :: getReadRange ( uint64_t first, uint64_t count, uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadCollection_v1 * self = Test ();
@@ -422,7 +631,13 @@ namespace ngs
         bool wants_full         = ( categories & Read :: fullyAligned ) != 0;
         bool wants_partial      = ( categories & Read :: partiallyAligned ) != 0;
         bool wants_unaligned    = ( categories & Read :: unaligned ) != 0;
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_read_range );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_read_range );
+        NGS_RECORD_ARG ( first );
+        NGS_RECORD_ARG ( count );
+        NGS_RECORD_ARG ( categories );
         NGS_Read_v1 * ret  = ( * vt -> get_read_range ) ( self, & err, first, count, wants_full, wants_partial, wants_unaligned );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -430,5 +645,87 @@ namespace ngs
         return ReadItf :: Cast ( ret );
     }
 
+    uint32_t ReadCollectionItf :: getFeatures () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_ReadCollection_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_ReadCollection_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.3, nothing was said, so all is claimed
+        if ( vt -> dad . minor_version < 3 )
+            return NGS_ReadCollectionFeature_all;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_features != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_features );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_features );
+        uint32_t ret  = ( * vt -> get_features ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    StatisticsItf * ReadCollectionItf :: getStatistics () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_ReadCollection_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_ReadCollection_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.4
+        if ( vt -> dad . minor_version < 4 )
+            throw ErrorMsg ( "the ReadCollection interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_statistics != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_statistics );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_statistics );
+        NGS_Statistics_v1 * ret  = ( * vt -> get_statistics ) ( self, & err );
+        NGS_RECORD_RESULT ( ret );
+
+        // check for errors
+        err . Check ();
+
+        return StatisticsItf :: Cast ( ret );
+    }
+
+    bool ReadCollectionItf :: getReferenceTable ( NGS_ReferenceTable_v1 & table ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_ReadCollection_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_ReadCollection_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.5
+        if ( vt -> dad . minor_version < 5 )
+            return FillReferenceTable ( this, table );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_reference_table != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadCollection_v1_vt, get_reference_table );
+        NGS_RECORD_CALL ( NGS_ReadCollection_v1_vt, get_reference_table );
+        NGS_RECORD_ARG ( table . fields );
+        NGS_RECORD_ARG ( table . capacity );
+        NGS_RECORD_ARG ( table . arena_size );
+        bool ret  = ( * vt -> get_reference_table ) ( self, & err, & table );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
 
 } // namespace ngs
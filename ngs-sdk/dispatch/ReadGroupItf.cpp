@@ -28,6 +28,8 @@
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/StatisticsItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/ReadGroupItf.h>
@@ -58,7 +60,7 @@ namespace ngs
      */
 
     StringItf * ReadGroupItf :: getName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadGroup_v1 * self = Test ();
@@ -69,6 +71,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_name != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadGroup_v1_vt, get_name );
+        NGS_RECORD_CALL ( NGS_ReadGroup_v1_vt, get_name );
         NGS_String_v1 * ret  = ( * vt -> get_name ) ( self, & err );
 
         // check for errors
@@ -78,7 +82,7 @@ namespace ngs
     }
 
     StatisticsItf * ReadGroupItf :: getStatistics () const 
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReadGroup_v1 * self = Test ();
@@ -89,7 +93,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_stats != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadGroup_v1_vt, get_stats );
+        NGS_RECORD_CALL ( NGS_ReadGroup_v1_vt, get_stats );
         NGS_Statistics_v1 * ret  = ( * vt -> get_stats ) ( self, & err );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -98,7 +105,7 @@ namespace ngs
     }
 
     bool ReadGroupItf :: nextReadGroup ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_ReadGroup_v1 * self = Test ();
@@ -109,6 +116,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReadGroup_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_ReadGroup_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -27,10 +27,17 @@
 #include <ngs/itf/ReadItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
+#include <ngs/itf/DirectBind.hpp>
 
 #include <ngs/itf/ReadItf.h>
 
+#if NGS_DIRECT_BIND
+#include <ngs/adapter/ReadItf.hpp>
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -53,22 +60,82 @@ namespace ngs
         return out;
     }
 
+    /*----------------------------------------------------------------------
+     * the row number that ends a read ID, for engines before v1.3
+     */
+    static
+    uint64_t ParseRowId ( StringItf * id )
+    {
+        const char * data = id -> data ();
+        size_t end = id -> size ();
+
+        // the digits the ID ends with, as in "SRR000001.R.12" or "12"
+        size_t start = end;
+        while ( start > 0 && data [ start - 1 ] >= '0' && data [ start - 1 ] <= '9' )
+            -- start;
+
+        uint64_t row = 0;
+        bool numeric = start < end;
+        for ( size_t i = start; numeric && i < end; ++ i )
+        {
+            unsigned digit = ( unsigned ) ( data [ i ] - '0' );
+            numeric = row <= ( ( uint64_t ) -1 - digit ) / 10;
+            row = row * 10 + digit;
+        }
+        id -> Release ();
+
+        if ( ! numeric )
+            throw ErrorMsg ( "the read IDs of this NGS engine do not end in a row number" );
+        return row;
+    }
+
+#if NGS_DIRECT_BIND
+    /*----------------------------------------------------------------------
+     * the adapter object behind a C one, or NULL to go through the vtable
+     */
+    static DirectTok NGS_Read_v1_direct;
+
+    static inline
+    const ngs_adapt :: ReadItf * Direct ( const NGS_Read_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_Read_v1_tok, NGS_Read_v1_direct ) )
+            return ngs_adapt :: ReadItf :: Self ( self );
+        return 0;
+    }
+
+    static inline
+    ngs_adapt :: ReadItf * Direct ( NGS_Read_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_Read_v1_tok, NGS_Read_v1_direct ) )
+            return ngs_adapt :: ReadItf :: Self ( self );
+        return 0;
+    }
+#endif
+
     /*----------------------------------------------------------------------
      * ReadItf
      */
 
     StringItf * ReadItf :: getReadId () const
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadId () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_id );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_id );
         NGS_String_v1 * ret  = ( * vt -> get_id ) ( self, & err );
 
         // check for errors
@@ -78,17 +145,25 @@ namespace ngs
     }
 
     uint32_t ReadItf :: getNumFragments () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getNumFragments () )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_num_frags != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_num_frags );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_num_frags );
         uint32_t ret  = ( * vt -> get_num_frags ) ( self, & err );
 
         // check for errors
@@ -98,7 +173,7 @@ namespace ngs
     }
 
     bool ReadItf :: fragmentIsAligned ( uint32_t fragIdx ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
@@ -113,6 +188,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> frag_is_aligned != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, frag_is_aligned );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, frag_is_aligned );
+        NGS_RECORD_ARG ( fragIdx );
         bool ret  = ( * vt -> frag_is_aligned ) ( self, & err, fragIdx );
 
         // check for errors
@@ -122,17 +200,25 @@ namespace ngs
     }
 
     uint32_t ReadItf :: getReadCategory () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getReadCategory () )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_category != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_category );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_category );
         uint32_t ret  = ( * vt -> get_category ) ( self, & err );
 
         // check for errors
@@ -142,17 +228,25 @@ namespace ngs
     }
 
     StringItf * ReadItf :: getReadGroup () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadGroup () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_read_group != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_read_group );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_read_group );
         NGS_String_v1 * ret  = ( * vt -> get_read_group ) ( self, & err );
 
         // check for errors
@@ -162,17 +256,25 @@ namespace ngs
     }
 
     StringItf * ReadItf :: getReadName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadName () ) )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_name != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_name );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_name );
         NGS_String_v1 * ret  = ( * vt -> get_name ) ( self, & err );
 
         // check for errors
@@ -182,29 +284,39 @@ namespace ngs
     }
 
     StringItf * ReadItf :: getReadBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReadBases ( 0, -1 );
     }
 
     StringItf * ReadItf :: getReadBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReadBases ( offset, -1 );
     }
 
     StringItf * ReadItf :: getReadBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadBases ( offset, length ) ) )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_bases );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_bases );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_bases ) ( self, & err, offset, length );
 
         // check for errors
@@ -214,29 +326,39 @@ namespace ngs
     }
 
     StringItf * ReadItf :: getReadQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReadQualities ( 0, -1 );
     }
 
     StringItf * ReadItf :: getReadQualities ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReadQualities ( offset, -1 );
     }
 
     StringItf * ReadItf :: getReadQualities ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getReadQualities ( offset, length ) ) )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_quals != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_quals );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_quals );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_quals ) ( self, & err, offset, length );
 
         // check for errors
@@ -246,17 +368,25 @@ namespace ngs
     }
 
     bool ReadItf :: nextRead ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_Read_v1 * self = Test ();
 
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> nextRead () )
+#endif
+
         // cast vtable to our level
         const NGS_Read_v1_vt * vt = Access ( self -> vt );
 
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -265,4 +395,99 @@ namespace ngs
         return ret;
     }
 
+    StringItf * ReadItf :: getCursor () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Read_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return DirectString ( direct -> getCursor () ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Read_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.2
+        if ( vt -> dad . minor_version < 2 )
+            throw ErrorMsg ( "the Read interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_cursor != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_cursor );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_cursor );
+        NGS_String_v1 * ret  = ( * vt -> get_cursor ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return StringItf :: Cast ( ret );
+    }
+
+    void ReadItf :: resumeFrom ( const char * cursor )
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        NGS_Read_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> resumeFrom ( cursor ) )
+#endif
+
+        // cast vtable to our level
+        const NGS_Read_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.2
+        if ( vt -> dad . minor_version < 2 )
+            throw ErrorMsg ( "the Read interface provided by this NGS engine is too old to support this message" );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> resume_from != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, resume_from );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, resume_from );
+        NGS_RECORD_ARG ( cursor );
+        ( * vt -> resume_from ) ( self, & err, cursor );
+
+        // check for errors
+        err . Check ();
+    }
+
+    uint64_t ReadItf :: getReadRowId () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Read_v1 * self = Test ();
+
+#if NGS_DIRECT_BIND
+        // or from the adapter classes, to be called directly
+        if ( const ngs_adapt :: ReadItf * direct = Direct ( self ) )
+            NGS_DIRECT_CALL ( return direct -> getReadRowId () )
+#endif
+
+        // cast vtable to our level
+        const NGS_Read_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.3, parse it from the ID
+        if ( vt -> dad . minor_version < 3 )
+            return ParseRowId ( getReadId () );
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_row_id != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Read_v1_vt, get_row_id );
+        NGS_RECORD_CALL ( NGS_Read_v1_vt, get_row_id );
+        uint64_t ret = ( * vt -> get_row_id ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
 } // namespace ngs
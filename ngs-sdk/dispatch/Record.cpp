@@ -0,0 +1,463 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/itf/Record.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <map>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * Record
+     *  the calls through the dispatch layer, in the order made
+     */
+
+    bool Record :: on;
+
+#if NGS_RECORD
+
+#if defined _MSC_VER
+#error "NGS_RECORD needs gcc or clang"
+#endif
+
+    static const unsigned int MAX_SLOTS = 512;
+
+    /* what a method does to the objects it is called on */
+    enum SlotKind
+    {
+        kind_call,
+        kind_release,
+        kind_duplicate
+    };
+
+    static const char * slot_names [ MAX_SLOTS ];
+    static unsigned char slot_kinds [ MAX_SLOTS ];
+    static bool slot_written [ MAX_SLOTS ];
+    static unsigned int num_slots;
+
+    /* an object seen, by its address, with the references to it that
+       the caller was given and hasn't released */
+    struct Object
+    {
+        uint64_t id;
+        uint64_t refs;
+    };
+
+    typedef std :: map < const void *, Object > Objects;
+
+    static FILE * out;
+    static Objects objects;
+    static uint64_t next_id;
+    static uint64_t origin;
+    static unsigned int num_threads;
+
+    static __thread unsigned int thread_id;
+    static __thread unsigned int thread_quiet;
+
+    /* what goes to the file, written out when full */
+    static unsigned char buffer [ 1 << 20 ];
+    static size_t buffered;
+
+    /* guards all of the above but the per-thread values */
+    static volatile int lock_word;
+
+    static
+    void Lock ()
+    {
+        while ( __sync_lock_test_and_set ( & lock_word, 1 ) )
+        {
+            while ( lock_word != 0 )
+                ;
+        }
+    }
+
+    static
+    void Unlock ()
+    {
+        __sync_lock_release ( & lock_word );
+    }
+
+    static
+    uint64_t Now ()
+    {
+        struct timespec ts;
+        clock_gettime ( CLOCK_MONOTONIC, & ts );
+        return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+    }
+
+    static
+    unsigned int PutVarint ( unsigned char * dst, uint64_t value )
+    {
+        unsigned int n = 0;
+        while ( value >= 0x80 )
+        {
+            dst [ n ++ ] = ( unsigned char ) ( value | 0x80 );
+            value >>= 7;
+        }
+        dst [ n ++ ] = ( unsigned char ) value;
+        return n;
+    }
+
+    static
+    void Flush ()
+    {
+        if ( buffered != 0 && out != 0 )
+            fwrite ( buffer, 1, buffered, out );
+        buffered = 0;
+    }
+
+    /* room for "bytes" more in the buffer */
+    static
+    unsigned char * Reserve ( size_t bytes )
+    {
+        if ( buffered + bytes > sizeof buffer )
+            Flush ();
+        return buffer + buffered;
+    }
+
+    static
+    void PutRecord ( const unsigned char * rec, size_t size )
+    {
+        memmove ( Reserve ( size ), rec, size );
+        buffered += size;
+    }
+
+    static
+    void PutMethod ( unsigned int slot )
+    {
+        if ( slot_written [ slot ] )
+            return;
+        slot_written [ slot ] = true;
+
+        size_t len = strlen ( slot_names [ slot ] );
+        unsigned char * dst = Reserve ( 1 + 10 + 10 + len );
+        unsigned int n = 0;
+        dst [ n ++ ] = 'M';
+        n += PutVarint ( dst + n, slot );
+        n += PutVarint ( dst + n, len );
+        memmove ( dst + n, slot_names [ slot ], len );
+        buffered += n + len;
+    }
+
+    /* the id of "obj", counting a reference to it; "opened" says that
+       the caller had it before the dispatch layer saw it */
+    static
+    uint64_t Seen ( const void * obj, unsigned int slot, bool opened )
+    {
+        Objects :: iterator it = objects . find ( obj );
+        if ( it != objects . end () )
+        {
+            if ( ! opened )
+                ++ it -> second . refs;
+            return it -> second . id;
+        }
+
+        Object o;
+        o . id = ++ next_id;
+        o . refs = 1;
+        objects [ obj ] = o;
+
+        if ( opened )
+        {
+            unsigned char rec [ 21 ];
+            unsigned int n = 0;
+            rec [ n ++ ] = 'O';
+            n += PutVarint ( rec + n, o . id );
+            n += PutVarint ( rec + n, slot );
+            PutRecord ( rec, n );
+        }
+
+        return o . id;
+    }
+
+    bool Record :: Compiled ()
+        NGS_NOTHROW
+    {
+        return true;
+    }
+
+    bool Record :: Start ( const char * path )
+        NGS_NOTHROW
+    {
+        Stop ();
+
+        FILE * f = fopen ( path, "wb" );
+        if ( f == 0 )
+            return false;
+        fwrite ( "NGSREC1\n", 1, 8, f );
+
+        Lock ();
+        out = f;
+        objects . clear ();
+        next_id = 0;
+        origin = Now ();
+        memset ( slot_written, 0, sizeof slot_written );
+        on = true;
+        Unlock ();
+
+        return true;
+    }
+
+    void Record :: Stop ()
+        NGS_NOTHROW
+    {
+        Lock ();
+        on = false;
+        Flush ();
+        if ( out != 0 )
+            fclose ( out );
+        out = 0;
+        objects . clear ();
+        Unlock ();
+    }
+
+    unsigned int Record :: Register ( const char * method )
+        NGS_NOTHROW
+    {
+        Lock ();
+        unsigned int slot = num_slots;
+        if ( slot < MAX_SLOTS )
+        {
+            slot_names [ slot ] = method;
+            if ( strcmp ( method, "NGS_Refcount_v1_vt::release" ) == 0 )
+                slot_kinds [ slot ] = kind_release;
+            else if ( strcmp ( method, "NGS_Refcount_v1_vt::duplicate" ) == 0 )
+                slot_kinds [ slot ] = kind_duplicate;
+            else
+                slot_kinds [ slot ] = kind_call;
+            ++ num_slots;
+        }
+        Unlock ();
+
+        // beyond MAX_SLOTS, methods are not recorded
+        return slot;
+    }
+
+    Record :: Call :: Call ( unsigned int _slot, const void * _self )
+        NGS_NOTHROW
+        : self ( 0 )
+        , result ( 0 )
+        , slot ( _slot )
+        , count ( 0 )
+        , used ( 0 )
+        , start ( 0 )
+    {
+        if ( on && thread_quiet == 0 && slot < MAX_SLOTS && _self != 0 )
+        {
+            // what the engine does through the dispatch layer to answer is its own
+            ++ thread_quiet;
+            self = _self;
+            start = Now ();
+        }
+    }
+
+    void Record :: Call :: Arg ( int64_t value )
+        NGS_NOTHROW
+    {
+        if ( self == 0 || used + 11 > sizeof args )
+            return;
+
+        args [ used ++ ] = 'i';
+        used += PutVarint ( args + used, ( ( uint64_t ) value << 1 ) ^ ( uint64_t ) ( value >> 63 ) );
+        ++ count;
+    }
+
+    void Record :: Call :: Arg ( const char * value )
+        NGS_NOTHROW
+    {
+        if ( self == 0 || used + 3 > sizeof args )
+            return;
+
+        size_t len = value == 0 ? 0 : strlen ( value );
+        if ( len > MAX_STRING )
+            len = MAX_STRING;
+        if ( len > sizeof args - used - 3 )
+            len = sizeof args - used - 3;
+
+        args [ used ++ ] = 's';
+        used += PutVarint ( args + used, len );
+        memmove ( args + used, value, len );
+        used += len;
+        ++ count;
+    }
+
+    void Record :: Call :: End ()
+        NGS_NOTHROW
+    {
+        uint64_t end = Now ();
+        -- thread_quiet;
+
+        Lock ();
+        if ( on )
+        {
+            if ( thread_id == 0 )
+                thread_id = ++ num_threads;
+
+            uint64_t obj = 0;
+            uint64_t res = 0;
+            unsigned char kind = slot_kinds [ slot ];
+            Objects :: iterator it = objects . find ( self );
+            if ( kind == kind_call )
+            {
+                // named before the object it opens
+                PutMethod ( slot );
+                obj = Seen ( self, slot, true );
+            }
+            else if ( it != objects . end () )
+            {
+                // only references to objects seen count
+                obj = it -> second . id;
+                if ( kind == kind_release && -- it -> second . refs == 0 )
+                    objects . erase ( it );
+            }
+
+            if ( obj != 0 )
+            {
+                if ( result != 0 )
+                    res = Seen ( result, slot, false );
+
+                PutMethod ( slot );
+
+                unsigned char * dst = Reserve ( 1 + 6 * 10 + used + 10 );
+                unsigned int n = 0;
+                dst [ n ++ ] = 'C';
+                n += PutVarint ( dst + n, slot );
+                n += PutVarint ( dst + n, thread_id );
+                n += PutVarint ( dst + n, obj );
+                n += PutVarint ( dst + n, start - origin );
+                n += PutVarint ( dst + n, end - start );
+                n += PutVarint ( dst + n, count );
+                memmove ( dst + n, args, used );
+                n += used;
+                n += PutVarint ( dst + n, res );
+                buffered += n;
+            }
+        }
+        Unlock ();
+    }
+
+    Record :: Quiet :: Quiet ( bool _quiet )
+        NGS_NOTHROW
+        : quiet ( _quiet )
+    {
+        if ( quiet )
+            ++ thread_quiet;
+    }
+
+    Record :: Quiet :: ~ Quiet ()
+        NGS_NOTHROW
+    {
+        if ( quiet )
+            -- thread_quiet;
+    }
+
+    /* NGS_RECORD in the environment starts recording to the file it names */
+    static
+    void StopAtExit ()
+    {
+        Record :: Stop ();
+    }
+
+    static struct RecordFromEnv
+    {
+        RecordFromEnv ()
+        {
+            const char * env = getenv ( "NGS_RECORD" );
+            if ( env != 0 && env [ 0 ] != 0 && Record :: Start ( env ) )
+                atexit ( StopAtExit );
+        }
+    } record_from_env;
+
+#else
+
+    bool Record :: Compiled ()
+        NGS_NOTHROW
+    {
+        return false;
+    }
+
+    bool Record :: Start ( const char * )
+        NGS_NOTHROW
+    {
+        return false;
+    }
+
+    void Record :: Stop ()
+        NGS_NOTHROW
+    {
+    }
+
+    unsigned int Record :: Register ( const char * )
+        NGS_NOTHROW
+    {
+        return 0;
+    }
+
+    Record :: Call :: Call ( unsigned int, const void * )
+        NGS_NOTHROW
+        : self ( 0 )
+        , result ( 0 )
+        , slot ( 0 )
+        , count ( 0 )
+        , used ( 0 )
+        , start ( 0 )
+    {
+    }
+
+    void Record :: Call :: Arg ( int64_t )
+        NGS_NOTHROW
+    {
+    }
+
+    void Record :: Call :: Arg ( const char * )
+        NGS_NOTHROW
+    {
+    }
+
+    void Record :: Call :: End ()
+        NGS_NOTHROW
+    {
+    }
+
+    Record :: Quiet :: Quiet ( bool )
+        NGS_NOTHROW
+        : quiet ( false )
+    {
+    }
+
+    Record :: Quiet :: ~ Quiet ()
+        NGS_NOTHROW
+    {
+    }
+
+#endif
+
+} // namespace ngs
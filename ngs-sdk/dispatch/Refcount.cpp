@@ -26,9 +26,13 @@
 
 #include <ngs/itf/Refcount.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 #include <ngs/itf/Refcount.h>
 
+#include <string.h>
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -64,7 +68,7 @@ namespace ngs
     }
 
     void OpaqueRefcount :: Release ()
-        throw ()
+        NGS_NOTHROW
     {
         if ( this != 0 )
         {
@@ -79,6 +83,8 @@ namespace ngs
                 // release object
                 ErrBlock err;
                 assert ( vt -> release != 0 );
+                NGS_CALL_STATS_SCOPE ( NGS_Refcount_v1_vt, release );
+                NGS_RECORD_CALL ( NGS_Refcount_v1_vt, release );
                 ( * vt -> release ) ( self, & err );
 
                 // check for errors
@@ -95,7 +101,7 @@ namespace ngs
     }
 
     void * OpaqueRefcount :: Duplicate () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         if ( this != 0 )
         {
@@ -108,7 +114,10 @@ namespace ngs
             // duplicate object reference
             ErrBlock err;
             assert ( vt -> duplicate != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Refcount_v1_vt, duplicate );
+            NGS_RECORD_CALL ( NGS_Refcount_v1_vt, duplicate );
             void * dup = ( * vt -> duplicate ) ( self, & err );
+            NGS_RECORD_RESULT ( dup );
 
             // check for errors
             err. Check ();
@@ -120,4 +129,40 @@ namespace ngs
 
         return 0;
     }
+
+    const NGS_VTable * OpaqueRefcount :: QueryExtension ( const char * name ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( this != 0 && name != 0 )
+        {
+            // cast to C object
+            const NGS_Refcount_v1 * self = Self ();
+
+            // extract VTable
+            const NGS_Refcount_v1_vt * vt = Cast ( self -> vt );
+
+            // before v1.1, there were no extensions
+            if ( vt -> dad . minor_version < 1 )
+                return 0;
+
+            // ask the object
+            ErrBlock err;
+            assert ( vt -> query_ext != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Refcount_v1_vt, query_ext );
+            NGS_RECORD_CALL ( NGS_Refcount_v1_vt, query_ext );
+            NGS_RECORD_ARG ( name );
+            const NGS_VTable * ext = ( * vt -> query_ext ) ( self, & err, name );
+
+            // check for errors
+            err . Check ();
+
+            // an extension answers to its own name only
+            if ( ext != 0 && ( ext -> itf_name == 0 || strcmp ( ext -> itf_name, name ) != 0 ) )
+                throw ErrorMsg ( "extension does not match its name" );
+
+            return ext;
+        }
+
+        return 0;
+    }
 }
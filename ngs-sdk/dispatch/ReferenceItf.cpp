@@ -29,12 +29,16 @@
 #include <ngs/itf/AlignmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/ReferenceItf.h>
 
 #include <ngs/Alignment.hpp>
 
+#include <string.h>
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -60,6 +64,7 @@ namespace ngs
             assert ( ( int ) Alignment :: maxMapQuality << 2 == ( int ) NGS_ReferenceAlignFlags_max_map_qual );
             assert ( ( int ) Alignment :: noWraparound << 2 == ( int ) NGS_ReferenceAlignFlags_no_wraparound );
             assert ( ( int ) Alignment :: startWithinSlice << 2 == ( int ) NGS_ReferenceAlignFlags_start_within_window );
+            assert ( ( int ) Alignment :: withMates << 2 == ( int ) NGS_ReferenceAlignFlags_with_mates );
             tested_bits = true;
         }
         return ( categories & 0x03 ) | ( filters << 2 );
@@ -85,7 +90,7 @@ namespace ngs
      */
 
     StringItf * ReferenceItf :: getCommonName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -96,6 +101,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_cmn_name != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_cmn_name );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_cmn_name );
         NGS_String_v1 * ret  = ( * vt -> get_cmn_name ) ( self, & err );
 
         // check for errors
@@ -105,7 +112,7 @@ namespace ngs
     }
 
     StringItf * ReferenceItf :: getCanonicalName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -116,6 +123,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_canon_name != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_canon_name );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_canon_name );
         NGS_String_v1 * ret  = ( * vt -> get_canon_name ) ( self, & err );
 
         // check for errors
@@ -125,7 +134,7 @@ namespace ngs
     }
 
     bool ReferenceItf :: getIsCircular () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -136,6 +145,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> is_circular != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, is_circular );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, is_circular );
         bool ret  = ( * vt -> is_circular ) ( self, & err );
 
         // check for errors
@@ -145,7 +156,7 @@ namespace ngs
     }
 
     uint64_t ReferenceItf :: getLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -156,6 +167,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_length != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_length );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_length );
         uint64_t ret  = ( * vt -> get_length ) ( self, & err );
 
         // check for errors
@@ -165,13 +178,13 @@ namespace ngs
     }
 
     StringItf * ReferenceItf :: getReferenceBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReferenceBases ( offset, -1 );
     }
 
     StringItf * ReferenceItf :: getReferenceBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -182,6 +195,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_ref_bases );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_ref_bases );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_ref_bases ) ( self, & err, offset, length );
 
         // check for errors
@@ -191,13 +208,13 @@ namespace ngs
     }
 
     StringItf * ReferenceItf :: getReferenceChunk ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReferenceChunk ( offset, -1 );
     }
 
     StringItf * ReferenceItf :: getReferenceChunk ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -208,6 +225,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_chunk != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_ref_chunk );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_ref_chunk );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_ref_chunk ) ( self, & err, offset, length );
 
         // check for errors
@@ -218,14 +239,14 @@ namespace ngs
 
 
     uint64_t ReferenceItf :: getAlignmentCount () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getAlignmentCount ( Alignment :: all );
     }
 
 
     uint64_t ReferenceItf :: getAlignmentCount ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -245,6 +266,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_count != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_align_count );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_align_count );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary      = ( categories & Alignment :: primaryAlignment ) != 0;
         bool wants_secondary    = ( categories & Alignment :: secondaryAlignment ) != 0;
         uint64_t ret  = ( * vt -> get_align_count ) ( self, & err, wants_primary, wants_secondary );
@@ -256,7 +280,7 @@ namespace ngs
     }
 
     AlignmentItf * ReferenceItf :: getAlignment ( const char * alignmentId ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -267,7 +291,11 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_alignment != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_alignment );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_alignment );
+        NGS_RECORD_ARG ( alignmentId );
         NGS_Alignment_v1 * ret  = ( * vt -> get_alignment ) ( self, & err, alignmentId );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -276,7 +304,7 @@ namespace ngs
     }
 
     AlignmentItf * ReferenceItf :: getAlignments ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -292,9 +320,13 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_alignments != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_alignments );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_alignments );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary      = ( categories & Alignment :: primaryAlignment ) != 0;
         bool wants_secondary    = ( categories & Alignment :: secondaryAlignment ) != 0;
         NGS_Alignment_v1 * ret  = ( * vt -> get_alignments ) ( self, & err, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -304,13 +336,13 @@ namespace ngs
 
 
     AlignmentItf * ReferenceItf :: getAlignmentSlice ( int64_t start, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getAlignmentSlice ( start, length, Alignment :: all );
     }
 
     AlignmentItf * ReferenceItf :: getAlignmentSlice ( int64_t start, uint64_t length, uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -326,9 +358,15 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_align_slice != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_align_slice );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_align_slice );
+        NGS_RECORD_ARG ( start );
+        NGS_RECORD_ARG ( length );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary      = ( categories & Alignment :: primaryAlignment ) != 0;
         bool wants_secondary    = ( categories & Alignment :: secondaryAlignment ) != 0;
         NGS_Alignment_v1 * ret  = ( * vt -> get_align_slice ) ( self, & err, start, length, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -337,7 +375,7 @@ namespace ngs
     }
 
     AlignmentItf * ReferenceItf :: getFilteredAlignmentSlice ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -362,8 +400,63 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_filtered_align_slice != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_filtered_align_slice );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_filtered_align_slice );
+        NGS_RECORD_ARG ( start );
+        NGS_RECORD_ARG ( length );
+        NGS_RECORD_ARG ( categories );
+        NGS_RECORD_ARG ( filters );
+        NGS_RECORD_ARG ( mappingQuality );
         uint32_t flags = make_flags ( categories, filters );
         NGS_Alignment_v1 * ret  = ( * vt -> get_filtered_align_slice ) ( self, & err, start, length, flags, mappingQuality );
+        NGS_RECORD_RESULT ( ret );
+
+        // check for errors
+        err . Check ();
+
+        return AlignmentItf :: Cast ( ret );
+    }
+
+    AlignmentItf * ReferenceItf :: getAlignmentShard ( uint32_t shard, uint32_t count, uint32_t categories ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        if ( shard >= count )
+            throw ErrorMsg ( "shard is out of range" );
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // test for bad categories
+        // this should not be possible in C++, but it is possible from other bindings
+        if ( categories == 0 )
+            categories = Alignment :: primaryAlignment;
+
+        // test for v1.4
+        if ( vt -> dad . minor_version < 4 )
+        {
+            // split the reference evenly, each alignment going to the slice where it starts
+            uint64_t length = getLength ();
+            uint64_t start = length / count * shard + length % count * shard / count;
+            uint64_t end = length / count * ( shard + 1 ) + length % count * ( shard + 1 ) / count;
+            uint32_t filters = Alignment :: passFailed | Alignment :: passDuplicates | Alignment :: startWithinSlice;
+            return getFilteredAlignmentSlice ( ( int64_t ) start, end - start, categories, filters, 0 );
+        }
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_align_shard != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_align_shard );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_align_shard );
+        NGS_RECORD_ARG ( shard );
+        NGS_RECORD_ARG ( count );
+        NGS_RECORD_ARG ( categories );
+        bool wants_primary = ( categories & Alignment :: primaryAlignment ) != 0;
+        bool wants_secondary = ( categories & Alignment :: secondaryAlignment ) != 0;
+        NGS_Alignment_v1 * ret  = ( * vt -> get_align_shard ) ( self, & err, shard, count, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -372,7 +465,7 @@ namespace ngs
     }
 
     PileupItf * ReferenceItf :: getPileups ( uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -388,9 +481,13 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_pileups != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_pileups );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_pileups );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary      = ( categories & Alignment :: primaryAlignment ) != 0;
         bool wants_secondary    = ( categories & Alignment :: secondaryAlignment ) != 0;
         NGS_Pileup_v1 * ret  = ( * vt -> get_pileups ) ( self, & err, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -399,7 +496,7 @@ namespace ngs
     }
 
     PileupItf * ReferenceItf :: getFilteredPileups ( uint32_t categories, uint32_t filters, int32_t mappingQuality ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -424,8 +521,14 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_filtered_pileups != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_filtered_pileups );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_filtered_pileups );
+        NGS_RECORD_ARG ( categories );
+        NGS_RECORD_ARG ( filters );
+        NGS_RECORD_ARG ( mappingQuality );
         uint32_t flags = make_flags ( categories, filters );
         NGS_Pileup_v1 * ret  = ( * vt -> get_filtered_pileups ) ( self, & err, flags, mappingQuality );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -434,13 +537,13 @@ namespace ngs
     }
 
     PileupItf * ReferenceItf :: getPileupSlice ( int64_t start, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getPileupSlice ( start, length, Alignment :: all );
     }
 
     PileupItf * ReferenceItf :: getPileupSlice ( int64_t start, uint64_t length, uint32_t categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -456,9 +559,15 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_pileup_slice != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_pileup_slice );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_pileup_slice );
+        NGS_RECORD_ARG ( start );
+        NGS_RECORD_ARG ( length );
+        NGS_RECORD_ARG ( categories );
         bool wants_primary      = ( categories & Alignment :: primaryAlignment ) != 0;
         bool wants_secondary    = ( categories & Alignment :: secondaryAlignment ) != 0;
         NGS_Pileup_v1 * ret  = ( * vt -> get_pileup_slice ) ( self, & err, start, length, wants_primary, wants_secondary );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -467,7 +576,7 @@ namespace ngs
     }
 
     PileupItf * ReferenceItf :: getFilteredPileupSlice ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Reference_v1 * self = Test ();
@@ -492,8 +601,16 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_filtered_pileup_slice != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_filtered_pileup_slice );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_filtered_pileup_slice );
+        NGS_RECORD_ARG ( start );
+        NGS_RECORD_ARG ( length );
+        NGS_RECORD_ARG ( categories );
+        NGS_RECORD_ARG ( filters );
+        NGS_RECORD_ARG ( mappingQuality );
         uint32_t flags = make_flags ( categories, filters );
         NGS_Pileup_v1 * ret  = ( * vt -> get_filtered_pileup_slice ) ( self, & err, start, length, flags, mappingQuality );
+        NGS_RECORD_RESULT ( ret );
 
         // check for errors
         err . Check ();
@@ -501,8 +618,59 @@ namespace ngs
         return PileupItf :: Cast ( ret );
     }
     
+    PileupItf * ReferenceItf :: getFilteredPileupSlice ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality,
+            uint32_t maxDepth, uint64_t seed, bool skipEmpty ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        // test for conflicting filters
+        const uint32_t conflictingMapQuality = Alignment :: minMapQuality | Alignment :: maxMapQuality;
+        if ( ( filters & conflictingMapQuality ) == conflictingMapQuality )
+            throw ErrorMsg ( "mapping quality can only be used as a minimum or maximum value, not both" );
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // test for v1.7, which is only needed to sample or skip
+        if ( vt -> dad . minor_version < 7 )
+        {
+            if ( maxDepth != 0 || skipEmpty )
+                throw ErrorMsg ( "the Reference interface provided by this NGS engine is too old to support this message" );
+            return getFilteredPileupSlice ( start, length, categories, filters, mappingQuality );
+        }
+
+        // test for bad categories
+        // this should not be possible in C++, but it is possible from other bindings
+        if ( categories == 0 )
+            categories = Alignment :: primaryAlignment;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_sampled_pileup_slice != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_sampled_pileup_slice );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_sampled_pileup_slice );
+        NGS_RECORD_ARG ( start );
+        NGS_RECORD_ARG ( length );
+        NGS_RECORD_ARG ( categories );
+        NGS_RECORD_ARG ( filters );
+        NGS_RECORD_ARG ( mappingQuality );
+        NGS_RECORD_ARG ( maxDepth );
+        NGS_RECORD_ARG ( seed );
+        NGS_RECORD_ARG ( skipEmpty );
+        uint32_t flags = make_flags ( categories, filters );
+        NGS_Pileup_v1 * ret  = ( * vt -> get_sampled_pileup_slice ) ( self, & err, start, length, flags, mappingQuality, maxDepth, seed, skipEmpty );
+        NGS_RECORD_RESULT ( ret );
+
+        // check for errors
+        err . Check ();
+
+        return PileupItf :: Cast ( ret );
+    }
+
     bool ReferenceItf :: nextReference ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         NGS_Reference_v1 * self = Test ();
@@ -513,6 +681,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> next != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, next );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, next );
         bool ret  = ( * vt -> next ) ( self, & err );
 
         // check for errors
@@ -520,5 +690,339 @@ namespace ngs
 
         return ret;
     }
+
+    uint32_t ReferenceItf :: getFeatures () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.5, nothing was said, so all is claimed
+        if ( vt -> dad . minor_version < 5 )
+            return NGS_ReferenceFeature_all;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_features != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_features );
+        NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_features );
+        uint32_t ret  = ( * vt -> get_features ) ( self, & err );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
+    /* CountCoverage
+     *  the depth from the long CIGARs of a slice's alignments, for an engine
+     *  that doesn't count it: each M, D, = or X run adds 1 where it starts
+     *  and takes 1 away where it ends, and a running sum gives the depth
+     */
+    static
+    void CountCoverage ( AlignmentItf * it, int64_t start, uint64_t length, uint32_t * depth )
+    {
+        memset ( depth, 0, length * sizeof depth [ 0 ] );
+
+        int64_t end = start + ( int64_t ) length;
+        try
+        {
+            while ( it -> nextAlignment () )
+            {
+                int64_t pos = it -> getAlignmentPosition ();
+                StringItf * cigar = it -> getLongCigar ( false );
+                const char * p = cigar -> data ();
+                const char * cigar_end = p + cigar -> size ();
+                int64_t len = 0;
+
+                for ( ; p < cigar_end; ++ p )
+                {
+                    if ( * p >= '0' && * p <= '9' )
+                    {
+                        len = len * 10 + ( * p - '0' );
+                        continue;
+                    }
+                    switch ( * p )
+                    {
+                    case 'M':
+                    case 'D':
+                    case '=':
+                    case 'X':
+                        if ( pos < end && pos + len > start )
+                        {
+                            int64_t a = pos > start ? pos : start;
+                            int64_t b = pos + len < end ? pos + len : end;
+                            ++ depth [ a - start ];
+                            if ( b < end )
+                                -- depth [ b - start ];
+                        }
+                        pos += len;
+                        break;
+                    case 'N':
+                        pos += len;
+                        break;
+                    }
+                    len = 0;
+                }
+                cigar -> Release ();
+            }
+        }
+        catch ( ... )
+        {
+            it -> Release ();
+            throw;
+        }
+        it -> Release ();
+
+        // the differences wrap around below zero, which the sum undoes
+        uint32_t sum = 0;
+        for ( uint64_t i = 0; i < length; ++ i )
+            depth [ i ] = sum += depth [ i ];
+    }
+
+    void ReferenceItf :: getCoverage ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality, uint32_t * depth ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        // test for conflicting filters
+        const uint32_t conflictingMapQuality = Alignment :: minMapQuality | Alignment :: maxMapQuality;
+        if ( ( filters & conflictingMapQuality ) == conflictingMapQuality )
+            throw ErrorMsg ( "mapping quality can only be used as a minimum or maximum value, not both" );
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // test for bad categories
+        // this should not be possible in C++, but it is possible from other bindings
+        if ( categories == 0 )
+            categories = Alignment :: primaryAlignment;
+
+        // from v1.6, the engine may count it
+        if ( vt -> dad . minor_version >= 6 )
+        {
+            // call through C vtable
+            ErrBlock err;
+            assert ( vt -> get_coverage != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_coverage );
+            NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_coverage );
+            NGS_RECORD_ARG ( start );
+            NGS_RECORD_ARG ( length );
+            NGS_RECORD_ARG ( categories );
+            NGS_RECORD_ARG ( filters );
+            NGS_RECORD_ARG ( mappingQuality );
+            uint32_t flags = make_flags ( categories, filters );
+            bool done = ( * vt -> get_coverage ) ( self, & err, start, length, flags, mappingQuality, depth );
+
+            // check for errors
+            err . Check ();
+
+            if ( done )
+                return;
+        }
+
+        // otherwise count it from the slice
+        NGS_RECORD_QUIET ( vt -> dad . minor_version >= 6 );
+        CountCoverage ( getFilteredAlignmentSlice ( start, length, categories, filters, mappingQuality ), start, length, depth );
+    }
+
+    uint64_t ReferenceItf :: copyReferenceBases ( uint64_t offset, char * buffer, uint64_t size ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // from v1.8, the engine copies them
+        if ( vt -> dad . minor_version >= 8 )
+        {
+            // call through C vtable
+            ErrBlock err;
+            assert ( vt -> copy_ref_bases != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, copy_ref_bases );
+            NGS_RECORD_CALL ( NGS_Reference_v1_vt, copy_ref_bases );
+            NGS_RECORD_ARG ( offset );
+            NGS_RECORD_ARG ( size );
+            uint64_t ret = ( * vt -> copy_ref_bases ) ( self, & err, offset, buffer, size );
+
+            // check for errors
+            err . Check ();
+
+            return ret;
+        }
+
+        // otherwise gather them from chunks
+        uint64_t length = getLength ();
+        if ( offset >= length )
+            return 0;
+        if ( size > length - offset )
+            size = length - offset;
+
+        uint64_t copied = 0;
+        while ( copied < size )
+        {
+            StringItf * chunk = getReferenceChunk ( offset + copied, size - copied );
+            size_t chunk_size = 0;
+            try
+            {
+                chunk_size = chunk -> size ();
+                if ( chunk_size > size - copied )
+                    chunk_size = ( size_t ) ( size - copied );
+                memmove ( buffer + copied, chunk -> data (), chunk_size );
+            }
+            catch ( ... )
+            {
+                chunk -> Release ();
+                throw;
+            }
+            chunk -> Release ();
+
+            if ( chunk_size == 0 )
+                break;
+            copied += chunk_size;
+        }
+
+        return copied;
+    }
+
+    /* BaseCode
+     *  0 .. 3 for A, C, G and T in either case, -1 for any other base
+     */
+    static inline
+    int BaseCode ( char base )
+    {
+        switch ( base )
+        {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        }
+        return -1;
+    }
+
+    /* PackBases
+     *  packs "count" bases, from one whose index is a multiple of 8,
+     *  as for get_packed_ref_bases
+     */
+    static
+    void PackBases ( const char * ascii, uint64_t count, uint8_t * bases, uint8_t * nMask )
+    {
+        for ( uint64_t i = 0; i < count; i += 8 )
+        {
+            uint8_t packed [ 2 ] = { 0, 0 };
+            uint8_t mask = 0;
+            for ( uint64_t j = 0; j < 8 && i + j < count; ++ j )
+            {
+                int code = BaseCode ( ascii [ i + j ] );
+                if ( code < 0 )
+                    mask |= ( uint8_t ) ( 1 << j );
+                else
+                    packed [ j >> 2 ] |= ( uint8_t ) ( code << ( ( j & 3 ) * 2 ) );
+            }
+
+            bases [ i / 4 ] = packed [ 0 ];
+            if ( i + 4 < count )
+                bases [ i / 4 + 1 ] = packed [ 1 ];
+            if ( nMask != 0 )
+                nMask [ i / 8 ] = mask;
+        }
+    }
+
+    uint64_t ReferenceItf :: getReferenceBasesPacked ( uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * nMask ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // from v1.9, the engine may pack them
+        if ( vt -> dad . minor_version >= 9 )
+        {
+            // call through C vtable
+            ErrBlock err;
+            assert ( vt -> get_packed_ref_bases != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, get_packed_ref_bases );
+            NGS_RECORD_CALL ( NGS_Reference_v1_vt, get_packed_ref_bases );
+            NGS_RECORD_ARG ( offset );
+            NGS_RECORD_ARG ( length );
+            uint64_t count = 0;
+            bool done = ( * vt -> get_packed_ref_bases ) ( self, & err, offset, length, bases, nMask, & count );
+
+            // check for errors
+            err . Check ();
+
+            if ( done )
+                return count;
+        }
+
+        // otherwise pack copied ones, a multiple of 8 at a time
+        NGS_RECORD_QUIET ( vt -> dad . minor_version >= 9 );
+        char ascii [ 4096 ];
+        uint64_t packed = 0;
+        while ( packed < length )
+        {
+            uint64_t size = length - packed < sizeof ascii ? length - packed : sizeof ascii;
+            uint64_t copied = copyReferenceBases ( offset + packed, ascii, size );
+            PackBases ( ascii, copied, bases + packed / 4, nMask != 0 ? nMask + packed / 8 : 0 );
+            packed += copied;
+            if ( copied < size )
+                break;
+        }
+
+        return packed;
+    }
+
+    void ReferenceItf :: estimateSlice ( int64_t start, uint64_t length, uint64_t & alignments, uint64_t & bytes ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Reference_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Reference_v1_vt * vt = Access ( self -> vt );
+
+        // from v1.10, the engine may estimate it
+        if ( vt -> dad . minor_version >= 10 )
+        {
+            // call through C vtable
+            ErrBlock err;
+            assert ( vt -> estimate_slice != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Reference_v1_vt, estimate_slice );
+            NGS_RECORD_CALL ( NGS_Reference_v1_vt, estimate_slice );
+            NGS_RECORD_ARG ( start );
+            NGS_RECORD_ARG ( length );
+            bool done = ( * vt -> estimate_slice ) ( self, & err, start, length, & alignments, & bytes );
+
+            // check for errors
+            err . Check ();
+
+            if ( done )
+                return;
+        }
+
+        // otherwise scale the count of all alignments to the part of the Reference in the slice
+        NGS_RECORD_QUIET ( vt -> dad . minor_version >= 10 );
+        uint64_t const total = getLength ();
+        int64_t const stop = start + ( int64_t ) length;
+        uint64_t const beg = start < 0 ? 0 : ( uint64_t ) start;
+        uint64_t const end = stop < 0 ? 0 : ( uint64_t ) stop < total ? ( uint64_t ) stop : total;
+
+        alignments = 0;
+        bytes = 0;
+        if ( end > beg )
+        {
+            uint64_t const count = getAlignmentCount ( Alignment :: all );
+            alignments = end - beg == total ? count : ( uint64_t ) ( ( double ) count * ( end - beg ) / total + 0.5 );
+        }
+    }
 }
 
@@ -27,6 +27,8 @@
 #include <ngs/itf/ReferenceSequenceItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/ReferenceSequenceItf.h>
@@ -61,7 +63,7 @@ namespace ngs
      */
 
     StringItf * ReferenceSequenceItf :: getCanonicalName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReferenceSequence_v1 * self = Test ();
@@ -72,6 +74,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_canon_name != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReferenceSequence_v1_vt, get_canon_name );
+        NGS_RECORD_CALL ( NGS_ReferenceSequence_v1_vt, get_canon_name );
         NGS_String_v1 * ret  = ( * vt -> get_canon_name ) ( self, & err );
 
         // check for errors
@@ -81,7 +85,7 @@ namespace ngs
     }
 
     bool ReferenceSequenceItf :: getIsCircular () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReferenceSequence_v1 * self = Test ();
@@ -92,6 +96,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> is_circular != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReferenceSequence_v1_vt, is_circular );
+        NGS_RECORD_CALL ( NGS_ReferenceSequence_v1_vt, is_circular );
         bool ret  = ( * vt -> is_circular ) ( self, & err );
 
         // check for errors
@@ -101,7 +107,7 @@ namespace ngs
     }
 
     uint64_t ReferenceSequenceItf :: getLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReferenceSequence_v1 * self = Test ();
@@ -112,6 +118,8 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_length != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReferenceSequence_v1_vt, get_length );
+        NGS_RECORD_CALL ( NGS_ReferenceSequence_v1_vt, get_length );
         uint64_t ret  = ( * vt -> get_length ) ( self, & err );
 
         // check for errors
@@ -121,13 +129,13 @@ namespace ngs
     }
 
     StringItf * ReferenceSequenceItf :: getReferenceBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReferenceBases ( offset, -1 );
     }
 
     StringItf * ReferenceSequenceItf :: getReferenceBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReferenceSequence_v1 * self = Test ();
@@ -138,6 +146,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_bases != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReferenceSequence_v1_vt, get_ref_bases );
+        NGS_RECORD_CALL ( NGS_ReferenceSequence_v1_vt, get_ref_bases );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_ref_bases ) ( self, & err, offset, length );
 
         // check for errors
@@ -147,13 +159,13 @@ namespace ngs
     }
 
     StringItf * ReferenceSequenceItf :: getReferenceChunk ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return this -> getReferenceChunk ( offset, -1 );
     }
 
     StringItf * ReferenceSequenceItf :: getReferenceChunk ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_ReferenceSequence_v1 * self = Test ();
@@ -164,6 +176,10 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_ref_chunk != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_ReferenceSequence_v1_vt, get_ref_chunk );
+        NGS_RECORD_CALL ( NGS_ReferenceSequence_v1_vt, get_ref_chunk );
+        NGS_RECORD_ARG ( offset );
+        NGS_RECORD_ARG ( length );
         NGS_String_v1 * ret  = ( * vt -> get_ref_chunk ) ( self, & err, offset, length );
 
         // check for errors
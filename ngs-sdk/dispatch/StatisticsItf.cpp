@@ -27,6 +27,8 @@
 #include <ngs/itf/StatisticsItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Record.hpp>
 #include <ngs/itf/VTable.hpp>
 
 #include <ngs/itf/StatisticsItf.h>
@@ -58,7 +60,7 @@ namespace ngs
      */
 
     uint32_t StatisticsItf :: getValueType ( const char * path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Statistics_v1 * self = Test ();
@@ -69,6 +71,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> get_type != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, get_type );
+        NGS_RECORD_CALL ( NGS_Statistics_v1_vt, get_type );
+        NGS_RECORD_ARG ( path );
         uint32_t ret  = ( * vt -> get_type ) ( self, & err, path );
 
         // check for errors
@@ -78,7 +83,7 @@ namespace ngs
     }
 
     StringItf * StatisticsItf :: getAsString ( const char * path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Statistics_v1 * self = Test ();
@@ -89,6 +94,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> as_string != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, as_string );
+        NGS_RECORD_CALL ( NGS_Statistics_v1_vt, as_string );
+        NGS_RECORD_ARG ( path );
         NGS_String_v1 * ret  = ( * vt -> as_string ) ( self, & err, path );
 
         // check for errors
@@ -98,7 +106,7 @@ namespace ngs
     }
 
     int64_t StatisticsItf :: getAsI64 ( const char * path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Statistics_v1 * self = Test ();
@@ -109,6 +117,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> as_I64 != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, as_I64 );
+        NGS_RECORD_CALL ( NGS_Statistics_v1_vt, as_I64 );
+        NGS_RECORD_ARG ( path );
         int64_t ret  = ( * vt -> as_I64 ) ( self, & err, path );
 
         // check for errors
@@ -118,7 +129,7 @@ namespace ngs
     }
 
     uint64_t StatisticsItf :: getAsU64 ( const char * path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Statistics_v1 * self = Test ();
@@ -129,6 +140,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> as_U64 != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, as_U64 );
+        NGS_RECORD_CALL ( NGS_Statistics_v1_vt, as_U64 );
+        NGS_RECORD_ARG ( path );
         uint64_t ret  = ( * vt -> as_U64 ) ( self, & err, path );
 
         // check for errors
@@ -138,7 +152,7 @@ namespace ngs
     }
 
     double StatisticsItf :: getAsDouble ( const char * path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_Statistics_v1 * self = Test ();
@@ -149,6 +163,9 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> as_F64 != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, as_F64 );
+        NGS_RECORD_CALL ( NGS_Statistics_v1_vt, as_F64 );
+        NGS_RECORD_ARG ( path );
         double ret  = ( * vt -> as_F64 ) ( self, & err, path );
 
         // check for errors
@@ -158,7 +175,7 @@ namespace ngs
     }
 
     StringItf * StatisticsItf :: nextPath ( const char * path ) const
-        throw ()
+        NGS_NOTHROW
     {
         try
         {
@@ -171,6 +188,9 @@ namespace ngs
             // call through C vtable
             ErrBlock err;
             assert ( vt -> next_path != 0 );
+            NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, next_path );
+            NGS_RECORD_CALL ( NGS_Statistics_v1_vt, next_path );
+            NGS_RECORD_ARG ( path );
             NGS_String_v1 * ret  = ( * vt -> next_path ) ( self, & err, path );
 
             // check for errors
@@ -190,4 +210,30 @@ namespace ngs
         return 0;
     }
 
+    bool StatisticsItf :: getEntries ( const NGS_StatisticsEntry_v1 * & entries, uint64_t & count ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the object is really from C
+        const NGS_Statistics_v1 * self = Test ();
+
+        // cast vtable to our level
+        const NGS_Statistics_v1_vt * vt = Access ( self -> vt );
+
+        // before v1.1, the paths could only be walked
+        if ( vt -> dad . minor_version < 1 )
+            return false;
+
+        // call through C vtable
+        ErrBlock err;
+        assert ( vt -> get_entries != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_Statistics_v1_vt, get_entries );
+        NGS_RECORD_CALL ( NGS_Statistics_v1_vt, get_entries );
+        bool ret = ( * vt -> get_entries ) ( self, & err, & entries, & count );
+
+        // check for errors
+        err . Check ();
+
+        return ret;
+    }
+
 } // namespace ngs
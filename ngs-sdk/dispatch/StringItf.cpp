@@ -26,7 +26,9 @@
 
 #include <ngs/itf/StringItf.hpp>
 #include <ngs/itf/ErrBlock.hpp>
+#include <ngs/itf/CallStats.hpp>
 #include <ngs/itf/VTable.hpp>
+#include <ngs/itf/DirectBind.hpp>
 
 #include <ngs/itf/StringItf.h>
 
@@ -51,13 +53,28 @@ namespace ngs
         return out;
     }
 
+#if NGS_DIRECT_BIND
+    /*----------------------------------------------------------------------
+     * the adapter object behind a C one, or NULL to go through the vtable
+     */
+    static DirectTok NGS_String_v1_direct;
+
+    static inline
+    const ngs_adapt :: StringItf * Direct ( const NGS_String_v1 * self )
+    {
+        if ( Direct ( self -> vt, NGS_String_v1_tok, NGS_String_v1_direct ) )
+            return ngs_adapt :: StringItf :: Self ( self );
+        return 0;
+    }
+#endif
+
     /*----------------------------------------------------------------------
      * StringItf
      *  a dynamically allocated object representing a string reference
      */
 
     const char * StringItf :: data () const
-        throw ()
+        NGS_NOTHROW
     {
         if ( this != 0 )
         {
@@ -67,11 +84,17 @@ namespace ngs
             // cast vtable to our level
             try
             {
+#if NGS_DIRECT_BIND
+                // or call the adapter object directly
+                if ( const ngs_adapt :: StringItf * direct = Direct ( self ) )
+                    return direct -> data ();
+#endif
                 const NGS_String_v1_vt * vt = Access ( self -> vt );
 
                 // call through C vtable
                 ErrBlock err;
                 assert ( vt -> data != 0 );
+                NGS_CALL_STATS_SCOPE ( NGS_String_v1_vt, data );
                 const char * ret = ( * vt -> data ) ( self, & err );
 
                 // check for errors
@@ -92,7 +115,7 @@ namespace ngs
     }
 
     size_t StringItf :: size () const
-        throw ()
+        NGS_NOTHROW
     {
         if ( this != 0 )
         {
@@ -102,11 +125,17 @@ namespace ngs
             // cast vtable to our level
             try
             {
+#if NGS_DIRECT_BIND
+                // or call the adapter object directly
+                if ( const ngs_adapt :: StringItf * direct = Direct ( self ) )
+                    return direct -> size ();
+#endif
                 const NGS_String_v1_vt * vt = Access ( self -> vt );
 
                 // call through C vtable
                 ErrBlock err;
                 assert ( vt -> size != 0 );
+                NGS_CALL_STATS_SCOPE ( NGS_String_v1_vt, size );
                 size_t ret  = ( * vt -> size ) ( self, & err );
 
                 // check for errors
@@ -127,13 +156,13 @@ namespace ngs
     }
 
     StringItf * StringItf :: substr ( size_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         return substr ( offset, -1 );
     }
 
     StringItf * StringItf :: substr ( size_t offset, size_t size ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         // the object is really from C
         const NGS_String_v1 * self = Test ();
@@ -144,6 +173,7 @@ namespace ngs
         // call through C vtable
         ErrBlock err;
         assert ( vt -> substr != 0 );
+        NGS_CALL_STATS_SCOPE ( NGS_String_v1_vt, substr );
         NGS_String_v1 * ret  = ( * vt -> substr ) ( self, & err, offset, size );
 
         // check for errors
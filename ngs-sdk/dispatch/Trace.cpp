@@ -0,0 +1,273 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/itf/Trace.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if ! defined _WIN32
+#include <unistd.h>
+#endif
+
+#if defined __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <new>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * Trace
+     *  per-thread rings of timed spans
+     */
+
+    bool Trace :: on;
+
+    uint64_t Trace :: Now ()
+        NGS_NOTHROW
+    {
+#if defined _WIN32
+        return 0;
+#else
+        struct timespec ts;
+        clock_gettime ( CLOCK_MONOTONIC, & ts );
+        return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+#endif
+    }
+
+#if NGS_TRACE
+
+#if defined _MSC_VER
+#error "NGS_TRACE needs gcc or clang"
+#endif
+
+    /* every thread that records gets a ring, kept after it exits so
+       that its spans can still be exported */
+    struct TraceRing
+    {
+        Trace :: Event events [ Trace :: RING_SIZE ];
+        uint64_t count;             // recorded, of which the last RING_SIZE are kept
+        unsigned int thread;
+        TraceRing * next;
+    };
+
+    static TraceRing * rings;
+    static unsigned int num_rings;
+    static __thread TraceRing * thread_ring;
+
+    /* guards the list of rings; recording itself takes no lock,
+       so spans are best collected while the threads are quiet */
+    static volatile int lock_word;
+
+    /* the system's id for the thread where there is one, so that
+       an engine's own spans can be put on the same tracks */
+    static
+    unsigned int ThreadId ( unsigned int nth )
+    {
+#if defined __linux__
+        return ( unsigned int ) syscall ( SYS_gettid );
+#else
+        return nth;
+#endif
+    }
+
+    static
+    void Lock ()
+    {
+        while ( __sync_lock_test_and_set ( & lock_word, 1 ) )
+        {
+            while ( lock_word != 0 )
+                ;
+        }
+    }
+
+    static
+    void Unlock ()
+    {
+        __sync_lock_release ( & lock_word );
+    }
+
+    bool Trace :: Compiled ()
+        NGS_NOTHROW
+    {
+        return true;
+    }
+
+    void Trace :: Enable ( bool _on )
+        NGS_NOTHROW
+    {
+        on = _on;
+    }
+
+    void Trace :: Record ( const char * name, uint64_t start, uint64_t end )
+        NGS_NOTHROW
+    {
+        TraceRing * r = thread_ring;
+        if ( r == 0 )
+        {
+            r = new ( std :: nothrow ) TraceRing;
+            if ( r == 0 )
+                return;
+            r -> count = 0;
+
+            Lock ();
+            r -> thread = ThreadId ( ++ num_rings );
+            r -> next = rings;
+            rings = r;
+            Unlock ();
+
+            thread_ring = r;
+        }
+
+        Event & e = r -> events [ r -> count % RING_SIZE ];
+        e . name = name;
+        e . start = start;
+        e . duration = end - start;
+        e . thread = r -> thread;
+        ++ r -> count;
+    }
+
+    void Trace :: Collect ( std :: vector < Event > & out, bool this_thread_only )
+    {
+        out . clear ();
+
+        Lock ();
+        for ( const TraceRing * r = this_thread_only ? thread_ring : rings; r != 0; r = r -> next )
+        {
+            uint64_t kept = r -> count < RING_SIZE ? r -> count : RING_SIZE;
+            for ( uint64_t i = r -> count - kept; i < r -> count; ++ i )
+                out . push_back ( r -> events [ i % RING_SIZE ] );
+            if ( this_thread_only )
+                break;
+        }
+        Unlock ();
+    }
+
+    void Trace :: Clear ()
+        NGS_NOTHROW
+    {
+        Lock ();
+        for ( TraceRing * r = rings; r != 0; r = r -> next )
+            r -> count = 0;
+        Unlock ();
+    }
+
+    void Trace :: Export ( FILE * out, bool open )
+    {
+        std :: vector < Event > events;
+        Collect ( events );
+
+        if ( open )
+            fprintf ( out, "[\n" );
+        int pid = ( int ) getpid ();
+        for ( size_t i = 0; i < events . size (); ++ i )
+        {
+            const Event & e = events [ i ];
+            fprintf ( out, "{\"name\":\"%s\",\"cat\":\"ngs\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u},\n"
+                      , e . name
+                      , e . start / 1000.0
+                      , e . duration / 1000.0
+                      , pid
+                      , e . thread
+                );
+        }
+        fflush ( out );
+    }
+
+    /* NGS_TRACE in the environment switches tracing on, and names the
+       file the spans are appended to at exit, or stderr for "1" */
+    static
+    void ExportAtExit ()
+    {
+        const char * dest = getenv ( "NGS_TRACE" );
+        if ( dest == 0 || strcmp ( dest, "1" ) == 0 )
+        {
+            Trace :: Export ( stderr );
+            return;
+        }
+
+        FILE * out = fopen ( dest, "a" );
+        if ( out != 0 )
+        {
+            Trace :: Export ( out, ftell ( out ) == 0 );
+            fclose ( out );
+        }
+    }
+
+    static struct TraceFromEnv
+    {
+        TraceFromEnv ()
+        {
+            const char * env = getenv ( "NGS_TRACE" );
+            if ( env != 0 && env [ 0 ] != 0 )
+            {
+                Trace :: Enable ( true );
+                atexit ( ExportAtExit );
+            }
+        }
+    } trace_from_env;
+
+#else
+
+    bool Trace :: Compiled ()
+        NGS_NOTHROW
+    {
+        return false;
+    }
+
+    void Trace :: Enable ( bool )
+        NGS_NOTHROW
+    {
+    }
+
+    void Trace :: Record ( const char *, uint64_t, uint64_t )
+        NGS_NOTHROW
+    {
+    }
+
+    void Trace :: Collect ( std :: vector < Event > & out, bool )
+    {
+        out . clear ();
+    }
+
+    void Trace :: Clear ()
+        NGS_NOTHROW
+    {
+    }
+
+    void Trace :: Export ( FILE * out, bool open )
+    {
+        if ( open )
+            fprintf ( out, "[\n" );
+        fflush ( out );
+    }
+
+#endif
+
+} // namespace ngs
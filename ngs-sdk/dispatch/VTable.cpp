@@ -29,6 +29,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if ! NGS_ITF_ATOMIC_BUILTINS && defined _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -44,12 +48,13 @@ namespace ngs
         if ( itf -> parent != 0 )
             depth = ItfTokDepth ( itf -> parent ) + 1;
 
-        if ( itf -> idx == 0 )
-            itf -> idx = depth;
+        // any thread that gets here finds the same depth
+        if ( NGS_ITF_LOAD ( itf -> idx ) == 0 )
+            NGS_ITF_STORE ( itf -> idx, depth );
 
         assert ( itf -> itf_name != 0 );
         assert ( itf -> itf_name [ 0 ] != 0 );
-        assert ( itf -> idx == depth );
+        assert ( NGS_ITF_LOAD ( itf -> idx ) == depth );
 
         return depth;
     }
@@ -68,31 +73,74 @@ namespace ngs
     }
 
     /*----------------------------------------------------------------------
-     * PopulateCache
+     * InstallCache
+     *  publishes "cache" as that of "vt" unless another thread got there
+     *  first, returning the one that "vt" ends up with
+     */
+    static
+    const NGS_HierCache * VTableInstallCache ( const NGS_VTable * vt, NGS_HierCache * cache )
+    {
+        const NGS_HierCache * expected = 0;
+#if NGS_ITF_ATOMIC_BUILTINS
+        if ( __atomic_compare_exchange_n ( & vt -> cache, & expected, cache,
+                 false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+            return cache;
+#elif defined _MSC_VER
+        expected = ( const NGS_HierCache* ) _InterlockedCompareExchangePointer
+            ( ( void * volatile * ) & vt -> cache, cache, 0 );
+        if ( expected == 0 )
+            return cache;
+#else
+        if ( __sync_bool_compare_and_swap ( & vt -> cache, expected, cache ) )
+            return cache;
+        expected = vt -> cache;
+#endif
+
+        // lost the race: use the winner's, which is just as good
+        free ( cache );
+        return expected;
+    }
+
+    /*----------------------------------------------------------------------
+     * FillCache
+     *  the linear hierarchy of "vt", most derived last
+     *  all of it is written before the cache is published, so that no
+     *  thread sees one partly filled
      */
     static
-    void VTablePopulateCache ( const NGS_VTable * vt, uint32_t depth, const ItfTok * itf, NGS_HierCache * cache )
+    void VTableFillCache ( const NGS_VTable * vt, uint32_t depth, NGS_HierCache * cache )
     {
+        cache -> length = depth;
         do
         {
-            assert ( vt != 0 );
-            assert ( itf != 0 );
             assert ( depth != 0 );
-            assert ( itf -> idx <= depth );
+            cache -> hier [ -- depth ] . parent = vt;
+            vt = vt -> parent;
+        }
+        while ( vt != 0 );
+    }
 
-            vt -> cache = cache;
+    /*----------------------------------------------------------------------
+     * RecordItf
+     *  marks the levels of a published cache that "itf" and its parents
+     *  name, each with a single word that any thread may read meanwhile
+     */
+    static
+    void VTableRecordItf ( const NGS_HierCache * cache, const ItfTok * itf )
+    {
+        NGS_HierCache * hc = const_cast < NGS_HierCache* > ( cache );
+        do
+        {
+            uint32_t idx = NGS_ITF_LOAD ( itf -> idx );
+            assert ( idx != 0 );
+            assert ( idx <= cache -> length );
 
-            if ( itf -> idx == depth -- )
-            {
-                assert ( strcmp ( vt -> itf_name, itf -> itf_name ) == 0 );
-                cache -> hier [ depth ] . itf_tok = ( const void* ) itf;
-                itf = itf -> parent;
-            }
+            if ( strcmp ( cache -> hier [ idx - 1 ] . parent -> itf_name, itf -> itf_name ) == 0 )
+                NGS_ITF_STORE ( hc -> hier [ idx - 1 ] . itf_tok, ( const void* ) itf );
 
-            cache -> hier [ depth ] . parent = vt;
-            vt = vt -> parent;
+            itf = itf -> parent;
         }
-        while ( vt != 0 );
+        while ( itf != 0 );
     }
 
 
@@ -102,7 +150,7 @@ namespace ngs
      *  resolves array indices of itf tokens
      */
     void Resolve ( const ItfTok  & itf )
-        throw ()
+        NGS_NOTHROW
     {
         // interfaces only support single-inheritance
         // perform a one-shot runtime depth assignment
@@ -110,34 +158,34 @@ namespace ngs
     }
 
     void Resolve ( const NGS_VTable * vt, const ItfTok & itf )
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         if ( vt != 0 )
         {
             // determine depth of hierarchy
             uint32_t depth = VTableDepth ( vt );
-            if ( itf . idx > depth )
+            if ( NGS_ITF_LOAD ( itf . idx ) > depth )
                 throw ErrorMsg ( "interface not supported" );
 
             // check for existing cache object
-            NGS_HierCache * cache = const_cast < NGS_HierCache* > ( vt -> cache );
+            const NGS_HierCache * cache = NGS_ITF_LOAD ( vt -> cache );
             if ( cache == 0 )
             {
                 // allocate a cache object
-                cache = ( NGS_HierCache* ) calloc ( 1, sizeof * cache
-                    - sizeof cache -> hier + sizeof cache -> hier [ 0 ] * depth );
-                if ( cache == 0 )
+                NGS_HierCache * fresh = ( NGS_HierCache* ) calloc ( 1, sizeof * fresh
+                    - sizeof fresh -> hier + sizeof fresh -> hier [ 0 ] * depth );
+                if ( fresh == 0 )
                     throw ErrorMsg ( "out of memory allocating NGS_HierCache" );
 
-                cache -> length = depth;
+                VTableFillCache ( vt, depth, fresh );
+                cache = VTableInstallCache ( vt, fresh );
             }
-            else if ( cache -> length != depth )
-            {
+
+            if ( cache -> length != depth )
                 throw ErrorMsg ( "corrupt vtable cache" );
-            }
 
             // populate
-            VTablePopulateCache ( vt, depth, & itf, cache );
+            VTableRecordItf ( cache, & itf );
         }
     }
 
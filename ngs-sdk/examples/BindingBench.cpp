@@ -0,0 +1,193 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* BindingBench
+ *  the C++ leg of a benchmark run alike in C++, Java and Python;
+ *  see also ngs-java/examples/examples/BindingBench.java and
+ *  ngs-python/examples/BindingBench.py
+ *
+ *  each scenario reads the first "count" alignments of a run;
+ *  output is one JSON object per line:
+ *    {"lang":"c++","bench":"<scenario>","records":<n>,"ns_per_record":<x>}
+ *
+ *  C++ calls the engine through a thin dispatch layer, so its numbers
+ *  stand for the engine; given this output, the Java and Python legs
+ *  report how much of their cost is JNI or ctypes marshalling
+ */
+
+#include <ncbi-vdb/NGS.hpp>
+#include <ngs-bam/ngs-bam.hpp>
+#include <ngs/ErrorMsg.hpp>
+#include <ngs/ReadCollection.hpp>
+#include <ngs/AlignmentIterator.hpp>
+#include <ngs/AlignmentBatch.hpp>
+#include <ngs/Alignment.hpp>
+
+#include <time.h>
+#include <stdlib.h>
+#include <iostream>
+
+using namespace ngs;
+using namespace std;
+
+class BindingBench
+{
+    static volatile uint64_t sink;
+
+    static double now ()
+    {
+        struct timespec ts;
+        clock_gettime ( CLOCK_MONOTONIC, & ts );
+        return ts . tv_sec + ts . tv_nsec * 1e-9;
+    }
+
+    static void report ( const char * bench, uint64_t records, double seconds )
+    {
+        cout << "{\"lang\":\"c++\",\"bench\":\"" << bench << "\""
+             << ",\"records\":" << records
+             << ",\"ns_per_record\":" << ( records == 0 ? 0.0 : seconds * 1e9 / records )
+             << "}" << endl;
+    }
+
+    enum Fields { none = 0, position = 1, bases = 2, qualities = 4 };
+
+    static void scan ( ReadCollection & run, uint64_t count, const char * bench, int fields )
+    {
+        double start = now ();
+        AlignmentIterator it = run . getAlignmentRange ( 1, count, Alignment :: all );
+
+        uint64_t i;
+        for ( i = 0; it . nextAlignment (); ++ i )
+        {
+            if ( fields & position )
+                sink += it . getAlignmentPosition ();
+            if ( fields & bases )
+                sink += it . getFragmentBases () . size ();
+            if ( fields & qualities )
+                sink += it . getFragmentQualities () . size ();
+        }
+
+        report ( bench, i, now () - start );
+    }
+
+    static void scan_views ( ReadCollection & run, uint64_t count )
+    {
+        double start = now ();
+        AlignmentIterator it = run . getAlignmentRange ( 1, count, Alignment :: all );
+
+        uint64_t i;
+        for ( i = 0; it . nextAlignment (); ++ i )
+        {
+            sink += it . getFragmentBasesView () . size ();
+            sink += it . getFragmentQualitiesView () . size ();
+        }
+
+        report ( "bases+qualities.view", i, now () - start );
+    }
+
+    static void scan_batches ( ReadCollection & run, uint64_t count )
+    {
+        AlignmentBatch batch ( AlignmentBatch :: alignmentPosition
+                             | AlignmentBatch :: fragmentBases
+                             | AlignmentBatch :: fragmentQualities );
+        double start = now ();
+        AlignmentIterator it = run . getAlignmentRange ( 1, count, Alignment :: all );
+
+        uint64_t n = 0;
+        while ( it . nextAlignmentBatch ( batch ) )
+        {
+            for ( uint32_t i = 0; i < batch . size (); ++ i )
+            {
+                sink += batch . getAlignmentPosition ( i );
+                sink += batch . getFragmentBases ( i ) . size ();
+                sink += batch . getFragmentQualities ( i ) . size ();
+            }
+            n += batch . size ();
+        }
+
+        report ( "batch", n, now () - start );
+    }
+
+    static ReadCollection open ( String acc )
+    {
+        size_t dot = acc . find_last_of ( '.' );
+        if ( dot != string :: npos )
+        {
+            String extension = acc . substr ( dot );
+            if ( extension == ".bam" || extension == ".BAM" )
+                return NGS_BAM :: openReadCollection ( acc );
+        }
+        return ncbi :: NGS :: openReadCollection ( acc );
+    }
+
+public:
+
+    static void run ( String acc, uint64_t count )
+    {
+        ReadCollection run = open ( acc );
+
+        // the first pass warms caches, so the rest compare alike
+        scan ( run, count, "warmup", none );
+
+        scan ( run, count, "next", none );
+        scan ( run, count, "position", position );
+        scan ( run, count, "bases", bases );
+        scan ( run, count, "qualities", qualities );
+        scan ( run, count, "position+bases+qualities", position | bases | qualities );
+        scan_views ( run, count );
+        scan_batches ( run, count );
+    }
+};
+
+volatile uint64_t BindingBench :: sink;
+
+int main ( int argc, char const *argv[] )
+{
+    if ( argc != 3 )
+    {
+        cerr << "Usage: BindingBench accession count\n";
+    }
+    else try
+    {
+        ncbi::NGS::setAppVersionString ( "BindingBench.1.0.0" );
+        BindingBench::run ( argv[1], strtoull ( argv[2], 0, 10 ) );
+        return 0;
+    }
+    catch ( ErrorMsg & x )
+    {
+        cerr <<  x.toString () << '\n';
+    }
+    catch ( exception & x )
+    {
+        cerr <<  x.what () << '\n';
+    }
+    catch ( ... )
+    {
+        cerr <<  "unknown exception\n";
+    }
+
+    return 10;
+}
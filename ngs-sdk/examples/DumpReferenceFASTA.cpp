@@ -29,9 +29,11 @@
 #include <ngs/ReadCollection.hpp>
 #include <ngs/ReadIterator.hpp>
 #include <ngs/Read.hpp>
+#include <ngs/ReferenceReader.hpp>
 
 
 #include <math.h>
+#include <string.h>
 #include <iostream>
 
 using namespace ngs;
@@ -41,9 +43,39 @@ class DumpReferenceFASTA
 {
 public:
 
+    enum { LINE = 70, CHUNK = 64 * 1024 };
+
+    /* format
+     *  copies "count" bases into "out", breaking them into lines of LINE;
+     *  "line" is the length of the line so far, returns the size written
+     *  "out" needs room for count + count / LINE + 1
+     */
+    static size_t format ( const char * bases, size_t count, size_t & line, char * out )
+    {
+        char * p = out;
+        while ( count != 0 )
+        {
+            size_t n = LINE - line;
+            if ( n > count )
+                n = count;
+            memcpy ( p, bases, n );
+            p += n;
+            bases += n;
+            count -= n;
+            line += n;
+            if ( line == LINE )
+            {
+                * p ++ = '\n';
+                line = 0;
+            }
+        }
+        return p - out;
+    }
+
     static void process ( const Reference & ref )
     {
-        uint64_t len = ref . getLength ();
+        static char bases [ CHUNK ];
+        static char text [ CHUNK + CHUNK / LINE + 1 ];
 
         size_t line = 0;
 
@@ -51,24 +83,10 @@ public:
 
         try
         {
-            for ( uint64_t offset = 0; offset < len; offset += 5000 )
-            {
-                StringRef chunk = ref . getReferenceChunk ( offset, 5000 );
-                size_t chunk_len = chunk . size ();
-                for ( size_t chunk_idx = 0; chunk_idx < chunk_len; )
-                {
-                    StringRef chunk_line = chunk . substr ( chunk_idx, 70 - line );
-                    line += chunk_line . size ();
-                    chunk_idx += chunk_line . size ();
-
-                    cout << chunk_line;
-                    if ( line >= 70 )
-                    {
-                        cout << '\n';
-                        line = 0;
-                    }
-                }
-            }
+            ReferenceReader reader ( ref );
+            uint64_t count;
+            while ( ( count = reader . read ( bases, CHUNK ) ) != 0 )
+                cout . write ( text, format ( bases, ( size_t ) count, line, text ) );
             if (line != 0)
                 cout << '\n';
         }
@@ -0,0 +1,440 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* FastqDump
+ *  writes the Reads of a run as FASTQ, on several threads
+ *
+ *  the Reads are cut into chunks of consecutive rows, each read by a
+ *  getReadRange of its own and formatted, and compressed if asked for,
+ *  into buffers of the thread that took it; a chunk compresses into
+ *  gzip members of its own, so the output as a whole is a gzip stream
+ *  only the writing of the buffers is done one thread at a time
+ *
+ *  with -o the output goes to <prefix>.fastq, or with --split the first
+ *  and second fragments of two-fragment Reads go to <prefix>_1.fastq and
+ *  <prefix>_2.fastq and all other Reads to <prefix>.fastq; with -z each
+ *  name ends in .gz. --ordered writes the chunks in the order of their
+ *  rows rather than as they are done; either way, a thread waits once
+ *  two chunks a thread are formatted and not yet written
+ */
+
+#include <ncbi-vdb/NGS.hpp>
+#include <ngs/ErrorMsg.hpp>
+#include <ngs/ReadCollection.hpp>
+#include <ngs/ReadIterator.hpp>
+#include <ngs/Read.hpp>
+
+#include <pthread.h>
+#include <zlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using namespace ngs;
+using namespace std;
+
+class FastqDump
+{
+public:
+
+    struct Options
+    {
+        uint32_t threads;
+        uint64_t chunk;     // Reads per chunk
+        int level;          // of gzip, or 0 not to compress
+        bool split;
+        bool ordered;
+        String prefix;      // empty for stdout
+
+        Options ()
+            : threads ( 4 )
+            , chunk ( 20000 )
+            , level ( 0 )
+            , split ( false )
+            , ordered ( false )
+        {
+        }
+    };
+
+    static void run ( const String & acc, const Options & options )
+    {
+        // open requested accession using SRA implementation of the API
+        ReadCollection run = ncbi::NGS::openReadCollection ( acc );
+
+        FastqDump dump ( run, options );
+        dump . open ();
+
+        vector < pthread_t > threads ( options . threads );
+        uint32_t started = 0;
+        for ( ; started < options . threads; ++ started )
+        {
+            if ( pthread_create ( & threads [ started ], 0, work, & dump ) != 0 )
+                break;
+        }
+        if ( started == 0 )
+            dump . work ();
+        for ( uint32_t i = 0; i < started; ++ i )
+            pthread_join ( threads [ i ], 0 );
+
+        dump . close ();
+        if ( ! dump . error . empty () )
+            throw runtime_error ( dump . error );
+
+        cerr << "Read " << dump . reads << " spots for " << run . getName () << '\n';
+    }
+
+private:
+
+    // the files of the output
+    enum { UNPAIRED, FIRST, SECOND, OUTPUTS };
+
+    struct Chunk
+    {
+        String text [ OUTPUTS ];
+    };
+
+    FastqDump ( const ReadCollection & Run, const Options & Options )
+        : collection ( Run )
+        , options ( Options )
+        , chunks ( 0 )
+        , next ( 0 )
+        , written ( 0 )
+        , writing ( false )
+        , reads ( 0 )
+    {
+        uint64_t count = collection . getReadCount ();
+        chunks = ( count + options . chunk - 1 ) / options . chunk;
+        rows = count;
+        for ( int i = 0; i < OUTPUTS; ++ i )
+            out [ i ] = 0;
+        pthread_mutex_init ( & lock, 0 );
+        pthread_cond_init ( & moved, 0 );
+    }
+
+    ~ FastqDump ()
+    {
+        close ();
+        for ( map < uint64_t, Chunk * > :: iterator i = done . begin (); i != done . end (); ++ i )
+            delete i -> second;
+        pthread_cond_destroy ( & moved );
+        pthread_mutex_destroy ( & lock );
+    }
+
+    void open ()
+    {
+        const char * gz = options . level != 0 ? ".gz" : "";
+        if ( options . prefix . empty () )
+        {
+            out [ UNPAIRED ] = stdout;
+            return;
+        }
+        out [ UNPAIRED ] = create ( options . prefix + ".fastq" + gz );
+        if ( options . split )
+        {
+            out [ FIRST ] = create ( options . prefix + "_1.fastq" + gz );
+            out [ SECOND ] = create ( options . prefix + "_2.fastq" + gz );
+        }
+    }
+
+    static FILE * create ( const String & path )
+    {
+        FILE * f = fopen ( path . c_str (), "wb" );
+        if ( f == 0 )
+            throw runtime_error ( "can't create " + path );
+        return f;
+    }
+
+    void close ()
+    {
+        for ( int i = 0; i < OUTPUTS; ++ i )
+        {
+            if ( out [ i ] == 0 )
+                continue;
+            if ( ( out [ i ] == stdout ? fflush ( out [ i ] ) : fclose ( out [ i ] ) ) != 0 && error . empty () )
+                error = "error writing the output";
+            out [ i ] = 0;
+        }
+    }
+
+    static void * work ( void * self )
+    {
+        static_cast < FastqDump * > ( self ) -> work ();
+        return 0;
+    }
+
+    // hands out chunks until none are left or one failed
+    void work ()
+    {
+        size_t hint = 0;
+        for ( ; ; )
+        {
+            pthread_mutex_lock ( & lock );
+            // no more than two chunks a thread are held at once
+            while ( error . empty () && next < chunks && next >= written + 2 * options . threads )
+                pthread_cond_wait ( & moved, & lock );
+            bool more = error . empty () && next < chunks;
+            uint64_t index = next ++;
+            pthread_mutex_unlock ( & lock );
+            if ( ! more )
+                return;
+
+            Chunk * chunk = new Chunk;
+            try
+            {
+                chunk -> text [ UNPAIRED ] . reserve ( hint );
+                uint64_t count = format ( index, * chunk );
+                hint = chunk -> text [ UNPAIRED ] . size ();
+                if ( options . level != 0 )
+                {
+                    for ( int i = 0; i < OUTPUTS; ++ i )
+                        compress ( chunk -> text [ i ], options . level );
+                }
+
+                pthread_mutex_lock ( & lock );
+                reads += count;
+                done [ index ] = chunk;
+                pthread_mutex_unlock ( & lock );
+            }
+            catch ( ErrorMsg & x )
+            {
+                delete chunk;
+                fail ( x . toString () );
+            }
+            catch ( exception & x )
+            {
+                delete chunk;
+                fail ( x . what () );
+            }
+            catch ( ... )
+            {
+                delete chunk;
+                fail ( "unknown exception" );
+            }
+            flush ();
+        }
+    }
+
+    void fail ( const String & msg )
+    {
+        pthread_mutex_lock ( & lock );
+        if ( error . empty () )
+            error = msg;
+        pthread_cond_broadcast ( & moved );
+        pthread_mutex_unlock ( & lock );
+    }
+
+    /* writes what is ready, unless another thread is writing already,
+       which then writes it instead */
+    void flush ()
+    {
+        pthread_mutex_lock ( & lock );
+        while ( ! writing && error . empty () )
+        {
+            vector < Chunk * > ready;
+            map < uint64_t, Chunk * > :: iterator i = done . begin ();
+            while ( i != done . end () && ( ! options . ordered || i -> first == written + ready . size () ) )
+            {
+                ready . push_back ( i -> second );
+                done . erase ( i ++ );
+            }
+            if ( ready . empty () )
+                break;
+
+            writing = true;
+            pthread_mutex_unlock ( & lock );
+            bool ok = true;
+            for ( size_t c = 0; c < ready . size (); ++ c )
+            {
+                for ( int f = 0; f < OUTPUTS; ++ f )
+                {
+                    const String & text = ready [ c ] -> text [ f ];
+                    if ( ! text . empty () && fwrite ( text . data (), 1, text . size (), out [ f ] ) != text . size () )
+                        ok = false;
+                }
+                delete ready [ c ];
+            }
+            pthread_mutex_lock ( & lock );
+            writing = false;
+            written += ready . size ();
+            if ( ! ok && error . empty () )
+                error = "error writing the output";
+            pthread_cond_broadcast ( & moved );
+        }
+        pthread_mutex_unlock ( & lock );
+    }
+
+    static void append ( String & text, const StringRef & id, const char * suffix,
+            const StringView & bases, const StringView & qualities )
+    {
+        text += '@';
+        text . append ( id . data (), id . size () );
+        text += suffix;
+        text += '\n';
+        text . append ( bases . data (), bases . size () );
+        text += "\n+\n";
+        text . append ( qualities . data (), qualities . size () );
+        text += '\n';
+    }
+
+    // the FASTQ of the Reads of chunk "index"; returns their number
+    uint64_t format ( uint64_t index, Chunk & chunk )
+    {
+        uint64_t first = index * options . chunk;
+        uint64_t count = rows - first < options . chunk ? rows - first : options . chunk;
+        ReadIterator it = collection . getReadRange ( first + 1, count, Read :: all );
+
+        uint64_t n = 0;
+        for ( ; it . nextRead (); ++ n )
+        {
+            StringRef id = it . getReadId ();
+            if ( options . split && it . getNumFragments () == 2 )
+            {
+                for ( int f = FIRST; f <= SECOND && it . nextFragment (); ++ f )
+                    append ( chunk . text [ f ], id, "", it . getFragmentBasesView (), it . getFragmentQualitiesView () );
+            }
+            else
+            {
+                StringRef bases = it . getReadBases ();
+                StringRef qualities = it . getReadQualities ();
+                append ( chunk . text [ UNPAIRED ], id, "",
+                         StringView ( bases . data (), bases . size () ),
+                         StringView ( qualities . data (), qualities . size () ) );
+            }
+        }
+        return n;
+    }
+
+    // replaces "text" with a gzip member of it
+    static void compress ( String & text, int level )
+    {
+        if ( text . empty () )
+            return;
+
+        z_stream zs;
+        memset ( & zs, 0, sizeof zs );
+        if ( deflateInit2 ( & zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+            throw runtime_error ( "can't start compressing" );
+
+        String gz ( deflateBound ( & zs, text . size () ), '\0' );
+        zs . next_in = ( Bytef * ) text . data ();
+        zs . avail_in = text . size ();
+        zs . next_out = ( Bytef * ) & gz [ 0 ];
+        zs . avail_out = gz . size ();
+        int rc = deflate ( & zs, Z_FINISH );
+        gz . resize ( zs . total_out );
+        deflateEnd ( & zs );
+        if ( rc != Z_STREAM_END )
+            throw runtime_error ( "can't compress" );
+        text . swap ( gz );
+    }
+
+    ReadCollection collection;
+    Options options;
+    uint64_t rows;
+    uint64_t chunks;
+
+    pthread_mutex_t lock;
+    pthread_cond_t moved;           // a chunk was written, or one failed
+    uint64_t next;                  // the next chunk to format
+    uint64_t written;               // the number written
+    map < uint64_t, Chunk * > done; // formatted, not written yet
+    bool writing;
+    uint64_t reads;
+    String error;                   // the first failure
+
+    FILE * out [ OUTPUTS ];
+};
+
+static void usage ()
+{
+    cerr << "Usage: FastqDump [ options ] accession\n"
+         << "  -t threads   threads to format on ( 4 )\n"
+         << "  -c reads     Reads per chunk ( 20000 )\n"
+         << "  -o prefix    write to <prefix>.fastq rather than to stdout\n"
+         << "  --split      paired fragments to <prefix>_1.fastq and <prefix>_2.fastq\n"
+         << "  -z [ level ] compress with gzip ( 6 ), adding .gz to the names\n"
+         << "  --ordered    keep the output in the order of the Reads\n";
+}
+
+int main ( int argc, char const *argv[] )
+{
+    FastqDump :: Options options;
+    char const * acc = 0;
+    for ( int i = 1; i < argc; ++ i )
+    {
+        String arg = argv [ i ];
+        if ( arg == "-t" && i + 1 < argc )
+            options . threads = strtoul ( argv [ ++ i ], 0, 10 );
+        else if ( arg == "-c" && i + 1 < argc )
+            options . chunk = strtoull ( argv [ ++ i ], 0, 10 );
+        else if ( arg == "-o" && i + 1 < argc )
+            options . prefix = argv [ ++ i ];
+        else if ( arg == "--split" )
+            options . split = true;
+        else if ( arg == "--ordered" )
+            options . ordered = true;
+        else if ( arg == "-z" )
+        {
+            options . level = 6;
+            if ( i + 1 < argc && argv [ i + 1 ] [ 0 ] >= '1' && argv [ i + 1 ] [ 0 ] <= '9' && argv [ i + 1 ] [ 1 ] == '\0' )
+                options . level = argv [ ++ i ] [ 0 ] - '0';
+        }
+        else if ( acc == 0 && arg [ 0 ] != '-' )
+            acc = argv [ i ];
+        else
+            acc = 0, i = argc;
+    }
+
+    if ( acc == 0 || options . threads == 0 || options . chunk == 0
+         || ( options . split && options . prefix . empty () ) )
+    {
+        usage ();
+    }
+    else try
+    {
+        ncbi::NGS::setAppVersionString ( "FastqDump.1.0.0" );
+        FastqDump::run ( acc, options );
+        return 0;
+    }
+    catch ( ErrorMsg & x )
+    {
+        cerr <<  x.toString () << '\n';
+    }
+    catch ( exception & x )
+    {
+        cerr <<  x.what () << '\n';
+    }
+    catch ( ... )
+    {
+        cerr <<  "unknown exception\n";
+    }
+
+    return 10;
+}
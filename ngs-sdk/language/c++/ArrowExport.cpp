@@ -0,0 +1,523 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/ArrowExport.hpp>
+
+#include <errno.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+namespace ngs
+{
+    namespace arrow
+    {
+        /*------------------------------------------------------------------
+         * ExportedArray
+         *  what an exported ArrowArray owns: its buffers, and its children
+         *  and dictionary, which a consumer may move out and release apart
+         *  from it
+         */
+        class ExportedArray
+        {
+        public:
+
+            /* makes "out" an empty array owning a new ExportedArray */
+            static ExportedArray * Attach ( ArrowArray * out )
+            {
+                ExportedArray * array = new ExportedArray;
+                memset ( out, 0, sizeof * out );
+                out -> release = Release;
+                out -> private_data = array;
+                return array;
+            }
+
+            /* a buffer of "size" zeroed bytes; never NULL */
+            char * Buffer ( size_t size )
+            {
+                data . push_back ( std :: vector < char > () );
+                data . back () . resize ( size != 0 ? size : 1 );
+                return & data . back () [ 0 ];
+            }
+
+            /* a child, to be attached once filled in */
+            ArrowArray * Child ()
+            {
+                children . push_back ( 0 );
+                children . back () = New ();
+                return children . back ();
+            }
+
+            ArrowArray * Dictionary ()
+            {
+                if ( dictionary == 0 )
+                    dictionary = New ();
+                return dictionary;
+            }
+
+            /* gives "out" its length and what it was given; no value is null */
+            void Finish ( ArrowArray * out, int64_t length )
+            {
+                buffers . assign ( 1, ( const void * ) 0 );
+                for ( size_t i = 0; i < data . size (); ++ i )
+                    buffers . push_back ( & data [ i ] [ 0 ] );
+
+                out -> length = length;
+                out -> n_buffers = buffers . size ();
+                out -> n_children = children . size ();
+                out -> buffers = & buffers [ 0 ];
+                out -> children = children . empty () ? 0 : & children [ 0 ];
+                out -> dictionary = dictionary;
+            }
+
+        private:
+
+            ExportedArray ()
+                : dictionary ( 0 )
+            {
+                // none owns more than offsets and values; the validity is NULL
+                data . reserve ( 2 );
+            }
+
+            ~ ExportedArray ()
+            {
+                for ( size_t i = 0; i < children . size (); ++ i )
+                    Free ( children [ i ] );
+                Free ( dictionary );
+            }
+
+            static ArrowArray * New ()
+            {
+                ArrowArray * array = new ArrowArray;
+                memset ( array, 0, sizeof * array );
+                return array;
+            }
+
+            // what the consumer moved out has been released already
+            static void Free ( ArrowArray * array )
+            {
+                if ( array != 0 )
+                {
+                    if ( array -> release != 0 )
+                        array -> release ( array );
+                    delete array;
+                }
+            }
+
+            static void Release ( ArrowArray * array )
+            {
+                delete static_cast < ExportedArray * > ( array -> private_data );
+                array -> release = 0;
+            }
+
+            std :: vector < std :: vector < char > > data;
+            std :: vector < const void * > buffers;
+            std :: vector < ArrowArray * > children;
+            ArrowArray * dictionary;
+        };
+
+        /*------------------------------------------------------------------
+         * ExportedSchema
+         *  what an exported ArrowSchema owns, as ExportedArray does
+         */
+        class ExportedSchema
+        {
+        public:
+
+            static ExportedSchema * Attach ( ArrowSchema * out, const char * format, const char * name )
+            {
+                ExportedSchema * schema = new ExportedSchema ( format, name );
+                memset ( out, 0, sizeof * out );
+                out -> format = schema -> format . c_str ();
+                out -> name = schema -> name . c_str ();
+                out -> release = Release;
+                out -> private_data = schema;
+                return schema;
+            }
+
+            void Child ( ArrowSchema * out, const char * format, const char * name )
+            {
+                children . push_back ( 0 );
+                children . back () = New ();
+                Attach ( children . back (), format, name );
+                out -> n_children = children . size ();
+                out -> children = & children [ 0 ];
+            }
+
+            /* makes the last child dictionary-encoded, of "format" values */
+            void Dictionary ( const char * format )
+            {
+                ArrowSchema * child = children . back ();
+                ExportedSchema * schema = static_cast < ExportedSchema * > ( child -> private_data );
+                schema -> dictionary = New ();
+                Attach ( schema -> dictionary, format, "" );
+                child -> dictionary = schema -> dictionary;
+            }
+
+        private:
+
+            ExportedSchema ( const char * Format, const char * Name )
+                : format ( Format )
+                , name ( Name )
+                , dictionary ( 0 )
+            {
+            }
+
+            ~ ExportedSchema ()
+            {
+                for ( size_t i = 0; i < children . size (); ++ i )
+                    Free ( children [ i ] );
+                Free ( dictionary );
+            }
+
+            static ArrowSchema * New ()
+            {
+                ArrowSchema * schema = new ArrowSchema;
+                memset ( schema, 0, sizeof * schema );
+                return schema;
+            }
+
+            static void Free ( ArrowSchema * schema )
+            {
+                if ( schema != 0 )
+                {
+                    if ( schema -> release != 0 )
+                        schema -> release ( schema );
+                    delete schema;
+                }
+            }
+
+            static void Release ( ArrowSchema * schema )
+            {
+                delete static_cast < ExportedSchema * > ( schema -> private_data );
+                schema -> release = 0;
+            }
+
+            String format;
+            String name;
+            std :: vector < ArrowSchema * > children;
+            ArrowSchema * dictionary;
+        };
+
+        /*------------------------------------------------------------------
+         * columns
+         */
+
+        template < class T >
+        static void FixedColumn ( ArrowArray * out, const T * values, uint32_t count )
+        {
+            ExportedArray * array = ExportedArray :: Attach ( out );
+            memcpy ( array -> Buffer ( count * sizeof ( T ) ), values, count * sizeof ( T ) );
+            array -> Finish ( out, count );
+        }
+
+        static void BoolColumn ( ArrowArray * out, const uint32_t * flags, uint32_t bit, uint32_t count )
+        {
+            ExportedArray * array = ExportedArray :: Attach ( out );
+            uint8_t * bits = ( uint8_t * ) array -> Buffer ( ( count + 7 ) / 8 );
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                if ( ( flags [ i ] & bit ) != 0 )
+                    bits [ i >> 3 ] |= ( uint8_t ) ( 1 << ( i & 7 ) );
+            }
+            array -> Finish ( out, count );
+        }
+
+        /* the strings of a batch column, copied out of the arena */
+        static void StringColumn ( ArrowArray * out, const NGS_AlignmentBatchString_v1 * strings,
+                const char * arena, uint32_t count )
+        {
+            uint64_t total = 0;
+            for ( uint32_t i = 0; i < count; ++ i )
+                total += strings [ i ] . size;
+
+            ExportedArray * array = ExportedArray :: Attach ( out );
+            int32_t * offsets = ( int32_t * ) array -> Buffer ( ( count + 1 ) * sizeof ( int32_t ) );
+            char * chars = array -> Buffer ( total );
+
+            int32_t offset = 0;
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                offsets [ i ] = offset;
+                memcpy ( chars + offset, arena + strings [ i ] . offset, strings [ i ] . size );
+                offset += strings [ i ] . size;
+            }
+            offsets [ count ] = offset;
+            array -> Finish ( out, count );
+        }
+
+        static void StringColumn ( ArrowArray * out, const std :: vector < String > & strings )
+        {
+            uint64_t total = 0;
+            for ( size_t i = 0; i < strings . size (); ++ i )
+                total += strings [ i ] . size ();
+
+            ExportedArray * array = ExportedArray :: Attach ( out );
+            int32_t * offsets = ( int32_t * ) array -> Buffer ( ( strings . size () + 1 ) * sizeof ( int32_t ) );
+            char * chars = array -> Buffer ( total );
+
+            int32_t offset = 0;
+            for ( size_t i = 0; i < strings . size (); ++ i )
+            {
+                offsets [ i ] = offset;
+                memcpy ( chars + offset, strings [ i ] . data (), strings [ i ] . size () );
+                offset += ( int32_t ) strings [ i ] . size ();
+            }
+            offsets [ strings . size () ] = offset;
+            array -> Finish ( out, strings . size () );
+        }
+
+        /*------------------------------------------------------------------
+         * AlignmentStream
+         *  the private data of the stream exportAlignments makes
+         */
+        class AlignmentStream
+        {
+        public:
+
+            AlignmentStream ( const AlignmentIterator & It, uint32_t Fields, uint32_t batchSize )
+                : it ( It )
+                , batch ( Fields, batchSize, ArenaSize ( Fields, batchSize ) )
+                , fields ( Fields )
+                , ended ( false )
+            {
+            }
+
+            static int GetSchema ( ArrowArrayStream * stream, ArrowSchema * out )
+            {
+                AlignmentStream * self = static_cast < AlignmentStream * > ( stream -> private_data );
+                out -> release = 0;
+                try
+                {
+                    self -> Schema ( out );
+                    return 0;
+                }
+                catch ( ... )
+                {
+                    self -> Fail ();
+                }
+                if ( out -> release != 0 )
+                    out -> release ( out );
+                return ENOMEM;
+            }
+
+            static int GetNext ( ArrowArrayStream * stream, ArrowArray * out )
+            {
+                AlignmentStream * self = static_cast < AlignmentStream * > ( stream -> private_data );
+                out -> release = 0;
+                try
+                {
+                    self -> Next ( out );
+                    return 0;
+                }
+                catch ( ... )
+                {
+                    self -> Fail ();
+                }
+                if ( out -> release != 0 )
+                    out -> release ( out );
+                return EIO;
+            }
+
+            static const char * GetLastError ( ArrowArrayStream * stream )
+            {
+                const AlignmentStream * self = static_cast < const AlignmentStream * > ( stream -> private_data );
+                return self -> error . empty () ? 0 : self -> error . c_str ();
+            }
+
+            static void Release ( ArrowArrayStream * stream )
+            {
+                delete static_cast < AlignmentStream * > ( stream -> private_data );
+                stream -> release = 0;
+            }
+
+        private:
+
+            /* room in the arena for the strings of "batchSize" short reads */
+            static uint32_t ArenaSize ( uint32_t fields, uint32_t batchSize )
+            {
+                uint64_t row
+                    = ( ( fields & AlignmentBatch :: referenceSpec ) != 0 ? 32 : 0 )
+                    + ( ( fields & AlignmentBatch :: readId ) != 0 ? 64 : 0 )
+                    + ( ( fields & AlignmentBatch :: fragmentBases ) != 0 ? 320 : 0 )
+                    + ( ( fields & AlignmentBatch :: fragmentQualities ) != 0 ? 320 : 0 );
+                uint64_t size = row * batchSize;
+                if ( size < 0x10000 )
+                    return row != 0 ? 0x10000 : 0;
+                // the offsets of a utf8 column are int32
+                return size < 0x40000000 ? ( uint32_t ) size : 0x40000000;
+            }
+
+            void Schema ( ArrowSchema * out ) const
+            {
+                ExportedSchema * schema = ExportedSchema :: Attach ( out, "+s", "" );
+                if ( ( fields & AlignmentBatch :: alignmentPosition ) != 0 )
+                {
+                    schema -> Child ( out, "l", "position" );
+                    schema -> Child ( out, "L", "length" );
+                }
+                if ( ( fields & AlignmentBatch :: mappingQuality ) != 0 )
+                    schema -> Child ( out, "i", "mapping_quality" );
+                if ( ( fields & AlignmentBatch :: alignmentFlags ) != 0 )
+                {
+                    schema -> Child ( out, "b", "is_primary" );
+                    schema -> Child ( out, "b", "is_reversed" );
+                    schema -> Child ( out, "b", "has_mate" );
+                }
+                if ( ( fields & AlignmentBatch :: referenceSpec ) != 0 )
+                {
+                    schema -> Child ( out, "i", "reference_spec" );
+                    schema -> Dictionary ( "u" );
+                }
+                if ( ( fields & AlignmentBatch :: readId ) != 0 )
+                    schema -> Child ( out, "u", "read_id" );
+                if ( ( fields & AlignmentBatch :: fragmentBases ) != 0 )
+                    schema -> Child ( out, "u", "fragment_bases" );
+                if ( ( fields & AlignmentBatch :: fragmentQualities ) != 0 )
+                    schema -> Child ( out, "u", "fragment_qualities" );
+            }
+
+            /* leaves "out" released at the end of the stream */
+            void Next ( ArrowArray * out )
+            {
+                if ( ended || ! it . nextAlignmentBatch ( batch ) )
+                {
+                    ended = true;
+                    return;
+                }
+
+                const NGS_AlignmentBatch_v1 & b = batch . batch;
+                ExportedArray * array = ExportedArray :: Attach ( out );
+                if ( ( fields & AlignmentBatch :: alignmentPosition ) != 0 )
+                {
+                    FixedColumn ( array -> Child (), b . position, b . count );
+                    FixedColumn ( array -> Child (), b . length, b . count );
+                }
+                if ( ( fields & AlignmentBatch :: mappingQuality ) != 0 )
+                    FixedColumn ( array -> Child (), b . map_qual, b . count );
+                if ( ( fields & AlignmentBatch :: alignmentFlags ) != 0 )
+                {
+                    BoolColumn ( array -> Child (), b . flags, NGS_AlignmentBatchFlags_primary, b . count );
+                    BoolColumn ( array -> Child (), b . flags, NGS_AlignmentBatchFlags_reversed, b . count );
+                    BoolColumn ( array -> Child (), b . flags, NGS_AlignmentBatchFlags_has_mate, b . count );
+                }
+                if ( ( fields & AlignmentBatch :: referenceSpec ) != 0 )
+                    SpecColumn ( array -> Child (), b );
+                if ( ( fields & AlignmentBatch :: readId ) != 0 )
+                    StringColumn ( array -> Child (), b . read_id, b . arena, b . count );
+                if ( ( fields & AlignmentBatch :: fragmentBases ) != 0 )
+                    StringColumn ( array -> Child (), b . bases, b . arena, b . count );
+                if ( ( fields & AlignmentBatch :: fragmentQualities ) != 0 )
+                    StringColumn ( array -> Child (), b . qualities, b . arena, b . count );
+                array -> Finish ( out, b . count );
+            }
+
+            /* the indices of the batch's reference specs, with the
+               dictionary of all those seen so far */
+            void SpecColumn ( ArrowArray * out, const NGS_AlignmentBatch_v1 & b )
+            {
+                ExportedArray * array = ExportedArray :: Attach ( out );
+                int32_t * indices = ( int32_t * ) array -> Buffer ( b . count * sizeof ( int32_t ) );
+
+                // alignments come sorted more often than not
+                int32_t last = -1;
+                for ( uint32_t i = 0; i < b . count; ++ i )
+                {
+                    const NGS_AlignmentBatchString_v1 & str = b . ref_spec [ i ];
+                    const char * spec = b . arena + str . offset;
+                    if ( last < 0 || specs [ last ] . size () != str . size
+                         || memcmp ( specs [ last ] . data (), spec, str . size ) != 0 )
+                    {
+                        String key ( spec, str . size );
+                        std :: map < String, int32_t > :: const_iterator found = index . find ( key );
+                        if ( found != index . end () )
+                            last = found -> second;
+                        else
+                        {
+                            last = ( int32_t ) specs . size ();
+                            specs . push_back ( key );
+                            index [ key ] = last;
+                        }
+                    }
+                    indices [ i ] = last;
+                }
+
+                StringColumn ( array -> Dictionary (), specs );
+                array -> Finish ( out, b . count );
+            }
+
+            void Fail ()
+            {
+                try
+                {
+                    throw;
+                }
+                catch ( std :: exception & x )
+                {
+                    Note ( x . what () );
+                }
+                catch ( ... )
+                {
+                    Note ( "unknown error" );
+                }
+            }
+
+            // nothing may be thrown back through the stream
+            void Note ( const char * msg )
+                NGS_NOTHROW
+            {
+                try
+                {
+                    error = msg;
+                }
+                catch ( ... )
+                {
+                    error . clear ();
+                }
+            }
+
+            AlignmentIterator it;
+            AlignmentBatch batch;
+            uint32_t fields;
+            std :: map < String, int32_t > index;
+            std :: vector < String > specs;     // in the order of their indices
+            String error;                       // of the last failure
+            bool ended;
+        };
+
+        void exportAlignments ( const AlignmentIterator & it, ArrowArrayStream * out, uint32_t fields, uint32_t batchSize )
+            NGS_THROWS ( ErrorMsg )
+        {
+            out -> private_data = new AlignmentStream ( it, fields & AlignmentBatch :: allFields, batchSize );
+            out -> get_schema = AlignmentStream :: GetSchema;
+            out -> get_next = AlignmentStream :: GetNext;
+            out -> get_last_error = AlignmentStream :: GetLastError;
+            out -> release = AlignmentStream :: Release;
+        }
+
+    } // namespace arrow
+
+} // namespace ngs
@@ -0,0 +1,332 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/Executor.hpp>
+
+#include "Threads.hpp"
+
+#include <deque>
+#include <string>
+
+namespace ngs
+{
+    /* ExecutorQuery
+     *  an iterator and its handler, advanced a step at a time
+     */
+    class ExecutorQuery
+    {
+    public:
+
+        /* Step
+         *  returns false at the end of the query
+         */
+        virtual bool Step () = 0;
+
+        virtual void Finish ( const String & error )
+            NGS_NOTHROW = 0;
+
+        virtual ~ ExecutorQuery ()
+        {
+        }
+    };
+
+    template < class H >
+    static void FinishHandler ( H & handler, const String & error )
+        NGS_NOTHROW
+    {
+        try
+        {
+            handler . finished ( error );
+        }
+        catch ( ... )
+        {
+        }
+    }
+
+    class AlignmentQuery : public ExecutorQuery
+    {
+    public:
+
+        AlignmentQuery ( const AlignmentIterator & It, AlignmentHandler & Handler,
+                uint32_t fields, uint32_t capacity, uint32_t arenaSize )
+            : it ( It )
+            , handler ( Handler )
+            , batch ( fields, capacity, arenaSize )
+        {
+        }
+
+        bool Step ()
+        {
+            if ( ! it . nextAlignmentBatch ( batch ) )
+                return false;
+            return batch . size () == 0 || handler . alignments ( batch );
+        }
+
+        void Finish ( const String & error )
+            NGS_NOTHROW
+        { FinishHandler ( handler, error ); }
+
+    private:
+
+        AlignmentIterator it;
+        AlignmentHandler & handler;
+        AlignmentBatch batch;
+    };
+
+    class ReadQuery : public ExecutorQuery
+    {
+    public:
+
+        ReadQuery ( const ReadIterator & It, ReadHandler & Handler, uint32_t Count )
+            : it ( It )
+            , handler ( Handler )
+            , step ( Count )
+        {
+        }
+
+        bool Step ()
+        {
+            for ( uint32_t i = 0; i < step; ++ i )
+            {
+                if ( ! it . nextRead () || ! handler . read ( it ) )
+                    return false;
+            }
+            return true;
+        }
+
+        void Finish ( const String & error )
+            NGS_NOTHROW
+        { FinishHandler ( handler, error ); }
+
+    private:
+
+        ReadIterator it;
+        ReadHandler & handler;
+        uint32_t step;
+    };
+
+    class PileupQuery : public ExecutorQuery
+    {
+    public:
+
+        PileupQuery ( const PileupIterator & It, PileupHandler & Handler, uint32_t Count )
+            : it ( It )
+            , handler ( Handler )
+            , step ( Count )
+        {
+        }
+
+        bool Step ()
+        {
+            for ( uint32_t i = 0; i < step; ++ i )
+            {
+                if ( ! it . nextPileup () || ! handler . pileup ( it ) )
+                    return false;
+            }
+            return true;
+        }
+
+        void Finish ( const String & error )
+            NGS_NOTHROW
+        { FinishHandler ( handler, error ); }
+
+    private:
+
+        PileupIterator it;
+        PileupHandler & handler;
+        uint32_t step;
+    };
+
+    /* ExecutorState
+     *  the queue of queries and the threads serving it
+     */
+    class ExecutorState
+    {
+    public:
+
+        ExecutorState ( uint32_t count )
+            : threads ( new Thread [ count ] )
+            , started ( 0 )
+            , pending ( 0 )
+            , stop ( false )
+        {
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                if ( threads [ started ] . Start ( Run, this ) )
+                    ++ started;
+            }
+        }
+
+        ~ ExecutorState ()
+        {
+            lock . Lock ();
+            stop = true;
+            work . WakeAll ();
+            lock . Unlock ();
+
+            for ( uint32_t i = 0; i < started; ++ i )
+                threads [ i ] . Join ();
+            delete [] threads;
+        }
+
+        static void Run ( void * self )
+        {
+            static_cast < ExecutorState * > ( self ) -> Serve ();
+        }
+
+        /* Serve
+         *  runs a step of the query at the front of the queue without
+         *  the lock, then puts it at the back or finishes it
+         */
+        void Serve ()
+            NGS_NOTHROW
+        {
+            lock . Lock ();
+            for ( ; ; )
+            {
+                while ( queue . empty () && ! stop )
+                    work . Wait ( lock );
+                if ( queue . empty () )
+                    break;
+
+                ExecutorQuery * query = queue . front ();
+                queue . pop_front ();
+                lock . Unlock ();
+
+                bool more = false;
+                std :: string what;
+                try
+                {
+                    more = query -> Step ();
+                }
+                catch ( ErrorMsg & x )
+                {
+                    what = x . toMessage ();
+                }
+                catch ( std :: exception & x )
+                {
+                    what = x . what ();
+                }
+                catch ( ... )
+                {
+                    what = "unknown error in executor query";
+                }
+
+                if ( ! more )
+                {
+                    query -> Finish ( what );
+                    delete query;
+                }
+
+                lock . Lock ();
+                if ( more )
+                    queue . push_back ( query );
+                else if ( -- pending == 0 )
+                    idle . WakeAll ();
+            }
+            lock . Unlock ();
+        }
+
+        Mutex lock;
+        Condition work;             // the queue has a query, or stop
+        Condition idle;             // nothing is pending
+        std :: deque < ExecutorQuery * > queue;
+        Thread * threads;
+        uint32_t started;
+        size_t pending;             // queries not yet finished
+        bool stop;
+    };
+
+    void Executor :: submit ( const AlignmentIterator & it, AlignmentHandler & handler,
+            uint32_t fields, uint32_t capacity, uint32_t arenaSize )
+        NGS_THROWS ( ErrorMsg )
+    {
+        Submit ( new AlignmentQuery ( it, handler, fields, capacity, arenaSize ) );
+    }
+
+    void Executor :: submit ( const ReadIterator & it, ReadHandler & handler, uint32_t step )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( step == 0 )
+            throw ErrorMsg ( "executor step is 0" );
+        Submit ( new ReadQuery ( it, handler, step ) );
+    }
+
+    void Executor :: submit ( const PileupIterator & it, PileupHandler & handler, uint32_t step )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( step == 0 )
+            throw ErrorMsg ( "executor step is 0" );
+        Submit ( new PileupQuery ( it, handler, step ) );
+    }
+
+    void Executor :: Submit ( ExecutorQuery * query )
+        NGS_THROWS ( ErrorMsg )
+    {
+        state -> lock . Lock ();
+        try
+        {
+            state -> queue . push_back ( query );
+        }
+        catch ( ... )
+        {
+            state -> lock . Unlock ();
+            delete query;
+            throw ErrorMsg ( "failed to queue executor query" );
+        }
+        ++ state -> pending;
+        state -> work . WakeAll ();
+        state -> lock . Unlock ();
+    }
+
+    void Executor :: wait ()
+        NGS_NOTHROW
+    {
+        state -> lock . Lock ();
+        while ( state -> pending != 0 )
+            state -> idle . Wait ( state -> lock );
+        state -> lock . Unlock ();
+    }
+
+    Executor :: Executor ( uint32_t threads )
+        NGS_THROWS ( ErrorMsg )
+        : state ( new ExecutorState ( threads == 0 ? 1 : threads ) )
+    {
+        if ( state -> started == 0 )
+        {
+            delete state;
+            throw ErrorMsg ( "failed to start executor threads" );
+        }
+    }
+
+    Executor :: ~ Executor ()
+        NGS_NOTHROW
+    {
+        wait ();
+        delete state;
+    }
+
+} // namespace ngs
@@ -29,33 +29,35 @@
 namespace ngs
 {
     Fragment :: Fragment ( FragmentRef ref )
-            throw ()
+            NGS_NOTHROW
         : self ( ref )
     {
         assert ( ref != 0 );
     }
 
     Fragment & Fragment :: operator = ( const Fragment & obj )
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         assert ( obj . self != 0 );
         FragmentRef new_ref = obj . self -> Duplicate ();
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = new_ref;
         return * this;
     }
 
     Fragment :: Fragment ( const Fragment & obj )
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
         : self ( obj . self -> Duplicate () )
     {
         assert ( obj . self != 0 );
     }
     
     Fragment :: ~ Fragment ()
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         this -> self = 0;
     }
 
@@ -0,0 +1,250 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/MultiPileupIterator.hpp>
+
+#include "Prefetcher.hpp"
+
+namespace ngs
+{
+    /* the positions in a batch */
+    static const uint32_t MULTI_PILEUP_BATCH = 64;
+
+    /* MultiPileupSlot
+     *  the columns of a sample's next covered positions
+     */
+    class MultiPileupSlot : public Prefetcher :: Slot
+    {
+    public:
+
+        MultiPileupSlot ( PileupIterator & It, uint32_t fields )
+            : it ( It )
+            , count ( 0 )
+        {
+            columns . reserve ( MULTI_PILEUP_BATCH );
+            try
+            {
+                for ( uint32_t i = 0; i < MULTI_PILEUP_BATCH; ++ i )
+                    columns . push_back ( new PileupColumn ( fields ) );
+            }
+            catch ( ... )
+            {
+                for ( size_t i = 0; i < columns . size (); ++ i )
+                    delete columns [ i ];
+                throw;
+            }
+            positions . resize ( MULTI_PILEUP_BATCH );
+        }
+
+        ~ MultiPileupSlot ()
+        {
+            for ( size_t i = 0; i < columns . size (); ++ i )
+                delete columns [ i ];
+        }
+
+        // the positions no alignment covers are passed over here
+        // when the engine doesn't skip them itself
+        bool Fill ()
+        {
+            count = 0;
+            while ( count < MULTI_PILEUP_BATCH && it . nextPileup () )
+            {
+                it . getColumn ( * columns [ count ] );
+                if ( columns [ count ] -> size () != 0 )
+                    positions [ count ++ ] = it . getReferencePosition ();
+            }
+            return count != 0;
+        }
+
+        PileupIterator & it;
+        std :: vector < PileupColumn * > columns;
+        std :: vector < int64_t > positions;
+        uint32_t count;
+    };
+
+    /* MultiPileupSample
+     *  a sample's Pileups, read ahead on a thread of their own
+     */
+    class MultiPileupSample
+    {
+    public:
+
+        MultiPileupSample ( const PileupIterator & It, uint32_t fields, uint32_t depth )
+            : it ( It )
+            , prefetcher ( 0 )
+            , slot ( 0 )
+            , idx ( 0 )
+        {
+            std :: vector < Prefetcher :: Slot * > slots;
+            try
+            {
+                for ( uint32_t i = 0; i < depth; ++ i )
+                    slots . push_back ( new MultiPileupSlot ( it, fields ) );
+            }
+            catch ( ... )
+            {
+                for ( size_t i = 0; i < slots . size (); ++ i )
+                    delete slots [ i ];
+                throw;
+            }
+            prefetcher = new Prefetcher ( slots );
+        }
+
+        ~ MultiPileupSample ()
+        {
+            delete prefetcher;
+        }
+
+        // to the sample's next covered position; false at its end
+        bool Next ()
+        {
+            if ( slot != 0 && ++ idx < slot -> count )
+                return true;
+            idx = 0;
+            slot = static_cast < MultiPileupSlot * > ( prefetcher -> Next () );
+            return slot != 0;
+        }
+
+        bool At ( int64_t position ) const
+        { return slot != 0 && slot -> positions [ idx ] == position; }
+
+        PileupIterator it;
+        Prefetcher * prefetcher;
+        MultiPileupSlot * slot;     // the one in use, or NULL at the end
+        uint32_t idx;               // of the current position in it
+    };
+
+    static
+    PileupIterator MultiPileupSlice ( const Reference & ref, int64_t start, uint64_t length,
+        Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality )
+    {
+        // engines that skip the empty positions themselves save the thread the trip
+        try
+        {
+            return ref . getFilteredPileupSlice ( start, length, categories, filters, mappingQuality, 0, 0, true );
+        }
+        catch ( ErrorMsg & )
+        {
+        }
+        return ref . getFilteredPileupSlice ( start, length, categories, filters, mappingQuality );
+    }
+
+    MultiPileupIterator :: MultiPileupIterator ( const std :: vector < Reference > & references,
+            int64_t start, uint64_t length, Alignment :: AlignmentCategory categories,
+            Alignment :: AlignmentFilter filters, int32_t mappingQuality,
+            uint32_t fields, uint32_t depth )
+            NGS_THROWS ( ErrorMsg )
+        : empty ( fields, 1, 1 )
+        , position ( 0 )
+        , started ( false )
+        , done ( false )
+    {
+        if ( references . empty () )
+            throw ErrorMsg ( "no samples to pile up" );
+        if ( depth == 0 )
+            throw ErrorMsg ( "prefetch depth is 0" );
+
+        try
+        {
+            for ( size_t i = 0; i < references . size (); ++ i )
+            {
+                PileupIterator it = MultiPileupSlice ( references [ i ], start, length, categories, filters, mappingQuality );
+                samples . push_back ( new MultiPileupSample ( it, fields, depth ) );
+            }
+        }
+        catch ( ... )
+        {
+            for ( size_t i = 0; i < samples . size (); ++ i )
+                delete samples [ i ];
+            throw;
+        }
+    }
+
+    MultiPileupIterator :: ~ MultiPileupIterator ()
+        NGS_NOTHROW
+    {
+        for ( size_t i = 0; i < samples . size (); ++ i )
+            delete samples [ i ];
+    }
+
+    bool MultiPileupIterator :: nextPileup ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( done )
+            return false;
+
+        // the samples that were at the last position move on
+        bool any = false;
+        int64_t next = 0;
+        for ( size_t i = 0; i < samples . size (); ++ i )
+        {
+            MultiPileupSample & s = * samples [ i ];
+            if ( ! started || s . At ( position ) )
+                s . Next ();
+            if ( s . slot != 0 )
+            {
+                int64_t const pos = s . slot -> positions [ s . idx ];
+                if ( ! any || pos < next )
+                    next = pos;
+                any = true;
+            }
+        }
+
+        started = true;
+        done = ! any;
+        position = next;
+        return any;
+    }
+
+    int64_t MultiPileupIterator :: getReferencePosition () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ! started || done )
+            throw ErrorMsg ( "no current position" );
+        return position;
+    }
+
+    size_t MultiPileupIterator :: getSampleCount () const
+        NGS_NOTHROW
+    {
+        return samples . size ();
+    }
+
+    const PileupColumn & MultiPileupIterator :: getColumn ( size_t sample ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ! started || done )
+            throw ErrorMsg ( "no current position" );
+        if ( sample >= samples . size () )
+            throw ErrorMsg ( "no such sample" );
+
+        const MultiPileupSample & s = * samples [ sample ];
+        if ( ! s . At ( position ) )
+            return empty;
+        return * s . slot -> columns [ s . idx ];
+    }
+
+} // namespace ngs
@@ -0,0 +1,565 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/Parallel.hpp>
+#include <ngs/WorkPool.hpp>
+
+#include "Threads.hpp"
+
+#include <vector>
+#include <string>
+
+namespace ngs
+{
+    namespace parallel
+    {
+        namespace
+        {
+            /* Tile
+             *  a window before it is handed to the task
+             */
+            struct Tile
+            {
+                size_t reference;
+                int64_t start;
+                uint64_t length;
+            };
+
+            /* Run
+             *  the tiles [ front, back ) that one thread has yet to visit
+             *  the owner takes from the front, thieves from the back
+             */
+            struct Run
+            {
+                Mutex lock;
+                uint64_t front;
+                uint64_t back;
+            };
+
+            /* Lane
+             *  what one thread keeps from window to window: the
+             *  Reference of the last, and the Pileups carried over
+             */
+            struct Lane
+            {
+                Lane ()
+                    : ref ( 0 )
+                    , current ( 0 )
+                    , pileups ( 0 )
+                    , last ( 0 )
+                    , extend ( true )
+                {
+                }
+
+                ~ Lane ()
+                {
+                    delete pileups;
+                    delete ref;
+                }
+
+                Reference * ref;
+                size_t current;
+                PileupIterator * pileups;
+                uint64_t last;              // the tile "pileups" is on
+                bool extend;                // false once the engine can't
+            };
+
+            /* Scheduler
+             */
+            class Scheduler
+            {
+            public:
+
+                Scheduler ( const ReadCollection & Collection, uint32_t threads )
+                    : collection ( Collection )
+                    , workers ( threads )
+                    , next ( 0 )
+                    , reducing ( false )
+                    , failed ( false )
+                {
+                }
+
+                virtual ~ Scheduler ()
+                {
+                    for ( size_t i = 0; i < runs . size (); ++ i )
+                        delete runs [ i ];
+                }
+
+                /* Tiles
+                 *  lists the windows and deals out runs of them
+                 */
+                void Tiles ( uint64_t windowSize )
+                {
+                    ReferenceIterator refs = collection . getReferences ();
+                    while ( refs . nextReference () )
+                    {
+                        uint64_t const length = refs . getLength ();
+                        names . push_back ( refs . getCommonName () );
+
+                        Tile t;
+                        t . reference = names . size () - 1;
+                        for ( uint64_t start = 0; start < length; start += windowSize )
+                        {
+                            t . start = ( int64_t ) start;
+                            t . length = length - start < windowSize ? length - start : windowSize;
+                            tiles . push_back ( t );
+                        }
+                    }
+                    done . assign ( tiles . size (), false );
+
+                    if ( ( uint64_t ) workers > tiles . size () )
+                        workers = tiles . size () == 0 ? 1 : ( uint32_t ) tiles . size ();
+                    for ( uint32_t i = 0; i < workers; ++ i )
+                    {
+                        Run * run = new Run;
+                        run -> front = tiles . size () * i / workers;
+                        run -> back = tiles . size () * ( i + 1 ) / workers;
+                        runs . push_back ( run );
+                    }
+                }
+
+                uint32_t Workers () const
+                { return workers; }
+
+                /* Work
+                 *  what each thread does, until no run has tiles left
+                 *  a thread that failed to start leaves its run to thieves
+                 */
+                void Work ( uint32_t self )
+                    NGS_NOTHROW
+                {
+                    Lane lane;
+                    uint64_t tile;
+                    for ( ; ; )
+                    {
+                        if ( ! Take ( self, tile ) )
+                        {
+                            if ( ! Steal ( self ) )
+                                break;
+                            continue;
+                        }
+
+                        const Tile & t = tiles [ tile ];
+                        std :: string what;
+                        try
+                        {
+                            if ( lane . ref == 0 || lane . current != t . reference )
+                            {
+                                delete lane . pileups;
+                                lane . pileups = 0;
+                                delete lane . ref;
+                                lane . ref = 0;
+                                lane . ref = new Reference ( collection . getReference ( names [ t . reference ] ) );
+                                lane . current = t . reference;
+                            }
+                            Window window = MakeWindow ( tile );
+                            Visit ( lane, tile, window );
+                        }
+                        catch ( ErrorMsg & x )
+                        {
+                            what = x . toMessage ();
+                        }
+                        catch ( std :: exception & x )
+                        {
+                            what = x . what ();
+                        }
+                        catch ( ... )
+                        {
+                            what = "unknown error in parallel task";
+                        }
+                        if ( ! what . empty () )
+                            Fail ( what );
+                        if ( ! Finish ( tile ) )
+                            break;
+                    }
+                }
+
+                /* Check
+                 *  throws the first error, after all threads are done
+                 */
+                void Check () const
+                    NGS_THROWS ( ErrorMsg )
+                {
+                    if ( failed )
+                        throw ErrorMsg ( error );
+                }
+
+            protected:
+
+                /* Visit
+                 *  runs the task over one window, "lane" holding its Reference
+                 */
+                virtual void Visit ( Lane & lane, uint64_t tile, const Window & window ) = 0;
+                virtual void Reduce ( const Window & window ) = 0;
+
+            private:
+
+                Window MakeWindow ( uint64_t tile ) const
+                {
+                    const Tile & t = tiles [ tile ];
+                    Window window;
+                    window . reference = names [ t . reference ];
+                    window . start = t . start;
+                    window . length = t . length;
+                    window . index = tile;
+                    return window;
+                }
+
+                bool Take ( uint32_t self, uint64_t & tile )
+                {
+                    Run & run = * runs [ self ];
+                    run . lock . Lock ();
+                    bool const took = run . front < run . back;
+                    if ( took )
+                        tile = run . front ++;
+                    run . lock . Unlock ();
+                    return took;
+                }
+
+                /* Steal
+                 *  moves the back half of the first run found with tiles
+                 *  into the thief's own, which is empty and so untouched
+                 *  by other thieves meanwhile
+                 */
+                bool Steal ( uint32_t self )
+                {
+                    for ( uint32_t k = 1; k < workers; ++ k )
+                    {
+                        Run & victim = * runs [ ( self + k ) % workers ];
+                        victim . lock . Lock ();
+                        uint64_t const left = victim . back - victim . front;
+                        uint64_t const back = victim . back;
+                        if ( left != 0 )
+                            victim . back -= ( left + 1 ) / 2;
+                        uint64_t const front = victim . back;
+                        victim . lock . Unlock ();
+
+                        if ( left != 0 )
+                        {
+                            Run & run = * runs [ self ];
+                            run . lock . Lock ();
+                            run . front = front;
+                            run . back = back;
+                            run . lock . Unlock ();
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                /* Fail
+                 *  keeps the first error and empties the runs
+                 */
+                void Fail ( const std :: string & what )
+                {
+                    state . Lock ();
+                    if ( ! failed )
+                    {
+                        failed = true;
+                        error = what;
+                    }
+                    state . Unlock ();
+
+                    for ( size_t i = 0; i < runs . size (); ++ i )
+                    {
+                        runs [ i ] -> lock . Lock ();
+                        runs [ i ] -> front = runs [ i ] -> back;
+                        runs [ i ] -> lock . Unlock ();
+                    }
+                }
+
+                /* Finish
+                 *  marks a tile as visited and reduces those visited in
+                 *  order from "next"; one thread reduces at a time, and
+                 *  does so without the lock while the others go on
+                 *  returns false once anything failed
+                 */
+                bool Finish ( uint64_t tile )
+                {
+                    state . Lock ();
+                    done [ tile ] = true;
+                    if ( ! reducing )
+                    {
+                        reducing = true;
+                        while ( ! failed && next < done . size () && done [ next ] )
+                        {
+                            Window window = MakeWindow ( next );
+                            state . Unlock ();
+
+                            std :: string what;
+                            try
+                            {
+                                Reduce ( window );
+                            }
+                            catch ( ErrorMsg & x )
+                            {
+                                what = x . toMessage ();
+                            }
+                            catch ( std :: exception & x )
+                            {
+                                what = x . what ();
+                            }
+                            catch ( ... )
+                            {
+                                what = "unknown error in parallel task";
+                            }
+                            if ( ! what . empty () )
+                                Fail ( what );
+
+                            state . Lock ();
+                            ++ next;
+                        }
+                        reducing = false;
+                    }
+                    bool const ok = ! failed;
+                    state . Unlock ();
+                    return ok;
+                }
+
+                const ReadCollection & collection;
+                uint32_t workers;
+
+                std :: vector < String > names;
+                std :: vector < Tile > tiles;
+                std :: vector < Run * > runs;
+
+                Mutex state;                // guards all below
+                std :: vector < bool > done;
+                uint64_t next;              // the first tile not reduced
+                bool reducing;
+                bool failed;
+                std :: string error;
+            };
+
+            /* SliceScheduler
+             *  visits the Alignments that start within each window
+             */
+            class SliceScheduler : public Scheduler
+            {
+            public:
+
+                SliceScheduler ( const ReadCollection & collection, SliceTask & Task, uint32_t threads,
+                        Alignment :: AlignmentCategory Categories, Alignment :: AlignmentFilter Filters, int32_t MappingQuality )
+                    : Scheduler ( collection, threads )
+                    , task ( Task )
+                    , categories ( Categories )
+                    , filters ( ( Alignment :: AlignmentFilter ) ( Filters | Alignment :: startWithinSlice ) )
+                    , mappingQuality ( MappingQuality )
+                {
+                }
+
+            protected:
+
+                void Visit ( Lane & lane, uint64_t tile, const Window & window )
+                {
+                    AlignmentIterator it = lane . ref -> getFilteredAlignmentSlice ( window . start, window . length,
+                        categories, filters, mappingQuality );
+                    task . visit ( window, it );
+                }
+
+                void Reduce ( const Window & window )
+                {
+                    task . reduce ( window );
+                }
+
+            private:
+
+                SliceTask & task;
+                Alignment :: AlignmentCategory categories;
+                Alignment :: AlignmentFilter filters;
+                int32_t mappingQuality;
+            };
+
+            /* PileupScheduler
+             *  visits the Pileups of each window; a thread going on to
+             *  the next window of the same Reference extends the slice it
+             *  has, so the Alignments that cross the boundary are carried
+             *  over rather than read again, and opens a new one otherwise
+             */
+            class PileupScheduler : public Scheduler
+            {
+            public:
+
+                PileupScheduler ( const ReadCollection & collection, PileupTask & Task, uint32_t threads,
+                        Alignment :: AlignmentCategory Categories, Alignment :: AlignmentFilter Filters, int32_t MappingQuality )
+                    : Scheduler ( collection, threads )
+                    , task ( Task )
+                    , categories ( Categories )
+                    , filters ( Filters )
+                    , mappingQuality ( MappingQuality )
+                {
+                }
+
+            protected:
+
+                void Visit ( Lane & lane, uint64_t tile, const Window & window )
+                {
+                    bool extended = false;
+                    if ( lane . pileups != 0 && lane . extend && tile == lane . last + 1 )
+                    {
+                        try
+                        {
+                            lane . pileups -> extendTo ( window . start + ( int64_t ) window . length );
+                            extended = true;
+                        }
+                        catch ( ErrorMsg & )
+                        {
+                            // an engine without it gets a slice per window
+                            lane . extend = false;
+                        }
+                    }
+                    if ( ! extended )
+                    {
+                        delete lane . pileups;
+                        lane . pileups = 0;
+                        lane . pileups = new PileupIterator ( lane . ref -> getFilteredPileupSlice ( window . start, window . length,
+                            categories, filters, mappingQuality ) );
+                    }
+                    lane . last = tile;
+
+                    task . visit ( window, * lane . pileups );
+
+                    // what the task left of the window is skipped, so that
+                    // extending starts on the next one
+                    while ( lane . pileups -> nextPileup () )
+                        ;
+                }
+
+                void Reduce ( const Window & window )
+                {
+                    task . reduce ( window );
+                }
+
+            private:
+
+                PileupTask & task;
+                Alignment :: AlignmentCategory categories;
+                Alignment :: AlignmentFilter filters;
+                int32_t mappingQuality;
+            };
+
+            /* Worker
+             *  a run of the scheduler on the shared pool; "finished"
+             *  counts those that have run or were taken back
+             */
+            struct Worker : public WorkItem
+            {
+                void run ()
+                {
+                    scheduler -> Work ( self );
+                    Finished ();
+                }
+
+                void Finished ()
+                {
+                    pending -> lock . Lock ();
+                    ++ pending -> finished;
+                    pending -> cond . WakeAll ();
+                    pending -> lock . Unlock ();
+                }
+
+                struct Pending
+                {
+                    Mutex lock;
+                    Condition cond;
+                    uint32_t finished;
+                };
+
+                Scheduler * scheduler;
+                Pending * pending;
+                uint32_t self;
+            };
+        }
+
+        static
+        void Drive ( Scheduler & scheduler, uint64_t windowSize )
+            NGS_THROWS ( ErrorMsg )
+        {
+            scheduler . Tiles ( windowSize );
+
+            // worker 0 is the caller, the others run on the pool
+            uint32_t const workers = scheduler . Workers ();
+            WorkPool & pool = WorkPool :: shared ();
+            Worker :: Pending pending;
+            pending . finished = 0;
+            std :: vector < Worker > args ( workers );
+            for ( uint32_t i = 1; i < workers; ++ i )
+            {
+                args [ i ] . scheduler = & scheduler;
+                args [ i ] . pending = & pending;
+                args [ i ] . self = i;
+                try
+                {
+                    pool . submit ( args [ i ] );
+                }
+                catch ( ... )
+                {
+                    // its run is left to thieves
+                    args [ i ] . Finished ();
+                }
+            }
+
+            scheduler . Work ( 0 );
+
+            // those that haven't started have nothing left to steal
+            for ( uint32_t i = 1; i < workers; ++ i )
+            {
+                if ( pool . cancel ( args [ i ] ) )
+                    args [ i ] . Finished ();
+            }
+            pending . lock . Lock ();
+            while ( pending . finished + 1 < workers )
+                pending . cond . Wait ( pending . lock );
+            pending . lock . Unlock ();
+
+            scheduler . Check ();
+        }
+
+        void forEachSlice ( const ReadCollection & collection, uint64_t windowSize, uint32_t threads, SliceTask & task,
+                Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality )
+            NGS_THROWS ( ErrorMsg )
+        {
+            if ( windowSize == 0 )
+                throw ErrorMsg ( "window size must not be zero" );
+
+            SliceScheduler scheduler ( collection, task, threads == 0 ? 1 : threads, categories, filters, mappingQuality );
+            Drive ( scheduler, windowSize );
+        }
+
+        void forEachPileup ( const ReadCollection & collection, uint64_t windowSize, uint32_t threads, PileupTask & task,
+                Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality )
+            NGS_THROWS ( ErrorMsg )
+        {
+            if ( windowSize == 0 )
+                throw ErrorMsg ( "window size must not be zero" );
+
+            PileupScheduler scheduler ( collection, task, threads == 0 ? 1 : threads, categories, filters, mappingQuality );
+            Drive ( scheduler, windowSize );
+        }
+
+    } // namespace parallel
+
+} // namespace ngs
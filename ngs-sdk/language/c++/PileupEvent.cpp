@@ -30,33 +30,35 @@ namespace ngs
 {
     
     PileupEvent :: PileupEvent ( PileupEventRef ref )
-            throw ()
+            NGS_NOTHROW
         : self ( ref )
     {
         assert ( ref != 0 );
     }
 
     PileupEvent & PileupEvent :: operator = ( const PileupEvent & obj )
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         assert ( obj . self != 0 );
         PileupEventRef new_ref = obj . self -> Duplicate ();
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = new_ref;
         return * this;
     }
 
     PileupEvent :: PileupEvent ( const PileupEvent & obj )
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
         : self ( obj . self == 0 ? 0 : obj . self -> Duplicate() )
     {
         assert ( obj . self != 0 );
     }
     
     PileupEvent :: ~ PileupEvent ()
-        throw ()
+        NGS_NOTHROW
     {
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = 0;
     }
 }
@@ -0,0 +1,197 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "Prefetcher.hpp"
+
+namespace ngs
+{
+    /* SharedPool
+     *  the pool, or deletes the slots the Prefetcher would own
+     */
+    static WorkPool & SharedPool ( const std :: vector < Prefetcher :: Slot * > & slots )
+        NGS_THROWS ( ErrorMsg )
+    {
+        try
+        {
+            return WorkPool :: shared ();
+        }
+        catch ( ... )
+        {
+            for ( size_t i = 0; i < slots . size (); ++ i )
+                delete slots [ i ];
+            throw;
+        }
+    }
+
+    Prefetcher :: Prefetcher ( const std :: vector < Slot * > & Slots )
+            NGS_THROWS ( ErrorMsg )
+        : pool ( SharedPool ( Slots ) )
+        , filler ( * this )
+        , slots ( Slots )
+        , filled ( 0 )
+        , used ( 0 )
+        , holding ( false )
+        , queued ( false )
+        , running ( false )
+        , done ( false )
+        , stop ( false )
+        , failed ( false )
+    {
+        lock . Lock ();
+        Schedule ();
+        lock . Unlock ();
+    }
+
+    Prefetcher :: ~ Prefetcher ()
+        NGS_NOTHROW
+    {
+        lock . Lock ();
+        stop = true;
+        if ( queued && pool . cancel ( filler ) )
+            queued = false;
+        while ( queued || running )
+            cond . Wait ( lock );
+        lock . Unlock ();
+
+        for ( size_t i = 0; i < slots . size (); ++ i )
+            delete slots [ i ];
+    }
+
+    Prefetcher :: Slot * Prefetcher :: Next ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        lock . Lock ();
+        if ( holding )
+        {
+            ++ used;
+            holding = false;
+            Schedule ();
+        }
+        while ( filled == used && ! done )
+        {
+            // rather than wait behind the pool's queue, fill it here
+            if ( queued && pool . cancel ( filler ) )
+                queued = false;
+            if ( ! queued && ! running )
+                FillOne ();
+            else
+                cond . Wait ( lock );
+        }
+
+        Slot * rslt = 0;
+        if ( filled != used )
+        {
+            holding = true;
+            rslt = slots [ used % slots . size () ];
+        }
+        lock . Unlock ();
+
+        if ( rslt == 0 && failed )
+            throw ErrorMsg ( error );
+        return rslt;
+    }
+
+    /* Schedule
+     *  submits the filler while there is room, unless it
+     *  is already; if it can't be, Next fills the slots
+     */
+    void Prefetcher :: Schedule ()
+        NGS_NOTHROW
+    {
+        if ( queued || running || done || stop || filled - used == slots . size () )
+            return;
+        try
+        {
+            pool . submit ( filler );
+            queued = true;
+        }
+        catch ( ... )
+        {
+        }
+    }
+
+    /* FillOne
+     *  the next slot isn't the consumer's, so it is filled without the lock
+     */
+    void Prefetcher :: FillOne ()
+        NGS_NOTHROW
+    {
+        running = true;
+        lock . Unlock ();
+
+        bool more = false;
+        bool threw = true;
+        std :: string what;
+        try
+        {
+            more = slots [ filled % slots . size () ] -> Fill ();
+            threw = false;
+        }
+        catch ( ErrorMsg & x )
+        {
+            what = x . toMessage ();
+        }
+        catch ( std :: exception & x )
+        {
+            what = x . what ();
+        }
+        catch ( ... )
+        {
+            what = "unknown error while prefetching";
+        }
+
+        lock . Lock ();
+        running = false;
+        if ( more )
+            ++ filled;
+        else
+        {
+            done = true;
+            failed = threw;
+            error = what;
+        }
+        cond . WakeAll ();
+    }
+
+    /* Run
+     *  a slot on the pool, then submits itself again
+     *  while there is room
+     */
+    void Prefetcher :: Run ()
+        NGS_NOTHROW
+    {
+        lock . Lock ();
+        queued = false;
+        if ( ! stop && ! done && filled - used != slots . size () )
+        {
+            FillOne ();
+            Schedule ();
+        }
+        cond . WakeAll ();
+        lock . Unlock ();
+    }
+
+} // namespace ngs
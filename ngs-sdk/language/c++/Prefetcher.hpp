@@ -0,0 +1,145 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_prefetcher_
+#define _hpp_ngs_prefetcher_
+
+#ifndef _hpp_ngs_error_msg_
+#include <ngs/ErrorMsg.hpp>
+#endif
+
+#ifndef _hpp_ngs_work_pool_
+#include <ngs/WorkPool.hpp>
+#endif
+
+#include "Threads.hpp"
+
+#include <vector>
+#include <string>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * Prefetcher
+     *  fills a ring of slots ahead of a single consumer, a slot at a time
+     *  on the shared WorkPool, so that many prefetching iterators don't
+     *  each keep a thread; the filler is submitted again while there is
+     *  room in the ring
+     *  a slot is handed over whole, so that the consumer reads all that
+     *  it holds without a lock; the lock is only taken to pass a slot
+     *  between the two, and to sleep when the ring is full or empty
+     *  a consumer that would wait for a fill that hasn't started takes
+     *  it back from the pool and fills the slot itself
+     */
+    class Prefetcher
+    {
+    public:
+
+        /* Slot
+         *  one batch of work, filled on the thread
+         */
+        class Slot
+        {
+        public:
+
+            /* Fill
+             *  returns false, leaving the slot unused, at the end
+             */
+            virtual bool Fill () = 0;
+
+            virtual ~ Slot ()
+            {
+            }
+        };
+
+        /* takes ownership of "slots" and starts filling them */
+        Prefetcher ( const std :: vector < Slot * > & slots )
+            NGS_THROWS ( ErrorMsg );
+
+        /* waits for a fill that is running, then deletes the slots */
+        ~ Prefetcher ()
+            NGS_NOTHROW;
+
+        /* Next
+         *  hands the slot returned last back to the filler, then the
+         *  next filled one, waiting for it if need be
+         *  returns NULL at the end
+         *  throws what a Fill threw, once the slots before it are used
+         */
+        Slot * Next ()
+            NGS_THROWS ( ErrorMsg );
+
+    private:
+
+        Prefetcher ( const Prefetcher & obj );
+        Prefetcher & operator = ( const Prefetcher & obj );
+
+        class Filler : public WorkItem
+        {
+        public:
+
+            explicit Filler ( Prefetcher & Owner )
+                : owner ( Owner )
+            {
+            }
+
+            void run ()
+            { owner . Run (); }
+
+        private:
+
+            Prefetcher & owner;
+        };
+
+        void Run ()
+            NGS_NOTHROW;
+
+        // both with the lock held
+        void Schedule ()
+            NGS_NOTHROW;
+        void FillOne ()
+            NGS_NOTHROW;
+
+        Mutex lock;
+        Condition cond;
+        WorkPool & pool;
+        Filler filler;
+
+        std :: vector < Slot * > slots;
+        size_t filled;              // slots filled so far
+        size_t used;                // slots handed back so far
+        bool holding;               // the consumer has slot "used"
+        bool queued;                // the filler is submitted
+        bool running;               // a slot is being filled
+        bool done;                  // the last slot has been filled
+        bool stop;                  // the consumer is going away
+        bool failed;
+        std :: string error;        // what a Fill threw
+    };
+
+} // namespace ngs
+
+#endif // _hpp_ngs_prefetcher_
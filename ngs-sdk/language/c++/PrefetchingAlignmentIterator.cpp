@@ -0,0 +1,103 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/PrefetchingAlignmentIterator.hpp>
+
+#include "Prefetcher.hpp"
+
+namespace ngs
+{
+    /* AlignmentSlot
+     *  a batch of the next Alignments
+     */
+    class AlignmentSlot : public Prefetcher :: Slot
+    {
+    public:
+
+        AlignmentSlot ( AlignmentIterator & It, uint32_t fields, uint32_t capacity, uint32_t arenaSize )
+            : it ( It )
+            , batch ( fields, capacity, arenaSize )
+        {
+        }
+
+        bool Fill ()
+        { return it . nextAlignmentBatch ( batch ); }
+
+        AlignmentIterator & it;
+        AlignmentBatch batch;
+    };
+
+    PrefetchingAlignmentIterator :: PrefetchingAlignmentIterator ( const AlignmentIterator & It,
+            uint32_t fields, uint32_t depth, uint32_t capacity, uint32_t arenaSize )
+            NGS_THROWS ( ErrorMsg )
+        : it ( It )
+        , prefetcher ( 0 )
+        , batch ( 0 )
+        , idx ( 0 )
+    {
+        if ( depth == 0 )
+            throw ErrorMsg ( "prefetch depth is 0" );
+
+        std :: vector < Prefetcher :: Slot * > slots;
+        try
+        {
+            for ( uint32_t i = 0; i < depth; ++ i )
+                slots . push_back ( new AlignmentSlot ( it, fields, capacity, arenaSize ) );
+        }
+        catch ( ... )
+        {
+            for ( size_t i = 0; i < slots . size (); ++ i )
+                delete slots [ i ];
+            throw;
+        }
+        prefetcher = new Prefetcher ( slots );
+    }
+
+    PrefetchingAlignmentIterator :: ~ PrefetchingAlignmentIterator ()
+        NGS_NOTHROW
+    {
+        delete prefetcher;
+    }
+
+    bool PrefetchingAlignmentIterator :: NextBatch ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        batch = 0;
+        idx = 0;
+        for ( ; ; )
+        {
+            AlignmentSlot * slot = static_cast < AlignmentSlot * > ( prefetcher -> Next () );
+            if ( slot == 0 )
+                return false;
+            if ( slot -> batch . size () != 0 )
+            {
+                batch = & slot -> batch;
+                return true;
+            }
+        }
+    }
+
+} // namespace ngs
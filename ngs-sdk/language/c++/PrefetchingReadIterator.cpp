@@ -0,0 +1,137 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/PrefetchingReadIterator.hpp>
+
+#include "Prefetcher.hpp"
+
+namespace ngs
+{
+    /* ReadSlot
+     *  the next Reads, copied into snapshots that are reused
+     */
+    class ReadSlot : public Prefetcher :: Slot
+    {
+    public:
+
+        ReadSlot ( ReadIterator & It, bool & Ended, uint32_t Fields, uint32_t capacity )
+            : it ( It )
+            , ended ( Ended )
+            , fields ( Fields )
+            , reads ( capacity )
+            , count ( 0 )
+        {
+        }
+
+        static void Copy ( String & dst, const StringRef & src )
+        { dst . assign ( src . data (), src . size () ); }
+
+        bool Fill ()
+        {
+            count = 0;
+            while ( ! ended && count < reads . size () )
+            {
+                if ( ! it . nextRead () )
+                {
+                    ended = true;
+                    break;
+                }
+
+                PrefetchingReadIterator :: Snapshot & read = reads [ count ++ ];
+                read . category = it . getReadCategory ();
+                read . fragments = it . getNumFragments ();
+                if ( fields & PrefetchingReadIterator :: readId )
+                    Copy ( read . id, it . getReadId () );
+                if ( fields & PrefetchingReadIterator :: readName )
+                    Copy ( read . name, it . getReadName () );
+                if ( fields & PrefetchingReadIterator :: readGroup )
+                    read . group = it . getReadGroup ();
+                if ( fields & PrefetchingReadIterator :: readBases )
+                    Copy ( read . bases, it . getReadBases () );
+                if ( fields & PrefetchingReadIterator :: readQualities )
+                    Copy ( read . qualities, it . getReadQualities () );
+            }
+            return count != 0;
+        }
+
+        ReadIterator & it;
+        bool & ended;               // shared by the slots
+        uint32_t fields;
+        std :: vector < PrefetchingReadIterator :: Snapshot > reads;
+        size_t count;
+    };
+
+    PrefetchingReadIterator :: PrefetchingReadIterator ( const ReadIterator & It,
+            uint32_t Fields, uint32_t depth, uint32_t capacity )
+            NGS_THROWS ( ErrorMsg )
+        : it ( It )
+        , fields ( Fields )
+        , prefetcher ( 0 )
+        , current ( 0 )
+        , end ( 0 )
+        , ended ( false )
+    {
+        if ( depth == 0 )
+            throw ErrorMsg ( "prefetch depth is 0" );
+        if ( capacity == 0 )
+            throw ErrorMsg ( "prefetch capacity is 0" );
+
+        std :: vector < Prefetcher :: Slot * > slots;
+        try
+        {
+            for ( uint32_t i = 0; i < depth; ++ i )
+                slots . push_back ( new ReadSlot ( it, ended, fields, capacity ) );
+        }
+        catch ( ... )
+        {
+            for ( size_t i = 0; i < slots . size (); ++ i )
+                delete slots [ i ];
+            throw;
+        }
+        prefetcher = new Prefetcher ( slots );
+    }
+
+    PrefetchingReadIterator :: ~ PrefetchingReadIterator ()
+        NGS_NOTHROW
+    {
+        delete prefetcher;
+    }
+
+    bool PrefetchingReadIterator :: NextBatch ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        current = end = 0;
+
+        ReadSlot * slot = static_cast < ReadSlot * > ( prefetcher -> Next () );
+        if ( slot == 0 )
+            return false;
+
+        current = & slot -> reads [ 0 ];
+        end = current + slot -> count;
+        return true;
+    }
+
+} // namespace ngs
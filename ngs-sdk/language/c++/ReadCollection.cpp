@@ -30,39 +30,42 @@ namespace ngs
 {
 
     ReadCollection & ReadCollection :: operator = ( ReadCollectionRef ref )
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         self = ref;
 
         return * this;
     }
 
     ReadCollection :: ReadCollection ( ReadCollectionRef ref )
-            throw ()
+            NGS_NOTHROW
         : self ( ref )
     {
     }
 
     ReadCollection & ReadCollection :: operator = ( const ReadCollection & obj )
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         self = obj . self -> Duplicate ();
 
         return * this;
     }
 
     ReadCollection :: ReadCollection ( const ReadCollection & obj )
-            throw ()
+            NGS_NOTHROW
         : self ( obj . self -> Duplicate () )
     {
     }
 
     ReadCollection :: ~ ReadCollection ()
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         self = 0;
     }
 
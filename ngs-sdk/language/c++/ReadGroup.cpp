@@ -30,39 +30,42 @@ namespace ngs
 {
 
     ReadGroup & ReadGroup :: operator = ( ReadGroupRef ref )
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         self = ref;
 
         return * this;
     }
         
     ReadGroup :: ReadGroup ( ReadGroupRef ref )
-            throw ()
+            NGS_NOTHROW
         : self ( ref )
     {
     }
 
     ReadGroup & ReadGroup :: operator = ( const ReadGroup & obj )
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         self = obj . self -> Duplicate ();
 
         return * this;
     }
         
     ReadGroup :: ReadGroup ( const ReadGroup & obj )
-            throw ()
+            NGS_NOTHROW
         : self ( obj . self -> Duplicate () )
     {
     }
 
     ReadGroup :: ~ ReadGroup ()
-        throw ()
+        NGS_NOTHROW
     {
-        self -> Release ();
+        if ( self != 0 )
+            self -> Release ();
         self = 0;
     }
 
@@ -30,33 +30,35 @@ namespace ngs
 {
 
     Reference :: Reference ( ReferenceRef ref )
-            throw ()
+            NGS_NOTHROW
         : self ( ref )
     {
         assert ( ref != 0 );
     }
 
     Reference & Reference :: operator = ( const Reference & obj )
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         assert ( obj . self != 0 );
         ReferenceRef new_ref = obj . self -> Duplicate ();
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = new_ref;
         return * this;
     }
 
     Reference :: Reference ( const Reference & obj )
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
         : self ( obj . self == 0 ? 0 : obj . self -> Duplicate() )
     {
         assert ( obj . self != 0 );
     }
     
     Reference :: ~ Reference ()
-        throw ()
+        NGS_NOTHROW
     {
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = 0;
     }
 
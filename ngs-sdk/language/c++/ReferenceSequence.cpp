@@ -30,43 +30,46 @@ namespace ngs
 {
 
     ReferenceSequence :: ReferenceSequence ( ReferenceSequenceRef ref )
-            throw ()
+            NGS_NOTHROW
         : self ( ref )
     {
         assert ( ref != 0 );
     }
 
     ReferenceSequence & ReferenceSequence :: operator = ( ReferenceSequenceRef ref )
-            throw ()
+            NGS_NOTHROW
     {
         assert ( ref != 0 );
         ReferenceSequenceRef new_ref = ref -> Duplicate ();
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = new_ref;
         return * this;
     }
 
     ReferenceSequence & ReferenceSequence :: operator = ( const ReferenceSequence & obj )
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         assert ( obj . self != 0 );
         ReferenceSequenceRef new_ref = obj . self -> Duplicate ();
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = new_ref;
         return * this;
     }
 
     ReferenceSequence :: ReferenceSequence ( const ReferenceSequence & obj )
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
         : self ( obj . self == 0 ? 0 : obj . self -> Duplicate() )
     {
         assert ( obj . self != 0 );
     }
     
     ReferenceSequence :: ~ ReferenceSequence ()
-        throw ()
+        NGS_NOTHROW
     {
-        this -> self -> Release ();
+        if ( this -> self != 0 )
+            this -> self -> Release ();
         this -> self = 0;
     }
 
@@ -0,0 +1,84 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/StringView.hpp>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * StringView
+     */
+
+    String StringView :: toString () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        return String ( str, sz );
+    }
+
+    String StringView :: toString ( size_t offset ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( offset > sz )
+            offset = sz;
+
+        return String ( str + offset, sz - offset );
+    }
+
+    String StringView :: toString ( size_t offset, size_t size ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( offset >= sz )
+        {
+            offset = sz;
+            size = 0;
+        }
+        else if ( offset + size > sz )
+        {
+            size = sz - offset;
+        }
+
+        return String ( str + offset, size );
+    }
+
+    StringView & StringView :: operator = ( const StringView & obj )
+        NGS_NOTHROW
+    {
+        StringItf * new_ref = obj . ref != 0 ? obj . ref -> Duplicate () : 0;
+        if ( ref != 0 )
+            ref -> Release ();
+        str = obj . str;
+        sz = obj . sz;
+        ref = new_ref;
+
+        return * this;
+    }
+
+    :: std :: ostream & operator << ( :: std :: ostream & s, const StringView & str )
+    {
+        return s . write ( str . data (), str . size () );
+    }
+
+} // namespace ngs
@@ -0,0 +1,181 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_threads_
+#define _hpp_ngs_threads_
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * Mutex, Condition, Thread
+     *  the little of the platform's threads that the language
+     *  binding uses for its background work
+     */
+    class Mutex
+    {
+    public:
+
+#if defined _WIN32
+        Mutex () { InitializeCriticalSection ( & m ); }
+        ~ Mutex () { DeleteCriticalSection ( & m ); }
+        void Lock () { EnterCriticalSection ( & m ); }
+        void Unlock () { LeaveCriticalSection ( & m ); }
+#else
+        Mutex () { pthread_mutex_init ( & m, 0 ); }
+        ~ Mutex () { pthread_mutex_destroy ( & m ); }
+        void Lock () { pthread_mutex_lock ( & m ); }
+        void Unlock () { pthread_mutex_unlock ( & m ); }
+#endif
+
+    private:
+
+        friend class Condition;
+
+        Mutex ( const Mutex & obj );
+        Mutex & operator = ( const Mutex & obj );
+
+#if defined _WIN32
+        CRITICAL_SECTION m;
+#else
+        pthread_mutex_t m;
+#endif
+    };
+
+    class Condition
+    {
+    public:
+
+#if defined _WIN32
+        Condition () { InitializeConditionVariable ( & c ); }
+        ~ Condition () {}
+        void Wait ( Mutex & mutex ) { SleepConditionVariableCS ( & c, & mutex . m, INFINITE ); }
+        void WakeOne () { WakeConditionVariable ( & c ); }
+        void WakeAll () { WakeAllConditionVariable ( & c ); }
+#else
+        Condition () { pthread_cond_init ( & c, 0 ); }
+        ~ Condition () { pthread_cond_destroy ( & c ); }
+        void Wait ( Mutex & mutex ) { pthread_cond_wait ( & c, & mutex . m ); }
+        void WakeOne () { pthread_cond_signal ( & c ); }
+        void WakeAll () { pthread_cond_broadcast ( & c ); }
+#endif
+
+    private:
+
+        Condition ( const Condition & obj );
+        Condition & operator = ( const Condition & obj );
+
+#if defined _WIN32
+        CONDITION_VARIABLE c;
+#else
+        pthread_cond_t c;
+#endif
+    };
+
+    class Thread
+    {
+    public:
+
+        typedef void ( * Main ) ( void * arg );
+
+        Thread ()
+            : main ( 0 )
+            , arg ( 0 )
+            , started ( false )
+        {
+        }
+
+        /* Start
+         *  runs "Main" ( "Arg" ) on a new thread
+         *  returns false if the thread could not be made
+         */
+        bool Start ( Main Main, void * Arg )
+        {
+            main = Main;
+            arg = Arg;
+#if defined _WIN32
+            handle = CreateThread ( 0, 0, Run, this, 0, 0 );
+            started = handle != 0;
+#else
+            started = pthread_create ( & handle, 0, Run, this ) == 0;
+#endif
+            return started;
+        }
+
+        /* Join
+         *  waits for a started thread to return
+         */
+        void Join ()
+        {
+            if ( started )
+            {
+#if defined _WIN32
+                WaitForSingleObject ( handle, INFINITE );
+                CloseHandle ( handle );
+#else
+                pthread_join ( handle, 0 );
+#endif
+                started = false;
+            }
+        }
+
+    private:
+
+        Thread ( const Thread & obj );
+        Thread & operator = ( const Thread & obj );
+
+#if defined _WIN32
+        static DWORD WINAPI Run ( LPVOID self )
+        {
+            Thread * t = static_cast < Thread * > ( self );
+            t -> main ( t -> arg );
+            return 0;
+        }
+
+        HANDLE handle;
+#else
+        static void * Run ( void * self )
+        {
+            Thread * t = static_cast < Thread * > ( self );
+            t -> main ( t -> arg );
+            return 0;
+        }
+
+        pthread_t handle;
+#endif
+        Main main;
+        void * arg;
+        bool started;
+    };
+
+} // namespace ngs
+
+#endif // _hpp_ngs_threads_
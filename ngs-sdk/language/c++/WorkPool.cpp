@@ -0,0 +1,437 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include <ngs/WorkPool.hpp>
+
+#include "Threads.hpp"
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if ! defined _WIN32
+#include <unistd.h>
+#endif
+#if defined __linux__
+#include <sched.h>
+#endif
+
+#if defined _MSC_VER
+#define NGS_THREAD_LOCAL __declspec ( thread )
+#else
+#define NGS_THREAD_LOCAL __thread
+#endif
+
+namespace ngs
+{
+    namespace
+    {
+        /* Queue
+         *  items waiting, each behind its own lock
+         */
+        struct Queue
+        {
+            Mutex lock;
+            std :: deque < WorkItem * > items;
+        };
+
+        struct Worker
+        {
+            WorkPoolState * pool;
+            uint32_t self;
+        };
+
+        /* the worker the calling thread is, if it is one */
+        NGS_THREAD_LOCAL Worker * current;
+    }
+
+    /* WorkPoolState
+     *  the queues and the threads serving them
+     *  "queued" counts the items in all of them, under "sleep", so that
+     *  a thread that found nothing sleeps only while there is nothing;
+     *  it is changed after an item is queued or taken, and so may be
+     *  briefly below zero
+     */
+    class WorkPoolState
+    {
+    public:
+
+        WorkPoolState ( uint32_t count )
+            : threads ( new Thread [ count ] )
+            , workers ( count )
+            , started ( 0 )
+            , queued ( 0 )
+            , idle ( 0 )
+            , stop ( false )
+        {
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                locals . push_back ( new Queue );
+                workers [ i ] . pool = this;
+                workers [ i ] . self = i;
+            }
+            // a thread that didn't start leaves its queue empty
+            for ( uint32_t i = 0; i < count; ++ i )
+            {
+                if ( threads [ i ] . Start ( Run, & workers [ i ] ) )
+                    ++ started;
+            }
+        }
+
+        ~ WorkPoolState ()
+        {
+            sleep . Lock ();
+            stop = true;
+            wake . WakeAll ();
+            sleep . Unlock ();
+
+            for ( size_t i = 0; i < locals . size (); ++ i )
+                threads [ i ] . Join ();
+            delete [] threads;
+            for ( size_t i = 0; i < locals . size (); ++ i )
+                delete locals [ i ];
+        }
+
+        static void Run ( void * arg )
+        {
+            Worker * w = static_cast < Worker * > ( arg );
+            w -> pool -> Serve ( * w );
+        }
+
+        void Serve ( Worker & self )
+            NGS_NOTHROW
+        {
+            current = & self;
+            for ( ; ; )
+            {
+                WorkItem * item = Take ( self . self );
+                if ( item != 0 )
+                {
+                    try
+                    {
+                        item -> run ();
+                    }
+                    catch ( ... )
+                    {
+                    }
+                    continue;
+                }
+
+                sleep . Lock ();
+                while ( queued <= 0 && ! stop )
+                {
+                    ++ idle;
+                    wake . Wait ( sleep );
+                    -- idle;
+                }
+                bool const stopping = stop;
+                sleep . Unlock ();
+                if ( stopping )
+                    break;
+            }
+            current = 0;
+        }
+
+        void Submit ( WorkItem & item, WorkPool :: Priority priority )
+            NGS_THROWS ( ErrorMsg )
+        {
+            Queue & q = current != 0 && current -> pool == this
+                ? * locals [ current -> self ]
+                : injected [ priority ];
+
+            q . lock . Lock ();
+            try
+            {
+                q . items . push_back ( & item );
+            }
+            catch ( ... )
+            {
+                q . lock . Unlock ();
+                throw ErrorMsg ( "failed to queue work" );
+            }
+            q . lock . Unlock ();
+
+            sleep . Lock ();
+            ++ queued;
+            if ( idle > 0 )
+                wake . WakeOne ();
+            sleep . Unlock ();
+        }
+
+        bool Cancel ( WorkItem & item )
+            NGS_NOTHROW
+        {
+            bool found = false;
+            for ( int p = WorkPool :: low; ! found && p <= WorkPool :: high; ++ p )
+                found = Remove ( injected [ p ], item );
+            for ( size_t i = 0; ! found && i < locals . size (); ++ i )
+                found = Remove ( * locals [ i ], item );
+            if ( found )
+                Taken ();
+            return found;
+        }
+
+        Thread * threads;
+        std :: vector < Worker > workers;
+        std :: vector < Queue * > locals;
+        Queue injected [ WorkPool :: high + 1 ];
+        uint32_t started;
+
+        Mutex sleep;                // guards all below
+        Condition wake;             // something was queued, or stop
+        long queued;
+        uint32_t idle;              // threads waiting on "wake"
+        bool stop;
+
+    private:
+
+        /* Take
+         *  high priority items, then the thread's own newest,
+         *  then normal and low ones, then the oldest of another's
+         */
+        WorkItem * Take ( uint32_t self )
+        {
+            WorkItem * item = PopFront ( injected [ WorkPool :: high ] );
+            if ( item == 0 )
+                item = PopBack ( * locals [ self ] );
+            if ( item == 0 )
+                item = PopFront ( injected [ WorkPool :: normal ] );
+            if ( item == 0 )
+                item = PopFront ( injected [ WorkPool :: low ] );
+            for ( uint32_t k = 1; item == 0 && k < locals . size (); ++ k )
+                item = PopFront ( * locals [ ( self + k ) % locals . size () ] );
+            if ( item != 0 )
+                Taken ();
+            return item;
+        }
+
+        void Taken ()
+        {
+            sleep . Lock ();
+            -- queued;
+            sleep . Unlock ();
+        }
+
+        static WorkItem * PopFront ( Queue & q )
+        {
+            WorkItem * item = 0;
+            q . lock . Lock ();
+            if ( ! q . items . empty () )
+            {
+                item = q . items . front ();
+                q . items . pop_front ();
+            }
+            q . lock . Unlock ();
+            return item;
+        }
+
+        static WorkItem * PopBack ( Queue & q )
+        {
+            WorkItem * item = 0;
+            q . lock . Lock ();
+            if ( ! q . items . empty () )
+            {
+                item = q . items . back ();
+                q . items . pop_back ();
+            }
+            q . lock . Unlock ();
+            return item;
+        }
+
+        static bool Remove ( Queue & q, WorkItem & item )
+        {
+            q . lock . Lock ();
+            std :: deque < WorkItem * > :: iterator i = std :: find ( q . items . begin (), q . items . end (), & item );
+            bool const found = i != q . items . end ();
+            if ( found )
+                q . items . erase ( i );
+            q . lock . Unlock ();
+            return found;
+        }
+    };
+
+    namespace
+    {
+        Mutex sharedLock;           // guards the two below
+        WorkPool * sharedPool;
+        uint32_t sharedThreads;     // what configure asked for
+
+#if defined __linux__
+        /* CgroupCPUs
+         *  the CPU quota of the process' cgroup, rounded up, as a
+         *  container sees it at /sys/fs/cgroup; 0 if it has none
+         */
+        uint32_t CgroupCPUs ()
+        {
+            long long quota = -1;
+            long long period = 0;
+
+            // cgroup v2: "<quota> <period>" or "max <period>"
+            FILE * f = fopen ( "/sys/fs/cgroup/cpu.max", "r" );
+            if ( f != 0 )
+            {
+                char text [ 32 ];
+                if ( fscanf ( f, "%31s %lld", text, & period ) == 2 && strcmp ( text, "max" ) != 0 )
+                    quota = atoll ( text );
+                fclose ( f );
+            }
+            else
+            {
+                f = fopen ( "/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r" );
+                if ( f != 0 )
+                {
+                    if ( fscanf ( f, "%lld", & quota ) != 1 )
+                        quota = -1;
+                    fclose ( f );
+                }
+                f = fopen ( "/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r" );
+                if ( f != 0 )
+                {
+                    if ( fscanf ( f, "%lld", & period ) != 1 )
+                        period = 0;
+                    fclose ( f );
+                }
+            }
+            if ( quota <= 0 || period <= 0 )
+                return 0;
+            return ( uint32_t ) ( ( quota + period - 1 ) / period );
+        }
+#endif
+
+        uint32_t OnlineCPUs ()
+        {
+#if defined _WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo ( & info );
+            return ( uint32_t ) info . dwNumberOfProcessors;
+#else
+#if defined __linux__ && defined CPU_COUNT
+            cpu_set_t set;
+            if ( sched_getaffinity ( 0, sizeof set, & set ) == 0 )
+                return ( uint32_t ) CPU_COUNT ( & set );
+#endif
+            long const n = sysconf ( _SC_NPROCESSORS_ONLN );
+            return n > 0 ? ( uint32_t ) n : 1;
+#endif
+        }
+    }
+
+    uint32_t WorkPool :: defaultThreads ()
+        NGS_NOTHROW
+    {
+        const char * env = getenv ( "NGS_POOL_THREADS" );
+        if ( env != 0 && atoi ( env ) > 0 )
+            return ( uint32_t ) atoi ( env );
+
+        uint32_t cpus = OnlineCPUs ();
+#if defined __linux__
+        uint32_t const quota = CgroupCPUs ();
+        if ( quota != 0 && quota < cpus )
+            cpus = quota;
+#endif
+        return cpus == 0 ? 1 : cpus;
+    }
+
+    bool WorkPool :: configure ( uint32_t threads )
+        NGS_NOTHROW
+    {
+        sharedLock . Lock ();
+        bool const before = sharedPool == 0;
+        if ( before )
+            sharedThreads = threads;
+        sharedLock . Unlock ();
+        return before;
+    }
+
+    WorkPool & WorkPool :: shared ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        sharedLock . Lock ();
+        try
+        {
+            if ( sharedPool == 0 )
+                sharedPool = new WorkPool ( sharedThreads != 0 ? sharedThreads : defaultThreads () );
+        }
+        catch ( ... )
+        {
+            sharedLock . Unlock ();
+            throw;
+        }
+        WorkPool & pool = * sharedPool;
+        sharedLock . Unlock ();
+        return pool;
+    }
+
+    void WorkPool :: submit ( WorkItem & item, Priority priority )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( priority < low || priority > high )
+            throw ErrorMsg ( "invalid work priority" );
+        state -> Submit ( item, priority );
+    }
+
+    bool WorkPool :: cancel ( WorkItem & item )
+        NGS_NOTHROW
+    {
+        return state -> Cancel ( item );
+    }
+
+    uint32_t WorkPool :: threads () const
+        NGS_NOTHROW
+    {
+        return state -> started;
+    }
+
+    WorkPool :: WorkPool ( uint32_t threads )
+        NGS_THROWS ( ErrorMsg )
+        : state ( 0 )
+    {
+        try
+        {
+            state = new WorkPoolState ( threads == 0 ? 1 : threads );
+        }
+        catch ( ... )
+        {
+            throw ErrorMsg ( "failed to make work pool" );
+        }
+        if ( state -> started == 0 )
+        {
+            delete state;
+            throw ErrorMsg ( "failed to start work pool threads" );
+        }
+    }
+
+    WorkPool :: ~ WorkPool ()
+        NGS_NOTHROW
+    {
+        delete state;
+    }
+
+} // namespace ngs
@@ -27,10 +27,14 @@
 #include "jni_AlignmentIteratorItf.h"
 #include "jni_ErrorMsg.hpp"
 #include "jni_String.hpp"
+#include "jni_Cache.hpp"
 
 #include <ngs/itf/FragmentItf.hpp>
 #include <ngs/itf/AlignmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
+#include <ngs/itf/AlignmentItf.h>
+
+#include <vector>
 
 using namespace ngs;
 
@@ -70,3 +74,162 @@ JNIEXPORT jboolean JNICALL Java_ngs_itf_AlignmentIteratorItf_NextAlignment
 
     return false;
 }
+
+/*----------------------------------------------------------------------
+ * AlignmentBatch
+ *  the Java batch holds its columns in primitive arrays; they are
+ *  filled from native columns of the same layout with one region
+ *  copy apiece, so a batch costs a single JNI transition
+ */
+
+// the ( offset, size ) pairs of a string column are copied as jint pairs
+typedef char BatchStringLayoutCheck [ sizeof ( NGS_AlignmentBatchString_v1 ) == 2 * sizeof ( jint ) ? 1 : -1 ];
+
+template < class T >
+class BatchColumn
+{
+public:
+
+    T * Make ( jarray jcol, jint count )
+    {
+        if ( jcol == 0 || count == 0 )
+            return 0;
+        col . resize ( count );
+        return & col [ 0 ];
+    }
+
+private:
+
+    std :: vector < T > col;
+};
+
+/* BatchFieldID
+ *  the cached ID of a field of AlignmentBatch, or else looked up in "jcls"
+ */
+static
+jfieldID BatchFieldID ( JNIEnv * jenv, jclass jcls, jfieldID cached, const char * name, const char * sig )
+{
+    if ( cached != 0 )
+        return cached;
+
+    jfieldID fid = jenv -> GetFieldID ( jcls, name, sig );
+    if ( fid == 0 )
+        throw ErrorMsg ( "alignment batch field is missing" );
+    return fid;
+}
+
+static
+jobject BatchField ( JNIEnv * jenv, jobject jbatch, jclass jcls, jfieldID cached, const char * name, const char * sig )
+{
+    return jenv -> GetObjectField ( jbatch, BatchFieldID ( jenv, jcls, cached, name, sig ) );
+}
+
+/*
+ * Class:     ngs_itf_AlignmentIteratorItf
+ * Method:    NextAlignmentBatch
+ * Signature: (JILngs/AlignmentBatch;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_ngs_itf_AlignmentIteratorItf_NextAlignmentBatch
+  ( JNIEnv * jenv, jobject jthis, jlong jself, jint max, jobject jbatch )
+{
+    try
+    {
+        if ( jbatch == 0 )
+            throw ErrorMsg ( "NULL batch parameter" );
+        if ( max <= 0 )
+            throw ErrorMsg ( "alignment batch maximum is not positive" );
+
+        // with the cache, the class is never needed
+        static const JNICache none = JNICache ();
+        const JNICache * jcache = JNICacheGet ( jenv );
+        const JNICache & ids = jcache != 0 ? * jcache : none;
+        jclass jcls = jcache != 0 ? 0 : jenv -> GetObjectClass ( jbatch );
+        jfieldID count_fid = BatchFieldID ( jenv, jcls, ids . batch . count, "count", "I" );
+        jfieldID state_fid = BatchFieldID ( jenv, jcls, ids . batch . state, "state", "I" );
+
+        jlongArray jposition = ( jlongArray ) BatchField ( jenv, jbatch, jcls, ids . batch . position, "position", "[J" );
+        jlongArray jlength = ( jlongArray ) BatchField ( jenv, jbatch, jcls, ids . batch . length, "length", "[J" );
+        jintArray jmap_qual = ( jintArray ) BatchField ( jenv, jbatch, jcls, ids . batch . map_qual, "mapQual", "[I" );
+        jintArray jflags = ( jintArray ) BatchField ( jenv, jbatch, jcls, ids . batch . flags, "flags", "[I" );
+        jintArray jref_spec = ( jintArray ) BatchField ( jenv, jbatch, jcls, ids . batch . ref_spec, "refSpec", "[I" );
+        jintArray jread_id = ( jintArray ) BatchField ( jenv, jbatch, jcls, ids . batch . read_id, "readIds", "[I" );
+        jintArray jbases = ( jintArray ) BatchField ( jenv, jbatch, jcls, ids . batch . bases, "bases", "[I" );
+        jintArray jqualities = ( jintArray ) BatchField ( jenv, jbatch, jcls, ids . batch . qualities, "qualities", "[I" );
+        jbyteArray jarena = ( jbyteArray ) BatchField ( jenv, jbatch, jcls, ids . batch . arena, "arena", "[B" );
+        if ( jarena == 0 )
+            throw ErrorMsg ( "alignment batch has no arena" );
+
+        BatchColumn < int64_t > position;
+        BatchColumn < uint64_t > length;
+        BatchColumn < int32_t > map_qual;
+        BatchColumn < uint32_t > flags;
+        BatchColumn < NGS_AlignmentBatchString_v1 > ref_spec, read_id, bases, qualities;
+        BatchColumn < char > arena;
+
+        NGS_AlignmentBatch_v1 batch;
+        batch . fields
+            = ( jposition != 0 ? NGS_AlignmentBatchFields_position : 0 )
+            | ( jmap_qual != 0 ? NGS_AlignmentBatchFields_map_qual : 0 )
+            | ( jflags != 0 ? NGS_AlignmentBatchFields_flags : 0 )
+            | ( jref_spec != 0 ? NGS_AlignmentBatchFields_ref_spec : 0 )
+            | ( jread_id != 0 ? NGS_AlignmentBatchFields_read_id : 0 )
+            | ( jbases != 0 ? NGS_AlignmentBatchFields_bases : 0 )
+            | ( jqualities != 0 ? NGS_AlignmentBatchFields_qualities : 0 );
+        batch . capacity = max;
+        batch . position = position . Make ( jposition, max );
+        batch . length = length . Make ( jlength, max );
+        batch . map_qual = map_qual . Make ( jmap_qual, max );
+        batch . flags = flags . Make ( jflags, max );
+        batch . ref_spec = ref_spec . Make ( jref_spec, max );
+        batch . read_id = read_id . Make ( jread_id, max );
+        batch . bases = bases . Make ( jbases, max );
+        batch . qualities = qualities . Make ( jqualities, max );
+        batch . arena_size = jenv -> GetArrayLength ( jarena );
+        batch . arena = arena . Make ( jarena, batch . arena_size );
+        batch . count = 0;
+        batch . arena_used = 0;
+        batch . state = jenv -> GetIntField ( jbatch, state_fid );
+
+        bool ret = Self ( (size_t) jself ) -> nextAlignmentBatch ( batch );
+
+        jsize n = batch . count;
+        if ( batch . position != 0 )
+        {
+            jenv -> SetLongArrayRegion ( jposition, 0, n, ( const jlong * ) batch . position );
+            jenv -> SetLongArrayRegion ( jlength, 0, n, ( const jlong * ) batch . length );
+        }
+        if ( batch . map_qual != 0 )
+            jenv -> SetIntArrayRegion ( jmap_qual, 0, n, ( const jint * ) batch . map_qual );
+        if ( batch . flags != 0 )
+            jenv -> SetIntArrayRegion ( jflags, 0, n, ( const jint * ) batch . flags );
+        if ( batch . ref_spec != 0 )
+            jenv -> SetIntArrayRegion ( jref_spec, 0, n * 2, ( const jint * ) batch . ref_spec );
+        if ( batch . read_id != 0 )
+            jenv -> SetIntArrayRegion ( jread_id, 0, n * 2, ( const jint * ) batch . read_id );
+        if ( batch . bases != 0 )
+            jenv -> SetIntArrayRegion ( jbases, 0, n * 2, ( const jint * ) batch . bases );
+        if ( batch . qualities != 0 )
+            jenv -> SetIntArrayRegion ( jqualities, 0, n * 2, ( const jint * ) batch . qualities );
+        if ( batch . arena_used != 0 )
+            jenv -> SetByteArrayRegion ( jarena, 0, batch . arena_used, ( const jbyte * ) batch . arena );
+
+        jenv -> SetIntField ( jbatch, count_fid, n );
+        jenv -> SetIntField ( jbatch, state_fid, batch . state );
+
+        return ( jboolean ) ret;
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return false;
+}
@@ -15,6 +15,14 @@ extern "C" {
 JNIEXPORT jboolean JNICALL Java_ngs_itf_AlignmentIteratorItf_NextAlignment
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     ngs_itf_AlignmentIteratorItf
+ * Method:    NextAlignmentBatch
+ * Signature: (JILngs/AlignmentBatch;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_ngs_itf_AlignmentIteratorItf_NextAlignmentBatch
+  (JNIEnv *, jobject, jlong, jint, jobject);
+
 #ifdef __cplusplus
 }
 #endif
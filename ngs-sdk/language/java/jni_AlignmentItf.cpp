@@ -31,6 +31,7 @@
 #include <ngs/itf/FragmentItf.hpp>
 #include <ngs/itf/AlignmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
+#include <ngs/itf/StringItf.h>
 
 using namespace ngs;
 
@@ -134,6 +135,130 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_AlignmentItf_GetFragmentQualities
     return 0;
 }
 
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentBasesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentBasesView ( offset, length, view );
+        return StringViewCopyToByteBuffer ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentBasesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentBasesView ( offset, length, view );
+        return StringViewCopyToByteArray ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentQualitiesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentQualitiesView ( offset, length, view );
+        return StringViewCopyToByteBuffer ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentQualitiesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentQualitiesView ( offset, length, view );
+        return StringViewCopyToByteArray ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
 /*
  * Class:     ngs_itf_AlignmentItf
  * Method:    IsPaired
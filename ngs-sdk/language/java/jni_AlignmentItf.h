@@ -31,6 +31,38 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_AlignmentItf_GetFragmentBases
 JNIEXPORT jstring JNICALL Java_ngs_itf_AlignmentItf_GetFragmentQualities
   (JNIEnv *, jobject, jlong, jlong, jlong);
 
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentBasesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentBasesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentQualitiesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_AlignmentItf
+ * Method:    GetFragmentQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_AlignmentItf_GetFragmentQualitiesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     ngs_itf_AlignmentItf
  * Method:    IsPaired
@@ -0,0 +1,159 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#include "jni_Cache.hpp"
+
+#include <atomic32.h>
+
+
+/*--------------------------------------------------------------------------
+ * JNICache
+ */
+
+enum { cache_empty, cache_filling, cache_ready, cache_failed };
+
+static JNICache cache;
+static atomic32_t cache_state;
+
+
+/* GlobalClass
+ *  a global reference to a class, or NULL with no exception pending
+ */
+static
+jclass GlobalClass ( JNIEnv * jenv, const char * name )
+{
+    jclass jcls = jenv -> FindClass ( name );
+    if ( jcls == 0 )
+    {
+        jenv -> ExceptionClear ();
+        return 0;
+    }
+
+    jclass jglobal = ( jclass ) jenv -> NewGlobalRef ( jcls );
+    jenv -> DeleteLocalRef ( jcls );
+    return jglobal;
+}
+
+/* Field
+ *  the ID of a field, or NULL with no exception pending
+ */
+static
+jfieldID Field ( JNIEnv * jenv, jclass jcls, const char * name, const char * sig )
+{
+    jfieldID fid = jenv -> GetFieldID ( jcls, name, sig );
+    if ( fid == 0 )
+        jenv -> ExceptionClear ();
+    return fid;
+}
+
+/* Fill
+ *  look everything up, returning false if anything is missing
+ */
+static
+bool Fill ( JNIEnv * jenv )
+{
+    cache . error_msg = GlobalClass ( jenv, "ngs/ErrorMsg" );
+    cache . runtime_exception = GlobalClass ( jenv, "java/lang/RuntimeException" );
+    if ( cache . error_msg == 0 || cache . runtime_exception == 0 )
+        return false;
+
+    jclass jbatch = jenv -> FindClass ( "ngs/AlignmentBatch" );
+    if ( jbatch == 0 )
+    {
+        jenv -> ExceptionClear ();
+        return false;
+    }
+
+    cache . batch . count = Field ( jenv, jbatch, "count", "I" );
+    cache . batch . state = Field ( jenv, jbatch, "state", "I" );
+    cache . batch . position = Field ( jenv, jbatch, "position", "[J" );
+    cache . batch . length = Field ( jenv, jbatch, "length", "[J" );
+    cache . batch . map_qual = Field ( jenv, jbatch, "mapQual", "[I" );
+    cache . batch . flags = Field ( jenv, jbatch, "flags", "[I" );
+    cache . batch . ref_spec = Field ( jenv, jbatch, "refSpec", "[I" );
+    cache . batch . read_id = Field ( jenv, jbatch, "readIds", "[I" );
+    cache . batch . bases = Field ( jenv, jbatch, "bases", "[I" );
+    cache . batch . qualities = Field ( jenv, jbatch, "qualities", "[I" );
+    cache . batch . arena = Field ( jenv, jbatch, "arena", "[B" );
+    jenv -> DeleteLocalRef ( jbatch );
+
+    if ( cache . batch . count == 0 || cache . batch . state == 0 ||
+         cache . batch . position == 0 || cache . batch . length == 0 ||
+         cache . batch . map_qual == 0 || cache . batch . flags == 0 ||
+         cache . batch . ref_spec == 0 || cache . batch . read_id == 0 ||
+         cache . batch . bases == 0 || cache . batch . qualities == 0 ||
+         cache . batch . arena == 0 )
+        return false;
+
+    jclass jcolumns = jenv -> FindClass ( "ngs/PileupColumns" );
+    if ( jcolumns == 0 )
+    {
+        jenv -> ExceptionClear ();
+        return false;
+    }
+
+    cache . columns . count = Field ( jenv, jcolumns, "count", "I" );
+    cache . columns . state = Field ( jenv, jcolumns, "state", "I" );
+    cache . columns . capacity = Field ( jenv, jcolumns, "capacity", "I" );
+    cache . columns . position = Field ( jenv, jcolumns, "position", "[J" );
+    cache . columns . ref_base = Field ( jenv, jcolumns, "refBase", "[B" );
+    cache . columns . start = Field ( jenv, jcolumns, "start", "[I" );
+    cache . columns . event_type = Field ( jenv, jcolumns, "type", "[I" );
+    cache . columns . base = Field ( jenv, jcolumns, "base", "[B" );
+    cache . columns . qual = Field ( jenv, jcolumns, "qual", "[B" );
+    cache . columns . map_qual = Field ( jenv, jcolumns, "mapQual", "[I" );
+    jenv -> DeleteLocalRef ( jcolumns );
+
+    return cache . columns . count != 0 && cache . columns . state != 0 &&
+        cache . columns . capacity != 0 && cache . columns . position != 0 &&
+        cache . columns . ref_base != 0 && cache . columns . start != 0 &&
+        cache . columns . event_type != 0 && cache . columns . base != 0 &&
+        cache . columns . qual != 0 && cache . columns . map_qual != 0;
+}
+
+/* Get
+ *  the first caller to find it empty fills it; the state is only
+ *  changed and read with a barrier, so the cache is seen filled
+ */
+const JNICache * JNICacheGet ( JNIEnv * jenv )
+{
+    int state = atomic32_test_and_set ( & cache_state, cache_filling, cache_empty );
+    if ( state == cache_ready )
+        return & cache;
+    if ( state != cache_empty )
+        return 0;
+
+    // an exception already pending would make the lookups fail
+    if ( jenv -> ExceptionCheck () )
+    {
+        atomic32_test_and_set ( & cache_state, cache_empty, cache_filling );
+        return 0;
+    }
+
+    bool filled = Fill ( jenv );
+    atomic32_test_and_set ( & cache_state, filled ? cache_ready : cache_failed, cache_filling );
+    return filled ? & cache : 0;
+}
@@ -0,0 +1,89 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_jni_Cache_
+#define _hpp_jni_Cache_
+
+#include "jni.h"
+
+
+/*--------------------------------------------------------------------------
+ * JNICache
+ *  global references to the classes, and the IDs, that the binding
+ *  needs on its busy paths, looked up once per process rather than on
+ *  every call
+ *
+ *  the binding is linked into the engine's JNI library, which has the
+ *  JNI_OnLoad, so the cache is filled by its first user instead
+ */
+struct JNICache
+{
+    jclass error_msg;               // ngs/ErrorMsg
+    jclass runtime_exception;       // java/lang/RuntimeException
+
+    // the fields of ngs/AlignmentBatch
+    struct
+    {
+        jfieldID count;
+        jfieldID state;
+        jfieldID position;
+        jfieldID length;
+        jfieldID map_qual;
+        jfieldID flags;
+        jfieldID ref_spec;
+        jfieldID read_id;
+        jfieldID bases;
+        jfieldID qualities;
+        jfieldID arena;
+    } batch;
+
+    // the fields of ngs/PileupColumns
+    struct
+    {
+        jfieldID count;
+        jfieldID state;
+        jfieldID capacity;
+        jfieldID position;
+        jfieldID ref_base;
+        jfieldID start;
+        jfieldID event_type;
+        jfieldID base;
+        jfieldID qual;
+        jfieldID map_qual;
+    } columns;
+};
+
+
+/* Get
+ *  the cache, filling it on first use
+ *  returns NULL while another thread is filling it, or if one of its
+ *  lookups failed; the caller then looks up what it needs itself
+ *  never leaves an exception pending
+ */
+const JNICache * JNICacheGet ( JNIEnv * jenv );
+
+
+#endif /* _hpp_jni_Cache_ */
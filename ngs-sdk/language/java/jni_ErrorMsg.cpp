@@ -25,6 +25,7 @@
 */
 
 #include "jni_ErrorMsg.hpp"
+#include "jni_Cache.hpp"
 
 #include <string.h>
 #include <stdio.h>
@@ -39,8 +40,21 @@
  */
 static
 void ErrorMsgThrow ( JNIEnv * jenv, jclass jexcept_cls, const char * fmt, va_list args )
-    throw ()
+    NGS_NOTHROW
 {
+    // a message with nothing to expand is thrown as it is
+    if ( strchr ( fmt, '%' ) == 0 )
+    {
+        jenv -> ThrowNew ( jexcept_cls, fmt );
+        return;
+    }
+    if ( fmt [ 0 ] == '%' && fmt [ 1 ] == 's' && fmt [ 2 ] == 0 )
+    {
+        const char * msg = va_arg ( args, const char * );
+        jenv -> ThrowNew ( jexcept_cls, msg != 0 ? msg : "(null)" );
+        return;
+    }
+
     // expand message into buffer
     char msg [ 4096 ];
     int size = vsnprintf ( msg, sizeof msg, fmt, args );
@@ -58,19 +72,20 @@ void ErrorMsgThrow ( JNIEnv * jenv, jclass jexcept_cls, const char * fmt, va_lis
  */
 static
 void ErrorMsgThrow ( JNIEnv * jenv, uint32_t type, const char * fmt, va_list args )
-    throw ()
+    NGS_NOTHROW
 {
     jclass jexcept_cls = 0;
+    const JNICache * jcache = JNICacheGet ( jenv );
 
     switch ( type )
     {
     case xt_error_msg:
-        jexcept_cls = jenv -> FindClass ( "ngs/ErrorMsg" );
+        jexcept_cls = jcache != 0 ? jcache -> error_msg : jenv -> FindClass ( "ngs/ErrorMsg" );
         break;
     }
 
     if ( jexcept_cls == 0 )
-        jexcept_cls = jenv -> FindClass ( "java/lang/RuntimeException" );
+        jexcept_cls = jcache != 0 ? jcache -> runtime_exception : jenv -> FindClass ( "java/lang/RuntimeException" );
 
     ErrorMsgThrow ( jenv, jexcept_cls, fmt, args );
 }
@@ -81,7 +96,7 @@ void ErrorMsgThrow ( JNIEnv * jenv, uint32_t type, const char * fmt, va_list arg
  *  may temporarily take information from point of throw
  */
 void ErrorMsgThrow ( JNIEnv * jenv, uint32_t type, const char *fmt, ... )
-    throw ()
+    NGS_NOTHROW
 {
     va_list args;
     va_start ( args, fmt );
@@ -93,7 +108,7 @@ void ErrorMsgThrow ( JNIEnv * jenv, uint32_t type, const char *fmt, ... )
 
 
 void RuntimeExceptionThrow ( JNIEnv * jenv, const char *fmt, ... )
-    throw ()
+    NGS_NOTHROW
 {
     va_list args;
     va_start ( args, fmt );
@@ -107,7 +122,7 @@ void RuntimeExceptionThrow ( JNIEnv * jenv, const char *fmt, ... )
 /* INTERNAL_ERROR
  */
 void JNI_INTERNAL_ERROR ( JNIEnv * jenv, const char * fmt, ... )
-    throw ()
+    NGS_NOTHROW
 {
     va_list args;
     va_start ( args, fmt );
@@ -128,14 +143,14 @@ void JNI_INTERNAL_ERROR ( JNIEnv * jenv, const char * fmt, ... )
  * AssertU64
  */
 void ErrorMsgAssertU32 ( JNIEnv * jenv, jint i )
-    throw ()
+    NGS_NOTHROW
 {
     if ( i < 0 )
         ErrorMsgThrow ( jenv, xt_error_msg, "integer sign violation" );
 }
 
 void ErrorMsgAssertU64 ( JNIEnv * jenv, jlong i )
-    throw ()
+    NGS_NOTHROW
 {
     if ( i < 0 )
         ErrorMsgThrow ( jenv, xt_error_msg, "integer sign violation" );
@@ -30,6 +30,7 @@
 
 #include <ngs/itf/FragmentItf.hpp>
 #include <ngs/itf/StringItf.hpp>
+#include <ngs/itf/StringItf.h>
 
 using namespace ngs;
 
@@ -131,6 +132,130 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_FragmentItf_GetFragmentQualities
     return 0;
 }
 
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentBasesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentBasesView ( offset, length, view );
+        return StringViewCopyToByteBuffer ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentBasesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentBasesView ( offset, length, view );
+        return StringViewCopyToByteArray ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentQualitiesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentQualitiesView ( offset, length, view );
+        return StringViewCopyToByteBuffer ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentQualitiesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentQualitiesView ( offset, length, view );
+        return StringViewCopyToByteArray ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
 /*
  * Class:     ngs_itf_FragmentItf
  * Method:    IsPaired
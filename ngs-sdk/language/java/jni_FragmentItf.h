@@ -31,6 +31,38 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_FragmentItf_GetFragmentBases
 JNIEXPORT jstring JNICALL Java_ngs_itf_FragmentItf_GetFragmentQualities
   (JNIEnv *, jobject, jlong, jlong, jlong);
 
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentBasesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentBasesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentQualitiesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_FragmentItf
+ * Method:    GetFragmentQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_FragmentItf_GetFragmentQualitiesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     ngs_itf_FragmentItf
  * Method:    IsPaired
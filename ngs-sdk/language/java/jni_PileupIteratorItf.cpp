@@ -27,8 +27,12 @@
 #include "jni_PileupIteratorItf.h"
 #include "jni_ErrorMsg.hpp"
 #include "jni_String.hpp"
+#include "jni_Cache.hpp"
 
 #include <ngs/itf/PileupItf.hpp>
+#include <ngs/itf/PileupItf.h>
+
+#include <vector>
 
 using namespace ngs;
 
@@ -68,3 +72,238 @@ JNIEXPORT jboolean JNICALL Java_ngs_itf_PileupIteratorItf_NextPileup
 
     return false;
 }
+
+/*----------------------------------------------------------------------
+ * PileupColumns
+ *  the events of a run of positions are gathered into native columns
+ *  laid out like the Java arrays, one position after another, and
+ *  copied over with one region copy apiece
+ */
+
+typedef char ColumnsLayoutCheck [ sizeof ( jint ) == sizeof ( uint32_t ) && sizeof ( jbyte ) == sizeof ( char ) ? 1 : -1 ];
+
+template < class T >
+class EventColumn
+{
+public:
+
+    void Make ( jarray jcol, jint capacity )
+    {
+        if ( jcol != 0 )
+            col . resize ( capacity );
+    }
+
+    // the room left past the events already gathered
+    T * At ( uint32_t used )
+    {
+        return col . empty () ? 0 : & col [ 0 ] + used;
+    }
+
+    const T * Data () const
+    {
+        return col . empty () ? 0 : & col [ 0 ];
+    }
+
+private:
+
+    std :: vector < T > col;
+};
+
+/* ColumnsFieldID
+ *  the cached ID of a field of PileupColumns, or else looked up in "jcls"
+ */
+static
+jfieldID ColumnsFieldID ( JNIEnv * jenv, jclass jcls, jfieldID cached, const char * name, const char * sig )
+{
+    if ( cached != 0 )
+        return cached;
+
+    jfieldID fid = jenv -> GetFieldID ( jcls, name, sig );
+    if ( fid == 0 )
+        throw ErrorMsg ( "pileup columns field is missing" );
+    return fid;
+}
+
+static
+jintArray NewColumn ( JNIEnv * jenv, jintArray, jint capacity )
+{
+    return jenv -> NewIntArray ( capacity );
+}
+
+static
+jbyteArray NewColumn ( JNIEnv * jenv, jbyteArray, jint capacity )
+{
+    return jenv -> NewByteArray ( capacity );
+}
+
+/* Grow
+ *  replace an event array of the Java object with one of "capacity"
+ *  returns false, with an exception pending, if it could not be made
+ */
+template < class A >
+static
+bool Grow ( JNIEnv * jenv, jobject jcolumns, jfieldID fid, A & jcol, jint capacity )
+{
+    if ( jcol == 0 )
+        return true;
+
+    A jnew = NewColumn ( jenv, jcol, capacity );
+    if ( jnew == 0 )
+        return false;
+
+    jenv -> SetObjectField ( jcolumns, fid, jnew );
+    jcol = jnew;
+    return true;
+}
+
+/*
+ * Class:     ngs_itf_PileupIteratorItf
+ * Method:    NextPileupColumns
+ * Signature: (JILngs/PileupColumns;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_ngs_itf_PileupIteratorItf_NextPileupColumns
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jint max, jobject jcolumns )
+{
+    try
+    {
+        if ( jcolumns == 0 )
+            throw ErrorMsg ( "NULL columns parameter" );
+        if ( max <= 0 )
+            throw ErrorMsg ( "pileup columns maximum is not positive" );
+
+        // with the cache, the class is never needed
+        static const JNICache none = JNICache ();
+        const JNICache * jcache = JNICacheGet ( jenv );
+        const JNICache & ids = jcache != 0 ? * jcache : none;
+        jclass jcls = jcache != 0 ? 0 : jenv -> GetObjectClass ( jcolumns );
+        jfieldID count_fid = ColumnsFieldID ( jenv, jcls, ids . columns . count, "count", "I" );
+        jfieldID state_fid = ColumnsFieldID ( jenv, jcls, ids . columns . state, "state", "I" );
+        jfieldID capacity_fid = ColumnsFieldID ( jenv, jcls, ids . columns . capacity, "capacity", "I" );
+        jfieldID type_fid = ColumnsFieldID ( jenv, jcls, ids . columns . event_type, "type", "[I" );
+        jfieldID base_fid = ColumnsFieldID ( jenv, jcls, ids . columns . base, "base", "[B" );
+        jfieldID qual_fid = ColumnsFieldID ( jenv, jcls, ids . columns . qual, "qual", "[B" );
+        jfieldID map_qual_fid = ColumnsFieldID ( jenv, jcls, ids . columns . map_qual, "mapQual", "[I" );
+
+        jlongArray jposition = ( jlongArray ) jenv -> GetObjectField ( jcolumns,
+            ColumnsFieldID ( jenv, jcls, ids . columns . position, "position", "[J" ) );
+        jbyteArray jref_base = ( jbyteArray ) jenv -> GetObjectField ( jcolumns,
+            ColumnsFieldID ( jenv, jcls, ids . columns . ref_base, "refBase", "[B" ) );
+        jintArray jstart = ( jintArray ) jenv -> GetObjectField ( jcolumns,
+            ColumnsFieldID ( jenv, jcls, ids . columns . start, "start", "[I" ) );
+        jintArray jtype = ( jintArray ) jenv -> GetObjectField ( jcolumns, type_fid );
+        jbyteArray jbase = ( jbyteArray ) jenv -> GetObjectField ( jcolumns, base_fid );
+        jbyteArray jqual = ( jbyteArray ) jenv -> GetObjectField ( jcolumns, qual_fid );
+        jintArray jmap_qual = ( jintArray ) jenv -> GetObjectField ( jcolumns, map_qual_fid );
+        if ( jposition == 0 || jref_base == 0 || jstart == 0 )
+            throw ErrorMsg ( "pileup columns have no positions" );
+        if ( jenv -> GetArrayLength ( jstart ) <= max )
+            throw ErrorMsg ( "pileup columns maximum is out of range" );
+
+        jint capacity = jenv -> GetIntField ( jcolumns, capacity_fid );
+        uint32_t const fields
+            = ( jtype != 0 ? NGS_PileupColumnFields_event_type : 0 )
+            | ( jbase != 0 ? NGS_PileupColumnFields_base : 0 )
+            | ( jqual != 0 ? NGS_PileupColumnFields_qual : 0 )
+            | ( jmap_qual != 0 ? NGS_PileupColumnFields_map_qual : 0 );
+
+        std :: vector < jlong > position ( max );
+        std :: vector < jbyte > ref_base ( max );
+        std :: vector < jint > start ( max + 1 );
+        EventColumn < uint32_t > event_type;
+        EventColumn < char > base, qual;
+        EventColumn < int32_t > map_qual;
+        event_type . Make ( jtype, capacity );
+        base . Make ( jbase, capacity );
+        qual . Make ( jqual, capacity );
+        map_qual . Make ( jmap_qual, capacity );
+
+        PileupItf * self = Self ( (size_t) jself );
+
+        // a set state means the iterator is already on a position that did not fit
+        jint state = jenv -> GetIntField ( jcolumns, state_fid );
+        jint n = 0;
+        uint32_t used = 0;
+        while ( n < max )
+        {
+            if ( state == 0 && ! self -> nextPileup () )
+                break;
+            state = 0;
+
+            NGS_PileupColumn_v1 column;
+            column . fields = fields;
+            column . capacity = ( uint32_t ) capacity - used;
+            column . event_type = event_type . At ( used );
+            column . base = base . At ( used );
+            column . qual = qual . At ( used );
+            column . map_qual = map_qual . At ( used );
+            column . ins_bases = 0;
+            column . ins_quals = 0;
+            column . arena = 0;
+            column . arena_size = 0;
+            column . count = 0;
+            column . arena_used = 0;
+
+            if ( ! self -> getColumn ( column ) )
+            {
+                state = 1;
+                if ( n != 0 )
+                    break;
+
+                // alone and still too deep: the room grows to hold it
+                capacity = column . count;
+                if ( ! Grow ( jenv, jcolumns, type_fid, jtype, capacity ) ||
+                     ! Grow ( jenv, jcolumns, base_fid, jbase, capacity ) ||
+                     ! Grow ( jenv, jcolumns, qual_fid, jqual, capacity ) ||
+                     ! Grow ( jenv, jcolumns, map_qual_fid, jmap_qual, capacity ) )
+                    return false;
+                jenv -> SetIntField ( jcolumns, capacity_fid, capacity );
+                event_type . Make ( jtype, capacity );
+                base . Make ( jbase, capacity );
+                qual . Make ( jqual, capacity );
+                map_qual . Make ( jmap_qual, capacity );
+                continue;
+            }
+
+            position [ n ] = self -> getReferencePosition ();
+            ref_base [ n ] = self -> getReferenceBase ();
+            start [ n ] = used;
+            used += column . count;
+            ++ n;
+        }
+        start [ n ] = used;
+
+        jenv -> SetLongArrayRegion ( jposition, 0, n, & position [ 0 ] );
+        jenv -> SetByteArrayRegion ( jref_base, 0, n, & ref_base [ 0 ] );
+        jenv -> SetIntArrayRegion ( jstart, 0, n + 1, & start [ 0 ] );
+        if ( used != 0 )
+        {
+            if ( jtype != 0 )
+                jenv -> SetIntArrayRegion ( jtype, 0, used, ( const jint * ) event_type . Data () );
+            if ( jbase != 0 )
+                jenv -> SetByteArrayRegion ( jbase, 0, used, ( const jbyte * ) base . Data () );
+            if ( jqual != 0 )
+                jenv -> SetByteArrayRegion ( jqual, 0, used, ( const jbyte * ) qual . Data () );
+            if ( jmap_qual != 0 )
+                jenv -> SetIntArrayRegion ( jmap_qual, 0, used, ( const jint * ) map_qual . Data () );
+        }
+
+        jenv -> SetIntField ( jcolumns, count_fid, n );
+        jenv -> SetIntField ( jcolumns, state_fid, state );
+
+        return ( jboolean ) ( n != 0 );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return false;
+}
@@ -15,6 +15,14 @@ extern "C" {
 JNIEXPORT jboolean JNICALL Java_ngs_itf_PileupIteratorItf_NextPileup
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     ngs_itf_PileupIteratorItf
+ * Method:    NextPileupColumns
+ * Signature: (JILngs/PileupColumns;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_ngs_itf_PileupIteratorItf_NextPileupColumns
+  (JNIEnv *, jobject, jlong, jint, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,7 @@
 #include <ngs/itf/AlignmentItf.hpp>
 #include <ngs/itf/ReadGroupItf.hpp>
 #include <ngs/itf/ReadItf.hpp>
+#include <ngs/itf/StatisticsItf.hpp>
 #include <ngs/itf/StringItf.hpp>
 
 using namespace ngs;
@@ -70,6 +71,12 @@ jlong Cast ( ReadItf * obj )
     return ( jlong ) ( size_t ) obj;
 }
 
+inline
+jlong Cast ( StatisticsItf * obj )
+{
+    return ( jlong ) ( size_t ) obj;
+}
+
 /*
  * Class:     ngs_itf_ReadCollectionItf
  * Method:    GetName
@@ -407,6 +414,38 @@ JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetAlignmentRange
     return 0;
 }
 
+/*
+ * Class:     ngs_itf_ReadCollectionItf
+ * Method:    GetAlignmentShard
+ * Signature: (JIII)J
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetAlignmentShard
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jint shard, jint count, jint categories )
+{
+    try
+    {
+        ErrorMsgAssertU32 ( jenv, shard );
+        ErrorMsgAssertU32 ( jenv, count );
+
+        AlignmentItf * new_ref = Self ( jself ) -> getAlignmentShard ( shard, count, categories );
+        return Cast ( new_ref );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
 /*
  * Class:     ngs_itf_ReadCollectionItf
  * Method:    GetRead
@@ -534,3 +573,60 @@ JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetReadRange
 
     return 0;
 }
+
+/*
+ * Class:     ngs_itf_ReadCollectionItf
+ * Method:    GetFeatures
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadCollectionItf_GetFeatures
+    ( JNIEnv * jenv, jobject jthis, jlong jself )
+{
+    try
+    {
+        return ( jint ) Self ( jself ) -> getFeatures ();
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadCollectionItf
+ * Method:    GetStatistics
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetStatistics
+    ( JNIEnv * jenv, jobject jthis, jlong jself )
+{
+    try
+    {
+        StatisticsItf * new_ref = Self ( jself ) -> getStatistics ();
+        return Cast ( new_ref );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
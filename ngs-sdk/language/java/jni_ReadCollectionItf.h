@@ -95,6 +95,14 @@ JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetAlignmentCount
 JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetAlignmentRange
   (JNIEnv *, jobject, jlong, jlong, jlong, jint);
 
+/*
+ * Class:     ngs_itf_ReadCollectionItf
+ * Method:    GetAlignmentShard
+ * Signature: (JIII)J
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetAlignmentShard
+  (JNIEnv *, jobject, jlong, jint, jint, jint);
+
 /*
  * Class:     ngs_itf_ReadCollectionItf
  * Method:    GetRead
@@ -127,6 +135,22 @@ JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetReadCount
 JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetReadRange
   (JNIEnv *, jobject, jlong, jlong, jlong, jint);
 
+/*
+ * Class:     ngs_itf_ReadCollectionItf
+ * Method:    GetFeatures
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadCollectionItf_GetFeatures
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     ngs_itf_ReadCollectionItf
+ * Method:    GetStatistics
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_ngs_itf_ReadCollectionItf_GetStatistics
+  (JNIEnv *, jobject, jlong);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,7 @@
 #include <ngs/itf/FragmentItf.hpp>
 #include <ngs/itf/ReadItf.hpp>
 #include <ngs/itf/StringItf.hpp>
+#include <ngs/itf/StringItf.h>
 
 using namespace ngs;
 
@@ -134,6 +135,130 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_ReadItf_GetFragmentQualities
     return 0;
 }
 
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentBasesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentBasesView ( offset, length, view );
+        return StringViewCopyToByteBuffer ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentBasesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentBasesView ( offset, length, view );
+        return StringViewCopyToByteArray ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentQualitiesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentQualitiesView ( offset, length, view );
+        return StringViewCopyToByteBuffer ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentQualitiesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        NGS_StringView_v1 view;
+        StringItf * ref = Self ( jself ) -> getFragmentQualitiesView ( offset, length, view );
+        return StringViewCopyToByteArray ( view, ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
 /*
  * Class:     ngs_itf_ReadItf
  * Method:    IsPaired
@@ -463,4 +588,124 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_ReadItf_GetReadQualities
     return 0;
 }
 
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadBasesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        StringItf * new_ref = Self ( jself ) -> getReadBases ( offset, length );
+        return StringItfConvertToByteBuffer ( new_ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadBasesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        StringItf * new_ref = Self ( jself ) -> getReadBases ( offset, length );
+        return StringItfConvertToByteArray ( new_ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadQualitiesBuffer
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jobject jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        StringItf * new_ref = Self ( jself ) -> getReadQualities ( offset, length );
+        return StringItfConvertToByteBuffer ( new_ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadQualitiesArray
+    ( JNIEnv * jenv, jobject jthis, jlong jself, jlong offset, jlong length, jbyteArray jdst, jint pos, jint room )
+{
+    try
+    {
+        ErrorMsgAssertUnsignedLong ( jenv, offset );
+        StringItf * new_ref = Self ( jself ) -> getReadQualities ( offset, length );
+        return StringItfConvertToByteArray ( new_ref, jdst, pos, room, jenv );
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
+
 #undef Self
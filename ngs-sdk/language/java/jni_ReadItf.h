@@ -31,6 +31,38 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_ReadItf_GetFragmentBases
 JNIEXPORT jstring JNICALL Java_ngs_itf_ReadItf_GetFragmentQualities
   (JNIEnv *, jobject, jlong, jlong, jlong);
 
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentBasesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentBasesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentQualitiesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetFragmentQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetFragmentQualitiesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     ngs_itf_ReadItf
  * Method:    IsPaired
@@ -119,6 +151,38 @@ JNIEXPORT jstring JNICALL Java_ngs_itf_ReadItf_GetReadBases
 JNIEXPORT jstring JNICALL Java_ngs_itf_ReadItf_GetReadQualities
   (JNIEnv *, jobject, jlong, jlong, jlong);
 
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadBasesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadBasesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadBasesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadBasesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadQualitiesBuffer
+ * Signature: (JJJLjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadQualitiesBuffer
+  (JNIEnv *, jobject, jlong, jlong, jlong, jobject, jint, jint);
+
+/*
+ * Class:     ngs_itf_ReadItf
+ * Method:    GetReadQualitiesArray
+ * Signature: (JJJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReadItf_GetReadQualitiesArray
+  (JNIEnv *, jobject, jlong, jlong, jlong, jbyteArray, jint, jint);
+
 #ifdef __cplusplus
 }
 #endif
@@ -500,3 +500,30 @@ JNIEXPORT jlong JNICALL Java_ngs_itf_ReferenceItf_GetFilteredPileupSlice
     return 0;
 }
 
+/*
+ * Class:     ngs_itf_ReferenceItf
+ * Method:    GetFeatures
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReferenceItf_GetFeatures
+    ( JNIEnv * jenv, jobject jthis, jlong jself )
+{
+    try
+    {
+        return ( jint ) Self ( jself ) -> getFeatures ();
+    }
+    catch ( ErrorMsg & x )
+    {
+        ErrorMsgThrow ( jenv, xt_error_msg, x . what () );
+    }
+    catch ( std :: exception & x )
+    {
+        ErrorMsgThrow ( jenv, xt_runtime, x . what () );
+    }
+    catch ( ... )
+    {
+        JNI_INTERNAL_ERROR ( jenv, "%s", __func__ );
+    }
+
+    return 0;
+}
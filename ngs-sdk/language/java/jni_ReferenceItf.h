@@ -127,6 +127,14 @@ JNIEXPORT jlong JNICALL Java_ngs_itf_ReferenceItf_GetPileupSlice
 JNIEXPORT jlong JNICALL Java_ngs_itf_ReferenceItf_GetFilteredPileupSlice
   (JNIEnv *, jobject, jlong, jlong, jlong, jint, jint, jint);
 
+/*
+ * Class:     ngs_itf_ReferenceItf
+ * Method:    GetFeatures
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_ngs_itf_ReferenceItf_GetFeatures
+  (JNIEnv *, jobject, jlong);
+
 #ifdef __cplusplus
 }
 #endif
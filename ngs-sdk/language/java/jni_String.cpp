@@ -28,6 +28,7 @@
 #include "jni_ErrorMsg.hpp"
 
 #include <ngs/itf/StringItf.hpp>
+#include <ngs/itf/StringItf.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -103,6 +104,35 @@ void JStringReleaseData ( jstring jself, JNIEnv * jenv, const char * data )
     jenv -> ReleaseStringUTFChars ( jself, data );
 }
 
+/* NewASCIIString
+ *  a Java String from up to ASCII_STRING_MAX bytes that are all ASCII,
+ *  widened straight to UTF-16 on the stack, so that they need neither a
+ *  terminating NUL nor decoding as modified UTF-8; a JVM with compact
+ *  strings keeps them as Latin-1
+ *  returns false, with no String made, if any byte isn't ASCII or is NUL
+ */
+static const size_t ASCII_STRING_MAX = 1024;
+
+static
+bool NewASCIIString ( JNIEnv * jenv, const char * data, size_t size, jstring & jstr )
+{
+    jchar wide [ ASCII_STRING_MAX ];
+
+    if ( size > ASCII_STRING_MAX )
+        return false;
+
+    for ( size_t i = 0; i < size; ++ i )
+    {
+        unsigned char ch = ( unsigned char ) data [ i ];
+        if ( ch == 0 || ch >= 0x80 )
+            return false;
+        wide [ i ] = ch;
+    }
+
+    jstr = jenv -> NewString ( wide, ( jsize ) size );
+    return true;
+}
+
 /* CopyToJString
  *  copy a Java String from an NGS_String
  */
@@ -120,6 +150,10 @@ jstring StringItfCopyToJString ( const ngs :: StringItf * self, JNIEnv * jenv )
 
     const char * data = self -> data ();
 
+    jstring jstr;
+    if ( NewASCIIString ( jenv, data, size, jstr ) )
+        return jstr;
+
     /* the Java gods did not see fit to provide a version
        of NewString that takes a pointer and a length,
        at least when it comes to UTF-8 character sets... */
@@ -151,7 +185,7 @@ jstring StringItfCopyToJString ( const ngs :: StringItf * self, JNIEnv * jenv )
     memcpy ( copy, data, size );
     copy [ size ] = 0;
 
-    jstring jstr = jenv -> NewStringUTF ( copy );
+    jstr = jenv -> NewStringUTF ( copy );
 
     free ( ( void* ) copy );
 
@@ -167,3 +201,94 @@ jstring StringItfConvertToJString ( ngs :: StringItf * self, JNIEnv * jenv )
     self -> Release ();
     return jstr;
 }
+
+/* ViewSize
+ *  the size of a view as a Java int
+ */
+static
+jint StringViewSize ( const NGS_StringView_v1 & view, ngs :: StringItf * ref, JNIEnv * jenv )
+{
+    if ( view . size > 0x7FFFFFFF )
+    {
+        if ( ref != 0 )
+            ref -> Release ();
+        RuntimeExceptionThrow ( jenv, "failed to copy a String ( string too long )" );
+        return -1;
+    }
+
+    return ( jint ) view . size;
+}
+
+/* CopyToByteBuffer
+ *  copy a view into a direct ByteBuffer
+ */
+jint StringViewCopyToByteBuffer ( const NGS_StringView_v1 & view, ngs :: StringItf * ref,
+    jobject jdst, jint pos, jint room, JNIEnv * jenv )
+{
+    assert ( jenv != 0 );
+
+    jint size = StringViewSize ( view, ref, jenv );
+    if ( size < 0 )
+        return 0;
+
+    if ( size != 0 && size <= room )
+    {
+        char * dst = ( char* ) jenv -> GetDirectBufferAddress ( jdst );
+        jlong cap = jenv -> GetDirectBufferCapacity ( jdst );
+        if ( dst == 0 || pos < 0 || ( jlong ) pos + size > cap )
+        {
+            if ( ref != 0 )
+                ref -> Release ();
+            RuntimeExceptionThrow ( jenv, "failed to copy a String ( bad ByteBuffer )" );
+            return 0;
+        }
+
+        memcpy ( dst + pos, view . data, size );
+    }
+
+    if ( ref != 0 )
+        ref -> Release ();
+
+    return size;
+}
+
+/* CopyToByteArray
+ *  copy a view into a byte[]
+ */
+jint StringViewCopyToByteArray ( const NGS_StringView_v1 & view, ngs :: StringItf * ref,
+    jbyteArray jdst, jint pos, jint room, JNIEnv * jenv )
+{
+    assert ( jenv != 0 );
+
+    jint size = StringViewSize ( view, ref, jenv );
+    if ( size < 0 )
+        return 0;
+
+    // an ArrayIndexOutOfBoundsException is raised for a bad "pos"
+    if ( size != 0 && size <= room )
+        jenv -> SetByteArrayRegion ( jdst, pos, size, ( const jbyte* ) view . data );
+
+    if ( ref != 0 )
+        ref -> Release ();
+
+    return size;
+}
+
+/* ConvertToByteBuffer
+ * ConvertToByteArray
+ */
+jint StringItfConvertToByteBuffer ( ngs :: StringItf * self, jobject jdst, jint pos, jint room, JNIEnv * jenv )
+{
+    NGS_StringView_v1 view;
+    view . data = self -> data ();
+    view . size = self -> size ();
+    return StringViewCopyToByteBuffer ( view, self, jdst, pos, room, jenv );
+}
+
+jint StringItfConvertToByteArray ( ngs :: StringItf * self, jbyteArray jdst, jint pos, jint room, JNIEnv * jenv )
+{
+    NGS_StringView_v1 view;
+    view . data = self -> data ();
+    view . size = self -> size ();
+    return StringViewCopyToByteArray ( view, self, jdst, pos, room, jenv );
+}
@@ -81,4 +81,24 @@ jstring StringItfCopyToJString ( const ngs :: StringItf * self, JNIEnv * jenv  )
 jstring StringItfConvertToJString ( ngs :: StringItf * self, JNIEnv * jenv );
 
 
+/* CopyToByteBuffer
+ * CopyToByteArray
+ *  copy the bytes of a view to "pos" of a direct java.nio.ByteBuffer
+ *  or of a byte[], releasing "ref" if not NULL
+ *  returns the size of the view; nothing is copied when it exceeds "room"
+ */
+jint StringViewCopyToByteBuffer ( const NGS_StringView_v1 & view, ngs :: StringItf * ref,
+    jobject jdst, jint pos, jint room, JNIEnv * jenv );
+jint StringViewCopyToByteArray ( const NGS_StringView_v1 & view, ngs :: StringItf * ref,
+    jbyteArray jdst, jint pos, jint room, JNIEnv * jenv );
+
+
+/* ConvertToByteBuffer
+ * ConvertToByteArray
+ *  as above, for the whole of a StringItf
+ */
+jint StringItfConvertToByteBuffer ( ngs :: StringItf * self, jobject jdst, jint pos, jint room, JNIEnv * jenv );
+jint StringItfConvertToByteArray ( ngs :: StringItf * self, jbyteArray jdst, jint pos, jint room, JNIEnv * jenv );
+
+
 #endif /* _hpp_jni_ErrorMsg_ */
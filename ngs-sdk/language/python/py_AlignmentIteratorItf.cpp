@@ -28,6 +28,7 @@
 #include "py_ErrorMsg.hpp"
 
 #include <ngs/itf/AlignmentItf.hpp>
+#include <ngs/itf/AlignmentItf.h>
 
 PY_RES_TYPE PY_NGS_AlignmentIteratorNext ( void* pRef, int* pRet, void** ppNGSStrError )
 {
@@ -54,3 +55,29 @@ PY_RES_TYPE PY_NGS_AlignmentIteratorNext ( void* pRef, int* pRet, void** ppNGSSt
     return ret;
 }
 
+
+PY_RES_TYPE PY_NGS_AlignmentIteratorNextBatch ( void* pRef, void* pBatch, int* pRet, void** ppNGSStrError )
+{
+    PY_RES_TYPE ret = PY_RES_ERROR;
+    try
+    {
+        NGS_AlignmentBatch_v1 * batch = CheckedCast< NGS_AlignmentBatch_v1* >(pBatch);
+        bool res = CheckedCast< ngs::AlignmentItf* >(pRef) -> nextAlignmentBatch( * batch );
+        assert(pRet != NULL);
+        *pRet = (int)res;
+        ret = PY_RES_OK;
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( std::exception & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( ... )
+    {
+        ret = ExceptionHandler ( ppNGSStrError );
+    }
+    return ret;
+}
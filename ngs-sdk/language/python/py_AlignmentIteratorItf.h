@@ -34,6 +34,9 @@ extern "C" {
 
 LIB_EXPORT PY_RES_TYPE PY_NGS_AlignmentIteratorNext(void* pRef, int* pRet, void** ppNGSStrError);
 
+/* pBatch is an NGS_AlignmentBatch_v1 whose columns are owned by the caller */
+LIB_EXPORT PY_RES_TYPE PY_NGS_AlignmentIteratorNextBatch(void* pRef, void* pBatch, int* pRet, void** ppNGSStrError);
+
 #ifdef __cplusplus
 }
 #endif
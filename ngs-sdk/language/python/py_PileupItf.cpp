@@ -28,6 +28,7 @@
 #include "py_ErrorMsg.hpp"
 
 #include <ngs/itf/PileupItf.hpp>
+#include <ngs/itf/PileupItf.h>
 
 PY_RES_TYPE PY_NGS_PileupGetReferenceSpec ( void* pRef, void** pRet, void** ppNGSStrError )
 {
@@ -133,3 +134,76 @@ PY_RES_TYPE PY_NGS_PileupGetPileupDepth ( void* pRef, uint32_t* pRet, void** ppN
     return ret;
 }
 
+
+namespace
+{
+    // positions counted per call into the engine
+    const uint32_t BASE_COUNTS_RUN = 256;
+
+    uint64_t FillBaseCounts ( ngs::PileupItf * it, int32_t min_qual, int64_t start, uint64_t length, bool by_strand, uint32_t * counts )
+    {
+        const uint32_t kinds = NGS_PileupBaseCount_kinds;
+        const uint32_t stride = by_strand ? 2 * kinds : kinds;
+
+        NGS_PileupBaseCounts_v1 run [ BASE_COUNTS_RUN ];
+        uint64_t total = 0;
+
+        while ( it -> nextPileup () )
+        {
+            uint32_t n = it -> getBaseCounts ( min_qual, BASE_COUNTS_RUN, run );
+            for ( uint32_t i = 0; i < n; ++ i )
+            {
+                // a slice may be wider than the window asked for
+                uint64_t offset = ( uint64_t ) ( run [ i ] . position - start );
+                if ( run [ i ] . position < start || offset >= length )
+                    continue;
+
+                uint32_t * dst = counts + offset * stride;
+                for ( uint32_t k = 0; k < kinds; ++ k )
+                {
+                    if ( by_strand )
+                    {
+                        dst [ k ] = run [ i ] . plus [ k ];
+                        dst [ kinds + k ] = run [ i ] . minus [ k ];
+                    }
+                    else
+                    {
+                        dst [ k ] = run [ i ] . plus [ k ] + run [ i ] . minus [ k ];
+                    }
+                }
+                ++ total;
+            }
+            if ( n == 0 )
+                break;
+        }
+
+        return total;
+    }
+}
+
+PY_RES_TYPE PY_NGS_PileupGetBaseCounts ( void* pRef, int32_t min_qual, int64_t start, uint64_t length, int by_strand, uint32_t* counts, uint64_t* pRet, void** ppNGSStrError )
+{
+    PY_RES_TYPE ret = PY_RES_ERROR; // TODO: use xt_* codes
+    try
+    {
+        assert (counts != NULL || length == 0);
+        uint64_t res = FillBaseCounts ( CheckedCast< ngs::PileupItf* >(pRef), min_qual, start, length, by_strand != 0, counts );
+        assert (pRet != NULL);
+        *pRet = res;
+        ret = PY_RES_OK;
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( std::exception & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( ... )
+    {
+        ret = ExceptionHandler ( ppNGSStrError );
+    }
+
+    return ret;
+}
@@ -37,6 +37,13 @@ LIB_EXPORT PY_RES_TYPE PY_NGS_PileupGetReferencePosition ( void* pRef, int64_t*
 LIB_EXPORT PY_RES_TYPE PY_NGS_PileupGetReferenceBase     ( void* pRef, char* pRet, void** ppNGSStrError );
 LIB_EXPORT PY_RES_TYPE PY_NGS_PileupGetPileupDepth       ( void* pRef, uint32_t* pRet, void** ppNGSStrError );
 
+/* advances a fresh PileupIterator of a slice to its end, counting the bases
+   of each position in [ start, start + length ) into counts: per position,
+   NGS_PileupBaseCount_kinds counts of both strands, or when "by_strand",
+   those of the plus strand followed by those of the minus one.
+   counts must come in zeroed; *pRet is the number of positions counted */
+LIB_EXPORT PY_RES_TYPE PY_NGS_PileupGetBaseCounts        ( void* pRef, int32_t min_qual, int64_t start, uint64_t length, int by_strand, uint32_t* counts, uint64_t* pRet, void** ppNGSStrError );
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,10 +43,13 @@ LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetAlignment      (void* pRef, char
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetAlignments     (void* pRef, uint32_t categories, void** pRet, void** ppNGSStrError);
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetAlignmentCount (void* pRef, uint32_t categories, uint64_t* pRet, void** ppNGSStrError);
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetAlignmentRange (void* pRef, uint64_t first, uint64_t count, uint32_t categories, void** pRet, void** ppNGSStrError);
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetAlignmentShard (void* pRef, uint32_t shard, uint32_t count, uint32_t categories, void** pRet, void** ppNGSStrError);
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetRead           (void* pRef, char const* readId, void** pRet, void** ppNGSStrError);
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetReads          (void* pRef, uint32_t categories, void** pRet, void** ppNGSStrError);
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetReadCount      (void* pRef, uint32_t categories, uint64_t* pRet, void** ppNGSStrError);
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetReadRange      (void* pRef, uint64_t first, uint64_t count, uint32_t categories, void** pRet, void** ppNGSStrError);
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetFeatures       (void* pRef, uint32_t* pRet, void** ppNGSStrError);
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReadCollectionGetStatistics     (void* pRef, void** pRet, void** ppNGSStrError);
 
 #ifdef __cplusplus
 }
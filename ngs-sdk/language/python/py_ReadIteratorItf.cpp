@@ -28,6 +28,9 @@
 #include "py_ErrorMsg.hpp"
 
 #include <ngs/itf/ReadItf.hpp>
+#include <ngs/itf/StringItf.hpp>
+
+#include <string.h>
 
 PY_RES_TYPE PY_NGS_ReadIteratorNext ( void* pRef, int* pRet, void** ppNGSStrError )
 {
@@ -54,3 +57,132 @@ PY_RES_TYPE PY_NGS_ReadIteratorNext ( void* pRef, int* pRet, void** ppNGSStrErro
     return ret;
 }
 
+
+namespace
+{
+    // the strings of the read being added, released when done with
+    struct ReadBatchStrings
+    {
+        ReadBatchStrings ()
+        {
+            for ( int i = 0; i < 4; ++ i )
+                str [ i ] = 0;
+        }
+
+        ~ ReadBatchStrings ()
+        {
+            for ( int i = 0; i < 4; ++ i )
+            {
+                if ( str [ i ] != 0 )
+                    str [ i ] -> Release ();
+            }
+        }
+
+        uint64_t size () const
+        {
+            uint64_t total = 0;
+            for ( int i = 0; i < 4; ++ i )
+            {
+                if ( str [ i ] != 0 )
+                    total += str [ i ] -> size ();
+            }
+            return total;
+        }
+
+        void Copy ( PY_NGS_ReadBatch & batch, int i, PY_NGS_ReadBatchString * dst ) const
+        {
+            if ( dst != 0 )
+            {
+                PY_NGS_ReadBatchString & out = dst [ batch . count ];
+
+                out . offset = batch . arena_used;
+                out . size = str [ i ] ? ( uint32_t ) str [ i ] -> size () : 0;
+                if ( out . size != 0 )
+                    ::memcpy ( batch . arena + batch . arena_used, str [ i ] -> data (), out . size );
+                batch . arena_used += out . size;
+            }
+        }
+
+        ngs::StringItf * str [ 4 ];
+    };
+
+    bool FillReadBatch ( ngs::ReadItf * it, PY_NGS_ReadBatch & batch )
+    {
+        uint32_t const fields = batch . fields;
+
+        batch . count = 0;
+        batch . arena_used = 0;
+
+        while ( batch . count < batch . capacity && batch . state != PY_NGS_ReadBatchState_end )
+        {
+            if ( batch . state == PY_NGS_ReadBatchState_next )
+            {
+                if ( ! it -> nextRead () )
+                {
+                    batch . state = PY_NGS_ReadBatchState_end;
+                    break;
+                }
+                batch . state = PY_NGS_ReadBatchState_held;
+            }
+
+            ReadBatchStrings strings;
+            if ( ( fields & PY_NGS_ReadBatchFields_read_id ) != 0 )
+                strings . str [ 0 ] = it -> getReadId ();
+            if ( ( fields & PY_NGS_ReadBatchFields_read_group ) != 0 )
+                strings . str [ 1 ] = it -> getReadGroup ();
+            if ( ( fields & PY_NGS_ReadBatchFields_bases ) != 0 )
+                strings . str [ 2 ] = it -> getReadBases ();
+            if ( ( fields & PY_NGS_ReadBatchFields_qualities ) != 0 )
+                strings . str [ 3 ] = it -> getReadQualities ();
+
+            // leave the read for the next batch if it doesn't fit in this one
+            if ( strings . size () > batch . arena_size - batch . arena_used )
+            {
+                if ( batch . count == 0 )
+                    throw ngs::ErrorMsg ( "read batch arena is too small for the next read" );
+                break;
+            }
+
+            uint32_t const i = batch . count;
+            if ( ( fields & PY_NGS_ReadBatchFields_category ) != 0 )
+                batch . category [ i ] = it -> getReadCategory ();
+            if ( ( fields & PY_NGS_ReadBatchFields_num_fragments ) != 0 )
+                batch . num_fragments [ i ] = it -> getNumFragments ();
+            strings . Copy ( batch, 0, ( fields & PY_NGS_ReadBatchFields_read_id ) ? batch . read_id : 0 );
+            strings . Copy ( batch, 1, ( fields & PY_NGS_ReadBatchFields_read_group ) ? batch . read_group : 0 );
+            strings . Copy ( batch, 2, ( fields & PY_NGS_ReadBatchFields_bases ) ? batch . bases : 0 );
+            strings . Copy ( batch, 3, ( fields & PY_NGS_ReadBatchFields_qualities ) ? batch . qualities : 0 );
+
+            ++ batch . count;
+            batch . state = PY_NGS_ReadBatchState_next;
+        }
+
+        return batch . count != 0;
+    }
+}
+
+PY_RES_TYPE PY_NGS_ReadIteratorNextBatch ( void* pRef, PY_NGS_ReadBatch* pBatch, int* pRet, void** ppNGSStrError )
+{
+    PY_RES_TYPE ret = PY_RES_ERROR;
+    try
+    {
+        PY_NGS_ReadBatch * batch = CheckedCast< PY_NGS_ReadBatch* >(pBatch);
+        bool res = FillReadBatch ( CheckedCast< ngs::ReadItf* >(pRef), * batch );
+        assert(pRet != NULL);
+        *pRet = (int)res;
+        ret = PY_RES_OK;
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( std::exception & x )
+    {
+        ret = ExceptionHandler ( x, ppNGSStrError );
+    }
+    catch ( ... )
+    {
+        ret = ExceptionHandler ( ppNGSStrError );
+    }
+    return ret;
+}
@@ -34,6 +34,61 @@ extern "C" {
 
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReadIteratorNext(void* pRef, int* pRet, void** ppNGSStrError);
 
+/*--------------------------------------------------------------------------
+ * PY_NGS_ReadBatch
+ *  the columns of the next few reads, laid out like NGS_AlignmentBatch_v1:
+ *  the caller provides the columns named in "fields" with room for
+ *  "capacity" reads, and an arena the strings are copied into
+ *
+ *  a read whose strings don't fit is held over for the next batch
+ */
+enum
+{
+    PY_NGS_ReadBatchFields_read_id       = 0x01,
+    PY_NGS_ReadBatchFields_category      = 0x02,
+    PY_NGS_ReadBatchFields_num_fragments = 0x04,
+    PY_NGS_ReadBatchFields_read_group    = 0x08,
+    PY_NGS_ReadBatchFields_bases         = 0x10,
+    PY_NGS_ReadBatchFields_qualities     = 0x20
+};
+
+enum
+{
+    PY_NGS_ReadBatchState_next,
+    PY_NGS_ReadBatchState_held,
+    PY_NGS_ReadBatchState_end
+};
+
+typedef struct PY_NGS_ReadBatchString PY_NGS_ReadBatchString;
+struct PY_NGS_ReadBatchString
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+typedef struct PY_NGS_ReadBatch PY_NGS_ReadBatch;
+struct PY_NGS_ReadBatch
+{
+    /* set by the caller */
+    uint32_t fields;
+    uint32_t capacity;
+    uint32_t * category;
+    uint32_t * num_fragments;
+    PY_NGS_ReadBatchString * read_id;
+    PY_NGS_ReadBatchString * read_group;
+    PY_NGS_ReadBatchString * bases;
+    PY_NGS_ReadBatchString * qualities;
+    char * arena;
+    uint32_t arena_size;
+
+    /* set by PY_NGS_ReadIteratorNextBatch; state is PY_NGS_ReadBatchState_next to begin with */
+    uint32_t count;
+    uint32_t arena_used;
+    uint32_t state;
+};
+
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReadIteratorNextBatch(void* pRef, PY_NGS_ReadBatch* pBatch, int* pRet, void** ppNGSStrError);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,10 @@ LIB_EXPORT PY_RES_TYPE PY_NGS_ReferenceGetPileups                 ( void* pRef,
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReferenceGetFilteredPileups         ( void* pRef, uint32_t categories, uint32_t filters, int32_t map_qual, void** pRet, void** ppNGSStrError );
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReferenceGetPileupSlice             ( void* pRef, int64_t start, uint64_t length, uint32_t categories, void** pRet, void** ppNGSStrError );
 LIB_EXPORT PY_RES_TYPE PY_NGS_ReferenceGetFilteredPileupSlice     ( void* pRef, int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t map_qual, void** pRet, void** ppNGSStrError );
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReferenceGetFeatures                ( void* pRef, uint32_t* pRet, void** ppNGSStrError );
+
+/* fills depth [ 0 .. length ), a window that must lie within the Reference */
+LIB_EXPORT PY_RES_TYPE PY_NGS_ReferenceGetCoverage                ( void* pRef, int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t map_qual, uint32_t* depth, void** ppNGSStrError );
 
 #ifdef __cplusplus
 }
@@ -31,6 +31,8 @@
 #include <ngs/Fragment.hpp>
 #endif
 
+#include <vector>
+
 namespace ngs
 {
 
@@ -54,7 +56,7 @@ namespace ngs
          *  the id will be unique within ReadCollection.
          */
         StringRef getAlignmentId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -64,18 +66,32 @@ namespace ngs
         /* getReferenceSpec
          */
         String getReferenceSpec () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReferenceSpecView
+         *  lent by the alignment: valid until the next message to it
+         */
+        StringView getReferenceSpecView () const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReferenceIndex
+         *  the index of the Reference in the order ReadCollection::getReferences
+         *  gives them, or -1 when unaligned; a table of names built once
+         *  maps it back without a string per Alignment
+         */
+        int32_t getReferenceIndex () const
+            NGS_THROWS ( ErrorMsg );
 
         /* getMappingQuality 
          */
         int getMappingQuality () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReferenceBases
          *  return reference bases
          */
         StringRef getReferenceBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -85,31 +101,51 @@ namespace ngs
         /* getReadGroup
          */
         String getReadGroup () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReadId
          */
         StringRef getReadId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReadIdView
+         *  lent by the alignment: valid until the next message to it
+         */
+        StringView getReadIdView () const
+            NGS_THROWS ( ErrorMsg );
 
         /* getClippedFragmentBases
          *  return fragment bases
          */
         StringRef getClippedFragmentBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getClippedFragmentQualities
          *  return fragment phred quality values
          *  using ASCII offset of 33
          */
         StringRef getClippedFragmentQualities () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignedFragmentBases
          *  return fragment bases in their aligned orientation
          */
         StringRef getAlignedFragmentBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getFragmentInReadOrientation
+         *  sets "bases" and "qualities" to all of the fragment, soft clips
+         *  included, as it was sequenced: reverse complemented, with its
+         *  qualities reversed, if it aligned to the reverse strand
+         *  an engine may fill both in with a single message, into the
+         *  storage they already have; otherwise they are turned around here
+         *  "qualities" is left empty if the fragment has none
+         *  returns false, leaving both empty, for a secondary or
+         *  supplementary alignment with hard clips, which hasn't all of
+         *  the read
+         */
+        bool getFragmentInReadOrientation ( String & bases, String & qualities ) const
+            NGS_THROWS ( ErrorMsg );
 
         /*------------------------------------------------------------------
          * details of this alignment
@@ -125,7 +161,8 @@ namespace ngs
             minMapQuality = 4,      // pass alignments with mappingQuality >= param
             maxMapQuality = 8,      // pass alignments with mappingQuality <= param
             noWraparound = 16,      // do not include leading wrapped around alignments to circular references
-            startWithinSlice = 32   // change slice intersection criteria so that start pos is within slice
+            startWithinSlice = 32,  // change slice intersection criteria so that start pos is within slice
+            withMates = 64          // also give the mates outside the slice, each right after its alignment
         };
 
         /* AlignmentCategory
@@ -143,7 +180,7 @@ namespace ngs
          *  throws ErrorMsg if the property cannot be retrieved
          */
         AlignmentCategory getAlignmentCategory () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignmentPosition
          *  retrieve the Alignment's starting position on the Reference
@@ -151,7 +188,7 @@ namespace ngs
          *  throws ErrorMsg if the property cannot be retrieved
          */
         int64_t getAlignmentPosition () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReferencePositionProjectionRange
          *  retrieve the projection of Reference position on the Alignment
@@ -168,7 +205,7 @@ namespace ngs
          *  throws ErrorMsg if the property cannot be retrieved
          */
         uint64_t getReferencePositionProjectionRange ( int64_t ref_pos ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAligmentLength
          *  retrieve the projected length of an Alignment projected upon Reference.
@@ -176,7 +213,7 @@ namespace ngs
          *  throws ErrorMsg if the property cannot be retrieved
          */
         uint64_t getAlignmentLength () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getIsReversedOrientation
          *  test if orientation is reversed with respect to the Reference sequence.
@@ -184,7 +221,7 @@ namespace ngs
          *  throws ErrorMsg if the property cannot be retrieved
          */
         bool getIsReversedOrientation () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* ClipEdge
          */
@@ -197,24 +234,70 @@ namespace ngs
         /* getSoftClip
          */
         int getSoftClip ( ClipEdge edge ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getTemplateLength
          */
         uint64_t getTemplateLength () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getShortCigar
          *  returns a text string describing alignment details
          */
         StringRef getShortCigar ( bool clipped ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getLongCigar
          *  returns a text string describing alignment details
          */
         StringRef getLongCigar ( bool clipped ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* CigarOps
+         *  the operations of a CIGAR as BAM packs them: each is the length
+         *  of the operation shifted left by 4 bits and its code, an index
+         *  into "MIDNSHP=X"
+         */
+        struct CigarOps
+        {
+            const uint32_t * ops;
+            uint32_t count;
+
+            uint32_t length ( uint32_t i ) const
+            { return ops [ i ] >> 4; }
+
+            char op ( uint32_t i ) const
+            { return "MIDNSHP=X???????" [ ops [ i ] & 15 ]; }
+        };
+
+        /* getCigarOps
+         *  the CIGAR of getLongCigar ( false ), clips included, without
+         *  formatting it: the operations are lent by the engine where it
+         *  can, valid until the next message to the alignment; otherwise
+         *  they are parsed from the long CIGAR into "buffer", which the
+         *  returned operations then point into
+         */
+        CigarOps getCigarOps ( std :: vector < uint32_t > & buffer ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getMismatchCount
+         *  the number of aligned bases unlike the Reference bases under
+         *  them, leaving out the insertions and deletions NM counts too
+         *  an engine may answer from the record's tags or bases without
+         *  a message for each; otherwise the bases are compared here
+         */
+        uint32_t getMismatchCount () const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getMismatchMask
+         *  sets "mask" to a byte for each base of the clipped fragment,
+         *  those the CIGAR's M, I, = and X operations cover, in the
+         *  orientation of the Reference: 1 for each that getMismatchCount
+         *  counts and 0 for the others
+         *  returns the number of 1s
+         */
+        uint32_t getMismatchMask ( std :: vector < uint8_t > & mask ) const
+            NGS_THROWS ( ErrorMsg );
 
         /* getRNAOrientation
          *  returns '+' if positive strand is transcribed
@@ -222,7 +305,30 @@ namespace ngs
          *  returns '?' if unknown
          */
         char getRNAOrientation () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* Core
+         *  the scalar fields of an alignment, as one value
+         */
+        struct Core
+        {
+            int64_t alignmentPosition;
+            uint64_t alignmentLength;
+            uint64_t templateLength;
+            int mappingQuality;
+            bool primary;
+            bool reversedOrientation;
+            bool mate;
+        };
+
+        /* getCore
+         *  the answers of getAlignmentPosition, getAlignmentLength,
+         *  getTemplateLength, getMappingQuality, getAlignmentCategory,
+         *  getIsReversedOrientation and hasMate, in a single message
+         *  to an engine that takes it
+         */
+        Core getCore () const
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -232,44 +338,157 @@ namespace ngs
         /* hasMate
          */
         bool hasMate () const
-            throw ();
+            NGS_NOTHROW;
 
         /* getMateAlignmentId
          */
         StringRef getMateAlignmentId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getMateAlignment
          */
         Alignment getMateAlignment () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getMateReferenceSpec
          */
         String getMateReferenceSpec () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getMateReferenceIndex
+         *  as getReferenceIndex, for the mate
+         */
+        int32_t getMateReferenceIndex () const
+            NGS_THROWS ( ErrorMsg );
 
         /* getMateIsReversedOrientation
          */
         bool getMateIsReversedOrientation () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+
+        /*------------------------------------------------------------------
+         * asking before messaging
+         */
+
+        /* AlignmentMessage
+         *  the messages an engine may answer; a cleared bit means
+         *  the message would only throw
+         */
+        enum AlignmentMessage
+        {
+            fragmentIdMessage                       = 0x00000001,
+            fragmentBasesMessage                    = 0x00000002,
+            fragmentQualitiesMessage                = 0x00000004,
+            alignmentIdMessage                      = 0x00000008,
+            referenceSpecMessage                    = 0x00000010,
+            mappingQualityMessage                   = 0x00000020,
+            referenceBasesMessage                   = 0x00000040,
+            readGroupMessage                        = 0x00000080,
+            readIdMessage                           = 0x00000100,
+            clippedFragmentBasesMessage             = 0x00000200,
+            clippedFragmentQualitiesMessage         = 0x00000400,
+            alignedFragmentBasesMessage             = 0x00000800,
+            alignmentCategoryMessage                = 0x00001000,
+            alignmentPositionMessage                = 0x00002000,
+            alignmentLengthMessage                  = 0x00004000,
+            isReversedOrientationMessage            = 0x00008000,
+            softClipMessage                         = 0x00010000,
+            templateLengthMessage                   = 0x00020000,
+            cigarMessage                            = 0x00040000,  // short and long
+            rnaOrientationMessage                   = 0x00080000,
+            hasMateMessage                          = 0x00100000,
+            mateAlignmentIdMessage                  = 0x00200000,
+            mateAlignmentMessage                    = 0x00400000,
+            mateReferenceSpecMessage                = 0x00800000,
+            mateIsReversedOrientationMessage        = 0x01000000,
+            referencePositionProjectionRangeMessage = 0x02000000,
+            tagsMessage                             = 0x04000000   // all of the tag messages
+        };
+
+        /* supports
+         *  true if the message is answered by this engine
+         *  the answer is the same for every Alignment of an iterator,
+         *  so it may be asked once, before the loop
+         */
+        bool supports ( AlignmentMessage msg ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* tryGetReadGroup
+         *  stores the read group into "name" and returns true,
+         *  or returns false if there is none to be had
+         */
+        bool tryGetReadGroup ( String & name ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* tryGetMateAlignmentId
+         *  stores the mate's id into "id" and returns true, or returns
+         *  false if there is no mate or the engine cannot say
+         */
+        bool tryGetMateAlignmentId ( String & id ) const
+            NGS_THROWS ( ErrorMsg );
+
+
+        /*------------------------------------------------------------------
+         * optional fields
+         *  the tagged values of the record, each named by two characters
+         *  such as "NM"; the getters throw if the record has no field of
+         *  that name, or has one of another type
+         */
+
+        /* hasTag
+         *  true if the record has the field "tag"
+         */
+        bool hasTag ( const String & tag ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getTagInt
+         *  the value of an integer field, of type c, C, s, S, i or I
+         */
+        int64_t getTagInt ( const String & tag ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getTagFloat
+         *  the value of a field of type f
+         */
+        float getTagFloat ( const String & tag ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getTagString
+         *  the value of a field of type Z or H, or the character of one of type A
+         */
+        String getTagString ( const String & tag ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getTagArray
+         *  the elements of a field of type B, each converted to T
+         */
+        template < class T >
+        std :: vector < T > getTagArray ( const String & tag ) const
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         Alignment & operator = ( AlignmentRef ref )
-            throw ();
+            NGS_NOTHROW;
         Alignment ( AlignmentRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         Alignment & operator = ( const Alignment & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         Alignment ( const Alignment & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        Alignment ( Alignment && obj )
+            noexcept;
+        Alignment & operator = ( Alignment && obj )
+            noexcept;
+#endif
 
         ~ Alignment ()
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
@@ -0,0 +1,192 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_alignment_batch_
+#define _hpp_ngs_alignment_batch_
+
+#ifndef _hpp_ngs_error_msg_
+#include <ngs/ErrorMsg.hpp>
+#endif
+
+#ifndef _hpp_ngs_alignment_
+#include <ngs/Alignment.hpp>
+#endif
+
+#ifndef _h_ngs_itf_alignmentitf_
+#include <ngs/itf/AlignmentItf.h>
+#endif
+
+#include <vector>
+
+namespace ngs
+{
+    namespace arrow
+    {
+        class AlignmentStream;
+    }
+
+    /*======================================================================
+     * AlignmentBatch
+     *  the columns of a number of Alignments at a time,
+     *  filled in by AlignmentIterator :: nextAlignmentBatch
+     *  a batch is meant for use with a single iterator
+     */
+    class AlignmentBatch
+    {
+    public:
+
+        /* BatchField
+         *  the columns to fill in
+         */
+        enum BatchField
+        {
+            alignmentPosition   = NGS_AlignmentBatchFields_position,  // and length
+            mappingQuality      = NGS_AlignmentBatchFields_map_qual,
+            alignmentFlags      = NGS_AlignmentBatchFields_flags,     // category, orientation, mate
+            referenceSpec       = NGS_AlignmentBatchFields_ref_spec,
+            readId              = NGS_AlignmentBatchFields_read_id,
+            fragmentBases       = NGS_AlignmentBatchFields_bases,
+            fragmentQualities   = NGS_AlignmentBatchFields_qualities,
+            allFields           = 0x7F,
+
+            // asked for by name, not by allFields, as not every engine has indices
+            referenceIndex      = NGS_AlignmentBatchFields_ref_index,
+            cigarOps            = NGS_AlignmentBatchFields_cigar      // clips included
+        };
+
+        /* size
+         *  the number of Alignments in the batch
+         */
+        uint32_t size () const
+            NGS_NOTHROW;
+
+        /* per-Alignment columns
+         *  "i" is zero-based and less than size ()
+         *  throws if "i" is out of range or the column was not asked for
+         */
+        int64_t getAlignmentPosition ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        uint64_t getAlignmentLength ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        int getMappingQuality ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        Alignment :: AlignmentCategory getAlignmentCategory ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        bool getIsReversedOrientation ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        bool hasMate ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        String getReferenceSpec ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        String getReadId ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        String getFragmentBases ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        String getFragmentQualities ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        int32_t getReferenceIndex ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        Alignment :: CigarOps getCigarOps ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* whole columns
+         *  size () entries each, contiguous for vector code; 0 for a column
+         *  that was not asked for. the strings of a record are bytes
+         *  [ offset, offset + size ) of getArena (), its CIGAR operations
+         *  entries [ offset, offset + size ) of getCigarArena ()
+         *  valid until the next fill of the batch
+         */
+        const int64_t * getAlignmentPositions () const
+            NGS_NOTHROW;
+        const uint64_t * getAlignmentLengths () const
+            NGS_NOTHROW;
+        const int32_t * getMappingQualities () const
+            NGS_NOTHROW;
+        const uint32_t * getAlignmentFlags () const      // NGS_AlignmentBatchFlags_* bits
+            NGS_NOTHROW;
+        const int32_t * getReferenceIndices () const
+            NGS_NOTHROW;
+        const NGS_AlignmentBatchString_v1 * getFragmentBasesSpans () const
+            NGS_NOTHROW;
+        const NGS_AlignmentBatchString_v1 * getFragmentQualitiesSpans () const
+            NGS_NOTHROW;
+        const NGS_AlignmentBatchString_v1 * getCigarSpans () const
+            NGS_NOTHROW;
+        const char * getArena () const
+            NGS_NOTHROW;
+        const uint32_t * getCigarArena () const
+            NGS_NOTHROW;
+
+    public:
+
+        // C++ support
+
+        /* "fields" is a mask of BatchField; a batch holds up to "capacity"
+           Alignments, as many as have strings that fit in "arenaSize" bytes
+           and CIGARs that fit in "cigarArenaSize" operations. the columns
+           and arenas are allocated here once, and reused by every fill */
+        AlignmentBatch ( uint32_t fields = allFields, uint32_t capacity = 1024, uint32_t arenaSize = 1024 * 1024,
+                         uint32_t cigarArenaSize = 64 * 1024 )
+            NGS_THROWS ( ErrorMsg );
+
+    private:
+
+        AlignmentBatch ( const AlignmentBatch & obj );
+        AlignmentBatch & operator = ( const AlignmentBatch & obj );
+
+        uint32_t Check ( uint32_t i, const void * column ) const
+            NGS_THROWS ( ErrorMsg );
+        String GetString ( uint32_t i, const NGS_AlignmentBatchString_v1 * column ) const
+            NGS_THROWS ( ErrorMsg );
+
+        friend class AlignmentIterator;
+        friend class arrow :: AlignmentStream;     // exports the columns as they are
+
+        NGS_AlignmentBatch_v1 batch;
+
+        std :: vector < int64_t > position;
+        std :: vector < uint64_t > length;
+        std :: vector < int32_t > map_qual;
+        std :: vector < uint32_t > flags;
+        std :: vector < NGS_AlignmentBatchString_v1 > ref_spec;
+        std :: vector < NGS_AlignmentBatchString_v1 > read_id;
+        std :: vector < NGS_AlignmentBatchString_v1 > bases;
+        std :: vector < NGS_AlignmentBatchString_v1 > qualities;
+        std :: vector < char > arena;
+        std :: vector < int32_t > ref_index;
+        std :: vector < NGS_AlignmentBatchString_v1 > cigar;
+        std :: vector < uint32_t > cigar_arena;
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_alignment_batch_
+#include <ngs/inl/AlignmentBatch.hpp>
+#endif
+
+#endif // _hpp_ngs_alignment_batch_
@@ -31,6 +31,10 @@
 #include <ngs/Alignment.hpp>
 #endif
 
+#ifndef _hpp_ngs_alignment_batch_
+#include <ngs/AlignmentBatch.hpp>
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -49,29 +53,95 @@ namespace ngs
          *  but could not be accessed.
          */
         bool nextAlignment ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* nextAlignmentBatch
+         *  fill "batch" with the columns of the next Alignments,
+         *  as many as it has room for
+         *  returns false if no more Alignments are available.
+         *  an iterator is read either with nextAlignment or
+         *  with nextAlignmentBatch, not with both.
+         */
+        bool nextAlignmentBatch ( AlignmentBatch & batch )
+            NGS_THROWS ( ErrorMsg );
+
+        /* fill
+         *  as nextAlignmentBatch, but with no more than "maxRecords"
+         *  of the next Alignments, for a caller whose vectors come in
+         *  a size of its own; the batch keeps its columns and arenas
+         *  returns the number of Alignments put in the batch,
+         *  0 if no more are available.
+         */
+        uint32_t fill ( AlignmentBatch & batch, uint32_t maxRecords )
+            NGS_THROWS ( ErrorMsg );
+
+        /* skipTo
+         *  advance to the next Alignment that ends after "refPos",
+         *  passing over those that end at or before it, as if the
+         *  iterator were a slice from "refPos" on. meant for the
+         *  Alignments of one Reference, e.g. a slice, which come in
+         *  order of position; an engine may seek ahead in its index
+         *  rather than read the Alignments it passes over.
+         *  returns false if no more Alignments are available.
+         */
+        bool skipTo ( int64_t refPos )
+            NGS_THROWS ( ErrorMsg );
+
+        /* getCursor
+         *  where the iterator is, as a short string of the engine's
+         *  own making, to be kept e.g. by a job that may be stopped
+         *  throws exception if the iterator can't be resumed
+         */
+        String getCursor () const
+            NGS_THROWS ( ErrorMsg );
+
+        /* resumeFrom
+         *  takes an iterator made just as the one "cursor" came from,
+         *  before it is first advanced, to where that one was; the next
+         *  nextAlignment returns the Alignment that followed the one
+         *  current when the cursor was taken
+         */
+        void resumeFrom ( const String & cursor )
+            NGS_THROWS ( ErrorMsg );
+
+        /* reposition
+         *  takes an iterator of a slice to another window of the same
+         *  Reference, as if it were made anew for it with the same
+         *  filters, but reusing what it holds, e.g. for tiling a
+         *  Reference with one iterator; the next nextAlignment returns
+         *  the first Alignment of the new window
+         *  throws exception if the iterator isn't of a slice
+         */
+        void reposition ( int64_t start, uint64_t length )
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         AlignmentIterator ( AlignmentRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         AlignmentIterator & operator = ( const AlignmentIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentIterator ( const AlignmentIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        AlignmentIterator ( AlignmentIterator && obj )
+            noexcept;
+        AlignmentIterator & operator = ( AlignmentIterator && obj )
+            noexcept;
+#endif
 
         ~ AlignmentIterator ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         Alignment & operator = ( const Alignment & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentIterator & operator = ( AlignmentRef ref )
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
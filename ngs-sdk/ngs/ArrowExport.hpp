@@ -0,0 +1,136 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_arrow_export_
+#define _hpp_ngs_arrow_export_
+
+#ifndef _hpp_ngs_alignment_iterator_
+#include <ngs/AlignmentIterator.hpp>
+#endif
+
+#include <stdint.h>
+
+/*--------------------------------------------------------------------------
+ * the Arrow C data and C stream interfaces
+ *  as given by the Arrow specification, which lets any Arrow
+ *  implementation take the data without linking to this one
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+    const char * format;
+    const char * name;
+    const char * metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema ** children;
+    struct ArrowSchema * dictionary;
+    void ( * release ) ( struct ArrowSchema * );
+    void * private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void ** buffers;
+    struct ArrowArray ** children;
+    struct ArrowArray * dictionary;
+    void ( * release ) ( struct ArrowArray * );
+    void * private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream
+{
+    int ( * get_schema ) ( struct ArrowArrayStream *, struct ArrowSchema * out );
+    int ( * get_next ) ( struct ArrowArrayStream *, struct ArrowArray * out );
+    const char * ( * get_last_error ) ( struct ArrowArrayStream * );
+    void ( * release ) ( struct ArrowArrayStream * );
+    void * private_data;
+};
+
+#endif /* ARROW_C_STREAM_INTERFACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+namespace ngs
+{
+    namespace arrow
+    {
+        /* exportAlignments
+         *  hands the Alignments of "it" to "out" as a stream of Arrow record
+         *  batches, each the Alignments of one AlignmentIterator ::
+         *  nextAlignmentBatch of up to "batchSize" rows, so an engine that
+         *  fills batches itself is read that way
+         *
+         *  "fields" is a mask of AlignmentBatch :: BatchField, and the
+         *  batches have these columns for those asked for, in this order:
+         *
+         *    alignmentPosition   position: int64, length: uint64
+         *    mappingQuality      mapping_quality: int32
+         *    alignmentFlags      is_primary, is_reversed, has_mate: bool
+         *    referenceSpec       reference_spec: dictionary < int32, utf8 >
+         *    readId              read_id: utf8
+         *    fragmentBases       fragment_bases: utf8
+         *    fragmentQualities   fragment_qualities: utf8, phred + 33
+         *
+         *  a reference spec keeps its index in the dictionary for the life
+         *  of the stream; each batch has the dictionary as it is so far
+         *
+         *  the stream holds its own reference to the iterator, which is
+         *  not to be advanced by others while the stream is in use. a
+         *  failure of the engine ends "get_next" with EIO, and the message
+         *  it threw is that of "get_last_error"
+         */
+        void exportAlignments ( const AlignmentIterator & it, struct ArrowArrayStream * out,
+                uint32_t fields = AlignmentBatch :: allFields, uint32_t batchSize = 65536 )
+            NGS_THROWS ( ErrorMsg );
+
+    } // namespace arrow
+
+} // namespace ngs
+
+#endif // _hpp_ngs_arrow_export_
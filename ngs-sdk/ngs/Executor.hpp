@@ -0,0 +1,185 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_executor_
+#define _hpp_ngs_executor_
+
+#ifndef _hpp_ngs_alignment_iterator_
+#include <ngs/AlignmentIterator.hpp>
+#endif
+
+#ifndef _hpp_ngs_read_iterator_
+#include <ngs/ReadIterator.hpp>
+#endif
+
+#ifndef _hpp_ngs_pileup_iterator_
+#include <ngs/PileupIterator.hpp>
+#endif
+
+namespace ngs
+{
+    class ExecutorQuery;
+    class ExecutorState;
+
+    /*======================================================================
+     * handlers
+     *  receive what a query submitted to an Executor produces
+     *  the calls for one query come in order from one thread at a time,
+     *  but not always the same thread; calls for different queries may
+     *  come concurrently
+     */
+
+    /* AlignmentHandler
+     */
+    class AlignmentHandler
+    {
+    public:
+
+        /* alignments
+         *  called with every batch of the query
+         *  returns false to end the query early
+         */
+        virtual bool alignments ( const AlignmentBatch & batch ) = 0;
+
+        /* finished
+         *  called once, last; "error" is empty if the query
+         *  ran to its end or was ended by the handler
+         */
+        virtual void finished ( const String & error )
+        {
+        }
+
+        virtual ~ AlignmentHandler ()
+        {
+        }
+    };
+
+    /* ReadHandler
+     */
+    class ReadHandler
+    {
+    public:
+
+        /* read
+         *  called with every Read of the query
+         *  returns false to end the query early
+         */
+        virtual bool read ( Read & read ) = 0;
+
+        /* finished
+         *  as for AlignmentHandler
+         */
+        virtual void finished ( const String & error )
+        {
+        }
+
+        virtual ~ ReadHandler ()
+        {
+        }
+    };
+
+    /* PileupHandler
+     */
+    class PileupHandler
+    {
+    public:
+
+        /* pileup
+         *  called with every Pileup of the query
+         *  returns false to end the query early
+         */
+        virtual bool pileup ( Pileup & pileup ) = 0;
+
+        /* finished
+         *  as for AlignmentHandler
+         */
+        virtual void finished ( const String & error )
+        {
+        }
+
+        virtual ~ PileupHandler ()
+        {
+        }
+    };
+
+    /*======================================================================
+     * Executor
+     *  a few threads that drive many iterators at once
+     *  a query is advanced one step at a time - a batch of Alignments,
+     *  or up to "step" Reads or Pileups - and then goes to the back of
+     *  the queue, so that no query holds a thread for long and a
+     *  thread blocked in one engine's I/O leaves the others to the rest
+     *  an iterator submitted belongs to the Executor until its handler
+     *  is finished, and must not be used meanwhile
+     */
+    class Executor
+    {
+    public:
+
+        /* submit
+         *  queues a query and returns at once
+         *  "handler" must outlive the query
+         */
+        void submit ( const AlignmentIterator & it, AlignmentHandler & handler,
+                uint32_t fields = AlignmentBatch :: allFields, uint32_t capacity = 1024, uint32_t arenaSize = 1024 * 1024 )
+            NGS_THROWS ( ErrorMsg );
+        void submit ( const ReadIterator & it, ReadHandler & handler, uint32_t step = 256 )
+            NGS_THROWS ( ErrorMsg );
+        void submit ( const PileupIterator & it, PileupHandler & handler, uint32_t step = 256 )
+            NGS_THROWS ( ErrorMsg );
+
+        /* wait
+         *  returns when every query submitted has finished
+         */
+        void wait ()
+            NGS_NOTHROW;
+
+    public:
+
+        /* starts "threads" threads, at least one
+         */
+        Executor ( uint32_t threads )
+            NGS_THROWS ( ErrorMsg );
+
+        /* waits for the queries, then stops the threads
+         */
+        ~ Executor ()
+            NGS_NOTHROW;
+
+    private:
+
+        Executor ( const Executor & obj );
+        Executor & operator = ( const Executor & obj );
+
+        void Submit ( ExecutorQuery * query )
+            NGS_THROWS ( ErrorMsg );
+
+        ExecutorState * state;
+    };
+
+} // namespace ngs
+
+#endif // _hpp_ngs_executor_
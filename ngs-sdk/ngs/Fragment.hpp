@@ -35,7 +35,12 @@
 #include <ngs/StringRef.hpp>
 #endif
 
+#ifndef _hpp_ngs_stringview_
+#include <ngs/StringView.hpp>
+#endif
+
 #include <stdint.h>
+#include <vector>
 
 namespace ngs
 {
@@ -59,7 +64,14 @@ namespace ngs
          *  representing a single biological fragment
          */
         StringRef getFragmentId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getFragmentIndex
+         *  the fragment's ordinal within its read, from 0: with
+         *  Read :: getReadRowId, a numeric key for the fragment
+         */
+        uint32_t getFragmentIndex () const
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -71,11 +83,11 @@ namespace ngs
          *  "offset" is zero-based
          */
         StringRef getFragmentBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getFragmentBases ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getFragmentBases ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* getFragmentQualities
@@ -84,45 +96,97 @@ namespace ngs
          *  "offset" is zero-based
          */
         StringRef getFragmentQualities () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getFragmentQualities ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getFragmentQualities ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+
+        /* getFragmentBasesView
+         * getFragmentQualitiesView
+         *  as above, but lent by the fragment rather than referenced:
+         *  valid until the next message to it or its iterator
+         */
+        StringView getFragmentBasesView () const
+            NGS_THROWS ( ErrorMsg );
+        StringView getFragmentBasesView ( uint64_t offset, uint64_t length ) const
+            NGS_THROWS ( ErrorMsg );
+        StringView getFragmentQualitiesView () const
+            NGS_THROWS ( ErrorMsg );
+        StringView getFragmentQualitiesView ( uint64_t offset, uint64_t length ) const
+            NGS_THROWS ( ErrorMsg );
+
+
+        /* PackedBases
+         *  bases as BAM packs them: two 4-bit codes to a byte, each an
+         *  index into "=ACMGRSVTWYHKDBN", the first base of a byte in its
+         *  high nibble; "phase" is 1 when the first of the "count" bases
+         *  is the low nibble of the first byte
+         */
+        struct PackedBases
+        {
+            const uint8_t * bases;
+            uint64_t count;
+            uint32_t phase;
+
+            uint8_t code ( uint64_t i ) const
+            { i += phase; return ( uint8_t ) ( ( bases [ i >> 1 ] >> ( ( i & 1 ) != 0 ? 0 : 4 ) ) & 15 ); }
+
+            char base ( uint64_t i ) const
+            { return "=ACMGRSVTWYHKDBN" [ code ( i ) ]; }
+        };
+
+        /* getFragmentBasesPacked
+         *  the bases of getFragmentBases, packed: lent by the engine where
+         *  it can, valid until the next message to the fragment; otherwise
+         *  packed from the bases into "buffer", which the returned bases
+         *  then point into, a base without a code as N
+         */
+        PackedBases getFragmentBasesPacked ( std :: vector < uint8_t > & buffer ) const
+            NGS_THROWS ( ErrorMsg );
+        PackedBases getFragmentBasesPacked ( uint64_t offset, uint64_t length, std :: vector < uint8_t > & buffer ) const
+            NGS_THROWS ( ErrorMsg );
 
 
         /* isPaired
          *  returns true if fragment has a mate
          */
         bool isPaired () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* isAligned
          *  returns true if fragment has alignment data
          */
         bool isAligned () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         Fragment ( FragmentRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         Fragment & operator = ( const Fragment & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         Fragment ( const Fragment & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        Fragment ( Fragment && obj )
+            noexcept;
+        Fragment & operator = ( Fragment && obj )
+            noexcept;
+#endif
 
         ~ Fragment ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         Fragment & operator = ( FragmentRef ref )
-            throw ();
+            NGS_NOTHROW;
 
     protected:
 
@@ -0,0 +1,118 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_multi_pileup_iterator_
+#define _hpp_ngs_multi_pileup_iterator_
+
+#ifndef _hpp_ngs_reference_
+#include <ngs/Reference.hpp>
+#endif
+
+#ifndef _hpp_ngs_pileup_column_
+#include <ngs/PileupColumn.hpp>
+#endif
+
+#include <vector>
+
+namespace ngs
+{
+    class MultiPileupSample;
+
+    /*======================================================================
+     * MultiPileupIterator
+     *  steps through the same window of several samples' Pileups at once,
+     *  e.g. of a tumor and its normal, one position at a time, with the
+     *  events of each sample there as a PileupColumn
+     *  the positions are those that at least one sample covers; a sample
+     *  that doesn't cover one has an empty column there
+     *  each sample's columns of the next positions are filled on the
+     *  shared WorkPool while those before them are used
+     */
+    class MultiPileupIterator
+    {
+    public:
+
+        /* nextPileup
+         *  advance to first position on initial invocation
+         *  advance to next position subsequently
+         *  returns false if no more positions are available.
+         *  throws what an engine threw once the positions
+         *  read before it have been used.
+         */
+        bool nextPileup ()
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReferencePosition
+         */
+        int64_t getReferencePosition () const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getSampleCount
+         *  the number of References it was made from
+         */
+        size_t getSampleCount () const
+            NGS_NOTHROW;
+
+        /* getColumn
+         *  the events of a sample at the current position, in the order of
+         *  the References it was made from; valid until the next nextPileup
+         */
+        const PileupColumn & getColumn ( size_t sample ) const
+            NGS_THROWS ( ErrorMsg );
+
+    public:
+
+        // C++ support
+
+        /* one Reference per sample, each of its own ReadCollection, as
+           from ReadCollection :: getReference; the window and filters are
+           as for Reference :: getFilteredPileupSlice, and "fields" is a
+           mask of PileupColumn :: ColumnField. up to "depth" batches of
+           positions per sample are filled ahead of the one in use */
+        MultiPileupIterator ( const std :: vector < Reference > & references,
+                int64_t start, uint64_t length, Alignment :: AlignmentCategory categories,
+                Alignment :: AlignmentFilter filters, int32_t mappingQuality,
+                uint32_t fields = PileupColumn :: allFields, uint32_t depth = 4 )
+            NGS_THROWS ( ErrorMsg );
+
+        ~ MultiPileupIterator ()
+            NGS_NOTHROW;
+
+    private:
+
+        MultiPileupIterator ( const MultiPileupIterator & obj );
+        MultiPileupIterator & operator = ( const MultiPileupIterator & obj );
+
+        std :: vector < MultiPileupSample * > samples;
+        PileupColumn empty;         // the column of a sample not covering it
+        int64_t position;
+        bool started;
+        bool done;
+    };
+
+} // namespace ngs
+
+#endif // _hpp_ngs_multi_pileup_iterator_
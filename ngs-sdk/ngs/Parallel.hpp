@@ -0,0 +1,154 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_parallel_
+#define _hpp_ngs_parallel_
+
+#ifndef _hpp_ngs_read_collection_
+#include <ngs/ReadCollection.hpp>
+#endif
+
+namespace ngs
+{
+    namespace parallel
+    {
+
+        /*==================================================================
+         * Window
+         *  one tile of a Reference, as handed to a SliceTask or PileupTask
+         */
+        struct Window
+        {
+            String reference;       // common name of the Reference
+            int64_t start;          // zero-based
+            uint64_t length;        // cut at the end of the Reference
+            uint64_t index;         // position of the window in collection order
+        };
+
+        /*==================================================================
+         * SliceTask
+         *  the work done for every window of forEachSlice
+         */
+        class SliceTask
+        {
+        public:
+
+            /* visit
+             *  called once per window, on any of the threads and
+             *  concurrently with other windows
+             *  "alignments" holds those that start within the window
+             */
+            virtual void visit ( const Window & window, AlignmentIterator & alignments ) = 0;
+
+            /* reduce
+             *  called once per window after it was visited, in window
+             *  order and never concurrently, so that results kept per
+             *  window can be combined in a deterministic order
+             */
+            virtual void reduce ( const Window & window )
+            {
+            }
+
+            virtual ~ SliceTask ()
+            {
+            }
+        };
+
+        /* forEachSlice
+         *  tiles every Reference of "collection" into windows of
+         *  "windowSize" bases and runs "task" over them on up to
+         *  "threads" threads: the calling one, and the rest of them
+         *  on the shared WorkPool, so that they take no more than its
+         *  threads, whatever else the process runs there
+         *
+         *  every thread starts with a run of consecutive windows and
+         *  steals half of the remaining run of another once its own is
+         *  done; a thread keeps the Reference of its last window
+         *
+         *  the slices are filtered with startWithinSlice in addition to
+         *  "filters", so an alignment is visited in one window only
+         *
+         *  throws the first error thrown by "task" or the engine, once
+         *  all threads have stopped
+         */
+        void forEachSlice ( const ReadCollection & collection, uint64_t windowSize, uint32_t threads, SliceTask & task,
+                Alignment :: AlignmentCategory categories = Alignment :: all,
+                Alignment :: AlignmentFilter filters = ( Alignment :: AlignmentFilter ) ( Alignment :: passFailed | Alignment :: passDuplicates ),
+                int32_t mappingQuality = 0 )
+            NGS_THROWS ( ErrorMsg );
+
+        /*==================================================================
+         * PileupTask
+         *  the work done for every window of forEachPileup
+         */
+        class PileupTask
+        {
+        public:
+
+            /* visit
+             *  called once per window, on any of the threads and
+             *  concurrently with other windows
+             *  "pileups" runs over the positions of the window, each
+             *  with all of the Alignments that cover it; those left when
+             *  visit returns are skipped
+             */
+            virtual void visit ( const Window & window, PileupIterator & pileups ) = 0;
+
+            /* reduce
+             *  as for SliceTask, in window order and never concurrently
+             */
+            virtual void reduce ( const Window & window )
+            {
+            }
+
+            virtual ~ PileupTask ()
+            {
+            }
+        };
+
+        /* forEachPileup
+         *  runs "task" over the Pileups of every window, as forEachSlice
+         *  does over their Alignments
+         *
+         *  a thread going on to the next window of its run extends the
+         *  slice of the last one, so an Alignment crossing the boundary
+         *  is read once per run rather than once per window; with an
+         *  engine that can't extend, each window gets its own slice
+         *
+         *  throws the first error thrown by "task" or the engine, once
+         *  all threads have stopped
+         */
+        void forEachPileup ( const ReadCollection & collection, uint64_t windowSize, uint32_t threads, PileupTask & task,
+                Alignment :: AlignmentCategory categories = Alignment :: all,
+                Alignment :: AlignmentFilter filters = ( Alignment :: AlignmentFilter ) ( Alignment :: passFailed | Alignment :: passDuplicates ),
+                int32_t mappingQuality = 0 )
+            NGS_THROWS ( ErrorMsg );
+
+    } // namespace parallel
+
+} // namespace ngs
+
+#endif // _hpp_ngs_parallel_
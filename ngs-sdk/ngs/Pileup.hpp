@@ -31,6 +31,14 @@
 #include <ngs/PileupEventIterator.hpp>
 #endif
 
+#ifndef _hpp_ngs_pileup_column_
+#include <ngs/PileupColumn.hpp>
+#endif
+
+#ifndef _hpp_ngs_pileup_base_counts_
+#include <ngs/PileupBaseCounts.hpp>
+#endif
+
 namespace ngs
 {
 
@@ -56,18 +64,18 @@ namespace ngs
         /* getReferenceSpec
          */
         String getReferenceSpec () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReferencePosition
          */
         int64_t getReferencePosition () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReferenceBase
          *  retrieves base at current Reference position
          */
         char getReferenceBase () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -79,24 +87,46 @@ namespace ngs
          *  at the current reference position
          */
         uint32_t getPileupDepth () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getColumn
+         *  fills "column" with every event at the current position
+         *  at once, growing it if need be, instead of a message per
+         *  event and field; iterating the events then starts over
+         */
+        void getColumn ( PileupColumn & column )
+            NGS_THROWS ( ErrorMsg );
+
+        /* getBaseCounts
+         *  counts the events at the current position by base and strand,
+         *  leaving out the bases with a quality below "minQuality";
+         *  iterating the events then starts over
+         */
+        void getBaseCounts ( int minQuality, PileupBaseCounts & counts )
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         Pileup & operator = ( PileupRef ref )
-            throw ();
+            NGS_NOTHROW;
         Pileup ( PileupRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         Pileup & operator = ( const Pileup & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         Pileup ( const Pileup & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        Pileup ( Pileup && obj )
+            noexcept;
+        Pileup & operator = ( Pileup && obj )
+            noexcept;
+#endif
 
         ~ Pileup ()
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
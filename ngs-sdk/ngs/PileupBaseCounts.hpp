@@ -0,0 +1,112 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_pileup_base_counts_
+#define _hpp_ngs_pileup_base_counts_
+
+#ifndef _hpp_ngs_error_msg_
+#include <ngs/ErrorMsg.hpp>
+#endif
+
+#ifndef _h_ngs_itf_pileupitf_
+#include <ngs/itf/PileupItf.h>
+#endif
+
+namespace ngs
+{
+    /*======================================================================
+     * PileupBaseCounts
+     *  the events of one Pileup position counted by what they show and
+     *  by strand, filled in by Pileup :: getBaseCounts
+     *  a match or mismatch counts as its base, anything but A, C, G or T
+     *  as N, unless its quality is below the one asked for; a deletion,
+     *  the skip of an intron included, counts as a deletion, and an event
+     *  with an insertion before it as an insertion too
+     */
+    class PileupBaseCounts
+    {
+    public:
+
+        /* BaseKind
+         */
+        enum BaseKind
+        {
+            baseA       = NGS_PileupBaseCount_A,
+            baseC       = NGS_PileupBaseCount_C,
+            baseG       = NGS_PileupBaseCount_G,
+            baseT       = NGS_PileupBaseCount_T,
+            baseN       = NGS_PileupBaseCount_N,
+            deletion    = NGS_PileupBaseCount_deletion,
+            insertion   = NGS_PileupBaseCount_insertion
+        };
+
+        /* Strand
+         *  of the alignments counted
+         */
+        enum Strand
+        {
+            plusStrand  = 1,
+            minusStrand = 2,
+            bothStrands = plusStrand | minusStrand
+        };
+
+        /* getReferencePosition
+         *  the position counted
+         */
+        int64_t getReferencePosition () const
+            NGS_NOTHROW;
+
+        /* getCount
+         */
+        uint32_t getCount ( BaseKind kind, Strand strands = bothStrands ) const
+            NGS_NOTHROW;
+
+    public:
+
+        // C++ support
+
+        PileupBaseCounts ()
+            NGS_NOTHROW;
+
+    private:
+
+        friend class Pileup;
+        friend class PileupIterator;
+
+        // the only member, so that an array of PileupBaseCounts
+        // is one of NGS_PileupBaseCounts_v1
+        NGS_PileupBaseCounts_v1 counts;
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_pileup_base_counts_
+#include <ngs/inl/PileupBaseCounts.hpp>
+#endif
+
+#endif // _hpp_ngs_pileup_base_counts_
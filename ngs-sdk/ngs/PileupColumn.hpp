@@ -0,0 +1,151 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_pileup_column_
+#define _hpp_ngs_pileup_column_
+
+#ifndef _hpp_ngs_error_msg_
+#include <ngs/ErrorMsg.hpp>
+#endif
+
+#ifndef _hpp_ngs_pileup_event_
+#include <ngs/PileupEvent.hpp>
+#endif
+
+#ifndef _hpp_ngs_stringview_
+#include <ngs/StringView.hpp>
+#endif
+
+#ifndef _h_ngs_itf_pileupitf_
+#include <ngs/itf/PileupItf.h>
+#endif
+
+#include <vector>
+
+namespace ngs
+{
+    /*======================================================================
+     * PileupColumn
+     *  the events of one Pileup position as columns, one per field,
+     *  filled in by Pileup :: getColumn; it grows to the depth it meets
+     */
+    class PileupColumn
+    {
+    public:
+
+        /* ColumnField
+         *  the columns to fill in
+         */
+        enum ColumnField
+        {
+            eventType           = NGS_PileupColumnFields_event_type,  // strand included
+            alignmentBase       = NGS_PileupColumnFields_base,
+            alignmentQuality    = NGS_PileupColumnFields_qual,
+            mappingQuality      = NGS_PileupColumnFields_map_qual,
+            insertionBases      = NGS_PileupColumnFields_ins_bases,
+            insertionQualities  = NGS_PileupColumnFields_ins_quals,
+            allFields           = 0x3F
+        };
+
+        /* size
+         *  the number of events in the column
+         */
+        uint32_t size () const
+            NGS_NOTHROW;
+
+        /* per-event fields
+         *  "i" is zero-based and less than size ()
+         *  throws if "i" is out of range or the column was not asked for
+         *  the insertions are valid until the column is filled again
+         */
+        PileupEvent :: PileupEventType getEventType ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        char getAlignmentBase ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        char getAlignmentQuality ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        int getMappingQuality ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        StringView getInsertionBases ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        StringView getInsertionQualities ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* whole columns
+         *  size () values each, or NULL if the column was not asked for
+         */
+        const uint32_t * getEventTypes () const
+            NGS_NOTHROW;
+        const char * getAlignmentBases () const
+            NGS_NOTHROW;
+        const char * getAlignmentQualities () const
+            NGS_NOTHROW;
+        const int32_t * getMappingQualities () const
+            NGS_NOTHROW;
+
+    public:
+
+        // C++ support
+
+        /* "fields" is a mask of ColumnField; room is made for "capacity"
+           events and "arenaSize" bytes of insertions to begin with */
+        PileupColumn ( uint32_t fields = allFields, uint32_t capacity = 256, uint32_t arenaSize = 4096 )
+            NGS_THROWS ( ErrorMsg );
+
+    private:
+
+        PileupColumn ( const PileupColumn & obj );
+        PileupColumn & operator = ( const PileupColumn & obj );
+
+        void Reserve ( uint32_t capacity, uint32_t arenaSize )
+            NGS_THROWS ( ErrorMsg );
+        uint32_t Check ( uint32_t i, const void * field ) const
+            NGS_THROWS ( ErrorMsg );
+        StringView GetString ( uint32_t i, const NGS_PileupColumnString_v1 * field ) const
+            NGS_THROWS ( ErrorMsg );
+
+        friend class Pileup;
+
+        NGS_PileupColumn_v1 column;
+
+        std :: vector < uint32_t > event_type;
+        std :: vector < char > base;
+        std :: vector < char > qual;
+        std :: vector < int32_t > map_qual;
+        std :: vector < NGS_PileupColumnString_v1 > ins_bases;
+        std :: vector < NGS_PileupColumnString_v1 > ins_quals;
+        std :: vector < char > arena;
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_pileup_column_
+#include <ngs/inl/PileupColumn.hpp>
+#endif
+
+#endif // _hpp_ngs_pileup_column_
@@ -50,29 +50,57 @@ namespace ngs
          *  but could not be accessed.
          */
         bool nextPileup ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* nextBaseCounts
+         *  advances as nextPileup does, then counts that position and up
+         *  to count - 1 after it into counts [ 0 .. count ), as
+         *  getBaseCounts does, leaving the iterator on the last counted
+         *  returns the number counted, fewer than "count" only at the end
+         */
+        uint32_t nextBaseCounts ( int minQuality, PileupBaseCounts * counts, uint32_t count )
+            NGS_THROWS ( ErrorMsg );
+
+        /* extendTo
+         *  moves the end of the window of a slice's Pileups out to
+         *  "newEnd", clipped to the Reference, so that nextPileup goes
+         *  on past the old end: the Alignments that cross it are kept
+         *  where they are, and only those starting at or after it are
+         *  read, e.g. for tiling a Reference with long Alignments
+         *  without walking each of them again for every tile
+         *  the window can't be made smaller.
+         *  throws exception if the iterator isn't of a slice
+         */
+        void extendTo ( int64_t newEnd )
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         PileupIterator ( PileupRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         PileupIterator & operator = ( const PileupIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupIterator ( const PileupIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        PileupIterator ( PileupIterator && obj )
+            noexcept;
+        PileupIterator & operator = ( PileupIterator && obj )
+            noexcept;
+#endif
 
         ~ PileupIterator ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         Pileup & operator = ( const Pileup & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupIterator & operator = ( PileupRef ref )
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
@@ -0,0 +1,124 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_prefetching_alignment_iterator_
+#define _hpp_ngs_prefetching_alignment_iterator_
+
+#ifndef _hpp_ngs_alignment_iterator_
+#include <ngs/AlignmentIterator.hpp>
+#endif
+
+namespace ngs
+{
+    class Prefetcher;
+
+    /*======================================================================
+     * PrefetchingAlignmentIterator
+     *  reads an AlignmentIterator of any engine ahead of its consumer:
+     *  work on the shared WorkPool fills AlignmentBatches with the columns
+     *  of the next Alignments while those before them are used, so that
+     *  the engine's I/O and decoding overlap the consumer's work
+     *  the AlignmentIterator it is made from belongs to that work
+     *  and must not be used while the PrefetchingAlignmentIterator exists
+     */
+    class PrefetchingAlignmentIterator
+    {
+    public:
+
+        /* nextAlignment
+         *  advance to first Alignment on initial invocation
+         *  advance to next Alignment subsequently
+         *  returns false if no more Alignments are available.
+         *  throws what the engine threw once the Alignments
+         *  read before it have been used.
+         */
+        bool nextAlignment ()
+            NGS_THROWS ( ErrorMsg );
+
+        /* columns of the current Alignment, as AlignmentBatch has them
+         *  throws if there is none or the column was not asked for
+         */
+        int64_t getAlignmentPosition () const
+            NGS_THROWS ( ErrorMsg );
+        uint64_t getAlignmentLength () const
+            NGS_THROWS ( ErrorMsg );
+        int getMappingQuality () const
+            NGS_THROWS ( ErrorMsg );
+        Alignment :: AlignmentCategory getAlignmentCategory () const
+            NGS_THROWS ( ErrorMsg );
+        bool getIsReversedOrientation () const
+            NGS_THROWS ( ErrorMsg );
+        bool hasMate () const
+            NGS_THROWS ( ErrorMsg );
+        String getReferenceSpec () const
+            NGS_THROWS ( ErrorMsg );
+        String getReadId () const
+            NGS_THROWS ( ErrorMsg );
+        String getFragmentBases () const
+            NGS_THROWS ( ErrorMsg );
+        String getFragmentQualities () const
+            NGS_THROWS ( ErrorMsg );
+
+    public:
+
+        // C++ support
+
+        /* "fields" is a mask of AlignmentBatch :: BatchField; up to "depth"
+           batches, each of "capacity" Alignments and "arenaSize" bytes,
+           are filled ahead of the one in use */
+        PrefetchingAlignmentIterator ( const AlignmentIterator & it,
+                uint32_t fields = AlignmentBatch :: allFields, uint32_t depth = 4,
+                uint32_t capacity = 1024, uint32_t arenaSize = 1024 * 1024 )
+            NGS_THROWS ( ErrorMsg );
+
+        ~ PrefetchingAlignmentIterator ()
+            NGS_NOTHROW;
+
+    private:
+
+        PrefetchingAlignmentIterator ( const PrefetchingAlignmentIterator & obj );
+        PrefetchingAlignmentIterator & operator = ( const PrefetchingAlignmentIterator & obj );
+
+        bool NextBatch ()
+            NGS_THROWS ( ErrorMsg );
+        const AlignmentBatch & Current () const
+            NGS_THROWS ( ErrorMsg );
+
+        AlignmentIterator it;
+        Prefetcher * prefetcher;
+        const AlignmentBatch * batch;   // the one in use, or NULL
+        uint32_t idx;                   // of the current Alignment in it
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_prefetching_alignment_iterator_
+#include <ngs/inl/PrefetchingAlignmentIterator.hpp>
+#endif
+
+#endif // _hpp_ngs_prefetching_alignment_iterator_
@@ -0,0 +1,148 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_prefetching_read_iterator_
+#define _hpp_ngs_prefetching_read_iterator_
+
+#ifndef _hpp_ngs_read_iterator_
+#include <ngs/ReadIterator.hpp>
+#endif
+
+namespace ngs
+{
+    class Prefetcher;
+
+    /*======================================================================
+     * PrefetchingReadIterator
+     *  reads a ReadIterator of any engine ahead of its consumer, as
+     *  PrefetchingAlignmentIterator does: work on the shared WorkPool
+     *  copies the next Reads while those before them are used
+     *  the ReadIterator it is made from belongs to that work
+     *  and must not be used while the PrefetchingReadIterator exists
+     */
+    class PrefetchingReadIterator
+    {
+    public:
+
+        /* ReadField
+         *  the strings to copy; the category and number of
+         *  fragments of every Read are always copied
+         */
+        enum ReadField
+        {
+            readId          = 1,
+            readName        = 2,
+            readGroup       = 4,
+            readBases       = 8,
+            readQualities   = 16,
+            allFields       = 31
+        };
+
+        /* nextRead
+         *  advance to first Read on initial invocation
+         *  advance to next Read subsequently
+         *  returns false if no more Reads are available.
+         *  throws what the engine threw once the Reads
+         *  read before it have been used.
+         */
+        bool nextRead ()
+            NGS_THROWS ( ErrorMsg );
+
+        /* the current Read, as Read has it
+         *  the strings are valid until the next call to nextRead
+         *  throws if there is none or the string was not asked for
+         */
+        const String & getReadId () const
+            NGS_THROWS ( ErrorMsg );
+        uint32_t getNumFragments () const
+            NGS_THROWS ( ErrorMsg );
+        Read :: ReadCategory getReadCategory () const
+            NGS_THROWS ( ErrorMsg );
+        const String & getReadGroup () const
+            NGS_THROWS ( ErrorMsg );
+        const String & getReadName () const
+            NGS_THROWS ( ErrorMsg );
+        const String & getReadBases () const
+            NGS_THROWS ( ErrorMsg );
+        const String & getReadQualities () const
+            NGS_THROWS ( ErrorMsg );
+
+    public:
+
+        // C++ support
+
+        /* "fields" is a mask of ReadField; up to "depth" batches
+           of "capacity" Reads are filled ahead of the one in use */
+        PrefetchingReadIterator ( const ReadIterator & it,
+                uint32_t fields = allFields, uint32_t depth = 4, uint32_t capacity = 1024 )
+            NGS_THROWS ( ErrorMsg );
+
+        ~ PrefetchingReadIterator ()
+            NGS_NOTHROW;
+
+        /* Snapshot
+         *  what is copied of a Read
+         */
+        struct Snapshot
+        {
+            String id;
+            String name;
+            String group;
+            String bases;
+            String qualities;
+            Read :: ReadCategory category;
+            uint32_t fragments;
+        };
+
+    private:
+
+        PrefetchingReadIterator ( const PrefetchingReadIterator & obj );
+        PrefetchingReadIterator & operator = ( const PrefetchingReadIterator & obj );
+
+        bool NextBatch ()
+            NGS_THROWS ( ErrorMsg );
+        const Snapshot & Current () const
+            NGS_THROWS ( ErrorMsg );
+        const String & Field ( const String & value, ReadField field ) const
+            NGS_THROWS ( ErrorMsg );
+
+        ReadIterator it;
+        uint32_t fields;
+        Prefetcher * prefetcher;
+        const Snapshot * current;       // of the batch in use, or NULL
+        const Snapshot * end;
+        bool ended;                     // "it" has no more Reads
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_prefetching_read_iterator_
+#include <ngs/inl/PrefetchingReadIterator.hpp>
+#endif
+
+#endif // _hpp_ngs_prefetching_read_iterator_
@@ -0,0 +1,376 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_projected_alignment_iterator_
+#define _hpp_ngs_projected_alignment_iterator_
+
+#ifndef _hpp_ngs_alignment_iterator_
+#include <ngs/AlignmentIterator.hpp>
+#endif
+
+#include <vector>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * Projection
+     *  the fields a ProjectedAlignmentIterator can be made to fetch
+     *  each holds the value of one field of the current Alignment and
+     *  answers the message of Alignment that it stands for; the values
+     *  it lends are valid until the next nextAlignment
+     *  "cores" counts the fields that Alignment :: getCore also answers
+     */
+    namespace Projection
+    {
+        /* None
+         *  fetches nothing; fills the unused places of the list
+         */
+        class None
+        {
+        public:
+            enum { cores = 0 };
+
+        protected:
+            void Fetch ( const Alignment &, const Alignment :: Core * )
+            {
+            }
+        };
+
+        class Position
+        {
+        public:
+            enum { cores = 1 };
+
+            int64_t getAlignmentPosition () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            { value = core != 0 ? core -> alignmentPosition : align . getAlignmentPosition (); }
+
+        private:
+            int64_t value;
+        };
+
+        class Length
+        {
+        public:
+            enum { cores = 1 };
+
+            uint64_t getAlignmentLength () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            { value = core != 0 ? core -> alignmentLength : align . getAlignmentLength (); }
+
+        private:
+            uint64_t value;
+        };
+
+        class TemplateLength
+        {
+        public:
+            enum { cores = 1 };
+
+            uint64_t getTemplateLength () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            { value = core != 0 ? core -> templateLength : align . getTemplateLength (); }
+
+        private:
+            uint64_t value;
+        };
+
+        class MapQ
+        {
+        public:
+            enum { cores = 1 };
+
+            int getMappingQuality () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            { value = core != 0 ? core -> mappingQuality : align . getMappingQuality (); }
+
+        private:
+            int value;
+        };
+
+        class Category
+        {
+        public:
+            enum { cores = 1 };
+
+            Alignment :: AlignmentCategory getAlignmentCategory () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            {
+                if ( core == 0 )
+                    value = align . getAlignmentCategory ();
+                else
+                    value = core -> primary ? Alignment :: primaryAlignment : Alignment :: secondaryAlignment;
+            }
+
+        private:
+            Alignment :: AlignmentCategory value;
+        };
+
+        class Orientation
+        {
+        public:
+            enum { cores = 1 };
+
+            bool getIsReversedOrientation () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            { value = core != 0 ? core -> reversedOrientation : align . getIsReversedOrientation (); }
+
+        private:
+            bool value;
+        };
+
+        class Mate
+        {
+        public:
+            enum { cores = 1 };
+
+            bool hasMate () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            { value = core != 0 ? core -> mate : align . hasMate (); }
+
+        private:
+            bool value;
+        };
+
+        /* Cigar
+         *  as Alignment :: getCigarOps, the buffer it may need kept here
+         */
+        class Cigar
+        {
+        public:
+            enum { cores = 0 };
+
+            Alignment :: CigarOps getCigarOps () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * )
+                NGS_THROWS ( ErrorMsg )
+            { value = align . getCigarOps ( buffer ); }
+
+        private:
+            Alignment :: CigarOps value;
+            std :: vector < uint32_t > buffer;
+        };
+
+        class Bases
+        {
+        public:
+            enum { cores = 0 };
+
+            const StringView & getFragmentBases () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * )
+                NGS_THROWS ( ErrorMsg )
+            { value = align . getFragmentBasesView (); }
+
+        private:
+            StringView value;
+        };
+
+        class Qualities
+        {
+        public:
+            enum { cores = 0 };
+
+            const StringView & getFragmentQualities () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * )
+                NGS_THROWS ( ErrorMsg )
+            { value = align . getFragmentQualitiesView (); }
+
+        private:
+            StringView value;
+        };
+
+        class ReferenceSpec
+        {
+        public:
+            enum { cores = 0 };
+
+            const StringView & getReferenceSpec () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * )
+                NGS_THROWS ( ErrorMsg )
+            { value = align . getReferenceSpecView (); }
+
+        private:
+            StringView value;
+        };
+
+        class ReadId
+        {
+        public:
+            enum { cores = 0 };
+
+            const StringView & getReadId () const
+                NGS_NOTHROW
+            { return value; }
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * )
+                NGS_THROWS ( ErrorMsg )
+            { value = align . getReadIdView (); }
+
+        private:
+            StringView value;
+        };
+
+        /* Link
+         *  one field of the list and the fields after it
+         */
+        template < class F, class Rest >
+        class Link : public F, public Rest
+        {
+        public:
+            enum { cores = F :: cores + Rest :: cores };
+
+        protected:
+            void Fetch ( const Alignment & align, const Alignment :: Core * core )
+                NGS_THROWS ( ErrorMsg )
+            {
+                F :: Fetch ( align, core );
+                Rest :: Fetch ( align, core );
+            }
+        };
+
+        template < class Rest >
+        class Link < None, Rest > : public Rest
+        {
+        };
+
+    } // namespace Projection
+
+    /*======================================================================
+     * ProjectedAlignmentIterator
+     *  reads an AlignmentIterator, fetching only the fields named by its
+     *  arguments, up to eight of the classes in Projection, on each
+     *  nextAlignment. it then answers the messages of those fields, and
+     *  no others, from what it fetched, e.g.
+     *
+     *    ProjectedAlignmentIterator < Projection :: Position,
+     *        Projection :: MapQ, Projection :: Cigar > it ( iter );
+     *    while ( it . nextAlignment () )
+     *        use ( it . getAlignmentPosition (), it . getCigarOps () );
+     *
+     *  with more than one of the fields Alignment :: getCore answers,
+     *  those are fetched in its single message
+     *  the AlignmentIterator it is made from is to be advanced only by it
+     */
+    template < class F1,
+               class F2 = Projection :: None, class F3 = Projection :: None,
+               class F4 = Projection :: None, class F5 = Projection :: None,
+               class F6 = Projection :: None, class F7 = Projection :: None,
+               class F8 = Projection :: None >
+    class ProjectedAlignmentIterator
+        : public Projection :: Link < F1, Projection :: Link < F2,
+                 Projection :: Link < F3, Projection :: Link < F4,
+                 Projection :: Link < F5, Projection :: Link < F6,
+                 Projection :: Link < F7, Projection :: Link < F8,
+                 Projection :: None > > > > > > > >
+    {
+    public:
+
+        /* nextAlignment
+         *  advance to first Alignment on initial invocation
+         *  advance to next Alignment subsequently, fetching its fields
+         *  returns false if no more Alignments are available.
+         */
+        bool nextAlignment ()
+            NGS_THROWS ( ErrorMsg );
+
+    public:
+
+        // C++ support
+
+        ProjectedAlignmentIterator ( const AlignmentIterator & it )
+            NGS_THROWS ( ErrorMsg );
+
+    private:
+
+        typedef Projection :: Link < F1, Projection :: Link < F2,
+                Projection :: Link < F3, Projection :: Link < F4,
+                Projection :: Link < F5, Projection :: Link < F6,
+                Projection :: Link < F7, Projection :: Link < F8,
+                Projection :: None > > > > > > > > Fields;
+
+        AlignmentIterator it;
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_projected_alignment_iterator_
+#include <ngs/inl/ProjectedAlignmentIterator.hpp>
+#endif
+
+#endif // _hpp_ngs_projected_alignment_iterator_
@@ -52,19 +52,27 @@ namespace ngs
         /* getReadId
          */
         StringRef getReadId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReadRowId
+         *  the number that ends getReadId, e.g. the row of an SRA read or
+         *  the file offset of a BAM one: a key without the string, unique
+         *  within the ReadCollection as the ID is
+         */
+        uint64_t getReadRowId () const
+            NGS_THROWS ( ErrorMsg );
 
         /* getNumFragments
          *  the number of biological Fragments contained in the read
          */
         uint32_t getNumFragments () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* fragmentIsAligned
          *  tests a fragment for being aligned
          */
         bool fragmentIsAligned ( uint32_t fragIdx ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
             
         /*------------------------------------------------------------------
          * read details
@@ -84,17 +92,17 @@ namespace ngs
         /* getReadCategory
          */
         ReadCategory getReadCategory () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReadGroup
          */
         String getReadGroup () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReadName
          */
         StringRef getReadName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* getReadBases
@@ -102,11 +110,11 @@ namespace ngs
          *  "offset" is zero-based
          */
         StringRef getReadBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getReadBases ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getReadBases ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* getReadQualities
@@ -115,31 +123,37 @@ namespace ngs
          *  "offset" is zero-based
          */
         StringRef getReadQualities () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getReadQualities ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getReadQualities ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         Read ( ReadRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         Read & operator = ( const Read & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         Read ( const Read & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        Read ( Read && obj )
+            noexcept;
+        Read & operator = ( Read && obj )
+            noexcept;
+#endif
 
         ~ Read ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         Read & operator = ( ReadRef ref )
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
@@ -39,6 +39,14 @@
 #include <ngs/AlignmentIterator.hpp>
 #endif
 
+#ifndef _hpp_ngs_statistics_
+#include <ngs/Statistics.hpp>
+#endif
+
+#ifndef _hpp_ngs_reference_table_
+#include <ngs/ReferenceTable.hpp>
+#endif
+
 namespace ngs
 {
 
@@ -68,7 +76,7 @@ namespace ngs
          *  a canonical name (e.g. ".sra"), they will be removed.
          */
         String getName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -79,18 +87,18 @@ namespace ngs
          *  returns an iterator of all ReadGroups used
          */
         ReadGroupIterator getReadGroups () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* hasReadGroup
          *  returns true if a call to "getReadGroup()" should succeed
          */
         bool hasReadGroup ( const String & spec ) const
-            throw ();
+            NGS_NOTHROW;
 
         /* getReadGroup
          */
         ReadGroup getReadGroup ( const String & spec ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -102,18 +110,18 @@ namespace ngs
          *  iterator will be empty if no Reads are aligned
          */
         ReferenceIterator getReferences () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* hasReference
          *  returns true if a call to "getReference()" should succeed
          */
         bool hasReference ( const String & spec ) const
-            throw ();
+            NGS_NOTHROW;
 
         /* getReference
          */
         Reference getReference ( const String & spec ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -125,22 +133,22 @@ namespace ngs
          *  throws ErrorMsg if Alignment does not exist
          */
         Alignment getAlignment ( const String & alignmentId ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignments
          *  returns an iterator of all Alignments from specified categories
          */
         AlignmentIterator getAlignments ( Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignmentCount
          *  returns count of all alignments
          *  "categories" provides a means of filtering by AlignmentCategory
          */
         uint64_t getAlignmentCount () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAlignmentCount ( Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignmentRange
          *  returns an iterator across a range of Alignments
@@ -148,9 +156,20 @@ namespace ngs
          *  "categories" provides a means of filtering by AlignmentCategory
          */
         AlignmentIterator getAlignmentRange ( uint64_t first, uint64_t count ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentIterator getAlignmentRange ( uint64_t first, uint64_t count, Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getAlignmentShard
+         *  returns an iterator across one of "count" shards of the set,
+         *  for reading it in parallel
+         *  "shard" is 0-based and less than "count"
+         *  the shards don't overlap and together cover every Alignment;
+         *  engines size them by the amount of data to be read where they can
+         *  "categories" provides a means of filtering by AlignmentCategory
+         */
+        AlignmentIterator getAlignmentShard ( uint32_t shard, uint32_t count, Alignment :: AlignmentCategory categories ) const
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -162,23 +181,23 @@ namespace ngs
          *  throws ErrorMsg if Read does not exist
          */
         Read getRead ( const String & readId ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReads
          *  returns an iterator of all contained machine Reads
          *  "categories" provides a means of filtering by ReadCategory
          */
         ReadIterator getReads ( Read :: ReadCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReadCount
          *  returns the number of reads in the collection
          *  "categories" provides an optional means of filtering by ReadCategory
          */
         uint64_t getReadCount () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getReadCount ( Read :: ReadCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReadRange
          *  returns an iterator across a range of Reads
@@ -186,26 +205,85 @@ namespace ngs
          *  "categories" provides an optional means of filtering by ReadCategory
          */
         ReadIterator getReadRange ( uint64_t first, uint64_t count ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadIterator getReadRange ( uint64_t first, uint64_t count, Read :: ReadCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+
+        /*------------------------------------------------------------------
+         * FEATURES
+         */
+
+        /* Feature
+         *  groups of messages an engine may answer; a cleared bit
+         *  means they would only throw
+         */
+        enum Feature
+        {
+            readGroupsFeature       = 0x001,    // getReadGroups, getReadGroup
+            referencesFeature       = 0x002,    // getReferences, getReference
+            alignmentByIdFeature    = 0x004,
+            alignmentsFeature       = 0x008,
+            alignmentCountFeature   = 0x010,
+            alignmentRangeFeature   = 0x020,
+            alignmentShardFeature   = 0x040,
+            readByIdFeature         = 0x080,
+            readsFeature            = 0x100     // getReads, getReadCount, getReadRange
+        };
+
+        /* supports
+         *  returns true if the engine answers the messages of "feature",
+         *  so work can be routed without probing for ErrorMsg
+         */
+        bool supports ( Feature feature ) const
+            NGS_THROWS ( ErrorMsg );
+
+
+        /*------------------------------------------------------------------
+         * STATISTICS
+         */
+
+        /* getStatistics
+         *  returns counters the engine keeps about the collection,
+         *  e.g. how much of the underlying file has been read
+         *  throws ErrorMsg if the engine keeps none
+         */
+        Statistics getStatistics () const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReferenceTable
+         *  the names and lengths of every Reference at once, in the order
+         *  of getReferences, for building a map of a long list of contigs
+         *  the second form fills in the columns "table" was made for,
+         *  reusing its allocation
+         */
+        ReferenceTable getReferenceTable () const
+            NGS_THROWS ( ErrorMsg );
+        void getReferenceTable ( ReferenceTable & table ) const
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         ReadCollection & operator = ( ReadCollectionRef ref )
-            throw ();
+            NGS_NOTHROW;
         ReadCollection ( ReadCollectionRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         ReadCollection & operator = ( const ReadCollection & obj )
-            throw ();
+            NGS_NOTHROW;
         ReadCollection ( const ReadCollection & obj )
-            throw ();
+            NGS_NOTHROW;
+#if NGS_HAVE_MOVE
+        ReadCollection ( ReadCollection && obj )
+            noexcept;
+        ReadCollection & operator = ( ReadCollection && obj )
+            noexcept;
+#endif
 
         ~ ReadCollection ()
-            throw ();
+            NGS_NOTHROW;
 
     protected:
 
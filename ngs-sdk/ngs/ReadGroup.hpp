@@ -56,7 +56,7 @@ namespace ngs
          *  returns the simple name of the read group
          */
         String getName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -64,24 +64,30 @@ namespace ngs
          */
 		 
 		Statistics getStatistics () const 
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         ReadGroup & operator = ( ReadGroupRef ref )
-            throw ();
+            NGS_NOTHROW;
         ReadGroup ( ReadGroupRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         ReadGroup & operator = ( const ReadGroup & obj )
-            throw ();
+            NGS_NOTHROW;
         ReadGroup ( const ReadGroup & obj )
-            throw ();
+            NGS_NOTHROW;
+#if NGS_HAVE_MOVE
+        ReadGroup ( ReadGroup && obj )
+            noexcept;
+        ReadGroup & operator = ( ReadGroup && obj )
+            noexcept;
+#endif
 
         ~ ReadGroup ()
-            throw ();
+            NGS_NOTHROW;
 
     protected:
 
@@ -49,29 +49,35 @@ namespace ngs
          *  but could not be accessed.
          */
         bool nextReadGroup ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         ReadGroupIterator ( ReadGroupRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         ReadGroupIterator & operator = ( const ReadGroupIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadGroupIterator ( const ReadGroupIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        ReadGroupIterator ( ReadGroupIterator && obj )
+            noexcept;
+        ReadGroupIterator & operator = ( ReadGroupIterator && obj )
+            noexcept;
+#endif
 
         ~ ReadGroupIterator ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         ReadGroup & operator = ( const ReadGroup & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadGroupIterator & operator = ( ReadGroupRef ref )
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
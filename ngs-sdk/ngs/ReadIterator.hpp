@@ -49,29 +49,52 @@ namespace ngs
          *  but could not be accessed.
          */
         bool nextRead ()
-            throw ( ErrorMsg );
-            
+            NGS_THROWS ( ErrorMsg );
+
+        /* getCursor
+         *  where the iterator is, as a short string of the engine's
+         *  own making, to be kept e.g. by a job that may be stopped
+         *  throws exception if the iterator can't be resumed
+         */
+        String getCursor () const
+            NGS_THROWS ( ErrorMsg );
+
+        /* resumeFrom
+         *  takes an iterator made just as the one "cursor" came from,
+         *  before it is first advanced, to where that one was; the next
+         *  nextRead returns the Read that followed the one current
+         *  when the cursor was taken
+         */
+        void resumeFrom ( const String & cursor )
+            NGS_THROWS ( ErrorMsg );
+
     public:
 
         // C++ support
 
         ReadIterator ( ReadRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         ReadIterator & operator = ( const ReadIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadIterator ( const ReadIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        ReadIterator ( ReadIterator && obj )
+            noexcept;
+        ReadIterator & operator = ( ReadIterator && obj )
+            noexcept;
+#endif
 
         ~ ReadIterator ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         Read & operator = ( const Read & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadIterator & operator = ( ReadRef ref )
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
@@ -35,6 +35,8 @@
 #include <ngs/PileupIterator.hpp>
 #endif
 
+#include <vector>
+
 namespace ngs
 {
 
@@ -56,27 +58,27 @@ namespace ngs
          *  returns the common name of reference, e.g. "chr1"
          */
         String getCommonName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getCanonicalName
          *  returns the accessioned name of reference, e.g. "NC_000001.11"
          */
         String getCanonicalName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* getIsCircular
          *  returns true if reference is circular
          */
         bool getIsCircular () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* getLength
          *  returns the length of the reference sequence
          */
         uint64_t getLength () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
 
         /* getReferenceBases
@@ -84,9 +86,9 @@ namespace ngs
          *  "offset" is zero-based
          */
         String getReferenceBases ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         String getReferenceBases ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getReferenceChunk
          *  return largest contiguous chunk available of
@@ -97,9 +99,33 @@ namespace ngs
          *  than requested.
          */
         StringRef getReferenceChunk ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringRef getReferenceChunk ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* copyReferenceBases
+         *  copies up to "size" bases from "offset" into "buffer",
+         *  without a String for each chunk
+         *  returns the number copied, fewer than "size" only at the
+         *  end of the Reference, and 0 from an "offset" at or past it
+         */
+        uint64_t copyReferenceBases ( uint64_t offset, char * buffer, uint64_t size ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* getReferenceBasesPacked
+         *  packs up to "length" bases from "offset" into "bases", four to
+         *  a byte as A = 0, C = 1, G = 2 and T = 3, the first base in the
+         *  low bits, for ( length + 3 ) / 4 bytes
+         *  any other base, as N, is packed as 0 and has its bit set in
+         *  "nMask", eight to a byte, the first base in the low bit, for
+         *  ( length + 7 ) / 8 bytes, unless "nMask" is NULL
+         *  the case of the bases is ignored
+         *  returns the number packed, as for copyReferenceBases
+         *  engines that don't pack them themselves have them packed
+         *  from copied ones
+         */
+        uint64_t getReferenceBasesPacked ( uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * nMask = 0 ) const
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -111,9 +137,24 @@ namespace ngs
          *  "categories" provides a means of filtering by AlignmentCategory
          */
         uint64_t getAlignmentCount () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAlignmentCount ( Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* estimateSlice
+         *  about how many alignments overlap a slice and how many bytes
+         *  of the compressed file hold them, for sizing parallel work
+         *  engines answer from an index, without reading the alignments;
+         *  those that can't have the count of all alignments scaled to
+         *  the slice, and 0 bytes, which means the size is unknown
+         */
+        struct SliceEstimate
+        {
+            uint64_t alignments;
+            uint64_t bytes;
+        };
+        SliceEstimate estimateSlice ( int64_t start, uint64_t length ) const
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignment
          *  returns an individual Alignment
@@ -121,13 +162,13 @@ namespace ngs
          *  or is not part of this Reference
          */
         Alignment getAlignment ( const String & alignmentId ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignments
          *  returns an iterator of contained alignments
          */
         AlignmentIterator getAlignments ( Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getAlignmentSlice
          *  returns an iterator across a slice of the Reference
@@ -141,9 +182,9 @@ namespace ngs
          *  "categories" provides a means of filtering by AlignmentCategory
          */
         AlignmentIterator getAlignmentSlice ( int64_t start, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentIterator getAlignmentSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getFilteredAlignmentSlice
          *  returns a filtered iterator across a slice of the Reference
@@ -153,7 +194,18 @@ namespace ngs
          */
         AlignmentIterator getFilteredAlignmentSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories,
                 Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* getAlignmentShard
+         *  returns an iterator across one of "count" shards of the
+         *  Alignments of the Reference, for reading it in parallel
+         *  "shard" is 0-based and less than "count"
+         *  the shards don't overlap and together cover every Alignment;
+         *  engines size them by the amount of data to be read where they can
+         *  "categories" provides a means of filtering by AlignmentCategory
+         */
+        AlignmentIterator getAlignmentShard ( uint32_t shard, uint32_t count, Alignment :: AlignmentCategory categories ) const
+            NGS_THROWS ( ErrorMsg );
 
 
         /*------------------------------------------------------------------
@@ -166,7 +218,7 @@ namespace ngs
          *  No mapping qualities are taken into account.
          */
         PileupIterator getPileups ( Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getFilteredPileups
          *  returns an iterator of contained Pileups
@@ -176,7 +228,7 @@ namespace ngs
          */
         PileupIterator getFilteredPileups ( Alignment :: AlignmentCategory categories,
                 Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getPileupSlice
          *  creates a PileupIterator on a slice (window) of reference
@@ -185,9 +237,9 @@ namespace ngs
          *  "categories" provides a means of filtering by AlignmentCategory
          */
         PileupIterator getPileupSlice ( int64_t start, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupIterator getPileupSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* getFilteredPileupSlice
          *  creates a PileupIterator on a slice (window) of reference
@@ -197,24 +249,92 @@ namespace ngs
          */
         PileupIterator getFilteredPileupSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories,
                 Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /*  "maxDepth", if not 0, caps the depth of each Pileup: the alignments
+         *  that start at a position are sampled down, as they enter the pileup,
+         *  to the room left by those still covering it, so that no events are
+         *  made for the rest; an alignment once taken is kept to its end
+         *  "seed" chooses the sample, the same seed the same alignments
+         *  "skipEmpty" leaves out the positions that no alignment covers
+         *  throws ErrorMsg if the engine can't, when either is asked for
+         */
+        PileupIterator getFilteredPileupSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories,
+                Alignment :: AlignmentFilter filters, int32_t mappingQuality,
+                uint32_t maxDepth, uint64_t seed = 0, bool skipEmpty = false ) const
+            NGS_THROWS ( ErrorMsg );
+
+
+        /*------------------------------------------------------------------
+         * COVERAGE
+         */
+
+        /* getCoverage
+         *  returns the depth at each position of a window of the reference:
+         *  the number of alignments that cover it with an M, D, = or X
+         *  operation, so that the skip of an intron doesn't count
+         *  "start" is the 0-based starting position, not before the reference;
+         *  the window is truncated to the end of the reference
+         *  "categories", "filters" and "mappingQuality" choose the alignments
+         *  as for getFilteredAlignmentSlice
+         *  engines that don't count it themselves have it counted
+         *  from the slice's CIGARs
+         */
+        std :: vector < uint32_t > getCoverage ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories,
+                Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
+            NGS_THROWS ( ErrorMsg );
+
+
+        /*------------------------------------------------------------------
+         * FEATURES
+         */
+
+        /* Feature
+         *  groups of messages an engine may answer; a cleared bit
+         *  means they would only throw
+         */
+        enum Feature
+        {
+            canonicalNameFeature    = 0x01,
+            circularityFeature      = 0x02,     // getIsCircular
+            basesFeature            = 0x04,     // getReferenceBases, getReferenceChunk
+            alignmentByIdFeature    = 0x08,
+            alignmentsFeature       = 0x10,     // whole, sliced and filtered
+            alignmentCountFeature   = 0x20,
+            alignmentShardFeature   = 0x40,
+            pileupsFeature          = 0x80      // whole, sliced and filtered
+        };
+
+        /* supports
+         *  returns true if the engine answers the messages of "feature"
+         *  for this Reference; an iterator may answer differently
+         *  as it moves from one Reference to the next
+         */
+        bool supports ( Feature feature ) const
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         Reference & operator = ( ReferenceRef ref )
-            throw ();
+            NGS_NOTHROW;
         Reference ( ReferenceRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         Reference & operator = ( const Reference & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         Reference ( const Reference & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        Reference ( Reference && obj )
+            noexcept;
+        Reference & operator = ( Reference && obj )
+            noexcept;
+#endif
 
         ~ Reference ()
-            throw ();
+            NGS_NOTHROW;
 
     protected:
 
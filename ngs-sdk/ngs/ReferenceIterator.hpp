@@ -49,29 +49,35 @@ namespace ngs
          *  but could not be accessed.
          */
         bool nextReference ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
     public:
 
         // C++ support
 
         ReferenceIterator ( ReferenceRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         ReferenceIterator & operator = ( const ReferenceIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReferenceIterator ( const ReferenceIterator & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        ReferenceIterator ( ReferenceIterator && obj )
+            noexcept;
+        ReferenceIterator & operator = ( ReferenceIterator && obj )
+            noexcept;
+#endif
 
         ~ ReferenceIterator ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
         Reference & operator = ( const Reference & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReferenceIterator & operator = ( ReferenceRef ref )
-            throw ();
+            NGS_NOTHROW;
     };
 
 } // namespace ngs
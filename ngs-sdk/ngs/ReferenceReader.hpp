@@ -0,0 +1,95 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _hpp_ngs_reference_reader_
+#define _hpp_ngs_reference_reader_
+
+#ifndef _hpp_ngs_reference_
+#include <ngs/Reference.hpp>
+#endif
+
+namespace ngs
+{
+    /*======================================================================
+     * ReferenceReader
+     *  reads the bases of a Reference from start to end into a buffer
+     *  of the caller's, e.g.
+     *
+     *    ReferenceReader reader ( ref );
+     *    while ( ( n = reader . read ( buffer, sizeof buffer ) ) != 0 )
+     *        use ( buffer, n );
+     *
+     *  an engine that sees the bases asked for in order may read ahead
+     *  of them; a ReferenceIterator it is made from is not to be
+     *  advanced while it reads
+     */
+    class ReferenceReader
+    {
+    public:
+
+        /* read
+         *  copies up to "size" bases from the current offset into
+         *  "buffer" and moves past them
+         *  returns the number copied, 0 at the end of the Reference
+         */
+        uint64_t read ( char * buffer, uint64_t size )
+            NGS_THROWS ( ErrorMsg );
+
+        /* getOffset
+         *  the 0-based offset of the next base to be read
+         */
+        uint64_t getOffset () const
+            NGS_NOTHROW;
+
+        /* seek
+         *  moves to "offset" for the next read
+         */
+        void seek ( uint64_t offset )
+            NGS_NOTHROW;
+
+    public:
+
+        // C++ support
+
+        ReferenceReader ( const Reference & ref, uint64_t offset = 0 )
+            NGS_THROWS ( ErrorMsg );
+
+    private:
+
+        Reference ref;
+        uint64_t offset;
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_reference_reader_
+#include <ngs/inl/ReferenceReader.hpp>
+#endif
+
+#endif // _hpp_ngs_reference_reader_
@@ -0,0 +1,158 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_reference_table_
+#define _hpp_ngs_reference_table_
+
+#ifndef _hpp_ngs_error_msg_
+#include <ngs/ErrorMsg.hpp>
+#endif
+
+#ifndef _hpp_ngs_stringref_
+#include <ngs/StringRef.hpp>
+#endif
+
+#ifndef _h_ngs_itf_read_collectionitf_
+#include <ngs/itf/ReadCollectionItf.h>
+#endif
+
+#include <vector>
+
+namespace ngs
+{
+
+    /*======================================================================
+     * ReferenceTable
+     *  the names and lengths of every Reference of a ReadCollection,
+     *  filled in by ReadCollection :: getReferenceTable in one call
+     *  rather than a walk of its ReferenceIterator
+     */
+    class ReferenceTable
+    {
+    public:
+
+        /* TableField
+         *  the columns to fill in
+         */
+        enum TableField
+        {
+            commonName          = NGS_ReferenceTableFields_common_name,
+            canonicalName       = NGS_ReferenceTableFields_canonical_name,
+            referenceLength     = NGS_ReferenceTableFields_length,
+            circular            = NGS_ReferenceTableFields_circular,
+            allFields           = 0x0F
+        };
+
+        /* size
+         *  the number of References
+         */
+        uint32_t size () const
+            NGS_NOTHROW;
+
+        /* has
+         *  true if the column was asked for and the engine knows it;
+         *  canonical names and circularity often aren't known
+         */
+        bool has ( TableField field ) const
+            NGS_NOTHROW;
+
+        /* per-Reference columns
+         *  "i" is zero-based and less than size (), in the order of
+         *  ReadCollection :: getReferences
+         *  throws if "i" is out of range or the column isn't there
+         */
+        String getCommonName ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        String getCanonicalName ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        uint64_t getLength ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+        bool getIsCircular ( uint32_t i ) const
+            NGS_THROWS ( ErrorMsg );
+
+        /* whole columns
+         *  size () entries each, or 0 for a column that isn't there;
+         *  the names are bytes [ offset, offset + size ) of getArena ()
+         */
+        const uint64_t * getLengths () const
+            NGS_NOTHROW;
+        const uint8_t * getCircular () const
+            NGS_NOTHROW;
+        const NGS_ReferenceTableString_v1 * getCommonNameSpans () const
+            NGS_NOTHROW;
+        const NGS_ReferenceTableString_v1 * getCanonicalNameSpans () const
+            NGS_NOTHROW;
+        const char * getArena () const
+            NGS_NOTHROW;
+
+    public:
+
+        // C++ support
+
+        /* "fields" is a mask of TableField; "capacity" References and
+           "arenaSize" bytes of names are allocated to begin with, and
+           grown by the fill to what the collection needs */
+        ReferenceTable ( uint32_t fields = allFields, uint32_t capacity = 1024, uint32_t arenaSize = 64 * 1024 )
+            NGS_THROWS ( ErrorMsg );
+
+    private:
+
+        friend class ReadCollection;
+
+        // the table to pass to the engine, over the current allocation
+        NGS_ReferenceTable_v1 Columns ()
+            NGS_NOTHROW;
+
+        // takes what the engine filled in, and returns false after
+        // growing the allocation if the table didn't fit in it
+        bool Keep ( const NGS_ReferenceTable_v1 & table, bool fit )
+            NGS_THROWS ( ErrorMsg );
+
+        void Check ( uint32_t i, TableField field ) const
+            NGS_THROWS ( ErrorMsg );
+        String GetName ( uint32_t i, const std :: vector < NGS_ReferenceTableString_v1 > & column, TableField field ) const
+            NGS_THROWS ( ErrorMsg );
+
+        uint32_t fields;
+        uint32_t filled;
+        uint32_t count;
+
+        std :: vector < NGS_ReferenceTableString_v1 > common_name;
+        std :: vector < NGS_ReferenceTableString_v1 > canonical_name;
+        std :: vector < uint64_t > length;
+        std :: vector < uint8_t > circular_flag;
+        std :: vector < char > arena;
+    };
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_reference_table_
+#include <ngs/inl/ReferenceTable.hpp>
+#endif
+
+#endif // _hpp_ngs_reference_table_
@@ -36,6 +36,7 @@
 #endif
 
 #include <stdint.h>
+#include <vector>
 
 namespace ngs
 {
@@ -66,12 +67,12 @@ namespace ngs
         /* getValueType
          */
         ValueType getValueType ( const String & path ) const
-            throw ();
+            NGS_NOTHROW;
     
         /* getAsString
          */
         String getAsString ( const String & path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
 
         /* other int types ? */
         
@@ -79,19 +80,19 @@ namespace ngs
          *  returns a signed 64-bit integer
          */
         int64_t getAsI64 ( const String & path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
             
         /* getAsU64
          *  returns an unsigned 64-bit integer
          */
         uint64_t getAsU64 ( const String & path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         
         /* getAsDouble
          *  returns a 64-bit floating point
          */
         double getAsDouble ( const String & path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
             
         /* nextPath 
          *  advance to next path in container
@@ -100,26 +101,56 @@ namespace ngs
          * returns an empty string if no more paths, or the next valid path string
          */
         String nextPath ( const String & path ) const
-            throw ();
+            NGS_NOTHROW;
+
+        /* Entry
+         *  a path with its value, which is held by the member "type" names;
+         *  "text" holds that of a string, and is otherwise empty
+         */
+        struct Entry
+        {
+            String path;
+            ValueType type;
+            String text;
+            union
+            {
+                int64_t i64;
+                uint64_t u64;
+                double f64;
+            };
+        };
+
+        /* getAll
+         *  fills "entries" with every path and its value, in the order
+         *  of nextPath, in a single message to an engine that takes it
+         */
+        void getAll ( std :: vector < Entry > & entries ) const
+            NGS_THROWS ( ErrorMsg );
             
     public:
 
         // C++ support
 
         Statistics ( StatisticsRef ref )
-            throw ();
+            NGS_NOTHROW;
 
         Statistics & operator = ( const Statistics & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         Statistics ( const Statistics & obj )
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+#if NGS_HAVE_MOVE
+        Statistics ( Statistics && obj )
+            noexcept;
+        Statistics & operator = ( Statistics && obj )
+            noexcept;
+#endif
 
         ~ Statistics ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
         Statistics & operator = ( StatisticsRef ref )
-            throw ();
+            NGS_NOTHROW;
             
     protected:
 
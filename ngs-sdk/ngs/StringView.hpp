@@ -0,0 +1,129 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_stringview_
+#define _hpp_ngs_stringview_
+
+#ifndef _hpp_ngs_stringref_
+#include <ngs/StringRef.hpp>
+#endif
+
+struct NGS_StringView_v1;
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * StringView
+     *  textual data lent by the object it came from, without a reference
+     *  of its own. it is valid until the next message to that object;
+     *  copy it with toString to keep it longer.
+     *  engines that cannot lend their data hand out a reference instead,
+     *  which the view holds on to
+     */
+    class StringView
+    {
+    public:
+
+        /* data
+         *  return character string
+         *  NOT necessarily NUL-terminated
+         */
+        const char * data () const
+            NGS_NOTHROW;
+
+        /* size
+         *   return size of string in bytes
+         */
+        size_t size () const
+            NGS_NOTHROW;
+
+        /* substr
+         *  view a substring of the original
+         *  "offset" is zero-based
+         */
+        StringView substr ( size_t offset ) const
+            NGS_NOTHROW;
+        StringView substr ( size_t offset, size_t size ) const
+            NGS_NOTHROW;
+
+        /* toString
+         *  create a normal C++ string
+         *  copies data
+         *  "offset" is zero-based
+         */
+        String toString () const
+            NGS_THROWS ( ErrorMsg );
+        String toString ( size_t offset ) const
+            NGS_THROWS ( ErrorMsg );
+        String toString ( size_t offset, size_t size ) const
+            NGS_THROWS ( ErrorMsg );
+
+    public:
+
+        // C++ support
+        StringView ()
+            NGS_NOTHROW;
+        StringView ( const char * data, size_t size )
+            NGS_NOTHROW;
+        StringView ( const NGS_StringView_v1 & view, StringItf * ref )
+            NGS_NOTHROW;
+
+        StringView ( const StringView & obj )
+            NGS_NOTHROW;
+#if NGS_HAVE_MOVE
+        StringView ( StringView && obj )
+            noexcept;
+        StringView & operator = ( StringView && obj )
+            noexcept;
+#endif
+        StringView & operator = ( const StringView & obj )
+            NGS_NOTHROW;
+
+        ~ StringView ()
+            NGS_NOTHROW;
+
+    private:
+
+        StringView ( const char * data, size_t size, StringItf * ref )
+            NGS_NOTHROW;
+
+        const char * str;
+        size_t sz;
+        StringItf * ref;
+    };
+
+    // support for C++ ostream
+    :: std :: ostream & operator << ( :: std :: ostream & s, const StringView & str );
+
+} // namespace ngs
+
+
+// inlines
+#ifndef _inl_ngs_stringview_
+#include <ngs/inl/StringView.hpp>
+#endif
+
+#endif // _hpp_ngs_stringview_
@@ -0,0 +1,156 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_work_pool_
+#define _hpp_ngs_work_pool_
+
+#ifndef _hpp_ngs_error_msg_
+#include <ngs/ErrorMsg.hpp>
+#endif
+
+#include <stdint.h>
+
+namespace ngs
+{
+    class WorkPoolState;
+
+    /*======================================================================
+     * WorkItem
+     *  work submitted to a WorkPool
+     *  an item is queued at most once at a time; it may be submitted
+     *  again once it has started to run, e.g. by itself
+     */
+    class WorkItem
+    {
+    public:
+
+        /* run
+         *  called once for each time the item was submitted, on one of
+         *  the pool's threads; must not throw
+         */
+        virtual void run () = 0;
+
+        virtual ~ WorkItem ()
+        {
+        }
+    };
+
+    /*======================================================================
+     * WorkPool
+     *  threads that run what is submitted to them; shared () is the one
+     *  for the whole process, that the engines' decompression pipelines,
+     *  prefetching iterators and forEachSlice all submit to, so that a
+     *  process with many collections open runs on as many threads as
+     *  the CPUs it may use, not a few for each of them
+     *
+     *  each thread has a queue of its own, for what is submitted from
+     *  it, which it takes from the back; what other threads submit
+     *  waits in one queue for each priority; a thread with nothing in
+     *  its own queue or in those steals from the front of another's
+     *  high priority items go before a thread's own, then normal and
+     *  low ones, each in the order they came
+     *
+     *  work that may wait for an item it submitted should not block on
+     *  one that hasn't started: it takes it back with cancel and runs
+     *  it itself, so that the pool never waits on its own queue
+     */
+    class WorkPool
+    {
+    public:
+
+        enum Priority
+        {
+            low,
+            normal,
+            high
+        };
+
+        /* shared
+         *  the process' pool, started at the first call with
+         *  the threads configure asked for, or defaultThreads ()
+         *  the pool is never stopped
+         */
+        static WorkPool & shared ()
+            NGS_THROWS ( ErrorMsg );
+
+        /* configure
+         *  the number of threads shared () starts with, 0 for
+         *  defaultThreads (); false once it is started, when
+         *  it keeps the threads it has
+         */
+        static bool configure ( uint32_t threads )
+            NGS_NOTHROW;
+
+        /* defaultThreads
+         *  NGS_POOL_THREADS from the environment if set, otherwise the
+         *  CPUs the process may run on, cut to its cgroup's CPU quota
+         */
+        static uint32_t defaultThreads ()
+            NGS_NOTHROW;
+
+        /* submit
+         *  queues "item", which must outlive its run
+         */
+        void submit ( WorkItem & item, Priority priority = normal )
+            NGS_THROWS ( ErrorMsg );
+
+        /* cancel
+         *  takes "item" off its queue; false if it isn't queued,
+         *  e.g. because it has started to run
+         */
+        bool cancel ( WorkItem & item )
+            NGS_NOTHROW;
+
+        /* threads
+         *  the number running
+         */
+        uint32_t threads () const
+            NGS_NOTHROW;
+
+    public:
+
+        /* starts "threads" threads, at least one
+         */
+        WorkPool ( uint32_t threads )
+            NGS_THROWS ( ErrorMsg );
+
+        /* waits for the items that are running, drops those
+         * still queued, then stops the threads
+         */
+        ~ WorkPool ()
+            NGS_NOTHROW;
+
+    private:
+
+        WorkPool ( const WorkPool & obj );
+        WorkPool & operator = ( const WorkPool & obj );
+
+        WorkPoolState * state;
+    };
+
+} // namespace ngs
+
+#endif // _hpp_ngs_work_pool_
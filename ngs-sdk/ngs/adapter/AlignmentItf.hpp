@@ -76,6 +76,63 @@ namespace ngs_adapt
         virtual bool getMateIsReversedOrientation () const = 0;
         virtual bool nextAlignment () = 0;
 
+        /* fills the batch through the messages above, one Alignment at a time;
+           engines with their records in hand do better by overriding it */
+        virtual bool nextAlignmentBatch ( NGS_AlignmentBatch_v1 & batch );
+
+        // as for getFragmentBasesView
+        virtual StringItf * getReferenceSpecView ( NGS_StringView_v1 & view ) const;
+        virtual StringItf * getReadIdView ( NGS_StringView_v1 & view ) const;
+
+        /* NGS_AlignmentMessage_* bits for the messages that answer without
+           throwing; all of them unless the engine says otherwise */
+        virtual uint32_t getSupportedMessages () const;
+
+        /* fills in "value" with the optional field named by the two
+           characters at "tag"; an engine without them has none to find */
+        virtual bool getTag ( const char * tag, NGS_AlignmentTag_v1 & value ) const;
+
+        /* fills in "cigar" with the record's packed CIGAR operations; an
+           engine without them leaves its long CIGAR to be parsed instead */
+        virtual bool getCigarOps ( NGS_AlignmentCigar_v1 & cigar ) const;
+
+        /* fills in "core" with the scalar fields of the record; by default
+           asks each of the messages above for its own */
+        virtual void getCore ( NGS_AlignmentCore_v1 & core ) const;
+
+        /* advances to the next Alignment that ends after "refPos"; by default
+           passes over the others with nextAlignment, where an engine with an
+           index can seek ahead instead */
+        virtual bool skipTo ( int64_t refPos );
+
+        /* where the iterator is, as a string that resumeFrom takes to carry
+           on after the current Alignment; by default there is none */
+        virtual StringItf * getCursor () const;
+        virtual void resumeFrom ( const char * cursor );
+
+        /* the indices of the references of the Alignment and its mate, in
+           the order the collection gives its references, or -1 for none;
+           by default there are none to give */
+        virtual int32_t getReferenceIndex () const;
+        virtual int32_t getMateReferenceIndex () const;
+
+        /* takes a slice iterator to another window of its Reference, as
+           if it had been made for that one; by default it can't be */
+        virtual void reposition ( int64_t start, uint64_t length );
+
+        /* NGS_AlignmentBatchFields_* bits for the columns nextAlignmentBatch
+           fills in, all of them by default; an engine that overrides it says
+           which it does, the others being filled through the messages above */
+        virtual uint32_t getBatchFields () const;
+
+        /* fills in "mismatches" against the Reference; by default returns
+           false, leaving the bases to be compared through the messages above */
+        virtual bool getMismatches ( NGS_AlignmentMismatches_v1 & mismatches ) const;
+
+        /* fills in "fragment" as it was sequenced; by default returns false,
+           leaving it to be turned around from the messages above */
+        virtual bool getReadFragment ( NGS_AlignmentReadFragment_v1 & fragment ) const;
+
         inline NGS_Alignment_v1 * Cast ()
         { return static_cast < NGS_Alignment_v1* > ( OpaqueRefcount :: offset_this () ); }
 
@@ -124,6 +181,22 @@ namespace ngs_adapt
         static NGS_String_v1 * CC get_mate_ref_spec ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
         static bool CC get_mate_is_reversed ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
         static bool CC next ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC next_batch ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentBatch_v1 * batch );
+        static NGS_String_v1 * CC get_ref_spec_view ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_StringView_v1 * view );
+        static NGS_String_v1 * CC get_read_id_view ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_StringView_v1 * view );
+        static uint32_t CC get_supported ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC get_tag ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, const char * tag, NGS_AlignmentTag_v1 * value );
+        static bool CC get_cigar_ops ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentCigar_v1 * cigar );
+        static void CC get_core ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentCore_v1 * core );
+        static bool CC skip_to ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, int64_t ref_pos );
+        static NGS_String_v1 * CC get_cursor ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+        static void CC resume_from ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, const char * cursor );
+        static int32_t CC get_ref_index ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+        static int32_t CC get_mate_ref_index ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+        static void CC reposition ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length );
+        static uint32_t CC get_batch_fields ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC get_mismatches ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentMismatches_v1 * mismatches );
+        static bool CC get_read_fragment ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentReadFragment_v1 * fragment );
 
     };
 
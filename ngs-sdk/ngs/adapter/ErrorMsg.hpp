@@ -27,6 +27,10 @@
 #ifndef _hpp_ngs_adapt_error_msg_
 #define _hpp_ngs_adapt_error_msg_
 
+#ifndef _h_ngs_itf_defs_
+#include <ngs/itf/defs.h>
+#endif
+
 #include <exception>
 #include <string>
 
@@ -46,39 +50,39 @@ namespace ngs_adapt
          *  what went wrong
          */
         virtual const char * what () const
-            throw ();
+            NGS_NOTHROW;
 
         /* toMessage ( for Java )
          *  returns the detailed message
          */
         virtual const :: std :: string & toMessage () const
-            throw ();
+            NGS_NOTHROW;
 
         /* toString ( for Java )
          *  returns a short description
          */
         virtual const :: std :: string & toString () const
-            throw ();
+            NGS_NOTHROW;
 
         /* constructors
          *  various means of constructing
          */        
         ErrorMsg ()
-            throw ();
+            NGS_NOTHROW;
         ErrorMsg ( const :: std :: string & message )
-            throw ();
+            NGS_NOTHROW;
 
     public:
 
         // C++ support
 
         ErrorMsg ( const ErrorMsg & obj )
-            throw ();
+            NGS_NOTHROW;
         ErrorMsg & operator = ( const ErrorMsg & obj )
-            throw ();
+            NGS_NOTHROW;
 
         virtual ~ ErrorMsg ()
-            throw ();
+            NGS_NOTHROW;
 
     private:
 
@@ -55,6 +55,23 @@ namespace ngs_adapt
         virtual StringItf * getFragmentQualities ( uint64_t offset, uint64_t length ) const = 0;
         virtual bool nextFragment () = 0;
 
+        // throw ErrorMsg unless overridden
+        virtual bool isPaired () const;
+        virtual bool isAligned () const;
+
+        /* fill in "view" and return 0 to lend the data; by default,
+           "view" points into a string that is returned for the caller to release */
+        virtual StringItf * getFragmentBasesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const;
+        virtual StringItf * getFragmentQualitiesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const;
+
+        /* fills in "packed" with the bases as BAM packs them and returns
+           true to lend them; returns false by default, for the caller to
+           pack those of getFragmentBases */
+        virtual bool getFragmentBasesPacked ( uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 & packed ) const;
+
+        // the fragment's ordinal within its read; throws ErrorMsg unless overridden
+        virtual uint32_t getFragmentIndex () const;
+
     protected:
 
         // support for C vtable
@@ -69,6 +86,15 @@ namespace ngs_adapt
         static NGS_String_v1 * CC get_quals ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err,
             uint64_t offset, uint64_t length );
         static bool next ( NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC is_paired ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC is_aligned ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
+        static NGS_String_v1 * CC get_bases_view ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, NGS_StringView_v1 * view );
+        static NGS_String_v1 * CC get_quals_view ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, NGS_StringView_v1 * view );
+        static bool CC get_packed_bases ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 * packed );
+        static uint32_t CC get_frag_index ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
 
     };
 
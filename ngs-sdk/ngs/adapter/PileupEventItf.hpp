@@ -65,6 +65,10 @@ namespace ngs_adapt
         virtual bool nextPileupEvent () = 0;
         virtual void resetPileupEvent () = 0;
 
+        /* as for AlignmentItf, of the event's Alignment */
+        virtual int32_t getReferenceIndex () const;
+        virtual int32_t getMateReferenceIndex () const;
+
     protected:
 
         PileupEventItf ( const NGS_VTable * vt );
@@ -86,6 +90,8 @@ namespace ngs_adapt
         static uint32_t CC get_indel_type ( const NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
         static bool CC next ( NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
         static void CC reset ( NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
+        static int32_t CC get_ref_index ( const NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
+        static int32_t CC get_mate_ref_index ( const NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
     };
 
 } // namespace ngs_adapt
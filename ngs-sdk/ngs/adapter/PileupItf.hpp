@@ -57,6 +57,18 @@ namespace ngs_adapt
         virtual uint32_t getPileupDepth () const = 0;
         virtual bool nextPileup () = 0;
 
+        /* fills in "column" with the events of the current position;
+           by default walks them, a message per event and field */
+        virtual bool getColumn ( NGS_PileupColumn_v1 & column );
+
+        /* fills in "counts" as for get_base_counts; by default walks
+           the events of each position, a message per event and field */
+        virtual uint32_t getBaseCounts ( int32_t min_qual, uint32_t count, NGS_PileupBaseCounts_v1 * counts );
+
+        /* moves the end of a slice's window out to "newEnd", keeping the
+           alignments at hand; by default it can't be */
+        virtual void extendTo ( int64_t newEnd );
+
         inline NGS_Pileup_v1 * Cast ()
         { return static_cast < NGS_Pileup_v1* > ( OpaqueRefcount :: offset_this () ); }
 
@@ -81,6 +93,9 @@ namespace ngs_adapt
         static char CC get_ref_base ( const NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
         static uint32_t CC get_pileup_depth ( const NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
         static bool CC next ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC get_column ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err, NGS_PileupColumn_v1 * column );
+        static uint32_t CC get_base_counts ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err, int32_t min_qual, uint32_t count, NGS_PileupBaseCounts_v1 * counts );
+        static void CC extend_to ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err, int64_t new_end );
 
     };
 
@@ -46,6 +46,7 @@ namespace ngs_adapt
     class ReadGroupItf;
     class ReferenceItf;
     class AlignmentItf;
+    class StatisticsItf;
 
     /*----------------------------------------------------------------------
      * ReadCollectionItf
@@ -65,11 +66,24 @@ namespace ngs_adapt
         virtual AlignmentItf * getAlignments ( bool wants_primary, bool wants_secondary ) const = 0;
         virtual uint64_t getAlignmentCount ( bool wants_primary, bool wants_secondary ) const = 0;
         virtual AlignmentItf * getAlignmentRange ( uint64_t first, uint64_t count, bool wants_primary, bool wants_secondary ) const = 0;
+        virtual AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary ) const = 0;
         virtual ReadItf * getRead ( const char * readId ) const = 0;
         virtual ReadItf * getReads ( bool wants_full, bool wants_partial, bool wants_unaligned ) const = 0;
         virtual uint64_t getReadCount ( bool wants_full, bool wants_partial, bool wants_unaligned ) const = 0;
         virtual ReadItf * getReadRange ( uint64_t first, uint64_t count, bool wants_full, bool wants_partial, bool wants_unaligned ) const = 0;
 
+        /* NGS_ReadCollectionFeature_* bits;
+           all of them unless the engine says otherwise */
+        virtual uint32_t getFeatures () const;
+
+        /* engine-defined counters about the collection itself;
+           throws unless the engine provides them */
+        virtual StatisticsItf * getStatistics () const;
+
+        /* the names and lengths of every reference at once, see
+           NGS_ReferenceTable_v1; by default, walks getReferences */
+        virtual bool getReferenceTable ( NGS_ReferenceTable_v1 & table ) const;
+
     protected:
 
         ReadCollectionItf ();
@@ -94,6 +108,8 @@ namespace ngs_adapt
             bool wants_primary, bool wants_secondary );
         static NGS_Alignment_v1 * CC get_align_range ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
             uint64_t first, uint64_t count, bool wants_primary, bool wants_secondary );
+        static NGS_Alignment_v1 * CC get_align_shard ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
+            uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary );
         static NGS_Read_v1 * CC get_read ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
             const char * readId );
         static NGS_Read_v1 * CC get_reads ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
@@ -102,6 +118,10 @@ namespace ngs_adapt
             bool wants_full, bool wants_partial, bool wants_unaligned );
         static NGS_Read_v1 * CC get_read_range ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
             uint64_t first, uint64_t count, bool wants_full, bool wants_partial, bool wants_unaligned );
+        static uint32_t CC get_features ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err );
+        static NGS_Statistics_v1 * CC get_statistics ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC get_reference_table ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
+            NGS_ReferenceTable_v1 * table );
 
     };
 
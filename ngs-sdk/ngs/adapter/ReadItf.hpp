@@ -59,6 +59,18 @@ namespace ngs_adapt
         virtual StringItf * getReadQualities ( uint64_t offset, uint64_t length ) const = 0;
         virtual bool nextRead () = 0;
 
+        // throw ErrorMsg unless overridden
+        virtual bool fragmentIsAligned ( uint32_t fragIdx ) const;
+
+        /* where the iterator is, as a string that resumeFrom takes to carry
+           on after the current Read; by default there is none */
+        virtual StringItf * getCursor () const;
+        virtual void resumeFrom ( const char * cursor );
+
+        /* the number that ends getReadId's, for a key without the string;
+           by default parsed from getReadId's */
+        virtual uint64_t getReadRowId () const;
+
         inline NGS_Read_v1 * Cast ()
         { return static_cast < NGS_Read_v1* > ( OpaqueRefcount :: offset_this () ); }
 
@@ -87,6 +99,10 @@ namespace ngs_adapt
         static NGS_String_v1 * CC get_bases ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, uint64_t length );
         static NGS_String_v1 * CC get_quals ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, uint64_t length );
         static bool CC next ( NGS_Read_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC frag_is_aligned ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, uint32_t fragIdx );
+        static NGS_String_v1 * CC get_cursor ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err );
+        static void CC resume_from ( NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, const char * cursor );
+        static uint64_t CC get_row_id ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err );
 
     };
 
@@ -38,6 +38,40 @@
 namespace ngs_adapt
 {
 
+    /*----------------------------------------------------------------------
+     * Allocator
+     *  where an engine's objects come from: every OpaqueRefcount, and the
+     *  blocks an engine takes with newBlock, e.g. for its record buffers
+     *  the default is the heap, with small objects recycled through a
+     *  per-thread pool; one installed takes it all, the pool included.
+     *  a block is given back to the allocator installed when it is freed,
+     *  so install one before the first collection is opened and keep it
+     *  until the last object is gone; it is called from any thread
+     */
+    class Allocator
+    {
+    public:
+
+        // "bytes" aligned as :: operator new aligns them; throws on failure
+        virtual void * allocate ( size_t bytes ) = 0;
+
+        // a block of "bytes" that allocate returned
+        virtual void deallocate ( void * block, size_t bytes ) = 0;
+
+        virtual ~ Allocator ();
+
+    public:
+
+        // the process' allocator, or NULL for the default;
+        // returns the one it replaces
+        static Allocator * install ( Allocator * allocator );
+        static Allocator * installed ();
+
+        // a block from the allocator installed, and back to it
+        static void * newBlock ( size_t bytes );
+        static void deleteBlock ( void * block, size_t bytes );
+    };
+
     /*----------------------------------------------------------------------
      * OpaqueRefcount
      */
@@ -49,11 +83,21 @@ namespace ngs_adapt
         virtual void Release ();
         virtual void * Duplicate () const;
 
+        // the vtable of an extension by its name, for NGS_Refcount_v1_vt
+        // query_ext; none unless a subclass says otherwise
+        virtual const NGS_VTable * QueryExtension ( const char * name ) const;
+
     public:
 
         // C++ support
         virtual ~ OpaqueRefcount ();
 
+        // from the Allocator installed, else small objects are
+        // recycled through a per-thread pool; a subclass may
+        // declare its own to allocate otherwise
+        void * operator new ( size_t bytes );
+        void operator delete ( void * obj, size_t bytes );
+
     protected:
 
         // not directly instantiable
@@ -88,6 +132,7 @@ namespace ngs_adapt
 
         static void CC release ( NGS_Refcount_v1 * self, NGS_ErrBlock_v1 * err );
         static void * CC duplicate ( const NGS_Refcount_v1 * self, NGS_ErrBlock_v1 * err );
+        static const NGS_VTable * CC query_ext ( const NGS_Refcount_v1 * self, NGS_ErrBlock_v1 * err, const char * name );
         NGS_Refcount_v1 cobj;
 
 
@@ -112,6 +157,9 @@ namespace ngs_adapt
 
     public:
 
+        using OpaqueRefcount :: operator new;
+        using OpaqueRefcount :: operator delete;
+
         inline C * Cast ()
         { return static_cast < C* > ( OpaqueRefcount :: offset_this () ); }
 
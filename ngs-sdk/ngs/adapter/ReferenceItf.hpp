@@ -62,17 +62,48 @@ namespace ngs_adapt
         virtual AlignmentItf * getAlignment ( const char * alignmentId ) const = 0;
         virtual AlignmentItf * getAlignments ( bool wants_primary, bool wants_secondary ) const = 0;
         virtual AlignmentItf * getAlignmentSlice ( int64_t start, uint64_t length, bool wants_primary, bool wants_secondary ) const = 0;
+        virtual AlignmentItf * getFilteredAlignments ( uint32_t flags, int32_t map_qual ) const = 0;
+        virtual AlignmentItf * getFilteredAlignmentSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual ) const = 0;
+        virtual AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary ) const = 0;
         virtual PileupItf * getPileups ( bool wants_primary, bool wants_secondary ) const = 0;
         virtual PileupItf * getFilteredPileups ( uint32_t flags, int32_t map_qual ) const = 0;
         virtual PileupItf * getPileupSlice ( int64_t start, uint64_t length, bool wants_primary, bool wants_secondary ) const = 0;
         virtual PileupItf * getFilteredPileupSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual ) const = 0;
         virtual bool nextReference () = 0;
 
+        /* NGS_ReferenceFeature_* bits for the current Reference;
+           all of them unless the engine says otherwise */
+        virtual uint32_t getFeatures () const;
+
+        /* fills in "depth" as for get_coverage and returns true; returns
+           false by default, leaving the count from the slice to the caller */
+        virtual bool getCoverage ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t * depth ) const;
+
+        /* a Pileup as for get_sampled_pileup_slice; by default only
+           getFilteredPileupSlice's, when nothing is to be sampled or skipped */
+        virtual PileupItf * getSampledPileupSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual,
+            uint32_t max_depth, uint64_t seed, bool skip_empty ) const;
+
+        /* copies bases as for copy_ref_bases; by default from
+           getReferenceChunk's, one chunk at a time */
+        virtual uint64_t copyReferenceBases ( uint64_t offset, char * buffer, uint64_t size ) const;
+
+        /* packs bases as for get_packed_ref_bases and returns true; returns
+           false by default, leaving it to the caller to pack copied ones */
+        virtual bool getReferenceBasesPacked ( uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * n_mask, uint64_t & count ) const;
+
+        /* estimates a slice as for estimate_slice and returns true; returns
+           false by default, leaving it to the caller to scale the count */
+        virtual bool estimateSlice ( int64_t start, uint64_t length, uint64_t & alignments, uint64_t & bytes ) const;
+
     protected:
 
         ReferenceItf ();
         static NGS_Reference_v1_vt ivt;
 
+        // walks and releases getReferences for its default getReferenceTable
+        friend class ReadCollectionItf;
+
     private:
 
         static NGS_String_v1 * CC get_cmn_name ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err );
@@ -91,6 +122,15 @@ namespace ngs_adapt
             bool wants_primary, bool wants_secondary );
         static NGS_Alignment_v1 * CC get_align_slice ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
             int64_t start, uint64_t length, bool wants_primary, bool wants_secondary );
+        static NGS_Alignment_v1 * CC get_filtered_alignments ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            uint32_t flags, int32_t map_qual );
+        static NGS_Alignment_v1 * CC get_filtered_align_slice ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            int64_t start, uint64_t length, uint32_t flags, int32_t map_qual );
+        static NGS_Alignment_v1 * CC get_align_shard ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary );
+        static uint32_t CC get_features ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err );
+        static bool CC get_coverage ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t * depth );
         static NGS_Pileup_v1 * CC get_pileups ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
             bool wants_primary, bool wants_secondary );
         static NGS_Pileup_v1 * CC get_filtered_pileups ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
@@ -99,6 +139,14 @@ namespace ngs_adapt
             int64_t start, uint64_t length, bool wants_primary, bool wants_secondary );
         static NGS_Pileup_v1 * CC get_filtered_pileup_slice ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
             int64_t start, uint64_t length, uint32_t flags, int32_t map_qual );
+        static NGS_Pileup_v1 * CC get_sampled_pileup_slice ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t max_depth, uint64_t seed, bool skip_empty );
+        static uint64_t CC copy_ref_bases ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            uint64_t offset, char * buffer, uint64_t size );
+        static bool CC get_packed_ref_bases ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * n_mask, uint64_t * count );
+        static bool CC estimate_slice ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err,
+            int64_t start, uint64_t length, uint64_t * alignments, uint64_t * bytes );
         static bool CC next ( NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err );
 
     };
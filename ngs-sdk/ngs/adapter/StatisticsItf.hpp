@@ -57,6 +57,11 @@ namespace ngs_adapt
         virtual double getAsDouble ( const char * path ) const = 0;
         virtual StringItf * nextPath ( const char * path ) const = 0;
 
+        /* sets "entries" to every path with its value, valid for the life
+           of the object, and returns true to lend them; returns false by
+           default, for the caller to walk the paths with nextPath */
+        virtual bool getEntries ( const NGS_StatisticsEntry_v1 * & entries, uint64_t & count ) const;
+
     protected:
 
         StatisticsItf ();
@@ -70,6 +75,7 @@ namespace ngs_adapt
         static uint64_t CC as_U64 ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
         static double CC as_F64 ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
         static NGS_String_v1 * CC next_path ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
+        static bool CC get_entries ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const NGS_StatisticsEntry_v1 ** entries, uint64_t * count );
 
     };
 
@@ -57,6 +57,9 @@ namespace ngs_adapt
         StringItf ( const char * data, size_t size );
         virtual ~ StringItf ();
 
+        // for adapters that take a string from another and are done with it
+        using OpaqueRefcount :: Release;
+
     private:
 
         // ?? should these be left public ??
@@ -38,6 +38,36 @@
 extern "C" {
 #endif
 
+/*--------------------------------------------------------------------------
+ * NGS_ADAPT_ABI
+ *  what the adapter classes are built with: the SDK version of these
+ *  headers and the C++ ABI of the compiler. NGS_ADAPT_CLASS tags the
+ *  class name of every adapter vtable with it, so that a dispatch layer
+ *  built with the same can find the C++ object behind a C one and call
+ *  it directly; see <ngs/itf/DirectBind.hpp>
+ *  there is no tag for a compiler whose ABI isn't known here
+ */
+#define NGS_ADAPT_SDK_VERSION "1.3.0"
+
+#define NGS_ADAPT_STR_( x ) # x
+#define NGS_ADAPT_STR( x ) NGS_ADAPT_STR_ ( x )
+
+#if defined __GXX_ABI_VERSION && defined _LIBCPP_VERSION
+ #define NGS_ADAPT_CXX_ABI "itanium-" NGS_ADAPT_STR ( __GXX_ABI_VERSION ) "-libc++"
+#elif defined __GXX_ABI_VERSION
+ #define NGS_ADAPT_CXX_ABI "itanium-" NGS_ADAPT_STR ( __GXX_ABI_VERSION )
+#elif defined _MSC_VER
+ #define NGS_ADAPT_CXX_ABI "msvc-" NGS_ADAPT_STR ( _MSC_VER )
+#endif
+
+#ifdef NGS_ADAPT_CXX_ABI
+ #define NGS_ADAPT_ABI " [ngs-sdk " NGS_ADAPT_SDK_VERSION " " NGS_ADAPT_CXX_ABI "]"
+#else
+ #define NGS_ADAPT_ABI ""
+#endif
+
+#define NGS_ADAPT_CLASS( name ) "ngs_adapt::" name NGS_ADAPT_ABI
+
 /*--------------------------------------------------------------------------
  * NGS_ErrBlock
  *  see "ErrBlock.h"
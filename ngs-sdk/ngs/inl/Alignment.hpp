@@ -35,6 +35,15 @@
 #include <ngs/itf/AlignmentItf.hpp>
 #endif
 
+#ifndef _h_ngs_itf_alignmentitf_
+#include <ngs/itf/AlignmentItf.h>
+#endif
+
+#include <string.h>
+#include <ctype.h>
+
+#include <algorithm>
+
 namespace ngs
 {
 
@@ -49,126 +58,562 @@ namespace ngs
 
     inline
     StringRef Alignment :: getAlignmentId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getAlignmentId () ); }
 
     inline
     String Alignment :: getReferenceSpec () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceSpec () ) . toString (); }
 
+    inline
+    StringView Alignment :: getReferenceSpecView () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_StringView_v1 view;
+        StringItf * ref = self -> getReferenceSpecView ( view );
+        return StringView ( view, ref );
+    }
+
+    inline
+    int32_t Alignment :: getReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> getReferenceIndex (); }
+
     inline
     int Alignment :: getMappingQuality () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getMappingQuality (); }
 
     inline
     StringRef Alignment :: getReferenceBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceBases () ); }
 
     inline
     String Alignment :: getReadGroup () const
-        throw ( ErrorMsg )
-    { return StringRef ( self -> getReadGroup () ) . toString (); }
+        NGS_THROWS ( ErrorMsg )
+    {
+        // an engine may have no read group to give
+        StringItf * str = self -> getReadGroup ();
+        return str == 0 ? String () : StringRef ( str ) . toString ();
+    }
 
     inline
     StringRef Alignment :: getReadId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReadId () ); }
 
+    inline
+    StringView Alignment :: getReadIdView () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_StringView_v1 view;
+        StringItf * ref = self -> getReadIdView ( view );
+        return StringView ( view, ref );
+    }
+
     inline
     StringRef Alignment :: getClippedFragmentBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getClippedFragmentBases () ); }
 
     inline
     StringRef Alignment :: getClippedFragmentQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getClippedFragmentQualities () ); }
 
     inline
     StringRef Alignment :: getAlignedFragmentBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getAlignedFragmentBases () ); }
 
+    inline
+    bool Alignment :: getFragmentInReadOrientation ( String & bases, String & qualities ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the engine's answer, asked again if the strings were too small
+        NGS_AlignmentReadFragment_v1 fragment;
+        bases . resize ( bases . capacity () );
+        qualities . resize ( bases . size () );
+        fragment . bases = bases . empty () ? 0 : & bases [ 0 ];
+        fragment . quals = qualities . empty () ? 0 : & qualities [ 0 ];
+        fragment . size = ( uint32_t ) bases . size ();
+        if ( self -> getReadFragment ( fragment ) )
+        {
+            if ( fragment . length > fragment . size )
+            {
+                bases . resize ( fragment . length );
+                qualities . resize ( fragment . length );
+                fragment . bases = & bases [ 0 ];
+                fragment . quals = & qualities [ 0 ];
+                fragment . size = fragment . length;
+                self -> getReadFragment ( fragment );
+            }
+            bases . resize ( fragment . length );
+            qualities . resize ( fragment . has_quals ? fragment . length : 0 );
+            return ! fragment . skipped;
+        }
+
+        // otherwise the fragment as aligned is turned around; one with
+        // hard clips is only part of the read unless it is the primary
+        Core const core = getCore ();
+        if ( ! core . primary )
+        {
+            std :: vector < uint32_t > buffer;
+            CigarOps const cigar = getCigarOps ( buffer );
+            for ( uint32_t i = 0; i < cigar . count; ++ i )
+            {
+                if ( cigar . op ( i ) == 'H' )
+                {
+                    bases . clear ();
+                    qualities . clear ();
+                    return false;
+                }
+            }
+        }
+
+        StringRef const b = getFragmentBases ();
+        StringRef const q = getFragmentQualities ();
+        bases . assign ( b . data (), b . size () );
+        qualities . assign ( q . data (), q . size () );
+        if ( core . reversedOrientation )
+        {
+            static const char from [] = "ACGTMRWSYKVHDBNacgtmrwsykvhdbn";
+            static const char to [] = "TGCAKYWSRMBDHVNtgcakywsrmbdhvn";
+            std :: reverse ( bases . begin (), bases . end () );
+            std :: reverse ( qualities . begin (), qualities . end () );
+            for ( size_t i = 0; i < bases . size (); ++ i )
+            {
+                const char * const at = bases [ i ] == 0 ? 0 : strchr ( from, bases [ i ] );
+                if ( at != 0 )
+                    bases [ i ] = to [ at - from ];
+            }
+        }
+        return true;
+    }
+
     inline
     Alignment :: AlignmentCategory Alignment :: getAlignmentCategory () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ( Alignment :: AlignmentCategory ) self -> getAlignmentCategory (); }
 
     inline
     int64_t Alignment :: getAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentPosition (); }
 
     inline
     uint64_t Alignment :: getReferencePositionProjectionRange (int64_t ref_pos) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getReferencePositionProjectionRange (ref_pos); }
 
     inline
     uint64_t Alignment :: getAlignmentLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentLength (); }
 
     inline
     bool Alignment :: getIsReversedOrientation () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getIsReversedOrientation (); }
 
     inline
     int Alignment :: getSoftClip ( ClipEdge edge ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getSoftClip ( edge ); }
 
     inline
     uint64_t Alignment :: getTemplateLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getTemplateLength (); }
 
     inline
     StringRef Alignment :: getShortCigar ( bool clipped ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getShortCigar ( clipped ) ); }
 
     inline
     StringRef Alignment :: getLongCigar ( bool clipped ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getLongCigar ( clipped ) ); }
 
+    inline
+    Alignment :: CigarOps Alignment :: getCigarOps ( std :: vector < uint32_t > & buffer ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentCigar_v1 lent;
+        if ( self -> getCigarOps ( lent ) )
+        {
+            CigarOps rslt = { lent . ops, lent . count };
+            return rslt;
+        }
+
+        static const char codes [] = "MIDNSHP=X";
+        String const cigar = getLongCigar ( false ) . toString ();
+        buffer . clear ();
+        uint32_t length = 0;
+        bool digits = false;
+        for ( String :: const_iterator c = cigar . begin (); c != cigar . end (); ++ c )
+        {
+            if ( * c >= '0' && * c <= '9' )
+            {
+                length = length * 10 + ( * c - '0' );
+                digits = true;
+                continue;
+            }
+            const char * code = strchr ( codes, * c );
+            if ( code == 0 || * c == 0 || ! digits )
+                throw ErrorMsg ( "malformed CIGAR: '" + cigar + "'" );
+            buffer . push_back ( ( length << 4 ) | ( uint32_t ) ( code - codes ) );
+            length = 0;
+            digits = false;
+        }
+        if ( digits )
+            throw ErrorMsg ( "malformed CIGAR: '" + cigar + "'" );
+
+        CigarOps rslt = { buffer . empty () ? 0 : & buffer [ 0 ], ( uint32_t ) buffer . size () };
+        return rslt;
+    }
+
+    inline
+    uint32_t Alignment :: getMismatchCount () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentMismatches_v1 mismatches;
+        mismatches . mask = 0;
+        mismatches . mask_size = 0;
+        if ( self -> getMismatches ( mismatches ) )
+            return mismatches . count;
+
+        std :: vector < uint8_t > mask;
+        return getMismatchMask ( mask );
+    }
+
+    inline
+    uint32_t Alignment :: getMismatchMask ( std :: vector < uint8_t > & mask ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // the engine's answer, asked again if the mask was too small
+        NGS_AlignmentMismatches_v1 mismatches;
+        mask . resize ( mask . capacity () );
+        mismatches . mask = mask . empty () ? 0 : & mask [ 0 ];
+        mismatches . mask_size = ( uint32_t ) mask . size ();
+        if ( self -> getMismatches ( mismatches ) )
+        {
+            if ( mismatches . bases > mismatches . mask_size )
+            {
+                mask . resize ( mismatches . bases );
+                mismatches . mask = & mask [ 0 ];
+                mismatches . mask_size = mismatches . bases;
+                self -> getMismatches ( mismatches );
+            }
+            mask . resize ( mismatches . bases );
+            return mismatches . count;
+        }
+
+        // otherwise the bases are compared along the CIGAR; = and X
+        // say what they are, M is compared, a read's '=' matching
+        std :: vector < uint32_t > buffer;
+        CigarOps const cigar = getCigarOps ( buffer );
+        StringRef const ref = getReferenceBases ();
+        StringRef const bases = getClippedFragmentBases ();
+        const char * const r = ref . data ();
+        const char * const q = bases . data ();
+        size_t const rsize = ref . size ();
+        size_t const qsize = bases . size ();
+
+        mask . assign ( qsize, 0 );
+        uint32_t count = 0;
+        size_t ri = 0, qi = 0;
+        for ( uint32_t i = 0; i < cigar . count; ++ i )
+        {
+            size_t const n = cigar . length ( i );
+            char const op = cigar . op ( i );
+            switch ( op )
+            {
+            case 'M':
+            case 'X':
+                for ( size_t k = 0; k < n && qi + k < qsize; ++ k )
+                {
+                    if ( op == 'M' )
+                    {
+                        if ( ri + k >= rsize )
+                            break;
+                        char const a = ( char ) toupper ( q [ qi + k ] );
+                        if ( a == '=' || a == toupper ( r [ ri + k ] ) )
+                            continue;
+                    }
+                    mask [ qi + k ] = 1;
+                    ++ count;
+                }
+                ri += n;
+                qi += n;
+                break;
+            case '=':
+                ri += n;
+                qi += n;
+                break;
+            case 'I':
+                qi += n;
+                break;
+            case 'D':
+            case 'N':
+                ri += n;
+                break;
+            }
+        }
+        return count;
+    }
+
     inline
     char Alignment :: getRNAOrientation () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getRNAOrientation (); }
+
+    inline
+    Alignment :: Core Alignment :: getCore () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentCore_v1 core;
+        self -> getCore ( core );
+
+        Core rslt =
+        {
+            core . position,
+            core . length,
+            core . template_len,
+            core . map_qual,
+            ( core . flags & NGS_AlignmentBatchFlags_primary ) != 0,
+            ( core . flags & NGS_AlignmentBatchFlags_reversed ) != 0,
+            ( core . flags & NGS_AlignmentBatchFlags_has_mate ) != 0
+        };
+        return rslt;
+    }
     
     inline
     bool Alignment :: hasMate () const
-        throw ()
+        NGS_NOTHROW
     { return self -> hasMate (); }
 
     inline
     StringRef Alignment :: getMateAlignmentId () const
-        throw ( ErrorMsg )
-    { return StringRef ( self -> getMateAlignmentId () ); }
+        NGS_THROWS ( ErrorMsg )
+    {
+        StringItf * str = self -> getMateAlignmentId ();
+        if ( str == 0 )
+            throw ErrorMsg ( "the mate was not found" );
+        return StringRef ( str );
+    }
 
     inline
     Alignment Alignment :: getMateAlignment () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return Alignment ( ( AlignmentRef ) self -> getMateAlignment () ); }
 
     inline
     String Alignment :: getMateReferenceSpec () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getMateReferenceSpec () ) . toString (); }
 
+    inline
+    int32_t Alignment :: getMateReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> getMateReferenceIndex (); }
+
     inline
     bool Alignment :: getMateIsReversedOrientation () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getMateIsReversedOrientation (); }
 
+    inline
+    bool Alignment :: supports ( AlignmentMessage msg ) const
+        NGS_THROWS ( ErrorMsg )
+    { return ( self -> getSupportedMessages () & ( uint32_t ) msg ) == ( uint32_t ) msg; }
+
+    inline
+    bool Alignment :: tryGetReadGroup ( String & name ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ! supports ( readGroupMessage ) )
+            return false;
+
+        StringItf * str = self -> getReadGroup ();
+        if ( str == 0 )
+            return false;
+
+        name = StringRef ( str ) . toString ();
+        return true;
+    }
+
+    inline
+    bool Alignment :: tryGetMateAlignmentId ( String & id ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ! supports ( AlignmentMessage ( hasMateMessage | mateAlignmentIdMessage ) ) || ! self -> hasMate () )
+            return false;
+
+        StringItf * str = self -> getMateAlignmentId ();
+        if ( str == 0 )
+            return false;
+
+        id = StringRef ( str ) . toString ();
+        return true;
+    }
+
+    /*----------------------------------------------------------------------
+     * optional fields
+     *  the values an engine lends are little-endian
+     */
+
+    inline
+    void AlignmentTagFind ( const AlignmentItf * itf, const String & tag, NGS_AlignmentTag_v1 & value )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( tag . size () != 2 )
+            throw ErrorMsg ( "a tag is two characters: '" + tag + "'" );
+        if ( ! itf -> getTag ( tag . data (), value ) )
+            throw ErrorMsg ( "no tag '" + tag + "'" );
+    }
+
+    inline
+    ErrorMsg AlignmentTagMismatch ( const String & tag, const char * kind )
+        NGS_NOTHROW
+    {
+        return ErrorMsg ( "tag '" + tag + "' is not " + kind );
+    }
+
+    inline
+    bool AlignmentTagIsInt ( char type )
+        NGS_NOTHROW
+    {
+        return type != 0 && strchr ( "cCsSiI", type ) != 0;
+    }
+
+    // element "i" of an integer value
+    inline
+    int64_t AlignmentTagInt ( const NGS_AlignmentTag_v1 & value, uint32_t i )
+        NGS_NOTHROW
+    {
+        const unsigned char * p = static_cast < const unsigned char * > ( value . data );
+        switch ( value . type )
+        {
+        case 'c':
+            return ( int8_t ) p [ i ];
+        case 'C':
+            return p [ i ];
+        case 's':
+            p += 2 * i;
+            return ( int16_t ) ( p [ 0 ] | ( p [ 1 ] << 8 ) );
+        case 'S':
+            p += 2 * i;
+            return ( uint16_t ) ( p [ 0 ] | ( p [ 1 ] << 8 ) );
+        case 'i':
+            p += 4 * i;
+            return ( int32_t ) ( p [ 0 ] | ( p [ 1 ] << 8 ) | ( p [ 2 ] << 16 ) | ( ( uint32_t ) p [ 3 ] << 24 ) );
+        default:
+            p += 4 * i;
+            return ( uint32_t ) ( p [ 0 ] | ( p [ 1 ] << 8 ) | ( p [ 2 ] << 16 ) | ( ( uint32_t ) p [ 3 ] << 24 ) );
+        }
+    }
+
+    // element "i" of a value of type f
+    inline
+    float AlignmentTagFloat ( const NGS_AlignmentTag_v1 & value, uint32_t i )
+        NGS_NOTHROW
+    {
+        const unsigned char * p = static_cast < const unsigned char * > ( value . data ) + 4 * i;
+        uint32_t const bits = p [ 0 ] | ( p [ 1 ] << 8 ) | ( p [ 2 ] << 16 ) | ( ( uint32_t ) p [ 3 ] << 24 );
+        float rslt;
+        memcpy ( & rslt, & bits, sizeof rslt );
+        return rslt;
+    }
+
+    inline
+    bool Alignment :: hasTag ( const String & tag ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentTag_v1 value;
+        return tag . size () == 2 && self -> getTag ( tag . data (), value );
+    }
+
+    inline
+    int64_t Alignment :: getTagInt ( const String & tag ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentTag_v1 value;
+        AlignmentTagFind ( self, tag, value );
+        if ( value . is_array || ! AlignmentTagIsInt ( value . type ) )
+            throw AlignmentTagMismatch ( tag, "an integer" );
+        return AlignmentTagInt ( value, 0 );
+    }
+
+    inline
+    float Alignment :: getTagFloat ( const String & tag ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentTag_v1 value;
+        AlignmentTagFind ( self, tag, value );
+        if ( value . is_array || value . type != 'f' )
+            throw AlignmentTagMismatch ( tag, "a float" );
+        return AlignmentTagFloat ( value, 0 );
+    }
+
+    inline
+    String Alignment :: getTagString ( const String & tag ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentTag_v1 value;
+        AlignmentTagFind ( self, tag, value );
+        if ( value . is_array || ( value . type != 'Z' && value . type != 'H' && value . type != 'A' ) )
+            throw AlignmentTagMismatch ( tag, "a string" );
+        return String ( static_cast < const char * > ( value . data ), value . count );
+    }
+
+    template < class T >
+    inline
+    std :: vector < T > Alignment :: getTagArray ( const String & tag ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_AlignmentTag_v1 value;
+        AlignmentTagFind ( self, tag, value );
+        if ( ! value . is_array )
+            throw AlignmentTagMismatch ( tag, "an array" );
+
+        std :: vector < T > rslt;
+        rslt . reserve ( value . count );
+        if ( value . type == 'f' )
+        {
+            for ( uint32_t i = 0; i < value . count; ++ i )
+                rslt . push_back ( static_cast < T > ( AlignmentTagFloat ( value, i ) ) );
+        }
+        else
+        {
+            for ( uint32_t i = 0; i < value . count; ++ i )
+                rslt . push_back ( static_cast < T > ( AlignmentTagInt ( value, i ) ) );
+        }
+        return rslt;
+    }
+
 #undef self
 
+#if NGS_HAVE_MOVE
+    inline
+    Alignment :: Alignment ( Alignment && obj )
+            noexcept
+        : Fragment ( static_cast < Fragment && > ( obj ) )
+    {
+    }
+
+    inline
+    Alignment & Alignment :: operator = ( Alignment && obj )
+        noexcept
+    {
+        Fragment :: operator = ( static_cast < Fragment && > ( obj ) );
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_alignment_
@@ -0,0 +1,222 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_alignment_batch_
+#define _inl_ngs_alignment_batch_
+
+#ifndef _hpp_ngs_alignment_batch_
+#include <ngs/AlignmentBatch.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * AlignmentBatch
+     */
+
+    template < class T >
+    inline
+    T * AlignmentBatchColumn ( std :: vector < T > & column, bool wanted, uint32_t capacity )
+    {
+        if ( ! wanted || capacity == 0 )
+            return 0;
+        column . resize ( capacity );
+        return & column [ 0 ];
+    }
+
+    inline
+    AlignmentBatch :: AlignmentBatch ( uint32_t fields, uint32_t capacity, uint32_t arenaSize, uint32_t cigarArenaSize )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( capacity == 0 )
+            throw ErrorMsg ( "alignment batch capacity is 0" );
+
+        batch . fields = fields;
+        batch . capacity = capacity;
+        batch . position = AlignmentBatchColumn ( position, ( fields & alignmentPosition ) != 0, capacity );
+        batch . length = AlignmentBatchColumn ( length, ( fields & alignmentPosition ) != 0, capacity );
+        batch . map_qual = AlignmentBatchColumn ( map_qual, ( fields & mappingQuality ) != 0, capacity );
+        batch . flags = AlignmentBatchColumn ( flags, ( fields & alignmentFlags ) != 0, capacity );
+        batch . ref_spec = AlignmentBatchColumn ( ref_spec, ( fields & referenceSpec ) != 0, capacity );
+        batch . read_id = AlignmentBatchColumn ( read_id, ( fields & readId ) != 0, capacity );
+        batch . bases = AlignmentBatchColumn ( bases, ( fields & fragmentBases ) != 0, capacity );
+        batch . qualities = AlignmentBatchColumn ( qualities, ( fields & fragmentQualities ) != 0, capacity );
+        batch . arena = AlignmentBatchColumn ( arena, true, arenaSize );
+        batch . arena_size = arenaSize;
+        batch . count = 0;
+        batch . arena_used = 0;
+        batch . state = NGS_AlignmentBatchState_next;
+        batch . ref_index = AlignmentBatchColumn ( ref_index, ( fields & referenceIndex ) != 0, capacity );
+        batch . cigar = AlignmentBatchColumn ( cigar, ( fields & cigarOps ) != 0, capacity );
+        batch . cigar_arena = AlignmentBatchColumn ( cigar_arena, ( fields & cigarOps ) != 0, cigarArenaSize );
+        batch . cigar_arena_size = batch . cigar_arena != 0 ? cigarArenaSize : 0;
+        batch . cigar_arena_used = 0;
+    }
+
+    inline
+    uint32_t AlignmentBatch :: size () const
+        NGS_NOTHROW
+    { return batch . count; }
+
+    inline
+    uint32_t AlignmentBatch :: Check ( uint32_t i, const void * column ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( column == 0 )
+            throw ErrorMsg ( "column was not requested for the alignment batch" );
+        if ( i >= batch . count )
+            throw ErrorMsg ( "alignment batch index is out of range" );
+        return i;
+    }
+
+    inline
+    String AlignmentBatch :: GetString ( uint32_t i, const NGS_AlignmentBatchString_v1 * column ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        const NGS_AlignmentBatchString_v1 & str = column [ Check ( i, column ) ];
+        return String ( batch . arena + str . offset, str . size );
+    }
+
+    inline
+    int64_t AlignmentBatch :: getAlignmentPosition ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return batch . position [ Check ( i, batch . position ) ]; }
+
+    inline
+    uint64_t AlignmentBatch :: getAlignmentLength ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return batch . length [ Check ( i, batch . length ) ]; }
+
+    inline
+    int AlignmentBatch :: getMappingQuality ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return batch . map_qual [ Check ( i, batch . map_qual ) ]; }
+
+    inline
+    Alignment :: AlignmentCategory AlignmentBatch :: getAlignmentCategory ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        return ( batch . flags [ Check ( i, batch . flags ) ] & NGS_AlignmentBatchFlags_primary ) != 0
+            ? Alignment :: primaryAlignment : Alignment :: secondaryAlignment;
+    }
+
+    inline
+    bool AlignmentBatch :: getIsReversedOrientation ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return ( batch . flags [ Check ( i, batch . flags ) ] & NGS_AlignmentBatchFlags_reversed ) != 0; }
+
+    inline
+    bool AlignmentBatch :: hasMate ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return ( batch . flags [ Check ( i, batch . flags ) ] & NGS_AlignmentBatchFlags_has_mate ) != 0; }
+
+    inline
+    String AlignmentBatch :: getReferenceSpec ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetString ( i, batch . ref_spec ); }
+
+    inline
+    String AlignmentBatch :: getReadId ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetString ( i, batch . read_id ); }
+
+    inline
+    String AlignmentBatch :: getFragmentBases ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetString ( i, batch . bases ); }
+
+    inline
+    String AlignmentBatch :: getFragmentQualities ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetString ( i, batch . qualities ); }
+
+    inline
+    int32_t AlignmentBatch :: getReferenceIndex ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return batch . ref_index [ Check ( i, batch . ref_index ) ]; }
+
+    inline
+    Alignment :: CigarOps AlignmentBatch :: getCigarOps ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        const NGS_AlignmentBatchString_v1 & ops = batch . cigar [ Check ( i, batch . cigar ) ];
+        Alignment :: CigarOps rslt = { batch . cigar_arena + ops . offset, ops . size };
+        return rslt;
+    }
+
+    inline
+    const int64_t * AlignmentBatch :: getAlignmentPositions () const
+        NGS_NOTHROW
+    { return batch . position; }
+
+    inline
+    const uint64_t * AlignmentBatch :: getAlignmentLengths () const
+        NGS_NOTHROW
+    { return batch . length; }
+
+    inline
+    const int32_t * AlignmentBatch :: getMappingQualities () const
+        NGS_NOTHROW
+    { return batch . map_qual; }
+
+    inline
+    const uint32_t * AlignmentBatch :: getAlignmentFlags () const
+        NGS_NOTHROW
+    { return batch . flags; }
+
+    inline
+    const int32_t * AlignmentBatch :: getReferenceIndices () const
+        NGS_NOTHROW
+    { return batch . ref_index; }
+
+    inline
+    const NGS_AlignmentBatchString_v1 * AlignmentBatch :: getFragmentBasesSpans () const
+        NGS_NOTHROW
+    { return batch . bases; }
+
+    inline
+    const NGS_AlignmentBatchString_v1 * AlignmentBatch :: getFragmentQualitiesSpans () const
+        NGS_NOTHROW
+    { return batch . qualities; }
+
+    inline
+    const NGS_AlignmentBatchString_v1 * AlignmentBatch :: getCigarSpans () const
+        NGS_NOTHROW
+    { return batch . cigar; }
+
+    inline
+    const char * AlignmentBatch :: getArena () const
+        NGS_NOTHROW
+    { return batch . arena; }
+
+    inline
+    const uint32_t * AlignmentBatch :: getCigarArena () const
+        NGS_NOTHROW
+    { return batch . cigar_arena; }
+
+} // namespace ngs
+
+#endif // _inl_ngs_alignment_batch_
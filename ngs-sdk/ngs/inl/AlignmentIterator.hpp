@@ -49,11 +49,78 @@ namespace ngs
 
     inline
     bool AlignmentIterator :: nextAlignment ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextAlignment (); }
 
+    inline
+    bool AlignmentIterator :: nextAlignmentBatch ( AlignmentBatch & batch )
+        NGS_THROWS ( ErrorMsg )
+    { return self -> nextAlignmentBatch ( batch . batch ); }
+
+    inline
+    uint32_t AlignmentIterator :: fill ( AlignmentBatch & batch, uint32_t maxRecords )
+        NGS_THROWS ( ErrorMsg )
+    {
+        uint32_t const capacity = batch . batch . capacity;
+        if ( maxRecords == 0 )
+        {
+            batch . batch . count = 0;
+            return 0;
+        }
+        if ( maxRecords < capacity )
+            batch . batch . capacity = maxRecords;
+        try
+        {
+            self -> nextAlignmentBatch ( batch . batch );
+        }
+        catch ( ... )
+        {
+            batch . batch . capacity = capacity;
+            throw;
+        }
+        batch . batch . capacity = capacity;
+        return batch . size ();
+    }
+
+    inline
+    bool AlignmentIterator :: skipTo ( int64_t refPos )
+        NGS_THROWS ( ErrorMsg )
+    { return self -> skipTo ( refPos ); }
+
+    inline
+    String AlignmentIterator :: getCursor () const
+        NGS_THROWS ( ErrorMsg )
+    { return StringRef ( self -> getCursor () ) . toString (); }
+
+    inline
+    void AlignmentIterator :: resumeFrom ( const String & cursor )
+        NGS_THROWS ( ErrorMsg )
+    { self -> resumeFrom ( cursor . c_str () ); }
+
+    inline
+    void AlignmentIterator :: reposition ( int64_t start, uint64_t length )
+        NGS_THROWS ( ErrorMsg )
+    { self -> reposition ( start, length ); }
+
 #undef self
 
+#if NGS_HAVE_MOVE
+    inline
+    AlignmentIterator :: AlignmentIterator ( AlignmentIterator && obj )
+            noexcept
+        : Alignment ( static_cast < Alignment && > ( obj ) )
+    {
+    }
+
+    inline
+    AlignmentIterator & AlignmentIterator :: operator = ( AlignmentIterator && obj )
+        noexcept
+    {
+        Alignment :: operator = ( static_cast < Alignment && > ( obj ) );
+        return * this;
+    }
+#endif
+
 }
 
 #endif // _inl_ngs_alignment_iterator_
@@ -35,6 +35,12 @@
 #include <ngs/itf/FragmentItf.hpp>
 #endif
 
+#ifndef _h_ngs_itf_fragmentitf_
+#include <ngs/itf/FragmentItf.h>
+#endif
+
+#include <string.h>
+
 
 namespace ngs
 {
@@ -45,49 +51,136 @@ namespace ngs
 
     inline
     StringRef Fragment :: getFragmentId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentId () ); }
 
+    inline
+    uint32_t Fragment :: getFragmentIndex () const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> getFragmentIndex (); }
+
     inline
     StringRef Fragment :: getFragmentBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentBases () ); }
 
     inline
     StringRef Fragment :: getFragmentBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentBases ( offset ) ); }
 
     inline
     StringRef Fragment :: getFragmentBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentBases ( offset, length ) ); }
 
     inline
     StringRef Fragment :: getFragmentQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentQualities () ); }
 
     inline
     StringRef Fragment :: getFragmentQualities ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentQualities ( offset ) ); }
 
     inline
     StringRef Fragment :: getFragmentQualities ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getFragmentQualities ( offset, length ) ); }
 
+    inline
+    StringView Fragment :: getFragmentBasesView () const
+        NGS_THROWS ( ErrorMsg )
+    { return getFragmentBasesView ( 0, -1 ); }
+
+    inline
+    StringView Fragment :: getFragmentBasesView ( uint64_t offset, uint64_t length ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_StringView_v1 view;
+        StringItf * ref = self -> getFragmentBasesView ( offset, length, view );
+        return StringView ( view, ref );
+    }
+
+    inline
+    StringView Fragment :: getFragmentQualitiesView () const
+        NGS_THROWS ( ErrorMsg )
+    { return getFragmentQualitiesView ( 0, -1 ); }
+
+    inline
+    StringView Fragment :: getFragmentQualitiesView ( uint64_t offset, uint64_t length ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_StringView_v1 view;
+        StringItf * ref = self -> getFragmentQualitiesView ( offset, length, view );
+        return StringView ( view, ref );
+    }
+
+    inline
+    Fragment :: PackedBases Fragment :: getFragmentBasesPacked ( std :: vector < uint8_t > & buffer ) const
+        NGS_THROWS ( ErrorMsg )
+    { return getFragmentBasesPacked ( 0, -1, buffer ); }
+
+    inline
+    Fragment :: PackedBases Fragment :: getFragmentBasesPacked ( uint64_t offset, uint64_t length, std :: vector < uint8_t > & buffer ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        NGS_FragmentPackedBases_v1 lent;
+        if ( self -> getFragmentBasesPacked ( offset, length, lent ) )
+        {
+            PackedBases rslt = { lent . bases, lent . count, lent . phase };
+            return rslt;
+        }
+
+        static const char codes [] = "=ACMGRSVTWYHKDBN";
+        StringView const bases = getFragmentBasesView ( offset, length );
+        buffer . assign ( ( bases . size () + 1 ) / 2, 0 );
+        for ( size_t i = 0; i < bases . size (); ++ i )
+        {
+            char c = bases . data () [ i ];
+            if ( c >= 'a' && c <= 'z' )
+                c -= 'a' - 'A';
+            const char * code = c != 0 ? strchr ( codes, c ) : 0;
+            uint8_t nibble = ( uint8_t ) ( code != 0 ? code - codes : 15 );
+            buffer [ i >> 1 ] |= ( uint8_t ) ( nibble << ( ( i & 1 ) != 0 ? 0 : 4 ) );
+        }
+
+        PackedBases rslt = { buffer . empty () ? 0 : & buffer [ 0 ], ( uint64_t ) bases . size (), 0 };
+        return rslt;
+    }
+
     inline
     bool Fragment :: isPaired () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> isPaired (); }
 
     inline
     bool Fragment :: isAligned () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> isAligned (); }
 
+#if NGS_HAVE_MOVE
+    // a moved-from Fragment holds no reference; it may only be assigned or destroyed
+
+    inline
+    Fragment :: Fragment ( Fragment && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    Fragment & Fragment :: operator = ( Fragment && obj )
+        noexcept
+    {
+        FragmentRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
@@ -45,9 +45,25 @@ namespace ngs
 
     inline
     bool FragmentIterator :: nextFragment ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextFragment (); }
 
+#if NGS_HAVE_MOVE
+    inline
+    FragmentIterator :: FragmentIterator ( FragmentIterator && obj )
+            noexcept
+        : Fragment ( static_cast < Fragment && > ( obj ) )
+    {
+    }
+
+    inline
+    FragmentIterator & FragmentIterator :: operator = ( FragmentIterator && obj )
+        noexcept
+    {
+        Fragment :: operator = ( static_cast < Fragment && > ( obj ) );
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
@@ -48,26 +48,68 @@ namespace ngs
 
     inline
     String Pileup :: getReferenceSpec () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceSpec () ) . toString (); }
 
     inline
     int64_t Pileup :: getReferencePosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getReferencePosition (); }
 
     inline
     char Pileup :: getReferenceBase () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getReferenceBase (); }
 
     inline
     uint32_t Pileup :: getPileupDepth () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getPileupDepth (); }
 
 #undef self
 
+    inline
+    void Pileup :: getColumn ( PileupColumn & column )
+        NGS_THROWS ( ErrorMsg )
+    {
+        PileupItf * pileup = reinterpret_cast < PileupItf * > ( self );
+        while ( ! pileup -> getColumn ( column . column ) )
+        {
+            // the column says how much room it needs; give it some to spare
+            NGS_PileupColumn_v1 & need = column . column;
+            if ( need . count <= need . capacity && need . arena_used <= need . arena_size )
+                throw ErrorMsg ( "pileup column was not filled" );
+            uint32_t capacity = need . capacity;
+            if ( need . count > capacity )
+                capacity = need . count / 2 > capacity ? need . count : capacity * 2;
+            uint32_t arenaSize = need . arena_size;
+            if ( need . arena_used > arenaSize )
+                arenaSize = need . arena_used / 2 > arenaSize ? need . arena_used : arenaSize * 2;
+            column . Reserve ( capacity, arenaSize );
+        }
+    }
+
+    inline
+    void Pileup :: getBaseCounts ( int minQuality, PileupBaseCounts & counts )
+        NGS_THROWS ( ErrorMsg )
+    { reinterpret_cast < PileupItf * > ( self ) -> getBaseCounts ( minQuality, 1, & counts . counts ); }
+
+#if NGS_HAVE_MOVE
+    inline
+    Pileup :: Pileup ( Pileup && obj )
+            noexcept
+        : PileupEventIterator ( static_cast < PileupEventIterator && > ( obj ) )
+    {
+    }
+
+    inline
+    Pileup & Pileup :: operator = ( Pileup && obj )
+        noexcept
+    {
+        PileupEventIterator :: operator = ( static_cast < PileupEventIterator && > ( obj ) );
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
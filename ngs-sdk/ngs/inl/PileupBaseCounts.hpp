@@ -0,0 +1,68 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_pileup_base_counts_
+#define _inl_ngs_pileup_base_counts_
+
+#ifndef _hpp_ngs_pileup_base_counts_
+#include <ngs/PileupBaseCounts.hpp>
+#endif
+
+#include <string.h>
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * PileupBaseCounts
+     */
+
+    inline
+    int64_t PileupBaseCounts :: getReferencePosition () const
+        NGS_NOTHROW
+    { return counts . position; }
+
+    inline
+    uint32_t PileupBaseCounts :: getCount ( BaseKind kind, Strand strands ) const
+        NGS_NOTHROW
+    {
+        uint32_t n = 0;
+        if ( ( strands & plusStrand ) != 0 )
+            n += counts . plus [ kind ];
+        if ( ( strands & minusStrand ) != 0 )
+            n += counts . minus [ kind ];
+        return n;
+    }
+
+    inline
+    PileupBaseCounts :: PileupBaseCounts ()
+        NGS_NOTHROW
+    {
+        memset ( & counts, 0, sizeof counts );
+    }
+
+} // namespace ngs
+
+#endif // _inl_ngs_pileup_base_counts_
@@ -0,0 +1,156 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_pileup_column_
+#define _inl_ngs_pileup_column_
+
+#ifndef _hpp_ngs_pileup_column_
+#include <ngs/PileupColumn.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * PileupColumn
+     */
+
+    template < class T >
+    inline
+    T * PileupColumnField ( std :: vector < T > & column, bool wanted, uint32_t capacity )
+    {
+        if ( ! wanted || capacity == 0 )
+            return 0;
+        column . resize ( capacity );
+        return & column [ 0 ];
+    }
+
+    inline
+    PileupColumn :: PileupColumn ( uint32_t fields, uint32_t capacity, uint32_t arenaSize )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( capacity == 0 )
+            throw ErrorMsg ( "pileup column capacity is 0" );
+
+        column . fields = fields;
+        column . count = 0;
+        column . arena_used = 0;
+        Reserve ( capacity, arenaSize );
+    }
+
+    inline
+    void PileupColumn :: Reserve ( uint32_t capacity, uint32_t arenaSize )
+        NGS_THROWS ( ErrorMsg )
+    {
+        uint32_t const fields = column . fields;
+
+        column . capacity = capacity;
+        column . event_type = PileupColumnField ( event_type, ( fields & eventType ) != 0, capacity );
+        column . base = PileupColumnField ( base, ( fields & alignmentBase ) != 0, capacity );
+        column . qual = PileupColumnField ( qual, ( fields & alignmentQuality ) != 0, capacity );
+        column . map_qual = PileupColumnField ( map_qual, ( fields & mappingQuality ) != 0, capacity );
+        column . ins_bases = PileupColumnField ( ins_bases, ( fields & insertionBases ) != 0, capacity );
+        column . ins_quals = PileupColumnField ( ins_quals, ( fields & insertionQualities ) != 0, capacity );
+        column . arena = PileupColumnField ( arena, true, arenaSize );
+        column . arena_size = arenaSize;
+    }
+
+    inline
+    uint32_t PileupColumn :: size () const
+        NGS_NOTHROW
+    { return column . count; }
+
+    inline
+    uint32_t PileupColumn :: Check ( uint32_t i, const void * field ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( field == 0 )
+            throw ErrorMsg ( "column was not requested for the pileup column" );
+        if ( i >= column . count )
+            throw ErrorMsg ( "pileup column index is out of range" );
+        return i;
+    }
+
+    inline
+    StringView PileupColumn :: GetString ( uint32_t i, const NGS_PileupColumnString_v1 * field ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        const NGS_PileupColumnString_v1 & str = field [ Check ( i, field ) ];
+        return StringView ( column . arena + str . offset, str . size );
+    }
+
+    inline
+    PileupEvent :: PileupEventType PileupColumn :: getEventType ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return ( PileupEvent :: PileupEventType ) column . event_type [ Check ( i, column . event_type ) ]; }
+
+    inline
+    char PileupColumn :: getAlignmentBase ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return column . base [ Check ( i, column . base ) ]; }
+
+    inline
+    char PileupColumn :: getAlignmentQuality ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return column . qual [ Check ( i, column . qual ) ]; }
+
+    inline
+    int PileupColumn :: getMappingQuality ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return column . map_qual [ Check ( i, column . map_qual ) ]; }
+
+    inline
+    StringView PileupColumn :: getInsertionBases ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetString ( i, column . ins_bases ); }
+
+    inline
+    StringView PileupColumn :: getInsertionQualities ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetString ( i, column . ins_quals ); }
+
+    inline
+    const uint32_t * PileupColumn :: getEventTypes () const
+        NGS_NOTHROW
+    { return column . event_type; }
+
+    inline
+    const char * PileupColumn :: getAlignmentBases () const
+        NGS_NOTHROW
+    { return column . base; }
+
+    inline
+    const char * PileupColumn :: getAlignmentQualities () const
+        NGS_NOTHROW
+    { return column . qual; }
+
+    inline
+    const int32_t * PileupColumn :: getMappingQualities () const
+        NGS_NOTHROW
+    { return column . map_qual; }
+
+} // namespace ngs
+
+#endif // _inl_ngs_pileup_column_
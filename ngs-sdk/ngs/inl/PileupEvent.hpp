@@ -44,64 +44,95 @@ namespace ngs
 
     inline
     int PileupEvent :: getMappingQuality () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getMappingQuality (); }
 
+    inline
+    int32_t PileupEvent :: getReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> getReferenceIndex (); }
+
+    inline
+    int32_t PileupEvent :: getMateReferenceIndex () const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> getMateReferenceIndex (); }
+
     inline
     StringRef PileupEvent :: getAlignmentId () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getAlignmentId () ); }
 
     inline
     int64_t PileupEvent :: getAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentPosition (); }
 
     inline
     int64_t PileupEvent :: getFirstAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getFirstAlignmentPosition (); }
 
     inline
     int64_t PileupEvent :: getLastAlignmentPosition () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getLastAlignmentPosition (); }
 
     inline
     PileupEvent :: PileupEventType PileupEvent :: getEventType () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ( PileupEvent :: PileupEventType ) self -> getEventType (); }
 
     inline
     char PileupEvent :: getAlignmentBase () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentBase (); }
 
     inline
     char PileupEvent :: getAlignmentQuality () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentQuality (); }
 
     inline
     StringRef PileupEvent :: getInsertionBases () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getInsertionBases () ); }
 
     inline
     StringRef PileupEvent :: getInsertionQualities () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getInsertionQualities () ); }
 
     inline
     uint32_t PileupEvent :: getEventRepeatCount () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getEventRepeatCount (); }
 
     inline
     PileupEvent :: EventIndelType PileupEvent :: getEventIndelType () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ( PileupEvent :: EventIndelType ) self -> getEventIndelType (); }
 
+#if NGS_HAVE_MOVE
+    // a moved-from PileupEvent holds no reference; it may only be assigned or destroyed
+
+    inline
+    PileupEvent :: PileupEvent ( PileupEvent && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    PileupEvent & PileupEvent :: operator = ( PileupEvent && obj )
+        noexcept
+    {
+        PileupEventRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
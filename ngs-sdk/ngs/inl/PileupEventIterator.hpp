@@ -43,14 +43,30 @@ namespace ngs
 
     inline
     bool PileupEventIterator :: nextPileupEvent ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextPileupEvent (); }
 
     inline
     void PileupEventIterator :: resetPileupEvent ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> resetPileupEvent (); }
 
+#if NGS_HAVE_MOVE
+    inline
+    PileupEventIterator :: PileupEventIterator ( PileupEventIterator && obj )
+            noexcept
+        : PileupEvent ( static_cast < PileupEvent && > ( obj ) )
+    {
+    }
+
+    inline
+    PileupEventIterator & PileupEventIterator :: operator = ( PileupEventIterator && obj )
+        noexcept
+    {
+        PileupEvent :: operator = ( static_cast < PileupEvent && > ( obj ) );
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
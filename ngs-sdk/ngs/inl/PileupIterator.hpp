@@ -48,11 +48,41 @@ namespace ngs
 
     inline
     bool PileupIterator :: nextPileup ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextPileup (); }
 
+    inline
+    uint32_t PileupIterator :: nextBaseCounts ( int minQuality, PileupBaseCounts * counts, uint32_t count )
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( count == 0 || ! self -> nextPileup () )
+            return 0;
+        return self -> getBaseCounts ( minQuality, count, & counts -> counts );
+    }
+
+    inline
+    void PileupIterator :: extendTo ( int64_t newEnd )
+        NGS_THROWS ( ErrorMsg )
+    { self -> extendTo ( newEnd ); }
+
 #undef self
 
+#if NGS_HAVE_MOVE
+    inline
+    PileupIterator :: PileupIterator ( PileupIterator && obj )
+            noexcept
+        : Pileup ( static_cast < Pileup && > ( obj ) )
+    {
+    }
+
+    inline
+    PileupIterator & PileupIterator :: operator = ( PileupIterator && obj )
+        noexcept
+    {
+        Pileup :: operator = ( static_cast < Pileup && > ( obj ) );
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
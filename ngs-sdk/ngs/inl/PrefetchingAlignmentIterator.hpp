@@ -0,0 +1,110 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_prefetching_alignment_iterator_
+#define _inl_ngs_prefetching_alignment_iterator_
+
+#ifndef _hpp_ngs_prefetching_alignment_iterator_
+#include <ngs/PrefetchingAlignmentIterator.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * PrefetchingAlignmentIterator
+     */
+
+    inline
+    bool PrefetchingAlignmentIterator :: nextAlignment ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( batch != 0 && ++ idx < batch -> size () )
+            return true;
+        return NextBatch ();
+    }
+
+    inline
+    const AlignmentBatch & PrefetchingAlignmentIterator :: Current () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( batch == 0 )
+            throw ErrorMsg ( "no current alignment" );
+        return * batch;
+    }
+
+    inline
+    int64_t PrefetchingAlignmentIterator :: getAlignmentPosition () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getAlignmentPosition ( idx ); }
+
+    inline
+    uint64_t PrefetchingAlignmentIterator :: getAlignmentLength () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getAlignmentLength ( idx ); }
+
+    inline
+    int PrefetchingAlignmentIterator :: getMappingQuality () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getMappingQuality ( idx ); }
+
+    inline
+    Alignment :: AlignmentCategory PrefetchingAlignmentIterator :: getAlignmentCategory () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getAlignmentCategory ( idx ); }
+
+    inline
+    bool PrefetchingAlignmentIterator :: getIsReversedOrientation () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getIsReversedOrientation ( idx ); }
+
+    inline
+    bool PrefetchingAlignmentIterator :: hasMate () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . hasMate ( idx ); }
+
+    inline
+    String PrefetchingAlignmentIterator :: getReferenceSpec () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getReferenceSpec ( idx ); }
+
+    inline
+    String PrefetchingAlignmentIterator :: getReadId () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getReadId ( idx ); }
+
+    inline
+    String PrefetchingAlignmentIterator :: getFragmentBases () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getFragmentBases ( idx ); }
+
+    inline
+    String PrefetchingAlignmentIterator :: getFragmentQualities () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . getFragmentQualities ( idx ); }
+
+} // namespace ngs
+
+#endif // _inl_ngs_prefetching_alignment_iterator_
@@ -0,0 +1,104 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_prefetching_read_iterator_
+#define _inl_ngs_prefetching_read_iterator_
+
+#ifndef _hpp_ngs_prefetching_read_iterator_
+#include <ngs/PrefetchingReadIterator.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * PrefetchingReadIterator
+     */
+
+    inline
+    bool PrefetchingReadIterator :: nextRead ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( current != 0 && ++ current < end )
+            return true;
+        return NextBatch ();
+    }
+
+    inline
+    const PrefetchingReadIterator :: Snapshot & PrefetchingReadIterator :: Current () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( current == 0 )
+            throw ErrorMsg ( "no current read" );
+        return * current;
+    }
+
+    inline
+    const String & PrefetchingReadIterator :: Field ( const String & value, ReadField field ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ( fields & field ) == 0 )
+            throw ErrorMsg ( "field was not requested for the prefetching read iterator" );
+        return value;
+    }
+
+    inline
+    const String & PrefetchingReadIterator :: getReadId () const
+        NGS_THROWS ( ErrorMsg )
+    { return Field ( Current () . id, readId ); }
+
+    inline
+    uint32_t PrefetchingReadIterator :: getNumFragments () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . fragments; }
+
+    inline
+    Read :: ReadCategory PrefetchingReadIterator :: getReadCategory () const
+        NGS_THROWS ( ErrorMsg )
+    { return Current () . category; }
+
+    inline
+    const String & PrefetchingReadIterator :: getReadGroup () const
+        NGS_THROWS ( ErrorMsg )
+    { return Field ( Current () . group, readGroup ); }
+
+    inline
+    const String & PrefetchingReadIterator :: getReadName () const
+        NGS_THROWS ( ErrorMsg )
+    { return Field ( Current () . name, readName ); }
+
+    inline
+    const String & PrefetchingReadIterator :: getReadBases () const
+        NGS_THROWS ( ErrorMsg )
+    { return Field ( Current () . bases, readBases ); }
+
+    inline
+    const String & PrefetchingReadIterator :: getReadQualities () const
+        NGS_THROWS ( ErrorMsg )
+    { return Field ( Current () . qualities, readQualities ); }
+
+} // namespace ngs
+
+#endif // _inl_ngs_prefetching_read_iterator_
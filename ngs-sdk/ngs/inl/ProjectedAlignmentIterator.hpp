@@ -0,0 +1,71 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_projected_alignment_iterator_
+#define _inl_ngs_projected_alignment_iterator_
+
+#ifndef _hpp_ngs_projected_alignment_iterator_
+#include <ngs/ProjectedAlignmentIterator.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * ProjectedAlignmentIterator
+     */
+
+    template < class F1, class F2, class F3, class F4, class F5, class F6, class F7, class F8 >
+    inline
+    bool ProjectedAlignmentIterator < F1, F2, F3, F4, F5, F6, F7, F8 > :: nextAlignment ()
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ! it . nextAlignment () )
+            return false;
+
+        // a lone field of the core is cheaper asked for by itself
+        if ( Fields :: cores > 1 )
+        {
+            const Alignment :: Core core = it . getCore ();
+            Fields :: Fetch ( it, & core );
+        }
+        else
+        {
+            Fields :: Fetch ( it, 0 );
+        }
+        return true;
+    }
+
+    template < class F1, class F2, class F3, class F4, class F5, class F6, class F7, class F8 >
+    inline
+    ProjectedAlignmentIterator < F1, F2, F3, F4, F5, F6, F7, F8 > :: ProjectedAlignmentIterator ( const AlignmentIterator & It )
+        NGS_THROWS ( ErrorMsg )
+        : it ( It )
+    {
+    }
+
+} // namespace ngs
+
+#endif // _inl_ngs_projected_alignment_iterator_
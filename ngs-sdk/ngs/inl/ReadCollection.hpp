@@ -44,99 +44,155 @@ namespace ngs
 
 	inline
     String ReadCollection :: getName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getName () ) . toString (); }
 
 	inline
     ReadGroupIterator ReadCollection :: getReadGroups () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ReadGroupIterator ( self -> getReadGroups () ); }
 
 	inline
     bool ReadCollection :: hasReadGroup ( const String & spec ) const
-        throw ()
+        NGS_NOTHROW
     { return self -> hasReadGroup ( spec . c_str () ); }
 
 	inline
     ReadGroup ReadCollection :: getReadGroup ( const String & spec ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ReadGroup ( self -> getReadGroup ( spec . c_str () ) ); }
 
 	inline
     ReferenceIterator ReadCollection :: getReferences () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ReferenceIterator ( self -> getReferences () ); }
 
 	inline
     bool ReadCollection :: hasReference ( const String & spec ) const
-        throw ()
+        NGS_NOTHROW
     { return self -> hasReference ( spec . c_str () ); }
 
 	inline
     Reference ReadCollection :: getReference ( const String & spec ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return Reference ( self -> getReference ( spec . c_str () ) ); }
 
 	inline
     Alignment ReadCollection :: getAlignment ( const String & alignmentId ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return Alignment ( ( AlignmentRef ) self -> getAlignment ( alignmentId . c_str () ) ); }
 
 	inline
     AlignmentIterator ReadCollection :: getAlignments ( Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignments ( ( uint32_t ) categories ) ); }
 
 	inline
     uint64_t ReadCollection :: getAlignmentCount () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentCount ( ( uint32_t ) Alignment :: all ); }
 
 	inline
     uint64_t ReadCollection :: getAlignmentCount ( Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentCount ( ( uint32_t ) categories ); }
 
 	inline
     AlignmentIterator ReadCollection :: getAlignmentRange ( uint64_t first, uint64_t count ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignmentRange ( first, count, ( uint32_t ) Alignment :: all ) ); }
 
 	inline
     AlignmentIterator ReadCollection :: getAlignmentRange ( uint64_t first, uint64_t count, Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignmentRange ( first, count, ( uint32_t ) categories ) ); }
 
+	inline
+    AlignmentIterator ReadCollection :: getAlignmentShard ( uint32_t shard, uint32_t count, Alignment :: AlignmentCategory categories ) const
+        NGS_THROWS ( ErrorMsg )
+    { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignmentShard ( shard, count, ( uint32_t ) categories ) ); }
+
 	inline
     Read ReadCollection :: getRead ( const String & readId ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return Read ( ( ReadRef ) self -> getRead ( readId . c_str () ) ); }
 
 	inline
     ReadIterator ReadCollection :: getReads ( Read :: ReadCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ReadIterator ( ( ReadRef ) self -> getReads ( ( uint32_t ) categories ) ); }
 
 	inline
     uint64_t ReadCollection :: getReadCount () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getReadCount ( ( uint32_t ) Read :: all ); }
 
 	inline
     uint64_t ReadCollection :: getReadCount ( Read :: ReadCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getReadCount ( ( uint32_t ) categories ); }
 
 	inline
     ReadIterator ReadCollection :: getReadRange ( uint64_t first, uint64_t count ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ReadIterator ( ( ReadRef ) self -> getReadRange ( first, count ) ); }
 
 	inline
     ReadIterator ReadCollection :: getReadRange ( uint64_t first, uint64_t count, Read :: ReadCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return ReadIterator ( ( ReadRef ) self -> getReadRange ( first, count, ( uint32_t ) categories ) ); }
-    
+
+	inline
+    bool ReadCollection :: supports ( Feature feature ) const
+        NGS_THROWS ( ErrorMsg )
+    { return ( self -> getFeatures () & ( uint32_t ) feature ) == ( uint32_t ) feature; }
+
+	inline
+    Statistics ReadCollection :: getStatistics () const
+        NGS_THROWS ( ErrorMsg )
+    { return Statistics ( self -> getStatistics () ); }
+
+	inline
+    ReferenceTable ReadCollection :: getReferenceTable () const
+        NGS_THROWS ( ErrorMsg )
+    {
+        ReferenceTable table;
+        getReferenceTable ( table );
+        return table;
+    }
+
+	inline
+    void ReadCollection :: getReferenceTable ( ReferenceTable & table ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        // a table that was too small has grown to what is needed, so a second try fits
+        NGS_ReferenceTable_v1 columns = table . Columns ();
+        while ( ! table . Keep ( columns, self -> getReferenceTable ( columns ) ) )
+            columns = table . Columns ();
+    }
+
+#if NGS_HAVE_MOVE
+    // a moved-from ReadCollection holds no reference; it may only be assigned or destroyed
+
+    inline
+    ReadCollection :: ReadCollection ( ReadCollection && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    ReadCollection & ReadCollection :: operator = ( ReadCollection && obj )
+        noexcept
+    {
+        ReadCollectionRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _hpp_ngs_itf_collection_
@@ -44,14 +44,36 @@ namespace ngs
 
     inline
     String ReadGroup :: getName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getName () ) . toString (); }
 
     inline
     Statistics ReadGroup :: getStatistics () const 
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return Statistics ( self -> getStatistics () ); }
 
+#if NGS_HAVE_MOVE
+    // a moved-from ReadGroup holds no reference; it may only be assigned or destroyed
+
+    inline
+    ReadGroup :: ReadGroup ( ReadGroup && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    ReadGroup & ReadGroup :: operator = ( ReadGroup && obj )
+        noexcept
+    {
+        ReadGroupRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_itf_group_
@@ -44,9 +44,26 @@ namespace ngs
 
     inline
     bool ReadGroupIterator :: nextReadGroup ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextReadGroup (); }
 
+#if NGS_HAVE_MOVE
+    inline
+    ReadGroupIterator :: ReadGroupIterator ( ReadGroupIterator && obj )
+            noexcept
+        : ReadGroup ( static_cast < ReadGroup && > ( obj ) )
+    {
+    }
+
+    inline
+    ReadGroupIterator & ReadGroupIterator :: operator = ( ReadGroupIterator && obj )
+        noexcept
+    {
+        ReadGroup :: operator = ( static_cast < ReadGroup && > ( obj ) );
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_itf_group_iterator_
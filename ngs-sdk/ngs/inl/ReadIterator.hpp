@@ -44,12 +44,39 @@ namespace ngs
 
     inline
     bool ReadIterator :: nextRead ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextRead (); }
 
+    inline
+    String ReadIterator :: getCursor () const
+        NGS_THROWS ( ErrorMsg )
+    { return StringRef ( self -> getCursor () ) . toString (); }
+
+    inline
+    void ReadIterator :: resumeFrom ( const String & cursor )
+        NGS_THROWS ( ErrorMsg )
+    { self -> resumeFrom ( cursor . c_str () ); }
+
 
 #undef self
 
+#if NGS_HAVE_MOVE
+    inline
+    ReadIterator :: ReadIterator ( ReadIterator && obj )
+            noexcept
+        : Read ( static_cast < Read && > ( obj ) )
+    {
+    }
+
+    inline
+    ReadIterator & ReadIterator :: operator = ( ReadIterator && obj )
+        noexcept
+    {
+        Read :: operator = ( static_cast < Read && > ( obj ) );
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_read_iterator_
@@ -44,104 +44,179 @@ namespace ngs
 
     inline
     String Reference :: getCommonName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getCommonName () ) . toString (); }
 
     inline
     String Reference :: getCanonicalName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getCanonicalName () ) . toString (); }
 
     inline
     bool Reference :: getIsCircular () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getIsCircular (); }
 
     inline
     uint64_t Reference :: getLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getLength (); }
 
     inline
     String Reference :: getReferenceBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceBases ( offset ) ) . toString (); }
 
     inline
     String Reference :: getReferenceBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceBases ( offset, length ) ) . toString (); }
 
     inline
     StringRef Reference :: getReferenceChunk ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceChunk ( offset ) ); }
 
     inline
     StringRef Reference :: getReferenceChunk ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceChunk ( offset, length ) ); }
 
+    inline
+    uint64_t Reference :: copyReferenceBases ( uint64_t offset, char * buffer, uint64_t size ) const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> copyReferenceBases ( offset, buffer, size ); }
+
+    inline
+    uint64_t Reference :: getReferenceBasesPacked ( uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * nMask ) const
+        NGS_THROWS ( ErrorMsg )
+    { return self -> getReferenceBasesPacked ( offset, length, bases, nMask ); }
+
     inline
     uint64_t Reference :: getAlignmentCount () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentCount (); }
 
     inline
     uint64_t Reference :: getAlignmentCount ( Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAlignmentCount ( ( uint32_t ) categories ); }
 
+    inline
+    Reference :: SliceEstimate Reference :: estimateSlice ( int64_t start, uint64_t length ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        SliceEstimate estimate;
+        self -> estimateSlice ( start, length, estimate . alignments, estimate . bytes );
+        return estimate;
+    }
+
     inline
     Alignment Reference :: getAlignment ( const String & alignmentId ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return Alignment ( ( AlignmentRef ) self -> getAlignment ( alignmentId . c_str () ) ); }
 
     inline
     AlignmentIterator Reference :: getAlignments ( Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignments ( ( uint32_t ) categories ) ); }
 
     inline
     AlignmentIterator Reference :: getAlignmentSlice ( int64_t start, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignmentSlice ( start, length ) ); }
 
     inline
     AlignmentIterator Reference :: getAlignmentSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignmentSlice ( start, length, ( uint32_t ) categories ) ); }
 
     inline
     AlignmentIterator Reference :: getFilteredAlignmentSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return AlignmentIterator ( ( AlignmentRef ) self -> getFilteredAlignmentSlice ( start, length, ( uint32_t ) categories, ( uint32_t ) filters, mappingQuality ) ); }
 
+    inline
+    AlignmentIterator Reference :: getAlignmentShard ( uint32_t shard, uint32_t count, Alignment :: AlignmentCategory categories ) const
+        NGS_THROWS ( ErrorMsg )
+    { return AlignmentIterator ( ( AlignmentRef ) self -> getAlignmentShard ( shard, count, ( uint32_t ) categories ) ); }
+
     inline
     PileupIterator Reference :: getPileups ( Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return PileupIterator ( ( PileupRef ) self -> getPileups ( ( uint32_t ) categories ) ); }
 
     inline
     PileupIterator Reference :: getFilteredPileups ( Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return PileupIterator ( ( PileupRef ) self -> getFilteredPileups ( ( uint32_t ) categories, ( uint32_t ) filters, mappingQuality ) ); }
     
     inline
     PileupIterator Reference :: getPileupSlice ( int64_t start, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return PileupIterator ( ( PileupRef ) self -> getPileupSlice ( start, length ) ); }
 
     inline
     PileupIterator Reference :: getPileupSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return PileupIterator ( ( PileupRef ) self -> getPileupSlice ( start, length, ( uint32_t ) categories ) ); }
 
     inline
     PileupIterator Reference :: getFilteredPileupSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return PileupIterator ( ( PileupRef ) self -> getFilteredPileupSlice ( start, length, ( uint32_t ) categories, ( uint32_t ) filters, mappingQuality ) ); }
 
+    inline
+    PileupIterator Reference :: getFilteredPileupSlice ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality,
+            uint32_t maxDepth, uint64_t seed, bool skipEmpty ) const
+        NGS_THROWS ( ErrorMsg )
+    { return PileupIterator ( ( PileupRef ) self -> getFilteredPileupSlice ( start, length, ( uint32_t ) categories, ( uint32_t ) filters, mappingQuality, maxDepth, seed, skipEmpty ) ); }
+
+    inline
+    bool Reference :: supports ( Feature feature ) const
+        NGS_THROWS ( ErrorMsg )
+    { return ( self -> getFeatures () & ( uint32_t ) feature ) == ( uint32_t ) feature; }
+
+    inline
+    std :: vector < uint32_t > Reference :: getCoverage ( int64_t start, uint64_t length, Alignment :: AlignmentCategory categories, Alignment :: AlignmentFilter filters, int32_t mappingQuality ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( start < 0 )
+            throw ErrorMsg ( "the window starts before the reference" );
+
+        uint64_t end = self -> getLength ();
+        if ( ( uint64_t ) start >= end )
+            return std :: vector < uint32_t > ();
+        if ( length < end - start )
+            end = start + length;
+
+        std :: vector < uint32_t > depth ( ( size_t ) ( end - start ) );
+        self -> getCoverage ( start, end - start, ( uint32_t ) categories, ( uint32_t ) filters, mappingQuality, & depth [ 0 ] );
+        return depth;
+    }
+
+#if NGS_HAVE_MOVE
+    // a moved-from Reference holds no reference; it may only be assigned or destroyed
+
+    inline
+    Reference :: Reference ( Reference && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    Reference & Reference :: operator = ( Reference && obj )
+        noexcept
+    {
+        ReferenceRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_reference_
@@ -44,9 +44,25 @@ namespace ngs
 
     inline
     bool ReferenceIterator :: nextReference ()
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> nextReference (); }
 
+#if NGS_HAVE_MOVE
+    inline
+    ReferenceIterator :: ReferenceIterator ( ReferenceIterator && obj )
+            noexcept
+        : Reference ( static_cast < Reference && > ( obj ) )
+    {
+    }
+
+    inline
+    ReferenceIterator & ReferenceIterator :: operator = ( ReferenceIterator && obj )
+        noexcept
+    {
+        Reference :: operator = ( static_cast < Reference && > ( obj ) );
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
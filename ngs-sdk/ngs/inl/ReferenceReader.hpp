@@ -0,0 +1,70 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+
+#ifndef _inl_ngs_reference_reader_
+#define _inl_ngs_reference_reader_
+
+#ifndef _hpp_ngs_reference_reader_
+#include <ngs/ReferenceReader.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * ReferenceReader
+     */
+
+    inline
+    uint64_t ReferenceReader :: read ( char * buffer, uint64_t size )
+        NGS_THROWS ( ErrorMsg )
+    {
+        uint64_t copied = ref . copyReferenceBases ( offset, buffer, size );
+        offset += copied;
+        return copied;
+    }
+
+    inline
+    uint64_t ReferenceReader :: getOffset () const
+        NGS_NOTHROW
+    { return offset; }
+
+    inline
+    void ReferenceReader :: seek ( uint64_t Offset )
+        NGS_NOTHROW
+    { offset = Offset; }
+
+    inline
+    ReferenceReader :: ReferenceReader ( const Reference & Ref, uint64_t Offset )
+        NGS_THROWS ( ErrorMsg )
+        : ref ( Ref )
+        , offset ( Offset )
+    {
+    }
+
+} // namespace ngs
+
+#endif // _inl_ngs_reference_reader_
@@ -44,39 +44,61 @@ namespace ngs
 
     inline
     String ReferenceSequence :: getCanonicalName () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getCanonicalName () ) . toString (); }
 
     inline
     bool ReferenceSequence :: getIsCircular () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getIsCircular (); }
 
     inline
     uint64_t ReferenceSequence :: getLength () const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getLength (); }
 
     inline
     String ReferenceSequence :: getReferenceBases ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceBases ( offset ) ) . toString (); }
 
     inline
     String ReferenceSequence :: getReferenceBases ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceBases ( offset, length ) ) . toString (); }
 
     inline
     StringRef ReferenceSequence :: getReferenceChunk ( uint64_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceChunk ( offset ) ); }
 
     inline
     StringRef ReferenceSequence :: getReferenceChunk ( uint64_t offset, uint64_t length ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getReferenceChunk ( offset, length ) ); }
 
+#if NGS_HAVE_MOVE
+    // a moved-from ReferenceSequence holds no reference; it may only be assigned or destroyed
+
+    inline
+    ReferenceSequence :: ReferenceSequence ( ReferenceSequence && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    ReferenceSequence & ReferenceSequence :: operator = ( ReferenceSequence && obj )
+        noexcept
+    {
+        ReferenceSequenceRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_reference_sequence_
@@ -0,0 +1,212 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_reference_table_
+#define _inl_ngs_reference_table_
+
+#ifndef _hpp_ngs_reference_table_
+#include <ngs/ReferenceTable.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * ReferenceTable
+     */
+
+    template < class T >
+    inline
+    T * ReferenceTableColumn ( std :: vector < T > & column )
+    {
+        return column . empty () ? 0 : & column [ 0 ];
+    }
+
+    inline
+    ReferenceTable :: ReferenceTable ( uint32_t _fields, uint32_t capacity, uint32_t arenaSize )
+        NGS_THROWS ( ErrorMsg )
+        : fields ( _fields & allFields )
+        , filled ( 0 )
+        , count ( 0 )
+    {
+        if ( fields == 0 )
+            throw ErrorMsg ( "no reference table fields were asked for" );
+
+        if ( ( fields & commonName ) != 0 )
+            common_name . resize ( capacity );
+        if ( ( fields & canonicalName ) != 0 )
+            canonical_name . resize ( capacity );
+        if ( ( fields & referenceLength ) != 0 )
+            length . resize ( capacity );
+        if ( ( fields & circular ) != 0 )
+            circular_flag . resize ( capacity );
+        if ( ( fields & ( commonName | canonicalName ) ) != 0 )
+            arena . resize ( arenaSize );
+    }
+
+    inline
+    NGS_ReferenceTable_v1 ReferenceTable :: Columns ()
+        NGS_NOTHROW
+    {
+        NGS_ReferenceTable_v1 table;
+        table . fields = fields;
+        table . capacity = 0;
+        table . common_name = ReferenceTableColumn ( common_name );
+        table . canonical_name = ReferenceTableColumn ( canonical_name );
+        table . length = ReferenceTableColumn ( length );
+        table . circular = ReferenceTableColumn ( circular_flag );
+        table . arena = ReferenceTableColumn ( arena );
+        table . arena_size = ( uint32_t ) arena . size ();
+        table . count = 0;
+        table . arena_used = 0;
+        table . filled = 0;
+
+        // every column asked for has the same room
+        if ( ! common_name . empty () )
+            table . capacity = ( uint32_t ) common_name . size ();
+        else if ( ! canonical_name . empty () )
+            table . capacity = ( uint32_t ) canonical_name . size ();
+        else if ( ! length . empty () )
+            table . capacity = ( uint32_t ) length . size ();
+        else
+            table . capacity = ( uint32_t ) circular_flag . size ();
+
+        return table;
+    }
+
+    inline
+    bool ReferenceTable :: Keep ( const NGS_ReferenceTable_v1 & table, bool fit )
+        NGS_THROWS ( ErrorMsg )
+    {
+        count = table . count;
+        filled = table . filled & fields;
+        if ( fit )
+            return true;
+
+        filled = 0;
+        if ( table . count <= table . capacity && table . arena_used <= table . arena_size )
+            throw ErrorMsg ( "the reference table did not fit, but no more room was asked for" );
+
+        if ( table . count > table . capacity )
+        {
+            if ( ( fields & commonName ) != 0 )
+                common_name . resize ( table . count );
+            if ( ( fields & canonicalName ) != 0 )
+                canonical_name . resize ( table . count );
+            if ( ( fields & referenceLength ) != 0 )
+                length . resize ( table . count );
+            if ( ( fields & circular ) != 0 )
+                circular_flag . resize ( table . count );
+        }
+        if ( table . arena_used > table . arena_size )
+            arena . resize ( table . arena_used );
+
+        count = 0;
+        return false;
+    }
+
+    inline
+    uint32_t ReferenceTable :: size () const
+        NGS_NOTHROW
+    { return count; }
+
+    inline
+    bool ReferenceTable :: has ( TableField field ) const
+        NGS_NOTHROW
+    { return ( filled & ( uint32_t ) field ) == ( uint32_t ) field; }
+
+    inline
+    void ReferenceTable :: Check ( uint32_t i, TableField field ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        if ( ! has ( field ) )
+            throw ErrorMsg ( "column is not in the reference table" );
+        if ( i >= count )
+            throw ErrorMsg ( "reference table index is out of range" );
+    }
+
+    inline
+    String ReferenceTable :: GetName ( uint32_t i, const std :: vector < NGS_ReferenceTableString_v1 > & column, TableField field ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        Check ( i, field );
+        const NGS_ReferenceTableString_v1 & str = column [ i ];
+        return str . size == 0 ? String () : String ( & arena [ str . offset ], str . size );
+    }
+
+    inline
+    String ReferenceTable :: getCommonName ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetName ( i, common_name, commonName ); }
+
+    inline
+    String ReferenceTable :: getCanonicalName ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    { return GetName ( i, canonical_name, canonicalName ); }
+
+    inline
+    uint64_t ReferenceTable :: getLength ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        Check ( i, referenceLength );
+        return length [ i ];
+    }
+
+    inline
+    bool ReferenceTable :: getIsCircular ( uint32_t i ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        Check ( i, circular );
+        return circular_flag [ i ] != 0;
+    }
+
+    inline
+    const uint64_t * ReferenceTable :: getLengths () const
+        NGS_NOTHROW
+    { return has ( referenceLength ) && count != 0 ? & length [ 0 ] : 0; }
+
+    inline
+    const uint8_t * ReferenceTable :: getCircular () const
+        NGS_NOTHROW
+    { return has ( circular ) && count != 0 ? & circular_flag [ 0 ] : 0; }
+
+    inline
+    const NGS_ReferenceTableString_v1 * ReferenceTable :: getCommonNameSpans () const
+        NGS_NOTHROW
+    { return has ( commonName ) && count != 0 ? & common_name [ 0 ] : 0; }
+
+    inline
+    const NGS_ReferenceTableString_v1 * ReferenceTable :: getCanonicalNameSpans () const
+        NGS_NOTHROW
+    { return has ( canonicalName ) && count != 0 ? & canonical_name [ 0 ] : 0; }
+
+    inline
+    const char * ReferenceTable :: getArena () const
+        NGS_NOTHROW
+    { return arena . empty () ? 0 : & arena [ 0 ]; }
+
+} // namespace ngs
+
+#endif // _inl_ngs_reference_table_
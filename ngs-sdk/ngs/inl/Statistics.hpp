@@ -35,6 +35,10 @@
 #include <ngs/itf/StatisticsItf.hpp>
 #endif
 
+#ifndef _h_ngs_itf_statisticsitf_
+#include <ngs/itf/StatisticsItf.h>
+#endif
+
 namespace ngs
 {
 
@@ -44,34 +48,111 @@ namespace ngs
 
     inline
     Statistics :: ValueType Statistics :: getValueType ( const String & path ) const
-        throw ()
+        NGS_NOTHROW
     { return ( Statistics :: ValueType ) self -> getValueType ( path . c_str () ); }
 
     inline
     String Statistics :: getAsString ( const String & path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> getAsString ( path . c_str () ) ) . toString (); }
 
     inline
     int64_t Statistics :: getAsI64 ( const String & path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAsI64 ( path . c_str () ); }
 
     inline
     uint64_t Statistics :: getAsU64 ( const String & path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAsU64 ( path . c_str () ); }
 
     inline
     double Statistics :: getAsDouble ( const String & path ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return self -> getAsDouble ( path . c_str () ); }
 
     inline
     String Statistics :: nextPath ( const String & path ) const
-        throw ()
+        NGS_NOTHROW
     { return StringRef ( self -> nextPath ( path . c_str () ) ) . toString (); }
 
+    inline
+    void Statistics :: getAll ( std :: vector < Entry > & entries ) const
+        NGS_THROWS ( ErrorMsg )
+    {
+        entries . clear ();
+
+        const NGS_StatisticsEntry_v1 * lent;
+        uint64_t count;
+        if ( self -> getEntries ( lent, count ) )
+        {
+            entries . resize ( count );
+            for ( uint64_t i = 0; i < count; ++ i )
+            {
+                Entry & e = entries [ i ];
+                e . path . assign ( lent [ i ] . path, lent [ i ] . path_size );
+                e . type = ( ValueType ) lent [ i ] . type;
+                e . text . assign ( lent [ i ] . text, lent [ i ] . text_size );
+                if ( e . type == int64 )
+                    e . i64 = lent [ i ] . value . i64;
+                else if ( e . type == real )
+                    e . f64 = lent [ i ] . value . f64;
+                else
+                    e . u64 = lent [ i ] . value . u64;
+            }
+            return;
+        }
+
+        // the engine has no list to lend; walk its paths
+        for ( String path = nextPath ( "" ); ! path . empty (); path = nextPath ( path ) )
+        {
+            Entry e;
+            e . path = path;
+            e . type = getValueType ( path );
+            e . u64 = 0;
+            switch ( e . type )
+            {
+            case string:
+                e . text = getAsString ( path );
+                break;
+            case int64:
+                e . i64 = getAsI64 ( path );
+                break;
+            case uint64:
+                e . u64 = getAsU64 ( path );
+                break;
+            case real:
+                e . f64 = getAsDouble ( path );
+                break;
+            default:
+                break;
+            }
+            entries . push_back ( e );
+        }
+    }
+
+#if NGS_HAVE_MOVE
+    // a moved-from Statistics holds no reference; it may only be assigned or destroyed
+
+    inline
+    Statistics :: Statistics ( Statistics && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    Statistics & Statistics :: operator = ( Statistics && obj )
+        noexcept
+    {
+        StatisticsRef ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
+
 } // namespace ngs
 
 #endif // _inl_ngs_statistics_
@@ -44,24 +44,45 @@ namespace ngs
 
     inline
     const char * StringRef :: data () const
-        throw ()
+        NGS_NOTHROW
     { return self -> data (); }
 
     inline
     size_t StringRef :: size () const
-        throw ()
+        NGS_NOTHROW
     { return self -> size (); }
 
     inline
     StringRef StringRef :: substr ( size_t offset ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> substr ( offset ) ); }
 
     inline
     StringRef StringRef :: substr ( size_t offset, size_t size ) const
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     { return StringRef ( self -> substr ( offset, size ) ); }
 
+#if NGS_HAVE_MOVE
+    // a moved-from StringRef holds no reference; it may only be assigned or destroyed
+
+    inline
+    StringRef :: StringRef ( StringRef && obj )
+            noexcept
+        : self ( obj . self )
+    {
+        obj . self = 0;
+    }
+
+    inline
+    StringRef & StringRef :: operator = ( StringRef && obj )
+        noexcept
+    {
+        StringItf * ref = self;
+        self = obj . self;
+        obj . self = ref;
+        return * this;
+    }
+#endif
 
 } // namespace ngs
 
@@ -0,0 +1,159 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _inl_ngs_stringview_
+#define _inl_ngs_stringview_
+
+#ifndef _hpp_ngs_stringview_
+#include <ngs/StringView.hpp>
+#endif
+
+#ifndef _hpp_ngs_itf_stringitf_
+#include <ngs/itf/StringItf.hpp>
+#endif
+
+#ifndef _h_ngs_itf_stringitf_
+#include <ngs/itf/StringItf.h>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * StringView
+     */
+
+    inline
+    const char * StringView :: data () const
+        NGS_NOTHROW
+    { return str; }
+
+    inline
+    size_t StringView :: size () const
+        NGS_NOTHROW
+    { return sz; }
+
+    inline
+    StringView StringView :: substr ( size_t offset ) const
+        NGS_NOTHROW
+    { return substr ( offset, sz ); }
+
+    inline
+    StringView StringView :: substr ( size_t offset, size_t size ) const
+        NGS_NOTHROW
+    {
+        if ( offset > sz )
+            offset = sz;
+        if ( size > sz - offset )
+            size = sz - offset;
+        return StringView ( str + offset, size, ref );
+    }
+
+    inline
+    StringView :: StringView ()
+            NGS_NOTHROW
+        : str ( "" )
+        , sz ( 0 )
+        , ref ( 0 )
+    {
+    }
+
+    inline
+    StringView :: StringView ( const char * data, size_t size )
+            NGS_NOTHROW
+        : str ( data )
+        , sz ( size )
+        , ref ( 0 )
+    {
+    }
+
+    inline
+    StringView :: StringView ( const NGS_StringView_v1 & view, StringItf * _ref )
+            NGS_NOTHROW
+        : str ( view . data )
+        , sz ( view . size )
+        , ref ( _ref )
+    {
+    }
+
+    inline
+    StringView :: StringView ( const char * data, size_t size, StringItf * _ref )
+            NGS_NOTHROW
+        : str ( data )
+        , sz ( size )
+        , ref ( _ref != 0 ? _ref -> Duplicate () : 0 )
+    {
+    }
+
+    inline
+    StringView :: StringView ( const StringView & obj )
+            NGS_NOTHROW
+        : str ( obj . str )
+        , sz ( obj . sz )
+        , ref ( obj . ref != 0 ? obj . ref -> Duplicate () : 0 )
+    {
+    }
+
+    inline
+    StringView :: ~ StringView ()
+        NGS_NOTHROW
+    {
+        if ( ref != 0 )
+            ref -> Release ();
+    }
+
+#if NGS_HAVE_MOVE
+    inline
+    StringView :: StringView ( StringView && obj )
+            noexcept
+        : str ( obj . str )
+        , sz ( obj . sz )
+        , ref ( obj . ref )
+    {
+        obj . str = "";
+        obj . sz = 0;
+        obj . ref = 0;
+    }
+
+    inline
+    StringView & StringView :: operator = ( StringView && obj )
+        noexcept
+    {
+        const char * s = str;
+        size_t n = sz;
+        StringItf * r = ref;
+        str = obj . str;
+        sz = obj . sz;
+        ref = obj . ref;
+        obj . str = s;
+        obj . sz = n;
+        obj . ref = r;
+        return * this;
+    }
+#endif
+
+} // namespace ngs
+
+#endif // _inl_ngs_stringview_
@@ -44,6 +44,227 @@ struct NGS_Alignment_v1
     const NGS_VTable * vt;
 };
 
+/*--------------------------------------------------------------------------
+ * NGS_AlignmentBatch_v1
+ *  the columns of the next few alignments, filled in by next_batch
+ *
+ *  the caller provides an array with room for "capacity" records
+ *  for each field in "fields", and an arena of "arena_size" bytes
+ *  that the strings of the records are copied into
+ *
+ *  an alignment whose strings don't fit in what is left of the arena
+ *  is held over and becomes the first of the next batch, so the same
+ *  batch must be passed to every next_batch of one iterator
+ *
+ *  the reference index and CIGAR columns came later: their members follow
+ *  "state" and are looked at only when "fields" asks for them, the CIGAR
+ *  operations going into an arena of their own of "cigar_arena_size" ops
+ */
+enum
+{
+    NGS_AlignmentBatchFields_position  = 0x01,  /* and length */
+    NGS_AlignmentBatchFields_map_qual  = 0x02,
+    NGS_AlignmentBatchFields_flags     = 0x04,
+    NGS_AlignmentBatchFields_ref_spec  = 0x08,
+    NGS_AlignmentBatchFields_read_id   = 0x10,
+    NGS_AlignmentBatchFields_bases     = 0x20,  /* fragment bases */
+    NGS_AlignmentBatchFields_qualities = 0x40,  /* fragment qualities */
+    NGS_AlignmentBatchFields_ref_index = 0x80,
+    NGS_AlignmentBatchFields_cigar     = 0x100  /* packed ops, clips included */
+};
+
+enum
+{
+    NGS_AlignmentBatchFlags_primary    = 0x01,
+    NGS_AlignmentBatchFlags_reversed   = 0x02,
+    NGS_AlignmentBatchFlags_has_mate   = 0x04
+};
+
+enum
+{
+    NGS_AlignmentBatchState_next,       /* move on before the next record */
+    NGS_AlignmentBatchState_held,       /* the current record is to come */
+    NGS_AlignmentBatchState_end         /* the iterator is used up */
+};
+
+/* a string of one record: bytes [ offset, offset + size ) of the arena */
+typedef struct NGS_AlignmentBatchString_v1 NGS_AlignmentBatchString_v1;
+struct NGS_AlignmentBatchString_v1
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+typedef struct NGS_AlignmentBatch_v1 NGS_AlignmentBatch_v1;
+struct NGS_AlignmentBatch_v1
+{
+    /* set by the caller */
+    uint32_t fields;
+    uint32_t capacity;
+    int64_t * position;
+    uint64_t * length;
+    int32_t * map_qual;
+    uint32_t * flags;
+    NGS_AlignmentBatchString_v1 * ref_spec;
+    NGS_AlignmentBatchString_v1 * read_id;
+    NGS_AlignmentBatchString_v1 * bases;
+    NGS_AlignmentBatchString_v1 * qualities;
+    char * arena;
+    uint32_t arena_size;
+
+    /* set by next_batch; state is NGS_AlignmentBatchState_next to begin with */
+    uint32_t count;
+    uint32_t arena_used;
+    uint32_t state;
+
+    /* set by the caller, for the columns of ref_index and cigar only;
+     *  a record's cigar is ops [ offset, offset + size ) of cigar_arena */
+    int32_t * ref_index;
+    NGS_AlignmentBatchString_v1 * cigar;
+    uint32_t * cigar_arena;
+    uint32_t cigar_arena_size;
+
+    /* set by next_batch, along with count */
+    uint32_t cigar_arena_used;
+};
+
+/* the messages an Alignment answers, as reported by get_supported
+ *  an engine leaves a bit clear for a message it would only ever
+ *  answer with an error, letting the caller skip it without the throw */
+enum
+{
+    NGS_AlignmentMessage_fragment_id              = 0x00000001,
+    NGS_AlignmentMessage_fragment_bases           = 0x00000002,
+    NGS_AlignmentMessage_fragment_quals           = 0x00000004,
+    NGS_AlignmentMessage_id                       = 0x00000008,
+    NGS_AlignmentMessage_ref_spec                 = 0x00000010,
+    NGS_AlignmentMessage_map_qual                 = 0x00000020,
+    NGS_AlignmentMessage_ref_bases                = 0x00000040,
+    NGS_AlignmentMessage_read_group               = 0x00000080,
+    NGS_AlignmentMessage_read_id                  = 0x00000100,
+    NGS_AlignmentMessage_clipped_frag_bases       = 0x00000200,
+    NGS_AlignmentMessage_clipped_frag_quals       = 0x00000400,
+    NGS_AlignmentMessage_aligned_frag_bases       = 0x00000800,
+    NGS_AlignmentMessage_is_primary               = 0x00001000,
+    NGS_AlignmentMessage_align_pos                = 0x00002000,
+    NGS_AlignmentMessage_align_length             = 0x00004000,
+    NGS_AlignmentMessage_is_reversed              = 0x00008000,
+    NGS_AlignmentMessage_soft_clip                = 0x00010000,
+    NGS_AlignmentMessage_template_len             = 0x00020000,
+    NGS_AlignmentMessage_cigar                    = 0x00040000,  /* short and long */
+    NGS_AlignmentMessage_rna_orientation          = 0x00080000,
+    NGS_AlignmentMessage_has_mate                 = 0x00100000,
+    NGS_AlignmentMessage_mate_id                  = 0x00200000,
+    NGS_AlignmentMessage_mate_alignment           = 0x00400000,
+    NGS_AlignmentMessage_mate_ref_spec            = 0x00800000,
+    NGS_AlignmentMessage_mate_is_reversed         = 0x01000000,
+    NGS_AlignmentMessage_ref_pos_projection_range = 0x02000000,
+    NGS_AlignmentMessage_tags                     = 0x04000000,
+    NGS_AlignmentMessage_all                      = 0x07FFFFFF
+};
+
+/*--------------------------------------------------------------------------
+ * NGS_AlignmentTag_v1
+ *  one optional field of a record, as found by get_tag
+ *
+ *  "type" is the SAM type of the value, one of "AcCsSiIfZH", or for an
+ *  array the type of its elements, with "is_array" set
+ *
+ *  "data" points at "count" values, little-endian, or at the "count"
+ *  characters of an A, Z or H value; it is lent by the Alignment and
+ *  is valid until its next message
+ */
+typedef struct NGS_AlignmentTag_v1 NGS_AlignmentTag_v1;
+struct NGS_AlignmentTag_v1
+{
+    const void * data;
+    uint32_t count;
+    char type;
+    bool is_array;
+};
+
+/*--------------------------------------------------------------------------
+ * NGS_AlignmentCigar_v1
+ *  the CIGAR of a record, clips included, as found by get_cigar_ops
+ *
+ *  "ops" points at "count" operations in host byte order, each the length
+ *  of the operation shifted left by 4 bits and its code, an index into
+ *  "MIDNSHP=X", as BAM packs them; it is lent by the Alignment and is
+ *  valid until its next message
+ */
+typedef struct NGS_AlignmentCigar_v1 NGS_AlignmentCigar_v1;
+struct NGS_AlignmentCigar_v1
+{
+    const uint32_t * ops;
+    uint32_t count;
+};
+
+/*--------------------------------------------------------------------------
+ * NGS_AlignmentMismatches_v1
+ *  the bases of a record unlike the reference, as found by get_mismatches
+ *
+ *  the clipped bases are those the CIGAR's M, I, = and X operations cover,
+ *  in the orientation of the reference; "count" is the number of them
+ *  aligned to a different base, leaving out insertions and deletions
+ *  "bases" is the number of clipped bases; if it is no more than
+ *  "mask_size", "mask" is filled in with 1 for each base counted and 0
+ *  for the others, unless it is NULL, for the count alone
+ */
+typedef struct NGS_AlignmentMismatches_v1 NGS_AlignmentMismatches_v1;
+struct NGS_AlignmentMismatches_v1
+{
+    /* set by the caller */
+    uint8_t * mask;
+    uint32_t mask_size;
+
+    /* set by the engine */
+    uint32_t count;
+    uint32_t bases;
+};
+
+/*--------------------------------------------------------------------------
+ * NGS_AlignmentReadFragment_v1
+ *  the fragment of a record as it was sequenced, as filled in by
+ *  get_read_fragment
+ *
+ *  all of its bases, soft clips included, reverse complemented if the
+ *  record is of the reverse strand, and their qualities, phred+33, in the
+ *  same order; "length" is the number of bases, and if it is no more than
+ *  "size", "bases" and "quals" are filled in with them, unless NULL
+ *  "has_quals" is true if "quals" was filled in, and false for a record
+ *  without qualities; "skipped" is true for a secondary or supplementary
+ *  record with hard clips, which hasn't all of the read, and "length" is 0
+ */
+typedef struct NGS_AlignmentReadFragment_v1 NGS_AlignmentReadFragment_v1;
+struct NGS_AlignmentReadFragment_v1
+{
+    /* set by the caller */
+    char * bases;
+    char * quals;
+    uint32_t size;
+
+    /* set by the engine */
+    uint32_t length;
+    bool has_quals;
+    bool skipped;
+};
+
+/*--------------------------------------------------------------------------
+ * NGS_AlignmentCore_v1
+ *  the scalar fields of a record, as filled in by get_core
+ *
+ *  "flags" holds the NGS_AlignmentBatchFlags_* bits, as next_batch does
+ */
+typedef struct NGS_AlignmentCore_v1 NGS_AlignmentCore_v1;
+struct NGS_AlignmentCore_v1
+{
+    int64_t position;
+    uint64_t length;
+    uint64_t template_len;
+    int32_t map_qual;
+    uint32_t flags;
+};
+
 typedef struct NGS_Alignment_v1_vt NGS_Alignment_v1_vt;
 struct NGS_Alignment_v1_vt
 {
@@ -79,6 +300,73 @@ struct NGS_Alignment_v1_vt
 
     /* v1.2 */
     uint64_t ( CC * get_ref_pos_projection_range ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, int64_t ref_pos );
+
+    /* v1.3 */
+    bool ( CC * next_batch ) ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentBatch_v1 * batch );
+
+    /* v1.4
+     *  as for get_bases_view on NGS_Fragment_v1 */
+    NGS_String_v1 * ( CC * get_ref_spec_view ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_StringView_v1 * view );
+    NGS_String_v1 * ( CC * get_read_id_view ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_StringView_v1 * view );
+
+    /* v1.5
+     *  NGS_AlignmentMessage_* bits, the same for every Alignment of an iterator */
+    uint32_t ( CC * get_supported ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* v1.6
+     *  fills in "value" with the field named by the two characters
+     *  at "tag" and returns true, or returns false if there is none */
+    bool ( CC * get_tag ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, const char * tag, NGS_AlignmentTag_v1 * value );
+
+    /* v1.7
+     *  fills in "cigar" with the operations of the record and returns true,
+     *  or returns false if the engine has none to lend */
+    bool ( CC * get_cigar_ops ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentCigar_v1 * cigar );
+
+    /* v1.8
+     *  fills in "core" with the position, length, template length,
+     *  mapping quality and flags of the record at once */
+    void ( CC * get_core ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentCore_v1 * core );
+
+    /* v1.9
+     *  advances to the next record that ends after "ref_pos", as next
+     *  would after passing over those that end at or before it
+     *  returns false if there are no more */
+    bool ( CC * skip_to ) ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, int64_t ref_pos );
+
+    /* v1.10
+     *  get_cursor returns where the iterator is, as a short string of
+     *  the engine's own making; resume_from takes an iterator made as
+     *  the one it came from to that place, after which next moves to
+     *  the record that followed the one then current */
+    NGS_String_v1 * ( CC * get_cursor ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+    void ( CC * resume_from ) ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, const char * cursor );
+
+    /* v1.11
+     *  the indices of the references of the record and of its mate, in
+     *  the order get_references of the collection gives them, or -1 */
+    int32_t ( CC * get_ref_index ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+    int32_t ( CC * get_mate_ref_index ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* v1.12
+     *  takes a slice iterator to another window of its reference,
+     *  before the first Alignment of it */
+    void ( CC * reposition ) ( NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length );
+
+    /* v1.13
+     *  the NGS_AlignmentBatchFields_* bits of the columns next_batch fills
+     *  in; a batch asking for others is filled through the messages above */
+    uint32_t ( CC * get_batch_fields ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* v1.14
+     *  fills in "mismatches" and returns true, or returns false if the
+     *  engine leaves comparing the bases to the caller */
+    bool ( CC * get_mismatches ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentMismatches_v1 * mismatches );
+
+    /* v1.15
+     *  fills in "fragment" and returns true, or returns false if the
+     *  engine leaves turning the fragment around to the caller */
+    bool ( CC * get_read_fragment ) ( const NGS_Alignment_v1 * self, NGS_ErrBlock_v1 * err, NGS_AlignmentReadFragment_v1 * fragment );
 };
 
 
@@ -32,6 +32,13 @@
 #endif
 
 struct NGS_Alignment_v1;
+struct NGS_AlignmentBatch_v1;
+struct NGS_StringView_v1;
+struct NGS_AlignmentTag_v1;
+struct NGS_AlignmentCigar_v1;
+struct NGS_AlignmentCore_v1;
+struct NGS_AlignmentMismatches_v1;
+struct NGS_AlignmentReadFragment_v1;
 
 namespace ngs
 {
@@ -49,55 +56,111 @@ namespace ngs
     public:
 
         StringItf * getAlignmentId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReferenceSpec () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         int32_t getMappingQuality () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReferenceBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReadGroup () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReadId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getClippedFragmentBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getClippedFragmentQualities () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getAlignedFragmentBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint32_t getAlignmentCategory () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         int64_t getAlignmentPosition () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getReferencePositionProjectionRange ( int64_t ref_pos ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAlignmentLength () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool getIsReversedOrientation () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         int32_t getSoftClip ( uint32_t edge ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getTemplateLength () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getShortCigar ( bool clipped ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getLongCigar ( bool clipped ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         char getRNAOrientation () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool hasMate () const
-            throw ();
+            NGS_NOTHROW;
         StringItf * getMateAlignmentId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getMateAlignment () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getMateReferenceSpec () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool getMateIsReversedOrientation () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool nextAlignment ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+        bool nextAlignmentBatch ( NGS_AlignmentBatch_v1 & batch )
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "view", returning the reference it points into, if any
+        StringItf * getReferenceSpecView ( NGS_StringView_v1 & view ) const
+            NGS_THROWS ( ErrorMsg );
+        StringItf * getReadIdView ( NGS_StringView_v1 & view ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // NGS_AlignmentMessage_* bits for the messages answered
+        uint32_t getSupportedMessages () const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "value" with the field "tag", or return false
+        bool getTag ( const char * tag, NGS_AlignmentTag_v1 & value ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "cigar" with the packed operations, or return false
+        bool getCigarOps ( NGS_AlignmentCigar_v1 & cigar ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "core" with the scalar fields, in one call where the engine can
+        void getCore ( NGS_AlignmentCore_v1 & core ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // advance to the next Alignment that ends after "refPos"
+        bool skipTo ( int64_t refPos )
+            NGS_THROWS ( ErrorMsg );
+
+        // where the iterator is, and continuing from there
+        StringItf * getCursor () const
+            NGS_THROWS ( ErrorMsg );
+        void resumeFrom ( const char * cursor )
+            NGS_THROWS ( ErrorMsg );
+
+        // the indices of the references of the Alignment and its mate
+        int32_t getReferenceIndex () const
+            NGS_THROWS ( ErrorMsg );
+        int32_t getMateReferenceIndex () const
+            NGS_THROWS ( ErrorMsg );
+
+        // a slice iterator taken to another window of its Reference
+        void reposition ( int64_t start, uint64_t length )
+            NGS_THROWS ( ErrorMsg );
+
+        // NGS_AlignmentBatchFields_* bits for the columns nextAlignmentBatch fills in
+        uint32_t getBatchFields () const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "mismatches" against the Reference, or return false
+        bool getMismatches ( NGS_AlignmentMismatches_v1 & mismatches ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "fragment" as it was sequenced, or return false
+        bool getReadFragment ( NGS_AlignmentReadFragment_v1 & fragment ) const
+            NGS_THROWS ( ErrorMsg );
     };
 
 } // namespace ngs
@@ -0,0 +1,182 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_itf_call_stats_
+#define _hpp_ngs_itf_call_stats_
+
+#ifndef _h_ngs_itf_defs_
+#include <ngs/itf/defs.h>
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <vector>
+
+#ifndef _hpp_ngs_itf_trace_
+#include <ngs/itf/Trace.hpp>
+#endif
+
+/*--------------------------------------------------------------------------
+ * NGS_CALL_STATS
+ *  the dispatch layer counts calls through each C vtable method and the
+ *  cycles they take when built with "make NGS_CALL_STATS=1", and then only
+ *  while switched on: by setting the environment variable NGS_CALL_STATS,
+ *  or with CallStats :: Enable
+ *
+ *  with NGS_CALL_STATS=1 the totals go to stderr at exit;
+ *  any other value is the name of a file to append them to
+ *
+ *  without the build flag, the calls below are there but find nothing
+ */
+
+namespace ngs
+{
+
+    /*----------------------------------------------------------------------
+     * CallStats
+     *  per-thread call counts and cycles for each vtable method
+     */
+    class CallStats
+    {
+    public:
+
+        struct Entry
+        {
+            const char * method;    // e.g. "NGS_Alignment_v1_vt::get_ref_spec"
+            uint64_t calls;
+            uint64_t cycles;        // TSC cycles, or nanoseconds without a TSC
+        };
+
+        /* Compiled
+         *  true if the dispatch layer was built to count
+         */
+        static bool Compiled ()
+            NGS_NOTHROW;
+
+        /* Enable
+         *  switch counting on or off; has no effect unless Compiled
+         */
+        static void Enable ( bool on )
+            NGS_NOTHROW;
+
+        static bool Enabled ()
+            NGS_NOTHROW
+        {
+            return on;
+        }
+
+        /* Totals
+         *  the methods called so far with their counts, summed over all
+         *  threads or for the calling thread only, in order of first call
+         */
+        static void Totals ( std :: vector < Entry > & out, bool this_thread_only = false );
+
+        /* Reset
+         *  zero the counts of all threads
+         */
+        static void Reset ()
+            NGS_NOTHROW;
+
+        /* Dump
+         *  write the totals as tab-separated lines, most cycles first
+         */
+        static void Dump ( FILE * out );
+
+    public:
+
+        // used by NGS_CALL_STATS_SCOPE
+
+        static unsigned int Register ( const char * method )
+            NGS_NOTHROW;
+
+        static uint64_t Now ()
+            NGS_NOTHROW
+        {
+#if defined _MSC_VER
+            return __rdtsc ();
+#elif defined __i386__ || defined __x86_64__
+            return __builtin_ia32_rdtsc ();
+#else
+            return Clock ();
+#endif
+        }
+
+        static void Add ( unsigned int slot, uint64_t cycles )
+            NGS_NOTHROW;
+
+        class Scope
+        {
+        public:
+
+            explicit Scope ( unsigned int _slot )
+                : slot ( _slot )
+                , start ( on ? Now () : 0 )
+            {
+            }
+
+            ~ Scope ()
+            {
+                if ( start != 0 )
+                    Add ( slot, Now () - start );
+            }
+
+        private:
+
+            unsigned int slot;
+            uint64_t start;
+        };
+
+    private:
+
+        static uint64_t Clock ()
+            NGS_NOTHROW;
+
+        static bool on;
+    };
+
+} // namespace ngs
+
+/* each of the dispatch layer's calls through a C vtable is counted,
+   and traced when built with NGS_TRACE; see ngs/itf/Trace.hpp */
+#if NGS_CALL_STATS
+#define NGS_CALL_STATS_COUNT( vt_type, method )                                                       \
+    static const unsigned int ngs_call_stats_slot = CallStats :: Register ( #vt_type "::" #method ); \
+    CallStats :: Scope ngs_call_stats_scope ( ngs_call_stats_slot )
+#else
+#define NGS_CALL_STATS_COUNT( vt_type, method ) \
+    ( void ) 0
+#endif
+
+#define NGS_CALL_STATS_SCOPE( vt_type, method ) \
+    NGS_CALL_STATS_COUNT ( vt_type, method );   \
+    NGS_TRACE_SCOPE ( #vt_type "::" #method )
+
+#endif // _hpp_ngs_itf_call_stats_
@@ -0,0 +1,139 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_itf_direct_bind_
+#define _hpp_ngs_itf_direct_bind_
+
+#ifndef _hpp_ngs_itf_vtable_
+#include <ngs/itf/VTable.hpp>
+#endif
+
+/*--------------------------------------------------------------------------
+ * NGS_DIRECT_BIND
+ *  built with "make NGS_DIRECT_BIND=1", the dispatch layer sends the
+ *  messages of Alignment, Fragment, Read and String to an object of the
+ *  adapter classes through its C++ virtuals, rather than through its C
+ *  vtable and an ErrBlock, when the class name of the vtable carries the
+ *  NGS_ADAPT_ABI the dispatch layer was built with: an engine built on
+ *  the same SDK headers, with the same compiler, in the same process.
+ *
+ *  any other object - from an engine in C, or from an adapter of another
+ *  version - goes through its C vtable as ever, as do the calls of the
+ *  language bindings, which don't come by here.
+ *
+ *  what the object throws is thrown on as an ErrorMsg with its message,
+ *  as it is from the C vtable. calls made directly aren't counted by
+ *  NGS_CALL_STATS.
+ */
+#ifndef NGS_DIRECT_BIND
+ #define NGS_DIRECT_BIND 0
+#endif
+
+#if NGS_DIRECT_BIND
+ #ifndef _h_ngs_adapt_defs_
+ #include <ngs/adapter/defs.h>
+ #endif
+ // with no ABI to tag the adapter classes, nothing can be told apart
+ #ifndef NGS_ADAPT_CXX_ABI
+  #undef NGS_DIRECT_BIND
+  #define NGS_DIRECT_BIND 0
+ #endif
+#endif
+
+#if NGS_DIRECT_BIND
+#include <ngs/itf/StringItf.hpp>
+#include <ngs/adapter/StringItf.hpp>
+#endif
+
+namespace ngs
+{
+    /*----------------------------------------------------------------------
+     * DirectTok
+     *  the last vtable of an interface found to be one to call directly,
+     *  and the last found not to be, so that a class name is looked at
+     *  once for each vtable seen rather than on every call
+     */
+    struct DirectTok
+    {
+        mutable const NGS_VTable * volatile direct;
+        mutable const NGS_VTable * volatile indirect;
+    };
+
+    /* DirectBound
+     *  true if the dispatch layer was built to call directly
+     */
+    bool DirectBound ()
+        NGS_NOTHROW;
+
+#if NGS_DIRECT_BIND
+
+    /* DirectResolve
+     *  looks at the class name of "vt" and remembers what it found
+     */
+    bool DirectResolve ( const NGS_VTable * vt, const ItfTok & itf, const DirectTok & tok )
+        NGS_NOTHROW;
+
+    /* Direct
+     *  true if the object with "vt", of the interface "itf", is one of
+     *  the adapter classes to be called directly
+     */
+    inline
+    bool Direct ( const NGS_VTable * vt, const ItfTok & itf, const DirectTok & tok )
+        NGS_NOTHROW
+    {
+        if ( vt == tok . direct )
+            return true;
+        if ( vt == tok . indirect )
+            return false;
+        return DirectResolve ( vt, itf, tok );
+    }
+
+    /* DirectThrow
+     *  throws what a direct call threw as an ErrorMsg
+     *  to be called only from within a catch block
+     */
+    void DirectThrow ()
+        NGS_THROWS ( ErrorMsg );
+
+    /* DirectString
+     *  the StringItf for one handed out by a direct call
+     */
+    inline
+    StringItf * DirectString ( ngs_adapt :: StringItf * str )
+        NGS_NOTHROW
+    {
+        return str != 0 ? StringItf :: Cast ( str -> Cast () ) : 0;
+    }
+
+#endif
+}
+
+#if NGS_DIRECT_BIND
+#define NGS_DIRECT_CALL( stmt ) \
+    try { stmt; } catch ( ... ) { :: ngs :: DirectThrow (); }
+#endif
+
+#endif // _hpp_ngs_itf_direct_bind_
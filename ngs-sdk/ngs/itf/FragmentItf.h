@@ -35,6 +35,24 @@
 extern "C" {
 #endif
 
+/*--------------------------------------------------------------------------
+ * NGS_FragmentPackedBases_v1
+ *  the bases of a fragment as BAM packs them, as found by get_packed_bases
+ *
+ *  "bases" points at bytes of two 4-bit codes each, indices into
+ *  "=ACMGRSVTWYHKDBN", the first base of a byte in its high nibble;
+ *  "phase" is 1 if the first of the "count" bases is the low nibble of
+ *  the first byte. they are lent by the Fragment and are valid until its
+ *  next message
+ */
+typedef struct NGS_FragmentPackedBases_v1 NGS_FragmentPackedBases_v1;
+struct NGS_FragmentPackedBases_v1
+{
+    const uint8_t * bases;
+    uint64_t count;
+    uint32_t phase;
+};
+
 /*--------------------------------------------------------------------------
  * NGS_Fragment_v1
  */
@@ -58,6 +76,21 @@ struct NGS_Fragment_v1_vt
     /* 1.1 */
     bool ( CC * is_paired ) ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
     bool ( CC * is_aligned ) ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* 1.2
+     *  fill in "view" and return NULL if the data can be lent,
+     *  or return a reference the caller releases that "view" points into */
+    NGS_String_v1 * ( CC * get_bases_view ) ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, uint64_t length, NGS_StringView_v1 * view );
+    NGS_String_v1 * ( CC * get_quals_view ) ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, uint64_t length, NGS_StringView_v1 * view );
+
+    /* 1.3
+     *  fills in "packed" with the bases get_bases would return and returns
+     *  true, or returns false if the engine has none to lend */
+    bool ( CC * get_packed_bases ) ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 * packed );
+
+    /* 1.4
+     *  the fragment's ordinal within its read, from 0 */
+    uint32_t ( CC * get_frag_index ) ( const NGS_Fragment_v1 * self, NGS_ErrBlock_v1 * err );
 };
 
 
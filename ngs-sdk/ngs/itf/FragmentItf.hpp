@@ -32,6 +32,8 @@
 #endif
 
 struct NGS_Fragment_v1;
+struct NGS_StringView_v1;
+struct NGS_FragmentPackedBases_v1;
 
 namespace ngs
 {
@@ -49,25 +51,38 @@ namespace ngs
     public:
 
         StringItf * getFragmentId () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getFragmentBases () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getFragmentBases ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getFragmentBases ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getFragmentQualities () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getFragmentQualities ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getFragmentQualities ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool nextFragment ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool isPaired () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool isAligned () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "view", returning the reference it points into, if any
+        StringItf * getFragmentBasesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+            NGS_THROWS ( ErrorMsg );
+        StringItf * getFragmentQualitiesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "packed" with lent bases, or return false
+        bool getFragmentBasesPacked ( uint64_t offset, uint64_t length, NGS_FragmentPackedBases_v1 & packed ) const
+            NGS_THROWS ( ErrorMsg );
+
+        uint32_t getFragmentIndex () const
+            NGS_THROWS ( ErrorMsg );
     };
 
 
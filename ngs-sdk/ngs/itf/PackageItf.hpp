@@ -48,7 +48,7 @@ namespace ngs
 
         static
         String getPackageVersion ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
     };
 
 
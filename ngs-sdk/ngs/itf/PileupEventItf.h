@@ -68,6 +68,11 @@ struct NGS_PileupEvent_v1_vt
     uint32_t ( CC * get_indel_type ) ( const NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
     bool ( CC * next ) ( NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
     void ( CC * reset ) ( NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* v1.1
+     *  as for NGS_Alignment_v1, of the event's alignment */
+    int32_t ( CC * get_ref_index ) ( const NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
+    int32_t ( CC * get_mate_ref_index ) ( const NGS_PileupEvent_v1 * self, NGS_ErrBlock_v1 * err );
 };
 
 
@@ -51,17 +51,116 @@ struct NGS_Pileup_v1
     const NGS_VTable * vt;
 };
 
+/*--------------------------------------------------------------------------
+ * NGS_PileupColumn_v1
+ *  the events of the current position of a Pileup, a column each,
+ *  filled in by get_column
+ *
+ *  the caller provides an array with room for "capacity" events for
+ *  each field in "fields", and an arena of "arena_size" bytes that the
+ *  insertions of the events are copied into
+ *
+ *  "event_type" holds what get_event_type answers, the strand included
+ */
+enum
+{
+    NGS_PileupColumnFields_event_type = 0x01,
+    NGS_PileupColumnFields_base       = 0x02,
+    NGS_PileupColumnFields_qual       = 0x04,
+    NGS_PileupColumnFields_map_qual   = 0x08,
+    NGS_PileupColumnFields_ins_bases  = 0x10,
+    NGS_PileupColumnFields_ins_quals  = 0x20
+};
+
+/* an insertion of one event: bytes [ offset, offset + size ) of the arena */
+typedef struct NGS_PileupColumnString_v1 NGS_PileupColumnString_v1;
+struct NGS_PileupColumnString_v1
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+typedef struct NGS_PileupColumn_v1 NGS_PileupColumn_v1;
+struct NGS_PileupColumn_v1
+{
+    /* set by the caller */
+    uint32_t fields;
+    uint32_t capacity;
+    uint32_t * event_type;
+    char * base;
+    char * qual;
+    int32_t * map_qual;
+    NGS_PileupColumnString_v1 * ins_bases;
+    NGS_PileupColumnString_v1 * ins_quals;
+    char * arena;
+    uint32_t arena_size;
+
+    /* set by get_column */
+    uint32_t count;
+    uint32_t arena_used;
+};
+
+/*--------------------------------------------------------------------------
+ * NGS_PileupBaseCounts_v1
+ *  the events of one position of a Pileup, counted by what they show
+ *  and by the strand of their alignment, filled in by get_base_counts
+ *
+ *  a match or mismatch counts as its base, anything other than A, C, G
+ *  or T as N, unless its quality is below the one asked for; a deletion,
+ *  a skip included, counts as a deletion, and an event with an insertion
+ *  before it counts as an insertion as well, whatever their qualities
+ */
+enum
+{
+    NGS_PileupBaseCount_A = 0,
+    NGS_PileupBaseCount_C,
+    NGS_PileupBaseCount_G,
+    NGS_PileupBaseCount_T,
+    NGS_PileupBaseCount_N,
+    NGS_PileupBaseCount_deletion,
+    NGS_PileupBaseCount_insertion,
+    NGS_PileupBaseCount_kinds
+};
+
+typedef struct NGS_PileupBaseCounts_v1 NGS_PileupBaseCounts_v1;
+struct NGS_PileupBaseCounts_v1
+{
+    int64_t position;
+    uint32_t plus [ NGS_PileupBaseCount_kinds ];
+    uint32_t minus [ NGS_PileupBaseCount_kinds ];
+};
+
 typedef struct NGS_Pileup_v1_vt NGS_Pileup_v1_vt;
 struct NGS_Pileup_v1_vt
 {
     NGS_VTable dad;
 
+    /* v1.0 interface */
     NGS_String_v1 * ( CC * get_ref_spec ) ( const NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
     int64_t ( CC * get_ref_pos ) ( const NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
     char ( CC * get_ref_base ) ( const NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
     uint32_t ( CC * get_pileup_depth ) ( const NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
     bool ( CC * next ) ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err );
 
+    /* v1.1
+     *  fills in "column" with every event of the current position and
+     *  returns true, or returns false with "count" and "arena_used" set
+     *  to the room the column needs if it doesn't fit; the events are
+     *  left to be iterated from the first */
+    bool ( CC * get_column ) ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err, NGS_PileupColumn_v1 * column );
+
+    /* v1.2
+     *  fills in counts [ 0 .. count ) for the current position and up to
+     *  count - 1 after it, with bases of a quality of at least "min_qual",
+     *  moving to each in turn as next does; returns the number filled in,
+     *  fewer than "count" only when next would return false */
+    uint32_t ( CC * get_base_counts ) ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err, int32_t min_qual, uint32_t count, NGS_PileupBaseCounts_v1 * counts );
+
+    /* v1.3
+     *  moves the end of a slice's window out to "new_end", so that next
+     *  goes on past the old end with the alignments it holds, reading
+     *  only those that start at or after the old end */
+    void ( CC * extend_to ) ( NGS_Pileup_v1 * self, NGS_ErrBlock_v1 * err, int64_t new_end );
 };
 
 
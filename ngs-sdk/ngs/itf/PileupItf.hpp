@@ -32,6 +32,8 @@
 #endif
 
 struct NGS_Pileup_v1;
+struct NGS_PileupColumn_v1;
+struct NGS_PileupBaseCounts_v1;
 
 namespace ngs
 {
@@ -49,15 +51,27 @@ namespace ngs
     public:
 
         StringItf * getReferenceSpec () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         int64_t getReferencePosition () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         char getReferenceBase () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint32_t getPileupDepth () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool nextPileup ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in "column" with the events, or return false to be given more room
+        bool getColumn ( NGS_PileupColumn_v1 & column )
+            NGS_THROWS ( ErrorMsg );
+
+        // count the events of this position and up to "count" - 1 after it
+        uint32_t getBaseCounts ( int32_t minQuality, uint32_t count, NGS_PileupBaseCounts_v1 * counts )
+            NGS_THROWS ( ErrorMsg );
+
+        // move the end of the window out to "newEnd"
+        void extendTo ( int64_t newEnd )
+            NGS_THROWS ( ErrorMsg );
 
     };
 
@@ -42,6 +42,73 @@ struct NGS_Read_v1;
 struct NGS_ReadGroup_v1;
 struct NGS_Reference_v1;
 struct NGS_Alignment_v1;
+struct NGS_Statistics_v1;
+
+/* the messages a ReadCollection answers, as reported by get_features
+ *  a clear bit means the engine would only answer them with an error */
+enum NGS_ReadCollectionFeature
+{
+    NGS_ReadCollectionFeature_read_groups       = 0x001,  /* get_read_groups, get_read_group */
+    NGS_ReadCollectionFeature_references        = 0x002,  /* get_references, get_reference */
+    NGS_ReadCollectionFeature_alignment_by_id   = 0x004,
+    NGS_ReadCollectionFeature_alignments        = 0x008,
+    NGS_ReadCollectionFeature_alignment_count   = 0x010,
+    NGS_ReadCollectionFeature_alignment_range   = 0x020,
+    NGS_ReadCollectionFeature_alignment_shard   = 0x040,
+    NGS_ReadCollectionFeature_read_by_id        = 0x080,
+    NGS_ReadCollectionFeature_reads             = 0x100,  /* get_reads, get_read_count, get_read_range */
+    NGS_ReadCollectionFeature_all               = 0x1FF
+};
+
+
+/*--------------------------------------------------------------------------
+ * NGS_ReferenceTable_v1
+ *  the names and lengths of every reference of a collection,
+ *  filled in by get_reference_table
+ *
+ *  the caller provides an array with room for "capacity" references
+ *  for each field in "fields", and an arena of "arena_size" bytes for
+ *  the names. "count" and "arena_used" are set to what the whole table
+ *  takes even when it doesn't fit; get_reference_table then returns false,
+ *  and the caller is to grow the arrays and the arena and ask again
+ *
+ *  "filled" is set to the fields asked for that the engine knows;
+ *  the others are left as they were
+ */
+enum
+{
+    NGS_ReferenceTableFields_common_name    = 0x01,
+    NGS_ReferenceTableFields_canonical_name = 0x02,
+    NGS_ReferenceTableFields_length         = 0x04,
+    NGS_ReferenceTableFields_circular       = 0x08
+};
+
+/* a name: bytes [ offset, offset + size ) of the arena */
+typedef struct NGS_ReferenceTableString_v1 NGS_ReferenceTableString_v1;
+struct NGS_ReferenceTableString_v1
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+typedef struct NGS_ReferenceTable_v1 NGS_ReferenceTable_v1;
+struct NGS_ReferenceTable_v1
+{
+    /* set by the caller */
+    uint32_t fields;
+    uint32_t capacity;
+    NGS_ReferenceTableString_v1 * common_name;
+    NGS_ReferenceTableString_v1 * canonical_name;
+    uint64_t * length;
+    uint8_t * circular;             /* 0 or 1 */
+    char * arena;
+    uint32_t arena_size;
+
+    /* set by get_reference_table */
+    uint32_t count;
+    uint32_t arena_used;
+    uint32_t filled;
+};
 
 
 /*--------------------------------------------------------------------------
@@ -79,6 +146,19 @@ struct NGS_ReadCollection_v1_vt
     // 1.1
     bool ( CC * has_read_group ) ( const NGS_ReadCollection_v1 * self, const char * spec );
     bool ( CC * has_reference ) ( const NGS_ReadCollection_v1 * self, const char * spec );
+
+    // 1.2
+    struct NGS_Alignment_v1 * ( CC * get_align_shard ) ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err,
+        uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary );
+
+    // 1.3
+    uint32_t ( CC * get_features ) ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err );
+
+    // 1.4
+    struct NGS_Statistics_v1 * ( CC * get_statistics ) ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err );
+
+    // 1.5
+    bool ( CC * get_reference_table ) ( const NGS_ReadCollection_v1 * self, NGS_ErrBlock_v1 * err, NGS_ReferenceTable_v1 * table );
 };
 
 
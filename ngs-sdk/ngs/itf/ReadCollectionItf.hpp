@@ -32,6 +32,7 @@
 #endif
 
 struct NGS_ReadCollection_v1;
+struct NGS_ReferenceTable_v1;
 
 namespace ngs
 {
@@ -44,6 +45,7 @@ namespace ngs
     class ReadGroupItf;
     class ReferenceItf;
     class AlignmentItf;
+    class StatisticsItf;
 
     /*----------------------------------------------------------------------
      * ReadCollectionItf
@@ -53,37 +55,50 @@ namespace ngs
     public:
         
         StringItf * getName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadGroupItf * getReadGroups () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool hasReadGroup ( const char * spec ) const
-            throw ();
+            NGS_NOTHROW;
         ReadGroupItf * getReadGroup ( const char * spec ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReferenceItf * getReferences () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool hasReference ( const char * spec ) const
-            throw ();
+            NGS_NOTHROW;
         ReferenceItf * getReference ( const char * spec ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignment ( const char * alignmentId ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignments ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAlignmentCount ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignmentRange ( uint64_t first, uint64_t count, uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+        AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, uint32_t categories ) const
+            NGS_THROWS ( ErrorMsg );
         ReadItf * getRead ( const char * readId ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadItf * getReads ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getReadCount ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadItf * getReadRange ( uint64_t first, uint64_t count ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         ReadItf * getReadRange ( uint64_t first, uint64_t count, uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        // NGS_ReadCollectionFeature_* bits
+        uint32_t getFeatures () const
+            NGS_THROWS ( ErrorMsg );
+
+        StatisticsItf * getStatistics () const
+            NGS_THROWS ( ErrorMsg );
+
+        // false if "table" was too small, see NGS_ReferenceTable_v1
+        bool getReferenceTable ( NGS_ReferenceTable_v1 & table ) const
+            NGS_THROWS ( ErrorMsg );
     };
 
 } // namespace ngs
@@ -61,6 +61,14 @@ struct NGS_Read_v1_vt
     /* 1.1 */
     bool ( CC * frag_is_aligned ) ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, uint32_t fragIdx );
 
+    /* 1.2 */
+    NGS_String_v1 * ( CC * get_cursor ) ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err );
+    void ( CC * resume_from ) ( NGS_Read_v1 * self, NGS_ErrBlock_v1 * err, const char * cursor );
+
+    /* 1.3
+     *  the number that ends the read's ID, without the string */
+    uint64_t ( CC * get_row_id ) ( const NGS_Read_v1 * self, NGS_ErrBlock_v1 * err );
+
 };
 
 
@@ -0,0 +1,214 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_itf_record_
+#define _hpp_ngs_itf_record_
+
+#ifndef _h_ngs_itf_defs_
+#include <ngs/itf/defs.h>
+#endif
+
+#include <stdint.h>
+
+/*--------------------------------------------------------------------------
+ * NGS_RECORD
+ *  the dispatch layer writes down every call through a C vtable method,
+ *  in the order made, when built with "make NGS_RECORD=1", and then only
+ *  while switched on: by setting the environment variable NGS_RECORD to
+ *  the name of a file to write them to, or with Record :: Start
+ *
+ *  a call is recorded with the object it was made on, the arguments that
+ *  say what was asked for - positions, lengths, categories, filters,
+ *  names and specs - and the object it returned, if any; buffers, views
+ *  and the data returned are left out, and so are calls on Strings.
+ *  objects are numbered in the order they are first seen; one seen first
+ *  as the object of a call, rather than as what a call returned, was
+ *  opened by the caller, e.g. a ReadCollection, and is noted as such
+ *
+ *  calls the engine makes of its own through the dispatch layer while
+ *  answering a call are not recorded, nor are those the dispatch layer
+ *  makes to do for an engine what it doesn't: replaying the outer call
+ *  makes them again. nor are calls bound directly with NGS_DIRECT_BIND
+ *
+ *  the file is a compact binary one, for test/ngs-bench/replay.cpp to
+ *  drive an engine with; see the format below
+ *
+ *  without the build flag, the macros below are nothing at all; with it,
+ *  a call costs a single branch while recording is off
+ */
+
+/*--------------------------------------------------------------------------
+ * file format
+ *  the 8 bytes "NGSREC1\n", then records, each a tag byte followed by
+ *  unsigned LEB128 varints ( "v" ) and strings as a length and bytes:
+ *
+ *    'M' v:method s:name                 a method, the first time it is used,
+ *                                        e.g. "NGS_Reference_v1_vt::get_align_slice"
+ *    'O' v:object v:method               an object opened by the caller, the
+ *                                        first time a method is called on it
+ *    'C' v:method v:thread v:object      a call that returned; start is in
+ *        v:start v:duration v:count      nanoseconds since recording started,
+ *        args... v:result                thread counts from 1, and result is
+ *                                        the object returned, or 0
+ *
+ *  an argument is 'i' with an integer as a zigzag varint, or 's' with a
+ *  string; a string is cut short at MAX_STRING bytes
+ */
+
+namespace ngs
+{
+
+    /*----------------------------------------------------------------------
+     * Record
+     *  the calls through the dispatch layer, in the order made
+     */
+    class Record
+    {
+    public:
+
+        static const unsigned int MAX_STRING = 256;
+
+        /* Compiled
+         *  true if the dispatch layer was built to record
+         */
+        static bool Compiled ()
+            NGS_NOTHROW;
+
+        /* Start
+         *  record calls to the file at "path", replacing it; returns
+         *  false if it can't be written, or unless Compiled
+         */
+        static bool Start ( const char * path )
+            NGS_NOTHROW;
+
+        /* Stop
+         *  stop recording and close the file
+         */
+        static void Stop ()
+            NGS_NOTHROW;
+
+        static bool Enabled ()
+            NGS_NOTHROW
+        {
+            return on;
+        }
+
+    public:
+
+        // used by NGS_RECORD_CALL and friends
+
+        static unsigned int Register ( const char * method )
+            NGS_NOTHROW;
+
+        class Call
+        {
+        public:
+
+            Call ( unsigned int slot, const void * self )
+                NGS_NOTHROW;
+
+            ~ Call ()
+            {
+                if ( self != 0 )
+                    End ();
+            }
+
+            void Arg ( int64_t value )
+                NGS_NOTHROW;
+            void Arg ( const char * value )
+                NGS_NOTHROW;
+
+            void Result ( const void * obj )
+                NGS_NOTHROW
+            {
+                result = obj;
+            }
+
+        private:
+
+            void End ()
+                NGS_NOTHROW;
+
+            const void * self;
+            const void * result;
+            unsigned int slot;
+            unsigned int count;
+            unsigned int used;
+            uint64_t start;
+            unsigned char args [ 2 * MAX_STRING ];
+        };
+
+        /* Quiet
+         *  calls are not recorded while one made "quiet" is in scope
+         *  on the thread
+         */
+        class Quiet
+        {
+        public:
+
+            explicit Quiet ( bool quiet )
+                NGS_NOTHROW;
+            ~ Quiet ()
+                NGS_NOTHROW;
+
+        private:
+
+            bool quiet;
+        };
+
+    private:
+
+        static bool on;
+    };
+
+} // namespace ngs
+
+/* the dispatch layer records a call made on "self" with NGS_RECORD_CALL,
+   then each argument with NGS_RECORD_ARG, and the object returned with
+   NGS_RECORD_RESULT; NGS_RECORD_QUIET keeps what it does in an engine's
+   stead out of the record, when the engine was asked first */
+#if NGS_RECORD
+#define NGS_RECORD_CALL( vt_type, method )                                                                 \
+    static const unsigned int ngs_record_slot = ngs :: Record :: Register ( #vt_type "::" #method );     \
+    ngs :: Record :: Call ngs_record_call ( ngs_record_slot, self )
+#define NGS_RECORD_ARG( arg ) \
+    ngs_record_call . Arg ( arg )
+#define NGS_RECORD_RESULT( obj ) \
+    ngs_record_call . Result ( obj )
+#define NGS_RECORD_QUIET( asked ) \
+    ngs :: Record :: Quiet ngs_record_quiet ( asked )
+#else
+#define NGS_RECORD_CALL( vt_type, method ) \
+    ( void ) 0
+#define NGS_RECORD_ARG( arg ) \
+    ( void ) 0
+#define NGS_RECORD_RESULT( obj ) \
+    ( void ) 0
+#define NGS_RECORD_QUIET( asked ) \
+    ( void ) 0
+#endif
+
+#endif // _hpp_ngs_itf_record_
@@ -37,6 +37,15 @@ extern "C" {
 
 /*--------------------------------------------------------------------------
  * NGS_Refcount_v1
+ *
+ *  v1.1 adds query_ext, through which an object hands out the vtable of an
+ *  optional interface - an extension - that it has besides the one it was
+ *  made with. an extension is named like an interface, e.g. "NGS_Xyz_v1",
+ *  and its vtable begins with an NGS_VTable whose itf_name is that name and
+ *  whose minor_version counts its own revisions; its methods are passed
+ *  the same object. an object without the extension returns NULL, as does
+ *  the dispatch layer for an engine older than v1.1, so that a client may
+ *  probe once, e.g. per iterator, and fall back to the plain messages
  */
 typedef struct NGS_Refcount_v1 NGS_Refcount_v1;
 struct NGS_Refcount_v1
@@ -51,6 +60,9 @@ struct NGS_Refcount_v1_vt
 
     void ( CC * release ) ( NGS_Refcount_v1 * self, NGS_ErrBlock_v1 * err );
     void* ( CC * duplicate ) ( const NGS_Refcount_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* v1.1 */
+    const NGS_VTable * ( CC * query_ext ) ( const NGS_Refcount_v1 * self, NGS_ErrBlock_v1 * err, const char * name );
 };
 
 #ifdef __cplusplus
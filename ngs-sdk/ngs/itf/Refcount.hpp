@@ -36,6 +36,7 @@
 #endif
 
 struct NGS_Refcount_v1;
+struct NGS_VTable;
 
 namespace ngs
 {
@@ -48,10 +49,17 @@ namespace ngs
     public:
 
         void Release ()
-            throw ();
+            NGS_NOTHROW;
 
         void * Duplicate () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        /* QueryExtension
+         *  the vtable of the extension "name", or NULL if the object has none
+         *  see NGS_Refcount_v1_vt :: query_ext
+         */
+        const NGS_VTable * QueryExtension ( const char * name ) const
+            NGS_THROWS ( ErrorMsg );
 
     private:
         OpaqueRefcount ();
@@ -71,18 +79,25 @@ namespace ngs
 
         inline
         void Release ()
-            throw ()
+            NGS_NOTHROW
         {
             OpaqueRefcount :: Release ();
         }
 
         inline
         T * Duplicate () const
-            throw ( ErrorMsg )
+            NGS_THROWS ( ErrorMsg )
         {
             return static_cast < T* > ( OpaqueRefcount :: Duplicate () );
         }
 
+        inline
+        const NGS_VTable * QueryExtension ( const char * name ) const
+            NGS_THROWS ( ErrorMsg )
+        {
+            return OpaqueRefcount :: QueryExtension ( name );
+        }
+
     protected:
 
         // type-punning casts from C++ to C object
@@ -50,7 +50,24 @@ enum NGS_ReferenceAlignFlags
     NGS_ReferenceAlignFlags_min_map_qual        = 0x10,
     NGS_ReferenceAlignFlags_max_map_qual        = 0x20,
     NGS_ReferenceAlignFlags_no_wraparound       = 0x40,
-    NGS_ReferenceAlignFlags_start_within_window = 0x80
+    NGS_ReferenceAlignFlags_start_within_window = 0x80,
+    NGS_ReferenceAlignFlags_with_mates          = 0x100
+};
+
+/* the messages a Reference answers, as reported by get_features
+ *  a clear bit means the engine would only answer them with an error;
+ *  an iterator reports on its current Reference */
+enum NGS_ReferenceFeature
+{
+    NGS_ReferenceFeature_canonical_name         = 0x01,
+    NGS_ReferenceFeature_circularity            = 0x02,  /* is_circular */
+    NGS_ReferenceFeature_bases                  = 0x04,  /* get_ref_bases, get_ref_chunk */
+    NGS_ReferenceFeature_alignment_by_id        = 0x08,
+    NGS_ReferenceFeature_alignments             = 0x10,  /* whole, sliced and filtered */
+    NGS_ReferenceFeature_alignment_count        = 0x20,
+    NGS_ReferenceFeature_alignment_shard        = 0x40,
+    NGS_ReferenceFeature_pileups                = 0x80,  /* whole, sliced and filtered */
+    NGS_ReferenceFeature_all                    = 0xFF
 };
 
 
@@ -94,6 +111,52 @@ struct NGS_Reference_v1_vt
     /* 1.3 interface */
     struct NGS_Alignment_v1 * ( CC * get_filtered_alignments ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, uint32_t flags, int32_t map_qual );
     struct NGS_Alignment_v1 * ( CC * get_filtered_align_slice ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length, uint32_t flags, int32_t map_qual );
+
+    /* 1.4 interface */
+    struct NGS_Alignment_v1 * ( CC * get_align_shard ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary );
+
+    /* 1.5 interface */
+    uint32_t ( CC * get_features ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err );
+
+    /* 1.6 interface
+     *  fills in depth [ 0 .. length ) with the number of alignments, chosen as by
+     *  get_filtered_align_slice, that cover each position of [ start, start + length )
+     *  with an M, D, = or X operation; returns false, leaving "depth" alone, if the
+     *  engine leaves the count to the caller */
+    bool ( CC * get_coverage ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length, uint32_t flags, int32_t map_qual, uint32_t * depth );
+
+    /* 1.7 interface
+     *  as get_filtered_pileup_slice, with the alignments that start at a position
+     *  sampled, as they enter the pileup, down to the room that "max_depth" leaves
+     *  after those still covering it, so that no Pileup is deeper; the same "seed"
+     *  samples the same alignments. a "max_depth" of 0 samples nothing.
+     *  "skip_empty" leaves out the positions that no alignment covers */
+    struct NGS_Pileup_v1 * ( CC * get_sampled_pileup_slice ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length,
+        uint32_t flags, int32_t map_qual, uint32_t max_depth, uint64_t seed, bool skip_empty );
+
+    /* 1.8 interface
+     *  copies up to "size" bases from "offset" into "buffer", across the
+     *  chunks of get_ref_chunk, and returns how many; fewer are copied only
+     *  at the end of the Reference, and none from an "offset" at or past it */
+    uint64_t ( CC * copy_ref_bases ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, char * buffer, uint64_t size );
+
+    /* 1.9 interface
+     *  packs up to "length" bases from "offset" into "bases", four to a byte
+     *  as A = 0, C = 1, G = 2 and T = 3, the first base in the low bits, and
+     *  sets "count" to how many, as copy_ref_bases would copy; any other base
+     *  is packed as 0 and has its bit set in "n_mask", eight to a byte, the
+     *  first base in the low bit, if "n_mask" isn't NULL. the case is ignored.
+     *  returns false, leaving it all alone, if the engine leaves it to the caller */
+    bool ( CC * get_packed_ref_bases ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, uint64_t offset, uint64_t length,
+        uint8_t * bases, uint8_t * n_mask, uint64_t * count );
+
+    /* 1.10 interface
+     *  sets "alignments" to about how many alignments overlap [ start, start + length )
+     *  and "bytes" to about how many bytes of the compressed file hold them, from
+     *  what the engine knows without reading them, as an index; for sizing work.
+     *  returns false, leaving both alone, if the engine leaves it to the caller */
+    bool ( CC * estimate_slice ) ( const NGS_Reference_v1 * self, NGS_ErrBlock_v1 * err, int64_t start, uint64_t length,
+        uint64_t * alignments, uint64_t * bytes );
 };
 
 
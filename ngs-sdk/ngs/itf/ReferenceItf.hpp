@@ -51,47 +51,72 @@ namespace ngs
     public:
 
         StringItf * getCommonName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getCanonicalName () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         bool getIsCircular () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getLength () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReferenceBases ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReferenceBases ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReferenceChunk ( uint64_t offset ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getReferenceChunk ( uint64_t offset, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAlignmentCount () const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAlignmentCount ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignment ( const char * alignmentId ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignments ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignmentSlice ( int64_t start, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getAlignmentSlice ( int64_t start, uint64_t length, uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         AlignmentItf * getFilteredAlignmentSlice ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+        AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, uint32_t categories ) const
+            NGS_THROWS ( ErrorMsg );
         PileupItf * getPileups ( uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupItf * getFilteredPileups ( uint32_t categories, uint32_t filters, int32_t mappingQuality ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupItf * getPileupSlice ( int64_t start, uint64_t length ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupItf * getPileupSlice ( int64_t start, uint64_t length, uint32_t categories ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         PileupItf * getFilteredPileupSlice ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+        PileupItf * getFilteredPileupSlice ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality,
+                uint32_t maxDepth, uint64_t seed, bool skipEmpty ) const
+            NGS_THROWS ( ErrorMsg );
         bool nextReference ()
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
+
+        // NGS_ReferenceFeature_* bits for the current Reference
+        uint32_t getFeatures () const
+            NGS_THROWS ( ErrorMsg );
+
+        // fill in depth [ 0 .. length ), counting from a slice if the engine doesn't
+        void getCoverage ( int64_t start, uint64_t length, uint32_t categories, uint32_t filters, int32_t mappingQuality, uint32_t * depth ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // copy bases into "buffer", from chunks if the engine doesn't
+        uint64_t copyReferenceBases ( uint64_t offset, char * buffer, uint64_t size ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // pack bases into "bases" and "nMask", from copied ones if the engine doesn't
+        uint64_t getReferenceBasesPacked ( uint64_t offset, uint64_t length, uint8_t * bases, uint8_t * nMask ) const
+            NGS_THROWS ( ErrorMsg );
+
+        // estimate a slice, scaling the alignment count if the engine doesn't
+        void estimateSlice ( int64_t start, uint64_t length, uint64_t & alignments, uint64_t & bytes ) const
+            NGS_THROWS ( ErrorMsg );
     };
 
 } // namespace ngs
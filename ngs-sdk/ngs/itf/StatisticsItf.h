@@ -44,17 +44,49 @@ struct NGS_Statistics_v1
     const NGS_VTable * vt;
 };
 
+/*--------------------------------------------------------------------------
+ * NGS_StatisticsEntry_v1
+ *  one path and its value, as lent by get_entries
+ *
+ *  "type" is what get_type answers for "path" and names the member of
+ *  the union that holds the value; a string value is at "text", which
+ *  is otherwise empty. "path" is NUL-terminated
+ */
+typedef struct NGS_StatisticsEntry_v1 NGS_StatisticsEntry_v1;
+struct NGS_StatisticsEntry_v1
+{
+    const char * path;
+    uint64_t path_size;
+    const char * text;
+    uint64_t text_size;
+    uint32_t type;
+    union
+    {
+        int64_t i64;
+        uint64_t u64;
+        double f64;
+    } value;
+};
+
 typedef struct NGS_Statistics_v1_vt NGS_Statistics_v1_vt;
 struct NGS_Statistics_v1_vt
 {
     NGS_VTable dad;
 
+    /* v1.0 interface */
     uint32_t ( CC * get_type ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
     NGS_String_v1 * ( CC * as_string ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
     int64_t ( CC * as_I64 ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
     uint64_t ( CC * as_U64 ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
     double ( CC * as_F64 ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
     NGS_String_v1 * ( CC * next_path ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const char * path );
+
+    /* v1.1
+     *  sets "entries" to every path of the set with its value, in the
+     *  order of next_path, and "count" to their number and returns true,
+     *  or returns false if the engine has no such list to lend; the list
+     *  is valid for the life of the object */
+    bool ( CC * get_entries ) ( const NGS_Statistics_v1 * self, NGS_ErrBlock_v1 * err, const NGS_StatisticsEntry_v1 ** entries, uint64_t * count );
 };
 
 
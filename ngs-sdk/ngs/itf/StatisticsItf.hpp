@@ -32,6 +32,7 @@
 #endif
 
 struct NGS_Statistics_v1;
+struct NGS_StatisticsEntry_v1;
 
 namespace ngs
 {
@@ -49,17 +50,19 @@ namespace ngs
     public:
 
         uint32_t getValueType ( const char * path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * getAsString ( const char * path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         int64_t getAsI64 ( const char * path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         uint64_t getAsU64 ( const char * path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         double getAsDouble ( const char * path ) const
-            throw ( ErrorMsg );
+            NGS_THROWS ( ErrorMsg );
         StringItf * nextPath ( const char * path ) const
-            throw ();
+            NGS_NOTHROW;
+        bool getEntries ( const NGS_StatisticsEntry_v1 * & entries, uint64_t & count ) const
+            NGS_THROWS ( ErrorMsg );
     };
 
 } // namespace ngs
@@ -55,6 +55,18 @@ struct NGS_String_v1_vt
 };
 
 
+/*--------------------------------------------------------------------------
+ * NGS_StringView_v1
+ *  textual data lent by an object rather than handed out as a reference,
+ *  valid until the next message to the object that filled it in
+ */
+struct NGS_StringView_v1
+{
+    const char * data;
+    size_t size;
+};
+
+
 #ifdef __cplusplus
 }
 #endif
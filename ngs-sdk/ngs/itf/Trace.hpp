@@ -0,0 +1,162 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_itf_trace_
+#define _hpp_ngs_itf_trace_
+
+#ifndef _h_ngs_itf_defs_
+#include <ngs/itf/defs.h>
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+/*--------------------------------------------------------------------------
+ * NGS_TRACE
+ *  the dispatch layer records a timed span for each call through a C
+ *  vtable method when built with "make NGS_TRACE=1", and then only while
+ *  switched on: by setting the environment variable NGS_TRACE to the
+ *  name of a file for the spans to be written to at exit, or with
+ *  Trace :: Enable
+ *
+ *  each thread records into a ring of its own that keeps the latest
+ *  RING_SIZE spans; they are written as Chrome trace events, which
+ *  chrome://tracing and Perfetto read, in the array format that may be
+ *  appended to, so that an engine recording its own spans can add them
+ *  to the same file, as ngs-bam does
+ *
+ *  without the build flag, NGS_TRACE_SCOPE is nothing at all; with it,
+ *  a span costs a single branch while tracing is off
+ */
+
+namespace ngs
+{
+
+    /*----------------------------------------------------------------------
+     * Trace
+     *  per-thread rings of timed spans
+     */
+    class Trace
+    {
+    public:
+
+        static const unsigned int RING_SIZE = 65536;
+
+        struct Event
+        {
+            const char * name;      // e.g. "NGS_Alignment_v1_vt::get_ref_spec"
+            uint64_t start;         // CLOCK_MONOTONIC nanoseconds
+            uint64_t duration;
+            unsigned int thread;    // the system's id for it on Linux; elsewhere 1 for the first to record, and so on
+        };
+
+        /* Compiled
+         *  true if the dispatch layer was built to trace
+         */
+        static bool Compiled ()
+            NGS_NOTHROW;
+
+        /* Enable
+         *  switch tracing on or off; has no effect unless Compiled
+         */
+        static void Enable ( bool on )
+            NGS_NOTHROW;
+
+        static bool Enabled ()
+            NGS_NOTHROW
+        {
+            return on;
+        }
+
+        /* Collect
+         *  the spans kept so far, of all threads or of the calling one only,
+         *  each thread's oldest first
+         */
+        static void Collect ( std :: vector < Event > & out, bool this_thread_only = false );
+
+        /* Clear
+         *  empty the rings of all threads
+         */
+        static void Clear ()
+            NGS_NOTHROW;
+
+        /* Export
+         *  write the spans kept so far as one Chrome trace event per line,
+         *  each followed by a comma, after the opening "[" if "open"
+         *  the closing "]" may be left off in this format
+         */
+        static void Export ( FILE * out, bool open = true );
+
+    public:
+
+        // used by NGS_TRACE_SCOPE
+
+        static uint64_t Now ()
+            NGS_NOTHROW;
+
+        static void Record ( const char * name, uint64_t start, uint64_t end )
+            NGS_NOTHROW;
+
+        class Scope
+        {
+        public:
+
+            explicit Scope ( const char * _name )
+                : name ( _name )
+                , start ( on ? Now () : 0 )
+            {
+            }
+
+            ~ Scope ()
+            {
+                if ( start != 0 )
+                    Record ( name, start, Now () );
+            }
+
+        private:
+
+            const char * name;
+            uint64_t start;
+        };
+
+    private:
+
+        static bool on;
+    };
+
+} // namespace ngs
+
+#if NGS_TRACE
+#define NGS_TRACE_SCOPE( name ) \
+    ngs :: Trace :: Scope ngs_trace_scope ( name )
+#else
+#define NGS_TRACE_SCOPE( name ) \
+    ( void ) 0
+#endif
+
+#endif // _hpp_ngs_itf_trace_
@@ -35,6 +35,31 @@
 #include <ngs/itf/VTable.h>
 #endif
 
+/*--------------------------------------------------------------------------
+ * NGS_ITF_ATOMIC_BUILTINS
+ *  the words below are shared by all threads, and are filled in by the
+ *  first to need them: a hierarchy cache is published whole with
+ *  release and read with acquire, and what is memoized is loaded and
+ *  stored atomically, which on x86 costs no more than a plain access.
+ *  on wherever the compiler's __atomic builtins exist; without them, the
+ *  words are volatile as before, which the compilers concerned order
+ */
+#ifndef NGS_ITF_ATOMIC_BUILTINS
+ #if defined __clang__ || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 7 )
+  #define NGS_ITF_ATOMIC_BUILTINS 1
+ #else
+  #define NGS_ITF_ATOMIC_BUILTINS 0
+ #endif
+#endif
+
+#if NGS_ITF_ATOMIC_BUILTINS
+ #define NGS_ITF_LOAD( word ) __atomic_load_n ( & ( word ), __ATOMIC_ACQUIRE )
+ #define NGS_ITF_STORE( word, val ) __atomic_store_n ( & ( word ), ( val ), __ATOMIC_RELEASE )
+#else
+ #define NGS_ITF_LOAD( word ) ( word )
+ #define NGS_ITF_STORE( word, val ) ( ( void ) ( ( word ) = ( val ) ) )
+#endif
+
 namespace ngs
 {
     /*----------------------------------------------------------------------
@@ -47,6 +72,7 @@ namespace ngs
         {
             assert ( parent == 0 );
             assert ( idx == 0 );
+            assert ( exact == 0 );
         }
 
         ItfTok ( const char * name, const ItfTok & dad )
@@ -54,6 +80,7 @@ namespace ngs
             , parent ( & dad )
         {
             assert ( idx == 0 );
+            assert ( exact == 0 );
         }
 
         /* name of the interface */
@@ -64,6 +91,10 @@ namespace ngs
 
         // index into linear inheritance array
         uint32_t mutable volatile idx;
+
+        // the last vtable found to be of exactly this interface,
+        // letting Cast skip the hierarchy for the objects seen most
+        mutable const NGS_VTable * volatile exact;
     };
 
     /*----------------------------------------------------------------------
@@ -72,34 +103,57 @@ namespace ngs
      *  resolves array indices of itf tokens
      */
     void Resolve ( const ItfTok & itf )
-        throw ();
+        NGS_NOTHROW;
     void Resolve ( const NGS_VTable * vt, const ItfTok & itf )
-        throw ( ErrorMsg );
+        NGS_THROWS ( ErrorMsg );
 
     /*----------------------------------------------------------------------
      * Cast
      *  cast an NGS_VTable to the desired level
      */
+    inline
+    const void * CastFound ( const NGS_VTable * vt, const ItfTok & itf, const NGS_VTable * out )
+        NGS_NOTHROW
+    {
+        if ( out == vt )
+            NGS_ITF_STORE ( itf . exact, vt );
+        return out;
+    }
+
     inline
     const void * Cast ( const NGS_VTable * vt, const ItfTok & itf )
-        throw ( ErrorMsg )
+        NGS_THROWS ( ErrorMsg )
     {
         if ( vt != 0 )
         {
-            if ( itf . idx == 0 )
+            if ( vt == NGS_ITF_LOAD ( itf . exact ) )
+                return vt;
+
+            uint32_t idx = NGS_ITF_LOAD ( itf . idx );
+            if ( idx == 0 )
+            {
                 Resolve ( itf );
-            if ( vt -> cache == 0 )
+                idx = NGS_ITF_LOAD ( itf . idx );
+            }
+
+            const NGS_HierCache * cache = NGS_ITF_LOAD ( vt -> cache );
+            if ( cache == 0 )
+            {
                 Resolve ( vt, itf );
+                cache = NGS_ITF_LOAD ( vt -> cache );
+            }
 
-            assert ( itf . idx != 0 );
-            assert ( itf . idx <= ( unsigned int ) vt -> cache -> length );
-            if ( vt -> cache -> hier [ itf . idx - 1 ] . itf_tok == ( const void* ) & itf )
-                return vt -> cache -> hier [ itf . idx - 1 ] . parent;
-            if ( vt -> cache -> hier [ itf . idx - 1 ] . itf_tok == 0 )
+            assert ( idx != 0 );
+            assert ( idx <= ( unsigned int ) cache -> length );
+            const void * tok = NGS_ITF_LOAD ( cache -> hier [ idx - 1 ] . itf_tok );
+            if ( tok == ( const void* ) & itf )
+                return CastFound ( vt, itf, cache -> hier [ idx - 1 ] . parent );
+            if ( tok == 0 )
             {
                 Resolve ( vt, itf );
-                if ( vt -> cache -> hier [ itf . idx - 1 ] . itf_tok == ( const void* ) & itf )
-                    return vt -> cache -> hier [ itf . idx - 1 ] . parent;
+                tok = NGS_ITF_LOAD ( cache -> hier [ idx - 1 ] . itf_tok );
+                if ( tok == ( const void* ) & itf )
+                    return CastFound ( vt, itf, cache -> hier [ idx - 1 ] . parent );
             }
         }
 
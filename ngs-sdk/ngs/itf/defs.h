@@ -47,6 +47,49 @@ extern "C" {
  #endif
 #endif
 
+/*--------------------------------------------------------------------------
+ * NGS_CXX11
+ *  whether the C++ compiler knows C++11
+ */
+#ifndef NGS_CXX11
+ #if defined __cplusplus && ( __cplusplus >= 201103L || ( defined _MSC_VER && _MSC_VER >= 1900 ) )
+  #define NGS_CXX11 1
+ #else
+  #define NGS_CXX11 0
+ #endif
+#endif
+
+/*--------------------------------------------------------------------------
+ * NGS_HAVE_MOVE
+ *  whether the C++ handle classes have move constructors and
+ *  assignments, which hand over their reference without counting it
+ *  defining it to 0 beforehand turns them off
+ */
+#ifndef NGS_HAVE_MOVE
+ #define NGS_HAVE_MOVE NGS_CXX11
+#endif
+
+/*--------------------------------------------------------------------------
+ * NGS_THROWS, NGS_NOTHROW
+ *  exception specifications of the C++ classes
+ *  under C++98 they are the dynamic ones, which are checked at run time
+ *  around every call; with NGS_NOEXCEPT they are noexcept ( false ) and
+ *  noexcept instead, which cost nothing and leave the thin inline
+ *  wrappers free to be inlined, and which C++17 requires
+ *  NGS_NOEXCEPT is set from C++11 on unless defined to 0 beforehand
+ */
+#ifndef NGS_NOEXCEPT
+ #define NGS_NOEXCEPT NGS_CXX11
+#endif
+
+#if NGS_NOEXCEPT
+ #define NGS_THROWS( x ) noexcept ( false )
+ #define NGS_NOTHROW noexcept
+#else
+ #define NGS_THROWS( x ) throw ( x )
+ #define NGS_NOTHROW throw ()
+#endif
+
 /*--------------------------------------------------------------------------
  * NGS_ErrBlock
  *  see "ErrBlock.h"
@@ -58,6 +101,7 @@ typedef struct NGS_ErrBlock_v1 NGS_ErrBlock_v1;
  *  see "StringItf.h"
  */
 typedef struct NGS_String_v1 NGS_String_v1;
+typedef struct NGS_StringView_v1 NGS_StringView_v1;
 
 
 #ifdef __cplusplus
@@ -0,0 +1,82 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _h_atomic32_
+#define _h_atomic32_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * the compiler's __atomic builtins, for processors without
+ * hand-written versions; only what the engine adapters need
+ */
+typedef struct atomic32_t atomic32_t;
+struct atomic32_t
+{
+    volatile int counter;
+};
+
+/* int atomic32_read ( const atomic32_t *v ); */
+#define atomic32_read( v ) \
+    __atomic_load_n ( & ( v ) -> counter, __ATOMIC_SEQ_CST )
+
+/* void atomic32_set ( atomic32_t *v, int i ); */
+#define atomic32_set( v, i ) \
+    __atomic_store_n ( & ( v ) -> counter, ( i ), __ATOMIC_SEQ_CST )
+
+/* add to v -> counter and return the prior value */
+/* int atomic32_read_and_add ( atomic32_t *v, int i ) */
+#define atomic32_read_and_add( v, i ) \
+    __atomic_fetch_add ( & ( v ) -> counter, ( i ), __ATOMIC_SEQ_CST )
+
+/* void atomic32_dec ( atomic32_t *v ) */
+#define atomic32_dec( v ) \
+    ( ( void ) __atomic_fetch_sub ( & ( v ) -> counter, 1, __ATOMIC_SEQ_CST ) )
+
+/* set v -> counter to s if it is t and return the prior value */
+static __inline__ int atomic32_test_and_set ( atomic32_t *v, int s, int t )
+{
+    __atomic_compare_exchange_n ( & v -> counter, & t, s, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+    return t;
+}
+
+/* add to v -> counter if it is greater than t and return the prior value */
+static __inline__ int atomic32_read_and_add_gt ( atomic32_t *v, int i, int t )
+{
+    int val = atomic32_read ( v );
+    while ( val > t &&
+            ! __atomic_compare_exchange_n ( & v -> counter, & val, val + i, 1, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+        ;
+    return val;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _h_atomic32_ */
@@ -0,0 +1,471 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* micro-benchmarks for the dispatch layer
+ *
+ *  every call made here goes C++ API -> dispatch -> C vtable -> adapter
+ *  -> test engine, and the test engine does next to no work of its own,
+ *  so the numbers are the cost of the layering.
+ *
+ *  output is one JSON object per line:
+ *    {"bench":"<name>","iterations":<n>,"ns_per_call":<x>}
+ *
+ *  usage: bench-ngs [ options ] [ iterations [ name-filter [ spec ] ] ]
+ *
+ *  given a "synthetic:..." spec, the streams of the generated collection
+ *  are timed instead, per alignment, read or pileup event
+ *
+ *  options:
+ *    -rounds n          run every bench n times and keep the best
+ *    -check baseline    compare with the output of an earlier run and
+ *                       exit with 2 if a bench got slower
+ *    -tolerance pct     how much slower is allowed, 20 by default
+ *
+ *  the times are compared as multiples of an indirect call timed in the
+ *  same run, so that a baseline carries over to a machine of another speed
+ */
+
+#include <test/test_engine/test_engine.hpp>
+#include <test/test_engine/ReadCollectionItf.hpp>
+
+#include <ngs/AlignmentBatch.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <time.h>
+
+////////////////////////////////////
+
+// our little benchmarking framework
+
+static uint64_t iterations = 1000000;
+static const char * filter = 0;
+static unsigned rounds = 1;
+
+/* keeps the optimizer from throwing away the results */
+static volatile uint64_t sink;
+
+static
+uint64_t now_ns ()
+{
+    struct timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC, & ts );
+    return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+}
+
+/* the best time of each bench over the rounds, in the order they ran */
+struct Result
+{
+    std :: string name;
+    uint64_t iterations;
+    double ns_per_call;
+};
+static std :: vector < Result > results;
+
+static
+void report ( const char * name, uint64_t n, uint64_t elapsed )
+{
+    double ns = n == 0 ? 0.0 : ( double ) elapsed / ( double ) n;
+    for ( size_t i = 0; i < results . size (); ++ i )
+    {
+        if ( results [ i ] . name == name )
+        {
+            if ( ns < results [ i ] . ns_per_call )
+                results [ i ] . ns_per_call = ns;
+            return;
+        }
+    }
+    Result r;
+    r . name = name;
+    r . iterations = n;
+    r . ns_per_call = ns;
+    results . push_back ( r );
+}
+
+static
+void print_results ()
+{
+    for ( size_t i = 0; i < results . size (); ++ i )
+    {
+        char ns [ 32 ];
+        snprintf ( ns, sizeof ns, "%.2f", results [ i ] . ns_per_call );
+        std :: cout
+            << "{\"bench\":\"" << results [ i ] . name << "\""
+            << ",\"iterations\":" << results [ i ] . iterations
+            << ",\"ns_per_call\":" << ns
+            << "}"
+            << std :: endl;
+    }
+}
+
+static
+bool selected ( const char * name )
+{
+    return filter == 0 || strstr ( name, filter ) != 0;
+}
+
+/* times "n" evaluations of "expr" */
+#define BENCH( name, n, setup, expr )                                   \
+    if ( selected ( name ) )                                            \
+    {                                                                   \
+        setup;                                                          \
+        uint64_t count = ( n );                                         \
+        uint64_t start = now_ns ();                                     \
+        for ( uint64_t i = 0; i < count; ++ i )                         \
+        {                                                               \
+            expr;                                                       \
+        }                                                               \
+        report ( name, count, now_ns () - start );                      \
+    }
+
+////////////////////////////////////
+
+/* the yardstick the others are checked against: a call through a
+   pointer the compiler can't see through, timed whatever the filter */
+static const char CALIBRATION [] = "Calibration.indirectCall";
+static const uint64_t calibration_calls = 10000000;
+
+static
+uint64_t calibration_step ( uint64_t x )
+{
+    return x * 3 + 1;
+}
+
+static
+void calibrate ()
+{
+    uint64_t ( * volatile fn ) ( uint64_t ) = calibration_step;
+    uint64_t start = now_ns ();
+    for ( uint64_t i = 0; i < calibration_calls; ++ i )
+        sink += fn ( i );
+    report ( CALIBRATION, calibration_calls, now_ns () - start );
+}
+
+static
+const Result * find_result ( const std :: string & name )
+{
+    for ( size_t i = 0; i < results . size (); ++ i )
+    {
+        if ( results [ i ] . name == name )
+            return & results [ i ];
+    }
+    return 0;
+}
+
+/* compares "results" with the lines of "path", as print_results wrote
+   them, and returns the number of benches slower than "tolerance"
+   percent allows; changes under half a nanosecond are taken for noise */
+static
+int check ( const char * path, double tolerance )
+{
+    std :: ifstream in ( path );
+    if ( ! in )
+        throw std :: runtime_error ( std :: string ( "cannot read baseline " ) + path );
+
+    std :: map < std :: string, double > baseline;
+    std :: string line;
+    while ( std :: getline ( in, line ) )
+    {
+        std :: string :: size_type name = line . find ( "\"bench\":\"" );
+        std :: string :: size_type ns = line . find ( "\"ns_per_call\":" );
+        if ( name == std :: string :: npos || ns == std :: string :: npos )
+            continue;
+        name += 9;
+        std :: string :: size_type end = line . find ( '"', name );
+        if ( end == std :: string :: npos )
+            continue;
+        baseline [ line . substr ( name, end - name ) ] = strtod ( line . c_str () + ns + 14, 0 );
+    }
+
+    const Result * cal = find_result ( CALIBRATION );
+    if ( cal == 0 || baseline [ CALIBRATION ] <= 0 || cal -> ns_per_call <= 0 )
+        throw std :: runtime_error ( std :: string ( "no calibration in baseline " ) + path );
+    double scale = baseline [ CALIBRATION ] / cal -> ns_per_call;
+
+    int regressions = 0;
+    for ( size_t i = 0; i < results . size (); ++ i )
+    {
+        const Result & r = results [ i ];
+        std :: map < std :: string, double > :: const_iterator b = baseline . find ( r . name );
+        if ( r . name == CALIBRATION || b == baseline . end () || b -> second <= 0 )
+            continue;
+
+        // as it would have been on the baseline's machine
+        double scaled = r . ns_per_call * scale;
+        double change = ( scaled - b -> second ) * 100 / b -> second;
+        bool slower = change > tolerance && scaled - b -> second > 0.5;
+        if ( slower )
+            ++ regressions;
+
+        char text [ 160 ];
+        snprintf ( text, sizeof text, "{\"bench\":\"%s\",\"baseline_ns\":%.2f,\"scaled_ns\":%.2f,\"change_pct\":%.1f%s}",
+                   r . name . c_str (), b -> second, scaled, change, slower ? ",\"regression\":true" : "" );
+        std :: cerr << text << std :: endl;
+    }
+    return regressions;
+}
+
+static
+void bench_getters ( const ngs :: ReadCollection & rc )
+{
+    BENCH ( "ReadCollection.getName", iterations, ;,
+            sink += rc . getName () . size () )
+
+    BENCH ( "Alignment.getAlignmentPosition", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getAlignmentPosition () )
+    BENCH ( "Alignment.getAlignmentLength", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getAlignmentLength () )
+    BENCH ( "Alignment.getMappingQuality", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getMappingQuality () )
+    BENCH ( "Alignment.getIsReversedOrientation", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getIsReversedOrientation () )
+    BENCH ( "Alignment.getReferenceSpec", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getReferenceSpec () . size () )
+    BENCH ( "Alignment.getFragmentBases", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getFragmentBases () . size () )
+    BENCH ( "Alignment.getFragmentBasesView", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            sink += al . getFragmentBasesView () . size () )
+
+    BENCH ( "Read.getReadCategory", iterations,
+            ngs :: Read read = rc . getRead ( "read" ),
+            sink += read . getReadCategory () )
+    BENCH ( "Read.getNumFragments", iterations,
+            ngs :: Read read = rc . getRead ( "read" ),
+            sink += read . getNumFragments () )
+    BENCH ( "Read.getReadBases", iterations,
+            ngs :: Read read = rc . getRead ( "read" ),
+            sink += read . getReadBases () . size () )
+}
+
+static
+void bench_iterators ( const ngs :: ReadCollection & rc )
+{
+    /* the test engine makes "shard + 1" alignments for a shard */
+    uint32_t n = iterations > 0xFFFFFFFF ? 0xFFFFFFFF : ( uint32_t ) iterations;
+
+    BENCH ( "AlignmentIterator.nextAlignment", n,
+            ngs :: AlignmentIterator it = rc . getAlignmentShard ( n - 1, n, ngs :: Alignment :: all ),
+            sink += it . nextAlignment () )
+    BENCH ( "AlignmentIterator.nextAlignment+getAlignmentPosition", n,
+            ngs :: AlignmentIterator it = rc . getAlignmentShard ( n - 1, n, ngs :: Alignment :: all ),
+            it . nextAlignment (); sink += it . getAlignmentPosition () )
+
+    if ( selected ( "AlignmentIterator.nextAlignmentBatch" ) )
+    {
+        ngs :: AlignmentIterator it = rc . getAlignmentShard ( n - 1, n, ngs :: Alignment :: all );
+        ngs :: AlignmentBatch batch ( ngs :: AlignmentBatch :: alignmentPosition | ngs :: AlignmentBatch :: mappingQuality );
+
+        uint64_t count = 0;
+        uint64_t start = now_ns ();
+        while ( it . nextAlignmentBatch ( batch ) )
+        {
+            for ( uint32_t i = 0; i < batch . size (); ++ i )
+                sink += batch . getAlignmentPosition ( i );
+            count += batch . size ();
+        }
+        /* reported per alignment, to compare with nextAlignment above */
+        report ( "AlignmentIterator.nextAlignmentBatch", count, now_ns () - start );
+    }
+
+    BENCH ( "ReadIterator.nextRead", iterations,
+            ngs :: ReadIterator it = rc . getReadRange ( 1, iterations ),
+            sink += it . nextRead () )
+}
+
+/* streams a synthetic collection end to end; the counts come from its
+   spec, so "iterations" has no say here */
+static
+void bench_streams ( const ngs :: ReadCollection & rc )
+{
+    if ( selected ( "Synthetic.nextAlignment+view" ) )
+    {
+        ngs :: AlignmentIterator it = rc . getAlignments ( ngs :: Alignment :: all );
+        uint64_t count = 0;
+        uint64_t start = now_ns ();
+        while ( it . nextAlignment () )
+        {
+            sink += it . getAlignmentPosition () + it . getFragmentBasesView () . size ();
+            ++ count;
+        }
+        report ( "Synthetic.nextAlignment+view", count, now_ns () - start );
+    }
+
+    if ( selected ( "Synthetic.nextAlignmentBatch" ) )
+    {
+        ngs :: AlignmentIterator it = rc . getAlignments ( ngs :: Alignment :: all );
+        ngs :: AlignmentBatch batch ( ngs :: AlignmentBatch :: alignmentPosition | ngs :: AlignmentBatch :: mappingQuality );
+        uint64_t count = 0;
+        uint64_t start = now_ns ();
+        while ( it . nextAlignmentBatch ( batch ) )
+        {
+            for ( uint32_t i = 0; i < batch . size (); ++ i )
+                sink += batch . getAlignmentPosition ( i );
+            count += batch . size ();
+        }
+        report ( "Synthetic.nextAlignmentBatch", count, now_ns () - start );
+    }
+
+    if ( selected ( "Synthetic.nextRead+getReadBases" ) )
+    {
+        ngs :: ReadIterator it = rc . getReads ( ngs :: Read :: all );
+        uint64_t count = 0;
+        uint64_t start = now_ns ();
+        while ( it . nextRead () )
+        {
+            sink += it . getReadBases () . size ();
+            ++ count;
+        }
+        report ( "Synthetic.nextRead+getReadBases", count, now_ns () - start );
+    }
+
+    if ( selected ( "Synthetic.nextPileupEvent" ) )
+    {
+        ngs :: ReferenceIterator ref = rc . getReferences ();
+        if ( ref . nextReference () )
+        {
+            ngs :: PileupIterator it = ref . getPileups ( ngs :: Alignment :: all );
+            uint64_t count = 0;
+            uint64_t start = now_ns ();
+            while ( it . nextPileup () )
+            {
+                while ( it . nextPileupEvent () )
+                {
+                    sink += it . getAlignmentBase ();
+                    ++ count;
+                }
+            }
+            report ( "Synthetic.nextPileupEvent", count, now_ns () - start );
+        }
+    }
+}
+
+static
+void bench_lifetime ( const ngs :: ReadCollection & rc )
+{
+    /* copies Duplicate the C object, destruction Releases it */
+    BENCH ( "Alignment.Duplicate+Release", iterations,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ),
+            ngs :: Alignment copy = al; sink += 1 )
+    BENCH ( "ReadCollection.getAlignment+Release", iterations, ;,
+            ngs :: Alignment al = rc . getAlignment ( "alignment" ); sink += 1 )
+}
+
+static
+int usage ( const char * name )
+{
+    std :: cerr << "usage: " << name << " [ -rounds n ] [ -check baseline [ -tolerance pct ] ]"
+                << " [ iterations [ name-filter [ spec ] ] ]" << std :: endl;
+    return 1;
+}
+
+int main ( int argc, char * argv [] )
+{
+    const char * baseline = 0;
+    double tolerance = 20;
+
+    int arg = 1;
+    for ( ; arg < argc && argv [ arg ] [ 0 ] == '-'; arg += 2 )
+    {
+        if ( arg + 1 >= argc )
+            return usage ( argv [ 0 ] );
+        if ( strcmp ( argv [ arg ], "-rounds" ) == 0 )
+            rounds = ( unsigned ) strtoul ( argv [ arg + 1 ], 0, 10 );
+        else if ( strcmp ( argv [ arg ], "-check" ) == 0 )
+            baseline = argv [ arg + 1 ];
+        else if ( strcmp ( argv [ arg ], "-tolerance" ) == 0 )
+            tolerance = strtod ( argv [ arg + 1 ], 0 );
+        else
+            return usage ( argv [ 0 ] );
+    }
+    if ( rounds == 0 || tolerance < 0 )
+        return usage ( argv [ 0 ] );
+
+    if ( argc > arg )
+    {
+        iterations = strtoull ( argv [ arg ], 0, 10 );
+        if ( iterations == 0 )
+            return usage ( argv [ 0 ] );
+    }
+    if ( argc > arg + 1 && argv [ arg + 1 ] [ 0 ] != 0 )
+        filter = argv [ arg + 1 ];
+    const char * spec = argc > arg + 2 ? argv [ arg + 2 ] : "test";
+
+    int regressions = 0;
+    try
+    {
+        ngs :: ReadCollection rc = ngs_test_engine :: NGS :: openReadCollection ( spec );
+
+        for ( unsigned round = 0; round < rounds; ++ round )
+        {
+            calibrate ();
+            if ( strncmp ( spec, "synthetic:", 10 ) == 0 )
+            {
+                bench_streams ( rc );
+            }
+            else
+            {
+                bench_getters ( rc );
+                bench_iterators ( rc );
+                bench_lifetime ( rc );
+            }
+        }
+
+        print_results ();
+        if ( baseline != 0 )
+            regressions = check ( baseline, tolerance );
+    }
+    catch ( std :: exception & x )
+    {
+        std :: cerr << "exception: " << x . what () << std :: endl;
+        return 1;
+    }
+    catch ( ... )
+    {
+        std :: cerr << "exception: unknown" << std :: endl;
+        return 1;
+    }
+
+    if ( regressions != 0 )
+    {
+        std :: cerr << regressions << " bench(es) slower than the baseline allows" << std :: endl;
+        return 2;
+    }
+    return 0;
+}
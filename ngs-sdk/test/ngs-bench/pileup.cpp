@@ -0,0 +1,300 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* pileup throughput
+ *
+ *  walks a window of a reference's pileup through each of the ways the
+ *  API has of reading it, and reports columns ( positions ) and events
+ *  per second, one JSON object per line:
+ *    {"bench":"<name>","spec":"<spec>","columns":<n>,"events":<n>,
+ *     "seconds":<x>,"columns_per_s":<x>,"events_per_s":<x>,"ns_per_event":<x>}
+ *
+ *    depth            nextPileup and getPileupDepth, no events
+ *    events           nextPileupEvent with the type, base and quality of each
+ *    events.mapq      the same, of alignments with a mapping quality of 20 or more
+ *    events.maxDepth  the same, capped at MAX_DEPTH events per position
+ *    column           getColumn, the type, base and quality columns
+ *    baseCounts       nextBaseCounts, a run of BASE_COUNT_RUN positions at a time
+ *
+ *  an engine that can't cap or sample its pileups is reported as such
+ *  for events.maxDepth
+ *
+ *  usage: bench-pileup [ spec [ reference [ start length ] ] ]
+ *
+ *  without a spec, synthetic collections are swept over depth and read
+ *  length, each with SWEEP_COLUMNS positions; a "synthetic:..." spec is
+ *  opened by the test engine, and, when built with NGS_BAM_LIBDIR, any
+ *  other spec is a BAM file opened by ngs-bam. the window is the first
+ *  reference, or the one named, whole or from "start" for "length"
+ */
+
+#include <test/test_engine/test_engine.hpp>
+
+#include <ngs/ReadCollection.hpp>
+#include <ngs/Reference.hpp>
+#include <ngs/ReferenceIterator.hpp>
+#include <ngs/PileupIterator.hpp>
+#include <ngs/PileupColumn.hpp>
+#include <ngs/PileupBaseCounts.hpp>
+
+#if HAVE_NGS_BAM
+#include <ngs-bam/ngs-bam.hpp>
+#endif
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <time.h>
+
+static const uint32_t MAX_DEPTH = 50;
+static const uint32_t BASE_COUNT_RUN = 1024;
+static const uint64_t SWEEP_COLUMNS = 100000;
+
+/* keeps the optimizer from throwing away the results */
+static volatile uint64_t sink;
+
+static
+uint64_t now_ns ()
+{
+    struct timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC, & ts );
+    return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+}
+
+static
+void report ( const char * name, const std :: string & spec, uint64_t columns, uint64_t events, uint64_t elapsed )
+{
+    double seconds = ( double ) elapsed / 1e9;
+    char text [ 256 ];
+    snprintf ( text, sizeof text,
+               ",\"columns\":%lu,\"events\":%lu,\"seconds\":%.6f"
+               ",\"columns_per_s\":%.0f,\"events_per_s\":%.0f,\"ns_per_event\":%.2f}",
+               ( unsigned long ) columns, ( unsigned long ) events, seconds,
+               seconds > 0 ? columns / seconds : 0.0,
+               seconds > 0 ? events / seconds : 0.0,
+               events > 0 ? ( double ) elapsed / events : 0.0 );
+    std :: cout << "{\"bench\":\"pileup." << name << "\",\"spec\":\"" << spec << "\"" << text << std :: endl;
+}
+
+/* the window of the pileups */
+struct Window
+{
+    ngs :: Reference ref;
+    int64_t start;
+    uint64_t length;
+
+    Window ( const ngs :: Reference & r, int64_t s, uint64_t l )
+        : ref ( r ), start ( s ), length ( l )
+    {
+    }
+
+    ngs :: PileupIterator slice () const
+    {
+        return ref . getPileupSlice ( start, length );
+    }
+};
+
+/* reads every event of "it", by type, base and quality */
+static
+void walk_events ( const char * name, const std :: string & spec, ngs :: PileupIterator it )
+{
+    uint64_t columns = 0, events = 0;
+    uint64_t start = now_ns ();
+    while ( it . nextPileup () )
+    {
+        while ( it . nextPileupEvent () )
+        {
+            sink += it . getEventType () + it . getAlignmentBase () + it . getAlignmentQuality ();
+            ++ events;
+        }
+        ++ columns;
+    }
+    report ( name, spec, columns, events, now_ns () - start );
+}
+
+static
+void bench_depth ( const Window & w, const std :: string & spec )
+{
+    ngs :: PileupIterator it = w . slice ();
+    uint64_t columns = 0, events = 0;
+    uint64_t start = now_ns ();
+    while ( it . nextPileup () )
+    {
+        events += it . getPileupDepth ();
+        ++ columns;
+    }
+    report ( "depth", spec, columns, events, now_ns () - start );
+}
+
+static
+void bench_events ( const Window & w, const std :: string & spec )
+{
+    walk_events ( "events", spec, w . slice () );
+
+    walk_events ( "events.mapq", spec,
+                  w . ref . getFilteredPileupSlice ( w . start, w . length, ngs :: Alignment :: all,
+                                                     ngs :: Alignment :: minMapQuality, 20 ) );
+
+    try
+    {
+        ngs :: PileupIterator it = w . ref . getFilteredPileupSlice ( w . start, w . length, ngs :: Alignment :: all,
+                                                                      ( ngs :: Alignment :: AlignmentFilter ) 0, 0, MAX_DEPTH );
+        walk_events ( "events.maxDepth", spec, it );
+    }
+    catch ( ngs :: ErrorMsg & )
+    {
+        std :: cout << "{\"bench\":\"pileup.events.maxDepth\",\"spec\":\"" << spec << "\",\"unsupported\":true}" << std :: endl;
+    }
+}
+
+static
+void bench_column ( const Window & w, const std :: string & spec )
+{
+    ngs :: PileupIterator it = w . slice ();
+    ngs :: PileupColumn column ( ngs :: PileupColumn :: eventType | ngs :: PileupColumn :: alignmentBase | ngs :: PileupColumn :: alignmentQuality );
+    uint64_t columns = 0, events = 0;
+    uint64_t start = now_ns ();
+    while ( it . nextPileup () )
+    {
+        it . getColumn ( column );
+
+        uint32_t n = column . size ();
+        const uint32_t * type = column . getEventTypes ();
+        const char * base = column . getAlignmentBases ();
+        const char * qual = column . getAlignmentQualities ();
+        for ( uint32_t i = 0; i < n; ++ i )
+            sink += type [ i ] + base [ i ] + qual [ i ];
+
+        events += n;
+        ++ columns;
+    }
+    report ( "column", spec, columns, events, now_ns () - start );
+}
+
+static
+void bench_base_counts ( const Window & w, const std :: string & spec )
+{
+    ngs :: PileupIterator it = w . slice ();
+    std :: vector < ngs :: PileupBaseCounts > counts ( BASE_COUNT_RUN );
+    uint64_t columns = 0, events = 0;
+    uint64_t start = now_ns ();
+    uint32_t n;
+    while ( ( n = it . nextBaseCounts ( 0, & counts [ 0 ], BASE_COUNT_RUN ) ) != 0 )
+    {
+        for ( uint32_t i = 0; i < n; ++ i )
+        {
+            for ( int kind = ngs :: PileupBaseCounts :: baseA; kind <= ngs :: PileupBaseCounts :: deletion; ++ kind )
+                events += counts [ i ] . getCount ( ( ngs :: PileupBaseCounts :: BaseKind ) kind );
+        }
+        columns += n;
+    }
+    report ( "baseCounts", spec, columns, events, now_ns () - start );
+}
+
+static
+ngs :: ReadCollection open ( const std :: string & spec )
+{
+    if ( spec . compare ( 0, 10, "synthetic:" ) == 0 )
+        return ngs_test_engine :: NGS :: openReadCollection ( spec );
+#if HAVE_NGS_BAM
+    return NGS_BAM :: openReadCollection ( spec );
+#else
+    throw std :: runtime_error ( "built without ngs-bam, so " + spec + " can't be opened; see the Makefile" );
+#endif
+}
+
+static
+void run ( const std :: string & spec, const char * refName, int64_t start, uint64_t length )
+{
+    ngs :: ReadCollection rc = open ( spec );
+
+    ngs :: ReferenceIterator refs = rc . getReferences ();
+    if ( refName == 0 && ! refs . nextReference () )
+        throw std :: runtime_error ( spec + " has no references" );
+    ngs :: Reference ref = refName != 0 ? rc . getReference ( refName ) : ngs :: Reference ( refs );
+
+    if ( length == 0 )
+        length = ref . getLength () - start;
+    Window w ( ref, start, length );
+
+    bench_depth ( w, spec );
+    bench_events ( w, spec );
+    bench_column ( w, spec );
+    bench_base_counts ( w, spec );
+}
+
+/* synthetic collections of SWEEP_COLUMNS positions at several depths and read lengths */
+static
+void sweep ()
+{
+    static const uint32_t depths [] = { 10, 30, 100, 300 };
+    static const uint32_t readlens [] = { 100, 250, 1000 };
+
+    for ( size_t d = 0; d < sizeof depths / sizeof depths [ 0 ]; ++ d )
+    {
+        for ( size_t r = 0; r < sizeof readlens / sizeof readlens [ 0 ]; ++ r )
+        {
+            char spec [ 128 ];
+            snprintf ( spec, sizeof spec, "synthetic:alignments=%lu,depth=%u,readlen=%u",
+                       ( unsigned long ) ( SWEEP_COLUMNS * depths [ d ] / readlens [ r ] ), depths [ d ], readlens [ r ] );
+            run ( spec, 0, 0, 0 );
+        }
+    }
+}
+
+int main ( int argc, char * argv [] )
+{
+    if ( argc > 5 || argc == 4 )
+    {
+        std :: cerr << "usage: " << argv [ 0 ] << " [ spec [ reference [ start length ] ] ]" << std :: endl;
+        return 1;
+    }
+
+    try
+    {
+        if ( argc == 1 )
+            sweep ();
+        else
+            run ( argv [ 1 ], argc > 2 ? argv [ 2 ] : 0,
+                  argc > 3 ? strtoll ( argv [ 3 ], 0, 10 ) : 0,
+                  argc > 4 ? strtoull ( argv [ 4 ], 0, 10 ) : 0 );
+    }
+    catch ( std :: exception & x )
+    {
+        std :: cerr << "exception: " << x . what () << std :: endl;
+        return 1;
+    }
+    catch ( ... )
+    {
+        std :: cerr << "exception: unknown" << std :: endl;
+        return 1;
+    }
+    return 0;
+}
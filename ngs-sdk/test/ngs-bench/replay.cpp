@@ -0,0 +1,1114 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+/* replay of a recorded job
+ *
+ *  makes the calls of a file written by a dispatch layer built with
+ *  NGS_RECORD ( see ngs/itf/Record.hpp ) again, with the arguments
+ *  recorded, on the collections given, and reports the time each method
+ *  took as recorded and as replayed, one JSON object per line:
+ *    {"bench":"replay.<method>","calls":<n>,"skipped":<n>,"errors":<n>,
+ *     "recorded_ns_per_call":<x>,"replayed_ns_per_call":<x>}
+ *  and a last one for the whole trace:
+ *    {"bench":"replay","trace":"<file>","calls":<n>,"skipped":<n>,
+ *     "errors":<n>,"recorded_seconds":<x>,"replayed_seconds":<x>}
+ *
+ *  usage: bench-replay [ -o options ] trace spec [ spec ... ]
+ *
+ *  the collections the job opened are opened from the specs, in order,
+ *  the last spec standing in for any more; a "synthetic:..." spec is
+ *  opened by the test engine, and, when built with NGS_BAM_LIBDIR, any
+ *  other spec is a BAM file opened by ngs-bam, with the OpenOptions
+ *  settings given by -o, e.g. "-o buildIndex=1". the calls are made one
+ *  after the other on this thread, in the order the job made them on
+ *  all of its threads, and the Strings they return are released unread
+ *
+ *  a call on an object that couldn't be replayed - one the job opened
+ *  other than a ReadCollection, or returned by a call that failed here -
+ *  is skipped, and a call that throws is counted as an error
+ */
+
+#include <test/test_engine/test_engine.hpp>
+
+#include <ngs/ReadCollection.hpp>
+
+#include <ngs/itf/ReadCollectionItf.hpp>
+#include <ngs/itf/ReadGroupItf.hpp>
+#include <ngs/itf/ReferenceItf.hpp>
+#include <ngs/itf/ReferenceSequenceItf.hpp>
+#include <ngs/itf/AlignmentItf.hpp>
+#include <ngs/itf/PileupItf.hpp>
+#include <ngs/itf/PileupEventItf.hpp>
+#include <ngs/itf/ReadItf.hpp>
+#include <ngs/itf/FragmentItf.hpp>
+#include <ngs/itf/StatisticsItf.hpp>
+#include <ngs/itf/StringItf.hpp>
+
+#if HAVE_NGS_BAM
+#include <ngs-bam/ngs-bam.hpp>
+#endif
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <time.h>
+
+using namespace ngs;
+
+/* keeps the optimizer from throwing away the results */
+static volatile uint64_t sink;
+
+static
+uint64_t now_ns ()
+{
+    struct timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC, & ts );
+    return ( uint64_t ) ts . tv_sec * 1000000000 + ts . tv_nsec;
+}
+
+static
+ngs :: ReadCollection open ( const std :: string & spec, const std :: string & options )
+{
+    if ( spec . compare ( 0, 10, "synthetic:" ) == 0 )
+        return ngs_test_engine :: NGS :: openReadCollection ( spec );
+#if HAVE_NGS_BAM
+    NGS_BAM :: OpenOptions oo;
+    NGS_BAM :: setOpenOptions ( oo, options );
+    return NGS_BAM :: openReadCollection ( spec, oo );
+#else
+    throw std :: runtime_error ( "built without ngs-bam, so " + spec + " can't be opened; see the Makefile" );
+#endif
+}
+
+/* the dispatch object under a ReadCollection, with a reference of its own */
+struct Opened : ngs :: ReadCollection
+{
+    explicit Opened ( const ngs :: ReadCollection & rc )
+        : ngs :: ReadCollection ( rc )
+    {
+    }
+
+    ReadCollectionItf * Itf () const
+    {
+        return self -> Duplicate ();
+    }
+};
+
+/*--------------------------------------------------------------------------
+ * the trace file
+ */
+struct Arg
+{
+    bool is_string;
+    int64_t i;
+    std :: string s;
+};
+
+struct Call
+{
+    unsigned int method;
+    uint64_t object;
+    uint64_t start;
+    uint64_t duration;
+    std :: vector < Arg > args;
+    uint64_t result;
+
+    int64_t I ( size_t n ) const
+    {
+        return n < args . size () && ! args [ n ] . is_string ? args [ n ] . i : 0;
+    }
+
+    const char * S ( size_t n ) const
+    {
+        return n < args . size () && args [ n ] . is_string ? args [ n ] . s . c_str () : "";
+    }
+};
+
+class Trace
+{
+public:
+
+    explicit Trace ( const char * path )
+        : f ( fopen ( path, "rb" ) )
+    {
+        char magic [ 8 ];
+        if ( f == 0 )
+            throw std :: runtime_error ( std :: string ( "can't open " ) + path );
+        if ( fread ( magic, 1, 8, f ) != 8 || memcmp ( magic, "NGSREC1\n", 8 ) != 0 )
+        {
+            fclose ( f );
+            throw std :: runtime_error ( std :: string ( path ) + " is not a recorded trace" );
+        }
+    }
+
+    ~ Trace ()
+    {
+        fclose ( f );
+    }
+
+    /* the tag of the next record, or EOF */
+    int Next ()
+    {
+        return getc ( f );
+    }
+
+    uint64_t Varint ()
+    {
+        uint64_t value = 0;
+        for ( unsigned int shift = 0; shift < 64; shift += 7 )
+        {
+            int c = getc ( f );
+            if ( c == EOF )
+                throw std :: runtime_error ( "the trace is cut short" );
+            value |= ( uint64_t ) ( c & 0x7f ) << shift;
+            if ( ( c & 0x80 ) == 0 )
+                return value;
+        }
+        throw std :: runtime_error ( "the trace is corrupt" );
+    }
+
+    std :: string String ()
+    {
+        std :: string s ( ( size_t ) Varint (), 0 );
+        if ( ! s . empty () && fread ( & s [ 0 ], 1, s . size (), f ) != s . size () )
+            throw std :: runtime_error ( "the trace is cut short" );
+        return s;
+    }
+
+    void ReadCall ( Call & c )
+    {
+        c . method = ( unsigned int ) Varint ();
+        Varint ();  // the thread
+        c . object = Varint ();
+        c . start = Varint ();
+        c . duration = Varint ();
+        c . args . resize ( ( size_t ) Varint () );
+        for ( size_t i = 0; i < c . args . size (); ++ i )
+        {
+            Arg & a = c . args [ i ];
+            int tag = getc ( f );
+            a . is_string = tag == 's';
+            if ( a . is_string )
+                a . s = String ();
+            else if ( tag == 'i' )
+            {
+                uint64_t z = Varint ();
+                a . i = ( int64_t ) ( z >> 1 ) ^ - ( int64_t ) ( z & 1 );
+            }
+            else
+                throw std :: runtime_error ( "the trace is corrupt" );
+        }
+        c . result = Varint ();
+    }
+
+private:
+
+    FILE * f;
+};
+
+/*--------------------------------------------------------------------------
+ * the methods replayed
+ */
+enum Op
+{
+    op_unknown,
+
+    rc_get_name, rc_get_read_groups, rc_has_read_group, rc_get_read_group, rc_get_references,
+    rc_has_reference, rc_get_reference, rc_get_alignment, rc_get_alignments, rc_get_align_count,
+    rc_get_align_range, rc_get_align_shard, rc_get_read, rc_get_reads, rc_get_read_count,
+    rc_get_read_range, rc_get_features, rc_get_statistics, rc_get_reference_table,
+
+    rf_get_cmn_name, rf_get_canon_name, rf_is_circular, rf_get_length, rf_get_ref_bases,
+    rf_get_ref_chunk, rf_get_align_count, rf_get_alignment, rf_get_alignments, rf_get_align_slice,
+    rf_get_filtered_align_slice, rf_get_align_shard, rf_get_pileups, rf_get_filtered_pileups,
+    rf_get_pileup_slice, rf_get_filtered_pileup_slice, rf_get_sampled_pileup_slice, rf_next,
+    rf_get_features, rf_get_coverage, rf_copy_ref_bases, rf_get_packed_ref_bases, rf_estimate_slice,
+
+    rs_get_canon_name, rs_is_circular, rs_get_length, rs_get_ref_bases, rs_get_ref_chunk,
+
+    pl_get_ref_spec, pl_get_ref_pos, pl_get_ref_base, pl_get_pileup_depth, pl_next,
+    pl_get_column, pl_get_base_counts, pl_extend_to,
+
+    pe_get_map_qual, pe_get_align_id, pe_get_align_pos, pe_get_first_align_pos, pe_get_last_align_pos,
+    pe_get_event_type, pe_get_align_base, pe_get_align_qual, pe_get_ins_bases, pe_get_ins_quals,
+    pe_get_rpt_count, pe_get_indel_type, pe_next, pe_reset, pe_get_ref_index, pe_get_mate_ref_index,
+
+    al_get_id, al_get_ref_spec, al_get_map_qual, al_get_ref_bases, al_get_read_group, al_get_read_id,
+    al_get_clipped_frag_bases, al_get_clipped_frag_quals, al_get_aligned_frag_bases, al_is_primary,
+    al_get_align_pos, al_get_ref_pos_projection_range, al_get_align_length, al_get_is_reversed,
+    al_get_soft_clip, al_get_template_len, al_get_short_cigar, al_get_long_cigar, al_get_rna_orientation,
+    al_has_mate, al_get_mate_id, al_get_mate_alignment, al_get_mate_ref_spec, al_get_mate_is_reversed,
+    al_next, al_next_batch, al_get_ref_spec_view, al_get_read_id_view, al_get_supported, al_get_tag,
+    al_get_cigar_ops, al_get_core, al_skip_to, al_get_cursor, al_resume_from, al_get_ref_index,
+    al_get_mate_ref_index, al_reposition, al_get_batch_fields, al_get_mismatches, al_get_read_fragment,
+
+    fr_get_id, fr_get_bases, fr_get_quals, fr_next, fr_is_paired, fr_is_aligned, fr_get_bases_view,
+    fr_get_quals_view, fr_get_packed_bases, fr_get_frag_index,
+
+    rd_get_id, rd_get_num_frags, rd_frag_is_aligned, rd_get_category, rd_get_read_group, rd_get_name,
+    rd_get_bases, rd_get_quals, rd_next, rd_get_cursor, rd_resume_from, rd_get_row_id,
+
+    rg_get_name, rg_get_stats, rg_next,
+
+    st_get_type, st_as_string, st_as_I64, st_as_U64, st_as_F64, st_next_path, st_get_entries,
+
+    ref_release, ref_duplicate, ref_query_ext
+};
+
+static const struct
+{
+    const char * name;
+    Op op;
+} op_names [] =
+{
+#define OP( vt, method, op ) { #vt "::" #method, op }
+    OP ( NGS_ReadCollection_v1_vt, get_name, rc_get_name ),
+    OP ( NGS_ReadCollection_v1_vt, get_read_groups, rc_get_read_groups ),
+    OP ( NGS_ReadCollection_v1_vt, has_read_group, rc_has_read_group ),
+    OP ( NGS_ReadCollection_v1_vt, get_read_group, rc_get_read_group ),
+    OP ( NGS_ReadCollection_v1_vt, get_references, rc_get_references ),
+    OP ( NGS_ReadCollection_v1_vt, has_reference, rc_has_reference ),
+    OP ( NGS_ReadCollection_v1_vt, get_reference, rc_get_reference ),
+    OP ( NGS_ReadCollection_v1_vt, get_alignment, rc_get_alignment ),
+    OP ( NGS_ReadCollection_v1_vt, get_alignments, rc_get_alignments ),
+    OP ( NGS_ReadCollection_v1_vt, get_align_count, rc_get_align_count ),
+    OP ( NGS_ReadCollection_v1_vt, get_align_range, rc_get_align_range ),
+    OP ( NGS_ReadCollection_v1_vt, get_align_shard, rc_get_align_shard ),
+    OP ( NGS_ReadCollection_v1_vt, get_read, rc_get_read ),
+    OP ( NGS_ReadCollection_v1_vt, get_reads, rc_get_reads ),
+    OP ( NGS_ReadCollection_v1_vt, get_read_count, rc_get_read_count ),
+    OP ( NGS_ReadCollection_v1_vt, get_read_range, rc_get_read_range ),
+    OP ( NGS_ReadCollection_v1_vt, get_features, rc_get_features ),
+    OP ( NGS_ReadCollection_v1_vt, get_statistics, rc_get_statistics ),
+    OP ( NGS_ReadCollection_v1_vt, get_reference_table, rc_get_reference_table ),
+
+    OP ( NGS_Reference_v1_vt, get_cmn_name, rf_get_cmn_name ),
+    OP ( NGS_Reference_v1_vt, get_canon_name, rf_get_canon_name ),
+    OP ( NGS_Reference_v1_vt, is_circular, rf_is_circular ),
+    OP ( NGS_Reference_v1_vt, get_length, rf_get_length ),
+    OP ( NGS_Reference_v1_vt, get_ref_bases, rf_get_ref_bases ),
+    OP ( NGS_Reference_v1_vt, get_ref_chunk, rf_get_ref_chunk ),
+    OP ( NGS_Reference_v1_vt, get_align_count, rf_get_align_count ),
+    OP ( NGS_Reference_v1_vt, get_alignment, rf_get_alignment ),
+    OP ( NGS_Reference_v1_vt, get_alignments, rf_get_alignments ),
+    OP ( NGS_Reference_v1_vt, get_align_slice, rf_get_align_slice ),
+    OP ( NGS_Reference_v1_vt, get_filtered_align_slice, rf_get_filtered_align_slice ),
+    OP ( NGS_Reference_v1_vt, get_align_shard, rf_get_align_shard ),
+    OP ( NGS_Reference_v1_vt, get_pileups, rf_get_pileups ),
+    OP ( NGS_Reference_v1_vt, get_filtered_pileups, rf_get_filtered_pileups ),
+    OP ( NGS_Reference_v1_vt, get_pileup_slice, rf_get_pileup_slice ),
+    OP ( NGS_Reference_v1_vt, get_filtered_pileup_slice, rf_get_filtered_pileup_slice ),
+    OP ( NGS_Reference_v1_vt, get_sampled_pileup_slice, rf_get_sampled_pileup_slice ),
+    OP ( NGS_Reference_v1_vt, next, rf_next ),
+    OP ( NGS_Reference_v1_vt, get_features, rf_get_features ),
+    OP ( NGS_Reference_v1_vt, get_coverage, rf_get_coverage ),
+    OP ( NGS_Reference_v1_vt, copy_ref_bases, rf_copy_ref_bases ),
+    OP ( NGS_Reference_v1_vt, get_packed_ref_bases, rf_get_packed_ref_bases ),
+    OP ( NGS_Reference_v1_vt, estimate_slice, rf_estimate_slice ),
+
+    OP ( NGS_ReferenceSequence_v1_vt, get_canon_name, rs_get_canon_name ),
+    OP ( NGS_ReferenceSequence_v1_vt, is_circular, rs_is_circular ),
+    OP ( NGS_ReferenceSequence_v1_vt, get_length, rs_get_length ),
+    OP ( NGS_ReferenceSequence_v1_vt, get_ref_bases, rs_get_ref_bases ),
+    OP ( NGS_ReferenceSequence_v1_vt, get_ref_chunk, rs_get_ref_chunk ),
+
+    OP ( NGS_Pileup_v1_vt, get_ref_spec, pl_get_ref_spec ),
+    OP ( NGS_Pileup_v1_vt, get_ref_pos, pl_get_ref_pos ),
+    OP ( NGS_Pileup_v1_vt, get_ref_base, pl_get_ref_base ),
+    OP ( NGS_Pileup_v1_vt, get_pileup_depth, pl_get_pileup_depth ),
+    OP ( NGS_Pileup_v1_vt, next, pl_next ),
+    OP ( NGS_Pileup_v1_vt, get_column, pl_get_column ),
+    OP ( NGS_Pileup_v1_vt, get_base_counts, pl_get_base_counts ),
+    OP ( NGS_Pileup_v1_vt, extend_to, pl_extend_to ),
+
+    OP ( NGS_PileupEvent_v1_vt, get_map_qual, pe_get_map_qual ),
+    OP ( NGS_PileupEvent_v1_vt, get_align_id, pe_get_align_id ),
+    OP ( NGS_PileupEvent_v1_vt, get_align_pos, pe_get_align_pos ),
+    OP ( NGS_PileupEvent_v1_vt, get_first_align_pos, pe_get_first_align_pos ),
+    OP ( NGS_PileupEvent_v1_vt, get_last_align_pos, pe_get_last_align_pos ),
+    OP ( NGS_PileupEvent_v1_vt, get_event_type, pe_get_event_type ),
+    OP ( NGS_PileupEvent_v1_vt, get_align_base, pe_get_align_base ),
+    OP ( NGS_PileupEvent_v1_vt, get_align_qual, pe_get_align_qual ),
+    OP ( NGS_PileupEvent_v1_vt, get_ins_bases, pe_get_ins_bases ),
+    OP ( NGS_PileupEvent_v1_vt, get_ins_quals, pe_get_ins_quals ),
+    OP ( NGS_PileupEvent_v1_vt, get_rpt_count, pe_get_rpt_count ),
+    OP ( NGS_PileupEvent_v1_vt, get_indel_type, pe_get_indel_type ),
+    OP ( NGS_PileupEvent_v1_vt, next, pe_next ),
+    OP ( NGS_PileupEvent_v1_vt, reset, pe_reset ),
+    OP ( NGS_PileupEvent_v1_vt, get_ref_index, pe_get_ref_index ),
+    OP ( NGS_PileupEvent_v1_vt, get_mate_ref_index, pe_get_mate_ref_index ),
+
+    OP ( NGS_Alignment_v1_vt, get_id, al_get_id ),
+    OP ( NGS_Alignment_v1_vt, get_ref_spec, al_get_ref_spec ),
+    OP ( NGS_Alignment_v1_vt, get_map_qual, al_get_map_qual ),
+    OP ( NGS_Alignment_v1_vt, get_ref_bases, al_get_ref_bases ),
+    OP ( NGS_Alignment_v1_vt, get_read_group, al_get_read_group ),
+    OP ( NGS_Alignment_v1_vt, get_read_id, al_get_read_id ),
+    OP ( NGS_Alignment_v1_vt, get_clipped_frag_bases, al_get_clipped_frag_bases ),
+    OP ( NGS_Alignment_v1_vt, get_clipped_frag_quals, al_get_clipped_frag_quals ),
+    OP ( NGS_Alignment_v1_vt, get_aligned_frag_bases, al_get_aligned_frag_bases ),
+    OP ( NGS_Alignment_v1_vt, is_primary, al_is_primary ),
+    OP ( NGS_Alignment_v1_vt, get_align_pos, al_get_align_pos ),
+    OP ( NGS_Alignment_v1_vt, get_ref_pos_projection_range, al_get_ref_pos_projection_range ),
+    OP ( NGS_Alignment_v1_vt, get_align_length, al_get_align_length ),
+    OP ( NGS_Alignment_v1_vt, get_is_reversed, al_get_is_reversed ),
+    OP ( NGS_Alignment_v1_vt, get_soft_clip, al_get_soft_clip ),
+    OP ( NGS_Alignment_v1_vt, get_template_len, al_get_template_len ),
+    OP ( NGS_Alignment_v1_vt, get_short_cigar, al_get_short_cigar ),
+    OP ( NGS_Alignment_v1_vt, get_long_cigar, al_get_long_cigar ),
+    OP ( NGS_Alignment_v1_vt, get_rna_orientation, al_get_rna_orientation ),
+    OP ( NGS_Alignment_v1_vt, has_mate, al_has_mate ),
+    OP ( NGS_Alignment_v1_vt, get_mate_id, al_get_mate_id ),
+    OP ( NGS_Alignment_v1_vt, get_mate_alignment, al_get_mate_alignment ),
+    OP ( NGS_Alignment_v1_vt, get_mate_ref_spec, al_get_mate_ref_spec ),
+    OP ( NGS_Alignment_v1_vt, get_mate_is_reversed, al_get_mate_is_reversed ),
+    OP ( NGS_Alignment_v1_vt, next, al_next ),
+    OP ( NGS_Alignment_v1_vt, next_batch, al_next_batch ),
+    OP ( NGS_Alignment_v1_vt, get_ref_spec_view, al_get_ref_spec_view ),
+    OP ( NGS_Alignment_v1_vt, get_read_id_view, al_get_read_id_view ),
+    OP ( NGS_Alignment_v1_vt, get_supported, al_get_supported ),
+    OP ( NGS_Alignment_v1_vt, get_tag, al_get_tag ),
+    OP ( NGS_Alignment_v1_vt, get_cigar_ops, al_get_cigar_ops ),
+    OP ( NGS_Alignment_v1_vt, get_core, al_get_core ),
+    OP ( NGS_Alignment_v1_vt, skip_to, al_skip_to ),
+    OP ( NGS_Alignment_v1_vt, get_cursor, al_get_cursor ),
+    OP ( NGS_Alignment_v1_vt, resume_from, al_resume_from ),
+    OP ( NGS_Alignment_v1_vt, get_ref_index, al_get_ref_index ),
+    OP ( NGS_Alignment_v1_vt, get_mate_ref_index, al_get_mate_ref_index ),
+    OP ( NGS_Alignment_v1_vt, reposition, al_reposition ),
+    OP ( NGS_Alignment_v1_vt, get_batch_fields, al_get_batch_fields ),
+    OP ( NGS_Alignment_v1_vt, get_mismatches, al_get_mismatches ),
+    OP ( NGS_Alignment_v1_vt, get_read_fragment, al_get_read_fragment ),
+
+    OP ( NGS_Fragment_v1_vt, get_id, fr_get_id ),
+    OP ( NGS_Fragment_v1_vt, get_bases, fr_get_bases ),
+    OP ( NGS_Fragment_v1_vt, get_quals, fr_get_quals ),
+    OP ( NGS_Fragment_v1_vt, next, fr_next ),
+    OP ( NGS_Fragment_v1_vt, is_paired, fr_is_paired ),
+    OP ( NGS_Fragment_v1_vt, is_aligned, fr_is_aligned ),
+    OP ( NGS_Fragment_v1_vt, get_bases_view, fr_get_bases_view ),
+    OP ( NGS_Fragment_v1_vt, get_quals_view, fr_get_quals_view ),
+    OP ( NGS_Fragment_v1_vt, get_packed_bases, fr_get_packed_bases ),
+    OP ( NGS_Fragment_v1_vt, get_frag_index, fr_get_frag_index ),
+
+    OP ( NGS_Read_v1_vt, get_id, rd_get_id ),
+    OP ( NGS_Read_v1_vt, get_num_frags, rd_get_num_frags ),
+    OP ( NGS_Read_v1_vt, frag_is_aligned, rd_frag_is_aligned ),
+    OP ( NGS_Read_v1_vt, get_category, rd_get_category ),
+    OP ( NGS_Read_v1_vt, get_read_group, rd_get_read_group ),
+    OP ( NGS_Read_v1_vt, get_name, rd_get_name ),
+    OP ( NGS_Read_v1_vt, get_bases, rd_get_bases ),
+    OP ( NGS_Read_v1_vt, get_quals, rd_get_quals ),
+    OP ( NGS_Read_v1_vt, next, rd_next ),
+    OP ( NGS_Read_v1_vt, get_cursor, rd_get_cursor ),
+    OP ( NGS_Read_v1_vt, resume_from, rd_resume_from ),
+    OP ( NGS_Read_v1_vt, get_row_id, rd_get_row_id ),
+
+    OP ( NGS_ReadGroup_v1_vt, get_name, rg_get_name ),
+    OP ( NGS_ReadGroup_v1_vt, get_stats, rg_get_stats ),
+    OP ( NGS_ReadGroup_v1_vt, next, rg_next ),
+
+    OP ( NGS_Statistics_v1_vt, get_type, st_get_type ),
+    OP ( NGS_Statistics_v1_vt, as_string, st_as_string ),
+    OP ( NGS_Statistics_v1_vt, as_I64, st_as_I64 ),
+    OP ( NGS_Statistics_v1_vt, as_U64, st_as_U64 ),
+    OP ( NGS_Statistics_v1_vt, as_F64, st_as_F64 ),
+    OP ( NGS_Statistics_v1_vt, next_path, st_next_path ),
+    OP ( NGS_Statistics_v1_vt, get_entries, st_get_entries ),
+
+    OP ( NGS_Refcount_v1_vt, release, ref_release ),
+    OP ( NGS_Refcount_v1_vt, duplicate, ref_duplicate ),
+    OP ( NGS_Refcount_v1_vt, query_ext, ref_query_ext )
+#undef OP
+};
+
+static
+Op find_op ( const std :: string & name )
+{
+    for ( size_t i = 0; i < sizeof op_names / sizeof op_names [ 0 ]; ++ i )
+    {
+        if ( name == op_names [ i ] . name )
+            return op_names [ i ] . op;
+    }
+    return op_unknown;
+}
+
+/*--------------------------------------------------------------------------
+ * Replay
+ */
+class Replay
+{
+public:
+
+    Replay ( const std :: vector < std :: string > & _specs, const std :: string & _options )
+        : specs ( _specs )
+        , options ( _options )
+        , opened ( 0 )
+        , calls ( 0 )
+        , skipped ( 0 )
+        , errors ( 0 )
+        , recorded_first ( 0 )
+        , recorded_last ( 0 )
+        , replayed ( 0 )
+    {
+    }
+
+    ~ Replay ()
+    {
+        for ( std :: map < uint64_t, Object > :: iterator it = objects . begin (); it != objects . end (); ++ it )
+        {
+            for ( size_t i = 0; i < it -> second . refs . size (); ++ i )
+                Release ( it -> second . refs [ i ] );
+        }
+    }
+
+    void Run ( const char * path )
+    {
+        Trace trace ( path );
+        Call c;
+
+        for ( int tag = trace . Next (); tag != EOF; tag = trace . Next () )
+        {
+            switch ( tag )
+            {
+            case 'M':
+            {
+                size_t slot = ( size_t ) trace . Varint ();
+                if ( slot >= methods . size () )
+                    methods . resize ( slot + 1 );
+                methods [ slot ] . name = trace . String ();
+                methods [ slot ] . op = find_op ( methods [ slot ] . name );
+                break;
+            }
+            case 'O':
+            {
+                uint64_t id = trace . Varint ();
+                size_t slot = ( size_t ) trace . Varint ();
+                if ( slot < methods . size () && methods [ slot ] . name . compare ( 0, 25, "NGS_ReadCollection_v1_vt:" ) == 0 )
+                    Open ( id );
+                break;
+            }
+            case 'C':
+                trace . ReadCall ( c );
+                Play ( c );
+                break;
+            default:
+                throw std :: runtime_error ( "the trace is corrupt" );
+            }
+        }
+    }
+
+    void Report ( const char * path ) const
+    {
+        for ( size_t i = 0; i < methods . size (); ++ i )
+        {
+            const Method & m = methods [ i ];
+            if ( m . calls == 0 && m . skipped == 0 )
+                continue;
+
+            char text [ 256 ];
+            snprintf ( text, sizeof text,
+                       ",\"calls\":%lu,\"skipped\":%lu,\"errors\":%lu"
+                       ",\"recorded_ns_per_call\":%.1f,\"replayed_ns_per_call\":%.1f}",
+                       ( unsigned long ) m . calls, ( unsigned long ) m . skipped, ( unsigned long ) m . errors,
+                       m . calls > 0 ? ( double ) m . recorded / m . calls : 0.0,
+                       m . calls > 0 ? ( double ) m . replayed / m . calls : 0.0 );
+            std :: cout << "{\"bench\":\"replay." << m . name << "\"" << text << std :: endl;
+        }
+
+        char text [ 256 ];
+        snprintf ( text, sizeof text,
+                   ",\"calls\":%lu,\"skipped\":%lu,\"errors\":%lu"
+                   ",\"recorded_seconds\":%.6f,\"replayed_seconds\":%.6f}",
+                   ( unsigned long ) calls, ( unsigned long ) skipped, ( unsigned long ) errors,
+                   ( double ) ( recorded_last - recorded_first ) / 1e9, ( double ) replayed / 1e9 );
+        std :: cout << "{\"bench\":\"replay\",\"trace\":\"" << path << "\"" << text << std :: endl;
+    }
+
+private:
+
+    struct Method
+    {
+        std :: string name;
+        Op op;
+        uint64_t calls;
+        uint64_t skipped;
+        uint64_t errors;
+        uint64_t recorded;
+        uint64_t replayed;
+
+        Method ()
+            : op ( op_unknown ), calls ( 0 ), skipped ( 0 ), errors ( 0 ), recorded ( 0 ), replayed ( 0 )
+        {
+        }
+    };
+
+    /* the references to an object of the trace that the replay holds,
+       the last of them the one to call */
+    struct Object
+    {
+        std :: vector < void * > refs;
+    };
+
+    static void Release ( void * obj )
+    {
+        static_cast < OpaqueRefcount * > ( obj ) -> Release ();
+    }
+
+    static void Drop ( StringItf * s )
+    {
+        if ( s != 0 )
+        {
+            sink += s -> size ();
+            s -> Release ();
+        }
+    }
+
+    void Open ( uint64_t id )
+    {
+        const std :: string & spec = specs [ opened < specs . size () ? opened : specs . size () - 1 ];
+        ++ opened;
+
+        uint64_t start = now_ns ();
+        Opened rc ( open ( spec, options ) );
+        objects [ id ] . refs . push_back ( rc . Itf () );
+        replayed += now_ns () - start;
+    }
+
+    void Play ( const Call & c )
+    {
+        if ( recorded_first == 0 )
+            recorded_first = c . start;
+        if ( c . start + c . duration > recorded_last )
+            recorded_last = c . start + c . duration;
+
+        if ( c . method >= methods . size () )
+            throw std :: runtime_error ( "the trace is corrupt" );
+        Method & m = methods [ c . method ];
+
+        std :: map < uint64_t, Object > :: iterator it = objects . find ( c . object );
+        if ( m . op == op_unknown || it == objects . end () )
+        {
+            ++ m . skipped;
+            ++ skipped;
+            return;
+        }
+        void * self = it -> second . refs . back ();
+
+        void * result = 0;
+        uint64_t start = now_ns ();
+        try
+        {
+            result = Dispatch ( m . op, self, c );
+        }
+        catch ( std :: exception & )
+        {
+            ++ m . errors;
+            ++ errors;
+        }
+        uint64_t elapsed = now_ns () - start;
+
+        ++ m . calls;
+        ++ calls;
+        m . recorded += c . duration;
+        m . replayed += elapsed;
+        replayed += elapsed;
+
+        if ( m . op == ref_release )
+        {
+            it -> second . refs . pop_back ();
+            if ( it -> second . refs . empty () )
+                objects . erase ( it );
+        }
+        else if ( result != 0 )
+        {
+            if ( c . result != 0 )
+                objects [ c . result ] . refs . push_back ( result );
+            else
+                Release ( result );
+        }
+    }
+
+    /* makes the call, returning the object it returned, if any */
+    void * Dispatch ( Op op, void * self, const Call & c )
+    {
+        ReadCollectionItf * rc = static_cast < ReadCollectionItf * > ( self );
+        ReferenceItf * rf = static_cast < ReferenceItf * > ( self );
+        ReferenceSequenceItf * rs = static_cast < ReferenceSequenceItf * > ( self );
+        PileupItf * pl = static_cast < PileupItf * > ( self );
+        PileupEventItf * pe = static_cast < PileupEventItf * > ( self );
+        AlignmentItf * al = static_cast < AlignmentItf * > ( self );
+        FragmentItf * fr = static_cast < FragmentItf * > ( self );
+        ReadItf * rd = static_cast < ReadItf * > ( self );
+        ReadGroupItf * rg = static_cast < ReadGroupItf * > ( self );
+        StatisticsItf * st = static_cast < StatisticsItf * > ( self );
+
+        switch ( op )
+        {
+        case rc_get_name: Drop ( rc -> getName () ); break;
+        case rc_get_read_groups: return rc -> getReadGroups ();
+        case rc_has_read_group: sink += rc -> hasReadGroup ( c . S ( 0 ) ); break;
+        case rc_get_read_group: return rc -> getReadGroup ( c . S ( 0 ) );
+        case rc_get_references: return rc -> getReferences ();
+        case rc_has_reference: sink += rc -> hasReference ( c . S ( 0 ) ); break;
+        case rc_get_reference: return rc -> getReference ( c . S ( 0 ) );
+        case rc_get_alignment: return rc -> getAlignment ( c . S ( 0 ) );
+        case rc_get_alignments: return rc -> getAlignments ( c . I ( 0 ) );
+        case rc_get_align_count: sink += rc -> getAlignmentCount ( c . I ( 0 ) ); break;
+        case rc_get_align_range: return rc -> getAlignmentRange ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rc_get_align_shard: return rc -> getAlignmentShard ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rc_get_read: return rc -> getRead ( c . S ( 0 ) );
+        case rc_get_reads: return rc -> getReads ( c . I ( 0 ) );
+        case rc_get_read_count: sink += rc -> getReadCount ( c . I ( 0 ) ); break;
+        case rc_get_read_range:
+            if ( c . args . size () < 3 )
+                return rc -> getReadRange ( c . I ( 0 ), c . I ( 1 ) );
+            return rc -> getReadRange ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rc_get_features: sink += rc -> getFeatures (); break;
+        case rc_get_statistics: return rc -> getStatistics ();
+        case rc_get_reference_table:
+        {
+            NGS_ReferenceTable_v1 & table = scratch . Table ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+            sink += rc -> getReferenceTable ( table );
+            break;
+        }
+
+        case rf_get_cmn_name: Drop ( rf -> getCommonName () ); break;
+        case rf_get_canon_name: Drop ( rf -> getCanonicalName () ); break;
+        case rf_is_circular: sink += rf -> getIsCircular (); break;
+        case rf_get_length: sink += rf -> getLength (); break;
+        case rf_get_ref_bases: Drop ( rf -> getReferenceBases ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case rf_get_ref_chunk: Drop ( rf -> getReferenceChunk ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case rf_get_align_count: sink += rf -> getAlignmentCount ( c . I ( 0 ) ); break;
+        case rf_get_alignment: return rf -> getAlignment ( c . S ( 0 ) );
+        case rf_get_alignments: return rf -> getAlignments ( c . I ( 0 ) );
+        case rf_get_align_slice: return rf -> getAlignmentSlice ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rf_get_filtered_align_slice:
+            return rf -> getFilteredAlignmentSlice ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ), c . I ( 3 ), c . I ( 4 ) );
+        case rf_get_align_shard: return rf -> getAlignmentShard ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rf_get_pileups: return rf -> getPileups ( c . I ( 0 ) );
+        case rf_get_filtered_pileups: return rf -> getFilteredPileups ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rf_get_pileup_slice: return rf -> getPileupSlice ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) );
+        case rf_get_filtered_pileup_slice:
+            return rf -> getFilteredPileupSlice ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ), c . I ( 3 ), c . I ( 4 ) );
+        case rf_get_sampled_pileup_slice:
+            return rf -> getFilteredPileupSlice ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ), c . I ( 3 ), c . I ( 4 ),
+                                                  c . I ( 5 ), c . I ( 6 ), c . I ( 7 ) != 0 );
+        case rf_next: sink += rf -> nextReference (); break;
+        case rf_get_features: sink += rf -> getFeatures (); break;
+        case rf_get_coverage:
+            rf -> getCoverage ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ), c . I ( 3 ), c . I ( 4 ),
+                                scratch . Words ( c . I ( 1 ) ) );
+            break;
+        case rf_copy_ref_bases:
+            sink += rf -> copyReferenceBases ( c . I ( 0 ), ( char * ) scratch . Bytes ( c . I ( 1 ) ), c . I ( 1 ) );
+            break;
+        case rf_get_packed_ref_bases:
+        {
+            uint64_t length = c . I ( 1 );
+            uint8_t * bases = scratch . Bytes ( length / 4 + length / 8 + 2 );
+            sink += rf -> getReferenceBasesPacked ( c . I ( 0 ), length, bases, bases + length / 4 + 1 );
+            break;
+        }
+        case rf_estimate_slice:
+        {
+            uint64_t alignments = 0, bytes = 0;
+            rf -> estimateSlice ( c . I ( 0 ), c . I ( 1 ), alignments, bytes );
+            sink += alignments + bytes;
+            break;
+        }
+
+        case rs_get_canon_name: Drop ( rs -> getCanonicalName () ); break;
+        case rs_is_circular: sink += rs -> getIsCircular (); break;
+        case rs_get_length: sink += rs -> getLength (); break;
+        case rs_get_ref_bases: Drop ( rs -> getReferenceBases ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case rs_get_ref_chunk: Drop ( rs -> getReferenceChunk ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+
+        case pl_get_ref_spec: Drop ( pl -> getReferenceSpec () ); break;
+        case pl_get_ref_pos: sink += pl -> getReferencePosition (); break;
+        case pl_get_ref_base: sink += pl -> getReferenceBase (); break;
+        case pl_get_pileup_depth: sink += pl -> getPileupDepth (); break;
+        case pl_next: sink += pl -> nextPileup (); break;
+        case pl_get_column:
+            sink += pl -> getColumn ( scratch . Column ( c . I ( 0 ), c . I ( 1 ), c . I ( 2 ) ) );
+            break;
+        case pl_get_base_counts:
+        {
+            uint32_t count = ( uint32_t ) c . I ( 1 );
+            NGS_PileupBaseCounts_v1 * counts = ( NGS_PileupBaseCounts_v1 * ) scratch . Bytes ( ( size_t ) count * sizeof * counts );
+            sink += pl -> getBaseCounts ( c . I ( 0 ), count, counts );
+            break;
+        }
+        case pl_extend_to: pl -> extendTo ( c . I ( 0 ) ); break;
+
+        case pe_get_map_qual: sink += pe -> getMappingQuality (); break;
+        case pe_get_align_id: Drop ( pe -> getAlignmentId () ); break;
+        case pe_get_align_pos: sink += pe -> getAlignmentPosition (); break;
+        case pe_get_first_align_pos: sink += pe -> getFirstAlignmentPosition (); break;
+        case pe_get_last_align_pos: sink += pe -> getLastAlignmentPosition (); break;
+        case pe_get_event_type: sink += pe -> getEventType (); break;
+        case pe_get_align_base: sink += pe -> getAlignmentBase (); break;
+        case pe_get_align_qual: sink += pe -> getAlignmentQuality (); break;
+        case pe_get_ins_bases: Drop ( pe -> getInsertionBases () ); break;
+        case pe_get_ins_quals: Drop ( pe -> getInsertionQualities () ); break;
+        case pe_get_rpt_count: sink += pe -> getEventRepeatCount (); break;
+        case pe_get_indel_type: sink += pe -> getEventIndelType (); break;
+        case pe_next: sink += pe -> nextPileupEvent (); break;
+        case pe_reset: pe -> resetPileupEvent (); break;
+        case pe_get_ref_index: sink += pe -> getReferenceIndex (); break;
+        case pe_get_mate_ref_index: sink += pe -> getMateReferenceIndex (); break;
+
+        case al_get_id: Drop ( al -> getAlignmentId () ); break;
+        case al_get_ref_spec: Drop ( al -> getReferenceSpec () ); break;
+        case al_get_map_qual: sink += al -> getMappingQuality (); break;
+        case al_get_ref_bases: Drop ( al -> getReferenceBases () ); break;
+        case al_get_read_group: Drop ( al -> getReadGroup () ); break;
+        case al_get_read_id: Drop ( al -> getReadId () ); break;
+        case al_get_clipped_frag_bases: Drop ( al -> getClippedFragmentBases () ); break;
+        case al_get_clipped_frag_quals: Drop ( al -> getClippedFragmentQualities () ); break;
+        case al_get_aligned_frag_bases: Drop ( al -> getAlignedFragmentBases () ); break;
+        case al_is_primary: sink += al -> getAlignmentCategory (); break;
+        case al_get_align_pos: sink += al -> getAlignmentPosition (); break;
+        case al_get_ref_pos_projection_range: sink += al -> getReferencePositionProjectionRange ( c . I ( 0 ) ); break;
+        case al_get_align_length: sink += al -> getAlignmentLength (); break;
+        case al_get_is_reversed: sink += al -> getIsReversedOrientation (); break;
+        case al_get_soft_clip: sink += al -> getSoftClip ( c . I ( 0 ) ); break;
+        case al_get_template_len: sink += al -> getTemplateLength (); break;
+        case al_get_short_cigar: Drop ( al -> getShortCigar ( c . I ( 0 ) != 0 ) ); break;
+        case al_get_long_cigar: Drop ( al -> getLongCigar ( c . I ( 0 ) != 0 ) ); break;
+        case al_get_rna_orientation: sink += al -> getRNAOrientation (); break;
+        case al_has_mate: sink += al -> hasMate (); break;
+        case al_get_mate_id: Drop ( al -> getMateAlignmentId () ); break;
+        case al_get_mate_alignment: return al -> getMateAlignment ();
+        case al_get_mate_ref_spec: Drop ( al -> getMateReferenceSpec () ); break;
+        case al_get_mate_is_reversed: sink += al -> getMateIsReversedOrientation (); break;
+        case al_next: sink += al -> nextAlignment (); break;
+        case al_next_batch:
+        {
+            NGS_AlignmentBatch_v1 & batch = scratch . Batch ( c . object, c . I ( 0 ), c . I ( 1 ), c . I ( 2 ), c . I ( 3 ) );
+            sink += al -> nextAlignmentBatch ( batch );
+            break;
+        }
+        case al_get_ref_spec_view:
+        {
+            NGS_StringView_v1 view;
+            Drop ( al -> getReferenceSpecView ( view ) );
+            sink += view . size;
+            break;
+        }
+        case al_get_read_id_view:
+        {
+            NGS_StringView_v1 view;
+            Drop ( al -> getReadIdView ( view ) );
+            sink += view . size;
+            break;
+        }
+        case al_get_supported: sink += al -> getSupportedMessages (); break;
+        case al_get_tag:
+        {
+            NGS_AlignmentTag_v1 value;
+            sink += al -> getTag ( c . S ( 0 ), value );
+            break;
+        }
+        case al_get_cigar_ops:
+        {
+            NGS_AlignmentCigar_v1 cigar;
+            sink += al -> getCigarOps ( cigar );
+            break;
+        }
+        case al_get_core:
+        {
+            NGS_AlignmentCore_v1 core;
+            al -> getCore ( core );
+            sink += core . position;
+            break;
+        }
+        case al_skip_to: sink += al -> skipTo ( c . I ( 0 ) ); break;
+        case al_get_cursor: Drop ( al -> getCursor () ); break;
+        case al_resume_from: al -> resumeFrom ( c . S ( 0 ) ); break;
+        case al_get_ref_index: sink += al -> getReferenceIndex (); break;
+        case al_get_mate_ref_index: sink += al -> getMateReferenceIndex (); break;
+        case al_reposition: al -> reposition ( c . I ( 0 ), c . I ( 1 ) ); break;
+        case al_get_batch_fields: sink += al -> getBatchFields (); break;
+        case al_get_mismatches:
+        {
+            NGS_AlignmentMismatches_v1 mismatches;
+            memset ( & mismatches, 0, sizeof mismatches );
+            mismatches . mask_size = ( uint32_t ) c . I ( 0 );
+            mismatches . mask = scratch . Bytes ( mismatches . mask_size );
+            sink += al -> getMismatches ( mismatches );
+            break;
+        }
+        case al_get_read_fragment:
+        {
+            NGS_AlignmentReadFragment_v1 fragment;
+            memset ( & fragment, 0, sizeof fragment );
+            fragment . size = ( uint32_t ) c . I ( 0 );
+            fragment . bases = ( char * ) scratch . Bytes ( 2 * ( size_t ) fragment . size );
+            fragment . quals = fragment . bases + fragment . size;
+            sink += al -> getReadFragment ( fragment );
+            break;
+        }
+
+        case fr_get_id: Drop ( fr -> getFragmentId () ); break;
+        case fr_get_bases: Drop ( fr -> getFragmentBases ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case fr_get_quals: Drop ( fr -> getFragmentQualities ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case fr_next: sink += fr -> nextFragment (); break;
+        case fr_is_paired: sink += fr -> isPaired (); break;
+        case fr_is_aligned: sink += fr -> isAligned (); break;
+        case fr_get_bases_view:
+        {
+            NGS_StringView_v1 view;
+            Drop ( fr -> getFragmentBasesView ( c . I ( 0 ), c . I ( 1 ), view ) );
+            sink += view . size;
+            break;
+        }
+        case fr_get_quals_view:
+        {
+            NGS_StringView_v1 view;
+            Drop ( fr -> getFragmentQualitiesView ( c . I ( 0 ), c . I ( 1 ), view ) );
+            sink += view . size;
+            break;
+        }
+        case fr_get_packed_bases:
+        {
+            NGS_FragmentPackedBases_v1 packed;
+            sink += fr -> getFragmentBasesPacked ( c . I ( 0 ), c . I ( 1 ), packed );
+            break;
+        }
+        case fr_get_frag_index: sink += fr -> getFragmentIndex (); break;
+
+        case rd_get_id: Drop ( rd -> getReadId () ); break;
+        case rd_get_num_frags: sink += rd -> getNumFragments (); break;
+        case rd_frag_is_aligned: sink += rd -> fragmentIsAligned ( c . I ( 0 ) ); break;
+        case rd_get_category: sink += rd -> getReadCategory (); break;
+        case rd_get_read_group: Drop ( rd -> getReadGroup () ); break;
+        case rd_get_name: Drop ( rd -> getReadName () ); break;
+        case rd_get_bases: Drop ( rd -> getReadBases ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case rd_get_quals: Drop ( rd -> getReadQualities ( c . I ( 0 ), c . I ( 1 ) ) ); break;
+        case rd_next: sink += rd -> nextRead (); break;
+        case rd_get_cursor: Drop ( rd -> getCursor () ); break;
+        case rd_resume_from: rd -> resumeFrom ( c . S ( 0 ) ); break;
+        case rd_get_row_id: sink += rd -> getReadRowId (); break;
+
+        case rg_get_name: Drop ( rg -> getName () ); break;
+        case rg_get_stats: return rg -> getStatistics ();
+        case rg_next: sink += rg -> nextReadGroup (); break;
+
+        case st_get_type: sink += st -> getValueType ( c . S ( 0 ) ); break;
+        case st_as_string: Drop ( st -> getAsString ( c . S ( 0 ) ) ); break;
+        case st_as_I64: sink += st -> getAsI64 ( c . S ( 0 ) ); break;
+        case st_as_U64: sink += st -> getAsU64 ( c . S ( 0 ) ); break;
+        case st_as_F64: sink += ( uint64_t ) st -> getAsDouble ( c . S ( 0 ) ); break;
+        case st_next_path: Drop ( st -> nextPath ( c . S ( 0 ) ) ); break;
+        case st_get_entries:
+        {
+            const NGS_StatisticsEntry_v1 * entries = 0;
+            uint64_t count = 0;
+            sink += st -> getEntries ( entries, count );
+            break;
+        }
+
+        case ref_release: Release ( self ); break;
+        case ref_duplicate: return static_cast < OpaqueRefcount * > ( self ) -> Duplicate ();
+        case ref_query_ext: sink += static_cast < OpaqueRefcount * > ( self ) -> QueryExtension ( c . S ( 0 ) ) != 0; break;
+
+        case op_unknown: break;
+        }
+        return 0;
+    }
+
+    /* the buffers of the calls that fill them in, as large as the job's were */
+    class Scratch
+    {
+    public:
+
+        uint8_t * Bytes ( size_t size )
+        {
+            if ( bytes . size () < size )
+                bytes . resize ( size );
+            return bytes . empty () ? 0 : & bytes [ 0 ];
+        }
+
+        uint32_t * Words ( size_t count )
+        {
+            if ( words . size () < count )
+                words . resize ( count );
+            return words . empty () ? 0 : & words [ 0 ];
+        }
+
+        NGS_ReferenceTable_v1 & Table ( uint32_t fields, uint32_t capacity, uint32_t arena_size )
+        {
+            memset ( & table, 0, sizeof table );
+            table . fields = fields;
+            table . capacity = capacity;
+            table . common_name = Strings ( 0, capacity );
+            table . canonical_name = Strings ( capacity, capacity );
+            table . length = Longs ( 0, capacity );
+            table . circular = Bytes ( capacity );
+            table . arena = Arena ( arena_size );
+            table . arena_size = arena_size;
+            return table;
+        }
+
+        NGS_PileupColumn_v1 & Column ( uint32_t fields, uint32_t capacity, uint32_t arena_size )
+        {
+            memset ( & column, 0, sizeof column );
+            column . fields = fields;
+            column . capacity = capacity;
+            uint32_t * words = Words ( 2 * ( size_t ) capacity );
+            column . event_type = words;
+            column . map_qual = ( int32_t * ) words + capacity;
+            column . base = ( char * ) Bytes ( 2 * ( size_t ) capacity );
+            column . qual = column . base + capacity;
+            column . ins_bases = ( NGS_PileupColumnString_v1 * ) Strings ( 0, capacity );
+            column . ins_quals = ( NGS_PileupColumnString_v1 * ) Strings ( capacity, capacity );
+            column . arena = Arena ( arena_size );
+            column . arena_size = arena_size;
+            return column;
+        }
+
+        /* a batch keeps its state from one call to the next, one per iterator */
+        NGS_AlignmentBatch_v1 & Batch ( uint64_t iterator, uint32_t fields, uint32_t capacity,
+                                         uint32_t arena_size, uint32_t cigar_arena_size )
+        {
+            NGS_AlignmentBatch_v1 & batch = batches [ iterator ];
+            uint32_t state = batch . capacity == 0 ? ( uint32_t ) NGS_AlignmentBatchState_next : batch . state;
+
+            memset ( & batch, 0, sizeof batch );
+            batch . fields = fields;
+            batch . capacity = capacity;
+            batch . position = ( int64_t * ) Longs ( 0, capacity );
+            batch . length = Longs ( capacity, capacity );
+            uint32_t * words = Words ( 3 * ( size_t ) capacity );
+            batch . map_qual = ( int32_t * ) words;
+            batch . flags = words + capacity;
+            batch . ref_index = ( int32_t * ) words + 2 * capacity;
+            batch . ref_spec = ( NGS_AlignmentBatchString_v1 * ) Strings ( 0, capacity );
+            batch . read_id = ( NGS_AlignmentBatchString_v1 * ) Strings ( capacity, capacity );
+            batch . bases = ( NGS_AlignmentBatchString_v1 * ) Strings ( 2 * capacity, capacity );
+            batch . qualities = ( NGS_AlignmentBatchString_v1 * ) Strings ( 3 * capacity, capacity );
+            batch . cigar = ( NGS_AlignmentBatchString_v1 * ) Strings ( 4 * capacity, capacity );
+            batch . arena = Arena ( arena_size );
+            batch . arena_size = arena_size;
+            if ( cigar_arena . size () < cigar_arena_size )
+                cigar_arena . resize ( cigar_arena_size );
+            batch . cigar_arena = cigar_arena . empty () ? 0 : & cigar_arena [ 0 ];
+            batch . cigar_arena_size = cigar_arena_size;
+            batch . state = state;
+            return batch;
+        }
+
+    private:
+
+        /* pairs of 32-bit offset and size, of which every such column is made */
+        NGS_ReferenceTableString_v1 * Strings ( size_t first, size_t count )
+        {
+            if ( strings . size () < first + count )
+                strings . resize ( first + count );
+            return strings . empty () ? 0 : & strings [ first ];
+        }
+
+        uint64_t * Longs ( size_t first, size_t count )
+        {
+            if ( longs . size () < first + count )
+                longs . resize ( first + count );
+            return longs . empty () ? 0 : & longs [ first ];
+        }
+
+        char * Arena ( size_t size )
+        {
+            if ( arena . size () < size )
+                arena . resize ( size );
+            return arena . empty () ? 0 : & arena [ 0 ];
+        }
+
+        std :: vector < uint8_t > bytes;
+        std :: vector < uint32_t > words;
+        std :: vector < uint64_t > longs;
+        std :: vector < char > arena;
+        std :: vector < uint32_t > cigar_arena;
+        std :: vector < NGS_ReferenceTableString_v1 > strings;
+        std :: map < uint64_t, NGS_AlignmentBatch_v1 > batches;
+        NGS_ReferenceTable_v1 table;
+        NGS_PileupColumn_v1 column;
+    };
+
+    std :: vector < std :: string > specs;
+    std :: string options;
+    size_t opened;
+
+    std :: vector < Method > methods;
+    std :: map < uint64_t, Object > objects;
+    Scratch scratch;
+
+    uint64_t calls;
+    uint64_t skipped;
+    uint64_t errors;
+    uint64_t recorded_first;
+    uint64_t recorded_last;
+    uint64_t replayed;
+};
+
+int main ( int argc, char * argv [] )
+{
+    int arg = 1;
+    std :: string options;
+    if ( argc > 2 && strcmp ( argv [ 1 ], "-o" ) == 0 )
+    {
+        options = argv [ 2 ];
+        arg = 3;
+    }
+
+    if ( argc < arg + 2 )
+    {
+        std :: cerr << "usage: " << argv [ 0 ] << " [ -o options ] trace spec [ spec ... ]" << std :: endl;
+        return 1;
+    }
+
+    try
+    {
+        Replay replay ( std :: vector < std :: string > ( argv + arg + 1, argv + argc ), options );
+        replay . Run ( argv [ arg ] );
+        replay . Report ( argv [ arg ] );
+    }
+    catch ( std :: exception & x )
+    {
+        std :: cerr << "exception: " << x . what () << std :: endl;
+        return 1;
+    }
+    catch ( ... )
+    {
+        std :: cerr << "exception: unknown" << std :: endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,8 +1,70 @@
 #include <stdexcept>
+#include <new>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <test/test_engine/test_engine.hpp>
 #include <test/test_engine/ReadCollectionItf.hpp>
 
+#include <ngs/itf/CallStats.hpp>
+#include <ngs/itf/Trace.hpp>
+#include <ngs/itf/DirectBind.hpp>
+#include <ngs/PrefetchingAlignmentIterator.hpp>
+#include <ngs/PrefetchingReadIterator.hpp>
+#include <ngs/ProjectedAlignmentIterator.hpp>
+#include <ngs/Parallel.hpp>
+#include <ngs/Executor.hpp>
+#include <ngs/WorkPool.hpp>
+#include <ngs/MultiPileupIterator.hpp>
+#include <ngs/ReferenceReader.hpp>
+#include <ngs/ArrowExport.hpp>
+
+//////////////////////////////////// 
+
+/* every operator new is counted, so that a test can tell how many
+   objects and buffers a stretch of code made: each StringItf, iterator
+   and engine object is one, as is each growth of a string or vector */
+static uint64_t allocations = 0;
+
+#if __cplusplus >= 201103L
+#define NEW_THROWS
+#define DELETE_THROWS noexcept
+#else
+#define NEW_THROWS throw ( std :: bad_alloc )
+#define DELETE_THROWS throw ()
+#endif
+
+static
+void * counted_new ( size_t size )
+{
+#if defined __GNUC__
+    __atomic_fetch_add ( & allocations, 1, __ATOMIC_RELAXED );
+#else
+    ++ allocations;
+#endif
+    void * mem = malloc ( size != 0 ? size : 1 );
+    if ( mem == 0 )
+        throw std :: bad_alloc ();
+    return mem;
+}
+
+void * operator new ( size_t size ) NEW_THROWS { return counted_new ( size ); }
+void * operator new [] ( size_t size ) NEW_THROWS { return counted_new ( size ); }
+void operator delete ( void * mem ) DELETE_THROWS { free ( mem ); }
+void operator delete [] ( void * mem ) DELETE_THROWS { free ( mem ); }
+
+static
+uint64_t Allocations ()
+{
+#if defined __GNUC__
+    return __atomic_load_n ( & allocations, __ATOMIC_RELAXED );
+#else
+    return allocations;
+#endif
+}
+
 //////////////////////////////////// 
 
 // our little unit testing framework
@@ -86,6 +148,28 @@ TEST_BEGIN_READCOLLECTION ( ReadCollection_getAlignmentRange )
     ngs::AlignmentIterator als = rc.getAlignmentRange ( 1, 20, ngs::Alignment::all );
 TEST_END
 
+TEST_BEGIN_READCOLLECTION ( ReadCollection_getAlignmentShard )
+    ngs::AlignmentIterator als = rc.getAlignmentShard ( 2, 4, ngs::Alignment::all );
+    // 3 alignments
+    Assert ( als.nextAlignment() );
+    Assert ( als.nextAlignment() );
+    Assert ( als.nextAlignment() );
+    Assert ( ! als.nextAlignment() );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( ReadCollection_getAlignmentShard_OutOfRange )
+    bool thrown = false;
+    try
+    {
+        ngs::AlignmentIterator als = rc.getAlignmentShard ( 4, 4, ngs::Alignment::all );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
 TEST_BEGIN_READCOLLECTION ( ReadCollection_getRead )
     ngs::Read read = rc.getRead ( "read" );
 TEST_END
@@ -103,10 +187,110 @@ TEST_BEGIN_READCOLLECTION ( ReadCollection_getReadRange )
     ngs::ReadIterator read = rc.getReadRange ( 1, 25, ngs::Read::all );
 TEST_END
 
+TEST_BEGIN_READCOLLECTION ( ReadCollection_supports )
+    Assert ( rc.supports ( ngs::ReadCollection::alignmentShardFeature ) );
+    Assert ( rc.supports ( ngs::ReadCollection::readsFeature ) );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( ReadCollection_getStatistics )
+    ngs::Statistics stat = rc.getStatistics ();
+    Assert ( 144 == stat.getAsU64 ( "path" ) );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( ReadCollection_getReferenceTable )
+    ngs::ReferenceTable table = rc.getReferenceTable ();
+    // 3 references
+    Assert ( 3 == table.size () );
+    Assert ( table.has ( ngs::ReferenceTable::allFields ) );
+    Assert ( "common name" == table.getCommonName ( 2 ) );
+    Assert ( "canonical name" == table.getCanonicalName ( 0 ) );
+    Assert ( 101 == table.getLength ( 1 ) );
+    Assert ( ! table.getIsCircular ( 1 ) );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( ReadCollection_getReferenceTable_Grow )
+    ngs::ReferenceTable table ( ngs::ReferenceTable::commonName | ngs::ReferenceTable::referenceLength, 1, 4 );
+    rc.getReferenceTable ( table );
+    Assert ( 3 == table.size () );
+    Assert ( ! table.has ( ngs::ReferenceTable::canonicalName ) );
+    Assert ( "common name" == table.getCommonName ( 1 ) );
+    Assert ( 101 == table.getLengths () [ 2 ] );
+    Assert ( 0 == table.getCircular () );
+TEST_END
+
+#if NGS_HAVE_MOVE
+static uint64_t DuplicateCalls ()
+{
+    std::vector < ngs::CallStats::Entry > totals;
+    ngs::CallStats::Totals ( totals, false );
+    for ( size_t i = 0; i < totals.size (); ++ i )
+    {
+        if ( std::string ( totals [ i ] . method ) == "NGS_Refcount_v1_vt::duplicate" )
+            return totals [ i ] . calls;
+    }
+    return 0;
+}
+
+TEST_BEGIN_READCOLLECTION ( ReadCollection_Move )
+    ngs::CallStats::Enable ( true );
+    ngs::CallStats::Reset ();
+    {
+        // growing the vector moves the handles without duplicating them
+        std::vector < ngs::AlignmentIterator > its;
+        for ( int i = 0; i < 9; ++ i )
+            its.push_back ( rc.getAlignments ( ngs::Alignment::all ) );
+        Assert ( 0 == DuplicateCalls () );
+        for ( size_t i = 0; i < its.size (); ++ i )
+            Assert ( its [ i ] . nextAlignment () );
+
+        ngs::ReadCollection moved ( std::move ( rc ) );
+        Assert ( "test" == moved.getName () );
+        ngs::ReadCollection other = ngs_test_engine::NGS::openReadCollection ( "other" );
+        other = std::move ( moved );
+        Assert ( "test" == other.getName () );
+        Assert ( "other" == moved.getName () );
+        Assert ( 0 == DuplicateCalls () );
+
+        // a moved-from handle may be assigned again
+        rc = other;
+        Assert ( "test" == rc.getName () );
+
+        ngs::StringRef id = its [ 0 ] . getFragmentId ();
+        ngs::StringRef taken ( std::move ( id ) );
+        Assert ( "alignFragId" == taken.toString () );
+        ngs::StringView view ( "abc", 3 );
+        ngs::StringView viewTaken ( std::move ( view ) );
+        Assert ( 0 == view.size () );
+        Assert ( 3 == viewTaken.size () );
+    }
+    ngs::CallStats::Enable ( false );
+TEST_END
+#endif
+
+TEST_BEGIN ( ReadCollection_QueryExtension )
+    ngs_adapt::ReadCollectionItf * engine = new ngs_test_engine::ReadCollectionItf ( "test" );
+    ngs::ReadCollectionItf * itf = ngs::ReadCollectionItf::Cast ( engine -> Cast () );
+
+    const NGS_VTable * ext = itf -> QueryExtension ( "NGS_TestExtension_v1" );
+    Assert ( ext != 0 );
+    Assert ( std::string ( "NGS_TestExtension_v1" ) == ext -> itf_name );
+    Assert ( itf -> QueryExtension ( "NGS_NoSuchExtension_v1" ) == 0 );
+
+    // an object of the engine that has none
+    ngs_adapt::AlignmentItf * align = new ngs_test_engine::AlignmentItf ( "align" );
+    ngs::AlignmentItf * other = ngs::AlignmentItf::Cast ( align -> Cast () );
+    Assert ( other -> QueryExtension ( "NGS_TestExtension_v1" ) == 0 );
+    other -> Release ();
+
+    itf -> Release ();
+    Assert ( ngs_test_engine::ReadCollectionItf::instanceCount == 0 );
+TEST_END
+
 void TestReadCollection()
 {
     ReadCollection_CreateDestroy ();
     ReadCollection_getName ();
+    ReadCollection_QueryExtension ();
     ReadCollection_getReadGroups ();
     ReadCollection_getReadGroup ();
     ReadCollection_getReferences ();
@@ -115,10 +299,19 @@ void TestReadCollection()
     ReadCollection_getAlignments ();
     ReadCollection_getAlignmentCount ();
     ReadCollection_getAlignmentRange ();
+    ReadCollection_getAlignmentShard ();
+    ReadCollection_getAlignmentShard_OutOfRange ();
     ReadCollection_getRead ();
     ReadCollection_getReads ();
     ReadCollection_getReadCount();
     ReadCollection_getReadRange();
+    ReadCollection_supports ();
+    ReadCollection_getStatistics ();
+    ReadCollection_getReferenceTable ();
+    ReadCollection_getReferenceTable_Grow ();
+#if NGS_HAVE_MOVE
+    ReadCollection_Move ();
+#endif
 }
 
 /////////// ReadGroup
@@ -196,11 +389,55 @@ TEST_BEGIN_REFERENCE ( Reference_getReferenceChunk )
     Assert ( "AG" == chunk );
 TEST_END
 
+TEST_BEGIN_REFERENCE ( Reference_copyReferenceBases )
+    // the test engine's chunks are all "AG", copied across as they come
+    char buffer [ 128 ];
+    Assert ( 10 == refs.copyReferenceBases ( 0, buffer, 10 ) );
+    Assert ( "AGAGAGAGAG" == ngs::String ( buffer, 10 ) );
+    Assert ( 1 == refs.copyReferenceBases ( 100, buffer, 10 ) );
+    Assert ( 0 == refs.copyReferenceBases ( 101, buffer, 10 ) );
+
+    ngs::ReferenceReader reader ( refs, 1 );
+    Assert ( 64 == reader.read ( buffer, 64 ) );
+    Assert ( 65 == reader.getOffset () );
+    Assert ( 36 == reader.read ( buffer, 64 ) );
+    Assert ( 0 == reader.read ( buffer, 64 ) );
+    Assert ( 101 == reader.getOffset () );
+    reader.seek ( 99 );
+    Assert ( 2 == reader.read ( buffer, 64 ) );
+TEST_END
+
+TEST_BEGIN_REFERENCE ( Reference_getReferenceBasesPacked )
+    // packed here from the test engine's "AG" chunks: A = 0 and G = 2
+    uint8_t bases [ 32 ];
+    uint8_t nMask [ 16 ];
+    memset ( bases, 0xFF, sizeof bases );
+    memset ( nMask, 0xFF, sizeof nMask );
+    Assert ( 10 == refs.getReferenceBasesPacked ( 0, 10, bases, nMask ) );
+    Assert ( 0x88 == bases [ 0 ] && 0x88 == bases [ 1 ] && 0x08 == bases [ 2 ] && 0xFF == bases [ 3 ] );
+    Assert ( 0 == nMask [ 0 ] && 0 == nMask [ 1 ] && 0xFF == nMask [ 2 ] );
+    Assert ( 100 == refs.getReferenceBasesPacked ( 1, 128, bases ) );
+    Assert ( 0x88 == bases [ 0 ] && 0x88 == bases [ 24 ] );
+    Assert ( 0 == refs.getReferenceBasesPacked ( 101, 8, bases ) );
+TEST_END
+
 TEST_BEGIN_REFERENCE ( Reference_getAlignmentCount )
     uint64_t count = refs.getAlignmentCount ( ngs::Alignment::all );
     Assert ( 19 == count );
 TEST_END
 
+TEST_BEGIN_REFERENCE ( Reference_estimateSlice )
+    // the test engine leaves it to the dispatch layer, which scales the count of 19
+    ngs::Reference::SliceEstimate estimate = refs.estimateSlice ( 0, 101 );
+    Assert ( 19 == estimate.alignments && 0 == estimate.bytes );
+    estimate = refs.estimateSlice ( -50, 1000 );
+    Assert ( 19 == estimate.alignments );
+    estimate = refs.estimateSlice ( 0, 50 );
+    Assert ( 9 == estimate.alignments );
+    estimate = refs.estimateSlice ( 200, 10 );
+    Assert ( 0 == estimate.alignments && 0 == estimate.bytes );
+TEST_END
+
 TEST_BEGIN_REFERENCE( Reference_getAlignment )
     ngs::Alignment al = refs.getAlignment ("alignment" );
 TEST_END
@@ -213,6 +450,21 @@ TEST_BEGIN_REFERENCE( Reference_getAlignmentSlice )
     ngs::AlignmentIterator als = refs.getAlignmentSlice ( 3, 2, ngs::Alignment::all );
 TEST_END
 
+TEST_BEGIN_REFERENCE( Reference_getFilteredAlignmentSlice )
+    ngs::AlignmentIterator als = refs.getFilteredAlignmentSlice ( 3, 2, ngs::Alignment::all, ngs::Alignment::startWithinSlice, 0 );
+    Assert ( als.nextAlignment() );
+    Assert ( als.nextAlignment() );
+    Assert ( ! als.nextAlignment() );
+TEST_END
+
+TEST_BEGIN_REFERENCE( Reference_getAlignmentShard )
+    ngs::AlignmentIterator als = refs.getAlignmentShard ( 1, 3, ngs::Alignment::all );
+    // 2 alignments
+    Assert ( als.nextAlignment() );
+    Assert ( als.nextAlignment() );
+    Assert ( ! als.nextAlignment() );
+TEST_END
+
 TEST_BEGIN_REFERENCE( Reference_getPileups )
     ngs::PileupIterator pups = refs.getPileups ( ngs::Alignment::all );
 TEST_END
@@ -221,6 +473,135 @@ TEST_BEGIN_REFERENCE( Reference_getPileupSlice )
     ngs::PileupIterator pups = refs.getPileupSlice ( 2, 5, ngs::Alignment::all );
 TEST_END
 
+TEST_BEGIN_REFERENCE( Reference_getFilteredPileupSlice_Sampled )
+    // nothing sampled or skipped is the plain slice
+    ngs::PileupIterator pups = refs.getFilteredPileupSlice ( 2, 5, ngs::Alignment::all, ngs::Alignment::passFailed, 0, 0 );
+    Assert ( pups.nextPileup () );
+
+    // the test engine leaves sampling to the adapter, which can't
+    bool thrown = false;
+    try
+    {
+        refs.getFilteredPileupSlice ( 2, 5, ngs::Alignment::all, ngs::Alignment::passFailed, 0, 10, 1 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+
+    thrown = false;
+    try
+    {
+        refs.getFilteredPileupSlice ( 2, 5, ngs::Alignment::all, ngs::Alignment::passFailed, 0, 0, 0, true );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_REFERENCE( Reference_supports )
+    Assert ( refs.supports ( ngs::Reference::basesFeature ) );
+    Assert ( refs.supports ( ngs::Reference::pileupsFeature ) );
+TEST_END
+
+TEST_BEGIN_REFERENCE ( Reference_getCoverage )
+    // the window is cut at the end of the reference
+    std::vector < uint32_t > depth = refs.getCoverage ( 90, 20, ngs::Alignment::all, ngs::Alignment::passFailed, 0 );
+    Assert ( 11 == depth.size () );
+    // the test engine's CIGARs have no lengths, so cover nothing
+    for ( size_t i = 0; i < depth.size (); ++ i )
+        Assert ( 0 == depth [ i ] );
+    Assert ( refs.getCoverage ( 101, 10, ngs::Alignment::all, ngs::Alignment::passFailed, 0 ).empty () );
+
+    bool thrown = false;
+    try
+    {
+        refs.getCoverage ( -1, 10, ngs::Alignment::all, ngs::Alignment::passFailed, 0 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+// counts the alignments of each window, and the order of reduction
+class CountingSliceTask : public ngs::parallel::SliceTask
+{
+public:
+    CountingSliceTask ( size_t windows, uint64_t failAt = ( uint64_t ) -1 )
+    : counts ( windows, 0 ), failAt ( failAt ), total ( 0 ), inOrder ( true ), reduced ( 0 )
+    {
+    }
+
+    void visit ( const ngs::parallel::Window & window, ngs::AlignmentIterator & alignments )
+    {
+        if ( window . index == failAt )
+            throw ngs::ErrorMsg ( "slice task failed" );
+        while ( alignments . nextAlignment () )
+            ++ counts [ window . index ];
+    }
+
+    void reduce ( const ngs::parallel::Window & window )
+    {
+        if ( window . index != reduced )
+            inOrder = false;
+        ++ reduced;
+        total += counts [ window . index ];
+    }
+
+    std::vector < uint64_t > counts;
+    uint64_t failAt;
+    uint64_t total;
+    bool inOrder;
+    uint64_t reduced;
+};
+
+TEST_BEGIN_READCOLLECTION ( Parallel_forEachSlice )
+    // 3 references of 101 bases, in windows of 10; the test engine
+    // returns as many alignments for a slice as it is long
+    for ( uint32_t threads = 0; threads <= 8; threads += 4 )
+    {
+        CountingSliceTask task ( 33 );
+        ngs::parallel::forEachSlice ( rc, 10, threads, task );
+        Assert ( 33 == task . reduced );
+        Assert ( task . inOrder );
+        Assert ( 303 == task . total );
+        Assert ( 1 == task . counts [ 10 ] );
+    }
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Parallel_forEachSlice_Error )
+    CountingSliceTask task ( 33, 5 );
+    bool thrown = false;
+    try
+    {
+        ngs::parallel::forEachSlice ( rc, 10, 4, task );
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        thrown = std::string ( "slice task failed" ) == x . what ();
+    }
+    Assert ( thrown );
+    // nothing is reduced past the window that failed
+    Assert ( task . reduced <= 5 );
+    Assert ( task . inOrder );
+
+    thrown = false;
+    try
+    {
+        ngs::parallel::forEachSlice ( rc, 0, 4, task );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
 void TestReference()
 {
     Reference_Iteration ();
@@ -231,11 +612,22 @@ void TestReference()
     Reference_getLength ();
     Reference_getReferenceBases ();
     Reference_getReferenceChunk ();
+    Reference_copyReferenceBases ();
+    Reference_getReferenceBasesPacked ();
+    Reference_getAlignmentCount ();
+    Reference_estimateSlice ();
     Reference_getAlignment ();
     Reference_getAlignments ();
     Reference_getAlignmentSlice ();
+    Reference_getFilteredAlignmentSlice ();
+    Reference_getAlignmentShard ();
     Reference_getPileups();
     Reference_getPileupSlice();
+    Reference_getFilteredPileupSlice_Sampled ();
+    Reference_supports ();
+    Reference_getCoverage ();
+    Parallel_forEachSlice ();
+    Parallel_forEachSlice_Error ();
 }
 
 /////////// Read
@@ -291,6 +683,22 @@ TEST_BEGIN_READ( Read_getFragmentQualitiesOffsetLength )
     Assert ( "bd" == quals );
 TEST_END
 
+TEST_BEGIN_READCOLLECTION ( Read_Cursor )
+    ngs::ReadIterator it = rc.getReads( ngs::Read::all );
+    // 6 reads
+    Assert ( it.nextRead() );
+    Assert ( it.nextRead() );
+    ngs::String cursor = it.getCursor ();
+
+    ngs::ReadIterator resumed = rc.getReads( ngs::Read::all );
+    resumed.resumeFrom ( cursor );
+    Assert ( resumed.nextRead() );
+    Assert ( resumed.nextRead() );
+    Assert ( resumed.nextRead() );
+    Assert ( resumed.nextRead() );
+    Assert ( ! resumed.nextRead() );
+TEST_END
+
 TEST_BEGIN_READ( Read_IterationFragments )
     // 2 fragments
     Assert ( read.nextFragment() );
@@ -303,6 +711,27 @@ TEST_BEGIN_READ( Read_getReadId )
     Assert ( "readId" == id );
 TEST_END
 
+TEST_BEGIN_READ( Read_getFragmentIndex )
+    Assert ( read.nextFragment() );
+    Assert ( 0 == read.getFragmentIndex() );
+    Assert ( read.nextFragment() );
+    Assert ( 1 == read.getFragmentIndex() );
+TEST_END
+
+TEST_BEGIN_READ( Read_getReadRowId_NotNumeric )
+    // "readId" does not end in a number
+    bool thrown = false;
+    try
+    {
+        read.getReadRowId();
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
 TEST_BEGIN_READ( Read_getNumFragments )
     uint32_t count = read.getNumFragments();
     Assert ( 2 == count );
@@ -353,9 +782,47 @@ TEST_BEGIN_READ( Read_getReadQualitiesOffsetLength )
     Assert ( "rs" == quals );
 TEST_END
 
+TEST_BEGIN_READCOLLECTION ( Read_Prefetching )
+    ngs::ReadIterator it = rc.getReads ( ngs::Read::all );
+    // 6 reads, in batches of 4 through a ring of 2
+    ngs::PrefetchingReadIterator pf ( it, ngs::PrefetchingReadIterator::allFields, 2, 4 );
+    unsigned count = 0;
+    while ( pf.nextRead () )
+    {
+        ++ count;
+        Assert ( "readId" == pf.getReadId () );
+        Assert ( "readName" == pf.getReadName () );
+        Assert ( "readGroup" == pf.getReadGroup () );
+        Assert ( "TGCA" == pf.getReadBases () );
+        Assert ( "qrst" == pf.getReadQualities () );
+        Assert ( 2 == pf.getNumFragments () );
+        Assert ( ngs::Read::partiallyAligned == pf.getReadCategory () );
+    }
+    Assert ( 6 == count );
+    Assert ( ! pf.nextRead () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Read_Prefetching_Fields )
+    ngs::ReadIterator it = rc.getReads ( ngs::Read::all );
+    ngs::PrefetchingReadIterator pf ( it, ngs::PrefetchingReadIterator::readId );
+    Assert ( pf.nextRead () );
+    Assert ( "readId" == pf.getReadId () );
+    bool thrown = false;
+    try
+    {
+        pf.getReadName ();
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
 void TestRead ()
 {
     Read_Iteration ();
+    Read_Cursor ();
 
     Read_getFragmentId ();
     Read_getFragmentBases ();
@@ -368,6 +835,8 @@ void TestRead ()
     Read_IterationFragments ();
     
     Read_getReadId ();
+    Read_getFragmentIndex ();
+    Read_getReadRowId_NotNumeric ();
     Read_getNumFragments ();
     Read_getReadCategory ();
     Read_getReadGroup ();
@@ -378,6 +847,9 @@ void TestRead ()
     Read_getReadQualities();
     Read_getReadQualitiesOffset ();
     Read_getReadQualitiesOffsetLength ();
+
+    Read_Prefetching ();
+    Read_Prefetching_Fields ();
 }
 
 /////////// Alignment
@@ -392,6 +864,245 @@ TEST_BEGIN_READCOLLECTION ( Alignment_Iteration )
     Assert ( ! it.nextAlignment() );
 TEST_END
 
+TEST_BEGIN_READCOLLECTION ( Alignment_skipTo )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // 4 alignments, each at 123 for 321
+    Assert ( it.skipTo ( 443 ) );
+    Assert ( 123 == it.getAlignmentPosition () );
+    Assert ( it.nextAlignment() );
+    Assert ( ! it.skipTo ( 444 ) );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_Cursor )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // 4 alignments
+    Assert ( it.nextAlignment() );
+    ngs::String cursor = it.getCursor ();
+
+    ngs::AlignmentIterator resumed = rc.getAlignments ( ngs::Alignment::all );
+    resumed.resumeFrom ( cursor );
+    Assert ( resumed.nextAlignment() );
+    Assert ( resumed.nextAlignment() );
+    Assert ( resumed.nextAlignment() );
+    Assert ( ! resumed.nextAlignment() );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_nextAlignmentBatch )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::AlignmentBatch batch;
+    Assert ( it.nextAlignmentBatch ( batch ) );
+    Assert ( 4 == batch . size () );
+    Assert ( 123 == batch . getAlignmentPosition ( 3 ) );
+    Assert ( 321 == batch . getAlignmentLength ( 3 ) );
+    Assert ( 90 == batch . getMappingQuality ( 3 ) );
+    Assert ( ngs::Alignment::secondaryAlignment == batch . getAlignmentCategory ( 3 ) );
+    Assert ( batch . getIsReversedOrientation ( 3 ) );
+    Assert ( batch . hasMate ( 3 ) );
+    Assert ( "referenceSpec" == batch . getReferenceSpec ( 3 ) );
+    Assert ( "alignReadId" == batch . getReadId ( 3 ) );
+    Assert ( "AGCT" == batch . getFragmentBases ( 3 ) );
+    Assert ( "bbd^" == batch . getFragmentQualities ( 3 ) );
+    Assert ( ! it.nextAlignmentBatch ( batch ) );
+    Assert ( 0 == batch . size () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_nextAlignmentBatch_Arena )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // the strings of each alignment take 32 bytes: 2 per batch
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::allFields, 3, 64 );
+    Assert ( it.nextAlignmentBatch ( batch ) );
+    Assert ( 2 == batch . size () );
+    Assert ( it.nextAlignmentBatch ( batch ) );
+    Assert ( 2 == batch . size () );
+    Assert ( "bbd^" == batch . getFragmentQualities ( 1 ) );
+    Assert ( ! it.nextAlignmentBatch ( batch ) );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_nextAlignmentBatch_ArenaTooSmall )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::allFields, 4, 16 );
+    bool thrown = false;
+    try
+    {
+        it.nextAlignmentBatch ( batch );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_fill )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::alignmentPosition | ngs::AlignmentBatch::referenceIndex
+                                | ngs::AlignmentBatch::cigarOps, 4, 0 );
+    Assert ( 3 == it.fill ( batch, 3 ) );
+    Assert ( 3 == batch . size () );
+    Assert ( 0 == batch . getReferenceIndices () [ 2 ] );
+    Assert ( 123 == batch . getAlignmentPositions () [ 2 ] );
+    Assert ( 0 == batch . getMappingQualities () );
+    ngs::Alignment::CigarOps ops = batch . getCigarOps ( 2 );
+    Assert ( 3 == ops . count );
+    Assert ( 5 == ops . length ( 0 ) && 'M' == ops . op ( 0 ) );
+    Assert ( 'D' == ops . op ( 1 ) );
+    Assert ( 6 == batch . getCigarSpans () [ 2 ] . offset );
+    Assert ( 1 == it.fill ( batch, 3 ) );
+    Assert ( 0 == it.fill ( batch, 3 ) );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_fill_CigarArena )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // each CIGAR has 3 operations: 2 per batch
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::cigarOps, 4, 0, 7 );
+    Assert ( 2 == it.fill ( batch, 4 ) );
+    Assert ( 2 == it.fill ( batch, 4 ) );
+    Assert ( 3 == batch . getCigarOps ( 1 ) . count );
+    Assert ( 0 == it.fill ( batch, 4 ) );
+
+    ngs::AlignmentIterator again = rc.getAlignments ( ngs::Alignment::all );
+    ngs::AlignmentBatch small ( ngs::AlignmentBatch::cigarOps, 4, 0, 2 );
+    bool thrown = false;
+    try
+    {
+        again.fill ( small, 4 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_nextAlignmentBatch_Fields )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::alignmentPosition, 4, 0 );
+    Assert ( it.nextAlignmentBatch ( batch ) );
+    Assert ( 4 == batch . size () );
+    Assert ( 123 == batch . getAlignmentPosition ( 0 ) );
+    bool thrown = false;
+    try
+    {
+        batch . getReadId ( 0 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_exportAlignments )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ArrowArrayStream stream;
+    ngs::arrow::exportAlignments ( it, & stream,
+        ngs::AlignmentBatch::alignmentPosition | ngs::AlignmentBatch::alignmentFlags
+        | ngs::AlignmentBatch::referenceSpec | ngs::AlignmentBatch::fragmentBases, 3 );
+
+    ArrowSchema schema;
+    Assert ( 0 == stream.get_schema ( & stream, & schema ) );
+    Assert ( std::string ( "+s" ) == schema.format );
+    Assert ( 7 == schema.n_children );
+    Assert ( std::string ( "position" ) == schema.children [ 0 ] -> name );
+    Assert ( std::string ( "is_reversed" ) == schema.children [ 3 ] -> name );
+    Assert ( std::string ( "i" ) == schema.children [ 5 ] -> format );
+    Assert ( std::string ( "u" ) == schema.children [ 5 ] -> dictionary -> format );
+    schema.release ( & schema );
+    Assert ( 0 == schema.release );
+
+    // the test engine has 4 alignments
+    ArrowArray array;
+    Assert ( 0 == stream.get_next ( & stream, & array ) );
+    Assert ( 3 == array.length );
+    Assert ( 7 == array.n_children );
+    Assert ( 123 == ( ( const int64_t * ) array.children [ 0 ] -> buffers [ 1 ] ) [ 2 ] );
+    Assert ( 0x07 == ( ( const uint8_t * ) array.children [ 3 ] -> buffers [ 1 ] ) [ 0 ] );
+    Assert ( 0 == ( ( const int32_t * ) array.children [ 5 ] -> buffers [ 1 ] ) [ 2 ] );
+    Assert ( 1 == array.children [ 5 ] -> dictionary -> length );
+    Assert ( 12 == ( ( const int32_t * ) array.children [ 6 ] -> buffers [ 1 ] ) [ 3 ] );
+    Assert ( 0 == memcmp ( "AGCT", ( const char * ) array.children [ 6 ] -> buffers [ 2 ] + 8, 4 ) );
+
+    // a child moved out is released by itself
+    ArrowArray moved = * array.children [ 6 ];
+    array.children [ 6 ] -> release = 0;
+    array.release ( & array );
+    moved.release ( & moved );
+
+    Assert ( 0 == stream.get_next ( & stream, & array ) );
+    Assert ( 1 == array.length );
+    array.release ( & array );
+    Assert ( 0 == stream.get_next ( & stream, & array ) );
+    Assert ( 0 == array.release );
+    Assert ( 0 == stream.get_last_error ( & stream ) );
+    stream.release ( & stream );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_Prefetching )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // one alignment per batch, so that the ring of 2 wraps around
+    ngs::PrefetchingAlignmentIterator pf ( it, ngs::AlignmentBatch::allFields, 2, 1, 64 );
+    unsigned count = 0;
+    while ( pf.nextAlignment () )
+    {
+        ++ count;
+        Assert ( 123 == pf.getAlignmentPosition () );
+        Assert ( 321 == pf.getAlignmentLength () );
+        Assert ( "alignReadId" == pf.getReadId () );
+        Assert ( "AGCT" == pf.getFragmentBases () );
+    }
+    Assert ( 4 == count );
+    Assert ( ! pf.nextAlignment () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_Prefetching_Error )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // the engine throws on the thread; the consumer sees it
+    ngs::PrefetchingAlignmentIterator pf ( it, ngs::AlignmentBatch::allFields, 2, 4, 16 );
+    bool thrown = false;
+    try
+    {
+        pf.nextAlignment ();
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_Prefetching_Abandoned )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // destroyed while the thread waits for a slot
+    ngs::PrefetchingAlignmentIterator pf ( it, ngs::AlignmentBatch::allFields, 1, 1, 64 );
+    Assert ( pf.nextAlignment () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_Projected )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    // the first three come from the core
+    ngs::ProjectedAlignmentIterator < ngs::Projection::Position, ngs::Projection::Length,
+        ngs::Projection::Category, ngs::Projection::Cigar, ngs::Projection::Bases > pa ( it );
+    unsigned count = 0;
+    while ( pa.nextAlignment () )
+    {
+        ++ count;
+        Assert ( 123 == pa.getAlignmentPosition () );
+        Assert ( 321 == pa.getAlignmentLength () );
+        Assert ( ngs::Alignment::secondaryAlignment == pa.getAlignmentCategory () );
+        Assert ( 3 == pa.getCigarOps ().count );
+        Assert ( "AGCT" == pa.getFragmentBases ().toString () );
+    }
+    Assert ( 4 == count );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Alignment_Projected_Single )
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::ProjectedAlignmentIterator < ngs::Projection::MapQ, ngs::Projection::ReadId > pa ( it );
+    Assert ( pa.nextAlignment () );
+    Assert ( 90 == pa.getMappingQuality () );
+    Assert ( "alignReadId" == pa.getReadId ().toString () );
+TEST_END
+
 
 #define TEST_BEGIN_ALIGNMENT( v ) \
     TEST_BEGIN_READCOLLECTION ( v ) \
@@ -432,6 +1143,33 @@ TEST_BEGIN_ALIGNMENT( Alignment_getFragmentQualitiesOffsetLength )
     Assert ( "bd" == quals );
 TEST_END
 
+TEST_BEGIN_ALIGNMENT( Alignment_getFragmentBasesView )
+    ngs::StringView bases = align.getFragmentBasesView();
+    Assert ( "AGCT" == bases.toString() );
+    Assert ( "GC" == bases.substr( 1, 2 ).toString() );
+    Assert ( "GC" == align.getFragmentBasesView( 1, 2 ).toString() );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getFragmentBasesPacked )
+    // packed here from the test engine's "AGCT"
+    std::vector < uint8_t > buffer;
+    ngs::Fragment::PackedBases packed = align.getFragmentBasesPacked ( buffer );
+    Assert ( 4 == packed.count && 0 == packed.phase );
+    Assert ( 0x14 == packed.bases [ 0 ] && 0x28 == packed.bases [ 1 ] );
+    Assert ( 'A' == packed.base ( 0 ) && 'T' == packed.base ( 3 ) );
+
+    packed = align.getFragmentBasesPacked ( 1, 3, buffer );
+    Assert ( 3 == packed.count );
+    Assert ( 4 == packed.code ( 0 ) && 2 == packed.code ( 1 ) && 8 == packed.code ( 2 ) );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getFragmentQualitiesView )
+    ngs::StringView quals = align.getFragmentQualitiesView();
+    ngs::StringView copy = quals;
+    Assert ( "bbd^" == copy.toString() );
+    Assert ( "d^" == quals.toString( 2 ) );
+TEST_END
+
 TEST_BEGIN_ALIGNMENT( Alignment_getAlignmentId )
     ngs::String id = align.getAlignmentId().toString();
     Assert ( "align" == id );
@@ -442,6 +1180,11 @@ TEST_BEGIN_ALIGNMENT( Alignment_getReferenceSpec )
     Assert ( "referenceSpec" == spec );
 TEST_END
 
+TEST_BEGIN_ALIGNMENT( Alignment_getReferenceIndex )
+    Assert ( 0 == align.getReferenceIndex() );
+    Assert ( 1 == align.getMateReferenceIndex() );
+TEST_END
+
 TEST_BEGIN_ALIGNMENT( Alignment_getMappingQuality )
     int qual = align.getMappingQuality();
     Assert ( 90 == qual );
@@ -457,6 +1200,17 @@ TEST_BEGIN_ALIGNMENT( Alignment_getReadGroup )
     Assert ( "alignReadGroup" == name );
 TEST_END
 
+TEST_BEGIN_ALIGNMENT( Alignment_getReferenceSpecView )
+    ngs::StringView spec = align.getReferenceSpecView();
+    Assert ( "referenceSpec" == spec.toString() );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getReadIdView )
+    ngs::StringView id = align.getReadIdView();
+    Assert ( "alignReadId" == id.toString() );
+    Assert ( "" == id.substr( 20 ).toString() );
+TEST_END
+
 TEST_BEGIN_ALIGNMENT( Alignment_getReadId )
     ngs::String id = align.getReadId().toString();
     Assert ( "alignReadId" == id );
@@ -543,10 +1297,152 @@ TEST_BEGIN_ALIGNMENT( Alignment_getMateIsReversedOrientation )
     Assert ( align.getMateIsReversedOrientation() );
 TEST_END
 
+TEST_BEGIN_ALIGNMENT( Alignment_supports )
+    Assert ( align.supports ( ngs::Alignment::readIdMessage ) );
+    Assert ( align.supports ( ngs::Alignment::referencePositionProjectionRangeMessage ) );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_tryGetReadGroup )
+    ngs::String name;
+    Assert ( align.tryGetReadGroup ( name ) );
+    Assert ( "alignReadGroup" == name );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_tryGetMateAlignmentId )
+    ngs::String id;
+    Assert ( align.tryGetMateAlignmentId ( id ) );
+    Assert ( "mateId" == id );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION( Alignment_tryGetReadGroup_None )
+    ngs::Alignment align = rc.getAlignment ( "single" );
+    ngs::String name;
+    Assert ( ! align.tryGetReadGroup ( name ) );
+    Assert ( name.empty () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION( Alignment_tryGetMateAlignmentId_NoMate )
+    ngs::Alignment align = rc.getAlignment ( "single" );
+    ngs::String id;
+    Assert ( ! align.tryGetMateAlignmentId ( id ) );
+    Assert ( id.empty () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION( Alignment_tryGetMateAlignmentId_MateNotFound )
+    ngs::Alignment align = rc.getAlignment ( "orphan" );
+    Assert ( align.hasMate () );
+    ngs::String id;
+    Assert ( ! align.tryGetMateAlignmentId ( id ) );
+    Assert ( id.empty () );
+
+    bool thrown = false;
+    try
+    {
+        align.getMateAlignmentId ();
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_hasTag )
+    Assert ( align.hasTag ( "NM" ) );
+    Assert ( ! align.hasTag ( "XS" ) );
+    Assert ( ! align.hasTag ( "NMX" ) );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getTagInt )
+    Assert ( 3 == align.getTagInt ( "NM" ) );
+    bool thrown = false;
+    try
+    {
+        align.getTagInt ( "MD" );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getTagString )
+    Assert ( "4A2" == align.getTagString ( "MD" ) );
+    bool thrown = false;
+    try
+    {
+        align.getTagString ( "XS" );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getTagArray )
+    std::vector < uint16_t > zx = align.getTagArray < uint16_t > ( "ZX" );
+    Assert ( 3 == zx.size () );
+    Assert ( 1 == zx [ 0 ] && 2 == zx [ 1 ] && 0xFFFF == zx [ 2 ] );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getCigarOps )
+    std::vector < uint32_t > buffer;
+    ngs::Alignment::CigarOps cigar = align.getCigarOps ( buffer );
+    Assert ( 3 == cigar.count );
+    Assert ( 5 == cigar.length ( 0 ) && 'M' == cigar.op ( 0 ) );
+    Assert ( 1 == cigar.length ( 1 ) && 'D' == cigar.op ( 1 ) );
+    Assert ( 3 == cigar.length ( 2 ) && 'M' == cigar.op ( 2 ) );
+    Assert ( buffer.empty () );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getMismatchMask )
+    // the test engine's "TA" is compared to "CTAG" along 5M1D3M
+    std::vector < uint8_t > mask;
+    Assert ( 2 == align.getMismatchMask ( mask ) );
+    Assert ( 2 == mask.size () );
+    Assert ( 1 == mask [ 0 ] && 1 == mask [ 1 ] );
+    Assert ( 2 == align.getMismatchCount () );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getFragmentInReadOrientation )
+    // a secondary alignment of the reverse strand, without hard clips
+    ngs::String bases ( "leftover" ), quals;
+    Assert ( align.getFragmentInReadOrientation ( bases, quals ) );
+    Assert ( "AGCT" == bases );
+    Assert ( "^dbb" == quals );
+TEST_END
+
+TEST_BEGIN_ALIGNMENT( Alignment_getCore )
+    ngs::Alignment::Core core = align.getCore ();
+    Assert ( align.getAlignmentPosition () == core.alignmentPosition );
+    Assert ( align.getAlignmentLength () == core.alignmentLength );
+    Assert ( align.getTemplateLength () == core.templateLength );
+    Assert ( align.getMappingQuality () == core.mappingQuality );
+    Assert ( ! core.primary );
+    Assert ( core.reversedOrientation );
+    Assert ( core.mate );
+TEST_END
+
 
 void TestAlignment ()
 {
     Alignment_Iteration ();
+    Alignment_skipTo ();
+    Alignment_Cursor ();
+    Alignment_nextAlignmentBatch ();
+    Alignment_nextAlignmentBatch_Arena ();
+    Alignment_nextAlignmentBatch_ArenaTooSmall ();
+    Alignment_nextAlignmentBatch_Fields ();
+    Alignment_fill ();
+    Alignment_fill_CigarArena ();
+    Alignment_exportAlignments ();
+    Alignment_Prefetching ();
+    Alignment_Prefetching_Error ();
+    Alignment_Prefetching_Abandoned ();
+    Alignment_Projected ();
+    Alignment_Projected_Single ();
 
     Alignment_getFragmentId ();
     Alignment_getFragmentBases ();
@@ -555,12 +1451,18 @@ void TestAlignment ()
     Alignment_getFragmentQualities();
     Alignment_getFragmentQualitiesOffset ();
     Alignment_getFragmentQualitiesOffsetLength ();
+    Alignment_getFragmentBasesView ();
+    Alignment_getFragmentBasesPacked ();
+    Alignment_getFragmentQualitiesView ();
 
     Alignment_getAlignmentId ();
     Alignment_getReferenceSpec ();
+    Alignment_getReferenceIndex ();
     Alignment_getMappingQuality ();
     Alignment_getReferenceBases ();
     Alignment_getReadGroup ();
+    Alignment_getReferenceSpecView ();
+    Alignment_getReadIdView ();
     Alignment_getReadId ();
     Alignment_getClippedFragmentBases ();
     Alignment_getClippedFragmentQualities ();
@@ -573,11 +1475,27 @@ void TestAlignment ()
     Alignment_getTemplateLength ();
     Alignment_getShortCigar ();
     Alignment_getLongCigar ();
+    Alignment_getCigarOps ();
+    Alignment_getMismatchMask ();
+    Alignment_getFragmentInReadOrientation ();
+    Alignment_getCore ();
     Alignment_hasMate ();
     Alignment_getMateAlignmentId ();
     Alignment_getMateAlignment ();
     Alignment_getMateReferenceSpec ();
     Alignment_getMateIsReversedOrientation ();
+
+    Alignment_supports ();
+    Alignment_tryGetReadGroup ();
+    Alignment_tryGetMateAlignmentId ();
+    Alignment_tryGetReadGroup_None ();
+    Alignment_tryGetMateAlignmentId_NoMate ();
+    Alignment_tryGetMateAlignmentId_MateNotFound ();
+
+    Alignment_hasTag ();
+    Alignment_getTagInt ();
+    Alignment_getTagString ();
+    Alignment_getTagArray ();
 }
 
 /////////// Pileup
@@ -613,6 +1531,120 @@ TEST_BEGIN_PILEUP ( Pileup_getPileupDepth )
     Assert ( 21 == pileup.getPileupDepth() );
 TEST_END
 
+TEST_BEGIN_PILEUP ( Pileup_getColumn )
+    ngs::PileupColumn column;
+    pileup.getColumn ( column );
+    Assert ( 7 == column.size () );
+    for ( uint32_t i = 0; i < column.size (); ++ i )
+    {
+        Assert ( ngs::PileupEvent::mismatch == column.getEventType ( i ) );
+        Assert ( 'A' == column.getAlignmentBase ( i ) );
+        Assert ( 'q' == column.getAlignmentQuality ( i ) );
+        Assert ( 98 == column.getMappingQuality ( i ) );
+        Assert ( "AC" == column.getInsertionBases ( i ).toString () );
+        Assert ( "#$" == column.getInsertionQualities ( i ).toString () );
+    }
+    Assert ( 'A' == column.getAlignmentBases () [ 6 ] );
+    // the events start over
+    ngs::PileupEventIterator events = it;
+    Assert ( events.nextPileupEvent () );
+TEST_END
+
+TEST_BEGIN_PILEUP ( Pileup_getColumn_Grow )
+    // too small for the 7 events and their insertions at first
+    ngs::PileupColumn column ( ngs::PileupColumn::allFields, 2, 4 );
+    pileup.getColumn ( column );
+    Assert ( 7 == column.size () );
+    Assert ( "AC" == column.getInsertionBases ( 6 ).toString () );
+    Assert ( "#$" == column.getInsertionQualities ( 6 ).toString () );
+    pileup.getColumn ( column );
+    Assert ( 7 == column.size () );
+TEST_END
+
+TEST_BEGIN_PILEUP ( Pileup_getColumn_Fields )
+    ngs::PileupColumn column ( ngs::PileupColumn::eventType | ngs::PileupColumn::mappingQuality );
+    pileup.getColumn ( column );
+    Assert ( 7 == column.size () );
+    Assert ( 98 == column.getMappingQualities () [ 0 ] );
+    Assert ( 0 == column.getAlignmentBases () );
+    bool thrown = false;
+    try
+    {
+        column.getAlignmentBase ( 0 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN_PILEUP ( Pileup_getBaseCounts )
+    ngs::PileupBaseCounts counts;
+    pileup.getBaseCounts ( 0, counts );
+    Assert ( 12345 == counts.getReferencePosition () );
+    Assert ( 7 == counts.getCount ( ngs::PileupBaseCounts::baseA ) );
+    Assert ( 7 == counts.getCount ( ngs::PileupBaseCounts::baseA, ngs::PileupBaseCounts::plusStrand ) );
+    Assert ( 0 == counts.getCount ( ngs::PileupBaseCounts::baseA, ngs::PileupBaseCounts::minusStrand ) );
+    Assert ( 0 == counts.getCount ( ngs::PileupBaseCounts::baseC ) );
+    Assert ( 0 == counts.getCount ( ngs::PileupBaseCounts::insertion ) );
+    // the test engine's qualities are 'q', i.e. 80
+    pileup.getBaseCounts ( 81, counts );
+    Assert ( 0 == counts.getCount ( ngs::PileupBaseCounts::baseA ) );
+    pileup.getBaseCounts ( 80, counts );
+    Assert ( 7 == counts.getCount ( ngs::PileupBaseCounts::baseA ) );
+    // the events start over
+    ngs::PileupEventIterator events = it;
+    Assert ( events.nextPileupEvent () );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Pileup_nextBaseCounts )
+    ngs::PileupIterator it = rc.getReference ( "refspec" ) .getPileups ( ngs::Alignment::all );
+    ngs::PileupBaseCounts counts [ 5 ];
+    // 3 positions
+    Assert ( 3 == it.nextBaseCounts ( 0, counts, 5 ) );
+    for ( size_t i = 0; i < 3; ++ i )
+        Assert ( 7 == counts [ i ].getCount ( ngs::PileupBaseCounts::baseA ) );
+    Assert ( 0 == counts [ 3 ].getCount ( ngs::PileupBaseCounts::baseA ) );
+    Assert ( 0 == it.nextBaseCounts ( 0, counts, 5 ) );
+TEST_END
+
+TEST_BEGIN ( Pileup_MultiPileupIterator )
+    ngs::ReadCollection tumor = ngs_test_engine::NGS::openReadCollection ( "tumor" );
+    ngs::ReadCollection normal = ngs_test_engine::NGS::openReadCollection ( "normal" );
+    std::vector < ngs::Reference > refs;
+    refs.push_back ( tumor.getReference ( "refspec" ) );
+    refs.push_back ( normal.getReference ( "refspec" ) );
+
+    // the test engine's window of 3 is 3 Pileups at the same position,
+    // and it doesn't skip, so both samples are met at each
+    ngs::MultiPileupIterator it ( refs, 0, 3, ngs::Alignment::all, ngs::Alignment::passFailed, 0,
+                                  ngs::PileupColumn::eventType, 2 );
+    Assert ( 2 == it.getSampleCount () );
+    uint32_t positions = 0;
+    while ( it.nextPileup () )
+    {
+        ++ positions;
+        Assert ( 12345 == it.getReferencePosition () );
+        Assert ( 7 == it.getColumn ( 0 ).size () );
+        Assert ( 7 == it.getColumn ( 1 ).size () );
+        Assert ( ngs::PileupEvent::mismatch == it.getColumn ( 1 ).getEventType ( 6 ) );
+    }
+    Assert ( 3 == positions );
+    Assert ( ! it.nextPileup () );
+
+    bool thrown = false;
+    try
+    {
+        it.getColumn ( 0 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
 void TestPileup ()
 {
     Pileup_Iteration ();
@@ -621,6 +1653,12 @@ void TestPileup ()
     Pileup_getReferencePosition ();
     Pileup_getReferenceBase ();
     Pileup_getPileupDepth ();
+    Pileup_getColumn ();
+    Pileup_getColumn_Grow ();
+    Pileup_getColumn_Fields ();
+    Pileup_getBaseCounts ();
+    Pileup_nextBaseCounts ();
+    Pileup_MultiPileupIterator ();
 }
 
 /////////// PileupEvent
@@ -652,6 +1690,11 @@ TEST_BEGIN_PILEUPEVENT ( PileupEvent_getMappingQuality )
     Assert ( 98 == evt.getMappingQuality() );
 TEST_END
 
+TEST_BEGIN_PILEUPEVENT ( PileupEvent_getReferenceIndex )
+    Assert ( 0 == evt.getReferenceIndex() );
+    Assert ( -1 == evt.getMateReferenceIndex() );
+TEST_END
+
 TEST_BEGIN_PILEUPEVENT ( PileupEvent_getAlignmentId )
     Assert ( "pileupEventAlignId" == evt.getAlignmentId().toString() );
 TEST_END
@@ -713,6 +1756,7 @@ void TestPileupEvent ()
     PileupEvent_Iteration();
 
     PileupEvent_getMappingQuality ();
+    PileupEvent_getReferenceIndex ();
     PileupEvent_getAlignmentId ();
     //PileupEvent_getAlignment ();
     PileupEvent_getAlignmentPosition ();
@@ -761,6 +1805,15 @@ TEST_BEGIN_STATISTICS ( Statistics_nextPath)
     Assert ( "nextpath" == stat.nextPath("path") );
 TEST_END
 
+TEST_BEGIN_STATISTICS ( Statistics_getAll)
+    std::vector < ngs::Statistics::Entry > entries;
+    stat.getAll ( entries );
+    Assert ( 1 == entries.size() );
+    Assert ( "path" == entries[0].path );
+    Assert ( ngs::Statistics::uint64 == entries[0].type );
+    Assert ( 144 == entries[0].u64 );
+TEST_END
+
 void TestStatistics ()
 {
     Statistics_getValueType ();
@@ -769,6 +1822,853 @@ void TestStatistics ()
     Statistics_getAsU64 ();
     Statistics_getAsDouble ();
     Statistics_nextPath ();
+    Statistics_getAll ();
+}
+
+/////////// Executor
+
+// counts what a query produced, and how it finished
+class CountingHandler : public ngs::AlignmentHandler, public ngs::ReadHandler, public ngs::PileupHandler
+{
+public:
+    CountingHandler ( uint64_t stopAt = ( uint64_t ) -1 )
+    : count ( 0 ), finishes ( 0 ), stopAt ( stopAt )
+    {
+    }
+
+    bool alignments ( const ngs::AlignmentBatch & batch )
+    {
+        count += batch . size ();
+        return count < stopAt;
+    }
+
+    bool read ( ngs::Read & read )
+    {
+        Assert ( ! read . getReadId () . toString () . empty () );
+        return ++ count < stopAt;
+    }
+
+    bool pileup ( ngs::Pileup & pileup )
+    {
+        return ++ count < stopAt;
+    }
+
+    void finished ( const ngs::String & Error )
+    {
+        ++ finishes;
+        error = Error;
+    }
+
+    uint64_t count;
+    uint32_t finishes;
+    uint64_t stopAt;
+    ngs::String error;
+};
+
+TEST_BEGIN_READCOLLECTION ( Executor_Queries )
+    uint64_t alignments = 0;
+    {
+        ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+        while ( it.nextAlignment () )
+            ++ alignments;
+    }
+    uint64_t pileups = 0;
+    {
+        ngs::PileupIterator it = rc.getReference ( "refspec" ) .getPileups ( ngs::Alignment::all );
+        while ( it.nextPileup () )
+            ++ pileups;
+    }
+
+    CountingHandler reads [ 3 ], aligns [ 3 ], pups;
+    {
+        ngs::Executor executor ( 2 );
+        for ( int i = 0; i < 3; ++ i )
+        {
+            executor.submit ( rc.getReads ( ngs::Read::all ), reads [ i ], 2 );
+            executor.submit ( rc.getAlignments ( ngs::Alignment::all ), aligns [ i ], ngs::AlignmentBatch::allFields, 1, 64 );
+        }
+        executor.submit ( rc.getReference ( "refspec" ) .getPileups ( ngs::Alignment::all ), pups, 1 );
+        executor.wait ();
+
+        for ( int i = 0; i < 3; ++ i )
+        {
+            Assert ( 6 == reads [ i ] . count );
+            Assert ( 1 == reads [ i ] . finishes );
+            Assert ( reads [ i ] . error . empty () );
+            Assert ( alignments == aligns [ i ] . count );
+            Assert ( 1 == aligns [ i ] . finishes );
+        }
+        Assert ( pileups == pups . count );
+        Assert ( 1 == pups . finishes );
+    }
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Executor_Stop )
+    CountingHandler reads ( 2 ), aligns ( 1 );
+    {
+        ngs::Executor executor ( 1 );
+        executor.submit ( rc.getReads ( ngs::Read::all ), reads );
+        executor.submit ( rc.getAlignments ( ngs::Alignment::all ), aligns, ngs::AlignmentBatch::allFields, 1, 64 );
+        // the destructor waits
+    }
+    Assert ( 2 == reads . count );
+    Assert ( 1 == reads . finishes );
+    Assert ( reads . error . empty () );
+    Assert ( 1 == aligns . count );
+    Assert ( 1 == aligns . finishes );
+TEST_END
+
+TEST_BEGIN_READCOLLECTION ( Executor_Error )
+    CountingHandler aligns;
+    {
+        ngs::Executor executor ( 2 );
+        // the batch's arena is too small for an alignment
+        executor.submit ( rc.getAlignments ( ngs::Alignment::all ), aligns, ngs::AlignmentBatch::allFields, 4, 16 );
+    }
+    Assert ( 0 == aligns . count );
+    Assert ( 1 == aligns . finishes );
+    Assert ( ! aligns . error . empty () );
+TEST_END
+
+void TestExecutor ()
+{
+    Executor_Queries ();
+    Executor_Stop ();
+    Executor_Error ();
+}
+
+/////////// WorkPool
+
+// notes the order items ran in; a blocker holds its thread until released
+class OrderedItem : public ngs::WorkItem
+{
+public:
+    OrderedItem ()
+    : id ( 0 ), order ( 0 ), ran ( 0 ), block ( false )
+    {
+    }
+
+    void run ()
+    {
+        while ( block && ! __sync_fetch_and_add ( & released, 0 ) )
+            usleep ( 100 );
+        order [ __sync_fetch_and_add ( ran, 1 ) ] = id;
+    }
+
+    int id;
+    int * order;
+    volatile int * ran;
+    bool block;
+    static volatile int released;
+};
+
+volatile int OrderedItem :: released;
+
+// waits up to 10 s for "count" items to have run
+static bool RanAll ( volatile int & ran, int count )
+{
+    for ( int i = 0; i < 100000 && __sync_fetch_and_add ( & ran, 0 ) < count; ++ i )
+        usleep ( 100 );
+    return __sync_fetch_and_add ( & ran, 0 ) == count;
+}
+
+TEST_BEGIN ( WorkPool_runsItems )
+    ngs::WorkPool pool ( 3 );
+    Assert ( 3 == pool . threads () );
+
+    int order [ 64 ];
+    volatile int ran = 0;
+    OrderedItem items [ 64 ];
+    for ( int i = 0; i < 64; ++ i )
+    {
+        items [ i ] . id = i;
+        items [ i ] . order = order;
+        items [ i ] . ran = & ran;
+        pool . submit ( items [ i ] );
+    }
+    Assert ( RanAll ( ran, 64 ) );
+    Assert ( ! pool . cancel ( items [ 0 ] ) );
+TEST_END
+
+TEST_BEGIN ( WorkPool_priorityAndCancel )
+    ngs::WorkPool pool ( 1 );
+    int order [ 8 ];
+    volatile int ran = 0;
+    OrderedItem items [ 5 ];
+    for ( int i = 0; i < 5; ++ i )
+    {
+        items [ i ] . id = i;
+        items [ i ] . order = order;
+        items [ i ] . ran = & ran;
+    }
+
+    // the one thread is held while the others are queued
+    OrderedItem :: released = 0;
+    items [ 0 ] . block = true;
+    pool . submit ( items [ 0 ] );
+    for ( int i = 0; i < 1000 && pool . cancel ( items [ 0 ] ); ++ i )
+    {
+        pool . submit ( items [ 0 ] );
+        usleep ( 1000 );
+    }
+    pool . submit ( items [ 1 ], ngs::WorkPool::low );
+    pool . submit ( items [ 2 ], ngs::WorkPool::normal );
+    pool . submit ( items [ 3 ], ngs::WorkPool::high );
+    pool . submit ( items [ 4 ], ngs::WorkPool::normal );
+    Assert ( pool . cancel ( items [ 4 ] ) );
+    Assert ( ! pool . cancel ( items [ 4 ] ) );
+    __sync_fetch_and_add ( & OrderedItem :: released, 1 );
+
+    Assert ( RanAll ( ran, 4 ) );
+    Assert ( 0 == order [ 0 ] );
+    Assert ( 3 == order [ 1 ] );
+    Assert ( 2 == order [ 2 ] );
+    Assert ( 1 == order [ 3 ] );
+TEST_END
+
+TEST_BEGIN ( WorkPool_defaultThreads )
+    const char * saved = getenv ( "NGS_POOL_THREADS" );
+    std :: string keep = saved ? saved : "";
+    setenv ( "NGS_POOL_THREADS", "5", 1 );
+    Assert ( 5 == ngs::WorkPool::defaultThreads () );
+    unsetenv ( "NGS_POOL_THREADS" );
+    Assert ( ngs::WorkPool::defaultThreads () >= 1 );
+    if ( saved )
+        setenv ( "NGS_POOL_THREADS", keep . c_str (), 1 );
+
+    // the shared pool is up, from the prefetching tests
+    Assert ( ! ngs::WorkPool::configure ( 2 ) );
+    Assert ( ngs::WorkPool::shared () . threads () >= 1 );
+TEST_END
+
+void TestWorkPool ()
+{
+    WorkPool_runsItems ();
+    WorkPool_priorityAndCancel ();
+    WorkPool_defaultThreads ();
+}
+
+/////////// CallStats
+TEST_BEGIN_READCOLLECTION ( CallStats_countsCalls )
+    ngs::CallStats::Enable ( true );
+    ngs::CallStats::Reset ();
+    ngs::String name = rc.getName ();
+    name = rc.getName ();
+    ngs::CallStats::Enable ( false );
+    name = rc.getName ();
+
+    std::vector < ngs::CallStats::Entry > totals;
+    ngs::CallStats::Totals ( totals, true );
+    if ( ! ngs::CallStats::Compiled () )
+    {
+        Assert ( totals.empty () );
+    }
+    else
+    {
+        bool found = false;
+        for ( size_t i = 0; i < totals.size (); ++ i )
+        {
+            if ( std::string ( totals [ i ] . method ) == "NGS_ReadCollection_v1_vt::get_name" )
+            {
+                Assert ( totals [ i ] . calls == 2 );
+                Assert ( totals [ i ] . cycles != 0 );
+                found = true;
+            }
+        }
+        Assert ( found );
+    }
+TEST_END
+
+void TestCallStats ()
+{
+    CallStats_countsCalls ();
+}
+
+/////////// Trace
+TEST_BEGIN_READCOLLECTION ( Trace_recordsSpans )
+    // run with NGS_TRACE set, the rest of the tests are traced too
+    bool traced = ngs::Trace::Enabled ();
+    ngs::Trace::Enable ( true );
+    ngs::Trace::Clear ();
+    ngs::String name = rc.getName ();
+    name = rc.getName ();
+    ngs::Trace::Enable ( false );
+    name = rc.getName ();
+    Assert ( ! ngs::Trace::Enabled () );
+
+    std::vector < ngs::Trace::Event > events;
+    ngs::Trace::Collect ( events, true );
+    size_t spans = 0;
+    for ( size_t i = 0; i < events.size (); ++ i )
+    {
+        if ( std::string ( events [ i ] . name ) == "NGS_ReadCollection_v1_vt::get_name" )
+        {
+            Assert ( events [ i ] . start != 0 );
+            Assert ( events [ i ] . thread != 0 );
+            ++ spans;
+        }
+    }
+    Assert ( spans == ( ngs::Trace::Compiled () ? 2 : 0 ) );
+
+    // one event per line, after the opening bracket
+    FILE * out = tmpfile ();
+    Assert ( out != 0 );
+    ngs::Trace::Export ( out );
+    rewind ( out );
+    char line [ 512 ];
+    Assert ( fgets ( line, sizeof line, out ) != 0 );
+    Assert ( std::string ( line ) == "[\n" );
+    size_t lines = 0;
+    while ( fgets ( line, sizeof line, out ) != 0 )
+    {
+        Assert ( line [ 0 ] == '{' );
+        ++ lines;
+    }
+    fclose ( out );
+    Assert ( lines >= spans );
+    ngs::Trace::Enable ( traced );
+TEST_END
+
+void TestTrace ()
+{
+    Trace_recordsSpans ();
+}
+
+/////////// DirectBind
+TEST_BEGIN_READCOLLECTION ( DirectBind_Alignment )
+    // the test engine is made of the adapter classes, and is built
+    // alongside, so with NGS_DIRECT_BIND it is called through C++
+    Assert ( ngs::DirectBound () == ( NGS_DIRECT_BIND != 0 ) );
+
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    Assert ( it.nextAlignment () );
+
+    ngs::CallStats::Enable ( true );
+    ngs::CallStats::Reset ();
+    int32_t mapq = it.getMappingQuality ();
+    ngs::CallStats::Enable ( false );
+    Assert ( mapq == rc.getAlignment ( "align" ) . getMappingQuality () );
+
+    // only calls through the C vtable are counted
+    std::vector < ngs::CallStats::Entry > totals;
+    ngs::CallStats::Totals ( totals, true );
+    uint64_t counted = 0;
+    for ( size_t i = 0; i < totals.size (); ++ i )
+    {
+        if ( std::string ( totals [ i ] . method ) == "NGS_Alignment_v1_vt::get_map_qual" )
+            counted = totals [ i ] . calls;
+    }
+    Assert ( counted == ( ngs::CallStats::Compiled () && ! ngs::DirectBound () ? 1 : 0 ) );
+
+    // what the engine throws arrives as an ErrorMsg with its message either way
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::allFields, 4, 16 );
+    std::string what;
+    try
+    {
+        it.nextAlignmentBatch ( batch );
+    }
+    catch ( ngs::ErrorMsg & x )
+    {
+        what = x.what ();
+    }
+    Assert ( "alignment batch arena is too small for the next alignment" == what );
+TEST_END
+
+void TestDirectBind ()
+{
+    DirectBind_Alignment ();
+}
+
+/////////// Synthetic
+#define SYNTHETIC "synthetic:alignments=1000,depth=10,readlen=50,references=2"
+
+TEST_BEGIN ( Synthetic_Alignments )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    Assert ( rc.getAlignmentCount () == 1000 );
+    Assert ( rc.getReadCount () == 1000 );
+
+    // sorted by reference and position, each matching its reference
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    uint64_t count = 0;
+    int64_t last = -1;
+    std::string spec;
+    while ( it.nextAlignment () )
+    {
+        ++ count;
+        std::string ref = it.getReferenceSpec ();
+        if ( ref != spec )
+        {
+            spec = ref;
+            last = -1;
+        }
+        int64_t pos = it.getAlignmentPosition ();
+        Assert ( pos >= last );
+        last = pos;
+        Assert ( it.getAlignmentLength () == 50 );
+        Assert ( it.getFragmentBases () . toString () == rc.getReference ( spec ) . getReferenceBases ( pos, 50 ) );
+        Assert ( it.getFragmentBasesView () . toString () == it.getFragmentBases () . toString () );
+    }
+    Assert ( count == 1000 );
+    Assert ( spec == "chr2" );
+
+    ngs::Alignment al = rc.getAlignment ( "A501" );
+    Assert ( al.getReferenceSpec () == "chr2" );
+    Assert ( al.getReferenceIndex () == 1 );
+    Assert ( al.getMateReferenceIndex () == -1 );
+    Assert ( al.getAlignmentPosition () == 0 );
+    Assert ( al.getReadId () . toString () == "R501" );
+    Assert ( rc.getRead ( "R501" ) . getReadBases () . toString () == al.getFragmentBases () . toString () );
+    Assert ( rc.getRead ( "R501" ) . getReadRowId () == 501 );
+TEST_END
+
+TEST_BEGIN ( Synthetic_Deterministic )
+    ngs::ReadCollection rc1 = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::ReadCollection rc2 = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::Alignment al1 = rc1.getAlignment ( "A777" );
+    ngs::Alignment al2 = rc2.getAlignment ( "A777" );
+    Assert ( al1.getFragmentBases () . toString () == al2.getFragmentBases () . toString () );
+    Assert ( al1.getFragmentQualities () . toString () == al2.getFragmentQualities () . toString () );
+    Assert ( al1.getMappingQuality () == al2.getMappingQuality () );
+TEST_END
+
+TEST_BEGIN ( Synthetic_Slice )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::Reference ref = rc.getReference ( "chr1" );
+    Assert ( ref.getAlignmentCount () == 500 );
+    Assert ( ref.getLength () == 499 * 50 / 10 + 50 );
+
+    // a slice has the alignments that overlap it
+    uint64_t overlapping = 0;
+    ngs::AlignmentIterator all = ref.getAlignments ( ngs::Alignment::all );
+    while ( all.nextAlignment () )
+    {
+        int64_t pos = all.getAlignmentPosition ();
+        if ( pos < 1010 && pos + 50 > 1000 )
+            ++ overlapping;
+    }
+    uint64_t count = 0;
+    ngs::AlignmentIterator it = ref.getAlignmentSlice ( 1000, 10 );
+    while ( it.nextAlignment () )
+        ++ count;
+    Assert ( count == overlapping );
+
+    // and the filters reject by mapping quality
+    ngs::AlignmentIterator filtered = ref.getFilteredAlignmentSlice ( 0, ref.getLength (), ngs::Alignment::all, ngs::Alignment::minMapQuality, 50 );
+    while ( filtered.nextAlignment () )
+        Assert ( filtered.getMappingQuality () >= 50 );
+TEST_END
+
+TEST_BEGIN ( Synthetic_Reposition )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::Reference ref = rc.getReference ( "chr1" );
+
+    // one iterator moved over the windows gives what a slice of each does
+    ngs::AlignmentIterator it = ref.getAlignmentSlice ( 0, 10 );
+    Assert ( it.nextAlignment () );
+    const int64_t starts [] = { 2000, 1000, 1005, 0 };
+    for ( size_t i = 0; i < sizeof starts / sizeof starts [ 0 ]; ++ i )
+    {
+        it.reposition ( starts [ i ], 10 );
+        ngs::AlignmentIterator fresh = ref.getAlignmentSlice ( starts [ i ], 10 );
+        while ( fresh.nextAlignment () )
+        {
+            Assert ( it.nextAlignment () );
+            Assert ( it.getAlignmentId () . toString () == fresh.getAlignmentId () . toString () );
+        }
+        Assert ( ! it.nextAlignment () );
+    }
+
+    // and keeps its filters
+    ngs::AlignmentIterator within = ref.getFilteredAlignmentSlice ( 0, 10, ngs::Alignment::all, ngs::Alignment::startWithinSlice, 0 );
+    within.reposition ( 1000, 10 );
+    while ( within.nextAlignment () )
+        Assert ( within.getAlignmentPosition () >= 1000 );
+
+    // an iterator that isn't of a slice can't be moved
+    bool thrown = false;
+    try
+    {
+        ngs::AlignmentIterator all = rc.getAlignments ( ngs::Alignment::all );
+        all.reposition ( 1000, 10 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+TEST_BEGIN ( Synthetic_Pileup )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::Reference ref = rc.getReference ( "chr1" );
+    ngs::PileupIterator it = ref.getPileupSlice ( 1000, 5 );
+    uint64_t pileups = 0;
+    while ( it.nextPileup () )
+    {
+        ++ pileups;
+        Assert ( it.getPileupDepth () == 10 );
+        uint32_t events = 0;
+        while ( it.nextPileupEvent () )
+        {
+            ++ events;
+            Assert ( it.getAlignmentBase () == it.getReferenceBase () );
+        }
+        Assert ( events == 10 );
+    }
+    Assert ( pileups == 5 );
+TEST_END
+
+TEST_BEGIN ( Synthetic_Pileup_ExtendTo )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::Reference ref = rc.getReference ( "chr1" );
+
+    // a window grown twice gives the positions of the whole one
+    ngs::PileupIterator whole = ref.getPileupSlice ( 1000, 12 );
+    ngs::PileupIterator it = ref.getPileupSlice ( 1000, 5 );
+    int64_t const ends [] = { 1008, 1012 };
+    for ( size_t i = 0; i < sizeof ends / sizeof ends [ 0 ] + 1; ++ i )
+    {
+        while ( it.nextPileup () )
+        {
+            Assert ( whole.nextPileup () );
+            Assert ( it.getReferencePosition () == whole.getReferencePosition () );
+            Assert ( it.getPileupDepth () == whole.getPileupDepth () );
+        }
+        if ( i < sizeof ends / sizeof ends [ 0 ] )
+            it.extendTo ( ends [ i ] );
+    }
+    Assert ( ! whole.nextPileup () );
+
+    // but can't be made smaller
+    bool thrown = false;
+    try
+    {
+        it.extendTo ( 1010 );
+    }
+    catch ( ngs::ErrorMsg & )
+    {
+        thrown = true;
+    }
+    Assert ( thrown );
+TEST_END
+
+// sums the depths of each window, checking its positions are its own
+class DepthPileupTask : public ngs::parallel::PileupTask
+{
+public:
+    DepthPileupTask ( size_t windows ) : depths ( windows, 0 ), inWindow ( true ), inOrder ( true ), reduced ( 0 ), total ( 0 )
+    {
+    }
+
+    void visit ( const ngs::parallel::Window & window, ngs::PileupIterator & pileups )
+    {
+        uint64_t depth = 0;
+        while ( pileups . nextPileup () )
+        {
+            int64_t const pos = pileups . getReferencePosition ();
+            if ( pos < window . start || pos >= window . start + ( int64_t ) window . length )
+                inWindow = false;
+            depth += pileups . getPileupDepth ();
+        }
+        depths [ window . index ] = depth;
+    }
+
+    void reduce ( const ngs::parallel::Window & window )
+    {
+        if ( window . index != reduced )
+            inOrder = false;
+        ++ reduced;
+        total += depths [ window . index ];
+    }
+
+    std::vector < uint64_t > depths;
+    bool inWindow;
+    bool inOrder;
+    uint64_t reduced;
+    uint64_t total;
+};
+
+TEST_BEGIN ( Synthetic_forEachPileup )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+
+    // the depths summed over whole References, one at a time
+    uint64_t whole = 0;
+    size_t windows = 0;
+    ngs::ReferenceIterator refs = rc.getReferences ();
+    while ( refs.nextReference () )
+    {
+        windows += ( size_t ) ( ( refs.getLength () + 36 ) / 37 );
+        ngs::PileupIterator it = refs.getPileups ( ngs::Alignment::all );
+        while ( it.nextPileup () )
+            whole += it.getPileupDepth ();
+    }
+    Assert ( whole != 0 );
+
+    // windows that Alignments cross, run on one thread and on several
+    for ( uint32_t threads = 1; threads <= 8; threads += 7 )
+    {
+        DepthPileupTask task ( windows );
+        ngs::parallel::forEachPileup ( rc, 37, threads, task );
+        Assert ( task . inWindow );
+        Assert ( task . inOrder );
+        Assert ( windows == task . reduced );
+        Assert ( whole == task . total );
+    }
+TEST_END
+
+TEST_BEGIN ( Synthetic_Mismatches )
+    // the reads match the reference exactly
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    std::vector < uint8_t > mask ( 7, 1 );
+    for ( int i = 0; i < 3 && it.nextAlignment (); ++ i )
+    {
+        Assert ( 0 == it.getMismatchCount () );
+        Assert ( 0 == it.getMismatchMask ( mask ) );
+        Assert ( 50 == mask.size () );
+        for ( size_t k = 0; k < mask.size (); ++ k )
+            Assert ( 0 == mask [ k ] );
+    }
+TEST_END
+
+TEST_BEGIN ( Synthetic_ReadOrientation )
+    // every other alignment is of the reverse strand
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::String bases, quals;
+    for ( int i = 0; i < 4 && it.nextAlignment (); ++ i )
+    {
+        ngs::String b = it.getFragmentBases ().toString ();
+        ngs::String q = it.getFragmentQualities ().toString ();
+        if ( it.getIsReversedOrientation () )
+        {
+            std::reverse ( b.begin (), b.end () );
+            std::reverse ( q.begin (), q.end () );
+            for ( size_t k = 0; k < b.size (); ++ k )
+                b [ k ] = "TGCA" [ strchr ( "ACGT", b [ k ] ) - "ACGT" ];
+        }
+        Assert ( it.getFragmentInReadOrientation ( bases, quals ) );
+        Assert ( b == bases );
+        Assert ( q == quals );
+    }
+TEST_END
+
+TEST_BEGIN ( Synthetic_Resume )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignmentShard ( 1, 4, ngs::Alignment::all );
+    Assert ( it.nextAlignment () );
+    Assert ( it.getAlignmentId () . toString () == "A251" );
+    ngs::String cursor = it.getCursor ();
+
+    ngs::AlignmentIterator resumed = rc.getAlignmentShard ( 1, 4, ngs::Alignment::all );
+    resumed.resumeFrom ( cursor );
+    Assert ( resumed.nextAlignment () );
+    Assert ( resumed.getAlignmentId () . toString () == "A252" );
+TEST_END
+
+TEST_BEGIN ( Synthetic_BadSpec )
+    const char * specs [] = { "synthetic:alignments=0", "synthetic:depth", "synthetic:reads=10", "synthetic:readlen=1.5" };
+    for ( size_t i = 0; i < sizeof specs / sizeof specs [ 0 ]; ++ i )
+    {
+        bool threw = false;
+        try
+        {
+            ngs_test_engine::NGS::openReadCollection ( specs [ i ] );
+        }
+        catch ( ngs::ErrorMsg & )
+        {
+            threw = true;
+        }
+        Assert ( threw );
+    }
+TEST_END
+
+void TestSynthetic ()
+{
+    Synthetic_Alignments ();
+    Synthetic_Deterministic ();
+    Synthetic_Slice ();
+    Synthetic_Reposition ();
+    Synthetic_Pileup ();
+    Synthetic_Pileup_ExtendTo ();
+    Synthetic_forEachPileup ();
+    Synthetic_Mismatches ();
+    Synthetic_ReadOrientation ();
+    Synthetic_Resume ();
+    Synthetic_BadSpec ();
+}
+
+/////////// Allocations
+/* the paths that lend rather than copy make nothing per record once
+   they are running; the synthetic engine lends all that it can, so
+   whatever is allocated below is the SDK's doing */
+#define ALLOC_SYNTHETIC "synthetic:alignments=2000,depth=10,readlen=100"
+
+TEST_BEGIN ( Allocations_nextAlignment )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( ALLOC_SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    Assert ( it.nextAlignment () );
+
+    uint64_t sum = 0, count = 0;
+    uint64_t before = Allocations ();
+    while ( it.nextAlignment () )
+    {
+        sum += it.getAlignmentPosition () + it.getAlignmentLength () + it.getMappingQuality () + it.getIsReversedOrientation ();
+        ++ count;
+    }
+    Assert ( Allocations () == before );
+    Assert ( count == 1999 && sum != 0 );
+TEST_END
+
+TEST_BEGIN ( Allocations_getCore )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( ALLOC_SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    std::vector < uint32_t > buffer;
+    Assert ( it.nextAlignment () );
+    it.getCore ();
+    it.getCigarOps ( buffer );
+
+    uint64_t sum = 0;
+    uint64_t before = Allocations ();
+    while ( it.nextAlignment () )
+    {
+        ngs::Alignment::Core core = it.getCore ();
+        ngs::Alignment::CigarOps ops = it.getCigarOps ( buffer );
+        sum += core.alignmentPosition + core.mappingQuality + ops.count;
+    }
+    Assert ( Allocations () == before );
+    Assert ( sum != 0 );
+TEST_END
+
+TEST_BEGIN ( Allocations_Views )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( ALLOC_SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    Assert ( it.nextAlignment () );
+    it.getFragmentBasesView ();
+    it.getFragmentQualitiesView ();
+
+    uint64_t sum = 0;
+    uint64_t before = Allocations ();
+    while ( it.nextAlignment () )
+        sum += it.getFragmentBasesView () . size () + it.getFragmentQualitiesView () . size ();
+    Assert ( Allocations () == before );
+    Assert ( sum == 1999 * 200 );
+
+    // where the strings are copied, they are counted
+    ngs::AlignmentIterator copied = rc.getAlignments ( ngs::Alignment::all );
+    Assert ( copied.nextAlignment () );
+    before = Allocations ();
+    copied.getFragmentBases () . toString ();
+    Assert ( Allocations () > before );
+TEST_END
+
+TEST_BEGIN ( Allocations_Reads )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( ALLOC_SYNTHETIC );
+    ngs::ReadIterator it = rc.getReads ( ngs::Read::all );
+    Assert ( it.nextRead () );
+    Assert ( it.nextFragment () );
+    it.getFragmentBasesView ();
+
+    uint64_t sum = 0;
+    uint64_t before = Allocations ();
+    while ( it.nextRead () )
+    {
+        while ( it.nextFragment () )
+            sum += it.getFragmentBasesView () . size ();
+    }
+    Assert ( Allocations () == before );
+    Assert ( sum == 1999 * 100 );
+TEST_END
+
+TEST_BEGIN ( Allocations_Batch )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( ALLOC_SYNTHETIC );
+    ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+    ngs::AlignmentBatch batch ( ngs::AlignmentBatch::alignmentPosition | ngs::AlignmentBatch::mappingQuality, 100 );
+    Assert ( it.nextAlignmentBatch ( batch ) );
+
+    uint64_t count = batch.size ();
+    uint64_t before = Allocations ();
+    while ( it.nextAlignmentBatch ( batch ) )
+    {
+        for ( uint32_t i = 0; i < batch.size (); ++ i )
+            Assert ( batch.getMappingQuality ( i ) >= 20 );
+        count += batch.size ();
+    }
+    Assert ( Allocations () == before );
+    Assert ( count == 2000 );
+TEST_END
+
+TEST_BEGIN ( Allocations_Pileup )
+    ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( ALLOC_SYNTHETIC );
+    ngs::PileupIterator it = rc.getReference ( "chr1" ) . getPileupSlice ( 500, 1000 );
+    Assert ( it.nextPileup () );
+
+    uint64_t events = 0;
+    uint64_t before = Allocations ();
+    while ( it.nextPileup () )
+    {
+        while ( it.nextPileupEvent () )
+            events += it.getAlignmentBase () != 0;
+    }
+    Assert ( Allocations () == before );
+    Assert ( events == 999 * 10 );
+TEST_END
+
+// hands out heap blocks, counting them
+class CountingAllocator : public ngs_adapt::Allocator
+{
+public:
+    CountingAllocator () : allocated ( 0 ), freed ( 0 ), live ( 0 ) {}
+
+    void * allocate ( size_t bytes )
+    {
+        ++ allocated;
+        live += bytes;
+        return :: operator new ( bytes );
+    }
+    void deallocate ( void * block, size_t bytes )
+    {
+        ++ freed;
+        live -= bytes;
+        :: operator delete ( block );
+    }
+
+    uint64_t allocated;
+    uint64_t freed;
+    size_t live;
+};
+
+TEST_BEGIN ( Allocations_Allocator )
+    CountingAllocator counting;
+    Assert ( ngs_adapt::Allocator::install ( & counting ) == 0 );
+    {
+        ngs::ReadCollection rc = ngs_test_engine::NGS::openReadCollection ( "test" );
+        ngs::AlignmentIterator it = rc.getAlignments ( ngs::Alignment::all );
+        Assert ( it.nextAlignment () );
+        Assert ( ! it.getFragmentBases () . toString () . empty () );
+
+        void * block = ngs_adapt::Allocator::newBlock ( 100 );
+        Assert ( counting . live >= 100 );
+        ngs_adapt::Allocator::deleteBlock ( block, 100 );
+    }
+    Assert ( ngs_adapt::Allocator::install ( 0 ) == & counting );
+    Assert ( ngs_adapt::Allocator::installed () == 0 );
+
+    // the engine's objects all came from it, and went back to it
+    Assert ( counting . allocated > 1 );
+    Assert ( counting . freed == counting . allocated );
+    Assert ( counting . live == 0 );
+TEST_END
+
+void TestAllocations ()
+{
+    Allocations_nextAlignment ();
+    Allocations_getCore ();
+    Allocations_Views ();
+    Allocations_Reads ();
+    Allocations_Batch ();
+    Allocations_Pileup ();
+    Allocations_Allocator ();
 }
 
 /////////// main
@@ -785,6 +2685,13 @@ int main ()
     TestPileup ();
     TestPileupEvent ();
     TestStatistics ();
+    TestExecutor ();
+    TestWorkPool ();
+    TestCallStats ();
+    TestTrace ();
+    TestDirectBind ();
+    TestSynthetic ();
+    TestAllocations ();
 
 
     // check for object leaks
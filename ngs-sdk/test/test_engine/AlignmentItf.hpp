@@ -31,6 +31,9 @@
 #include <ngs/adapter/StringItf.hpp>
 #include <ngs/adapter/AlignmentItf.hpp>
 
+#include <stdio.h>
+#include <stdlib.h>
+
 namespace ngs_test_engine
 {
 
@@ -83,6 +86,16 @@ namespace ngs_test_engine
             return 90; 
         }
 
+        virtual int32_t getReferenceIndex () const
+        {
+            return 0;
+        }
+
+        virtual int32_t getMateReferenceIndex () const
+        {
+            return 1;
+        }
+
         virtual ngs_adapt::StringItf * getReferenceBases () const 
         {
             static std::string bases = "CTAG";
@@ -91,6 +104,9 @@ namespace ngs_test_engine
 
         virtual ngs_adapt::StringItf * getReadGroup () const
         {
+            // "single" and "orphan" are in no read group
+            if ( id == "single" || id == "orphan" )
+                return 0;
             static std::string rg = "alignReadGroup";
             return new ngs_adapt::StringItf( rg.c_str(), rg.size() ); 
         }
@@ -171,15 +187,19 @@ namespace ngs_test_engine
             return '+'; 
         }
 
+        // "single" is unpaired; "orphan" is paired, but its mate is not
+        // in the collection
         virtual bool hasMate () const 
         { 
-            return true; 
+            return id != "single"; 
         }
 
         virtual ngs_adapt::StringItf * getMateAlignmentId () const 
         { 
-            static std::string id = "mateId";
-            return new ngs_adapt::StringItf( id.c_str(), id.size() ); 
+            if ( id == "single" || id == "orphan" )
+                return 0;
+            static std::string mate = "mateId";
+            return new ngs_adapt::StringItf( mate.c_str(), mate.size() ); 
         }
 
         virtual ngs_adapt::AlignmentItf * getMateAlignment () const 
@@ -198,6 +218,49 @@ namespace ngs_test_engine
             return true; 
         }
 
+        virtual bool getTag ( const char * tag, NGS_AlignmentTag_v1 & value ) const
+        {
+            static const unsigned char nm [] = { 3, 0, 0, 0 };
+            static const char md [] = "4A2";
+            static const unsigned char zx [] = { 1, 0, 2, 0, 0xFF, 0xFF };
+
+            value . is_array = false;
+            value . count = 1;
+            if ( tag [ 0 ] == 'N' && tag [ 1 ] == 'M' )
+            {
+                value . type = 'i';
+                value . data = nm;
+            }
+            else if ( tag [ 0 ] == 'M' && tag [ 1 ] == 'D' )
+            {
+                value . type = 'Z';
+                value . data = md;
+                value . count = sizeof md - 1;
+            }
+            else if ( tag [ 0 ] == 'Z' && tag [ 1 ] == 'X' )
+            {
+                value . type = 'S';
+                value . is_array = true;
+                value . data = zx;
+                value . count = sizeof zx / 2;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+
+        virtual bool getCigarOps ( NGS_AlignmentCigar_v1 & cigar ) const
+        {
+            // 5M1D3M
+            static const uint32_t ops [] = { 5 << 4 | 0, 1 << 4 | 2, 3 << 4 | 0 };
+
+            cigar . ops = ops;
+            cigar . count = sizeof ops / sizeof ops [ 0 ];
+            return true;
+        }
+
         virtual bool nextAlignment () 
         { 
             switch ( iterateFor )
@@ -208,6 +271,19 @@ namespace ngs_test_engine
             }
         }
 
+        // the count still to come
+        virtual ngs_adapt::StringItf * getCursor () const
+        {
+            static char cursor [ 16 ];
+            int size = sprintf ( cursor, "%d", iterateFor );
+            return new ngs_adapt::StringItf( cursor, size );
+        }
+
+        virtual void resumeFrom ( const char * cursor )
+        {
+            iterateFor = atoi ( cursor );
+        }
+
 	public:
 		AlignmentItf () 
         :   iterateFor(-1)
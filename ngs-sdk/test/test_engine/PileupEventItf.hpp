@@ -48,6 +48,16 @@ namespace ngs_test_engine
             return 98;
         }
 
+        virtual int32_t getReferenceIndex () const
+        {
+            return 0;
+        }
+
+        virtual int32_t getMateReferenceIndex () const
+        {
+            return -1;
+        }
+
         virtual ngs_adapt::StringItf * getAlignmentId () const
         {
             static std::string alId = "pileupEventAlignId";
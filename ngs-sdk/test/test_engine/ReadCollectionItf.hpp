@@ -34,6 +34,9 @@
 #include "ReferenceItf.hpp"
 #include "AlignmentItf.hpp"
 #include "ReadItf.hpp"
+#include "StatisticsItf.hpp"
+
+#include <string.h>
 
 namespace ngs_test_engine
 {
@@ -104,6 +107,11 @@ namespace ngs_test_engine
             return new ngs_test_engine::AlignmentItf ( 2 ); 
         }
 
+        virtual ngs_adapt::AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary ) const 
+        {
+            return new ngs_test_engine::AlignmentItf ( shard + 1 ); 
+        }
+
         virtual ngs_adapt::ReadItf * getRead ( const char * readId ) const 
         {
             return new ngs_test_engine::ReadItf ( readId ); 
@@ -124,6 +132,17 @@ namespace ngs_test_engine
             return new ngs_test_engine::ReadItf ( ( unsigned int ) count ); 
         }
 
+        virtual ngs_adapt::StatisticsItf * getStatistics () const
+        {
+            return new ngs_test_engine::StatisticsItf ();
+        }
+
+        virtual const NGS_VTable * QueryExtension ( const char * ext ) const
+        {
+            static const NGS_VTable test_ext = { "ngs_test_engine::ReadCollectionItf", "NGS_TestExtension_v1", 0 };
+            return strcmp ( ext, test_ext . itf_name ) == 0 ? & test_ext : 0;
+        }
+
 	public:
 		ReadCollectionItf ( const char* accession ) 
             : name ( accession )
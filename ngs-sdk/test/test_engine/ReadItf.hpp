@@ -31,6 +31,9 @@
 #include <ngs/adapter/StringItf.hpp>
 #include <ngs/adapter/ReadItf.hpp>
 
+#include <stdio.h>
+#include <stdlib.h>
+
 namespace ngs_test_engine
 {
 
@@ -77,6 +80,11 @@ namespace ngs_test_engine
             }
         }
 
+        virtual uint32_t getFragmentIndex () const
+        {
+            return ( uint32_t ) ( 1 - fragmentsIterateFor );
+        }
+
         virtual ngs_adapt::StringItf * getReadId () const 
         {
             static std::string readId = "readId";
@@ -131,6 +139,19 @@ namespace ngs_test_engine
             }
         }
 
+        // the count still to come
+        virtual ngs_adapt::StringItf * getCursor () const
+        {
+            static char cursor [ 16 ];
+            int size = sprintf ( cursor, "%d", iterateFor );
+            return new ngs_adapt::StringItf( cursor, size );
+        }
+
+        virtual void resumeFrom ( const char * cursor )
+        {
+            iterateFor = atoi ( cursor );
+        }
+
 	public:
 		ReadItf () 
         :   iterateFor(-1),
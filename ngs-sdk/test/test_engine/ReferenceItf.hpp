@@ -102,6 +102,21 @@ namespace ngs_test_engine
             return new ngs_test_engine::AlignmentItf ( ( unsigned int ) length ); 
         }
 
+        virtual ngs_adapt :: AlignmentItf * getFilteredAlignments ( uint32_t flags, int32_t map_qual ) const
+        {
+            return new ngs_test_engine::AlignmentItf ( 5 ); 
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getFilteredAlignmentSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual ) const
+        {
+            return new ngs_test_engine::AlignmentItf ( ( unsigned int ) length ); 
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary ) const
+        {
+            return new ngs_test_engine::AlignmentItf ( count - shard ); 
+        }
+
         virtual ngs_adapt :: PileupItf * getPileups ( bool wants_primary, bool wants_secondary ) const
         {
             return new ngs_test_engine::PileupItf ( 3 ); 
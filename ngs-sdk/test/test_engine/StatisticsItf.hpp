@@ -73,6 +73,13 @@ namespace ngs_test_engine
             static std::string val = "nextpath";
             return new ngs_adapt::StringItf( val.c_str(), val.size() );         
         }
+        virtual bool getEntries ( const NGS_StatisticsEntry_v1 * & entries, uint64_t & count ) const
+        {
+            static const NGS_StatisticsEntry_v1 val = { "path", 4, "", 0, 3, { 144 } };
+            entries = & val;
+            count = 1;
+            return true;
+        }
 
 	public:
 		StatisticsItf () 
@@ -0,0 +1,1354 @@
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+*/
+
+#ifndef _hpp_ngs_test_engine_syntheticitf_
+#define _hpp_ngs_test_engine_syntheticitf_
+
+#include <ngs/adapter/ErrorMsg.hpp>
+#include <ngs/adapter/StringItf.hpp>
+#include <ngs/adapter/ReadCollectionItf.hpp>
+#include <ngs/adapter/ReferenceItf.hpp>
+#include <ngs/adapter/AlignmentItf.hpp>
+#include <ngs/adapter/ReadItf.hpp>
+#include <ngs/adapter/PileupItf.hpp>
+
+#include <ngs/Read.hpp>
+#include <ngs/PileupEvent.hpp>
+
+#include "ReadGroupItf.hpp"
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* the synthetic engine
+ *  opened with "synthetic:" followed by comma-separated parameters,
+ *  e.g. "synthetic:alignments=1e8,depth=50,readlen=150,references=4"
+ *
+ *  every alignment, read and pileup is worked out from its index, so
+ *  streams of any size come without I/O or memory to speak of, and the
+ *  same spec always gives the same data
+ */
+
+namespace ngs_test_engine
+{
+
+    /*----------------------------------------------------------------------
+     * SyntheticSpec
+     *  the alignments are spread evenly over the references, those of a
+     *  reference "readlen" bases long and starting every readlen/depth
+     *  bases, so that each position away from the ends is covered "depth"
+     *  times; alignment i of the collection is read i, with one fragment
+     *  that matches the reference exactly
+     */
+    struct SyntheticSpec
+    {
+        uint64_t alignments;
+        uint32_t depth;
+        uint32_t readlen;
+        uint32_t references;
+
+        SyntheticSpec ()
+        : alignments ( 1000000 )
+        , depth ( 30 )
+        , readlen ( 100 )
+        , references ( 1 )
+        {
+        }
+
+        uint64_t perReference () const
+        {
+            return ( alignments + references - 1 ) / references;
+        }
+
+        // the index of the first alignment on "ref"
+        uint64_t firstOn ( uint32_t ref ) const
+        {
+            uint64_t first = perReference () * ref;
+            return first < alignments ? first : alignments;
+        }
+
+        uint64_t countOn ( uint32_t ref ) const
+        {
+            return firstOn ( ref + 1 ) - firstOn ( ref );
+        }
+
+        uint32_t referenceOf ( uint64_t idx ) const
+        {
+            return ( uint32_t ) ( idx / perReference () );
+        }
+
+        // where the k-th alignment of a reference starts
+        int64_t startOf ( uint64_t k ) const
+        {
+            return ( int64_t ) ( k * readlen / depth );
+        }
+
+        // the first k that starts at or after "pos"
+        uint64_t firstAt ( int64_t pos ) const
+        {
+            return pos <= 0 ? 0 : ( ( uint64_t ) pos * depth + readlen - 1 ) / readlen;
+        }
+
+        uint64_t referenceLength ( uint32_t ref ) const
+        {
+            uint64_t count = countOn ( ref );
+            return count == 0 ? 0 : ( uint64_t ) startOf ( count - 1 ) + readlen;
+        }
+
+        // the end of [ start, start + length ) within "ref"
+        int64_t sliceEnd ( uint32_t ref, int64_t start, uint64_t length ) const
+        {
+            int64_t refLength = ( int64_t ) referenceLength ( ref );
+            return length > ( uint64_t ) ( refLength - start ) ? refLength : start + ( int64_t ) length;
+        }
+
+        /* the alignments of "ref" that overlap [ start, start + length ),
+           or that start in it, as [ beg, end ) of the collection */
+        void slice ( uint32_t ref, int64_t start, uint64_t length, bool startWithin, bool wants_primary, uint64_t & beg, uint64_t & end ) const
+        {
+            uint64_t first = firstOn ( ref );
+            uint64_t count = countOn ( ref );
+            int64_t from = startWithin ? start : start - ( int64_t ) readlen + 1;
+            beg = firstAt ( from );
+            end = wants_primary ? firstAt ( sliceEnd ( ref, start, length ) ) : beg;
+            if ( end > count )
+                end = count;
+            if ( beg > end )
+                beg = end;
+            beg += first;
+            end += first;
+        }
+
+        static char referenceBase ( uint32_t ref, uint64_t pos )
+        {
+            uint32_t h = ( uint32_t ) pos * 2654435761u ^ ( uint32_t ) ( pos >> 32 ) ^ ( ref + 1 ) * 0x85ebca6bu;
+            h ^= h >> 15;
+            return "ACGT" [ ( h >> 7 ) & 3 ];
+        }
+
+        static int32_t mappingQuality ( uint64_t idx )
+        {
+            return ( int32_t ) ( 20 + idx % 41 );
+        }
+
+        static char quality ( uint64_t idx, uint64_t offset )
+        {
+            return ( char ) ( '#' + ( idx * 7 + offset ) % 38 );
+        }
+
+        static std :: string referenceName ( uint32_t ref )
+        {
+            char name [ 16 ];
+            int size = sprintf ( name, "chr%u", ref + 1 );
+            return std :: string ( name, size );
+        }
+
+        /* ids are a letter and the one-based index */
+        static std :: string id ( char kind, uint64_t idx )
+        {
+            char id [ 24 ];
+            int size = sprintf ( id, "%c%llu", kind, ( unsigned long long ) idx + 1 );
+            return std :: string ( id, size );
+        }
+
+        // the index for an id, or "alignments" if it is none of ours
+        uint64_t idxOf ( char kind, const char * id ) const
+        {
+            char * end;
+            if ( id [ 0 ] != kind || id [ 1 ] < '1' || id [ 1 ] > '9' )
+                return alignments;
+            unsigned long long n = strtoull ( id + 1, & end, 10 );
+            return * end != 0 || n > alignments ? alignments : ( uint64_t ) n - 1;
+        }
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticFilter
+     *  the mapping quality bits of NGS_ReferenceAlignFlags, the only
+     *  filters that can reject a synthetic alignment
+     */
+    struct SyntheticFilter
+    {
+        uint32_t flags;
+        int32_t map_qual;
+
+        SyntheticFilter ( uint32_t p_flags = 0, int32_t p_map_qual = 0 )
+        : flags ( p_flags )
+        , map_qual ( p_map_qual )
+        {
+        }
+
+        bool rejects ( uint64_t idx ) const
+        {
+            int32_t q = SyntheticSpec :: mappingQuality ( idx );
+            return ( ( flags & NGS_ReferenceAlignFlags_min_map_qual ) != 0 && q < map_qual )
+                || ( ( flags & NGS_ReferenceAlignFlags_max_map_qual ) != 0 && q > map_qual );
+        }
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticString
+     *  a string that keeps its own copy, since the buffers of a synthetic
+     *  iterator change as it moves
+     */
+    class SyntheticString : public ngs_adapt :: StringItf
+    {
+    public:
+
+        SyntheticString ( const std :: string & p_value )
+        : ngs_adapt :: StringItf ( 0, 0 )
+        , value ( p_value )
+        {
+            str = value . data ();
+            sz = value . size ();
+        }
+
+    private:
+
+        std :: string value;
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticRecord
+     *  what the alignment, read and fragment of one index have in common
+     */
+    class SyntheticRecord
+    {
+    public:
+
+        SyntheticRecord ( const SyntheticSpec & p_spec )
+        : spec ( p_spec )
+        , idx ( 0 )
+        , ref ( 0 )
+        , position ( 0 )
+        , filled ( false )
+        , valid ( false )
+        {
+        }
+
+        void Set ( uint64_t p_idx )
+        {
+            idx = p_idx;
+            ref = spec . referenceOf ( idx );
+            position = spec . startOf ( idx - spec . firstOn ( ref ) );
+            filled = false;
+            valid = true;
+        }
+
+        void Check () const
+        {
+            if ( ! valid )
+                throw ngs_adapt :: ErrorMsg ( "invalid iterator access" );
+        }
+
+        void Clear ()
+        {
+            valid = false;
+        }
+
+        // the bases and qualities are only worked out when asked for
+        const std :: string & Bases () const
+        {
+            Fill ();
+            return bases;
+        }
+
+        const std :: string & Qualities () const
+        {
+            Fill ();
+            return quals;
+        }
+
+        ngs_adapt :: StringItf * Part ( const std :: string & whole, uint64_t offset, uint64_t length ) const
+        {
+            Check ();
+            if ( offset >= whole . size () )
+                return new SyntheticString ( std :: string () );
+            return new SyntheticString ( whole . substr ( ( size_t ) offset, length == ( uint64_t ) -1 ? std :: string :: npos : ( size_t ) length ) );
+        }
+
+        void View ( const std :: string & whole, uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        {
+            Check ();
+            uint64_t size = whole . size ();
+            if ( offset > size )
+                offset = size;
+            if ( length > size - offset )
+                length = size - offset;
+            view . data = whole . data () + offset;
+            view . size = ( size_t ) length;
+        }
+
+        SyntheticSpec spec;
+        uint64_t idx;
+        uint32_t ref;
+        int64_t position;
+
+    private:
+
+        void Fill () const
+        {
+            Check ();
+            if ( filled )
+                return;
+            bases . resize ( spec . readlen );
+            quals . resize ( spec . readlen );
+            for ( uint32_t i = 0; i < spec . readlen; ++ i )
+            {
+                bases [ i ] = SyntheticSpec :: referenceBase ( ref, position + i );
+                quals [ i ] = SyntheticSpec :: quality ( idx, i );
+            }
+            filled = true;
+        }
+
+        mutable std :: string bases;
+        mutable std :: string quals;
+        mutable bool filled;
+        bool valid;
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticAlignmentItf
+     *  iterates over the alignments with indices [ first, end ) that pass
+     *  "filter", or stands for the one alignment at "first"
+     */
+    class SyntheticAlignmentItf : public ngs_adapt :: AlignmentItf
+    {
+    public:
+
+        virtual ngs_adapt :: StringItf * getFragmentId () const
+        {
+            rec . Check ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'F', rec . idx ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentBases ( uint64_t offset, uint64_t length ) const
+        {
+            return rec . Part ( rec . Bases (), offset, length );
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentQualities ( uint64_t offset, uint64_t length ) const
+        {
+            return rec . Part ( rec . Qualities (), offset, length );
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentBasesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        {
+            rec . View ( rec . Bases (), offset, length, view );
+            return 0;
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentQualitiesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        {
+            rec . View ( rec . Qualities (), offset, length, view );
+            return 0;
+        }
+
+        virtual ngs_adapt :: StringItf * getAlignmentId () const
+        {
+            rec . Check ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'A', rec . idx ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getReferenceSpec () const
+        {
+            rec . Check ();
+            return new SyntheticString ( SyntheticSpec :: referenceName ( rec . ref ) );
+        }
+
+        virtual int32_t getReferenceIndex () const
+        {
+            rec . Check ();
+            return ( int32_t ) rec . ref;
+        }
+
+        virtual int32_t getMateReferenceIndex () const
+        {
+            rec . Check ();
+            return -1;
+        }
+
+        virtual int32_t getMappingQuality () const
+        {
+            rec . Check ();
+            return SyntheticSpec :: mappingQuality ( rec . idx );
+        }
+
+        virtual ngs_adapt :: StringItf * getReferenceBases () const
+        {
+            return rec . Part ( rec . Bases (), 0, ( uint64_t ) -1 );
+        }
+
+        virtual ngs_adapt :: StringItf * getReadGroup () const
+        {
+            rec . Check ();
+            return new SyntheticString ( std :: string () );
+        }
+
+        virtual ngs_adapt :: StringItf * getReadId () const
+        {
+            rec . Check ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'R', rec . idx ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getClippedFragmentBases () const
+        {
+            return rec . Part ( rec . Bases (), 0, ( uint64_t ) -1 );
+        }
+
+        virtual ngs_adapt :: StringItf * getClippedFragmentQualities () const
+        {
+            return rec . Part ( rec . Qualities (), 0, ( uint64_t ) -1 );
+        }
+
+        virtual ngs_adapt :: StringItf * getAlignedFragmentBases () const
+        {
+            return rec . Part ( rec . Bases (), 0, ( uint64_t ) -1 );
+        }
+
+        virtual bool isPrimary () const
+        {
+            rec . Check ();
+            return true;
+        }
+
+        virtual int64_t getAlignmentPosition () const
+        {
+            rec . Check ();
+            return rec . position;
+        }
+
+        virtual uint64_t getReferencePositionProjectionRange ( int64_t ref_pos ) const
+        {
+            rec . Check ();
+            if ( ref_pos < rec . position || ref_pos >= rec . position + ( int64_t ) rec . spec . readlen )
+                return ( uint64_t ) -1;
+            return ( ( uint64_t ) ( ref_pos - rec . position ) << 32 ) | 1;
+        }
+
+        virtual uint64_t getAlignmentLength () const
+        {
+            rec . Check ();
+            return rec . spec . readlen;
+        }
+
+        virtual bool getIsReversedOrientation () const
+        {
+            rec . Check ();
+            return ( rec . idx & 1 ) != 0;
+        }
+
+        virtual int32_t getSoftClip ( uint32_t edge ) const
+        {
+            rec . Check ();
+            return 0;
+        }
+
+        virtual uint64_t getTemplateLength () const
+        {
+            rec . Check ();
+            return 0;
+        }
+
+        virtual ngs_adapt :: StringItf * getShortCigar ( bool clipped ) const
+        {
+            return Cigar ( 'M' );
+        }
+
+        virtual ngs_adapt :: StringItf * getLongCigar ( bool clipped ) const
+        {
+            return Cigar ( '=' );
+        }
+
+        virtual char getRNAOrientation () const
+        {
+            rec . Check ();
+            return '?';
+        }
+
+        virtual bool hasMate () const
+        {
+            rec . Check ();
+            return false;
+        }
+
+        virtual ngs_adapt :: StringItf * getMateAlignmentId () const
+        {
+            rec . Check ();
+            return new SyntheticString ( std :: string () );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getMateAlignment () const
+        {
+            throw ngs_adapt :: ErrorMsg ( "synthetic alignments have no mates" );
+        }
+
+        virtual ngs_adapt :: StringItf * getMateReferenceSpec () const
+        {
+            rec . Check ();
+            return new SyntheticString ( std :: string () );
+        }
+
+        virtual bool getMateIsReversedOrientation () const
+        {
+            rec . Check ();
+            return false;
+        }
+
+        virtual bool getCigarOps ( NGS_AlignmentCigar_v1 & cigar ) const
+        {
+            rec . Check ();
+            cigar . ops = & cigarOp;
+            cigar . count = 1;
+            return true;
+        }
+
+        virtual void getCore ( NGS_AlignmentCore_v1 & core ) const
+        {
+            rec . Check ();
+            core . position = rec . position;
+            core . length = rec . spec . readlen;
+            core . template_len = 0;
+            core . map_qual = SyntheticSpec :: mappingQuality ( rec . idx );
+            core . flags = NGS_AlignmentBatchFlags_primary
+                | ( ( rec . idx & 1 ) != 0 ? NGS_AlignmentBatchFlags_reversed : 0 );
+        }
+
+        virtual bool nextAlignment ()
+        {
+            if ( ! iterating )
+                throw ngs_adapt :: ErrorMsg ( "invalid iterator access" );
+            while ( next < end && filter . rejects ( next ) )
+                ++ next;
+            if ( next >= end )
+                return false;
+            rec . Set ( next ++ );
+            return true;
+        }
+
+        // the index of the next alignment to look at
+        virtual ngs_adapt :: StringItf * getCursor () const
+        {
+            char cursor [ 24 ];
+            int size = sprintf ( cursor, "%llu", ( unsigned long long ) next );
+            return new SyntheticString ( std :: string ( cursor, size ) );
+        }
+
+        virtual void resumeFrom ( const char * cursor )
+        {
+            next = strtoull ( cursor, 0, 10 );
+        }
+
+        // a slice is given the alignments of the new window
+        virtual void reposition ( int64_t start, uint64_t length )
+        {
+            if ( ! sliced )
+                throw ngs_adapt :: ErrorMsg ( "this Alignment iterator cannot be repositioned" );
+            rec . spec . slice ( sliceRef, start, length,
+                ( filter . flags & NGS_ReferenceAlignFlags_start_within_window ) != 0, wantsPrimary, next, end );
+            rec . Clear ();
+        }
+
+    public:
+
+        SyntheticAlignmentItf ( const SyntheticSpec & spec, uint64_t p_first, uint64_t p_end, const SyntheticFilter & p_filter )
+        : rec ( spec )
+        , filter ( p_filter )
+        , next ( p_first )
+        , end ( p_end < spec . alignments ? p_end : spec . alignments )
+        , cigarOp ( spec . readlen << 4 | 0 )
+        , sliceRef ( 0 )
+        , iterating ( true )
+        , sliced ( false )
+        , wantsPrimary ( false )
+        {
+        }
+
+        // a slice of "ref", which reposition can move
+        SyntheticAlignmentItf ( const SyntheticSpec & spec, uint32_t ref, int64_t start, uint64_t length, const SyntheticFilter & p_filter, bool wants_primary )
+        : rec ( spec )
+        , filter ( p_filter )
+        , next ( 0 )
+        , end ( 0 )
+        , cigarOp ( spec . readlen << 4 | 0 )
+        , sliceRef ( ref )
+        , iterating ( true )
+        , sliced ( true )
+        , wantsPrimary ( wants_primary )
+        {
+            reposition ( start, length );
+        }
+
+        SyntheticAlignmentItf ( const SyntheticSpec & spec, uint64_t idx )
+        : rec ( spec )
+        , next ( idx + 1 )
+        , end ( idx + 1 )
+        , cigarOp ( spec . readlen << 4 | 0 )
+        , sliceRef ( 0 )
+        , iterating ( false )
+        , sliced ( false )
+        , wantsPrimary ( false )
+        {
+            rec . Set ( idx );
+        }
+
+    private:
+
+        ngs_adapt :: StringItf * Cigar ( char op ) const
+        {
+            rec . Check ();
+            char cigar [ 16 ];
+            int size = sprintf ( cigar, "%u%c", rec . spec . readlen, op );
+            return new SyntheticString ( std :: string ( cigar, size ) );
+        }
+
+        SyntheticRecord rec;
+        SyntheticFilter filter;
+        uint64_t next, end;
+        uint32_t cigarOp;
+        uint32_t sliceRef;
+        bool iterating;
+        bool sliced;
+        bool wantsPrimary;
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticReadItf
+     *  as the alignments, reads [ first, end ) of one fragment each
+     */
+    class SyntheticReadItf : public ngs_adapt :: ReadItf
+    {
+    public:
+
+        virtual ngs_adapt :: StringItf * getFragmentId () const
+        {
+            CheckFragment ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'F', rec . idx ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentBases ( uint64_t offset, uint64_t length ) const
+        {
+            CheckFragment ();
+            return rec . Part ( rec . Bases (), offset, length );
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentQualities ( uint64_t offset, uint64_t length ) const
+        {
+            CheckFragment ();
+            return rec . Part ( rec . Qualities (), offset, length );
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentBasesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        {
+            CheckFragment ();
+            rec . View ( rec . Bases (), offset, length, view );
+            return 0;
+        }
+
+        virtual ngs_adapt :: StringItf * getFragmentQualitiesView ( uint64_t offset, uint64_t length, NGS_StringView_v1 & view ) const
+        {
+            CheckFragment ();
+            rec . View ( rec . Qualities (), offset, length, view );
+            return 0;
+        }
+
+        virtual bool isPaired () const
+        {
+            CheckFragment ();
+            return false;
+        }
+
+        virtual bool isAligned () const
+        {
+            CheckFragment ();
+            return true;
+        }
+
+        virtual bool nextFragment ()
+        {
+            rec . Check ();
+            if ( fragment > 0 )
+                return false;
+            ++ fragment;
+            return true;
+        }
+
+        virtual ngs_adapt :: StringItf * getReadId () const
+        {
+            rec . Check ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'R', rec . idx ) );
+        }
+
+        virtual uint32_t getNumFragments () const
+        {
+            rec . Check ();
+            return 1;
+        }
+
+        virtual bool fragmentIsAligned ( uint32_t fragIdx ) const
+        {
+            rec . Check ();
+            return fragIdx == 0;
+        }
+
+        virtual uint32_t getReadCategory () const
+        {
+            rec . Check ();
+            return ngs :: Read :: fullyAligned;
+        }
+
+        virtual ngs_adapt :: StringItf * getReadGroup () const
+        {
+            rec . Check ();
+            return new SyntheticString ( std :: string () );
+        }
+
+        virtual ngs_adapt :: StringItf * getReadName () const
+        {
+            rec . Check ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'R', rec . idx ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getReadBases ( uint64_t offset, uint64_t length ) const
+        {
+            return rec . Part ( rec . Bases (), offset, length );
+        }
+
+        virtual ngs_adapt :: StringItf * getReadQualities ( uint64_t offset, uint64_t length ) const
+        {
+            return rec . Part ( rec . Qualities (), offset, length );
+        }
+
+        virtual bool nextRead ()
+        {
+            if ( ! iterating )
+                throw ngs_adapt :: ErrorMsg ( "invalid iterator access" );
+            if ( next >= end )
+                return false;
+            rec . Set ( next ++ );
+            fragment = 0;
+            return true;
+        }
+
+        // the index of the next read
+        virtual ngs_adapt :: StringItf * getCursor () const
+        {
+            char cursor [ 24 ];
+            int size = sprintf ( cursor, "%llu", ( unsigned long long ) next );
+            return new SyntheticString ( std :: string ( cursor, size ) );
+        }
+
+        virtual void resumeFrom ( const char * cursor )
+        {
+            next = strtoull ( cursor, 0, 10 );
+        }
+
+    public:
+
+        SyntheticReadItf ( const SyntheticSpec & spec, uint64_t p_first, uint64_t p_end )
+        : rec ( spec )
+        , next ( p_first )
+        , end ( p_end < spec . alignments ? p_end : spec . alignments )
+        , fragment ( 0 )
+        , iterating ( true )
+        {
+        }
+
+        SyntheticReadItf ( const SyntheticSpec & spec, uint64_t idx )
+        : rec ( spec )
+        , next ( idx + 1 )
+        , end ( idx + 1 )
+        , fragment ( 0 )
+        , iterating ( false )
+        {
+            rec . Set ( idx );
+        }
+
+    private:
+
+        void CheckFragment () const
+        {
+            rec . Check ();
+            if ( fragment == 0 )
+                throw ngs_adapt :: ErrorMsg ( "invalid fragment access" );
+        }
+
+        SyntheticRecord rec;
+        uint64_t next, end;
+        uint32_t fragment;
+        bool iterating;
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticPileupItf
+     *  the positions [ start, end ) of one reference, with an event for
+     *  each alignment that covers the position and passes "filter"
+     */
+    class SyntheticPileupItf : public ngs_adapt :: PileupItf
+    {
+    public:
+
+        // PileupEventItf
+
+        virtual int32_t getMappingQuality () const
+        {
+            CheckEvent ();
+            return SyntheticSpec :: mappingQuality ( Idx () );
+        }
+
+        virtual ngs_adapt :: StringItf * getAlignmentId () const
+        {
+            CheckEvent ();
+            return new SyntheticString ( SyntheticSpec :: id ( 'A', Idx () ) );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignment () const
+        {
+            CheckEvent ();
+            return new SyntheticAlignmentItf ( spec, Idx () );
+        }
+
+        virtual int64_t getAlignmentPosition () const
+        {
+            CheckEvent ();
+            return pos - spec . startOf ( event );
+        }
+
+        virtual int64_t getFirstAlignmentPosition () const
+        {
+            CheckEvent ();
+            return spec . startOf ( event );
+        }
+
+        virtual int64_t getLastAlignmentPosition () const
+        {
+            CheckEvent ();
+            return spec . startOf ( event ) + spec . readlen - 1;
+        }
+
+        virtual uint32_t getEventType () const
+        {
+            CheckEvent ();
+            int64_t first = spec . startOf ( event );
+            uint32_t type = ngs :: PileupEvent :: match;
+            if ( pos == first )
+                type |= ngs :: PileupEvent :: alignment_start;
+            if ( pos == first + spec . readlen - 1 )
+                type |= ngs :: PileupEvent :: alignment_stop;
+            if ( ( Idx () & 1 ) != 0 )
+                type |= ngs :: PileupEvent :: alignment_minus_strand;
+            return type;
+        }
+
+        virtual char getAlignmentBase () const
+        {
+            CheckEvent ();
+            return SyntheticSpec :: referenceBase ( ref, pos );
+        }
+
+        virtual char getAlignmentQuality () const
+        {
+            CheckEvent ();
+            return SyntheticSpec :: quality ( Idx (), pos - spec . startOf ( event ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getInsertionBases () const
+        {
+            CheckEvent ();
+            return new SyntheticString ( std :: string () );
+        }
+
+        virtual ngs_adapt :: StringItf * getInsertionQualities () const
+        {
+            CheckEvent ();
+            return new SyntheticString ( std :: string () );
+        }
+
+        // the rest of the alignment is one run of matches
+        virtual uint32_t getEventRepeatCount () const
+        {
+            CheckEvent ();
+            return ( uint32_t ) ( spec . startOf ( event ) + spec . readlen - pos );
+        }
+
+        virtual uint32_t getEventIndelType () const
+        {
+            CheckEvent ();
+            return ( uint32_t ) ngs :: PileupEvent :: normal_indel;
+        }
+
+        virtual bool nextPileupEvent ()
+        {
+            CheckPileup ();
+            event = nextEvent;
+            while ( event < lastEvent && filter . rejects ( first + event ) )
+                ++ event;
+            if ( event >= lastEvent )
+                return false;
+            nextEvent = event + 1;
+            return true;
+        }
+
+        virtual void resetPileupEvent ()
+        {
+            CheckPileup ();
+            nextEvent = firstEvent;
+            event = lastEvent;
+        }
+
+        // PileupItf
+
+        virtual ngs_adapt :: StringItf * getReferenceSpec () const
+        {
+            CheckPileup ();
+            return new SyntheticString ( SyntheticSpec :: referenceName ( ref ) );
+        }
+
+        virtual int64_t getReferencePosition () const
+        {
+            CheckPileup ();
+            return pos;
+        }
+
+        virtual char getReferenceBase () const
+        {
+            CheckPileup ();
+            return SyntheticSpec :: referenceBase ( ref, pos );
+        }
+
+        virtual uint32_t getPileupDepth () const
+        {
+            CheckPileup ();
+            uint32_t depth = 0;
+            for ( uint64_t k = firstEvent; k < lastEvent; ++ k )
+            {
+                if ( ! filter . rejects ( first + k ) )
+                    ++ depth;
+            }
+            return depth;
+        }
+
+        virtual bool nextPileup ()
+        {
+            pos = started ? pos + 1 : start;
+            started = true;
+            if ( pos >= end )
+            {
+                pos = end;
+                return false;
+            }
+            firstEvent = spec . firstAt ( pos - spec . readlen + 1 );
+            lastEvent = spec . firstAt ( pos + 1 );
+            if ( lastEvent > count )
+                lastEvent = count;
+            if ( firstEvent > lastEvent )
+                firstEvent = lastEvent;
+            nextEvent = firstEvent;
+            event = lastEvent;
+            return true;
+        }
+
+        // the positions past the old end are those of a longer slice
+        virtual void extendTo ( int64_t newEnd )
+        {
+            int64_t const limit = ( int64_t ) spec . referenceLength ( ref );
+            if ( newEnd > limit )
+                newEnd = limit;
+            if ( newEnd < end )
+                throw ngs_adapt :: ErrorMsg ( "a pileup window can't be made smaller" );
+            if ( started && pos >= end )
+                pos = end - 1;
+            end = newEnd;
+        }
+
+    public:
+
+        SyntheticPileupItf ( const SyntheticSpec & p_spec, uint32_t p_ref, int64_t p_start, int64_t p_end, const SyntheticFilter & p_filter )
+        : spec ( p_spec )
+        , filter ( p_filter )
+        , ref ( p_ref )
+        , first ( p_spec . firstOn ( p_ref ) )
+        , count ( p_spec . countOn ( p_ref ) )
+        , start ( p_start < 0 ? 0 : p_start )
+        , end ( p_end )
+        , pos ( 0 )
+        , firstEvent ( 0 )
+        , lastEvent ( 0 )
+        , nextEvent ( 0 )
+        , event ( 0 )
+        , started ( false )
+        {
+        }
+
+    private:
+
+        // the collection index of the alignment of the current event
+        uint64_t Idx () const
+        {
+            return first + event;
+        }
+
+        void CheckPileup () const
+        {
+            if ( ! started || pos >= end )
+                throw ngs_adapt :: ErrorMsg ( "invalid iterator access" );
+        }
+
+        void CheckEvent () const
+        {
+            CheckPileup ();
+            if ( event >= lastEvent )
+                throw ngs_adapt :: ErrorMsg ( "invalid pileup event access" );
+        }
+
+        SyntheticSpec spec;
+        SyntheticFilter filter;
+        uint32_t ref;
+        uint64_t first, count;
+        int64_t start, end, pos;
+
+        // events are k of the reference's alignments, [ firstEvent, lastEvent )
+        uint64_t firstEvent, lastEvent, nextEvent, event;
+        bool started;
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticReferenceItf
+     *  one reference, or an iterator over them all
+     */
+    class SyntheticReferenceItf : public ngs_adapt :: ReferenceItf
+    {
+    public:
+
+        virtual ngs_adapt :: StringItf * getCommonName () const
+        {
+            Check ();
+            return new SyntheticString ( SyntheticSpec :: referenceName ( ref ) );
+        }
+
+        virtual ngs_adapt :: StringItf * getCanonicalName () const
+        {
+            Check ();
+            return new SyntheticString ( SyntheticSpec :: referenceName ( ref ) );
+        }
+
+        virtual bool getIsCircular () const
+        {
+            Check ();
+            return false;
+        }
+
+        virtual uint64_t getLength () const
+        {
+            Check ();
+            return spec . referenceLength ( ref );
+        }
+
+        virtual ngs_adapt :: StringItf * getReferenceBases ( uint64_t offset, uint64_t length ) const
+        {
+            return Bases ( offset, length, spec . referenceLength ( ref ) );
+        }
+
+        // chunks end at the next multiple of 5000, as they do in SRA
+        virtual ngs_adapt :: StringItf * getReferenceChunk ( uint64_t offset, uint64_t length ) const
+        {
+            return Bases ( offset, length, ( offset / 5000 + 1 ) * 5000 );
+        }
+
+        virtual uint64_t getAlignmentCount ( bool wants_primary, bool wants_secondary ) const
+        {
+            Check ();
+            return wants_primary ? spec . countOn ( ref ) : 0;
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignment ( const char * alignmentId ) const
+        {
+            Check ();
+            uint64_t idx = spec . idxOf ( 'A', alignmentId );
+            if ( idx >= spec . alignments || spec . referenceOf ( idx ) != ref )
+                throw ngs_adapt :: ErrorMsg ( "alignment not found" );
+            return new SyntheticAlignmentItf ( spec, idx );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignments ( bool wants_primary, bool wants_secondary ) const
+        {
+            return getAlignmentSlice ( 0, spec . referenceLength ( ref ), wants_primary, wants_secondary );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignmentSlice ( int64_t start, uint64_t length, bool wants_primary, bool wants_secondary ) const
+        {
+            return Slice ( start, length, SyntheticFilter (), wants_primary );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getFilteredAlignments ( uint32_t flags, int32_t map_qual ) const
+        {
+            return Slice ( 0, spec . referenceLength ( ref ), SyntheticFilter ( flags, map_qual ), ( flags & NGS_ReferenceAlignFlags_wants_primary ) != 0 );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getFilteredAlignmentSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual ) const
+        {
+            return Slice ( start, length, SyntheticFilter ( flags, map_qual ), ( flags & NGS_ReferenceAlignFlags_wants_primary ) != 0 );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary ) const
+        {
+            Check ();
+            if ( count == 0 || shard >= count )
+                throw ngs_adapt :: ErrorMsg ( "invalid shard" );
+            uint64_t first = spec . firstOn ( ref );
+            uint64_t n = wants_primary ? spec . countOn ( ref ) : 0;
+            return new SyntheticAlignmentItf ( spec, first + n * shard / count, first + n * ( shard + 1 ) / count, SyntheticFilter () );
+        }
+
+        virtual ngs_adapt :: PileupItf * getPileups ( bool wants_primary, bool wants_secondary ) const
+        {
+            return getPileupSlice ( 0, spec . referenceLength ( ref ), wants_primary, wants_secondary );
+        }
+
+        virtual ngs_adapt :: PileupItf * getFilteredPileups ( uint32_t flags, int32_t map_qual ) const
+        {
+            return getFilteredPileupSlice ( 0, spec . referenceLength ( ref ), flags, map_qual );
+        }
+
+        virtual ngs_adapt :: PileupItf * getPileupSlice ( int64_t start, uint64_t length, bool wants_primary, bool wants_secondary ) const
+        {
+            Check ();
+            int64_t end = wants_primary ? SliceEnd ( start, length ) : start;
+            return new SyntheticPileupItf ( spec, ref, start, end, SyntheticFilter () );
+        }
+
+        virtual ngs_adapt :: PileupItf * getFilteredPileupSlice ( int64_t start, uint64_t length, uint32_t flags, int32_t map_qual ) const
+        {
+            Check ();
+            int64_t end = ( flags & NGS_ReferenceAlignFlags_wants_primary ) != 0 ? SliceEnd ( start, length ) : start;
+            return new SyntheticPileupItf ( spec, ref, start, end, SyntheticFilter ( flags, map_qual ) );
+        }
+
+        virtual bool nextReference ()
+        {
+            if ( ! iterating )
+                throw ngs_adapt :: ErrorMsg ( "invalid iterator access" );
+            if ( next >= spec . references )
+                return false;
+            ref = next ++;
+            return true;
+        }
+
+    public:
+
+        SyntheticReferenceItf ( const SyntheticSpec & p_spec )
+        : spec ( p_spec )
+        , ref ( 0 )
+        , next ( 0 )
+        , iterating ( true )
+        {
+        }
+
+        SyntheticReferenceItf ( const SyntheticSpec & p_spec, uint32_t p_ref )
+        : spec ( p_spec )
+        , ref ( p_ref )
+        , next ( p_ref + 1 )
+        , iterating ( false )
+        {
+        }
+
+    private:
+
+        void Check () const
+        {
+            if ( iterating && next == 0 )
+                throw ngs_adapt :: ErrorMsg ( "invalid iterator access" );
+        }
+
+        ngs_adapt :: StringItf * Bases ( uint64_t offset, uint64_t length, uint64_t limit ) const
+        {
+            Check ();
+            uint64_t refLength = spec . referenceLength ( ref );
+            if ( limit > refLength )
+                limit = refLength;
+            if ( offset >= limit )
+                return new SyntheticString ( std :: string () );
+            if ( length > limit - offset )
+                length = limit - offset;
+            std :: string bases ( ( size_t ) length, 'N' );
+            for ( uint64_t i = 0; i < length; ++ i )
+                bases [ ( size_t ) i ] = SyntheticSpec :: referenceBase ( ref, offset + i );
+            return new SyntheticString ( bases );
+        }
+
+        int64_t SliceEnd ( int64_t start, uint64_t length ) const
+        {
+            return spec . sliceEnd ( ref, start, length );
+        }
+
+        /* the alignments that overlap [ start, start + length ), or
+           that start within it for startWithinSlice */
+        ngs_adapt :: AlignmentItf * Slice ( int64_t start, uint64_t length, const SyntheticFilter & filter, bool wants_primary ) const
+        {
+            Check ();
+            return new SyntheticAlignmentItf ( spec, ref, start, length, filter, wants_primary );
+        }
+
+        SyntheticSpec spec;
+        uint32_t ref, next;
+        bool iterating;
+    };
+
+    /*----------------------------------------------------------------------
+     * SyntheticReadCollectionItf
+     */
+    class SyntheticReadCollectionItf : public ngs_adapt :: ReadCollectionItf
+    {
+    public:
+
+        virtual ngs_adapt :: StringItf * getName () const
+        {
+            return new SyntheticString ( name );
+        }
+
+        virtual ngs_adapt :: ReadGroupItf * getReadGroups () const
+        {
+            return new ngs_test_engine :: ReadGroupItf ( 1 );
+        }
+
+        virtual bool hasReadGroup ( const char * spec ) const
+        {
+            return spec [ 0 ] == 0;
+        }
+
+        virtual ngs_adapt :: ReadGroupItf * getReadGroup ( const char * spec ) const
+        {
+            return new ngs_test_engine :: ReadGroupItf ();
+        }
+
+        virtual ngs_adapt :: ReferenceItf * getReferences () const
+        {
+            return new SyntheticReferenceItf ( synth );
+        }
+
+        virtual bool hasReference ( const char * spec ) const
+        {
+            return RefOf ( spec ) < synth . references;
+        }
+
+        virtual ngs_adapt :: ReferenceItf * getReference ( const char * spec ) const
+        {
+            uint32_t ref = RefOf ( spec );
+            if ( ref >= synth . references )
+                throw ngs_adapt :: ErrorMsg ( "reference not found" );
+            return new SyntheticReferenceItf ( synth, ref );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignment ( const char * alignmentId ) const
+        {
+            uint64_t idx = synth . idxOf ( 'A', alignmentId );
+            if ( idx >= synth . alignments )
+                throw ngs_adapt :: ErrorMsg ( "alignment not found" );
+            return new SyntheticAlignmentItf ( synth, idx );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignments ( bool wants_primary, bool wants_secondary ) const
+        {
+            return new SyntheticAlignmentItf ( synth, 0, wants_primary ? synth . alignments : 0, SyntheticFilter () );
+        }
+
+        virtual uint64_t getAlignmentCount ( bool wants_primary, bool wants_secondary ) const
+        {
+            return wants_primary ? synth . alignments : 0;
+        }
+
+        // "first" is one-based, as for SRA
+        virtual ngs_adapt :: AlignmentItf * getAlignmentRange ( uint64_t first, uint64_t count, bool wants_primary, bool wants_secondary ) const
+        {
+            uint64_t beg = first == 0 ? 0 : first - 1;
+            return new SyntheticAlignmentItf ( synth, beg, wants_primary ? RangeEnd ( beg, count ) : beg, SyntheticFilter () );
+        }
+
+        virtual ngs_adapt :: AlignmentItf * getAlignmentShard ( uint32_t shard, uint32_t count, bool wants_primary, bool wants_secondary ) const
+        {
+            if ( count == 0 || shard >= count )
+                throw ngs_adapt :: ErrorMsg ( "invalid shard" );
+            uint64_t n = wants_primary ? synth . alignments : 0;
+            return new SyntheticAlignmentItf ( synth, n * shard / count, n * ( shard + 1 ) / count, SyntheticFilter () );
+        }
+
+        virtual ngs_adapt :: ReadItf * getRead ( const char * readId ) const
+        {
+            uint64_t idx = synth . idxOf ( 'R', readId );
+            if ( idx >= synth . alignments )
+                throw ngs_adapt :: ErrorMsg ( "read not found" );
+            return new SyntheticReadItf ( synth, idx );
+        }
+
+        virtual ngs_adapt :: ReadItf * getReads ( bool wants_full, bool wants_partial, bool wants_unaligned ) const
+        {
+            return new SyntheticReadItf ( synth, 0, wants_full ? synth . alignments : 0 );
+        }
+
+        virtual uint64_t getReadCount ( bool wants_full, bool wants_partial, bool wants_unaligned ) const
+        {
+            return wants_full ? synth . alignments : 0;
+        }
+
+        virtual ngs_adapt :: ReadItf * getReadRange ( uint64_t first, uint64_t count, bool wants_full, bool wants_partial, bool wants_unaligned ) const
+        {
+            uint64_t beg = first == 0 ? 0 : first - 1;
+            return new SyntheticReadItf ( synth, beg, wants_full ? RangeEnd ( beg, count ) : beg );
+        }
+
+    public:
+
+        SyntheticReadCollectionItf ( const char * p_name, const SyntheticSpec & p_synth )
+        : name ( p_name )
+        , synth ( p_synth )
+        {
+        }
+
+    private:
+
+        uint64_t RangeEnd ( uint64_t beg, uint64_t count ) const
+        {
+            return count > synth . alignments ? synth . alignments : beg + count;
+        }
+
+        // the index for a reference's name, or "references" if it is none of ours
+        uint32_t RefOf ( const char * spec ) const
+        {
+            char * end;
+            if ( spec [ 0 ] != 'c' || spec [ 1 ] != 'h' || spec [ 2 ] != 'r' || spec [ 3 ] < '1' || spec [ 3 ] > '9' )
+                return synth . references;
+            unsigned long n = strtoul ( spec + 3, & end, 10 );
+            return * end != 0 || n > synth . references ? synth . references : ( uint32_t ) n - 1;
+        }
+
+        std :: string name;
+        SyntheticSpec synth;
+    };
+
+} // namespace ngs_test_engine
+
+#endif // _hpp_ngs_test_engine_syntheticitf_
@@ -33,6 +33,10 @@
 #include "ReadItf.hpp"
 #include "StatisticsItf.hpp"
 #include "PileupItf.hpp"
+#include "SyntheticItf.hpp"
+
+#include <string.h>
+#include <stdlib.h>
 
   unsigned int ngs_test_engine::ReadCollectionItf::instanceCount = 0;
   unsigned int ngs_test_engine::ReadGroupItf::instanceCount = 0;
@@ -45,9 +49,62 @@
 namespace ngs_test_engine
 {
 
-	  ngs::ReadCollection NGS::openReadCollection ( const String & spec ) throw ( ErrorMsg )
+    /* parseSynthetic
+     *  fills "synth" from the "name=value" pairs after "synthetic:"
+     *  values may be written as "1e8"
+     */
+    static
+    void parseSynthetic ( const char * params, SyntheticSpec & synth )
+    {
+        while ( * params != 0 )
+        {
+            const char * end = strchr ( params, ',' );
+            if ( end == 0 )
+                end = params + strlen ( params );
+
+            std :: string param ( params, end - params );
+            std :: string :: size_type eq = param . find ( '=' );
+            if ( eq == std :: string :: npos )
+                throw ErrorMsg ( "synthetic: expected name=value, not '" + param + "'" );
+
+            std :: string key = param . substr ( 0, eq );
+            const char * value = param . c_str () + eq + 1;
+            char * rest;
+            double n = strtod ( value, & rest );
+            if ( rest == value || * rest != 0 || ! ( n >= 1 ) || n > 1e18 || n != ( double ) ( uint64_t ) n )
+                throw ErrorMsg ( "synthetic: bad value in '" + param + "'" );
+
+            if ( key == "alignments" )
+                synth . alignments = ( uint64_t ) n;
+            else if ( n > 0xFFFF )
+                throw ErrorMsg ( "synthetic: value too large in '" + param + "'" );
+            else if ( key == "depth" )
+                synth . depth = ( uint32_t ) n;
+            else if ( key == "readlen" )
+                synth . readlen = ( uint32_t ) n;
+            else if ( key == "references" )
+                synth . references = ( uint32_t ) n;
+            else
+                throw ErrorMsg ( "synthetic: unknown parameter '" + key + "'" );
+
+            params = * end == ',' ? end + 1 : end;
+        }
+    }
+
+	  ngs::ReadCollection NGS::openReadCollection ( const String & spec ) NGS_THROWS ( ErrorMsg )
 	{
-        ngs_adapt::ReadCollectionItf * ad_itf = new ngs_test_engine::ReadCollectionItf ( spec . c_str () );
+        ngs_adapt::ReadCollectionItf * ad_itf;
+        if ( spec . compare ( 0, 10, "synthetic:" ) == 0 )
+        {
+            SyntheticSpec synth;
+            parseSynthetic ( spec . c_str () + 10, synth );
+            ad_itf = new ngs_test_engine::SyntheticReadCollectionItf ( spec . c_str (), synth );
+        }
+        else
+        {
+            ad_itf = new ngs_test_engine::ReadCollectionItf ( spec . c_str () );
+        }
+
         NGS_ReadCollection_v1 * c_obj = ad_itf -> Cast ();
         ngs::ReadCollectionItf * ngs_itf = ngs::ReadCollectionItf::Cast ( c_obj );
 		return ngs::ReadCollection ( ngs_itf );
@@ -41,8 +41,10 @@ namespace ngs_test_engine
          *  create an object representing a named collection of reads
          *  "spec" may be a path to an object
          *  or may be an id, accession, or URL
+         *  one that starts with "synthetic:" opens a generated collection
+         *  of the size it gives, see SyntheticItf.hpp
          */
-        static  ReadCollection openReadCollection ( const String & spec ) throw ( ErrorMsg );
+        static  ReadCollection openReadCollection ( const String & spec ) NGS_THROWS ( ErrorMsg );
     };
 
 } // namespace ngs_test_engine